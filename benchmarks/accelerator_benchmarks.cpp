@@ -0,0 +1,90 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#include <benchmark/benchmark.h>
+
+#include "AcceleratorBuffer.hpp"
+#include "xacc.hpp"
+
+#include <random>
+
+using namespace xacc;
+
+namespace {
+// H on all qubits, a CX ladder and an Rz per qubit, repeated, then Measures
+std::shared_ptr<CompositeInstruction> layeredCircuit(int nq, int layers) {
+  auto provider = xacc::getIRProvider("quantum");
+  auto circuit = provider->createComposite("bench_circuit");
+  for (int l = 0; l < layers; l++) {
+    for (size_t q = 0; q < nq; q++) {
+      circuit->addInstruction(provider->createInstruction("H", {q}));
+    }
+    for (size_t q = 0; q + 1 < nq; q++) {
+      circuit->addInstruction(provider->createInstruction("CNOT", {q, q + 1}));
+    }
+    for (size_t q = 0; q < nq; q++) {
+      circuit->addInstruction(
+          provider->createInstruction("Rz", {q}, {0.1 * (l + 1)}));
+    }
+  }
+  for (size_t q = 0; q < nq; q++) {
+    circuit->addInstruction(provider->createInstruction("Measure", {q}));
+  }
+  return circuit;
+}
+
+void execute(benchmark::State &state, const std::string &name) {
+  if (!xacc::hasAccelerator(name)) {
+    state.SkipWithError((name + " is not installed").c_str());
+    return;
+  }
+  const int nq = state.range(0);
+  auto qpu = xacc::getAccelerator(name, {std::make_pair("shots", 1024)});
+  auto circuit = layeredCircuit(nq, 4);
+  for (auto _ : state) {
+    auto buffer = xacc::qalloc(nq);
+    qpu->execute(buffer, circuit);
+    benchmark::DoNotOptimize(buffer->getMeasurementCounts());
+  }
+  state.counters["qubits"] = nq;
+}
+} // namespace
+
+static void BM_ExpectationValueZ(benchmark::State &state) {
+  const int nbBits = state.range(0);
+  std::mt19937 gen(3);
+  std::uniform_int_distribution<int> bit(0, 1);
+  AcceleratorBuffer buffer("bench", nbBits);
+  std::map<std::string, int> counts;
+  for (int s = 0; s < 4096; s++) {
+    std::string bits(nbBits, '0');
+    for (auto &b : bits) {
+      b = bit(gen) ? '1' : '0';
+    }
+    counts[bits]++;
+  }
+  buffer.setMeasurements(counts);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(buffer.getExpectationValueZ());
+  }
+  state.counters["outcomes"] = counts.size();
+}
+BENCHMARK(BM_ExpectationValueZ)->RangeMultiplier(2)->Range(4, 64);
+
+static void BM_QppExecute(benchmark::State &state) { execute(state, "qpp"); }
+BENCHMARK(BM_QppExecute)->DenseRange(4, 20, 4);
+
+static void BM_QsimExecute(benchmark::State &state) { execute(state, "qsim"); }
+BENCHMARK(BM_QsimExecute)->DenseRange(4, 20, 4);
+
+static void BM_AerExecute(benchmark::State &state) { execute(state, "aer"); }
+BENCHMARK(BM_AerExecute)->DenseRange(4, 20, 4);
@@ -0,0 +1,165 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#include <benchmark/benchmark.h>
+
+#include "Circuit.hpp"
+#include "xacc.hpp"
+#include "xacc_service.hpp"
+
+#include <random>
+#include <sstream>
+
+using namespace xacc;
+
+namespace {
+// The "hwe" ansatz on a chain of nq qubits
+std::shared_ptr<quantum::Circuit> hwe(int nq, int layers) {
+  std::vector<std::pair<int, int>> coupling;
+  for (int q = 0; q + 1 < nq; q++) {
+    coupling.push_back({q, q + 1});
+  }
+  auto circuit = std::dynamic_pointer_cast<quantum::Circuit>(
+      xacc::getService<Instruction>("hwe"));
+  circuit->expand({std::make_pair("nq", nq), std::make_pair("layers", layers),
+                   std::make_pair("coupling", coupling)});
+  return circuit;
+}
+
+// layers of H, Rz and CX on random pairs, with some cancelling pairs for the
+// circuit optimizer
+std::string xasmSource(const std::string &name, int nq, int layers) {
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> qubit(0, nq - 1);
+  std::stringstream ss;
+  ss << "__qpu__ void " << name << "(qbit q) {\n";
+  for (int l = 0; l < layers; l++) {
+    for (int q = 0; q < nq; q++) {
+      ss << "H(q[" << q << "]);\n";
+      ss << "Rz(q[" << q << "], " << 0.1 * (l + 1) << ");\n";
+      ss << "Rz(q[" << q << "], " << -0.05 * (l + 1) << ");\n";
+    }
+    for (int q = 0; q < nq; q++) {
+      const int a = qubit(gen);
+      int b = qubit(gen);
+      if (a == b) {
+        b = (a + 1) % nq;
+      }
+      ss << "CX(q[" << a << "], q[" << b << "]);\n";
+      if (q % 3 == 0) {
+        ss << "CX(q[" << a << "], q[" << b << "]);\n";
+      }
+    }
+  }
+  for (int q = 0; q < nq; q++) {
+    ss << "Measure(q[" << q << "]);\n";
+  }
+  ss << "}\n";
+  return ss.str();
+}
+
+std::shared_ptr<CompositeInstruction> compileXasm(int nq, int layers) {
+  const std::string name = "bench_" + std::to_string(nq) + "_" +
+                           std::to_string(layers);
+  return xacc::getCompiler("xasm")
+      ->compile(xasmSource(name, nq, layers))
+      ->getComposites()[0];
+}
+
+// Coupling map only, for the placement benchmarks
+class ChainAccelerator : public Accelerator {
+  std::vector<std::pair<int, int>> edges;
+
+public:
+  ChainAccelerator(int nq) {
+    for (int q = 0; q + 1 < nq; q++) {
+      edges.push_back({q, q + 1});
+    }
+  }
+  const std::string name() const override { return "bench-chain"; }
+  const std::string description() const override { return ""; }
+  void initialize(const HeterogeneousMap &params = {}) override {}
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::shared_ptr<CompositeInstruction> function) override {}
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::vector<std::shared_ptr<CompositeInstruction>>
+                   functions) override {}
+  void updateConfiguration(const HeterogeneousMap &config) override {}
+  const std::vector<std::string> configurationKeys() override { return {}; }
+  std::vector<std::pair<int, int>> getConnectivity() override { return edges; }
+};
+} // namespace
+
+// Circuit::operator()(params): the evaluated copy of a parameterized ansatz
+static void BM_CircuitBind(benchmark::State &state) {
+  auto circuit = hwe(state.range(0), 4);
+  std::vector<double> params(circuit->nVariables());
+  for (int i = 0; i < params.size(); i++) {
+    params[i] = 0.01 * i;
+  }
+  for (auto _ : state) {
+    params[0] += 1e-6;
+    benchmark::DoNotOptimize((*circuit)(params));
+  }
+  state.counters["gates"] = circuit->nInstructions();
+}
+BENCHMARK(BM_CircuitBind)->RangeMultiplier(2)->Range(4, 32);
+
+static void BM_XasmCompile(benchmark::State &state) {
+  auto compiler = xacc::getCompiler("xasm");
+  const auto src = xasmSource("bench_xasm", 8, state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(compiler->compile(src));
+  }
+  state.counters["layers"] = state.range(0);
+}
+BENCHMARK(BM_XasmCompile)->RangeMultiplier(4)->Range(1, 64);
+
+static void BM_CircuitOptimizer(benchmark::State &state) {
+  auto opt = xacc::getIRTransformation("circuit-optimizer");
+  auto program = compileXasm(state.range(0), 8);
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto copy = std::dynamic_pointer_cast<CompositeInstruction>(program->clone());
+    state.ResumeTiming();
+    opt->apply(copy, nullptr);
+    benchmark::DoNotOptimize(copy->nInstructions());
+  }
+  state.counters["gates"] = program->nInstructions();
+}
+BENCHMARK(BM_CircuitOptimizer)->RangeMultiplier(2)->Range(4, 32);
+
+static void BM_SwapShortestPath(benchmark::State &state) {
+  const int nq = state.range(0);
+  auto qpu = std::make_shared<ChainAccelerator>(nq);
+  auto placement = xacc::getIRTransformation("swap-shortest-path");
+  auto program = compileXasm(nq, 4);
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto copy = std::dynamic_pointer_cast<CompositeInstruction>(program->clone());
+    state.ResumeTiming();
+    placement->apply(copy, qpu);
+    benchmark::DoNotOptimize(copy->nInstructions());
+  }
+  state.counters["gates"] = program->nInstructions();
+}
+BENCHMARK(BM_SwapShortestPath)->RangeMultiplier(2)->Range(4, 32);
+
+// The service lookups done by every algorithm initialization
+static void BM_GetService(benchmark::State &state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(xacc::getService<Instruction>("hwe"));
+    benchmark::DoNotOptimize(xacc::getService<IRTransformation>(
+        "circuit-optimizer"));
+  }
+}
+BENCHMARK(BM_GetService);
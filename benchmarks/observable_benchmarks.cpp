@@ -0,0 +1,111 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#include <benchmark/benchmark.h>
+
+#include "FermionOperator.hpp"
+#include "ObservableTransform.hpp"
+#include "PauliOperator.hpp"
+#include "xacc.hpp"
+#include "xacc_service.hpp"
+
+#include <random>
+
+using namespace xacc;
+using namespace xacc::quantum;
+
+namespace {
+// nbTerms random Pauli strings on nq qubits
+PauliOperator randomPauli(int nq, int nbTerms, unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<int> pauli(0, 3);
+  std::uniform_real_distribution<double> coeff(-1.0, 1.0);
+  const std::string names[] = {"I", "X", "Y", "Z"};
+  PauliOperator op;
+  for (int t = 0; t < nbTerms; t++) {
+    std::map<int, std::string> ops;
+    for (int q = 0; q < nq; q++) {
+      const int p = pauli(gen);
+      if (p) {
+        ops.emplace(q, names[p]);
+      }
+    }
+    op += PauliOperator(ops, coeff(gen));
+  }
+  return op;
+}
+
+// One- and two-body excitations of a chemistry-like Hamiltonian on n orbitals
+FermionOperator molecularHamiltonian(int n) {
+  FermionOperator op;
+  for (int p = 0; p < n; p++) {
+    for (int q = 0; q < n; q++) {
+      op += FermionOperator({{p, true}, {q, false}}, 0.1 / (1 + p + q));
+    }
+  }
+  for (int p = 0; p < n; p++) {
+    for (int q = p + 1; q < n; q++) {
+      op += FermionOperator({{p, true}, {q, true}, {q, false}, {p, false}},
+                            0.05 / (1 + p * q));
+    }
+  }
+  return op;
+}
+} // namespace
+
+// The measurement circuits of an operator on an ansatz
+static void BM_PauliObserve(benchmark::State &state) {
+  const int nq = 8;
+  auto op = randomPauli(nq, state.range(0), 7);
+  auto provider = xacc::getIRProvider("quantum");
+  auto ansatz = provider->createComposite("ansatz");
+  for (int q = 0; q < nq; q++) {
+    ansatz->addInstruction(provider->createInstruction("H", {(size_t)q}));
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(op.observe(ansatz));
+  }
+  state.counters["terms"] = op.nTerms();
+}
+BENCHMARK(BM_PauliObserve)->RangeMultiplier(4)->Range(16, 1024);
+
+static void BM_PauliProduct(benchmark::State &state) {
+  auto a = randomPauli(16, state.range(0), 1);
+  auto b = randomPauli(16, state.range(0), 2);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a * b);
+  }
+  state.counters["terms"] = a.nTerms();
+}
+BENCHMARK(BM_PauliProduct)->RangeMultiplier(4)->Range(16, 256);
+
+static void BM_PauliSum(benchmark::State &state) {
+  auto a = randomPauli(16, state.range(0), 1);
+  auto b = randomPauli(16, state.range(0), 2);
+  for (auto _ : state) {
+    auto sum = a;
+    sum += b;
+    benchmark::DoNotOptimize(sum.nTerms());
+  }
+}
+BENCHMARK(BM_PauliSum)->RangeMultiplier(4)->Range(64, 16384);
+
+static void BM_JordanWigner(benchmark::State &state) {
+  auto jw = xacc::getService<ObservableTransform>("jw");
+  auto op = std::make_shared<FermionOperator>(
+      molecularHamiltonian(state.range(0)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(jw->transform(op));
+  }
+  state.counters["fermion-terms"] = op->getNonIdentitySubTerms().size();
+}
+BENCHMARK(BM_JordanWigner)->RangeMultiplier(2)->Range(4, 16);
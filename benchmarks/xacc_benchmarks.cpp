@@ -0,0 +1,30 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#include <benchmark/benchmark.h>
+
+#include "xacc.hpp"
+
+// The benchmarks are registered by the other translation units. The
+// --benchmark_* flags are consumed before the framework is initialized, e.g.
+//   xacc-benchmarks --benchmark_filter=Pauli --benchmark_format=json
+int main(int argc, char **argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  xacc::Initialize();
+  xacc::set_verbose(false);
+  benchmark::RunSpecifiedBenchmarks();
+  xacc::Finalize();
+  return 0;
+}
@@ -20,15 +20,29 @@ namespace py = pybind11;
 namespace xacc {
 namespace external {
 
+// The Python plugins (py-plugins directory) contribute their services when
+// the xacc module is imported. load() only registers these services, from
+// the manifest of the plugin sources (see contributedServiceNames): the
+// interpreter is started and xacc imported on the first request of one of
+// them, i.e. not at all for the jobs not using them.
 class PythonPluginLoader : public ExternalLanguagePluginLoader {
 protected:
-  void* libpython_handle;
+  void* libpython_handle = nullptr;
+  bool interpreterStarted = false;
+  // Starts the interpreter and imports the xacc module (and so the plugins)
+  bool startInterpreter();
+
 public:
   const std::string name() const override { return "python"; }
   const std::string description() const override { return ""; }
   bool load() override;
   bool unload() override;
 
+  // The names of the contributed services (accelerators, optimizers, ...)
+  // declared by the pelix decorators of the plugin files of in_dir, read
+  // without running Python.
+  static std::vector<std::string>
+  contributedServiceNames(const std::string &in_dir);
 };
 
 } // namespace external
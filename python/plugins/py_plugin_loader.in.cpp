@@ -12,18 +12,92 @@
  *******************************************************************************/
 #include "xacc_config.hpp"
 #include "py_plugin_loader.hpp"
+#include "xacc_service.hpp"
 #include "pybind11/embed.h"
+#include <dirent.h>
 #include <dlfcn.h>
+#include <fstream>
+#include <regex>
+#include <set>
+#include <sstream>
+
+namespace {
+// The service types contributed by PyServiceRegistry.initialize (xacc.py)
+const std::set<std::string> contributedTypes{
+    "accelerator", "accelerator_decorator", "algorithm",  "compiler",
+    "irtransformation", "observable",       "optimizer"};
+} // namespace
+
 namespace xacc {
 namespace external {
 
+std::vector<std::string>
+PythonPluginLoader::contributedServiceNames(const std::string &in_dir) {
+  std::vector<std::string> names;
+  DIR *dir = opendir(in_dir.c_str());
+  if (!dir) {
+    return names;
+  }
+  // A component: @Provides("type") then its @Property decorators, among
+  // which @Property("_name", "name", "the-name"), up to the class.
+  const std::regex provides("@Provides\\(\\s*\"([^\"]+)\"\\s*\\)");
+  const std::regex nameProperty(
+      "@Property\\(\\s*\"[^\"]*\"\\s*,\\s*\"name\"\\s*,\\s*\"([^\"]+)\"");
+  while (auto entry = readdir(dir)) {
+    const std::string fileName = entry->d_name;
+    if (fileName.size() < 3 ||
+        fileName.compare(fileName.size() - 3, 3, ".py") != 0) {
+      continue;
+    }
+    std::ifstream stream(in_dir + "/" + fileName);
+    std::stringstream ss;
+    ss << stream.rdbuf();
+    const auto source = ss.str();
+    for (std::sregex_iterator iter(source.begin(), source.end(), provides),
+         end;
+         iter != end; ++iter) {
+      if (!contributedTypes.count((*iter)[1])) {
+        continue;
+      }
+      const auto begin = source.begin() + iter->position() + iter->length();
+      auto classPos = source.find("\nclass ", iter->position());
+      const auto last =
+          classPos == std::string::npos ? source.end() : source.begin() + classPos;
+      std::smatch name;
+      if (std::regex_search(begin, last, name, nameProperty)) {
+        names.emplace_back(name[1]);
+      }
+    }
+  }
+  closedir(dir);
+  return names;
+}
+
 bool PythonPluginLoader::load() {
+  const auto pluginDir = xacc::getRootDirectory() + "/py-plugins";
+  const auto names = contributedServiceNames(pluginDir);
+  xacc::debug("[PyPluginLoader] Deferring the loading of " +
+              std::to_string(names.size()) +
+              " contributed Python plugin services of " + pluginDir);
+  if (!names.empty()) {
+    xacc::deferContributedServices(names, [this]() {
+      if (!startInterpreter()) {
+        xacc::warning("[xacc::external] Warning, could not load python "
+                      "external language plugin.");
+      }
+    });
+  }
+  return true;
+}
+
+bool PythonPluginLoader::startInterpreter() {
   xacc::debug("[PyPluginLoader] Loading all contributed Python plugins.");
 
   if (!XACC_IS_APPLE){
     libpython_handle = dlopen("@PYTHON_LIB_NAME@", RTLD_LAZY | RTLD_GLOBAL);
   }
   py::initialize_interpreter();
+  interpreterStarted = true;
   try {
     py::module sys = py::module::import("xacc");
     sys.attr("loaded_from_cpp_dont_finalize") = true;
@@ -38,9 +112,11 @@ bool PythonPluginLoader::load() {
 }
 
 bool PythonPluginLoader::unload() {
-  if (!XACC_IS_APPLE) {
+  // Nothing to unload if none of the Python services was used
+  if (!XACC_IS_APPLE && interpreterStarted) {
      xacc::debug("[PyPluginLoader] Unloading Python plugins");
      py::finalize_interpreter();
+     interpreterStarted = false;
      int i = dlclose(libpython_handle);
      if (i != 0) {
         std::cout << "error closing python lib: " << i << "\n";
@@ -16,6 +16,30 @@
 #include "py_heterogeneous_map.hpp"
 #include "xacc_service.hpp"
 
+namespace {
+// Read-only NumPy view over native data (no copy), owner keeps it alive
+template <typename T>
+py::array readOnlyView(const std::vector<py::ssize_t> &shape, const T *data,
+                       py::handle owner) {
+  py::array_t<T> view(shape, data, owner);
+  view.attr("setflags")(false);
+  return view;
+}
+
+py::dict toDict(const xacc::ExecutionMetrics &metrics) {
+  using namespace xacc;
+  py::dict result;
+  result["accelerator"] = metrics.accelerator;
+  result["job-id"] = metrics.jobId;
+  result[py::str(ExecutionInfo::QueueTimeKey)] = metrics.queueTimeMs;
+  result[py::str(ExecutionInfo::ExecutionTimeKey)] = metrics.executionTimeMs;
+  result[py::str(ExecutionInfo::PeakMemoryKey)] = metrics.peakMemoryBytes;
+  result[py::str(ExecutionInfo::CircuitCountKey)] = metrics.nbCircuits;
+  result[py::str(ExecutionInfo::ShotCountKey)] = metrics.nbShots;
+  return result;
+}
+} // namespace
+
 void bind_accelerator(py::module &m) {
   // Expose the Accelerator
   py::class_<xacc::Accelerator, std::shared_ptr<xacc::Accelerator>,
@@ -27,14 +51,23 @@ void bind_accelerator(py::module &m) {
   acc.def(py::init<>())
       .def("name", &xacc::Accelerator::name,
            "Return the name of this Accelerator.")
+      .def("getSignature", &xacc::Accelerator::getSignature,
+           "Return the name and backend of this Accelerator.")
       .def("getProperties", &xacc::Accelerator::getProperties, "")
+      .def("exportState", &xacc::Accelerator::exportState,
+           py::call_guard<py::gil_scoped_release>(),
+           "Write the state vector of the last execution to a NumPy .npy "
+           "file (numpy.load() reads it).")
       .def("contributeInstructions", &xacc::Accelerator::contributeInstructions,
            py::arg("custom_json_config") = std::string(""), "")
+      // Long-running calls release the GIL (Python-implemented
+      // accelerators re-acquire it in their overrides)
       .def("execute",
            (void (xacc::Accelerator::*)(
                std::shared_ptr<AcceleratorBuffer>,
                const std::shared_ptr<CompositeInstruction>)) &
                xacc::Accelerator::execute,
+           py::call_guard<py::gil_scoped_release>(),
            "Execute the Function with the given AcceleratorBuffer.")
       .def(
           "execute",
@@ -45,8 +78,10 @@ void bind_accelerator(py::module &m) {
               auto src = functor().cast<std::string>();
               auto compiler = xacc::getCompiler(compiler_name);
               auto composite = compiler->compile(src)->getComposites()[0];
-              if (exec)
+              if (exec) {
+                py::gil_scoped_release release;
                 qpu.execute(buffer, composite);
+              }
 
               return composite;
             };
@@ -75,6 +110,7 @@ void bind_accelerator(py::module &m) {
                 }
               }
 
+              py::gil_scoped_release release;
               qpu.execute(buffer, programs);
               return;
             } else {
@@ -103,7 +139,57 @@ void bind_accelerator(py::module &m) {
                std::shared_ptr<AcceleratorBuffer>,
                const std::vector<std::shared_ptr<CompositeInstruction>>)) &
                xacc::Accelerator::execute,
+           py::call_guard<py::gil_scoped_release>(),
            "Execute the Function with the given AcceleratorBuffer.")
+      .def(
+          "getWaveFunction",
+          [](xacc::Accelerator &qpu) -> py::object {
+            auto info = qpu.getExecutionInfo();
+            if (!info.keyExists<ExecutionInfo::WaveFuncPtrType>(
+                    ExecutionInfo::WaveFuncKey)) {
+              return py::none();
+            }
+            auto waveFunc = info.get<ExecutionInfo::WaveFuncPtrType>(
+                ExecutionInfo::WaveFuncKey);
+            // The capsule shares the ownership of the native state
+            auto holder = new ExecutionInfo::WaveFuncPtrType(waveFunc);
+            py::capsule owner(holder, [](void *p) {
+              delete reinterpret_cast<ExecutionInfo::WaveFuncPtrType *>(p);
+            });
+            return readOnlyView<std::complex<double>>(
+                {(py::ssize_t)waveFunc->size()}, waveFunc->data(), owner);
+          },
+          "Return the state vector of the last execution (ExecutionInfo "
+          "wave-function) as a read-only complex128 NumPy view, without "
+          "copying, or None if the Accelerator does not provide it.")
+      .def(
+          "getExecutionMetrics",
+          [](xacc::Accelerator &qpu) {
+            return toDict(qpu.getLastExecutionMetrics());
+          },
+          "Return the metrics of the last execution as a dict: "
+          "accelerator, job-id and the ExecutionInfo queue-time-ms, "
+          "execution-time-ms, peak-memory-bytes (-1 if unknown), "
+          "circuit-count and shot-count (-1 if exact).")
+      .def(
+          "setExecutionMetricsCallback",
+          [](xacc::Accelerator &qpu, py::function callback) {
+            // Copied by native threads: only the shared_ptr is, the
+            // function is released with the GIL.
+            std::shared_ptr<py::function> function(
+                new py::function(std::move(callback)), [](py::function *f) {
+                  py::gil_scoped_acquire acquire;
+                  delete f;
+                });
+            qpu.setExecutionMetricsCallback(
+                [function](const ExecutionMetrics &metrics) {
+                  py::gil_scoped_acquire acquire;
+                  (*function)(toDict(metrics));
+                });
+          },
+          "Call the given function with the metrics of each execution "
+          "(a dict, see getExecutionMetrics), possibly from another "
+          "thread.")
       .def("initialize", &xacc::Accelerator::initialize, "")
       .def("defaultPlacementTransformation",
            &xacc::Accelerator::defaultPlacementTransformation, "")
@@ -132,7 +218,8 @@ void bind_accelerator(py::module &m) {
       "The AcceleratorBuffer models a register of qubits.")
       .def(py::init<const std::string &, const int>())
       .def("getExpectationValueZ",
-           &xacc::AcceleratorBuffer::getExpectationValueZ,
+           (const double (xacc::AcceleratorBuffer::*)()) &
+               xacc::AcceleratorBuffer::getExpectationValueZ,
            "Return the expectation value with respect to the Z operator.")
       .def("resetBuffer", &xacc::AcceleratorBuffer::resetBuffer,
            "Reset this buffer for use in another computation.")
@@ -155,6 +242,31 @@ void bind_accelerator(py::module &m) {
       .def("getMeasurementCounts",
            &xacc::AcceleratorBuffer::getMeasurementCounts,
            "Return the mapping of measure bit strings to their counts.")
+      .def(
+          "getPackedMeasurements",
+          [](std::shared_ptr<AcceleratorBuffer> b) {
+            if (b->hasIrregularMeasurements()) {
+              xacc::error("getPackedMeasurements: the measurements contain "
+                          "characters other than 0 and 1, use "
+                          "getMeasurementCounts.");
+            }
+            auto owner = py::cast(b);
+            const auto nbRows = (py::ssize_t)b->getPackedCounts().size();
+            const auto nbWords = (py::ssize_t)b->getPackedWords();
+            return py::make_tuple(
+                readOnlyView<std::uint64_t>({nbRows, nbWords},
+                                            b->getPackedBitStrings().data(),
+                                            owner),
+                readOnlyView<int>({nbRows}, b->getPackedCounts().data(),
+                                  owner),
+                readOnlyView<std::size_t>(
+                    {nbRows}, b->getPackedLengths().data(), owner));
+          },
+          "Return read-only NumPy views (no copy) of the measurement counts: "
+          "the (rows, words) uint64 array of bit strings (bit k of a row is "
+          "the k-th character from the right), and the counts and bit "
+          "string lengths of the rows. Valid until the measurements of the "
+          "buffer change.")
       .def("getChildren",
            (std::vector<std::shared_ptr<AcceleratorBuffer>>(
                xacc::AcceleratorBuffer::*)(const std::string)) &
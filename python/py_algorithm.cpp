@@ -28,6 +28,7 @@ void bind_algorithm(py::module &m) {
            (void (xacc::Algorithm::*)(
                const std::shared_ptr<xacc::AcceleratorBuffer>) const) &
                xacc::Algorithm::execute,
+           py::call_guard<py::gil_scoped_release>(),
            "Execute the Algorithm, storing the results in provided "
            "AcceleratorBuffer.")
       .def("execute",
@@ -35,6 +36,7 @@ void bind_algorithm(py::module &m) {
                const std::shared_ptr<xacc::AcceleratorBuffer>,
                const std::vector<double> &)) &
                xacc::Algorithm::execute,
+           py::call_guard<py::gil_scoped_release>(),
            "Execute the Algorithm, storing the results in provided "
            "AcceleratorBuffer.")
       .def(
@@ -17,6 +17,7 @@
 #include "xacc.hpp"
 #include "xacc_service.hpp"
 #include "InstructionIterator.hpp"
+#include "BinaryIR.hpp"
 #include "py_heterogeneous_map.hpp"
 
 void bind_ir(py::module &m) {
@@ -137,6 +138,12 @@ void bind_ir(py::module &m) {
       .def("setCoefficient", &xacc::CompositeInstruction::setCoefficient, "")
       .def("depth", &xacc::CompositeInstruction::depth, "")
       .def("persistGraph", &xacc::CompositeInstruction::persistGraph, "")
+      .def(
+          "toBinary",
+          [](std::shared_ptr<CompositeInstruction> program) {
+            return py::bytes(xacc::quantum::toBinary(program));
+          },
+          "Serialize to the binary IR format, see xacc.fromBinary.")
       .def("mapBits", &xacc::CompositeInstruction::mapBits, "")
       .def("setTag", &xacc::CompositeInstruction::setTag, "")
       .def("getTag", &xacc::CompositeInstruction::getTag, "")
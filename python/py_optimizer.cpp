@@ -24,8 +24,11 @@ void bind_optimizer(py::module &m) {
           "optimize",
           [&](xacc::Optimizer &o, py::function &f,
               const int ndim) -> OptResult {
+            // The optimization runs without the GIL, the Python objective
+            // re-acquires it.
             OptFunction opt(
                 [&](const std::vector<double> &x, std::vector<double> &grad) {
+                  py::gil_scoped_acquire acquire;
                   auto ret = f(x);
                   if (py::isinstance<py::tuple>(ret)) {
                     auto result =
@@ -39,6 +42,7 @@ void bind_optimizer(py::module &m) {
                   }
                 },
                 ndim);
+            py::gil_scoped_release release;
             return o.optimize(opt);
           },
           "")
@@ -57,6 +61,7 @@ void bind_optimizer(py::module &m) {
             }
             OptFunction opt(
                 [&](const std::vector<double> &x, std::vector<double> &grad) {
+                  py::gil_scoped_acquire acquire;
                   if (grad.empty()) {
                     return f.attr("__call__")(x).cast<double>();
                   } else {
@@ -66,10 +71,13 @@ void bind_optimizer(py::module &m) {
                   }
                 },
                 f.attr("dimensions")().cast<int>());
+            py::gil_scoped_release release;
             return o.optimize(opt);
           },
           "")
-      .def("optimize", [](xacc::Optimizer &o) { return o.optimize(); })
+      .def(
+          "optimize", [](xacc::Optimizer &o) { return o.optimize(); },
+          py::call_guard<py::gil_scoped_release>())
       .def("setOptions",
            (void (xacc::Optimizer::*)(const HeterogeneousMap &)) &
                xacc::Optimizer::setOptions,
@@ -86,5 +94,5 @@ void bind_optimizer(py::module &m) {
             std::vector<double> tmpgrad(o.dimensions());
             return o(x, tmpgrad);
           },
-          "");
+          py::call_guard<py::gil_scoped_release>(), "");
 }
\ No newline at end of file
@@ -321,6 +321,23 @@ class TestGateFunctions(test.TestCase):
         self.assertEqual(f.nInstructions(), 5)
 
 
+    def test_BinarySerialization(self):
+        f = xacc.gate.createFunction("foo", ["theta"])
+        rx = xacc.gate.create("Rx", [1])
+        rx.setParameter(0, "theta")
+        f.addInstruction(xacc.gate.create("H", [0]))
+        f.addInstruction(rx)
+        f.addInstruction(xacc.gate.create("CNOT", [0, 1]))
+
+        data = f.toBinary()
+        self.assertTrue(isinstance(data, bytes))
+        g = xacc.fromBinary(data)
+        self.assertEqual(g.name(), "foo")
+        self.assertEqual(g.toString(), f.toString())
+        self.assertEqual(g.nParameters(), 1)
+        # Any buffer, e.g. an mmap.mmap, can be read
+        g = xacc.fromBinary(memoryview(bytearray(data)))
+        self.assertEqual(g.nInstructions(), 3)
 
 
 
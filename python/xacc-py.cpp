@@ -15,6 +15,7 @@
 
 #include "InstructionIterator.hpp"
 #include "AcceleratorDecorator.hpp"
+#include "BinaryIR.hpp"
 
 #include "py_heterogeneous_map.hpp"
 #include "py_ir.hpp"
@@ -220,6 +221,15 @@ PYBIND11_MODULE(_pyxacc, m) {
     auto c = xacc::getService<Instruction>(name);
     return std::dynamic_pointer_cast<CompositeInstruction>(c);
   });
+  m.def(
+      "fromBinary",
+      [](py::buffer data) {
+        // Read in place, e.g. from bytes or an mmap.mmap
+        auto info = data.request();
+        return xacc::quantum::fromBinary(static_cast<const char *>(info.ptr),
+                                         info.size * info.itemsize);
+      },
+      "Load a circuit serialized with CompositeInstruction.toBinary.");
   m.def(
       "createCompositeInstruction",
       [](const std::string &name, const PyHeterogeneousMap &options) {
@@ -309,10 +319,18 @@ PYBIND11_MODULE(_pyxacc, m) {
       "getState",
       [](std::shared_ptr<Accelerator> acc,
          std::shared_ptr<CompositeInstruction> f) {
-        auto results = acc->getAcceleratorState(f);
-        Eigen::VectorXcd ret =
-            Eigen::Map<Eigen::VectorXcd>(results.data(), results.size());
-        return ret;
+        auto state = std::make_unique<std::vector<std::complex<double>>>();
+        {
+          py::gil_scoped_release release;
+          *state = acc->getAcceleratorState(f);
+        }
+        // The NumPy array takes the ownership of the state (no copy)
+        auto results = state.release();
+        py::capsule owner(results, [](void *p) {
+          delete reinterpret_cast<std::vector<std::complex<double>> *>(p);
+        });
+        return py::array_t<std::complex<double>>(
+            {(py::ssize_t)results->size()}, results->data(), owner);
       },
       "Compute and return the state after execution of the given program on "
       "the given accelerator.");
@@ -15,6 +15,7 @@ from _pyxacc import *
 import os
 import time
 import json
+import hashlib
 import platform
 import sys
 import re
@@ -166,6 +167,28 @@ def setCredentials(opts):
 
 
 
+# Compiled kernels of the decorated functions, by (source hash, compiler,
+# accelerator signature, tag): a function decorated again with the same
+# source (e.g. within a loop over parameter points) is not recompiled.
+_compiledKernels = {}
+
+
+def compileKernel(src, qpu, compilerName='pyxasm', tag=None):
+    key = (hashlib.sha256(src.encode('utf-8')).hexdigest(), compilerName,
+           qpu.getSignature(), tag)
+    if key not in _compiledKernels:
+        ir = getCompiler(compilerName).compile(src, qpu)
+        kernel = ir.getComposites()[0]
+        if tag is not None:
+            kernel.setTag(tag)
+        _compiledKernels[key] = kernel
+    return _compiledKernels[key]
+
+
+def clearKernelCache():
+    _compiledKernels.clear()
+
+
 class DecoratorFunction(ABC):
 
     def __init__(self):
@@ -181,7 +204,6 @@ class DecoratorFunction(ABC):
 
         self.processVariables()
 
-        compiler = getCompiler('pyxasm')
         if self.accelerator == None:
             if 'accelerator' in self.kwargs:
                 if isinstance(self.kwargs['accelerator'], Accelerator):
@@ -197,10 +219,8 @@ class DecoratorFunction(ABC):
         else:
             self.qpu = self.accelerator
 
-        ir = compiler.compile(self.src, self.qpu)
-        self.compiledKernel = ir.getComposites()[0]
-        if 'tag' in self.kwargs:
-            self.compiledKernel.setTag(self.kwargs['tag'])
+        self.compiledKernel = compileKernel(
+            self.src, self.qpu, tag=self.kwargs.get('tag'))
 
     def overrideAccelerator(self, acc):
         self.qpu = acc
@@ -249,6 +269,8 @@ class WrappedF(DecoratorFunction):
         if not isinstance(argsList[0], AcceleratorBuffer):
             raise RuntimeError(
                 'First argument of an xacc kernel must be the Accelerator Buffer to operate on.')
+        # Bound through the cached evaluation plan of the kernel, a new
+        # instance: the cached kernel may be shared with other wrappers.
         fevaled = self.compiledKernel.eval(argsList[1:])
         fevaled.setTag(self.compiledKernel.getTag())
         self.qpu.execute(argsList[0], fevaled)
@@ -114,7 +114,7 @@ void AnnealingProgram::persist(std::ostream &outStream) {
   writer.String("instructions");
   writer.StartArray();
 
-  for (auto &i : getInstructions()) {
+  for (auto &i : instructions) {
     writer.StartObject();
     writer.String("instruction");
     writer.String(i->name().c_str());
@@ -226,7 +226,7 @@ AnnealingProgram::operator()(const std::vector<double> &params) {
   auto evaluated = std::make_shared<AnnealingProgram>("evaled_" + name());
 
   // Walk the IR Tree, handle functions and instructions differently
-  for (auto inst : getInstructions()) {
+  for (auto &inst : instructions) {
     if (inst->isComposite()) {
       // If a Function, call this method recursively
       auto evaled =
@@ -112,6 +112,9 @@ public:
     return instructions[idx];
   }
   std::vector<InstPtr> getInstructions() override { return instructions; }
+  const std::vector<InstPtr> &getInstructionsView() override {
+    return instructions;
+  }
   void removeInstruction(const std::size_t idx) override {
     validateInstructionIndex(idx);
     instructions.erase(instructions.begin() + idx);
@@ -0,0 +1,209 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#include "ArrayAnnealingProgram.hpp"
+#include "xacc_service.hpp"
+
+namespace xacc {
+namespace quantum {
+
+ArrayAnnealingProgram::ArrayAnnealingProgram(std::string kernelName,
+                                             std::vector<double> biases,
+                                             std::vector<Coupler> couplers)
+    : AnnealingProgram(kernelName), h(std::move(biases)),
+      J(std::move(couplers)) {
+  for (auto &coupler : J) {
+    const auto maxBit = std::max(coupler.i, coupler.j);
+    if (maxBit >= h.size()) {
+      h.resize(maxBit + 1, 0.0);
+    }
+  }
+}
+
+void ArrayAnnealingProgram::setBias(std::size_t bit, double value) {
+  if (bit >= h.size()) {
+    h.resize(bit + 1, 0.0);
+    instructionsValid = false;
+  }
+  h[bit] = value;
+  if (instructionsValid) {
+    InstructionParameter p(value);
+    instructions[bit]->setParameter(0, p);
+  }
+}
+
+void ArrayAnnealingProgram::setBiases(const std::vector<double> &values) {
+  if (values.size() != h.size()) {
+    xacc::error("ArrayAnnealingProgram: " + std::to_string(values.size()) +
+                " biases given for " + std::to_string(h.size()) + " bits.");
+  }
+  for (std::size_t bit = 0; bit < values.size(); ++bit) {
+    setBias(bit, values[bit]);
+  }
+}
+
+void ArrayAnnealingProgram::setCoupler(std::size_t idx, double value) {
+  if (idx >= J.size()) {
+    xacc::error("ArrayAnnealingProgram: invalid coupler index " +
+                std::to_string(idx) + ".");
+  }
+  J[idx].value = value;
+  if (instructionsValid) {
+    InstructionParameter p(value);
+    instructions[h.size() + idx]->setParameter(0, p);
+  }
+}
+
+void ArrayAnnealingProgram::setCouplerValues(
+    const std::vector<double> &values) {
+  if (values.size() != J.size()) {
+    xacc::error("ArrayAnnealingProgram: " + std::to_string(values.size()) +
+                " coupler values given for " + std::to_string(J.size()) +
+                " couplers.");
+  }
+  for (std::size_t idx = 0; idx < values.size(); ++idx) {
+    setCoupler(idx, values[idx]);
+  }
+}
+
+std::size_t ArrayAnnealingProgram::addCoupler(std::size_t i, std::size_t j,
+                                              double value) {
+  if (i == j) {
+    xacc::error("ArrayAnnealingProgram: a coupler needs two distinct bits, "
+                "use setBias.");
+  }
+  const auto maxBit = std::max(i, j);
+  if (maxBit >= h.size()) {
+    h.resize(maxBit + 1, 0.0);
+  }
+  J.push_back(Coupler{i, j, value});
+  instructionsValid = false;
+  return J.size() - 1;
+}
+
+void ArrayAnnealingProgram::buildInstructions() {
+  if (instructionsValid) {
+    return;
+  }
+  instructions.clear();
+  instructions.reserve(h.size() + J.size());
+  for (std::size_t bit = 0; bit < h.size(); ++bit) {
+    instructions.emplace_back(std::make_shared<DWQMI>(bit, h[bit]));
+  }
+  for (auto &coupler : J) {
+    instructions.emplace_back(
+        std::make_shared<DWQMI>(coupler.i, coupler.j, coupler.value));
+  }
+  instructionsValid = true;
+}
+
+void ArrayAnnealingProgram::errorUnsupported(const std::string &method) const {
+  xacc::error("ArrayAnnealingProgram::" + method +
+              " is not supported, use the bias and coupler setters.");
+}
+
+void ArrayAnnealingProgram::addInstruction(InstPtr instruction) {
+  auto bits = instruction->bits();
+  if (instruction->isComposite() || bits.size() != 2 ||
+      instruction->nParameters() != 1 ||
+      instruction->getParameter(0).isVariable()) {
+    xacc::error("ArrayAnnealingProgram: only numeric bias and coupler "
+                "instructions can be added, not " +
+                instruction->toString() + ".");
+  }
+  const double value =
+      xacc::InstructionParameterToDouble(instruction->getParameter(0));
+  if (bits[0] == bits[1]) {
+    setBias(bits[0], value);
+  } else {
+    addCoupler(bits[0], bits[1], value);
+  }
+}
+
+const int ArrayAnnealingProgram::nInstructions() {
+  return h.size() + J.size();
+}
+
+InstPtr ArrayAnnealingProgram::getInstruction(const std::size_t idx) {
+  buildInstructions();
+  return AnnealingProgram::getInstruction(idx);
+}
+
+std::vector<InstPtr> ArrayAnnealingProgram::getInstructions() {
+  buildInstructions();
+  return instructions;
+}
+
+const std::vector<InstPtr> &ArrayAnnealingProgram::getInstructionsView() {
+  buildInstructions();
+  return instructions;
+}
+
+void ArrayAnnealingProgram::removeInstruction(const std::size_t idx) {
+  errorUnsupported("removeInstruction");
+}
+
+void ArrayAnnealingProgram::replaceInstruction(const std::size_t idx,
+                                               InstPtr newInst) {
+  errorUnsupported("replaceInstruction");
+}
+
+void ArrayAnnealingProgram::insertInstruction(const std::size_t idx,
+                                              InstPtr newInst) {
+  errorUnsupported("insertInstruction");
+}
+
+void ArrayAnnealingProgram::clear() {
+  h.clear();
+  J.clear();
+  instructions.clear();
+  instructionsValid = false;
+}
+
+std::shared_ptr<Graph> ArrayAnnealingProgram::toGraph() {
+  auto graph = xacc::getService<Graph>("boost-ugraph");
+  for (std::size_t bit = 0; bit < h.size(); ++bit) {
+    HeterogeneousMap props{std::make_pair("bias", h[bit])};
+    graph->addVertex(props);
+  }
+  for (auto &coupler : J) {
+    graph->addEdge(coupler.i, coupler.j, coupler.value);
+  }
+  return graph;
+}
+
+const std::string ArrayAnnealingProgram::toString() {
+  buildInstructions();
+  return AnnealingProgram::toString();
+}
+
+void ArrayAnnealingProgram::persist(std::ostream &outStream) {
+  buildInstructions();
+  AnnealingProgram::persist(outStream);
+}
+
+std::shared_ptr<CompositeInstruction>
+ArrayAnnealingProgram::operator()(const std::vector<double> &params) {
+  if (!params.empty()) {
+    xacc::error("ArrayAnnealingProgram has no variables, update the biases "
+                "and couplers in place instead.");
+  }
+  return std::dynamic_pointer_cast<CompositeInstruction>(clone());
+}
+
+std::shared_ptr<Instruction> ArrayAnnealingProgram::clone() {
+  auto copy = std::make_shared<ArrayAnnealingProgram>(_name, h, J);
+  copy->setTag(tag);
+  return copy;
+}
+} // namespace quantum
+} // namespace xacc
@@ -0,0 +1,99 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#ifndef QUANTUM_AQC_ARRAYANNEALINGPROGRAM_HPP_
+#define QUANTUM_AQC_ARRAYANNEALINGPROGRAM_HPP_
+
+#include "AnnealingProgram.hpp"
+
+namespace xacc {
+namespace quantum {
+
+// An Ising / QUBO problem stored as arrays: the dense biases h and the
+// couplers J in coordinate (i, j, value) form. The values are updated in
+// place, e.g. every training epoch, without building instructions; the
+// DWQMI instructions are only created when the instruction API is used.
+class ArrayAnnealingProgram : public AnnealingProgram {
+public:
+  struct Coupler {
+    std::size_t i;
+    std::size_t j;
+    double value;
+  };
+
+  ArrayAnnealingProgram(std::string kernelName)
+      : AnnealingProgram(kernelName) {}
+  ArrayAnnealingProgram(std::string kernelName, std::vector<double> biases,
+                        std::vector<Coupler> couplers);
+
+  // Number of variables (size of h)
+  std::size_t nBits() const { return h.size(); }
+  std::size_t nCouplers() const { return J.size(); }
+  const std::vector<double> &biases() const { return h; }
+  const std::vector<Coupler> &couplers() const { return J; }
+
+  // In-place updates, the biases (resp. coupler values) given in the order
+  // of biases() (resp. couplers()).
+  void setBias(std::size_t bit, double value);
+  void setBiases(const std::vector<double> &values);
+  void setCoupler(std::size_t idx, double value);
+  void setCouplerValues(const std::vector<double> &values);
+  // Appends a coupler (the biases are extended to its bits), returns its
+  // index.
+  std::size_t addCoupler(std::size_t i, std::size_t j, double value);
+
+  // The problem as (i, j, value) entries, biases first, e.g. SAPI's
+  // sapi_ProblemEntry, without going through the instructions.
+  template <typename Entry> void writeEntries(std::vector<Entry> &out) const {
+    out.reserve(out.size() + h.size() + J.size());
+    for (std::size_t bit = 0; bit < h.size(); ++bit) {
+      out.push_back(Entry{(int)bit, (int)bit, h[bit]});
+    }
+    for (auto &coupler : J) {
+      out.push_back(Entry{(int)coupler.i, (int)coupler.j, coupler.value});
+    }
+  }
+
+  // Instruction API: a bias or a coupler DWQMI with a numeric parameter.
+  void addInstruction(InstPtr instruction) override;
+  const int nInstructions() override;
+  const int nChildren() override { return nInstructions(); }
+  InstPtr getInstruction(const std::size_t idx) override;
+  std::vector<InstPtr> getInstructions() override;
+  const std::vector<InstPtr> &getInstructionsView() override;
+  void removeInstruction(const std::size_t idx) override;
+  void replaceInstruction(const std::size_t idx, InstPtr newInst) override;
+  void insertInstruction(const std::size_t idx, InstPtr newInst) override;
+  void clear() override;
+  bool hasChildren() const override { return !h.empty() || !J.empty(); }
+
+  std::shared_ptr<Graph> toGraph() override;
+  const std::string toString() override;
+  void persist(std::ostream &outStream) override;
+  std::shared_ptr<CompositeInstruction>
+  operator()(const std::vector<double> &params) override;
+
+  std::shared_ptr<Instruction> clone() override;
+
+protected:
+  std::vector<double> h;
+  std::vector<Coupler> J;
+  // The instructions are rebuilt when the sparsity pattern changed
+  bool instructionsValid = false;
+  void buildInstructions();
+  void errorUnsupported(const std::string &method) const;
+};
+
+} // namespace quantum
+} // namespace xacc
+
+#endif
@@ -0,0 +1,66 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#include <gtest/gtest.h>
+#include "ArrayAnnealingProgram.hpp"
+
+using namespace xacc::quantum;
+
+namespace {
+struct Entry {
+  int i;
+  int j;
+  double value;
+};
+} // namespace
+
+TEST(ArrayAnnealingProgramTester, checkInPlaceUpdates) {
+  ArrayAnnealingProgram program("foo", {1.0, 2.0}, {{0, 1, 0.5}});
+  program.addCoupler(1, 3, -0.5);
+  EXPECT_EQ(4, program.nBits());
+  EXPECT_EQ(2, program.nCouplers());
+  EXPECT_EQ(6, program.nInstructions());
+
+  std::vector<Entry> entries;
+  program.writeEntries(entries);
+  ASSERT_EQ(6, entries.size());
+  EXPECT_EQ(1, entries[1].i);
+  EXPECT_EQ(1, entries[1].j);
+  EXPECT_EQ(2.0, entries[1].value);
+  EXPECT_EQ(3, entries[5].j);
+  EXPECT_EQ(-0.5, entries[5].value);
+
+  // The instructions follow the updates
+  auto bias = program.getInstruction(2);
+  program.setBiases({0.1, 0.2, 0.3, 0.4});
+  program.setCouplerValues({1.5, 2.5});
+  EXPECT_EQ(bias, program.getInstruction(2));
+  EXPECT_EQ(0.3, xacc::InstructionParameterToDouble(bias->getParameter(0)));
+  EXPECT_EQ("0 0 0.1;\n1 1 0.2;\n2 2 0.3;\n3 3 0.4;\n0 1 1.5;\n1 3 2.5;\n",
+            program.toString());
+
+  // Instructions are routed to the arrays
+  program.addInstruction(std::make_shared<DWQMI>(4, 0.7));
+  program.addInstruction(std::make_shared<DWQMI>(0, 4, 0.9));
+  EXPECT_EQ(5, program.nBits());
+  EXPECT_EQ(3, program.nCouplers());
+  EXPECT_EQ(0.7, program.biases()[4]);
+  EXPECT_EQ(8, program.getInstructions().size());
+
+  auto copy = std::dynamic_pointer_cast<ArrayAnnealingProgram>(program.clone());
+  EXPECT_EQ(program.toString(), copy->toString());
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -71,6 +71,91 @@ void Circuit::throwIfInvalidInstructionParameter(InstPtr instruction) {
   }
 }
 
+bool Circuit::evaluationPlanIsValid() const {
+  if (!evaluationPlan || !evaluationPlan->cacheable ||
+      evaluationPlan->revision != revision) {
+    return false;
+  }
+  for (auto &[circuit, rev] : evaluationPlan->nested) {
+    if (circuit->revision != rev) {
+      return false;
+    }
+  }
+  return true;
+}
+
+InstructionSpan Circuit::flatView() {
+  bool isValid = flatViewRevision.has_value() && *flatViewRevision == revision;
+  for (auto &[circuit, rev] : flatViewNested) {
+    isValid = isValid && circuit->revision == rev;
+  }
+  if (!isValid) {
+    buildFlatTree(flatTree);
+    flatViewRevision = revision;
+    flatViewNested.clear();
+    for (auto &owner : flatTree.owners) {
+      if (owner->isComposite()) {
+        auto nested = std::dynamic_pointer_cast<Circuit>(owner);
+        if (!nested) {
+          flatViewRevision.reset();
+          break;
+        }
+        flatViewNested.emplace_back(nested, nested->revision);
+      }
+    }
+  }
+  return InstructionSpan(flatTree.nodes.data(),
+                         flatTree.nodes.data() + flatTree.nodes.size());
+}
+
+std::shared_ptr<Circuit::EvaluationPlan> Circuit::buildEvaluationPlan() {
+  auto plan = std::make_shared<EvaluationPlan>();
+  plan->revision = revision;
+
+  InstructionIterator iter(shared_from_this());
+  // Skip the root, we track our own revision
+  iter.next();
+  while (iter.hasNext()) {
+    auto inst = iter.next();
+    if (inst->isComposite()) {
+      auto nested = std::dynamic_pointer_cast<Circuit>(inst);
+      if (nested) {
+        plan->nested.emplace_back(nested, nested->revision);
+      } else {
+        // We can't track changes to this node, so
+        // the plan is only good for a single evaluation.
+        plan->cacheable = false;
+      }
+      continue;
+    }
+
+    EvaluationStep step;
+    step.inst = inst;
+    if (inst->isParameterized()) {
+      for (int i = 0; i < inst->nParameters(); i++) {
+        auto p = inst->getParameter(i);
+        if (!p.isVariable()) {
+          step.expressions.emplace_back("");
+          continue;
+        }
+        auto expr = p.toString();
+        ParameterSlot slot;
+        slot.paramIdx = i;
+        auto varIter = std::find(variables.begin(), variables.end(), expr);
+        if (varIter != variables.end()) {
+          slot.variableIdx = std::distance(variables.begin(), varIter);
+        } else {
+          slot.compiled = parsingUtil->compile(expr, variables);
+        }
+        step.expressions.emplace_back(expr);
+        step.slots.emplace_back(slot);
+      }
+    }
+    plan->steps.emplace_back(std::move(step));
+  }
+  return plan;
+}
+
 std::shared_ptr<CompositeInstruction>
 Circuit::operator()(const std::vector<double> &params) {
   if (!parsingUtil) {
@@ -85,41 +170,57 @@ Circuit::operator()(const std::vector<double> &params) {
     exit(0);
   }
 
-  std::vector<InstPtr> flatten;
-  InstructionIterator iter(shared_from_this());
-  while (iter.hasNext()) {
-    auto inst = iter.next();
-    if (!inst->isComposite()) {
-      flatten.emplace_back(inst);
+  // Instruction parameters may have been modified in place
+  // since the plan was built, i.e. by an IRTransformation.
+  const auto isStale = [](const EvaluationStep &step) {
+    for (int i = 0; i < step.expressions.size(); i++) {
+      auto p = step.inst->getParameter(i);
+      auto expr = mpark::get_if<std::string>(&p);
+      if (expr ? *expr != step.expressions[i]
+               : !step.expressions[i].empty()) {
+        return true;
+      }
     }
+    return false;
+  };
+
+  if (!evaluationPlanIsValid()) {
+    evaluationPlan = buildEvaluationPlan();
   }
 
-  auto evaluatedCircuit = std::make_shared<Circuit>("evaled_" + name());
+  std::vector<InstPtr> evaluatedInsts;
+  evaluatedInsts.reserve(evaluationPlan->steps.size());
+  for (int stepIdx = 0; stepIdx < evaluationPlan->steps.size(); stepIdx++) {
+    auto &step = evaluationPlan->steps[stepIdx];
+    if (step.expressions.empty()) {
+      evaluatedInsts.emplace_back(step.inst);
+      continue;
+    }
 
-  // Walk the IR Tree, handle functions and instructions differently
-  for (auto inst : flatten) {
-    if (inst->isParameterized()) {
-      auto updatedInst = inst->clone();
-      for (int i = 0; i < inst->nParameters(); i++) {
-        if (inst->getParameter(i).isVariable()) {
-          InstructionParameter p = inst->getParameter(i);
-          std::stringstream s;
-          double val;
-          parsingUtil->evaluate(p.toString(), variables, params, val);
-          updatedInst->setParameter(i, val);
-        } else {
-          auto a = inst->getParameter(i);
-          updatedInst->setParameter(i, a);
-        }
-        updatedInst->setBits(inst->bits());
-        if (!inst->getBufferNames().empty()) {
-          updatedInst->setBufferNames(inst->getBufferNames());
-        }
+    if (isStale(step)) {
+      evaluationPlan = buildEvaluationPlan();
+      return operator()(params);
+    }
+
+    auto updatedInst = step.inst->clone();
+    for (auto &slot : step.slots) {
+      double val;
+      if (slot.variableIdx >= 0) {
+        val = params[slot.variableIdx];
+      } else if (!slot.compiled || !slot.compiled->evaluate(params, val)) {
+        parsingUtil->evaluate(step.expressions[slot.paramIdx], variables,
+                              params, val);
       }
-      evaluatedCircuit->addInstruction(updatedInst);
-    } else {
-      evaluatedCircuit->addInstruction(inst);
+      updatedInst->setParameter(slot.paramIdx, val);
     }
+    evaluatedInsts.emplace_back(updatedInst);
+  }
+
+  auto evaluatedCircuit = std::make_shared<Circuit>("evaled_" + name());
+  // All parameters are concrete at this point, no need to validate.
+  evaluatedCircuit->addInstructions(std::move(evaluatedInsts), false);
+  if (!evaluationPlan->cacheable) {
+    evaluationPlan.reset();
   }
   return evaluatedCircuit;
 }
@@ -138,6 +239,7 @@ void Circuit::load(std::istream &inStream) {
   //     irGeneratorNames.push_back(irg);
   //   }
 
+  invalidateEvaluationPlan();
   variables.clear();
   instructions.clear();
 
@@ -199,7 +301,68 @@ void Circuit::load(std::istream &inStream) {
   }
 }
 
-const int Circuit::depth() { return toGraph()->depth() - 2; }
+const int Circuit::depth() { return layers().size(); }
+
+bool Circuit::layersMatchRevisions() const {
+  if (!layersRevision.has_value() || *layersRevision != revision) {
+    return false;
+  }
+  for (auto &[circuit, rev] : layersNested) {
+    if (circuit->revision != rev) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Circuit::appendToLayers(const InstPtr &in_inst) {
+  // Pre-order, as in flatView()
+  std::vector<InstPtr> pending{in_inst};
+  while (!pending.empty() && layersRevision.has_value()) {
+    auto inst = pending.back();
+    pending.pop_back();
+    if (!inst->isComposite()) {
+      layersGates.emplace_back(inst.get(), inst->isEnabled());
+      layering.add(inst.get());
+      continue;
+    }
+    auto nested = std::dynamic_pointer_cast<Circuit>(inst);
+    if (!nested) {
+      // Can't track changes to this node
+      layersRevision.reset();
+      break;
+    }
+    layersNested.emplace_back(nested, nested->revision);
+    const auto &children = nested->getInstructionsView();
+    pending.insert(pending.end(), children.rbegin(), children.rend());
+  }
+  if (layersRevision.has_value()) {
+    layersRevision = revision;
+  }
+}
+
+const InstructionLayers &Circuit::layers() {
+  bool isValid = layersMatchRevisions();
+  for (size_t i = 0; isValid && i < layersGates.size(); ++i) {
+    isValid = layersGates[i].first->isEnabled() == layersGates[i].second;
+  }
+  if (isValid) {
+    return layering.layers();
+  }
+
+  layering.clear();
+  layersGates.clear();
+  layersNested.clear();
+  layersRevision = revision;
+  for (auto &inst : instructions) {
+    appendToLayers(inst);
+  }
+  if (!layersRevision.has_value()) {
+    // Not cacheable, e.g. non-Circuit composites: rebuilt on each call
+    CompositeInstruction::layers();
+  }
+  return layering.layers();
+}
 
 const std::string Circuit::persistGraph() {
   std::stringstream s;
@@ -19,6 +19,7 @@
 #include "Utils.hpp"
 #include "expression_parsing_util.hpp"
 #include <limits>
+#include <optional>
 #include <memory>
 #include <stdexcept>
 #include <unordered_set>
@@ -53,6 +54,51 @@ private:
     }
   }
 
+  // Cached, pre-parsed form of this Circuit used by operator()(params).
+  // Each step references a leaf instruction of the (flattened) tree and
+  // the expression string of each of its parameters (empty for
+  // non-variable parameters). Variable parameters are evaluated either
+  // by direct lookup (variableIdx) or via a pre-compiled expression.
+  struct ParameterSlot {
+    std::size_t paramIdx;
+    int variableIdx = -1;
+    std::shared_ptr<CompiledExpression> compiled;
+  };
+  struct EvaluationStep {
+    InstPtr inst;
+    std::vector<std::string> expressions;
+    std::vector<ParameterSlot> slots;
+  };
+  struct EvaluationPlan {
+    std::size_t revision = 0;
+    // Nested Circuits and their revision at the time the plan was built.
+    std::vector<std::pair<std::shared_ptr<Circuit>, std::size_t>> nested;
+    std::vector<EvaluationStep> steps;
+    bool cacheable = true;
+  };
+
+  std::shared_ptr<EvaluationPlan> evaluationPlan;
+  std::size_t revision = 0;
+
+  void invalidateEvaluationPlan() { revision++; }
+  bool evaluationPlanIsValid() const;
+
+  // Revisions the cached flat view (see flatView()) was built at,
+  // or empty if it can't be cached (nested non-Circuit composites).
+  std::optional<std::size_t> flatViewRevision;
+  std::vector<std::pair<std::shared_ptr<Circuit>, std::size_t>> flatViewNested;
+  std::shared_ptr<EvaluationPlan> buildEvaluationPlan();
+
+  // layers() cache: the revisions it was built at (empty if it can't be
+  // cached, see flatView()), and the gates it holds with their enabled state
+  // at the time (Instruction::disable() does not change the revisions).
+  std::optional<std::size_t> layersRevision;
+  std::vector<std::pair<std::shared_ptr<Circuit>, std::size_t>> layersNested;
+  std::vector<std::pair<Instruction *, bool>> layersGates;
+  bool layersMatchRevisions() const;
+  // Add an instruction (sub-tree) after the current layers
+  void appendToLayers(const InstPtr &in_inst);
+
   void errorCircuitParameter() const {
     xacc::XACCLogger::instance()->error(
         "Circuit Instruction parameter API not implemented.");
@@ -73,6 +119,23 @@ protected:
   std::complex<double> coefficient = 1.0;
   std::string acc_signature = "";
 
+  // Feed the (enabled) gates, flattened, to the hasher.
+  // Sub-classes with control semantics (e.g. IfStmt) add their own data.
+  virtual void appendStructuralHash(StructuralHasher &io_hasher,
+                                    ParameterHashMode mode) {
+    for (auto &inst : instructions) {
+      if (!inst->isEnabled()) {
+        continue;
+      }
+      auto circuit = std::dynamic_pointer_cast<Circuit>(inst);
+      if (circuit) {
+        circuit->appendStructuralHash(io_hasher, mode);
+      } else {
+        io_hasher.add<uint64_t>(inst->structuralHash(mode));
+      }
+    }
+  }
+
 public:
   Circuit(const std::string &name) : circuitName(name) {}
   Circuit(const std::string &name, std::vector<std::string> &vars)
@@ -196,25 +259,38 @@ public:
     return instructions[idx];
   }
   std::vector<InstPtr> getInstructions() override { return instructions; }
+  const std::vector<InstPtr> &getInstructionsView() override {
+    return instructions;
+  }
+  InstructionSpan flatView() override;
   void removeInstruction(const std::size_t idx) override {
     validateInstructionIndex(idx);
+    invalidateEvaluationPlan();
     instructions.erase(instructions.begin() + idx);
   }
   void replaceInstruction(const std::size_t idx, InstPtr newInst) override {
     validateInstructionIndex(idx);
     throwIfInvalidInstructionParameter(newInst);
+    invalidateEvaluationPlan();
     instructions[idx] = newInst;
   }
   void insertInstruction(const std::size_t idx, InstPtr newInst) override {
     validateInstructionIndex(idx);
     throwIfInvalidInstructionParameter(newInst);
+    invalidateEvaluationPlan();
     instructions.insert(instructions.begin() + idx, newInst);
   }
 
   void addInstruction(InstPtr instruction) override {
     throwIfInvalidInstructionParameter(instruction);
     validateInstructionPtr(instruction);
+    // Appending keeps the layers up to date
+    const bool extendLayers = layersMatchRevisions();
+    invalidateEvaluationPlan();
     instructions.push_back(instruction);
+    if (extendLayers) {
+      appendToLayers(instruction);
+    }
   }
   void addInstructions(std::vector<InstPtr> &insts) override {
     for (auto &i : insts)
@@ -233,13 +309,17 @@ public:
       }
     } else {
       // Bypass instruction validation, append all the instructions directly.
+      invalidateEvaluationPlan();
       instructions.insert(instructions.end(),
                           std::make_move_iterator(insts.begin()),
                           std::make_move_iterator(insts.end()));
     }
   }
 
-  void clear() override { instructions.clear(); }
+  void clear() override {
+    invalidateEvaluationPlan();
+    instructions.clear();
+  }
 
   bool hasChildren() const override { return !instructions.empty(); }
   bool expand(const HeterogeneousMap &runtimeOptions) override {
@@ -259,9 +339,11 @@ public:
   }
 
   void addVariable(const std::string variableName) override {
+    invalidateEvaluationPlan();
     variables.push_back(variableName);
   }
   void addVariables(const std::vector<std::string> &vars) override {
+    invalidateEvaluationPlan();
     variables.insert(variables.end(), vars.begin(), vars.end());
   }
   const std::vector<std::string> getVariables() override {
@@ -280,6 +362,7 @@ public:
   }
   void replaceVariable(const std::string variable,
                        const std::string newVariable) override {
+    invalidateEvaluationPlan();
     std::replace_if(
         variables.begin(), variables.end(),
         [&](const std::string var) { return var == variable; }, newVariable);
@@ -287,7 +370,20 @@ public:
 
   const std::size_t nVariables() override { return getVariables().size(); }
 
+  // Number of as soon as possible layers, see layers().
   const int depth() override;
+  // Cached, and maintained by addInstruction().
+  const InstructionLayers &layers() override;
+
+  // Hash of the flattened gate sequence: independent of the circuit name and
+  // of how the gates are grouped into sub-circuits.
+  // Gates cache their own hash, hence this is a cheap pass over the circuit.
+  uint64_t structuralHash(
+      ParameterHashMode mode = ParameterHashMode::Numeric) override {
+    StructuralHasher hasher;
+    appendStructuralHash(hasher, mode);
+    return hasher.value();
+  }
   const std::string persistGraph() override;
   std::shared_ptr<Graph> toGraph() override;
 
@@ -399,9 +495,14 @@ public:
   std::shared_ptr<Instruction> clone() override {
     auto cloned = std::make_shared<Circuit>(name(), variables, buffer_names);
 
+    // These instructions were already validated when added to
+    // this Circuit, so skip the (quadratic) re-validation.
+    std::vector<InstPtr> clonedInsts;
+    clonedInsts.reserve(instructions.size());
     for (auto i : instructions) {
-      cloned->addInstruction(i->clone());
+      clonedInsts.emplace_back(i->clone());
     }
+    cloned->addInstructions(std::move(clonedInsts), false);
     return cloned; // std::make_shared<Circuit>(*this);
   }
 
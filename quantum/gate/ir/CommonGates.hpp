@@ -93,6 +93,21 @@ public:
     }
   }
 
+protected:
+  // The conditional and its body (disabled until expanded)
+  void appendStructuralHash(StructuralHasher &io_hasher,
+                            ParameterHashMode mode) override {
+    io_hasher.add(name());
+    io_hasher.add(bufferName);
+    io_hasher.add<uint64_t>(bitIdx);
+    io_hasher.add<uint64_t>(instructions.size());
+    for (auto &inst : instructions) {
+      io_hasher.add<uint64_t>(inst->structuralHash(mode));
+    }
+  }
+
+public:
+
   const std::string toString() override; 
   DEFINE_CLONE(IfStmt)
   DEFINE_VISITABLE()
@@ -13,23 +13,48 @@
 #include "Gate.hpp"
 #include "xacc.hpp"
 #include "xacc_service.hpp"
+#include <unordered_map>
+
+namespace {
+xacc::GateOpcode getOpcode(const std::string &in_name) {
+  using xacc::GateOpcode;
+  static const std::unordered_map<std::string, GateOpcode> opcodes{
+      {"I", GateOpcode::I},           {"H", GateOpcode::H},
+      {"X", GateOpcode::X},           {"Y", GateOpcode::Y},
+      {"Z", GateOpcode::Z},           {"S", GateOpcode::S},
+      {"Sdg", GateOpcode::Sdg},       {"T", GateOpcode::T},
+      {"Tdg", GateOpcode::Tdg},       {"Rx", GateOpcode::Rx},
+      {"Ry", GateOpcode::Ry},         {"Rz", GateOpcode::Rz},
+      {"U1", GateOpcode::U1},         {"U", GateOpcode::U},
+      {"CNOT", GateOpcode::CNOT},     {"CY", GateOpcode::CY},
+      {"CZ", GateOpcode::CZ},         {"CH", GateOpcode::CH},
+      {"CRZ", GateOpcode::CRZ},       {"CPhase", GateOpcode::CPhase},
+      {"Swap", GateOpcode::Swap},     {"iSwap", GateOpcode::iSwap},
+      {"fSim", GateOpcode::fSim},     {"XY", GateOpcode::XY},
+      {"Measure", GateOpcode::Measure}, {"Reset", GateOpcode::Reset}};
+  auto iter = opcodes.find(in_name);
+  return iter == opcodes.end() ? GateOpcode::Unknown : iter->second;
+}
+} // namespace
 
 namespace xacc {
 namespace quantum {
 
 Gate::Gate() {}
-Gate::Gate(std::string name) : gateName(name) {}
+Gate::Gate(std::string name) : gateName(name), gateOpcode(getOpcode(name)) {}
 Gate::Gate(std::string name, std::vector<InstructionParameter> params)
-    : gateName(name), parameters(params) {}
+    : gateName(name), gateOpcode(getOpcode(name)), parameters(params) {}
 Gate::Gate(std::string name, std::vector<std::size_t> qubts)
-    : gateName(name), qbits(qubts),
+    : gateName(name), gateOpcode(getOpcode(name)), qbits(qubts),
       parameters(std::vector<InstructionParameter>{}) {}
 Gate::Gate(std::string name, std::vector<std::size_t> qubts,
            std::vector<InstructionParameter> params)
-    : gateName(name), qbits(qubts), parameters(params) {}
+    : gateName(name), gateOpcode(getOpcode(name)), qbits(qubts),
+      parameters(params) {}
 Gate::Gate(const Gate &inst)
-    : gateName(inst.gateName), qbits(inst.qbits), parameters(inst.parameters),
-      arguments(inst.arguments), enabled(inst.enabled), buffer_names(inst.buffer_names) {}
+    : gateName(inst.gateName), gateOpcode(inst.gateOpcode), qbits(inst.qbits),
+      parameters(inst.parameters), arguments(inst.arguments),
+      enabled(inst.enabled), buffer_names(inst.buffer_names) {}
 
 const std::string Gate::name() const { return gateName; }
 const std::string Gate::description() const {
@@ -59,6 +84,15 @@ void Gate::mapBits(std::vector<std::size_t> bitMap) {
     }
     qbits[i] = bitMap[qbits[i]];
   }
+  invalidateHash();
+}
+
+uint64_t Gate::structuralHash(ParameterHashMode mode) {
+  auto &cached = hashCache[static_cast<int>(mode)];
+  if (!cached.has_value()) {
+    cached = Instruction::structuralHash(mode);
+  }
+  return cached.value();
 }
 
 const std::string Gate::toString() {
@@ -109,6 +143,7 @@ void Gate::setParameter(const std::size_t idx, InstructionParameter &p) {
   }
 
   parameters[idx] = p;
+  invalidateHash();
 }
 
 std::vector<InstructionParameter> Gate::getParameters() { return parameters; }
@@ -117,6 +152,7 @@ void Gate::applyRuntimeArguments() {
   if (!parsingUtil) {
     parsingUtil = xacc::getService<ExpressionParsingUtil>("exprtk");
   }
+  invalidateHash();
 
   for (auto &kv : arguments) {
     if (kv.second->type.find("std::vector<double>") != std::string::npos) {
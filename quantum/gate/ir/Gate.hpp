@@ -15,8 +15,10 @@
 
 #include "Instruction.hpp"
 #include "Cloneable.hpp"
+#include "GateArena.hpp"
 #include "Utils.hpp"
 #include "expression_parsing_util.hpp"
+#include <optional>
 
 namespace xacc {
 namespace quantum {
@@ -29,6 +31,8 @@ protected:
   std::shared_ptr<ExpressionParsingUtil> parsingUtil;
 
   std::string gateName;
+  // Set from gateName on construction
+  GateOpcode gateOpcode = GateOpcode::Unknown;
   std::vector<std::size_t> qbits;
   bool enabled = true;
   std::vector<InstructionParameter> parameters;
@@ -46,6 +50,11 @@ protected:
   //}
   std::map<int, int> param_idx_to_vector_idx;
 
+  // Cached structural hash per ParameterHashMode,
+  // reset when the bits or parameters change.
+  std::optional<uint64_t> hashCache[2];
+  void invalidateHash() { hashCache[0].reset(); hashCache[1].reset(); }
+
 public:
   Gate();
   Gate(std::string name);
@@ -71,7 +80,10 @@ public:
 
   void applyRuntimeArguments() override;
   const std::vector<std::size_t> bits() override;
-  void setBits(const std::vector<std::size_t> bits) override { qbits = bits; }
+  void setBits(const std::vector<std::size_t> bits) override {
+    qbits = bits;
+    invalidateHash();
+  }
   std::string getBufferName(const std::size_t bitIdx) override;
   void
   setBufferNames(const std::vector<std::string> bufferNamesPerIdx) override;
@@ -95,7 +107,11 @@ public:
 
   void mapBits(std::vector<std::size_t> bitMap) override;
 
+  uint64_t structuralHash(
+      ParameterHashMode mode = ParameterHashMode::Numeric) override;
+
   bool isComposite() override { return false; }
+  GateOpcode opcode() const override { return gateOpcode; }
 
   bool isEnabled() override;
   void disable() override;
@@ -103,7 +119,7 @@ public:
 
 #define DEFINE_CLONE(CLASS)                                                    \
   std::shared_ptr<Instruction> clone() override {                              \
-    return std::make_shared<CLASS>(*this);                                     \
+    return xacc::quantum::makeGate<CLASS>(*this);                              \
   }
 };
 
@@ -0,0 +1,85 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "GateArena.hpp"
+#include <atomic>
+
+namespace {
+using xacc::quantum::GateArena;
+constexpr std::size_t NbSizeClasses =
+    GateArena::MaxBlockSize / GateArena::Granularity;
+
+struct FreeBlock {
+  FreeBlock *next;
+};
+
+// Trivially destructible: still usable by gates released during thread exit.
+struct ThreadArena {
+  FreeBlock *freeLists[NbSizeClasses];
+  char *slabCurrent;
+  char *slabEnd;
+};
+thread_local ThreadArena threadArena{};
+std::atomic<std::size_t> slabCount{0};
+
+std::size_t sizeClass(std::size_t bytes) {
+  return (bytes + GateArena::Granularity - 1) / GateArena::Granularity - 1;
+}
+} // namespace
+
+namespace xacc {
+namespace quantum {
+void *GateArena::allocate(std::size_t bytes) {
+  if (bytes == 0 || bytes > MaxBlockSize) {
+    return ::operator new(bytes);
+  }
+  auto &arena = threadArena;
+  const auto cls = sizeClass(bytes);
+  if (auto block = arena.freeLists[cls]) {
+    arena.freeLists[cls] = block->next;
+    return block;
+  }
+
+  const auto blockSize = (cls + 1) * Granularity;
+  const std::size_t tailSize = arena.slabEnd - arena.slabCurrent;
+  if (tailSize < blockSize) {
+    // The tail of the previous slab (shorter than a block) is recycled.
+    if (tailSize >= Granularity) {
+      deallocate(arena.slabCurrent, tailSize);
+    }
+    arena.slabCurrent = static_cast<char *>(::operator new(SlabSize));
+    arena.slabEnd = arena.slabCurrent + SlabSize;
+    slabCount++;
+  }
+  auto block = arena.slabCurrent;
+  arena.slabCurrent += blockSize;
+  return block;
+}
+
+void GateArena::deallocate(void *ptr, std::size_t bytes) {
+  if (!ptr) {
+    return;
+  }
+  if (bytes == 0 || bytes > MaxBlockSize) {
+    ::operator delete(ptr);
+    return;
+  }
+  auto &arena = threadArena;
+  const auto cls = sizeClass(bytes);
+  auto block = static_cast<FreeBlock *>(ptr);
+  block->next = arena.freeLists[cls];
+  arena.freeLists[cls] = block;
+}
+
+std::size_t GateArena::nbSlabs() { return slabCount; }
+} // namespace quantum
+} // namespace xacc
@@ -0,0 +1,81 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#ifndef QUANTUM_GATE_IR_GATEARENA_HPP_
+#define QUANTUM_GATE_IR_GATEARENA_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+namespace xacc {
+namespace quantum {
+// Pooled storage for gate instructions.
+// Blocks are carved contiguously from large slabs and recycled through
+// per-thread, size-class free lists, so building or cloning large circuits
+// doesn't hit the general-purpose heap once per gate.
+// Slabs are retained for the lifetime of the process, hence a gate can be
+// released on any thread.
+class GateArena {
+public:
+  static constexpr std::size_t Granularity = alignof(std::max_align_t);
+  // Larger requests are forwarded to the heap.
+  static constexpr std::size_t MaxBlockSize = 1024;
+  static constexpr std::size_t SlabSize = 64 * 1024;
+
+  static void *allocate(std::size_t bytes);
+  static void deallocate(void *ptr, std::size_t bytes);
+  // Number of slabs allocated so far (all threads)
+  static std::size_t nbSlabs();
+};
+
+// Standard allocator on top of the GateArena, for std::allocate_shared:
+// the gate and its shared_ptr control block share one pooled block.
+template <typename T> class GateAllocator {
+public:
+  using value_type = T;
+  GateAllocator() noexcept = default;
+  template <typename U> GateAllocator(const GateAllocator<U> &) noexcept {}
+
+  T *allocate(std::size_t n) {
+    if (alignof(T) > GateArena::Granularity) {
+      return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+    return static_cast<T *>(GateArena::allocate(n * sizeof(T)));
+  }
+  void deallocate(T *ptr, std::size_t n) noexcept {
+    if (alignof(T) > GateArena::Granularity) {
+      ::operator delete(ptr);
+    } else {
+      GateArena::deallocate(ptr, n * sizeof(T));
+    }
+  }
+};
+
+template <typename T, typename U>
+bool operator==(const GateAllocator<T> &, const GateAllocator<U> &) {
+  return true;
+}
+template <typename T, typename U>
+bool operator!=(const GateAllocator<T> &, const GateAllocator<U> &) {
+  return false;
+}
+
+// make_shared counterpart allocating from the GateArena
+template <typename GateType, typename... Args>
+std::shared_ptr<GateType> makeGate(Args &&... args) {
+  return std::allocate_shared<GateType>(GateAllocator<GateType>(),
+                                        std::forward<Args>(args)...);
+}
+} // namespace quantum
+} // namespace xacc
+#endif
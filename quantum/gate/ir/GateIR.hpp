@@ -29,7 +29,7 @@ public:
   const std::size_t maxBit() override {
     int maxBit = 0;
     for (auto k : kernels) {
-      for (auto inst : k->getInstructions()) {
+      for (auto &inst : k->getInstructionsView()) {
         for (auto b : inst->bits()) {
           if (b > maxBit) {
             maxBit = b;
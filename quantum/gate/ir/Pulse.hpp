@@ -31,7 +31,9 @@ protected:
   std::size_t t0 = 0;
   std::size_t _duration = 0;
 
-  std::vector<std::vector<double>> samples = {};
+  // Shared by the copies of the pulse, e.g. the instances of a backend pulse
+  // library entry in the cmd-defs and the lowered circuits.
+  std::shared_ptr<const std::vector<std::vector<double>>> samples;
   HeterogeneousMap pulseParameters;
 public:
   Pulse();
@@ -59,10 +61,12 @@ public:
   std::size_t duration() override { return _duration; }
   void setDuration(const std::size_t d) override { _duration = d; }
   void setSamples(const std::vector<std::vector<double>> s) override {
-    samples = s;
-    _duration = samples.size();
+    _duration = s.size();
+    samples = std::make_shared<const std::vector<std::vector<double>>>(s);
+  }
+  std::vector<std::vector<double>> getSamples() override {
+    return samples ? *samples : std::vector<std::vector<double>>{};
   }
-  std::vector<std::vector<double>> getSamples() override { return samples; }
   void setPulseParams(const HeterogeneousMap &in_pulseParams) override {
     pulseParameters = in_pulseParams;
   }
@@ -110,7 +114,7 @@ public:
 
   std::shared_ptr<Instruction> clone() override {
     auto inst = std::make_shared<Pulse>(gateName, ch, parameters[0], qbits);
-    inst->setSamples(samples);
+    inst->samples = samples;
     inst->setStart(t0);
     inst->setDuration(_duration);
     inst->setPulseParams(pulseParameters);
@@ -3,17 +3,18 @@
 #include "Pulse.hpp"
 
 #include "xacc.hpp"
+#include <algorithm>
+#include <unordered_map>
 
 namespace {
   // Note: this is a *SEQUENTIAL* pulse scheduler, i.e. it will respect the ordering of the composites (command defs),
   // e.g. if we do a "pulse::cx_0_1; pulse::cx_4_5"; pulse sequence of the second one (pulse::cx_4_5) will be scheduled
   // *AFTER* that of the first one "pulse::cx_0_1".
-  // TODO: we can implement a smarter scheduler which will keep track of the *set* of channels related to a composite,
-  // and in case that the two sets of channels are completely disjoint (for two consecutive composites), we can schedule them in parallel 
-  // (i.e. same start time for both composites)
-  void processComposite(std::shared_ptr<xacc::CompositeInstruction> composite, size_t compositeStartTime, std::map<std::string, std::size_t>& io_channel2times) {
+  // See the "asap" and "alap" policies for schedules that run composites on disjoint channels in parallel.
+  // io_latestTime is the latest end time of all channels (the start time of the next nested composite).
+  void processComposite(std::shared_ptr<xacc::CompositeInstruction> composite, size_t compositeStartTime, std::unordered_map<std::string, std::size_t>& io_channel2times, std::size_t& io_latestTime) {
     // Process children of a composite instructions
-    for (auto& inst: composite->getInstructions()) {
+    for (auto& inst: composite->getInstructionsView()) {
       if (inst->isEnabled() && !inst->isComposite()) {
         auto pulse = std::dynamic_pointer_cast<xacc::quantum::Pulse>(inst);
         if (!pulse) {
@@ -25,9 +26,9 @@ namespace {
         auto& currentTimeOnChannel = io_channel2times[pulse->channel()];
         // The expected start time of a pulse is shifted by that of the parent composite.
         auto pulseExpectedStart = pulse->start() + compositeStartTime;
-        
+
         // Normally, in a well-formed pulse composite instruction (e.g. those from IBM json)
-        // individual pulses within a composite (command def) already have their start time set correctly 
+        // individual pulses within a composite (command def) already have their start time set correctly
         // (i.e. pulses on the same channels are spaced correctly)
         // hence, the following condition should be passing
         if (pulseExpectedStart >= currentTimeOnChannel) {
@@ -43,22 +44,211 @@ namespace {
         }
         // Update the current time on channel after the pulse has been scheduled.
         currentTimeOnChannel = pulse->start() + pulse->duration();
+        io_latestTime = std::max(io_latestTime, currentTimeOnChannel);
       } else if (inst->isEnabled() && inst->isComposite()) {
         // Composite nested within a composite
         // The start time of this nested composite must be the latest time of all channels
-        size_t nextCompositeStartTime = 0;
-        for (const auto& kv : io_channel2times) {
-          nextCompositeStartTime = kv.second > nextCompositeStartTime ? kv.second  : nextCompositeStartTime;
-        }
-
         auto compositeInstPtr = std::dynamic_pointer_cast<xacc::CompositeInstruction>(inst);
         if (!compositeInstPtr) {
             xacc::error("Invalid instruction in pulse program.");
         }
         // Recursive
-        processComposite(compositeInstPtr, nextCompositeStartTime, io_channel2times);
+        processComposite(compositeInstPtr, io_latestTime, io_channel2times, io_latestTime);
+      }
+    }
+  }
+
+  // Unit of the "asap" and "alap" schedules: a raw pulse or a command def,
+  // i.e. a composite of pulses only, whose pulses keep their relative timing.
+  struct PulseBlock {
+    std::vector<std::shared_ptr<xacc::Instruction>> pulses;
+    // Start time of each pulse relative to the block
+    std::vector<size_t> offsets;
+    size_t duration = 0;
+  };
+
+  std::shared_ptr<xacc::Instruction> asPulse(const std::shared_ptr<xacc::Instruction>& in_inst) {
+    if (!std::dynamic_pointer_cast<xacc::quantum::Pulse>(in_inst)) {
+      xacc::error("Invalid instruction in pulse program.");
+    }
+    return in_inst;
+  }
+
+  void collectBlocks(std::shared_ptr<xacc::CompositeInstruction> composite, std::vector<PulseBlock>& io_blocks) {
+    for (auto& inst: composite->getInstructionsView()) {
+      if (!inst->isEnabled()) {
+        continue;
+      }
+      if (!inst->isComposite()) {
+        PulseBlock block;
+        block.pulses.emplace_back(asPulse(inst));
+        block.offsets.emplace_back(0);
+        block.duration = inst->duration();
+        io_blocks.emplace_back(std::move(block));
+        continue;
+      }
+      auto compositeInstPtr = std::dynamic_pointer_cast<xacc::CompositeInstruction>(inst);
+      if (!compositeInstPtr) {
+        xacc::error("Invalid instruction in pulse program.");
+      }
+      const auto children = compositeInstPtr->getInstructionsView();
+      const bool isCommandDef = std::none_of(children.begin(), children.end(), [](const auto& child) {
+        return child->isEnabled() && child->isComposite();
+      });
+      if (!isCommandDef) {
+        collectBlocks(compositeInstPtr, io_blocks);
+        continue;
       }
-    } 
+      // Relative timing within the command def, with the same spacing rule as the sequential schedule.
+      PulseBlock block;
+      std::unordered_map<std::string, std::size_t> channel2times;
+      for (auto& child: children) {
+        if (!child->isEnabled()) {
+          continue;
+        }
+        auto& currentTimeOnChannel = channel2times[child->channel()];
+        const auto offset = std::max<size_t>(child->start(), currentTimeOnChannel);
+        currentTimeOnChannel = offset + child->duration();
+        block.pulses.emplace_back(asPulse(child));
+        block.offsets.emplace_back(offset);
+        block.duration = std::max(block.duration, currentTimeOnChannel);
+      }
+      if (!block.pulses.empty()) {
+        io_blocks.emplace_back(std::move(block));
+      }
+    }
+  }
+
+  // Earliest start of each block (in order) such that pulses on the same channel don't overlap
+  // and blocks on the same qubit (e.g. a gate and the measurement of its qubit) don't overlap either.
+  // Returns the total duration.
+  size_t placeAsap(const std::vector<const PulseBlock*>& in_blocks, const std::vector<std::vector<size_t>>& in_offsets, std::vector<size_t>& out_starts) {
+    std::unordered_map<std::string, std::size_t> channel2times;
+    std::unordered_map<std::size_t, std::size_t> qubit2times;
+    size_t totalDuration = 0;
+    out_starts.resize(in_blocks.size());
+    for (size_t blockIdx = 0; blockIdx < in_blocks.size(); ++blockIdx) {
+      const auto& pulses = in_blocks[blockIdx]->pulses;
+      const auto& offsets = in_offsets[blockIdx];
+      size_t start = 0;
+      for (size_t i = 0; i < pulses.size(); ++i) {
+        const auto iter = channel2times.find(pulses[i]->channel());
+        if (iter != channel2times.end() && iter->second > offsets[i]) {
+          start = std::max(start, iter->second - offsets[i]);
+        }
+        for (const auto bit : pulses[i]->bits()) {
+          const auto qubitIter = qubit2times.find(bit);
+          if (qubitIter != qubit2times.end()) {
+            start = std::max(start, qubitIter->second);
+          }
+        }
+      }
+      const auto blockEnd = start + in_blocks[blockIdx]->duration;
+      for (size_t i = 0; i < pulses.size(); ++i) {
+        auto& currentTimeOnChannel = channel2times[pulses[i]->channel()];
+        currentTimeOnChannel = std::max(currentTimeOnChannel, start + offsets[i] + pulses[i]->duration());
+        for (const auto bit : pulses[i]->bits()) {
+          qubit2times[bit] = blockEnd;
+        }
+      }
+      out_starts[blockIdx] = start;
+      totalDuration = std::max(totalDuration, blockEnd);
+    }
+    return totalDuration;
+  }
+
+  void scheduleBlocks(std::shared_ptr<xacc::CompositeInstruction> program, bool in_asLateAsPossible) {
+    std::vector<PulseBlock> blocks;
+    collectBlocks(program, blocks);
+    std::vector<const PulseBlock*> order;
+    std::vector<std::vector<size_t>> offsets;
+    for (const auto& block : blocks) {
+      order.emplace_back(&block);
+      offsets.emplace_back(block.offsets);
+    }
+    if (in_asLateAsPossible) {
+      // ASAP on the reversed program, with mirrored blocks.
+      std::reverse(order.begin(), order.end());
+      std::reverse(offsets.begin(), offsets.end());
+      for (size_t blockIdx = 0; blockIdx < order.size(); ++blockIdx) {
+        for (size_t i = 0; i < offsets[blockIdx].size(); ++i) {
+          offsets[blockIdx][i] = order[blockIdx]->duration - offsets[blockIdx][i] - order[blockIdx]->pulses[i]->duration();
+        }
+      }
+    }
+    std::vector<size_t> starts;
+    const auto totalDuration = placeAsap(order, offsets, starts);
+    for (size_t blockIdx = 0; blockIdx < order.size(); ++blockIdx) {
+      const auto& block = *order[blockIdx];
+      // Mirrored back: the block ends where its reversed counterpart starts.
+      const auto start = in_asLateAsPossible ? totalDuration - starts[blockIdx] - block.duration : starts[blockIdx];
+      for (size_t i = 0; i < block.pulses.size(); ++i) {
+        block.pulses[i]->setStart(start + block.offsets[i]);
+      }
+    }
+  }
+
+  std::vector<std::shared_ptr<xacc::Instruction>> enabledPulses(std::shared_ptr<xacc::CompositeInstruction> program) {
+    std::vector<std::shared_ptr<xacc::Instruction>> pulses;
+    xacc::InstructionIterator it(program);
+    while (it.hasNext()) {
+      auto nextInst = it.next();
+      if (nextInst->isEnabled() && !nextInst->isComposite()) {
+        pulses.emplace_back(nextInst);
+      }
+    }
+    return pulses;
+  }
+
+  // Shifts the measurement pulses of each channel so that the first ones
+  // all start at the latest first measurement start time.
+  void alignMeasurements(std::shared_ptr<xacc::CompositeInstruction> program) {
+    const auto measureKey = [](const std::shared_ptr<xacc::Instruction>& in_pulse) -> std::string {
+      if (in_pulse->name() == "acquire") {
+        const auto bits = in_pulse->bits();
+        return "acquire" + (bits.empty() ? std::string() : std::to_string(bits[0]));
+      }
+      const auto channel = in_pulse->channel();
+      return !channel.empty() && channel[0] == 'm' ? channel : "";
+    };
+
+    std::vector<std::pair<std::string, std::shared_ptr<xacc::Instruction>>> measurePulses;
+    std::unordered_map<std::string, std::size_t> firstStarts;
+    size_t alignedStart = 0;
+    for (auto& pulse : enabledPulses(program)) {
+      const auto key = measureKey(pulse);
+      if (!key.empty()) {
+        auto iter = firstStarts.find(key);
+        if (iter == firstStarts.end()) {
+          iter = firstStarts.emplace(key, pulse->start()).first;
+        }
+        iter->second = std::min(iter->second, pulse->start());
+        measurePulses.emplace_back(key, pulse);
+      }
+    }
+    for (const auto& kv : firstStarts) {
+      alignedStart = std::max(alignedStart, kv.second);
+    }
+    for (auto& [key, pulse] : measurePulses) {
+      pulse->setStart(pulse->start() + alignedStart - firstStarts[key]);
+    }
+  }
+
+  // Merges (adding the phases) consecutive frame changes at the same time on a channel, disabling all but the first one.
+  void coalesceFrameChanges(std::shared_ptr<xacc::CompositeInstruction> program) {
+    std::unordered_map<std::string, std::shared_ptr<xacc::Instruction>> lastPulses;
+    for (auto& pulse : enabledPulses(program)) {
+      auto& lastPulse = lastPulses[pulse->channel()];
+      if (lastPulse && lastPulse != pulse && pulse->name() == "fc" && lastPulse->name() == "fc" &&
+          lastPulse->start() == pulse->start() && lastPulse->getParameter(0).which() != 2 && pulse->getParameter(0).which() != 2) {
+        xacc::InstructionParameter phase(xacc::InstructionParameterToDouble(lastPulse->getParameter(0)) +
+                                         xacc::InstructionParameterToDouble(pulse->getParameter(0)));
+        lastPulse->setParameter(0, phase);
+        pulse->disable();
+        continue;
+      }
+      lastPulse = pulse;
+    }
   }
 }
 
@@ -69,10 +259,34 @@ namespace quantum {
 void PulseScheduler::schedule(std::shared_ptr<CompositeInstruction> program) {
 
   // Remember that sub-composites have timings relative to each other internally
-  std::map<std::string, std::size_t> channel2times;
+  std::unordered_map<std::string, std::size_t> channel2times;
+  std::size_t latestTime = 0;
   // Run the recursive scheduler, starting at this root composite at time 0:
-  processComposite(program, 0, channel2times);
+  processComposite(program, 0, channel2times, latestTime);
 }
 
+void PulseScheduler::schedule(std::shared_ptr<CompositeInstruction> program,
+                              const HeterogeneousMap &options) {
+  std::string policy = "sequential";
+  if (options.stringExists("policy")) {
+    policy = options.getString("policy");
+  }
+
+  if (policy == "sequential") {
+    schedule(program);
+  } else if (policy == "asap" || policy == "alap") {
+    scheduleBlocks(program, policy == "alap");
+  } else {
+    xacc::error("Invalid pulse scheduling policy '" + policy +
+                "'. Valid values are 'sequential', 'asap' and 'alap'.");
+  }
+
+  if (options.get_or_default("align-measurements", false)) {
+    alignMeasurements(program);
+  }
+  if (options.get_or_default("coalesce-frame-changes", false)) {
+    coalesceFrameChanges(program);
+  }
+}
+}
 }
-}
\ No newline at end of file
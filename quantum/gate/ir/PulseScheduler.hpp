@@ -17,9 +17,25 @@
 
 namespace xacc {
 namespace quantum {
+// Sets the start time of the pulses of a program, in a single pass tracking
+// the time at which each channel is free (linear in the number of pulses).
+// Options:
+//  - "policy" (string):
+//    "sequential" (default): each (nested) composite starts after all the
+//    pulses before it;
+//    "asap": each command def (composite of pulses, whose relative timing is
+//    kept) or raw pulse starts as soon as the channels and qubits it uses
+//    are free;
+//    "alap": as late as possible, i.e. "asap" on the reversed program.
+//  - "align-measurements" (bool, default false): the measurement (m channels)
+//    and acquire pulses of all the channels are shifted to start together.
+//  - "coalesce-frame-changes" (bool, default false): consecutive frame
+//    changes at the same time on a channel are merged into one.
 class PulseScheduler : public Scheduler {
 public:
   void schedule(std::shared_ptr<CompositeInstruction> program) override;
+  void schedule(std::shared_ptr<CompositeInstruction> program,
+                const HeterogeneousMap &options) override;
   const std::string name() const override {
 		return "pulse";
 	}
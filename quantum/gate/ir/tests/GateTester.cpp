@@ -315,6 +315,40 @@ TEST(GateFunctionTester, checkDepth) {
   auto g = f->toGraph();
 
   EXPECT_EQ(3, g->depth());
+  EXPECT_EQ(3, f->depth());
+}
+
+TEST(GateFunctionTester, checkLayers) {
+  auto f = std::make_shared<Circuit>("foo");
+  auto x = std::make_shared<X>(0);
+  auto h = std::make_shared<Hadamard>(1);
+  auto cn1 = std::make_shared<CNOT>(1, 2);
+  auto rz = std::make_shared<Rz>(1, 3.1415);
+  f->addInstructions({x, h, cn1});
+  EXPECT_EQ(2, f->depth());
+
+  // Maintained by addInstruction, nested circuits included
+  auto sub = std::make_shared<Circuit>("sub");
+  sub->addInstruction(rz);
+  sub->addInstruction(std::make_shared<Z>(2));
+  f->addInstruction(sub);
+  const auto &layers = f->layers();
+  ASSERT_EQ(3, layers.size());
+  EXPECT_EQ(2, layers[0].size());
+  EXPECT_EQ(cn1.get(), layers[1][0]);
+  EXPECT_EQ(2, layers[2].size());
+  EXPECT_EQ(rz.get(), layers[2][0]);
+
+  // Changes to the nested circuit and disabled gates
+  sub->addInstruction(std::make_shared<Hadamard>(1));
+  EXPECT_EQ(4, f->depth());
+  cn1->disable();
+  EXPECT_EQ(3, f->depth());
+  cn1->enable();
+  // No H on q1 before the CNOT
+  f->removeInstruction(1);
+  EXPECT_EQ(3, f->depth());
+  EXPECT_EQ(0, std::make_shared<Circuit>("empty")->depth());
 }
 
 TEST(GateFunctionTester, checkU3Eval) {
@@ -330,6 +364,123 @@ auto f = xacc::getCompiled("qubit2_depth1");
 auto ff = f->operator()({1.0, 1.0});
 std::cout << "F: " << ff->toString() << "\n";
 }
+
+TEST(GateFunctionTester, checkRepeatedEval) {
+  auto f = std::make_shared<Circuit>("foo", std::vector<std::string>{"t0", "t1"});
+  auto nested = std::make_shared<Circuit>("bar", std::vector<std::string>{"t0", "t1"});
+  nested->addInstruction(std::make_shared<Ry>(1, "t1"));
+  f->addInstruction(std::make_shared<Hadamard>(0));
+  f->addInstruction(std::make_shared<Rx>(0, "t0"));
+  f->addInstruction(std::make_shared<Rz>(0, "2*t0 + t1"));
+  f->addInstruction(nested);
+
+  for (auto x : {0.1, 0.2, 0.3}) {
+    auto evaled = f->operator()({x, 1.5});
+    EXPECT_EQ(4, evaled->nInstructions());
+    EXPECT_EQ("H", evaled->getInstruction(0)->name());
+    EXPECT_NEAR(x, evaled->getInstruction(1)->getParameter(0).as<double>(), 1e-12);
+    EXPECT_NEAR(2 * x + 1.5, evaled->getInstruction(2)->getParameter(0).as<double>(), 1e-12);
+    EXPECT_NEAR(1.5, evaled->getInstruction(3)->getParameter(0).as<double>(), 1e-12);
+  }
+
+  // Changes to nested circuits must be picked up
+  nested->addInstruction(std::make_shared<Rx>(1, "t0"));
+  auto evaled = f->operator()({0.5, 1.5});
+  EXPECT_EQ(5, evaled->nInstructions());
+  EXPECT_NEAR(0.5, evaled->getInstruction(4)->getParameter(0).as<double>(), 1e-12);
+
+  // As well as parameters updated in place
+  xacc::InstructionParameter p("t1");
+  f->getInstruction(1)->setParameter(0, p);
+  evaled = f->operator()({0.5, 1.5});
+  EXPECT_NEAR(1.5, evaled->getInstruction(1)->getParameter(0).as<double>(), 1e-12);
+}
+
+TEST(GateTester, checkGateArena) {
+  auto circuit = std::make_shared<Circuit>("arena");
+  for (std::size_t i = 0; i < 1000; ++i) {
+    circuit->addInstruction(std::make_shared<Rx>(i % 4, 0.1 * i));
+    circuit->addInstruction(std::make_shared<CNOT>(i % 4, (i + 1) % 4));
+  }
+  auto cloned = std::dynamic_pointer_cast<Circuit>(circuit->clone());
+  EXPECT_EQ(2000, cloned->nInstructions());
+  for (std::size_t i = 0; i < cloned->nInstructions(); ++i) {
+    EXPECT_EQ(circuit->getInstruction(i)->toString(),
+              cloned->getInstruction(i)->toString());
+  }
+
+  // Released blocks are recycled
+  const auto nbSlabs = GateArena::nbSlabs();
+  cloned.reset();
+  for (int i = 0; i < 10; ++i) {
+    auto tmp = circuit->clone();
+  }
+  EXPECT_EQ(nbSlabs, GateArena::nbSlabs());
+}
+
+TEST(GateTester, checkFlatView) {
+  auto nested = std::make_shared<Circuit>("nested");
+  nested->addInstruction(std::make_shared<Hadamard>(1));
+  auto circuit = std::make_shared<Circuit>("root");
+  circuit->addInstruction(std::make_shared<Hadamard>(0));
+  circuit->addInstruction(nested);
+  circuit->addInstruction(std::make_shared<CNOT>(0, 1));
+
+  const auto checkSequence = [&]() {
+    auto view = circuit->flatView();
+    xacc::InstructionIterator it(circuit);
+    size_t idx = 0;
+    while (it.hasNext()) {
+      ASSERT_LT(idx, view.size());
+      EXPECT_EQ(it.next().get(), view[idx++]);
+    }
+    EXPECT_EQ(idx, view.size());
+  };
+  checkSequence();
+  EXPECT_EQ(5, circuit->flatView().size());
+  // Cached
+  EXPECT_EQ(circuit->flatView().begin(), circuit->flatView().begin());
+
+  // Changes to nested circuits must be picked up
+  nested->addInstruction(std::make_shared<X>(0));
+  EXPECT_EQ(6, circuit->flatView().size());
+  checkSequence();
+  circuit->removeInstruction(0);
+  EXPECT_EQ(5, circuit->flatView().size());
+  checkSequence();
+}
+
+TEST(GateTester, checkInstructionsView) {
+  auto circuit = std::make_shared<Circuit>("view");
+  circuit->addInstruction(std::make_shared<Hadamard>(0));
+  circuit->addInstruction(std::make_shared<CNOT>(0, 1));
+  const auto &view = circuit->getInstructionsView();
+  const auto copy = circuit->getInstructions();
+  EXPECT_EQ(copy, view);
+  // No copy: reflects the changes
+  circuit->addInstruction(std::make_shared<X>(1));
+  EXPECT_EQ(3, view.size());
+  EXPECT_EQ("X", view[2]->name());
+}
+
+TEST(GateTester, checkOpcode) {
+  EXPECT_EQ(xacc::GateOpcode::H, Hadamard(0).opcode());
+  EXPECT_EQ(xacc::GateOpcode::CNOT, CNOT(0, 1).opcode());
+  EXPECT_EQ(xacc::GateOpcode::Rz, Rz(0, 0.5).opcode());
+  EXPECT_EQ(xacc::GateOpcode::Measure, Measure(0).opcode());
+  EXPECT_EQ(xacc::GateOpcode::I, Identity().opcode());
+  // Kept by the clones
+  EXPECT_EQ(xacc::GateOpcode::U, U(0, 0.1, 0.2, 0.3).clone()->opcode());
+  // Created by name
+  auto provider = xacc::getIRProvider("quantum");
+  EXPECT_EQ(xacc::GateOpcode::CNOT,
+            provider->createInstruction("CX", {0, 1})->opcode());
+  EXPECT_EQ(xacc::GateOpcode::Unknown,
+            provider->createInstruction("AnnealingInstruction", {0, 1})
+                ->opcode());
+  EXPECT_EQ(xacc::GateOpcode::Unknown, Circuit("foo").opcode());
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize();
   ::testing::InitGoogleTest(&argc, argv);
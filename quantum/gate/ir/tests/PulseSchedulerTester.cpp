@@ -20,6 +20,7 @@
 #include "xacc_service.hpp"
 #include "Utils.hpp"
 #include "Scheduler.hpp"
+#include "Pulse.hpp"
 
 
 namespace {
@@ -240,6 +241,61 @@ TEST(PulseSchedulerTester, checkComplexConstruct) {
   validateCompositeAfterScheduled(std::dynamic_pointer_cast<xacc::CompositeInstruction>(cx2), x1Duration + h1Duration + pulseInst1->duration() + cx1Duration + pulseInst2->duration(), cx2PulseSchedule);
 }
 
+TEST(PulseSchedulerTester, checkPolicies) {
+  const auto makePulse = [](const std::string& in_name, const std::string& in_channel, size_t in_duration, size_t in_qubit, double in_phase = 0.0) {
+    auto pulse = std::make_shared<xacc::quantum::Pulse>(in_name, in_channel, in_phase, std::vector<std::size_t>{in_qubit});
+    pulse->setDuration(in_duration);
+    return pulse;
+  };
+
+  const auto runScheduler = [&](const std::string& in_policy) {
+    auto provider = xacc::getIRProvider("quantum");
+    auto program = provider->createComposite("test_" + in_policy);
+    // Two command defs on disjoint channels and qubits, then measurements.
+    auto cmdDef0 = provider->createComposite("cmd_def_0");
+    auto fc0 = makePulse("fc", "d0", 0, 0, 0.1);
+    auto pulse0 = makePulse("pulse0", "d0", 10, 0);
+    cmdDef0->addInstructions({fc0, pulse0});
+    auto cmdDef1 = provider->createComposite("cmd_def_1");
+    auto pulse1 = makePulse("pulse1", "d1", 20, 1);
+    cmdDef1->addInstruction(pulse1);
+    auto fc1 = makePulse("fc", "d0", 0, 0, 0.2);
+    auto fc2 = makePulse("fc", "d0", 0, 0, 0.3);
+    auto measure = provider->createComposite("measure");
+    auto meas0 = makePulse("meas0", "m0", 8, 0);
+    auto meas1 = makePulse("meas1", "m1", 8, 1);
+    measure->addInstructions({meas0, meas1});
+    program->addInstructions({cmdDef0, cmdDef1, fc1, fc2, measure});
+
+    auto scheduler = xacc::getService<xacc::Scheduler>("pulse");
+    scheduler->schedule(program, {{"policy", in_policy}, {"align-measurements", true}, {"coalesce-frame-changes", true}});
+
+    // Measurements are aligned, after the pulses on their qubit.
+    EXPECT_EQ(meas0->start(), meas1->start());
+    EXPECT_GE(meas0->start(), fc2->start());
+    EXPECT_GE(meas1->start(), pulse1->start() + pulse1->duration());
+    // Frame changes at the same time on d0 are merged.
+    EXPECT_EQ(fc1->start(), pulse0->start() + pulse0->duration());
+    EXPECT_TRUE(fc1->isEnabled());
+    EXPECT_FALSE(fc2->isEnabled());
+    EXPECT_NEAR(fc1->getParameter(0).as<double>(), 0.5, 1e-12);
+    return std::make_pair(pulse0->start(), pulse1->start());
+  };
+
+  // Sequential: command defs one after the other.
+  const auto sequentialStarts = runScheduler("sequential");
+  EXPECT_EQ(sequentialStarts.first, 0);
+  EXPECT_EQ(sequentialStarts.second, 10);
+  // ASAP: command defs in parallel
+  const auto asapStarts = runScheduler("asap");
+  EXPECT_EQ(asapStarts.first, 0);
+  EXPECT_EQ(asapStarts.second, 0);
+  // ALAP: the shorter command def is pushed against the measurement.
+  const auto alapStarts = runScheduler("alap");
+  EXPECT_EQ(alapStarts.first, 10);
+  EXPECT_EQ(alapStarts.second, 0);
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize();
   ::testing::InitGoogleTest(&argc, argv);
@@ -19,6 +19,7 @@
 #include "xacc_config.hpp"
 #include "xacc_service.hpp"
 #include "Utils.hpp"
+#include "Pulse.hpp"
 
 TEST(PulseTester, checkBasic) {
   // TODO load from json file prototypical pulses and cmd_defs...
@@ -90,6 +91,20 @@ TEST(PulseTester, checkBasic) {
     }
   }
 }
+TEST(PulseTester, checkSharedSamples) {
+  auto pulse = std::make_shared<xacc::quantum::Pulse>("gaussian", "d0");
+  const std::vector<std::vector<double>> samples{{0.1, 0.0}, {0.2, 0.1}};
+  pulse->setSamples(samples);
+  auto copy = pulse->clone();
+  EXPECT_EQ(samples, copy->getSamples());
+  EXPECT_EQ(2, copy->duration());
+  // Setting the samples of a copy doesn't change the original
+  copy->setSamples({{0.3, 0.0}});
+  EXPECT_EQ(1, copy->duration());
+  EXPECT_EQ(samples, pulse->getSamples());
+  EXPECT_TRUE(xacc::quantum::Pulse("fc").getSamples().empty());
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize();
   ::testing::InitGoogleTest(&argc, argv);
@@ -162,6 +162,9 @@ public:
   }
 
   std::vector<InstPtr> getInstructions() override { return instructions; }
+  const std::vector<InstPtr> &getInstructionsView() override {
+    return instructions;
+  }
   void removeInstruction(const std::size_t idx) override {
     validateInstructionIndex(idx);
     instructions.erase(instructions.begin() + idx);
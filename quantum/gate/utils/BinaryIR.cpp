@@ -0,0 +1,402 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "BinaryIR.hpp"
+#include "Circuit.hpp"
+#include "CommonGates.hpp"
+#include "GateArena.hpp"
+#include "xacc.hpp"
+#include "xacc_service.hpp"
+#include <cstring>
+#include <sstream>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+using namespace xacc;
+using namespace xacc::quantum;
+
+constexpr char Magic[] = "XACCIR";
+constexpr std::size_t MagicSize = sizeof(Magic) - 1;
+constexpr uint8_t Version = 1;
+
+// Record opcodes, the common gates follow.
+constexpr uint8_t CompositeOpcode = 0;
+constexpr uint8_t NamedOpcode = 1;
+constexpr uint8_t FirstGateOpcode = 2;
+
+enum ParameterTag : uint8_t { IntParam = 0, DoubleParam = 1, StringParam = 2 };
+
+struct GateEntry {
+  const char *name;
+  std::shared_ptr<Gate> (*create)();
+};
+
+template <typename GateT> std::shared_ptr<Gate> createGate() {
+  return makeGate<GateT>();
+}
+
+// Append only: the index of a gate is its opcode (minus FirstGateOpcode).
+const GateEntry GateTable[] = {
+    {"I", &createGate<Identity>},     {"H", &createGate<Hadamard>},
+    {"CNOT", &createGate<CNOT>},      {"U1", &createGate<U1>},
+    {"Rx", &createGate<Rx>},          {"Ry", &createGate<Ry>},
+    {"Rz", &createGate<Rz>},          {"Swap", &createGate<Swap>},
+    {"U", &createGate<U>},            {"X", &createGate<X>},
+    {"Y", &createGate<Y>},            {"Z", &createGate<Z>},
+    {"Measure", &createGate<Measure>}, {"CZ", &createGate<CZ>},
+    {"CPhase", &createGate<CPhase>},  {"XY", &createGate<XY>},
+    {"S", &createGate<S>},            {"Sdg", &createGate<Sdg>},
+    {"T", &createGate<T>},            {"Tdg", &createGate<Tdg>},
+    {"CY", &createGate<CY>},          {"CH", &createGate<CH>},
+    {"CRZ", &createGate<CRZ>},        {"Reset", &createGate<Reset>},
+    {"iSwap", &createGate<iSwap>},    {"fSim", &createGate<fSim>}};
+constexpr std::size_t NbGates = sizeof(GateTable) / sizeof(GateTable[0]);
+
+uint8_t getOpcode(const std::string &in_name) {
+  static const std::unordered_map<std::string, uint8_t> opcodes = [] {
+    std::unordered_map<std::string, uint8_t> result;
+    for (std::size_t i = 0; i < NbGates; ++i) {
+      result.emplace(GateTable[i].name, FirstGateOpcode + i);
+    }
+    return result;
+  }();
+  auto iter = opcodes.find(in_name);
+  return iter == opcodes.end() ? NamedOpcode : iter->second;
+}
+
+class Writer {
+public:
+  void writeComposite(CompositeInstruction &in_composite) {
+    m_body.push_back(CompositeOpcode);
+    writeString(in_composite.name());
+    const auto vars = in_composite.getVariables();
+    writeVarint(vars.size());
+    for (const auto &var : vars) {
+      writeString(var);
+    }
+    const auto coeff = in_composite.getCoefficient();
+    writeDouble(coeff.real());
+    writeDouble(coeff.imag());
+    writeString(in_composite.accelerator_signature());
+
+    const auto &instructions = in_composite.getInstructionsView();
+    writeVarint(instructions.size());
+    for (const auto &inst : instructions) {
+      if (inst->isComposite()) {
+        if (inst->name() == "ifstmt") {
+          xacc::error("[BinaryIR] Conditional instructions cannot be "
+                      "serialized.");
+        }
+        writeComposite(*std::dynamic_pointer_cast<CompositeInstruction>(inst));
+      } else {
+        writeInstruction(*inst);
+      }
+    }
+  }
+
+  void write(std::ostream &out_stream) const {
+    std::string header(Magic, MagicSize);
+    header.push_back(Version);
+    header.push_back(0);
+    Writer table;
+    table.writeVarint(m_strings.size());
+    for (const auto *str : m_strings) {
+      table.writeVarint(str->size());
+      table.m_body.append(*str);
+    }
+    out_stream << header << table.m_body << m_body;
+  }
+
+private:
+  void writeInstruction(Instruction &in_inst) {
+    if (in_inst.isAnalog()) {
+      xacc::error("[BinaryIR] Analog instructions cannot be serialized: " +
+                  in_inst.name() + ".");
+    }
+    const auto opcode = getOpcode(in_inst.name());
+    m_body.push_back(opcode);
+    if (opcode == NamedOpcode) {
+      writeString(in_inst.name());
+    }
+    m_body.push_back(in_inst.isEnabled() ? 1 : 0);
+    const auto bits = in_inst.bits();
+    writeVarint(bits.size());
+    for (const auto bit : bits) {
+      writeVarint(bit);
+    }
+    const auto bufferNames = in_inst.getBufferNames();
+    writeVarint(bufferNames.size());
+    for (const auto &bufferName : bufferNames) {
+      writeString(bufferName);
+    }
+    const auto params = in_inst.getParameters();
+    writeVarint(params.size());
+    for (const auto &param : params) {
+      switch (param.which()) {
+      case 0:
+        m_body.push_back(IntParam);
+        // Zigzag, small negative values stay short.
+        writeVarint((static_cast<uint64_t>(param.as<int>()) << 1) ^
+                    static_cast<uint64_t>(param.as<int>() < 0 ? -1 : 0));
+        break;
+      case 1:
+        m_body.push_back(DoubleParam);
+        writeDouble(param.as<double>());
+        break;
+      default:
+        m_body.push_back(StringParam);
+        writeString(param.as<std::string>());
+      }
+    }
+  }
+
+  void writeVarint(uint64_t in_value) {
+    while (in_value >= 0x80) {
+      m_body.push_back(static_cast<char>((in_value & 0x7F) | 0x80));
+      in_value >>= 7;
+    }
+    m_body.push_back(static_cast<char>(in_value));
+  }
+  void writeDouble(double in_value) {
+    uint64_t bits;
+    std::memcpy(&bits, &in_value, sizeof(bits));
+    for (int i = 0; i < 8; ++i) {
+      m_body.push_back(static_cast<char>(bits >> (8 * i)));
+    }
+  }
+  void writeString(const std::string &in_str) {
+    auto iter = m_stringIds.find(in_str);
+    if (iter == m_stringIds.end()) {
+      iter = m_stringIds.emplace(in_str, m_strings.size()).first;
+      m_strings.push_back(&iter->first);
+    }
+    writeVarint(iter->second);
+  }
+
+  std::string m_body;
+  std::unordered_map<std::string, std::size_t> m_stringIds;
+  // Keys of m_stringIds (stable in a node-based map), by id
+  std::vector<const std::string *> m_strings;
+};
+
+class Reader {
+public:
+  Reader(const char *in_data, std::size_t in_size)
+      : m_pos(in_data), m_end(in_data + in_size) {}
+
+  std::shared_ptr<CompositeInstruction> read() {
+    if (static_cast<std::size_t>(m_end - m_pos) < MagicSize + 2 ||
+        std::memcmp(m_pos, Magic, MagicSize) != 0) {
+      xacc::error("[BinaryIR] Not a binary XACC IR.");
+      return nullptr;
+    }
+    m_pos += MagicSize;
+    if (static_cast<uint8_t>(*m_pos) != Version) {
+      xacc::error("[BinaryIR] Unsupported binary XACC IR version: " +
+                  std::to_string(static_cast<uint8_t>(*m_pos)) + ".");
+      return nullptr;
+    }
+    m_pos += 2;
+
+    const auto nbStrings = readCount();
+    m_strings.reserve(nbStrings);
+    for (std::size_t i = 0; i < nbStrings; ++i) {
+      const auto size = readCount();
+      m_strings.emplace_back(m_pos, size);
+      m_pos += size;
+    }
+
+    if (readByte() != CompositeOpcode) {
+      corrupted();
+    }
+    auto composite = readComposite();
+    if (m_pos != m_end) {
+      corrupted();
+    }
+    return composite;
+  }
+
+private:
+  std::shared_ptr<CompositeInstruction> readComposite() {
+    const auto name = readString();
+    std::vector<std::string> vars(readCount());
+    for (auto &var : vars) {
+      var = readString();
+    }
+    auto composite = std::make_shared<Circuit>(name, std::move(vars));
+    const double real = readDouble();
+    const double imag = readDouble();
+    composite->setCoefficient({real, imag});
+    composite->set_accelerator_signature(readString());
+
+    std::vector<InstPtr> instructions(readCount());
+    for (auto &inst : instructions) {
+      const auto opcode = readByte();
+      if (opcode == CompositeOpcode) {
+        inst = readComposite();
+      } else {
+        inst = readInstruction(opcode);
+      }
+    }
+    // Validated when serialized
+    composite->addInstructions(std::move(instructions), false);
+    return composite;
+  }
+
+  InstPtr readInstruction(uint8_t in_opcode) {
+    std::string name;
+    if (in_opcode == NamedOpcode) {
+      name = readString();
+    } else if (in_opcode - FirstGateOpcode >= NbGates) {
+      corrupted();
+    }
+    const bool enabled = readByte() != 0;
+    std::vector<std::size_t> bits(readCount());
+    for (auto &bit : bits) {
+      bit = readVarint();
+    }
+    std::vector<std::string> bufferNames(readCount());
+    for (auto &bufferName : bufferNames) {
+      bufferName = readString();
+    }
+    const auto nbParams = readCount();
+    std::vector<InstructionParameter> params;
+    params.reserve(nbParams);
+    for (std::size_t i = 0; i < nbParams; ++i) {
+      switch (readByte()) {
+      case IntParam: {
+        const auto zigzag = readVarint();
+        params.emplace_back(static_cast<int>((zigzag >> 1) ^ -(zigzag & 1)));
+        break;
+      }
+      case DoubleParam:
+        params.emplace_back(readDouble());
+        break;
+      case StringParam:
+        params.emplace_back(readString());
+        break;
+      default:
+        corrupted();
+      }
+    }
+
+    InstPtr inst;
+    if (in_opcode == NamedOpcode) {
+      if (!m_provider) {
+        m_provider = xacc::getService<IRProvider>("quantum");
+      }
+      inst = m_provider->createInstruction(name, bits, params);
+    } else {
+      inst = GateTable[in_opcode - FirstGateOpcode].create();
+      if (static_cast<std::size_t>(inst->nParameters()) != params.size()) {
+        corrupted();
+      }
+      inst->setBits(bits);
+      for (std::size_t i = 0; i < params.size(); ++i) {
+        inst->setParameter(i, params[i]);
+      }
+    }
+    if (!bufferNames.empty()) {
+      inst->setBufferNames(bufferNames);
+    }
+    if (!enabled) {
+      inst->disable();
+    }
+    return inst;
+  }
+
+  // Counts of elements of at least one byte each, i.e. bounded by the size.
+  std::size_t readCount() {
+    const auto value = readVarint();
+    if (value > static_cast<uint64_t>(m_end - m_pos)) {
+      corrupted();
+    }
+    return value;
+  }
+  uint8_t readByte() {
+    if (m_pos == m_end) {
+      corrupted();
+    }
+    return static_cast<uint8_t>(*m_pos++);
+  }
+  uint64_t readVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      const auto byte = readByte();
+      value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if (!(byte & 0x80)) {
+        return value;
+      }
+    }
+    corrupted();
+    return value;
+  }
+  double readDouble() {
+    if (m_end - m_pos < 8) {
+      corrupted();
+    }
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; ++i) {
+      bits |= static_cast<uint64_t>(static_cast<uint8_t>(m_pos[i])) << (8 * i);
+    }
+    m_pos += 8;
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+  std::string readString() {
+    const auto id = readVarint();
+    if (id >= m_strings.size()) {
+      corrupted();
+    }
+    return std::string(m_strings[id]);
+  }
+  [[noreturn]] void corrupted() {
+    xacc::error("[BinaryIR] Truncated or corrupted binary XACC IR.");
+    std::abort();
+  }
+
+  const char *m_pos;
+  const char *m_end;
+  // Views of the input
+  std::vector<std::string_view> m_strings;
+  std::shared_ptr<IRProvider> m_provider;
+};
+} // namespace
+
+namespace xacc {
+namespace quantum {
+std::string
+toBinary(const std::shared_ptr<CompositeInstruction> &in_composite) {
+  std::stringstream ss;
+  writeBinary(in_composite, ss);
+  return ss.str();
+}
+
+void writeBinary(const std::shared_ptr<CompositeInstruction> &in_composite,
+                 std::ostream &out_stream) {
+  Writer writer;
+  writer.writeComposite(*in_composite);
+  writer.write(out_stream);
+}
+
+std::shared_ptr<CompositeInstruction> fromBinary(const char *in_data,
+                                                 std::size_t in_size) {
+  return Reader(in_data, in_size).read();
+}
+
+std::shared_ptr<CompositeInstruction> fromBinary(const std::string &in_data) {
+  return fromBinary(in_data.data(), in_data.size());
+}
+} // namespace quantum
+} // namespace xacc
@@ -0,0 +1,49 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+
+namespace xacc {
+class CompositeInstruction;
+namespace quantum {
+// Compact binary form of a circuit (CompositeInstruction tree), loaded back
+// without compiling, e.g. to cache or checkpoint compiled circuits, or to send
+// them to other processes.
+//
+// Layout (integers are LEB128 varints unless stated otherwise):
+//   "XACCIR" + version byte + reserved byte
+//   string table: count, then (length, bytes) for each string
+//   root composite record
+// A record starts with an opcode byte: a composite, an instruction looked up
+// by name, or one of the common gates. Composites have their name, variables,
+// coefficient (2 raw little-endian doubles), accelerator signature and child
+// records. Instructions have an enabled flag, bits, buffer names and
+// parameters (tagged int, raw double or string). Names, buffer names and
+// string parameters are indices into the string table.
+//
+// Conditional (ifstmt) and analog instructions are not supported.
+std::string toBinary(const std::shared_ptr<CompositeInstruction> &in_composite);
+void writeBinary(const std::shared_ptr<CompositeInstruction> &in_composite,
+                 std::ostream &out_stream);
+
+// Builds the circuit encoded in [in_data, in_data + in_size). The bytes are
+// decoded in place, e.g. from a memory-mapped file, and only need to remain
+// valid during the call.
+std::shared_ptr<CompositeInstruction> fromBinary(const char *in_data,
+                                                 std::size_t in_size);
+std::shared_ptr<CompositeInstruction> fromBinary(const std::string &in_data);
+} // namespace quantum
+} // namespace xacc
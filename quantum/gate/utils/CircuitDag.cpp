@@ -0,0 +1,135 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "CircuitDag.hpp"
+#include "CompositeInstruction.hpp"
+#include "xacc.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace xacc {
+namespace quantum {
+CircuitDag::CircuitDag(
+    const std::shared_ptr<CompositeInstruction> &in_circuit) {
+  size_t nbQubits = 0;
+  for (auto *inst : in_circuit->flatView()) {
+    for (const auto &bit : inst->bits()) {
+      nbQubits = std::max(nbQubits, bit + 1);
+    }
+  }
+  m_first.assign(nbQubits, NONE);
+  m_last.assign(nbQubits, NONE);
+
+  for (const auto &inst : in_circuit->getInstructionsView()) {
+    if (!inst->isEnabled()) {
+      continue;
+    }
+    const NodeId id = m_nodes.size();
+    Node node;
+    node.inst = inst;
+    if (!inst->isComposite()) {
+      node.wires = inst->bits();
+    }
+    if (node.wires.empty()) {
+      node.wires.resize(nbQubits);
+      std::iota(node.wires.begin(), node.wires.end(), 0);
+    }
+    node.next.assign(node.wires.size(), NONE);
+    for (const auto &qubit : node.wires) {
+      const auto previous = m_last[qubit];
+      node.prev.emplace_back(previous);
+      if (previous == NONE) {
+        m_first[qubit] = id;
+      } else {
+        m_nodes[previous].next[wireIndex(previous, qubit)] = id;
+      }
+      m_last[qubit] = id;
+    }
+    m_nodes.emplace_back(std::move(node));
+  }
+}
+
+size_t CircuitDag::wireIndex(NodeId in_node, size_t in_qubit) const {
+  const auto &wires = m_nodes[in_node].wires;
+  const auto iter = std::find(wires.begin(), wires.end(), in_qubit);
+  if (iter == wires.end()) {
+    xacc::error("CircuitDag: qubit " + std::to_string(in_qubit) +
+                " is not a wire of node " + std::to_string(in_node));
+  }
+  return std::distance(wires.begin(), iter);
+}
+
+CircuitDag::NodeId CircuitDag::next(NodeId in_node, size_t in_qubit) const {
+  return m_nodes[in_node].next[wireIndex(in_node, in_qubit)];
+}
+
+CircuitDag::NodeId CircuitDag::prev(NodeId in_node, size_t in_qubit) const {
+  return m_nodes[in_node].prev[wireIndex(in_node, in_qubit)];
+}
+
+CircuitDag::NodeId CircuitDag::commonSuccessor(NodeId in_node) const {
+  const auto &next = m_nodes[in_node].next;
+  if (next.empty() || next[0] == NONE ||
+      std::any_of(next.begin(), next.end(),
+                  [&](NodeId id) { return id != next[0]; })) {
+    return NONE;
+  }
+  return next[0];
+}
+
+void CircuitDag::remove(NodeId in_node) {
+  auto &node = m_nodes[in_node];
+  if (node.removed) {
+    return;
+  }
+  for (size_t i = 0; i < node.wires.size(); ++i) {
+    const auto qubit = node.wires[i];
+    const auto previous = node.prev[i];
+    const auto following = node.next[i];
+    if (previous == NONE) {
+      m_first[qubit] = following;
+    } else {
+      m_nodes[previous].next[wireIndex(previous, qubit)] = following;
+    }
+    if (following == NONE) {
+      m_last[qubit] = previous;
+    } else {
+      m_nodes[following].prev[wireIndex(following, qubit)] = previous;
+    }
+  }
+  node.removed = true;
+}
+
+void CircuitDag::replace(NodeId in_node, std::shared_ptr<Instruction> in_inst) {
+  auto &node = m_nodes[in_node];
+  if (!node.inst->isComposite() && in_inst->bits() != node.inst->bits()) {
+    xacc::error("CircuitDag: the replacement of " + node.inst->name() +
+                " must act on the same qubits.");
+  }
+  node.inst = std::move(in_inst);
+}
+
+void CircuitDag::toCircuit(
+    const std::shared_ptr<CompositeInstruction> &io_circuit) const {
+  std::vector<std::shared_ptr<Instruction>> instructions;
+  instructions.reserve(m_nodes.size());
+  for (const auto &node : m_nodes) {
+    if (!node.removed) {
+      instructions.emplace_back(node.inst);
+    }
+  }
+  io_circuit->clear();
+  // The original (validated) children or their replacements.
+  io_circuit->addInstructions(std::move(instructions), false);
+}
+} // namespace quantum
+} // namespace xacc
@@ -0,0 +1,82 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace xacc {
+class CompositeInstruction;
+class Instruction;
+namespace quantum {
+// Mutable dependency graph (DAG) of a circuit.
+// Each enabled child instruction of the circuit is a node, linked to its
+// predecessor and successor on each of its qubit wires. Removing or replacing
+// a node only relinks its wires, hence peephole passes can rewrite a circuit
+// to a fixed point without rebuilding a graph after each rewrite; the result
+// is written back with toCircuit().
+// Nested composites (and instructions without qubits) act as barriers on all
+// the wires.
+class CircuitDag {
+public:
+  using NodeId = size_t;
+  static constexpr NodeId NONE = static_cast<NodeId>(-1);
+
+  explicit CircuitDag(const std::shared_ptr<CompositeInstruction> &in_circuit);
+
+  // Node ids are [0, nbNodes()), in circuit order; removed nodes keep theirs.
+  size_t nbNodes() const { return m_nodes.size(); }
+  size_t nbQubits() const { return m_first.size(); }
+  bool isRemoved(NodeId in_node) const { return m_nodes[in_node].removed; }
+  const std::shared_ptr<Instruction> &instruction(NodeId in_node) const {
+    return m_nodes[in_node].inst;
+  }
+  const std::vector<size_t> &wires(NodeId in_node) const {
+    return m_nodes[in_node].wires;
+  }
+
+  // Neighbors of a node on one of its wires (NONE at the wire ends)
+  NodeId next(NodeId in_node, size_t in_qubit) const;
+  NodeId prev(NodeId in_node, size_t in_qubit) const;
+  // First and last nodes on a wire (NONE if the wire is empty)
+  NodeId first(size_t in_qubit) const { return m_first[in_qubit]; }
+  NodeId last(size_t in_qubit) const { return m_last[in_qubit]; }
+  // The successor of the node if it is the same on all its wires, else NONE.
+  NodeId commonSuccessor(NodeId in_node) const;
+
+  void remove(NodeId in_node);
+  // Replace the instruction of a node, the new one must act on the same
+  // qubits.
+  void replace(NodeId in_node, std::shared_ptr<Instruction> in_inst);
+
+  // Replace the children of the circuit by the remaining instructions
+  // (in their original order).
+  void toCircuit(const std::shared_ptr<CompositeInstruction> &io_circuit) const;
+
+private:
+  struct Node {
+    std::shared_ptr<Instruction> inst;
+    std::vector<size_t> wires;
+    // Per wire (same index as in wires)
+    std::vector<NodeId> prev;
+    std::vector<NodeId> next;
+    bool removed = false;
+  };
+  size_t wireIndex(NodeId in_node, size_t in_qubit) const;
+
+  std::vector<Node> m_nodes;
+  std::vector<NodeId> m_first;
+  std::vector<NodeId> m_last;
+};
+} // namespace quantum
+} // namespace xacc
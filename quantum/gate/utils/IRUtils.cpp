@@ -16,7 +16,9 @@
 #include "InstructionIterator.hpp"
 #include "xacc_service.hpp"
 #include "IRProvider.hpp"
+#include <algorithm>
 #include <cassert>
+#include <limits>
 namespace {
 // Computes the base length of a Composite:
 // i.e. not include measure gates.
@@ -27,7 +29,7 @@ getBaseLength(const std::shared_ptr<xacc::CompositeInstruction> &in_composite) {
   while (it.hasNext()) {
     auto nextInst = it.next();
     if (nextInst->isEnabled() && !nextInst->isComposite()) {
-      if (nextInst->name() == "Measure") {
+      if (nextInst->opcode() == xacc::GateOpcode::Measure) {
         return length;
       }
       length++;
@@ -36,15 +38,45 @@ getBaseLength(const std::shared_ptr<xacc::CompositeInstruction> &in_composite) {
   return length;
 }
 
-bool compareInst(xacc::InstPtr in_a, xacc::InstPtr in_b) {
+bool compareInst(
+    xacc::InstPtr in_a, xacc::InstPtr in_b,
+    xacc::ParameterHashMode in_mode = xacc::ParameterHashMode::Numeric) {
   if (!in_a || !in_b) {
     return false;
   }
   // We should only compare elementary instructions.
   assert(!in_a->isComposite() && !in_b->isComposite());
   assert(in_a->isEnabled() && in_b->isEnabled());
-  return (in_a->name() == in_b->name()) && (in_a->bits() == in_b->bits()) &&
-         (in_a->getParameters() == in_b->getParameters());
+  if ((in_a->name() != in_b->name()) || (in_a->bits() != in_b->bits())) {
+    return false;
+  }
+  const auto params_a = in_a->getParameters();
+  const auto params_b = in_b->getParameters();
+  if (params_a.size() != params_b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < params_a.size(); ++i) {
+    if (in_mode == xacc::ParameterHashMode::Symbolic) {
+      // Any numeric value matches, symbolic parameters must be the same.
+      xacc::StructuralHasher hash_a, hash_b;
+      xacc::hashInstructionParameter(hash_a, params_a[i], in_mode);
+      xacc::hashInstructionParameter(hash_b, params_b[i], in_mode);
+      if (hash_a.value() != hash_b.value()) {
+        return false;
+      }
+      continue;
+    }
+    // Compare angles exactly, InstructionParameter::operator== only
+    // compares the string representation (6 significant digits).
+    if (params_a[i].which() == 1 && params_b[i].which() == 1) {
+      if (params_a[i].as<double>() != params_b[i].as<double>()) {
+        return false;
+      }
+    } else if (params_a[i] != params_b[i]) {
+      return false;
+    }
+  }
+  return true;
 }
 // Helper to pop the instruction stack (so that we can walk both trees
 // simultaneously)
@@ -57,9 +89,42 @@ xacc::InstPtr getNextInstruction(xacc::InstructionIterator &iter) {
   }
   return nullptr;
 }
+
+// Enabled, non-composite instructions of a circuit
+std::vector<xacc::InstPtr>
+flattenInstructions(const std::shared_ptr<xacc::CompositeInstruction> &in_composite) {
+  std::vector<xacc::InstPtr> result;
+  xacc::InstructionIterator it(in_composite);
+  while (it.hasNext()) {
+    auto nextInst = it.next();
+    if (nextInst->isEnabled() && !nextInst->isComposite()) {
+      result.emplace_back(nextInst);
+    }
+  }
+  return result;
+}
 } // namespace
 namespace xacc {
 namespace quantum {
+bool structurallyEqual(const std::shared_ptr<CompositeInstruction> &in_a,
+                       const std::shared_ptr<CompositeInstruction> &in_b,
+                       ParameterHashMode in_mode) {
+  if (in_a->structuralHash(in_mode) != in_b->structuralHash(in_mode)) {
+    return false;
+  }
+  const auto instructions_a = flattenInstructions(in_a);
+  const auto instructions_b = flattenInstructions(in_b);
+  if (instructions_a.size() != instructions_b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < instructions_a.size(); ++i) {
+    if (!compareInst(instructions_a[i], instructions_b[i], in_mode)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 ObservedAnsatz ObservedAnsatz::fromObservedComposites(
     const std::vector<std::shared_ptr<CompositeInstruction>> &in_composites) {
   auto gateRegistry = xacc::getService<xacc::IRProvider>("quantum");
@@ -75,119 +140,68 @@ ObservedAnsatz ObservedAnsatz::fromObservedComposites(
     return result;
   }
 
-  std::shared_ptr<CompositeInstruction> shortestComposite = in_composites[0];
-  // Find the shortest composite (not include the measure part)
-  for (size_t i = 1; i < in_composites.size(); ++i) {
-    if (getBaseLength(in_composites[i]) < getBaseLength(shortestComposite)) {
-      shortestComposite = in_composites[i];
+  // Flattened gates of each circuit and the hashes of their prefixes,
+  // up to the shortest base (i.e. before the first Measure).
+  std::vector<std::vector<InstPtr>> flattened;
+  size_t maxBaseLength = std::numeric_limits<size_t>::max();
+  for (const auto &composite : in_composites) {
+    flattened.emplace_back(flattenInstructions(composite));
+    maxBaseLength = std::min(maxBaseLength, getBaseLength(composite));
+  }
+  std::vector<std::vector<uint64_t>> prefixHashes;
+  for (const auto &instructions : flattened) {
+    std::vector<uint64_t> hashes{0};
+    StructuralHasher hasher;
+    for (size_t k = 0; k < maxBaseLength; ++k) {
+      hasher.add<uint64_t>(instructions[k]->structuralHash());
+      hashes.emplace_back(hasher.value());
     }
+    prefixHashes.emplace_back(std::move(hashes));
   }
 
-  InstructionIterator it(shortestComposite);
-  while (it.hasNext()) {
-    auto nextInst = it.next();
-    if (nextInst->isEnabled() && !nextInst->isComposite()) {
-      if (nextInst->name() == "Measure") {
-        break;
+  // Longest common prefix (at least 2 gates): compare the prefix hashes,
+  // then verify the gates of the candidate exactly.
+  const auto isCommonPrefix = [&](size_t in_length) {
+    for (size_t i = 1; i < flattened.size(); ++i) {
+      if (prefixHashes[i][in_length] != prefixHashes[0][in_length]) {
+        return false;
       }
-      baseComposite->addInstruction(nextInst->clone());
-    }
-  }
-
-  // Check if a composite is the base of the other
-  const auto isBaseOf =
-      [](const std::shared_ptr<CompositeInstruction> &in_base,
-         const std::shared_ptr<CompositeInstruction> &in_toTest,
-         InstructionIterator &out_Iter) {
-        assert(getBaseLength(in_base) <= getBaseLength(in_toTest));
-        bool result = true;
-        InstructionIterator baseIt(in_base);
-        InstructionIterator otherIter(in_toTest);
-        while (baseIt.hasNext()) {
-          auto nextInst = baseIt.next();
-          if (nextInst->isEnabled() && !nextInst->isComposite()) {
-            // Pop the other iter as well
-            auto otherInstr = getNextInstruction(otherIter);
-            if (!compareInst(nextInst, otherInstr)) {
-              return false;
-            }
-            out_Iter = otherIter;
-          }
-        }
-        return result;
-      };
-
-  const std::function<InstPtr(std::shared_ptr<CompositeInstruction>)>
-      getLastInstr =
-          [&](std::shared_ptr<CompositeInstruction> composite) -> InstPtr {
-    auto instructions = composite->getInstructions();
-    for (auto rIter = instructions.rbegin(); rIter != instructions.rend();
-         ++rIter) {
-      if ((*rIter)->isEnabled()) {
-        if (!(*rIter)->isComposite()) {
-          return (*rIter);
-        } else {
-          std::shared_ptr<CompositeInstruction> compositeCast =
-              std::dynamic_pointer_cast<CompositeInstruction>(*rIter);
-          return getLastInstr(compositeCast);
+    }
+    for (size_t i = 1; i < flattened.size(); ++i) {
+      for (size_t k = 0; k < in_length; ++k) {
+        if (!compareInst(flattened[0][k], flattened[i][k])) {
+          return false;
         }
-        return (*rIter);
       }
     }
-    return nullptr;
+    return true;
   };
 
-  // Cache of the iterators during matching
-  std::vector<InstructionIterator> matchedIters;
-  while (getBaseLength(baseComposite) > 1) {
-    bool allMatched = true;
-    matchedIters.clear();
-    for (const auto &compositeToTest : in_composites) {
-      InstructionIterator compIter(compositeToTest);
-      if (!isBaseOf(baseComposite, compositeToTest, compIter)) {
-        // Remove the last instruction of base and re-check
-        auto lastInst = getLastInstr(baseComposite);
-        if (lastInst) {
-          lastInst->disable();
-          baseComposite->removeDisabled();
-        } else {
-          baseComposite->clear();
-        }
-        allMatched = false;
-        break;
-      }
-      matchedIters.emplace_back(compIter);
-    }
-
-    if (allMatched) {
-      assert(matchedIters.size() == in_composites.size());
-      std::vector<std::shared_ptr<CompositeInstruction>> subCircuits;
-      for (size_t i = 0; i < in_composites.size(); ++i) {
-        auto comp = in_composites[i];
-        auto iter = matchedIters[i];
-        auto newComp =
-            // IMPORTANT: the sub-circuit must keep the same name as the
-            // composite since downstream mapping depends on this.
-            gateRegistry->createComposite(comp->name());
-        // Add the remaining instructions
-        while (iter.hasNext()) {
-
-          auto nextInst = iter.next();
-
-          if (nextInst->isEnabled() && !nextInst->isComposite()) {
-            newComp->addInstruction(nextInst->clone());
-          }
-        }
-        subCircuits.emplace_back(newComp);
+  for (size_t length = maxBaseLength; length > 1; --length) {
+    if (!isCommonPrefix(length)) {
+      continue;
+    }
+    for (size_t k = 0; k < length; ++k) {
+      baseComposite->addInstruction(flattened[0][k]->clone());
+    }
+    std::vector<std::shared_ptr<CompositeInstruction>> subCircuits;
+    for (size_t i = 0; i < in_composites.size(); ++i) {
+      auto newComp =
+          // IMPORTANT: the sub-circuit must keep the same name as the
+          // composite since downstream mapping depends on this.
+          gateRegistry->createComposite(in_composites[i]->name());
+      // Add the remaining instructions
+      for (size_t k = length; k < flattened[i].size(); ++k) {
+        newComp->addInstruction(flattened[i][k]->clone());
       }
-      result.m_baseAnsatz = baseComposite;
-      result.m_obsCircuits = subCircuits;
-      return result;
+      subCircuits.emplace_back(newComp);
     }
+    result.m_baseAnsatz = baseComposite;
+    result.m_obsCircuits = subCircuits;
+    return result;
   }
 
   // These circuits have no relationship:
-  baseComposite->clear();
   // Returns an empty base and all input composites as individual circuits.
   result.m_baseAnsatz = baseComposite;
   result.m_obsCircuits = in_composites;
@@ -234,5 +248,64 @@ bool ObservedAnsatz::validate(
   }
   return true;
 }
+
+PrefixSharedBatch PrefixSharedBatch::fromComposites(
+    const std::vector<std::shared_ptr<CompositeInstruction>> &in_composites,
+    size_t in_maxCheckpoints) {
+  PrefixSharedBatch result;
+  for (const auto &composite : in_composites) {
+    result.m_instructions.emplace_back(flattenInstructions(composite));
+  }
+
+  result.m_startCheckpoints.assign(in_composites.size(), -1);
+  if (in_composites.empty() || in_maxCheckpoints == 0) {
+    return result;
+  }
+
+  // Length of the shared (measure-free) prefix with the reference circuit.
+  const auto &reference = result.m_instructions[0];
+  std::vector<size_t> prefixLengths;
+  for (const auto &instructions : result.m_instructions) {
+    size_t length = 0;
+    while (length < reference.size() && length < instructions.size() &&
+           reference[length]->opcode() != GateOpcode::Measure &&
+           reference[length]->structuralHash() ==
+               instructions[length]->structuralHash() &&
+           compareInst(reference[length], instructions[length])) {
+      length++;
+    }
+    prefixLengths.emplace_back(length);
+  }
+
+  // Checkpoint at each distinct prefix length, spread evenly
+  // (always keeping the deepest) if there are too many.
+  std::vector<size_t> candidates;
+  for (const auto &length : prefixLengths) {
+    if (length > 0) {
+      candidates.emplace_back(length);
+    }
+  }
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                   candidates.end());
+  if (candidates.size() <= in_maxCheckpoints) {
+    result.m_checkpoints = candidates;
+  } else {
+    for (size_t k = 1; k <= in_maxCheckpoints; ++k) {
+      result.m_checkpoints.emplace_back(
+          candidates[k * candidates.size() / in_maxCheckpoints - 1]);
+    }
+  }
+
+  for (size_t i = 0; i < prefixLengths.size(); ++i) {
+    for (int cp = result.m_checkpoints.size() - 1; cp >= 0; --cp) {
+      if (result.m_checkpoints[cp] <= prefixLengths[i]) {
+        result.m_startCheckpoints[i] = cp;
+        break;
+      }
+    }
+  }
+  return result;
+}
 } // namespace quantum
 } // namespace xacc
\ No newline at end of file
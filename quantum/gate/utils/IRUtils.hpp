@@ -14,10 +14,20 @@
 #pragma once
 #include <vector>
 #include <memory>
+#include "Instruction.hpp"
 
 namespace xacc {
 class CompositeInstruction;
 namespace quantum {
+// Exact comparison of the (flattened, enabled) gates of two circuits,
+// ignoring the circuit names. The structural hashes are compared first,
+// so this is cheap for different circuits.
+// In ParameterHashMode::Symbolic, numeric parameter values are ignored.
+bool structurallyEqual(
+    const std::shared_ptr<CompositeInstruction> &in_a,
+    const std::shared_ptr<CompositeInstruction> &in_b,
+    ParameterHashMode in_mode = ParameterHashMode::Numeric);
+
 // Describes a common pattern whereby there is
 // a common base ansatz/state-preparation circuit (no measurement)
 // and a set of *observe* sub-circuits appended to that base circuit.
@@ -38,5 +48,37 @@ private:
   std::shared_ptr<CompositeInstruction> m_baseAnsatz;
   std::vector<std::shared_ptr<CompositeInstruction>> m_obsCircuits;
 };
+
+// Describes a batch of circuits that share leading gates with the first
+// (reference) circuit of the batch, e.g. parameter-shift gradient circuits
+// which only diverge from the ansatz at the shifted gate.
+// A state-vector simulator can save the state of the reference circuit at the
+// checkpoint gate boundaries and start each circuit from the deepest
+// checkpoint it has in common with the reference, rather than from |0>.
+class PrefixSharedBatch {
+public:
+  // At most in_maxCheckpoints state checkpoints will be requested.
+  [[nodiscard]] static PrefixSharedBatch fromComposites(
+      const std::vector<std::shared_ptr<CompositeInstruction>> &in_composites,
+      size_t in_maxCheckpoints);
+  // Flattened (enabled, non-composite) instructions of a circuit
+  const std::vector<std::shared_ptr<Instruction>> &
+  getInstructions(size_t in_circuitIdx) const {
+    return m_instructions[in_circuitIdx];
+  }
+  // Number of leading reference gates to apply before saving each
+  // checkpoint (ascending).
+  const std::vector<size_t> &getCheckpoints() const { return m_checkpoints; }
+  // Index (into getCheckpoints()) of the checkpoint the circuit can start
+  // from, or -1 if it must start from |0>.
+  int getStartCheckpoint(size_t in_circuitIdx) const {
+    return m_startCheckpoints[in_circuitIdx];
+  }
+
+private:
+  std::vector<std::vector<std::shared_ptr<Instruction>>> m_instructions;
+  std::vector<size_t> m_checkpoints;
+  std::vector<int> m_startCheckpoints;
+};
 } // namespace quantum
 } // namespace xacc
\ No newline at end of file
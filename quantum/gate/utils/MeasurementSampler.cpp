@@ -0,0 +1,130 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+
+#include "MeasurementSampler.hpp"
+#include "AcceleratorBuffer.hpp"
+#include "CompositeInstruction.hpp"
+#include "xacc.hpp"
+#include <algorithm>
+#include <numeric>
+#include <thread>
+
+namespace xacc {
+namespace quantum {
+bool canSampleFromFinalState(
+    const std::shared_ptr<CompositeInstruction> &in_composite) {
+  bool measureEncountered = false;
+  for (auto *nextInst : in_composite->flatView()) {
+    if (!nextInst->isEnabled()) {
+      continue;
+    }
+    // Reset and conditionals need the collapsed state of each shot.
+    if (nextInst->opcode() == GateOpcode::Reset ||
+        (nextInst->isComposite() && nextInst->name() == "ifstmt")) {
+      return false;
+    }
+    if (nextInst->opcode() == GateOpcode::Measure) {
+      measureEncountered = true;
+    } else if (measureEncountered && !nextInst->isComposite()) {
+      // Something after a Measure gate.
+      return false;
+    }
+  }
+  return true;
+}
+
+void MeasurementSampler::accumulateMarginal(
+    uint64_t in_stateSize, const ChunkAccumulator &in_accumulate) {
+  // Small states (or state vectors sampled before xacc is initialized) are
+  // not worth the scheduling.
+  constexpr uint64_t minChunkSize = 1ULL << 14;
+  const uint64_t nbChunks =
+      xacc::isInitialized()
+          ? std::min<uint64_t>(std::max<uint64_t>(in_stateSize / minChunkSize, 1),
+                               std::max(1u, std::thread::hardware_concurrency()))
+          : 1;
+  if (nbChunks == 1) {
+    in_accumulate(0, in_stateSize, m_cumulativeProbs.data());
+    return;
+  }
+
+  const size_t nbOutcomes = m_cumulativeProbs.size();
+  std::vector<double> histograms(nbChunks * nbOutcomes, 0.0);
+  xacc::getTaskScheduler()->parallelFor(
+      0, nbChunks, [&](size_t beginIdx, size_t endIdx) {
+        for (auto chunk = beginIdx; chunk < endIdx; ++chunk) {
+          in_accumulate(chunk * in_stateSize / nbChunks,
+                        (chunk + 1) * in_stateSize / nbChunks,
+                        histograms.data() + chunk * nbOutcomes);
+        }
+      });
+  for (uint64_t chunk = 0; chunk < nbChunks; ++chunk) {
+    for (size_t k = 0; k < nbOutcomes; ++k) {
+      m_cumulativeProbs[k] += histograms[chunk * nbOutcomes + k];
+    }
+  }
+}
+
+void MeasurementSampler::buildCumulativeTable() {
+  std::partial_sum(m_cumulativeProbs.begin(), m_cumulativeProbs.end(),
+                   m_cumulativeProbs.begin());
+}
+
+std::map<uint64_t, int>
+MeasurementSampler::sample(int in_shots, std::mt19937_64 &io_rng) const {
+  std::map<uint64_t, int> result;
+  if (in_shots <= 0) {
+    return result;
+  }
+  // Scale by the total probability: the state may not be exactly normalized.
+  std::uniform_real_distribution<double> dist(0.0, m_cumulativeProbs.back());
+  std::vector<double> draws(in_shots);
+  for (auto &draw : draws) {
+    draw = dist(io_rng);
+  }
+  std::sort(draws.begin(), draws.end());
+
+  // Both sequences are sorted: a single walk along the cumulative table.
+  uint64_t outcome = 0;
+  const uint64_t lastOutcome = m_cumulativeProbs.size() - 1;
+  for (size_t i = 0; i < draws.size();) {
+    // Guard against round-off at the upper end.
+    while (outcome < lastOutcome && m_cumulativeProbs[outcome] <= draws[i]) {
+      ++outcome;
+    }
+    int count = 0;
+    while (i < draws.size() &&
+           (outcome == lastOutcome || draws[i] < m_cumulativeProbs[outcome])) {
+      ++count;
+      ++i;
+    }
+    result.emplace_hint(result.end(), outcome, count);
+  }
+  return result;
+}
+
+void MeasurementSampler::appendMeasurements(
+    std::shared_ptr<AcceleratorBuffer> io_buffer, int in_shots) const {
+  static thread_local std::mt19937_64 rng(std::random_device{}());
+  for (const auto &[outcome, count] : sample(in_shots, rng)) {
+    std::string bitString;
+    for (size_t j = 0; j < m_nbMeasureBits; ++j) {
+      bitString.push_back(((outcome >> j) & 1ULL) ? '1' : '0');
+    }
+    for (int i = 0; i < count; ++i) {
+      io_buffer->appendMeasurement(bitString);
+    }
+  }
+}
+} // namespace quantum
+} // namespace xacc
@@ -0,0 +1,102 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+
+#pragma once
+#include <complex>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace xacc {
+class CompositeInstruction;
+class AcceleratorBuffer;
+namespace quantum {
+// Returns true if the shots of this circuit can be simulated by sampling
+// from its final state vector, i.e. all the Measure instructions are at the
+// very end of the circuit (no Reset, no conditional execution).
+bool canSampleFromFinalState(
+    const std::shared_ptr<CompositeInstruction> &in_composite);
+
+// Draws measurement outcomes from a final state vector.
+// The probability distribution is first marginalized onto the measured
+// qubits, O(2^n) in parallel chunks, each chunk with its own histogram of the
+// 2^m outcomes merged once. The shots are then drawn as one batch of sorted
+// uniforms walked along the cumulative distribution, i.e.
+// O(2^n + shots * log(shots) + 2^m) in total, with no copy or collapse of the
+// state vector.
+class MeasurementSampler {
+public:
+  // The state vector is indexed with qubit 0 as the LSB (XACC convention),
+  // any container with size() and operator[] returning a complex amplitude.
+  // Bit j of an outcome is the result of in_measureBits[j].
+  template <typename StateVectorType>
+  MeasurementSampler(const StateVectorType &in_stateVec,
+                     const std::vector<size_t> &in_measureBits)
+      : m_nbMeasureBits(in_measureBits.size()),
+        m_cumulativeProbs(1ULL << in_measureBits.size(), 0.0) {
+    const uint64_t stateSize = in_stateVec.size();
+    // The outcome of index i is lowOutcomes[low bits of i] |
+    // highOutcomes[high bits of i], rather than m bit extractions per index.
+    size_t nbBits = 0;
+    while ((1ULL << nbBits) < stateSize) {
+      ++nbBits;
+    }
+    const size_t nbLowBits = nbBits / 2;
+    const uint64_t lowMask = (1ULL << nbLowBits) - 1;
+    const auto outcomeTable = [&](size_t in_shift, size_t in_size) {
+      std::vector<uint64_t> table(1ULL << in_size, 0);
+      for (uint64_t k = 0; k < table.size(); ++k) {
+        for (size_t j = 0; j < in_measureBits.size(); ++j) {
+          const auto bit = in_measureBits[j];
+          if (bit >= in_shift && bit < in_shift + in_size) {
+            table[k] |= ((k >> (bit - in_shift)) & 1ULL) << j;
+          }
+        }
+      }
+      return table;
+    };
+    const auto lowOutcomes = outcomeTable(0, nbLowBits);
+    const auto highOutcomes = outcomeTable(nbLowBits, nbBits - nbLowBits);
+    accumulateMarginal(stateSize, [&](uint64_t in_begin, uint64_t in_end,
+                                      double *io_histogram) {
+      for (uint64_t i = in_begin; i < in_end; ++i) {
+        io_histogram[lowOutcomes[i & lowMask] |
+                     highOutcomes[i >> nbLowBits]] += std::norm(in_stateVec[i]);
+      }
+    });
+    buildCumulativeTable();
+  }
+
+  // Outcome -> count after in_shots draws.
+  std::map<uint64_t, int> sample(int in_shots, std::mt19937_64 &io_rng) const;
+  // Sample in_shots bit strings (character j is the result of
+  // in_measureBits[j]) and append them to the buffer.
+  void appendMeasurements(std::shared_ptr<AcceleratorBuffer> io_buffer,
+                          int in_shots) const;
+
+private:
+  // Adds the probabilities of the state indices [begin, end) to a histogram
+  // of the outcomes.
+  using ChunkAccumulator =
+      std::function<void(uint64_t, uint64_t, double *)>;
+  void accumulateMarginal(uint64_t in_stateSize,
+                          const ChunkAccumulator &in_accumulate);
+  void buildCumulativeTable();
+  size_t m_nbMeasureBits;
+  std::vector<double> m_cumulativeProbs;
+};
+} // namespace quantum
+} // namespace xacc
@@ -0,0 +1,399 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+
+#include "PassManager.hpp"
+#include "IRTransformation.hpp"
+#include "IRUtils.hpp"
+#include "InstructionIterator.hpp"
+#include "xacc.hpp"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/writer.h"
+#include <algorithm>
+
+namespace {
+// Bound on the number of cached circuits (cleared when reached).
+constexpr size_t MAX_CACHED_CIRCUITS = 1024;
+
+// The structural comparison ignores the disabled instructions (e.g.
+// conditional gates), which the transformations may not.
+bool isCacheable(
+    const std::shared_ptr<xacc::CompositeInstruction> &in_program) {
+  xacc::InstructionIterator it(in_program);
+  while (it.hasNext()) {
+    if (!it.next()->isEnabled()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<xacc::InstPtr>
+cloneInstructions(const std::vector<xacc::InstPtr> &in_instructions) {
+  std::vector<xacc::InstPtr> result;
+  result.reserve(in_instructions.size());
+  for (const auto &inst : in_instructions) {
+    result.emplace_back(inst->clone());
+  }
+  return result;
+}
+
+void setInstructions(
+    const std::shared_ptr<xacc::CompositeInstruction> &io_program,
+    const std::vector<xacc::InstPtr> &in_instructions) {
+  io_program->clear();
+  io_program->addInstructions(cloneInstructions(in_instructions));
+}
+
+void accumulate(xacc::quantum::PassManager::CircuitStatistics &io_total,
+                const xacc::quantum::PassManager::CircuitStatistics &in_stats) {
+  io_total.nbGates += in_stats.nbGates;
+  io_total.nbTwoQubitGates += in_stats.nbTwoQubitGates;
+  io_total.depth += in_stats.depth;
+}
+
+template <typename Writer>
+void writeStatistics(
+    Writer &io_writer,
+    const xacc::quantum::PassManager::CircuitStatistics &in_stats) {
+  io_writer.StartObject();
+  io_writer.Key("gates");
+  io_writer.Uint64(in_stats.nbGates);
+  io_writer.Key("two-qubit-gates");
+  io_writer.Uint64(in_stats.nbTwoQubitGates);
+  io_writer.Key("depth");
+  io_writer.Uint64(in_stats.depth);
+  io_writer.EndObject();
+}
+} // namespace
+
+namespace xacc {
+namespace quantum {
+PassManager &PassManager::addPass(const std::string &in_name,
+                                  const HeterogeneousMap &in_options) {
+  // Validate the name now rather than in the middle of a batch.
+  xacc::getIRTransformation(in_name);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_passes.push_back({in_name, nullptr, in_options});
+  m_statistics.push_back({in_name});
+  m_cache.clear();
+  return *this;
+}
+
+PassManager &
+PassManager::addPass(std::shared_ptr<IRTransformation> in_transformation,
+                     const HeterogeneousMap &in_options) {
+  if (!in_transformation) {
+    xacc::error("PassManager: null IRTransformation.");
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_passes.push_back(
+      {in_transformation->name(), in_transformation, in_options});
+  m_statistics.push_back({in_transformation->name()});
+  m_cache.clear();
+  return *this;
+}
+
+PassManager::CircuitStatistics PassManager::getCircuitStatistics(
+    const std::shared_ptr<CompositeInstruction> &in_program) {
+  CircuitStatistics stats;
+  // Layer of the last gate on each qubit
+  std::vector<size_t> layers;
+  InstructionIterator it(in_program);
+  while (it.hasNext()) {
+    auto inst = it.next();
+    if (!inst->isEnabled() || inst->isComposite()) {
+      continue;
+    }
+    const auto bits = inst->bits();
+    ++stats.nbGates;
+    if (bits.size() == 2) {
+      ++stats.nbTwoQubitGates;
+    }
+    size_t layer = 0;
+    for (const auto bit : bits) {
+      if (bit >= layers.size()) {
+        layers.resize(bit + 1, 0);
+      }
+      layer = std::max(layer, layers[bit]);
+    }
+    for (const auto bit : bits) {
+      layers[bit] = layer + 1;
+    }
+    stats.depth = std::max(stats.depth, layer + 1);
+  }
+  return stats;
+}
+
+const PassManager::CacheEntry *PassManager::findCached(
+    uint64_t in_key,
+    const std::shared_ptr<CompositeInstruction> &in_program) const {
+  const auto range = m_cache.equal_range(in_key);
+  for (auto iter = range.first; iter != range.second; ++iter) {
+    if (structurallyEqual(iter->second.input, in_program)) {
+      return &iter->second;
+    }
+  }
+  return nullptr;
+}
+
+void PassManager::run(
+    const std::vector<std::shared_ptr<CompositeInstruction>> &io_programs) {
+  if (m_passes.empty() || io_programs.empty()) {
+    return;
+  }
+
+  const auto nbPrograms = io_programs.size();
+  std::vector<uint64_t> keys(nbPrograms, 0);
+  std::vector<bool> cacheable(nbPrograms, false);
+  for (size_t i = 0; i < nbPrograms; ++i) {
+    cacheable[i] = isCacheable(io_programs[i]);
+    if (cacheable[i]) {
+      keys[i] = io_programs[i]->structuralHash();
+    }
+  }
+
+  // Circuits to compile, with a copy of their input for the cache, and the
+  // circuits that are duplicates of one of them.
+  std::vector<size_t> toCompile;
+  std::vector<std::shared_ptr<CompositeInstruction>> inputs;
+  std::vector<std::pair<size_t, size_t>> duplicates;
+  std::vector<std::pair<size_t, std::vector<InstPtr>>> hits;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unordered_multimap<uint64_t, size_t> batch;
+    for (size_t i = 0; i < nbPrograms; ++i) {
+      if (!cacheable[i]) {
+        toCompile.emplace_back(i);
+        inputs.emplace_back(nullptr);
+        continue;
+      }
+      if (auto entry = findCached(keys[i], io_programs[i])) {
+        hits.emplace_back(i, entry->output);
+        continue;
+      }
+      bool isDuplicate = false;
+      const auto range = batch.equal_range(keys[i]);
+      for (auto iter = range.first; iter != range.second; ++iter) {
+        if (structurallyEqual(io_programs[iter->second], io_programs[i])) {
+          duplicates.emplace_back(i, iter->second);
+          isDuplicate = true;
+          break;
+        }
+      }
+      if (!isDuplicate) {
+        batch.emplace(keys[i], i);
+        toCompile.emplace_back(i);
+        inputs.emplace_back(std::dynamic_pointer_cast<CompositeInstruction>(
+            io_programs[i]->clone()));
+      }
+    }
+    m_cacheHits += hits.size() + duplicates.size();
+  }
+
+  for (const auto &[programIdx, output] : hits) {
+    setInstructions(io_programs[programIdx], output);
+  }
+
+  xacc::getTaskScheduler()->parallelFor(
+      0, toCompile.size(), [&](size_t beginIdx, size_t endIdx) {
+        std::vector<PassStatistics> statistics(m_passes.size());
+        std::vector<PassRecord> records;
+        for (size_t i = beginIdx; i < endIdx; ++i) {
+          auto &program = io_programs[toCompile[i]];
+          CircuitStatistics stats;
+          if (m_collectStatistics) {
+            stats = getCircuitStatistics(program);
+          }
+          for (size_t passIdx = 0; passIdx < m_passes.size(); ++passIdx) {
+            const auto &pass = m_passes[passIdx];
+            auto transformation = pass.transformation
+                                      ? pass.transformation
+                                      : xacc::getIRTransformation(pass.name);
+            const auto start = std::chrono::steady_clock::now();
+            transformation->apply(program, m_accelerator, pass.options);
+            const double seconds = std::chrono::duration<double>(
+                                       std::chrono::steady_clock::now() - start)
+                                       .count();
+            statistics[passIdx].seconds += seconds;
+            if (m_collectStatistics) {
+              const auto statsAfter = getCircuitStatistics(program);
+              accumulate(statistics[passIdx].before, stats);
+              accumulate(statistics[passIdx].after, statsAfter);
+              records.push_back(
+                  {passIdx, program->name(),
+                   std::chrono::duration<double>(start - m_startTime).count(),
+                   seconds, 0, stats, statsAfter});
+              stats = statsAfter;
+            }
+          }
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t passIdx = 0; passIdx < m_passes.size(); ++passIdx) {
+          auto &total = m_statistics[passIdx];
+          total.nbRuns += endIdx - beginIdx;
+          total.seconds += statistics[passIdx].seconds;
+          accumulate(total.before, statistics[passIdx].before);
+          accumulate(total.after, statistics[passIdx].after);
+        }
+        const auto threadIdx =
+            m_threadIndices
+                .emplace(std::this_thread::get_id(), m_threadIndices.size())
+                .first->second;
+        for (auto &record : records) {
+          record.threadIdx = threadIdx;
+          m_records.emplace_back(std::move(record));
+        }
+      });
+
+  for (const auto &[programIdx, sourceIdx] : duplicates) {
+    setInstructions(io_programs[programIdx],
+                    io_programs[sourceIdx]->getInstructions());
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; i < toCompile.size(); ++i) {
+      if (!inputs[i]) {
+        continue;
+      }
+      if (m_cache.size() >= MAX_CACHED_CIRCUITS) {
+        m_cache.clear();
+      }
+      auto output =
+          cloneInstructions(io_programs[toCompile[i]]->getInstructions());
+      m_cache.emplace(keys[toCompile[i]],
+                      CacheEntry{inputs[i], std::move(output)});
+    }
+  }
+  xacc::info("[PassManager] Compiled " + std::to_string(toCompile.size()) +
+             " of " + std::to_string(nbPrograms) + " circuits, " +
+             std::to_string(nbPrograms - toCompile.size()) + " from cache.");
+}
+
+std::vector<PassManager::PassStatistics> PassManager::getStatistics() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_statistics;
+}
+
+std::vector<PassManager::PassRecord> PassManager::getRecords() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_records;
+}
+
+void PassManager::clearStatistics() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto &stats : m_statistics) {
+    stats = PassStatistics{stats.name};
+  }
+  m_records.clear();
+}
+
+std::string PassManager::toJson() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  rapidjson::StringBuffer buffer;
+  rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+  writer.StartObject();
+  writer.Key("passes");
+  writer.StartArray();
+  for (const auto &stats : m_statistics) {
+    writer.StartObject();
+    writer.Key("name");
+    writer.String(stats.name.c_str());
+    writer.Key("runs");
+    writer.Uint64(stats.nbRuns);
+    writer.Key("seconds");
+    writer.Double(stats.seconds);
+    if (m_collectStatistics) {
+      writer.Key("before");
+      writeStatistics(writer, stats.before);
+      writer.Key("after");
+      writeStatistics(writer, stats.after);
+    }
+    writer.EndObject();
+  }
+  writer.EndArray();
+  writer.Key("cache-hits");
+  writer.Uint64(m_cacheHits);
+  writer.Key("records");
+  writer.StartArray();
+  for (const auto &record : m_records) {
+    writer.StartObject();
+    writer.Key("pass");
+    writer.String(m_statistics[record.passIdx].name.c_str());
+    writer.Key("circuit");
+    writer.String(record.circuitName.c_str());
+    writer.Key("start");
+    writer.Double(record.startSeconds);
+    writer.Key("seconds");
+    writer.Double(record.seconds);
+    writer.Key("thread");
+    writer.Uint64(record.threadIdx);
+    writer.Key("before");
+    writeStatistics(writer, record.before);
+    writer.Key("after");
+    writeStatistics(writer, record.after);
+    writer.EndObject();
+  }
+  writer.EndArray();
+  writer.EndObject();
+  return buffer.GetString();
+}
+
+std::string PassManager::toChromeTrace() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+  writer.StartObject();
+  writer.Key("traceEvents");
+  writer.StartArray();
+  for (const auto &record : m_records) {
+    writer.StartObject();
+    writer.Key("name");
+    writer.String(m_statistics[record.passIdx].name.c_str());
+    writer.Key("cat");
+    writer.String("pass");
+    writer.Key("ph");
+    writer.String("X");
+    // Microseconds
+    writer.Key("ts");
+    writer.Double(record.startSeconds * 1e6);
+    writer.Key("dur");
+    writer.Double(record.seconds * 1e6);
+    writer.Key("pid");
+    writer.Uint64(0);
+    writer.Key("tid");
+    writer.Uint64(record.threadIdx);
+    writer.Key("args");
+    writer.StartObject();
+    writer.Key("circuit");
+    writer.String(record.circuitName.c_str());
+    writer.Key("before");
+    writeStatistics(writer, record.before);
+    writer.Key("after");
+    writeStatistics(writer, record.after);
+    writer.EndObject();
+    writer.EndObject();
+  }
+  writer.EndArray();
+  writer.Key("displayTimeUnit");
+  writer.String("ms");
+  writer.EndObject();
+  return buffer.GetString();
+}
+
+void PassManager::clearCache() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_cache.clear();
+}
+} // namespace quantum
+} // namespace xacc
@@ -0,0 +1,149 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+
+#pragma once
+#include "heterogeneous.hpp"
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace xacc {
+class Accelerator;
+class CompositeInstruction;
+class Instruction;
+class IRTransformation;
+namespace quantum {
+// Runs a pipeline of IR transformations (e.g. circuit-optimizer then a
+// placement) on batches of circuits, e.g. the observed or tomography circuits
+// of an iteration:
+// - The circuits of a batch are compiled in parallel on the shared task
+// scheduler, hence the transformations must not keep per-call state in their
+// members (services that are Cloneable are instantiated per circuit).
+// - Results are cached by circuit structure: a circuit that is structurally
+// equal (IRUtils structurallyEqual) to one already compiled by this
+// pipeline, in this batch or a previous one, gets a copy of its result.
+// - The time spent in each pass is accumulated, see getStatistics(). With
+// setCollectStatistics(true), the gate counts and depth of the circuits
+// before and after each pass are also accumulated, and each application of a
+// pass is recorded (see toJson() and toChromeTrace()).
+class PassManager {
+public:
+  // Of the flattened, enabled gates of a circuit
+  struct CircuitStatistics {
+    size_t nbGates = 0;
+    size_t nbTwoQubitGates = 0;
+    // Number of layers, with the gates scheduled as soon as possible
+    size_t depth = 0;
+  };
+  static CircuitStatistics
+  getCircuitStatistics(const std::shared_ptr<CompositeInstruction> &in_program);
+
+  struct PassStatistics {
+    std::string name;
+    // Number of circuits the pass was applied to
+    size_t nbRuns = 0;
+    // Total (summed over the worker threads)
+    double seconds = 0.0;
+    // Summed over the runs, if collected
+    CircuitStatistics before;
+    CircuitStatistics after;
+  };
+
+  // One application of a pass
+  struct PassRecord {
+    size_t passIdx;
+    std::string circuitName;
+    // Since the construction of the PassManager
+    double startSeconds;
+    double seconds;
+    // Worker threads are numbered in order of appearance
+    size_t threadIdx;
+    CircuitStatistics before;
+    CircuitStatistics after;
+  };
+
+  PassManager(std::shared_ptr<Accelerator> in_accelerator = nullptr)
+      : m_accelerator(in_accelerator),
+        m_startTime(std::chrono::steady_clock::now()) {}
+
+  // Append a pass, by IRTransformation service name or instance.
+  // Changing the pipeline clears the cache.
+  PassManager &addPass(const std::string &in_name,
+                       const HeterogeneousMap &in_options = {});
+  PassManager &addPass(std::shared_ptr<IRTransformation> in_transformation,
+                       const HeterogeneousMap &in_options = {});
+  size_t nbPasses() const { return m_passes.size(); }
+
+  // Transform the circuits in place.
+  void run(const std::vector<std::shared_ptr<CompositeInstruction>>
+               &io_programs);
+  void run(std::shared_ptr<CompositeInstruction> io_program) {
+    run(std::vector<std::shared_ptr<CompositeInstruction>>{io_program});
+  }
+
+  // Off by default, the statistics cost a pass over the circuits.
+  void setCollectStatistics(bool in_collect) {
+    m_collectStatistics = in_collect;
+  }
+  // In pipeline order, accumulated over all the run() calls
+  std::vector<PassStatistics> getStatistics() const;
+  std::vector<PassRecord> getRecords() const;
+  void clearStatistics();
+  // Pass statistics and records
+  std::string toJson() const;
+  // Records as complete events of the Chrome trace event format (for
+  // chrome://tracing or Perfetto), one row per worker thread.
+  std::string toChromeTrace() const;
+  // Number of circuits which got a cached result
+  size_t getCacheHits() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_cacheHits;
+  }
+  void clearCache();
+
+private:
+  struct Pass {
+    std::string name;
+    // Null for passes added by name, resolved for each circuit.
+    std::shared_ptr<IRTransformation> transformation;
+    HeterogeneousMap options;
+  };
+  struct CacheEntry {
+    // Copy of the input circuit, for the exact comparison
+    std::shared_ptr<CompositeInstruction> input;
+    std::vector<std::shared_ptr<Instruction>> output;
+  };
+
+  // Requires m_mutex to be held.
+  const CacheEntry *
+  findCached(uint64_t in_key,
+             const std::shared_ptr<CompositeInstruction> &in_program) const;
+
+  std::shared_ptr<Accelerator> m_accelerator;
+  std::vector<Pass> m_passes;
+  std::chrono::steady_clock::time_point m_startTime;
+  bool m_collectStatistics = false;
+  std::vector<PassStatistics> m_statistics;
+  std::vector<PassRecord> m_records;
+  std::map<std::thread::id, size_t> m_threadIndices;
+  std::unordered_multimap<uint64_t, CacheEntry> m_cache;
+  size_t m_cacheHits = 0;
+  mutable std::mutex m_mutex;
+};
+} // namespace quantum
+} // namespace xacc
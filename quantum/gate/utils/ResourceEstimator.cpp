@@ -0,0 +1,316 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+
+#include "ResourceEstimator.hpp"
+#include "Accelerator.hpp"
+#include "InstructionIterator.hpp"
+#include "xacc.hpp"
+#include "rapidjson/document.h"
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+namespace {
+const std::set<std::string> VIRTUAL_GATES{"I",   "Z", "Rz",  "U1",
+                                          "S",   "Sdg", "T", "Tdg"};
+const std::set<std::string> SINGLE_PULSE_GATES{"X", "Y", "H"};
+const std::set<std::string> SINGLE_PULSE_TWO_QUBIT_GATES{"CNOT", "CZ", "CY",
+                                                         "CH"};
+const std::set<std::string> Z_ROTATIONS{"Rz", "U1"};
+
+// angle / (pi / 4) if it is an integer, -1 otherwise
+int quarterTurns(double in_angle) {
+  const double quarters = in_angle / (M_PI / 4.0);
+  const double rounded = std::round(quarters);
+  if (std::abs(quarters - rounded) > 1e-9) {
+    return -1;
+  }
+  return ((int)std::fmod(rounded, 8.0) + 8) % 8;
+}
+
+// The numeric value of a parameter, false if it is symbolic
+bool numericValue(const xacc::InstructionParameter &in_param,
+                  double &out_value) {
+  if (in_param.which() == 2) {
+    const auto &str = in_param.as<std::string>();
+    char *end = nullptr;
+    out_value = strtod(str.c_str(), &end);
+    return end != str.c_str() && *end == '\0';
+  }
+  out_value = xacc::InstructionParameterToDouble(in_param);
+  return true;
+}
+
+double toNs(double in_value, const std::string &in_unit) {
+  if (in_unit == "s") {
+    return in_value * 1e9;
+  }
+  if (in_unit == "ms") {
+    return in_value * 1e6;
+  }
+  if (in_unit == "us" || in_unit == "µs") {
+    return in_value * 1e3;
+  }
+  return in_value;
+}
+
+double mean(const std::map<size_t, double> &in_values, double in_default) {
+  if (in_values.empty()) {
+    return in_default;
+  }
+  double sum = 0.0;
+  for (auto &[key, value] : in_values) {
+    sum += value;
+  }
+  return sum / in_values.size();
+}
+} // namespace
+
+namespace xacc {
+namespace quantum {
+double TimingModel::duration(Instruction &in_gate) const {
+  const auto &name = in_gate.name();
+  const auto bits = in_gate.bits();
+  if (bits.empty() || VIRTUAL_GATES.count(name)) {
+    return 0.0;
+  }
+  if (name == "Measure" || name == "Reset") {
+    const auto iter = measureOverrides.find(bits[0]);
+    return iter == measureOverrides.end() ? measureNs : iter->second;
+  }
+  if (bits.size() == 1) {
+    const auto iter = singleQubitOverrides.find(bits[0]);
+    const double pulseNs =
+        iter == singleQubitOverrides.end() ? singleQubitNs : iter->second;
+    return (SINGLE_PULSE_GATES.count(name) ? 1 : 2) * pulseNs;
+  }
+  double pulseNs = twoQubitNs;
+  if (bits.size() == 2) {
+    auto iter = twoQubitOverrides.find({bits[0], bits[1]});
+    if (iter == twoQubitOverrides.end()) {
+      iter = twoQubitOverrides.find({bits[1], bits[0]});
+    }
+    if (iter != twoQubitOverrides.end()) {
+      pulseNs = iter->second;
+    }
+  }
+  if (bits.size() > 2) {
+    return 6 * pulseNs;
+  }
+  if (SINGLE_PULSE_TWO_QUBIT_GATES.count(name)) {
+    return pulseNs;
+  }
+  return (name == "Swap" ? 3 : 2) * pulseNs;
+}
+
+TimingModel TimingModel::fromIbmProperties(const std::string &in_propertiesJson,
+                                           const std::string &in_configJson) {
+  TimingModel model;
+  rapidjson::Document props;
+  props.Parse(in_propertiesJson.c_str());
+  if (props.HasParseError() || !props.IsObject()) {
+    xacc::warning("ResourceEstimator: invalid backend properties, using the "
+                  "default timing model.");
+    return model;
+  }
+
+  // Single-qubit pulse lengths by preference: sx, then u2, then x
+  std::map<size_t, std::pair<int, double>> pulses;
+  const std::vector<std::string> pulseGates{"sx", "u2", "x"};
+  if (props.HasMember("gates") && props["gates"].IsArray()) {
+    for (auto &gate : props["gates"].GetArray()) {
+      if (!gate.HasMember("gate") || !gate.HasMember("qubits") ||
+          !gate.HasMember("parameters")) {
+        continue;
+      }
+      const std::string gateName = gate["gate"].GetString();
+      double lengthNs = -1.0;
+      for (auto &param : gate["parameters"].GetArray()) {
+        if (param.HasMember("name") &&
+            std::string(param["name"].GetString()) == "gate_length" &&
+            param.HasMember("value") && param["value"].IsNumber()) {
+          lengthNs = toNs(param["value"].GetDouble(),
+                          param.HasMember("unit") ? param["unit"].GetString()
+                                                  : "ns");
+        }
+      }
+      const auto &qubits = gate["qubits"];
+      if (lengthNs <= 0.0 || !qubits.IsArray() || qubits.Empty()) {
+        continue;
+      }
+      if (qubits.Size() == 2 && (gateName == "cx" || gateName == "ecr")) {
+        model.twoQubitOverrides[{qubits[0].GetUint(), qubits[1].GetUint()}] =
+            lengthNs;
+      } else if (qubits.Size() == 1) {
+        const auto rank = std::find(pulseGates.begin(), pulseGates.end(),
+                                    gateName) -
+                          pulseGates.begin();
+        const size_t qubit = qubits[0].GetUint();
+        if (rank < pulseGates.size() &&
+            (!pulses.count(qubit) || rank < pulses[qubit].first)) {
+          pulses[qubit] = {rank, lengthNs};
+        }
+      }
+    }
+  }
+  for (auto &[qubit, pulse] : pulses) {
+    model.singleQubitOverrides[qubit] = pulse.second;
+  }
+
+  if (props.HasMember("qubits") && props["qubits"].IsArray()) {
+    size_t qubit = 0;
+    for (auto &qubitProps : props["qubits"].GetArray()) {
+      for (auto &prop : qubitProps.GetArray()) {
+        if (prop.HasMember("name") &&
+            std::string(prop["name"].GetString()) == "readout_length" &&
+            prop.HasMember("value") && prop["value"].IsNumber()) {
+          model.measureOverrides[qubit] = toNs(
+              prop["value"].GetDouble(),
+              prop.HasMember("unit") ? prop["unit"].GetString() : "ns");
+        }
+      }
+      ++qubit;
+    }
+  }
+
+  model.singleQubitNs = mean(model.singleQubitOverrides, model.singleQubitNs);
+  model.measureNs = mean(model.measureOverrides, model.measureNs);
+  if (!model.twoQubitOverrides.empty()) {
+    double sum = 0.0;
+    for (auto &[pair, lengthNs] : model.twoQubitOverrides) {
+      sum += lengthNs;
+    }
+    model.twoQubitNs = sum / model.twoQubitOverrides.size();
+  }
+
+  if (!in_configJson.empty()) {
+    rapidjson::Document config;
+    config.Parse(in_configJson.c_str());
+    // In us
+    if (!config.HasParseError() && config.IsObject() &&
+        config.HasMember("default_rep_delay") &&
+        config["default_rep_delay"].IsNumber()) {
+      model.shotOverheadNs = config["default_rep_delay"].GetDouble() * 1e3;
+    }
+  }
+  return model;
+}
+
+TimingModel
+TimingModel::fromAccelerator(const std::shared_ptr<Accelerator> &in_accelerator) {
+  if (!in_accelerator) {
+    return TimingModel();
+  }
+  auto properties = in_accelerator->getProperties();
+  if (!properties.stringExists("total-json")) {
+    return TimingModel();
+  }
+  return fromIbmProperties(properties.getString("total-json"),
+                           properties.stringExists("config-json")
+                               ? properties.getString("config-json")
+                               : "");
+}
+
+ResourceEstimate ResourceEstimator::estimate(
+    const std::shared_ptr<CompositeInstruction> &in_program,
+    int in_shots) const {
+  ResourceEstimate estimate;
+  // Layer and finish time of the last gate on each qubit
+  std::vector<size_t> layers;
+  std::vector<double> finishNs;
+  InstructionIterator it(in_program);
+  while (it.hasNext()) {
+    auto inst = it.next();
+    if (!inst->isEnabled() || inst->isComposite()) {
+      continue;
+    }
+    const auto bits = inst->bits();
+    if (bits.empty()) {
+      continue;
+    }
+    const auto &name = inst->name();
+    ++estimate.nbGates;
+    if (bits.size() >= 2) {
+      ++estimate.nbTwoQubitGates;
+    }
+    if (name == "Measure") {
+      ++estimate.nbMeasurements;
+    } else if (name == "T" || name == "Tdg") {
+      ++estimate.nbTGates;
+    } else if (inst->nParameters() > 0 && name != "Reset") {
+      bool clifford = true;
+      bool symbolic = false;
+      int turns = 0;
+      for (auto &param : inst->getParameters()) {
+        double angle = 0.0;
+        if (!numericValue(param, angle)) {
+          symbolic = true;
+          break;
+        }
+        turns = quarterTurns(angle);
+        if (turns < 0 || turns % 2) {
+          clifford = false;
+        }
+      }
+      if (symbolic) {
+        ++estimate.nbNonCliffordRotations;
+      } else if (!clifford) {
+        if (Z_ROTATIONS.count(name) && turns >= 0) {
+          ++estimate.nbTGates;
+        } else {
+          ++estimate.nbNonCliffordRotations;
+        }
+      }
+    }
+
+    size_t layer = 0;
+    double startNs = 0.0;
+    for (const auto bit : bits) {
+      if (bit >= layers.size()) {
+        layers.resize(bit + 1, 0);
+        finishNs.resize(bit + 1, 0.0);
+      }
+      layer = std::max(layer, layers[bit]);
+      startNs = std::max(startNs, finishNs[bit]);
+    }
+    const double endNs = startNs + m_model.duration(*inst);
+    for (const auto bit : bits) {
+      layers[bit] = layer + 1;
+      finishNs[bit] = endNs;
+    }
+    estimate.depth = std::max(estimate.depth, layer + 1);
+    estimate.durationNs = std::max(estimate.durationNs, endNs);
+  }
+
+  estimate.nbQubits = layers.size();
+  estimate.stateVectorBytes = std::ldexp(16.0, estimate.nbQubits);
+  estimate.runtimeSeconds =
+      std::max(in_shots, 1) *
+      (estimate.durationNs + m_model.shotOverheadNs) * 1e-9;
+  return estimate;
+}
+
+std::vector<ResourceEstimate> ResourceEstimator::estimate(
+    const std::vector<std::shared_ptr<CompositeInstruction>> &in_programs,
+    int in_shots) const {
+  std::vector<ResourceEstimate> estimates(in_programs.size());
+  xacc::getTaskScheduler()->parallelFor(
+      0, in_programs.size(), [&](size_t beginIdx, size_t endIdx) {
+        for (size_t i = beginIdx; i < endIdx; ++i) {
+          estimates[i] = estimate(in_programs[i], in_shots);
+        }
+      });
+  return estimates;
+}
+} // namespace quantum
+} // namespace xacc
@@ -0,0 +1,105 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+
+#pragma once
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace xacc {
+class Accelerator;
+class CompositeInstruction;
+class Instruction;
+namespace quantum {
+// Durations of the gates on a backend, in ns. Gates are counted in native
+// pulses of an IBM-like (sx, rz, cx) gate set:
+// - Z rotations (Rz, U1, Z, S, Sdg, T, Tdg, I) are virtual (0 ns),
+// - X, Y, H take one single-qubit pulse, Rx, Ry, U two,
+// - CNOT, CZ, CY, CH take one two-qubit pulse, Swap three, the other
+// two-qubit gates two and the larger gates six (Toffoli),
+// - Measure and Reset take a readout.
+// The per-qubit (and per-pair, in either direction) overrides take
+// precedence over the defaults.
+struct TimingModel {
+  double singleQubitNs = 35.5;
+  double twoQubitNs = 300.0;
+  double measureNs = 4000.0;
+  // Added to each shot, e.g. the repetition delay
+  double shotOverheadNs = 0.0;
+  std::map<size_t, double> singleQubitOverrides;
+  std::map<size_t, double> measureOverrides;
+  std::map<std::pair<size_t, size_t>, double> twoQubitOverrides;
+
+  double duration(Instruction &in_gate) const;
+
+  // From the backend properties JSON of IBM (the "total-json" Accelerator
+  // property: gate_length of sx/u2/x and cx/ecr, readout_length of the
+  // qubits) and its configuration JSON (the "config-json" property:
+  // default_rep_delay). The defaults are the means of the backend values.
+  static TimingModel fromIbmProperties(const std::string &in_propertiesJson,
+                                       const std::string &in_configJson = "");
+  // From the properties of an Accelerator if it has IBM-like ones, the
+  // default model otherwise.
+  static TimingModel
+  fromAccelerator(const std::shared_ptr<Accelerator> &in_accelerator);
+};
+
+// Of the flattened, enabled gates of a circuit
+struct ResourceEstimate {
+  // Highest qubit index + 1
+  size_t nbQubits = 0;
+  size_t nbGates = 0;
+  // Gates on two or more qubits
+  size_t nbTwoQubitGates = 0;
+  // T and Tdg, and the Z rotations by odd multiples of pi / 4
+  size_t nbTGates = 0;
+  // The other rotations that are not multiples of pi / 2 (including the
+  // symbolic ones), each of which costs many T gates once synthesized
+  size_t nbNonCliffordRotations = 0;
+  size_t nbMeasurements = 0;
+  // Number of layers, with the gates scheduled as soon as possible
+  size_t depth = 0;
+  // Of a complex<double> state vector of nbQubits
+  double stateVectorBytes = 0.0;
+  // Critical path of one shot, each gate started as soon as its qubits are
+  double durationNs = 0.0;
+  // shots * (durationNs + shotOverheadNs)
+  double runtimeSeconds = 0.0;
+};
+
+// Estimates the resources of circuits before their execution, in one pass
+// over their gates: compile them first (e.g. with a PassManager) to get
+// the figures of the compiled circuits.
+class ResourceEstimator {
+public:
+  ResourceEstimator(const TimingModel &in_model = TimingModel())
+      : m_model(in_model) {}
+  ResourceEstimator(const std::shared_ptr<Accelerator> &in_accelerator)
+      : m_model(TimingModel::fromAccelerator(in_accelerator)) {}
+
+  ResourceEstimate estimate(const std::shared_ptr<CompositeInstruction> &in_program,
+                            int in_shots = 1) const;
+  // Estimated in parallel on the shared task scheduler
+  std::vector<ResourceEstimate>
+  estimate(const std::vector<std::shared_ptr<CompositeInstruction>> &in_programs,
+           int in_shots = 1) const;
+
+  const TimingModel &getTimingModel() const { return m_model; }
+
+private:
+  TimingModel m_model;
+};
+} // namespace quantum
+} // namespace xacc
@@ -0,0 +1,93 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include <gtest/gtest.h>
+#include "BinaryIR.hpp"
+#include "Circuit.hpp"
+#include "CommonGates.hpp"
+#include "IRUtils.hpp"
+#include "xacc.hpp"
+#include "xacc_service.hpp"
+#include <sstream>
+
+using namespace xacc::quantum;
+
+TEST(BinaryIRTester, checkRoundTrip) {
+  auto provider = xacc::getIRProvider("quantum");
+  auto circuit = provider->createComposite("foo", {"theta"});
+  circuit->addInstruction(std::make_shared<Hadamard>(0));
+  circuit->addInstruction(std::make_shared<Rx>(1, std::string("theta")));
+  circuit->addInstruction(std::make_shared<U>(1, 0.1, -0.2, 3.0));
+  auto sub = provider->createComposite("sub");
+  auto x = std::make_shared<X>(2);
+  x->disable();
+  sub->addInstruction(x);
+  sub->addInstruction(std::make_shared<CPhase>(0, 2, -1.5));
+  circuit->addInstruction(sub);
+  // Not one of the common gates, created by name
+  circuit->addInstruction(provider->createInstruction("AnnealingInstruction", {0, 2}, {0.25}));
+  auto measure = std::make_shared<Measure>(1, 3);
+  measure->setBufferNames({"q", "c"});
+  circuit->addInstruction(measure);
+  circuit->setCoefficient({0.5, -2.0});
+
+  const auto data = toBinary(circuit);
+  auto loaded = fromBinary(data);
+  EXPECT_EQ(loaded->name(), "foo");
+  EXPECT_EQ(loaded->getVariables(), circuit->getVariables());
+  EXPECT_EQ(loaded->getCoefficient(), circuit->getCoefficient());
+  EXPECT_EQ(loaded->toString(), circuit->toString());
+  EXPECT_EQ(loaded->nInstructions(), circuit->nInstructions());
+  EXPECT_TRUE(structurallyEqual(loaded, circuit));
+
+  auto loadedSub = std::dynamic_pointer_cast<xacc::CompositeInstruction>(
+      loaded->getInstruction(3));
+  ASSERT_TRUE(loadedSub);
+  EXPECT_EQ(loadedSub->name(), "sub");
+  EXPECT_FALSE(loadedSub->getInstruction(0)->isEnabled());
+  EXPECT_EQ(loaded->getInstruction(4)->name(), "AnnealingInstruction");
+  EXPECT_EQ(loaded->getInstruction(5)->getBufferName(1), "c");
+  EXPECT_EQ(loaded->getInstruction(5)->getParameter(0).as<int>(), 3);
+
+  // Parameterized circuits can be evaluated.
+  auto evaled = (*loaded)({1.5});
+  EXPECT_NEAR(evaled->getInstruction(1)->getParameter(0).as<double>(), 1.5,
+              1e-12);
+
+  // Same bytes when serialized again, or to a stream
+  EXPECT_EQ(toBinary(loaded), data);
+  std::stringstream ss;
+  writeBinary(circuit, ss);
+  EXPECT_EQ(ss.str(), data);
+}
+
+TEST(BinaryIRTester, checkCompact) {
+  auto circuit = std::make_shared<Circuit>("big");
+  for (int i = 0; i < 1000; ++i) {
+    circuit->addInstruction(std::make_shared<Rz>(i % 10, 0.1 * i));
+    circuit->addInstruction(std::make_shared<CNOT>(i % 10, (i + 1) % 10));
+  }
+  const auto data = toBinary(circuit);
+  // Opcode, flag, bits, buffer name id and parameters: a few bytes per gate
+  EXPECT_LT(data.size(), 16 * circuit->nInstructions());
+  auto loaded = fromBinary(data.data(), data.size());
+  EXPECT_EQ(loaded->nInstructions(), 2000);
+  EXPECT_TRUE(structurallyEqual(loaded, circuit));
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize(argc, argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include "CommonGates.hpp"
+#include "xacc.hpp"
+#include "CircuitDag.hpp"
+
+using namespace xacc::quantum;
+
+TEST(CircuitDagTester, checkLinks) {
+  auto circuit = std::make_shared<Circuit>("dag");
+  circuit->addInstruction(std::make_shared<Hadamard>(0));
+  circuit->addInstruction(std::make_shared<CNOT>(0, 1));
+  circuit->addInstruction(std::make_shared<X>(1));
+  circuit->addInstruction(std::make_shared<Rz>(0, 0.5));
+
+  CircuitDag dag(circuit);
+  EXPECT_EQ(4, dag.nbNodes());
+  EXPECT_EQ(2, dag.nbQubits());
+  EXPECT_EQ(0, dag.first(0));
+  EXPECT_EQ(1, dag.first(1));
+  EXPECT_EQ(1, dag.next(0, 0));
+  EXPECT_EQ(3, dag.next(1, 0));
+  EXPECT_EQ(2, dag.next(1, 1));
+  EXPECT_EQ(CircuitDag::NONE, dag.commonSuccessor(1));
+  EXPECT_EQ(1, dag.commonSuccessor(0));
+  EXPECT_EQ(CircuitDag::NONE, dag.next(3, 0));
+
+  // Removing the CNOT relinks both wires
+  dag.remove(1);
+  EXPECT_TRUE(dag.isRemoved(1));
+  EXPECT_EQ(3, dag.next(0, 0));
+  EXPECT_EQ(0, dag.prev(3, 0));
+  EXPECT_EQ(2, dag.first(1));
+  EXPECT_EQ(CircuitDag::NONE, dag.prev(2, 1));
+
+  dag.replace(3, std::make_shared<Rz>(0, 1.5));
+  dag.toCircuit(circuit);
+  EXPECT_EQ(3, circuit->nInstructions());
+  EXPECT_EQ("H", circuit->getInstruction(0)->name());
+  EXPECT_EQ("X", circuit->getInstruction(1)->name());
+  EXPECT_NEAR(1.5, circuit->getInstruction(2)->getParameter(0).as<double>(),
+              1e-12);
+}
+
+TEST(CircuitDagTester, checkBarrier) {
+  auto nested = std::make_shared<Circuit>("nested");
+  nested->addInstruction(std::make_shared<Hadamard>(2));
+  auto circuit = std::make_shared<Circuit>("dag");
+  circuit->addInstruction(std::make_shared<Hadamard>(0));
+  circuit->addInstruction(nested);
+  circuit->addInstruction(std::make_shared<Hadamard>(0));
+  auto disabled = std::make_shared<X>(1);
+  disabled->disable();
+  circuit->addInstruction(disabled);
+
+  // Composites are on all the wires, disabled instructions are skipped.
+  CircuitDag dag(circuit);
+  EXPECT_EQ(3, dag.nbNodes());
+  EXPECT_EQ(3, dag.nbQubits());
+  EXPECT_EQ(1, dag.commonSuccessor(0));
+  EXPECT_EQ(1, dag.first(1));
+  EXPECT_EQ(2, dag.next(1, 0));
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize(argc, argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
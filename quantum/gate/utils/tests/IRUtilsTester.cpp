@@ -116,6 +116,78 @@ TEST(IRUtilsTester, checkObservable) {
   }
 }
 
+TEST(IRUtilsTester, checkPrefixSharedBatch) {
+  auto gateRegistry = xacc::getService<xacc::IRProvider>("quantum");
+  // Shift the angle of one of the 3 Ry gates in each circuit
+  std::vector<std::shared_ptr<xacc::CompositeInstruction>> circuits;
+  for (int shifted = -1; shifted < 3; ++shifted) {
+    auto circuit = gateRegistry->createComposite(
+        "__SHIFTED__" + std::to_string(shifted));
+    circuit->addInstruction(std::make_shared<Hadamard>(0));
+    for (int i = 0; i < 3; ++i) {
+      const double angle = (i == shifted) ? 0.1 + 1e-9 : 0.1;
+      circuit->addInstruction(std::make_shared<Ry>(i, angle));
+      circuit->addInstruction(std::make_shared<CNOT>(i, i + 1));
+    }
+    circuit->addInstruction(std::make_shared<Measure>(0));
+    circuits.emplace_back(circuit);
+  }
+
+  auto batch = PrefixSharedBatch::fromComposites(circuits, 10);
+  EXPECT_EQ(batch.getInstructions(0).size(), 8);
+  // Diverges at gate 1, 3, 5 (angles differ
+  // beyond the printed precision); the reference shares all 7 gates.
+  EXPECT_EQ(batch.getCheckpoints(), std::vector<size_t>({1, 3, 5, 7}));
+  EXPECT_EQ(batch.getStartCheckpoint(0), 3);
+  EXPECT_EQ(batch.getStartCheckpoint(1), 0);
+  EXPECT_EQ(batch.getStartCheckpoint(2), 1);
+  EXPECT_EQ(batch.getStartCheckpoint(3), 2);
+
+  // Limited number of checkpoints: keep the deepest.
+  auto limited = PrefixSharedBatch::fromComposites(circuits, 2);
+  EXPECT_EQ(limited.getCheckpoints(), std::vector<size_t>({3, 7}));
+  EXPECT_EQ(limited.getStartCheckpoint(1), -1);
+  EXPECT_EQ(limited.getStartCheckpoint(3), 0);
+}
+
+TEST(IRUtilsTester, checkStructuralHash) {
+  auto gateRegistry = xacc::getService<xacc::IRProvider>("quantum");
+  const auto makeCircuit = [&](const std::string &name, double angle) {
+    auto circuit = gateRegistry->createComposite(name);
+    circuit->addInstruction(std::make_shared<Hadamard>(0));
+    circuit->addInstruction(std::make_shared<Ry>(1, angle));
+    circuit->addInstruction(std::make_shared<CNOT>(0, 1));
+    return circuit;
+  };
+  auto a = makeCircuit("a", 0.5);
+  auto b = makeCircuit("b", 0.5);
+  auto c = makeCircuit("c", 0.25);
+  // Names don't matter
+  EXPECT_EQ(a->structuralHash(), b->structuralHash());
+  EXPECT_TRUE(structurallyEqual(a, b));
+  EXPECT_NE(a->structuralHash(), c->structuralHash());
+  EXPECT_FALSE(structurallyEqual(a, c));
+  // Same template
+  EXPECT_EQ(a->structuralHash(xacc::ParameterHashMode::Symbolic),
+            c->structuralHash(xacc::ParameterHashMode::Symbolic));
+  EXPECT_TRUE(structurallyEqual(a, c, xacc::ParameterHashMode::Symbolic));
+
+  // The cached hash of a gate is updated when it changes.
+  c->getInstruction(1)->setParameter(0, 0.5);
+  EXPECT_EQ(a->structuralHash(), c->structuralHash());
+  c->getInstruction(2)->setBits({1, 0});
+  EXPECT_FALSE(structurallyEqual(a, c));
+
+  // Nesting doesn't matter either
+  auto nested = gateRegistry->createComposite("nested");
+  auto sub = gateRegistry->createComposite("sub");
+  sub->addInstruction(std::make_shared<Hadamard>(0));
+  sub->addInstruction(std::make_shared<Ry>(1, 0.5));
+  nested->addInstruction(sub);
+  nested->addInstruction(std::make_shared<CNOT>(0, 1));
+  EXPECT_TRUE(structurallyEqual(a, nested));
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize(argc, argv);
   ::testing::InitGoogleTest(&argc, argv);
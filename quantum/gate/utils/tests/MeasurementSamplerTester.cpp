@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include "CommonGates.hpp"
+#include "AcceleratorBuffer.hpp"
+#include "xacc.hpp"
+#include "MeasurementSampler.hpp"
+
+using namespace xacc::quantum;
+
+TEST(MeasurementSamplerTester, checkCanSample) {
+  auto terminal = std::make_shared<Circuit>("terminal");
+  terminal->addInstruction(std::make_shared<Hadamard>(0));
+  terminal->addInstruction(std::make_shared<CNOT>(0, 1));
+  terminal->addInstruction(std::make_shared<Measure>(0));
+  terminal->addInstruction(std::make_shared<Measure>(1));
+  EXPECT_TRUE(canSampleFromFinalState(terminal));
+
+  auto midCircuit = std::make_shared<Circuit>("mid_circuit");
+  midCircuit->addInstruction(std::make_shared<Hadamard>(0));
+  midCircuit->addInstruction(std::make_shared<Measure>(0));
+  midCircuit->addInstruction(std::make_shared<CNOT>(0, 1));
+  midCircuit->addInstruction(std::make_shared<Measure>(1));
+  EXPECT_FALSE(canSampleFromFinalState(midCircuit));
+
+  auto withReset = std::make_shared<Circuit>("with_reset");
+  withReset->addInstruction(std::make_shared<Hadamard>(0));
+  withReset->addInstruction(std::make_shared<Reset>(0));
+  withReset->addInstruction(std::make_shared<Measure>(0));
+  EXPECT_FALSE(canSampleFromFinalState(withReset));
+}
+
+TEST(MeasurementSamplerTester, checkSampling) {
+  // 3-qubit state: 0.6 |000> + 0.8 |101> (q0 is the LSB)
+  std::vector<std::complex<double>> stateVec(8, 0.0);
+  stateVec[0] = 0.6;
+  stateVec[5] = 0.8;
+  const int nbShots = 100000;
+  {
+    // Marginal on q2 and q1 (in that order)
+    MeasurementSampler sampler(stateVec, {2, 1});
+    std::mt19937_64 rng(42);
+    const auto counts = sampler.sample(nbShots, rng);
+    EXPECT_EQ(counts.size(), 2);
+    EXPECT_NEAR(counts.at(0) / (double)nbShots, 0.36, 0.01);
+    EXPECT_NEAR(counts.at(1) / (double)nbShots, 0.64, 0.01);
+  }
+  {
+    auto buffer = std::make_shared<xacc::AcceleratorBuffer>("q", 3);
+    MeasurementSampler sampler(stateVec, {0, 1, 2});
+    sampler.appendMeasurements(buffer, nbShots);
+    const auto counts = buffer->getMeasurementCounts();
+    EXPECT_EQ(counts.size(), 2);
+    EXPECT_EQ(counts.at("000") + counts.at("101"), nbShots);
+    EXPECT_NEAR(buffer->computeMeasurementProbability("101"), 0.64, 0.01);
+  }
+}
+
+TEST(MeasurementSamplerTester, checkChunkedMarginal) {
+  // 16 qubits, enough for the marginal to be split in chunks:
+  // |psi> = 0.5 |0...00> + 0.5i |0...01> + sqrt(0.5) |1...11>
+  const size_t nbQubits = 16;
+  std::vector<std::complex<double>> stateVec(1ULL << nbQubits, 0.0);
+  stateVec[0] = std::sqrt(0.25);
+  stateVec[1] = std::complex<double>(0.0, std::sqrt(0.25));
+  stateVec.back() = std::sqrt(0.5);
+  // Marginal on q15 and q0: outcomes 00 (0.25), 10 (0.25, q0 = 1), 11 (0.5)
+  MeasurementSampler sampler(stateVec, {0, nbQubits - 1});
+  std::mt19937_64 rng(7);
+  const int nbShots = 200000;
+  const auto counts = sampler.sample(nbShots, rng);
+  EXPECT_EQ(counts.count(2), 0);
+  int total = 0;
+  for (const auto &[outcome, count] : counts) {
+    total += count;
+  }
+  EXPECT_EQ(total, nbShots);
+  EXPECT_NEAR(counts.at(0) / (double)nbShots, 0.25, 0.01);
+  EXPECT_NEAR(counts.at(1) / (double)nbShots, 0.25, 0.01);
+  EXPECT_NEAR(counts.at(3) / (double)nbShots, 0.5, 0.01);
+  EXPECT_TRUE(sampler.sample(0, rng).empty());
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize(argc, argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
@@ -0,0 +1,178 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include <gtest/gtest.h>
+#include "CommonGates.hpp"
+#include "IRTransformation.hpp"
+#include "PassManager.hpp"
+#include "xacc.hpp"
+#include "rapidjson/document.h"
+#include <atomic>
+
+using namespace xacc::quantum;
+
+namespace {
+// Removes the Identity gates, counting its calls.
+class RemoveIdentities : public xacc::IRTransformation {
+public:
+  std::atomic<int> nbCalls{0};
+  void apply(std::shared_ptr<xacc::CompositeInstruction> program,
+             const std::shared_ptr<xacc::Accelerator> accelerator,
+             const xacc::HeterogeneousMap &options = {}) override {
+    ++nbCalls;
+    std::vector<xacc::InstPtr> kept;
+    for (auto &inst : program->getInstructions()) {
+      if (inst->name() != "I") {
+        kept.emplace_back(inst);
+      }
+    }
+    program->clear();
+    program->addInstructions(kept);
+  }
+  const xacc::IRTransformationType type() const override {
+    return xacc::IRTransformationType::Optimization;
+  }
+  const std::string name() const override { return "remove-identities"; }
+  const std::string description() const override { return ""; }
+};
+
+std::shared_ptr<Circuit> makeCircuit(const std::string &name, double angle) {
+  auto circuit = std::make_shared<Circuit>(name);
+  circuit->addInstruction(std::make_shared<Hadamard>(0));
+  circuit->addInstruction(std::make_shared<Identity>(1));
+  circuit->addInstruction(std::make_shared<CNOT>(0, 1));
+  circuit->addInstruction(std::make_shared<Rz>(1, angle));
+  circuit->addInstruction(std::make_shared<Identity>(0));
+  return circuit;
+}
+} // namespace
+
+TEST(PassManagerTester, checkBatch) {
+  auto pass = std::make_shared<RemoveIdentities>();
+  PassManager passManager;
+  passManager.addPass(pass);
+  std::vector<std::shared_ptr<xacc::CompositeInstruction>> programs;
+  for (int i = 0; i < 12; ++i) {
+    programs.emplace_back(
+        makeCircuit("circuit_" + std::to_string(i), i % 3 ? 0.5 : 1.5));
+  }
+  passManager.run(programs);
+  // Two distinct circuits
+  EXPECT_EQ(2, pass->nbCalls);
+  EXPECT_EQ(10, passManager.getCacheHits());
+  for (int i = 0; i < 12; ++i) {
+    ASSERT_EQ(3, programs[i]->nInstructions());
+    EXPECT_EQ("circuit_" + std::to_string(i), programs[i]->name());
+    EXPECT_NEAR(i % 3 ? 0.5 : 1.5,
+                programs[i]->getInstruction(2)->getParameter(0).as<double>(),
+                1e-12);
+  }
+  // Results are copies
+  programs[1]->getInstruction(2)->setParameter(0, 2.5);
+  EXPECT_NEAR(0.5, programs[2]->getInstruction(2)->getParameter(0).as<double>(),
+              1e-12);
+
+  // Circuits seen in the previous batch are not compiled again.
+  passManager.run(makeCircuit("again", 0.5));
+  passManager.run(makeCircuit("new", 2.0));
+  EXPECT_EQ(3, pass->nbCalls);
+  EXPECT_EQ(11, passManager.getCacheHits());
+
+  const auto stats = passManager.getStatistics();
+  ASSERT_EQ(1, stats.size());
+  EXPECT_EQ("remove-identities", stats[0].name);
+  EXPECT_EQ(3, stats[0].nbRuns);
+  EXPECT_GE(stats[0].seconds, 0.0);
+  // Not collected by default
+  EXPECT_EQ(0, stats[0].before.nbGates);
+  EXPECT_TRUE(passManager.getRecords().empty());
+
+  passManager.clearCache();
+  passManager.run(makeCircuit("again", 0.5));
+  EXPECT_EQ(4, pass->nbCalls);
+}
+
+TEST(PassManagerTester, checkParallel) {
+  auto pass = std::make_shared<RemoveIdentities>();
+  PassManager passManager;
+  passManager.addPass(pass).addPass(pass);
+  std::vector<std::shared_ptr<xacc::CompositeInstruction>> programs;
+  for (int i = 0; i < 64; ++i) {
+    programs.emplace_back(makeCircuit("circuit_" + std::to_string(i), i));
+  }
+  passManager.run(programs);
+  EXPECT_EQ(128, pass->nbCalls);
+  EXPECT_EQ(0, passManager.getCacheHits());
+  for (int i = 0; i < 64; ++i) {
+    ASSERT_EQ(3, programs[i]->nInstructions());
+    EXPECT_NEAR(i, programs[i]->getInstruction(2)->getParameter(0).as<double>(),
+                1e-12);
+  }
+  const auto stats = passManager.getStatistics();
+  ASSERT_EQ(2, stats.size());
+  EXPECT_EQ(64, stats[1].nbRuns);
+}
+
+TEST(PassManagerTester, checkStatistics) {
+  auto pass = std::make_shared<RemoveIdentities>();
+  PassManager passManager;
+  passManager.addPass(pass).addPass(pass);
+  passManager.setCollectStatistics(true);
+  passManager.run(makeCircuit("circuit", 0.5));
+
+  const auto stats = passManager.getStatistics();
+  ASSERT_EQ(2, stats.size());
+  EXPECT_EQ(5, stats[0].before.nbGates);
+  EXPECT_EQ(1, stats[0].before.nbTwoQubitGates);
+  EXPECT_EQ(3, stats[0].before.depth);
+  EXPECT_EQ(3, stats[0].after.nbGates);
+  EXPECT_EQ(3, stats[1].before.nbGates);
+  EXPECT_EQ(3, stats[1].after.nbGates);
+  EXPECT_EQ(1, stats[1].after.nbTwoQubitGates);
+  EXPECT_EQ(3, stats[1].after.depth);
+
+  const auto records = passManager.getRecords();
+  ASSERT_EQ(2, records.size());
+  EXPECT_EQ(0, records[0].passIdx);
+  EXPECT_EQ(1, records[1].passIdx);
+  EXPECT_EQ("circuit", records[0].circuitName);
+  EXPECT_LE(records[0].startSeconds + records[0].seconds,
+            records[1].startSeconds);
+
+  rapidjson::Document json;
+  json.Parse(passManager.toJson().c_str());
+  ASSERT_FALSE(json.HasParseError());
+  EXPECT_EQ(2, json["passes"].GetArray().Size());
+  EXPECT_EQ(5, json["passes"][0]["before"]["gates"].GetInt());
+  EXPECT_EQ(2, json["records"].GetArray().Size());
+
+  rapidjson::Document trace;
+  trace.Parse(passManager.toChromeTrace().c_str());
+  ASSERT_FALSE(trace.HasParseError());
+  const auto &events = trace["traceEvents"];
+  ASSERT_EQ(2, events.GetArray().Size());
+  EXPECT_EQ(std::string("X"), events[0]["ph"].GetString());
+  EXPECT_EQ(std::string("remove-identities"), events[1]["name"].GetString());
+  EXPECT_EQ(3, events[1]["args"]["after"]["gates"].GetInt());
+
+  passManager.clearStatistics();
+  EXPECT_TRUE(passManager.getRecords().empty());
+  EXPECT_EQ(0, passManager.getStatistics()[0].nbRuns);
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize(argc, argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
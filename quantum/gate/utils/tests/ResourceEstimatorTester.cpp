@@ -0,0 +1,116 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include <gtest/gtest.h>
+#include "CommonGates.hpp"
+#include "ResourceEstimator.hpp"
+#include "xacc.hpp"
+
+using namespace xacc::quantum;
+
+namespace {
+std::shared_ptr<Circuit> makeCircuit(double angle) {
+  auto circuit = std::make_shared<Circuit>("circuit");
+  circuit->addInstruction(std::make_shared<Hadamard>(0));
+  circuit->addInstruction(std::make_shared<T>(1));
+  circuit->addInstruction(std::make_shared<CNOT>(0, 1));
+  circuit->addInstruction(std::make_shared<Rz>(1, angle));
+  circuit->addInstruction(std::make_shared<Rx>(2, 0.3));
+  circuit->addInstruction(std::make_shared<Measure>(0));
+  circuit->addInstruction(std::make_shared<Measure>(1));
+  return circuit;
+}
+} // namespace
+
+TEST(ResourceEstimatorTester, checkEstimate) {
+  TimingModel model;
+  model.singleQubitNs = 10.0;
+  model.twoQubitNs = 100.0;
+  model.measureNs = 1000.0;
+  model.shotOverheadNs = 500.0;
+  ResourceEstimator estimator(model);
+
+  const auto estimate = estimator.estimate(makeCircuit(M_PI / 4), 1000);
+  EXPECT_EQ(3, estimate.nbQubits);
+  EXPECT_EQ(7, estimate.nbGates);
+  EXPECT_EQ(1, estimate.nbTwoQubitGates);
+  // T and Rz(pi / 4)
+  EXPECT_EQ(2, estimate.nbTGates);
+  EXPECT_EQ(1, estimate.nbNonCliffordRotations);
+  EXPECT_EQ(2, estimate.nbMeasurements);
+  // H, CNOT, Rz, Measure(1)
+  EXPECT_EQ(4, estimate.depth);
+  EXPECT_NEAR(128.0, estimate.stateVectorBytes, 1e-12);
+  // H (10) -> CNOT (100) -> Measure (1000), virtual T and Rz
+  EXPECT_NEAR(1110.0, estimate.durationNs, 1e-9);
+  EXPECT_NEAR(1000 * 1610.0 * 1e-9, estimate.runtimeSeconds, 1e-12);
+
+  // Clifford angle
+  EXPECT_EQ(1, estimator.estimate(makeCircuit(M_PI / 2)).nbTGates);
+
+  // Batched
+  std::vector<std::shared_ptr<xacc::CompositeInstruction>> programs;
+  for (int i = 0; i < 8; ++i) {
+    programs.emplace_back(makeCircuit(i * M_PI / 4));
+  }
+  const auto estimates = estimator.estimate(programs, 10);
+  ASSERT_EQ(8, estimates.size());
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(i % 2 ? 2 : 1, estimates[i].nbTGates);
+    EXPECT_EQ(4, estimates[i].depth);
+  }
+}
+
+TEST(ResourceEstimatorTester, checkIbmProperties) {
+  const std::string properties = R"({
+    "qubits": [
+      [{"name": "T1", "unit": "us", "value": 100.0},
+       {"name": "readout_length", "unit": "us", "value": 2.0}],
+      [{"name": "readout_length", "unit": "ns", "value": 3000.0}]
+    ],
+    "gates": [
+      {"gate": "sx", "qubits": [0], "parameters": [
+        {"name": "gate_error", "unit": "", "value": 0.001},
+        {"name": "gate_length", "unit": "ns", "value": 20.0}]},
+      {"gate": "x", "qubits": [0], "parameters": [
+        {"name": "gate_length", "unit": "ns", "value": 50.0}]},
+      {"gate": "sx", "qubits": [1], "parameters": [
+        {"name": "gate_length", "unit": "ns", "value": 40.0}]},
+      {"gate": "cx", "qubits": [0, 1], "parameters": [
+        {"name": "gate_length", "unit": "ns", "value": 400.0}]}
+    ]
+  })";
+  const auto model = TimingModel::fromIbmProperties(
+      properties, R"({"default_rep_delay": 250.0})");
+  EXPECT_NEAR(20.0, model.singleQubitOverrides.at(0), 1e-12);
+  EXPECT_NEAR(30.0, model.singleQubitNs, 1e-12);
+  EXPECT_NEAR(2000.0, model.measureOverrides.at(0), 1e-12);
+  EXPECT_NEAR(2500.0, model.measureNs, 1e-12);
+  EXPECT_NEAR(400.0, model.twoQubitNs, 1e-12);
+  EXPECT_NEAR(250000.0, model.shotOverheadNs, 1e-9);
+
+  // The cx of (0, 1) in the other direction
+  CNOT cx(1, 0);
+  EXPECT_NEAR(400.0, model.duration(cx), 1e-12);
+  Ry ry(1, 0.5);
+  EXPECT_NEAR(80.0, model.duration(ry), 1e-12);
+  Measure measure(1);
+  EXPECT_NEAR(3000.0, model.duration(measure), 1e-12);
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize(argc, argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
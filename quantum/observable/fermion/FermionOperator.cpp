@@ -18,6 +18,186 @@
 #include "FermionOperatorLexer.h"
 #include "ObservableTransform.hpp"
 #include "xacc_service.hpp"
+#include <cctype>
+
+namespace {
+using xacc::quantum::FermionTerm;
+using xacc::quantum::Operators;
+
+void skipSpaces(const char *&io_pos, const char *in_end) {
+  while (io_pos != in_end && std::isspace(static_cast<unsigned char>(*io_pos))) {
+    ++io_pos;
+  }
+}
+
+bool skipDigits(const char *&io_pos, const char *in_end) {
+  const char *start = io_pos;
+  while (io_pos != in_end && std::isdigit(static_cast<unsigned char>(*io_pos))) {
+    ++io_pos;
+  }
+  return io_pos != start;
+}
+
+// [-]digits[.digits][e[-]digits] or [-].digits[e[-]digits], out_isInteger
+// if there is neither a fraction nor an exponent.
+bool parseNumber(const char *&io_pos, const char *in_end, double &out_value,
+                 bool &out_isInteger) {
+  const char *pos = io_pos;
+  if (pos != in_end && *pos == '-') {
+    ++pos;
+  }
+  bool hasMantissa = skipDigits(pos, in_end);
+  out_isInteger = true;
+  if (pos != in_end && *pos == '.') {
+    ++pos;
+    if (!skipDigits(pos, in_end)) {
+      return false;
+    }
+    hasMantissa = true;
+    out_isInteger = false;
+  }
+  if (!hasMantissa) {
+    return false;
+  }
+  if (pos != in_end && (*pos == 'e' || *pos == 'E')) {
+    ++pos;
+    if (pos != in_end && (*pos == '-' || *pos == '+')) {
+      ++pos;
+    }
+    if (!skipDigits(pos, in_end)) {
+      return false;
+    }
+    out_isInteger = false;
+  }
+  // The source is null-terminated and strtod stops where the scan above did.
+  out_value = std::strtod(io_pos, nullptr);
+  io_pos = pos;
+  return true;
+}
+
+// (real, real), the parts may be integers
+bool parseComplex(const char *&io_pos, const char *in_end,
+                  std::complex<double> &out_coeff) {
+  double parts[2];
+  bool isInteger;
+  ++io_pos;
+  for (int i = 0; i < 2; ++i) {
+    skipSpaces(io_pos, in_end);
+    if (!parseNumber(io_pos, in_end, parts[i], isInteger)) {
+      return false;
+    }
+    skipSpaces(io_pos, in_end);
+    if (io_pos == in_end || *io_pos++ != (i == 0 ? ',' : ')')) {
+      return false;
+    }
+  }
+  out_coeff = std::complex<double>(parts[0], parts[1]);
+  return true;
+}
+
+// Hand-written fast path of fromString() for the canonical form (as written
+// by toString()): "coeff 3^ 2 + coeff 1^ 0 - ...", where coeff is a real
+// with a fraction or exponent, or (real, imag). A leading integer is only
+// read as an operator if it is a creation one (e.g. "3^ 2"), since the
+// grammar is ambiguous otherwise. Like terms are summed into out_terms as
+// they are read, without a parse tree. Returns false on anything else,
+// which is left to the ANTLR grammar.
+bool parseCanonical(const std::string &in_src,
+                    std::unordered_map<std::string, FermionTerm> &out_terms) {
+  const char *pos = in_src.c_str();
+  const char *end = pos + in_src.size();
+  skipSpaces(pos, end);
+  if (pos == end) {
+    return false;
+  }
+  double sign = 1.0;
+  std::string id;
+  while (true) {
+    skipSpaces(pos, end);
+    if (pos == end) {
+      return false;
+    }
+    bool hasCoeff = false;
+    std::complex<double> coeff(1.0, 0.0);
+    if (*pos == '(') {
+      if (!parseComplex(pos, end, coeff)) {
+        return false;
+      }
+      hasCoeff = true;
+    } else if (*pos == '-' || *pos == '.' ||
+               std::isdigit(static_cast<unsigned char>(*pos))) {
+      const char *start = pos;
+      double real;
+      bool isInteger;
+      if (!parseNumber(pos, end, real, isInteger)) {
+        return false;
+      }
+      if (isInteger) {
+        // Parsed again below as an operator
+        pos = start;
+      } else {
+        coeff = real;
+        hasCoeff = true;
+      }
+    }
+
+    Operators ops;
+    id.clear();
+    while (true) {
+      skipSpaces(pos, end);
+      if (pos == end || *pos == '+' || *pos == '-') {
+        break;
+      }
+      const char *digits = pos;
+      if (!skipDigits(pos, end) || pos - digits > 9) {
+        return false;
+      }
+      const bool isCreation = pos != end && *pos == '^';
+      if (!hasCoeff && ops.empty() && !isCreation) {
+        return false;
+      }
+      pos += isCreation;
+      ops.emplace_back(std::atoi(digits), isCreation);
+      // As FermionTerm::id()
+      id.append(std::to_string(ops.back().first))
+          .append(isCreation ? "^ " : " ");
+    }
+    if (!hasCoeff && ops.empty()) {
+      return false;
+    }
+    if (pos != end && *pos == '-' && pos + 1 != end &&
+        (std::isdigit(static_cast<unsigned char>(pos[1])) || pos[1] == '.')) {
+      // A negative number, e.g. a negative mode index
+      return false;
+    }
+
+    coeff *= sign;
+    if (ops.empty()) {
+      id = "I";
+    }
+    auto iter = out_terms.find(id);
+    if (iter != out_terms.end()) {
+      iter->second.coeff() += coeff;
+    } else {
+      out_terms.emplace(id, FermionTerm(coeff, std::move(ops)));
+    }
+
+    if (pos == end) {
+      break;
+    }
+    sign = *pos++ == '-' ? -1.0 : 1.0;
+  }
+
+  for (auto iter = out_terms.begin(); iter != out_terms.end();) {
+    if (std::abs(iter->second.coeff()) < 1e-12) {
+      iter = out_terms.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+  return true;
+}
+} // namespace
 
 namespace xacc {
 namespace quantum {
@@ -110,6 +290,12 @@ const std::string FermionOperator::toString() {
 }
 
 void FermionOperator::fromString(const std::string str) {
+  std::unordered_map<std::string, FermionTerm> parsed;
+  if (parseCanonical(str, parsed)) {
+    terms = std::move(parsed);
+    return;
+  }
+
   using namespace antlr4;
   using namespace fermion;
 
@@ -159,6 +159,8 @@ public:
   std::vector<std::shared_ptr<CompositeInstruction>>
   observe(std::shared_ptr<CompositeInstruction> function) override;
   const std::string toString() override;
+  // The canonical form ("coeff 3^ 2 + ...") is read by a hand-written
+  // streaming parser, anything else by the ANTLR grammar.
   void fromString(const std::string str) override;
   const int nBits() override;
 
@@ -170,6 +170,21 @@ TEST(FermionOperatorTester, checkNormalize) {
 }
 
 
+TEST(FermionOperatorTester, checkCanonicalParsing) {
+    FermionOperator op("(0.5,-1) 3^ 2 + 1.5e-3 1^ 0 - 0.25 3^ 2 + (2, 0)");
+    EXPECT_EQ(3, op.getTerms().size());
+    auto terms = op.getTerms();
+    EXPECT_NEAR(0.25, terms["3^ 2 "].coeff().real(), 1e-12);
+    EXPECT_NEAR(-1.0, terms["3^ 2 "].coeff().imag(), 1e-12);
+    EXPECT_NEAR(1.5e-3, terms["1^ 0 "].coeff().real(), 1e-12);
+    EXPECT_NEAR(2.0, terms["I"].coeff().real(), 1e-12);
+
+    // toString() round trip
+    FermionOperator roundTrip(op.toString());
+    EXPECT_TRUE(roundTrip == op);
+    EXPECT_NEAR(-1.0, roundTrip.getTerms()["3^ 2 "].coeff().imag(), 1e-12);
+}
+
 int main(int argc, char** argv) {
     xacc::Initialize(argc,argv);
    ::testing::InitGoogleTest(&argc, argv);
@@ -12,7 +12,14 @@
  *******************************************************************************/
 #include "PauliOperator.hpp"
 #include "IRProvider.hpp"
+#include "SymplecticPauli.hpp"
+#include <algorithm>
+#include <bitset>
+#include <cctype>
 #include <cmath>
+#include <cstring>
+#include <fstream>
+#include <mutex>
 #include <regex>
 #include <set>
 #include <iostream>
@@ -27,6 +34,220 @@
 
 #include <armadillo>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+// Below this many pairs of terms, operator products are computed serially.
+constexpr size_t PARALLEL_MIN_PAIRS = 1 << 14;
+
+using xacc::quantum::Term;
+
+void skipSpaces(const char *&io_pos, const char *in_end) {
+  while (io_pos != in_end && std::isspace(static_cast<unsigned char>(*io_pos))) {
+    ++io_pos;
+  }
+}
+
+bool skipDigits(const char *&io_pos, const char *in_end) {
+  const char *start = io_pos;
+  while (io_pos != in_end && std::isdigit(static_cast<unsigned char>(*io_pos))) {
+    ++io_pos;
+  }
+  return io_pos != start;
+}
+
+// [-]digits[.digits][e[-]digits] or [-].digits[e[-]digits]
+bool parseNumber(const char *&io_pos, const char *in_end, double &out_value) {
+  const char *pos = io_pos;
+  if (pos != in_end && *pos == '-') {
+    ++pos;
+  }
+  bool hasMantissa = skipDigits(pos, in_end);
+  if (pos != in_end && *pos == '.') {
+    ++pos;
+    if (!skipDigits(pos, in_end)) {
+      return false;
+    }
+    hasMantissa = true;
+  }
+  if (!hasMantissa) {
+    return false;
+  }
+  if (pos != in_end && (*pos == 'e' || *pos == 'E')) {
+    ++pos;
+    if (pos != in_end && (*pos == '-' || *pos == '+')) {
+      ++pos;
+    }
+    if (!skipDigits(pos, in_end)) {
+      return false;
+    }
+  }
+  // The source is null-terminated and strtod stops where the scan above did.
+  out_value = std::strtod(io_pos, nullptr);
+  io_pos = pos;
+  return true;
+}
+
+// real or (real, real)
+bool parseCoefficient(const char *&io_pos, const char *in_end,
+                      std::complex<double> &out_coeff) {
+  if (*io_pos != '(') {
+    double real;
+    if (!parseNumber(io_pos, in_end, real)) {
+      return false;
+    }
+    out_coeff = real;
+    return true;
+  }
+  double real, imag;
+  ++io_pos;
+  skipSpaces(io_pos, in_end);
+  if (!parseNumber(io_pos, in_end, real)) {
+    return false;
+  }
+  skipSpaces(io_pos, in_end);
+  if (io_pos == in_end || *io_pos++ != ',') {
+    return false;
+  }
+  skipSpaces(io_pos, in_end);
+  if (!parseNumber(io_pos, in_end, imag)) {
+    return false;
+  }
+  skipSpaces(io_pos, in_end);
+  if (io_pos == in_end || *io_pos++ != ')') {
+    return false;
+  }
+  out_coeff = std::complex<double>(real, imag);
+  return true;
+}
+
+// Hand-written fast path of fromString() for the canonical form (as written
+// by toString()): "coeff X0 Y1 + coeff Z2 - ...", with an optional real or
+// (real, imag) coefficient and at most one Pauli per qubit in each term.
+// Like terms are summed into out_terms as they are read, without a parse
+// tree. Returns false on anything else, which is left to the ANTLR grammar.
+bool parseCanonical(const std::string &in_src,
+                    std::map<std::string, Term> &out_terms) {
+  const char *pos = in_src.c_str();
+  const char *end = pos + in_src.size();
+  skipSpaces(pos, end);
+  if (pos == end) {
+    return false;
+  }
+  double sign = 1.0;
+  while (true) {
+    skipSpaces(pos, end);
+    if (pos == end) {
+      return false;
+    }
+    bool isEmpty = true;
+    std::complex<double> coeff(1.0, 0.0);
+    if (*pos == '(' || *pos == '-' || *pos == '.' ||
+        std::isdigit(static_cast<unsigned char>(*pos))) {
+      if (!parseCoefficient(pos, end, coeff)) {
+        return false;
+      }
+      isEmpty = false;
+    }
+    std::map<int, std::string> ops;
+    while (true) {
+      skipSpaces(pos, end);
+      if (pos == end || *pos == '+' || *pos == '-') {
+        break;
+      }
+      const char pauli = *pos++;
+      isEmpty = false;
+      if (pauli == 'I') {
+        continue;
+      }
+      const char *digits = pos;
+      if ((pauli != 'X' && pauli != 'Y' && pauli != 'Z') ||
+          !skipDigits(pos, end) || pos - digits > 9) {
+        return false;
+      }
+      const int qubit = std::atoi(digits);
+      if (!ops.emplace(qubit, std::string(1, pauli)).second) {
+        // e.g. X0 Y0, needs the Pauli products
+        return false;
+      }
+    }
+    if (isEmpty) {
+      return false;
+    }
+
+    coeff *= sign;
+    auto id = Term::id(ops);
+    auto iter = out_terms.lower_bound(id);
+    if (iter != out_terms.end() && iter->first == id) {
+      iter->second.coeff() += coeff;
+    } else {
+      out_terms.emplace_hint(iter, std::move(id), Term(coeff, std::move(ops)));
+    }
+
+    if (pos == end) {
+      break;
+    }
+    sign = *pos++ == '-' ? -1.0 : 1.0;
+  }
+
+  for (auto iter = out_terms.begin(); iter != out_terms.end();) {
+    if (std::abs(iter->second.coeff()) < 1e-12) {
+      iter = out_terms.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+  return true;
+}
+
+// Binary file layout (native byte order): this header, then for each term
+// its nbWords X words, nbWords Z words (see SymplecticPauli) and the real
+// and imaginary parts of its coefficient.
+struct BinaryHeader {
+  char magic[8];
+  uint64_t version;
+  uint64_t nbWords;
+  uint64_t nbTerms;
+};
+constexpr char BINARY_MAGIC[8] = {'X', 'A', 'C', 'C', 'P', 'A', 'U', 'L'};
+constexpr uint64_t BINARY_VERSION = 1;
+
+// Read-only mapping of a whole file, unmapped on destruction.
+class MappedFile {
+public:
+  MappedFile(const std::string &in_fileName) {
+    const int fd = open(in_fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return;
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0) {
+      void *data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        m_data = static_cast<const char *>(data);
+        m_size = fileStat.st_size;
+        madvise(data, m_size, MADV_SEQUENTIAL);
+      }
+    }
+    close(fd);
+  }
+  ~MappedFile() {
+    if (m_data) {
+      munmap(const_cast<char *>(m_data), m_size);
+    }
+  }
+  const char *data() const { return m_data; }
+  size_t size() const { return m_size; }
+
+private:
+  const char *m_data = nullptr;
+  size_t m_size = 0;
+};
+} // namespace
+
 namespace xacc {
 namespace quantum {
 
@@ -128,7 +349,8 @@ PauliOperator::PauliOperator(std::complex<double> c, std::string var) {
                 std::forward_as_tuple(c, var));
 }
 
-PauliOperator::PauliOperator(const PauliOperator &i) : terms(i.terms) {}
+PauliOperator::PauliOperator(const PauliOperator &i)
+    : terms(i.terms), grouping(i.grouping) {}
 
 /**
  * The Constructor, takes a vector of
@@ -178,43 +400,147 @@ std::complex<double> PauliOperator::coefficient() {
   }
   return terms.begin()->second.coeff();
 }
-std::vector<std::shared_ptr<CompositeInstruction>>
-PauliOperator::observe(std::shared_ptr<CompositeInstruction> function) {
-
-  // Create a new GateQIR to hold the spin based terms
-  auto gateRegistry = xacc::getService<IRProvider>("quantum");
-  std::vector<std::shared_ptr<CompositeInstruction>> observed;
-  int counter = 0;
-  auto pi = xacc::constants::pi;
-
-  // If the incoming function has instructions that have
-  // their buffer_names set, then we need to set the
-  // new measurement instructions buffer names to be the same.
-  // Here we assume that all instructions have the same buffer name
-  std::string buf_name = "";
-
-  if (function->nInstructions() > 0 &&
-      !function->getInstruction(0)->getBufferNames().empty()) {
-    buf_name = function->getInstruction(0)->getBufferNames()[0];
+void PauliOperator::fromOptions(const HeterogeneousMap &options) {
+  if (options.stringExists("grouping")) {
+    auto mode = options.getString("grouping");
+    if (mode == "none") {
+      mode = "";
+    }
+    if (!mode.empty() && mode != "qwc") {
+      xacc::error("Invalid PauliOperator grouping mode: " + mode +
+                  ". Valid modes are none and qwc.");
+    }
+    grouping = mode;
   }
+  return;
+}
 
-  // Populate GateQIR now...
+std::vector<std::pair<std::map<int, std::string>, std::vector<std::string>>>
+PauliOperator::qubitWiseCommutingGroups() {
+  // Greedy first-fit, placing the highest weight terms first.
+  std::vector<std::pair<std::string, std::map<int, std::string>>> toPlace;
   for (auto &inst : terms) {
+    if (inst.second.isIdentity()) {
+      continue;
+    }
+    std::map<int, std::string> ops;
+    for (auto &kv : inst.second.ops()) {
+      if (kv.second != "I" && !kv.second.empty()) {
+        ops.insert(kv);
+      }
+    }
+    toPlace.push_back({inst.first, ops});
+  }
+  std::stable_sort(toPlace.begin(), toPlace.end(),
+                   [](const auto &a, const auto &b) {
+                     return a.second.size() > b.second.size();
+                   });
+
+  std::vector<std::pair<std::map<int, std::string>, std::vector<std::string>>>
+      groups;
+  for (auto &[termId, ops] : toPlace) {
+    bool placed = false;
+    for (auto &[basis, termIds] : groups) {
+      const bool qwc = std::all_of(ops.begin(), ops.end(), [&](auto &kv) {
+        auto iter = basis.find(kv.first);
+        return iter == basis.end() || iter->second == kv.second;
+      });
+      if (qwc) {
+        basis.insert(ops.begin(), ops.end());
+        termIds.push_back(termId);
+        placed = true;
+        break;
+      }
+    }
+    if (!placed) {
+      groups.push_back({ops, {termId}});
+    }
+  }
+  return groups;
+}
 
-    Term spinInst = inst.second;
-
-    auto gateFunction =
-        gateRegistry->createComposite(inst.first, function->getVariables());
+bool PauliOperator::measurementPlanIsValid(const std::string &bufferName) {
+  if (!measurementPlan || measurementPlan->bufferName != bufferName ||
+      measurementPlan->grouping != grouping ||
+      measurementPlan->termIds.size() != terms.size()) {
+    return false;
+  }
+  int termIdx = 0;
+  for (auto &inst : terms) {
+    if (measurementPlan->termIds[termIdx] != inst.first) {
+      return false;
+    }
+    termIdx++;
+  }
+  return true;
+}
 
-    gateFunction->setCoefficient(spinInst.coeff());
+std::shared_ptr<PauliOperator::MeasurementPlan>
+PauliOperator::buildMeasurementPlan(const std::string &bufferName) {
+  auto gateRegistry = xacc::getService<IRProvider>("quantum");
+  auto pi = xacc::constants::pi;
+  auto plan = std::make_shared<MeasurementPlan>();
+  plan->bufferName = bufferName;
+  plan->grouping = grouping;
+  for (auto &inst : terms) {
+    plan->termIds.push_back(inst.first);
+  }
 
-    if (function->hasChildren()) {
-      gateFunction->addInstruction(function->clone());
+  const auto createBasisChange = [&](std::size_t qbit,
+                                     const std::string &gateName)
+      -> std::shared_ptr<Instruction> {
+    std::shared_ptr<Instruction> gate;
+    if (gateName == "X") {
+      gate = gateRegistry->createInstruction("H",
+                                             std::vector<std::size_t>{qbit});
+    } else if (gateName == "Y") {
+      gate = gateRegistry->createInstruction("Rx",
+                                             std::vector<std::size_t>{qbit});
+      InstructionParameter p(pi / 2.0);
+      gate->setParameter(0, p);
     }
+    if (gate && !bufferName.empty())
+      gate->setBufferNames({bufferName});
+    return gate;
+  };
 
-    for (auto arg : function->getArguments()) {
-      gateFunction->addArgument(arg, 0);
+  if (grouping == "qwc") {
+    if (terms.count("I")) {
+      plan->kernels.push_back({"I", "I", {}});
+    }
+    for (auto &[basis, termIds] : qubitWiseCommutingGroups()) {
+      MeasuredKernel kernel;
+      kernel.name = Term::id(basis);
+      std::vector<std::shared_ptr<xacc::Instruction>> measurements;
+      // Measure the basis qubits in ascending order into
+      // consecutive classical bits, postProcess() relies on this.
+      int classicalIdx = 0;
+      for (auto &[qbit, gateName] : basis) {
+        std::size_t tt = qbit;
+        auto gate = createBasisChange(tt, gateName);
+        if (gate) {
+          kernel.instructions.push_back(gate);
+        }
+        auto meas = gateRegistry->createInstruction(
+            "Measure", std::vector<std::size_t>{tt});
+        if (!bufferName.empty())
+          meas->setBufferNames({bufferName});
+        xacc::InstructionParameter cIdx(classicalIdx++);
+        meas->setParameter(0, cIdx);
+        measurements.push_back(meas);
+      }
+      kernel.instructions.insert(kernel.instructions.end(),
+                                 measurements.begin(), measurements.end());
+      plan->kernels.emplace_back(std::move(kernel));
     }
+    return plan;
+  }
+
+  for (auto &inst : terms) {
+    Term spinInst = inst.second;
+    MeasuredKernel kernel;
+    kernel.name = inst.first;
+    kernel.termId = inst.first;
 
     // Loop over all terms in the Spin Instruction
     // and create instructions to run on the Gate QPU.
@@ -235,37 +561,77 @@ PauliOperator::observe(std::shared_ptr<CompositeInstruction> function) {
       auto gateName = terms[i].second;
       auto meas = gateRegistry->createInstruction("Measure",
                                                   std::vector<std::size_t>{tt});
-      if (!buf_name.empty())
-        meas->setBufferNames({buf_name});
+      if (!bufferName.empty())
+        meas->setBufferNames({bufferName});
       xacc::InstructionParameter classicalIdx(qbit);
       meas->setParameter(0, classicalIdx);
       measurements.push_back(meas);
 
-      if (gateName == "X") {
-        auto hadamard =
-            gateRegistry->createInstruction("H", std::vector<std::size_t>{tt});
-        if (!buf_name.empty())
-          hadamard->setBufferNames({buf_name});
-        gateFunction->addInstruction(hadamard);
-      } else if (gateName == "Y") {
-        auto rx =
-            gateRegistry->createInstruction("Rx", std::vector<std::size_t>{tt});
-        if (!buf_name.empty())
-          rx->setBufferNames({buf_name});
-        InstructionParameter p(pi / 2.0);
-        rx->setParameter(0, p);
-        gateFunction->addInstruction(rx);
+      auto gate = createBasisChange(tt, gateName);
+      if (gate) {
+        kernel.instructions.push_back(gate);
       }
     }
 
     if (!spinInst.isIdentity()) {
       for (auto m : measurements) {
-        gateFunction->addInstruction(m);
+        kernel.instructions.push_back(m);
       }
     }
 
+    plan->kernels.emplace_back(std::move(kernel));
+  }
+  return plan;
+}
+
+std::vector<std::shared_ptr<CompositeInstruction>>
+PauliOperator::observe(std::shared_ptr<CompositeInstruction> function) {
+
+  // Create a new GateQIR to hold the spin based terms
+  auto gateRegistry = xacc::getService<IRProvider>("quantum");
+  std::vector<std::shared_ptr<CompositeInstruction>> observed;
+
+  // If the incoming function has instructions that have
+  // their buffer_names set, then we need to set the
+  // new measurement instructions buffer names to be the same.
+  // Here we assume that all instructions have the same buffer name
+  std::string buf_name = "";
+
+  if (function->nInstructions() > 0 &&
+      !function->getInstruction(0)->getBufferNames().empty()) {
+    buf_name = function->getInstruction(0)->getBufferNames()[0];
+  }
+
+  if (!measurementPlanIsValid(buf_name)) {
+    measurementPlan = buildMeasurementPlan(buf_name);
+  }
+
+  const auto variables = function->getVariables();
+  const auto arguments = function->getArguments();
+  const bool hasChildren = function->hasChildren();
+
+  // Populate GateQIR now...
+  for (auto &kernel : measurementPlan->kernels) {
+    auto gateFunction = gateRegistry->createComposite(kernel.name, variables);
+    gateFunction->setCoefficient(
+        kernel.termId.empty() ? std::complex<double>(1.0, 0.0)
+                              : terms.at(kernel.termId).coeff());
+
+    if (hasChildren) {
+      gateFunction->addInstruction(function->clone());
+    }
+
+    for (auto arg : arguments) {
+      gateFunction->addArgument(arg, 0);
+    }
+
+    // Clone so that any transformation of the observed
+    // kernels does not modify the cached instructions.
+    for (auto &m : kernel.instructions) {
+      gateFunction->addInstruction(m->clone());
+    }
+
     observed.push_back(gateFunction);
-    counter++;
   }
   return observed;
 }
@@ -425,6 +791,12 @@ const std::string PauliOperator::toString() {
 }
 
 void PauliOperator::fromString(const std::string str) {
+  std::map<std::string, Term> parsed;
+  if (parseCanonical(str, parsed)) {
+    terms = std::move(parsed);
+    return;
+  }
+
   using namespace antlr4;
   using namespace pauli;
 
@@ -449,6 +821,163 @@ void PauliOperator::fromString(const std::string str) {
   operator+=(listener.getOperator());
 }
 
+void PauliOperator::toBinaryFile(const std::string &fileName) const {
+  std::vector<SymplecticPauli> paulis;
+  paulis.reserve(terms.size());
+  size_t nbWords = 0;
+  for (auto &kv : terms) {
+    if (!std::get<1>(kv.second).empty()) {
+      xacc::error("PauliOperator::toBinaryFile: variable coefficient '" +
+                  std::get<1>(kv.second) + "' is not supported.");
+    }
+    paulis.emplace_back(std::get<2>(kv.second));
+    nbWords = std::max(nbWords, paulis.back().xWords().size());
+  }
+
+  std::ofstream out(fileName, std::ios::binary);
+  if (!out) {
+    xacc::error("PauliOperator::toBinaryFile: cannot open " + fileName + ".");
+  }
+  BinaryHeader header;
+  std::memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+  header.version = BINARY_VERSION;
+  header.nbWords = nbWords;
+  header.nbTerms = terms.size();
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  std::vector<uint64_t> words(2 * nbWords);
+  size_t termIdx = 0;
+  for (auto &kv : terms) {
+    const auto &pauli = paulis[termIdx++];
+    std::fill(words.begin(), words.end(), 0);
+    std::copy(pauli.xWords().begin(), pauli.xWords().end(), words.begin());
+    std::copy(pauli.zWords().begin(), pauli.zWords().end(),
+              words.begin() + nbWords);
+    const double coeff[2] = {std::get<0>(kv.second).real(),
+                             std::get<0>(kv.second).imag()};
+    out.write(reinterpret_cast<const char *>(words.data()),
+              words.size() * sizeof(uint64_t));
+    out.write(reinterpret_cast<const char *>(coeff), sizeof(coeff));
+  }
+  if (!out) {
+    xacc::error("PauliOperator::toBinaryFile: failed to write " + fileName +
+                ".");
+  }
+}
+
+void PauliOperator::fromBinaryFile(const std::string &fileName) {
+  const MappedFile file(fileName);
+  if (!file.data()) {
+    xacc::error("PauliOperator::fromBinaryFile: cannot read " + fileName + ".");
+  }
+  BinaryHeader header;
+  if (file.size() < sizeof(header)) {
+    xacc::error("PauliOperator::fromBinaryFile: " + fileName +
+                " is not a binary Pauli operator file.");
+  }
+  std::memcpy(&header, file.data(), sizeof(header));
+  const size_t recordSize =
+      2 * header.nbWords * sizeof(uint64_t) + 2 * sizeof(double);
+  if (std::memcmp(header.magic, BINARY_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != BINARY_VERSION ||
+      (file.size() - sizeof(header)) / recordSize != header.nbTerms ||
+      (file.size() - sizeof(header)) % recordSize != 0) {
+    xacc::error("PauliOperator::fromBinaryFile: " + fileName +
+                " is not a binary Pauli operator file.");
+  }
+
+  clear();
+  std::vector<uint64_t> x(header.nbWords), z(header.nbWords);
+  double coeff[2];
+  const char *record = file.data() + sizeof(header);
+  for (uint64_t i = 0; i < header.nbTerms; ++i, record += recordSize) {
+    // The records are not necessarily aligned
+    std::memcpy(x.data(), record, x.size() * sizeof(uint64_t));
+    std::memcpy(z.data(), record + x.size() * sizeof(uint64_t),
+                z.size() * sizeof(uint64_t));
+    std::memcpy(coeff, record + 2 * x.size() * sizeof(uint64_t),
+                sizeof(coeff));
+    Term term(std::complex<double>(coeff[0], coeff[1]),
+              SymplecticPauli(x, z).toOps());
+    // Written from a PauliOperator: ids are unique and in increasing order
+    terms.emplace_hint(terms.end(), term.id(), std::move(term));
+  }
+}
+
+void PauliOperator::fromSymplectic(const uint64_t *x, const uint64_t *z,
+                                   const size_t nbWords,
+                                   const std::complex<double> *coeffs,
+                                   const size_t nbTerms) {
+  clear();
+  std::vector<uint64_t> xw(nbWords), zw(nbWords);
+  for (size_t t = 0; t < nbTerms; ++t) {
+    std::copy(x + t * nbWords, x + (t + 1) * nbWords, xw.begin());
+    std::copy(z + t * nbWords, z + (t + 1) * nbWords, zw.begin());
+    Term term(coeffs[t], SymplecticPauli(xw, zw).toOps());
+    auto id = term.id();
+    auto iter = terms.lower_bound(id);
+    if (iter != terms.end() && iter->first == id) {
+      iter->second.coeff() += coeffs[t];
+    } else {
+      terms.emplace_hint(iter, std::move(id), std::move(term));
+    }
+  }
+  for (auto iter = terms.begin(); iter != terms.end();) {
+    iter = std::abs(iter->second.coeff()) < 1e-12 ? terms.erase(iter)
+                                                  : std::next(iter);
+  }
+}
+
+std::complex<double>
+PauliOperator::expectationValue(const std::complex<double> *state,
+                                const size_t dim) {
+  if (dim == 0 || (dim & (dim - 1)) != 0) {
+    xacc::error("PauliOperator::expectationValue: the state dimension " +
+                std::to_string(dim) + " is not a power of 2.");
+  }
+  int n = 0;
+  while ((size_t(1) << n) < dim) {
+    ++n;
+  }
+  if (nQubits() > n) {
+    xacc::error("PauliOperator::expectationValue: a state of " +
+                std::to_string(n) + " qubits for an operator on " +
+                std::to_string(nQubits()) + ".");
+  }
+
+  // P |b> = i^nY (-1)^|b & zMask| |b ^ xMask>, in index bits
+  std::complex<double> total = 0.0;
+  for (auto &kv : terms) {
+    if (!kv.second.var().empty()) {
+      xacc::error("PauliOperator::expectationValue: variable coefficient " +
+                  kv.second.var() + ", evaluate the operator first.");
+    }
+    size_t xMask = 0, zMask = 0;
+    int nY = 0;
+    for (auto &op : kv.second.ops()) {
+      const size_t bit = size_t(1) << (n - 1 - op.first);
+      if (op.second == "X" || op.second == "Y") {
+        xMask |= bit;
+      }
+      if (op.second == "Z" || op.second == "Y") {
+        zMask |= bit;
+      }
+      nY += op.second == "Y";
+    }
+    double re = 0.0, im = 0.0;
+    for (size_t b = 0; b < dim; ++b) {
+      const auto amp = std::conj(state[b ^ xMask]) * state[b];
+      const double sign = std::bitset<64>(b & zMask).count() & 1 ? -1.0 : 1.0;
+      re += sign * amp.real();
+      im += sign * amp.imag();
+    }
+    static const std::complex<double> iPowers[] = {
+        {1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+    total += kv.second.coeff() * iPowers[nY % 4] * std::complex<double>(re, im);
+  }
+  return total;
+}
+
 bool PauliOperator::contains(PauliOperator &op) {
   if (op.nTerms() > 1)
     xacc::error("Cannot check PauliOperator.contains for more than 1 term.");
@@ -461,25 +990,25 @@ bool PauliOperator::contains(PauliOperator &op) {
 }
 
 bool PauliOperator::commutes(PauliOperator &op) {
-  return (op * (*this) - (*this) * op).nTerms() == 0;
+  if (hasVariableTerms() || op.hasVariableTerms()) {
+    return (op * (*this) - (*this) * op).nTerms() == 0;
+  }
+  return multiplyTerms(op, true).empty();
 }
 
 void PauliOperator::clear() { terms.clear(); }
 
 PauliOperator &PauliOperator::operator+=(const PauliOperator &v) noexcept {
+  // One lookup per term, the position is also the insertion hint.
   for (auto &kv : v.terms) {
-
-    auto termId = kv.first;
-    auto otherTerm = kv.second;
-
-    if (terms.count(termId)) {
-      terms.at(termId).coeff() += otherTerm.coeff();
-    } else {
-      terms.insert({termId, otherTerm});
-    }
-
-    if (std::abs(terms[termId].coeff()) < 1e-12) {
-      terms.erase(termId);
+    auto iter = terms.lower_bound(kv.first);
+    if (iter != terms.end() && iter->first == kv.first) {
+      iter->second.coeff() += std::get<0>(kv.second);
+      if (std::abs(iter->second.coeff()) < 1e-12) {
+        terms.erase(iter);
+      }
+    } else if (std::abs(std::get<0>(kv.second)) >= 1e-12) {
+      terms.emplace_hint(iter, kv);
     }
   }
 
@@ -491,24 +1020,141 @@ PauliOperator &PauliOperator::operator-=(const PauliOperator &v) noexcept {
 }
 
 PauliOperator &PauliOperator::operator*=(const PauliOperator &v) noexcept {
+  terms = multiplyTerms(v, false);
+  return *this;
+}
 
-  std::map<std::string, Term> newTerms;
-  for (auto &kv : terms) {
-    for (auto &vkv : v.terms) {
-      auto multTerm = kv.second * vkv.second;
-      auto id = multTerm.id();
+bool PauliOperator::hasVariableTerms() const {
+  return std::any_of(terms.begin(), terms.end(),
+                     [](const auto &kv) { return !std::get<1>(kv.second).empty(); });
+}
 
-      if (!newTerms.insert({id, multTerm}).second) {
-        newTerms.at(id).coeff() += multTerm.coeff();
+std::map<std::string, Term>
+PauliOperator::multiplyTerms(const PauliOperator &other,
+                             bool commutatorOnly) const {
+  // Terms are keyed by their Pauli string and variable:
+  // no string is built per product, only per resulting term.
+  struct TermKey {
+    SymplecticPauli pauli;
+    std::string var;
+    bool operator==(const TermKey &other) const {
+      return var == other.var && pauli == other.pauli;
+    }
+  };
+  struct TermKeyHash {
+    size_t operator()(const TermKey &key) const {
+      return key.pauli.hash() ^ std::hash<std::string>()(key.var);
+    }
+  };
+  const auto toSymplectic = [](const std::map<std::string, Term> &in_terms) {
+    std::vector<std::pair<SymplecticPauli, const Term *>> result;
+    result.reserve(in_terms.size());
+    for (auto &kv : in_terms) {
+      result.emplace_back(SymplecticPauli(std::get<2>(kv.second)), &kv.second);
+    }
+    return result;
+  };
+  const auto lhs = toSymplectic(terms);
+  const auto rhs = toSymplectic(other.terms);
+  const std::complex<double> phases[4] = {{1.0, 0.0}, {0.0, 1.0}, {-1.0, 0.0},
+                                          {0.0, -1.0}};
+
+  using ProductMap =
+      std::unordered_map<TermKey, std::complex<double>, TermKeyHash>;
+  // Products of lhs[beginIdx, endIdx) with all of rhs, sharded by key hash.
+  const auto multiplyRange = [&](size_t beginIdx, size_t endIdx,
+                                 std::vector<ProductMap> &io_shards) {
+    TermKey key;
+    for (size_t i = beginIdx; i < endIdx; ++i) {
+      const auto &[lhsPauli, lhsTerm] = lhs[i];
+      const auto &lhsVar = std::get<1>(*lhsTerm);
+      for (const auto &[rhsPauli, rhsTerm] : rhs) {
+        if (commutatorOnly && lhsPauli.commutes(rhsPauli)) {
+          continue;
+        }
+        const int phase =
+            SymplecticPauli::multiply(lhsPauli, rhsPauli, key.pauli);
+        // Same convention as Term::operator*=
+        const auto &rhsVar = std::get<1>(*rhsTerm);
+        if (lhsVar.empty() || rhsVar.empty()) {
+          key.var = lhsVar.empty() ? rhsVar : lhsVar;
+        } else {
+          key.var = lhsVar + " " + rhsVar;
+        }
+        auto coeff =
+            std::get<0>(*lhsTerm) * std::get<0>(*rhsTerm) * phases[phase];
+        if (commutatorOnly) {
+          // AB - BA = 2AB for anticommuting Pauli strings
+          coeff *= 2.0;
+        }
+        auto &shard = io_shards[TermKeyHash()(key) % io_shards.size()];
+        auto iter = shard.find(key);
+        if (iter == shard.end()) {
+          shard.emplace(key, coeff);
+        } else {
+          iter->second += coeff;
+        }
       }
+    }
+  };
+
+  // Large products are split by lhs term across the task scheduler, each
+  // task accumulating into its own shards; shard i of all the tasks is then
+  // merged by a single task, so no locking on the product maps.
+  std::shared_ptr<TaskScheduler> scheduler;
+  if (lhs.size() * rhs.size() >= PARALLEL_MIN_PAIRS && xacc::isInitialized()) {
+    scheduler = xacc::getTaskScheduler();
+  }
+  const size_t nbShards =
+      scheduler ? std::max(1, scheduler->getNumberOfThreads()) : 1;
+  std::vector<std::vector<ProductMap>> partials;
+  if (nbShards == 1) {
+    partials.emplace_back(1);
+    multiplyRange(0, lhs.size(), partials.front());
+  } else {
+    std::mutex partialsLock;
+    scheduler->parallelFor(0, lhs.size(), [&](size_t beginIdx, size_t endIdx) {
+      std::vector<ProductMap> shards(nbShards);
+      multiplyRange(beginIdx, endIdx, shards);
+      std::lock_guard<std::mutex> guard(partialsLock);
+      partials.emplace_back(std::move(shards));
+    });
+  }
 
-      if (std::abs(newTerms.at(id).coeff()) < 1e-12) {
-        newTerms.erase(id);
+  std::vector<std::vector<std::pair<std::string, Term>>> shardTerms(nbShards);
+  const auto mergeShards = [&](size_t beginIdx, size_t endIdx) {
+    for (size_t shardIdx = beginIdx; shardIdx < endIdx; ++shardIdx) {
+      auto &merged = partials.front()[shardIdx];
+      for (size_t i = 1; i < partials.size(); ++i) {
+        for (const auto &[productKey, coeff] : partials[i][shardIdx]) {
+          auto [iter, inserted] = merged.emplace(productKey, coeff);
+          if (!inserted) {
+            iter->second += coeff;
+          }
+        }
+      }
+      for (const auto &[productKey, coeff] : merged) {
+        if (std::abs(coeff) < 1e-12) {
+          continue;
+        }
+        Term term(coeff, productKey.var, productKey.pauli.toOps());
+        shardTerms[shardIdx].emplace_back(term.id(), term);
       }
     }
+  };
+  if (nbShards == 1) {
+    mergeShards(0, 1);
+  } else {
+    scheduler->parallelFor(0, nbShards, mergeShards);
   }
-  terms = newTerms;
-  return *this;
+
+  std::map<std::string, Term> newTerms;
+  for (auto &termList : shardTerms) {
+    for (auto &kv : termList) {
+      newTerms.emplace(std::move(kv));
+    }
+  }
+  return newTerms;
 }
 
 bool PauliOperator::operator==(const PauliOperator &v) noexcept {
@@ -681,7 +1327,7 @@ Term &Term::operator*=(const Term &v) noexcept {
       // This means, we have a op on same qubit in both
       // so we need to check its product
       auto myGate = ops().at(qubit);
-      auto gate_coeff = pauliProducts.at(myGate + gate);
+      auto gate_coeff = pauliProducts().at(myGate + gate);
       if (gate_coeff.second != "I") {
         ops().at(kv.first) = gate_coeff.second;
       } else {
@@ -752,7 +1398,7 @@ void PauliOperator::fromXACCIR(std::shared_ptr<IR> ir) {
 
   for (auto &kernel : ir->getComposites()) {
     std::map<int, std::string> pauliTerm;
-    for (auto inst : kernel->getInstructions()) {
+    for (auto &inst : kernel->getInstructionsView()) {
 
       if (!inst->isComposite()) {
 
@@ -781,8 +1427,13 @@ std::shared_ptr<Observable>
 PauliOperator::commutator(std::shared_ptr<Observable> op) {
 
   PauliOperator &A = *std::dynamic_pointer_cast<PauliOperator>(op);
-  std::shared_ptr<PauliOperator> commutatorHA =
-      std::make_shared<PauliOperator>((*this) * A - A * (*this));
+  if (hasVariableTerms() || A.hasVariableTerms()) {
+    std::shared_ptr<PauliOperator> commutatorHA =
+        std::make_shared<PauliOperator>((*this) * A - A * (*this));
+    return commutatorHA;
+  }
+  auto commutatorHA = std::make_shared<PauliOperator>();
+  commutatorHA->terms = multiplyTerms(A, true);
   return commutatorHA;
 }
 
@@ -796,6 +1447,33 @@ PauliOperator PauliOperator::hermitianConjugate() const {
   return conjugate;
 }
 
+PauliOperator &PauliOperator::simplify(const double threshold) {
+  std::map<std::string, Term> simplified;
+  for (auto &kv : terms) {
+    auto &ops = std::get<2>(kv.second);
+    for (auto iter = ops.begin(); iter != ops.end();) {
+      iter = iter->second == "I" ? ops.erase(iter) : std::next(iter);
+    }
+    const auto termId = kv.second.id();
+    auto iter = simplified.lower_bound(termId);
+    if (iter != simplified.end() && iter->first == termId) {
+      iter->second.coeff() += std::get<0>(kv.second);
+    } else {
+      simplified.emplace_hint(iter, termId, kv.second);
+    }
+  }
+
+  for (auto iter = simplified.begin(); iter != simplified.end();) {
+    if (std::abs(iter->second.coeff()) < threshold) {
+      iter = simplified.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+  terms = std::move(simplified);
+  return *this;
+}
+
 void PauliOperator::normalize() {
 
   double norm = 0.0;
@@ -814,6 +1492,10 @@ void PauliOperator::normalize() {
 double PauliOperator::postProcess(std::shared_ptr<AcceleratorBuffer> buffer,
                                   const std::string &postProcessTask,
                                   const HeterogeneousMap &extra_data) {
+  if (grouping == "qwc") {
+    return postProcessGroups(buffer, postProcessTask, extra_data);
+  }
+
   if (buffer->nChildren() < getNonIdentitySubTerms().size()) {
     xacc::error(
         "The buffer doesn't contain enough sub-buffers as expected. Expect: " +
@@ -842,72 +1524,182 @@ double PauliOperator::postProcess(std::shared_ptr<AcceleratorBuffer> buffer,
     termToChildBuffer.emplace(termName, childBuff);
   }
 
-  // Follow the logic in observe() to interpret the data:
+  if (postProcessTask != Observable::PostProcessingTask::EXP_VAL_CALC &&
+      postProcessTask != Observable::PostProcessingTask::VARIANCE_CALC) {
+    xacc::error("Unknown post-processing task: " + postProcessTask);
+    return 0.0;
+  }
+
+  // Follow the logic in observe() to interpret the data: the buffer name is
+  // the term name -> Composite name -> child buffer name. All the children
+  // are then reduced in one (parallel) pass.
+  std::vector<std::complex<double>> termCoeffs;
+  std::vector<std::string> termNames;
+  std::vector<std::shared_ptr<AcceleratorBuffer>> childBuffers;
+  for (auto &inst : terms) {
+    if (!inst.second.isIdentity()) {
+      auto iter = termToChildBuffer.find(inst.first);
+      if (iter == termToChildBuffer.end()) {
+        xacc::error("Cannot find the child buffer for term: " + inst.first);
+      }
+      termCoeffs.push_back(inst.second.coeff());
+      termNames.push_back(inst.first);
+      childBuffers.push_back(iter->second);
+    }
+  }
+  // Whole bit string parities
+  const auto stats = AcceleratorBuffer::getZStatistics(
+      childBuffers,
+      std::vector<std::vector<std::vector<int>>>(childBuffers.size()));
+
   if (postProcessTask == Observable::PostProcessingTask::EXP_VAL_CALC) {
     std::complex<double> energy =
         getIdentitySubTerm() ? getIdentitySubTerm()->coefficient() : 0.0;
-    for (auto &inst : terms) {
-      Term spinInst = inst.second;
-      if (!spinInst.isIdentity()) {
-        // The buffer name is the term name -> Composite name -> child buffer
-        // name.
-        const auto &bufferName = inst.first;
-        auto iter = termToChildBuffer.find(bufferName);
-        if (iter == termToChildBuffer.end()) {
-          xacc::error("Cannot find the child buffer for term: " + inst.first);
-        }
-
-        auto childBuff = iter->second;
-        auto expval = childBuff->getExpectationValueZ();
-
-        // Adding some meta-data to the child buffer as well:
-        {
-          childBuff->addExtraInfo("coefficient", spinInst.coeff().real());
-          childBuff->addExtraInfo("kernel", inst.first);
-          childBuff->addExtraInfo("exp-val-z", expval);
-        }
-        // Accumulate the energy:
-        energy += expval * spinInst.coeff();
+    for (size_t i = 0; i < childBuffers.size(); i++) {
+      auto &childBuff = childBuffers[i];
+      auto expval = stats[i].expVals[0];
+
+      // Adding some meta-data to the child buffer as well:
+      {
+        childBuff->addExtraInfo("coefficient", termCoeffs[i].real());
+        childBuff->addExtraInfo("kernel", termNames[i]);
+        childBuff->addExtraInfo("exp-val-z", expval);
       }
+      // Accumulate the energy:
+      energy += expval * termCoeffs[i];
     }
     return energy.real();
   }
 
-  if (postProcessTask == Observable::PostProcessingTask::VARIANCE_CALC) {
-    double variance = 0.0;
-    for (auto &inst : terms) {
-      Term spinInst = inst.second;
-      if (!spinInst.isIdentity()) {
-        const auto &bufferName = inst.first;
-        auto iter = termToChildBuffer.find(bufferName);
-        if (iter == termToChildBuffer.end()) {
-          xacc::error("Cannot find the child buffer for term: " + inst.first);
-        }
+  double variance = 0.0;
+  for (size_t i = 0; i < childBuffers.size(); i++) {
+    // Adding variance meta-data to the child buffer as well.
+    if (stats[i].shots > 0) {
+      auto &childBuff = childBuffers[i];
+      auto expval = stats[i].expVals[0];
+      auto paulvar = 1.0 - expval * expval;
+      childBuff->addExtraInfo("pauli-variance", paulvar);
+      variance += termCoeffs[i].real() * termCoeffs[i].real() * paulvar;
+      childBuff->addExtraInfo("energy-standard-deviation",
+                              std::sqrt(variance / stats[i].shots));
+    }
+  }
+  return variance;
+}
+double
+PauliOperator::postProcessGroups(std::shared_ptr<AcceleratorBuffer> buffer,
+                                 const std::string &postProcessTask,
+                                 const HeterogeneousMap &extra_data) {
+  if (postProcessTask != Observable::PostProcessingTask::EXP_VAL_CALC &&
+      postProcessTask != Observable::PostProcessingTask::VARIANCE_CALC) {
+    xacc::error("Unknown post-processing task: " + postProcessTask);
+    return 0.0;
+  }
 
-        auto childBuff = iter->second;
-        // Adding variance meta-data to the child buffer as well.
-        if (!childBuff->getMeasurementCounts().empty()) {
-          auto expval = childBuff->getExpectationValueZ();
-          auto paulvar = 1.0 - expval * expval;
-          childBuff->addExtraInfo("pauli-variance", paulvar);
-          variance +=
-              (spinInst.coeff().real() * spinInst.coeff().real() * paulvar);
-
-          int n_shots = 0;
-          for (auto [k, v] : childBuff->getMeasurementCounts()) {
-            n_shots += v;
-          }
-          childBuff->addExtraInfo("energy-standard-deviation",
-                                  std::sqrt(variance / n_shots));
+  // Bit strings are MSB (classical bit 0 is the right-most
+  // character) unless the caller specifies otherwise.
+  const bool isLsb = extra_data.stringExists("bit-order") &&
+                     extra_data.getString("bit-order") == "LSB";
+
+  std::unordered_map<std::string, std::shared_ptr<AcceleratorBuffer>>
+      groupToChildBuffer;
+  for (auto &childBuff : buffer->getChildren()) {
+    auto groupName = childBuff->name();
+    if (groupName.rfind("evaled_", 0) == 0) {
+      groupName.erase(0, 7);
+    }
+    groupToChildBuffer.emplace(groupName, childBuff);
+  }
+
+  // The Z masks of the terms of each group on its classical bits, all the
+  // groups being then reduced in one (parallel) pass.
+  const auto groups = qubitWiseCommutingGroups();
+  std::vector<std::string> groupNames;
+  std::vector<std::shared_ptr<AcceleratorBuffer>> childBuffers;
+  std::vector<std::vector<std::vector<int>>> groupBits;
+  std::vector<std::vector<double>> groupCoeffs;
+  for (auto &[basis, termIds] : groups) {
+    const auto groupName = Term::id(basis);
+    auto iter = groupToChildBuffer.find(groupName);
+    if (iter == groupToChildBuffer.end()) {
+      xacc::error("Cannot find the child buffer for term group: " +
+                  groupName);
+    }
+
+    // Classical bit k holds the k-th basis qubit (ascending),
+    // so map each term to the classical bits it acts on.
+    std::map<int, int> qubitToClassicalBit;
+    for (auto &[qbit, gateName] : basis) {
+      qubitToClassicalBit.emplace(qbit, qubitToClassicalBit.size());
+    }
+    std::vector<std::vector<int>> termBits;
+    std::vector<double> termCoeffs;
+    for (auto &termId : termIds) {
+      auto &term = terms.at(termId);
+      std::vector<int> bits;
+      for (auto &kv : term.ops()) {
+        if (kv.second != "I" && !kv.second.empty()) {
+          bits.push_back(qubitToClassicalBit[kv.first]);
         }
       }
+      termBits.push_back(bits);
+      termCoeffs.push_back(term.coeff().real());
+    }
+    groupNames.push_back(groupName);
+    childBuffers.push_back(iter->second);
+    groupBits.push_back(termBits);
+    groupCoeffs.push_back(termCoeffs);
+  }
+  const auto stats = AcceleratorBuffer::getZStatistics(
+      childBuffers, groupBits, groupCoeffs,
+      isLsb ? AcceleratorBuffer::BitOrder::LSB
+            : AcceleratorBuffer::BitOrder::MSB);
+
+  std::complex<double> energy =
+      getIdentitySubTerm() ? getIdentitySubTerm()->coefficient() : 0.0;
+  double variance = 0.0;
+  for (size_t g = 0; g < groups.size(); g++) {
+    const auto &termIds = groups[g].second;
+    const auto &groupName = groupNames[g];
+    auto &childBuff = childBuffers[g];
+    if (stats[g].shots == 0) {
+      xacc::error("PauliOperator qwc grouping requires measurement counts "
+                  "(shots) for term group: " +
+                  groupName);
+    }
+
+    std::map<std::string, double> termExpValMap;
+    std::complex<double> groupEnergy = 0.0;
+    for (int i = 0; i < termIds.size(); i++) {
+      termExpValMap.emplace(termIds[i], stats[g].expVals[i]);
+      groupEnergy += stats[g].expVals[i] * terms.at(termIds[i]).coeff();
+    }
+
+    if (postProcessTask == Observable::PostProcessingTask::EXP_VAL_CALC) {
+      // The kernel coefficient of a group is 1.0, so exp-val-z
+      // here holds the energy contribution of the whole group.
+      childBuff->addExtraInfo("coefficient", 1.0);
+      childBuff->addExtraInfo("kernel", groupName);
+      childBuff->addExtraInfo("exp-val-z", groupEnergy.real());
+      childBuff->addExtraInfo("term-exp-vals", termExpValMap);
+      energy += groupEnergy;
+    } else {
+      // Terms in a group share samples, so use the sample
+      // variance of the combined group estimator.
+      const double groupVariance = stats[g].variance;
+      childBuff->addExtraInfo("pauli-variance", groupVariance);
+      variance += groupVariance;
+      childBuff->addExtraInfo("energy-standard-deviation",
+                              std::sqrt(variance / stats[g].shots));
     }
-    return variance;
   }
 
-  xacc::error("Unknown post-processing task: " + postProcessTask);
-  return 0.0;
+  if (postProcessTask == Observable::PostProcessingTask::VARIANCE_CALC) {
+    return variance;
+  }
+  return energy.real();
 }
+
 } // namespace quantum
 } // namespace xacc
 
@@ -53,85 +53,68 @@ class Term : public TermTuple,
              public tao::operators::equality_comparable<Term> {
 
 protected:
-  // static std::map<std::string, std::pair<c, std::string>>
-  void create_map() {
-    // static std::map<std::string, std::pair<c, std::string>> m;
-    pauliProducts.insert({"II", {c(1.0, 0.0), "I"}});
-    pauliProducts.insert({"IX", {c(1.0, 0.0), "X"}});
-    pauliProducts.insert({"XI", {c(1.0, 0.0), "X"}});
-    pauliProducts.insert({"IY", {c(1.0, 0.0), "Y"}});
-    pauliProducts.insert({"YI", {c(1.0, 0.0), "Y"}});
-    pauliProducts.insert({"ZI", {c(1.0, 0.0), "Z"}});
-    pauliProducts.insert({"IZ", {c(1.0, 0.0), "Z"}});
-    pauliProducts.insert({"XX", {c(1.0, 0.0), "I"}});
-    pauliProducts.insert({"YY", {c(1.0, 0.0), "I"}});
-    pauliProducts.insert({"ZZ", {c(1.0, 0.0), "I"}});
-    pauliProducts.insert({"XY", {c(0.0, 1.0), "Z"}});
-    pauliProducts.insert({"XZ", {c(0.0, -1.0), "Y"}});
-    pauliProducts.insert({"YX", {c(0.0, -1.0), "Z"}});
-    pauliProducts.insert({"YZ", {c(0.0, 1.0), "X"}});
-    pauliProducts.insert({"ZX", {c(0.0, 1.0), "Y"}});
-    pauliProducts.insert({"ZY", {c(0.0, -1.0), "X"}});
-    // return m;
+  // Single-qubit products, e.g. "XY" -> (i, "Z")
+  static const std::map<std::string, std::pair<c, std::string>> &
+  pauliProducts() {
+    static const std::map<std::string, std::pair<c, std::string>> products{
+        {"II", {c(1.0, 0.0), "I"}},  {"IX", {c(1.0, 0.0), "X"}},
+        {"XI", {c(1.0, 0.0), "X"}},  {"IY", {c(1.0, 0.0), "Y"}},
+        {"YI", {c(1.0, 0.0), "Y"}},  {"ZI", {c(1.0, 0.0), "Z"}},
+        {"IZ", {c(1.0, 0.0), "Z"}},  {"XX", {c(1.0, 0.0), "I"}},
+        {"YY", {c(1.0, 0.0), "I"}},  {"ZZ", {c(1.0, 0.0), "I"}},
+        {"XY", {c(0.0, 1.0), "Z"}},  {"XZ", {c(0.0, -1.0), "Y"}},
+        {"YX", {c(0.0, -1.0), "Z"}}, {"YZ", {c(0.0, 1.0), "X"}},
+        {"ZX", {c(0.0, 1.0), "Y"}},  {"ZY", {c(0.0, -1.0), "X"}}};
+    return products;
   }
 
-  std::map<std::string, std::pair<c, std::string>> pauliProducts;
-
 public:
   Term() {
     std::get<0>(*this) = std::complex<double>(0, 0);
     std::get<1>(*this) = "";
     std::get<2>(*this) = {};
-    create_map();
   }
 
   Term(const Term &t) {
     std::get<0>(*this) = std::get<0>(t);
     std::get<1>(*this) = std::get<1>(t);
     std::get<2>(*this) = std::get<2>(t);
-    create_map();
   }
 
   Term(std::complex<double> c) {
     std::get<0>(*this) = c;
     std::get<1>(*this) = "";
     std::get<2>(*this) = {};
-    create_map();
   }
 
   Term(double c) {
     std::get<0>(*this) = std::complex<double>(c, 0);
     std::get<1>(*this) = "";
     std::get<2>(*this) = {};
-    create_map();
   }
 
   Term(std::complex<double> c, std::map<int, std::string> ops) {
     std::get<0>(*this) = c;
     std::get<1>(*this) = "";
     std::get<2>(*this) = ops;
-    create_map();
   }
 
   Term(std::string var) {
     std::get<0>(*this) = std::complex<double>(1, 0);
     std::get<1>(*this) = var;
     std::get<2>(*this) = {};
-    create_map();
   }
 
   Term(std::complex<double> c, std::string var) {
     std::get<0>(*this) = c;
     std::get<1>(*this) = var;
     std::get<2>(*this) = {};
-    create_map();
   }
 
   Term(std::string var, std::map<int, std::string> ops) {
     std::get<0>(*this) = std::complex<double>(1, 0);
     std::get<1>(*this) = var;
     std::get<2>(*this) = ops;
-    create_map();
   }
 
   Term(std::complex<double> c, std::string var,
@@ -139,14 +122,12 @@ public:
     std::get<0>(*this) = c;
     std::get<1>(*this) = var;
     std::get<2>(*this) = ops;
-    create_map();
   }
 
   Term(std::map<int, std::string> ops) {
     std::get<0>(*this) = std::complex<double>(1, 0);
     std::get<1>(*this) = "";
     std::get<2>(*this) = ops;
-    create_map();
   }
 
   static const std::string id(const std::map<int, std::string> &ops,
@@ -221,6 +202,50 @@ class PauliOperator
 protected:
   std::map<std::string, Term> terms;
 
+  // Measurement grouping mode used by observe() and postProcess(),
+  // set via fromOptions({{"grouping", "qwc"}}). By default (empty)
+  // every term is measured by its own kernel.
+  std::string grouping = "";
+
+  // Measurement instructions (basis changes followed by measures) for
+  // each observed kernel, in kernel order. These only depend on the
+  // terms, the grouping mode and the target buffer name, so observe()
+  // builds them once and clones them into each new set of observed
+  // kernels. The kernel coefficient is that of termId, or 1.0 if
+  // termId is empty (i.e. a group of terms).
+  struct MeasuredKernel {
+    std::string name;
+    std::string termId;
+    std::vector<std::shared_ptr<Instruction>> instructions;
+  };
+  struct MeasurementPlan {
+    std::string bufferName;
+    std::string grouping;
+    std::vector<std::string> termIds;
+    std::vector<MeasuredKernel> kernels;
+  };
+  std::shared_ptr<MeasurementPlan> measurementPlan;
+
+  // Partition the non-identity terms into qubit-wise commuting groups,
+  // returning the measurement basis of each group and its term ids.
+  std::vector<std::pair<std::map<int, std::string>, std::vector<std::string>>>
+  qubitWiseCommutingGroups();
+  double postProcessGroups(std::shared_ptr<AcceleratorBuffer> buffer,
+                           const std::string &postProcessTask,
+                           const HeterogeneousMap &extra_data);
+
+  // Products of all the pairs of terms (this term * other term), summed in
+  // symplectic form. If commutatorOnly, only the anticommuting pairs are
+  // kept (twice), i.e. the commutator [this, other] for terms without
+  // variable coefficients.
+  std::map<std::string, Term> multiplyTerms(const PauliOperator &other,
+                                            bool commutatorOnly) const;
+  bool hasVariableTerms() const;
+
+  bool measurementPlanIsValid(const std::string &bufferName);
+  std::shared_ptr<MeasurementPlan>
+  buildMeasurementPlan(const std::string &bufferName);
+
 public:
   std::shared_ptr<Observable> clone() override {
     return std::make_shared<PauliOperator>();
@@ -293,8 +318,25 @@ public:
   }
 
   const std::string toString() override;
+  // The canonical form ("coeff X0 Y1 + ...") is read by a hand-written
+  // streaming parser, anything else by the ANTLR grammar.
   void fromString(const std::string str) override;
 
+  // Compact binary form, the X/Z bit masks and the coefficient of each
+  // term, read back through a memory mapping. Variable coefficients are
+  // not supported.
+  void toBinaryFile(const std::string &fileName) const;
+  void fromBinaryFile(const std::string &fileName);
+
+  // Bulk construction from the symplectic form of nbTerms Pauli strings:
+  // the X (Z) masks of term t are x[t * nbWords, (t + 1) * nbWords), bit q
+  // of a word set for an X (Z) on qubit q (64 qubits per word), Y if both.
+  // Repeated strings are summed, as with +=.
+  void fromSymplectic(const uint64_t *x, const uint64_t *z,
+                      const size_t nbWords,
+                      const std::complex<double> *coeffs,
+                      const size_t nbTerms);
+
   bool contains(PauliOperator &op);
   bool commutes(PauliOperator &op);
 
@@ -317,6 +359,11 @@ public:
 
   std::vector<SparseTriplet> getSparseMatrixElements() {return to_sparse_matrix();}
   std::vector<std::complex<double>> toDenseMatrix(const int nQubits);
+  // <psi|H|psi> of a state vector of dim = 2^n amplitudes, n >= nQubits(),
+  // indexed as to_sparse_matrix() (qubit 0 is the most significant bit),
+  // without forming the matrix.
+  std::complex<double> expectationValue(const std::complex<double> *state,
+                                        const size_t dim);
 
   std::vector<SparseTriplet>
   to_sparse_matrix() override;
@@ -338,7 +385,7 @@ public:
 
   const std::string name() const override { return "pauli"; }
   const std::string description() const override { return ""; }
-  void fromOptions(const HeterogeneousMap &options) override { return; }
+  void fromOptions(const HeterogeneousMap &options) override;
   
   std::shared_ptr<Observable>
   commutator(std::shared_ptr<Observable> obs) override;
@@ -346,6 +393,9 @@ public:
   PauliOperator hermitianConjugate() const;
 
   void normalize() override;
+  // Combine like terms (e.g. differing only by explicit identities) and
+  // drop the terms whose coefficient magnitude is below the threshold.
+  PauliOperator &simplify(const double threshold = 1e-12);
   virtual double postProcess(std::shared_ptr<AcceleratorBuffer> buffer,
                              const std::string &postProcessTask,
                              const HeterogeneousMap &extra_data) override;
@@ -353,7 +403,7 @@ public:
 } // namespace quantum
 
 template const quantum::PauliOperator
-HeterogeneousMap::get<quantum::PauliOperator>(const std::string key) const;
+HeterogeneousMap::get<quantum::PauliOperator>(const std::string &key) const;
 
 } // namespace xacc
 
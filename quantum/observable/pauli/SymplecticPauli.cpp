@@ -0,0 +1,122 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "SymplecticPauli.hpp"
+#include "StructuralHasher.hpp"
+#include "xacc.hpp"
+#include <algorithm>
+#include <bitset>
+
+namespace {
+int popcount(uint64_t in_word) { return std::bitset<64>(in_word).count(); }
+} // namespace
+
+namespace xacc {
+namespace quantum {
+SymplecticPauli::SymplecticPauli(const std::map<int, std::string> &in_ops) {
+  for (const auto &[qubit, op] : in_ops) {
+    if (op == "I") {
+      continue;
+    }
+    if (qubit < 0 || (op != "X" && op != "Y" && op != "Z")) {
+      xacc::error("Invalid Pauli operator " + op + std::to_string(qubit));
+    }
+    const size_t word = qubit / 64;
+    if (word >= m_x.size()) {
+      m_x.resize(word + 1, 0);
+      m_z.resize(word + 1, 0);
+    }
+    const uint64_t mask = 1ULL << (qubit % 64);
+    if (op != "Z") {
+      m_x[word] |= mask;
+    }
+    if (op != "X") {
+      m_z[word] |= mask;
+    }
+  }
+  trim();
+}
+
+SymplecticPauli::SymplecticPauli(std::vector<uint64_t> in_x,
+                                 std::vector<uint64_t> in_z)
+    : m_x(std::move(in_x)), m_z(std::move(in_z)) {
+  const size_t nbWords = std::max(m_x.size(), m_z.size());
+  m_x.resize(nbWords, 0);
+  m_z.resize(nbWords, 0);
+  trim();
+}
+
+std::map<int, std::string> SymplecticPauli::toOps() const {
+  std::map<int, std::string> ops;
+  for (size_t word = 0; word < m_x.size(); ++word) {
+    for (auto bits = m_x[word] | m_z[word]; bits != 0; bits &= bits - 1) {
+      const int bit = popcount((bits & -bits) - 1);
+      const bool x = (m_x[word] >> bit) & 1ULL;
+      const bool z = (m_z[word] >> bit) & 1ULL;
+      ops.emplace(word * 64 + bit, x ? (z ? "Y" : "X") : "Z");
+    }
+  }
+  return ops;
+}
+
+int SymplecticPauli::multiply(const SymplecticPauli &in_a,
+                              const SymplecticPauli &in_b,
+                              SymplecticPauli &out) {
+  const size_t nbWords = std::max(in_a.m_x.size(), in_b.m_x.size());
+  out.m_x.resize(nbWords);
+  out.m_z.resize(nbWords);
+  // Single-qubit products are i^+1 for XY, YZ, ZX, i^-1 for YX, ZY, XZ.
+  int phase = 0;
+  for (size_t word = 0; word < nbWords; ++word) {
+    const uint64_t x1 = word < in_a.m_x.size() ? in_a.m_x[word] : 0;
+    const uint64_t z1 = word < in_a.m_z.size() ? in_a.m_z[word] : 0;
+    const uint64_t x2 = word < in_b.m_x.size() ? in_b.m_x[word] : 0;
+    const uint64_t z2 = word < in_b.m_z.size() ? in_b.m_z[word] : 0;
+    const uint64_t xa = x1 & ~z1, ya = x1 & z1, za = ~x1 & z1;
+    const uint64_t xb = x2 & ~z2, yb = x2 & z2, zb = ~x2 & z2;
+    phase += popcount((xa & yb) | (ya & zb) | (za & xb));
+    phase -= popcount((ya & xb) | (za & yb) | (xa & zb));
+    out.m_x[word] = x1 ^ x2;
+    out.m_z[word] = z1 ^ z2;
+  }
+  out.trim();
+  return ((phase % 4) + 4) % 4;
+}
+
+bool SymplecticPauli::commutes(const SymplecticPauli &in_other) const {
+  const size_t nbWords = std::min(m_x.size(), in_other.m_x.size());
+  int parity = 0;
+  for (size_t word = 0; word < nbWords; ++word) {
+    parity ^= popcount((m_x[word] & in_other.m_z[word]) ^
+                       (m_z[word] & in_other.m_x[word])) &
+              1;
+  }
+  return parity == 0;
+}
+
+uint64_t SymplecticPauli::hash() const {
+  StructuralHasher hasher;
+  for (size_t word = 0; word < m_x.size(); ++word) {
+    hasher.add(m_x[word]);
+    hasher.add(m_z[word]);
+  }
+  return hasher.value();
+}
+
+void SymplecticPauli::trim() {
+  while (!m_x.empty() && m_x.back() == 0 && m_z.back() == 0) {
+    m_x.pop_back();
+    m_z.pop_back();
+  }
+}
+} // namespace quantum
+} // namespace xacc
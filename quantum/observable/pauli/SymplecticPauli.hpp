@@ -0,0 +1,57 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#ifndef QUANTUM_OBSERVABLE_PAULI_SYMPLECTICPAULI_HPP_
+#define QUANTUM_OBSERVABLE_PAULI_SYMPLECTICPAULI_HPP_
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace xacc {
+namespace quantum {
+// Bit-packed (symplectic) form of a Pauli string: qubit q carries X if bit q
+// of x is set, Z if bit q of z is set, Y if both.
+// Products and commutation checks are word-wise XORs and popcounts.
+class SymplecticPauli {
+public:
+  SymplecticPauli() = default;
+  // From the Term representation (qubit -> "I", "X", "Y" or "Z")
+  explicit SymplecticPauli(const std::map<int, std::string> &in_ops);
+  // From the X and Z bit masks (64 qubits per word)
+  SymplecticPauli(std::vector<uint64_t> in_x, std::vector<uint64_t> in_z);
+  std::map<int, std::string> toOps() const;
+
+  // out = a * b = i^k P(a xor b), returns k (0 to 3).
+  // out may be re-used across calls, to avoid allocations.
+  static int multiply(const SymplecticPauli &in_a, const SymplecticPauli &in_b,
+                      SymplecticPauli &out);
+  bool commutes(const SymplecticPauli &in_other) const;
+  bool isIdentity() const { return m_x.empty(); }
+  // The X and Z words, both of the same (trimmed) size
+  const std::vector<uint64_t> &xWords() const { return m_x; }
+  const std::vector<uint64_t> &zWords() const { return m_z; }
+
+  bool operator==(const SymplecticPauli &in_other) const {
+    return m_x == in_other.m_x && m_z == in_other.m_z;
+  }
+  uint64_t hash() const;
+
+private:
+  // Drop the trailing all-identity words (unique representation)
+  void trim();
+  std::vector<uint64_t> m_x;
+  std::vector<uint64_t> m_z;
+};
+} // namespace quantum
+} // namespace xacc
+#endif
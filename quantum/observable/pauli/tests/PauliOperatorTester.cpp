@@ -466,6 +466,84 @@ TEST(PauliOperatorTester, checkCommutes) {
   EXPECT_FALSE(PauliOperator({{0, "X"}}).commutes(y));
 }
 
+TEST(PauliOperatorTester, checkSymplecticProducts) {
+  PauliOperator x({{0, "X"}}), y({{0, "Y"}});
+  auto xy = x * y;
+  EXPECT_EQ(1, xy.nTerms());
+  auto term = xy.getTerms().begin()->second;
+  EXPECT_NEAR(1.0, term.coeff().imag(), 1e-12);
+  EXPECT_EQ("Z", term.ops().at(0));
+
+  PauliOperator a, b;
+  a.fromString("0.5 X0 Y1 + 1.5 Z0 Z2 + 2.0 Y1 X2 + 3.3 X0 Z1 Y2");
+  b.fromString("2.0 Z0 X1 + 0.7 Y0 Y2 + 1.1 X1 Z2 + 0.3 Z1");
+  auto dense = [](PauliOperator &op) {
+    auto data = op.toDenseMatrix(3);
+    return Eigen::MatrixXcd(Eigen::Map<Eigen::MatrixXcd>(data.data(), 8, 8));
+  };
+
+  auto ab = a * b;
+  const Eigen::MatrixXcd da = dense(a), db = dense(b);
+  EXPECT_NEAR(0.0, (dense(ab) - da * db).norm(), 1e-9);
+  auto comm = std::dynamic_pointer_cast<PauliOperator>(
+      a.commutator(std::make_shared<PauliOperator>(b)));
+  EXPECT_NEAR(0.0, (dense(*comm) - (da * db - db * da)).norm(), 1e-9);
+
+  EXPECT_FALSE(a.commutes(b));
+  PauliOperator zz({{0, "Z"}, {2, "Z"}});
+  PauliOperator xx({{0, "X"}, {2, "X"}});
+  EXPECT_TRUE(zz.commutes(xx));
+}
+
+TEST(PauliOperatorTester, checkParallelProducts) {
+  // Enough pairs of terms to split the product across the task scheduler
+  const std::string paulis = "IXYZ";
+  PauliOperator a, b;
+  for (int i = 0; i < 256; i++) {
+    std::map<int, std::string> ops;
+    for (int q = 0; q < 4; q++) {
+      ops[q] = std::string(1, paulis[(i >> (2 * q)) % 4]);
+    }
+    a += PauliOperator(ops, 0.01 * (i + 1));
+    if (i % 2 == 0) {
+      b += PauliOperator(ops, 1.0 - 0.003 * i);
+    }
+  }
+
+  PauliOperator expected;
+  for (auto &lhs : a.getTerms()) {
+    for (auto &rhs : b.getTerms()) {
+      expected += PauliOperator(lhs.second.ops(), lhs.second.coeff()) *
+                  PauliOperator(rhs.second.ops(), rhs.second.coeff());
+    }
+  }
+  auto product = a * b;
+  EXPECT_EQ(expected.nTerms(), product.nTerms());
+  auto terms = product.getTerms();
+  for (auto &kv : expected.getTerms()) {
+    ASSERT_TRUE(terms.count(kv.first));
+    EXPECT_NEAR(0.0, std::abs(terms.at(kv.first).coeff() - kv.second.coeff()),
+                1e-9);
+  }
+}
+
+TEST(PauliOperatorTester, checkSimplify) {
+  PauliOperator op;
+  op.fromString("0.5 X0 Z1 + 1e-9 Y2 + 0.25 Z3");
+  op.simplify(1e-6);
+  EXPECT_EQ(2, op.nTerms());
+  EXPECT_FALSE(op.getTerms().count("Y2"));
+
+  // Explicit identities are dropped
+  PauliOperator op2({{0, "X"}, {2, "I"}}, 0.5);
+  op2 += PauliOperator({{0, "X"}}, 0.5);
+  op2.simplify();
+  EXPECT_EQ(1, op2.nTerms());
+  auto x0 = op2.getTerms().at("X0");
+  EXPECT_NEAR(1.0, x0.coeff().real(), 1e-12);
+  EXPECT_EQ(1, x0.ops().size());
+}
+
 TEST(PauliOperatorTester, checkSciNot) {
   PauliOperator op;
   op.fromString("(1.234e-4, 0) Z0");
@@ -490,6 +568,158 @@ TEST(PauliOperatorTester, checkNormalize) {
 
 }
 
+TEST(PauliOperatorTester, checkObserveRepeated) {
+  PauliOperator op("0.5 X0 Z1 + 0.25 Y1 + 0.1");
+  auto provider = xacc::getService<xacc::IRProvider>("quantum");
+  auto ansatz = provider->createComposite("ansatz");
+  ansatz->addInstruction(provider->createInstruction("H", {0}));
+  ansatz->addInstruction(provider->createInstruction("CNOT", {0, 1}));
+
+  auto first = op.observe(ansatz);
+  EXPECT_EQ(3, first.size());
+  // Transform the first set of kernels, this must not
+  // affect kernels observed later on.
+  for (auto &k : first) {
+    k->mapBits({2, 3});
+  }
+
+  // Terms changed, the cached measurements must be rebuilt
+  op += PauliOperator("1.5 Z0");
+  auto second = op.observe(ansatz);
+  EXPECT_EQ(4, second.size());
+  for (auto &k : second) {
+    EXPECT_EQ(2, k->nPhysicalBits());
+    if (k->name() == "X0Z1") {
+      // ansatz, H on q0, measure q1 and q0
+      EXPECT_EQ(4, k->nChildren());
+      EXPECT_EQ("H", k->getInstruction(1)->name());
+      EXPECT_EQ(0.5, std::real(k->getCoefficient()));
+    }
+    if (k->name() == "Y1") {
+      EXPECT_EQ("Rx", k->getInstruction(1)->name());
+      EXPECT_EQ("Measure", k->getInstruction(2)->name());
+    }
+    if (k->name() == "I") {
+      EXPECT_EQ(1, k->nChildren());
+    }
+  }
+}
+
+TEST(PauliOperatorTester, checkQubitWiseCommutingGroups) {
+  PauliOperator op("0.5 X0 X1 + 0.25 X0 + 1.5 Z0 Z1 + 0.75 Z1 + 0.1");
+  op.fromOptions({{"grouping", "qwc"}});
+  auto provider = xacc::getService<xacc::IRProvider>("quantum");
+  auto ansatz = provider->createComposite("ansatz");
+  ansatz->addInstruction(provider->createInstruction("H", {0}));
+
+  auto kernels = op.observe(ansatz);
+  std::vector<std::string> names;
+  for (auto &k : kernels) {
+    names.push_back(k->name());
+  }
+  EXPECT_EQ(std::vector<std::string>({"I", "X0X1", "Z0Z1"}), names);
+  // ansatz, H, H, Measure, Measure
+  EXPECT_EQ(5, kernels[1]->nChildren());
+  EXPECT_EQ(0.1, std::real(kernels[0]->getCoefficient()));
+  EXPECT_EQ(1.0, std::real(kernels[1]->getCoefficient()));
+
+  auto buffer = xacc::qalloc(2);
+  auto xGroup = std::make_shared<xacc::AcceleratorBuffer>("X0X1", 2);
+  xGroup->appendMeasurement("00", 75);
+  xGroup->appendMeasurement("01", 25);
+  auto zGroup = std::make_shared<xacc::AcceleratorBuffer>("Z0Z1", 2);
+  zGroup->appendMeasurement("11", 100);
+  buffer->appendChild("X0X1", xGroup);
+  buffer->appendChild("Z0Z1", zGroup);
+
+  // MSB: q0 is the right-most bit
+  EXPECT_NEAR(1.225,
+              op.postProcess(buffer,
+                             xacc::Observable::PostProcessingTask::EXP_VAL_CALC,
+                             {}),
+              1e-9);
+  auto termExpVals = mpark::get<std::map<std::string, double>>(
+      xGroup->getInformation("term-exp-vals"));
+  EXPECT_NEAR(0.5, termExpVals["X0"], 1e-9);
+  EXPECT_NEAR(0.5, termExpVals["X0X1"], 1e-9);
+
+  // LSB: q0 is the left-most bit
+  EXPECT_NEAR(1.35,
+              op.postProcess(buffer,
+                             xacc::Observable::PostProcessingTask::EXP_VAL_CALC,
+                             {{"bit-order", std::string("LSB")}}),
+              1e-9);
+}
+
+TEST(PauliOperatorTester, checkCanonicalParsing) {
+  PauliOperator op("(0.5,-1) X0 Y1 + 1.5e-3 Z2 Z3 - 0.25 X0 Y1 + 2.0 I + 1.0");
+  EXPECT_EQ(3, op.nTerms());
+  auto terms = op.getTerms();
+  EXPECT_NEAR(0.25, terms["X0Y1"].coeff().real(), 1e-12);
+  EXPECT_NEAR(-1.0, terms["X0Y1"].coeff().imag(), 1e-12);
+  EXPECT_NEAR(1.5e-3, terms["Z2Z3"].coeff().real(), 1e-12);
+  EXPECT_NEAR(3.0, terms["I"].coeff().real(), 1e-12);
+
+  // toString() round trip
+  PauliOperator roundTrip(op.toString());
+  EXPECT_TRUE(roundTrip.isClose(op));
+
+  // Repeated qubits go through the grammar
+  PauliOperator product("0.5 X0 Y0");
+  EXPECT_EQ(1, product.nTerms());
+  EXPECT_NEAR(0.5, product.getTerms()["Z0"].coeff().imag(), 1e-12);
+}
+
+TEST(PauliOperatorTester, checkBinaryFile) {
+  PauliOperator op("(0.5,-1) X0 Y1 + 1.5 Z2 Z70 + 0.25 Y127 + 2.0");
+  const std::string fileName = "pauli_operator_test.bin";
+  op.toBinaryFile(fileName);
+
+  PauliOperator loaded;
+  loaded.fromBinaryFile(fileName);
+  EXPECT_EQ(4, loaded.nTerms());
+  EXPECT_TRUE(loaded.isClose(op));
+  auto terms = loaded.getTerms();
+  EXPECT_NEAR(-1.0, terms["X0Y1"].coeff().imag(), 1e-12);
+  EXPECT_NEAR(0.25, terms["Y127"].coeff().real(), 1e-12);
+  std::remove(fileName.c_str());
+}
+
+TEST(PauliOperatorTester, checkFromSymplectic) {
+  // X0 Y1, Z2 twice, I, X0 cancelled, Z64 (two words per term)
+  std::vector<uint64_t> x{0b011, 0, 0, 0, 0, 0, 0, 0, 0b1, 0, 0b1, 0, 0, 0};
+  std::vector<uint64_t> z{0b010, 0, 0b100, 0, 0b100, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+  std::vector<std::complex<double>> coeffs{{0.5, -1}, 1.0, 0.5, 2.0,
+                                           1.0,       -1.0, 0.25};
+
+  PauliOperator op;
+  op.fromSymplectic(x.data(), z.data(), 2, coeffs.data(), 7);
+  PauliOperator expected("(0.5,-1) X0 Y1 + 1.5 Z2 + 2.0 + 0.25 Z64");
+  EXPECT_EQ(4, op.nTerms());
+  EXPECT_TRUE(op.isClose(expected));
+}
+
+TEST(PauliOperatorTester, checkExpectationValue) {
+  PauliOperator op("0.5 X0 Y1 + 1.5 Z2 + (0.3,0.1) Y0 Z1 X2 + 2.0 + 0.7 X2");
+  std::vector<std::complex<double>> psi(8);
+  double norm = 0.0;
+  for (int i = 0; i < 8; i++) {
+    psi[i] = std::complex<double>(std::cos(1.3 * i + 0.2), std::sin(0.7 * i));
+    norm += std::norm(psi[i]);
+  }
+  for (auto &amp : psi) {
+    amp /= std::sqrt(norm);
+  }
+
+  std::complex<double> expected = 0.0;
+  for (auto &el : op.to_sparse_matrix()) {
+    expected += std::conj(psi[el.row()]) * el.coeff() * psi[el.col()];
+  }
+  const auto value = op.expectationValue(psi.data(), psi.size());
+  EXPECT_NEAR(expected.real(), value.real(), 1e-12);
+  EXPECT_NEAR(expected.imag(), value.imag(), 1e-12);
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize(argc, argv);
   ::testing::InitGoogleTest(&argc, argv);
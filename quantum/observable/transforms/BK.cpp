@@ -0,0 +1,50 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "BK.hpp"
+
+namespace {
+void setBit(std::vector<uint64_t> &io_words, int in_bit) {
+  io_words[in_bit / 64] |= 1ULL << (in_bit % 64);
+}
+} // namespace
+
+namespace xacc {
+namespace quantum {
+void BK::ladderOperator(int in_mode, int in_nbModes, SymplecticPauli &out_x,
+                        SymplecticPauli &out_y) const {
+  const size_t nbWords = (in_nbModes + 63) / 64;
+  std::vector<uint64_t> x(nbWords, 0), zParity(nbWords, 0),
+      zRemainder(nbWords, 0);
+  // 1-based Fenwick tree indices: qubit k - 1 stores the parity of the modes
+  // (k - lowbit(k), k].
+  const auto lowbit = [](int k) { return k & -k; };
+  const int j = in_mode + 1;
+  for (int k = j + lowbit(j); k <= in_nbModes; k += lowbit(k)) {
+    // Update set: the ancestors of j
+    setBit(x, k - 1);
+  }
+  for (int k = j - 1; k > 0; k -= lowbit(k)) {
+    // Parity set: the prefix (modes < j)
+    setBit(zParity, k - 1);
+    if (k <= j - lowbit(j)) {
+      // Remainder set: the prefix without the children of j
+      setBit(zRemainder, k - 1);
+    }
+  }
+  setBit(x, j - 1);
+  out_x = SymplecticPauli(x, zParity);
+  setBit(zRemainder, j - 1);
+  out_y = SymplecticPauli(x, zRemainder);
+}
+} // namespace quantum
+} // namespace xacc
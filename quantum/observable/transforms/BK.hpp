@@ -0,0 +1,38 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_IR_OBSERVABLETRANSFORM_BK_HPP_
+#define XACC_IR_OBSERVABLETRANSFORM_BK_HPP_
+#include "FermionToQubitTransform.hpp"
+namespace xacc {
+namespace quantum {
+// Bravyi-Kitaev encoding (Fenwick tree form, any number of modes): qubit j
+// stores the parity of a block of modes, so the ladder operators act on
+// O(log n) qubits:
+//   P_x = X_U(j) X_j Z_P(j), P_y = X_U(j) Y_j Z_R(j)
+// with U the update set, P the parity set and R the remainder set of j.
+// The number of modes is that of the highest mode in the observable.
+class BK : public FermionToQubitTransform {
+public:
+  const std::string name() const override { return "bk"; }
+
+  const std::string description() const override {
+    return "Bravyi-Kitaev fermion-to-qubit transform.";
+  }
+
+protected:
+  void ladderOperator(int in_mode, int in_nbModes, SymplecticPauli &out_x,
+                      SymplecticPauli &out_y) const override;
+};
+} // namespace quantum
+} // namespace xacc
+#endif
@@ -0,0 +1,198 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "FermionToQubitTransform.hpp"
+#include "FermionOperator.hpp"
+#include "PauliOperator.hpp"
+#include "xacc.hpp"
+#include "xacc_observable.hpp"
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+using xacc::quantum::SymplecticPauli;
+// Below this many fermion terms, the transform runs serially.
+constexpr size_t PARALLEL_MIN_TERMS = 256;
+
+struct TermKey {
+  SymplecticPauli pauli;
+  std::string var;
+  bool operator==(const TermKey &other) const {
+    return var == other.var && pauli == other.pauli;
+  }
+};
+struct TermKeyHash {
+  size_t operator()(const TermKey &key) const {
+    return key.pauli.hash() ^ std::hash<std::string>()(key.var);
+  }
+};
+using PauliMap = std::unordered_map<TermKey, std::complex<double>, TermKeyHash>;
+} // namespace
+
+namespace xacc {
+namespace quantum {
+std::shared_ptr<Observable>
+FermionToQubitTransform::transform(std::shared_ptr<Observable> Hptr_input) {
+  // First we pre-process the observable to a FermionOperator
+  std::shared_ptr<Observable> observable;
+  if (std::dynamic_pointer_cast<FermionOperator>(Hptr_input)) {
+    observable = Hptr_input;
+  } else {
+    auto obs_str = Hptr_input->toString();
+    if (obs_str.find("^") != std::string::npos) {
+      observable = xacc::quantum::getObservable("fermion", obs_str);
+    } else {
+      XACCLogger::instance()->error(
+          "[" + name() + "] Error, cannot cast incoming Observable ptr to "
+          "something we can process.");
+    }
+  }
+
+  auto fermionObservable =
+      std::dynamic_pointer_cast<FermionOperator>(observable);
+  if (!fermionObservable) {
+    XACCLogger::instance()->info("Cannot execute " + name() +
+                                 " on a non-fermion observable.");
+    return observable;
+  }
+
+  const auto terms = fermionObservable->getTerms();
+  std::vector<const FermionTerm *> fermionTerms;
+  fermionTerms.reserve(terms.size());
+  int nbModes = 0;
+  for (auto &kv : terms) {
+    fermionTerms.emplace_back(&kv.second);
+    for (auto &op : std::get<1>(kv.second)) {
+      nbModes = std::max(nbModes, op.first + 1);
+    }
+  }
+
+  // (P_x, P_y) of each mode
+  std::vector<std::pair<SymplecticPauli, SymplecticPauli>> ladders(nbModes);
+  for (int mode = 0; mode < nbModes; ++mode) {
+    ladderOperator(mode, nbModes, ladders[mode].first, ladders[mode].second);
+  }
+
+  const std::complex<double> phases[4] = {{1.0, 0.0}, {0.0, 1.0}, {-1.0, 0.0},
+                                          {0.0, -1.0}};
+  // Expands fermionTerms[beginIdx, endIdx) into io_shards (by key hash).
+  const auto transformRange = [&](size_t beginIdx, size_t endIdx,
+                                  std::vector<PauliMap> &io_shards) {
+    std::vector<std::pair<SymplecticPauli, std::complex<double>>> current,
+        next;
+    SymplecticPauli product;
+    TermKey key;
+    for (size_t i = beginIdx; i < endIdx; ++i) {
+      const auto &term = *fermionTerms[i];
+      current.assign(1, {SymplecticPauli(), std::get<0>(term)});
+      for (const auto &[mode, isCreation] : std::get<1>(term)) {
+        const std::complex<double> xcoeff(0.5, 0.0),
+            ycoeff(0.0, isCreation ? -0.5 : 0.5);
+        next.clear();
+        const auto append = [&](const SymplecticPauli &in_pauli,
+                                std::complex<double> in_coeff) {
+          // Few strings per term: a linear search merges the duplicates.
+          for (auto &entry : next) {
+            if (entry.first == in_pauli) {
+              entry.second += in_coeff;
+              return;
+            }
+          }
+          next.emplace_back(in_pauli, in_coeff);
+        };
+        for (const auto &[pauli, coeff] : current) {
+          int phase = SymplecticPauli::multiply(pauli, ladders[mode].first,
+                                                product);
+          append(product, coeff * xcoeff * phases[phase]);
+          phase = SymplecticPauli::multiply(pauli, ladders[mode].second,
+                                            product);
+          append(product, coeff * ycoeff * phases[phase]);
+        }
+        std::swap(current, next);
+      }
+
+      key.var = std::get<2>(term);
+      for (auto &[pauli, coeff] : current) {
+        if (std::abs(coeff) < 1e-12) {
+          continue;
+        }
+        key.pauli = std::move(pauli);
+        auto &shard = io_shards[TermKeyHash()(key) % io_shards.size()];
+        auto iter = shard.find(key);
+        if (iter == shard.end()) {
+          shard.emplace(key, coeff);
+        } else {
+          iter->second += coeff;
+        }
+      }
+    }
+  };
+
+  // Same scheme as the PauliOperator products: per-task shards, then each
+  // shard merged by a single task.
+  std::shared_ptr<TaskScheduler> scheduler;
+  if (fermionTerms.size() >= PARALLEL_MIN_TERMS && xacc::isInitialized()) {
+    scheduler = xacc::getTaskScheduler();
+  }
+  const size_t nbShards =
+      scheduler ? std::max(1, scheduler->getNumberOfThreads()) : 1;
+  std::vector<std::vector<PauliMap>> partials;
+  if (nbShards == 1) {
+    partials.emplace_back(1);
+    transformRange(0, fermionTerms.size(), partials.front());
+  } else {
+    std::mutex partialsLock;
+    scheduler->parallelFor(
+        0, fermionTerms.size(), [&](size_t beginIdx, size_t endIdx) {
+          std::vector<PauliMap> shards(nbShards);
+          transformRange(beginIdx, endIdx, shards);
+          std::lock_guard<std::mutex> guard(partialsLock);
+          partials.emplace_back(std::move(shards));
+        });
+  }
+
+  std::vector<std::vector<PauliOperator>> shardTerms(nbShards);
+  const auto mergeShards = [&](size_t beginIdx, size_t endIdx) {
+    for (size_t shardIdx = beginIdx; shardIdx < endIdx; ++shardIdx) {
+      auto &merged = partials.front()[shardIdx];
+      for (size_t i = 1; i < partials.size(); ++i) {
+        for (const auto &[pauliKey, coeff] : partials[i][shardIdx]) {
+          auto [iter, inserted] = merged.emplace(pauliKey, coeff);
+          if (!inserted) {
+            iter->second += coeff;
+          }
+        }
+      }
+      for (const auto &[pauliKey, coeff] : merged) {
+        if (std::abs(coeff) >= 1e-12) {
+          shardTerms[shardIdx].emplace_back(pauliKey.pauli.toOps(), coeff,
+                                            pauliKey.var);
+        }
+      }
+    }
+  };
+  if (nbShards == 1) {
+    mergeShards(0, 1);
+  } else {
+    scheduler->parallelFor(0, nbShards, mergeShards);
+  }
+
+  auto result = std::make_shared<PauliOperator>();
+  for (auto &termList : shardTerms) {
+    for (auto &term : termList) {
+      result->operator+=(term);
+    }
+  }
+  return result;
+}
+} // namespace quantum
+} // namespace xacc
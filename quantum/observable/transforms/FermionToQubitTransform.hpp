@@ -0,0 +1,38 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_IR_OBSERVABLETRANSFORM_FERMIONTOQUBIT_HPP_
+#define XACC_IR_OBSERVABLETRANSFORM_FERMIONTOQUBIT_HPP_
+#include "ObservableTransform.hpp"
+#include "SymplecticPauli.hpp"
+
+namespace xacc {
+namespace quantum {
+// Base of the linear fermion-to-qubit encodings (Jordan-Wigner,
+// Bravyi-Kitaev, ...), where each ladder operator maps to two Pauli strings:
+//   a_j^dagger = (P_x - i P_y) / 2,  a_j = (P_x + i P_y) / 2.
+// The fermion terms are expanded directly in symplectic form, in parallel
+// across terms on the task scheduler.
+class FermionToQubitTransform : public ObservableTransform {
+public:
+  std::shared_ptr<Observable>
+  transform(std::shared_ptr<Observable> obs) override;
+
+protected:
+  // P_x and P_y of mode in_mode out of in_nbModes.
+  virtual void ladderOperator(int in_mode, int in_nbModes,
+                              SymplecticPauli &out_x,
+                              SymplecticPauli &out_y) const = 0;
+};
+} // namespace quantum
+} // namespace xacc
+#endif
@@ -11,74 +11,23 @@
  *   Alexander J. McCaskey - initial API and implementation
  *******************************************************************************/
 #include "JW.hpp"
-#include <memory>
-#include "FermionOperator.hpp"
-#include "PauliOperator.hpp"
-#include "xacc_observable.hpp"
 
 namespace xacc {
 namespace quantum {
-template <typename T>
-bool ptr_is_a(std::shared_ptr<Observable> ptr) {
-  return std::dynamic_pointer_cast<T>(ptr) != nullptr;
-}
-std::shared_ptr<Observable>
-JW::transform(std::shared_ptr<Observable> Hptr_input) {
-
-  // First we pre-process the observable to a FermionOperator
-  std::shared_ptr<Observable> observable;
-  auto obs_str = Hptr_input->toString();
-  if (ptr_is_a<FermionOperator>(Hptr_input)) {  
-    observable = Hptr_input;
-  } else if (obs_str.find("^") != std::string::npos) {
-    observable = xacc::quantum::getObservable("fermion", obs_str);
-  } else {
-    XACCLogger::instance()->error("[Jordan Wigner] Error, cannot cast incoming Observable ptr to something we can process.");
-  }
-
-  auto fermionObservable =
-      std::dynamic_pointer_cast<FermionOperator>(observable);
-
-  if (!fermionObservable) {
-    XACCLogger::instance()->info(
-        "Cannot execute Jordan Wigner on a non-fermion observable.");
-    return observable;
-  }
-
-  auto result = std::make_shared<PauliOperator>();
-
-  auto terms = fermionObservable->getTerms();
-
-  // Loop over all Fermionic terms...
-  for (auto &kv : terms) {
-
-    auto var = kv.second.var();
-    auto coeff = kv.second.coeff();
-    auto operators = kv.second.ops();
-
-    PauliOperator current(coeff, var);
-    for (auto &kv2 : operators) {
-      std::map<int, std::string> zs;
-      auto isCreation = kv2.second;
-
-      int index = kv2.first;
-
-      std::complex<double> ycoeff = isCreation ? std::complex<double>(0, -.5)
-                                               : std::complex<double>(0, .5),
-                           xcoeff(.5, 0);
-
-      for (int j = 0; j < index; j++)
-        zs.emplace(std::make_pair(j, "Z"));
-
-      current *= PauliOperator(zs) * (PauliOperator({{index, "X"}}, xcoeff) +
-                                      PauliOperator({{index, "Y"}}, ycoeff));
-    }
-
-    result->operator+=(current);
+void JW::ladderOperator(int in_mode, int in_nbModes, SymplecticPauli &out_x,
+                        SymplecticPauli &out_y) const {
+  const size_t nbWords = in_mode / 64 + 1;
+  std::vector<uint64_t> x(nbWords, 0), z(nbWords, 0);
+  // Parity string on the lower modes
+  for (size_t word = 0; word < nbWords - 1; ++word) {
+    z[word] = ~0ULL;
   }
-
-  return result;
+  const uint64_t bit = 1ULL << (in_mode % 64);
+  z.back() = bit - 1;
+  x.back() = bit;
+  out_x = SymplecticPauli(x, z);
+  z.back() |= bit;
+  out_y = SymplecticPauli(x, z);
 }
-
 } // namespace quantum
-} // namespace xacc
\ No newline at end of file
+} // namespace xacc
@@ -12,17 +12,20 @@
  *******************************************************************************/
 #ifndef XACC_IR_OBSERVABLETRANSFORM_JW_HPP_
 #define XACC_IR_OBSERVABLETRANSFORM_JW_HPP_
-#include "ObservableTransform.hpp"
+#include "FermionToQubitTransform.hpp"
 namespace xacc {
 namespace quantum {
-class JW : public ObservableTransform {
+class JW : public FermionToQubitTransform {
 public:
-  std::shared_ptr<Observable>
-  transform(std::shared_ptr<Observable> obs) override;
   const std::string name() const override { return "jw"; }
 
   const std::string description() const override { return ""; }
+
+protected:
+  // P_x = Z_0 ... Z_{j-1} X_j, P_y = Z_0 ... Z_{j-1} Y_j
+  void ladderOperator(int in_mode, int in_nbModes, SymplecticPauli &out_x,
+                      SymplecticPauli &out_y) const override;
 };
 } // namespace quantum
 } // namespace xacc
-#endif
\ No newline at end of file
+#endif
@@ -11,6 +11,8 @@
  *   Alexander J. McCaskey - initial API and implementation
  *******************************************************************************/
 #include "JW.hpp"
+#include "BK.hpp"
+#include "Parity.hpp"
 
 #include "cppmicroservices/BundleActivator.h"
 #include "cppmicroservices/BundleContext.h"
@@ -35,6 +37,10 @@ public:
   void Start(BundleContext context) {
     auto c = std::make_shared<xacc::quantum::JW>();
     context.RegisterService<xacc::ObservableTransform>(c);
+    context.RegisterService<xacc::ObservableTransform>(
+        std::make_shared<xacc::quantum::BK>());
+    context.RegisterService<xacc::ObservableTransform>(
+        std::make_shared<xacc::quantum::Parity>());
   }
 
   /**
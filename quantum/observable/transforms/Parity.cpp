@@ -0,0 +1,35 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "Parity.hpp"
+
+namespace xacc {
+namespace quantum {
+void Parity::ladderOperator(int in_mode, int in_nbModes,
+                            SymplecticPauli &out_x,
+                            SymplecticPauli &out_y) const {
+  const size_t nbWords = (in_nbModes + 63) / 64;
+  std::vector<uint64_t> x(nbWords, 0), z(nbWords, 0);
+  // Update string on the higher modes, and X_j
+  for (int k = in_mode; k < in_nbModes; ++k) {
+    x[k / 64] |= 1ULL << (k % 64);
+  }
+  if (in_mode > 0) {
+    z[(in_mode - 1) / 64] |= 1ULL << ((in_mode - 1) % 64);
+  }
+  out_x = SymplecticPauli(x, z);
+  std::fill(z.begin(), z.end(), 0);
+  z[in_mode / 64] |= 1ULL << (in_mode % 64);
+  out_y = SymplecticPauli(x, z);
+}
+} // namespace quantum
+} // namespace xacc
@@ -0,0 +1,37 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_IR_OBSERVABLETRANSFORM_PARITY_HPP_
+#define XACC_IR_OBSERVABLETRANSFORM_PARITY_HPP_
+#include "FermionToQubitTransform.hpp"
+namespace xacc {
+namespace quantum {
+// Parity encoding: qubit j stores the parity of the modes 0 to j.
+//   P_x = Z_{j-1} X_j X_{j+1} ... X_{n-1}, P_y = Y_j X_{j+1} ... X_{n-1}
+// For a particle (and spin) conserving Hamiltonian, with the spin-up modes
+// first, qubits n/2 - 1 and n - 1 only carry Z operators: qubit-tapering
+// removes them ("fermion-transform" option).
+class Parity : public FermionToQubitTransform {
+public:
+  const std::string name() const override { return "parity"; }
+
+  const std::string description() const override {
+    return "Parity fermion-to-qubit transform.";
+  }
+
+protected:
+  void ladderOperator(int in_mode, int in_nbModes, SymplecticPauli &out_x,
+                      SymplecticPauli &out_y) const override;
+};
+} // namespace quantum
+} // namespace xacc
+#endif
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include "BK.hpp"
+#include "JW.hpp"
+#include "xacc.hpp"
+#include <Eigen/Dense>
+#include <memory>
+#include "FermionOperator.hpp"
+#include "PauliOperator.hpp"
+
+using namespace xacc::quantum;
+
+TEST(BravyiKitaevTransformationTester, checkLadderOperators) {
+  BK t;
+  // The highest mode sets the number of modes (4): a_1^dagger is
+  // 0.5 Z0 X1 X3 - 0.5i Y1 X3
+  auto bk = std::dynamic_pointer_cast<PauliOperator>(
+      t.transform(std::make_shared<FermionOperator>("1^ + 0.001 3^")));
+  auto terms = bk->getTerms();
+  EXPECT_EQ(4, terms.size());
+  EXPECT_NEAR(0.5, terms.at("Z0X1X3").coeff().real(), 1e-9);
+  EXPECT_NEAR(-0.5, terms.at("Y1X3").coeff().imag(), 1e-9);
+  EXPECT_NEAR(0.0005, terms.at("Z1Z2X3").coeff().real(), 1e-9);
+  EXPECT_NEAR(-0.0005, terms.at("Y3").coeff().imag(), 1e-9);
+
+  // Number operator: n_1 = (1 - Z0 Z1) / 2
+  auto n1 = std::dynamic_pointer_cast<PauliOperator>(
+      t.transform(std::make_shared<FermionOperator>("1^ 1")));
+  EXPECT_TRUE(n1->operator==(PauliOperator("0.5 I + -0.5 Z0 Z1")));
+}
+
+TEST(BravyiKitaevTransformationTester, checkSpectrum) {
+  // Same spectrum as the Jordan-Wigner encoding
+  auto fermion = std::make_shared<FermionOperator>(
+      "0.5 0^ 2 + 0.5 2^ 0 + -1.2 1^ 1 + 0.3 3^ 1 + 0.3 1^ 3 + 0.7 0^ 1^ 3 2 "
+      "+ 0.7 2^ 3^ 1 0 + 0.2 4^ 0 + 0.2 0^ 4");
+  JW jw;
+  BK bk;
+  auto eigenvalues = [](std::shared_ptr<xacc::Observable> obs) {
+    auto data = std::dynamic_pointer_cast<PauliOperator>(obs)->toDenseMatrix(5);
+    Eigen::MatrixXcd m = Eigen::Map<Eigen::MatrixXcd>(data.data(), 32, 32);
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXcd> solver(m);
+    return Eigen::VectorXd(solver.eigenvalues());
+  };
+  EXPECT_NEAR(
+      0.0,
+      (eigenvalues(jw.transform(fermion)) - eigenvalues(bk.transform(fermion)))
+          .norm(),
+      1e-9);
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize(argc, argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
@@ -3,6 +3,7 @@
 #include "xacc.hpp"
 #include <memory>
 #include <regex>
+#include <sstream>
 #include "FermionOperator.hpp"
 #include "PauliOperator.hpp"
 
@@ -40,6 +41,41 @@ TEST(JordanWignerTransformationTester, checkEasyTransform) {
   EXPECT_TRUE(std::dynamic_pointer_cast<PauliOperator>(result)->operator==(op));
 }
 
+TEST(JordanWignerTransformationTester, checkManyTerms) {
+  // Enough terms to run the transform on the task scheduler
+  std::stringstream ss;
+  for (int i = 0; i < 18; i++) {
+    for (int j = 0; j < 18; j++) {
+      ss << (i == 0 && j == 0 ? "" : " + ") << 0.1 * (i + 1) - 0.05 * j << " "
+         << i << "^ " << j;
+    }
+  }
+  auto fermion = std::make_shared<FermionOperator>(ss.str());
+  JW t;
+  auto result = std::dynamic_pointer_cast<PauliOperator>(t.transform(fermion));
+
+  // Reference: the ladder operators as PauliOperator products
+  auto ladder = [](int index, bool isCreation) {
+    std::map<int, std::string> zs;
+    for (int j = 0; j < index; j++) {
+      zs.emplace(j, "Z");
+    }
+    return PauliOperator(zs) *
+           (PauliOperator({{index, "X"}}, 0.5) +
+            PauliOperator({{index, "Y"}}, std::complex<double>(
+                                              0, isCreation ? -0.5 : 0.5)));
+  };
+  PauliOperator expected;
+  for (auto &kv : fermion->getTerms()) {
+    PauliOperator current(kv.second.coeff());
+    for (auto &op : kv.second.ops()) {
+      current *= ladder(op.first, op.second);
+    }
+    expected += current;
+  }
+  EXPECT_TRUE(result->operator==(expected));
+}
+
 // TEST(JordanWignerTransformationTester,checkH2Transform) {
 
 // 	const std::string code =
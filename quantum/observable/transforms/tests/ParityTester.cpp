@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include "JW.hpp"
+#include "Parity.hpp"
+#include "xacc.hpp"
+#include <Eigen/Dense>
+#include <memory>
+#include "FermionOperator.hpp"
+#include "PauliOperator.hpp"
+
+using namespace xacc::quantum;
+
+TEST(ParityTransformationTester, checkLadderOperators) {
+  Parity t;
+  // 3 modes: a_1^dagger = 0.5 Z0 X1 X2 - 0.5i Y1 X2
+  auto result = std::dynamic_pointer_cast<PauliOperator>(
+      t.transform(std::make_shared<FermionOperator>("1^ + 0.001 2^")));
+  auto terms = result->getTerms();
+  EXPECT_NEAR(0.5, terms.at("Z0X1X2").coeff().real(), 1e-9);
+  EXPECT_NEAR(-0.5, terms.at("Y1X2").coeff().imag(), 1e-9);
+
+  // Number operator: n_1 = (1 - Z0 Z1) / 2
+  auto n1 = std::dynamic_pointer_cast<PauliOperator>(
+      t.transform(std::make_shared<FermionOperator>("1^ 1")));
+  EXPECT_TRUE(n1->operator==(PauliOperator("0.5 I + -0.5 Z0 Z1")));
+}
+
+TEST(ParityTransformationTester, checkParityQubits) {
+  // Spin-conserving, spin-up orbitals (0, 1) first: qubits 1 and 3 only
+  // carry Z operators.
+  auto fermion = std::make_shared<FermionOperator>(
+      "0.5 0^ 1 + 0.5 1^ 0 + 0.5 2^ 3 + 0.5 3^ 2 + -1.2 1^ 1 + 0.4 0^ 2^ 3 1 "
+      "+ 0.4 1^ 3^ 2 0");
+  Parity parity;
+  JW jw;
+  auto result = std::dynamic_pointer_cast<PauliOperator>(
+      parity.transform(fermion));
+  for (auto &kv : result->getTerms()) {
+    for (auto &op : kv.second.ops()) {
+      if (op.first == 1 || op.first == 3) {
+        EXPECT_EQ("Z", op.second);
+      }
+    }
+  }
+
+  auto eigenvalues = [](std::shared_ptr<xacc::Observable> obs) {
+    auto data = std::dynamic_pointer_cast<PauliOperator>(obs)->toDenseMatrix(4);
+    Eigen::MatrixXcd m = Eigen::Map<Eigen::MatrixXcd>(data.data(), 16, 16);
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXcd> solver(m);
+    return Eigen::VectorXd(solver.eigenvalues());
+  };
+  EXPECT_NEAR(0.0,
+              (eigenvalues(jw.transform(fermion)) - eigenvalues(result)).norm(),
+              1e-9);
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize(argc, argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
@@ -23,7 +23,9 @@
 #include "xacc_observable.hpp"
 #include "Circuit.hpp"
 #include "AlgorithmGradientStrategy.hpp"
+#include "DistributedExecution.hpp"
 
+#include <algorithm>
 #include <complex>
 #include <memory>
 #include <iomanip>
@@ -80,6 +82,19 @@ bool ADAPT::initialize(const HeterogeneousMap &parameters) {
     _printOps = parameters.get<bool>("print-operators");
   }
 
+  if (parameters.keyExists<bool>("layer-wise")) {
+    _layerWise = parameters.get<bool>("layer-wise");
+    if (_layerWise && subAlgo != "vqe") {
+      xacc::warning("ADAPT layer-wise optimization requires the vqe "
+                    "sub-algorithm, optimizing all parameters.");
+      _layerWise = false;
+    }
+  }
+
+  if (parameters.keyExists<bool>("distributed-pool")) {
+    _distributedPool = parameters.get<bool>("distributed-pool");
+  }
+
   if (parameters.stringExists("gradient_strategy")) {
     gradStrategyName = parameters.getString("gradient_strategy");
   }
@@ -133,6 +148,8 @@ bool ADAPT::initialize(const HeterogeneousMap &parameters) {
     observable = std::dynamic_pointer_cast<Observable>(pauliObservable);
   }
 
+  checkpoint = Checkpoint::fromParameters(parameters);
+  profiler.initialize(parameters);
   return true;
 }
 
@@ -152,7 +169,7 @@ void ADAPT::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
 
   if (initialState) {
 
-    for (auto &inst : initialState->getInstructions()) {
+    for (auto &inst : initialState->getInstructionsView()) {
       ansatzInstructions->addInstruction(inst);
     }
 
@@ -188,26 +205,63 @@ void ADAPT::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
   auto operators = pool->generate(buffer->size());
   std::vector<int> ansatzOps;
 
-  // Vector of commutators, need to compute them only once
-  std::vector<std::shared_ptr<Observable>> commutators;
-  if (subAlgo == "QAOA") {
+  // With an MPI-distributed accelerator, each virtual QPU only builds and
+  // measures the commutators of its slice of the pool, on its own QPU; the
+  // selection is reduced over the virtual QPUs.
+  auto distributed =
+      _distributedPool
+          ? std::dynamic_pointer_cast<DistributedExecution>(accelerator)
+          : nullptr;
+  if (distributed && distributed->nbVirtualQpus() < 2) {
+    distributed = nullptr;
+  }
+  size_t poolBegin = 0, poolEnd = operators.size();
+  auto commutatorAccelerator = accelerator;
+  if (distributed) {
+    std::tie(poolBegin, poolEnd) = distributed->localRange(operators.size());
+    commutatorAccelerator = distributed->localAccelerator();
+    xacc::info("Virtual QPU " + std::to_string(distributed->virtualQpuIndex()) +
+               " screens the operators [" + std::to_string(poolBegin) + ", " +
+               std::to_string(poolEnd) + ") of the pool.");
+  }
 
-    std::complex<double> i(0, 1);
-    for (auto op : operators) {
-      auto comm = observable->commutator(op);
+  // Vector of commutators, need to compute them only once. Each one is a
+  // symplectic Pauli product, computed in parallel over the pool.
+  std::vector<std::shared_ptr<Observable>> commutators(operators.size());
+  auto computeCommutator = [&](size_t opIdx) {
+    auto comm = observable->commutator(operators[opIdx]);
+    if (subAlgo == "QAOA") {
       auto &tmp = *std::dynamic_pointer_cast<PauliOperator>(comm);
-      tmp = tmp * i;
-      auto ptr = std::dynamic_pointer_cast<Observable>(
-          std::make_shared<PauliOperator>(tmp));
-      commutators.push_back(ptr);
+      tmp = tmp * std::complex<double>(0, 1);
     }
-
-  } else {
-
-    for (auto op : operators) {
-      commutators.push_back(observable->commutator(op));
+    commutators[opIdx] = comm;
+  };
+  xacc::getTaskScheduler()->parallelFor(
+      poolBegin, poolEnd, [&](std::size_t beginIdx, std::size_t endIdx) {
+        for (auto opIdx = beginIdx; opIdx < endIdx; ++opIdx) {
+          computeCommutator(opIdx);
+        }
+      });
+
+  // The distinct Pauli terms of all the commutators: each one is measured
+  // once per iteration, in a single submission, and the commutators are
+  // evaluated from these expectation values.
+  auto commutatorTerms = std::make_shared<PauliOperator>();
+  for (size_t opIdx = poolBegin; opIdx < poolEnd; ++opIdx) {
+    auto &comm = commutators[opIdx];
+    for (auto &[termId, term] :
+         std::dynamic_pointer_cast<PauliOperator>(comm)->getTerms()) {
+      if (!term.isIdentity()) {
+        *commutatorTerms += PauliOperator(term.ops(), 1.0);
+      }
     }
   }
+  const bool hasCommutatorTerms = !commutatorTerms->getTerms().empty();
+  const HeterogeneousMap postProcessOptions{std::make_pair(
+      "bit-order",
+      std::string(accelerator->getBitOrder() == Accelerator::BitOrder::MSB
+                      ? "MSB"
+                      : "LSB"))};
 
   xacc::info("Operator pool: " + pool->name());
   xacc::info("Number of operators in the pool: " +
@@ -215,8 +269,82 @@ void ADAPT::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
   double oldEnergy = 0.0;
   std::vector<double> x; // these are the variational parameters
 
+  // QAOA: the cost Hamiltonian layer at the start of each iteration
+  const auto addCostLayer = [&]() {
+    auto costHamiltonianGates = std::dynamic_pointer_cast<quantum::Circuit>(
+        xacc::getService<Instruction>("exp_i_theta"));
+
+    // Create instruction for new operator
+    costHamiltonianGates->expand(
+        {std::make_pair("pauli", observable->toString()),
+         std::make_pair(
+             "param_id",
+             "x" + std::to_string(ansatzInstructions->nVariables()))});
+
+    ansatzInstructions->addVariable(
+        "x" + std::to_string(ansatzInstructions->nVariables()));
+    for (auto &inst : costHamiltonianGates->getInstructionsView()) {
+      ansatzInstructions->addInstruction(inst);
+    }
+  };
+  // Appends the pool operator (with a new variable), returns its gates
+  const auto addOperator = [&](int in_opIdx) {
+    // Instruction service for the operator to be added to the ansatz
+    auto operatorGates = pool->getOperatorInstructions(
+        in_opIdx, ansatzInstructions->nVariables());
+
+    // Label for new variable and add it to the circuit
+    ansatzInstructions->addVariable(
+        "x" + std::to_string(ansatzInstructions->nVariables()));
+
+    // Append new instructions to current circuit
+    for (auto &inst : operatorGates->getInstructionsView()) {
+      ansatzInstructions->addInstruction(inst);
+    }
+    return operatorGates;
+  };
+
+  // Restart: the ansatz of the completed iterations is rebuilt from their
+  // operators, and the operator selected at the interrupted one (if any) is
+  // optimized without measuring the commutators again.
+  int firstIter = 0;
+  std::vector<int> restoredOps;
+  if (checkpoint) {
+    ss << "adapt|" << subAlgo << "|" << pool->name() << "|" << _layerWise
+       << "|" << observable->toString();
+    auto &state = checkpoint->state();
+    if (checkpoint->restore(ss.str()) && state.hasExtraInfoKey("adapt-ops")) {
+      restoredOps = state.getInformation("adapt-ops").as<std::vector<int>>();
+      if (state.hasExtraInfoKey("adapt-iterations")) {
+        firstIter = state.getInformation("adapt-iterations").as<int>();
+        x = state.getInformation("adapt-params").as<std::vector<double>>();
+        oldEnergy = state.getInformation("adapt-energy").as<double>();
+      }
+      for (int iter = 0; iter < firstIter; iter++) {
+        if (subAlgo == "QAOA") {
+          addCostLayer();
+        }
+        addOperator(restoredOps[iter]);
+        ansatzOps.push_back(restoredOps[iter]);
+      }
+      if (firstIter > 0) {
+        buffer->addExtraInfo("opt-val", ExtraInfo(oldEnergy));
+        buffer->addExtraInfo("opt-params", ExtraInfo(x));
+        buffer->addExtraInfo("opt-ansatz", ExtraInfo(ansatzOps));
+      }
+      xacc::info("ADAPT restarts at iteration " +
+                 std::to_string(firstIter + 1));
+    }
+    ss.str(std::string());
+  }
+
+  // Null unless profiling
+  const auto spans = profiler.recorder();
+
   // start ADAPT loop
-  for (int iter = 0; iter < _maxIter; iter++) {
+  for (int iter = firstIter; iter < _maxIter; iter++) {
+    ScopeTimer iteration("adapt-iteration", spans.get());
+    iteration.phase("ansatz");
 
     xacc::info("Iteration: " + std::to_string(iter + 1));
     xacc::info("Computing [H, A]");
@@ -224,32 +352,41 @@ void ADAPT::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
                std::to_string(_printThreshold));
 
     if (subAlgo == "QAOA") {
-
-      auto costHamiltonianGates = std::dynamic_pointer_cast<quantum::Circuit>(
-          xacc::getService<Instruction>("exp_i_theta"));
-
-      // Create instruction for new operator
-      costHamiltonianGates->expand(
-          {std::make_pair("pauli", observable->toString()),
-           std::make_pair(
-               "param_id",
-               "x" + std::to_string(ansatzInstructions->nVariables()))});
-
-      ansatzInstructions->addVariable(
-          "x" + std::to_string(ansatzInstructions->nVariables()));
-      for (auto &inst : costHamiltonianGates->getInstructions()) {
-        ansatzInstructions->addInstruction(inst);
-      }
+      addCostLayer();
       x.insert(x.begin(), 0.01);
     }
 
     int maxCommutatorIdx = 0;
     double maxCommutator = 0.0;
     double gradientNorm = 0.0;
+    // Selected before the restart
+    const bool restoredOp = iter < restoredOps.size();
+    if (restoredOp) {
+      maxCommutatorIdx = restoredOps[iter];
+      xacc::info("Operator " + std::to_string(maxCommutatorIdx) +
+                 " was selected before the restart.");
+    }
+
+    // Measure the terms of all the commutators with the updated circuit ansatz
+    iteration.phase("commutators");
+    auto commutatorBuffer = xacc::qalloc(buffer->size());
+    if (hasCommutatorTerms && !restoredOp) {
+      // Same parameter binding as the sub-algorithm: VQE::execute reverses
+      // the parameters.
+      auto params = x;
+      if (subAlgo == "vqe") {
+        std::reverse(params.begin(), params.end());
+      }
+      commutatorAccelerator->computeExpectations(
+          commutatorBuffer, ansatzInstructions->operator()(params),
+          commutatorTerms);
+    }
 
     // Loop over non-vanishing commutators and select the one with largest
     // magnitude
-    for (int operatorIdx = 0; operatorIdx < commutators.size(); operatorIdx++) {
+    iteration.phase("selection");
+    for (int operatorIdx = poolBegin; operatorIdx < poolEnd && !restoredOp;
+         operatorIdx++) {
 
       // only compute commutators if they aren't zero
       int nTermsCommutator =
@@ -259,18 +396,14 @@ void ADAPT::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
       if (nTermsCommutator != 0) {
 
         // Print number of instructions for computing <observable>
-        xacc::info("Number of instructions for commutator calculation: " +
-                   std::to_string(nTermsCommutator));
-        // observe the commutators with the updated circuit ansatz
-        auto grad_algo = xacc::getAlgorithm(
-            subAlgo, {std::make_pair("observable", commutators[operatorIdx]),
-                      std::make_pair("optimizer", optimizer),
-                      std::make_pair("accelerator", accelerator),
-                      std::make_pair("ansatz", ansatzInstructions)});
-        auto tmp_buffer = xacc::qalloc(buffer->size());
-        auto commutatorValue = std::real(grad_algo->execute(tmp_buffer, x)[0]);
-
-        if (abs(commutatorValue) > _printThreshold) {
+        XACC_LOG_INFO("Number of instructions for commutator calculation: " +
+                      std::to_string(nTermsCommutator));
+        const double commutatorValue = commutators[operatorIdx]->postProcess(
+            commutatorBuffer, Observable::PostProcessingTask::EXP_VAL_CALC,
+            postProcessOptions);
+
+        if (abs(commutatorValue) > _printThreshold &&
+            xacc::loggingEnabled(1)) {
           ss << std::setprecision(12) << "[H," << operatorIdx
              << "] = " << commutatorValue;
           xacc::info(ss.str());
@@ -287,18 +420,38 @@ void ADAPT::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
       }
     }
 
-    ss << std::setprecision(12) << "Max gradient component: [H, "
-       << maxCommutatorIdx << "] = " << maxCommutator << " a.u.";
-    xacc::info(ss.str());
-    ss.str(std::string());
+    if (distributed && !restoredOp) {
+      // The largest magnitude over the virtual QPUs (MPI_MAXLOC), then its
+      // signed value (from its virtual QPU only) and the norm.
+      const int localMaxIdx = maxCommutatorIdx;
+      maxCommutatorIdx =
+          distributed->allReduceMaxLoc(std::abs(maxCommutator), localMaxIdx)
+              .second;
+      std::vector<double> sums{
+          gradientNorm, localMaxIdx == maxCommutatorIdx ? maxCommutator : 0.0};
+      distributed->allReduceSum(sums);
+      gradientNorm = sums[0];
+      maxCommutator = sums[1];
+      if (!commutators[maxCommutatorIdx]) {
+        // Selected from another slice
+        computeCommutator(maxCommutatorIdx);
+      }
+    }
 
-    gradientNorm = std::sqrt(gradientNorm);
-    ss << std::setprecision(12) << "Norm of gradient vector: " << gradientNorm
-       << " a.u.";
-    xacc::info(ss.str());
-    ss.str(std::string());
+    if (!restoredOp) {
+      ss << std::setprecision(12) << "Max gradient component: [H, "
+         << maxCommutatorIdx << "] = " << maxCommutator << " a.u.";
+      xacc::info(ss.str());
+      ss.str(std::string());
+
+      gradientNorm = std::sqrt(gradientNorm);
+      ss << std::setprecision(12) << "Norm of gradient vector: "
+         << gradientNorm << " a.u.";
+      xacc::info(ss.str());
+      ss.str(std::string());
+    }
 
-    if (gradientNorm < _adaptThreshold) { // ADAPT converged
+    if (!restoredOp && gradientNorm < _adaptThreshold) { // ADAPT converged
 
       xacc::info("ADAPT-" + subAlgo + " converged in " + std::to_string(iter) +
                  " iterations.");
@@ -320,35 +473,59 @@ void ADAPT::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
       // Add the ansatz to the compilation database for later retrieval
       xacc::appendCompiled(ansatzInstructions, true);
       buffer->addExtraInfo("final-ansatz", ExtraInfo(ansatzInstructions->name()));
-      return;
+      break;
 
     } else if (iter < _maxIter) { // Add operator and reoptimize
 
       xacc::info(subAlgo + " optimization of current ansatz.");
+      iteration.phase("ansatz");
 
       // keep track of growing ansatz
       ansatzOps.push_back(maxCommutatorIdx);
+      if (checkpoint) {
+        checkpoint->state().addExtraInfo("adapt-ops", ExtraInfo(ansatzOps));
+        checkpoint->beginStage(iter + 1);
+        checkpoint->save();
+      }
 
-      // Instruction service for the operator to be added to the ansatz
-      auto maxCommutatorGate = pool->getOperatorInstructions(
-          maxCommutatorIdx, ansatzInstructions->nVariables());
-
-      // Label for new variable and add it to the circuit
-      ansatzInstructions->addVariable(
-          "x" + std::to_string(ansatzInstructions->nVariables()));
+      // Layer-wise: the current ansatz is frozen at its optimal parameters
+      // (VQE binds them in reverse order), only the new one is optimized.
+      std::shared_ptr<CompositeInstruction> frozenAnsatz;
+      if (_layerWise) {
+        auto params = x;
+        std::reverse(params.begin(), params.end());
+        frozenAnsatz = ansatzInstructions->operator()(params);
+      }
 
-      // Append new instructions to current circuit
-      for (auto &inst : maxCommutatorGate->getInstructions()) {
-        ansatzInstructions->addInstruction(inst);
+      const auto newVariable =
+          "x" + std::to_string(ansatzInstructions->nVariables());
+      auto maxCommutatorGate = addOperator(maxCommutatorIdx);
+
+      std::shared_ptr<CompositeInstruction> subAnsatz = ansatzInstructions;
+      if (_layerWise) {
+        subAnsatz = ansatzRegistry->createComposite(
+            "ansatzLayer" + std::to_string(iter + 1));
+        subAnsatz->addVariable(newVariable);
+        for (auto &inst : frozenAnsatz->getInstructionsView()) {
+          subAnsatz->addInstruction(inst);
+        }
+        for (auto &inst : maxCommutatorGate->getInstructionsView()) {
+          subAnsatz->addInstruction(inst);
+        }
       }
 
       // Convergence is improved if passing initial parameters to optimizer
-      // so we create a new instance of Optimizer with them
-      // insert 0.0 for VQE and pi/2 for QAOA
+      // so we create a new instance of Optimizer with them: the optimal
+      // parameters of the previous iteration (warm start), and 0.0 for VQE
+      // or pi/2 for QAOA for the new operator
+      const double newParameter =
+          subAlgo == "QAOA" ? xacc::constants::pi / 2.0 : 0.0;
+      x.insert(x.begin(), newParameter);
+      const std::vector<double> initialParameters =
+          _layerWise ? std::vector<double>{newParameter} : x;
 
       // Instantiate gradient class
       std::shared_ptr<AlgorithmGradientStrategy> gradientStrategy;
-      std::shared_ptr<Optimizer> newOptimizer;
       if (!gradStrategyName.empty() && subAlgo == "vqe" &&
           optimizer->isGradientBased()) {
 
@@ -357,11 +534,6 @@ void ADAPT::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
         gradientStrategy->initialize(
             {std::make_pair("observable", observable),
              std::make_pair("commutator", commutators[maxCommutatorIdx])});
-        x.insert(x.begin(), 0.0);
-        newOptimizer = xacc::getOptimizer(
-            optimizer->name(), {std::make_pair(optimizer->name() + "-optimizer",
-                                               optimizer->get_algorithm()),
-                                std::make_pair("initial-parameters", x)});
 
       } else if (!gradStrategyName.empty() && subAlgo == "QAOA" &&
                  optimizer->isGradientBased()) {
@@ -370,30 +542,37 @@ void ADAPT::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
             xacc::getService<AlgorithmGradientStrategy>(gradStrategyName);
         gradientStrategy->initialize(
             {std::make_pair("observable", observable)});
-        x.insert(x.begin(), xacc::constants::pi / 2.0);
-        newOptimizer = xacc::getOptimizer(
-            optimizer->name(), {std::make_pair(optimizer->name() + "-optimizer",
-                                               optimizer->get_algorithm()),
-                                std::make_pair("initial-parameters", x)});
-
-      } else {
-        gradientStrategy = nullptr;
-        newOptimizer = xacc::getOptimizer(
-            optimizer->name(), {std::make_pair(optimizer->name() + "-optimizer",
-                                               optimizer->get_algorithm())});
       }
+      auto newOptimizer = xacc::getOptimizer(
+          optimizer->name(),
+          {std::make_pair(optimizer->name() + "-optimizer",
+                          optimizer->get_algorithm()),
+           std::make_pair("initial-parameters", initialParameters)});
 
       // Start subAlgo optimization
-      auto sub_opt = xacc::getAlgorithm(
-          subAlgo, {std::make_pair("observable", observable),
-                    std::make_pair("optimizer", newOptimizer),
-                    std::make_pair("accelerator", accelerator),
-                    std::make_pair("gradient_strategy", gradientStrategy),
-                    std::make_pair("ansatz", ansatzInstructions)});
+      iteration.phase("optimization");
+      HeterogeneousMap subOptions{
+          std::make_pair("observable", observable),
+          std::make_pair("optimizer", newOptimizer),
+          std::make_pair("accelerator", accelerator),
+          std::make_pair("gradient_strategy", gradientStrategy),
+          std::make_pair("ansatz", subAnsatz)};
+      if (spans) {
+        subOptions.insert("profile", true);
+      }
+      if (checkpoint) {
+        subOptions.insert("checkpoint", checkpoint);
+      }
+      auto sub_opt = xacc::getAlgorithm(subAlgo, subOptions);
       sub_opt->execute(buffer);
+      iteration.phase("bookkeeping");
 
       auto newEnergy = (*buffer)["opt-val"].as<double>();
-      x = (*buffer)["opt-params"].as<std::vector<double>>();
+      if (_layerWise) {
+        x[0] = (*buffer)["opt-params"].as<std::vector<double>>()[0];
+      } else {
+        x = (*buffer)["opt-params"].as<std::vector<double>>();
+      }
       oldEnergy = newEnergy;
 
       ss << std::setprecision(12) << "Energy at ADAPT iteration " << iter + 1
@@ -428,13 +607,21 @@ void ADAPT::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
       buffer->addExtraInfo("opt-val", ExtraInfo(oldEnergy));
       buffer->addExtraInfo("opt-params", ExtraInfo(x));
       buffer->addExtraInfo("opt-ansatz", ExtraInfo(ansatzOps));
+      if (checkpoint) {
+        auto &state = checkpoint->state();
+        state.addExtraInfo("adapt-iterations", iter + 1);
+        state.addExtraInfo("adapt-params", ExtraInfo(x));
+        state.addExtraInfo("adapt-energy", oldEnergy);
+        checkpoint->save();
+      }
 
     } else {
       xacc::info("ADAPT-" + subAlgo + " did not converge in " +
                  std::to_string(_maxIter) + " iterations.");
-      return;
+      break;
     }
   }
+  profiler.record(spans.get(), {"adapt-iteration"}, *buffer);
 }
 
 } // namespace algorithm
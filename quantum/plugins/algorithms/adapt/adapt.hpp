@@ -14,6 +14,8 @@
 #define XACC_ALGORITHM_ADAPT_HPP_
 
 #include "Algorithm.hpp"
+#include "AlgorithmProfiler.hpp"
+#include "Checkpoint.hpp"
 #include "Observable.hpp"
 #include "PauliOperator.hpp"
 #include "OperatorPool.hpp"
@@ -40,12 +42,24 @@ protected:
   double _printThreshold = 1.0e-10; // threshold to print commutator
   bool _printOps = false; // set to true to print operators at every iteration
   int _nElectrons; // # of electrons, used for VQE
+  // only optimize the parameter of the new operator at each iteration (VQE)
+  bool _layerWise = false;
+  // partition the pool over the virtual QPUs of an hpc-virtualization
+  // accelerator (DistributedExecution)
+  bool _distributedPool = true;
 
   std::vector<int> checkpointOps; // indices of operators to construct initial ansatz
   std::vector<double> checkpointParams; // initial parameters for initial ansatz
   // name of class to compute gradient for optimization
   // defaults to parameter shift
   std::string gradStrategyName = "parameter-shift-gradient"; 
+  // "profile": commutators / selection / ansatz / optimization durations of
+  // each ADAPT iteration (and the profile of the sub-algorithm)
+  AlgorithmProfiler profiler;
+  // "checkpoint": the selected operators and the parameters of each ADAPT
+  // iteration, and the evaluations of the current optimization (shared with
+  // the sub-algorithm). A restart resumes at the interrupted iteration.
+  std::shared_ptr<Checkpoint> checkpoint;
 
 public:
 
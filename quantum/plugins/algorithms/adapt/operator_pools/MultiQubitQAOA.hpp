@@ -15,6 +15,7 @@
 
 #include "adapt.hpp"
 #include "OperatorPool.hpp"
+#include "OperatorPoolCache.hpp"
 #include "variant.hpp"
 #include "xacc.hpp"
 #include "xacc_service.hpp"
@@ -52,9 +53,22 @@ public:
     return true;
   }
 
-  // generate the pool
+  // generate the pool, once per number of qubits
   std::vector<std::shared_ptr<Observable>> generate(const int &nQubits) override {
 
+    auto cached = OperatorPoolCache::instance().get(
+        name(), nQubits, -1, [&]() {
+          OperatorPoolCache::Pool generated;
+          generated.operators = generateOperators(nQubits);
+          generated.qubitOperators = generated.operators;
+          return generated;
+        });
+    pool = cached->qubitOperators;
+    return pool;
+  }
+
+  std::vector<std::shared_ptr<Observable>> generateOperators(const int &nQubits) {
+
     // Single-qubit pool in ADAPT-QAOA
 
     std::vector<PauliOperator> pauliOps;
@@ -94,11 +108,12 @@ public:
 
     }
 
+    std::vector<std::shared_ptr<Observable>> operators;
     for (auto op: pauliOps){
-      pool.push_back(std::dynamic_pointer_cast<Observable>(std::make_shared<PauliOperator>(op)));
+      operators.push_back(std::dynamic_pointer_cast<Observable>(std::make_shared<PauliOperator>(op)));
     }
 
-    return pool;
+    return operators;
   }
 
   std::string operatorString(const int index) override {
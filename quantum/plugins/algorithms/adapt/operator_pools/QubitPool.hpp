@@ -15,6 +15,7 @@
 
 #include "adapt.hpp"
 #include "OperatorPool.hpp"
+#include "OperatorPoolCache.hpp"
 #include "xacc.hpp"
 #include "xacc_service.hpp"
 #include "Observable.hpp"
@@ -42,93 +43,88 @@ public:
     return true;
   }
 
-  // generate the pool
+  // generate the pool, once per number of qubits
   std::vector<std::shared_ptr<Observable>> generate(const int &nQubits) override {
 
+    auto cached = OperatorPoolCache::instance().get(
+        name(), nQubits, -1, [&]() {
+          OperatorPoolCache::Pool generated;
+          generated.operators = generateOperators(nQubits);
+          generated.qubitOperators = generated.operators;
+          return generated;
+        });
+    pool = cached->qubitOperators;
+    return pool;
+  }
+
+  std::vector<std::shared_ptr<Observable>> generateOperators(const int &nQubits) {
+
     // The qubit pool vanishes for strings with an even number of Pauli Y's
     // and can have at most 4 operators
     // We loop over the indices for qubits q0-q3 and
-    // {X, Y, X} for each qubit and make sure that we have the appropriate 
-    // number of Y's and only add unique operators, i.e., those which 
-    // survive symmetry operations in the PauliOperator class.
-
-    std::vector<PauliOperator> pauliOps;
-    std::vector<std::string> label;
-    std::string opStr;
-    PauliOperator op;
+    // {X, Y, X} for each qubit and keep the strings with the appropriate 
+    // number of Y's. Each (ordered) choice of qubits and Paulis is a
+    // distinct string, so there are no duplicates to look for.
+
+    std::vector<std::shared_ptr<Observable>> operators;
+    std::map<int, std::string> ops;
+    int nY = 0;
+    const std::complex<double> i(0.0, 1.0);
+    const auto add = [&]() {
+      if (nY % 2 == 1) {
+        operators.push_back(std::make_shared<PauliOperator>(ops, i));
+      }
+    };
 
     for (int q0 = 0; q0 < nQubits; q0++){
 
       for (auto op0 : {"X", "Y", "Z"}){
 
-        label.push_back(op0);
-        if (op0 == "Y"){
-          opStr = "Y" + std::to_string(q0);
-          op.fromString("(0,1)" + opStr);
-          pauliOps.push_back(op);
-        }
+        ops[q0] = op0;
+        nY += op0 == std::string("Y");
+        add();
 
         for (int q1 = q0 + 1; q1 < nQubits; q1++){
 
           for (auto op1 : {"X", "Y", "Z"}){
 
-            label.push_back(op1);
-            if (std::count(label.begin(), label.end(), "Y") == 1){
-              opStr = op0 + std::to_string(q0) + op1 + std::to_string(q1);
-              op.fromString("(0,1)" + opStr);
-              if(!(std::find(pauliOps.begin(), pauliOps.end(), op) != pauliOps.end())){
-                pauliOps.push_back(op);
-              }
-
-            }
+            ops[q1] = op1;
+            nY += op1 == std::string("Y");
+            add();
 
             for (int q2 = q1 + 1; q2 < nQubits; q2++){
 
               for (auto op2 : {"X", "Y", "Z"}){
 
-                label.push_back(op2);
-                if (std::count(label.begin(), label.end(), "Y") == 1 || std::count(label.begin(), label.end(), "Y") == 3){
-
-                  opStr = op0 + std::to_string(q0) + op1 + std::to_string(q1) + op2 + std::to_string(q2);
-                  op.fromString("(0,1)" + opStr);
-                  if(!(std::find(pauliOps.begin(), pauliOps.end(), op) != pauliOps.end())){
-                    pauliOps.push_back(op);
-                  }
-                }
+                ops[q2] = op2;
+                nY += op2 == std::string("Y");
+                add();
 
                 for (int q3 = q2 + 1; q3 < nQubits; q3++){
 
                   for (auto op3 : {"X", "Y", "Z"}){
 
-                    label.push_back(op3);
-                    if (std::count(label.begin(), label.end(), "Y") == 1 || std::count(label.begin(), label.end(), "Y") == 3){
-
-                      opStr = op0 + std::to_string(q0) + op1 + std::to_string(q1) + op2 + std::to_string(q2) + op3 + std::to_string(q3);
-                      op.fromString("(0,1)" + opStr);
-                      if(!(std::find(pauliOps.begin(), pauliOps.end(), op) != pauliOps.end())){
-                        pauliOps.push_back(op);
-                      }
-
-                    } 
-
-                    label.pop_back();
+                    ops[q3] = op3;
+                    nY += op3 == std::string("Y");
+                    add();
+                    nY -= op3 == std::string("Y");
                   }
+                  ops.erase(q3);
                 }
-                label.pop_back();
+                nY -= op2 == std::string("Y");
               }
+              ops.erase(q2);
             }
-            label.pop_back();
+            nY -= op1 == std::string("Y");
           }
+          ops.erase(q1);
         }
-        label.pop_back();
+        nY -= op0 == std::string("Y");
       }
+      ops.erase(q0);
     }
 
-    for (auto op: pauliOps){
-      pool.push_back(std::dynamic_pointer_cast<Observable>(std::make_shared<PauliOperator>(op)));
-    }
-
-    return pool;
+    return operators;
   }
 
   std::string operatorString(const int index) override {
@@ -143,7 +139,6 @@ public:
     // Instruction service for the operator to be added to the ansatz
     auto gate = std::dynamic_pointer_cast<quantum::Circuit>(
         xacc::getService<Instruction>("exp_i_theta"));
-xacc::info(std::to_string(varIdx));
     // Create instruction for new operator
     gate->expand(
         {std::make_pair("pauli", pool[opIdx]->toString()),
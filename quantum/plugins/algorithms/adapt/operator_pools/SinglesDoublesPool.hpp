@@ -15,6 +15,7 @@
 
 #include "adapt.hpp"
 #include "OperatorPool.hpp"
+#include "OperatorPoolCache.hpp"
 #include "xacc.hpp"
 #include "xacc_service.hpp"
 #include "Observable.hpp"
@@ -56,6 +57,7 @@ public:
   std::vector<std::shared_ptr<Observable>>
   getExcitationOperators(const int &nQubits) override {
 
+    operators.clear();
     auto _nOccupied = (int)std::ceil(_nElectrons / 2.0);
     auto _nVirtual = nQubits / 2 - _nOccupied;
     auto _nOrbs = _nOccupied + _nVirtual;
@@ -99,18 +101,19 @@ public:
     return operators;
   }
 
-  // generate the pool
+  // generate the pool, once per (n-qubits, n-electrons)
   std::vector<std::shared_ptr<Observable>>
   generate(const int &nQubits) override {
 
-    auto ops = getExcitationOperators(nQubits);
-    auto jw = xacc::getService<ObservableTransform>("jw");
-    for (auto &op : ops) {
-      auto tmp = *std::dynamic_pointer_cast<FermionOperator>(op);
-      tmp -= tmp.hermitianConjugate();
-      tmp.normalize();
-      pool.push_back(jw->transform(std::make_shared<FermionOperator>(tmp)));
-    }
+    auto cached = OperatorPoolCache::instance().get(
+        name(), nQubits, _nElectrons, [&]() {
+          OperatorPoolCache::Pool generated;
+          generated.operators = getExcitationOperators(nQubits);
+          generated.qubitOperators = jordanWignerPool(generated.operators);
+          return generated;
+        });
+    operators = cached->operators;
+    pool = cached->qubitOperators;
     return pool;
   }
 
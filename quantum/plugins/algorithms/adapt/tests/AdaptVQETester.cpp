@@ -21,12 +21,13 @@
 #include "PauliOperator.hpp"
 #include "xacc_observable.hpp"
 #include "AlgorithmGradientStrategy.hpp"
+#include "OperatorPool.hpp"
+#include "OperatorPoolCache.hpp"
 
 using namespace xacc;
 using namespace xacc::quantum;
 
 
-
 TEST(AdaptTesterVQE, checkAdaptVQE) {
 
   xacc::set_verbose(true);
@@ -76,6 +77,33 @@ TEST(AdaptTesterVQE, checkAdaptVQE) {
   EXPECT_NEAR(-1.13717, buffer_vqe->getInformation("opt-val").as<double>(), 1e-4);
 }
 
+TEST(AdaptTesterVQE, checkPoolCache) {
+
+  auto &cache = OperatorPoolCache::instance();
+  cache.clear();
+
+  // Pauli strings on up to 4 qubits with an odd number of Y's:
+  // sum_k C(4, k) (3^k - 1) / 2
+  auto pool = xacc::getService<OperatorPool>("qubit-pool");
+  auto operators = pool->generate(4);
+  EXPECT_EQ(120, operators.size());
+  EXPECT_EQ(1, cache.size());
+
+  // Same pool, not regenerated nor appended to
+  auto again = pool->generate(4);
+  EXPECT_EQ(operators.size(), again.size());
+  EXPECT_EQ(operators[0], again[0]);
+  EXPECT_EQ(1, cache.getHits());
+
+  auto sd = xacc::getService<OperatorPool>("singles-doubles-pool");
+  sd->optionalParameters({std::make_pair("n-electrons", 2)});
+  auto sdOperators = sd->generate(4);
+  // 2 singles and 1 double
+  EXPECT_EQ(3, sdOperators.size());
+  EXPECT_EQ(3, sd->generate(4).size());
+  EXPECT_EQ(2, cache.size());
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize(argc, argv);
   ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,158 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "SparsePauliHamiltonian.hpp"
+#include "PauliOperator.hpp"
+#include "xacc.hpp"
+#include <algorithm>
+#include <bitset>
+#include <map>
+
+namespace {
+int popcount(uint64_t in_word) { return std::bitset<64>(in_word).count(); }
+
+// All the in_nbBits-bit words with in_nbOnes bits set, in increasing order.
+std::vector<uint64_t> combinations(int in_nbBits, int in_nbOnes) {
+  std::vector<uint64_t> result;
+  if (in_nbOnes < 0 || in_nbOnes > in_nbBits) {
+    return result;
+  }
+  if (in_nbOnes == 0) {
+    return {0};
+  }
+  // Gosper's hack: next word with the same number of bits set
+  const uint64_t limit = 1ULL << in_nbBits;
+  for (uint64_t word = (1ULL << in_nbOnes) - 1; word < limit;) {
+    result.emplace_back(word);
+    const uint64_t lowest = word & -word;
+    const uint64_t ripple = word + lowest;
+    word = (((ripple ^ word) >> 2) / lowest) | ripple;
+  }
+  return result;
+}
+} // namespace
+
+namespace xacc {
+namespace algorithm {
+SparsePauliHamiltonian::SparsePauliHamiltonian(quantum::PauliOperator &in_op,
+                                               int in_nbQubits)
+    : m_nbQubits(in_nbQubits) {
+  if (in_nbQubits < 1 || in_nbQubits > 63) {
+    xacc::error("SparsePauliHamiltonian: invalid number of qubits " +
+                std::to_string(in_nbQubits) + ".");
+  }
+  const Amplitude iPowers[4] = {{1.0, 0.0}, {0.0, 1.0}, {-1.0, 0.0},
+                                {0.0, -1.0}};
+  std::map<uint64_t, StringGroup> groups;
+  for (auto &kv : in_op.getTerms()) {
+    auto term = kv.second;
+    if (!term.var().empty()) {
+      xacc::error("SparsePauliHamiltonian: variable coefficient '" +
+                  term.var() + "' is not supported.");
+    }
+    uint64_t x = 0, z = 0;
+    int nbYs = 0;
+    for (auto &[qubit, op] : term.ops()) {
+      if (qubit >= in_nbQubits) {
+        xacc::error("SparsePauliHamiltonian: qubit " + std::to_string(qubit) +
+                    " is out of range.");
+      }
+      if (op == "X" || op == "Y") {
+        x |= 1ULL << qubit;
+      }
+      if (op == "Z" || op == "Y") {
+        z |= 1ULL << qubit;
+      }
+      nbYs += op == "Y";
+    }
+    auto &group = groups[x];
+    group.x = x;
+    group.z.emplace_back(z);
+    group.coeffs.emplace_back(term.coeff() * iPowers[nbYs % 4]);
+  }
+  for (auto &kv : groups) {
+    m_groups.emplace_back(std::move(kv.second));
+  }
+}
+
+void SparsePauliHamiltonian::restrictToSector(int in_nbParticles) {
+  m_basis = combinations(m_nbQubits, in_nbParticles);
+  if (m_basis.empty()) {
+    xacc::error("SparsePauliHamiltonian: empty symmetry sector.");
+  }
+}
+
+void SparsePauliHamiltonian::restrictToSector(int in_nbParticles,
+                                              int in_twoSz) {
+  if (m_nbQubits % 2 != 0 || (in_nbParticles + in_twoSz) % 2 != 0) {
+    xacc::error("SparsePauliHamiltonian: invalid spin sector.");
+  }
+  const int nbOrbitals = m_nbQubits / 2;
+  const int nbAlpha = (in_nbParticles + in_twoSz) / 2;
+  const auto alphas = combinations(nbOrbitals, nbAlpha);
+  const auto betas = combinations(nbOrbitals, in_nbParticles - nbAlpha);
+  m_basis.clear();
+  m_basis.reserve(alphas.size() * betas.size());
+  // Beta (high bits) major: sorted
+  for (const auto beta : betas) {
+    for (const auto alpha : alphas) {
+      m_basis.emplace_back((beta << nbOrbitals) | alpha);
+    }
+  }
+  if (m_basis.empty()) {
+    xacc::error("SparsePauliHamiltonian: empty symmetry sector.");
+  }
+}
+
+size_t SparsePauliHamiltonian::dimension() const {
+  return m_basis.empty() ? (1ULL << m_nbQubits) : m_basis.size();
+}
+
+int64_t SparsePauliHamiltonian::index(uint64_t in_state) const {
+  if (m_basis.empty()) {
+    return in_state;
+  }
+  const auto iter = std::lower_bound(m_basis.begin(), m_basis.end(), in_state);
+  return (iter != m_basis.end() && *iter == in_state)
+             ? std::distance(m_basis.begin(), iter)
+             : -1;
+}
+
+void SparsePauliHamiltonian::apply(const std::vector<Amplitude> &in_vec,
+                                   std::vector<Amplitude> &out_vec) const {
+  out_vec.resize(dimension());
+  // <r|X^x Z^z|c> with c = r ^ x is (-1)^popcount(c & z)
+  const auto applyRows = [&](size_t beginIdx, size_t endIdx) {
+    for (size_t row = beginIdx; row < endIdx; ++row) {
+      const uint64_t rowState = m_basis.empty() ? row : m_basis[row];
+      Amplitude sum = 0.0;
+      for (const auto &group : m_groups) {
+        const uint64_t colState = rowState ^ group.x;
+        const auto col = index(colState);
+        if (col < 0) {
+          // Out of the sector (zero for a symmetric Hamiltonian)
+          continue;
+        }
+        Amplitude element = 0.0;
+        for (size_t k = 0; k < group.z.size(); ++k) {
+          element += (popcount(colState & group.z[k]) & 1) ? -group.coeffs[k]
+                                                           : group.coeffs[k];
+        }
+        sum += element * in_vec[col];
+      }
+      out_vec[row] = sum;
+    }
+  };
+  xacc::getTaskScheduler()->parallelFor(0, dimension(), applyRows);
+}
+} // namespace algorithm
+} // namespace xacc
@@ -0,0 +1,61 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#pragma once
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+namespace xacc {
+namespace quantum {
+class PauliOperator;
+}
+namespace algorithm {
+// Matrix-free action of a Pauli Hamiltonian on state vectors (bit q of a
+// basis state index is qubit q), optionally restricted to a symmetry sector.
+// Each Pauli string X^x Z^z maps |c> to a single basis state |c ^ x>, so the
+// strings are grouped by x and H v is gathered row by row (in parallel on
+// the task scheduler), without storing the matrix.
+class SparsePauliHamiltonian {
+public:
+  using Amplitude = std::complex<double>;
+  // At most 63 qubits, no variable coefficients.
+  SparsePauliHamiltonian(quantum::PauliOperator &in_op, int in_nbQubits);
+
+  // Only keep the basis states with in_nbParticles ones (Jordan-Wigner
+  // occupation), and (in_nbParticles + in_twoSz) / 2 of them in the first
+  // half of the qubits (the spin-up orbitals) if in_twoSz is given.
+  void restrictToSector(int in_nbParticles);
+  void restrictToSector(int in_nbParticles, int in_twoSz);
+
+  size_t dimension() const;
+  // out = H in (vectors of dimension())
+  void apply(const std::vector<Amplitude> &in_vec,
+             std::vector<Amplitude> &out_vec) const;
+
+private:
+  // Position of a basis state in the (sector) vectors, -1 if not in it.
+  int64_t index(uint64_t in_state) const;
+
+  struct StringGroup {
+    uint64_t x;
+    std::vector<uint64_t> z;
+    // Including the i factor of each Y (Y = i X Z)
+    std::vector<Amplitude> coeffs;
+  };
+  std::vector<StringGroup> m_groups;
+  int m_nbQubits;
+  // Sorted sector basis states, empty for the full space.
+  std::vector<uint64_t> m_basis;
+};
+} // namespace algorithm
+} // namespace xacc
@@ -0,0 +1,150 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "exact_diag.hpp"
+#include "SparsePauliHamiltonian.hpp"
+#include "ObservableTransform.hpp"
+#include "PauliOperator.hpp"
+#include "xacc.hpp"
+#include "xacc_service.hpp"
+#include <Eigen/Dense>
+#include <cmath>
+#include <random>
+
+namespace {
+using Amplitude = std::complex<double>;
+double norm(const std::vector<Amplitude> &in_vec) {
+  double sum = 0.0;
+  for (const auto &a : in_vec) {
+    sum += std::norm(a);
+  }
+  return std::sqrt(sum);
+}
+} // namespace
+
+namespace xacc {
+namespace algorithm {
+bool ExactDiagonalization::initialize(const HeterogeneousMap &parameters) {
+  if (!parameters.pointerLikeExists<Observable>("observable")) {
+    xacc::error("'observable' is required.");
+    return false;
+  }
+  auto observable = xacc::as_shared_ptr(
+      parameters.getPointerLike<Observable>("observable"));
+  if (!std::dynamic_pointer_cast<quantum::PauliOperator>(observable)) {
+    observable =
+        xacc::getService<ObservableTransform>("jw")->transform(observable);
+  }
+  m_observable = observable;
+  m_nbQubits = parameters.keyExists<int>("n-qubits")
+                   ? parameters.get<int>("n-qubits")
+                   : m_observable->nBits();
+  m_nbParticles = parameters.keyExists<int>("n-particles")
+                      ? parameters.get<int>("n-particles")
+                      : -1;
+  m_hasSz = parameters.keyExists<double>("sz");
+  if (m_hasSz) {
+    if (m_nbParticles < 0) {
+      xacc::error("'sz' requires 'n-particles'.");
+      return false;
+    }
+    m_twoSz = std::lround(2.0 * parameters.get<double>("sz"));
+  }
+  if (parameters.keyExists<int>("max-iterations")) {
+    m_maxIterations = parameters.get<int>("max-iterations");
+  }
+  if (parameters.keyExists<double>("tolerance")) {
+    m_tolerance = parameters.get<double>("tolerance");
+  }
+  return true;
+}
+
+const std::vector<std::string>
+ExactDiagonalization::requiredParameters() const {
+  return {"observable"};
+}
+
+void ExactDiagonalization::execute(
+    const std::shared_ptr<AcceleratorBuffer> buffer) const {
+  auto &pauli = dynamic_cast<quantum::PauliOperator &>(*m_observable);
+  SparsePauliHamiltonian H(pauli, m_nbQubits);
+  if (m_nbParticles >= 0 && m_hasSz) {
+    H.restrictToSector(m_nbParticles, m_twoSz);
+  } else if (m_nbParticles >= 0) {
+    H.restrictToSector(m_nbParticles);
+  }
+  const size_t dim = H.dimension();
+
+  // Lanczos recurrence, three vectors only: the lowest Ritz value converges
+  // without re-orthogonalization (loss of orthogonality only duplicates it).
+  std::vector<Amplitude> previous(dim, 0.0), current(dim), next;
+  std::mt19937_64 rng(0);
+  std::normal_distribution<double> dist;
+  for (auto &a : current) {
+    a = Amplitude(dist(rng), dist(rng));
+  }
+  const double initialNorm = norm(current);
+  for (auto &a : current) {
+    a /= initialNorm;
+  }
+
+  std::vector<double> alphas, betas, energies;
+  double beta = 0.0;
+  for (int iter = 0; iter < m_maxIterations && iter < (int)dim; ++iter) {
+    H.apply(current, next);
+    Amplitude alpha = 0.0;
+    for (size_t i = 0; i < dim; ++i) {
+      alpha += std::conj(current[i]) * next[i];
+    }
+    for (size_t i = 0; i < dim; ++i) {
+      next[i] -= alpha.real() * current[i] + beta * previous[i];
+    }
+    alphas.emplace_back(alpha.real());
+
+    Eigen::VectorXd diag = Eigen::Map<Eigen::VectorXd>(alphas.data(),
+                                                       alphas.size());
+    Eigen::VectorXd subDiag =
+        Eigen::Map<Eigen::VectorXd>(betas.data(), betas.size());
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver;
+    solver.computeFromTridiagonal(diag, subDiag, Eigen::EigenvaluesOnly);
+    energies.emplace_back(solver.eigenvalues()(0));
+
+    beta = norm(next);
+    const bool converged =
+        energies.size() > 1 &&
+        std::abs(energies.back() - energies[energies.size() - 2]) <
+            m_tolerance;
+    // Invariant subspace: the Ritz values are exact
+    if (converged || beta < 1e-12) {
+      break;
+    }
+    betas.emplace_back(beta);
+    for (size_t i = 0; i < dim; ++i) {
+      previous[i] = current[i];
+      current[i] = next[i] / beta;
+    }
+  }
+
+  buffer->addExtraInfo("opt-val", ExtraInfo(energies.back()));
+  buffer->addExtraInfo("exp-vals", ExtraInfo(energies));
+  buffer->addExtraInfo("sector-dimension", ExtraInfo((int)dim));
+}
+
+std::vector<double>
+ExactDiagonalization::execute(const std::shared_ptr<AcceleratorBuffer> buffer,
+                              const std::vector<double> &x) {
+  // Nothing to parameterize
+  xacc::error("This method is unsupported!");
+  return {};
+}
+} // namespace algorithm
+} // namespace xacc
@@ -0,0 +1,54 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#pragma once
+
+#include "Algorithm.hpp"
+
+namespace xacc {
+namespace algorithm {
+// Reference ground-state energy of an observable by sparse (matrix-free)
+// Lanczos iterations, i.e. beyond the reach of dense diagonalization.
+// Parameters:
+//  - "observable": Pauli, or fermion (Jordan-Wigner transformed) observable.
+//  - "n-qubits" (int): defaults to the observable qubits.
+//  - "n-particles" (int): restrict to this particle number (Jordan-Wigner
+//    occupation), and optionally "sz" (double) with the spin-up orbitals on
+//    the first half of the qubits.
+//  - "max-iterations" (int, default 500), "tolerance" (double, default
+//    1e-10): convergence of the lowest Ritz value.
+// Results: "opt-val" (energy), "exp-vals" (energy at each iteration) and
+// "sector-dimension".
+class ExactDiagonalization : public Algorithm {
+public:
+  bool initialize(const HeterogeneousMap &parameters) override;
+  const std::vector<std::string> requiredParameters() const override;
+  void execute(const std::shared_ptr<AcceleratorBuffer> buffer) const override;
+  std::vector<double> execute(const std::shared_ptr<AcceleratorBuffer> buffer,
+                              const std::vector<double> &parameters) override;
+  const std::string name() const override { return "exact-diag"; }
+  const std::string description() const override {
+    return "Sparse Lanczos ground-state energy of an observable.";
+  }
+  DEFINE_ALGORITHM_CLONE(ExactDiagonalization)
+
+private:
+  std::shared_ptr<Observable> m_observable;
+  int m_nbQubits = -1;
+  int m_nbParticles = -1;
+  bool m_hasSz = false;
+  int m_twoSz = 0;
+  int m_maxIterations = 500;
+  double m_tolerance = 1e-10;
+};
+} // namespace algorithm
+} // namespace xacc
@@ -0,0 +1,105 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include <gtest/gtest.h>
+
+#include "xacc.hpp"
+#include "xacc_observable.hpp"
+#include "xacc_service.hpp"
+#include "Algorithm.hpp"
+#include "ObservableTransform.hpp"
+#include "PauliOperator.hpp"
+#include <Eigen/Dense>
+
+namespace {
+double denseGroundStateEnergy(xacc::quantum::PauliOperator &op, int n) {
+  auto data = op.toDenseMatrix(n);
+  Eigen::MatrixXcd m = Eigen::Map<Eigen::MatrixXcd>(data.data(), 1 << n, 1 << n);
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXcd> solver(m);
+  return solver.eigenvalues()(0);
+}
+} // namespace
+
+TEST(ExactDiagTester, checkHeisenbergChain) {
+  // Random couplings, open chain
+  std::stringstream ss;
+  for (int i = 0; i < 7; i++) {
+    for (const std::string op : {"X", "Y", "Z"}) {
+      ss << (ss.str().empty() ? "" : " + ") << 0.3 + 0.1 * ((3 * i + op[0]) % 5)
+         << " " << op << i << " " << op << i + 1;
+    }
+    ss << " + " << 0.05 * i << " Z" << i;
+  }
+  auto H = std::make_shared<xacc::quantum::PauliOperator>(ss.str());
+
+  auto exactDiag = xacc::getAlgorithm("exact-diag", {std::make_pair("observable", H)});
+  auto buffer = xacc::qalloc(8);
+  exactDiag->execute(buffer);
+  EXPECT_NEAR(denseGroundStateEnergy(*H, 8), (*buffer)["opt-val"].as<double>(),
+              1e-6);
+  EXPECT_EQ(256, (*buffer)["sector-dimension"].as<int>());
+}
+
+TEST(ExactDiagTester, checkParticleSector) {
+  // Hopping on 3 orbitals (x 2 spins), plus an on-site repulsion
+  auto H = xacc::quantum::getObservable(
+      "fermion",
+      std::string("-1.0 0^ 1 + -1.0 1^ 0 + -1.0 1^ 2 + -1.0 2^ 1 + -1.0 3^ 4 + -1.0 4^ 3 "
+      "+ -1.0 4^ 5 + -1.0 5^ 4 + 2.0 0^ 3^ 3 0 + 2.0 1^ 4^ 4 1 + 2.0 2^ 5^ 5 2"));
+
+  // Two electrons, singlet-like sector: 3 x 3 states
+  auto exactDiag = xacc::getAlgorithm(
+      "exact-diag",
+      {std::make_pair("observable", H), std::make_pair("n-particles", 2),
+       std::make_pair("sz", 0.0)});
+  auto buffer = xacc::qalloc(6);
+  exactDiag->execute(buffer);
+  EXPECT_EQ(9, (*buffer)["sector-dimension"].as<int>());
+  const double sectorEnergy = (*buffer)["opt-val"].as<double>();
+
+  // The full space contains the sector
+  auto full = xacc::getAlgorithm("exact-diag", {std::make_pair("observable", H)});
+  auto fullBuffer = xacc::qalloc(6);
+  full->execute(fullBuffer);
+  EXPECT_LT((*fullBuffer)["opt-val"].as<double>(), sectorEnergy + 1e-9);
+
+  // Dense reference, restricted to the sector
+  auto pauli = std::dynamic_pointer_cast<xacc::quantum::PauliOperator>(
+      xacc::getService<xacc::ObservableTransform>("jw")->transform(H));
+  auto data = pauli->toDenseMatrix(6);
+  Eigen::MatrixXcd m = Eigen::Map<Eigen::MatrixXcd>(data.data(), 64, 64);
+  std::vector<int> states;
+  for (int s = 0; s < 64; s++) {
+    // toDenseMatrix: qubit 0 is the most significant bit
+    const int alpha = ((s >> 5) & 1) + ((s >> 4) & 1) + ((s >> 3) & 1);
+    const int beta = ((s >> 2) & 1) + ((s >> 1) & 1) + (s & 1);
+    if (alpha == 1 && beta == 1) {
+      states.emplace_back(s);
+    }
+  }
+  Eigen::MatrixXcd sector(states.size(), states.size());
+  for (size_t i = 0; i < states.size(); i++) {
+    for (size_t j = 0; j < states.size(); j++) {
+      sector(i, j) = m(states[i], states[j]);
+    }
+  }
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXcd> solver(sector);
+  EXPECT_NEAR(solver.eigenvalues()(0), sectorEnergy, 1e-8);
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize(argc, argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
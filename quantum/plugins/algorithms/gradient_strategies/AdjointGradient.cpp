@@ -0,0 +1,460 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#include "AdjointGradient.hpp"
+#include "FermionOperator.hpp"
+#include "InstructionIterator.hpp"
+#include "ObservableTransform.hpp"
+#include "xacc.hpp"
+#include "xacc_service.hpp"
+#include <cassert>
+#include <iomanip>
+
+namespace {
+using namespace xacc;
+using StateVec = std::vector<std::complex<double>>;
+// Row-major 2x2 or 4x4 gate matrix
+using GateMat = std::vector<std::complex<double>>;
+constexpr std::complex<double> I{0.0, 1.0};
+
+struct GateOp {
+  std::vector<size_t> qubits;
+  GateMat mat;
+  // d(mat)/d(angle) for each gate parameter
+  std::vector<GateMat> dMats;
+};
+
+// Controlled version of a single-qubit gate matrix
+// (the derivative of a controlled gate has a zero control-0 block).
+GateMat controlled(const GateMat &in_mat, bool in_isDerivative = false) {
+  const std::complex<double> one = in_isDerivative ? 0.0 : 1.0;
+  return {one, 0.0, 0.0,       0.0,       0.0,       one,
+          0.0, 0.0, 0.0,       0.0,       in_mat[0], in_mat[1],
+          0.0, 0.0, in_mat[2], in_mat[3]};
+}
+
+GateOp toGateOp(const InstPtr &in_inst) {
+  GateOp op;
+  op.qubits = in_inst->bits();
+  std::vector<double> angles;
+  for (const auto &param : in_inst->getParameters()) {
+    if (param.isVariable()) {
+      // Must be an evaluated (numeric) circuit.
+      const auto val = param.as<std::string>();
+      char *end = nullptr;
+      std::strtod(val.c_str(), &end);
+      if (end == val.c_str() || *end != '\0') {
+        xacc::error("Adjoint gradient: unresolved parameter '" + val +
+                    "' in " + in_inst->name() + ".");
+      }
+    }
+    angles.emplace_back(InstructionParameterToDouble(param));
+  }
+
+  const auto name = in_inst->name();
+  const double c = angles.empty() ? 0.0 : std::cos(angles[0] / 2.0);
+  const double s = angles.empty() ? 0.0 : std::sin(angles[0] / 2.0);
+  if (name == "H") {
+    const double h = 1.0 / std::sqrt(2.0);
+    op.mat = {h, h, h, -h};
+  } else if (name == "X") {
+    op.mat = {0.0, 1.0, 1.0, 0.0};
+  } else if (name == "Y") {
+    op.mat = {0.0, -I, I, 0.0};
+  } else if (name == "Z") {
+    op.mat = {1.0, 0.0, 0.0, -1.0};
+  } else if (name == "S") {
+    op.mat = {1.0, 0.0, 0.0, I};
+  } else if (name == "Sdg") {
+    op.mat = {1.0, 0.0, 0.0, -I};
+  } else if (name == "T") {
+    op.mat = {1.0, 0.0, 0.0, std::exp(I * M_PI / 4.0)};
+  } else if (name == "Tdg") {
+    op.mat = {1.0, 0.0, 0.0, std::exp(-I * M_PI / 4.0)};
+  } else if (name == "I") {
+    op.mat = {1.0, 0.0, 0.0, 1.0};
+  } else if (name == "Rx") {
+    op.mat = {c, -I * s, -I * s, c};
+    op.dMats = {{-s / 2.0, -I * c / 2.0, -I * c / 2.0, -s / 2.0}};
+  } else if (name == "Ry") {
+    op.mat = {c, -s, s, c};
+    op.dMats = {{-s / 2.0, -c / 2.0, c / 2.0, -s / 2.0}};
+  } else if (name == "Rz") {
+    const auto m = std::exp(-I * angles[0] / 2.0);
+    const auto p = std::exp(I * angles[0] / 2.0);
+    op.mat = {m, 0.0, 0.0, p};
+    op.dMats = {{-I / 2.0 * m, 0.0, 0.0, I / 2.0 * p}};
+  } else if (name == "U") {
+    const auto eP = std::exp(I * angles[1]);
+    const auto eL = std::exp(I * angles[2]);
+    op.mat = {c, -eL * s, eP * s, eP * eL * c};
+    op.dMats = {{-s / 2.0, -eL * c / 2.0, eP * c / 2.0, -eP * eL * s / 2.0},
+                {0.0, 0.0, I * eP * s, I * eP * eL * c},
+                {0.0, -I * eL * s, 0.0, I * eP * eL * c}};
+  } else if (name == "CNOT") {
+    op.mat = controlled({0.0, 1.0, 1.0, 0.0});
+  } else if (name == "CY") {
+    op.mat = controlled({0.0, -I, I, 0.0});
+  } else if (name == "CZ") {
+    op.mat = controlled({1.0, 0.0, 0.0, -1.0});
+  } else if (name == "CH") {
+    const double h = 1.0 / std::sqrt(2.0);
+    op.mat = controlled({h, h, h, -h});
+  } else if (name == "Swap") {
+    op.mat = {1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0,
+              0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0};
+  } else if (name == "iSwap") {
+    op.mat = {1.0, 0.0, 0.0, 0.0, 0.0, 0.0, I,   0.0,
+              0.0, I,   0.0, 0.0, 0.0, 0.0, 0.0, 1.0};
+  } else if (name == "CRZ") {
+    const auto m = std::exp(-I * angles[0] / 2.0);
+    const auto p = std::exp(I * angles[0] / 2.0);
+    op.mat = controlled({m, 0.0, 0.0, p});
+    op.dMats = {controlled({-I / 2.0 * m, 0.0, 0.0, I / 2.0 * p}, true)};
+  } else if (name == "CPhase") {
+    const auto p = std::exp(I * angles[0]);
+    op.mat = controlled({1.0, 0.0, 0.0, p});
+    op.dMats = {controlled({0.0, 0.0, 0.0, I * p}, true)};
+  } else if (name == "fSim") {
+    const double ct = std::cos(angles[0]);
+    const double st = std::sin(angles[0]);
+    const auto eP = std::exp(-I * angles[1]);
+    op.mat = {1.0, 0.0,      0.0,      0.0, 0.0, ct,  -I * st, 0.0,
+              0.0, -I * st,  ct,       0.0, 0.0, 0.0, 0.0,     eP};
+    op.dMats = {{0.0, 0.0,     0.0, 0.0, 0.0, -st, -I * ct, 0.0,
+                 0.0, -I * ct, -st, 0.0, 0.0, 0.0, 0.0,     0.0},
+                {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
+                 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, -I * eP}};
+  } else {
+    xacc::error("Adjoint gradient: unsupported instruction '" + name + "'.");
+  }
+
+  if (!op.dMats.empty() && op.dMats.size() != angles.size()) {
+    xacc::error("Adjoint gradient: invalid parameters for '" + name + "'.");
+  }
+  return op;
+}
+
+// Unitary (non-measure) instructions of an evaluated circuit
+std::vector<InstPtr>
+flattenCircuit(const std::shared_ptr<CompositeInstruction> &in_circuit) {
+  std::vector<InstPtr> result;
+  InstructionIterator it(in_circuit);
+  while (it.hasNext()) {
+    auto nextInst = it.next();
+    if (nextInst->isEnabled() && !nextInst->isComposite() &&
+        nextInst->opcode() != xacc::GateOpcode::Measure) {
+      result.emplace_back(nextInst);
+    }
+  }
+  return result;
+}
+
+// Applies a gate matrix (or its adjoint) on the given qubits,
+// qubit q is bit q of the state index.
+void applyMat(StateVec &io_state, const std::vector<size_t> &in_qubits,
+              const GateMat &in_mat, bool in_adjoint) {
+  const size_t dim = 1ULL << in_qubits.size();
+  const auto elem = [&](size_t row, size_t col) {
+    return in_adjoint ? std::conj(in_mat[col * dim + row])
+                      : in_mat[row * dim + col];
+  };
+
+  if (in_qubits.size() == 1) {
+    const size_t mask = 1ULL << in_qubits[0];
+    for (size_t i = 0; i < io_state.size(); ++i) {
+      if (i & mask) {
+        continue;
+      }
+      const auto a = io_state[i];
+      const auto b = io_state[i | mask];
+      io_state[i] = elem(0, 0) * a + elem(0, 1) * b;
+      io_state[i | mask] = elem(1, 0) * a + elem(1, 1) * b;
+    }
+  } else {
+    assert(in_qubits.size() == 2);
+    // Local index is 2 * bit(qubits[0]) + bit(qubits[1])
+    const size_t mask0 = 1ULL << in_qubits[0];
+    const size_t mask1 = 1ULL << in_qubits[1];
+    for (size_t i = 0; i < io_state.size(); ++i) {
+      if ((i & mask0) || (i & mask1)) {
+        continue;
+      }
+      const size_t idx[4] = {i, i | mask1, i | mask0, i | mask0 | mask1};
+      std::complex<double> in[4];
+      for (size_t k = 0; k < 4; ++k) {
+        in[k] = io_state[idx[k]];
+      }
+      for (size_t row = 0; row < 4; ++row) {
+        std::complex<double> val = 0.0;
+        for (size_t col = 0; col < 4; ++col) {
+          val += elem(row, col) * in[col];
+        }
+        io_state[idx[row]] = val;
+      }
+    }
+  }
+}
+
+StateVec applyObservable(xacc::quantum::PauliOperator &in_obs,
+                         const StateVec &in_state) {
+  StateVec result(in_state.size(), 0.0);
+  for (auto &[termName, term] : in_obs) {
+    size_t xMask = 0, zMask = 0;
+    int nbY = 0;
+    for (const auto &[qubit, pauli] : term.ops()) {
+      if (pauli == "X" || pauli == "Y") {
+        xMask |= 1ULL << qubit;
+      }
+      if (pauli == "Z" || pauli == "Y") {
+        zMask |= 1ULL << qubit;
+      }
+      if (pauli == "Y") {
+        nbY++;
+      }
+    }
+    // Y = i * X * Z (acting on |b>: i * (-1)^b |1-b>)
+    auto coeff = term.coeff();
+    for (int k = 0; k < nbY; ++k) {
+      coeff *= I;
+    }
+    for (size_t i = 0; i < in_state.size(); ++i) {
+      const bool odd = __builtin_popcountll(i & zMask) & 1;
+      result[i ^ xMask] += (odd ? -coeff : coeff) * in_state[i];
+    }
+  }
+  return result;
+}
+
+// The gates of the circuit evaluated at x and, for each gate and angle, the
+// (x index, d(angle)/dx) pairs.
+struct DifferentiatedCircuit {
+  std::vector<GateOp> ops;
+  std::vector<std::vector<std::vector<std::pair<size_t, double>>>> angleGrads;
+  int nbQubits = 0;
+};
+
+DifferentiatedCircuit
+differentiate(const std::function<std::shared_ptr<CompositeInstruction>(
+                  const std::vector<double> &)> &evaluator,
+              const std::vector<double> &x, int minQubits) {
+  DifferentiatedCircuit result;
+  const auto gates = flattenCircuit(evaluator(x));
+  auto &ops = result.ops;
+  int nbQubits = minQubits;
+  for (const auto &gate : gates) {
+    ops.emplace_back(toGateOp(gate));
+    for (const auto &bit : gate->bits()) {
+      nbQubits = std::max(nbQubits, static_cast<int>(bit) + 1);
+    }
+  }
+  result.nbQubits = nbQubits;
+
+  // d(gate angle)/dx, by central differences of the evaluated angles
+  // (exact for the usual linear angle expressions).
+  auto &angleGrads = result.angleGrads;
+  angleGrads.resize(ops.size());
+  for (size_t g = 0; g < ops.size(); ++g) {
+    angleGrads[g].resize(ops[g].dMats.size());
+  }
+  const double step = 1e-4;
+  for (size_t k = 0; k < x.size(); ++k) {
+    auto xPlus = x;
+    auto xMinus = x;
+    xPlus[k] += step;
+    xMinus[k] -= step;
+    const auto gatesPlus = flattenCircuit(evaluator(xPlus));
+    const auto gatesMinus = flattenCircuit(evaluator(xMinus));
+    if (gatesPlus.size() != gates.size() || gatesMinus.size() != gates.size()) {
+      xacc::error("Adjoint gradient: circuit structure must not depend on "
+                  "the parameters.");
+    }
+    for (size_t g = 0; g < ops.size(); ++g) {
+      for (size_t j = 0; j < ops[g].dMats.size(); ++j) {
+        const double dAngle =
+            (InstructionParameterToDouble(gatesPlus[g]->getParameter(j)) -
+             InstructionParameterToDouble(gatesMinus[g]->getParameter(j))) /
+            (2.0 * step);
+        if (dAngle != 0.0) {
+          angleGrads[g][j].emplace_back(k, dAngle);
+        }
+      }
+    }
+  }
+  return result;
+}
+
+std::complex<double> innerProduct(const StateVec &in_bra,
+                                  const StateVec &in_ket) {
+  std::complex<double> result = 0.0;
+  for (size_t i = 0; i < in_bra.size(); ++i) {
+    result += std::conj(in_bra[i]) * in_ket[i];
+  }
+  return result;
+}
+} // namespace
+
+namespace xacc {
+namespace algorithm {
+bool AdjointGradient::initialize(const HeterogeneousMap parameters) {
+  if (!parameters.pointerLikeExists<Observable>("observable")) {
+    xacc::error("Gradient strategy needs observable");
+    return false;
+  }
+  auto obs =
+      xacc::as_shared_ptr(parameters.getPointerLike<Observable>("observable"));
+  if (std::dynamic_pointer_cast<xacc::quantum::FermionOperator>(obs)) {
+    obs = xacc::getService<ObservableTransform>("jw")->transform(obs);
+  }
+  m_observable = std::dynamic_pointer_cast<xacc::quantum::PauliOperator>(obs);
+  if (!m_observable) {
+    xacc::error("Adjoint gradient requires a Pauli (or Fermion) observable.");
+    return false;
+  }
+
+  kernel_evaluator = nullptr;
+  if (parameters.keyExists<std::function<std::shared_ptr<CompositeInstruction>(
+          std::vector<double>)>>("kernel-evaluator")) {
+    kernel_evaluator =
+        parameters.get<std::function<std::shared_ptr<CompositeInstruction>(
+            std::vector<double>)>>("kernel-evaluator");
+  }
+  return true;
+}
+
+std::vector<double> AdjointGradient::computeDerivative(
+    const std::function<std::shared_ptr<CompositeInstruction>(
+        const std::vector<double> &)> &evaluator,
+    xacc::quantum::PauliOperator &observable, const std::vector<double> &x,
+    double *optional_out_fn_val) {
+  const auto circuit = differentiate(evaluator, x, observable.nBits());
+  const auto &ops = circuit.ops;
+  const auto &angleGrads = circuit.angleGrads;
+  const int nbQubits = circuit.nbQubits;
+
+  // Forward sweep
+  StateVec phi(1ULL << nbQubits, 0.0);
+  phi[0] = 1.0;
+  for (const auto &op : ops) {
+    applyMat(phi, op.qubits, op.mat, false);
+  }
+  auto lambda = applyObservable(observable, phi);
+  if (optional_out_fn_val) {
+    std::complex<double> expVal = 0.0;
+    for (size_t i = 0; i < phi.size(); ++i) {
+      expVal += std::conj(phi[i]) * lambda[i];
+    }
+    *optional_out_fn_val = expVal.real();
+  }
+
+  // Backward sweep: dE/dtheta = 2 Re <lambda| dU phi>
+  std::vector<double> gradients(x.size(), 0.0);
+  for (int g = ops.size() - 1; g >= 0; --g) {
+    applyMat(phi, ops[g].qubits, ops[g].mat, true);
+    for (size_t j = 0; j < ops[g].dMats.size(); ++j) {
+      if (angleGrads[g][j].empty()) {
+        continue;
+      }
+      auto mu = phi;
+      applyMat(mu, ops[g].qubits, ops[g].dMats[j], false);
+      std::complex<double> overlap = 0.0;
+      for (size_t i = 0; i < mu.size(); ++i) {
+        overlap += std::conj(lambda[i]) * mu[i];
+      }
+      for (const auto &[k, dAngle] : angleGrads[g][j]) {
+        gradients[k] += 2.0 * overlap.real() * dAngle;
+      }
+    }
+    applyMat(lambda, ops[g].qubits, ops[g].mat, true);
+  }
+
+  return gradients;
+}
+
+std::vector<double> AdjointGradient::computeMetricTensor(
+    const std::function<std::shared_ptr<CompositeInstruction>(
+        const std::vector<double> &)> &evaluator,
+    const std::vector<double> &x, int nbQubits) {
+  const auto circuit = differentiate(evaluator, x, nbQubits);
+  const auto &ops = circuit.ops;
+  const auto &angleGrads = circuit.angleGrads;
+  const size_t dim = 1ULL << circuit.nbQubits;
+
+  // d|psi>/dx_k: the derivative of each gate, applied to the state before
+  // it, is propagated through the rest of the circuit.
+  StateVec phi(dim, 0.0);
+  phi[0] = 1.0;
+  std::vector<StateVec> dPsi(x.size(), StateVec(dim, 0.0));
+  for (size_t g = 0; g < ops.size(); ++g) {
+    for (auto &dPsiK : dPsi) {
+      applyMat(dPsiK, ops[g].qubits, ops[g].mat, false);
+    }
+    for (size_t j = 0; j < ops[g].dMats.size(); ++j) {
+      if (angleGrads[g][j].empty()) {
+        continue;
+      }
+      auto mu = phi;
+      applyMat(mu, ops[g].qubits, ops[g].dMats[j], false);
+      for (const auto &[k, dAngle] : angleGrads[g][j]) {
+        for (size_t i = 0; i < dim; ++i) {
+          dPsi[k][i] += dAngle * mu[i];
+        }
+      }
+    }
+    applyMat(phi, ops[g].qubits, ops[g].mat, false);
+  }
+
+  // g_kl = Re(<d_k psi|d_l psi> - <d_k psi|psi><psi|d_l psi>)
+  const size_t nbParams = x.size();
+  std::vector<std::complex<double>> overlaps(nbParams);
+  for (size_t k = 0; k < nbParams; ++k) {
+    overlaps[k] = innerProduct(phi, dPsi[k]);
+  }
+  std::vector<double> metric(nbParams * nbParams, 0.0);
+  for (size_t k = 0; k < nbParams; ++k) {
+    for (size_t l = k; l < nbParams; ++l) {
+      const double val = (innerProduct(dPsi[k], dPsi[l]) -
+                          std::conj(overlaps[k]) * overlaps[l])
+                             .real();
+      metric[k * nbParams + l] = val;
+      metric[l * nbParams + k] = val;
+    }
+  }
+  return metric;
+}
+
+void AdjointGradient::compute(
+    std::vector<double> &dx,
+    std::vector<std::shared_ptr<AcceleratorBuffer>> results) {
+  // The list must be empty, i.e. no remote evaluation.
+  assert(results.empty());
+  const auto evaluator = [&](const std::vector<double> &x) {
+    if (kernel_evaluator) {
+      return kernel_evaluator(x);
+    }
+    return m_varKernel->getVariables().empty() ? m_varKernel
+                                               : m_varKernel->operator()(x);
+  };
+  dx = computeDerivative(evaluator, *m_observable, m_currentParams);
+
+  std::stringstream ss;
+  ss << std::setprecision(5) << "Computed gradient: ";
+  for (auto param : dx) {
+    ss << param << " ";
+  }
+  xacc::info(ss.str());
+
+  m_varKernel.reset();
+  m_currentParams.clear();
+}
+} // namespace algorithm
+} // namespace xacc
@@ -0,0 +1,83 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_ADJOINT_GRADIENT_HPP_
+#define XACC_ADJOINT_GRADIENT_HPP_
+
+#include "AlgorithmGradientStrategy.hpp"
+#include "CompositeInstruction.hpp"
+#include "PauliOperator.hpp"
+#include <complex>
+#include <functional>
+
+namespace xacc {
+namespace algorithm {
+
+// Adjoint-method gradient: computes all partial derivatives of <H> with one
+// forward and one backward state-vector sweep over the circuit (no circuit
+// executions on the Accelerator), i.e. about 3 simulations regardless of
+// the number of parameters.
+// Like autodiff, the state-vector simulation is done locally.
+class AdjointGradient : public AlgorithmGradientStrategy {
+public:
+  bool initialize(const HeterogeneousMap parameters) override;
+
+  // The gradient is evaluated locally, we don't need <H(x)>,
+  // just make sure the optimization loop does not require circuits.
+  bool isNumerical() const override { return true; }
+  void setFunctionValue(const double expValue) override {}
+
+  // Returns an empty vector -> no circuits will be appended.
+  std::vector<std::shared_ptr<CompositeInstruction>>
+  getGradientExecutions(std::shared_ptr<CompositeInstruction> circuit,
+                        const std::vector<double> &x) override {
+    m_varKernel = circuit;
+    m_currentParams = x;
+    return {};
+  }
+
+  void
+  compute(std::vector<double> &dx,
+          std::vector<std::shared_ptr<AcceleratorBuffer>> results) override;
+
+  // Derivatives of <observable> w.r.t. x for the circuit evaluated by
+  // evaluator (optionally also returns <observable> at x).
+  static std::vector<double> computeDerivative(
+      const std::function<std::shared_ptr<CompositeInstruction>(
+          const std::vector<double> &)> &evaluator,
+      xacc::quantum::PauliOperator &observable, const std::vector<double> &x,
+      double *optional_out_fn_val = nullptr);
+
+  // Fubini-Study metric tensor (row-major, x.size() x x.size()) of the state
+  // prepared by the circuit evaluated by evaluator, from one forward sweep.
+  static std::vector<double> computeMetricTensor(
+      const std::function<std::shared_ptr<CompositeInstruction>(
+          const std::vector<double> &)> &evaluator,
+      const std::vector<double> &x, int nbQubits = 0);
+
+  const std::string name() const override { return "adjoint"; }
+  const std::string description() const override {
+    return "Adjoint-method (reverse-mode) state-vector gradient.";
+  }
+
+private:
+  std::shared_ptr<xacc::quantum::PauliOperator> m_observable;
+  std::shared_ptr<CompositeInstruction> m_varKernel;
+  std::vector<double> m_currentParams;
+  // Support for QCOR kernel evaluator
+  std::function<std::shared_ptr<CompositeInstruction>(std::vector<double>)>
+      kernel_evaluator;
+};
+
+} // namespace algorithm
+} // namespace xacc
+#endif
@@ -17,7 +17,9 @@
 #include "xacc.hpp"
 #include "xacc_service.hpp"
 #include "AlgorithmGradientStrategy.hpp"
+#include "LightCone.hpp"
 #include <iomanip>
+#include <random>
 
 using namespace xacc;
 
@@ -32,6 +34,14 @@ protected:
   double obsExpValue;              // <H> expectation value of the observable
   std::function<std::shared_ptr<CompositeInstruction>(std::vector<double>)>
       kernel_evaluator;
+  // Only observe the terms in the light cone of the shifted gates,
+  // the others cancel out.
+  bool lightCone = false;
+  // Simultaneous perturbation (SPSA) estimate from this many random +/-1
+  // directions (2 circuit sets each) instead of the 2 x P shifts.
+  int spsaSamples = 0;
+  std::mt19937 rng{std::random_device()()};
+  std::vector<std::vector<double>> perturbations;
 
 public:
   // Set this to true to get energy, but see comment on passObsExpValue below
@@ -56,6 +66,15 @@ public:
     if (parameters.keyExists<double>("step")) {
       step = parameters.get<double>("step");
     }
+    if (parameters.keyExists<bool>("light-cone")) {
+      lightCone = parameters.get<bool>("light-cone");
+    }
+    if (parameters.keyExists<int>("spsa-samples")) {
+      spsaSamples = parameters.get<int>("spsa-samples");
+    }
+    if (parameters.keyExists<int>("seed")) {
+      rng.seed(parameters.get<int>("seed"));
+    }
 
     if (parameters.keyExists<std::function<
             std::shared_ptr<CompositeInstruction>(std::vector<double>)>>(
@@ -74,36 +93,49 @@ public:
                         const std::vector<double> &x) override {
 
     std::vector<std::shared_ptr<CompositeInstruction>> gradientInstructions;
-    for (int op = 0; op < x.size(); op++) { // loop over operators
-      for (double sign : {1.0, -1.0}) {     // change sign
+    // Each element of the gradient (or SPSA sample) is shifted along
+    // a direction
+    std::vector<std::vector<double>> directions;
+    perturbations.clear();
+    if (spsaSamples > 0) {
+      std::bernoulli_distribution coin;
+      for (int sample = 0; sample < spsaSamples; sample++) {
+        std::vector<double> delta(x.size());
+        for (auto &d : delta) {
+          d = coin(rng) ? 1.0 : -1.0;
+        }
+        perturbations.push_back(delta);
+      }
+      directions = perturbations;
+    } else {
+      for (int op = 0; op < x.size(); op++) { // loop over operators
+        std::vector<double> direction(x.size(), 0.0);
+        direction[op] = 1.0;
+        directions.push_back(direction);
+      }
+    }
+
+    for (auto &direction : directions) {
+      for (double sign : {1.0, -1.0}) { // change sign
 
-        // shift the parameter by step and observe
+        // shift the parameters by step and observe
         auto tmpX = x;
-        tmpX[op] += sign * step;
-
-        std::vector<std::shared_ptr<CompositeInstruction>> kernels;
-        if (kernel_evaluator) {
-          auto evaled_base = kernel_evaluator(tmpX);
-          kernels = obs->observe(evaled_base);
-          for (auto &f : kernels) {
-            coefficients.push_back(std::real(f->getCoefficient()));
-            gradientInstructions.push_back(f);
-          }
-        } else {
-          kernels = obs->observe(circuit);
-
-          // loop over circuit instructions
-          // and gather coefficients/instructions
-          for (auto &f : kernels) {
-            auto evaled = f->operator()(tmpX);
-            coefficients.push_back(std::real(f->getCoefficient()));
-            gradientInstructions.push_back(evaled);
-          }
+        for (int op = 0; op < x.size(); op++) {
+          tmpX[op] += sign * step * direction[op];
         }
+
+        auto shifted = observeShifted(obs, circuit, kernel_evaluator, x, tmpX,
+                                      lightCone);
+        coefficients.insert(coefficients.end(), shifted.coefficients.begin(),
+                            shifted.coefficients.end());
+        gradientInstructions.insert(gradientInstructions.end(),
+                                    shifted.kernels.begin(),
+                                    shifted.kernels.end());
         // the number of instructions for a given element of x is the same
-        // regardless of the parameter sign, so we need only one of this
+        // regardless of the parameter sign (same light cone), so we need
+        // only one of this
         if (sign == 1.0) {
-          nInstructionsElement.push_back(kernels.size());
+          nInstructionsElement.push_back(shifted.kernels.size());
         }
       }
     }
@@ -117,8 +149,12 @@ public:
           std::vector<std::shared_ptr<AcceleratorBuffer>> results) override {
 
     int shift = 0;
-    // loop over the terms in the gradient vector
-    for (int gradTerm = 0; gradTerm < dx.size(); gradTerm++) {
+    if (!perturbations.empty()) {
+      std::fill(dx.begin(), dx.end(), 0.0);
+    }
+    // loop over the terms in the gradient vector (or SPSA samples)
+    for (int gradTerm = 0; gradTerm < nInstructionsElement.size();
+         gradTerm++) {
 
       double plusGradElement = 0.0;  // <+>
       double minusGradElement = 0.0; // <->
@@ -139,13 +175,22 @@ public:
       }
 
       // gradient is (<+> - <->) / 2 *step
-      dx[gradTerm] =
+      const double slope =
           std::real(plusGradElement - minusGradElement) / (2.0 * step);
+      if (perturbations.empty()) {
+        dx[gradTerm] = slope;
+      } else {
+        // Average of the slope along each direction (1 / delta = delta)
+        for (int op = 0; op < dx.size(); op++) {
+          dx[op] += slope * perturbations[gradTerm][op] / perturbations.size();
+        }
+      }
       shift += 2 * nInstructionsElement[gradTerm];
     }
 
     coefficients.clear();
     nInstructionsElement.clear();
+    perturbations.clear();
     std::stringstream ss;
     ss << std::setprecision(5) << "Computed gradient: ";
     for (auto param : dx) {
@@ -17,6 +17,7 @@
 #include "xacc.hpp"
 #include "xacc_service.hpp"
 #include "AlgorithmGradientStrategy.hpp"
+#include "LightCone.hpp"
 #include <iomanip>
 
 using namespace xacc;
@@ -32,6 +33,11 @@ protected:
   double obsExpValue;              // <H> expectation value of the observable
   std::function<std::shared_ptr<CompositeInstruction>(std::vector<double>)>
       kernel_evaluator;
+  // Only observe the terms in the light cone of the shifted gates,
+  // the others keep their base point value.
+  bool lightCone = false;
+  std::vector<std::string> termIds; // term observed by each instruction
+  std::unordered_map<std::string, double> baseExpValues; // <P> at x
 
 public:
   // this is a numerical gradient
@@ -43,6 +49,11 @@ public:
     return;
   }
 
+  void setBaseResults(const std::vector<std::shared_ptr<AcceleratorBuffer>>
+                          &baseResults) override {
+    baseExpValues = termExpectations(baseResults);
+  }
+
   bool initialize(const HeterogeneousMap parameters) override {
 
     if (!parameters.keyExists<std::shared_ptr<Observable>>("observable")) {
@@ -56,6 +67,9 @@ public:
     if (parameters.keyExists<double>("step")) {
       step = parameters.get<double>("step");
     }
+    if (parameters.keyExists<bool>("light-cone")) {
+      lightCone = parameters.get<bool>("light-cone");
+    }
     if (parameters.keyExists<std::function<
             std::shared_ptr<CompositeInstruction>(std::vector<double>)>>(
             "kernel-evaluator")) {
@@ -87,27 +101,16 @@ public:
       tmpX[op] += step;
       //   auto kernels = obs->observe(circuit);
 
-      std::vector<std::shared_ptr<CompositeInstruction>> kernels;
-      if (kernel_evaluator) {
-        auto evaled_base = kernel_evaluator(tmpX);
-        kernels = obs->observe(evaled_base);
-        for (auto &f : kernels) {
-          coefficients.push_back(std::real(f->getCoefficient()));
-          gradientInstructions.push_back(f);
-        }
-      } else {
-        kernels = obs->observe(circuit);
-
-        // loop over circuit instructions
-        // and gather coefficients/instructions
-        for (auto &f : kernels) {
-          auto evaled = f->operator()(tmpX);
-          coefficients.push_back(std::real(f->getCoefficient()));
-          gradientInstructions.push_back(evaled);
-        }
-      }
-
-      nInstructionsElement.push_back(kernels.size());
+      auto shifted = observeShifted(obs, circuit, kernel_evaluator, x, tmpX,
+                                    lightCone);
+      coefficients.insert(coefficients.end(), shifted.coefficients.begin(),
+                          shifted.coefficients.end());
+      termIds.insert(termIds.end(), shifted.termIds.begin(),
+                     shifted.termIds.end());
+      gradientInstructions.insert(gradientInstructions.end(),
+                                  shifted.kernels.begin(),
+                                  shifted.kernels.end());
+      nInstructionsElement.push_back(shifted.kernels.size());
     }
 
     return gradientInstructions;
@@ -130,16 +133,28 @@ public:
 
         auto expval =
             std::real(results[instElement + shift]->getExpectationValueZ());
+        if (lightCone) {
+          // Only the change of the term counts
+          auto iter = baseExpValues.find(termIds[instElement + shift]);
+          if (iter == baseExpValues.end()) {
+            xacc::error("Light-cone gradient needs the base point value of " +
+                        termIds[instElement + shift] + ".");
+          }
+          expval -= iter->second;
+        }
         gradElement += expval * coefficients[instElement + shift];
       }
 
       // gradient is (<+> - <->)/2
-      dx[gradTerm] = std::real(gradElement - obsExpValue) / step;
+      dx[gradTerm] = lightCone ? gradElement / step
+                               : std::real(gradElement - obsExpValue) / step;
       shift += nInstructionsElement[gradTerm];
     }
 
     coefficients.clear();
     nInstructionsElement.clear();
+    termIds.clear();
+    baseExpValues.clear();
     std::stringstream ss;
     ss << std::setprecision(5) << "Computed gradient: ";
     for (auto param : dx) {
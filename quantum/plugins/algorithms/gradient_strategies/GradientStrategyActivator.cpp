@@ -19,6 +19,7 @@
 #include "cppmicroservices/BundleContext.h"
 #include "cppmicroservices/ServiceProperties.h"
 #include "QuantumNaturalGradient.hpp"
+#include "AdjointGradient.hpp"
 
 #include <memory>
 
@@ -47,6 +48,9 @@ public:
 
     context.RegisterService<xacc::AlgorithmGradientStrategy>(std::make_shared<xacc::algorithm::QuantumNaturalGradient>());
 
+    auto adj = std::make_shared<xacc::algorithm::AdjointGradient>();
+    context.RegisterService<xacc::AlgorithmGradientStrategy>(adj);
+
   }
 
   void Stop(BundleContext /*context*/) {}
@@ -0,0 +1,163 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_GRADIENT_LIGHT_CONE_HPP_
+#define XACC_GRADIENT_LIGHT_CONE_HPP_
+
+#include "AcceleratorBuffer.hpp"
+#include "CompositeInstruction.hpp"
+#include "InstructionIterator.hpp"
+#include "PauliOperator.hpp"
+#include <set>
+#include <unordered_map>
+
+namespace xacc {
+namespace algorithm {
+
+using CircuitEvaluator =
+    std::function<std::shared_ptr<CompositeInstruction>(std::vector<double>)>;
+
+// Observed kernels of a shifted parameter point, with the coefficient and
+// the term id of each kernel.
+struct ShiftedKernels {
+  std::vector<std::shared_ptr<CompositeInstruction>> kernels;
+  std::vector<double> coefficients;
+  std::vector<std::string> termIds;
+};
+
+// Qubits in the forward light cone of the gates whose angles differ between
+// the two evaluations of a circuit, i.e. the only qubits whose reduced state
+// the shift can change.
+inline std::set<std::size_t>
+shiftedLightCone(const std::shared_ptr<CompositeInstruction> &in_base,
+                 const std::shared_ptr<CompositeInstruction> &in_shifted) {
+  const auto gates = [](const std::shared_ptr<CompositeInstruction> &in_circ) {
+    std::vector<InstPtr> result;
+    InstructionIterator it(in_circ);
+    while (it.hasNext()) {
+      auto inst = it.next();
+      if (inst->isEnabled() && !inst->isComposite()) {
+        result.emplace_back(inst);
+      }
+    }
+    return result;
+  };
+  const auto baseGates = gates(in_base);
+  const auto shiftedGates = gates(in_shifted);
+  if (baseGates.size() != shiftedGates.size()) {
+    xacc::error("Light cone: circuit structure must not depend on the "
+                "parameters.");
+  }
+
+  std::set<std::size_t> cone;
+  for (size_t i = 0; i < baseGates.size(); ++i) {
+    const auto bits = baseGates[i]->bits();
+    bool inCone = false;
+    for (size_t j = 0; j < baseGates[i]->nParameters() && !inCone; ++j) {
+      inCone = InstructionParameterToDouble(baseGates[i]->getParameter(j)) !=
+               InstructionParameterToDouble(shiftedGates[i]->getParameter(j));
+    }
+    for (const auto &bit : bits) {
+      inCone = inCone || cone.count(bit);
+    }
+    if (inCone) {
+      cone.insert(bits.begin(), bits.end());
+    }
+  }
+  return cone;
+}
+
+// The terms of a Pauli observable acting on a qubit of the cone
+// (nullptr for other observables).
+inline std::shared_ptr<Observable>
+restrictToLightCone(const std::shared_ptr<Observable> &in_obs,
+                    const std::set<std::size_t> &in_cone) {
+  auto pauli = std::dynamic_pointer_cast<xacc::quantum::PauliOperator>(in_obs);
+  if (!pauli) {
+    return nullptr;
+  }
+  auto restricted = std::make_shared<xacc::quantum::PauliOperator>();
+  for (auto &[termId, term] : *pauli) {
+    for (const auto &[qubit, op] : term.ops()) {
+      if (op != "I" && in_cone.count(qubit)) {
+        *restricted +=
+            xacc::quantum::PauliOperator(term.ops(), term.coeff());
+        break;
+      }
+    }
+  }
+  return restricted;
+}
+
+// Observes in_obs on the circuit at in_shiftedX, skipping (with
+// in_lightCone) the terms outside the light cone of the shift from in_x.
+inline ShiftedKernels
+observeShifted(const std::shared_ptr<Observable> &in_obs,
+               const std::shared_ptr<CompositeInstruction> &in_circuit,
+               const CircuitEvaluator &in_evaluator,
+               const std::vector<double> &in_x,
+               const std::vector<double> &in_shiftedX, bool in_lightCone) {
+  auto obs = in_obs;
+  if (in_lightCone) {
+    const auto evaluate = [&](const std::vector<double> &in_params) {
+      return in_evaluator ? in_evaluator(in_params)
+                          : in_circuit->operator()(in_params);
+    };
+    if (auto restricted = restrictToLightCone(
+            in_obs, shiftedLightCone(evaluate(in_x), evaluate(in_shiftedX)))) {
+      obs = restricted;
+    }
+  }
+
+  ShiftedKernels result;
+  if (in_evaluator) {
+    for (auto &f : obs->observe(in_evaluator(in_shiftedX))) {
+      result.coefficients.push_back(std::real(f->getCoefficient()));
+      result.termIds.push_back(f->name());
+      result.kernels.push_back(f);
+    }
+  } else {
+    for (auto &f : obs->observe(in_circuit)) {
+      result.coefficients.push_back(std::real(f->getCoefficient()));
+      result.termIds.push_back(f->name());
+      result.kernels.push_back(f->operator()(in_shiftedX));
+    }
+  }
+  return result;
+}
+
+// <P> of each measured term of the energy evaluation results, by term id.
+inline std::unordered_map<std::string, double> termExpectations(
+    const std::vector<std::shared_ptr<AcceleratorBuffer>> &in_results) {
+  std::unordered_map<std::string, double> expectations;
+  for (auto &childBuffer : in_results) {
+    // Qubit-wise commuting groups hold the value of each of their terms.
+    if (childBuffer->hasExtraInfoKey("term-exp-vals")) {
+      for (const auto &[termId, expVal] :
+           childBuffer->getInformation("term-exp-vals")
+               .as<std::map<std::string, double>>()) {
+        expectations[termId] = expVal;
+      }
+      continue;
+    }
+    auto termId = childBuffer->name();
+    if (termId.rfind("evaled_", 0) == 0) {
+      termId.erase(0, 7);
+    }
+    expectations[termId] = childBuffer->getExpectationValueZ();
+  }
+  return expectations;
+}
+
+} // namespace algorithm
+} // namespace xacc
+#endif
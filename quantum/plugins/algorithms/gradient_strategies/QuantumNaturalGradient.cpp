@@ -12,30 +12,39 @@
  *******************************************************************************/
 
 #include "QuantumNaturalGradient.hpp"
+#include "AdjointGradient.hpp"
 #include "xacc.hpp"
 #include "xacc_service.hpp"
 #include <cassert>
+#include <optional>
 
 using namespace xacc;
 
 namespace {
 std::optional<xacc::quantum::PauliOperator> getGenerator(const InstPtr& in_inst) 
 {
-    if (in_inst->name() == "Rx")
+    if (in_inst->opcode() == xacc::GateOpcode::Rx)
     {
         return xacc::quantum::PauliOperator({{ in_inst->bits()[0], "X" }}, 0.5);
     }
-    if (in_inst->name() == "Ry")
+    if (in_inst->opcode() == xacc::GateOpcode::Ry)
     {
         return xacc::quantum::PauliOperator({{ in_inst->bits()[0], "Y" }}, 0.5);
     }
-    if (in_inst->name() == "Rz")
+    if (in_inst->opcode() == xacc::GateOpcode::Rz)
     {
         return xacc::quantum::PauliOperator({{ in_inst->bits()[0], "Z" }}, 0.5);
     }
 
     return std::nullopt;
 }
+
+// Id of a single-term Pauli operator (independent of its coefficient)
+std::string getTermId(xacc::quantum::PauliOperator& in_pauli)
+{
+    assert(in_pauli.nTerms() == 1);
+    return in_pauli.begin()->first;
+}
 }
 namespace xacc {
 namespace algorithm {
@@ -44,7 +53,35 @@ bool QuantumNaturalGradient::initialize(const HeterogeneousMap in_parameters)
     m_gradientStrategy.reset();
     m_layers.clear();
     m_nbMetricTensorKernels = 0;
-    m_metricTermToIdx.clear();
+    m_layerMeasurements.clear();
+    m_metricTensor = "block-diagonal";
+    m_groupLayerTerms = false;
+    m_bitOrder = "MSB";
+    m_circuit.reset();
+    m_x.clear();
+    if (in_parameters.stringExists("metric-tensor"))
+    {
+        m_metricTensor = in_parameters.getString("metric-tensor");
+        if (m_metricTensor != "block-diagonal" && m_metricTensor != "statevector")
+        {
+            xacc::error("Invalid metric-tensor '" + m_metricTensor + "', must be block-diagonal or statevector.");
+            return false;
+        }
+    }
+    if (in_parameters.stringExists("grouping"))
+    {
+        const auto grouping = in_parameters.getString("grouping");
+        if (grouping != "qwc" && grouping != "none")
+        {
+            xacc::error("Invalid grouping '" + grouping + "', must be qwc or none.");
+            return false;
+        }
+        m_groupLayerTerms = grouping == "qwc";
+    }
+    if (in_parameters.stringExists("bit-order"))
+    {
+        m_bitOrder = in_parameters.getString("bit-order");
+    }
     // User can provide a regular gradient strategy.
     // Note: this natural gradient requires a base gradient strategy.
     if (in_parameters.pointerLikeExists<AlgorithmGradientStrategy>("gradient-strategy"))
@@ -77,9 +114,17 @@ std::vector<std::shared_ptr<CompositeInstruction>> QuantumNaturalGradient::getGr
 {
     auto baseGradientKernels = m_gradientStrategy->getGradientExecutions(in_circuit, in_x);
     m_nbMetricTensorKernels = 0;
+    m_nbParams = in_x.size();
+    m_layerMeasurements.clear();
+    if (m_metricTensor == "statevector")
+    {
+        // No circuits to observe, the tensor is computed in compute().
+        m_circuit = in_circuit;
+        m_x = in_x;
+        return baseGradientKernels;
+    }
     // Layering the circuit:
     m_layers = ParametrizedCircuitLayer::toParametrizedLayers(in_circuit);
-    m_nbParams = in_x.size();
     std::vector<std::string> paramNames;
     assert(in_circuit->getVariables().size() == in_x.size());
     for (const auto& param : in_circuit->getVariables())
@@ -91,7 +136,16 @@ std::vector<std::shared_ptr<CompositeInstruction>> QuantumNaturalGradient::getGr
     for (auto& layer : m_layers)
     {
         auto kernels = constructMetricTensorSubCircuit(layer, paramNames, in_x);
-        
+        LayerMeasurement measurement;
+        if (layer.groupedTerms)
+        {
+            measurement.firstKernel = metricTensorKernels.size();
+            measurement.nbKernels = kernels.size();
+            metricTensorKernels.insert(metricTensorKernels.end(), kernels.begin(), kernels.end());
+            m_layerMeasurements.emplace_back(std::move(measurement));
+            continue;
+        }
+
         // Insert *non-identity* kernels only
         size_t kernelIdx = 0;
         const auto isIdentityTerm = [](xacc::quantum::PauliOperator& in_pauli){
@@ -103,7 +157,7 @@ std::vector<std::shared_ptr<CompositeInstruction>> QuantumNaturalGradient::getGr
             if (!isIdentityTerm(layer.kiTerms[i]))
             {
                 metricTensorKernels.emplace_back(kernels[kernelIdx]);
-                m_metricTermToIdx.emplace(layer.kiTerms[i].toString(), metricTensorKernels.size() - 1);
+                measurement.termToIdx.emplace(getTermId(layer.kiTerms[i]), metricTensorKernels.size() - 1);
             }
             kernelIdx++;
         }        
@@ -113,10 +167,11 @@ std::vector<std::shared_ptr<CompositeInstruction>> QuantumNaturalGradient::getGr
             if (!isIdentityTerm(layer.kikjTerms[i]))
             {
                 metricTensorKernels.emplace_back(kernels[kernelIdx]);
-                m_metricTermToIdx.emplace(layer.kikjTerms[i].toString(), metricTensorKernels.size());
+                measurement.termToIdx.emplace(getTermId(layer.kikjTerms[i]), metricTensorKernels.size() - 1);
             }
             kernelIdx++;
         }  
+        m_layerMeasurements.emplace_back(std::move(measurement));
     }
 
     m_nbMetricTensorKernels = metricTensorKernels.size();
@@ -126,7 +181,8 @@ std::vector<std::shared_ptr<CompositeInstruction>> QuantumNaturalGradient::getGr
 
 void QuantumNaturalGradient::compute(std::vector<double>& out_dx, std::vector<std::shared_ptr<AcceleratorBuffer>> in_results)
 {
-    assert(m_nbMetricTensorKernels > 0 && in_results.size() > m_nbMetricTensorKernels);
+    // No metric tensor kernels with the state-vector metric tensor.
+    assert(in_results.size() >= m_nbMetricTensorKernels);
     const auto iterPos = in_results.begin() + (in_results.size() - m_nbMetricTensorKernels);
     // Split the results: regular gradient results + metric tensor results.
     std::vector<std::shared_ptr<AcceleratorBuffer>> baseResults;
@@ -195,7 +251,29 @@ ObservedKernels QuantumNaturalGradient::constructMetricTensorSubCircuit(Parametr
 
     io_layer.kiTerms = KiTerms;
     io_layer.kikjTerms = KiKjTerms;
-    
+    io_layer.groupedTerms.reset();
+
+    if (m_groupLayerTerms)
+    {
+        // The generators of a layer act on distinct qubits, 
+        // so all its terms are measured together.
+        auto groupedTerms = std::make_shared<xacc::quantum::PauliOperator>();
+        for (auto& term : KiTerms)
+        {
+            *groupedTerms += xacc::quantum::PauliOperator(term.begin()->second.ops(), 1.0);
+        }
+        for (auto& term : KiKjTerms)
+        {
+            if (term.getNonIdentitySubTerms().size() > 0)
+            {
+                *groupedTerms += xacc::quantum::PauliOperator(term.begin()->second.ops(), 1.0);
+            }
+        }
+        groupedTerms->fromOptions({{"grouping", "qwc"}});
+        io_layer.groupedTerms = groupedTerms;
+        return groupedTerms->observe(resolvedCirc);
+    }
+
     for (auto& term : KiTerms)
     {   
         auto obsKernels = term.observe(resolvedCirc);
@@ -217,12 +295,63 @@ ObservedKernels QuantumNaturalGradient::constructMetricTensorSubCircuit(Parametr
     return obsComp;
 }
 
+std::unordered_map<std::string, double> QuantumNaturalGradient::getLayerExpectations(size_t in_layerIdx, 
+                                                                                      const std::vector<std::shared_ptr<xacc::AcceleratorBuffer>>& in_results) const
+{
+    std::unordered_map<std::string, double> expectations;
+    const auto& layer = m_layers[in_layerIdx];
+    const auto& measurement = m_layerMeasurements[in_layerIdx];
+    if (!layer.groupedTerms)
+    {
+        for (const auto& [termId, idx] : measurement.termToIdx)
+        {
+            expectations.emplace(termId, in_results[idx]->getExpectationValueZ());
+        }
+        return expectations;
+    }
+
+    // The term expectations of each group, from its measurement counts.
+    auto groupBuffer = std::make_shared<xacc::AcceleratorBuffer>(in_results[measurement.firstKernel]->size());
+    for (size_t i = 0; i < measurement.nbKernels; ++i)
+    {
+        const auto& childBuffer = in_results[measurement.firstKernel + i];
+        groupBuffer->appendChild(childBuffer->name(), childBuffer);
+    }
+    layer.groupedTerms->postProcess(groupBuffer, Observable::PostProcessingTask::EXP_VAL_CALC, {{"bit-order", m_bitOrder}});
+    for (auto& childBuffer : groupBuffer->getChildren())
+    {
+        for (const auto& [termId, expVal] : childBuffer->getInformation("term-exp-vals").as<std::map<std::string, double>>())
+        {
+            expectations.emplace(termId, expVal);
+        }
+    }
+    return expectations;
+}
+
 arma::dmat QuantumNaturalGradient::constructMetricTensorMatrix(const std::vector<std::shared_ptr<xacc::AcceleratorBuffer>>& in_results)
 {   
     arma::dmat gMat(m_nbParams, m_nbParams, arma::fill::zeros);
+    if (m_metricTensor == "statevector")
+    {
+        const auto evaluator = [&](const std::vector<double>& in_x) {
+            return m_circuit->getVariables().empty() ? m_circuit : m_circuit->operator()(in_x);
+        };
+        const auto metric = AdjointGradient::computeMetricTensor(evaluator, m_x);
+        for (size_t i = 0; i < m_nbParams; ++i)
+        {
+            for (size_t j = 0; j < m_nbParams; ++j)
+            {
+                gMat(i, j) = metric[i * m_nbParams + j];
+            }
+        }
+        return gMat;
+    }
+
     size_t blockIdx = 0;
-    for (auto& layer : m_layers)
+    for (size_t layerIdx = 0; layerIdx < m_layers.size(); ++layerIdx)
     {
+        auto& layer = m_layers[layerIdx];
+        const auto expectations = getLayerExpectations(layerIdx, in_results);
         const auto nbParamsInBlock = layer.paramInds.size();
         // Constructs the block diagonal matrices
         arma::dmat blockMat(nbParamsInBlock, nbParamsInBlock, arma::fill::zeros);
@@ -240,11 +369,9 @@ arma::dmat QuantumNaturalGradient::constructMetricTensorMatrix(const std::vector
                 auto secondOrderTerm = layer.kiTerms[i] * layer.kiTerms[j];
                 
                 const auto getExpectationForTerm = [&](xacc::quantum::PauliOperator& in_pauli){
-                    if (m_metricTermToIdx.find(in_pauli.toString()) == m_metricTermToIdx.end())
-                    {
-                        return 1.0;
-                    }
-                    return in_results[m_metricTermToIdx[in_pauli.toString()]]->getExpectationValueZ();
+                    // Identity terms are not measured.
+                    const auto iter = expectations.find(getTermId(in_pauli));
+                    return iter == expectations.end() ? 1.0 : iter->second;
                 };
 
                 const double firstOrderTerm1Exp = getExpectationForTerm(firstOrderTerm1);
@@ -314,7 +441,7 @@ std::vector<ParametrizedCircuitLayer> ParametrizedCircuitLayer::toParametrizedLa
                     qubitsInLayer.clear();
                 }
                 currentLayer.ops.emplace_back(inst);
-                currentLayer.paramInds.emplace_back(std::distance(iter, variables.begin()));
+                currentLayer.paramInds.emplace_back(std::distance(variables.begin(), iter));
                 qubitsInLayer.emplace(bitIdx);
             } 
             else
@@ -35,6 +35,9 @@ struct ParametrizedCircuitLayer
     // Tensor matrix terms:
     std::vector<xacc::quantum::PauliOperator> kiTerms;
     std::vector<xacc::quantum::PauliOperator> kikjTerms;
+    // With grouped measurements: all the non-identity Ki and KiKj terms 
+    // (coefficient 1.0) in qubit-wise commuting groups.
+    std::shared_ptr<xacc::quantum::PauliOperator> groupedTerms;
     // Partition the circuit into layers.
     static std::vector<ParametrizedCircuitLayer> toParametrizedLayers(const std::shared_ptr<xacc::CompositeInstruction>& in_circuit);
 };
@@ -57,6 +60,19 @@ private:
                                                     const std::vector<std::string>& in_varNames, 
                                                     const std::vector<double>& in_varVals) const; 
     arma::dmat constructMetricTensorMatrix(const std::vector<std::shared_ptr<xacc::AcceleratorBuffer>>& in_results);
+    // <P> of the measured Ki and KiKj terms of a layer, by term id.
+    std::unordered_map<std::string, double> getLayerExpectations(size_t in_layerIdx, 
+                                                                  const std::vector<std::shared_ptr<xacc::AcceleratorBuffer>>& in_results) const;
+
+    // Where the measurements of a layer are in the metric tensor results.
+    struct LayerMeasurement
+    {
+        // Per-term kernels: term id -> result index
+        std::unordered_map<std::string, size_t> termToIdx;
+        // Grouped kernels: [firstKernel, firstKernel + nbKernels)
+        size_t firstKernel = 0;
+        size_t nbKernels = 0;
+    };
 
 private:
     // The *regular* gradient strategy service whose gradients will
@@ -65,9 +81,18 @@ private:
     // Cache the circuit layer structure to reconstruct metric tensor.
     std::vector<ParametrizedCircuitLayer> m_layers;
     size_t m_nbMetricTensorKernels;
-    // Keeps track of the term and the index in the kernel sequence.
-    std::unordered_map<std::string, size_t> m_metricTermToIdx;
+    // Keeps track of the terms of each layer in the kernel sequence.
+    std::vector<LayerMeasurement> m_layerMeasurements;
     size_t m_nbParams;
+    // "block-diagonal": measured layer by layer (default), 
+    // "statevector": the full tensor, computed locally from the state vector.
+    std::string m_metricTensor;
+    // Measure the terms of a layer in qubit-wise commuting groups (needs shots).
+    bool m_groupLayerTerms;
+    std::string m_bitOrder;
+    // The circuit and parameters of the state-vector metric tensor.
+    std::shared_ptr<xacc::CompositeInstruction> m_circuit;
+    std::vector<double> m_x;
 };
 }
 }
@@ -31,17 +31,6 @@ inline constexpr std::complex<double> operator"" _i(long double x) noexcept {
   return {0., static_cast<double>(x)};
 }
 
-MatrixXcdual kroneckerProduct(MatrixXcdual &lhs, MatrixXcdual &rhs) {
-  MatrixXcdual result(lhs.rows() * rhs.rows(), lhs.cols() * rhs.cols());
-  for (int i = 0; i < lhs.rows(); ++i) {
-    for (int j = 0; j < lhs.cols(); ++j) {
-      result.block(i * rhs.rows(), j * rhs.cols(), rhs.rows(), rhs.cols()) =
-          lhs(i, j) * rhs;
-    }
-  }
-  return result;
-}
-
 enum class Rot { X, Y, Z };
 
 class AutodiffCircuitVisitor : public AllGateVisitor {
@@ -51,8 +40,9 @@ public:
       const std::unordered_map<std::string, autodiff::dual> &in_varMap)
       : m_nbQubit(in_nbQubits), m_varMap(in_varMap) {
     static bool static_gate_init = false;
-    m_circuitMat =
-        MatrixXcdual::Identity(1ULL << in_nbQubits, 1ULL << in_nbQubits);
+    // Propagate the |0> state rather than the whole circuit unitary.
+    m_stateVec = VectorXcdual::Zero(1ULL << in_nbQubits);
+    m_stateVec(0) = 1.0;
     if (!static_gate_init) {
       X_Mat << 0.0 + 0.0_i, 1.0 + 0.0_i, 1.0 + 0.0_i, 0.0 + 0.0_i;
       Y_Mat << 0.0 + 0.0_i, -I, I, 0.0 + 0.0_i;
@@ -87,13 +77,11 @@ public:
   }
   // Gate visitor Impl
   void visit(Hadamard &h) override {
-    m_circuitMat = singleQubitGateExpand(H_Mat, h.bits()[0]) * m_circuitMat;
+    applySingleQubitGate(H_Mat, h.bits()[0]);
   }
 
   void visit(CNOT &cnot) override {
-    MatrixXcdual fullMat =
-        twoQubitGateExpand(CX_Mat, cnot.bits()[0], cnot.bits()[1]);
-    m_circuitMat = fullMat * m_circuitMat;
+    applyTwoQubitGate(CX_Mat, cnot.bits()[0], cnot.bits()[1]);
   }
 
   void visit(Rz &rz) override {
@@ -105,18 +93,15 @@ public:
       const auto [coeff, varName] = parseVarString(p.toString());
       const auto iter = m_varMap.find(varName);
       if (iter != m_varMap.end()) {
-        MatrixXcdual fullMat = singleParametricQubitGateExpand(
+        applySingleParametricQubitGate(
             coeff * iter->second, Rot::Z, rz.bits()[0]);
-        m_circuitMat = fullMat * m_circuitMat;
       } else {
         xacc::error("Unknown variable named '" + varName + "' encountered.");
       }
     } else {
       // Non-parametrized gate, i.e. the angle is fixed, not a variable.
       autodiff::dual theta = InstructionParameterToDouble(rz.getParameter(0));
-      MatrixXcdual fullMat =
-          singleParametricQubitGateExpand(theta, Rot::Z, rz.bits()[0]);
-      m_circuitMat = fullMat * m_circuitMat;
+      applySingleParametricQubitGate(theta, Rot::Z, rz.bits()[0]);
     }
   }
 
@@ -129,18 +114,15 @@ public:
       const auto [coeff, varName] = parseVarString(p.toString());
       const auto iter = m_varMap.find(varName);
       if (iter != m_varMap.end()) {
-        MatrixXcdual fullMat = singleParametricQubitGateExpand(
+        applySingleParametricQubitGate(
             coeff * iter->second, Rot::Y, ry.bits()[0]);
-        m_circuitMat = fullMat * m_circuitMat;
       } else {
         xacc::error("Unknown variable named '" + varName + "' encountered.");
       }
     } else {
       // Non-parametrized gate, i.e. the angle is fixed, not a variable.
       autodiff::dual theta = InstructionParameterToDouble(ry.getParameter(0));
-      MatrixXcdual fullMat =
-          singleParametricQubitGateExpand(theta, Rot::Y, ry.bits()[0]);
-      m_circuitMat = fullMat * m_circuitMat;
+      applySingleParametricQubitGate(theta, Rot::Y, ry.bits()[0]);
     }
   }
 
@@ -153,63 +135,52 @@ public:
       const auto [coeff, varName] = parseVarString(p.toString());
       const auto iter = m_varMap.find(varName);
       if (iter != m_varMap.end()) {
-        MatrixXcdual fullMat = singleParametricQubitGateExpand(
+        applySingleParametricQubitGate(
             coeff * iter->second, Rot::X, rx.bits()[0]);
-        m_circuitMat = fullMat * m_circuitMat;
       } else {
         xacc::error("Unknown variable named '" + varName + "' encountered.");
       }
     } else {
       // Non-parametrized gate, i.e. the angle is fixed, not a variable.
       autodiff::dual theta = InstructionParameterToDouble(rx.getParameter(0));
-      MatrixXcdual fullMat =
-          singleParametricQubitGateExpand(theta, Rot::X, rx.bits()[0]);
-      m_circuitMat = fullMat * m_circuitMat;
+      applySingleParametricQubitGate(theta, Rot::X, rx.bits()[0]);
     }
   }
 
   void visit(X &x) override {
-    m_circuitMat = singleQubitGateExpand(X_Mat, x.bits()[0]) * m_circuitMat;
+    applySingleQubitGate(X_Mat, x.bits()[0]);
   }
 
   void visit(Y &y) override {
-    m_circuitMat = singleQubitGateExpand(Y_Mat, y.bits()[0]) * m_circuitMat;
+    applySingleQubitGate(Y_Mat, y.bits()[0]);
   }
   void visit(Z &z) override {
-    m_circuitMat = singleQubitGateExpand(Z_Mat, z.bits()[0]) * m_circuitMat;
+    applySingleQubitGate(Z_Mat, z.bits()[0]);
   }
   void visit(CY &cy) override {
-    MatrixXcdual fullMat =
-        twoQubitGateExpand(CY_Mat, cy.bits()[0], cy.bits()[1]);
-    m_circuitMat = fullMat * m_circuitMat;
+    applyTwoQubitGate(CY_Mat, cy.bits()[0], cy.bits()[1]);
   }
   void visit(CZ &cz) override {
-    MatrixXcdual fullMat =
-        twoQubitGateExpand(CZ_Mat, cz.bits()[0], cz.bits()[1]);
-    m_circuitMat = fullMat * m_circuitMat;
+    applyTwoQubitGate(CZ_Mat, cz.bits()[0], cz.bits()[1]);
   }
   void visit(Swap &s) override {
-    MatrixXcdual fullMat =
-        twoQubitGateExpand(Swap_Mat, s.bits()[0], s.bits()[1]);
-    m_circuitMat = fullMat * m_circuitMat;
+    applyTwoQubitGate(Swap_Mat, s.bits()[0], s.bits()[1]);
   }
   void visit(CRZ &crz) override {}
   void visit(CH &ch) override {
-    MatrixXcdual fullMat =
-        twoQubitGateExpand(CH_Mat, ch.bits()[0], ch.bits()[1]);
-    m_circuitMat = fullMat * m_circuitMat;
+    applyTwoQubitGate(CH_Mat, ch.bits()[0], ch.bits()[1]);
   }
   void visit(S &s) override {
-    m_circuitMat = singleQubitGateExpand(S_Mat, s.bits()[0]) * m_circuitMat;
+    applySingleQubitGate(S_Mat, s.bits()[0]);
   }
   void visit(Sdg &sdg) override {
-    m_circuitMat = singleQubitGateExpand(Sdg_Mat, sdg.bits()[0]) * m_circuitMat;
+    applySingleQubitGate(Sdg_Mat, sdg.bits()[0]);
   }
   void visit(T &t) override {
-    m_circuitMat = singleQubitGateExpand(T_Mat, t.bits()[0]) * m_circuitMat;
+    applySingleQubitGate(T_Mat, t.bits()[0]);
   }
   void visit(Tdg &tdg) override {
-    m_circuitMat = singleQubitGateExpand(Tdg_Mat, tdg.bits()[0]) * m_circuitMat;
+    applySingleQubitGate(Tdg_Mat, tdg.bits()[0]);
   }
   void visit(CPhase &cphase) override {}
   void visit(Measure &measure) override {}
@@ -221,33 +192,24 @@ public:
   // Identifiable Impl
   const std::string name() const override { return ""; }
   const std::string description() const override { return ""; }
-  MatrixXcdual getMat() const { return m_circuitMat; }
-  MatrixXcdual singleQubitGateExpand(MatrixXcdual &in_gateMat,
-                                     size_t in_loc) const {
-    if (m_nbQubit == 1) {
-      return in_gateMat;
-    }
-    if (in_loc == 0) {
-      auto dim = 1ULL << (m_nbQubit - 1);
-      MatrixXcdual rhs = MatrixXcdual::Identity(dim, dim);
-      return kroneckerProduct(in_gateMat, rhs);
-    } else if (in_loc == m_nbQubit - 1) {
-      auto dim = 1ULL << (m_nbQubit - 1);
-      MatrixXcdual lhs = MatrixXcdual::Identity(dim, dim);
-      return kroneckerProduct(lhs, in_gateMat);
-    } else {
-      auto leftDim = 1ULL << in_loc;
-      auto rightDim = 1ULL << (m_nbQubit - 1 - in_loc);
-      MatrixXcdual lhs = MatrixXcdual::Identity(leftDim, leftDim);
-      MatrixXcdual rhs = MatrixXcdual::Identity(rightDim, rightDim);
-      MatrixXcdual lhsKron = kroneckerProduct(lhs, in_gateMat);
-      return kroneckerProduct(lhsKron, rhs);
+  VectorXcdual getStateVec() const { return m_stateVec; }
+
+  // Note: qubit 0 is the most significant bit of the state vector index.
+  void applySingleQubitGate(const MatrixXcdual &in_gateMat, size_t in_loc) {
+    const size_t mask = 1ULL << (m_nbQubit - in_loc - 1);
+    for (size_t i = 0; i < m_stateVec.size(); ++i) {
+      if (i & mask) {
+        continue;
+      }
+      const cxdual a = m_stateVec(i);
+      const cxdual b = m_stateVec(i | mask);
+      m_stateVec(i) = in_gateMat(0, 0) * a + in_gateMat(0, 1) * b;
+      m_stateVec(i | mask) = in_gateMat(1, 0) * a + in_gateMat(1, 1) * b;
     }
   }
 
-  MatrixXcdual singleParametricQubitGateExpand(autodiff::dual in_var,
-                                               Rot in_rotType,
-                                               size_t in_bitLoc) const {
+  void applySingleParametricQubitGate(autodiff::dual in_var, Rot in_rotType,
+                                      size_t in_bitLoc) {
     static const cxdual I_dual = I;
     MatrixXcdual gateMat = [&]() {
       switch (in_rotType) {
@@ -276,47 +238,32 @@ public:
         __builtin_unreachable();
       }
     }();
-    return singleQubitGateExpand(gateMat, in_bitLoc);
+    applySingleQubitGate(gateMat, in_bitLoc);
   }
 
-  MatrixXcdual twoQubitGateExpand(MatrixXcdual &in_gateMat, size_t in_bit1,
-                                  size_t in_bit2) const {
-    const auto matSize = 1ULL << m_nbQubit;
-    MatrixXcdual resultMat = MatrixXcdual::Identity(matSize, matSize);
-    // Qubit index list (0->(dim-1))
-    std::vector<size_t> index_list(m_nbQubit);
-    std::iota(index_list.begin(), index_list.end(), 0);
-    const std::vector<size_t> idx{m_nbQubit - in_bit2 - 1,
-                                  m_nbQubit - in_bit1 - 1};
-    for (size_t k = 0; k < matSize; ++k) {
-      std::vector<cxdual> oldColumn(matSize);
-      for (size_t i = 0; i < matSize; ++i) {
-        oldColumn[i] = resultMat(i, k);
+  // The gate matrix is in the (in_bit1, in_bit2) basis, in_bit1 being the
+  // most significant bit, e.g. in_bit1 is the control.
+  void applyTwoQubitGate(const MatrixXcdual &in_gateMat, size_t in_bit1,
+                         size_t in_bit2) {
+    const size_t mask1 = 1ULL << (m_nbQubit - in_bit1 - 1);
+    const size_t mask2 = 1ULL << (m_nbQubit - in_bit2 - 1);
+    for (size_t i = 0; i < m_stateVec.size(); ++i) {
+      if ((i & mask1) || (i & mask2)) {
+        continue;
       }
-
-      for (size_t i = 0; i < matSize; ++i) {
-        size_t local_i = 0;
-        for (size_t l = 0; l < idx.size(); ++l) {
-          local_i |= ((i >> idx[l]) & 1) << l;
-        }
-
+      const size_t idx[4] = {i, i | mask2, i | mask1, i | mask1 | mask2};
+      cxdual in[4];
+      for (size_t k = 0; k < 4; ++k) {
+        in[k] = m_stateVec(idx[k]);
+      }
+      for (size_t row = 0; row < 4; ++row) {
         cxdual res = 0.0_i;
-        for (size_t j = 0; j < (1ULL << idx.size()); ++j) {
-          size_t locIdx = i;
-          for (size_t l = 0; l < idx.size(); ++l) {
-            if (((j >> l) & 1) != ((i >> idx[l]) & 1)) {
-              locIdx ^= (1ULL << idx[l]);
-            }
-          }
-
-          res += oldColumn[locIdx] * in_gateMat(local_i, j);
+        for (size_t col = 0; col < 4; ++col) {
+          res += in_gateMat(row, col) * in[col];
         }
-
-        resultMat(i, k) = res;
+        m_stateVec(idx[row]) = res;
       }
     }
-
-    return resultMat;
   }
 
   std::pair<double, std::string>
@@ -334,7 +281,7 @@ public:
   }
 
 private:
-  MatrixXcdual m_circuitMat;
+  VectorXcdual m_stateVec;
   size_t m_nbQubit;
   std::unordered_map<std::string, autodiff::dual> m_varMap;
 };
@@ -344,11 +291,8 @@ namespace xacc {
 namespace quantum {
 void Autodiff::fromObservable(std::shared_ptr<Observable> obs) {
   m_nbQubits = obs->nBits();
-  const auto dim = 1ULL << m_nbQubits;
-  m_obsMat = MatrixXcdual::Zero(dim, dim);
-  for (auto &triplet : obs->to_sparse_matrix()) {
-    m_obsMat(triplet.row(), triplet.col()) = triplet.coeff();
-  }
+  // Keep the observable matrix sparse, i.e. O(2^n * terms) elements.
+  m_obsTriplets = obs->to_sparse_matrix();
 }
 
 bool Autodiff::initialize(const HeterogeneousMap parameters) {
@@ -372,9 +316,8 @@ bool Autodiff::initialize(const HeterogeneousMap parameters) {
 
 std::vector<double> Autodiff::computeDerivative(
     std::shared_ptr<CompositeInstruction> CompositeInstruction,
-    const MatrixXcdual &obsMat, const std::vector<double> &x, size_t nbQubits,
-    double *optional_out_fn_val) {
-  // std::cout << "Observable: \n" << obsMat << "\n";
+    const std::vector<SparseTriplet> &obsTriplets, const std::vector<double> &x,
+    size_t nbQubits, double *optional_out_fn_val) {
   // std::cout << "Circuit: \n" << CompositeInstruction->toString() << "\n";
   // std::cout << "Number of arguments = " << CompositeInstruction->nVariables()
   //           << "\n";
@@ -399,17 +342,20 @@ std::vector<double> Autodiff::computeDerivative(
         inst->accept(&visitor);
       }
     }
-    MatrixXcdual circMat = visitor.getMat();
-    // std::cout << "Circ Mat:\n" << circMat << "\n";
-    VectorXcdual finalState = circMat.col(0);
+    VectorXcdual finalState = visitor.getStateVec();
     // std::cout << "Final state:\n" << finalState << "\n";
 
-    VectorXcdual ket = obsMat * finalState;
+    // Sparse matrix-vector product: ket = obs * finalState
+    VectorXcdual ket = VectorXcdual::Zero(finalState.size());
+    for (auto triplet : obsTriplets) {
+      const auto coeff = triplet.coeff();
+      ket[triplet.row()] +=
+          cxdual(coeff.real(), coeff.imag()) * finalState[triplet.col()];
+    }
     VectorXcdual bra = VectorXcdual::Zero(finalState.size());
     for (int i = 0; i < finalState.size(); ++i) {
       bra[i] = conj(finalState[i]);
     }
-    // std::cout << "Mat:\n" << circMat << "\n";
     // std::cout << "Final state:\n" << finalState << "\n";
     cxdual exp_val = bra.cwiseProduct(ket).sum();
     return exp_val.real();
@@ -441,7 +387,7 @@ std::vector<double>
 Autodiff::derivative(std::shared_ptr<CompositeInstruction> CompositeInstruction,
                      const std::vector<double> &x,
                      double *optional_out_fn_val) {
-  return computeDerivative(CompositeInstruction, m_obsMat, x, m_nbQubits, optional_out_fn_val);
+  return computeDerivative(CompositeInstruction, m_obsTriplets, x, m_nbQubits, optional_out_fn_val);
 }
 
 void Autodiff::compute(
@@ -466,7 +412,7 @@ void Autodiff::compute(
           auto kernel = kernel_evaluator(newParameters);
           assert(kernel->getVariables().size() == 0);
           double funcVal = 0.0;
-          computeDerivative(kernel, m_obsMat, {} /* no params */, m_nbQubits,
+          computeDerivative(kernel, m_obsTriplets, {} /* no params */, m_nbQubits,
                             &funcVal);
           valuesPlus[i] = funcVal;
         } else {
@@ -476,7 +422,7 @@ void Autodiff::compute(
           auto kernel = kernel_evaluator(newParameters);
           assert(kernel->getVariables().size() == 0);
           double funcVal = 0.0;
-          computeDerivative(kernel, m_obsMat, {} /* no params */, m_nbQubits,
+          computeDerivative(kernel, m_obsTriplets, {} /* no params */, m_nbQubits,
                             &funcVal);
           valuesMinus[i] = funcVal;
         }
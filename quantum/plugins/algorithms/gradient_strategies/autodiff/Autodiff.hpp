@@ -49,8 +49,9 @@ public:
   // Static helper to evaluate the derivatives and optionally the function value.
   static std::vector<double>
   computeDerivative(std::shared_ptr<CompositeInstruction> CompositeInstruction,
-                    const MatrixXcdual &obsMat, const std::vector<double> &x,
-                    size_t nbQubits, double *optional_out_fn_val = nullptr);
+                    const std::vector<SparseTriplet> &obsTriplets,
+                    const std::vector<double> &x, size_t nbQubits,
+                    double *optional_out_fn_val = nullptr);
 
   // AlgorithmGradientStrategy implementation:
   virtual bool isNumerical() const override { return true; }
@@ -72,7 +73,8 @@ public:
           std::vector<std::shared_ptr<AcceleratorBuffer>> results) override;
 
 private:
-  MatrixXcdual m_obsMat;
+  // Observable matrix in sparse (triplet) form
+  std::vector<SparseTriplet> m_obsTriplets;
   size_t m_nbQubits;
   std::shared_ptr<CompositeInstruction> m_varKernel;
   std::vector<double> m_currentParams;
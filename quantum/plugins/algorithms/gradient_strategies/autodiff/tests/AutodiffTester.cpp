@@ -303,6 +303,39 @@ exp_i_theta(q, t1, {{"pauli", "X0 Z1 Y2 - X2 Z1 Y0"}});
   EXPECT_NEAR(energy, -2.044, 0.1);
 }
 
+TEST(AutodiffTester, checkManyQubits) {
+  // 14 qubits: the dense (4^n) observable/circuit matrices
+  // would need several TB, the sparse path only a few MB.
+  const int nbQubits = 14;
+  std::string obsStr;
+  auto provider = xacc::getIRProvider("quantum");
+  auto ansatz = provider->createComposite("many_qubits_ansatz");
+  for (int i = 0; i < nbQubits; ++i) {
+    obsStr += (i == 0 ? "Z" : " + Z") + std::to_string(i);
+    const std::string varName = "t" + std::to_string(i);
+    ansatz->addVariable(varName);
+    ansatz->addInstruction(provider->createInstruction(
+        "Ry", {(size_t)i}, {xacc::InstructionParameter(varName)}));
+  }
+  auto H = xacc::quantum::getObservable("pauli", obsStr);
+  auto autodiff = std::make_shared<xacc::quantum::Autodiff>();
+  autodiff->fromObservable(H);
+
+  // <Z_i> = cos(t_i)
+  std::vector<double> params;
+  double expected = 0.0;
+  for (int i = 0; i < nbQubits; ++i) {
+    params.emplace_back(0.1 * i);
+    expected += std::cos(0.1 * i);
+  }
+  double energy = 0.0;
+  auto grad = autodiff->derivative(ansatz, params, &energy);
+  EXPECT_NEAR(energy, expected, 1e-9);
+  for (int i = 0; i < nbQubits; ++i) {
+    EXPECT_NEAR(grad[i], -std::sin(params[i]), 1e-9);
+  }
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize(argc, argv);
   ::testing::InitGoogleTest(&argc, argv);
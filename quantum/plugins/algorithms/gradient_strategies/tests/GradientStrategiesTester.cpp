@@ -168,6 +168,150 @@ TEST(GradientStrategiesTester, checkDeuteronVQE) {
   EXPECT_NEAR((*buffer)["opt-val"].as<double>(), -1.74886, 1e-4);
 }
 
+TEST(GradientStrategiesTester, checkAdjoint) {
+  auto observable = xacc::quantum::getObservable(
+      "pauli", std::string("0.5 X0 Z1 - 1.2 Y0 Y1 + 0.7 Z1 + 0.3 X2"));
+
+  xacc::qasm(R"(
+        .compiler xasm
+        .circuit adjoint_ansatz
+        .parameters t0, t1, t2
+        .qbit q
+        H(q[0]);
+        Ry(q[0], t0);
+        CNOT(q[0], q[1]);
+        Rx(q[1], 0.5 * t1);
+        CPhase(q[1], q[2], t2);
+        H(q[2]);
+        Rz(q[2], t0);
+        U(q[1], t1, t2, 0.3);
+    )");
+  auto ansatz = xacc::getCompiled("adjoint_ansatz");
+  const std::vector<double> x{0.3, -0.8, 1.2};
+
+  auto adjoint = xacc::getService<AlgorithmGradientStrategy>("adjoint");
+  adjoint->initialize({{"observable", observable}});
+  EXPECT_TRUE(adjoint->getGradientExecutions(ansatz, x).empty());
+  std::vector<double> dx(x.size());
+  adjoint->compute(dx, {});
+
+  // Compare against central differences on qpp
+  auto accelerator = xacc::getAccelerator("qpp");
+  auto energy = [&](const std::vector<double> &params) {
+    auto buffer = xacc::qalloc(3);
+    auto kernels = observable->observe(ansatz->operator()(params));
+    accelerator->execute(buffer, kernels);
+    double result = 0.0;
+    auto children = buffer->getChildren();
+    for (int i = 0; i < kernels.size(); ++i) {
+      result += std::real(kernels[i]->getCoefficient()) *
+                children[i]->getExpectationValueZ();
+    }
+    return result;
+  };
+  for (int i = 0; i < x.size(); ++i) {
+    auto plus = x, minus = x;
+    plus[i] += 1e-5;
+    minus[i] -= 1e-5;
+    EXPECT_NEAR(dx[i], (energy(plus) - energy(minus)) / 2e-5, 1e-5);
+  }
+}
+
+TEST(GradientStrategiesTester, checkLightCone) {
+  auto observable = xacc::quantum::getObservable(
+      "pauli", std::string("Z0 + 0.5 X0 + Z1 + 0.2 Z2"));
+
+  xacc::qasm(R"(
+        .compiler xasm
+        .circuit light_cone_ansatz
+        .parameters t0, t1
+        .qbit q
+        Ry(q[0], t0);
+        Ry(q[1], t1);
+        H(q[2]);
+    )");
+  auto ansatz = xacc::getCompiled("light_cone_ansatz");
+  const std::vector<double> x{0.3, 0.5};
+  // E = cos(t0) + 0.5 sin(t0) + cos(t1)
+  const std::vector<double> expected{-std::sin(0.3) + 0.5 * std::cos(0.3),
+                                     -std::sin(0.5)};
+
+  auto accelerator = xacc::getAccelerator("qpp");
+  auto baseBuffer = xacc::qalloc(3);
+  accelerator->execute(baseBuffer,
+                       observable->observe(ansatz->operator()(x)));
+
+  for (const std::string name : {"forward", "backward", "central"}) {
+    auto gradient = xacc::getService<AlgorithmGradientStrategy>(name);
+    gradient->initialize({{"observable", observable},
+                          {"step", 1e-5},
+                          {"light-cone", true}});
+    auto kernels = gradient->getGradientExecutions(ansatz, x);
+    // t0: Z0, X0 and t1: Z1 (twice for central differences)
+    EXPECT_EQ(kernels.size(), name == "central" ? 6 : 3);
+    auto buffer = xacc::qalloc(3);
+    accelerator->execute(buffer, kernels);
+    gradient->setBaseResults(baseBuffer->getChildren());
+    std::vector<double> dx(x.size());
+    gradient->compute(dx, buffer->getChildren());
+    for (int i = 0; i < x.size(); ++i) {
+      EXPECT_NEAR(dx[i], expected[i], 1e-4);
+    }
+  }
+
+  // A single random direction is exact for one parameter
+  xacc::qasm(R"(
+        .compiler xasm
+        .circuit spsa_ansatz
+        .parameters t0
+        .qbit q
+        Ry(q[0], t0);
+    )");
+  auto spsaAnsatz = xacc::getCompiled("spsa_ansatz");
+  auto spsa = xacc::getService<AlgorithmGradientStrategy>("central");
+  spsa->initialize({{"observable", observable},
+                    {"step", 1e-5},
+                    {"spsa-samples", 1},
+                    {"seed", 7}});
+  auto kernels = spsa->getGradientExecutions(spsaAnsatz, {0.3});
+  auto buffer = xacc::qalloc(3);
+  accelerator->execute(buffer, kernels);
+  std::vector<double> dx(1);
+  spsa->compute(dx, buffer->getChildren());
+  EXPECT_NEAR(dx[0], expected[0], 1e-4);
+}
+
+TEST(GradientStrategiesTester, checkDeuteronVQEAdjoint) {
+  auto accelerator = xacc::getAccelerator("qpp");
+  auto H_N_2 = xacc::quantum::getObservable(
+      "pauli", std::string("5.907 - 2.1433 X0X1 "
+                           "- 2.1433 Y0Y1"
+                           "+ .21829 Z0 - 6.125 Z1"));
+
+  auto optimizer = xacc::getOptimizer("nlopt", {{"nlopt-optimizer", "l-bfgs"}});
+  xacc::qasm(R"(
+        .compiler xasm
+        .circuit deuteron_ansatz_adjoint
+        .parameters theta
+        .qbit q
+        X(q[0]);
+        Ry(q[1], theta);
+        CNOT(q[1],q[0]);
+    )");
+  auto ansatz = xacc::getCompiled("deuteron_ansatz_adjoint");
+
+  auto vqe = xacc::getAlgorithm("vqe");
+  vqe->initialize({{"ansatz", ansatz},
+                   {"observable", H_N_2},
+                   {"accelerator", accelerator},
+                   {"optimizer", optimizer},
+                   {"gradient_strategy", "adjoint"}});
+
+  auto buffer = xacc::qalloc(2);
+  vqe->execute(buffer);
+  EXPECT_NEAR((*buffer)["opt-val"].as<double>(), -1.74886, 1e-4);
+}
+
 TEST(GradientStrategiesTester, checkYanPSproblem) {
 
   int nLayer = 7;
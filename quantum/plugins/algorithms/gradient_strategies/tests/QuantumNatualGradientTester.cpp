@@ -15,6 +15,7 @@
 #include "xacc.hpp"
 #include "xacc_service.hpp"
 #include "QuantumNaturalGradient.hpp"
+#include "AdjointGradient.hpp"
 #include "Observable.hpp"
 
 using namespace xacc;
@@ -205,6 +206,79 @@ TEST(QuantumNatualGradientTester, testSingleQubitRotations)
     EXPECT_NEAR(finalCostValue, -1.0, 0.1);
 } 
 
+TEST(QuantumNatualGradientTester, checkMetricTensorOptions)
+{
+    auto xasmCompiler = xacc::getCompiler("xasm");
+    auto ir = xasmCompiler->compile(R"(__qpu__ void ansatz5(qbit q, double t0, double t1, double t2, double t3) {
+        // State-prep 
+        Ry(q[0], pi/4);
+        Ry(q[1], pi/3);
+        Ry(q[2], pi/7);
+        // Parametrized gates (layer 1)
+        Rz(q[0], t0);
+        Rz(q[1], t1);
+        CX(q[0], q[1]);
+        CX(q[1], q[2]);
+        // Parametrized gates (layer 2)
+        Ry(q[1], t2);
+        Rx(q[2], t3);
+        CX(q[0], q[1]);
+        CX(q[1], q[2]);
+    })", nullptr);
+
+    auto program = ir->getComposite("ansatz5");
+    std::shared_ptr<Observable> observable = std::make_shared<xacc::quantum::PauliOperator>();
+    observable->fromString("Y0");
+    const std::vector<double> params(4, 0.0);
+
+    auto qng = xacc::getService<AlgorithmGradientStrategy>("quantum-natural-gradient");
+    EXPECT_TRUE(qng->initialize({std::make_pair("observable", observable), 
+                                 std::make_pair("metric-tensor", "statevector")}));
+    // Only the base gradient circuits
+    const auto baseKernels = qng->getGradientExecutions(program, params);
+    
+    EXPECT_TRUE(qng->initialize({std::make_pair("observable", observable), 
+                                 std::make_pair("grouping", "qwc")}));
+    // One circuit per layer
+    const auto groupedKernels = qng->getGradientExecutions(program, params);
+    EXPECT_EQ(groupedKernels.size(), baseKernels.size() + 2);
+}
+
+TEST(QuantumNatualGradientTester, checkStatevectorMetricTensor)
+{
+    auto xasmCompiler = xacc::getCompiler("xasm");
+    auto ir = xasmCompiler->compile(R"(__qpu__ void testRotation2(qbit q, double t0, double t1) {
+        Rx(q[0], t0);
+        Ry(q[0], t1);
+    })", nullptr);
+
+    auto program = ir->getComposite("testRotation2");
+    const std::vector<double> params { 0.11, 0.12 };
+    const auto evaluator = [&](const std::vector<double>& in_x) { return program->operator()(in_x); };
+    // g = diag(1/4, cos^2(t0)/4)
+    const auto metric = AdjointGradient::computeMetricTensor(evaluator, params);
+    EXPECT_EQ(metric.size(), 4);
+    EXPECT_NEAR(metric[0], 0.25, 1e-6);
+    EXPECT_NEAR(metric[1], 0.0, 1e-6);
+    EXPECT_NEAR(metric[2], 0.0, 1e-6);
+    EXPECT_NEAR(metric[3], std::cos(0.11) * std::cos(0.11) / 4.0, 1e-6);
+
+    std::shared_ptr<Observable> observable = std::make_shared<xacc::quantum::PauliOperator>();
+    observable->fromString("Z0");    
+    auto optimizer = xacc::getOptimizer("mlpack", { std::make_pair("initial-parameters", params) });
+    auto vqe = xacc::getService<Algorithm>("vqe");
+    auto acc = xacc::getAccelerator("qpp");
+    EXPECT_TRUE(vqe->initialize({std::make_pair("ansatz", program),
+                                std::make_pair("accelerator", acc),
+                                std::make_pair("observable", observable),
+                                std::make_pair("optimizer", optimizer),
+                                std::make_pair("gradient_strategy", "quantum-natural-gradient"),
+                                std::make_pair("metric-tensor", "statevector")}));
+    auto buffer = xacc::qalloc(1);
+    vqe->execute(buffer);
+    EXPECT_NEAR((*buffer)["opt-val"].as<double>(), -1.0, 0.1);
+} 
+
 int main(int argc, char **argv) 
 {
     xacc::Initialize(argc, argv);
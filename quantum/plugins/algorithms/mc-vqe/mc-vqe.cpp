@@ -18,7 +18,9 @@
 #include "xacc.hpp"
 #include "xacc_service.hpp"
 #include <Eigen/Eigenvalues>
+#include <algorithm>
 #include <iomanip>
+#include <unordered_map>
 
 using namespace xacc;
 using namespace xacc::quantum;
@@ -145,33 +147,40 @@ void MC_VQE::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
         // the gradients of each state
         std::vector<double> averageGrad(x.size());
 
-        // loop over states
+        // retrieve CIS state preparation instructions and add entangler
+        std::vector<std::shared_ptr<CompositeInstruction>> kernels;
+        std::vector<ObservedState> observedStates;
         for (int state = 0; state < nStates; state++) {
-
-          // fsToExec stores observed circuits to compute gradients
-          std::vector<std::shared_ptr<CompositeInstruction>> gradFsToExec;
-
-          // retrieve CIS state preparation instructions and add entangler
           auto kernel = statePreparationCircuit(CISGateAngles.col(state));
           kernel->addVariables(entangler->getVariables());
-          for (auto &inst : entangler->getInstructions()) {
+          for (auto &inst : entangler->getInstructionsView()) {
             kernel->addInstruction(inst);
           }
 
-	  depth = kernel->depth();
-	  nGates = kernel->nInstructions();
-
           logControl("Printing circuit for state #" + std::to_string(state), 3);
           logControl(kernel->toString(), 3);
+          kernels.push_back(kernel);
+          observedStates.push_back({observable, kernel, x});
+        }
+        depth = kernels.back()->depth();
+        nGates = kernels.back()->nInstructions();
 
-          // Cleaned this up by calling VQE
-          if (tnqvmLog) {
-            xacc::set_verbose(true);
-          }
-          auto energy = vqeWrapper(observable, kernel, x);
-          if (tnqvmLog) {
-            xacc::set_verbose(false);
-          }
+        // The states are independent: evaluate all their energies at once
+        if (tnqvmLog) {
+          xacc::set_verbose(true);
+        }
+        const auto energies = vqeBatchWrapper(observedStates);
+        if (tnqvmLog) {
+          xacc::set_verbose(false);
+        }
+
+        // loop over states
+        for (int state = 0; state < nStates; state++) {
+
+          // fsToExec stores observed circuits to compute gradients
+          std::vector<std::shared_ptr<CompositeInstruction>> gradFsToExec;
+          const auto &kernel = kernels[state];
+          const auto energy = energies[state];
 
           // Retrieve instructions for gradient, if a pointer of type
           // AlgorithmGradientStrategy is given
@@ -279,58 +288,8 @@ void MC_VQE::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
   logControl(
       "Computing Hamiltonian matrix elements in the interference state basis",
       1);
-  for (int stateA = 0; stateA < nStates - 1; stateA++) {
-    for (int stateB = stateA + 1; stateB < nStates; stateB++) {
-
-      // |+> = (|A> + |B>)/sqrt(2)
-      auto plusInterferenceCircuit = statePreparationCircuit(
-          (CISGateAngles.col(stateA) + CISGateAngles.col(stateB)) /
-          std::sqrt(2));
-      plusInterferenceCircuit->addVariables(entangler->getVariables());
-      for (auto &inst : entangler->getInstructions()) {
-        plusInterferenceCircuit->addInstruction(inst);
-      }
-
-      // vqe call to compute the expectation value of the AEIM Hamiltonian
-      // in the plusInterferenceCircuit with optimal entangler parameters
-      // It does NOT perform any optimization
-      if (tnqvmLog) {
-        xacc::set_verbose(true);
-      }
-      auto plusTerm =
-          vqeWrapper(observable, plusInterferenceCircuit, optimizedEntangler);
-      if (tnqvmLog) {
-        xacc::set_verbose(false);
-      }
-
-      // |-> = (|A> - |B>)/sqrt(2)
-      auto minusInterferenceCircuit = statePreparationCircuit(
-          (CISGateAngles.col(stateA) - CISGateAngles.col(stateB)) /
-          std::sqrt(2));
-      minusInterferenceCircuit->addVariables(entangler->getVariables());
-      for (auto &inst : entangler->getInstructions()) {
-        minusInterferenceCircuit->addInstruction(inst);
-      }
-
-      // vqe call to compute the expectation value of the AEIM Hamiltonian
-      // in the plusInterferenceCircuit with optimal entangler parameters
-      // It does NOT perform any optimization
-      if (tnqvmLog) {
-        xacc::set_verbose(true);
-      }
-      auto minusTerm =
-          vqeWrapper(observable, minusInterferenceCircuit, optimizedEntangler);
-      if (tnqvmLog) {
-        xacc::set_verbose(false);
-      }
-
-      // add the new matrix elements to entangledHamiltonian
-      entangledHamiltonian(stateA, stateB) =
-          (plusTerm - minusTerm) / std::sqrt(2);
-      entangledHamiltonian(stateB, stateA) =
-          entangledHamiltonian(stateA, stateB);
-    }
-  }
+  interferenceMatrixElements(entangledHamiltonian, entangler,
+                             optimizedEntangler);
 
   auto endMC = std::chrono::high_resolution_clock::now();
   auto MCTime =
@@ -388,7 +347,7 @@ MC_VQE::execute(const std::shared_ptr<AcceleratorBuffer> buffer,
     auto kernel = statePreparationCircuit(CISGateAngles.col(state));
     // add entangler variables
     kernel->addVariables(entangler->getVariables());
-    for (auto &inst : entangler->getInstructions()) {
+    for (auto &inst : entangler->getInstructionsView()) {
       kernel->addInstruction(inst); // append entangler gates
     }
   
@@ -425,56 +384,7 @@ MC_VQE::execute(const std::shared_ptr<AcceleratorBuffer> buffer,
   logControl(
       "Computing Hamiltonian matrix elements in the interference state basis",
       1);
-  for (int stateA = 0; stateA < nStates - 1; stateA++) {
-    for (int stateB = stateA + 1; stateB < nStates; stateB++) {
-
-      // |+> = (|A> + |B>)/sqrt(2)
-      auto plusInterferenceCircuit = statePreparationCircuit(
-          (CISGateAngles.col(stateA) + CISGateAngles.col(stateB)) /
-          std::sqrt(2));
-      plusInterferenceCircuit->addVariables(entangler->getVariables());
-      for (auto &inst : entangler->getInstructions()) {
-        plusInterferenceCircuit->addInstruction(inst);
-      }
-
-      // vqe call to compute the expectation value of the AEIM Hamiltonian
-      // in the plusInterferenceCircuit with optimal entangler parameters
-      // It does NOT perform any optimization
-      if (tnqvmLog) {
-        xacc::set_verbose(true);
-      }
-      auto plusTerm = vqeWrapper(observable, plusInterferenceCircuit, x);
-      if (tnqvmLog) {
-        xacc::set_verbose(false);
-      }
-
-      // |-> = (|A> - |B>)/sqrt(2)
-      auto minusInterferenceCircuit = statePreparationCircuit(
-          (CISGateAngles.col(stateA) - CISGateAngles.col(stateB)) /
-          std::sqrt(2));
-      minusInterferenceCircuit->addVariables(entangler->getVariables());
-      for (auto &inst : entangler->getInstructions()) {
-        minusInterferenceCircuit->addInstruction(inst);
-      }
-
-      // vqe call to compute the expectation value of the AEIM Hamiltonian
-      // in the plusInterferenceCircuit with optimal entangler parameters
-      // It does NOT perform any optimization
-      if (tnqvmLog) {
-        xacc::set_verbose(true);
-      }
-      auto minusTerm = vqeWrapper(observable, minusInterferenceCircuit, x);
-      if (tnqvmLog) {
-        xacc::set_verbose(false);
-      }
-
-      // add the new matrix elements to entangledHamiltonian
-      entangledHamiltonian(stateA, stateB) =
-          (plusTerm - minusTerm) / std::sqrt(2);
-      entangledHamiltonian(stateB, stateA) =
-          entangledHamiltonian(stateA, stateB);
-    }
-  }
+  interferenceMatrixElements(entangledHamiltonian, entangler, x);
 
   auto endMC = std::chrono::high_resolution_clock::now();
   auto MCTime =
@@ -950,5 +860,124 @@ double MC_VQE::vqeWrapper(const std::shared_ptr<Observable> observable,
   return vqe->execute(q, x)[0];
 }
 
+std::vector<double>
+MC_VQE::vqeBatchWrapper(const std::vector<ObservedState> &in_states) const {
+
+  std::vector<double> energies(in_states.size(), 0.0);
+  std::vector<std::shared_ptr<CompositeInstruction>> fsToExec;
+  // state index and coefficient of each circuit in fsToExec
+  std::vector<std::pair<std::size_t, double>> circuitTerms;
+  for (std::size_t i = 0; i < in_states.size(); i++) {
+    // same parameter ordering as VQE
+    auto tmp_x = in_states[i].x;
+    std::reverse(tmp_x.begin(), tmp_x.end());
+    auto evaled = in_states[i].kernel->operator()(tmp_x);
+    for (auto &f : in_states[i].observable->observe(evaled)) {
+      const double coeff = std::real(f->getCoefficient());
+      int nFunctionInstructions = 0;
+      if (f->nInstructions() > 0 && f->getInstruction(0)->isComposite()) {
+        nFunctionInstructions =
+            evaled->nInstructions() + f->nInstructions() - 1;
+      } else {
+        nFunctionInstructions = f->nInstructions();
+      }
+
+      if (nFunctionInstructions > evaled->nInstructions()) {
+        // Accelerators name the child buffers after the circuits:
+        // the term names are only unique within a state.
+        f->setName("state" + std::to_string(i) + "_" + f->name());
+        fsToExec.push_back(f);
+        circuitTerms.emplace_back(i, coeff);
+      } else {
+        // identity term
+        energies[i] += coeff;
+      }
+    }
+  }
+
+  if (fsToExec.empty()) {
+    return energies;
+  }
+
+  auto tmpBuffer = xacc::qalloc(nChromophores);
+  accelerator->execute(tmpBuffer, fsToExec);
+  std::unordered_map<std::string, std::shared_ptr<AcceleratorBuffer>>
+      nameToBuffer;
+  for (auto &child : tmpBuffer->getChildren()) {
+    nameToBuffer.emplace(child->name(), child);
+  }
+
+  for (std::size_t k = 0; k < fsToExec.size(); k++) {
+    auto iter = nameToBuffer.find(fsToExec[k]->name());
+    if (iter == nameToBuffer.end()) {
+      xacc::error("MC-VQE: no result for circuit '" + fsToExec[k]->name() +
+                  "'.");
+    }
+    const auto &[state, coeff] = circuitTerms[k];
+    energies[state] += coeff * iter->second->getExpectationValueZ();
+  }
+
+  return energies;
+}
+
+void MC_VQE::interferenceMatrixElements(
+    Eigen::MatrixXd &entangledHamiltonian,
+    const std::shared_ptr<CompositeInstruction> entangler,
+    const std::vector<double> &x) const {
+
+  // interference state preparation followed by the entangler
+  const auto interferenceCircuit = [&](const Eigen::VectorXd &angles) {
+    auto kernel = statePreparationCircuit(angles);
+    kernel->addVariables(entangler->getVariables());
+    for (auto &inst : entangler->getInstructionsView()) {
+      kernel->addInstruction(inst);
+    }
+    return kernel;
+  };
+
+  // expectation values of the AEIM Hamiltonian in the interference states
+  // with the given entangler parameters (it does NOT perform any optimization)
+  std::vector<ObservedState> interferenceStates;
+  for (int stateA = 0; stateA < nStates - 1; stateA++) {
+    for (int stateB = stateA + 1; stateB < nStates; stateB++) {
+      // |+> = (|A> + |B>)/sqrt(2)
+      interferenceStates.push_back(
+          {observable,
+           interferenceCircuit(
+               (CISGateAngles.col(stateA) + CISGateAngles.col(stateB)) /
+               std::sqrt(2)),
+           x});
+      // |-> = (|A> - |B>)/sqrt(2)
+      interferenceStates.push_back(
+          {observable,
+           interferenceCircuit(
+               (CISGateAngles.col(stateA) - CISGateAngles.col(stateB)) /
+               std::sqrt(2)),
+           x});
+    }
+  }
+
+  if (tnqvmLog) {
+    xacc::set_verbose(true);
+  }
+  const auto energies = vqeBatchWrapper(interferenceStates);
+  if (tnqvmLog) {
+    xacc::set_verbose(false);
+  }
+
+  // add the new matrix elements to entangledHamiltonian
+  auto next = energies.begin();
+  for (int stateA = 0; stateA < nStates - 1; stateA++) {
+    for (int stateB = stateA + 1; stateB < nStates; stateB++) {
+      const double plusTerm = *next++;
+      const double minusTerm = *next++;
+      entangledHamiltonian(stateA, stateB) =
+          (plusTerm - minusTerm) / std::sqrt(2);
+      entangledHamiltonian(stateB, stateA) =
+          entangledHamiltonian(stateA, stateB);
+    }
+  }
+}
+
 } // namespace algorithm
 } // namespace xacc
@@ -74,6 +74,27 @@ protected:
                     const std::shared_ptr<CompositeInstruction> kernel,
                     const std::vector<double> x) const;
 
+  // An expectation value to evaluate: <observable> in the state kernel(x)
+  struct ObservedState {
+    std::shared_ptr<Observable> observable;
+    std::shared_ptr<CompositeInstruction> kernel;
+    std::vector<double> x;
+  };
+
+  // Same as vqeWrapper for all the states at once: their observed circuits
+  // are submitted in a single Accelerator execution (hence distributed across
+  // the virtual QPUs of an hpc-virtualization decorated accelerator), and the
+  // expectation values are returned in the order of in_states.
+  std::vector<double>
+  vqeBatchWrapper(const std::vector<ObservedState> &in_states) const;
+
+  // Off-diagonal elements of the Hamiltonian matrix in the MC state basis,
+  // from the interference states (|A> +/- |B>)/sqrt(2), in one batch.
+  void interferenceMatrixElements(
+      Eigen::MatrixXd &entangledHamiltonian,
+      const std::shared_ptr<CompositeInstruction> entangler,
+      const std::vector<double> &x) const;
+
   // controls the level of printing
   int logLevel = 1;
   bool tnqvmLog = false;
@@ -92,6 +113,12 @@ protected:
                    const Eigen::MatrixXd subspaceRotation,
                    const std::vector<double> x);
 
+  // entangler parameter rotations of each state (Eqs. 124-127)
+  std::vector<Eigen::VectorXd>
+  getResponseRotations(const std::shared_ptr<CompositeInstruction> entangler,
+                       const Eigen::MatrixXd &gateAngles,
+                       const std::vector<double> &x) const;
+
   Eigen::VectorXd
   getVQE1PDM(const std::string pauliTerm,
              const std::shared_ptr<CompositeInstruction> entangler,
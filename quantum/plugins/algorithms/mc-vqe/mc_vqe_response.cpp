@@ -18,21 +18,31 @@ MC_VQE::getUnrelaxed1PDM(const std::string pauliTerm,
   Eigen::MatrixXd rotatedEigenstates = Eigen::MatrixXd::Zero(nStates, nStates);
   Eigen::MatrixXd gateAngles = statePreparationAngles(rotatedEigenstates);
 
-  std::vector<Eigen::VectorXd> unrelaxed1PDM;
+  // all the density matrix elements are evaluated in one batch
+  std::vector<ObservedState> observedStates;
   for (int state = 0; state < nStates; state++) {
 
     // prepare interference state and append entangler
     auto kernel = statePreparationCircuit(gateAngles.col(state));
     kernel->addVariables(entangler->getVariables());
-    for (auto &inst : entangler->getInstructions()) {
+    for (auto &inst : entangler->getInstructionsView()) {
       kernel->addInstruction(inst);
     }
 
-    Eigen::VectorXd stateDensityMatrix = Eigen::VectorXd::Zero(nChromophores);
     for (int A = 0; A < nChromophores; A++) {
       auto term = PauliOperator({{A, pauliTerm}});
-      stateDensityMatrix(A) =
-          vqeWrapper(std::make_shared<PauliOperator>(term), kernel, x);
+      observedStates.push_back(
+          {std::make_shared<PauliOperator>(term), kernel, x});
+    }
+  }
+  const auto expVals = vqeBatchWrapper(observedStates);
+
+  std::vector<Eigen::VectorXd> unrelaxed1PDM;
+  auto next = expVals.begin();
+  for (int state = 0; state < nStates; state++) {
+    Eigen::VectorXd stateDensityMatrix = Eigen::VectorXd::Zero(nChromophores);
+    for (int A = 0; A < nChromophores; A++) {
+      stateDensityMatrix(A) = *next++;
     }
 
     unrelaxed1PDM.push_back(stateDensityMatrix);
@@ -62,23 +72,34 @@ MC_VQE::getUnrelaxed2PDM(const std::string pauliTerm,
     }
   }
 
-  std::vector<Eigen::MatrixXd> unrelaxed2PDM;
+  // all the density matrix elements are evaluated in one batch
+  std::vector<ObservedState> observedStates;
   for (int state = 0; state < nStates; state++) {
 
     // prepare interference state and append entangler
     auto kernel = statePreparationCircuit(gateAngles.col(state));
     kernel->addVariables(entangler->getVariables());
-    for (auto &inst : entangler->getInstructions()) {
+    for (auto &inst : entangler->getInstructionsView()) {
       kernel->addInstruction(inst);
     }
 
-    Eigen::VectorXd stateDensityMatrix = Eigen::VectorXd::Zero(nChromophores);
     for (int A = 0; A < nChromophores; A++) {
       for (int B : pairs[A]) {
         auto term = PauliOperator({{A, pauliTerm[0]}, {B, pauliTerm[1]}});
-        // auto term = PauliOperator({{A, "X"}, {B, "Y"}});
-        stateDensityMatrix(A, B) =
-            vqeWrapper(std::make_shared<PauliOperator>(term), kernel, x);
+        observedStates.push_back(
+            {std::make_shared<PauliOperator>(term), kernel, x});
+      }
+    }
+  }
+  const auto expVals = vqeBatchWrapper(observedStates);
+
+  std::vector<Eigen::MatrixXd> unrelaxed2PDM;
+  auto next = expVals.begin();
+  for (int state = 0; state < nStates; state++) {
+    Eigen::VectorXd stateDensityMatrix = Eigen::VectorXd::Zero(nChromophores);
+    for (int A = 0; A < nChromophores; A++) {
+      for (int B : pairs[A]) {
+        stateDensityMatrix(A, B) = *next++;
       }
     }
 
@@ -88,133 +109,165 @@ MC_VQE::getUnrelaxed2PDM(const std::string pauliTerm,
   return unrelaxed2PDM;
 }
 
-Eigen::VectorXd
-MC_VQE::getVQE1PDM(const std::string pauliTerm,
-                   const std::shared_ptr<CompositeInstruction> entangler,
-                   const Eigen::MatrixXd subspaceRotation,
-                   const std::vector<double> x) {
+std::vector<Eigen::VectorXd> MC_VQE::getResponseRotations(
+    const std::shared_ptr<CompositeInstruction> entangler,
+    const Eigen::MatrixXd &gateAngles, const std::vector<double> &x) const {
 
-  Eigen::MatrixXd rotatedEigenstates = Eigen::MatrixXd::Zero(nStates, nStates);
-  Eigen::MatrixXd gateAngles = statePreparationAngles(rotatedEigenstates);
   int nParams = x.size();
-  std::vector<double> tmp_x;
+  const auto shifted = [&x](const std::vector<std::pair<int, double>> shifts) {
+    auto tmp_x = x;
+    for (const auto &[g, shift] : shifts) {
+      tmp_x[g] += shift;
+    }
+    return tmp_x;
+  };
+  const double pi = xacc::constants::pi;
+
+  // all the energies of the gradients and of the Hessian are evaluated in one
+  // batch, then consumed in the same order
+  std::vector<ObservedState> observedStates;
 
-  std::vector<Eigen::VectorXd> gradients;
   // compute gradient for each state energy w.r.t. to entangler parameters
   for (int state = 0; state < nStates; state++) {
 
     // prepare interference state and append entangler
     auto kernel = statePreparationCircuit(gateAngles.col(state));
     kernel->addVariables(entangler->getVariables());
-    for (auto &inst : entangler->getInstructions()) {
+    for (auto &inst : entangler->getInstructionsView()) {
       kernel->addInstruction(inst);
     }
 
     // Eq. 124
-    Eigen::VectorXd stateDensityMatrix = Eigen::VectorXd::Zero(nParams);
     for (int g = 0; g < nParams; g++) {
-      tmp_x = x;
-      tmp_x[g] += xacc::constants::pi / 4.0;
-      stateDensityMatrix(g) = vqeWrapper(observable, kernel, tmp_x);
-
-      tmp_x = x;
-      tmp_x[g] -= xacc::constants::pi / 4.0;
-      stateDensityMatrix(g) -= vqeWrapper(observable, kernel, tmp_x);
+      observedStates.push_back({observable, kernel, shifted({{g, pi / 4.0}})});
+      observedStates.push_back({observable, kernel, shifted({{g, -pi / 4.0}})});
     }
-
-    gradients.push_back(stateDensityMatrix);
   }
 
   // Now compute Hessian
-  Eigen::MatrixXd hessian = Eigen::MatrixXd::Zero(nParams, nParams);
   for (int state = 0; state < nStates; state++) {
 
     // prepare interference state and append entangler
     auto kernel = statePreparationCircuit(CISGateAngles.col(state));
     kernel->addVariables(entangler->getVariables());
-    for (auto &inst : entangler->getInstructions()) {
+    for (auto &inst : entangler->getInstructionsView()) {
       kernel->addInstruction(inst);
     }
 
-    // Eq. 124
-    // diagonal terms
+    // Eq. 125 term #2 is the same for all the diagonal terms
+    observedStates.push_back({observable, kernel, x});
+    // diagonal terms, Eq. 125 terms #1 and #3
     for (int g = 0; g < nParams; g++) {
-
-      // Eq. 125 term #1
-      tmp_x = x;
-      tmp_x[g] += xacc::constants::pi / 2.0;
-      hessian(g, g) += vqeWrapper(observable, kernel, tmp_x);
-
-      // Eq. 125 term #2
-      hessian(g, g) += vqeWrapper(observable, kernel, x);
-
-      // Eq. 125 term #3
-      tmp_x = x;
-      tmp_x[g] -= xacc::constants::pi / 2.0;
-      hessian(g, g) -= vqeWrapper(observable, kernel, tmp_x);
+      observedStates.push_back({observable, kernel, shifted({{g, pi / 2.0}})});
+      observedStates.push_back({observable, kernel, shifted({{g, -pi / 2.0}})});
     }
 
     // off-diagonal terms
-
     for (int g = 1; g < nParams; g++) {
       for (int gp = g; gp < nParams - 1; gp++) {
+        for (double signG : {1.0, -1.0}) {
+          for (double signGp : {1.0, -1.0}) {
+            observedStates.push_back(
+                {observable, kernel,
+                 shifted({{g, signG * pi / 4.0}, {gp, signGp * pi / 4.0}})});
+          }
+        }
+      }
+    }
+  }
 
-        tmp_x = x;
-        tmp_x[g] += xacc::constants::pi / 4.0;
-        tmp_x[gp] += xacc::constants::pi / 4.0;
-        hessian(g, gp) += vqeWrapper(observable, kernel, tmp_x);
+  const auto energies = vqeBatchWrapper(observedStates);
+  auto next = energies.begin();
 
-        tmp_x = x;
-        tmp_x[g] += xacc::constants::pi / 4.0;
-        tmp_x[gp] -= xacc::constants::pi / 4.0;
-        hessian(g, gp) -= vqeWrapper(observable, kernel, tmp_x);
+  std::vector<Eigen::VectorXd> gradients;
+  for (int state = 0; state < nStates; state++) {
+    Eigen::VectorXd stateDensityMatrix = Eigen::VectorXd::Zero(nParams);
+    for (int g = 0; g < nParams; g++) {
+      stateDensityMatrix(g) = *next++;
+      stateDensityMatrix(g) -= *next++;
+    }
 
-        tmp_x = x;
-        tmp_x[g] -= xacc::constants::pi / 4.0;
-        tmp_x[gp] += xacc::constants::pi / 4.0;
-        hessian(g, gp) -= vqeWrapper(observable, kernel, tmp_x);
+    gradients.push_back(stateDensityMatrix);
+  }
 
-        tmp_x = x;
-        tmp_x[g] -= xacc::constants::pi / 4.0;
-        tmp_x[gp] -= xacc::constants::pi / 4.0;
-        hessian(g, gp) += vqeWrapper(observable, kernel, tmp_x);
+  Eigen::MatrixXd hessian = Eigen::MatrixXd::Zero(nParams, nParams);
+  for (int state = 0; state < nStates; state++) {
+    const double energy = *next++;
+    for (int g = 0; g < nParams; g++) {
+      hessian(g, g) += *next++;
+      hessian(g, g) += energy;
+      hessian(g, g) -= *next++;
+    }
+
+    for (int g = 1; g < nParams; g++) {
+      for (int gp = g; gp < nParams - 1; gp++) {
+        hessian(g, gp) += *next++;
+        hessian(g, gp) -= *next++;
+        hessian(g, gp) -= *next++;
+        hessian(g, gp) += *next++;
       }
     }
   }
 
   hessian /= nStates;
 
+  std::vector<Eigen::VectorXd> rotations;
+  for (int state = 0; state < nStates; state++) {
+    rotations.push_back(hessian.colPivHouseholderQr().solve(-gradients[state]));
+  }
+
+  return rotations;
+}
+
+Eigen::VectorXd
+MC_VQE::getVQE1PDM(const std::string pauliTerm,
+                   const std::shared_ptr<CompositeInstruction> entangler,
+                   const Eigen::MatrixXd subspaceRotation,
+                   const std::vector<double> x) {
+
+  Eigen::MatrixXd rotatedEigenstates = Eigen::MatrixXd::Zero(nStates, nStates);
+  Eigen::MatrixXd gateAngles = statePreparationAngles(rotatedEigenstates);
+  int nParams = x.size();
+  std::vector<double> tmp_x;
+
+  const auto theta_g = getResponseRotations(entangler, gateAngles, x);
+
   // Eq. 128
-  Eigen::VectorXd vqe1PDM = Eigen::VectorXd::Zero(nChromophores);
+  std::vector<ObservedState> observedStates;
   for (int A = 0; A < nChromophores; A++) {
 
-    auto term = PauliOperator({{A, pauliTerm}});
+    auto term = std::make_shared<PauliOperator>(
+        PauliOperator({{A, pauliTerm}}));
 
     for (int state = 0; state < nStates; state++) {
 
       // prepare interference state and append entangler
       auto kernel = statePreparationCircuit(CISGateAngles.col(state));
       kernel->addVariables(entangler->getVariables());
-      for (auto &inst : entangler->getInstructions()) {
+      for (auto &inst : entangler->getInstructionsView()) {
         kernel->addInstruction(inst);
       }
 
-      Eigen::VectorXd theta_g =
-          hessian.colPivHouseholderQr().solve(-gradients[state]);
-
       for (int g = 0; g < nParams; g++) {
-
         tmp_x = x;
         tmp_x[g] += xacc::constants::pi / 4.0;
-        vqe1PDM(A) +=
-            theta_g(g) *
-            vqeWrapper(std::make_shared<PauliOperator>(term), kernel, tmp_x);
+        observedStates.push_back({term, kernel, tmp_x});
 
         tmp_x = x;
         tmp_x[g] -= xacc::constants::pi / 4.0;
-        vqe1PDM(A) -=
-            theta_g(g) *
-            vqeWrapper(std::make_shared<PauliOperator>(term), kernel, tmp_x);
+        observedStates.push_back({term, kernel, tmp_x});
+      }
+    }
+  }
+  const auto expVals = vqeBatchWrapper(observedStates);
+
+  Eigen::VectorXd vqe1PDM = Eigen::VectorXd::Zero(nChromophores);
+  auto next = expVals.begin();
+  for (int A = 0; A < nChromophores; A++) {
+    for (int state = 0; state < nStates; state++) {
+      for (int g = 0; g < nParams; g++) {
+        vqe1PDM(A) += theta_g[state](g) * *next++;
+        vqe1PDM(A) -= theta_g[state](g) * *next++;
       }
     }
   }
@@ -247,124 +300,48 @@ MC_VQE::getVQE2PDM(const std::string pauliTerm,
     }
   }
 
-  std::vector<Eigen::VectorXd> gradients;
-  // compute gradient for each state energy w.r.t. to entangler parameters
-  for (int state = 0; state < nStates; state++) {
-
-    // prepare interference state and append entangler
-    auto kernel = statePreparationCircuit(gateAngles.col(state));
-    kernel->addVariables(entangler->getVariables());
-    for (auto &inst : entangler->getInstructions()) {
-      kernel->addInstruction(inst);
-    }
-
-    // Eq. 124
-    Eigen::VectorXd stateDensityMatrix = Eigen::VectorXd::Zero(nParams);
-    for (int g = 0; g < nParams; g++) {
-      tmp_x = x;
-      tmp_x[g] += xacc::constants::pi / 4.0;
-      stateDensityMatrix(g) = vqeWrapper(observable, kernel, tmp_x);
-
-      tmp_x = x;
-      tmp_x[g] -= xacc::constants::pi / 4.0;
-      stateDensityMatrix(g) -= vqeWrapper(observable, kernel, tmp_x);
-    }
-
-    gradients.push_back(stateDensityMatrix);
-  }
-
-  // Now compute Hessian
-  Eigen::MatrixXd hessian = Eigen::MatrixXd::Zero(nParams, nParams);
-  for (int state = 0; state < nStates; state++) {
-
-    // prepare interference state and append entangler
-    auto kernel = statePreparationCircuit(CISGateAngles.col(state));
-    kernel->addVariables(entangler->getVariables());
-    for (auto &inst : entangler->getInstructions()) {
-      kernel->addInstruction(inst);
-    }
-
-    // Eq. 124
-    // diagonal terms
-    for (int g = 0; g < nParams; g++) {
-
-      // Eq. 125 term #1
-      tmp_x = x;
-      tmp_x[g] += xacc::constants::pi / 2.0;
-      hessian(g, g) += vqeWrapper(observable, kernel, tmp_x);
-
-      // Eq. 125 term #2
-      hessian(g, g) += vqeWrapper(observable, kernel, x);
-
-      // Eq. 125 term #3
-      tmp_x = x;
-      tmp_x[g] -= xacc::constants::pi / 2.0;
-      hessian(g, g) -= vqeWrapper(observable, kernel, tmp_x);
-    }
-
-    // off-diagonal terms
-
-    for (int g = 1; g < nParams; g++) {
-      for (int gp = g; gp < nParams - 1; gp++) {
-
-        tmp_x = x;
-        tmp_x[g] += xacc::constants::pi / 4.0;
-        tmp_x[gp] += xacc::constants::pi / 4.0;
-        hessian(g, gp) += vqeWrapper(observable, kernel, tmp_x);
-
-        tmp_x = x;
-        tmp_x[g] += xacc::constants::pi / 4.0;
-        tmp_x[gp] -= xacc::constants::pi / 4.0;
-        hessian(g, gp) -= vqeWrapper(observable, kernel, tmp_x);
-
-        tmp_x = x;
-        tmp_x[g] -= xacc::constants::pi / 4.0;
-        tmp_x[gp] += xacc::constants::pi / 4.0;
-        hessian(g, gp) -= vqeWrapper(observable, kernel, tmp_x);
-
-        tmp_x = x;
-        tmp_x[g] -= xacc::constants::pi / 4.0;
-        tmp_x[gp] -= xacc::constants::pi / 4.0;
-        hessian(g, gp) += vqeWrapper(observable, kernel, tmp_x);
-      }
-    }
-  }
-
-  hessian /= nStates;
+  const auto theta_g = getResponseRotations(entangler, gateAngles, x);
 
   // Eq. 128
-  Eigen::VectorXd vqe1PDM = Eigen::VectorXd::Zero(nChromophores);
+  std::vector<ObservedState> observedStates;
   for (int A = 0; A < nChromophores; A++) {
 
     for (int B : pairs[A]) {
 
-      auto term = PauliOperator({{A, pauliTerm[0]}, {B, pauliTerm[1]}});
+      auto term = std::make_shared<PauliOperator>(
+          PauliOperator({{A, pauliTerm[0]}, {B, pauliTerm[1]}}));
 
       for (int state = 0; state < nStates; state++) {
 
         // prepare interference state and append entangler
         auto kernel = statePreparationCircuit(CISGateAngles.col(state));
         kernel->addVariables(entangler->getVariables());
-        for (auto &inst : entangler->getInstructions()) {
+        for (auto &inst : entangler->getInstructionsView()) {
           kernel->addInstruction(inst);
         }
 
-        Eigen::VectorXd theta_g =
-            hessian.colPivHouseholderQr().solve(-gradients[state]);
-
         for (int g = 0; g < nParams; g++) {
-
           tmp_x = x;
           tmp_x[g] += xacc::constants::pi / 4.0;
-          vqe1PDM(A) +=
-              theta_g(g) *
-              vqeWrapper(std::make_shared<PauliOperator>(term), kernel, tmp_x);
+          observedStates.push_back({term, kernel, tmp_x});
 
           tmp_x = x;
           tmp_x[g] -= xacc::constants::pi / 4.0;
-          vqe1PDM(A) -=
-              theta_g(g) *
-              vqeWrapper(std::make_shared<PauliOperator>(term), kernel, tmp_x);
+          observedStates.push_back({term, kernel, tmp_x});
+        }
+      }
+    }
+  }
+  const auto expVals = vqeBatchWrapper(observedStates);
+
+  Eigen::VectorXd vqe1PDM = Eigen::VectorXd::Zero(nChromophores);
+  auto next = expVals.begin();
+  for (int A = 0; A < nChromophores; A++) {
+    for (int B : pairs[A]) {
+      for (int state = 0; state < nStates; state++) {
+        for (int g = 0; g < nParams; g++) {
+          vqe1PDM(A) += theta_g[state](g) * *next++;
+          vqe1PDM(A) -= theta_g[state](g) * *next++;
         }
       }
     }
@@ -111,9 +111,10 @@ void DDCL::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
           assert(circuits.size() == 1);
         }
 
-        // Execute!
+        // Execute! The shifted circuits all share the gates before their
+        // shifted one with the loss circuit.
         auto tmpBuffer = xacc::qalloc(buffer->size());
-        accelerator->execute(tmpBuffer, circuits);
+        accelerator->executeWithPrefixSharing(tmpBuffer, circuits);
         auto buffers = tmpBuffer->getChildren();
 
         for (auto b : buffers) {
@@ -21,6 +21,31 @@ namespace algorithm {
 using Circuit = std::shared_ptr<CompositeInstruction>;
 using Counts = std::map<std::string, int>;
 
+// Probability distribution of the counts, indexed by the bit string read
+// as a binary integer (first character most significant). Bit strings
+// beyond size are dropped.
+inline std::vector<double> toDistribution(const Counts &counts,
+                                          std::size_t size) {
+  std::vector<double> dist(size, 0.0);
+  int shots = 0;
+  for (auto &[bitString, count] : counts) {
+    shots += count;
+  }
+  if (shots == 0) {
+    return dist;
+  }
+  for (auto &[bitString, count] : counts) {
+    std::size_t idx = 0;
+    for (auto c : bitString) {
+      idx = (idx << 1) | (c == '1');
+    }
+    if (idx < size) {
+      dist[idx] = (double)count / shots;
+    }
+  }
+  return dist;
+}
+
 class LossStrategy : public Identifiable {
 public:
   virtual std::pair<double, std::vector<double>>
@@ -37,17 +37,8 @@ protected:
 public:
   std::pair<double, std::vector<double>>
   compute(Counts &counts, const std::vector<double> &target, const HeterogeneousMap& = {}) override {
-    int shots = 0;
-    for (auto &x : counts) {
-      shots += x.second;
-    }
-
     // Compute the probability distribution
-    std::vector<double> q(target.size()); // all zeros
-    for (auto &x : counts) {
-      int idx = std::stoi(x.first, nullptr, 2);
-      q[idx] = (double)x.second / shots;
-    }
+    auto q = toDistribution(counts, target.size());
 
     // get M=1/2(P+Q)
     std::vector<double> m(target.size());
@@ -112,25 +103,12 @@ public:
                const std::vector<double> &target_dist) override {
     assert(2 * grad.size() == results.size());
 
-    // Get the number of shosts
-    int shots = 0;
-    for (auto &x : results[0]->getMeasurementCounts()) {
-      shots += x.second;
-    }
-
     // Create q+ and q- vectors
     int counter = 0;
     std::vector<std::vector<double>> qplus_theta, qminus_theta;
     for (int i = 0; i < results.size(); i += 2) {
-      std::vector<double> qp(q_dist.size()), qm(q_dist.size());
-      for (auto &x : results[i]->getMeasurementCounts()) {
-        int idx = std::stoi(x.first, nullptr, 2);
-        qp[idx] = (double)x.second / shots;
-      }
-      for (auto &x : results[i + 1]->getMeasurementCounts()) {
-        int idx = std::stoi(x.first, nullptr, 2);
-        qm[idx] = (double)x.second / shots;
-      }
+      auto qp = toDistribution(results[i]->getMeasurementCounts(), q_dist.size());
+      auto qm = toDistribution(results[i + 1]->getMeasurementCounts(), q_dist.size());
 
       std::vector<double> shiftedp = currentParameterSet;
       std::vector<double> shiftedm = currentParameterSet;
@@ -158,17 +136,26 @@ public:
       counter++;
     }
 
-    for (int i = 0; i < grad.size(); i++) {
-      double sum = 0.0;
-      for (int x = 0; x < q_dist.size(); x++) {
-        if (std::fabs(q_dist[x]) > 1e-12) {
-          sum += std::log(q_dist[x] / (0.5 * (target_dist[x] + q_dist[x]))) *
-                 0.5 * (qplus_theta[i][x] - qminus_theta[i][x]);
-        }
+    // The log ratios are the same for all the parameters
+    std::vector<double> logRatios(q_dist.size(), 0.0);
+    for (int x = 0; x < q_dist.size(); x++) {
+      if (std::fabs(q_dist[x]) > 1e-12) {
+        logRatios[x] =
+            std::log(q_dist[x] / (0.5 * (target_dist[x] + q_dist[x])));
       }
-      sum *= 0.5;
-      grad[i] = sum;
     }
+    xacc::getTaskScheduler()->parallelFor(
+        0, grad.size(), [&](std::size_t beginIdx, std::size_t endIdx) {
+          for (auto i = beginIdx; i < endIdx; i++) {
+            double sum = 0.0;
+            for (int x = 0; x < q_dist.size(); x++) {
+              sum += logRatios[x] * 0.5 *
+                     (qplus_theta[i][x] - qminus_theta[i][x]);
+            }
+            sum *= 0.5;
+            grad[i] = sum;
+          }
+        });
 
     return;
   }
@@ -16,85 +16,66 @@
 #include "ddcl.hpp"
 #include "xacc.hpp"
 #include <cassert>
+#include <cmath>
 #include <set>
-#include <Eigen/Dense>
 #include "InstructionIterator.hpp"
 
 namespace xacc {
 namespace algorithm {
-
-class MMDLossStrategy : public LossStrategy {
-protected:
-  // Helper functions
-  Eigen::MatrixXd mix_rbf_kernel(std::vector<int> x,std::vector<int> y,
-                                 std::vector<double> sigma_list, int num_bit){
-    //it's always the case that x = y = [0, 1, ..., pow(2, num_bit)-1];
-    std::vector<int> temp_x(x.size());
-    std::vector<int> temp_y(y.size());
-    Eigen::MatrixXd dx2 = Eigen::MatrixXd::Zero(x.size(), x.size());
-    for(int i = 0; i < num_bit; i++){
-      for(int j = 0; j < x.size(); j++){
-        temp_x[j] = (x[j]>>i)&1;
-        temp_y[j] = (y[j] >>i)&1;
-      }
-      for(int k = 0; k < x.size(); k++){
-        for(int l = 0; l < x.size(); l++){
-          dx2(k,l) += (temp_x[k] != temp_y[l]);
-        }
+namespace mmd {
+// In-place (unnormalized) Walsh-Hadamard transform, size a power of 2.
+inline void walshHadamard(std::vector<double> &io_vec) {
+  for (std::size_t h = 1; h < io_vec.size(); h <<= 1) {
+    for (std::size_t block = 0; block < io_vec.size(); block += 2 * h) {
+      for (std::size_t i = block; i < block + h; ++i) {
+        const double a = io_vec[i], b = io_vec[i + h];
+        io_vec[i] = a + b;
+        io_vec[i + h] = a - b;
       }
-
     }
-    return _mix_rbf_kernel_d(dx2, sigma_list);
-
   }
-
-
-  Eigen::MatrixXd _mix_rbf_kernel_d(Eigen::MatrixXd dx2, std::vector<double> sigma_list){
-    Eigen::MatrixXd K = Eigen::MatrixXd::Zero(dx2.rows(), dx2.cols());
-      Eigen::MatrixXd _dx2 = dx2;
-      for(auto &sigma : sigma_list){
-        double gamma = 1.0/(2*sigma);
-        for(int i = 0; i < dx2.rows(); i++){
-          for(int j = 0; j < dx2.cols(); j++){
-              _dx2(i,j) = std::exp(-gamma*dx2(i,j));
-          }
-        }
-        K += _dx2;
-      }
-      return K;
+}
+
+// The mixed RBF kernel K(x, y) = sum_sigma exp(-|x ^ y| / (2 sigma)) over
+// the num_bit bit strings only depends on x ^ y, so it is diagonal in the
+// Walsh basis: K = H diag(F) H / 2^n, its eigenvalue for s being
+// sum_sigma (1 + exp(-gamma))^(n - |s|) (1 - exp(-gamma))^|s|.
+inline std::vector<double> rbfKernelSpectrum(const std::vector<double> &sigma_list,
+                                             int num_bit) {
+  std::vector<double> spectrum(1ULL << num_bit, 0.0);
+  for (auto &sigma : sigma_list) {
+    const double decay = std::exp(-1.0 / (2 * sigma));
+    std::vector<double> byWeight(num_bit + 1);
+    for (int w = 0; w <= num_bit; w++) {
+      byWeight[w] =
+          std::pow(1.0 + decay, num_bit - w) * std::pow(1.0 - decay, w);
+    }
+    for (std::size_t s = 0; s < spectrum.size(); s++) {
+      spectrum[s] += byWeight[__builtin_popcountll(s)];
+    }
   }
-
-  double kernel_expect(Eigen::MatrixXd K,
-                       std::vector<double> px,
-                       std::vector<double>  py){
-    int len = px.size();
-    //This takes px and py and turns them into eigen::Vector objects
-    Eigen::VectorXd P = Eigen::Map<Eigen::VectorXd, Eigen::Unaligned>(px.data(), px.size());
-    Eigen::VectorXd Q = Eigen::Map<Eigen::VectorXd, Eigen::Unaligned>(py.data(), py.size());
-
-    auto temp = K*Q;
-    double expectation = P.dot(temp);
-
-
-    return expectation;
+  return spectrum;
+}
+
+// p^T K q from the Walsh transforms of p and q, in O(2^n).
+inline double kernelExpect(const std::vector<double> &spectrum,
+                           const std::vector<double> &hat_p,
+                           const std::vector<double> &hat_q) {
+  double expectation = 0.0;
+  for (std::size_t s = 0; s < spectrum.size(); s++) {
+    expectation += spectrum[s] * hat_p[s] * hat_q[s];
   }
+  return expectation / spectrum.size();
+}
+} // namespace mmd
+
 
+class MMDLossStrategy : public LossStrategy {
 public:
   std::pair<double, std::vector<double>>
   compute(Counts &counts, const std::vector<double> &target, const HeterogeneousMap& = {}) override {
-    int shots = 0;
-    for (auto &x : counts) {
-      shots += x.second;
-    }
-
-
     // Compute the probability distribution
-    std::vector<double> q(target.size()); // all zeros
-    for (auto &x : counts) {
-      int idx = std::stoi(x.first, nullptr, 2);
-      q[idx] = (double)x.second / shots;
-    }
-
+    auto q = toDistribution(counts, target.size());
 
     std::vector<double> pxy(q.size());
     for(int i = 0; i < q.size(); i++)
@@ -102,21 +83,17 @@ public:
         pxy[i] = std::abs(target[i] - q[i]);
       }
 
-
     //worried about edge cases, anywhere in here where I can access this information
     //without type instability
     ///Also how can I allow sigma_list to be passed as parameters into the
     //loss?
     int num_bit = (int)log2(target.size());
 
-    std::vector<int> basis(pow(2,num_bit));
-    for(int i = 0; i < pow(2,num_bit); i++){
-      basis[i] = i;
-    }
-
     std::vector<double> sigma_list = {0.25};
-    Eigen::MatrixXd K = mix_rbf_kernel(basis, basis, sigma_list, num_bit);
-    auto mmd = kernel_expect(K, pxy, pxy);
+    // The kernel is never formed: O(n 2^n) instead of O(4^n)
+    const auto spectrum = mmd::rbfKernelSpectrum(sigma_list, num_bit);
+    mmd::walshHadamard(pxy);
+    auto mmd = mmd::kernelExpect(spectrum, pxy, pxy);
 
     return std::make_pair(mmd, q);
   }
@@ -141,56 +118,6 @@ public:
   protected:
     std::vector<double> currentParameterSet;
 
-    double kernel_expect(Eigen::MatrixXd K,
-                         std::vector<double> px,
-                         std::vector<double>  py){
-      int len = px.size();
-      //This takes px and py and turns them into eigen::Vector objects
-      //YOU_CALLED_A_FIXED_SIZE_METHOD_ON_A_DYNAMIC_SIZE_MATRIX
-      Eigen::VectorXd P = Eigen::Map<Eigen::VectorXd, Eigen::Unaligned>(px.data(), px.size());
-      Eigen::VectorXd Q = Eigen::Map<Eigen::VectorXd, Eigen::Unaligned>(py.data(), py.size());
-
-      double expectation = P.dot(K*Q);
-
-
-      return expectation;
-    }
-
-    Eigen::MatrixXd mix_rbf_kernel(std::vector<int> x,std::vector<int> y,
-                                   std::vector<double> sigma_list, int num_bit){
-      //it's always the case that x = y = [0, 1, ..., pow(2, num_bit)-1];
-      std::vector<int> temp_x(x.size());
-      std::vector<int> temp_y(y.size());
-      Eigen::MatrixXd dx2 = Eigen::MatrixXd::Zero(x.size(), x.size());
-      for(int i = 0; i < num_bit; i++){
-        for(int j = 0; j < x.size(); j++){
-            temp_x[j] = (x[j]>>i)&1;
-            temp_y[j] = (y[j] >>i)&1;
-        }
-        for(int k = 0; k < x.size(); k++){
-          for(int l = 0; l < x.size(); l++){
-            dx2(k,l) += (temp_x[k] != temp_y[l]);
-          }
-        }
-      }
-        return _mix_rbf_kernel_d(dx2, sigma_list);
-    }
-
-    Eigen::MatrixXd _mix_rbf_kernel_d(Eigen::MatrixXd dx2, std::vector<double> sigma_list){
-      Eigen::MatrixXd K = Eigen::MatrixXd::Zero(dx2.rows(), dx2.cols());
-      Eigen::MatrixXd _dx2 = dx2;
-      for(auto &sigma : sigma_list){
-        double gamma = 1.0/(2*sigma);
-          for(int i = 0; i < dx2.rows(); i++){
-            for(int j = 0; j < dx2.cols(); j++){
-              _dx2(i,j) = std::exp(-gamma*dx2(i,j));
-            }
-          }
-          K += _dx2;
-      }
-      return K;
-    }
-
   public:
     std::vector<Circuit>
     getCircuitExecutions(Circuit circuit, const std::vector<double> &x) override {
@@ -232,26 +159,13 @@ public:
                  const std::vector<double> &target_dist) override {
       assert(2*grad.size() == results.size());
 
-      //Get the number of shots
-      int shots = 0;
-      for (auto &x : results[0]->getMeasurementCounts()) {
-        shots += x.second;
-      }
-
       //q+ and q- vectors
       int counter = 0;
       std::vector<std::vector<double>> qplus_theta, qminus_theta;
       for (int i = 0; i < results.size(); i += 2) {
 
-        std::vector<double> qp(q_dist.size()), qm(q_dist.size());
-        for (auto &x : results[i]->getMeasurementCounts()) {
-          int idx = std::stoi(x.first, nullptr, 2);
-          qp[idx] = (double)x.second / shots;
-        }
-        for (auto &x : results[i + 1]->getMeasurementCounts()) {
-          int idx = std::stoi(x.first, nullptr, 2);
-          qm[idx] = (double)x.second / shots;
-        }
+        auto qp = toDistribution(results[i]->getMeasurementCounts(), q_dist.size());
+        auto qm = toDistribution(results[i + 1]->getMeasurementCounts(), q_dist.size());
         std::vector<double> shiftedp = currentParameterSet;
         std::vector<double> shiftedm = currentParameterSet;
         auto xplus = currentParameterSet[counter] + xacc::constants::pi / 2;
@@ -282,24 +196,24 @@ public:
 
       std::vector<double> sigma_list = {0.1};
       int num_bit = (int) log2(q_dist.size());
-      std::vector<int> basis(pow(2,num_bit));
-      for(int i = 0; i < pow(2,num_bit); i++){
-        basis[i] = i;
-      }
-      Eigen::MatrixXd K = mix_rbf_kernel(basis, basis, sigma_list, num_bit);
-      //compute gradient vector
-      std::vector<double> grad_pos(counter);
-      std::vector<double> grad_neg(counter);
-      std::vector<double> grad_pos_targ(counter);
-      std::vector<double> grad_neg_targ(counter);
-
-      for(int i = 0; i < counter; i++){
-        grad_pos[i] = kernel_expect(K, qplus_theta[i], q_dist);
-        grad_neg[i] = kernel_expect(K, qminus_theta[i], q_dist);
-        grad_pos_targ[i] = kernel_expect(K, qplus_theta[i], target_dist);
-        grad_neg_targ[i] = kernel_expect(K, qminus_theta[i], target_dist);
-        grad[i] = grad_pos[i]-grad_pos_targ[i]-grad_neg[i]+grad_neg_targ[i];
+      const auto spectrum = mmd::rbfKernelSpectrum(sigma_list, num_bit);
+      // grad = (q+ - q-)^T K (q - target): one transform per parameter
+      std::vector<double> hat_diff(q_dist.size());
+      for (int x = 0; x < q_dist.size(); x++) {
+        hat_diff[x] = q_dist[x] - target_dist[x];
       }
+      mmd::walshHadamard(hat_diff);
+      xacc::getTaskScheduler()->parallelFor(
+          0, counter, [&](std::size_t beginIdx, std::size_t endIdx) {
+            for (auto i = beginIdx; i < endIdx; i++) {
+              std::vector<double> shift(q_dist.size());
+              for (int x = 0; x < q_dist.size(); x++) {
+                shift[x] = qplus_theta[i][x] - qminus_theta[i][x];
+              }
+              mmd::walshHadamard(shift);
+              grad[i] = mmd::kernelExpect(spectrum, shift, hat_diff);
+            }
+          });
       return;
     }
     const std::string name() const override { return "mmd-parameter-shift"; }
@@ -16,6 +16,7 @@
 #include "xacc_service.hpp"
 #include "Optimizer.hpp"
 #include "Algorithm.hpp"
+#include "ddcl.hpp"
 
 using namespace xacc;
 const std::string src =
@@ -139,16 +140,34 @@ TEST(DDCLTester, checkMMDSimpleWithGradient) {
   }
 }
 
+TEST(DDCLTester, checkMMDKernel) {
+  // Against the dense 4^n kernel sum
+  auto mmd = xacc::getService<xacc::algorithm::LossStrategy>("mmd");
+  xacc::algorithm::Counts counts{{"000", 3}, {"011", 1}, {"101", 2}, {"111", 4}};
+  const std::vector<double> target(8, 1.0 / 8);
+  const auto [loss, q] = mmd->compute(counts, target);
+  EXPECT_NEAR(q[3], 0.1, 1e-12);
+  EXPECT_NEAR(q[5], 0.2, 1e-12);
+
+  double expected = 0.0;
+  for (int x = 0; x < 8; x++) {
+    for (int y = 0; y < 8; y++) {
+      expected += std::abs(target[x] - q[x]) * std::abs(target[y] - q[y]) *
+                  std::exp(-__builtin_popcount(x ^ y) / (2 * 0.25));
+    }
+  }
+  EXPECT_NEAR(loss, expected, 1e-12);
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize(argc, argv);
-  int ret = 0;
   if (xacc::hasAccelerator("local-ibm")) {
     auto acc = xacc::getAccelerator("aer");
     auto compiler = xacc::getCompiler("xasm");
     auto ir = compiler->compile(src, acc);
-    ::testing::InitGoogleTest(&argc, argv);
-    ret = RUN_ALL_TESTS();
   }
+  ::testing::InitGoogleTest(&argc, argv);
+  int ret = RUN_ALL_TESTS();
   xacc::Finalize();
   return ret;
 }
@@ -36,36 +36,14 @@ const std::string name() const override { return "data-exp"; }
           Eigen::VectorXd &h, HeterogeneousMap options = {}) override {
     int batch_size = features.rows();
 
-    // features is bs x n_v
-    // w is n_v x n_v
-    // h is 1 x n_v
-    // features * w + h means add h[0,col] to features*x[I, col]
-    Eigen::MatrixXd tmp = features * w;
-    for (int col = 0; col < tmp.cols(); col++) {
-      for (int row = 0; row < tmp.rows(); row++) {
-        tmp(row, col) += h(col);
-      }
-    }
-
- for (int col = 0; col < tmp.cols(); col++) {
-      for (int row = 0; row < tmp.rows(); row++) {
-        tmp(row, col) = 1./(1.+std::exp(-tmp(row,col)));
-      }
-    }
-
-    Eigen::MatrixXd h_probs = tmp;
-    // h_probs has to be bs x n_v
+    // features is bs x n_v, w is n_v x n_h and h is n_h:
+    // h_probs = sigmoid(features * w + h), bs x n_h
+    Eigen::MatrixXd h_probs = sigmoidAffine(features, w, h);
 
     Eigen::MatrixXd w_expectation =
         (features.transpose() * h_probs) / batch_size;
-
-    Eigen::VectorXd v_expectation = Eigen::VectorXd::Zero(v.size());
-    Eigen::VectorXd h_expectation = Eigen::VectorXd::Zero(v.size());
-
-    for (int i = 0; i < features.rows(); i++) {
-      v_expectation(i) = features.row(i).sum() / features.row(i).size();
-      h_expectation(i) = h_probs.row(i).sum() / h_probs.row(i).size();
-    }
+    Eigen::VectorXd v_expectation = features.colwise().mean().transpose();
+    Eigen::VectorXd h_expectation = h_probs.colwise().mean().transpose();
 
     return std::make_tuple(w_expectation, v_expectation, h_expectation);
   }
@@ -18,45 +18,56 @@
 namespace xacc {
 namespace algorithm {
 
+// Model expectations from k Gibbs steps of a block of chains, all chains
+// being updated at once with matrix products. The chains start from the
+// batch (CD-k) or, with "persistent", from where the previous call left
+// them (PCD).
 class ContrastiveDivergenceExpectationStrategy : public ExpectationStrategy {
 protected:
+  Eigen::MatrixXd chains;
+  std::mt19937_64 rng{std::random_device()()};
 
-  Eigen::VectorXd sample(Eigen::VectorXd& probs) {
-      Eigen::VectorXd tmp = probs + Eigen::VectorXd::Random(probs.size());
-      Eigen::VectorXd tmp2 = tmp.array().floor();
-      return tmp2;
-  }
 public:
-const std::string name() const override { return "cd"; }
+  const std::string name() const override { return "cd"; }
   const std::string description() const override { return ""; }
   std::tuple<Eigen::MatrixXd, Eigen::VectorXd, Eigen::VectorXd>
   compute(Eigen::MatrixXd &features, Eigen::MatrixXd &w, Eigen::VectorXd &v,
           Eigen::VectorXd &h, HeterogeneousMap options = {}) override {
-
-    Eigen::VectorXd exp_h = options.get<Eigen::VectorXd>("dataexp_h");
-    Eigen::VectorXd h_sample = sample(exp_h);
-
-    Eigen::MatrixXd tmp = h_sample * w.transpose();
-     for (int col = 0; col < tmp.cols(); col++) {
-      for (int row = 0; row < tmp.rows(); row++) {
-        tmp(row, col) += v(col);
+    int k = options.keyExists<int>("cd-k") ? options.get<int>("cd-k") : 1;
+    bool persistent = options.keyExists<bool>("persistent") &&
+                      options.get<bool>("persistent");
+    if (options.keyExists<bool>("reset-chains") &&
+        options.get<bool>("reset-chains")) {
+      chains.resize(0, 0);
+      if (options.keyExists<int>("seed")) {
+        rng.seed(options.get<int>("seed"));
       }
     }
 
-    // tmp.unaryExpr([](double& x) {return 1./(1.+std::exp(-x));});
-    
-    // Eigen::MatrixXd h_probs = tmp.array().exp();//unaryExpr(s);
-    // h_probs has to be bs x n_v
-
-    Eigen::MatrixXd w_expectation;
+    if (!persistent || chains.cols() != w.rows()) {
+      if (persistent && options.keyExists<int>("n-chains")) {
+        // Random binary visibles
+        chains = sampleBernoulli(
+            Eigen::MatrixXd::Constant(options.get<int>("n-chains"), w.rows(),
+                                      0.5),
+            rng);
+      } else {
+        chains = features;
+      }
+    }
 
-    Eigen::VectorXd v_expectation = Eigen::VectorXd::Zero(v.size());
-    Eigen::VectorXd h_expectation = Eigen::VectorXd::Zero(v.size());
+    // chains is n_chains x n_v, h_probs n_chains x n_h
+    Eigen::MatrixXd h_probs = sigmoidAffine(chains, w, h);
+    for (int step = 0; step < k; step++) {
+      Eigen::MatrixXd h_sample = sampleBernoulli(h_probs, rng);
+      chains = sampleBernoulli(sigmoidAffine(h_sample, w.transpose(), v), rng);
+      h_probs = sigmoidAffine(chains, w, h);
+    }
 
-    // for (int i = 0; i < features.rows(); i++) {
-    //   v_expectation(i) = features.row(i).sum() / features.row(i).size();
-    //   h_expectation(i) = h_probs.row(i).sum() / h_probs.row(i).size();
-    // }
+    const double nChains = chains.rows();
+    Eigen::MatrixXd w_expectation = (chains.transpose() * h_probs) / nChains;
+    Eigen::VectorXd v_expectation = chains.colwise().mean().transpose();
+    Eigen::VectorXd h_expectation = h_probs.colwise().mean().transpose();
 
     return std::make_tuple(w_expectation, v_expectation, h_expectation);
   }
@@ -14,47 +14,48 @@
 #define XACC_ALGORITHM_RBM_CLASSIFICATION_DWAVE_MCMCEXP_HPP_
 
 #include "rbm_classification.hpp"
+#include "xacc.hpp"
 
 namespace xacc {
 namespace algorithm {
 
+// Model expectations of the -1 / +1 RBM from Gibbs chains run as one block
+// with matrix products. The chains start from the samples given in the
+// options (e.g. the dwave reads of the RBM, one occurrence-weighted chain per
+// distinct read) or from random spins.
 class DWaveRBM_MCMCDataExpectationStrategy : public ExpectationStrategy {
 protected:
-  //   def sample_arr(probs, a=-1, b=1):
-  //     rand_sample = np.random.random(probs.shape)
-  //     A = np.ones(probs.shape)*b
-  //     A[rand_sample > probs] = a
-  //     return A
-
-  Eigen::VectorXi sampleArray(Eigen::VectorXd &probs) {
-
-    Eigen::VectorXd random = Eigen::VectorXd::Random(probs.size());
-    Eigen::VectorXi A = Eigen::VectorXi::Ones(probs.size());
-
-    for (int i = 0; i < probs.size(); i++) {
-      A(i) = random(i) > probs(i) ? -1 : A(i);
-    }
-
-    return A;
-  }
-
-  Eigen::VectorXi sampleHGivenV(Eigen::VectorXi &v, Eigen::VectorXd &b,
-                                Eigen::MatrixXd &w) {
-    Eigen::VectorXd tmp = 2 * (b + w * v.cast<double>());
-    for (int i = 0; i < tmp.size(); i++) {
-      tmp(i) = 1. / (1. + std::exp(-tmp(i)));
+  std::mt19937_64 rng{std::random_device()()};
+
+  // Initial chains (n_chains x (n_v + n_h)) and their weights from the
+  // row-major "samples" (visibles then hiddens, 0 / 1 or -1 / +1) and the
+  // optional "occurrences".
+  void seedChains(const HeterogeneousMap &options, int nv, int nh,
+                  Eigen::MatrixXd &states, Eigen::VectorXd &weights) {
+    const auto samples = options.get<std::vector<int>>("samples");
+    const int width = nv + nh;
+    if (samples.empty() || samples.size() % width != 0) {
+      xacc::error("dwave-mcmc: samples must hold n_samples x (n_v + n_h) "
+                  "values.");
     }
-    Eigen::VectorXd h_probs = tmp;
-    return sampleArray(h_probs);
-  }
-  Eigen::VectorXi sampleVGivenH(Eigen::VectorXi &h, Eigen::VectorXd &a,
-                                Eigen::MatrixXd &w) {
-    Eigen::VectorXd tmp = 2 * (a + w * h.cast<double>());
-    for (int i = 0; i < tmp.size(); i++) {
-      tmp(i) = 1. / (1. + std::exp(-tmp(i)));
+    const int nSamples = samples.size() / width;
+    Eigen::Map<const Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic,
+                                   Eigen::RowMajor>>
+        values(samples.data(), nSamples, width);
+    // 0 / 1 values are mapped to spins
+    states = values.cast<double>().unaryExpr(
+        [](double x) { return x > 0 ? 1.0 : -1.0; });
+
+    weights = Eigen::VectorXd::Ones(nSamples);
+    if (options.keyExists<std::vector<int>>("occurrences")) {
+      const auto occurrences = options.get<std::vector<int>>("occurrences");
+      if ((int)occurrences.size() != nSamples) {
+        xacc::error("dwave-mcmc: occurrences must hold one value per sample.");
+      }
+      for (int i = 0; i < nSamples; i++) {
+        weights(i) = occurrences[i];
+      }
     }
-    Eigen::VectorXd v_probs = tmp;
-    return sampleArray(v_probs);
   }
 
 public:
@@ -64,54 +65,47 @@ public:
   std::tuple<Eigen::MatrixXd, Eigen::VectorXd, Eigen::VectorXd>
   compute(Eigen::MatrixXd &features, Eigen::MatrixXd &w, Eigen::VectorXd &v,
           Eigen::VectorXd &h, HeterogeneousMap options = {}) override {
-
-    int nSamples = options.keyExists<int>("n-samples")
-                       ? options.get<int>("n-samples")
-                       : 10;
-
-    Eigen::VectorXi curr_v = Eigen::VectorXi::Ones(v.size());
-    Eigen::VectorXd tmp = Eigen::VectorXd::Random(v.size());
-    for (int i = 0; i < tmp.size(); i++) {
-      curr_v(i) = tmp(i) > .5 ? curr_v(i) : -1;
-    }
-    std::vector<Eigen::VectorXi> vs, hs;
-    for (int i = 0; i < nSamples; i++) {
-      vs.push_back(curr_v);
-      Eigen::VectorXi curr_h = sampleHGivenV(curr_v, h, w);
-      hs.push_back(curr_h);
-      curr_v = sampleVGivenH(curr_h, v, w);
+    const int nv = v.size(), nh = h.size();
+    int nGibbsSteps = options.keyExists<int>("n-gibbs-steps")
+                          ? options.get<int>("n-gibbs-steps")
+                          : 1;
+    if (options.keyExists<bool>("reset-chains") &&
+        options.get<bool>("reset-chains") && options.keyExists<int>("seed")) {
+      rng.seed(options.get<int>("seed"));
     }
 
-    Eigen::MatrixXi visibles = Eigen::MatrixXi::Zero(nSamples, v.size());
-    for (int i = 0; i < nSamples; i++) {
-      visibles.row(i) = vs[i];
-    }
-    Eigen::MatrixXi hidden = Eigen::MatrixXi::Zero(nSamples, h.size());
-    for (int i = 0; i < nSamples; i++) {
-      hidden.row(i) = hs[i];
+    Eigen::MatrixXd visibles, hidden;
+    Eigen::VectorXd weights;
+    if (options.keyExists<std::vector<int>>("samples")) {
+      Eigen::MatrixXd states;
+      seedChains(options, nv, nh, states, weights);
+      visibles = states.leftCols(nv);
+      hidden = states.rightCols(nh);
+    } else {
+      int nSamples = options.keyExists<int>("n-samples")
+                         ? options.get<int>("n-samples")
+                         : 10;
+      visibles = sampleBernoulli(Eigen::MatrixXd::Constant(nSamples, nv, 0.5),
+                                 rng, -1.0);
+      weights = Eigen::VectorXd::Ones(nSamples);
     }
 
-    // sum v
-    Eigen::VectorXd sum_v = Eigen::VectorXd::Zero(v.size());
-    for (int i = 0; i < v.size(); i++) {
-      sum_v(i) = visibles.col(i).sum();
+    // p(h = +1 | v) = sigmoid(2 (v w + b_h)), p(v = +1 | h) =
+    // sigmoid(2 (h w^T + b_v)), one chain per row
+    if (hidden.size() == 0) {
+      hidden = sampleBernoulli(sigmoidAffine(visibles, w, h, 2.0), rng, -1.0);
     }
-
-    // sum h
-    Eigen::VectorXd sum_h = Eigen::VectorXd::Zero(h.size());
-    for (int i = 0; i < h.size(); i++) {
-      sum_h(i) = hidden.col(i).sum();
+    for (int step = 0; step < nGibbsSteps; step++) {
+      visibles = sampleBernoulli(sigmoidAffine(hidden, w.transpose(), v, 2.0),
+                                 rng, -1.0);
+      hidden = sampleBernoulli(sigmoidAffine(visibles, w, h, 2.0), rng, -1.0);
     }
 
-    // sum v * h
-    Eigen::MatrixXd sum_vh = (visibles.transpose() * hidden).cast<double>();
-
-    // exp w = sumvh / nsamples
-    Eigen::MatrixXd expW = sum_vh / nSamples;
-    Eigen::VectorXd expv = sum_v / nSamples;
-    Eigen::VectorXd exph = sum_h / nSamples;
-    // exp v = sumv / nsamples
-    // exp h = sumh / nsamples
+    const double total = weights.sum();
+    Eigen::MatrixXd expW =
+        (visibles.transpose() * weights.asDiagonal() * hidden) / total;
+    Eigen::VectorXd expv = (visibles.transpose() * weights) / total;
+    Eigen::VectorXd exph = (hidden.transpose() * weights) / total;
 
     return std::make_tuple(expW, expv, exph);
   }
@@ -61,10 +61,22 @@ void RBMClassification::execute(
   auto nv = rbm->getParameter(0).as<int>();
   auto nh = rbm->getParameter(1).as<int>();
 
-  int batch_size = 1;
+  int batch_size = _parameters.keyExists<int>("batch-size")
+                       ? _parameters.get<int>("batch-size")
+                       : 1;
+  int n_epochs =
+      _parameters.keyExists<int>("epochs") ? _parameters.get<int>("epochs") : 1;
+  double l2reg = _parameters.keyExists<double>("l2-reg")
+                     ? _parameters.get<double>("l2-reg")
+                     : 0.0;
+  double lr = _parameters.keyExists<double>("learning-rate")
+                  ? _parameters.get<double>("learning-rate")
+                  : .01;
+  if (batch_size < 1 || batch_size > training_data.rows()) {
+    xacc::error("rbm-classification: batch-size must be in [1, " +
+                std::to_string(training_data.rows()) + "].");
+  }
   int n_batches = training_data.rows() / batch_size;
-  double l2reg = 0.0;
-  double lr = .01;
 
   // Initialize the RBM
   Eigen::MatrixXd w = Eigen::MatrixXd::Random(nv, nh);
@@ -76,38 +88,39 @@ void RBMClassification::execute(
   auto dataExpectations = xacc::getService<ExpectationStrategy>("data-exp");
   auto modelExpectations = xacc::getService<ExpectationStrategy>(modelExp);
 
+  // Persistent model chains start over with each run
+  auto modelOptions = _parameters;
+  modelOptions.insert("reset-chains", true);
+
   // Strategy:
-  // loop through data in chunks of batch_size
-  int epoch = 0;
-  for (int batchIdx = 0; batchIdx < n_batches; batchIdx += batch_size) {
-    xacc::debug("Starting Epoch " +std::to_string(epoch));
-    epoch++;
-
-    // batch should be batch_size x nv
-    Eigen::MatrixXd batch = training_data.block(batchIdx, 0, batch_size, nv);
-
-    // Create data exp w, v, and h, as well as model versions
-    Eigen::MatrixXd tmp = Eigen::MatrixXd::Zero(1, 1);
-    Eigen::MatrixXd dataexp_W, modexp_W;
-    Eigen::VectorXd dataexp_v, dataexp_h, modexp_v, modexp_h;
-
-    // Compute the data expectations
-    std::tie(dataexp_W, dataexp_v, dataexp_h) =
-        dataExpectations->compute(batch, w, bv, bh);
-
-    // Compute the model expectations
-    if (modelExp == "dwave" || modelExp == "dwave-mcmc") {
+  // loop through data in chunks of batch_size, each batch being a
+  // batch_size x nv block of rows
+  for (int epoch = 0; epoch < n_epochs; epoch++) {
+    xacc::debug("Starting Epoch " + std::to_string(epoch));
+    for (int batchIdx = 0; batchIdx < n_batches; batchIdx++) {
+      Eigen::MatrixXd batch =
+          training_data.block(batchIdx * batch_size, 0, batch_size, nv);
+
+      Eigen::MatrixXd dataexp_W, modexp_W;
+      Eigen::VectorXd dataexp_v, dataexp_h, modexp_v, modexp_h;
+
+      // Compute the data expectations
+      std::tie(dataexp_W, dataexp_v, dataexp_h) =
+          dataExpectations->compute(batch, w, bv, bh);
+
+      // Compute the model expectations
       std::tie(modexp_W, modexp_v, modexp_h) =
-          modelExpectations->compute(tmp, w, bv, bh, _parameters);
+          modelExpectations->compute(batch, w, bv, bh, modelOptions);
+      modelOptions.insert("reset-chains", false);
+
+      // Get the deltas and update for the next iteration
+      Eigen::MatrixXd wdelta = dataexp_W - modexp_W;
+      Eigen::VectorXd v_delta = dataexp_v - modexp_v;
+      Eigen::VectorXd h_delta = dataexp_h - modexp_h;
+      w = (1. - l2reg) * w + lr * wdelta;
+      bv = (1. - l2reg) * bv + lr * v_delta;
+      bh = (1. - l2reg) * bh + lr * h_delta;
     }
-
-    // Get the deltas and update for the next iteration
-    Eigen::MatrixXd wdelta = dataexp_W - modexp_W;
-    Eigen::VectorXd v_delta = dataexp_v - modexp_v;
-    Eigen::VectorXd h_delta = dataexp_h - modexp_h;
-    w = (1. - l2reg) * w + lr * wdelta;
-    bv = (1. - l2reg) * bv + lr * v_delta;
-    bh = (1. - l2reg) * bh + lr * h_delta;
   }
 
   std::vector<double> wvec(w.data(), w.data() + w.size()),
@@ -17,9 +17,29 @@
 #include <vector>
 #include <Eigen/Dense>
 #include <fstream>
+#include <random>
 
 namespace xacc {
 namespace algorithm {
+// Logistic function of scale * (x * w + bias), x holding one sample per row.
+// The products are Eigen's blocked (and, with OpenMP, multithreaded) GEMM.
+inline Eigen::MatrixXd sigmoidAffine(const Eigen::MatrixXd &x,
+                                     const Eigen::MatrixXd &w,
+                                     const Eigen::VectorXd &bias,
+                                     double scale = 1.0) {
+  Eigen::MatrixXd z = x * w;
+  z.rowwise() += bias.transpose();
+  return (1.0 + (-scale * z.array()).exp()).inverse().matrix();
+}
+
+// 1 with the probability of each entry, low otherwise.
+inline Eigen::MatrixXd sampleBernoulli(const Eigen::MatrixXd &probs,
+                                       std::mt19937_64 &rng,
+                                       double low = 0.0) {
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  return probs.unaryExpr(
+      [&](double p) { return uniform(rng) < p ? 1.0 : low; });
+}
 
 class ExpectationStrategy : public Identifiable {
 public:
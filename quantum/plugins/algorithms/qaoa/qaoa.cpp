@@ -20,9 +20,14 @@
 #include "xacc_observable.hpp"
 #include "CompositeInstruction.hpp"
 #include "AlgorithmGradientStrategy.hpp"
+#include "AcceleratorDecorator.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <iomanip>
+#include <limits>
+#include <map>
 
 namespace xacc {
 namespace algorithm {
@@ -116,6 +121,112 @@ bool QAOA::initialize(const HeterogeneousMap &parameters) {
     m_shuffleTerms = parameters.get<bool>("shuffle-terms");
   }
 
+  m_retentionPolicy =
+      ChildBufferRetention::fromParameters(parameters, m_retainIterations);
+
+  // Diagonal cost Hamiltonian fast path: a single measured circuit per
+  // evaluation, all the terms (and the objective) from its counts.
+  m_diagonalSampling = false;
+  if (parameters.keyExists<bool>("diagonal-sampling")) {
+    m_diagonalSampling = parameters.get<bool>("diagonal-sampling");
+  }
+  m_objective = "expectation";
+  if (parameters.stringExists("objective")) {
+    m_objective = parameters.getString("objective");
+  }
+  if (m_objective != "expectation" && m_objective != "cvar" &&
+      m_objective != "gibbs") {
+    std::cout << "'objective' must be 'expectation', 'cvar' or 'gibbs'.\n";
+    initializeOk = false;
+  }
+  // CVaR and Gibbs objectives need the sampled cost values
+  if (m_objective != "expectation") {
+    m_diagonalSampling = true;
+    if (m_optimizer && m_optimizer->isGradientBased()) {
+      std::cout << "The '" << m_objective
+                << "' objective requires a gradient-free optimizer.\n";
+      initializeOk = false;
+    }
+  }
+  m_cvarAlpha = 1.0;
+  if (parameters.keyExists<double>("cvar-alpha")) {
+    m_cvarAlpha = parameters.get<double>("cvar-alpha");
+    if (m_cvarAlpha <= 0.0 || m_cvarAlpha > 1.0) {
+      std::cout << "'cvar-alpha' must be in (0, 1].\n";
+      initializeOk = false;
+    }
+  }
+  m_gibbsEta = 1.0;
+  if (parameters.keyExists<double>("gibbs-eta")) {
+    m_gibbsEta = parameters.get<double>("gibbs-eta");
+    if (m_gibbsEta <= 0.0) {
+      std::cout << "'gibbs-eta' must be positive.\n";
+      initializeOk = false;
+    }
+  }
+
+  if (initializeOk && m_diagonalSampling) {
+    m_costZMasks.clear();
+    m_costCoeffs.clear();
+    m_costIdentityCoeff = 0.0;
+    auto pauliCost = dynamic_cast<xacc::quantum::PauliOperator *>(m_costHamObs);
+    bool isDiagonal = pauliCost != nullptr;
+    if (pauliCost) {
+      for (auto &[termName, term] : pauliCost->getTerms()) {
+        std::vector<int> zMask;
+        for (auto &[qubit, op] : term.ops()) {
+          if (op == "Z") {
+            zMask.push_back(qubit);
+          } else if (op != "I" && !op.empty()) {
+            isDiagonal = false;
+          }
+        }
+        if (zMask.empty()) {
+          m_costIdentityCoeff += std::real(term.coeff());
+        } else {
+          m_costZMasks.push_back(zMask);
+          m_costCoeffs.push_back(std::real(term.coeff()));
+        }
+      }
+    }
+    if (!isDiagonal) {
+      std::cout << "'diagonal-sampling' requires a Pauli cost Hamiltonian of "
+                   "Z and I terms only.\n";
+      initializeOk = false;
+    }
+  }
+
+  // Light-cone mode: each cost term is evaluated (locally) on the
+  // subcircuit that can reach its qubits.
+  m_lightCone = false;
+  if (parameters.keyExists<bool>("light-cone")) {
+    m_lightCone = parameters.get<bool>("light-cone");
+  }
+  m_lightConeMaxQubits = 20;
+  if (parameters.keyExists<int>("light-cone-max-qubits")) {
+    m_lightConeMaxQubits = parameters.get<int>("light-cone-max-qubits");
+    if (m_lightConeMaxQubits <= 0) {
+      std::cout << "'light-cone-max-qubits' must be positive.\n";
+      initializeOk = false;
+    }
+  }
+  m_single_exec_lightCone.reset();
+  if (m_lightCone && m_diagonalSampling) {
+    std::cout << "'light-cone' cannot be combined with 'diagonal-sampling' "
+                 "or a sampled 'objective'.\n";
+    initializeOk = false;
+  }
+  if (initializeOk && m_lightCone &&
+      !dynamic_cast<xacc::quantum::PauliOperator *>(m_costHamObs)) {
+    std::cout << "'light-cone' requires a Pauli cost Hamiltonian.\n";
+    initializeOk = false;
+  }
+
+  m_parameterStore = ParameterStore::fromParameters(
+      parameters, ParameterStore::Update::Best);
+  m_checkpoint = Checkpoint::fromParameters(parameters);
+  m_profiler.initialize(parameters);
+
   if (m_optimizer && m_optimizer->isGradientBased() &&
       gradientStrategy == nullptr) {
     // No gradient strategy was provided, just use autodiff.
@@ -143,7 +254,7 @@ void QAOA::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
       m.insert("nbQubits", nbQubits);
       m.insert("nbSteps", m_nbSteps);
       m.insert("ref-ham", m_refHamObs);
-      m.insert("cost-ham", m_costHamObs);
+      m.insert("cost-ham", xacc::as_shared_ptr(m_costHamObs));
       m.insert("parameter-scheme", m_parameterizedMode);
       if (m_initial_state){
           m.insert("initial-state", m_initial_state);
@@ -156,9 +267,99 @@ void QAOA::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
   auto kernels = m_costHamObs->observe(kernel);
 
   int iterCount = 0;
-  // Construct the optimizer/minimizer:
-  OptFunction f(
-      [&, this](const std::vector<double> &x, std::vector<double> &dx) {
+  ChildBufferRetention retention(m_retentionPolicy, m_retainIterations);
+  // Null unless profiling
+  const auto spans = m_profiler.recorder();
+  // Logs the iteration and records its children, returns the value to
+  // minimize.
+  const auto finishIteration = [&](const std::vector<double> &x,
+                                   double energy,
+                                   ChildBufferRetention::Children children) {
+    iterCount++;
+    if (xacc::loggingEnabled(1)) {
+      std::stringstream ss;
+      ss << "Iter " << iterCount << ": E("
+         << (!x.empty() ? std::to_string(x[0]) : "");
+      for (int i = 1; i < x.size(); i++) {
+        ss << "," << std::setprecision(3) << x[i];
+        if (i > 4) {
+          // Don't print too many params
+          ss << ", ...";
+          break;
+        }
+      }
+      ss << ") = " << std::setprecision(12) << energy;
+      xacc::info(ss.str());
+    }
+
+    if (m_maximize) energy *= -1.0;
+    retention.addIteration(buffer, x, energy, std::move(children));
+    return energy;
+  };
+
+  std::shared_ptr<LightConeEvaluator> lightCone;
+  if (m_lightCone) {
+    lightCone = std::make_shared<LightConeEvaluator>(
+        kernel, *dynamic_cast<xacc::quantum::PauliOperator *>(m_costHamObs),
+        m_lightConeMaxQubits);
+  }
+
+  // Construct the optimizer/minimizer. The cost terms can be given already
+  // evaluated at x, as the child buffers of precomputed (batched evaluation).
+  const auto evaluateAt =
+      [&, this](const std::vector<double> &x, std::vector<double> &dx,
+                std::shared_ptr<AcceleratorBuffer> precomputed) {
+        // An empty dx asks for the value only (e.g. a line-search probe):
+        // the gradient circuits are not run then.
+        const bool withGradient = gradientStrategy && !dx.empty();
+        ScopeTimer iteration("iteration", spans.get());
+        if (lightCone) {
+          // The gradient is computed on the light cones as well: the
+          // gradient strategy circuits would run the full QAOA circuit.
+          iteration.phase("execute");
+          const double energy = lightCone->energy(x);
+          if (m_optimizer->isGradientBased() && !dx.empty()) {
+            iteration.phase("gradient");
+            dx = lightCone->gradient(x);
+            if (m_maximize) {
+              for (auto &val : dx) {
+                val *= -1.0;
+              }
+            }
+          }
+          auto coneBuffer = xacc::qalloc(buffer->size());
+          coneBuffer->setName("light-cone");
+          coneBuffer->addExtraInfo("energy", energy);
+          coneBuffer->addExtraInfo("parameters", x);
+          iteration.phase("bookkeeping");
+          return finishIteration(x, energy, {coneBuffer});
+        }
+
+        if (m_diagonalSampling) {
+          iteration.phase("bind");
+          auto evaled = kernel->operator()(x);
+          iteration.phase("execute");
+          auto sampledBuffer = xacc::qalloc(buffer->size());
+          const auto [objective, energy] =
+              evaluateSampledCost(evaled, sampledBuffer);
+          sampledBuffer->addExtraInfo("parameters", x);
+          if (withGradient) {
+            iteration.phase("gradient");
+            auto gradFsToExec =
+                gradientStrategy->getGradientExecutions(kernel, x);
+            auto gradBuffer = xacc::qalloc(buffer->size());
+            if (!gradFsToExec.empty()) {
+              m_qpu->execute(gradBuffer, gradFsToExec);
+            }
+            if (gradientStrategy->isNumerical()) {
+              gradientStrategy->setFunctionValue(energy - m_costIdentityCoeff);
+            }
+            gradientStrategy->compute(dx, gradBuffer->getChildren());
+          }
+          iteration.phase("bookkeeping");
+          return finishIteration(x, objective, {sampledBuffer});
+        }
+
         std::vector<double> coefficients;
         std::vector<std::string> kernelNames;
         std::vector<std::shared_ptr<CompositeInstruction>> fsToExec;
@@ -178,8 +379,7 @@ void QAOA::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
           }
 
           if (nFunctionInstructions > kernel->nInstructions()) {
-            auto evaled = f->operator()(x);
-            fsToExec.push_back(evaled);
+            fsToExec.push_back(f);
             coefficients.push_back(std::real(coeff));
           } else {
             identityCoeff += std::real(coeff);
@@ -187,26 +387,40 @@ void QAOA::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
         }
 
         // enables gradients (Daniel)
-        if (gradientStrategy) {
-
-          auto gradFsToExec =
-              gradientStrategy->getGradientExecutions(kernel, x);
-          // Add gradient instructions to be sent to the qpu
+        std::vector<std::shared_ptr<CompositeInstruction>> gradFsToExec;
+        if (withGradient) {
+          iteration.phase("gradient");
+          gradFsToExec = gradientStrategy->getGradientExecutions(kernel, x);
           nInstructionsEnergy = fsToExec.size();
           nInstructionsGradient = gradFsToExec.size();
-          for (auto inst : gradFsToExec) {
-            fsToExec.push_back(inst);
-          }
-          xacc::info("Number of instructions for energy calculation: " +
-                     std::to_string(nInstructionsEnergy));
-          xacc::info("Number of instructions for gradient calculation: " +
-                     std::to_string(nInstructionsGradient));
+          XACC_LOG_INFO("Number of instructions for energy calculation: " +
+                        std::to_string(nInstructionsEnergy));
+          XACC_LOG_INFO("Number of instructions for gradient calculation: " +
+                        std::to_string(nInstructionsGradient));
         }
 
-        auto tmpBuffer = xacc::qalloc(buffer->size());
-        m_qpu->execute(tmpBuffer, fsToExec);
+        // Evaluate the cost Hamiltonian terms on the QAOA state,
+        // then run any gradient circuits after them.
+        auto tmpBuffer = precomputed;
+        if (!tmpBuffer) {
+          iteration.phase("bind");
+          auto evaled = kernel->operator()(x);
+          iteration.phase("execute");
+          tmpBuffer = xacc::qalloc(buffer->size());
+          m_qpu->computeExpectations(tmpBuffer, evaled,
+                                     xacc::as_shared_ptr(m_costHamObs));
+        }
+        if (!gradFsToExec.empty()) {
+          iteration.phase("execute");
+          auto gradBuffer = xacc::qalloc(buffer->size());
+          m_qpu->execute(gradBuffer, gradFsToExec);
+          for (auto &child : gradBuffer->getChildren()) {
+            tmpBuffer->appendChild(child->name(), child);
+          }
+        }
         auto buffers = tmpBuffer->getChildren();
 
+        iteration.phase("post-process");
         double energy = identityCoeff;
         auto idBuffer = xacc::qalloc(buffer->size());
         idBuffer->addExtraInfo("coefficient", identityCoeff);
@@ -214,9 +428,9 @@ void QAOA::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
         idBuffer->addExtraInfo("kernel", "I");
         idBuffer->addExtraInfo("parameters", x);
         idBuffer->addExtraInfo("exp-val-z", 1.0);
-        buffer->appendChild("I", idBuffer);
+        ChildBufferRetention::Children children{idBuffer};
 
-        if (gradientStrategy) { // gradient-based optimization
+        if (withGradient) { // gradient-based optimization
 
           for (int i = 0; i < nInstructionsEnergy; i++) { // compute energy
             auto expval = buffers[i]->getExpectationValueZ();
@@ -225,21 +439,26 @@ void QAOA::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
             buffers[i]->addExtraInfo("kernel", fsToExec[i]->name());
             buffers[i]->addExtraInfo("exp-val-z", expval);
             buffers[i]->addExtraInfo("parameters", x);
-            buffer->appendChild(fsToExec[i]->name(), buffers[i]);
+            children.emplace_back(buffers[i]);
           }
 
-          std::stringstream ss;
-          ss << std::setprecision(12) << "Current Energy: " << energy;
-          xacc::info(ss.str());
-          ss.str(std::string());
+          if (xacc::loggingEnabled(1)) {
+            std::stringstream ss;
+            ss << std::setprecision(12) << "Current Energy: " << energy;
+            xacc::info(ss.str());
+          }
 
           // If gradientStrategy is numerical, pass the energy
           // We subtract the identityCoeff from the energy
           // instead of passing the energy because the gradients
           // only take the coefficients of parameterized instructions
+          iteration.phase("gradient");
           if (gradientStrategy->isNumerical()) {
             gradientStrategy->setFunctionValue(energy - identityCoeff);
           }
+          gradientStrategy->setBaseResults(
+              std::vector<std::shared_ptr<AcceleratorBuffer>>(
+                  buffers.begin(), buffers.begin() + nInstructionsEnergy));
 
           // update gradient vector
           gradientStrategy->compute(
@@ -255,37 +474,82 @@ void QAOA::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
             buffers[i]->addExtraInfo("kernel", fsToExec[i]->name());
             buffers[i]->addExtraInfo("exp-val-z", expval);
             buffers[i]->addExtraInfo("parameters", x);
-            buffer->appendChild(fsToExec[i]->name(), buffers[i]);
-          }
-        }
-   
-        std::stringstream ss;
-        iterCount++;
-        ss << "Iter " << iterCount << ": E("
-           << (!x.empty() ? std::to_string(x[0]) : "");
-        for (int i = 1; i < x.size(); i++) {
-          ss << "," << std::setprecision(3) << x[i];
-          if (i > 4) {
-            // Don't print too many params
-            ss << ", ...";
-            break;
+            children.emplace_back(buffers[i]);
           }
         }
-        ss << ") = " << std::setprecision(12) << energy;
-        xacc::info(ss.str());
-        
-        if (m_maximize) energy *= -1.0;
-        return energy;
+
+        iteration.phase("bookkeeping");
+        return finishIteration(x, energy, std::move(children));
+      };
+  OptFunction f(
+      [&](const std::vector<double> &x, std::vector<double> &dx) {
+        return evaluateAt(x, dx, nullptr);
       },
       kernel->nVariables());
+  // Population-based optimizers evaluate their candidates as one batch of
+  // all the cost term circuits (values only; not for light cones, sampled
+  // costs or decorators, which may aggregate over an execution).
+  if (!lightCone && !m_diagonalSampling &&
+      !std::dynamic_pointer_cast<xacc::AcceleratorDecorator>(
+          xacc::as_shared_ptr(m_qpu))) {
+    f.setBatchFunction([&](const std::vector<std::vector<double>> &xs) {
+      // The iterations of the batch only post-process
+      ScopeTimer batch("batch", spans.get());
+      batch.phase("bind");
+      std::vector<std::shared_ptr<AcceleratorBuffer>> tmpBuffers;
+      std::vector<std::shared_ptr<CompositeInstruction>> evaledKernels;
+      for (auto &x : xs) {
+        evaledKernels.emplace_back(kernel->operator()(x));
+        tmpBuffers.emplace_back(xacc::qalloc(buffer->size()));
+      }
+      batch.phase("execute");
+      m_qpu->computeExpectations(tmpBuffers, evaledKernels,
+                                 xacc::as_shared_ptr(m_costHamObs));
+      batch.phase("iterations");
+      std::vector<double> values;
+      std::vector<double> dx;
+      for (int i = 0; i < xs.size(); i++) {
+        values.push_back(evaluateAt(xs[i], dx, tmpBuffers[i]));
+      }
+      return values;
+    });
+  }
+
+  std::string fingerprint;
+  if (m_parameterStore) {
+    fingerprint = m_parameterStore->fingerprint(problemFingerprint(nbQubits));
+    m_parameterStore->warmStart(fingerprint, kernel->nVariables(),
+                                *m_optimizer);
+  }
+
+  CheckpointedOptFunction checkpointed(f, m_checkpoint);
+  if (m_checkpoint) {
+    // The cost Hamiltonian itself, not its graph family
+    m_checkpoint->restore("qaoa|" + m_costHamObs->toString() + "|" +
+                          m_parameterizedMode + "#" +
+                          std::to_string(kernel->nVariables()));
+  }
+  auto result = m_checkpoint ? m_optimizer->optimize(checkpointed)
+                             : m_optimizer->optimize(f);
+  if (m_checkpoint) {
+    m_checkpoint->save();
+  }
+  retention.finalize(buffer);
+
+  if (m_parameterStore) {
+    // Per cost term, so that the graphs of different sizes compare.
+    const auto nbTerms =
+        std::max<std::size_t>(1, m_costHamObs->getNonIdentitySubTerms().size());
+    m_parameterStore->record(fingerprint, result.second,
+                             result.first / nbTerms);
+  }
 
-  auto result = m_optimizer->optimize(f);
-  
   // Reports the final cost:
   double finalCost = result.first;
   if (m_maximize) finalCost *= -1.0;
   buffer->addExtraInfo("opt-val", ExtraInfo(finalCost));
   buffer->addExtraInfo("opt-params", ExtraInfo(result.second));
+  m_profiler.record(spans.get(), {"iteration", "batch"}, *buffer);
 }
 
 std::vector<double>
@@ -304,7 +568,7 @@ QAOA::execute(const std::shared_ptr<AcceleratorBuffer> buffer,
     m.insert("nbQubits", nbQubits);
     m.insert("nbSteps", m_nbSteps);
     m.insert("ref-ham", m_refHamObs);
-    m.insert("cost-ham", m_costHamObs);
+    m.insert("cost-ham", xacc::as_shared_ptr(m_costHamObs));
     m.insert("parameter-scheme", m_parameterizedMode);
     if (m_initial_state){
         m.insert("initial-state", m_initial_state);
@@ -315,6 +579,30 @@ QAOA::execute(const std::shared_ptr<AcceleratorBuffer> buffer,
     m_single_exec_kernel = kernel;
   }
 
+  if (m_diagonalSampling) {
+    auto sampledBuffer = xacc::qalloc(buffer->size());
+    const auto [objective, energy] =
+        evaluateSampledCost(kernel->operator()(x), sampledBuffer);
+    sampledBuffer->addExtraInfo("parameters", x);
+    buffer->appendChild(sampledBuffer->name(), sampledBuffer);
+    return {objective};
+  }
+
+  if (m_lightCone) {
+    // The cones only depend on the (parameterized) kernel: reuse them.
+    if (!m_single_exec_lightCone) {
+      m_single_exec_lightCone = std::make_shared<LightConeEvaluator>(
+          kernel, *dynamic_cast<xacc::quantum::PauliOperator *>(m_costHamObs),
+          m_lightConeMaxQubits);
+    }
+    const double energy = m_single_exec_lightCone->energy(x);
+    auto coneBuffer = xacc::qalloc(buffer->size());
+    coneBuffer->addExtraInfo("energy", energy);
+    coneBuffer->addExtraInfo("parameters", x);
+    buffer->appendChild("light-cone", coneBuffer);
+    return {energy};
+  }
+
   // Observe the cost Hamiltonian:
   auto kernels = m_costHamObs->observe(kernel);
   std::vector<double> coefficients;
@@ -334,8 +622,7 @@ QAOA::execute(const std::shared_ptr<AcceleratorBuffer> buffer,
     }
 
     if (nFunctionInstructions > kernel->nInstructions()) {
-      auto evaled = f->operator()(x);
-      fsToExec.push_back(evaled);
+      fsToExec.push_back(f);
       coefficients.push_back(std::real(coeff));
     } else {
       identityCoeff += std::real(coeff);
@@ -343,7 +630,8 @@ QAOA::execute(const std::shared_ptr<AcceleratorBuffer> buffer,
   }
 
   auto tmpBuffer = xacc::qalloc(buffer->size());
-  m_qpu->execute(tmpBuffer, fsToExec);
+  m_qpu->computeExpectations(tmpBuffer, kernel->operator()(x),
+                             xacc::as_shared_ptr(m_costHamObs));
   auto buffers = tmpBuffer->getChildren();
 
   double energy = identityCoeff;
@@ -374,5 +662,127 @@ QAOA::execute(const std::shared_ptr<AcceleratorBuffer> buffer,
   return {finalCost};
 }
 
+std::string QAOA::problemFingerprint(int in_nbQubits) const {
+  // Degree of each qubit in the graph of the 2-qubit cost terms
+  std::vector<int> degrees(in_nbQubits, 0);
+  bool hasFields = false, isWeighted = false;
+  double edgeWeight = 0.0;
+  auto pauliCost = dynamic_cast<xacc::quantum::PauliOperator *>(m_costHamObs);
+  if (pauliCost) {
+    for (auto &[termName, term] : pauliCost->getTerms()) {
+      std::vector<int> qubits;
+      for (auto &[qubit, op] : term.ops()) {
+        if (op != "I" && !op.empty()) {
+          qubits.push_back(qubit);
+        }
+      }
+      if (qubits.size() == 1) {
+        hasFields = true;
+      } else if (qubits.size() == 2) {
+        for (const auto &qubit : qubits) {
+          if (qubit < in_nbQubits) {
+            degrees[qubit]++;
+          }
+        }
+        const double weight = std::real(term.coeff());
+        isWeighted = isWeighted || (edgeWeight != 0.0 && weight != edgeWeight);
+        edgeWeight = weight;
+      }
+    }
+  }
+  std::map<int, int> histogram;
+  for (const auto &degree : degrees) {
+    histogram[degree]++;
+  }
+
+  // Fractions of the qubits with each degree, e.g. "3:1.00" for the
+  // 3-regular graphs of any size.
+  std::stringstream ss;
+  ss << "qaoa|" << m_parameterizedMode << "|p" << m_nbSteps << "|";
+  for (const auto &[degree, count] : histogram) {
+    ss << degree << ":" << std::fixed << std::setprecision(2)
+       << double(count) / std::max(1, in_nbQubits) << ",";
+  }
+  ss << (hasFields ? "|fields" : "") << (isWeighted ? "|weighted" : "");
+  if (m_maximize) {
+    ss << "|max";
+  }
+  if (externalAnsatz) {
+    ss << "|" << externalAnsatz->name();
+  }
+  return ss.str();
+}
+
+std::pair<double, double> QAOA::evaluateSampledCost(
+    const std::shared_ptr<CompositeInstruction> &in_evaled,
+    std::shared_ptr<AcceleratorBuffer> &out_buffer) const {
+  // The QAOA state followed by the measurement of all the qubits:
+  // all the Z strings are evaluated on the same bit strings.
+  auto provider = xacc::getIRProvider("quantum");
+  auto sampled = provider->createComposite(in_evaled->name() + "_sampled");
+  sampled->addInstruction(in_evaled);
+  for (std::size_t i = 0; i < out_buffer->size(); ++i) {
+    sampled->addInstruction(provider->createInstruction("Measure", {i}));
+  }
+  out_buffer->setName(sampled->name());
+  m_qpu->execute(out_buffer, sampled);
+
+  auto values = out_buffer->getDiagonalValues(
+      m_costZMasks, m_costCoeffs,
+      m_qpu->getBitOrder() == Accelerator::BitOrder::MSB
+          ? AcceleratorBuffer::BitOrder::MSB
+          : AcceleratorBuffer::BitOrder::LSB);
+  if (values.empty()) {
+    xacc::error("QAOA: 'diagonal-sampling' requires measurement counts, "
+                "i.e. an accelerator with 'shots'.");
+  }
+
+  double totalCounts = 0.0, energy = 0.0;
+  for (auto &[value, count] : values) {
+    value += m_costIdentityCoeff;
+    totalCounts += count;
+    energy += value * count;
+  }
+  energy /= totalCounts;
+  out_buffer->addExtraInfo("energy", energy);
+
+  // The objectives below favor the low cost samples (high if maximizing).
+  const double sign = m_maximize ? -1.0 : 1.0;
+  double objective = energy;
+  if (m_objective == "cvar") {
+    // Mean cost over the best alpha fraction of the samples
+    std::sort(values.begin(), values.end(),
+              [sign](const auto &a, const auto &b) {
+                return sign * a.first < sign * b.first;
+              });
+    const double tailCounts = m_cvarAlpha * totalCounts;
+    double tailTotal = 0.0, tailSum = 0.0;
+    for (const auto &[value, count] : values) {
+      const double weight = std::min<double>(count, tailCounts - tailTotal);
+      if (weight <= 0.0) {
+        break;
+      }
+      tailSum += weight * value;
+      tailTotal += weight;
+    }
+    objective = tailSum / tailTotal;
+  } else if (m_objective == "gibbs") {
+    // -ln <exp(-eta * cost)> / eta, i.e. a soft minimum of the sampled cost
+    // (in cost units), evaluated with the log-sum-exp shift.
+    double maxExponent = -std::numeric_limits<double>::infinity();
+    for (const auto &[value, count] : values) {
+      maxExponent = std::max(maxExponent, -m_gibbsEta * sign * value);
+    }
+    double sum = 0.0;
+    for (const auto &[value, count] : values) {
+      sum += count * std::exp(-m_gibbsEta * sign * value - maxExponent);
+    }
+    objective =
+        -sign * (maxExponent + std::log(sum / totalCounts)) / m_gibbsEta;
+  }
+  out_buffer->addExtraInfo("objective", objective);
+  return std::make_pair(objective, energy);
+}
+
 } // namespace algorithm
 } // namespace xacc
\ No newline at end of file
@@ -16,6 +16,11 @@
 #include "IRProvider.hpp"
 #include "CompositeInstruction.hpp"
 #include "AlgorithmGradientStrategy.hpp"
+#include "AlgorithmProfiler.hpp"
+#include "Checkpoint.hpp"
+#include "ChildBufferRetention.hpp"
+#include "ParameterStore.hpp"
+#include "qaoa_lightcone.hpp"
 
 namespace xacc {
 namespace algorithm {
@@ -29,6 +34,16 @@ public:
     const std::string name() const override { return "QAOA"; }
     const std::string description() const override { return ""; }
     DEFINE_ALGORITHM_CLONE(QAOA)
+private:
+    // Diagonal cost Hamiltonian fast path: samples the QAOA state once and
+    // evaluates the objective from the counts. Returns the objective and
+    // the (sampled) cost expectation value.
+    std::pair<double, double> evaluateSampledCost(
+        const std::shared_ptr<CompositeInstruction> &in_evaled,
+        std::shared_ptr<AcceleratorBuffer> &out_buffer) const;
+    // Parameter store key: the cost graph degree distribution, the number
+    // of steps and the parameter scheme.
+    std::string problemFingerprint(int in_nbQubits) const;
 private:
     Observable* m_costHamObs;
     Observable* m_refHamObs;
@@ -42,6 +57,35 @@ private:
     bool m_maximize = false;
     CompositeInstruction* m_initial_state = nullptr;
     bool m_shuffleTerms = false;
+    ChildBufferRetention::Policy m_retentionPolicy =
+        ChildBufferRetention::Policy::All;
+    int m_retainIterations = 1;
+    // 'diagonal-sampling': the cost Hamiltonian is a sum of Z strings,
+    // i.e. the Z masks (qubits) and coefficients of its non-identity terms.
+    bool m_diagonalSampling = false;
+    std::vector<std::vector<int>> m_costZMasks;
+    std::vector<double> m_costCoeffs;
+    double m_costIdentityCoeff = 0.0;
+    // 'objective': "expectation", "cvar" ('cvar-alpha') or "gibbs"
+    // ('gibbs-eta'), the last two from the sampled cost values only.
+    std::string m_objective = "expectation";
+    double m_cvarAlpha = 1.0;
+    double m_gibbsEta = 1.0;
+    // 'light-cone': exact energy (and gradient) from the reverse light cones
+    // of the cost terms, simulated locally; cones of at most
+    // 'light-cone-max-qubits' qubits.
+    bool m_lightCone = false;
+    int m_lightConeMaxQubits = 20;
+    std::shared_ptr<LightConeEvaluator> m_single_exec_lightCone;
+    // 'parameter-store': warm start from (and record) the best parameters
+    // of the graphs of the same family.
+    std::shared_ptr<ParameterStore> m_parameterStore;
+    // 'checkpoint': the objective evaluations are logged, and replayed on a
+    // restart.
+    std::shared_ptr<Checkpoint> m_checkpoint;
+    // 'profile': per-iteration bind / execute / post-process / gradient /
+    // bookkeeping durations
+    AlgorithmProfiler m_profiler;
 };
 } // namespace algorithm
 } // namespace xacc
@@ -184,7 +184,7 @@ std::shared_ptr<CompositeInstruction> QAOA::constructParameterizedKernel(bool ex
   auto provider = getIRProvider("quantum");
   auto qaoaKernel = provider->createComposite("qaoaKernel");
   if (m_initial_state) {
-     for (auto inst : m_initial_state->getInstructions()) {
+     for (auto &inst : m_initial_state->getInstructionsView()) {
         qaoaKernel->addInstruction(inst);
      }
   } else {
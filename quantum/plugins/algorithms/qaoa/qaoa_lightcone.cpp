@@ -0,0 +1,420 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "qaoa_lightcone.hpp"
+
+#include "xacc.hpp"
+#include "InstructionIterator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <map>
+#include <set>
+#include <sstream>
+#include <unordered_map>
+
+namespace {
+using StateVec = std::vector<std::complex<double>>;
+// Row-major 2x2 or 4x4 gate matrix
+using GateMat = std::vector<std::complex<double>>;
+constexpr std::complex<double> I{0.0, 1.0};
+
+GateMat controlled(const GateMat &in_mat) {
+  return {1.0, 0.0, 0.0,       0.0,       0.0,       1.0,
+          0.0, 0.0, 0.0,       0.0,       in_mat[0], in_mat[1],
+          0.0, 0.0, in_mat[2], in_mat[3]};
+}
+
+// Matrix of an evaluated gate
+GateMat gateMatrix(xacc::Instruction &in_inst) {
+  std::vector<double> angles;
+  for (const auto &param : in_inst.getParameters()) {
+    angles.emplace_back(xacc::InstructionParameterToDouble(param));
+  }
+  const auto name = in_inst.name();
+  const double c = angles.empty() ? 0.0 : std::cos(angles[0] / 2.0);
+  const double s = angles.empty() ? 0.0 : std::sin(angles[0] / 2.0);
+  if (name == "H") {
+    const double h = 1.0 / std::sqrt(2.0);
+    return {h, h, h, -h};
+  } else if (name == "X") {
+    return {0.0, 1.0, 1.0, 0.0};
+  } else if (name == "Y") {
+    return {0.0, -I, I, 0.0};
+  } else if (name == "Z") {
+    return {1.0, 0.0, 0.0, -1.0};
+  } else if (name == "S") {
+    return {1.0, 0.0, 0.0, I};
+  } else if (name == "Sdg") {
+    return {1.0, 0.0, 0.0, -I};
+  } else if (name == "T") {
+    return {1.0, 0.0, 0.0, std::exp(I * M_PI / 4.0)};
+  } else if (name == "Tdg") {
+    return {1.0, 0.0, 0.0, std::exp(-I * M_PI / 4.0)};
+  } else if (name == "I") {
+    return {1.0, 0.0, 0.0, 1.0};
+  } else if (name == "Rx" && angles.size() == 1) {
+    return {c, -I * s, -I * s, c};
+  } else if (name == "Ry" && angles.size() == 1) {
+    return {c, -s, s, c};
+  } else if (name == "Rz" && angles.size() == 1) {
+    return {std::exp(-I * angles[0] / 2.0), 0.0, 0.0,
+            std::exp(I * angles[0] / 2.0)};
+  } else if (name == "U" && angles.size() == 3) {
+    const auto eP = std::exp(I * angles[1]);
+    const auto eL = std::exp(I * angles[2]);
+    return {c, -eL * s, eP * s, eP * eL * c};
+  } else if (name == "CNOT") {
+    return controlled({0.0, 1.0, 1.0, 0.0});
+  } else if (name == "CY") {
+    return controlled({0.0, -I, I, 0.0});
+  } else if (name == "CZ") {
+    return controlled({1.0, 0.0, 0.0, -1.0});
+  } else if (name == "CH") {
+    const double h = 1.0 / std::sqrt(2.0);
+    return controlled({h, h, h, -h});
+  } else if (name == "Swap") {
+    return {1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0,
+            0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0};
+  } else if (name == "CRZ" && angles.size() == 1) {
+    return controlled({std::exp(-I * angles[0] / 2.0), 0.0, 0.0,
+                       std::exp(I * angles[0] / 2.0)});
+  } else if (name == "CPhase" && angles.size() == 1) {
+    return controlled({1.0, 0.0, 0.0, std::exp(I * angles[0])});
+  }
+  xacc::error("QAOA light cone: unsupported instruction '" + name + "'.");
+  return {};
+}
+
+bool isDiagonalGate(const std::string &in_name) {
+  static const std::set<std::string> diagonalGates{
+      "I", "Z", "S", "Sdg", "T", "Tdg", "Rz", "CZ", "CRZ", "CPhase"};
+  return diagonalGates.count(in_name) > 0;
+}
+
+// Gates [begin, end) of the flattened circuit and their qubits
+struct GateBlock {
+  std::size_t begin;
+  std::size_t end;
+  // Diagonal in the computational basis, e.g. the CNOT - Rz - CNOT of a
+  // Z..Z exponential: all the diagonal blocks commute.
+  bool diagonal;
+  std::vector<std::size_t> qubits;
+};
+
+// Splits the gates into single gates and the shortest diagonal sequences of
+// CNOT and diagonal gates (the CNOTs compose to the identity parity map).
+std::vector<GateBlock>
+toBlocks(const std::vector<std::shared_ptr<xacc::Instruction>> &in_gates) {
+  std::vector<GateBlock> blocks;
+  for (std::size_t i = 0; i < in_gates.size();) {
+    if (isDiagonalGate(in_gates[i]->name())) {
+      blocks.push_back({i, i + 1, true, in_gates[i]->bits()});
+      ++i;
+      continue;
+    }
+    if (in_gates[i]->name() == "CNOT") {
+      // Parity map of the CNOTs: qubit -> the qubits it is the XOR of
+      std::map<std::size_t, std::set<std::size_t>> parities;
+      const auto parity = [&](std::size_t in_qubit) -> std::set<std::size_t> & {
+        auto iter = parities.find(in_qubit);
+        if (iter == parities.end()) {
+          iter = parities.emplace(in_qubit, std::set<std::size_t>{in_qubit})
+                     .first;
+        }
+        return iter->second;
+      };
+      std::set<std::size_t> qubits;
+      std::size_t end = 0;
+      for (std::size_t j = i; j < in_gates.size(); ++j) {
+        const auto name = in_gates[j]->name();
+        const auto bits = in_gates[j]->bits();
+        if (name == "CNOT") {
+          auto &target = parity(bits[1]);
+          for (const auto &q : parity(bits[0])) {
+            if (!target.erase(q)) {
+              target.insert(q);
+            }
+          }
+        } else if (!isDiagonalGate(name)) {
+          break;
+        }
+        qubits.insert(bits.begin(), bits.end());
+        const bool isIdentity = std::all_of(
+            parities.begin(), parities.end(), [](const auto &entry) {
+              return entry.second.size() == 1 &&
+                     *entry.second.begin() == entry.first;
+            });
+        if (isIdentity) {
+          end = j + 1;
+          break;
+        }
+      }
+      if (end > 0) {
+        blocks.push_back(
+            {i, end, true, std::vector<std::size_t>(qubits.begin(),
+                                                    qubits.end())});
+        i = end;
+        continue;
+      }
+    }
+    blocks.push_back({i, i + 1, false, in_gates[i]->bits()});
+    ++i;
+  }
+  return blocks;
+}
+
+// Applies a gate matrix on the given qubits (qubit q is bit q of the index),
+// the local index of a 2-qubit gate is 2 * bit(qubits[0]) + bit(qubits[1]).
+void applyMat(StateVec &io_state, const std::vector<size_t> &in_qubits,
+              const GateMat &in_mat) {
+  if (in_qubits.size() == 1) {
+    const size_t mask = 1ULL << in_qubits[0];
+    for (size_t i = 0; i < io_state.size(); ++i) {
+      if (i & mask) {
+        continue;
+      }
+      const auto a = io_state[i];
+      const auto b = io_state[i | mask];
+      io_state[i] = in_mat[0] * a + in_mat[1] * b;
+      io_state[i | mask] = in_mat[2] * a + in_mat[3] * b;
+    }
+    return;
+  }
+  const size_t mask0 = 1ULL << in_qubits[0];
+  const size_t mask1 = 1ULL << in_qubits[1];
+  for (size_t i = 0; i < io_state.size(); ++i) {
+    if ((i & mask0) || (i & mask1)) {
+      continue;
+    }
+    const size_t idx[4] = {i, i | mask1, i | mask0, i | mask0 | mask1};
+    std::complex<double> in[4];
+    for (size_t k = 0; k < 4; ++k) {
+      in[k] = io_state[idx[k]];
+    }
+    for (size_t row = 0; row < 4; ++row) {
+      std::complex<double> val = 0.0;
+      for (size_t col = 0; col < 4; ++col) {
+        val += in_mat[row * 4 + col] * in[col];
+      }
+      io_state[idx[row]] = val;
+    }
+  }
+}
+} // namespace
+
+namespace xacc {
+namespace algorithm {
+LightConeEvaluator::LightConeEvaluator(
+    std::shared_ptr<CompositeInstruction> in_kernel,
+    xacc::quantum::PauliOperator &in_costHam, std::size_t in_maxQubits)
+    : m_kernel(in_kernel) {
+  const auto gates = flatten(m_kernel);
+  m_nbGates = gates.size();
+  for (const auto &gate : gates) {
+    if (gate->bits().size() > 2) {
+      xacc::error("QAOA light cone: unsupported instruction '" +
+                  gate->name() + "' (more than 2 qubits).");
+    }
+  }
+  const auto blocks = toBlocks(gates);
+
+  // Structural key of a cone -> index in m_cones
+  std::unordered_map<std::string, std::size_t> coneIndex;
+  for (auto &[termName, term] : in_costHam.getTerms()) {
+    // Cone labels: the term qubits first (ascending), then the other qubits
+    // in the order they enter the cone.
+    std::unordered_map<std::size_t, std::size_t> label;
+    std::map<std::size_t, std::string> termOps;
+    for (auto &[qubit, op] : term.ops()) {
+      if (op != "I" && !op.empty()) {
+        termOps.emplace(qubit, op);
+      }
+    }
+    if (termOps.empty()) {
+      m_identityCoeff += std::real(term.coeff());
+      continue;
+    }
+    ++m_nbTerms;
+    for (const auto &[qubit, op] : termOps) {
+      label.emplace(qubit, label.size());
+    }
+
+    // Reverse light cone: a gate is in the cone if it acts on a qubit of
+    // the cone, and then all of its qubits are. Consecutive diagonal blocks
+    // commute, i.e. those that do not touch the cone (before the run) are
+    // not in it, e.g. the cost layer only spreads the cone to the neighbors.
+    const auto touchesCone = [&](const GateBlock &in_block) {
+      return std::any_of(
+          in_block.qubits.begin(), in_block.qubits.end(),
+          [&](std::size_t bit) { return label.count(bit) > 0; });
+    };
+    std::vector<std::size_t> coneBlocks;
+    for (std::size_t b = blocks.size(); b-- > 0;) {
+      std::size_t runBegin = b;
+      if (blocks[b].diagonal) {
+        while (runBegin > 0 && blocks[runBegin - 1].diagonal) {
+          --runBegin;
+        }
+      }
+      std::vector<std::size_t> inCone;
+      for (std::size_t r = b + 1; r-- > runBegin;) {
+        if (touchesCone(blocks[r])) {
+          inCone.emplace_back(r);
+        }
+      }
+      for (const auto &r : inCone) {
+        coneBlocks.emplace_back(r);
+        for (const auto &bit : blocks[r].qubits) {
+          label.emplace(bit, label.size());
+        }
+      }
+      if (label.size() > in_maxQubits) {
+        xacc::error("QAOA light cone: the cone of term " + termName +
+                    " has more than " + std::to_string(in_maxQubits) +
+                    " qubits ('light-cone-max-qubits').");
+      }
+      b = runBegin;
+    }
+    std::vector<std::size_t> coneGates;
+    for (const auto &r : coneBlocks) {
+      for (std::size_t g = blocks[r].end; g-- > blocks[r].begin;) {
+        coneGates.emplace_back(g);
+      }
+    }
+    std::reverse(coneGates.begin(), coneGates.end());
+
+    Cone cone;
+    cone.nbQubits = label.size();
+    cone.gates = coneGates;
+    std::stringstream key;
+    for (const auto &g : coneGates) {
+      std::vector<std::size_t> bits;
+      key << gates[g]->name() << "(";
+      for (const auto &bit : gates[g]->bits()) {
+        bits.emplace_back(label[bit]);
+        key << bits.back() << ",";
+      }
+      for (const auto &param : gates[g]->getParameters()) {
+        key << param.toString() << ",";
+      }
+      key << ")";
+      cone.bits.emplace_back(std::move(bits));
+    }
+    key << "|";
+    for (const auto &[qubit, op] : termOps) {
+      const auto bit = uint64_t(1) << label[qubit];
+      key << op << label[qubit];
+      if (op == "X" || op == "Y") {
+        cone.xMask |= bit;
+      }
+      if (op == "Z" || op == "Y") {
+        cone.zMask |= bit;
+      }
+      cone.nbY += op == "Y";
+    }
+
+    const auto [iter, isNew] =
+        coneIndex.emplace(key.str(), m_cones.size());
+    if (isNew) {
+      m_cones.emplace_back(std::move(cone));
+    }
+    m_cones[iter->second].coeff += std::real(term.coeff());
+  }
+
+  std::stringstream ss;
+  ss << "QAOA light cone: " << m_nbTerms << " terms, " << m_cones.size()
+     << " distinct cones of up to " << maxConeQubits() << " qubits.";
+  xacc::info(ss.str());
+}
+
+std::size_t LightConeEvaluator::maxConeQubits() const {
+  std::size_t result = 0;
+  for (const auto &cone : m_cones) {
+    result = std::max(result, cone.nbQubits);
+  }
+  return result;
+}
+
+double LightConeEvaluator::energy(const std::vector<double> &in_x) const {
+  const auto gates = flatten(m_kernel->operator()(in_x));
+  if (gates.size() != m_nbGates) {
+    xacc::error("QAOA light cone: circuit structure must not depend on the "
+                "parameters.");
+  }
+  std::vector<double> values(m_cones.size());
+  xacc::getTaskScheduler()->parallelFor(
+      0, m_cones.size(), [&](std::size_t beginIdx, std::size_t endIdx) {
+        for (std::size_t i = beginIdx; i < endIdx; ++i) {
+          values[i] = simulate(m_cones[i], gates);
+        }
+      });
+  double result = m_identityCoeff;
+  for (std::size_t i = 0; i < m_cones.size(); ++i) {
+    result += m_cones[i].coeff * values[i];
+  }
+  return result;
+}
+
+std::vector<double>
+LightConeEvaluator::gradient(const std::vector<double> &in_x,
+                             double in_step) const {
+  std::vector<double> result(in_x.size());
+  for (std::size_t k = 0; k < in_x.size(); ++k) {
+    auto xPlus = in_x;
+    auto xMinus = in_x;
+    xPlus[k] += in_step;
+    xMinus[k] -= in_step;
+    result[k] = (energy(xPlus) - energy(xMinus)) / (2.0 * in_step);
+  }
+  return result;
+}
+
+std::vector<std::shared_ptr<Instruction>> LightConeEvaluator::flatten(
+    const std::shared_ptr<CompositeInstruction> &in_circuit) const {
+  std::vector<std::shared_ptr<Instruction>> result;
+  InstructionIterator it(in_circuit);
+  while (it.hasNext()) {
+    auto nextInst = it.next();
+    if (nextInst->isEnabled() && !nextInst->isComposite()) {
+      if (nextInst->name() == "Measure") {
+        xacc::error("QAOA light cone: the ansatz must not have measurements.");
+      }
+      result.emplace_back(nextInst);
+    }
+  }
+  return result;
+}
+
+double LightConeEvaluator::simulate(
+    const Cone &in_cone,
+    const std::vector<std::shared_ptr<Instruction>> &in_gates) {
+  StateVec state(std::size_t(1) << in_cone.nbQubits, 0.0);
+  state[0] = 1.0;
+  for (std::size_t i = 0; i < in_cone.gates.size(); ++i) {
+    applyMat(state, in_cone.bits[i], gateMatrix(*in_gates[in_cone.gates[i]]));
+  }
+
+  // P|j> = i^nbY (-1)^|j & zMask| |j ^ xMask>
+  std::complex<double> result = 0.0;
+  for (std::size_t j = 0; j < state.size(); ++j) {
+    const double sign = (__builtin_popcountll(j & in_cone.zMask) & 1) ? -1.0
+                                                                     : 1.0;
+    result += std::conj(state[j ^ in_cone.xMask]) * sign * state[j];
+  }
+  static const std::complex<double> powersOfI[4] = {
+      {1.0, 0.0}, {0.0, 1.0}, {-1.0, 0.0}, {0.0, -1.0}};
+  return std::real(powersOfI[in_cone.nbY & 3] * result);
+}
+} // namespace algorithm
+} // namespace xacc
@@ -0,0 +1,80 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#pragma once
+
+#include "CompositeInstruction.hpp"
+#include "PauliOperator.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace xacc {
+namespace algorithm {
+// Exact cost expectation value of a QAOA state, term by term on the reverse
+// light cones: <psi(x)|P|psi(x)> only depends on the gates that reach the
+// qubits of P when walking the circuit backwards, i.e. a subcircuit on a few
+// qubits for sparse graphs and shallow circuits. The diagonal gate blocks of
+// the cost layers (e.g. CNOT - Rz - CNOT) commute, so a layer only extends
+// the cone to the neighboring qubits, whatever the order of the terms.
+// Cones with the same structure (gates, relabeled qubits, parameter
+// expressions and term) are simulated once, the distinct ones in parallel.
+class LightConeEvaluator
+{
+public:
+    // in_kernel: the parameterized (unevaluated) ansatz of a QAOA run.
+    // Errors if a cone has more than in_maxQubits qubits.
+    LightConeEvaluator(std::shared_ptr<CompositeInstruction> in_kernel,
+                       xacc::quantum::PauliOperator& in_costHam,
+                       std::size_t in_maxQubits);
+
+    // Cost expectation value at x
+    double energy(const std::vector<double>& in_x) const;
+    // d(energy)/dx by central differences (of exact expectation values)
+    std::vector<double> gradient(const std::vector<double>& in_x,
+                                 double in_step = 1e-5) const;
+
+    std::size_t nbTerms() const { return m_nbTerms; }
+    std::size_t nbCones() const { return m_cones.size(); }
+    std::size_t maxConeQubits() const;
+
+private:
+    struct Cone
+    {
+        std::size_t nbQubits = 0;
+        // Gate indices in the flattened kernel, in circuit order,
+        // and their qubits in the cone labeling.
+        std::vector<std::size_t> gates;
+        std::vector<std::vector<std::size_t>> bits;
+        // The (relabeled) Pauli term
+        uint64_t xMask = 0;
+        uint64_t zMask = 0;
+        int nbY = 0;
+        // Sum of the coefficients of the terms with this cone
+        double coeff = 0.0;
+    };
+
+    std::vector<std::shared_ptr<Instruction>>
+    flatten(const std::shared_ptr<CompositeInstruction>& in_circuit) const;
+    static double
+    simulate(const Cone& in_cone,
+             const std::vector<std::shared_ptr<Instruction>>& in_gates);
+
+    std::shared_ptr<CompositeInstruction> m_kernel;
+    std::vector<Cone> m_cones;
+    std::size_t m_nbTerms = 0;
+    std::size_t m_nbGates = 0;
+    double m_identityCoeff = 0.0;
+};
+} // namespace algorithm
+} // namespace xacc
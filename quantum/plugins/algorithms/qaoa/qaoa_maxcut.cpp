@@ -256,6 +256,21 @@ namespace algorithm {
         if (parameters.keyExists<bool>("shuffle-terms")) {
           m_shuffleTerms = parameters.get<bool>("shuffle-terms");
         }
+        // The MaxCut Hamiltonian is diagonal: QAOA can evaluate it (and the
+        // CVaR/Gibbs objectives) from the counts of a single circuit.
+        m_costOptions = HeterogeneousMap();
+        if (parameters.keyExists<bool>("diagonal-sampling")) {
+          m_costOptions.insert("diagonal-sampling",
+                               parameters.get<bool>("diagonal-sampling"));
+        }
+        if (parameters.stringExists("objective")) {
+          m_costOptions.insert("objective", parameters.getString("objective"));
+        }
+        for (const std::string key : {"cvar-alpha", "gibbs-eta"}) {
+          if (parameters.keyExists<double>(key)) {
+            m_costOptions.insert(key, parameters.get<double>(key));
+          }
+        }
         if (m_optimizer && m_optimizer->isGradientBased() &&
             gradientStrategy == nullptr) {
             // No gradient strategy was provided, just use autodiff.
@@ -279,6 +294,7 @@ namespace algorithm {
         m.insert("steps", m_nbSteps);
         m.insert("parameter-scheme", "Standard");
         m.insert("shuffle-terms", m_shuffleTerms);
+        m.merge(m_costOptions);
 
         if (m_initializationMode == "warm-start") {
             m.insert("initial-state", warm_start(m_graph));
@@ -300,6 +316,7 @@ namespace algorithm {
         m.insert("steps", m_nbSteps);
         m.insert("parameter-scheme", "Standard");
         m.insert("shuffle-terms", m_shuffleTerms);
+        m.merge(m_costOptions);
 
         // If: warm-start selected, call the warm start function
         // and use as initial-state.
@@ -47,6 +47,9 @@ private:
     bool m_maximize = false;
     CompositeInstruction* m_initial_state = nullptr;
     bool m_shuffleTerms = false;
+    // Cost evaluation options forwarded to QAOA: 'diagonal-sampling',
+    // 'objective', 'cvar-alpha' and 'gibbs-eta'.
+    HeterogeneousMap m_costOptions;
 };
 } // namespace algorithm
 } // namespace xacc
@@ -117,9 +117,120 @@ TEST(QAOATester, checkP1TriangleGraph) {
   }
 }
 
+TEST(QAOATester, checkDiagonalSampling) {
+  auto acc = xacc::getAccelerator("qpp", {{"shots", 8192}});
+  auto optimizer = xacc::getOptimizer("nlopt");
+  auto H = xacc::quantum::getObservable(
+      "pauli", std::string("1.5 I - 0.5 Z0 Z1 - 0.5 Z0 Z2 - 0.5 Z1 Z2"));
+  // One sampled circuit per evaluation for the diagonal cost Hamiltonian
+  auto qaoa = xacc::getAlgorithm("QAOA", {{"accelerator", acc},
+                                          {"optimizer", optimizer},
+                                          {"observable", H},
+                                          {"steps", 1},
+                                          {"parameter-scheme", "Standard"},
+                                          {"diagonal-sampling", true}});
+  auto cvar = xacc::getAlgorithm("QAOA", {{"accelerator", acc},
+                                          {"optimizer", optimizer},
+                                          {"observable", H},
+                                          {"steps", 1},
+                                          {"parameter-scheme", "Standard"},
+                                          {"maximize", true},
+                                          {"objective", "cvar"},
+                                          {"cvar-alpha", 0.25}});
+  for (auto gamma : {-2.0, -0.5, 1.0}) {
+    for (auto beta : {-0.3, 0.2}) {
+      auto buffer = xacc::qalloc(3);
+      auto cost = qaoa->execute(buffer, std::vector<double>{gamma, beta})[0];
+      auto theory = 3 * (.5 +
+                         .25 * std::sin(4 * beta) * std::sin(gamma) *
+                             (std::cos(gamma) + std::cos(gamma)) -
+                         .25 * std::sin(2 * beta) * std::sin(2 * beta) *
+                             (1 - std::cos(2 * gamma)));
+      EXPECT_NEAR(cost, theory, 0.1);
+      EXPECT_EQ(buffer->nChildren(), 1);
+
+      // Mean over the best quarter of the samples (the max cut is 2)
+      auto cvarBuffer = xacc::qalloc(3);
+      auto cvarCost =
+          cvar->execute(cvarBuffer, std::vector<double>{gamma, beta})[0];
+      EXPECT_GT(cvarCost, theory - 0.1);
+      EXPECT_LE(cvarCost, 2.0 + 1e-9);
+    }
+  }
+}
+
 // Making sure that a set of Hadamards can be passed
 // as the "initial-state" to the QAOA algorithm and 
 // the proper result is returned
+TEST(QAOATester, checkLightCone) {
+  auto acc = xacc::getAccelerator("qpp");
+  auto optimizer = xacc::getOptimizer("nlopt");
+  // Ring of 10 qubits: the p = 2 cones only have 6 qubits.
+  std::string ring;
+  for (int i = 0; i < 10; ++i) {
+    ring += " + Z" + std::to_string(i) + " Z" + std::to_string((i + 1) % 10);
+  }
+  auto H = xacc::quantum::getObservable("pauli", "0.5 " + ring);
+  auto qaoa = xacc::getAlgorithm("QAOA", {{"accelerator", acc},
+                                          {"optimizer", optimizer},
+                                          {"observable", H},
+                                          {"steps", 2},
+                                          {"parameter-scheme", "Standard"}});
+  auto lightCone = xacc::getAlgorithm("QAOA", {{"accelerator", acc},
+                                               {"optimizer", optimizer},
+                                               {"observable", H},
+                                               {"steps", 2},
+                                               {"parameter-scheme", "Standard"},
+                                               {"light-cone", true},
+                                               {"light-cone-max-qubits", 6}});
+  for (const auto &x : std::vector<std::vector<double>>{
+           {0.3, -0.7, 1.1, 0.2}, {-1.2, 0.4, 0.5, -0.9}}) {
+    auto buffer = xacc::qalloc(10);
+    auto coneBuffer = xacc::qalloc(10);
+    const auto energy = qaoa->execute(buffer, x)[0];
+    const auto coneEnergy = lightCone->execute(coneBuffer, x)[0];
+    EXPECT_NEAR(coneEnergy, energy, 1e-8);
+    EXPECT_EQ(coneBuffer->nChildren(), 1);
+  }
+}
+
+TEST(QAOATester, checkParameterStore) {
+  const std::string storeFile = "qaoa_parameter_store.json";
+  std::remove(storeFile.c_str());
+  auto acc = xacc::getAccelerator("qpp");
+  // Rings of 4 and 5 qubits: the same (2-regular) family
+  std::vector<std::vector<double>> optParams;
+  for (int n : {4, 5}) {
+    std::string ring = "0.0 I";
+    for (int i = 0; i < n; ++i) {
+      ring += " + 0.5 Z" + std::to_string(i) + " Z" +
+              std::to_string((i + 1) % n);
+    }
+    auto H = xacc::quantum::getObservable("pauli", ring);
+    auto optimizer = xacc::getOptimizer(
+        "nlopt", {{"initial-parameters", std::vector<double>{0.1, 0.1}}});
+    auto qaoa = xacc::getAlgorithm("QAOA", {{"accelerator", acc},
+                                            {"optimizer", optimizer},
+                                            {"observable", H},
+                                            {"steps", 1},
+                                            {"parameter-scheme", "Standard"},
+                                            {"parameter-store", storeFile}});
+    auto buffer = xacc::qalloc(n);
+    qaoa->execute(buffer);
+    if (n == 5) {
+      // Warm started from the optimum of the 4-qubit ring
+      auto firstParams = buffer->getChildren()[0]
+                             ->getInformation("parameters")
+                             .as<std::vector<double>>();
+      EXPECT_EQ(firstParams, optParams[0]);
+    }
+    optParams.emplace_back(
+        (*buffer)["opt-params"].as<std::vector<double>>());
+  }
+  std::remove(storeFile.c_str());
+  std::remove((storeFile + ".lock").c_str());
+}
+
 TEST(QAOATester, checkInitialStateConstruction) {
   auto acc = xacc::getAccelerator("qpp");
   auto buffer = xacc::qalloc(2);
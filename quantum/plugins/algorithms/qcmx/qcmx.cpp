@@ -21,6 +21,7 @@
 #include <iomanip>
 #include <memory>
 #include <sstream>
+#include <unordered_set>
 #include <string>
 #include <vector>
 
@@ -80,6 +81,19 @@ bool QCMX::initialize(const HeterogeneousMap &parameters) {
                std::to_string(threshold));
   }
 
+  grouping = "";
+  if (parameters.stringExists("grouping")) {
+    grouping = parameters.getString("grouping");
+    if (grouping == "none") {
+      grouping = "";
+    }
+    if (!grouping.empty() && grouping != "qwc") {
+      xacc::error("Invalid 'grouping' " + grouping +
+                  ", valid modes are none and qwc.");
+      return false;
+    }
+  }
+
   // in case the ansatz is parameterized
   if (parameters.keyExists<std::vector<double>>("parameters")) {
     x = parameters.get<std::vector<double>>("parameters");
@@ -99,15 +113,20 @@ void QCMX::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
   std::map<std::string, double> energies;
 
   auto H = *std::dynamic_pointer_cast<PauliOperator>(observable);
-  auto momentOperator = H;
+  // All the powers H, ..., H^(2K - 1) are formed first, their Pauli
+  // strings overlap so they are measured together.
+  std::vector<PauliOperator> powers{H};
+  for (int i = 1; i < 2 * maxOrder - 1; i++) {
+    powers.push_back(powers.back() * H);
+  }
+  const auto allMoments = measureMoments(powers, buffer->size());
+
   std::vector<double> moments;
   // The energy computation itself is just classical post processing
   // So we can compute the energy from all implemented expansions
   // because the bottleneck is the quantum computation of the moments
   for (int i = 0; i < 2 * maxOrder - 1; i++) {
-    auto momentExpValue = measureOperator(
-        std::make_shared<PauliOperator>(momentOperator), buffer->size());
-    moments.push_back(momentExpValue);
+    moments.push_back(allMoments[i]);
 
     double e;
     if ((i != 0) && (i % 2 == 0)) {
@@ -139,8 +158,6 @@ void QCMX::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
       xacc::info(ss.str());
       ss.str(std::string());
     }
-
-    momentOperator *= H;
   }
 
   // add energy to the buffer
@@ -149,49 +166,83 @@ void QCMX::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
   return;
 }
 
-double QCMX::measureOperator(const std::shared_ptr<Observable> obs,
-                             const int bufferSize) const {
-
-  std::vector<std::shared_ptr<CompositeInstruction>> kernels;
-  if (x.empty()) {
-    kernels = obs->observe(xacc::as_shared_ptr(kernel));
-  } else {
-    auto evaled = kernel->operator()(x);
-    kernels = obs->observe(evaled);
-  }
-
-  // we loop over all measured circuits
-  // and check if that term has been measured
-  // if so, we just multiply the measurement by the coefficient
-  // We gather all new circuits into fsToExec and execute
-  // Because these are all commutators, we don't need to worry about the I term
-  // Also, terms with small coeffs can be ignored by setting threshold below
-  std::vector<std::shared_ptr<CompositeInstruction>> fsToExec;
-  std::vector<std::complex<double>> coefficients;
-  double total = 0.0;
-  for (auto &f : kernels) {
-    std::complex<double> coeff = f->getCoefficient();
-    if (cachedMeasurements.find(f->name()) != cachedMeasurements.end()) {
-      total += std::real(coeff * cachedMeasurements[f->name()]);
-    } else if (std::fabs(coeff.real()) >= threshold) {
-      fsToExec.push_back(f);
-      coefficients.push_back(coeff);
+std::vector<double>
+QCMX::measureMoments(const std::vector<PauliOperator> &powers,
+                     const int bufferSize) const {
+
+  // The union of the Pauli strings of all the powers, without the identity
+  // (added classically), those already measured and those whose coefficient
+  // is below threshold in every power.
+  auto measured = std::make_shared<PauliOperator>();
+  std::unordered_set<std::string> toMeasure;
+  for (auto &power : powers) {
+    for (auto &[termId, term] : power.getTerms()) {
+      if (term.isIdentity() || cachedMeasurements.count(termId) ||
+          toMeasure.count(termId) ||
+          std::fabs(std::real(term.coeff())) < threshold) {
+        continue;
+      }
+      toMeasure.insert(termId);
+      *measured += PauliOperator(term.ops(), 1.0);
     }
   }
 
-  // for circuits that have not been executed previously
-  auto tmpBuffer = xacc::qalloc(bufferSize);
-  accelerator->execute(tmpBuffer, fsToExec);
-  auto buffers = tmpBuffer->getChildren();
+  // One batch for all the moments
   xacc::info("Number of terms to be measured = " +
-             std::to_string(fsToExec.size()));
-  for (int i = 0; i < fsToExec.size(); i++) {
-    auto expval = buffers[i]->getExpectationValueZ();
-    total += std::real(expval * coefficients[i]);
-    cachedMeasurements.emplace(fsToExec[i]->name(), expval);
+             std::to_string(toMeasure.size()));
+  if (!toMeasure.empty()) {
+    if (!grouping.empty()) {
+      measured->fromOptions({{"grouping", grouping}});
+    }
+    auto ansatz =
+        x.empty() ? xacc::as_shared_ptr(kernel) : kernel->operator()(x);
+    auto tmpBuffer = xacc::qalloc(bufferSize);
+    accelerator->computeExpectations(tmpBuffer, ansatz, measured);
+    if (grouping == "qwc") {
+      const HeterogeneousMap postProcessOptions{std::make_pair(
+          "bit-order",
+          std::string(accelerator->getBitOrder() == Accelerator::BitOrder::MSB
+                          ? "MSB"
+                          : "LSB"))};
+      measured->postProcess(tmpBuffer,
+                            Observable::PostProcessingTask::EXP_VAL_CALC,
+                            postProcessOptions);
+    }
+    for (auto &childBuffer : tmpBuffer->getChildren()) {
+      if (grouping == "qwc") {
+        for (auto &[termId, expVal] :
+             mpark::get<std::map<std::string, double>>(
+                 childBuffer->getInformation("term-exp-vals"))) {
+          cachedMeasurements.emplace(termId, expVal);
+        }
+      } else {
+        auto termName = childBuffer->name();
+        if (termName.rfind("evaled_", 0) == 0) {
+          termName.erase(0, 7);
+        }
+        cachedMeasurements.emplace(termName,
+                                   childBuffer->getExpectationValueZ());
+      }
+    }
   }
 
-  return total;
+  // Every moment from the shared expectation values
+  std::vector<double> moments;
+  for (auto &power : powers) {
+    double total = 0.0;
+    for (auto &[termId, term] : power.getTerms()) {
+      if (term.isIdentity()) {
+        total += std::real(term.coeff());
+        continue;
+      }
+      auto iter = cachedMeasurements.find(termId);
+      if (iter != cachedMeasurements.end()) {
+        total += std::real(term.coeff() * iter->second);
+      }
+    }
+    moments.push_back(total);
+  }
+  return moments;
 }
 
 // Compute energy from CMX
@@ -19,6 +19,7 @@
 
 #include "Algorithm.hpp"
 #include "Observable.hpp"
+#include "PauliOperator.hpp"
 
 namespace xacc {
 namespace algorithm {
@@ -42,8 +43,14 @@ protected:
   // spectrum is only for PDS
   mutable std::vector<double> spectrum;
 
-  double measureOperator(const std::shared_ptr<Observable> obs,
-                         const int bufferSize) const;
+  // "qwc" to measure the qubit-wise commuting terms together
+  std::string grouping;
+
+  // <H^k> for each of the powers, the distinct Pauli strings of all the
+  // powers being measured in a single batch.
+  std::vector<double>
+  measureMoments(const std::vector<quantum::PauliOperator> &powers,
+                 const int bufferSize) const;
 
   // Compute energy from PDS CMX
   double PDS(const std::vector<double> &moments, const int order) const;
@@ -23,10 +23,13 @@
 #include "xacc_observable.hpp"
 #include <Eigen/Dense>
 #include <Eigen/Eigenvalues>
+#include <array>
 #include <memory>
 #include <sstream>
+#include <unordered_set>
 #include <vector>
 #include "OperatorPool.hpp"
+#include "DistributedExecution.hpp"
 
 using namespace xacc;
 using namespace xacc::quantum;
@@ -63,6 +66,10 @@ bool qEOM::initialize(const HeterogeneousMap &parameters) {
   observable =
       xacc::as_shared_ptr(parameters.getPointerLike<Observable>("observable"));
 
+  if (parameters.keyExists<bool>("distributed-pool")) {
+    distributedPool = parameters.get<bool>("distributed-pool");
+  }
+
   if (parameters.keyExists<std::vector<std::shared_ptr<Observable>>>(
           "operators")) {
     operators =
@@ -141,55 +148,94 @@ void qEOM::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
     auto A_HB = *std::dynamic_pointer_cast<PauliOperator>(A->commutator(HB));
 
     // 1/2 x ([[A,H],B] + [A,[H,B]])
-    auto ret = 0.5 * (AH_B + A_HB);
-    return std::dynamic_pointer_cast<Observable>(
-        std::make_shared<PauliOperator>(ret));
+    return 0.5 * (AH_B + A_HB);
+  };
+  auto asPauli = [](std::shared_ptr<Observable> op) {
+    return *std::dynamic_pointer_cast<PauliOperator>(op);
   };
 
   // Here we loop over operators on the left and on the right,
-  // which I loosely refer to as bra and ket
-  // loop over bra
+  // which I loosely refer to as bra and ket, j >= i.
+  std::vector<std::pair<int, int>> pairs;
   for (int i = 0; i < nOperators; i++) {
-
-    auto tmp_bra = (*std::dynamic_pointer_cast<PauliOperator>(operators[i]))
-                       .hermitianConjugate();
-    auto bra = std::dynamic_pointer_cast<Observable>(
-        std::make_shared<PauliOperator>(tmp_bra));
-
-    // loop over ket
     for (int j = i; j < nOperators; j++) {
+      pairs.emplace_back(i, j);
+    }
+  }
 
-      auto ket = operators[j];
-      auto tmp_ketConj =
-          (*std::dynamic_pointer_cast<PauliOperator>(operators[j]))
-              .hermitianConjugate();
-      auto ketConj = std::dynamic_pointer_cast<Observable>(
-          std::make_shared<PauliOperator>(tmp_ketConj));
-
-      // qEOM matrix elements
-      auto M_MatOperator = doubleCommutator(bra, ket);
-      if (!M_MatOperator->getSubTerms().empty()) {
-        M(i, j) = measureOperator(M_MatOperator, buffer);
-        M(j, i) = M(i, j);
-      }
-
-      auto Q_MatOperator = doubleCommutator(bra, ketConj);
-      if (!Q_MatOperator->getSubTerms().empty()) {
-        Q(i, j) = measureOperator(Q_MatOperator, buffer);
-        Q(j, i) = Q(i, j);
-      }
+  // With an MPI-distributed accelerator, each virtual QPU only builds and
+  // measures the elements of its slice of the pairs, on its own QPU; the
+  // matrices are then summed over the virtual QPUs.
+  auto distributed =
+      distributedPool ? dynamic_cast<DistributedExecution *>(accelerator)
+                      : nullptr;
+  if (distributed && distributed->nbVirtualQpus() < 2) {
+    distributed = nullptr;
+  }
+  size_t pairBegin = 0, pairEnd = pairs.size();
+  Accelerator *qpu = accelerator;
+  std::shared_ptr<Accelerator> localQpu;
+  if (distributed) {
+    std::tie(pairBegin, pairEnd) = distributed->localRange(pairs.size());
+    localQpu = distributed->localAccelerator();
+    qpu = localQpu.get();
+  }
 
-      auto V_MatOperator = bra->commutator(ket);
-      if (!V_MatOperator->getSubTerms().empty()) {
-        V(i, j) = measureOperator(V_MatOperator, buffer);
-        V(j, i) = V(i, j);
-      }
+  // The M, Q, V and W operators of every pair, built in parallel
+  std::vector<std::array<PauliOperator, 4>> elementOperators(pairs.size());
+  xacc::getTaskScheduler()->parallelFor(
+      pairBegin, pairEnd, [&](std::size_t beginIdx, std::size_t endIdx) {
+        for (auto k = beginIdx; k < endIdx; k++) {
+          const auto [i, j] = pairs[k];
+          auto bra = std::dynamic_pointer_cast<Observable>(
+              std::make_shared<PauliOperator>(
+                  asPauli(operators[i]).hermitianConjugate()));
+          auto ket = operators[j];
+          auto ketConj = std::dynamic_pointer_cast<Observable>(
+              std::make_shared<PauliOperator>(
+                  asPauli(operators[j]).hermitianConjugate()));
+
+          // qEOM matrix elements
+          elementOperators[k] = {doubleCommutator(bra, ket),
+                                 doubleCommutator(bra, ketConj),
+                                 asPauli(bra->commutator(ket)),
+                                 asPauli(bra->commutator(ketConj))};
+        }
+      });
+
+  // Their distinct Pauli strings are measured once, then every element is
+  // read from the expectation values.
+  std::vector<PauliOperator> allOperators;
+  allOperators.reserve(4 * (pairEnd - pairBegin));
+  for (auto k = pairBegin; k < pairEnd; k++) {
+    auto &ops = elementOperators[k];
+    allOperators.insert(allOperators.end(), ops.begin(), ops.end());
+  }
+  measureTerms(allOperators, buffer, qpu);
+
+  for (int k = pairBegin; k < pairEnd; k++) {
+    const auto [i, j] = pairs[k];
+    auto &ops = elementOperators[k];
+    M(i, j) = M(j, i) = expectationValue(ops[0]);
+    Q(i, j) = Q(j, i) = expectationValue(ops[1]);
+    V(i, j) = V(j, i) = expectationValue(ops[2]);
+    W(i, j) = W(j, i) = expectationValue(ops[3]);
+  }
 
-      auto W_MatOperator = bra->commutator(ketConj);
-      if (!W_MatOperator->getSubTerms().empty()) {
-        W(i, j) = measureOperator(W_MatOperator, buffer);
-        W(j, i) = W(i, j);
-      }
+  if (distributed) {
+    // The elements of the other slices are zero here.
+    std::vector<double> elements;
+    elements.reserve(4 * M.size());
+    for (auto *matrix : {&M, &Q, &V, &W}) {
+      elements.insert(elements.end(), matrix->data(),
+                      matrix->data() + matrix->size());
+    }
+    distributed->allReduceSum(elements);
+    size_t offset = 0;
+    for (auto *matrix : {&M, &Q, &V, &W}) {
+      std::copy(elements.begin() + offset,
+                elements.begin() + offset + matrix->size(), matrix->data());
+      offset += matrix->size();
     }
   }
 
@@ -237,41 +283,51 @@ void qEOM::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
   return;
 }
 
-double
-qEOM::measureOperator(const std::shared_ptr<Observable> obs,
-                      const std::shared_ptr<AcceleratorBuffer> buffer) const {
-
-  // observe
-  auto kernels = obs->observe(xacc::as_shared_ptr(kernel));
-
-  // we loop over all measured circuits
-  // and check if that term has been measured
-  // if so, we just multiply the measurement by the coefficient
-  // We gather all new circuits into fsToExec and execute
-  // Because these are all commutators, we don't need to worry about the I term
-  std::vector<std::shared_ptr<CompositeInstruction>> fsToExec;
-  std::vector<std::complex<double>> coefficients;
-  double total = 0.0;
-  for (auto &f : kernels) {
-    std::complex<double> coeff = f->getCoefficient();
-    if (cachedMeasurements.find(f->name()) != cachedMeasurements.end()) {
-      total += std::real(coeff * cachedMeasurements[f->name()]);
-    } else {
-      fsToExec.push_back(f);
-      coefficients.push_back(coeff);
+void qEOM::measureTerms(
+    const std::vector<PauliOperator> &ops,
+    const std::shared_ptr<AcceleratorBuffer> buffer, Accelerator *qpu) const {
+
+  // The union of the non-identity strings not measured yet
+  auto measured = std::make_shared<PauliOperator>();
+  std::unordered_set<std::string> toMeasure;
+  for (auto &op : ops) {
+    for (auto &[termId, term] : op.getTerms()) {
+      if (!term.isIdentity() && !cachedMeasurements.count(termId) &&
+          toMeasure.insert(termId).second) {
+        *measured += PauliOperator(term.ops(), 1.0);
+      }
     }
   }
+  xacc::info("[qEOM] Measuring " + std::to_string(toMeasure.size()) +
+             " distinct Pauli terms.");
+  if (toMeasure.empty()) {
+    return;
+  }
 
-  // for circuits that have not been executed previously
   auto tmpBuffer = xacc::qalloc(buffer->size());
-  accelerator->execute(tmpBuffer, fsToExec);
-  auto buffers = tmpBuffer->getChildren();
-  for (int i = 0; i < fsToExec.size(); i++) {
-    auto expval = buffers[i]->getExpectationValueZ();
-    total += std::real(expval * coefficients[i]);
-    cachedMeasurements.emplace(fsToExec[i]->name(), expval);
+  qpu->computeExpectations(tmpBuffer, xacc::as_shared_ptr(kernel), measured);
+  for (auto &childBuffer : tmpBuffer->getChildren()) {
+    auto termName = childBuffer->name();
+    if (termName.rfind("evaled_", 0) == 0) {
+      termName.erase(0, 7);
+    }
+    cachedMeasurements.emplace(termName, childBuffer->getExpectationValueZ());
   }
+}
 
+double qEOM::expectationValue(const PauliOperator &op) const {
+  double total = 0.0;
+  for (auto &[termId, term] : op.getTerms()) {
+    if (term.isIdentity()) {
+      total += std::real(term.coeff());
+      continue;
+    }
+    auto iter = cachedMeasurements.find(termId);
+    if (iter == cachedMeasurements.end()) {
+      xacc::error("[qEOM] Term " + termId + " was not measured.");
+    }
+    total += std::real(term.coeff() * iter->second);
+  }
   return total;
 }
 
@@ -24,6 +24,7 @@
 
 #include "Algorithm.hpp"
 #include "xacc.hpp"
+#include "PauliOperator.hpp"
 #include <unordered_map>
 #include <vector>
 
@@ -37,8 +38,17 @@ protected:
   HeterogeneousMap parameters;
   std::vector<std::shared_ptr<Observable>> operators;
   mutable std::unordered_map<std::string, double> cachedMeasurements;
+  // "distributed-pool": partition the operator pairs over the virtual QPUs
+  // of an hpc-virtualization accelerator (DistributedExecution)
+  bool distributedPool = true;
 
-  double measureOperator(const std::shared_ptr<Observable> obs, const std::shared_ptr<AcceleratorBuffer> buffer) const;
+  // Measures the distinct Pauli strings of all the operators in one batch
+  // on qpu, the values being cached in cachedMeasurements.
+  void measureTerms(const std::vector<quantum::PauliOperator> &ops,
+                    const std::shared_ptr<AcceleratorBuffer> buffer,
+                    Accelerator *qpu) const;
+  // <op> from cachedMeasurements
+  double expectationValue(const quantum::PauliOperator &op) const;
 
 public:
   bool initialize(const HeterogeneousMap &parameters) override;
@@ -0,0 +1,163 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace xacc {
+namespace algorithm {
+// Pauli string (up to 32 qubits) in the symplectic form: qubit q is X if only
+// the bit q of x is set, Z if only the bit q of z is set and Y if both are.
+struct PauliCode {
+  uint32_t x = 0;
+  uint32_t z = 0;
+
+  bool operator==(const PauliCode &other) const {
+    return x == other.x && z == other.z;
+  }
+  bool isIdentity() const { return x == 0 && z == 0; }
+
+  // The PauliOperator term representation, e.g. {{0, "X"}, {2, "Z"}}
+  std::map<int, std::string> toOps() const {
+    std::map<int, std::string> ops;
+    for (int q = 0; q < 32; ++q) {
+      const bool hasX = (x >> q) & 1;
+      const bool hasZ = (z >> q) & 1;
+      if (hasX || hasZ) {
+        ops.emplace(q, hasX ? (hasZ ? "Y" : "X") : "Z");
+      }
+    }
+    return ops;
+  }
+
+  static PauliCode fromOps(const std::map<int, std::string> &in_ops) {
+    PauliCode code;
+    for (const auto &[qubit, op] : in_ops) {
+      if (op == "X" || op == "Y") {
+        code.x |= uint32_t(1) << qubit;
+      }
+      if (op == "Z" || op == "Y") {
+        code.z |= uint32_t(1) << qubit;
+      }
+    }
+    return code;
+  }
+};
+
+// The Pauli string of a * b, see productPhase() for the factor.
+inline PauliCode operator*(const PauliCode &a, const PauliCode &b) {
+  return {a.x ^ b.x, a.z ^ b.z};
+}
+
+// a * b = i^k (a ^ b), returns k (mod 4).
+// With P(x, z) = i^|x & z| X^x Z^z (i.e. Y = iXZ), moving Z^(a.z) across
+// X^(b.x) gives a factor (-1)^|a.z & b.x|.
+inline int productPhase(const PauliCode &a, const PauliCode &b) {
+  const auto c = a * b;
+  return (__builtin_popcount(a.x & a.z) + __builtin_popcount(b.x & b.z) +
+          2 * __builtin_popcount(a.z & b.x) - __builtin_popcount(c.x & c.z)) &
+         3;
+}
+
+inline bool commute(const PauliCode &a, const PauliCode &b) {
+  return ((__builtin_popcount(a.x & b.z) + __builtin_popcount(a.z & b.x)) &
+          1) == 0;
+}
+
+// i^k
+inline std::complex<double> phaseFactor(int k) {
+  static const std::complex<double> powersOfI[4] = {
+      {1.0, 0.0}, {0.0, 1.0}, {-1.0, 0.0}, {0.0, -1.0}};
+  return powersOfI[k & 3];
+}
+
+// A list of distinct Pauli strings with an index look-up: index arithmetic
+// for the full basis, a hash map otherwise.
+class PauliBasis {
+public:
+  // All the 4^n Pauli strings on n qubits, the index of (x, z) is
+  // x | z << n, i.e. the identity comes first.
+  static PauliBasis full(int in_nbQubits) {
+    PauliBasis basis;
+    basis.m_nbQubits = in_nbQubits;
+    const uint64_t dim = uint64_t(1) << in_nbQubits;
+    basis.m_codes.reserve(dim * dim);
+    for (uint64_t z = 0; z < dim; ++z) {
+      for (uint64_t x = 0; x < dim; ++x) {
+        basis.m_codes.push_back({uint32_t(x), uint32_t(z)});
+      }
+    }
+    return basis;
+  }
+
+  // All the Pauli strings acting on the given qubits only (identity first)
+  static PauliBasis onQubits(const std::vector<std::size_t> &in_qubits) {
+    const std::size_t nbQubits = in_qubits.size();
+    const uint64_t dim = uint64_t(1) << nbQubits;
+    std::vector<PauliCode> codes;
+    codes.reserve(dim * dim);
+    for (uint64_t k = 0; k < dim * dim; ++k) {
+      PauliCode code;
+      for (std::size_t i = 0; i < nbQubits; ++i) {
+        code.x |= uint32_t((k >> i) & 1) << in_qubits[i];
+        code.z |= uint32_t((k >> (nbQubits + i)) & 1) << in_qubits[i];
+      }
+      codes.emplace_back(code);
+    }
+    return PauliBasis(std::move(codes));
+  }
+
+  explicit PauliBasis(std::vector<PauliCode> in_codes)
+      : m_codes(std::move(in_codes)) {
+    m_index.reserve(m_codes.size());
+    for (std::size_t i = 0; i < m_codes.size(); ++i) {
+      m_index.emplace(key(m_codes[i]), i);
+    }
+  }
+
+  std::size_t size() const { return m_codes.size(); }
+  const PauliCode &operator[](std::size_t in_idx) const {
+    return m_codes[in_idx];
+  }
+
+  // Index of the Pauli string, -1 if it is not in the basis.
+  int64_t find(const PauliCode &in_code) const {
+    if (m_nbQubits >= 0) {
+      if ((in_code.x >> m_nbQubits) != 0 || (in_code.z >> m_nbQubits) != 0) {
+        return -1;
+      }
+      return int64_t(in_code.x) | (int64_t(in_code.z) << m_nbQubits);
+    }
+    const auto iter = m_index.find(key(in_code));
+    return iter == m_index.end() ? -1 : int64_t(iter->second);
+  }
+
+private:
+  PauliBasis() = default;
+  static uint64_t key(const PauliCode &in_code) {
+    return uint64_t(in_code.x) | (uint64_t(in_code.z) << 32);
+  }
+
+  // Number of qubits of the full basis, -1 for an arbitrary list
+  int m_nbQubits = -1;
+  std::vector<PauliCode> m_codes;
+  std::unordered_map<uint64_t, std::size_t> m_index;
+};
+} // namespace algorithm
+} // namespace xacc
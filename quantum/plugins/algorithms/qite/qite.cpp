@@ -17,118 +17,190 @@
 #include "xacc_service.hpp"
 #include "PauliOperator.hpp"
 #include "Circuit.hpp"
+#include "PauliBasis.hpp"
+#include <iomanip>
 #include <memory>
+#include <sstream>
+#include <unordered_map>
 #include <armadillo>
 #include <cassert>
 
 namespace {
+using xacc::algorithm::PauliBasis;
+using xacc::algorithm::PauliCode;
 const std::complex<double> I{0.0, 1.0};
-int findMatchingPauliIndex(const std::vector<std::string> &in_OpList,
-                           const std::string &in_obsStr) {
-  // Returns true if the *operators* of the two terms are identical
-  // e.g. a Z0X1 and b Z0X1 -> true
-  const auto comparePauliString = [](const std::string &in_a,
-                                     const std::string &in_b) -> bool {
-    // Strip the coefficient part
-    auto opA = in_a.substr(in_a.find_last_of(")") + 1);
-    auto opB = in_b.substr(in_b.find_last_of(")") + 1);
-    opA.erase(std::remove(opA.begin(), opA.end(), ' '), opA.end());
-    opB.erase(std::remove(opB.begin(), opB.end(), ' '), opB.end());
-    return opA == opB;
-  };
 
-  for (int i = 0; i < in_OpList.size(); ++i) {
-    std::shared_ptr<xacc::Observable> obs =
-        std::make_shared<xacc::quantum::PauliOperator>();
-    const std::string pauliObsStr = "1.0 " + in_OpList[i];
-    obs->fromString(pauliObsStr);
+PauliCode termCode(const std::shared_ptr<xacc::Observable> &in_term) {
+  auto pauliTerm =
+      std::dynamic_pointer_cast<xacc::quantum::PauliOperator>(in_term);
+  assert(pauliTerm && pauliTerm->getTerms().size() == 1);
+  return PauliCode::fromOps(pauliTerm->getTerms().begin()->second.ops());
+}
 
-    if (comparePauliString(obs->toString(), in_obsStr)) {
-      return i;
+// The local domain of a Hamiltonian term: its support and the nearest qubits
+// (by index distance to the support) up to in_domainSize qubits, sorted.
+std::vector<std::size_t> localDomain(const PauliCode &in_term,
+                                     int in_nbQubits, int in_domainSize) {
+  const uint32_t support = in_term.x | in_term.z;
+  std::vector<std::size_t> domain, others;
+  for (int q = 0; q < in_nbQubits; ++q) {
+    ((support >> q) & 1 ? domain : others).emplace_back(q);
+  }
+  if (domain.empty()) {
+    return domain;
+  }
+  const auto distance = [&](std::size_t in_qubit) {
+    std::size_t minDist = in_nbQubits;
+    for (const auto q : domain) {
+      minDist = std::min(minDist, q > in_qubit ? q - in_qubit : in_qubit - q);
     }
+    return minDist;
+  };
+  std::vector<std::pair<std::size_t, std::size_t>> candidates;
+  for (const auto q : others) {
+    candidates.emplace_back(distance(q), q);
+  }
+  std::sort(candidates.begin(), candidates.end());
+  for (std::size_t i = 0;
+       i < candidates.size() && int(domain.size()) < in_domainSize; ++i) {
+    domain.emplace_back(candidates[i].second);
   }
-  // Failed!
-  return -1;
+  std::sort(domain.begin(), domain.end());
+  return domain;
 }
 
-// Project/flatten the target observable into the full list of all
-// possible Pauli operator combinations.
-// e.g. H = a X + b Z (1 qubit)
-// -> { 0.0, a, 0.0, b } (the ordering is I, X, Y, Z)
-std::vector<double>
-observableToVec(std::shared_ptr<xacc::Observable> in_observable,
-                const std::vector<std::string> &in_pauliObsList) {
-  std::vector<double> obsProjCoeffs(in_pauliObsList.size(), 0.0);
+// Encodes Pauli operator strings, e.g. "X0Z1" (the empty string is the
+// identity).
+PauliBasis toPauliBasis(const std::vector<std::string> &in_pauliOps) {
+  std::vector<PauliCode> codes;
+  codes.reserve(in_pauliOps.size());
+  for (const auto &op : in_pauliOps) {
+    xacc::quantum::PauliOperator pauliOp("1.0 " + op);
+    codes.emplace_back(
+        PauliCode::fromOps(pauliOp.getTerms().begin()->second.ops()));
+  }
+  return PauliBasis(std::move(codes));
+}
+
+// Project the target observable onto the Pauli basis
+// e.g. H = a X + b Z (1 qubit) -> { (index of X, a), (index of Z, b) }
+std::vector<std::pair<std::size_t, double>>
+projectObservable(std::shared_ptr<xacc::Observable> in_observable,
+                  const PauliBasis &in_basis) {
+  std::vector<std::pair<std::size_t, double>> obsProjCoeffs;
   for (const auto &term : in_observable->getNonIdentitySubTerms()) {
-    const auto index =
-        findMatchingPauliIndex(in_pauliObsList, term->toString());
+    const auto index = in_basis.find(termCode(term));
     assert(index >= 0);
-    obsProjCoeffs[index] = term->coefficient().real();
+    obsProjCoeffs.emplace_back(index, term->coefficient().real());
   }
   return obsProjCoeffs;
 };
 
-// Helper to generate all permutation of Pauli observables:
-// e.g.
-// 1-qubit: I, X, Y, Z
-// 2-qubit: II, IX, IY, IZ, XI, XX, XY, XZ, YI, YX, YY, YZ, ZI, ZX, ZY, ZZ
-std::vector<std::string> generatePauliPermutation(int in_nbQubits) {
-  assert(in_nbQubits > 0);
-  const int nbPermutations = std::pow(4, in_nbQubits);
-  std::vector<std::string> opsList;
-  opsList.reserve(nbPermutations);
-
-  const std::vector<std::string> pauliOps{"X", "Y", "Z"};
-  const auto addQubitPauli = [&opsList, &pauliOps](int in_qubitIdx) {
-    const auto currentOpListSize = opsList.size();
-    for (int i = 0; i < currentOpListSize; ++i) {
-      auto &currentOp = opsList[i];
-      for (const auto &pauliOp : pauliOps) {
-        const auto newOp = currentOp + pauliOp + std::to_string(in_qubitIdx);
-        opsList.emplace_back(newOp);
+// S + S^T, where S(i, j) = <psi|sigma_dagger(i)sigma(j)|psi>: 
+// sigma(i)sigma(j) = i^k sigma(l), the anti-commuting pairs cancel out and the
+// commuting ones have k = 0 or 2, hence a real symmetric matrix. Only the
+// entries whose product has a non-zero expectation value are stored.
+arma::sp_mat createSMatrix(const PauliBasis &in_basis,
+                           const std::vector<double> &in_tomoExp) {
+  const auto sMatDim = in_basis.size();
+  std::vector<arma::uword> rows, cols;
+  std::vector<double> values;
+  for (std::size_t i = 0; i < sMatDim; ++i) {
+    for (std::size_t j = 0; j < sMatDim; ++j) {
+      if (!commute(in_basis[i], in_basis[j])) {
+        continue;
+      }
+      const auto index = in_basis.find(in_basis[i] * in_basis[j]);
+      if (index < 0 || std::abs(in_tomoExp[index]) <= 1e-12) {
+        continue;
       }
+      const double sign =
+          productPhase(in_basis[i], in_basis[j]) == 0 ? 2.0 : -2.0;
+      rows.emplace_back(i);
+      cols.emplace_back(j);
+      values.emplace_back(sign * in_tomoExp[index]);
     }
-  };
-
-  opsList = {"", "X0", "Y0", "Z0"};
-  for (int i = 1; i < in_nbQubits; ++i) {
-    addQubitPauli(i);
   }
 
-  assert(opsList.size() == nbPermutations);
-  std::sort(opsList.begin(), opsList.end());
-
-  return opsList;
-};
+  arma::umat locations(2, values.size());
+  for (std::size_t k = 0; k < values.size(); ++k) {
+    locations(0, k) = rows[k];
+    locations(1, k) = cols[k];
+  }
+  return arma::sp_mat(locations, arma::vec(values), sMatDim, sMatDim);
+}
 
-arma::cx_mat createSMatrix(const std::vector<std::string> &in_pauliOps,
-                           const std::vector<double> &in_tomoExp) {
-  const auto sMatDim = in_pauliOps.size();
-  arma::cx_mat S_Mat(sMatDim, sMatDim, arma::fill::zeros);
-  arma::cx_vec b_Vec(sMatDim, arma::fill::zeros);
-
-  const auto calcSmatEntry = [&](int in_row,
-                                 int in_col) -> std::complex<double> {
-    // Map the tomography expectation to the S matrix
-    // S(i, j) = <psi|sigma_dagger(i)sigma(j)|psi>
-    // sigma_dagger(i)sigma(j) will produce another Pauli operator with an
-    // additional coefficient. e.g. sigma_x * sigma_y = i*sigma_z
-    const auto leftOp = "1.0 " + in_pauliOps[in_row];
-    const auto rightOp = "1.0 " + in_pauliOps[in_col];
-    xacc::quantum::PauliOperator left(leftOp);
-    xacc::quantum::PauliOperator right(rightOp);
-    auto product = left * right;
-    const auto index = findMatchingPauliIndex(in_pauliOps, product.toString());
-    return in_tomoExp[index] * product.coefficient();
-  };
+// Saves the QITE steps: their energy, norm and A operator, the operators
+// term by term (with exact coefficients).
+void saveSteps(xacc::Checkpoint &io_checkpoint,
+               const std::vector<std::shared_ptr<xacc::Observable>> &in_aOps,
+               const std::vector<double> &in_energies,
+               const std::vector<double> &in_norms) {
+  std::vector<int> nbTerms;
+  std::vector<std::string> terms;
+  std::vector<double> coeffs;
+  for (const auto &aOp : in_aOps) {
+    auto pauli = std::dynamic_pointer_cast<xacc::quantum::PauliOperator>(aOp);
+    assert(pauli);
+    nbTerms.emplace_back(pauli->getTerms().size());
+    for (auto &[termId, term] : pauli->getTerms()) {
+      std::stringstream ss;
+      for (auto &[qubit, op] : term.ops()) {
+        ss << op << qubit << " ";
+      }
+      terms.emplace_back(ss.str());
+      coeffs.emplace_back(std::real(term.coeff()));
+      coeffs.emplace_back(std::imag(term.coeff()));
+    }
+  }
+  auto &state = io_checkpoint.state();
+  state.addExtraInfo("qite-energies", in_energies);
+  state.addExtraInfo("qite-norms", in_norms);
+  state.addExtraInfo("qite-op-sizes", nbTerms);
+  state.addExtraInfo("qite-op-terms", terms);
+  state.addExtraInfo("qite-op-coeffs", coeffs);
+  io_checkpoint.save();
+}
 
-  // S matrix:
-  for (int i = 0; i < sMatDim; ++i) {
-    for (int j = 0; j < sMatDim; ++j) {
-      S_Mat(i, j) = calcSmatEntry(i, j);
+// The (at most in_maxSteps) steps saved in the checkpoint (see saveSteps)
+void restoreSteps(xacc::Checkpoint &io_checkpoint, const std::string &in_key,
+                  int in_maxSteps,
+                  std::vector<std::shared_ptr<xacc::Observable>> &out_aOps,
+                  std::vector<double> &out_energies,
+                  std::vector<double> &out_norms) {
+  auto &state = io_checkpoint.state();
+  if (!io_checkpoint.restore(in_key) ||
+      !state.hasExtraInfoKey("qite-op-sizes")) {
+    return;
+  }
+  out_energies =
+      state.getInformation("qite-energies").as<std::vector<double>>();
+  out_norms = state.getInformation("qite-norms").as<std::vector<double>>();
+  const auto nbTerms =
+      state.getInformation("qite-op-sizes").as<std::vector<int>>();
+  const auto terms =
+      state.getInformation("qite-op-terms").as<std::vector<std::string>>();
+  const auto coeffs =
+      state.getInformation("qite-op-coeffs").as<std::vector<double>>();
+  std::size_t termIdx = 0;
+  for (std::size_t step = 0;
+       step < nbTerms.size() && out_aOps.size() < in_maxSteps; ++step) {
+    auto aOp = std::make_shared<xacc::quantum::PauliOperator>();
+    for (int i = 0; i < nbTerms[step]; ++i, ++termIdx) {
+      std::map<int, std::string> ops;
+      std::stringstream ss(terms[termIdx]);
+      std::string op;
+      while (ss >> op) {
+        ops.emplace(std::stoi(op.substr(1)), op.substr(0, 1));
+      }
+      *aOp += xacc::quantum::PauliOperator(
+          ops, std::complex<double>(coeffs[2 * termIdx],
+                                    coeffs[2 * termIdx + 1]));
     }
+    out_aOps.emplace_back(aOp);
   }
-  return S_Mat;
+  out_energies.resize(out_aOps.size());
+  out_norms.resize(out_aOps.size());
 }
 
 template <typename T> std::vector<T> arange(T start, T stop, T step = 1) {
@@ -204,6 +276,17 @@ bool QITE::initialize(const HeterogeneousMap &parameters) {
     }
   }
 
+  // Local QITE: the A operator of each Hamiltonian term acts on a domain of
+  // that many qubits around its support (0: the whole register).
+  m_domainSize = 0;
+  if (parameters.keyExists<int>("domain-size")) {
+    m_domainSize = parameters.get<int>("domain-size");
+    if (m_domainSize < 0) {
+      std::cout << "'domain-size' must be non-negative.\n";
+      initializeOk = false;
+    }
+  }
+
   m_ansatz = nullptr;
   // Ansatz here is just a state preparation circuit:
   // e.g. if we want to start in state |01>, not |00>
@@ -213,11 +296,22 @@ bool QITE::initialize(const HeterogeneousMap &parameters) {
 
   m_approxOps.clear();
   m_energyAtStep.clear();
+  m_profiler.initialize(parameters);
+  m_checkpoint = Checkpoint::fromParameters(parameters);
 
   input_parameters = parameters;
   return initializeOk;
 }
 
+std::string QITE::checkpointKey() const {
+  // Not the number of steps: a restart may run more steps.
+  std::stringstream ss;
+  ss << name() << "|" << std::setprecision(17) << m_dBeta << "|"
+     << m_domainSize << "|" << m_observable->toString() << "|"
+     << (m_ansatz ? m_ansatz->toString() : "");
+  return ss.str();
+}
+
 const std::vector<std::string> QITE::requiredParameters() const {
   return {"accelerator", "steps", "step-size", "observable"};
 }
@@ -311,7 +405,7 @@ double QITE::calculate(const std::string &calculation_task,
           *(std::dynamic_pointer_cast<xacc::quantum::PauliOperator>(hamTerm));
     }
     auto [normVal, nextAOps] =
-        internalCalcAOps(pauliOps, sigmaExpectation, hamOp);
+        internalCalcAOps(toPauliBasis(pauliOps), sigmaExpectation, hamOp);
     buffer->addExtraInfo("Aops-str", nextAOps->toString());
     return normVal;
   }
@@ -319,95 +413,84 @@ double QITE::calculate(const std::string &calculation_task,
 }
 
 std::pair<double, std::shared_ptr<Observable>>
-QITE::internalCalcAOps(const std::vector<std::string> &pauliOps,
+QITE::internalCalcAOps(const PauliBasis &pauliOps,
                        const std::vector<double> &sigmaExpectation,
                        std::shared_ptr<Observable> in_hmTerm) const {
   // Calculate S matrix and b vector
   // i.e. set up the linear equation Sa = b
   const auto sMatDim = pauliOps.size();
-  arma::cx_mat S_Mat(sMatDim, sMatDim, arma::fill::zeros);
-  arma::cx_vec b_Vec(sMatDim, arma::fill::zeros);
+  arma::vec b_Vec(sMatDim, arma::fill::zeros);
 
+  // The expectation of sigma_dagger(i)sigma(j): sigma(i)sigma(j) will produce
+  // another Pauli operator with an additional coefficient.
+  // e.g. sigma_x * sigma_y = i*sigma_z
   const auto calcSmatEntry = [&](const std::vector<double> &in_tomoExp,
-                                 int in_row,
-                                 int in_col) -> std::complex<double> {
-    // Map the tomography expectation to the S matrix
-    // S(i, j) = <psi|sigma_dagger(i)sigma(j)|psi>
-    // sigma_dagger(i)sigma(j) will produce another Pauli operator with an
-    // additional coefficient. e.g. sigma_x * sigma_y = i*sigma_z
-    const auto leftOp = "1.0 " + pauliOps[in_row];
-    const auto rightOp = "1.0 " + pauliOps[in_col];
-    xacc::quantum::PauliOperator left(leftOp);
-    xacc::quantum::PauliOperator right(rightOp);
-    auto product = left * right;
-    const auto index = findMatchingPauliIndex(pauliOps, product.toString());
-    return in_tomoExp[index] * product.coefficient();
-  };
-
-  // S matrix:
-  for (int i = 0; i < sMatDim; ++i) {
-    for (int j = 0; j < sMatDim; ++j) {
-      const auto entry = calcSmatEntry(sigmaExpectation, i, j);
-      S_Mat(i, j) = std::abs(entry) > 1e-12 ? entry : 0.0;
+                                 std::size_t in_row,
+                                 std::size_t in_col) -> std::complex<double> {
+    const auto index = pauliOps.find(pauliOps[in_row] * pauliOps[in_col]);
+    if (index < 0) {
+      return 0.0;
     }
-  }
+    return in_tomoExp[index] *
+           phaseFactor(productPhase(pauliOps[in_row], pauliOps[in_col]));
+  };
 
   // b vector:
-  const auto obsProjCoeffs = observableToVec(in_hmTerm, pauliOps);
+  const auto obsProjCoeffs = projectObservable(in_hmTerm, pauliOps);
 
   // Calculate c: Eq. 3 in https://arxiv.org/pdf/1901.07653.pdf
   double c = 1.0;
-  for (int i = 0; i < obsProjCoeffs.size(); ++i) {
-    c -= 2.0 * m_dBeta * obsProjCoeffs[i] * sigmaExpectation[i];
+  for (const auto &[index, coeff] : obsProjCoeffs) {
+    c -= 2.0 * m_dBeta * coeff * sigmaExpectation[index];
   }
 
   for (int i = 0; i < sMatDim; ++i) {
     std::complex<double> b =
         (sigmaExpectation[i] / std::sqrt(c) - sigmaExpectation[i]) / m_dBeta;
-    for (int j = 0; j < obsProjCoeffs.size(); ++j) {
+    for (const auto &[index, coeff] : obsProjCoeffs) {
       // The expectation of the pauli product of the Hamiltonian term
       // and the sweeping pauli term.
-      const auto expectVal = calcSmatEntry(sigmaExpectation, i, j);
-      b -= obsProjCoeffs[j] * expectVal / std::sqrt(c);
+      const auto expectVal = calcSmatEntry(sigmaExpectation, i, index);
+      b -= coeff * expectVal / std::sqrt(c);
     }
-    b = I * b - I * std::conj(b);
+    // i * b - i * conj(b) is real
+    const double bVal = std::real(I * b - I * std::conj(b));
     // Set b_Vec
-    b_Vec(i) = std::abs(b) > 1e-12 ? b : 0.0;
+    b_Vec(i) = std::abs(bVal) > 1e-12 ? bVal : 0.0;
   }
 
-  auto lhs = S_Mat + S_Mat.st();
-  auto rhs = -b_Vec;
-  arma::cx_vec a_Vec = arma::solve(lhs, rhs);
+  // S + S^T
+  const arma::sp_mat lhs = createSMatrix(pauliOps, sigmaExpectation);
+  arma::vec rhs = -b_Vec;
+  arma::vec a_Vec = arma::solve(arma::mat(lhs), rhs);
 
   // Now, we have the decomposition of A observable in the basis of
   // all possible Pauli combinations.
   assert(a_Vec.n_elem == pauliOps.size());
-  const std::string aObsStr = [&]() {
-    std::stringstream s;
-    s.precision(12);
-    s << std::fixed << a_Vec(0);
-
-    for (int i = 1; i < pauliOps.size(); ++i) {
-      s << " + " << (-2.0 * a_Vec(i)) << " " << pauliOps[i];
-    }
-
-    return s.str();
-  }();
 
   // Compute the approximate A observable/Hamiltonian.
   // This operator will drive the exp_i_theta evolution
   // which emulate the imaginary time evolution of the original observable.
-  std::shared_ptr<Observable> updatedAham =
-      std::make_shared<xacc::quantum::PauliOperator>();
-  updatedAham->fromString(aObsStr);
-  return std::make_pair(std::sqrt(c), updatedAham);
+  auto updatedAham = std::make_shared<xacc::quantum::PauliOperator>();
+  *updatedAham += xacc::quantum::PauliOperator(a_Vec(0));
+  for (int i = 1; i < pauliOps.size(); ++i) {
+    *updatedAham +=
+        xacc::quantum::PauliOperator(pauliOps[i].toOps(), -2.0 * a_Vec(i));
+  }
+  return std::make_pair(std::sqrt(c),
+                        std::static_pointer_cast<Observable>(updatedAham));
 }
 
 std::tuple<double, double, std::shared_ptr<Observable>>
 QITE::calcQiteEvolve(const std::shared_ptr<AcceleratorBuffer> &in_buffer,
                      std::shared_ptr<CompositeInstruction> in_kernel,
                      std::shared_ptr<Observable> in_hmTerm,
-                     bool energyOnly) const {
+                     bool energyOnly, ScopeTimer *io_step) const {
+  const auto phase = [io_step](const std::string &name) {
+    if (io_step) {
+      io_step->phase(name);
+    }
+  };
   std::vector<std::shared_ptr<CompositeInstruction>> fsToExec;
 
   if (!custom_optimizers.empty()) {
@@ -417,86 +500,180 @@ QITE::calcQiteEvolve(const std::shared_ptr<AcceleratorBuffer> &in_buffer,
     }
   }
   
-  // First, create the sub-circuits to evaluate current energy values:
-  auto kernels = m_observable->observe(in_kernel);
-  std::vector<double> coefficients;
-  std::vector<std::string> kernelNames;
-  double identityCoeff = 0.0;
-  for (auto &f : kernels) {
-    kernelNames.push_back(f->name());
-    std::complex<double> coeff = f->getCoefficient();
-    int nFunctionInstructions = 0;
-    if (f->nInstructions() > 0 && f->getInstruction(0)->isComposite()) {
-      nFunctionInstructions =
-          in_kernel->nInstructions() + f->nInstructions() - 1;
-    } else {
-      nFunctionInstructions = f->nInstructions();
-    }
+  if (energyOnly) {
+    phase("tomography");
+    // First, create the sub-circuits to evaluate current energy values:
+    auto kernels = m_observable->observe(in_kernel);
+    std::vector<double> coefficients;
+    double identityCoeff = 0.0;
+    for (auto &f : kernels) {
+      std::complex<double> coeff = f->getCoefficient();
+      int nFunctionInstructions = 0;
+      if (f->nInstructions() > 0 && f->getInstruction(0)->isComposite()) {
+        nFunctionInstructions =
+            in_kernel->nInstructions() + f->nInstructions() - 1;
+      } else {
+        nFunctionInstructions = f->nInstructions();
+      }
 
-    if (nFunctionInstructions > in_kernel->nInstructions()) {
-      fsToExec.push_back(f);
-      coefficients.push_back(std::real(coeff));
-    } else {
-      identityCoeff += std::real(coeff);
+      if (nFunctionInstructions > in_kernel->nInstructions()) {
+        coefficients.push_back(std::real(coeff));
+      } else {
+        identityCoeff += std::real(coeff);
+      }
     }
+
+    // Evaluate the energy terms on the kernel state:
+    auto tmpBuffer = xacc::qalloc(in_buffer->size());
+    m_accelerator->computeExpectations(tmpBuffer, in_kernel, m_observable);
+    // Get energy buffers:
+    std::vector<std::shared_ptr<AcceleratorBuffer>> energyBuffers =
+        tmpBuffer->getChildren();
+    assert(energyBuffers.size() == coefficients.size());
+    phase("solve");
+    const double currentEnergy = calcCurrentEnergy(
+        in_buffer->size(), identityCoeff, coefficients, energyBuffers);
+    return std::make_tuple(currentEnergy, 0.0, nullptr);
+  }
+
+  if (m_domainSize > 0 && m_domainSize < in_buffer->size()) {
+    return calcLocalQiteEvolve(in_buffer, in_kernel, in_hmTerm, io_step);
   }
-  // Cache the number of kernels for energy evaluation:
-  const size_t nbEnergyKernels = fsToExec.size();
-  // If we only need to evaluate the energy: no need any Pauli operators.
-  const auto pauliOps = energyOnly
-                            ? std::vector<std::string>{""}
-                            : generatePauliPermutation(in_buffer->size());
 
-  // Observe the kernels using the various Pauli
-  // operators to calculate S and b.
-  std::vector<double> sigmaExpectation;
+  phase("tomography");
+  // Observe the kernels using all the Pauli operators to calculate S and b.
+  // The Hamiltonian terms are among them, hence a single submission also
+  // gives the current energy.
+  const auto pauliOps = PauliBasis::full(in_buffer->size());
+  std::vector<double> sigmaExpectation(pauliOps.size(), 0.0);
   // Identity observable:
-  sigmaExpectation.emplace_back(1.0);
+  sigmaExpectation[0] = 1.0;
+  auto tomoObservable = std::make_shared<xacc::quantum::PauliOperator>();
+  std::vector<std::string> tomoTermNames;
+  tomoTermNames.reserve(pauliOps.size() - 1);
   for (int i = 1; i < pauliOps.size(); ++i) {
-    std::shared_ptr<Observable> tomoObservable =
-        std::make_shared<xacc::quantum::PauliOperator>();
-    const std::string pauliObsStr = "1.0 " + pauliOps[i];
-    tomoObservable->fromString(pauliObsStr);
-    assert(tomoObservable->getSubTerms().size() == 1);
-    assert(tomoObservable->getNonIdentitySubTerms().size() == 1);
-    auto obsKernel = tomoObservable->observe(in_kernel).front();
-    // Add tomography kernels:
-    fsToExec.emplace_back(obsKernel);
-  }
-
-  // Execute all kernels:
-  auto tmpBuffer = xacc::qalloc(in_buffer->size());
-  m_accelerator->execute(tmpBuffer, fsToExec);
-  // Get child buffers:
-  auto childBuffers = tmpBuffer->getChildren();
-  std::vector<std::shared_ptr<AcceleratorBuffer>> energyBuffers;
-  // Get energy buffers:
-  std::copy_n(childBuffers.begin(), nbEnergyKernels,
-              std::back_inserter(energyBuffers));
-  assert(energyBuffers.size() == nbEnergyKernels);
-
-  // Get tomography buffers:
-  std::vector<std::shared_ptr<AcceleratorBuffer>> tommoBuffers;
-  std::copy_n(childBuffers.begin() + nbEnergyKernels, pauliOps.size() - 1,
-              std::back_inserter(tommoBuffers));
+    xacc::quantum::PauliOperator tomoTerm(pauliOps[i].toOps(), 1.0);
+    tomoTermNames.emplace_back(tomoTerm.getTerms().begin()->first);
+    *tomoObservable += tomoTerm;
+  }
 
-  // Process buffer results:
-  const double currentEnergy = calcCurrentEnergy(
-      in_buffer->size(), identityCoeff, coefficients, energyBuffers);
-  if (energyOnly) {
-    assert(childBuffers.size() == nbEnergyKernels);
-    return std::make_tuple(currentEnergy, 0.0, nullptr);
+  // Evaluate the tomography terms on the kernel state:
+  auto tomoBuffer = xacc::qalloc(in_buffer->size());
+  m_accelerator->computeExpectations(tomoBuffer, in_kernel, tomoObservable);
+  for (int i = 1; i < pauliOps.size(); ++i) {
+    auto children = tomoBuffer->getChildren(tomoTermNames[i - 1]);
+    assert(children.size() == 1);
+    sigmaExpectation[i] = children.front()->getExpectationValueZ();
   }
 
-  for (auto &childBuffer : tommoBuffers) {
-    const auto expval = childBuffer->getExpectationValueZ();
-    sigmaExpectation.emplace_back(expval);
+  // Process buffer results:
+  phase("solve");
+  double currentEnergy = 0.0;
+  if (auto identityTerm = m_observable->getIdentitySubTerm()) {
+    currentEnergy += identityTerm->coefficient().real();
+  }
+  for (const auto &[index, coeff] :
+       projectObservable(m_observable, pauliOps)) {
+    currentEnergy += coeff * sigmaExpectation[index];
   }
-  assert(sigmaExpectation.size() == pauliOps.size());
+  xacc::info("Energy = " + std::to_string(currentEnergy));
+
   auto [norm, Aops] = internalCalcAOps(pauliOps, sigmaExpectation, in_hmTerm);
   return std::make_tuple(currentEnergy, norm, Aops);
 }
 
+std::tuple<double, double, std::shared_ptr<Observable>>
+QITE::calcLocalQiteEvolve(const std::shared_ptr<AcceleratorBuffer> &in_buffer,
+                          std::shared_ptr<CompositeInstruction> in_kernel,
+                          std::shared_ptr<Observable> in_hmTerm,
+                          ScopeTimer *io_step) const {
+  if (io_step) {
+    io_step->phase("tomography");
+  }
+  // The Pauli basis of each Hamiltonian term domain: all the A operators are
+  // approximated from the current state, i.e. the same first order in the
+  // step size as the Trotterization.
+  const auto hamTerms = in_hmTerm->getNonIdentitySubTerms();
+  std::vector<PauliBasis> domainBases;
+  domainBases.reserve(hamTerms.size());
+  // The distinct (non-identity) Pauli operators to measure
+  auto tomoObservable = std::make_shared<xacc::quantum::PauliOperator>();
+  std::unordered_map<uint64_t, std::string> tomoTermNames;
+  const auto codeKey = [](const PauliCode &in_code) {
+    return uint64_t(in_code.x) | (uint64_t(in_code.z) << 32);
+  };
+  for (const auto &term : hamTerms) {
+    domainBases.emplace_back(PauliBasis::onQubits(
+        localDomain(termCode(term), in_buffer->size(), m_domainSize)));
+    const auto &basis = domainBases.back();
+    for (std::size_t i = 1; i < basis.size(); ++i) {
+      if (tomoTermNames.count(codeKey(basis[i])) == 0) {
+        xacc::quantum::PauliOperator tomoTerm(basis[i].toOps(), 1.0);
+        tomoTermNames.emplace(codeKey(basis[i]),
+                              tomoTerm.getTerms().begin()->first);
+        *tomoObservable += tomoTerm;
+      }
+    }
+  }
+  xacc::info("Local QITE: " + std::to_string(tomoTermNames.size()) +
+             " Pauli operators to measure.");
+
+  // Evaluate all the domain tomography terms on the kernel state at once:
+  auto tomoBuffer = xacc::qalloc(in_buffer->size());
+  m_accelerator->computeExpectations(tomoBuffer, in_kernel, tomoObservable);
+  std::unordered_map<std::string, double> tomoExpVals;
+  for (auto &child : tomoBuffer->getChildren()) {
+    tomoExpVals.emplace(child->name(), child->getExpectationValueZ());
+  }
+  const auto expectation = [&](const PauliCode &in_code) {
+    if (in_code.isIdentity()) {
+      return 1.0;
+    }
+    const auto iter = tomoExpVals.find(tomoTermNames.at(codeKey(in_code)));
+    assert(iter != tomoExpVals.end());
+    return iter->second;
+  };
+
+  // The Hamiltonian terms are in their own domain: current energy
+  if (io_step) {
+    io_step->phase("solve");
+  }
+  double currentEnergy = 0.0;
+  if (auto identityTerm = m_observable->getIdentitySubTerm()) {
+    currentEnergy += identityTerm->coefficient().real();
+  }
+  for (const auto &term : m_observable->getNonIdentitySubTerms()) {
+    currentEnergy += term->coefficient().real() * expectation(termCode(term));
+  }
+  xacc::info("Energy = " + std::to_string(currentEnergy));
+
+  // Solve the (small) linear systems of the domains in parallel.
+  std::vector<std::pair<double, std::shared_ptr<Observable>>> localAOps(
+      hamTerms.size());
+  xacc::getTaskScheduler()->parallelFor(
+      0, hamTerms.size(), [&](std::size_t beginIdx, std::size_t endIdx) {
+        for (std::size_t i = beginIdx; i < endIdx; ++i) {
+          const auto &basis = domainBases[i];
+          std::vector<double> sigmaExpectation(basis.size());
+          for (std::size_t k = 0; k < basis.size(); ++k) {
+            sigmaExpectation[k] = expectation(basis[k]);
+          }
+          localAOps[i] = internalCalcAOps(basis, sigmaExpectation, hamTerms[i]);
+        }
+      });
+
+  // Merge the local A operators: the propagator circuit is the Trotter
+  // product of their terms.
+  double norm = 1.0;
+  auto aOps = std::make_shared<xacc::quantum::PauliOperator>();
+  for (const auto &[localNorm, localAOp] : localAOps) {
+    norm *= localNorm;
+    *aOps += *std::dynamic_pointer_cast<xacc::quantum::PauliOperator>(localAOp);
+  }
+  return std::make_tuple(currentEnergy, norm,
+                         std::static_pointer_cast<Observable>(aOps));
+}
+
 void QITE::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
   if (!m_analytical) {
     // Run on hardware/simulator using quantum gates/measure
@@ -507,22 +684,39 @@ void QITE::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
           *(std::dynamic_pointer_cast<xacc::quantum::PauliOperator>(hamTerm));
     }
 
+    // Restart: the saved steps are not computed again.
+    std::vector<double> normAtStep;
+    if (m_checkpoint) {
+      restoreSteps(*m_checkpoint, checkpointKey(), m_nbSteps, m_approxOps,
+                   m_energyAtStep, normAtStep);
+    }
+
+    // Null unless profiling
+    const auto spans = m_profiler.recorder();
     // Time stepping:
-    for (int i = 0; i < m_nbSteps; ++i) {
+    for (int i = m_approxOps.size(); i < m_nbSteps; ++i) {
+      ScopeTimer step("step", spans.get());
+      step.phase("circuit");
       // Propagates the state via Trotter steps:
       auto kernel = constructPropagateCircuit();
       // Optimizes/calculates next A ops
       auto [energyVal, normVal, nextAOps] =
-          calcQiteEvolve(buffer, kernel, hamOp);
+          calcQiteEvolve(buffer, kernel, hamOp, false, &step);
       // The energy at this step (before adding the newly calculated A-op)
       m_energyAtStep.emplace_back(energyVal);
       m_approxOps.emplace_back(nextAOps);
+      normAtStep.emplace_back(normVal);
+      if (m_checkpoint) {
+        saveSteps(*m_checkpoint, m_approxOps, m_energyAtStep, normAtStep);
+      }
     }
 
     // We need to execute an extra call to evaluate the end energy:
+    ScopeTimer finalStep("step", spans.get());
+    finalStep.phase("circuit");
     auto finalKernel = constructPropagateCircuit();
     auto [energyVal, normVal, nextAOps] =
-        calcQiteEvolve(buffer, finalKernel, hamOp, true);
+        calcQiteEvolve(buffer, finalKernel, hamOp, true, &finalStep);
     assert(nextAOps == nullptr);
     m_energyAtStep.emplace_back(energyVal);
     assert(m_energyAtStep.size() == m_nbSteps + 1);
@@ -537,6 +731,10 @@ void QITE::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
     const auto openQASMSrc = staq->translate(finalKernel);
     // Returns the QITE circuit as a QASM string:
     buffer->addExtraInfo("qasm", ExtraInfo(openQASMSrc));
+    if (spans) {
+      spans->end(0);
+    }
+    m_profiler.record(spans.get(), {"step"}, *buffer);
   } else {
     // Analytical run:
     // This serves two purposes:
@@ -556,7 +754,7 @@ void QITE::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
     const auto getTomographyExpVec = [](int in_nbQubits,
                                         const arma::cx_vec &in_psi,
                                         const arma::cx_vec &in_delta) {
-      const auto pauliOps = generatePauliPermutation(in_nbQubits);
+      const auto pauliOps = PauliBasis::full(in_nbQubits);
       std::vector<std::complex<double>> sigmaExpectation(pauliOps.size());
       std::vector<std::complex<double>> bVec(pauliOps.size());
 
@@ -564,9 +762,8 @@ void QITE::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
       bVec[0] = arma::cdot(in_delta, in_psi);
 
       for (int i = 1; i < pauliOps.size(); ++i) {
-        auto tomoObservable = std::make_shared<xacc::quantum::PauliOperator>();
-        const std::string pauliObsStr = "1.0 " + pauliOps[i];
-        tomoObservable->fromString(pauliObsStr);
+        auto tomoObservable = std::make_shared<xacc::quantum::PauliOperator>(
+            pauliOps[i].toOps(), 1.0);
         assert(tomoObservable->getSubTerms().size() == 1);
         assert(tomoObservable->getNonIdentitySubTerms().size() == 1);
         arma::cx_mat hMat(1 << in_nbQubits, 1 << in_nbQubits,
@@ -628,32 +825,24 @@ void QITE::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
         pauliExpValues.emplace_back(val.real());
       }
 
-      arma::cx_mat sMat = createSMatrix(
-          generatePauliPermutation(buffer->size()), pauliExpValues);
-      arma::cx_vec b_Vec(bVec.size(), arma::fill::zeros);
+      const auto pauliOps = PauliBasis::full(buffer->size());
+      // S + S^T
+      const arma::sp_mat lhs = createSMatrix(pauliOps, pauliExpValues);
+      arma::vec b_Vec(bVec.size(), arma::fill::zeros);
       for (int i = 0; i < bVec.size(); ++i) {
-        b_Vec(i) = -I * bVec[i] + I * std::conj(bVec[i]);
+        b_Vec(i) = std::real(-I * bVec[i] + I * std::conj(bVec[i]));
       }
 
-      auto lhs = sMat + sMat.st();
       auto rhs = b_Vec;
-      arma::cx_vec a_Vec = arma::solve(lhs, rhs);
-      const auto pauliOps = generatePauliPermutation(buffer->size());
-      const std::string aObsStr = [&]() {
-        std::stringstream s;
-        s.precision(12);
-        s << std::fixed << a_Vec(0);
-
-        for (int i = 1; i < pauliOps.size(); ++i) {
-          s << " + " << a_Vec(i) << " " << pauliOps[i];
-        }
-
-        return s.str();
-      }();
+      arma::vec a_Vec = arma::solve(arma::mat(lhs), rhs);
 
       std::shared_ptr<xacc::quantum::PauliOperator> updatedAham =
           std::make_shared<xacc::quantum::PauliOperator>();
-      updatedAham->fromString(aObsStr);
+      *updatedAham += xacc::quantum::PauliOperator(a_Vec(0));
+      for (int i = 1; i < pauliOps.size(); ++i) {
+        *updatedAham +=
+            xacc::quantum::PauliOperator(pauliOps[i].toOps(), a_Vec(i));
+      }
       const auto aHamMat = updatedAham->toDenseMatrix(buffer->size());
       arma::cx_mat aMat(1 << buffer->size(), 1 << buffer->size(),
                         arma::fill::zeros);
@@ -733,23 +922,53 @@ void QLanczos::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
         *(std::dynamic_pointer_cast<xacc::quantum::PauliOperator>(hamTerm));
   }
 
+  // Restart: the saved steps are replayed (classically) and not computed
+  // again.
+  std::vector<std::shared_ptr<Observable>> savedAOps;
+  std::vector<double> savedEnergies, savedNorms;
+  if (m_checkpoint) {
+    restoreSteps(*m_checkpoint, checkpointKey(), m_nbSteps, savedAOps,
+                 savedEnergies, savedNorms);
+  }
+  std::vector<double> stepNorms;
+
+  // Null unless profiling
+  const auto spans = m_profiler.recorder();
   // Time stepping:
   for (int i = 0; i < m_nbSteps; ++i) {
-    // Propagates the state via Trotter steps:
-    auto kernel = constructPropagateCircuit();
-    // Optimizes/calculates next A ops
-    auto [energyVal, normVal, nextAOps] = calcQiteEvolve(buffer, kernel, hamOp);
+    const bool saved = i < savedAOps.size();
+    ScopeTimer step("step", spans.get());
+    step.phase("circuit");
+    double energyVal = 0.0, normVal = 1.0;
+    std::shared_ptr<Observable> nextAOps;
+    if (saved) {
+      energyVal = savedEnergies[i];
+      normVal = savedNorms[i];
+      nextAOps = savedAOps[i];
+    } else {
+      // Propagates the state via Trotter steps:
+      auto kernel = constructPropagateCircuit();
+      // Optimizes/calculates next A ops
+      std::tie(energyVal, normVal, nextAOps) =
+          calcQiteEvolve(buffer, kernel, hamOp, false, &step);
+    }
     m_approxOps.emplace_back(nextAOps);
     m_energyAtStep.emplace_back(energyVal);
+    stepNorms.emplace_back(normVal);
+    if (m_checkpoint && !saved) {
+      saveSteps(*m_checkpoint, m_approxOps, m_energyAtStep, stepNorms);
+    }
     // Odd steps (back processing):
     if ((i % 2) == 1) {
       lanczosEnergy.emplace_back(calcQlanczosEnergy(normAtStep));
     }
     normAtStep.emplace_back(normVal * normAtStep.back());
   }
+  ScopeTimer finalStep("step", spans.get());
+  finalStep.phase("circuit");
   auto finalKernel = constructPropagateCircuit();
   auto [energyVal, normVal, nextAOps] =
-      calcQiteEvolve(buffer, finalKernel, hamOp, true);
+      calcQiteEvolve(buffer, finalKernel, hamOp, true, &finalStep);
   assert(nextAOps == nullptr);
   m_energyAtStep.emplace_back(energyVal);
   assert(m_energyAtStep.size() == m_nbSteps + 1);
@@ -760,6 +979,10 @@ void QLanczos::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
   // Also returns the full list of energy values
   // at each QLanczos step.
   buffer->addExtraInfo("exp-vals", ExtraInfo(lanczosEnergy));
+  if (spans) {
+    spans->end(0);
+  }
+  m_profiler.record(spans.get(), {"step"}, *buffer);
 }
 
 double QLanczos::calcQlanczosEnergy(const std::vector<double> &normVec) const {
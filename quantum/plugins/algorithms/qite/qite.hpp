@@ -13,7 +13,10 @@
 #pragma once
 
 #include "Algorithm.hpp"
+#include "AlgorithmProfiler.hpp"
+#include "Checkpoint.hpp"
 #include "IRTransformation.hpp"
+#include "PauliBasis.hpp"
 
 namespace xacc {
 namespace algorithm {
@@ -46,15 +49,24 @@ protected:
   // system to this time step in_hmTerm: the H term to be approximate by the A
   // term i.e. emulate the imaginary time evolution of that H term. Returns
   // energy value (double), the norm (as a double) and the A operator (Pauli
-  // observable)
+  // observable). The circuit / tomography / solve phases are recorded in
+  // io_step if given.
   std::tuple<double, double, std::shared_ptr<Observable>>
   calcQiteEvolve(const std::shared_ptr<AcceleratorBuffer> &in_buffer,
                  std::shared_ptr<CompositeInstruction> in_kernel,
                  std::shared_ptr<Observable> in_hmTerm,
-                 bool energyOnly = false) const;
+                 bool energyOnly = false, ScopeTimer *io_step = nullptr) const;
+  // Local QITE ('domain-size' option): one A operator per Hamiltonian term,
+  // over the Pauli basis of the qubits around the term support. Returns the
+  // energy, the norm and the sum of the local A operators.
+  std::tuple<double, double, std::shared_ptr<Observable>>
+  calcLocalQiteEvolve(const std::shared_ptr<AcceleratorBuffer> &in_buffer,
+                      std::shared_ptr<CompositeInstruction> in_kernel,
+                      std::shared_ptr<Observable> in_hmTerm,
+                      ScopeTimer *io_step = nullptr) const;
   // Internal helper function:
   std::pair<double, std::shared_ptr<Observable>>
-  internalCalcAOps(const std::vector<std::string> &pauliOps,
+  internalCalcAOps(const PauliBasis &pauliOps,
                    const std::vector<double> &sigmaExpectation,
                    std::shared_ptr<Observable> in_hmTerm) const;
 
@@ -83,6 +95,14 @@ protected:
   // For accelerator-based simulation, the Ansatz is used to
   // prepare the initial state.
   int m_initialState;
+  // Number of qubits of the local A operator domains (0: whole register)
+  int m_domainSize = 0;
+  // "profile": circuit / tomography / solve durations of each step
+  AlgorithmProfiler m_profiler;
+  // "checkpoint": the A operator, energy and norm of each step, a restart
+  // resumes after the last saved step.
+  std::shared_ptr<Checkpoint> m_checkpoint;
+  std::string checkpointKey() const;
   xacc::HeterogeneousMap input_parameters;
 };
 
@@ -18,6 +18,36 @@
 #include "Observable.hpp"
 #include "Algorithm.hpp"
 #include "PauliOperator.hpp"
+#include "PauliBasis.hpp"
+
+TEST(QITETester, checkPauliBasis)
+{
+  using namespace xacc::algorithm;
+  const auto basis = PauliBasis::full(2);
+  EXPECT_EQ(basis.size(), 16);
+  EXPECT_TRUE(basis[0].isIdentity());
+  for (size_t i = 0; i < basis.size(); ++i)
+  {
+    EXPECT_EQ(basis.find(basis[i]), i);
+    // Same product as the PauliOperator algebra
+    for (size_t j = 0; j < basis.size(); ++j)
+    {
+      xacc::quantum::PauliOperator left(basis[i].toOps(), 1.0);
+      xacc::quantum::PauliOperator right(basis[j].toOps(), 1.0);
+      auto product = left * right;
+      xacc::quantum::PauliOperator expected(
+          (basis[i] * basis[j]).toOps(),
+          phaseFactor(productPhase(basis[i], basis[j])));
+      EXPECT_TRUE(product == expected);
+      EXPECT_NEAR(std::abs(product.coefficient() - expected.coefficient()), 0.0, 1e-12);
+      EXPECT_EQ(commute(basis[i], basis[j]), commute(basis[j], basis[i]));
+    }
+  }
+  // Arbitrary list: hashed look-up
+  const PauliBasis subset({ basis[5], basis[0], basis[12] });
+  EXPECT_EQ(subset.find(basis[12]), 2);
+  EXPECT_EQ(subset.find(basis[3]), -1);
+}
 
 TEST(QITETester, checkSimple) 
 {
@@ -154,6 +184,37 @@ TEST(QITETester, checkDeuteuronH3)
   EXPECT_NEAR(finalEnergy, -2.04482, 0.01);
 }*/
 
+TEST(QITETester, checkDeuteuronH3LocalDomain)
+{
+  auto qite = xacc::getService<xacc::Algorithm>("qite");
+  std::shared_ptr<xacc::Observable> observable = std::make_shared<xacc::quantum::PauliOperator>();
+  observable->fromString("5.907 - 2.1433 X0X1 - 2.1433 Y0Y1 + .21829 Z0 - 6.125 Z1 + 9.625 - 9.625 Z2 - 3.91 X1 X2 - 3.91 Y1 Y2");
+  auto acc = xacc::getAccelerator("qpp");
+  const int nbSteps = 20;
+  const double stepSize = 0.05;
+  auto compiler = xacc::getCompiler("xasm");
+  auto ir = compiler->compile(R"(__qpu__ void f_local(qbit q) { X(q[0]); })", nullptr);
+  auto x = ir->getComposite("f_local");
+
+  // 2-qubit domains: {0, 1} and {1, 2}
+  const bool initOk =  qite->initialize({
+    std::make_pair("accelerator", acc),
+    std::make_pair("steps", nbSteps),
+    std::make_pair("observable", observable),
+    std::make_pair("step-size", stepSize),
+    std::make_pair("ansatz", x),
+    std::make_pair("domain-size", 2)
+  });
+
+  EXPECT_TRUE(initOk);
+
+  auto buffer = xacc::qalloc(3);
+  qite->execute(buffer);
+  const double finalEnergy = (*buffer)["opt-val"].as<double>();
+  std::cout << "Final Energy: " << finalEnergy << "\n";
+  EXPECT_NEAR(finalEnergy, -2.04482, 0.05);
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize(argc, argv);
   ::testing::InitGoogleTest(&argc, argv);
@@ -95,6 +95,7 @@ bool ControlledU::expand(const xacc::HeterogeneousMap &runtimeOptions) {
   if (s.size() != ctrlIdxs.size()) {
     xacc::error("Control bits must be unique.");
   }
+  m_rotationCutoff = runtimeOptions.get_or_default("rotation-cutoff", 0.0);
   auto ctrlU = uComposite;
   // Recursive application of control bits:
   for (const auto &ctrlIdx : ctrlIdxs) {
@@ -264,6 +265,9 @@ void ControlledU::visit(Rz &rz) {
   } else {
     const auto targetIdx = std::make_pair(rz.getBufferName(0), rz.bits()[0]);
     const auto angle = InstructionParameterToDouble(rz.getParameter(0));
+    if (isNegligible(angle)) {
+      return;
+    }
     // CRz
     m_composite->addInstruction(m_gateProvider->createInstruction(
         "CRZ", {m_ctrlIdx, targetIdx}, {angle}));
@@ -346,6 +350,9 @@ void ControlledU::visit(U1 &u1) {
   // cU1 == CPhase
   const auto targetIdx = std::make_pair(u1.getBufferName(0), u1.bits()[0]);
   auto angle = u1.getParameter(0);
+  if (angle.which() != 2 && isNegligible(InstructionParameterToDouble(angle))) {
+    return;
+  }
   m_composite->addInstruction(m_gateProvider->createInstruction(
       "CPhase", {m_ctrlIdx, targetIdx}, {angle}));
 }
@@ -386,6 +393,9 @@ void ControlledU::visit(CZ &cz) {
 
 void ControlledU::visit(CRZ &crz) {
   const auto theta = InstructionParameterToDouble(crz.getParameter(0));
+  if (isNegligible(theta)) {
+    return;
+  }
   // Decompose
   Rz rz1(crz.bits()[1], theta / 2);
   rz1.setBufferNames({crz.getBufferName(1)});
@@ -440,6 +450,9 @@ void ControlledU::visit(CPhase &cphase) {
       std::make_pair(cphase.getBufferName(1), cphase.bits()[1]);
   // Angle
   const auto angle = InstructionParameterToDouble(cphase.getParameter(0));
+  if (isNegligible(angle)) {
+    return;
+  }
   m_composite->addInstruction(m_gateProvider->createInstruction(
       "CPhase", {ctrlIdx1, ctrlIdx2}, {angle / 2}));
   m_composite->addInstruction(
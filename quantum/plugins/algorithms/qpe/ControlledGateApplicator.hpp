@@ -24,6 +24,8 @@ public:
   bool expand(const xacc::HeterogeneousMap &runtimeOptions) override;
   // Input: The composite "U" and the control Idx.
   // Control Idx must *not* be one of the qubits that U is acting on.
+  // Optional "rotation-cutoff": the controlled phases and z rotations with a
+  // smaller (numeric) angle are dropped.
   const std::vector<std::string> requiredKeys() override {
     return {"U", "control-idx"};
   }
@@ -64,12 +66,17 @@ private:
   std::shared_ptr<xacc::CompositeInstruction>
   applyControl(const std::shared_ptr<xacc::CompositeInstruction> &in_program,
                const std::pair<std::string, size_t> &in_ctrlIdx);
+  // True if the controlled rotation by this angle is dropped.
+  bool isNegligible(double in_angle) const {
+    return std::abs(in_angle) < m_rotationCutoff;
+  }
 
 private:
   std::shared_ptr<xacc::CompositeInstruction> m_composite;
   std::shared_ptr<xacc::IRProvider> m_gateProvider;
   // The current control qubit (buffer name & index)
   std::pair<std::string, size_t> m_ctrlIdx;
+  double m_rotationCutoff = 0.0;
 };
 } // namespace circuits
 } // namespace xacc
\ No newline at end of file
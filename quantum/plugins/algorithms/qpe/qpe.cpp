@@ -15,9 +15,95 @@
 #include "xacc_service.hpp"
 #include "xacc_observable.hpp"
 #include "Circuit.hpp"
+#include "GateFusion.hpp"
+#include <algorithm>
 #include <cassert>
 #include <iomanip>
 
+namespace {
+bool hasHamiltonian(const xacc::HeterogeneousMap& in_params)
+{
+    return in_params.stringExists("hamiltonian") || in_params.pointerLikeExists<xacc::Observable>("hamiltonian");
+}
+
+// Circuit of the (n-qubit) unitary by the z-y-z, KAK or QFAST decomposition,
+// with the global phase the decompositions drop (relative phase once controlled).
+std::shared_ptr<xacc::CompositeInstruction> synthesize(const Eigen::MatrixXcd& in_unitary, double& out_globalPhase)
+{
+    size_t nbQubits = 0;
+    while ((1ULL << nbQubits) < (size_t)in_unitary.rows())
+    {
+        ++nbQubits;
+    }
+    const std::string decomposer = nbQubits == 1 ? "z-y-z" : (nbQubits == 2 ? "kak" : "QFAST");
+    auto circuit = std::dynamic_pointer_cast<xacc::CompositeInstruction>(xacc::getService<xacc::Instruction>(decomposer));
+    if (!circuit->expand({ std::make_pair("unitary", in_unitary) }))
+    {
+        xacc::error("QPE: failed to synthesize the oracle power with " + decomposer + ".");
+    }
+
+    // The decomposers do not share the GateFuser bit order: take whichever
+    // matches, then the phase of tr(V^dagger U).
+    out_globalPhase = 0.0;
+    double bestOverlap = -1.0;
+    for (bool reversed : { false, true })
+    {
+        auto copy = std::make_shared<xacc::quantum::Circuit>("copy");
+        xacc::InstructionIterator it(circuit);
+        while (it.hasNext())
+        {
+            auto inst = it.next();
+            if (!inst->isComposite() && inst->isEnabled())
+            {
+                auto gate = inst->clone();
+                if (reversed)
+                {
+                    auto bits = gate->bits();
+                    for (auto& bit : bits)
+                    {
+                        bit = nbQubits - 1 - bit;
+                    }
+                    gate->setBits(bits);
+                }
+                copy->addInstruction(gate);
+            }
+        }
+        xacc::quantum::GateFuser fuser;
+        fuser.initialize(copy);
+        const std::complex<double> overlap = (fuser.calcFusedGate(nbQubits).adjoint() * in_unitary).trace();
+        if (std::abs(overlap) > bestOverlap)
+        {
+            bestOverlap = std::abs(overlap);
+            out_globalPhase = std::arg(overlap);
+        }
+    }
+    return circuit;
+}
+
+// exp(-i H t) by the trotter generator
+std::shared_ptr<xacc::CompositeInstruction> evolve(const xacc::HeterogeneousMap& in_params, double in_time)
+{
+    auto circuit = std::dynamic_pointer_cast<xacc::CompositeInstruction>(xacc::getService<xacc::Instruction>("trotter"));
+    xacc::HeterogeneousMap options {
+        std::make_pair("time", in_time),
+        std::make_pair("order", in_params.get_or_default("trotter-order", 2)),
+        std::make_pair("steps", in_params.get_or_default("trotter-steps", 1)),
+        // C-U visits the gates
+        std::make_pair("shared-steps", false)
+    };
+    if (in_params.stringExists("hamiltonian"))
+    {
+        options.insert("pauli", in_params.getString("hamiltonian"));
+    }
+    else
+    {
+        options.insert("observable", in_params.getPointerLike<xacc::Observable>("hamiltonian"));
+    }
+    circuit->expand(options);
+    return circuit;
+}
+} // namespace
+
 namespace xacc {
 namespace algorithm {
 bool QuantumPhaseEstimation::initialize(const HeterogeneousMap& parameters) 
@@ -30,7 +116,8 @@ bool QuantumPhaseEstimation::initialize(const HeterogeneousMap& parameters)
         initializeOk = false;
     }
 
-    if (!parameters.pointerLikeExists<CompositeInstruction>("oracle")) 
+    const bool oracleMatrix = parameters.keyExists<Eigen::MatrixXcd>("oracle-unitary") || hasHamiltonian(parameters);
+    if (!parameters.pointerLikeExists<CompositeInstruction>("oracle") && !oracleMatrix) 
     {
         std::cout << "'oracle' is required.\n";
         initializeOk = false;
@@ -39,7 +126,7 @@ bool QuantumPhaseEstimation::initialize(const HeterogeneousMap& parameters)
     if (initializeOk)
     {
         m_qpu = parameters.getPointerLike<Accelerator>("accelerator");
-        m_oracle = parameters.getPointerLike<CompositeInstruction>("oracle");
+        m_oracle = parameters.pointerLikeExists<CompositeInstruction>("oracle") ? parameters.getPointerLike<CompositeInstruction>("oracle") : nullptr;
     }
 
     m_params = parameters;
@@ -53,8 +140,31 @@ const std::vector<std::string> QuantumPhaseEstimation::requiredParameters() cons
 
 void QuantumPhaseEstimation::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const 
 {
+    // U^(2^i) is synthesized from U^(2^i) (by repeated squaring of
+    // "oracle-unitary") or evolved for 2^i t (when U = exp(-i "hamiltonian" t))
+    // rather than made of 2^i copies of the controlled oracle.
+    const bool fromUnitary = m_params.keyExists<Eigen::MatrixXcd>("oracle-unitary");
+    const bool fromHamiltonian = !fromUnitary && hasHamiltonian(m_params);
+    const double evolutionTime = m_params.get_or_default("evolution-time", 1.0);
+
     // Calculate the number of qubits that are used by the oracle:
-    const size_t nbOracleBits = m_oracle->uniqueBits().size();
+    const size_t nbOracleBits = [&]() -> size_t {
+        if (fromUnitary)
+        {
+            size_t nbQubits = 0;
+            while ((1ULL << nbQubits) < (size_t)m_params.get<Eigen::MatrixXcd>("oracle-unitary").rows())
+            {
+                ++nbQubits;
+            }
+            return nbQubits;
+        }
+        if (fromHamiltonian)
+        {
+            const auto bits = evolve(m_params, evolutionTime)->uniqueBits();
+            return bits.empty() ? 0 : *std::max_element(bits.begin(), bits.end()) + 1;
+        }
+        return m_oracle->uniqueBits().size();
+    }();
 
     if (nbOracleBits < 1)
     {
@@ -120,19 +230,51 @@ void QuantumPhaseEstimation::execute(const std::shared_ptr<AcceleratorBuffer> bu
         qpeKernel->addInstructions(statePrep->getInstructions());
     }
 
-    auto oracleSharedPtr = std::shared_ptr<CompositeInstruction>(m_oracle, xacc::empty_delete<CompositeInstruction>());
-    mapPrimaryQubits(oracleSharedPtr);
+    std::shared_ptr<CompositeInstruction> oracleSharedPtr;
+    if (m_oracle && !fromUnitary && !fromHamiltonian)
+    {
+        oracleSharedPtr = std::shared_ptr<CompositeInstruction>(m_oracle, xacc::empty_delete<CompositeInstruction>());
+        mapPrimaryQubits(oracleSharedPtr);
+    }
+    Eigen::MatrixXcd oraclePower;
+    if (fromUnitary)
+    {
+        oraclePower = m_params.get<Eigen::MatrixXcd>("oracle-unitary");
+    }
     
     // Controlled-oracle application
     for (size_t i = 0; i < bitPrecision; ++i)
     {
         // q0: U; q1: U^2; q2: U^4; etc.
-        const int nbCalls = 1 << i;
+        int nbCalls = 1 << i;
+        auto uPower = oracleSharedPtr;
+        double globalPhase = 0.0;
+        if (fromUnitary)
+        {
+            if (i > 0)
+            {
+                oraclePower = oraclePower * oraclePower;
+            }
+            uPower = synthesize(oraclePower, globalPhase);
+            mapPrimaryQubits(uPower);
+            nbCalls = 1;
+        }
+        else if (fromHamiltonian)
+        {
+            uPower = evolve(m_params, nbCalls * evolutionTime);
+            mapPrimaryQubits(uPower);
+            nbCalls = 1;
+        }
         auto ctrlKernel = std::dynamic_pointer_cast<CompositeInstruction>(xacc::getService<Instruction>("C-U"));
-        ctrlKernel->expand( { 
-            std::make_pair("U",  m_oracle),
+        HeterogeneousMap ctrlOptions { 
+            std::make_pair("U",  uPower.get()),
             std::make_pair("control-idx",  static_cast<int>(i)),
-        });            
+        };
+        if (m_params.keyExists<double>("rotation-cutoff"))
+        {
+            ctrlOptions.insert("rotation-cutoff", m_params.get<double>("rotation-cutoff"));
+        }
+        ctrlKernel->expand(ctrlOptions);
         // Apply C-U^n
         for (int count = 0; count < nbCalls; count++)
         {
@@ -142,11 +284,30 @@ void QuantumPhaseEstimation::execute(const std::shared_ptr<AcceleratorBuffer> bu
                 qpeKernel->addInstruction(ctrlKernel->getInstruction(instId)->clone());
             }
         }
+        // Controlled global phase of the synthesized power
+        if (std::abs(globalPhase) > 1e-12)
+        {
+            qpeKernel->addInstruction(gateRegistry->createInstruction("U1", { i }, { globalPhase }));
+        }
     }
     
     // IQFT on the phase estimation register.
     auto iqft = std::dynamic_pointer_cast<CompositeInstruction>(xacc::getService<Instruction>("iqft"));
-    iqft->expand( { std::make_pair("nq", static_cast<int>(bitPrecision)) });    
+    // Approximate / nearest-neighbour IQFT options are forwarded
+    HeterogeneousMap iqftOptions { std::make_pair("nq", static_cast<int>(bitPrecision)) };
+    if (m_params.keyExists<int>("approximation-degree"))
+    {
+        iqftOptions.insert("approximation-degree", m_params.get<int>("approximation-degree"));
+    }
+    if (m_params.keyExists<double>("rotation-cutoff"))
+    {
+        iqftOptions.insert("rotation-cutoff", m_params.get<double>("rotation-cutoff"));
+    }
+    if (m_params.keyExists<bool>("lnn"))
+    {
+        iqftOptions.insert("lnn", m_params.get<bool>("lnn"));
+    }
+    iqft->expand(iqftOptions);
     qpeKernel->addInstructions(iqft->getInstructions());
     
     // Measure the ancilla/result qubits
@@ -16,6 +16,15 @@
 
 namespace xacc {
 namespace algorithm {
+// Options besides "oracle" (applied 2^i times, controlled by the i-th bit):
+//   "oracle-unitary"  the oracle matrix instead (Eigen::MatrixXcd, kak / QFAST
+//                     bit order): U^(2^i) by repeated squaring, synthesized
+//                     (z-y-z, kak or QFAST) and controlled once,
+//   "hamiltonian"     U = exp(-i H t) instead (Pauli string or Observable):
+//                     U^(2^i) by the trotter generator at time 2^i t, with
+//                     "evolution-time" t (default 1), "trotter-order"
+//                     (default 2) and "trotter-steps" per power (default 1),
+//   "approximation-degree", "rotation-cutoff", "lnn": see qft and C-U.
 class QuantumPhaseEstimation : public Algorithm 
 {
 public:
@@ -15,6 +15,7 @@
 #include "xacc.hpp"
 #include "xacc_service.hpp"
 #include "Algorithm.hpp"
+#include <Eigen/Dense>
 
 using namespace xacc;
 
@@ -84,6 +85,49 @@ TEST(QpeTester, checkMultiQubitOracle)
   EXPECT_NEAR(result, 1.0, 0.01);
 }
 
+TEST(QpeTester, checkUnitaryOracle) 
+{
+  auto acc = xacc::getAccelerator("qpp", {std::make_pair("shots", 1024)});
+  auto compiler = xacc::getCompiler("xasm");
+  auto statePrep = compiler->compile(R"(__qpu__ void prep2(qbit q) {
+    X(q[0]); 
+    X(q[1]); 
+  })", nullptr)->getComposite("prep2");  
+
+  // Controlled-S: diag(1, 1, 1, i), eigenstate |11> => 010
+  Eigen::MatrixXcd unitary = Eigen::MatrixXcd::Identity(4, 4);
+  unitary(3, 3) = std::complex<double>(0.0, 1.0);
+  auto buffer = xacc::qalloc(5);
+  auto qpe = xacc::getService<Algorithm>("QPE");
+  EXPECT_TRUE(qpe->initialize({
+                    std::make_pair("accelerator", acc),
+                    std::make_pair("oracle-unitary", unitary),
+                    std::make_pair("state-preparation", statePrep)
+                  }));
+  qpe->execute(buffer);
+  EXPECT_NEAR(buffer->computeMeasurementProbability("010"), 1.0, 0.01);
+}
+
+TEST(QpeTester, checkHamiltonianOracle) 
+{
+  auto acc = xacc::getAccelerator("qpp", {std::make_pair("shots", 1024)});
+  auto compiler = xacc::getCompiler("xasm");
+  auto statePrep = compiler->compile(R"(__qpu__ void prep3(qbit q) {
+    X(q[0]); 
+  })", nullptr)->getComposite("prep3");  
+
+  // exp(-i pi/4 Z) |1> = exp(i pi/4) |1> => 100, as the T oracle
+  auto buffer = xacc::qalloc(4);
+  auto qpe = xacc::getService<Algorithm>("QPE");
+  EXPECT_TRUE(qpe->initialize({
+                    std::make_pair("accelerator", acc),
+                    std::make_pair("hamiltonian", std::string("0.7853981633974483 Z0")),
+                    std::make_pair("state-preparation", statePrep)
+                  }));
+  qpe->execute(buffer);
+  EXPECT_NEAR(buffer->computeMeasurementProbability("100"), 1.0, 0.01);
+}
+
 int main(int argc, char **argv) 
 {
   xacc::Initialize(argc, argv);
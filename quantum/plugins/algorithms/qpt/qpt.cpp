@@ -54,282 +54,133 @@ void QPT::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
 
   int nQ = circuit->nLogicalBits();
 
-  auto VStack =
-      [](const std::vector<Eigen::MatrixXcd> &mat_vec) -> Eigen::MatrixXcd {
-    assert(!mat_vec.empty());
-    long num_cols = mat_vec[0].cols();
-    size_t num_rows = 0;
-    for (size_t mat_idx = 0; mat_idx < mat_vec.size(); ++mat_idx) {
-      assert(mat_vec[mat_idx].cols() == num_cols);
-      num_rows += mat_vec[mat_idx].rows();
-    }
-    Eigen::MatrixXcd vstacked_mat(num_rows, num_cols);
-    size_t row_offset = 0;
-    for (size_t mat_idx = 0; mat_idx < mat_vec.size(); ++mat_idx) {
-      long cur_rows = mat_vec[mat_idx].rows();
-      vstacked_mat.middleRows(row_offset, cur_rows) = mat_vec[mat_idx];
-      row_offset += cur_rows;
-    }
-    return vstacked_mat;
-  };
-
-  // Paulis
+  // Single-qubit preparations (zp, zm, xp, yp) and measurement operators
+  // (X, Y, Z bases, outcomes 0 and 1)
   Eigen::MatrixXcd im = Eigen::MatrixXcd::Identity(2, 2), px(2, 2), py(2, 2),
                    pz(2, 2);
   px << 0, 1, 1, 0;
   py << 0, -1i, 1i, 0;
   pz << 1, 0, 0, -1;
 
+  const std::vector<std::string> prep_names{"zp", "zm", "xp", "yp"};
   std::vector<Eigen::MatrixXcd> rhos{0.5 * (im + pz), 0.5 * (im - pz),
                                      0.5 * (im + px), 0.5 * (im + py)};
-  std::map<std::string, Eigen::MatrixXcd> prep_label_2_rho{
-      {"zp", rhos[0]}, {"zm", rhos[1]}, {"xp", rhos[2]}, {"yp", rhos[3]}};
 
-  // Measurement operators
   Eigen::MatrixXcd x0(2, 2), x1(2, 2), y0(2, 2), y1(2, 2);
   x0 << .5, .5, .5, .5;
   x1 << .5, -.5, -.5, .5;
   y0 << .5, -.5i, .5i, .5;
   y1 << .5, .5i, -.5i, .5;
 
-  std::vector<Eigen::MatrixXcd> pauli_measure_mats{
-      x0, x1, y0, y1, 0.5 * (im + pz), 0.5 * (im - pz)},
-      blocks;
-
-  std::map<std::string, std::vector<Eigen::MatrixXcd>> pauli_measure_mats_map{
-      {"X", {x0, x1}},
-      {"Y", {y0, y1}},
-      {"Z", {0.5 * (im + pz), 0.5 * (im - pz)}}};
-
-  // Generate all nQubit Pauli Strings
-  std::vector<std::string> XYZ{"X", "Y", "Z"};
-  std::vector<std::string> collected_strings;
-  std::function<void(std::vector<std::string> &, std::string, const int,
-                     const int)>
-      y;
-  y = [&](std::vector<std::string> &set, std::string prefix, const int n,
-          const int k) {
-    if (k == 0) {
-      collected_strings.push_back(prefix);
-      return;
-    }
-
-    for (int i = 0; i < n; i++) {
-      auto newPrefix = prefix + " " + set[i];
-      y(set, newPrefix, n, k - 1);
+  const std::vector<std::string> XYZ{"X", "Y", "Z"};
+  std::vector<std::vector<Eigen::MatrixXcd>> pauli_measure_mats{
+      {x0, x1}, {y0, y1}, {0.5 * (im + pz), 0.5 * (im - pz)}};
+
+  // The 4^n preparations x 3^n measurement bases, qubit 0 is the most
+  // significant digit of the indices.
+  int nPreps = 1, nBases = 1, nOutcomes = 1;
+  for (int q = 0; q < nQ; q++) {
+    nPreps *= 4;
+    nBases *= 3;
+    nOutcomes *= 2;
+  }
+  const auto digits = [nQ](int idx, int base) {
+    std::vector<int> result(nQ);
+    for (int q = nQ - 1; q >= 0; q--) {
+      result[q] = idx % base;
+      idx /= base;
     }
+    return result;
   };
 
-  auto x = [&](std::vector<std::string> &set, const int k) {
-    auto n = set.size();
-    y(set, std::string(""), n, k);
-  };
-
-  // Get all Permutations of XYZ
-  x(XYZ, nQ);
-
-  // Goal 1, create all nqubit pauli strings / observables
-  std::vector<PauliOperator> basis_observables;
-  for (auto s : collected_strings) {
-    xacc::trim(s);
-    auto paulis = xacc::split(s, ' ');
-    std::string pauli_with_idxs = "";
-    int idx = 0;
-    for (auto p : paulis) {
-      pauli_with_idxs += p + std::to_string(idx) + " ";
-      idx++;
-    }
-    basis_observables.emplace_back(pauli_with_idxs);
-  }
-
-  // Goal 2, create states zplus, zmins, xplus, yplus
-  // PLUS circuit on all qubits
+  // Shared template of the tomography circuits: the (flattened and
+  // optimized) circuit to characterize, optimized once.
   auto provider = xacc::getIRProvider("quantum");
   auto circuit_as_shared = std::shared_ptr<CompositeInstruction>(
       circuit, xacc::empty_delete<CompositeInstruction>());
-  std::map<int, std::vector<std::shared_ptr<CompositeInstruction>>>
-      prep_circuits;
-
-  // template composite instructions, call setBits to change qbit idx
-  auto template_generator =
-      [&](const std::string &name,
-          std::size_t qbit) -> std::shared_ptr<CompositeInstruction> {
-    if (name == "zp") {
-      return provider->createComposite("zp");
-    } else if (name == "zm") {
-      auto zm_i = provider->createComposite("zm");
-      zm_i->addInstruction(
-          provider->createInstruction("X", std::vector<std::size_t>{qbit}));
-      return zm_i;
-    } else if (name == "xp") {
-      auto xp_i = provider->createComposite("xp");
-      xp_i->addInstruction(
-          provider->createInstruction("H", std::vector<std::size_t>{qbit}));
-      return xp_i;
-    } else if (name == "yp") {
-      auto yp_i = provider->createComposite("yp");
-      yp_i->addInstruction(
-          provider->createInstruction("H", std::vector<std::size_t>{qbit}));
-      yp_i->addInstruction(
-          provider->createInstruction("S", std::vector<std::size_t>{qbit}));
-      return yp_i;
-    } else {
-      return nullptr;
+  auto body = provider->createComposite(circuit->name(),
+                                        circuit->getVariables());
+  InstructionIterator iter(circuit_as_shared);
+  while (iter.hasNext()) {
+    auto inst = iter.next();
+    if (!inst->isComposite()) {
+      body->addInstruction(inst->clone());
     }
-  };
-
-  std::vector<std::string> prep_names{"zp", "zm", "xp", "yp"};
-  collected_strings.clear();
-  x(prep_names, nQ);
-
-  std::vector<std::vector<std::string>> prep_labels;
-  for (auto c : collected_strings) {
-    xacc::trim(c);
-    auto preps = xacc::split(c, ' ');
-    prep_labels.push_back(preps);
   }
-
-  // Get all possible bit strings
-  collected_strings.clear();
-  std::vector<std::string> bits{"0", "1"}, all_bit_strings;
-  x(bits, nQ);
-  for (auto &bs : collected_strings) {
-    xacc::trim(bs);
-    auto bbits = xacc::split(bs, ' ');
-    std::string bbs = "";
-    for (auto bb : bbits)
-      bbs += bb;
-    all_bit_strings.push_back(bbs);
+  if (optimizeCircuit) {
+    xacc::getIRTransformation("circuit-optimizer")->apply(body, nullptr);
   }
+  // Measurements are on the buffer of the circuit (as Observable::observe)
+  const std::vector<std::string> buffer_names =
+      body->nInstructions() > 0 ? body->getInstruction(0)->getBufferNames()
+                                : std::vector<std::string>{};
 
-  std::vector<std::string> names;
   std::vector<std::shared_ptr<CompositeInstruction>> all_circuits;
-  for (auto &prep_names_on_qbits : prep_labels) {
+  all_circuits.reserve(nPreps * nBases);
+  for (int prep_idx = 0; prep_idx < nPreps; prep_idx++) {
+    const auto preps = digits(prep_idx, 4);
     std::string comp_name = "";
-    for (auto &p : prep_names_on_qbits) {
-      comp_name += p + "_";
-    }
-    auto prep_on_all_qbits = provider->createComposite(comp_name + "all");
-    for (std::size_t i = 0; i < nQ; i++) {
-      auto prep_name = prep_names_on_qbits[i];
-      auto prep = template_generator(prep_name, i);
-      if (i > 0) {
-        prep->setBits({i});
-      }
-
-
-      prep_on_all_qbits->addInstructions(prep->getInstructions());
-    }
-
-    // Add circuit to be characterized
-    for (auto& inst : circuit_as_shared->getInstructions()) {
-       prep_on_all_qbits->addInstruction(inst->clone());
+    for (auto &p : preps) {
+      comp_name += prep_names[p] + "_";
     }
 
-    // Create Prep Operator
-    Eigen::MatrixXcd prep;
-    for (int k = 0; k < prep_names_on_qbits.size(); k++) {
-      auto p = prep_names_on_qbits[k];
-      //   std::cout << p << ", " << k << ", " << prep_label_2_rho[p] << "\n";
-      if (k == 0) {
-        prep = prep_label_2_rho[p];
-      } else {
-        prep = Eigen::kroneckerProduct(prep_label_2_rho[p], prep).eval();
-      }
-    }
-
-    // std::cout << "PREP:\n" << prep << "\n";
-    for (auto &basis_element : basis_observables) {
-      auto prep_on_all_and_meas = basis_element.observe(prep_on_all_qbits)[0];
-
-      std::stringstream ss;
+    for (int basis_idx = 0; basis_idx < nBases; basis_idx++) {
+      const auto bases = digits(basis_idx, 3);
       std::vector<std::string> measure_label;
-      std::vector<int> idxs;
-      auto pauli_as_term = *basis_element.begin();
-      for (auto &kv : pauli_as_term.second.ops()) {
-        // std::cout << "OP: " << kv.second << " ";
-        measure_label.push_back(kv.second);
-        idxs.push_back(kv.first);
+      for (auto &b : bases) {
+        measure_label.push_back(XYZ[b]);
       }
-      //   std::cout << "\n";
+      std::stringstream ss;
       ss << measure_label;
-
-      names.push_back(comp_name + "_" + ss.str());
-      prep_on_all_and_meas->setName(comp_name + "_"+ss.str());
-
-      all_circuits.push_back(prep_on_all_and_meas);
-
-      std::vector<Eigen::MatrixXcd> meas_mats;
-      for (auto iter : all_bit_strings) {
-        // std::cout << iter << "\n";
-
-        Eigen::MatrixXcd meas_mat;
-        int counter = 0;
-
-        // Direction of loop here is dependent on bit ordering
-        // from backend accelerator. Default is MSB like IBM
-        int start;
-        std::function<bool(int&)> stop_condition;
-        std::function<void(int&)> iter_expr;
-        start = measure_label.size()-1;
-        stop_condition = [](int& k) {return k>=0;};
-        iter_expr = [](int& k) {k = k - 1;};
-        for (int k = start; stop_condition(k); iter_expr(k)) {
-          int bit = iter[counter] == '0' ? 0 : 1;
-          auto mat = pauli_measure_mats_map[measure_label[k]][bit];
-          if (k == measure_label.size() - 1) {
-            meas_mat = mat;
-          } else {
-            meas_mat = Eigen::kroneckerProduct(meas_mat, mat).eval();
+      auto tomo_circuit = provider->createComposite(
+          comp_name + "_" + ss.str(), body->getVariables());
+
+      for (std::size_t i = 0; i < nQ; i++) {
+        if (preps[i] == 1) {
+          tomo_circuit->addInstruction(
+              provider->createInstruction("X", std::vector<std::size_t>{i}));
+        } else if (preps[i] >= 2) {
+          tomo_circuit->addInstruction(
+              provider->createInstruction("H", std::vector<std::size_t>{i}));
+          if (preps[i] == 3) {
+            tomo_circuit->addInstruction(provider->createInstruction(
+                "S", std::vector<std::size_t>{i}));
           }
-          counter++;
         }
-        meas_mats.push_back(meas_mat);
-      }
-
-      std::vector<Eigen::MatrixXcd> prep_meas_mats;
-      for (auto &m : meas_mats) {
-        // std::cout << "Meas:\n" << m << "\n";
-        prep_meas_mats.push_back(
-            Eigen::kroneckerProduct(prep.transpose(), m).eval());
       }
-
-      Eigen::MatrixXcd ret(prep_meas_mats.size(), prep_meas_mats[0].size());
-      for (int k = 0; k < prep_meas_mats.size(); k++) {
-        ret.row(k) = Eigen::Map<Eigen::VectorXcd>(prep_meas_mats[k].data(),
-                                                  prep_meas_mats[k].size())
-                         .conjugate();
+      for (auto &inst : body->getInstructionsView()) {
+        tomo_circuit->addInstruction(inst->clone());
       }
 
-      blocks.push_back(ret);
-    }
-  }
-
-  Eigen::MatrixXcd basis_matrix = VStack(blocks);
-
-  std::vector<std::shared_ptr<CompositeInstruction>> tmp_all;
-
-  for (auto& c : all_circuits) {
-    std::vector<InstPtr> flatten;
-    InstructionIterator iter(c);
-    while (iter.hasNext()) {
-      auto inst = iter.next();
-      if (!inst->isComposite()) {
-        flatten.emplace_back(inst);
+      // Basis changes then measurements, last qubit first
+      std::vector<InstPtr> measurements;
+      for (int i = nQ - 1; i >= 0; i--) {
+        std::size_t qbit = i;
+        InstPtr gate;
+        if (bases[i] == 0) {
+          gate = provider->createInstruction("H",
+                                             std::vector<std::size_t>{qbit});
+        } else if (bases[i] == 1) {
+          gate = provider->createInstruction("Rx",
+                                             std::vector<std::size_t>{qbit},
+                                             {xacc::constants::pi / 2.0});
+        }
+        if (gate) {
+          if (!buffer_names.empty()) {
+            gate->setBufferNames(buffer_names);
+          }
+          tomo_circuit->addInstruction(gate);
+        }
+        auto meas = provider->createInstruction(
+            "Measure", std::vector<std::size_t>{qbit});
+        if (!buffer_names.empty()) {
+          meas->setBufferNames(buffer_names);
+        }
+        meas->setParameter(0, InstructionParameter(i));
+        measurements.push_back(meas);
       }
-    }
-    auto tmp = provider->createComposite(c->name(), c->getVariables());
-    tmp->addInstructions(flatten);
-    tmp_all.push_back(tmp);
-  }
-
-  all_circuits = tmp_all;
-
-  // Perform default circuit optimization
-  if (optimizeCircuit) {
-    auto optimizer = xacc::getIRTransformation("circuit-optimizer");
-    for (auto circuit : all_circuits) {
-      optimizer->apply(circuit, nullptr);
+      tomo_circuit->addInstructions(measurements);
+      all_circuits.push_back(tomo_circuit);
     }
   }
 
@@ -341,11 +192,23 @@ void QPT::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
       }
   }
 
-  // Execute and get data vector
+  // Execute (a single batch) and get data vector
   qpu->execute(buffer, all_circuits);
   auto children = buffer->getChildren();
 
+  // Get all possible bit strings, the outcome of qubit q is its bit
+  // nQ - 1 - q (before the MSB reversal).
+  std::vector<std::string> all_bit_strings;
+  for (int outcome_idx = 0; outcome_idx < nOutcomes; outcome_idx++) {
+    std::string bit_string;
+    for (int k = 0; k < nQ; k++) {
+      bit_string += ((outcome_idx >> (nQ - 1 - k)) & 1) ? "1" : "0";
+    }
+    all_bit_strings.push_back(bit_string);
+  }
+
   std::vector<std::complex<double>> data_vec;
+  data_vec.reserve(children.size() * nOutcomes);
   auto xasm = xacc::getCompiler("xasm");
   int i = 0;
   for (auto &child : children) {
@@ -357,19 +220,95 @@ void QPT::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
       if (qpu->getBitOrder() == Accelerator::BitOrder::MSB) {
           std::reverse(bit_string.begin(), bit_string.end());
       }
-    //   std::cout << names[i] << ", " << child->getMeasurementCounts() << ", " << bit_string << "\n";
       auto prob = child->computeMeasurementProbability(bit_string);
       data_vec.push_back(prob);
     }
     i++;
   }
 
-  Eigen::VectorXcd data =
-      Eigen::Map<Eigen::VectorXcd>(data_vec.data(), data_vec.size());
+  // Linear inversion. The data (prep, basis, outcome) are the Born
+  // probabilities conj(vec(rho^T (x) E)) . vec(choi), with rho and E tensor
+  // products over the qubits: up to index permutations the basis matrix is
+  // A1 (x) ... (x) A1 with A1 the 24 x 16 single-qubit one, and the least
+  // squares solution is pinv(A1) applied along the qubit axis of the data
+  // tensor, one qubit at a time (without the 12^n x 16^n basis matrix).
+  // Single-qubit row (prep * 3 + basis) * 2 + outcome, column
+  // r1 + 2 c1 + 4 r2 + 8 c2 for the entries rho^T(r1, c1) and E(r2, c2).
+  Eigen::MatrixXcd single_qubit_basis(24, 16);
+  for (int p = 0; p < 4; p++) {
+    for (int b = 0; b < 3; b++) {
+      for (int o = 0; o < 2; o++) {
+        for (int u = 0; u < 16; u++) {
+          const int r1 = u & 1, c1 = (u >> 1) & 1, r2 = (u >> 2) & 1,
+                    c2 = (u >> 3) & 1;
+          single_qubit_basis((p * 3 + b) * 2 + o, u) = std::conj(
+              rhos[p](c1, r1) * pauli_measure_mats[b][o](r2, c2));
+        }
+      }
+    }
+  }
+  const Eigen::MatrixXcd single_qubit_pinv =
+      single_qubit_basis.completeOrthogonalDecomposition().pseudoInverse();
+
+  // Data tensor, the single-qubit row of qubit q has stride 24^q
+  std::vector<std::complex<double>> tensor(data_vec.size());
+  for (int prep_idx = 0; prep_idx < nPreps; prep_idx++) {
+    const auto preps = digits(prep_idx, 4);
+    for (int basis_idx = 0; basis_idx < nBases; basis_idx++) {
+      const auto bases = digits(basis_idx, 3);
+      for (int outcome_idx = 0; outcome_idx < nOutcomes; outcome_idx++) {
+        std::size_t tensor_idx = 0, stride = 1;
+        for (int q = 0; q < nQ; q++) {
+          const int o = (outcome_idx >> q) & 1;
+          tensor_idx += stride * ((preps[q] * 3 + bases[q]) * 2 + o);
+          stride *= 24;
+        }
+        tensor[tensor_idx] =
+            data_vec[(prep_idx * nBases + basis_idx) * nOutcomes + outcome_idx];
+      }
+    }
+  }
+
+  // Contract pinv(A1) with the tensor axis of each qubit in turn
+  std::size_t inner = 1;
+  for (int q = 0; q < nQ; q++) {
+    const std::size_t outer = tensor.size() / (inner * 24);
+    std::vector<std::complex<double>> contracted(inner * 16 * outer);
+    xacc::getTaskScheduler()->parallelFor(
+        0, outer, [&](std::size_t begin_idx, std::size_t end_idx) {
+          for (std::size_t io = begin_idx; io < end_idx; io++) {
+            for (int u = 0; u < 16; u++) {
+              for (std::size_t ii = 0; ii < inner; ii++) {
+                std::complex<double> sum = 0.0;
+                for (int r = 0; r < 24; r++) {
+                  sum += single_qubit_pinv(u, r) *
+                         tensor[ii + inner * (r + 24 * io)];
+                }
+                contracted[ii + inner * (u + 16 * io)] = sum;
+              }
+            }
+          }
+        });
+    tensor.swap(contracted);
+    inner *= 16;
+  }
 
-  Eigen::VectorXcd choi_vec =
-      basis_matrix.bdcSvd(Eigen::ComputeThinU | Eigen::ComputeThinV)
-          .solve(data);
+  // vec(choi) index: (r1 * 2^n + r2) + (c1 * 2^n + c2) * 4^n, bit q of r1,
+  // c1, r2 and c2 from the column of qubit q.
+  Eigen::VectorXcd choi_vec(tensor.size());
+  for (std::size_t t = 0; t < tensor.size(); t++) {
+    std::size_t r1 = 0, c1 = 0, r2 = 0, c2 = 0, rest = t;
+    for (int q = 0; q < nQ; q++) {
+      const std::size_t u = rest % 16;
+      rest /= 16;
+      r1 |= (u & 1) << q;
+      c1 |= ((u >> 1) & 1) << q;
+      r2 |= ((u >> 2) & 1) << q;
+      c2 |= ((u >> 3) & 1) << q;
+    }
+    choi_vec((r1 * nOutcomes + r2) + (c1 * nOutcomes + c2) * nPreps) =
+        tensor[t];
+  }
   Eigen::MatrixXcd choi = Eigen::Map<Eigen::MatrixXcd>(
       choi_vec.data(), std::pow(2, 2 * nQ), std::pow(2, 2 * nQ));
 
@@ -228,6 +228,40 @@ TEST(QPTTester, checkBell) {
     EXPECT_NEAR(1.0, fidelity(.25 * chi, .25 * true_bell_chi), 1e-1);
   }
 }
+TEST(QPTTester, checkThreeQubitPauli) {
+  if (xacc::hasAccelerator("qpp")) {
+    // 64 x 27 tomography circuits, a single execution
+    auto acc = xacc::getAccelerator("qpp", {std::make_pair("shots", 1024)});
+    auto buffer = xacc::qalloc(3);
+
+    auto compiler = xacc::getCompiler("xasm");
+    auto ir = compiler->compile(R"(__qpu__ void xyz(qbit q) {
+        X(q[0]);
+        Y(q[1]);
+        Z(q[2]);
+    })",
+                                nullptr);
+    auto xyz = ir->getComposite("xyz");
+
+    auto qpt = xacc::getService<Algorithm>("qpt");
+    EXPECT_TRUE(qpt->initialize(
+        {std::make_pair("circuit", xyz), std::make_pair("accelerator", acc)}));
+    qpt->execute(buffer);
+    EXPECT_EQ(buffer->nChildren(), 64 * 27);
+
+    // A Pauli channel: a single (normalized) chi element
+    auto chi_real = (*buffer)["chi-real"].as<std::vector<double>>();
+    EXPECT_EQ(chi_real.size(), 64 * 64);
+    double trace = 0.0, max_diag = 0.0;
+    for (int i = 0; i < 64; i++) {
+      trace += chi_real[i * 64 + i] / 8.0;
+      max_diag = std::max(max_diag, chi_real[i * 64 + i] / 8.0);
+    }
+    EXPECT_NEAR(trace, 1.0, 1e-1);
+    EXPECT_NEAR(max_diag, 1.0, 1e-1);
+  }
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize(argc, argv);
   xacc::external::load_external_language_plugins();
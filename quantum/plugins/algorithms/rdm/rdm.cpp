@@ -14,14 +14,126 @@
 
 #include "Observable.hpp"
 #include "xacc.hpp"
+#include "xacc_service.hpp"
 
 #include "FermionOperator.hpp"
+#include "ObservableTransform.hpp"
+#include "PauliOperator.hpp"
+#include <Eigen/SparseCore>
 #include <unsupported/Eigen/CXX11/Tensor>
 #include <unsupported/Eigen/CXX11/TensorSymmetry>
 
+#include <array>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
 using namespace xacc;
 
+namespace {
+// The Pauli decomposition of the independent rho_pqrs elements,
+// rho = identity + coefficients * <terms>. It only depends on the number
+// of spin-orbitals and the options, so it is built once per process and
+// shared by all the executions (e.g. every VQE iteration of the
+// rdm-purification decorator).
+struct MeasurementPlan {
+  // (m, n, v, w) of the independent elements and their "m,n,v,w" labels
+  std::vector<std::array<int, 4>> elements;
+  std::vector<std::string> labels;
+  // The distinct non-identity Pauli strings (grouping set) and the index
+  // of each term id, i.e. the column of coefficients (elements x terms)
+  std::shared_ptr<xacc::quantum::PauliOperator> measured;
+  std::unordered_map<std::string, int> termIndex;
+  Eigen::SparseMatrix<double> coefficients;
+  Eigen::VectorXd identity;
+};
+
+std::shared_ptr<MeasurementPlan>
+buildMeasurementPlan(int nQubits, bool szSymmetry,
+                     const std::string &grouping) {
+  auto plan = std::make_shared<MeasurementPlan>();
+
+  // Spin of a spin-orbital (alpha first) for the Sz selection rule
+  auto isBeta = [&](int p) { return 2 * p >= nQubits; };
+
+  // The independent elements: pairs (m, n), m < n, and (v, w) <= (m, n)
+  // follows from rho(m, n, v, w) = rho(v, w, m, n).
+  std::vector<std::pair<int, int>> pairs;
+  for (int m = 0; m < nQubits; m++) {
+    for (int n = m + 1; n < nQubits; n++) {
+      pairs.emplace_back(m, n);
+    }
+  }
+  for (int i = 0; i < pairs.size(); i++) {
+    for (int j = i; j < pairs.size(); j++) {
+      const auto [m, n] = pairs[i];
+      const auto [v, w] = pairs[j];
+      if (szSymmetry &&
+          isBeta(m) + isBeta(n) != isBeta(v) + isBeta(w)) {
+        continue;
+      }
+      plan->elements.push_back({m, n, v, w});
+      plan->labels.push_back(std::to_string(m) + "," + std::to_string(n) +
+                             "," + std::to_string(v) + "," +
+                             std::to_string(w));
+    }
+  }
+
+  // JW transform each element, the distinct non-identity Pauli strings are
+  // collected in a single observable and measured once.
+  auto jw = xacc::getService<ObservableTransform>("jw");
+  plan->measured = std::make_shared<xacc::quantum::PauliOperator>();
+  plan->identity = Eigen::VectorXd::Zero(plan->elements.size());
+  std::vector<Eigen::Triplet<double>> triplets;
+  for (int i = 0; i < plan->elements.size(); i++) {
+    const auto &e = plan->elements[i];
+    std::stringstream xx;
+    xx << "0.5 " << e[0] << "^ " << e[1] << "^ " << e[3] << " " << e[2]
+       << " + "
+       << "0.5 " << e[3] << "^ " << e[2] << "^ " << e[0] << " " << e[1];
+    auto op = std::make_shared<xacc::quantum::FermionOperator>(xx.str());
+    auto pauli = std::dynamic_pointer_cast<xacc::quantum::PauliOperator>(
+        jw->transform(op));
+    for (auto &[termId, term] : pauli->getTerms()) {
+      const double t = std::real(term.coeff());
+      if (term.isIdentity()) {
+        // We don't execute the identity terms
+        // but we still have to add their contribution
+        plan->identity[i] += t;
+        continue;
+      }
+      auto iter = plan->termIndex.find(termId);
+      if (iter == plan->termIndex.end()) {
+        iter = plan->termIndex.emplace(termId, plan->termIndex.size()).first;
+        *plan->measured += xacc::quantum::PauliOperator(term.ops(), 1.0);
+      }
+      triplets.emplace_back(i, iter->second, t);
+    }
+  }
+  if (!grouping.empty()) {
+    plan->measured->fromOptions({{"grouping", grouping}});
+  }
+  plan->coefficients.resize(plan->elements.size(), plan->termIndex.size());
+  plan->coefficients.setFromTriplets(triplets.begin(), triplets.end());
+  return plan;
+}
+
+std::shared_ptr<const MeasurementPlan>
+getMeasurementPlan(int nQubits, bool szSymmetry, const std::string &grouping) {
+  static std::mutex cacheMutex;
+  static std::map<std::tuple<int, bool, std::string>,
+                  std::shared_ptr<const MeasurementPlan>>
+      cache;
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  auto &plan = cache[std::make_tuple(nQubits, szSymmetry, grouping)];
+  if (!plan) {
+    plan = buildMeasurementPlan(nQubits, szSymmetry, grouping);
+  }
+  return plan;
+}
+} // namespace
+
 namespace xacc {
 namespace algorithm {
 bool RDM::initialize(const HeterogeneousMap &parameters) {
@@ -34,6 +146,20 @@ bool RDM::initialize(const HeterogeneousMap &parameters) {
   ansatz = parameters.get<std::shared_ptr<CompositeInstruction>>("ansatz");
   accelerator = parameters.get<std::shared_ptr<Accelerator>>("accelerator");
 
+  grouping = "";
+  if (parameters.stringExists("grouping")) {
+    grouping = parameters.getString("grouping");
+    if (grouping == "none") {
+      grouping = "";
+    }
+    if (!grouping.empty() && grouping != "qwc") {
+      std::cout << "Invalid 'grouping' " << grouping
+                << ", valid modes are none and qwc.\n";
+      return false;
+    }
+  }
+  szSymmetry = parameters.get_or_default("sz-symmetry", false);
+
   return true;
 }
 
@@ -43,148 +169,96 @@ const std::vector<std::string> RDM::requiredParameters() const {
 
 void RDM::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
 
-  // Reset
-  int nQubits = buffer->size(), nExecs = 0;
-
-  Eigen::Tensor<std::complex<double>, 4> rho_pqrs(nQubits, nQubits, nQubits,
-                                                  nQubits);
-  rho_pqrs.setZero();
-
-  // Get the Accelerator we're running on, the
-  // number of orbitals/qubits in the problem,
-  // the MPIProvider Communicator reference, and the
-  // VQE state preparation ansatz.
-
-  Eigen::DynamicSGroup rho_pq_Sym, rho_pqrs_Sym;
-  rho_pq_Sym.addHermiticity(0, 1);
-  rho_pqrs_Sym.addAntiSymmetry(0, 1);
-  rho_pqrs_Sym.addAntiSymmetry(2, 3);
-
-  // Map p,q,r,s indices to a coefficient for all
-  // identity terms encountered
-  std::map<std::vector<int>, double> rho_element_2_identity_coeff;
-
-  // Map function names to the actual function and all
-  // p,q,r,s and coefficients that contribute to that element
-  std::map<std::string,
-           std::pair<std::shared_ptr<CompositeInstruction>,
-                     std::vector<std::pair<std::vector<int>, double>>>>
-      functions;
-
-  // Generate the 2-RDM circuits for executiong
-  for (int m = 0; m < nQubits; m++) {
-    for (int n = m + 1; n < nQubits; n++) {
-      for (int v = m; v < nQubits; v++) {
-        for (int w = v + 1; w < nQubits; w++) {
-          std::stringstream xx;
-          xx << "0.5 " << m << "^ " << n << "^ " << w << " " << v << " + "
-             << "0.5 " << w << "^ " << v << "^ " << m << " " << n;
-          auto op = std::make_shared<xacc::quantum::FermionOperator>(xx.str());
-          auto hpqrs_ir = op->observe(ansatz);
-
-          for (auto &kernel : hpqrs_ir) {
-            auto t = std::real(
-                kernel->getCoefficient());
-            int nFunctionInstructions = 0;
-
-            if (kernel->getInstruction(0)->isComposite()) {
-              nFunctionInstructions =
-                  ansatz->nInstructions() + kernel->nInstructions() - 1;
-            } else {
-              nFunctionInstructions = kernel->nInstructions();
-            }
-
-            if (nFunctionInstructions > ansatz->nInstructions()) {
-              // if (kernel->nInstructions() > ansatz->nInstructions()) {
-              auto name = kernel->name();
-              if (functions.count(name)) {
-                functions[name].second.push_back({{m, n, v, w}, t});
-              } else {
-                functions.insert({name, {kernel, {{{m, n, v, w}, t}}}});
-              }
-            } else {
-              rho_element_2_identity_coeff.insert({{m, n, v, w}, t});
-            }
-          }
-        }
-      }
-    }
-  }
-
-  std::vector<std::shared_ptr<CompositeInstruction>> fsToExecute;
-  for (auto &kv : functions) {
-    fsToExecute.push_back(kv.second.first);
-  }
-
-  int nPhysicalQubits =
-      nQubits; //*std::max_element(qubitMap.begin(), qubitMap.end()) + 1;
+  int nQubits = buffer->size();
+  const auto plan = getMeasurementPlan(nQubits, szSymmetry, grouping);
+  const auto &elements = plan->elements;
+  const auto nTerms = plan->termIndex.size();
 
   // Execute all nontrivial circuits
-  xacc::info("[RDM] Executing " + std::to_string(fsToExecute.size()) +
-             " circuits to compute rho_pqrs.");
   auto tmpBuffer = xacc::qalloc(buffer->size());
-  accelerator->execute(tmpBuffer, fsToExecute);
+  if (nTerms > 0) {
+    accelerator->computeExpectations(tmpBuffer, ansatz, plan->measured);
+  }
   auto buffers = tmpBuffer->getChildren();
+  xacc::info("[RDM] Executed " + std::to_string(buffers.size()) +
+             " circuits (" + std::to_string(nTerms) +
+             " Pauli terms) to compute " + std::to_string(elements.size()) +
+             " rho_pqrs elements.");
 
   bool useROExps = false;
   if (accelerator->name() == "ro-error") {
     useROExps = true;
   }
 
-  // Create a mapping of rho_pqrs elements to summed expectation values for
-  // each circuit contributing to it
-  std::map<std::vector<int>, double> sumMap;
-  for (int i = 0; i < buffers.size(); i++) {
-    auto fName = fsToExecute[i]->name();
-    auto p = functions[fName];
+  // The expectation values of the terms measured by each circuit
+  if (grouping == "qwc") {
+    const HeterogeneousMap postProcessOptions{std::make_pair(
+        "bit-order",
+        std::string(accelerator->getBitOrder() == Accelerator::BitOrder::MSB
+                        ? "MSB"
+                        : "LSB"))};
+    plan->measured->postProcess(tmpBuffer,
+                                Observable::PostProcessingTask::EXP_VAL_CALC,
+                                postProcessOptions);
+  }
+  Eigen::VectorXd termValues = Eigen::VectorXd::Zero(nTerms);
+  for (auto &childBuffer : buffers) {
+    std::map<std::string, double> termExpVals;
+    if (grouping == "qwc") {
+      termExpVals = mpark::get<std::map<std::string, double>>(
+          childBuffer->getInformation("term-exp-vals"));
+    } else {
+      auto termName = childBuffer->name();
+      if (termName.rfind("evaled_", 0) == 0) {
+        termName.erase(0, 7);
+      }
+      termExpVals.emplace(
+          termName, useROExps ? mpark::get<double>(childBuffer->getInformation(
+                                    "ro-fixed-exp-val-z"))
+                              : childBuffer->getExpectationValueZ());
+    }
+
+    // The rho_pqrs elements each circuit contributes to
     std::vector<std::string> contributingIndices;
     std::vector<double> contributingCoeffs;
-    for (auto &l : p.second) {
-      auto elements = l.first;
-      std::stringstream s;
-      s << elements[0] << "," << elements[1] << "," << elements[2] << ","
-        << elements[3];
-      contributingIndices.push_back(s.str());
-      double value;
-      if (useROExps) {
-        value = l.second * mpark::get<double>(buffers[i]->getInformation(
-                               "ro-fixed-exp-val-z"));
-      } else {
-        value = l.second * buffers[i]->getExpectationValueZ();
+    for (auto &[termId, expVal] : termExpVals) {
+      auto iter = plan->termIndex.find(termId);
+      if (iter == plan->termIndex.end()) {
+        xacc::error("[RDM] Unexpected measured term " + termId);
       }
-      contributingCoeffs.push_back(value);
-      if (!sumMap.count(elements)) {
-        sumMap.insert({elements, value});
-      } else {
-        sumMap[elements] += value;
+      termValues[iter->second] = expVal;
+      for (Eigen::SparseMatrix<double>::InnerIterator it(plan->coefficients,
+                                                         iter->second);
+           it; ++it) {
+        contributingIndices.push_back(plan->labels[it.row()]);
+        contributingCoeffs.push_back(it.value() * expVal);
       }
     }
-    buffers[i]->addExtraInfo("kernel", ExtraInfo(fName));
-    buffers[i]->addExtraInfo("contributing_rho_pqrs",
-                             ExtraInfo(contributingIndices));
-    buffers[i]->addExtraInfo("contributing_coeffs",
-                             ExtraInfo(contributingCoeffs));
-    buffer->appendChild(fName, buffers[i]);
-  }
-
-  // Add all identity terms, we don't execute them
-  // but we still have to add their contribution
-  for (auto &kv : rho_element_2_identity_coeff) {
-    sumMap[kv.first] += kv.second;
+    const auto fName = childBuffer->name();
+    childBuffer->addExtraInfo("kernel", ExtraInfo(fName));
+    childBuffer->addExtraInfo("contributing_rho_pqrs",
+                              ExtraInfo(contributingIndices));
+    childBuffer->addExtraInfo("contributing_coeffs",
+                              ExtraInfo(contributingCoeffs));
+    buffer->appendChild(fName, childBuffer);
   }
+  const Eigen::VectorXd elementValues =
+      plan->identity + plan->coefficients * termValues;
 
   // Set rho_pqrs. This is all we need
   // to get rho_pq as well
-  for (auto &kv : sumMap) {
-    auto elements = kv.first;
-    rho_pqrs_Sym(rho_pqrs, elements[0], elements[1], elements[2], elements[3]) =
-        kv.second;
-    rho_pqrs_Sym(rho_pqrs, elements[2], elements[3], elements[0], elements[1]) =
-        kv.second;
+  Eigen::Tensor<double, 4> rho_pqrs(nQubits, nQubits, nQubits, nQubits);
+  rho_pqrs.setZero();
+  Eigen::DynamicSGroup rho_pqrs_Sym;
+  rho_pqrs_Sym.addAntiSymmetry(0, 1);
+  rho_pqrs_Sym.addAntiSymmetry(2, 3);
+  for (int i = 0; i < elements.size(); i++) {
+    const auto &e = elements[i];
+    rho_pqrs_Sym(rho_pqrs, e[0], e[1], e[2], e[3]) = elementValues[i];
+    rho_pqrs_Sym(rho_pqrs, e[2], e[3], e[0], e[1]) = elementValues[i];
   }
 
-  Eigen::Tensor<double, 4> realt = rho_pqrs.real();
-  auto real = realt.data();
+  auto real = rho_pqrs.data();
   std::vector<double> rho_pqrs_data(real, real + rho_pqrs.size());
   for (auto &a : rho_pqrs_data)
     if (std::fabs(a) < 1e-12)
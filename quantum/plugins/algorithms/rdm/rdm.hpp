@@ -17,10 +17,21 @@
 
 namespace xacc {
 namespace algorithm {
+// 2-RDM of the state prepared by the ansatz. Only the elements
+// rho(m, n, v, w) with m < n, v < w and (m, n) <= (v, w) are measured, the
+// others follow from the (anti)symmetries. The JW Pauli strings are shared
+// by many elements: each distinct string is measured once, optionally in
+// qubit-wise commuting groups. Options:
+//   "grouping"    "qwc" to measure commuting strings together (requires
+//                 shots), "none" (default) for one circuit per string,
+//   "sz-symmetry" skip (i.e. set to zero) the elements that do not conserve
+//                 Sz; spin-orbitals are ordered as all alpha then all beta.
 class RDM : public Algorithm {
 protected:
   std::shared_ptr<CompositeInstruction> ansatz;
   std::shared_ptr<Accelerator> accelerator;
+  std::string grouping = "";
+  bool szSymmetry = false;
 
   HeterogeneousMap parameters;
 
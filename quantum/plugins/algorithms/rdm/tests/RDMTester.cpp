@@ -149,6 +149,81 @@ TEST(RDMGeneratorTester, checkGround) {
 //   }
 }
 
+// Energy of the H2 Hamiltonian (src) from a 2-RDM
+double rdmEnergy(std::vector<double> data) {
+  const int nQubits = 4;
+  xacc::quantum::FermionOperator op(src);
+  Eigen::Tensor<double, 2> hpq(4, 4);
+  hpq.setZero();
+  Eigen::Tensor<double, 4> hpqrs(4, 4, 4, 4);
+  hpqrs.setZero();
+  double energy = 0.0;
+  for (auto &kv : op.getTerms()) {
+    auto ops = kv.second.ops();
+    if (ops.size() == 4) {
+      hpqrs(ops[0].first, ops[1].first, ops[2].first, ops[3].first) =
+          std::real(kv.second.coeff());
+    } else if (ops.size() == 2) {
+      hpq(ops[0].first, ops[1].first) = std::real(kv.second.coeff());
+    } else {
+      energy = std::real(kv.second.coeff());
+    }
+  }
+
+  Eigen::TensorMap<Eigen::Tensor<double, 4>> rho_pqrs(data.data(), 4, 4, 4, 4);
+  Eigen::array<int, 2> cc2({1, 3});
+  Eigen::Tensor<double, 2> rho_pq = rho_pqrs.trace(cc2);
+  for (int p = 0; p < nQubits; p++) {
+    for (int q = 0; q < nQubits; q++) {
+      for (int r = 0; r < nQubits; r++) {
+        for (int s = 0; s < nQubits; s++) {
+          energy += 0.5 * hpqrs(p, q, r, s) *
+                    (rho_pqrs(p, q, s, r) + rho_pqrs(r, s, q, p));
+        }
+      }
+      energy += 0.5 * hpq(p, q) * (rho_pq(p, q) + rho_pq(q, p));
+    }
+  }
+  return energy;
+}
+
+TEST(RDMGeneratorTester, checkSymmetryAndGrouping) {
+  auto compiler = xacc::getCompiler("xasm");
+  auto ruccsd = compiler->compile(rucc, nullptr)->getComposite("f");
+  ruccsd = (*ruccsd.get())(std::vector<double>{.22984});
+
+  auto runRdm = [&](xacc::HeterogeneousMap options) {
+    auto rdmGen = xacc::getAlgorithm("rdm");
+    options.insert("ansatz", ruccsd);
+    EXPECT_TRUE(rdmGen->initialize(options));
+    auto buffer = xacc::qalloc(4);
+    rdmGen->execute(buffer);
+    return buffer;
+  };
+
+  // Every distinct Pauli string is measured once
+  auto full = runRdm({std::make_pair("accelerator", xacc::getAccelerator("qpp"))});
+  EXPECT_NEAR(rdmEnergy(full->getInformation("2-rdm").as<std::vector<double>>()),
+              -1.1371, 1e-4);
+
+  // The Sz non-conserving elements vanish for this state
+  auto sz = runRdm({std::make_pair("accelerator", xacc::getAccelerator("qpp")),
+                    std::make_pair("sz-symmetry", true)});
+  EXPECT_LT(sz->nChildren(), full->nChildren());
+  EXPECT_NEAR(rdmEnergy(sz->getInformation("2-rdm").as<std::vector<double>>()),
+              -1.1371, 1e-4);
+
+  // Qubit-wise commuting groups of strings, sampled
+  auto qwc = runRdm(
+      {std::make_pair("accelerator",
+                      xacc::getAccelerator("qpp", {std::make_pair("shots", 8192)})),
+       std::make_pair("sz-symmetry", true),
+       std::make_pair("grouping", "qwc")});
+  EXPECT_LT(qwc->nChildren(), sz->nChildren());
+  EXPECT_NEAR(rdmEnergy(qwc->getInformation("2-rdm").as<std::vector<double>>()),
+              -1.1371, 5e-2);
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize();
   int ret = 0;
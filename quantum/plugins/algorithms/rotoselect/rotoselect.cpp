@@ -21,6 +21,7 @@
 #include <functional>
 #include <cassert>
 #include <cmath>
+#include <set>
 
 using namespace xacc;
 
@@ -199,87 +200,160 @@ void Rotoselect::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const
   // We can implement other criteria, such as convergence rate, etc.
   const int nbIterations = m_parameters.get<int>("iterations");
   int iterationCount = 0;
-  
-  // Optimization note:
-  // This evaluation function is the main runner of the training loop (7 evaluations per training step/iteration).
-  // We can run all evaluations per step in parallel. In order to do so, we need:
-  // (1) Clone the rotoselectKernel for each thread, i.e. each thread has an independent copy (because it will swap a gate for evaluation).
-  // (2) Clone the accelerator (simulator) which will run the circuit to evaluate the energy for this config.
-  // This will give us good speedup in the case that the simulator is not utilize all the CPU resources (i.e. if the simulator is not multithreaded by itself).
-  const auto evaluateFn = [&](size_t in_pauliGateIdx, PauliType in_pauliType, double in_angle) -> double {
-    // Find the gate:
+
+  const auto replaceGate = [&](size_t in_pauliGateIdx, PauliType in_pauliType, double in_angle) {
     auto iter = pauliGateIdxToCircuitIdx.find(in_pauliGateIdx);
     assert(iter != pauliGateIdxToCircuitIdx.end());
-
     const auto currentGate = rotoselectKernel->getInstruction(iter->second);
     assert(currentGate->nRequiredBits() == 1);
-    const auto qubitIdx = currentGate->bits()[0];
-    auto newGate = createPauliGate(qubitIdx, in_pauliType, in_angle);
-    rotoselectKernel->replaceInstruction(iter->second, newGate);
-    // Calculate the observable
-    auto kernels = observable->observe(rotoselectKernel);
-    double energy = 0.0;
+    rotoselectKernel->replaceInstruction(iter->second, createPauliGate(currentGate->bits()[0], in_pauliType, in_angle));
+    return currentGate;
+  };
 
-    {
-      std::vector<double> coefficients;
-      std::vector<std::string> kernelNames;
-      std::vector<std::shared_ptr<CompositeInstruction>> fsToExec;
+  // The energy in the angle of a rotation gate, the others fixed, is the sinusoid
+  // E(theta) = C + a cos(theta) + b sin(theta), determined by the probes at 0 and +/- pi/2 
+  // (theta = 0 being the same for the three Pauli types).
+  // Probes: (X, 0), then (type, +pi/2), (type, -pi/2) for X, Y, Z.
+  const std::vector<std::pair<PauliType, double>> probes { 
+    { PauliType::X, 0.0 },
+    { PauliType::X, M_PI_2 }, { PauliType::X, -M_PI_2 },
+    { PauliType::Y, M_PI_2 }, { PauliType::Y, -M_PI_2 },
+    { PauliType::Z, M_PI_2 }, { PauliType::Z, -M_PI_2 }
+  };
 
-      double identityCoeff = 0.0;
-      for (auto &f : kernels) 
+  // Energies of the probes of all the given gates, measured in one submission.
+  const auto evaluateProbes = [&](const std::vector<size_t>& in_pauliGateIdxs) {
+    std::vector<std::shared_ptr<CompositeInstruction>> fsToExec;
+    std::vector<double> coefficients;
+    std::vector<double> energies;
+    std::vector<size_t> nbMeasured;
+    for (const auto& pauliGateIdx : in_pauliGateIdxs)
+    {
+      for (const auto& [pauliType, angle] : probes)
       {
-        kernelNames.push_back(f->name());
-        std::complex<double> coeff = f->getCoefficient();
-        int nFunctionInstructions = 0;
-        if (f->getInstruction(0)->isComposite()) 
-        {
-          nFunctionInstructions = rotoselectKernel->nInstructions() + f->nInstructions() - 1;
-        } 
-        else 
+        auto currentGate = replaceGate(pauliGateIdx, pauliType, angle);
+        // observe() copies the instructions of the kernel
+        auto kernels = observable->observe(rotoselectKernel);
+        double identityCoeff = 0.0;
+        size_t count = 0;
+        for (auto &f : kernels) 
         {
-          nFunctionInstructions = f->nInstructions();
-        }
-
-        if (nFunctionInstructions > rotoselectKernel->nInstructions()) 
-        {
-          fsToExec.push_back(f);
-          coefficients.push_back(std::real(coeff));
-        } 
-        else 
-        {
-          identityCoeff += std::real(coeff);
+          const auto coeff = std::real(f->getCoefficient());
+          const int nFunctionInstructions = f->getInstruction(0)->isComposite() ? 
+            rotoselectKernel->nInstructions() + f->nInstructions() - 1 : 
+            f->nInstructions();
+          if (nFunctionInstructions > rotoselectKernel->nInstructions()) 
+          {
+            fsToExec.push_back(f);
+            coefficients.push_back(coeff);
+            ++count;
+          } 
+          else 
+          {
+            identityCoeff += coeff;
+          }
         }
+        energies.push_back(identityCoeff);
+        nbMeasured.push_back(count);
+        rotoselectKernel->replaceInstruction(pauliGateIdxToCircuitIdx[pauliGateIdx], currentGate);
       }
+    }
 
-      auto tmpBuffer = xacc::qalloc(buffer->size());
-      accelerator->execute(tmpBuffer, fsToExec);
-      auto buffers = tmpBuffer->getChildren();
-
-      energy = identityCoeff;
+    auto tmpBuffer = xacc::qalloc(buffer->size());
+    accelerator->execute(tmpBuffer, fsToExec);
+    auto buffers = tmpBuffer->getChildren();
+    size_t next = 0;
+    for (size_t k = 0; k < energies.size(); ++k)
+    {
       auto idBuffer = xacc::qalloc(buffer->size());
-      idBuffer->addExtraInfo("coefficient", identityCoeff);
+      idBuffer->addExtraInfo("coefficient", energies[k]);
       idBuffer->setName("I");
       idBuffer->addExtraInfo("kernel", "I");
       idBuffer->addExtraInfo("exp-val-z", 1.0);
       buffer->appendChild("I", idBuffer);
+      for (size_t i = 0; i < nbMeasured[k]; ++i, ++next) 
+      {
+        auto expval = buffers[next]->getExpectationValueZ();
+        energies[k] += expval * coefficients[next];
+        buffers[next]->addExtraInfo("coefficient", coefficients[next]);
+        buffers[next]->addExtraInfo("kernel", fsToExec[next]->name());
+        buffers[next]->addExtraInfo("exp-val-z", expval);
+        buffer->appendChild(fsToExec[next]->name(), buffers[next]);
+      }
+    }
+    return energies;
+  };
 
-      for (int i = 0; i < buffers.size(); i++) 
+  // Groups of rotation gates updated together: with "parallel-updates", consecutive
+  // gates whose light cones never reach the same observable term, i.e. the energy
+  // is a sum of functions of each of their angles. Otherwise one gate per group.
+  std::vector<std::vector<size_t>> groups;
+  if (m_parameters.get_or_default("parallel-updates", false))
+  {
+    // Observable terms (qubit supports) reached by each rotation gate, walking the
+    // circuit backward from each term.
+    std::unordered_map<size_t, size_t> circuitIdxToPauliGateIdx;
+    for (const auto& [pauliGateIdx, circuitIdx] : pauliGateIdxToCircuitIdx)
+    {
+      circuitIdxToPauliGateIdx.emplace(circuitIdx, pauliGateIdx);
+    }
+    std::vector<std::set<size_t>> reachedTerms(nbRotationGates);
+    size_t termIdx = 0;
+    for (auto& term : observable->getNonIdentitySubTerms())
+    {
+      std::set<size_t> support;
+      for (auto& f : term->observe(rotoselectKernel))
       {
-        auto expval = buffers[i]->getExpectationValueZ();
-        energy += expval * coefficients[i];
-        buffers[i]->addExtraInfo("coefficient", coefficients[i]);
-        buffers[i]->addExtraInfo("kernel", fsToExec[i]->name());
-        buffers[i]->addExtraInfo("exp-val-z", expval);
-        buffer->appendChild(fsToExec[i]->name(), buffers[i]);
-      } 
+        // The measurements give the support of the term
+        for (auto& inst : f->getInstructions())
+        {
+          if (inst->name() == "Measure")
+          {
+            support.insert(inst->bits()[0]);
+          }
+        }
+      }
+      for (int k = rotoselectKernel->nInstructions() - 1; k >= 0; --k)
+      {
+        auto inst = rotoselectKernel->getInstruction(k);
+        const auto bits = inst->bits();
+        if (std::none_of(bits.begin(), bits.end(), [&](size_t q) { return support.count(q); }))
+        {
+          continue;
+        }
+        support.insert(bits.begin(), bits.end());
+        auto iter = circuitIdxToPauliGateIdx.find(k);
+        if (iter != circuitIdxToPauliGateIdx.end())
+        {
+          reachedTerms[iter->second].insert(termIdx);
+        }
+      }
+      ++termIdx;
+    }
 
+    std::set<size_t> groupTerms;
+    for (size_t pauliGateIdx = 0; pauliGateIdx < nbRotationGates; ++pauliGateIdx)
+    {
+      const auto& terms = reachedTerms[pauliGateIdx];
+      const bool independent = std::none_of(terms.begin(), terms.end(), [&](size_t t) { return groupTerms.count(t); });
+      if (groups.empty() || !independent)
+      {
+        groups.emplace_back();
+        groupTerms.clear();
+      }
+      groups.back().push_back(pauliGateIdx);
+      groupTerms.insert(terms.begin(), terms.end());
     }
+    xacc::info("Rotoselect: " + std::to_string(nbRotationGates) + " rotation gates in " + std::to_string(groups.size()) + " independent groups.");
+  }
+  else
+  {
+    for (size_t pauliGateIdx = 0; pauliGateIdx < nbRotationGates; ++pauliGateIdx)
+    {
+      groups.push_back({ pauliGateIdx });
+    }
+  }
 
-    // Return back the original gate:
-    rotoselectKernel->replaceInstruction(iter->second, currentGate);
-    return energy;
-  };
-  
   // We keep track of all the min energy value achieved at each iteration.
   // This can be used to determine stopping conditions (in addition to just iteration loop count)
   std::vector<double> minEnergyVec;
@@ -288,84 +362,72 @@ void Rotoselect::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const
   double trainingResult = std::numeric_limits<double>::max();
   while (!stopCriteriaMet)
   {
-    for (size_t i = 0; i < nbLayers; ++i)
+    for (const auto& group : groups)
     {
-      for (size_t j = 0; j < nbQubits; ++j)
+      const auto energies = evaluateProbes(group);
+      // The energy reached by the whole update: the fitted energy of the current
+      // circuit plus the decrease brought by each gate.
+      double groupEnergy = 0.0;
+      for (size_t g = 0; g < group.size(); ++g)
       {
-        const auto pauliGateIdx =  i*nbQubits + j;
-        // We need 7 params to evaluate optimal params for this rotation gate
-        const double M_X_PI_2 = evaluateFn(pauliGateIdx, PauliType::X, M_PI_2);
-        const double M_X_M_PI_2 = evaluateFn(pauliGateIdx, PauliType::X, -M_PI_2);
-        const double M_Y_PI_2 = evaluateFn(pauliGateIdx, PauliType::Y, M_PI_2);
-        const double M_Y_M_PI_2 = evaluateFn(pauliGateIdx, PauliType::Y, -M_PI_2);
-        const double M_Z_PI_2 = evaluateFn(pauliGateIdx, PauliType::Z, M_PI_2);
-        const double M_Z_M_PI_2 = evaluateFn(pauliGateIdx, PauliType::Z, -M_PI_2);
-        const double M_ZERO = evaluateFn(pauliGateIdx, PauliType::X, 0.0);
-
-        // Compute the minimum for each Pauli type
-        const auto minCalc = [](double in_m0, double in_mPiOver2, double in_mMinusPiOver2){
-          double result = -M_PI_2 - atan2(2*in_m0 - in_mPiOver2 - in_mMinusPiOver2, in_mPiOver2 - in_mMinusPiOver2);
-          // Normalize to the [-pi,+pi] range
-          if (result < -M_PI)
-          {
-            result += 2*M_PI;
-          }  
-          assert((result >= -M_PI && result <= M_PI));
-          return result;
-        };
-
-        const double min_Theta_X = minCalc(M_ZERO, M_X_PI_2, M_X_M_PI_2);
-        const double min_Theta_Y = minCalc(M_ZERO, M_Y_PI_2, M_Y_M_PI_2);
-        const double min_Theta_Z = minCalc(M_ZERO, M_Z_PI_2, M_Z_M_PI_2);
-        
-        // Which Pauli give us the minimum?
-        const double min_X = evaluateFn(pauliGateIdx, PauliType::X, min_Theta_X);
-        const double min_Y = evaluateFn(pauliGateIdx, PauliType::Y, min_Theta_Y);
-        const double min_Z = evaluateFn(pauliGateIdx, PauliType::Z, min_Theta_Z);
-        double minEnergy = min_X;
+        const auto pauliGateIdx = group[g];
+        const double* probeEnergies = energies.data() + g * probes.size();
+        const double M_ZERO = probeEnergies[0];
+
+        // Closed-form minimum of C + a cos(theta) + b sin(theta):
+        // theta = atan2(-b, -a), E = C - sqrt(a^2 + b^2)
+        double minEnergy = std::numeric_limits<double>::max();
+        double currentEnergy = 0.0;
         PauliType minPauli = PauliType::X;
-        double minAngle = min_Theta_X;
-        if (min_Y < minEnergy)
-        {
-          minEnergy = min_Y;
-          minPauli = PauliType::Y;
-          minAngle = min_Theta_Y;
-        }
-
-        if (min_Z < minEnergy)
+        double minAngle = 0.0;
+        for (int type = 0; type < 3; ++type)
         {
-          minEnergy = min_Z;
-          minPauli = PauliType::Z;
-          minAngle = min_Theta_Z;
+          const double mPiOver2 = probeEnergies[1 + 2 * type];
+          const double mMinusPiOver2 = probeEnergies[2 + 2 * type];
+          const double c = 0.5 * (mPiOver2 + mMinusPiOver2);
+          const double a = M_ZERO - c;
+          const double b = 0.5 * (mPiOver2 - mMinusPiOver2);
+          const double energy = c - std::sqrt(a * a + b * b);
+          if (energy < minEnergy)
+          {
+            minEnergy = energy;
+            minPauli = static_cast<PauliType>(type);
+            minAngle = std::atan2(-b, -a);
+          }
+          if (static_cast<PauliType>(type) == pauliTypeVec[pauliGateIdx])
+          {
+            const double theta = thetaVec[pauliGateIdx];
+            currentEnergy = c + a * std::cos(theta) + b * std::sin(theta);
+          }
         }
+        groupEnergy += (g == 0 ? minEnergy : minEnergy - currentEnergy);
+        pauliTypeVec[pauliGateIdx] = minPauli;
+        thetaVec[pauliGateIdx] = minAngle;
 
         // Update the rotation gate:
         ++iterationCount;
-        auto iter = pauliGateIdxToCircuitIdx.find(pauliGateIdx);
-        assert(iter != pauliGateIdxToCircuitIdx.end());
-        const auto currentGate = rotoselectKernel->getInstruction(iter->second);
-        assert(currentGate->nRequiredBits() == 1);
-        const auto qubitIdx = currentGate->bits()[0];
-        auto newGate = createPauliGate(qubitIdx, minPauli, minAngle);
-        rotoselectKernel->replaceInstruction(iter->second, newGate);
+        auto currentGate = replaceGate(pauliGateIdx, minPauli, minAngle);
         
         if (xacc::verbose)
         {
           // Debug:
-          std::cout << "Replace " << currentGate->name() << "(" << currentGate->getParameter(0).as<double>() << ")" << " with " << newGate->name() << "(" << minAngle << ")" << " @ q[" << qubitIdx << "] \n";
+          std::cout << "Replace " << currentGate->name() << "(" << currentGate->getParameter(0).as<double>() << ")" << " with " << rotoselectKernel->getInstruction(pauliGateIdxToCircuitIdx[pauliGateIdx])->name() << "(" << minAngle << ")" << " @ q[" << currentGate->bits()[0] << "] \n";
           std::cout << "Min Energy: " << minEnergy << "\n";
-          std::cout << "New circuit: \n" <<  rotoselectKernel->toString();
         }
-        
-        minEnergyVec.emplace_back(minEnergy);
-        if (minEnergy < trainingResult)
-        {
-          // Update the new result
-          trainingResult = minEnergy;
-        }
-        // Training logging:
-        std::cout << "Rotoselect (iteration = " << iterationCount << "): Objective function value = " << trainingResult << "\n";
       }
+
+      if (xacc::verbose)
+      {
+        std::cout << "New circuit: \n" <<  rotoselectKernel->toString();
+      }
+      minEnergyVec.emplace_back(groupEnergy);
+      if (groupEnergy < trainingResult)
+      {
+        // Update the new result
+        trainingResult = groupEnergy;
+      }
+      // Training logging:
+      std::cout << "Rotoselect (iteration = " << iterationCount << "): Objective function value = " << trainingResult << "\n";
     }
 
     // For now, just use loop count as the stopping condition
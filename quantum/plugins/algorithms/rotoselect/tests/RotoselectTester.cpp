@@ -44,6 +44,28 @@ TEST(RotoselectTester, checkSimple)
   std::cout << "Optimal value: " << buffer->getInformation("opt-val").as<double>() << "\n";
 }
 
+TEST(RotoselectTester, checkParallelUpdates) 
+{
+  auto acc = xacc::getAccelerator("qpp");
+  auto buffer = xacc::qalloc(4);
+ 
+  // Z0 and Z3 are only reached by the gates on qubits {0, 1} and {2, 3}
+  std::shared_ptr<Observable> observable = std::make_shared<xacc::quantum::PauliOperator>();
+  observable->fromString("Z0 + Z3");
+
+  auto rotoselect = xacc::getService<Algorithm>("rotoselect");
+  EXPECT_TRUE(rotoselect->initialize({
+                                      std::make_pair("accelerator", acc),
+                                      std::make_pair("observable", observable),
+                                      std::make_pair("layers", 1),
+                                      std::make_pair("iterations", 4),
+                                      std::make_pair("parallel-updates", true),
+                                    }));
+  rotoselect->execute(buffer);
+  // Exact minimization of each single-qubit landscape
+  EXPECT_NEAR(buffer->getInformation("opt-val").as<double>(), -2.0, 1e-6);
+}
+
 int main(int argc, char **argv) 
 {
   xacc::Initialize(argc, argv);
@@ -18,6 +18,8 @@
 #include "Observable.hpp"
 #include "Algorithm.hpp"
 #include "PauliOperator.hpp"
+#include <fstream>
+#include <sstream>
 
 using namespace xacc;
 const std::string rucc = R"rucc(__qpu__ void f(qbit q, double t0) {
@@ -180,6 +182,156 @@ TEST(VQETester, checkChildBuffers) {
   }
 }
 
+TEST(VQETester, checkStreaming) {
+  std::shared_ptr<Observable> H_N_2 =
+      std::make_shared<xacc::quantum::PauliOperator>();
+  H_N_2->fromString("5.907 - 2.1433 X0X1 "
+                    "- 2.1433 Y0Y1"
+                    "+ .21829 Z0 - 6.125 Z1");
+
+  xacc::qasm(R"(
+        .compiler xasm
+        .circuit deuteron_ansatz_streaming
+        .parameters theta
+        .qbit q
+        X(q[0]);
+        Ry(q[1], theta);
+        CNOT(q[1],q[0]);
+    )");
+  auto ansatz = xacc::getCompiled("deuteron_ansatz_streaming");
+  auto accelerator =
+      xacc::getAccelerator("qpp", {std::make_pair("vqe-mode", true)});
+
+  for (bool keepChildren : {false, true}) {
+    // Two terms per chunk
+    auto vqe = xacc::getAlgorithm("vqe");
+    auto optimizer = xacc::getOptimizer("nlopt");
+    EXPECT_TRUE(vqe->initialize({{"ansatz", ansatz},
+                                 {"observable", H_N_2},
+                                 {"accelerator", accelerator},
+                                 {"optimizer", optimizer},
+                                 {"chunk-size", 2},
+                                 {"keep-children", keepChildren}}));
+    auto buffer = xacc::qalloc(2);
+    vqe->execute(buffer);
+    EXPECT_NEAR(-1.74886, (*buffer)["opt-val"].as<double>(), 1e-4);
+    const auto energies = (*buffer)["params-energy"].as<std::vector<double>>();
+    const auto variances =
+        (*buffer)["params-variance"].as<std::vector<double>>();
+    EXPECT_EQ(energies.size(), variances.size());
+    EXPECT_EQ(buffer->nChildren(),
+              keepChildren ? energies.size() * H_N_2->getSubTerms().size()
+                           : 0);
+
+    auto new_buffer = xacc::qalloc(2);
+    EXPECT_NEAR(
+        (*buffer)["opt-val"].as<double>(),
+        vqe->execute(new_buffer,
+                     (*buffer)["opt-params"].as<std::vector<double>>())[0],
+        1e-6);
+  }
+}
+
+TEST(VQETester, checkChildBufferRetention) {
+  std::shared_ptr<Observable> H_N_2 =
+      std::make_shared<xacc::quantum::PauliOperator>();
+  H_N_2->fromString("5.907 - 2.1433 X0X1 "
+                    "- 2.1433 Y0Y1"
+                    "+ .21829 Z0 - 6.125 Z1");
+
+  xacc::qasm(R"(
+        .compiler xasm
+        .circuit deuteron_ansatz_retention
+        .parameters theta
+        .qbit q
+        X(q[0]);
+        Ry(q[1], theta);
+        CNOT(q[1],q[0]);
+    )");
+  auto ansatz = xacc::getCompiled("deuteron_ansatz_retention");
+  auto accelerator =
+      xacc::getAccelerator("qpp", {std::make_pair("vqe-mode", true)});
+  const auto nbTerms = H_N_2->getSubTerms().size();
+
+  // Number of iterations kept by each policy
+  for (auto &[policy, nbKept] : std::vector<std::pair<std::string, int>>{
+           {"keep-last", 3}, {"keep-best", 1}, {"aggregate-only", 0}}) {
+    auto vqe = xacc::getAlgorithm("vqe");
+    auto optimizer = xacc::getOptimizer("nlopt");
+    EXPECT_TRUE(vqe->initialize({{"ansatz", ansatz},
+                                 {"observable", H_N_2},
+                                 {"accelerator", accelerator},
+                                 {"optimizer", optimizer},
+                                 {"child-buffer-retention", policy},
+                                 {"retain-iterations", 3}}));
+    auto buffer = xacc::qalloc(2);
+    vqe->execute(buffer);
+    EXPECT_NEAR(-1.74886, (*buffer)["opt-val"].as<double>(), 1e-4);
+    const auto energies = (*buffer)["params-energy"].as<std::vector<double>>();
+    EXPECT_GT(energies.size(), 3);
+    EXPECT_EQ(buffer->nChildren(), nbKept * nbTerms);
+
+    // The optimal children are still found for the aggregate results
+    const auto expVals = (*buffer)["opt-exp-vals"].as<std::vector<double>>();
+    const auto coeffs = (*buffer)["coefficients"].as<std::vector<double>>();
+    EXPECT_EQ(expVals.size(), nbTerms);
+    double energy = 0.0;
+    for (int i = 0; i < expVals.size(); i++) {
+      energy += expVals[i] * coeffs[i];
+    }
+    EXPECT_NEAR(energy, (*buffer)["opt-val"].as<double>(), 1e-6);
+  }
+}
+
+TEST(VQETester, checkProfile) {
+  std::shared_ptr<Observable> H_N_2 =
+      std::make_shared<xacc::quantum::PauliOperator>();
+  H_N_2->fromString("5.907 - 2.1433 X0X1 - 2.1433 Y0Y1 + .21829 Z0 - 6.125 Z1");
+  xacc::qasm(R"(
+        .compiler xasm
+        .circuit deuteron_ansatz_profile
+        .parameters theta
+        .qbit q
+        X(q[0]);
+        Ry(q[1], theta);
+        CNOT(q[1],q[0]);
+    )");
+  auto ansatz = xacc::getCompiled("deuteron_ansatz_profile");
+  auto accelerator =
+      xacc::getAccelerator("qpp", {std::make_pair("vqe-mode", true)});
+  auto vqe = xacc::getAlgorithm("vqe");
+  const std::string traceFile = "vqe_profile_trace.json";
+  EXPECT_TRUE(vqe->initialize({{"ansatz", ansatz},
+                               {"observable", H_N_2},
+                               {"accelerator", accelerator},
+                               {"optimizer", xacc::getOptimizer("nlopt")},
+                               {"profile-trace", traceFile}}));
+  auto buffer = xacc::qalloc(2);
+  vqe->execute(buffer);
+
+  // One entry per iteration and phase, the phases within the iteration
+  const auto nbIterations =
+      (*buffer)["params-energy"].as<std::vector<double>>().size();
+  const auto total = (*buffer)["profile-iteration-ms"].as<std::vector<double>>();
+  EXPECT_EQ(nbIterations, total.size());
+  double phases = 0.0;
+  for (const std::string phase :
+       {"bind", "observe", "execute", "post-process", "bookkeeping"}) {
+    const auto key = "profile-iteration-" + phase + "-ms";
+    ASSERT_TRUE(buffer->hasExtraInfoKey(key));
+    const auto durations = (*buffer)[key].as<std::vector<double>>();
+    EXPECT_EQ(nbIterations, durations.size());
+    phases += durations[0];
+  }
+  EXPECT_LE(phases, total[0] + 1e-3);
+
+  std::ifstream trace(traceFile);
+  std::stringstream contents;
+  contents << trace.rdbuf();
+  EXPECT_NE(contents.str().find("\"traceEvents\""), std::string::npos);
+  std::remove(traceFile.c_str());
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize(argc, argv);
   ::testing::InitGoogleTest(&argc, argv);
@@ -13,6 +13,8 @@
 #include "vqe.hpp"
 
 #include "Observable.hpp"
+#include "ObservableTransform.hpp"
+#include "PauliOperator.hpp"
 #include "Utils.hpp"
 #include "xacc.hpp"
 #include "xacc_service.hpp"
@@ -82,9 +84,98 @@ bool VQE::initialize(const HeterogeneousMap &parameters) {
     gradientStrategy = xacc::getService<AlgorithmGradientStrategy>("autodiff");
     gradientStrategy->initialize(parameters);
   }
+
+  retentionPolicy =
+      ChildBufferRetention::fromParameters(parameters, retainIterations);
+  // The last optimum of a (geometry) sweep is the best guess for the next
+  parameterStore = ParameterStore::fromParameters(
+      parameters, ParameterStore::Update::Latest);
+  checkpoint = Checkpoint::fromParameters(parameters);
+  profiler.initialize(parameters);
+
+  // Streaming evaluation of large observables, in chunks of Pauli terms
+  chunkSize = 0;
+  keepChildren = false;
+  streamedTerms.clear();
+  streamedIdentityCoeff = 0.0;
+  if (parameters.keyExists<int>("chunk-size")) {
+    chunkSize = parameters.get<int>("chunk-size");
+    if (chunkSize < 1) {
+      xacc::error("VQE Algorithm Error - 'chunk-size' must be positive.");
+    }
+    if (parameters.keyExists<bool>("keep-children")) {
+      keepChildren = parameters.get<bool>("keep-children");
+    }
+    auto pauli = dynamic_cast<quantum::PauliOperator *>(observable);
+    std::shared_ptr<Observable> transformed;
+    if (!pauli && observable->name() == "fermion") {
+      transformed = xacc::getService<ObservableTransform>("jw")->transform(
+          xacc::as_shared_ptr(observable));
+      pauli = dynamic_cast<quantum::PauliOperator *>(transformed.get());
+    }
+    if (!pauli) {
+      xacc::error("VQE Algorithm Error - 'chunk-size' requires a Pauli or "
+                  "fermion observable.");
+    }
+    for (auto &kv : pauli->getTerms()) {
+      if (kv.second.isIdentity()) {
+        streamedIdentityCoeff += std::real(kv.second.coeff());
+      } else {
+        streamedTerms.emplace_back(kv.second.ops(), kv.second.coeff());
+      }
+    }
+  }
   return true;
 }
 
+std::pair<double, double>
+VQE::evaluateInChunks(const std::shared_ptr<AcceleratorBuffer> buffer,
+                      std::shared_ptr<CompositeInstruction> evaled,
+                      const std::vector<double> &x,
+                      const HeterogeneousMap &postProcessOptions,
+                      ChildBufferRetention::Children &out_children) const {
+  double energy = streamedIdentityCoeff, variance = 0.0;
+  if (keepChildren) {
+    auto idBuffer = xacc::qalloc(buffer->size());
+    idBuffer->addExtraInfo("coefficient", streamedIdentityCoeff);
+    idBuffer->setName("I");
+    idBuffer->addExtraInfo("kernel", "I");
+    idBuffer->addExtraInfo("parameters", x);
+    idBuffer->addExtraInfo("exp-val-z", 1.0);
+    out_children.emplace_back(idBuffer);
+  }
+  for (size_t beginIdx = 0; beginIdx < streamedTerms.size();
+       beginIdx += chunkSize) {
+    // Only this chunk's kernels and child buffers are alive at a time
+    const size_t endIdx =
+        std::min(beginIdx + chunkSize, streamedTerms.size());
+    auto chunk = std::make_shared<quantum::PauliOperator>();
+    for (size_t i = beginIdx; i < endIdx; i++) {
+      chunk->operator+=(quantum::PauliOperator(streamedTerms[i].first,
+                                               streamedTerms[i].second));
+    }
+    auto chunkBuffer = xacc::qalloc(buffer->size());
+    accelerator->computeExpectations(chunkBuffer, evaled, chunk);
+    energy += chunk->postProcess(chunkBuffer,
+                                 Observable::PostProcessingTask::EXP_VAL_CALC,
+                                 postProcessOptions);
+    variance += chunk->postProcess(
+        chunkBuffer, Observable::PostProcessingTask::VARIANCE_CALC,
+        postProcessOptions);
+
+    for (auto &[k, v] : chunkBuffer->getInformation()) {
+      buffer->addExtraInfo(k, v);
+    }
+    if (keepChildren) {
+      for (auto &childBuffer : chunkBuffer->getChildren()) {
+        childBuffer->addExtraInfo("parameters", x);
+        out_children.emplace_back(childBuffer);
+      }
+    }
+  }
+  return {energy, variance};
+}
+
 const std::vector<std::string> VQE::requiredParameters() const {
   return {"observable", "optimizer", "accelerator", "ansatz"};
 }
@@ -97,13 +188,70 @@ void VQE::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
   }
 
   // auto kernels = observable->observe(xacc::as_shared_ptr(kernel));
-  // Cache of energy values during iterations.
-  std::vector<double> energies;
+  // Cache of energy (and variance) values during iterations.
+  std::vector<double> energies, variances;
+  // Child buffers of the iterations, kept according to the retention policy
+  ChildBufferRetention retention(retentionPolicy, retainIterations);
+  // Null unless profiling
+  const auto spans = profiler.recorder();
+
+  // Let the Observable know how to interpret the measured bit strings.
+  const HeterogeneousMap postProcessOptions{std::make_pair(
+      "bit-order",
+      std::string(accelerator->getBitOrder() == Accelerator::BitOrder::MSB
+                      ? "MSB"
+                      : "LSB"))};
 
   // Here we just need to make a lambda kernel
   // to optimize that makes calls to the targeted QPU.
-  OptFunction f(
-      [&, this](const std::vector<double> &x, std::vector<double> &dx) {
+  // The observable terms can be given already evaluated at x, as the child
+  // buffers of precomputed (batched evaluation).
+  const auto evaluateAt =
+      [&, this](const std::vector<double> &x, std::vector<double> &dx,
+                std::shared_ptr<AcceleratorBuffer> precomputed) {
+        // An empty dx asks for the value only (e.g. a line-search probe):
+        // the gradient circuits are not run then.
+        const bool withGradient = gradientStrategy && !dx.empty();
+        ScopeTimer iteration("iteration", spans.get());
+        iteration.phase("bind");
+        if (chunkSize > 0) {
+          auto tmp_x = x;
+          std::reverse(tmp_x.begin(), tmp_x.end());
+          auto evaled = kernel->operator()(tmp_x);
+          ChildBufferRetention::Children children;
+          // Observe, execute and post-process, chunk by chunk
+          iteration.phase("execute");
+          const auto [energy, variance] = evaluateInChunks(
+              buffer, evaled, x, postProcessOptions, children);
+          iteration.phase("bookkeeping");
+          retention.addIteration(buffer, x, energy, std::move(children));
+
+          if (withGradient) {
+            iteration.phase("gradient");
+            auto gradFsToExec = gradientStrategy->getGradientExecutions(
+                xacc::as_shared_ptr(kernel), x);
+            auto gradBuffer = xacc::qalloc(buffer->size());
+            accelerator->executeWithPrefixSharing(gradBuffer, gradFsToExec);
+            if (gradientStrategy->isNumerical()) {
+              gradientStrategy->setFunctionValue(energy -
+                                                 streamedIdentityCoeff);
+            }
+            gradientStrategy->compute(dx, gradBuffer->getChildren());
+          }
+
+          if (xacc::loggingEnabled(1)) {
+            std::stringstream ss;
+            ss << "E(" << (!x.empty() ? std::to_string(x[0]) : "");
+            for (int i = 1; i < x.size(); i++)
+              ss << "," << x[i];
+            ss << ") = " << std::setprecision(12) << energy;
+            xacc::info(ss.str());
+          }
+          energies.emplace_back(energy);
+          variances.emplace_back(variance);
+          return energy;
+        }
+
         std::vector<double> coefficients;
         std::vector<std::string> kernelNames;
         std::vector<std::shared_ptr<CompositeInstruction>> fsToExec;
@@ -113,6 +261,7 @@ void VQE::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
         std::reverse(tmp_x.begin(), tmp_x.end());
         auto evaled = kernel->operator()(tmp_x);
         // observe
+        iteration.phase("observe");
         auto kernels = observable->observe(evaled);
 
         double identityCoeff = 0.0;
@@ -140,26 +289,44 @@ void VQE::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
 
         // Retrieve instructions for gradient, if a pointer of type
         // AlgorithmGradientStrategy is given
-        if (gradientStrategy) {
-
-          auto gradFsToExec = gradientStrategy->getGradientExecutions(
+        std::vector<std::shared_ptr<CompositeInstruction>> gradFsToExec;
+        if (withGradient) {
+          iteration.phase("gradient");
+          gradFsToExec = gradientStrategy->getGradientExecutions(
               xacc::as_shared_ptr(kernel), x);
-          // Add gradient instructions to be sent to the qpu
           nInstructionsEnergy = fsToExec.size();
           nInstructionsGradient = gradFsToExec.size();
-          for (auto inst : gradFsToExec) {
-            fsToExec.push_back(inst);
-          }
-          xacc::info("Number of instructions for energy calculation: " +
-                     std::to_string(nInstructionsEnergy));
-          xacc::info("Number of instructions for gradient calculation: " +
-                     std::to_string(nInstructionsGradient));
+          XACC_LOG_INFO("Number of instructions for energy calculation: " +
+                        std::to_string(nInstructionsEnergy));
+          XACC_LOG_INFO("Number of instructions for gradient calculation: " +
+                        std::to_string(nInstructionsGradient));
         }
 
-        auto tmpBuffer = xacc::qalloc(buffer->size());
-        accelerator->execute(tmpBuffer, fsToExec);
+        // Let the accelerator evaluate all the observable terms on the
+        // ansatz state (simulators only need to prepare it once).
+        iteration.phase("execute");
+        auto tmpBuffer = precomputed;
+        if (!tmpBuffer) {
+          tmpBuffer = xacc::qalloc(buffer->size());
+          accelerator->computeExpectations(tmpBuffer, evaled,
+                                           xacc::as_shared_ptr(observable));
+        }
+        nInstructionsEnergy = tmpBuffer->nChildren();
+        if (!gradFsToExec.empty()) {
+          // Gradient circuits only diverge from the ansatz at the
+          // shifted gate, let simulators reuse the shared prefix state.
+          auto gradBuffer = xacc::qalloc(buffer->size());
+          accelerator->executeWithPrefixSharing(gradBuffer, gradFsToExec);
+          for (auto &child : gradBuffer->getChildren()) {
+            tmpBuffer->appendChild(child->name(), child);
+          }
+          for (auto &[k, v] : gradBuffer->getInformation()) {
+            buffer->addExtraInfo(k, v);
+          }
+        }
         auto buffers = tmpBuffer->getChildren();
 
+        iteration.phase("bookkeeping");
         // Tag any gradient buffers;
         for (int i = nInstructionsEnergy; i < buffers.size(); i++) {
           buffers[i]->addExtraInfo("is-gradient-calc", true);
@@ -179,7 +346,6 @@ void VQE::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
         idBuffer->addExtraInfo("exp-val-z", 1.0);
         if (accelerator->name() == "ro-error")
           idBuffer->addExtraInfo("ro-fixed-exp-val-z", 1.0);
-        buffer->appendChild("I", idBuffer);
 
         // Add information about the variational parameters to the child
         // buffers.
@@ -190,9 +356,11 @@ void VQE::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
         }
 
         // Special key to indicate that the buffer was processed by a
-        // HPC virtualization decorator.
+        // HPC virtualization decorator. Only used if the decorator didn't
+        // return the child buffers (can't post-process them then).
         const std::string aggregate_key =
             "__internal__decorator_aggregate_vqe__";
+        iteration.phase("post-process");
         const double energy = [&]() {
           // Compute the Energy. We can do this manually,
           // or we may have a case where a accelerator decorator
@@ -200,7 +368,8 @@ void VQE::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
           // on the buffer extra info.
           if (std::dynamic_pointer_cast<xacc::AcceleratorDecorator>(
                   xacc::as_shared_ptr(accelerator)) &&
-              buffer->hasExtraInfoKey(aggregate_key)) {
+              buffer->hasExtraInfoKey(aggregate_key) &&
+              nInstructionsEnergy == 0) {
             // Handles VQE that was executed on a virtualized Accelerator,
             // i.e. the energy has been aggregated by the Decorator.
             double resultEnergy = identityCoeff;
@@ -212,7 +381,9 @@ void VQE::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
             // Normal VQE: post-proces the result with the Observable.
             // This will also populate meta-data to the child-buffer of
             // the main buffer.
-            return observable->postProcess(tmpBuffer);
+            return observable->postProcess(
+          tmpBuffer, Observable::PostProcessingTask::EXP_VAL_CALC,
+          postProcessOptions);
           }
         }();
 
@@ -221,7 +392,8 @@ void VQE::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
         const double variance = [&]() {
           if (std::dynamic_pointer_cast<xacc::AcceleratorDecorator>(
                   xacc::as_shared_ptr(accelerator)) &&
-              buffer->hasExtraInfoKey(aggregate_key)) {
+              buffer->hasExtraInfoKey(aggregate_key) &&
+              nInstructionsEnergy == 0) {
             // HPC decorator doesn't support variance...
             return 0.0;
 
@@ -229,11 +401,13 @@ void VQE::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
             // This will also populate information about variance to each child
             // buffer.
             return observable->postProcess(
-                tmpBuffer, Observable::PostProcessingTask::VARIANCE_CALC);
+                tmpBuffer, Observable::PostProcessingTask::VARIANCE_CALC,
+                postProcessOptions);
           }
         }();
 
-        if (gradientStrategy) {
+        if (withGradient) {
+          iteration.phase("gradient");
           // gradient-based optimization
           // If gradientStrategy is numerical, pass the energy
           // We subtract the identityCoeff from the energy
@@ -242,6 +416,9 @@ void VQE::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
           if (gradientStrategy->isNumerical()) {
             gradientStrategy->setFunctionValue(energy - identityCoeff);
           }
+          gradientStrategy->setBaseResults(
+              std::vector<std::shared_ptr<AcceleratorBuffer>>(
+                  buffers.begin(), buffers.begin() + nInstructionsEnergy));
 
           // update gradient vector
           gradientStrategy->compute(
@@ -249,30 +426,101 @@ void VQE::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
                       buffers.begin() + nInstructionsEnergy, buffers.end()));
         }
 
-        // Append the child buffers from the temp. buffer
-        // to the main buffer.
+        // Hand the child buffers from the temp. buffer (after the identity
+        // one) to the retention policy for the main buffer.
         // These child buffers have extra-information populate in the above
         // post-process steps.
-        for (auto &b : buffers) {
-          buffer->appendChild(b->name(), b);
+        iteration.phase("bookkeeping");
+        buffers.insert(buffers.begin(), idBuffer);
+        retention.addIteration(buffer, x, energy, std::move(buffers));
+        if (xacc::loggingEnabled(1)) {
+          std::stringstream ss;
+          ss << "E(" << (!x.empty() ? std::to_string(x[0]) : "");
+          for (int i = 1; i < x.size(); i++)
+            ss << "," << x[i];
+          ss << ") = " << std::setprecision(12) << energy;
+          xacc::info(ss.str());
         }
-        std::stringstream ss;
-        ss << "E(" << (!x.empty() ? std::to_string(x[0]) : "");
-        for (int i = 1; i < x.size(); i++)
-          ss << "," << x[i];
-        ss << ") = " << std::setprecision(12) << energy;
-        xacc::info(ss.str());
         // Saves the energy value.
         energies.emplace_back(energy);
+        variances.emplace_back(variance);
+        return energy;
+      };
+  const auto evaluate = [&](const std::vector<double> &x,
+                            std::vector<double> &dx) {
+    return evaluateAt(x, dx, nullptr);
+  };
+  // Shot-adaptive optimizers set the shots of each evaluation, the variance
+  // is that of the energy for a single shot of each term.
+  OptFunction f(
+      evaluate,
+      [&](const std::vector<double> &x, int shots, double &variance) {
+        accelerator->updateConfiguration({std::make_pair("shots", shots)});
+        std::vector<double> dx;
+        const double energy = evaluate(x, dx);
+        variance = variances.back();
         return energy;
       },
       kernel->nVariables());
+  // Population-based optimizers evaluate their candidates as one batch of
+  // all their observed kernels (values only). Not with term chunks or
+  // decorators (which may aggregate the energy over an execution).
+  if (chunkSize == 0 &&
+      !std::dynamic_pointer_cast<xacc::AcceleratorDecorator>(
+          xacc::as_shared_ptr(accelerator))) {
+    f.setBatchFunction([&](const std::vector<std::vector<double>> &xs) {
+      // The iterations of the batch only post-process
+      ScopeTimer batch("batch", spans.get());
+      batch.phase("bind");
+      std::vector<std::shared_ptr<AcceleratorBuffer>> tmpBuffers;
+      std::vector<std::shared_ptr<CompositeInstruction>> evaledKernels;
+      for (auto &x : xs) {
+        auto tmp_x = x;
+        std::reverse(tmp_x.begin(), tmp_x.end());
+        evaledKernels.emplace_back(kernel->operator()(tmp_x));
+        tmpBuffers.emplace_back(xacc::qalloc(buffer->size()));
+      }
+      batch.phase("execute");
+      accelerator->computeExpectations(tmpBuffers, evaledKernels,
+                                       xacc::as_shared_ptr(observable));
+      batch.phase("iterations");
+      std::vector<double> values;
+      std::vector<double> dx;
+      for (int i = 0; i < xs.size(); i++) {
+        values.push_back(evaluateAt(xs[i], dx, tmpBuffers[i]));
+      }
+      return values;
+    });
+  }
+
+  std::string fingerprint;
+  if (parameterStore) {
+    fingerprint = parameterStore->fingerprint(problemFingerprint());
+    parameterStore->warmStart(fingerprint, kernel->nVariables(), *optimizer);
+  }
 
-  auto result = optimizer->optimize(f);
+  // Replayed evaluations only restore the energy history.
+  CheckpointedOptFunction checkpointed(
+      f, checkpoint, [&](const Checkpoint::Evaluation &in_evaluation) {
+        energies.emplace_back(in_evaluation.value);
+        variances.emplace_back(in_evaluation.variance);
+      });
+  if (checkpoint) {
+    checkpoint->restore(problemFingerprint() + "#" +
+                        std::to_string(kernel->nVariables()));
+  }
+  auto result = checkpoint ? optimizer->optimize(checkpointed)
+                           : optimizer->optimize(f);
+  if (checkpoint) {
+    checkpoint->save();
+  }
+  retention.finalize(buffer);
+  if (parameterStore) {
+    parameterStore->record(fingerprint, result.second, result.first);
+  }
 
   // Get the children at the opt-params
-  auto children_at_final_parameters =
-      buffer->getChildren("parameters", result.second);
+  auto children_at_final_parameters = retention.getChildren(result.second);
   std::vector<double> opt_exp_vals, children_coeffs;
   std::vector<std::string> children_names;
   for (auto &child : children_at_final_parameters) {
@@ -294,12 +542,56 @@ void VQE::execute(const std::shared_ptr<AcceleratorBuffer> buffer) const {
   buffer->addExtraInfo("opt-params", ExtraInfo(result.second));
   // Adds energies so that users can examine the convergence.
   buffer->addExtraInfo("params-energy", ExtraInfo(energies));
+  buffer->addExtraInfo("params-variance", ExtraInfo(variances));
+  profiler.record(spans.get(), {"iteration", "batch"}, *buffer);
   return;
 }
 
+std::string VQE::problemFingerprint() const {
+  std::stringstream ss;
+  ss << "vqe|" << kernel->name() << "|";
+  auto pauli = dynamic_cast<quantum::PauliOperator *>(observable);
+  if (pauli) {
+    // The term names are their Pauli strings
+    for (auto &[termName, term] : pauli->getTerms()) {
+      if (!term.isIdentity()) {
+        ss << termName << ",";
+      }
+    }
+  } else {
+    ss << observable->name() << "|" << observable->nBits() << "|"
+       << observable->getNonIdentitySubTerms().size();
+  }
+  return ss.str();
+}
+
 std::vector<double>
 VQE::execute(const std::shared_ptr<AcceleratorBuffer> buffer,
              const std::vector<double> &x) {
+  if (chunkSize > 0) {
+    auto tmp_x = x;
+    std::reverse(tmp_x.begin(), tmp_x.end());
+    auto evaled = xacc::as_shared_ptr(kernel)->operator()(tmp_x);
+    const HeterogeneousMap postProcessOptions{std::make_pair(
+        "bit-order",
+        std::string(accelerator->getBitOrder() == Accelerator::BitOrder::MSB
+                        ? "MSB"
+                        : "LSB"))};
+    ChildBufferRetention::Children children;
+    const double energy =
+        evaluateInChunks(buffer, evaled, x, postProcessOptions, children)
+            .first;
+    for (auto &child : children) {
+      buffer->appendChild(child->name(), child);
+    }
+    std::stringstream ss;
+    ss << "E(" << (!x.empty() ? std::to_string(x[0]) : "");
+    for (int i = 1; i < x.size(); i++)
+      ss << "," << x[i];
+    ss << ") = " << std::setprecision(12) << energy;
+    xacc::info(ss.str());
+    return {energy};
+  }
 
   std::vector<double> coefficients;
   std::vector<std::string> kernelNames;
@@ -330,7 +622,8 @@ VQE::execute(const std::shared_ptr<AcceleratorBuffer> buffer,
   }
 
   auto tmpBuffer = xacc::qalloc(buffer->size());
-  accelerator->execute(tmpBuffer, fsToExec);
+  accelerator->computeExpectations(tmpBuffer, evaled,
+                                   xacc::as_shared_ptr(observable));
   auto buffers = tmpBuffer->getChildren();
   for (auto &b : buffers) {
     b->addExtraInfo("parameters", x);
@@ -351,6 +644,11 @@ VQE::execute(const std::shared_ptr<AcceleratorBuffer> buffer,
     idBuffer->addExtraInfo("ro-fixed-exp-val-z", 1.0);
   buffer->appendChild("I", idBuffer);
   const std::string aggregate_key = "__internal__decorator_aggregate_vqe__";
+  const HeterogeneousMap postProcessOptions{std::make_pair(
+      "bit-order",
+      std::string(accelerator->getBitOrder() == Accelerator::BitOrder::MSB
+                      ? "MSB"
+                      : "LSB"))};
   const double energy = [&]() {
     // Compute the Energy. We can do this manually,
     // or we may have a case where a accelerator decorator
@@ -358,7 +656,7 @@ VQE::execute(const std::shared_ptr<AcceleratorBuffer> buffer,
     // on the buffer extra info.
     if (std::dynamic_pointer_cast<xacc::AcceleratorDecorator>(
             xacc::as_shared_ptr(accelerator)) &&
-        buffer->hasExtraInfoKey(aggregate_key)) {
+        buffer->hasExtraInfoKey(aggregate_key) && buffers.empty()) {
       // Handles VQE that was executed on a virtualized Accelerator,
       // i.e. the energy has been aggregated by the Decorator.
       double resultEnergy = identityCoeff;
@@ -370,7 +668,9 @@ VQE::execute(const std::shared_ptr<AcceleratorBuffer> buffer,
       // Normal VQE: post-proces the result with the Observable.
       // This will also populate meta-data to the child-buffer of
       // the main buffer.
-      return observable->postProcess(tmpBuffer);
+      return observable->postProcess(
+          tmpBuffer, Observable::PostProcessingTask::EXP_VAL_CALC,
+          postProcessOptions);
     }
   }();
 
@@ -379,7 +679,7 @@ VQE::execute(const std::shared_ptr<AcceleratorBuffer> buffer,
   const double variance = [&]() {
     if (std::dynamic_pointer_cast<xacc::AcceleratorDecorator>(
             xacc::as_shared_ptr(accelerator)) &&
-        buffer->hasExtraInfoKey(aggregate_key)) {
+        buffer->hasExtraInfoKey(aggregate_key) && buffers.empty()) {
       // HPC decorator doesn't support variance...
       return 0.0;
 
@@ -387,7 +687,8 @@ VQE::execute(const std::shared_ptr<AcceleratorBuffer> buffer,
       // This will also populate information about variance to each child
       // buffer.
       return observable->postProcess(
-          tmpBuffer, Observable::PostProcessingTask::VARIANCE_CALC);
+          tmpBuffer, Observable::PostProcessingTask::VARIANCE_CALC,
+          postProcessOptions);
     }
   }();
   // Append the child buffers from the temp. buffer
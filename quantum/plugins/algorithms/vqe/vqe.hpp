@@ -15,6 +15,12 @@
 
 #include "Algorithm.hpp"
 #include "AlgorithmGradientStrategy.hpp"
+#include "AlgorithmProfiler.hpp"
+#include "Checkpoint.hpp"
+#include "ChildBufferRetention.hpp"
+#include "ParameterStore.hpp"
+#include <complex>
+#include <map>
 
 namespace xacc {
 namespace algorithm {
@@ -29,6 +35,39 @@ protected:
 
   HeterogeneousMap parameters;
 
+  // Which iterations' child buffers are kept ("child-buffer-retention").
+  ChildBufferRetention::Policy retentionPolicy =
+      ChildBufferRetention::Policy::All;
+  int retainIterations = 1;
+
+  // Streaming evaluation ("chunk-size" > 0): the Pauli terms are observed,
+  // executed and post-processed chunkSize at a time, and the child buffers
+  // are only returned in out_children if keepChildren ("keep-children").
+  int chunkSize = 0;
+  bool keepChildren = false;
+  std::vector<std::pair<std::map<int, std::string>, std::complex<double>>>
+      streamedTerms;
+  double streamedIdentityCoeff = 0.0;
+
+  // "parameter-store": warm start from (and record) the optimum of the
+  // same problem, e.g. the previous bond length of a sweep. The default key
+  // is the ansatz and the structure (not the coefficients) of the observable.
+  std::shared_ptr<ParameterStore> parameterStore;
+  // "checkpoint": the objective evaluations are logged, and replayed on a
+  // restart (e.g. by ADAPT, which shares its checkpoint).
+  std::shared_ptr<Checkpoint> checkpoint;
+  // "profile": per-iteration bind / observe / execute / post-process /
+  // gradient / bookkeeping durations
+  AlgorithmProfiler profiler;
+  std::string problemFingerprint() const;
+  // (energy, variance) at the ansatz state evaled, from the chunks.
+  std::pair<double, double>
+  evaluateInChunks(const std::shared_ptr<AcceleratorBuffer> buffer,
+                   std::shared_ptr<CompositeInstruction> evaled,
+                   const std::vector<double> &x,
+                   const HeterogeneousMap &postProcessOptions,
+                   ChildBufferRetention::Children &out_children) const;
+
 public:
   bool initialize(const HeterogeneousMap &parameters) override;
   const std::vector<std::string> requiredParameters() const override;
@@ -46,15 +46,22 @@ public:
   void visit(fSim &in_fsimGate) override;
   void visit(IfStmt &ifStmt) override {}
   void visit(Measure &measure) override;
-  pybind11::object &getProgram() { return m_aqasmProgram; }
+  // The AQASM program of the visited gates, built by a single Python call.
+  pybind11::object &getProgram();
 
 private:
-  pybind11::object createProgram();
+  // AQASM gate name, parameters, qubits, modifier ("dag" or "ctrl") and
+  // matrix (CustomGate)
+  using GateOp = std::tuple<std::string, std::vector<double>,
+                            std::vector<size_t>, std::string, pybind11::object>;
+  void addGate(const std::string &in_aqasmName,
+               const std::vector<double> &in_params,
+               const std::vector<size_t> &in_bits,
+               const std::string &in_modifier = "",
+               pybind11::object in_matrix = pybind11::none());
   size_t m_nbQubit;
-  pybind11::module m_aqasm;
+  std::vector<GateOp> m_ops;
   pybind11::object m_aqasmProgram;
-  pybind11::object m_qreg;
-  pybind11::object m_creg;
 };
 
 class QlmAccelerator : public Accelerator {
@@ -83,6 +90,17 @@ public:
   virtual void execute(std::shared_ptr<AcceleratorBuffer> buffer,
                        const std::vector<std::shared_ptr<CompositeInstruction>>
                            compositeInstructions) override;
+  // Jobs are submitted before returning when using remote (QLMaaS) access.
+  // Otherwise, or when results are needed, the Python work runs when the
+  // returned future is waited on.
+  virtual std::future<void>
+  executeAsync(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::shared_ptr<CompositeInstruction>
+                   compositeInstruction) override;
+  virtual std::future<void>
+  executeAsync(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::vector<std::shared_ptr<CompositeInstruction>>
+                   compositeInstructions) override;
   virtual void apply(std::shared_ptr<AcceleratorBuffer> buffer,
                      std::shared_ptr<Instruction> inst) override{};
 
@@ -96,6 +114,12 @@ private:
   void persistResultToBuffer(std::shared_ptr<AcceleratorBuffer> buffer,
                              pybind11::object &result,
                              pybind11::object &job) const;
+  void persistBatchResultToBuffer(
+      std::shared_ptr<AcceleratorBuffer> buffer,
+      const std::vector<std::shared_ptr<CompositeInstruction>>
+          &compositeInstructions,
+      pybind11::object &batchResult,
+      std::vector<pybind11::object> &jobs) const;
 
 private:
   int m_shots;
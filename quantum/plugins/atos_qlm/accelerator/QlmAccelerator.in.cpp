@@ -38,14 +38,6 @@ void exportAqasm(pybind11::object &in_program, const std::string &in_fileName) {
   in_program.attr("export")(in_fileName);
 }
 
-pybind11::object qlm_qalloc(pybind11::object &in_program, size_t in_nbQubits) {
-  return in_program.attr("qalloc")(in_nbQubits);
-}
-
-pybind11::object qlm_calloc(pybind11::object &in_program, size_t in_nbBits) {
-  return in_program.attr("calloc")(in_nbBits);
-}
-
 pybind11::object to_circ(pybind11::object &in_program) {
   return in_program.attr("to_circ")();
 }
@@ -80,39 +72,42 @@ int getJobType(JobType in_type) {
   }
 }
 
-pybind11::object getAqasmGate(const std::string &in_xaccGateName) {
-  static std::unordered_map<std::string, pybind11::object> gateNameToGate;
+// Python side of the circuit translation and of the result conversion: a
+// circuit is built by a single call from its list of gates, and the samples
+// of a result come back as arrays, rather than a pybind11 call per gate or
+// per sample.
+const char *QLM_HELPERS_SRC = R"#(
+import numpy as np
+import qat.lang.AQASM as aqasm
+
+def build_program(nb_qubits, ops):
+    prog = aqasm.Program()
+    qreg = prog.qalloc(nb_qubits)
+    prog.calloc(nb_qubits)
+    for name, params, qubits, modifier, matrix in ops:
+        gate = getattr(aqasm, name) if matrix is None else aqasm.CustomGate(matrix)
+        if params:
+            gate = gate(*params)
+        if modifier == "dag":
+            gate = gate.dag()
+        elif modifier == "ctrl":
+            gate = gate.ctrl()
+        prog.apply(gate, *[qreg[q] for q in qubits])
+    return prog
+
+def samples(result):
+    states = [str(sample.state)[1:-1] for sample in result]
+    probs = np.array([sample.probability for sample in result], dtype=float)
+    return states, probs
+)#";
+
+pybind11::object qlmHelper(const std::string &in_name) {
   // Lazy construct (making sure the Accelerator has been initialized)
-  // List of AQASM native gates:
-  // Constant gates: X, Y, Z, H, S, T, CNOT, CCNOT, CSIGN, SWAP, SQRTSWAP, ISWAP
-  // Parametrized gates: RX, RY, RZ, PH (phase shift)
-  if (gateNameToGate.empty()) {
-    auto aqasm = pybind11::module::import("qat.lang.AQASM");
-    gateNameToGate.emplace("X", aqasm.attr("X"));
-    gateNameToGate.emplace("Y", aqasm.attr("Y"));
-    gateNameToGate.emplace("Z", aqasm.attr("Z"));
-    gateNameToGate.emplace("Rx", aqasm.attr("RX"));
-    gateNameToGate.emplace("Ry", aqasm.attr("RY"));
-    gateNameToGate.emplace("Rz", aqasm.attr("RZ"));
-    gateNameToGate.emplace("H", aqasm.attr("H"));
-    gateNameToGate.emplace("T", aqasm.attr("T"));
-    gateNameToGate.emplace("S", aqasm.attr("S"));
-    gateNameToGate.emplace("PH", aqasm.attr("PH"));
-    // Two-qubit gates:
-    gateNameToGate.emplace("CNOT", aqasm.attr("CNOT"));
-    gateNameToGate.emplace("Swap", aqasm.attr("SWAP"));
-    gateNameToGate.emplace("CZ", aqasm.attr("CSIGN"));
-    gateNameToGate.emplace("iSwap", aqasm.attr("ISWAP"));
-    // Fall-back
-    gateNameToGate.emplace("CustomGate", aqasm.attr("CustomGate"));
-  }
-
-  const auto gateObjIter = gateNameToGate.find(in_xaccGateName);
-  if (gateObjIter != gateNameToGate.end()) {
-    return gateObjIter->second;
-  } else {
-    return gateNameToGate["CustomGate"];
+  static pybind11::dict helpers;
+  if (!helpers.contains("build_program")) {
+    pybind11::exec(QLM_HELPERS_SRC, helpers);
   }
+  return helpers[in_name.c_str()];
 }
 
 // Gate name and arity
@@ -184,153 +179,91 @@ matToNumpy(const std::vector<std::vector<std::complex<double>>> &in_mat) {
 
 namespace xacc {
 namespace quantum {
-QlmCircuitVisitor::QlmCircuitVisitor(size_t nbQubit) : m_nbQubit(nbQubit) {
-  m_aqasm = pybind11::module::import("qat.lang.AQASM");
-  m_aqasmProgram = createProgram();
-  m_qreg = qlm_qalloc(m_aqasmProgram, m_nbQubit);
-  m_creg = qlm_calloc(m_aqasmProgram, m_nbQubit);
+QlmCircuitVisitor::QlmCircuitVisitor(size_t nbQubit) : m_nbQubit(nbQubit) {}
+
+void QlmCircuitVisitor::addGate(const std::string &in_aqasmName,
+                                const std::vector<double> &in_params,
+                                const std::vector<size_t> &in_bits,
+                                const std::string &in_modifier,
+                                pybind11::object in_matrix) {
+  m_ops.emplace_back(in_aqasmName, in_params, in_bits, in_modifier,
+                     std::move(in_matrix));
+  m_aqasmProgram = pybind11::object();
 }
 
-pybind11::object QlmCircuitVisitor::createProgram() {
-  return m_aqasm.attr("Program")();
+pybind11::object &QlmCircuitVisitor::getProgram() {
+  if (!m_aqasmProgram) {
+    m_aqasmProgram = qlmHelper("build_program")(m_nbQubit, m_ops);
+  }
+  return m_aqasmProgram;
 }
 
-void QlmCircuitVisitor::visit(Hadamard &h) {
-  auto h_gate = getAqasmGate(h.name());
-  m_aqasmProgram.attr("apply")(h_gate, m_qreg[pybind11::int_(h.bits()[0])]);
-}
+void QlmCircuitVisitor::visit(Hadamard &h) { addGate("H", {}, h.bits()); }
 
-void QlmCircuitVisitor::visit(CNOT &cnot) {
-  auto cx_gate = getAqasmGate(cnot.name());
-  m_aqasmProgram.attr("apply")(cx_gate, m_qreg[pybind11::int_(cnot.bits()[0])],
-                               m_qreg[pybind11::int_(cnot.bits()[1])]);
-}
+void QlmCircuitVisitor::visit(CNOT &cnot) { addGate("CNOT", {}, cnot.bits()); }
 
 void QlmCircuitVisitor::visit(Rz &rz) {
-  auto rz_gate = getAqasmGate(rz.name());
-  const double theta = InstructionParameterToDouble(rz.getParameter(0));
-  m_aqasmProgram.attr("apply")(rz_gate(theta),
-                               m_qreg[pybind11::int_(rz.bits()[0])]);
+  addGate("RZ", {InstructionParameterToDouble(rz.getParameter(0))},
+          rz.bits());
 }
 
 void QlmCircuitVisitor::visit(Ry &ry) {
-  auto ry_gate = getAqasmGate(ry.name());
-  const double theta = InstructionParameterToDouble(ry.getParameter(0));
-  m_aqasmProgram.attr("apply")(ry_gate(theta),
-                               m_qreg[pybind11::int_(ry.bits()[0])]);
+  addGate("RY", {InstructionParameterToDouble(ry.getParameter(0))},
+          ry.bits());
 }
 
 void QlmCircuitVisitor::visit(Rx &rx) {
-  auto rx_gate = getAqasmGate(rx.name());
-  const double theta = InstructionParameterToDouble(rx.getParameter(0));
-  m_aqasmProgram.attr("apply")(rx_gate(theta),
-                               m_qreg[pybind11::int_(rx.bits()[0])]);
+  addGate("RX", {InstructionParameterToDouble(rx.getParameter(0))},
+          rx.bits());
 }
 
-void QlmCircuitVisitor::visit(X &x) {
-  auto x_gate = getAqasmGate(x.name());
-  m_aqasmProgram.attr("apply")(x_gate, m_qreg[pybind11::int_(x.bits()[0])]);
-}
+void QlmCircuitVisitor::visit(X &x) { addGate("X", {}, x.bits()); }
 
-void QlmCircuitVisitor::visit(Y &y) {
-  auto y_gate = getAqasmGate(y.name());
-  m_aqasmProgram.attr("apply")(y_gate, m_qreg[pybind11::int_(y.bits()[0])]);
-}
+void QlmCircuitVisitor::visit(Y &y) { addGate("Y", {}, y.bits()); }
 
-void QlmCircuitVisitor::visit(Z &z) {
-  auto z_gate = getAqasmGate(z.name());
-  m_aqasmProgram.attr("apply")(z_gate, m_qreg[pybind11::int_(z.bits()[0])]);
-}
+void QlmCircuitVisitor::visit(Z &z) { addGate("Z", {}, z.bits()); }
 
-void QlmCircuitVisitor::visit(S &s) {
-  auto s_gate = getAqasmGate(s.name());
-  m_aqasmProgram.attr("apply")(s_gate, m_qreg[pybind11::int_(s.bits()[0])]);
-}
+void QlmCircuitVisitor::visit(S &s) { addGate("S", {}, s.bits()); }
 
-void QlmCircuitVisitor::visit(Sdg &sdg) {
-  auto s_gate = getAqasmGate("S");
-  auto sdg_gate = s_gate.attr("dag")();
-  m_aqasmProgram.attr("apply")(sdg_gate, m_qreg[pybind11::int_(sdg.bits()[0])]);
-}
+void QlmCircuitVisitor::visit(Sdg &sdg) { addGate("S", {}, sdg.bits(), "dag"); }
 
-void QlmCircuitVisitor::visit(T &t) {
-  auto t_gate = getAqasmGate(t.name());
-  m_aqasmProgram.attr("apply")(t_gate, m_qreg[pybind11::int_(t.bits()[0])]);
-}
+void QlmCircuitVisitor::visit(T &t) { addGate("T", {}, t.bits()); }
 
-void QlmCircuitVisitor::visit(Tdg &tdg) {
-  auto t_gate = getAqasmGate("T");
-  auto tdg_gate = t_gate.attr("dag")();
-  m_aqasmProgram.attr("apply")(tdg_gate, m_qreg[pybind11::int_(tdg.bits()[0])]);
-}
+void QlmCircuitVisitor::visit(Tdg &tdg) { addGate("T", {}, tdg.bits(), "dag"); }
 
-void QlmCircuitVisitor::visit(CY &cy) {
-  auto y_gate = getAqasmGate("Y");
-  auto cy_gate = y_gate.attr("ctrl")();
-  m_aqasmProgram.attr("apply")(cy_gate, m_qreg[pybind11::int_(cy.bits()[0])],
-                               m_qreg[pybind11::int_(cy.bits()[1])]);
-}
+void QlmCircuitVisitor::visit(CY &cy) { addGate("Y", {}, cy.bits(), "ctrl"); }
 
-void QlmCircuitVisitor::visit(CZ &cz) {
-  auto cz_gate = getAqasmGate(cz.name());
-  m_aqasmProgram.attr("apply")(cz_gate, m_qreg[pybind11::int_(cz.bits()[0])],
-                               m_qreg[pybind11::int_(cz.bits()[1])]);
-}
+void QlmCircuitVisitor::visit(CZ &cz) { addGate("CSIGN", {}, cz.bits()); }
 
-void QlmCircuitVisitor::visit(Swap &s) {
-  auto swap_gate = getAqasmGate(s.name());
-  m_aqasmProgram.attr("apply")(swap_gate, m_qreg[pybind11::int_(s.bits()[0])],
-                               m_qreg[pybind11::int_(s.bits()[1])]);
-}
+void QlmCircuitVisitor::visit(Swap &s) { addGate("SWAP", {}, s.bits()); }
 
 void QlmCircuitVisitor::visit(CRZ &crz) {
-  auto rz_gate = getAqasmGate("Rz");
-  const double theta = InstructionParameterToDouble(crz.getParameter(0));
-  auto crz_gate = rz_gate(theta).attr("ctrl")();
-  m_aqasmProgram.attr("apply")(crz_gate, m_qreg[pybind11::int_(crz.bits()[0])],
-                               m_qreg[pybind11::int_(crz.bits()[1])]);
+  addGate("RZ", {InstructionParameterToDouble(crz.getParameter(0))},
+          crz.bits(), "ctrl");
 }
 
-void QlmCircuitVisitor::visit(CH &ch) {
-  auto h_gate = getAqasmGate("H");
-  auto ch_gate = h_gate.attr("ctrl")();
-  m_aqasmProgram.attr("apply")(ch_gate, m_qreg[pybind11::int_(ch.bits()[0])],
-                               m_qreg[pybind11::int_(ch.bits()[1])]);
-}
+void QlmCircuitVisitor::visit(CH &ch) { addGate("H", {}, ch.bits(), "ctrl"); }
 
 void QlmCircuitVisitor::visit(CPhase &cphase) {
-  auto ph_gate = getAqasmGate("PH");
-  const double theta = InstructionParameterToDouble(cphase.getParameter(0));
-  auto cp_gate = ph_gate(theta).attr("ctrl")();
-  m_aqasmProgram.attr("apply")(cp_gate,
-                               m_qreg[pybind11::int_(cphase.bits()[0])],
-                               m_qreg[pybind11::int_(cphase.bits()[1])]);
+  addGate("PH", {InstructionParameterToDouble(cphase.getParameter(0))},
+          cphase.bits(), "ctrl");
 }
 
 void QlmCircuitVisitor::visit(U &u) {
-  auto c_gate = getAqasmGate("CustomGate");
   const auto theta = InstructionParameterToDouble(u.getParameter(0));
   const auto phi = InstructionParameterToDouble(u.getParameter(1));
   const auto lambda = InstructionParameterToDouble(u.getParameter(2));
-  auto u3_gate = c_gate(u3GateMat(theta, phi, lambda));
-  m_aqasmProgram.attr("apply")(u3_gate, m_qreg[pybind11::int_(u.bits()[0])]);
+  addGate("CustomGate", {}, u.bits(), "", u3GateMat(theta, phi, lambda));
 }
 
 void QlmCircuitVisitor::visit(iSwap &in_iSwapGate) {
-  auto iswap_gate = getAqasmGate(in_iSwapGate.name());
-  m_aqasmProgram.attr("apply")(iswap_gate,
-                               m_qreg[pybind11::int_(in_iSwapGate.bits()[0])],
-                               m_qreg[pybind11::int_(in_iSwapGate.bits()[1])]);
+  addGate("ISWAP", {}, in_iSwapGate.bits());
 }
 
 void QlmCircuitVisitor::visit(fSim &in_fsimGate) {
   const auto theta = InstructionParameterToDouble(in_fsimGate.getParameter(0));
   const auto phi = InstructionParameterToDouble(in_fsimGate.getParameter(1));
-  auto c_gate = getAqasmGate("CustomGate");
-  auto fsim_gate = c_gate(fSimGateMat(theta, phi));
-  m_aqasmProgram.attr("apply")(fsim_gate,
-                               m_qreg[pybind11::int_(in_fsimGate.bits()[0])],
-                               m_qreg[pybind11::int_(in_fsimGate.bits()[1])]);
+  addGate("CustomGate", {}, in_fsimGate.bits(), "", fSimGateMat(theta, phi));
 }
 
 void QlmCircuitVisitor::visit(Measure &measure) {}
@@ -977,19 +910,17 @@ void QlmAccelerator::persistResultToBuffer(
   };
 
   if (result.attr("value").is_none()) {
-    auto iter = pybind11::iter(result);
-    while (iter != pybind11::iterator::sentinel()) {
-      auto sampleData = *iter;
-      auto bitStr = pybind11::str(sampleData.attr("state")).cast<std::string>();
-      bitStr = bitStr.substr(1, bitStr.size() - 2);
-      auto bitStrProb = sampleData.attr("probability").cast<double>();
-      int count = std::round(bitStrProb * m_shots);
+    auto samples = qlmHelper("samples")(result).cast<pybind11::tuple>();
+    const auto bitStrs = samples[0].cast<std::vector<std::string>>();
+    const auto probs = samples[1].cast<pybind11::array_t<double>>();
+    const auto bitStrProbs = probs.unchecked<1>();
+    for (size_t i = 0; i < bitStrs.size(); ++i) {
+      int count = std::round(bitStrProbs(i) * m_shots);
       if (m_noiseModel) {
-        applyReadoutError(bitStr, count, *m_noiseModel);
+        applyReadoutError(bitStrs[i], count, *m_noiseModel);
       } else {
-        buffer->appendMeasurement(bitStr, count);
+        buffer->appendMeasurement(bitStrs[i], count);
       }
-      ++iter;
     }
   } else {
     auto expVal = result.attr("value").cast<double>();
@@ -1053,11 +984,8 @@ void QlmAccelerator::execute(
     std::shared_ptr<AcceleratorBuffer> buffer,
     const std::vector<std::shared_ptr<CompositeInstruction>>
         compositeInstructions) {
-  std::vector<std::shared_ptr<AcceleratorBuffer>> childBuffers;
   std::vector<pybind11::object> jobs;
   for (auto &f : compositeInstructions) {
-    childBuffers.emplace_back(
-        std::make_shared<xacc::AcceleratorBuffer>(f->name(), buffer->size()));
     jobs.emplace_back(constructQlmJob(buffer, f));
   }
 
@@ -1074,6 +1002,68 @@ void QlmAccelerator::execute(
     }
   }();
 
+  persistBatchResultToBuffer(buffer, compositeInstructions, batchResult, jobs);
+}
+
+std::future<void> QlmAccelerator::executeAsync(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::shared_ptr<CompositeInstruction> compositeInstruction) {
+  // Python must run on the thread holding the GIL, so the
+  // work is deferred to the thread waiting on the future.
+  if (!m_remoteAccess || (m_noiseModel && m_shots < 0)) {
+    return std::async(std::launch::deferred,
+                      [this, buffer, compositeInstruction]() {
+                        execute(buffer, compositeInstruction);
+                      });
+  }
+
+  // QLMaaS: submit now, only join on the job later
+  auto qlmJob = constructQlmJob(buffer, compositeInstruction);
+  auto asynchronous_result = m_qlmQpuServer.attr("submit")(qlmJob);
+  return std::async(std::launch::deferred,
+                    [this, buffer, qlmJob, asynchronous_result]() mutable {
+                      auto result = asynchronous_result.attr("join")();
+                      persistResultToBuffer(buffer, result, qlmJob);
+                    });
+}
+
+std::future<void> QlmAccelerator::executeAsync(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>>
+        compositeInstructions) {
+  if (!m_remoteAccess) {
+    return std::async(std::launch::deferred,
+                      [this, buffer, compositeInstructions]() {
+                        execute(buffer, compositeInstructions);
+                      });
+  }
+
+  std::vector<pybind11::object> jobs;
+  for (auto &f : compositeInstructions) {
+    jobs.emplace_back(constructQlmJob(buffer, f));
+  }
+  auto batch = pybind11::module::import("qat.core").attr("Batch")(jobs);
+  auto asynchronous_result = m_qlmQpuServer.attr("submit")(batch);
+  return std::async(std::launch::deferred,
+                    [this, buffer, compositeInstructions, jobs,
+                     asynchronous_result]() mutable {
+                      auto batchResult = asynchronous_result.attr("join")();
+                      persistBatchResultToBuffer(buffer, compositeInstructions,
+                                                 batchResult, jobs);
+                    });
+}
+
+void QlmAccelerator::persistBatchResultToBuffer(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>>
+        &compositeInstructions,
+    pybind11::object &batchResult, std::vector<pybind11::object> &jobs) const {
+  std::vector<std::shared_ptr<AcceleratorBuffer>> childBuffers;
+  for (auto &f : compositeInstructions) {
+    childBuffers.emplace_back(
+        std::make_shared<xacc::AcceleratorBuffer>(f->name(), buffer->size()));
+  }
+
   // pybind11::print(batchResult);
   auto iter = pybind11::iter(batchResult);
   int childBufferIndex = 0;
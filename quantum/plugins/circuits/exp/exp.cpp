@@ -17,11 +17,13 @@
 #include "ObservableTransform.hpp"
 #include "PauliOperator.hpp"
 #include "CommonGates.hpp"
+#include "SymplecticPauli.hpp"
 
 #include "Utils.hpp"
 #include "xacc.hpp"
 #include "xacc_service.hpp"
 #include <memory>
+#include <numeric>
 #include <regex>
 
 #include <Eigen/Dense>
@@ -66,124 +68,179 @@ bool Exp::expand(const HeterogeneousMap &parameters) {
   double pi = xacc::constants::pi;
   addVariable(paramLetter);
 
-  std::vector<xacc::InstPtr> exp_insts;
-
   // Should we apply the compute action uncompute opt pattern
   // always default to true
   auto apply_cau_opt = parameters.get_or_default(
       "__internal_compute_action_uncompute_opt__", true);
 
-  // auto q_name = q.name();
-  for (auto inst : terms) {
-    auto spinInst = inst.second;
+  // Term ordering, "term-order":
+  //   "lexicographic" sorted by (qubit, Pauli) strings, i.e. a different
+  //                   product formula unless the terms commute,
+  //   "greedy"        each next term is the one sharing the longest prefix
+  //                   of (qubit, Pauli) with the previous term, among the few
+  //                   next ones that commute with all the terms they move
+  //                   ahead of, i.e. the same operator as the default order.
+  // With "share-ladders" (default true if a term order is given), the trailing
+  // basis changes and CNOT ladder of a term cancel with the leading ones of
+  // the next term on their common prefix (no compute-action-uncompute
+  // segments then).
+  const auto termOrder = parameters.stringExists("term-order")
+                             ? parameters.getString("term-order")
+                             : std::string("none");
+  if (termOrder != "none" && termOrder != "lexicographic" &&
+      termOrder != "greedy") {
+    xacc::error("Invalid term-order " + termOrder +
+                ", must be lexicographic or greedy.");
+  }
+  const bool shareLadders =
+      parameters.get_or_default("share-ladders", termOrder != "none");
+  if (shareLadders) {
+    apply_cau_opt = false;
+  }
+
+  // The (qubit, Pauli) strings of the non-identity terms, with their
+  // coefficients
+  std::vector<std::vector<std::pair<int, std::string>>> paulis;
+  std::vector<double> coeffs;
+  std::vector<SymplecticPauli> symplectics;
+  for (auto &inst : terms) {
+    auto &spinInst = inst.second;
     if (spinInst.isIdentity()) {
       continue;
     }
-    // Get the individual pauli terms
-    auto termsMap = std::get<2>(spinInst);
-
-    std::vector<std::pair<int, std::string>> terms;
-    for (auto &kv : termsMap) {
+    std::vector<std::pair<int, std::string>> termPaulis;
+    for (auto &kv : spinInst.ops()) {
       if (kv.second != "I" && !kv.second.empty()) {
-        terms.push_back({kv.first, kv.second});
+        termPaulis.push_back({kv.first, kv.second});
       }
     }
-    // The largest qubit index is on the last term
-    int largestQbitIdx = terms[terms.size() - 1].first;
-
-    std::vector<std::size_t> qidxs;
-    std::vector<xacc::InstPtr> basis_front, basis_back;
-
-    for (auto &term : terms) {
-      auto qid = term.first;
-      auto pop = term.second;
-
-      qidxs.push_back(qid);
-
-      if (pop == "X") {
-        basis_front.emplace_back(
-            std::make_shared<xacc::quantum::Hadamard>(qid));
-        basis_back.emplace_back(std::make_shared<xacc::quantum::Hadamard>(qid));
+    if (termPaulis.empty()) {
+      continue;
+    }
+    paulis.emplace_back(std::move(termPaulis));
+    coeffs.push_back(std::real(spinInst.coeff()) != 0.0
+                         ? std::real(spinInst.coeff())
+                         : std::imag(spinInst.coeff()));
+    if (termOrder == "greedy") {
+      symplectics.emplace_back(spinInst.ops());
+    }
+  }
 
-        if (apply_cau_opt) {
-          basis_front.back()->attachMetadata(
-              {{"__qcor__compute__segment__", true}});
-          basis_back.back()->attachMetadata(
-              {{"__qcor__compute__segment__", true}});
+  const auto sharedPrefix =
+      [&](const std::vector<std::pair<int, std::string>> &a,
+          const std::vector<std::pair<int, std::string>> &b) {
+        std::size_t nbShared = 0;
+        while (nbShared < a.size() && nbShared < b.size() &&
+               a[nbShared] == b[nbShared]) {
+          nbShared++;
+        }
+        return nbShared;
+      };
+
+  std::vector<std::size_t> order(paulis.size());
+  std::iota(order.begin(), order.end(), 0);
+  if (termOrder == "lexicographic") {
+    std::stable_sort(order.begin(), order.end(),
+                     [&](std::size_t a, std::size_t b) {
+                       return paulis[a] < paulis[b];
+                     });
+  } else if (termOrder == "greedy") {
+    // Candidates among the next unscheduled terms
+    constexpr std::size_t window = 64;
+    std::vector<bool> scheduled(paulis.size(), false);
+    std::size_t first = 0;
+    for (std::size_t step = 0; step < paulis.size(); step++) {
+      while (scheduled[first]) {
+        first++;
+      }
+      std::size_t best = first;
+      std::size_t bestShared =
+          step ? sharedPrefix(paulis[order[step - 1]], paulis[first]) : 0;
+      std::size_t nbScanned = 1;
+      for (std::size_t j = first + 1;
+           step && j < paulis.size() && nbScanned < window; j++) {
+        if (scheduled[j]) {
+          continue;
+        }
+        nbScanned++;
+        const auto nbShared = sharedPrefix(paulis[order[step - 1]], paulis[j]);
+        if (nbShared <= bestShared) {
+          continue;
         }
-      } else if (pop == "Y") {
-        basis_front.emplace_back(
-            std::make_shared<xacc::quantum::Rx>(qid, 1.57079362679));
-        basis_back.emplace_back(
-            std::make_shared<xacc::quantum::Rx>(qid, -1.57079362679));
-
-        if (apply_cau_opt) {
-          basis_front.back()->attachMetadata(
-              {{"__qcor__compute__segment__", true}});
-          basis_back.back()->attachMetadata(
-              {{"__qcor__compute__segment__", true}});
+        bool movable = true;
+        for (std::size_t i = first; i < j && movable; i++) {
+          movable = scheduled[i] || symplectics[i].commutes(symplectics[j]);
+        }
+        if (movable) {
+          best = j;
+          bestShared = nbShared;
         }
       }
+      scheduled[best] = true;
+      order[step] = best;
     }
+  }
 
-    // std::cout << "QIDS:  " << qidxs << "\n";
-
-    Eigen::MatrixXi cnot_pairs(2, qidxs.size() - 1);
-    for (int i = 0; i < qidxs.size() - 1; i++) {
-      cnot_pairs(0, i) = qidxs[i];
+  std::vector<xacc::InstPtr> exp_insts;
+  const auto addBasisChange = [&](std::size_t qid, const std::string &pop,
+                                  double sign) {
+    if (pop == "X") {
+      exp_insts.emplace_back(std::make_shared<xacc::quantum::Hadamard>(qid));
+    } else if (pop == "Y") {
+      exp_insts.emplace_back(
+          std::make_shared<xacc::quantum::Rx>(qid, sign * 1.57079362679));
+    } else {
+      return;
     }
-    for (int i = 0; i < qidxs.size() - 1; i++) {
-      cnot_pairs(1, i) = qidxs[i + 1];
+    if (apply_cau_opt) {
+      exp_insts.back()->attachMetadata({{"__qcor__compute__segment__", true}});
     }
-
-    // std::cout << "HOWDY: \n" << cnot_pairs << "\n";
-    std::vector<xacc::InstPtr> cnot_front, cnot_back;
-    for (int i = 0; i < qidxs.size() - 1; i++) {
-      Eigen::VectorXi pairs = cnot_pairs.col(i);
-      auto c = pairs(0);
-      auto t = pairs(1);
-      cnot_front.emplace_back(std::make_shared<xacc::quantum::CNOT>(c, t));
-      if (apply_cau_opt) {
-        cnot_front.back()->attachMetadata(
-            {{"__qcor__compute__segment__", true}});
+  };
+  const auto addCNOT = [&](std::size_t c, std::size_t t) {
+    exp_insts.emplace_back(std::make_shared<xacc::quantum::CNOT>(c, t));
+    if (apply_cau_opt) {
+      exp_insts.back()->attachMetadata({{"__qcor__compute__segment__", true}});
+    }
+  };
+
+  // The trailing ladder of the previous term, emitted once the next term
+  // is known (without its first nbShared (qubit, Pauli))
+  const std::vector<std::pair<int, std::string>> *previous = nullptr;
+  const auto addTrailingLadder = [&](std::size_t nbShared) {
+    if (!previous) {
+      return;
+    }
+    for (int i = (int)previous->size() - 2; i >= 0; i--) {
+      if (i + 1 >= nbShared) {
+        addCNOT((*previous)[i].first, (*previous)[i + 1].first);
       }
     }
+    for (int i = nbShared; i < previous->size(); i++) {
+      addBasisChange((*previous)[i].first, (*previous)[i].second, -1.0);
+    }
+  };
 
-    for (int i = qidxs.size() - 2; i >= 0; i--) {
-      Eigen::VectorXi pairs = cnot_pairs.col(i);
-      auto c = pairs(0);
-      auto t = pairs(1);
-      cnot_back.emplace_back(std::make_shared<xacc::quantum::CNOT>(c, t));
-      if (apply_cau_opt) {
-        cnot_back.back()->attachMetadata(
-            {{"__qcor__compute__segment__", true}});
-      }
+  for (auto termIdx : order) {
+    const auto &termPaulis = paulis[termIdx];
+    const auto nbShared =
+        shareLadders && previous ? sharedPrefix(*previous, termPaulis) : 0;
+    addTrailingLadder(nbShared);
+
+    for (int i = nbShared; i < termPaulis.size(); i++) {
+      addBasisChange(termPaulis[i].first, termPaulis[i].second, 1.0);
     }
-    exp_insts.insert(exp_insts.end(),
-                     std::make_move_iterator(basis_front.begin()),
-                     std::make_move_iterator(basis_front.end()));
-    exp_insts.insert(exp_insts.end(),
-                     std::make_move_iterator(cnot_front.begin()),
-                     std::make_move_iterator(cnot_front.end()));
-
-    double coeff;
-    if (std::real(spinInst.coeff()) != 0.0) {
-      coeff = std::real(spinInst.coeff());
-    } else {
-      coeff = std::imag(spinInst.coeff());
+    for (int i = 0; i < (int)termPaulis.size() - 1; i++) {
+      if (i + 1 >= nbShared) {
+        addCNOT(termPaulis[i].first, termPaulis[i + 1].first);
+      }
     }
 
-    std::string p = std::to_string(2.0 * coeff) + " * " + paramLetter;
+    std::string p = std::to_string(2.0 * coeffs[termIdx]) + " * " + paramLetter;
     exp_insts.emplace_back(
-        std::make_shared<xacc::quantum::Rz>(qidxs[qidxs.size() - 1], p));
-
-    exp_insts.insert(exp_insts.end(),
-                     std::make_move_iterator(cnot_back.begin()),
-                     std::make_move_iterator(cnot_back.end()));
-    exp_insts.insert(exp_insts.end(),
-                     std::make_move_iterator(basis_back.begin()),
-                     std::make_move_iterator(basis_back.end()));
+        std::make_shared<xacc::quantum::Rz>(termPaulis.back().first, p));
+    previous = &termPaulis;
   }
+  addTrailingLadder(0);
 
   addInstructions(std::move(exp_insts), false);
 
@@ -313,7 +370,7 @@ void Exp::applyRuntimeArguments() {
     auto xasm = xacc::getCompiler("xasm");
     auto tmp = xasm->compile(xasm_src)->getComposites()[0];
 
-    for (auto inst : tmp->getInstructions()) {
+    for (auto &inst : tmp->getInstructionsView()) {
       addInstruction(inst);
     }
 
@@ -33,6 +33,35 @@ TEST(ExpTester, checkSimple) {
   std::cout << "F2:\n" << exp2->toString() << "\n";
 }
 
+TEST(ExpTester, checkSharedLadders) {
+  const auto countCNOTs = [](std::shared_ptr<quantum::Circuit> circuit) {
+    int count = 0;
+    for (auto &inst : circuit->getInstructions()) {
+      count += inst->name() == "CNOT";
+    }
+    return count;
+  };
+  const std::string pauli = "X0 X1 Z2 Z3 + Y0 Y1 + X0 X1 Y2";
+  auto exp = std::dynamic_pointer_cast<quantum::Circuit>(
+      xacc::getService<Instruction>("exp_i_theta"));
+  EXPECT_TRUE(exp->expand({std::make_pair("pauli", pauli)}));
+  EXPECT_EQ(12, countCNOTs(exp));
+
+  // X0 X1 Y2 then X0 X1 Z2 Z3 share CNOT(0, 1) and the basis changes of 0, 1
+  for (auto &options :
+       std::vector<HeterogeneousMap>{{std::make_pair("share-ladders", true)},
+                                     {std::make_pair("term-order", "greedy")},
+                                     {std::make_pair("term-order",
+                                                     "lexicographic")}}) {
+    auto shared = std::dynamic_pointer_cast<quantum::Circuit>(
+        xacc::getService<Instruction>("exp_i_theta"));
+    options.insert("pauli", pauli);
+    EXPECT_TRUE(shared->expand(options));
+    EXPECT_EQ(10, countCNOTs(shared));
+    EXPECT_EQ(exp->nInstructions() - 6, shared->nInstructions());
+  }
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize(argc, argv);
   //   xacc::Initialize();
@@ -58,49 +58,70 @@ bool HWE::expand(const HeterogeneousMap &parameters) {
   addVariables(fParams);
 
   auto provider = xacc::getService<IRProvider>("quantum");
-  int angleCounter = 0;
+  const auto parameter = [&](int idx) {
+    return InstructionParameter(paramLetter + std::to_string(idx));
+  };
+
+  // The layers are instances of one template: the entangler (the CNOTs of
+  // the coupling) then Rz Rx Rz on each qubit, the parameters of layer d
+  // at offset 2 nq + 3 nq d. The gates are cloned from the template rather
+  // than created through the provider, and appended at once.
+  // With "shared-layers", the entangler is one sub-composite shared by all
+  // the layers (transformations that modify the gates in place must then be
+  // applied to a flattened copy).
+  const bool sharedLayers = parameters.get_or_default("shared-layers", false);
+  std::vector<InstPtr> entangler;
+  for (auto &p : connectivity) {
+    std::size_t tmp1 = p.first;
+    std::size_t tmp2 = p.second;
+    entangler.emplace_back(provider->createInstruction("CNOT", {tmp1, tmp2}));
+  }
+  std::shared_ptr<CompositeInstruction> sharedEntangler;
+  if (sharedLayers && !entangler.empty()) {
+    sharedEntangler = provider->createComposite(name() + "_entangler");
+    sharedEntangler->addInstructions(std::move(entangler), false);
+  }
+  // (gate, parameter index in the layer)
+  std::vector<std::pair<InstPtr, int>> rotations;
+  for (std::size_t q = 0; q < nQubits; q++) {
+    rotations.emplace_back(
+        provider->createInstruction("Rz", {q}, {parameter(0)}), 3 * q);
+    rotations.emplace_back(
+        provider->createInstruction("Rx", {q}, {parameter(0)}), 3 * q + 1);
+    rotations.emplace_back(
+        provider->createInstruction("Rz", {q}, {parameter(0)}), 3 * q + 2);
+  }
 
+  std::vector<InstPtr> insts;
+  insts.reserve(2 * nQubits +
+                layers * (3 * nQubits + (sharedEntangler ? 1 : entangler.size())));
   // Zeroth layer, start with X and Z rotations
   for (std::size_t q = 0; q < nQubits; q++) {
-    auto rx = provider->createInstruction(
-        "Rx", {q},
-        {InstructionParameter(paramLetter + std::to_string(angleCounter))});
-    auto rz = provider->createInstruction(
-        "Rz", {q},
-        {InstructionParameter(paramLetter + std::to_string(angleCounter + 1))});
-    addInstruction(rx);
-    addInstruction(rz);
-    angleCounter += 2;
+    auto rx = rotations[3 * q + 1].first->clone();
+    rx->setParameter(0, parameter(2 * q));
+    auto rz = rotations[3 * q].first->clone();
+    rz->setParameter(0, parameter(2 * q + 1));
+    insts.emplace_back(rx);
+    insts.emplace_back(rz);
   }
 
   for (int d = 0; d < layers; d++) {
-    for (auto &p : connectivity) {
-      std::size_t tmp1 = p.first;
-      std::size_t tmp2 = p.second;
-      auto cnot = provider->createInstruction("CNOT", {tmp1,tmp2});
-      addInstruction(cnot);
+    if (sharedEntangler) {
+      insts.emplace_back(sharedEntangler);
+    } else {
+      for (auto &cnot : entangler) {
+        insts.emplace_back(d ? cnot->clone() : cnot);
+      }
     }
-    for (std::size_t q = 0; q < nQubits; q++) {
-      auto rz1 = provider->createInstruction(
-          "Rz", {q},
-          {InstructionParameter(paramLetter + std::to_string(angleCounter))});
-      addInstruction(rz1);
-
-      auto rx = provider->createInstruction(
-          "Rx", {q},
-          {InstructionParameter(paramLetter +
-                                std::to_string(angleCounter + 1))});
-      addInstruction(rx);
-
-      auto rz2 = provider->createInstruction(
-          "Rz", {q},
-          {InstructionParameter(paramLetter +
-                                std::to_string(angleCounter + 2))});
-      addInstruction(rz2);
-
-      angleCounter += 3;
+    const int offset = 2 * nQubits + 3 * nQubits * d;
+    for (auto &[gate, paramIdx] : rotations) {
+      auto inst = gate->clone();
+      inst->setParameter(0, parameter(offset + paramIdx));
+      insts.emplace_back(inst);
     }
   }
+  // All the parameters are variables of this circuit.
+  addInstructions(std::move(insts), false);
 
   return true;
 }
@@ -45,6 +45,37 @@ auto hwe2 = std::dynamic_pointer_cast<quantum::Circuit>(
   EXPECT_EQ(20, hwe2->nVariables());
 }
 
+TEST(HWETester, checkSharedLayers) {
+  const auto generate = [](bool shared) {
+    auto hwe = std::dynamic_pointer_cast<quantum::Circuit>(
+        xacc::getService<Instruction>("hwe"));
+    EXPECT_TRUE(hwe->expand(
+        {std::make_pair("nq", 4), std::make_pair("layers", 3),
+         std::make_pair("coupling",
+                        std::vector<std::pair<int, int>>{{0, 1}, {1, 2}, {2, 3}}),
+         std::make_pair("shared-layers", shared)}));
+    return hwe;
+  };
+  auto copied = generate(false);
+  auto shared = generate(true);
+  EXPECT_EQ(8 + 3 * (3 + 12), copied->nInstructions());
+  // One entangler sub-composite per layer
+  EXPECT_EQ(8 + 3 * (1 + 12), shared->nInstructions());
+  EXPECT_EQ(44, shared->nVariables());
+
+  std::vector<double> params(44);
+  for (int i = 0; i < params.size(); ++i) {
+    params[i] = 0.1 * i;
+  }
+  auto evaledCopied = (*copied)(params);
+  auto evaledShared = (*shared)(params);
+  ASSERT_EQ(evaledCopied->nInstructions(), evaledShared->nInstructions());
+  for (int i = 0; i < evaledCopied->nInstructions(); ++i) {
+    EXPECT_EQ(evaledCopied->getInstruction(i)->toString(),
+              evaledShared->getInstruction(i)->toString());
+  }
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize(argc, argv);
 //   xacc::Initialize();
@@ -5,25 +5,24 @@
 #include <Eigen/Eigenvalues>
 #include <unsupported/Eigen/KroneckerProduct>
 #include <unsupported/Eigen/MatrixFunctions>
+#include <atomic>
 #include "PauliOperator.hpp"
 
 namespace {
 constexpr std::complex<double> I{0.0, 1.0};
 int getTempId() {
-  static int tempIdCounter = 0;
-  tempIdCounter++;
-  return tempIdCounter;
+  // The decomposition may run concurrently (e.g. two-qubit-block-merging).
+  static std::atomic<int> tempIdCounter{0};
+  return ++tempIdCounter;
 }
 
 // Define some special matrices
 const Eigen::MatrixXcd &KAK_MAGIC() {
-  static Eigen::MatrixXcd KAK_MAGIC(4, 4);
-  static bool init = false;
-  if (!init) {
-    KAK_MAGIC << 1, 0, 0, I, 0, I, 1, 0, 0, I, -1, 0, 1, 0, 0, -I;
-    KAK_MAGIC = KAK_MAGIC * std::sqrt(0.5);
-    init = true;
-  }
+  static const Eigen::MatrixXcd KAK_MAGIC = []() {
+    Eigen::MatrixXcd result(4, 4);
+    result << 1, 0, 0, I, 0, I, 1, 0, 0, I, -1, 0, 1, 0, 0, -I;
+    return Eigen::MatrixXcd(result * std::sqrt(0.5));
+  }();
 
   return KAK_MAGIC;
 }
@@ -34,13 +33,11 @@ const Eigen::MatrixXcd &KAK_MAGIC_DAG() {
 }
 
 const Eigen::MatrixXcd &KAK_GAMMA() {
-  static Eigen::MatrixXcd KAK_GAMMA(4, 4);
-  static bool init = false;
-  if (!init) {
-    KAK_GAMMA << 1, 1, 1, 1, 1, 1, -1, -1, -1, 1, -1, 1, 1, -1, -1, 1;
-    KAK_GAMMA = 0.25 * KAK_GAMMA;
-    init = true;
-  }
+  static const Eigen::MatrixXcd KAK_GAMMA = []() {
+    Eigen::MatrixXcd result(4, 4);
+    result << 1, 1, 1, 1, 1, 1, -1, -1, -1, 1, -1, 1, 1, -1, -1, 1;
+    return Eigen::MatrixXcd(0.25 * result);
+  }();
 
   return KAK_GAMMA;
 }
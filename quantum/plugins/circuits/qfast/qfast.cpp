@@ -17,10 +17,12 @@
 #include <unsupported/Eigen/KroneckerProduct>
 #include <unsupported/Eigen/MatrixFunctions>
 #include <unsupported/Eigen/NumericalDiff>
+#include <limits>
 #include <numeric>
 #include <random>
 #include "json.hpp"
 #include "xacc_config.hpp"
+#include "StructuralHasher.hpp"
 
 namespace {
 Eigen::MatrixXcd X { Eigen::MatrixXcd::Zero(2, 2)};      
@@ -194,10 +196,7 @@ bool QFAST::expand(const xacc::HeterogeneousMap& runtimeOptions)
         qfastCacheFileName = runtimeOptions.getString("cache-file-name");
     }
 
-    if (!m_cache.initialize(cacheDir + "/" + qfastCacheFileName))
-    {
-        xacc::warning("Failed to initialize QFAST cache. No cache look-up.");
-    }
+    m_cache = DecomposedResultCache::get(cacheDir + "/" + qfastCacheFileName);
 
     // Default trace distance limit = 0.01 (99% fidelity).
     m_distanceLimit = 0.01;
@@ -239,6 +238,19 @@ bool QFAST::expand(const xacc::HeterogeneousMap& runtimeOptions)
         }
     }
 
+    // Default: one start per thread, up to 4.
+    m_nbStarts = std::max(1, std::min(4, xacc::getTaskScheduler()->getNumberOfThreads()));
+    if (runtimeOptions.keyExists<int>("nb-starts"))
+    {
+        const int nbStarts = runtimeOptions.get<int>("nb-starts");
+        if (nbStarts < 1)
+        {
+            xacc::error("Invalid 'nb-starts' setting.");
+            return false;
+        }
+        m_nbStarts = nbStarts;
+    }
+
     m_optimizer.reset();
     if (runtimeOptions.pointerLikeExists<Optimizer>("optimizer"))
     {
@@ -247,7 +259,7 @@ bool QFAST::expand(const xacc::HeterogeneousMap& runtimeOptions)
 
     m_locationModel = std::make_shared<LocationModel>(m_nbQubits);
     
-    const auto cacheLookupResult = m_cache.getCache(m_targetU);
+    const auto cacheLookupResult = m_cache->getCache(m_targetU);
 
     const auto decomposedResult = cacheLookupResult.empty() ? 
                                     // No cache, run decompose:
@@ -259,7 +271,7 @@ bool QFAST::expand(const xacc::HeterogeneousMap& runtimeOptions)
     // if it was not found (i.e. decomposed in the previous step)
     if (cacheLookupResult.empty())
     {
-        if (m_cache.addCacheEntry(m_targetU, decomposedResult))
+        if (m_cache->addCacheEntry(m_targetU, decomposedResult))
         {
             xacc::info("Caching the QFAST result to file succeeded.");
         }
@@ -344,7 +356,7 @@ std::vector<QFAST::Block> QFAST::refine(const std::vector<QFAST::PauliReps>& in_
     RefineDiffFunctor diffFunctor(this, refinedReps, nbParams);
     Eigen::NumericalDiff<RefineDiffFunctor> numDiff(diffFunctor);    
     
-    auto optimizer = m_optimizer ? m_optimizer : xacc::getOptimizer("nlopt");
+    auto optimizer = getOptimizerInstance();
 
     const bool needGrads = optimizer->isGradientBased();    
     
@@ -571,10 +583,71 @@ std::vector<std::vector<Eigen::MatrixXcd>> QFAST::generateAllPaulis(size_t in_nb
     return result;
 }
 
+std::shared_ptr<Optimizer> QFAST::getOptimizerInstance() const
+{
+    auto optimizer = m_optimizer ? m_optimizer : xacc::getOptimizer("nlopt");
+    auto cloneable = std::dynamic_pointer_cast<Cloneable<Optimizer>>(optimizer);
+    return cloneable ? cloneable->clone() : optimizer;
+}
+
 bool QFAST::optimizeAtDepth(std::vector<PauliReps>& io_repsToOpt, double in_targetDistance) const 
 {
     assert(!io_repsToOpt.empty());
-   
+    std::vector<std::shared_ptr<Optimizer>> optimizers { getOptimizerInstance() };
+    // Concurrent starts need independent optimizer instances.
+    const bool isCloned = optimizers[0] != (m_optimizer ? m_optimizer : xacc::getOptimizer("nlopt"));
+    while (isCloned && optimizers.size() < m_nbStarts)
+    {
+        optimizers.emplace_back(getOptimizerInstance());
+    }
+
+    if (optimizers.size() == 1)
+    {
+        return optimizeStart(io_repsToOpt, in_targetDistance, optimizers[0], nullptr) < in_targetDistance;
+    }
+
+    // The first start continues from the current parameters,
+    // the others from random locations.
+    std::vector<std::vector<PauliReps>> starts(optimizers.size(), io_repsToOpt);
+    std::random_device rd;
+    std::mt19937 mt(rd());
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    for (size_t i = 1; i < starts.size(); ++i)
+    {
+        for (auto& layer : starts[i])
+        {
+            for (auto& locParam : layer.locValues)
+            {
+                locParam = dist(mt);
+            }
+        }
+    }
+
+    std::vector<double> distances(starts.size(), std::numeric_limits<double>::max());
+    std::atomic<bool> stop(false);
+    xacc::getTaskScheduler()->parallelFor(0, starts.size(), [&](size_t beginIdx, size_t endIdx) {
+        for (size_t i = beginIdx; i < endIdx; ++i)
+        {
+            if (stop)
+            {
+                continue;
+            }
+            distances[i] = optimizeStart(starts[i], in_targetDistance, optimizers[i], &stop);
+            if (distances[i] < in_targetDistance)
+            {
+                stop = true;
+            }
+        }
+    });
+
+    const auto bestIdx = std::distance(distances.begin(), std::min_element(distances.begin(), distances.end()));
+    xacc::info("[Explore] Best start: " + std::to_string(bestIdx) + " of " + std::to_string(starts.size()));
+    io_repsToOpt = std::move(starts[bestIdx]);
+    return distances[bestIdx] < in_targetDistance;
+}
+
+double QFAST::optimizeStart(std::vector<PauliReps>& io_repsToOpt, double in_targetDistance, std::shared_ptr<Optimizer> in_optimizer, const std::atomic<bool>* in_stop) const 
+{
     int nbParams = 0;
     std::vector<double> initialParams; 
     for (const auto& layer : io_repsToOpt)
@@ -586,7 +659,7 @@ bool QFAST::optimizeAtDepth(std::vector<PauliReps>& io_repsToOpt, double in_targ
     
     const int maxEval = nbParams * 100;
 
-    auto optimizer = m_optimizer ? m_optimizer : xacc::getOptimizer("nlopt");
+    auto& optimizer = in_optimizer;
     const bool needGrads = optimizer->isGradientBased();    
     
     // Handle optimizer specific configurations.
@@ -639,6 +712,16 @@ bool QFAST::optimizeAtDepth(std::vector<PauliReps>& io_repsToOpt, double in_targ
     OptFunction f(
         [&](const std::vector<double>& x, std::vector<double>& grad) 
         {
+            if (in_stop && *in_stop)
+            {
+                // Another start met the target:
+                // a zero cost (below the stop value) terminates this one.
+                if (needGrads)
+                {
+                    grad.assign(x.size(), 0.0);
+                }
+                return 0.0;
+            }
             const Eigen::VectorXd inputParams = Eigen::Map<const Eigen::VectorXd>(x.data(), x.size());
             // Just 1 output:
             Eigen::VectorXd outVal(1);
@@ -704,7 +787,7 @@ bool QFAST::optimizeAtDepth(std::vector<PauliReps>& io_repsToOpt, double in_targ
     // allowing a linear combination of multiple locations.
     // We have used *soft-max* to prevent most of that
     // unless the optimizer created two identical location parameters at a layer.    
-    return (evaluateCostFunc(accumU) < in_targetDistance);
+    return evaluateCostFunc(accumU);
 }
 
 int QFAST::ExploreDiffFunctor::operator()(const InputType& in_x, ValueType& out_fvec) const
@@ -745,9 +828,11 @@ double QFAST::computeTraceDistance(const Eigen::MatrixXcd& in_mat1, const Eigen:
     assert(in_mat1.rows() == in_mat2.rows());
     assert(in_mat1.cols() == in_mat2.cols());
     const auto d = in_mat1.cols();
-    const auto product = in_mat1.adjoint() * in_mat2;
-    const double traceNorm =  std::norm(product.trace());
-    return std::sqrt(1.0 - traceNorm / (d*d));
+    // Tr(A^dagger * B), without the matrix product.
+    const std::complex<double> trace = in_mat1.conjugate().cwiseProduct(in_mat2).sum();
+    const double traceNorm =  std::norm(trace);
+    // Rounding may make it (slightly) negative for equal matrices.
+    return std::sqrt(std::max(0.0, 1.0 - traceNorm / (d*d)));
 }
 
 double QFAST::evaluateCostFunc(const Eigen::MatrixXcd& in_U) const
@@ -876,8 +961,26 @@ Eigen::MatrixXcd  QFAST::Block::toFullMat(size_t in_totalDim) const
     return resultMat;
 }
 
+std::shared_ptr<QFAST::DecomposedResultCache> QFAST::DecomposedResultCache::get(const std::string& in_filePath)
+{
+    static std::mutex registryMutex;
+    static std::unordered_map<std::string, std::shared_ptr<DecomposedResultCache>> registry;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto& result = registry[in_filePath];
+    if (!result)
+    {
+        result = std::make_shared<DecomposedResultCache>();
+        if (!result->initialize(in_filePath))
+        {
+            xacc::warning("Failed to initialize QFAST cache. No cache look-up.");
+        }
+    }
+    return result;
+}
+
 bool QFAST::DecomposedResultCache::initialize(const std::string& in_filePath)
 {
+    std::lock_guard<std::mutex> lock(mutex);
     fileName = in_filePath;
     if (!fileExists(in_filePath))
     {
@@ -904,6 +1007,7 @@ bool QFAST::DecomposedResultCache::initialize(const std::string& in_filePath)
     if (!fileString.empty() && !fromJsonString(fileString))
     {
         cache.clear();
+        index.clear();
         xacc::warning("Failed to parse cache file " + in_filePath);
         return false;
     }
@@ -914,16 +1018,20 @@ bool QFAST::DecomposedResultCache::initialize(const std::string& in_filePath)
         
 bool QFAST::DecomposedResultCache::addCacheEntry(const Eigen::MatrixXcd& in_unitary, const std::vector<Block>& in_decomposedBlocks, bool in_shouldSync)
 {
-    // Must add new entries only
-    assert(getCache(in_unitary).empty());
+    std::lock_guard<std::mutex> lock(mutex);
+    // Another instance may have added it in the meantime.
+    if (findEntry(in_unitary))
+    {
+        return true;
+    }
     CacheEntry newEntry;
     newEntry.uMat = in_unitary;
     newEntry.blocks = in_decomposedBlocks;
-    cache.emplace_back(std::move(newEntry));
+    insertEntry(std::move(newEntry));
     // Write to file
     if (in_shouldSync && fileExists(fileName))
     {
-        const std::string newCacheContent = toJson();
+        const std::string newCacheContent = toJsonUnlocked();
         // Open file to write
         FILE* hFile = fopen(fileName.c_str(), "w");
         // Failed to open file for writing.
@@ -941,25 +1049,81 @@ bool QFAST::DecomposedResultCache::addCacheEntry(const Eigen::MatrixXcd& in_unit
         
 std::vector<QFAST::Block> QFAST::DecomposedResultCache::getCache(const Eigen::MatrixXcd& in_unitary) const
 {
-    // Note: for now, we do a linear search here since this is a local cache,
-    // hence we don't expect it to have more than a handful of cached results.
-    // TODO: if we are to implement a global database, we may need to implement
-    // some form of hashing machanism.    
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto* entry = findEntry(in_unitary);
+    if (entry)
+    {
+        xacc::info("Found cache entry!");
+        return entry->blocks;
+    }
+    return {};
+}
+
+const QFAST::DecomposedResultCache::CacheEntry* QFAST::DecomposedResultCache::findEntry(const Eigen::MatrixXcd& in_unitary) const
+{
     // Tolerance for matching    
     constexpr double TRACE_DISTANCE_TOLERANCE = 1e-5;
+    const auto matches = [&](const CacheEntry& in_entry) {
+        // Dimension matched
+        return in_entry.uMat.rows() == in_unitary.rows() && 
+            in_entry.uMat.cols() == in_unitary.cols() &&
+            QFAST::computeTraceDistance(in_entry.uMat, in_unitary) < TRACE_DISTANCE_TOLERANCE;
+    };
+
+    const auto range = index.equal_range(canonicalKey(in_unitary));
+    for (auto iter = range.first; iter != range.second; ++iter)
+    {
+        if (matches(cache[iter->second]))
+        {
+            return &cache[iter->second];
+        }
+    }
+    // The quantization of the key may separate unitaries within the tolerance,
+    // the (rare) near matches are found by a linear search.
     for (const auto& entry : cache)
     {
-        // Dimension matched
-        if (entry.uMat.size() == in_unitary.size())
+        if (matches(entry))
         {
-            if (QFAST::computeTraceDistance(entry.uMat, in_unitary) < TRACE_DISTANCE_TOLERANCE)  
-            {
-                xacc::info("Found cache entry!");
-                return entry.blocks;
-            }          
+            return &entry;
         }
     }
-    return {};
+    return nullptr;
+}
+
+void QFAST::DecomposedResultCache::insertEntry(CacheEntry&& in_entry)
+{
+    index.emplace(canonicalKey(in_entry.uMat), cache.size());
+    cache.emplace_back(std::move(in_entry));
+}
+
+uint64_t QFAST::DecomposedResultCache::canonicalKey(const Eigen::MatrixXcd& in_unitary)
+{
+    // Quantization step of the entries
+    constexpr double KEY_RESOLUTION = 1e-6;
+    // Each column of a unitary has an entry of magnitude >= 1/sqrt(d),
+    // the global phase is fixed by the first one above half of that.
+    const double threshold = 0.5 / std::sqrt(std::max<double>(in_unitary.rows(), 1.0));
+    std::complex<double> phase = 1.0;
+    for (Eigen::Index i = 0; i < in_unitary.size(); ++i)
+    {
+        const double magnitude = std::abs(in_unitary(i));
+        if (magnitude >= threshold)
+        {
+            phase = std::conj(in_unitary(i)) / magnitude;
+            break;
+        }
+    }
+
+    xacc::StructuralHasher hasher;
+    hasher.add<int64_t>(in_unitary.rows());
+    hasher.add<int64_t>(in_unitary.cols());
+    for (Eigen::Index i = 0; i < in_unitary.size(); ++i)
+    {
+        const std::complex<double> entry = in_unitary(i) * phase;
+        hasher.add<int64_t>(std::llround(entry.real() / KEY_RESOLUTION));
+        hasher.add<int64_t>(std::llround(entry.imag() / KEY_RESOLUTION));
+    }
+    return hasher.value();
 }
 
 std::string QFAST::Block::toJson() const 
@@ -1090,6 +1254,12 @@ bool QFAST::DecomposedResultCache::CacheEntry::fromJsonString(const std::string&
 }
 
 std::string QFAST::DecomposedResultCache::toJson() const 
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return toJsonUnlocked();
+}
+
+std::string QFAST::DecomposedResultCache::toJsonUnlocked() const 
 {
     std::vector<std::string> cacheJson;
     for (const auto& entry: cache)
@@ -1112,7 +1282,7 @@ bool QFAST::DecomposedResultCache::fromJsonString(const std::string& in_jsonStri
         CacheEntry newEntry;
         if (newEntry.fromJsonString(entryJson))
         {
-            cache.emplace_back(newEntry);
+            insertEntry(std::move(newEntry));
         }
         else
         {
@@ -16,6 +16,9 @@
 #include "Circuit.hpp"
 #include "IRProvider.hpp"
 #include <Eigen/Dense>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
 
 namespace xacc {
 class Optimizer;    
@@ -62,8 +65,12 @@ private:
     // this cache can be reused directly.
     // (2) The instantiation is just direct linear algebra calculation
     // and hence is super fast.  
+    // A cache file is loaded once per process, all the QFAST instances
+    // (possibly expanding concurrently) share its cache.
     struct DecomposedResultCache
     {
+        // The cache of a file
+        static std::shared_ptr<DecomposedResultCache> get(const std::string& in_filePath);
         // Initialize this cache with a file.
         bool initialize(const std::string& in_filePath);
         // Add a QFAST decomposed result to the cache.
@@ -76,6 +83,10 @@ private:
         
         // Json serialization:
         std::string toJson() const; 
+
+        // Hash of the unitary up to a global phase:
+        // the phase of its first large entry is removed and the entries are quantized.
+        static uint64_t canonicalKey(const Eigen::MatrixXcd& in_unitary);
     private:
         bool fromJsonString(const std::string& in_jsonString);
     
@@ -87,8 +98,16 @@ private:
             std::string toJson() const; 
             bool fromJsonString(const std::string& in_jsonString);
         };
+        // Requires mutex to be held.
+        const CacheEntry* findEntry(const Eigen::MatrixXcd& in_unitary) const;
+        void insertEntry(CacheEntry&& in_entry);
+        std::string toJsonUnlocked() const;
+
         std::vector<CacheEntry> cache;
+        // Canonical key -> index in cache
+        std::unordered_multimap<uint64_t, size_t> index;
         std::string fileName;
+        mutable std::mutex mutex;
     };
 
     struct PauliReps 
@@ -219,7 +238,15 @@ private:
     // Returns true if the target trace distance can be met.
     // The depth is determined by the io_repsToOpt vector,
     // optimization results are updated in-place.
+    // With several starts, the others begin from random locations
+    // and run concurrently, until one meets the target.
     bool optimizeAtDepth(std::vector<PauliReps>& io_repsToOpt, double in_targetDistance) const;
+    // One start: returns the trace distance after fixing the locations.
+    // Aborted (i.e. returns early) once in_stop is set.
+    double optimizeStart(std::vector<PauliReps>& io_repsToOpt, double in_targetDistance, std::shared_ptr<Optimizer> in_optimizer, const std::atomic<bool>* in_stop) const;
+    // The optimizer to configure for a run: a clone of the selected one
+    // if it can be cloned (so that concurrent runs don't share options).
+    std::shared_ptr<Optimizer> getOptimizerInstance() const;
 
     // Compute the Pauli Rep. of a layer to unitary matrix
     Eigen::MatrixXcd layerToUnitaryMatrix(const PauliReps& in_layer, const Topology& in_layerTopology, const TopologyPaulis& in_topologyPaulis) const;
@@ -232,8 +259,10 @@ private:
     // Explore phase distance limit:
     double m_exploreTraceDistanceLimit;
     std::shared_ptr<LocationModel> m_locationModel;
-    DecomposedResultCache m_cache;
+    std::shared_ptr<DecomposedResultCache> m_cache;
     std::shared_ptr<Optimizer> m_optimizer;
+    // Number of starts of the explore optimizations
+    size_t m_nbStarts;
 };
 } // namespace circuits
 } // namespace xacc
\ No newline at end of file
@@ -116,6 +116,42 @@ TEST(QFastTester, checkSimple)
   }
 }
 
+TEST(QFastTester, checkCacheUpToPhase) 
+{
+  // A CNOT (permutation) on 3 qubits
+  Eigen::MatrixXcd cnotMat = Eigen::MatrixXcd::Identity(8, 8);
+  for (int i = 4; i < 6; ++i)
+  {
+    cnotMat(2 * i - 4, 2 * i - 4) = 0.0;
+    cnotMat(2 * i - 3, 2 * i - 3) = 0.0;
+    cnotMat(2 * i - 4, 2 * i - 3) = 1.0;
+    cnotMat(2 * i - 3, 2 * i - 4) = 1.0;
+  }
+  const std::string cacheFile = "qfast_test_" + std::to_string(time(0)) + ".cache";
+  
+  auto qfast = std::dynamic_pointer_cast<quantum::Circuit>(xacc::getService<Instruction>("QFAST"));
+  EXPECT_TRUE(qfast->expand({ 
+    std::make_pair("unitary", cnotMat),
+    std::make_pair("cache-file-name", cacheFile),
+    std::make_pair("nb-starts", 2)
+  }));
+
+  // Same up to a global phase: a cache hit, i.e. the same circuit.
+  const Eigen::MatrixXcd phasedMat = std::exp(std::complex<double>(0.0, 0.7)) * cnotMat;
+  auto qfastPhased = std::dynamic_pointer_cast<quantum::Circuit>(xacc::getService<Instruction>("QFAST"));
+  EXPECT_TRUE(qfastPhased->expand({ 
+    std::make_pair("unitary", phasedMat),
+    std::make_pair("cache-file-name", cacheFile),
+    std::make_pair("nb-starts", 2)
+  }));
+  ASSERT_EQ(qfast->nInstructions(), qfastPhased->nInstructions());
+  for (size_t i = 0; i < qfast->nInstructions(); ++i)
+  {
+    EXPECT_EQ(qfast->getInstruction(i)->name(), qfastPhased->getInstruction(i)->name());
+    EXPECT_EQ(qfast->getInstruction(i)->bits(), qfastPhased->getInstruction(i)->bits());
+  }
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize(argc, argv);
   ::testing::InitGoogleTest(&argc, argv);
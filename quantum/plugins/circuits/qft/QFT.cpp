@@ -13,6 +13,7 @@
 #include "QFT.hpp"
 #include "xacc.hpp"
 #include "xacc_service.hpp"
+#include <cmath>
 
 namespace xacc {
 
@@ -47,6 +48,14 @@ bool QFT::expand(const xacc::HeterogeneousMap &runtimeOptions) {
     xacc::error("Invalid QFT runtimeOptions:\n" + ss.str());
   }
 
+  // Approximate QFT: the controlled rotations by pi / 2^k are dropped when
+  // k > "approximation-degree" or when below "rotation-cutoff".
+  const int degree = runtimeOptions.get_or_default("approximation-degree", -1);
+  const double cutoff = runtimeOptions.get_or_default("rotation-cutoff", 0.0);
+  const auto keepRotation = [&](int k, double angle) {
+    return (degree < 0 || k <= degree) && std::abs(angle) >= cutoff;
+  };
+
   auto gateRegistry = xacc::getService<IRProvider>("quantum");
 
   auto bitReversal = [&](std::vector<std::size_t> qubits)
@@ -91,6 +100,10 @@ bool QFT::expand(const xacc::HeterogeneousMap &runtimeOptions) {
       for (int i = n - 1; i > 0; --i) {
         auto q_idx = qs[idx];
         auto angle = 3.1415926 / std::pow(2, n - i);
+        if (!keepRotation(n - i, angle)) {
+          idx++;
+          continue;
+        }
         InstructionParameter p(angle);
         auto cp = gateRegistry->createInstruction(
             "CPhase", std::vector<std::size_t>{q, q_idx});
@@ -124,11 +137,42 @@ bool QFT::expand(const xacc::HeterogeneousMap &runtimeOptions) {
     qubits.push_back(i);
   }
 
-  auto qftInstructions = coreqft(qubits);
+  // Linear nearest-neighbour variant: each qubit is swapped along the chain
+  // after its rotations, which leaves the output in the bit-reversed order
+  // the swap network would produce.
+  auto lnnqft = [&](std::vector<std::size_t> &qubits)
+      -> std::vector<std::shared_ptr<Instruction>> {
+    std::vector<std::shared_ptr<Instruction>> insts;
+    const auto n = qubits.size();
+    // The chain starts from the last qubit
+    const auto at = [&](std::size_t pos) { return qubits[n - 1 - pos]; };
+    for (std::size_t k = 0; k < n; ++k) {
+      insts.push_back(
+          gateRegistry->createInstruction("H", std::vector<std::size_t>{at(0)}));
+      for (std::size_t j = 1; j < n - k; ++j) {
+        auto angle = 3.1415926 / std::pow(2, j);
+        if (keepRotation(j, angle)) {
+          auto cp = gateRegistry->createInstruction(
+              "CPhase", std::vector<std::size_t>{at(j - 1), at(j)});
+          cp->setParameter(0, InstructionParameter(angle));
+          insts.push_back(cp);
+        }
+        insts.push_back(gateRegistry->createInstruction(
+            "Swap", std::vector<std::size_t>{at(j - 1), at(j)}));
+      }
+    }
+    return insts;
+  };
 
-  auto swaps = bitReversal(qubits);
-  for (auto s : swaps) {
-    qftInstructions.push_back(s);
+  std::vector<std::shared_ptr<Instruction>> qftInstructions;
+  if (runtimeOptions.get_or_default("lnn", false)) {
+    qftInstructions = lnnqft(qubits);
+  } else {
+    qftInstructions = coreqft(qubits);
+    auto swaps = bitReversal(qubits);
+    for (auto s : swaps) {
+      qftInstructions.push_back(s);
+    }
   }
 
   for (auto i : qftInstructions) {
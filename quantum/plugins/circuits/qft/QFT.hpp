@@ -19,6 +19,14 @@
 namespace xacc {
 namespace circuits {
 
+// Quantum Fourier transform on the qubits [start, end) (or [0, nq)).
+// Options:
+//   "approximation-degree" k: only the controlled rotations by pi / 2^j,
+//                          j <= k, are kept (default: all),
+//   "rotation-cutoff"      the rotations with a smaller angle are dropped,
+//   "lnn"                  (default false) nearest-neighbour gates only: the
+//                          qubits are swapped along the chain instead of
+//                          the final bit-reversal swaps.
 class QFT : public xacc::quantum::Circuit {
 public:
   QFT() : Circuit("qft") {}
@@ -20,7 +20,6 @@ using namespace xacc;
 
 TEST(QFTTester, checkCreation) {
 
-  xacc::Initialize();
   auto tmp = xacc::getService<Instruction>("qft");//std::make_shared<QFT>();
   auto qft = std::dynamic_pointer_cast<CompositeInstruction>(tmp);
 
@@ -46,10 +45,82 @@ TEST(QFTTester, checkCreation) {
 
 //   auto expectedIR = std::make_shared<GateIR>();
 //   expectedIR->addKernel(expectedF);
-  xacc::Finalize();
+}
+
+namespace {
+std::shared_ptr<CompositeInstruction> qft(const HeterogeneousMap &options) {
+  auto circuit = std::dynamic_pointer_cast<CompositeInstruction>(
+      xacc::getService<Instruction>("qft"));
+  EXPECT_TRUE(circuit->expand(options));
+  return circuit;
+}
+
+int count(std::shared_ptr<CompositeInstruction> circuit,
+          const std::string &gate) {
+  int result = 0;
+  for (auto &inst : circuit->getInstructions()) {
+    result += inst->name() == gate;
+  }
+  return result;
+}
+
+// The state of the QFT of a non-trivial input
+std::vector<std::complex<double>>
+transformed(std::shared_ptr<CompositeInstruction> circuit) {
+  auto provider = xacc::getIRProvider("quantum");
+  auto program = provider->createComposite("program");
+  program->addInstruction(provider->createInstruction("X", {0}));
+  program->addInstruction(provider->createInstruction("Ry", {2}, {0.7}));
+  program->addInstruction(provider->createInstruction("H", {3}));
+  program->addInstruction(provider->createInstruction("CNOT", {3, 4}));
+  program->addInstructions(circuit->getInstructions());
+  auto accelerator = xacc::getAccelerator("qpp");
+  auto buffer = xacc::qalloc(5);
+  accelerator->execute(buffer, program);
+  return *accelerator->getExecutionInfo<ExecutionInfo::WaveFuncPtrType>(
+      ExecutionInfo::WaveFuncKey);
+}
+
+double fidelity(const std::vector<std::complex<double>> &a,
+                const std::vector<std::complex<double>> &b) {
+  std::complex<double> overlap = 0.0;
+  for (size_t i = 0; i < a.size(); i++) {
+    overlap += std::conj(a[i]) * b[i];
+  }
+  return std::norm(overlap);
+}
+} // namespace
+
+TEST(QFTTester, checkApproximateAndLnn) {
+  auto exact = qft({{"nq", 5}});
+  EXPECT_EQ(10, count(exact, "CPhase"));
+  const auto expected = transformed(exact);
+
+  // Rotations by pi / 2^3 and pi / 2^4 dropped
+  auto approximate = qft({{"nq", 5}, {"approximation-degree", 2}});
+  EXPECT_EQ(7, count(approximate, "CPhase"));
+  EXPECT_EQ(7, count(qft({{"nq", 5}, {"rotation-cutoff", 0.5}}), "CPhase"));
+  EXPECT_GT(fidelity(expected, transformed(approximate)), 0.9);
+
+  auto lnn = qft({{"nq", 5}, {"lnn", true}});
+  EXPECT_EQ(10, count(lnn, "CPhase"));
+  for (auto &inst : lnn->getInstructions()) {
+    if (inst->bits().size() == 2) {
+      EXPECT_EQ(1, std::abs((int)inst->bits()[0] - (int)inst->bits()[1]));
+    }
+  }
+  EXPECT_NEAR(1.0, fidelity(expected, transformed(lnn)), 1e-9);
+  // The swaps are kept when approximated
+  auto lnnApproximate =
+      qft({{"nq", 5}, {"lnn", true}, {"approximation-degree", 2}});
+  EXPECT_EQ(7, count(lnnApproximate, "CPhase"));
+  EXPECT_EQ(count(lnn, "Swap"), count(lnnApproximate, "Swap"));
 }
 
 int main(int argc, char **argv) {
+  xacc::Initialize(argc, argv);
   ::testing::InitGoogleTest(&argc, argv);
-  return RUN_ALL_TESTS();
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
 }
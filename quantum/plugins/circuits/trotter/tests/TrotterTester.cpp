@@ -0,0 +1,105 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#include "xacc.hpp"
+#include <gtest/gtest.h>
+#include "Circuit.hpp"
+#include "InstructionIterator.hpp"
+#include "xacc_service.hpp"
+
+using namespace xacc;
+
+namespace {
+const std::string HAMILTONIAN = "0.5 X0 X1 + 0.3 Z0 + 0.2 Y1";
+
+std::shared_ptr<quantum::Circuit> generate(const std::string &name,
+                                           const HeterogeneousMap &options) {
+  auto circuit = std::dynamic_pointer_cast<quantum::Circuit>(
+      xacc::getService<Instruction>(name));
+  HeterogeneousMap params = options;
+  params.insert("pauli", HAMILTONIAN);
+  EXPECT_TRUE(circuit->expand(params));
+  return circuit;
+}
+
+std::vector<std::complex<double>>
+waveFunction(std::shared_ptr<CompositeInstruction> circuit) {
+  auto accelerator = xacc::getAccelerator("qpp");
+  auto buffer = xacc::qalloc(2);
+  accelerator->execute(buffer, circuit);
+  return *accelerator->getExecutionInfo<ExecutionInfo::WaveFuncPtrType>(
+      ExecutionInfo::WaveFuncKey);
+}
+
+double fidelity(const std::vector<std::complex<double>> &a,
+                const std::vector<std::complex<double>> &b) {
+  std::complex<double> overlap = 0.0;
+  for (size_t i = 0; i < a.size(); i++) {
+    overlap += std::conj(a[i]) * b[i];
+  }
+  return std::norm(overlap);
+}
+
+size_t nbGates(std::shared_ptr<CompositeInstruction> circuit) {
+  size_t count = 0;
+  InstructionIterator it(circuit);
+  while (it.hasNext()) {
+    count += !it.next()->isComposite();
+  }
+  return count;
+}
+} // namespace
+
+TEST(TrotterTester, checkSuzuki) {
+  auto reference =
+      generate("trotter", {{"time", 1.0}, {"order", 4}, {"steps", 20}});
+  // Shared steps
+  EXPECT_EQ(20, reference->nInstructions());
+  const auto expected = waveFunction(reference);
+
+  auto second = generate("trotter", {{"time", 1.0}, {"steps", 50}});
+  EXPECT_NEAR(1.0, fidelity(expected, waveFunction(second)), 1e-5);
+  // First order, copied steps
+  auto first = generate("trotter", {{"time", 1.0},
+                                   {"order", 1},
+                                   {"steps", 200},
+                                   {"shared-steps", false}});
+  EXPECT_EQ(nbGates(first), first->nInstructions());
+  EXPECT_NEAR(1.0, fidelity(expected, waveFunction(first)), 1e-3);
+
+  // Steps from the target error
+  auto bounded = generate("trotter", {{"time", 1.0}, {"error", 1e-3}});
+  EXPECT_GT(bounded->nInstructions(), 1);
+  EXPECT_NEAR(1.0, fidelity(expected, waveFunction(bounded)), 1e-3);
+}
+
+TEST(TrotterTester, checkQDrift) {
+  const auto expected = waveFunction(
+      generate("trotter", {{"time", 1.0}, {"order", 4}, {"steps", 20}}));
+  auto qdrift =
+      generate("qdrift", {{"time", 1.0}, {"samples", 10000}, {"seed", 7}});
+  EXPECT_EQ(10000, qdrift->nInstructions());
+  EXPECT_NEAR(1.0, fidelity(expected, waveFunction(qdrift)), 1e-2);
+
+  // Same seed, same circuit
+  auto again =
+      generate("qdrift", {{"time", 1.0}, {"samples", 10000}, {"seed", 7}});
+  EXPECT_EQ(qdrift->toString(), again->toString());
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize(argc, argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
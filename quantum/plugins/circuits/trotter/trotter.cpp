@@ -0,0 +1,278 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#include "trotter.hpp"
+#include "CommonGates.hpp"
+#include "FermionOperator.hpp"
+#include "InstructionIterator.hpp"
+#include "ObservableTransform.hpp"
+#include "PauliOperator.hpp"
+#include "xacc.hpp"
+#include "xacc_service.hpp"
+#include <cmath>
+#include <random>
+
+using namespace xacc::quantum;
+
+namespace {
+struct PauliTerm {
+  // (qubit, "X" / "Y" / "Z") by increasing qubit
+  std::vector<std::pair<std::size_t, std::string>> paulis;
+  double coeff;
+};
+
+// The non-identity terms of the Hamiltonian of the options, false if there
+// is none.
+bool hamiltonianTerms(const xacc::HeterogeneousMap &parameters,
+                      const std::string &generatorName,
+                      std::vector<PauliTerm> &out_terms) {
+  std::map<std::string, Term> terms;
+  const auto jw = [](std::shared_ptr<xacc::Observable> op) {
+    return std::dynamic_pointer_cast<PauliOperator>(
+               xacc::getService<xacc::ObservableTransform>("jw")->transform(op))
+        ->getTerms();
+  };
+  if (parameters.stringExists("pauli")) {
+    terms = PauliOperator(parameters.getString("pauli")).getTerms();
+  } else if (parameters.stringExists("fermion")) {
+    terms = jw(std::make_shared<FermionOperator>(
+        parameters.getString("fermion")));
+  } else if (parameters.pointerLikeExists<xacc::Observable>("observable")) {
+    auto observable =
+        parameters.getPointerLike<xacc::Observable>("observable");
+    if (auto pauli = dynamic_cast<PauliOperator *>(observable)) {
+      terms = pauli->getTerms();
+    } else if (dynamic_cast<FermionOperator *>(observable)) {
+      terms = jw(xacc::as_shared_ptr(observable));
+    } else {
+      xacc::error(generatorName +
+                  ": the observable must be a Pauli or fermion operator.");
+    }
+  } else {
+    return false;
+  }
+
+  out_terms.clear();
+  for (auto &kv : terms) {
+    auto term = kv.second;
+    if (std::abs(std::imag(term.coeff())) > 1e-12) {
+      xacc::error(generatorName + ": the Hamiltonian must be Hermitian (" +
+                  kv.first + " has a complex coefficient).");
+    }
+    PauliTerm pauliTerm;
+    pauliTerm.coeff = std::real(term.coeff());
+    for (auto &op : term.ops()) {
+      if (op.second != "I" && !op.second.empty()) {
+        pauliTerm.paulis.emplace_back(op.first, op.second);
+      }
+    }
+    // The identity only contributes a global phase
+    if (!pauliTerm.paulis.empty() && pauliTerm.coeff != 0.0) {
+      out_terms.emplace_back(std::move(pauliTerm));
+    }
+  }
+  return true;
+}
+
+double lambda(const std::vector<PauliTerm> &terms) {
+  double sum = 0.0;
+  for (auto &term : terms) {
+    sum += std::abs(term.coeff);
+  }
+  return sum;
+}
+
+// Appends exp(-i theta P): basis changes, CNOT ladder, Rz(2 theta) on the
+// last qubit, then the inverse ladder and basis changes.
+void addExponential(Circuit &block, const PauliTerm &term, double theta) {
+  const double pi = xacc::constants::pi;
+  const auto &paulis = term.paulis;
+  for (auto &[qubit, pauli] : paulis) {
+    if (pauli == "X") {
+      block.addInstruction(std::make_shared<Hadamard>(qubit));
+    } else if (pauli == "Y") {
+      block.addInstruction(std::make_shared<Rx>(qubit, pi / 2.0));
+    }
+  }
+  for (std::size_t i = 0; i + 1 < paulis.size(); i++) {
+    block.addInstruction(
+        std::make_shared<CNOT>(paulis[i].first, paulis[i + 1].first));
+  }
+  block.addInstruction(std::make_shared<Rz>(paulis.back().first, 2.0 * theta));
+  for (std::size_t i = paulis.size() - 1; i > 0; i--) {
+    block.addInstruction(
+        std::make_shared<CNOT>(paulis[i - 1].first, paulis[i].first));
+  }
+  for (auto &[qubit, pauli] : paulis) {
+    if (pauli == "X") {
+      block.addInstruction(std::make_shared<Hadamard>(qubit));
+    } else if (pauli == "Y") {
+      block.addInstruction(std::make_shared<Rx>(qubit, -pi / 2.0));
+    }
+  }
+}
+
+// The block itself if shared, a copy of its gates otherwise.
+void addBlock(Circuit &target, const std::shared_ptr<Circuit> &block,
+              bool shared) {
+  if (shared) {
+    target.addInstruction(block);
+    return;
+  }
+  xacc::InstructionIterator it(block);
+  while (it.hasNext()) {
+    auto inst = it.next();
+    if (!inst->isComposite()) {
+      target.addInstruction(inst->clone());
+    }
+  }
+}
+
+// S_order(dt), its repeated sub-formulas shared if requested.
+std::shared_ptr<Circuit> suzukiBlock(const std::vector<PauliTerm> &terms,
+                                     int order, double dt, bool shared) {
+  auto block = std::make_shared<Circuit>("suzuki_" + std::to_string(order));
+  if (order == 1) {
+    for (auto &term : terms) {
+      addExponential(*block, term, term.coeff * dt);
+    }
+  } else if (order == 2) {
+    // The two middle half-steps of the last term merged
+    for (std::size_t k = 0; k < terms.size(); k++) {
+      const double factor = k + 1 == terms.size() ? 1.0 : 0.5;
+      addExponential(*block, terms[k], factor * terms[k].coeff * dt);
+    }
+    for (std::size_t k = terms.size() - 1; k > 0; k--) {
+      addExponential(*block, terms[k - 1], 0.5 * terms[k - 1].coeff * dt);
+    }
+  } else {
+    const double p = 1.0 / (4.0 - std::pow(4.0, 1.0 / (order - 1)));
+    auto outer = suzukiBlock(terms, order - 2, p * dt, shared);
+    auto inner = suzukiBlock(terms, order - 2, (1.0 - 4.0 * p) * dt, shared);
+    addBlock(*block, outer, shared);
+    addBlock(*block, outer, shared);
+    addBlock(*block, inner, shared);
+    addBlock(*block, outer, shared);
+    addBlock(*block, outer, shared);
+  }
+  return block;
+}
+} // namespace
+
+namespace xacc {
+namespace circuits {
+const std::vector<std::string> Trotter::requiredKeys() {
+  return {"pauli", "time", "steps"};
+}
+
+bool Trotter::expand(const HeterogeneousMap &parameters) {
+  std::vector<PauliTerm> terms;
+  if (!hamiltonianTerms(parameters, name(), terms)) {
+    return false;
+  }
+
+  const double time = parameters.get_or_default("time", 1.0);
+  const int order = parameters.get_or_default("order", 2);
+  if (order != 1 && (order < 2 || order % 2)) {
+    xacc::error("trotter: invalid order " + std::to_string(order) +
+                ", must be 1 or even.");
+  }
+  int steps = 1;
+  if (parameters.keyExists<int>("steps")) {
+    steps = parameters.get<int>("steps");
+  } else if (parameters.keyExists<double>("error")) {
+    const double error = parameters.get<double>("error");
+    if (error <= 0.0) {
+      xacc::error("trotter: the target error must be positive.");
+    }
+    const double lt = lambda(terms) * std::abs(time);
+    const double bound =
+        order == 1 ? lt * lt / (2.0 * error)
+                   : std::pow(std::pow(2.0 * std::pow(5.0, order / 2 - 1) * lt,
+                                       order + 1) /
+                                  (3.0 * error),
+                              1.0 / order);
+    steps = std::max(1.0, std::ceil(bound));
+  }
+  if (steps < 1) {
+    xacc::error("trotter: the number of steps must be positive.");
+  }
+  if (terms.empty()) {
+    return true;
+  }
+
+  const bool shared = parameters.get_or_default("shared-steps", true);
+  auto step = suzukiBlock(terms, order, time / steps, shared);
+  for (int i = 0; i < steps; i++) {
+    addBlock(*this, step, shared);
+  }
+  return true;
+}
+
+const std::vector<std::string> QDrift::requiredKeys() {
+  return {"pauli", "time", "samples"};
+}
+
+bool QDrift::expand(const HeterogeneousMap &parameters) {
+  std::vector<PauliTerm> terms;
+  if (!hamiltonianTerms(parameters, name(), terms)) {
+    return false;
+  }
+  if (terms.empty()) {
+    return true;
+  }
+
+  const double time = parameters.get_or_default("time", 1.0);
+  const double totalWeight = lambda(terms);
+  int samples = 0;
+  if (parameters.keyExists<int>("samples")) {
+    samples = parameters.get<int>("samples");
+  } else {
+    const double error = parameters.get_or_default("error", 0.01);
+    if (error <= 0.0) {
+      xacc::error("qdrift: the target error must be positive.");
+    }
+    samples = std::max(
+        1.0, std::ceil(2.0 * std::pow(totalWeight * time, 2) / error));
+  }
+  if (samples < 1) {
+    xacc::error("qdrift: the number of samples must be positive.");
+  }
+
+  std::mt19937 rng(parameters.keyExists<int>("seed")
+                       ? parameters.get<int>("seed")
+                       : std::random_device()());
+  std::vector<double> weights;
+  for (auto &term : terms) {
+    weights.push_back(std::abs(term.coeff));
+  }
+  std::discrete_distribution<std::size_t> distribution(weights.begin(),
+                                                       weights.end());
+
+  // exp(-i sign(c_k) P_k Lambda t / N) of each term, built when first sampled
+  const bool shared = parameters.get_or_default("shared-steps", true);
+  const double theta = totalWeight * time / samples;
+  std::vector<std::shared_ptr<Circuit>> exponentials(terms.size());
+  for (int i = 0; i < samples; i++) {
+    const auto k = distribution(rng);
+    if (!exponentials[k]) {
+      exponentials[k] =
+          std::make_shared<Circuit>("qdrift_term_" + std::to_string(k));
+      addExponential(*exponentials[k], terms[k],
+                     terms[k].coeff > 0.0 ? theta : -theta);
+    }
+    addBlock(*this, exponentials[k], shared);
+  }
+  return true;
+}
+} // namespace circuits
+} // namespace xacc
@@ -0,0 +1,67 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_GENERATORS_TROTTER_HPP_
+#define XACC_GENERATORS_TROTTER_HPP_
+
+#include "Circuit.hpp"
+
+namespace xacc {
+namespace circuits {
+// Time evolution exp(-i H t) of a Hermitian H = sum_k c_k P_k, given as
+// "pauli" or "fermion" (Jordan-Wigner) strings or as an "observable", by a
+// Suzuki product formula: r steps of S_order(t / r), with
+//   S_1(dt)  = prod_k exp(-i c_k P_k dt),
+//   S_2(dt)  = prod_k exp(-i c_k P_k dt / 2) prod_k reversed (...),
+//   S_2j(dt) = S_2j-2(p dt)^2 S_2j-2((1 - 4p) dt) S_2j-2(p dt)^2,
+//              p = 1 / (4 - 4^(1 / (2j - 1))).
+// Options:
+//   "time"         t (default 1),
+//   "order"        1 or even (default 2),
+//   "steps"        r, or
+//   "error"        the target error, r from the (loose) triangle-inequality
+//                  bound with Lambda = sum_k |c_k|: (Lambda t)^2 / (2 r) for
+//                  the first order, (2 5^(j-1) Lambda t)^(2j+1) / (3 r^2j)
+//                  for the order 2j (default: one step),
+//   "shared-steps" (default true) the steps, and the repeated sub-formulas
+//                  of the higher orders, are the same sub-composite added
+//                  several times rather than copies: transformations that
+//                  modify the gates in place must be applied to a flattened
+//                  copy.
+class Trotter : public xacc::quantum::Circuit {
+public:
+  Trotter() : Circuit("trotter") {}
+  bool expand(const xacc::HeterogeneousMap &runtimeOptions) override;
+  const std::vector<std::string> requiredKeys() override;
+  DEFINE_CLONE(Trotter);
+};
+
+// qDRIFT (Campbell) randomized evolution of the same Hamiltonians: N
+// exponentials exp(-i sign(c_k) P_k Lambda t / N), each term sampled with
+// probability |c_k| / Lambda. Options:
+//   "time"         t (default 1),
+//   "samples"      N, or
+//   "error"        the target error, N = ceil(2 Lambda^2 t^2 / error)
+//                  (default: N = ceil(2 Lambda^2 t^2 / 0.01)),
+//   "seed"         of the sampling (random by default),
+//   "shared-steps" (default true) the exponentials of a term are the same
+//                  sub-composite, see Trotter.
+class QDrift : public xacc::quantum::Circuit {
+public:
+  QDrift() : Circuit("qdrift") {}
+  bool expand(const xacc::HeterogeneousMap &runtimeOptions) override;
+  const std::vector<std::string> requiredKeys() override;
+  DEFINE_CLONE(QDrift);
+};
+} // namespace circuits
+} // namespace xacc
+#endif
@@ -49,6 +49,32 @@ TEST(UCCSDTester,checkQubitPool) {
 	
 }
 
+TEST(UCCSDTester,checkCachedExpansionAndLadders) {
+  const auto countCNOTs = [](std::shared_ptr<CompositeInstruction> circuit) {
+    int count = 0;
+    for (auto &inst : circuit->getInstructions()) {
+      count += inst->name() == "CNOT";
+    }
+    return count;
+  };
+  auto uccsd = std::dynamic_pointer_cast<CompositeInstruction>(
+      xacc::getService<Instruction>("uccsd"));
+  EXPECT_TRUE(uccsd->expand({std::make_pair("ne", 2), std::make_pair("nq", 8)}));
+  // From the cached expansion
+  auto again = std::dynamic_pointer_cast<CompositeInstruction>(
+      xacc::getService<Instruction>("uccsd"));
+  EXPECT_TRUE(again->expand({std::make_pair("ne", 2), std::make_pair("nq", 8)}));
+  EXPECT_EQ(uccsd->toString(), again->toString());
+  EXPECT_EQ(uccsd->nVariables(), again->nVariables());
+
+  auto cancelled = std::dynamic_pointer_cast<CompositeInstruction>(
+      xacc::getService<Instruction>("uccsd"));
+  EXPECT_TRUE(cancelled->expand({std::make_pair("ne", 2),
+                                 std::make_pair("nq", 8),
+                                 std::make_pair("cancel-ladders", true)}));
+  EXPECT_EQ(uccsd->nVariables(), cancelled->nVariables());
+  EXPECT_LT(countCNOTs(cancelled), countCNOTs(uccsd));
+}
 
 int main(int argc, char** argv) {
     xacc::Initialize();
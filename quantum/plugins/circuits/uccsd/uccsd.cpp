@@ -20,10 +20,158 @@
 #include "xacc.hpp"
 #include "ObservableTransform.hpp"
 #include <memory>
+#include <mutex>
 #include <vector>
 
 using namespace xacc::quantum;
 
+namespace {
+// The JW Pauli terms of the UCCSD excitations, with the variables theta0,
+// theta1...
+std::map<std::string, Term> expandExcitations(int nQubits, int nElectrons) {
+  auto _nOccupied = (int)std::ceil(nElectrons / 2.0);
+  auto _nVirtual = nQubits / 2 - _nOccupied;
+  auto _nOrbitals = _nOccupied + _nVirtual;
+  auto nSingle = _nOccupied * _nVirtual;
+  auto nDouble = nSingle * (nSingle + 1) / 2;
+  auto _nParameters = nSingle + nDouble;
+
+  std::vector<std::string> params;
+  for (int i = 0; i < _nParameters; i++) {
+    params.push_back("theta" + std::to_string(i));
+  }
+
+  auto slice = [](const std::vector<std::string> &v, int start = 0,
+                  int end = -1) {
+    int oldlen = v.size();
+    int newlen;
+    if (end == -1 or end >= oldlen) {
+      newlen = oldlen - start;
+    } else {
+      newlen = end - start;
+    }
+    std::vector<std::string> nv(newlen);
+    for (int i = 0; i < newlen; i++) {
+      nv[i] = v[start + i];
+    }
+    return nv;
+  };
+  auto singleParams = slice(params, 0, nSingle);
+  auto doubleParams1 = slice(params, nSingle, 2 * nSingle);
+  auto doubleParams2 = slice(params, 2 * nSingle);
+  std::vector<std::function<int(int, int)>> fs{[](int i, int n) { return i; },
+                                          [](int i, int n) { return i + n; }};
+
+  using OpType = std::vector<std::pair<int, bool>>;
+  int count = 0;
+  FermionOperator myOp;
+  for (int i = 0; i < _nVirtual; i++) {
+    for (int j = 0; j < _nOccupied; j++) {
+      auto vs = _nOccupied + i;
+      auto os = j;
+      for (int s = 0; s < 2; s++) {
+        auto ti = fs[s];
+        auto oi = fs[1 - s];
+        auto vt = ti(vs, _nOrbitals);
+        auto vo = oi(vs, _nOrbitals);
+        auto ot = ti(os, _nOrbitals);
+        auto oo = oi(os, _nOrbitals);
+
+        OpType op1{{vt, 1}, {ot, 0}}, op2{{ot, 1}, {vt, 0}};
+        FermionOperator op(op1, 1.0, singleParams[count]);
+        FermionOperator opp(op2, -1., singleParams[count]);
+
+        OpType op3{{vt, 1}, {ot, 0}, {vo, 1}, {oo, 0}},
+            op4{{oo, 1}, {vo, 0}, {ot, 1}, {vt, 0}};
+        FermionOperator oppp(op3, -1., doubleParams1[count]);
+        FermionOperator opppp(op4, 1., doubleParams1[count]);
+
+        myOp += op + opp + oppp + opppp;
+      }
+      count++;
+    }
+  }
+
+  count = 0;
+  // routine for converting amplitudes for use by UCCSD
+  std::vector<std::tuple<int, int>> tupleVec;
+  for (int i = 0; i < _nVirtual; i++) {
+    for (int j = 0; j < _nOccupied; j++) {
+      tupleVec.push_back(std::make_tuple(i, j));
+    }
+  }
+  // Combination lambda used to determine indices
+  auto Combination = [=](std::vector<std::tuple<int, int>> t) {
+    std::vector<std::tuple<int, int, int, int>> comboVec;
+    for (int i = 0; i < t.size(); i++) {
+      for (int j = i + 1; j < t.size(); j++) {
+        const std::tuple<int, int, int, int> newTuple =
+            std::tuple_cat(t[i], t[j]);
+        comboVec.push_back(newTuple);
+      }
+    }
+    return comboVec;
+  };
+
+  auto combineVec = Combination(tupleVec);
+  for (auto i : combineVec) {
+    auto p = std::get<0>(i);
+    auto q = std::get<1>(i);
+    auto r = std::get<2>(i);
+    auto s = std::get<3>(i);
+
+    auto vs1 = _nOccupied + p;
+    auto os1 = q;
+    auto vs2 = _nOccupied + r;
+    auto os2 = s;
+
+    for (int sa = 0; sa < 2; sa++) {
+      for (int sb = 0; sb < 2; sb++) {
+        auto ia = fs[sa];
+        auto ib = fs[sb];
+
+        auto v1a = ia(vs1, _nOrbitals);
+        auto o1a = ia(os1, _nOrbitals);
+        auto v2b = ib(vs2, _nOrbitals);
+        auto o2b = ib(os2, _nOrbitals);
+
+        OpType op5{{v1a, 1}, {o1a, 0}, {v2b, 1}, {o2b, 0}},
+            op6{{o2b, 1}, {o1a, 0}, {v2b, 1}, {o2b, 0}};
+        FermionOperator op(op5, -1., doubleParams2[count]);
+        FermionOperator op2(op6, 1., doubleParams2[count]);
+        myOp += op + op2;
+      }
+    }
+    count++;
+  }
+
+  auto jw = xacc::getService<xacc::ObservableTransform>("jw");
+
+  auto compositeResult = jw->transform(
+      std::shared_ptr<xacc::Observable>(&myOp, [](xacc::Observable *) {}));
+
+  return std::dynamic_pointer_cast<PauliOperator>(compositeResult)->getTerms();
+}
+
+// Cached by (nq, ne), the only inputs of the expansion, e.g. for all the
+// geometries of a scan.
+std::map<std::string, Term> excitationTerms(int nQubits, int nElectrons) {
+  static std::mutex cacheMutex;
+  static std::map<std::pair<int, int>, std::map<std::string, Term>> cache;
+  {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto iter = cache.find({nQubits, nElectrons});
+    if (iter != cache.end()) {
+      return iter->second;
+    }
+  }
+  auto terms = expandExcitations(nQubits, nElectrons);
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  return cache.emplace(std::make_pair(nQubits, nElectrons), std::move(terms))
+      .first->second;
+}
+} // namespace
+
 namespace xacc {
 namespace circuits {
 
@@ -48,7 +196,6 @@ bool UCCSD::expand(const xacc::HeterogeneousMap &runtimeOptions) {
   auto _nOrbitals = _nOccupied + _nVirtual;
 
   std::map<std::string, Term> terms;
-  std::vector<xacc::InstructionParameter> variables;
 
   if (runtimeOptions.stringExists("pool")) {
 
@@ -86,248 +233,97 @@ bool UCCSD::expand(const xacc::HeterogeneousMap &runtimeOptions) {
     auto nSingle = _nOccupied * _nVirtual;
     auto nDouble = nSingle * (nSingle + 1) / 2;
     auto _nParameters = nSingle + nDouble;
-
-    std::vector<std::string> params;
-
-    if (variables.empty()) {
-      for (int i = 0; i < _nParameters; i++) {
-        params.push_back("theta" + std::to_string(i));
-        variables.push_back(InstructionParameter("theta" + std::to_string(i)));
-        addVariable("theta" + std::to_string(i));
-      }
-    } else {
-      for (int i = 0; i < _nParameters; i++) {
-        params.push_back(variables[i].as<std::string>());
-      }
+    for (int i = 0; i < _nParameters; i++) {
+      addVariable("theta" + std::to_string(i));
     }
+    terms = excitationTerms(nQubits, nElectrons);
+  }
 
-    auto slice = [](const std::vector<std::string> &v, int start = 0,
-                    int end = -1) {
-      int oldlen = v.size();
-      int newlen;
-      if (end == -1 or end >= oldlen) {
-        newlen = oldlen - start;
-      } else {
-        newlen = end - start;
-      }
-      std::vector<std::string> nv(newlen);
-      for (int i = 0; i < newlen; i++) {
-        nv[i] = v[start + i];
-      }
-      return nv;
-    };
-    auto singleParams = slice(params, 0, nSingle);
-    auto doubleParams1 = slice(params, nSingle, 2 * nSingle);
-    auto doubleParams2 = slice(params, 2 * nSingle);
-    std::vector<std::function<int(int, int)>> fs{[](int i, int n) { return i; },
-                                            [](int i, int n) { return i + n; }};
-
-    using OpType = std::vector<std::pair<int, bool>>;
-    int count = 0;
-    std::stringstream fOpSS;
-    FermionOperator myOp;
-    for (int i = 0; i < _nVirtual; i++) {
-      for (int j = 0; j < _nOccupied; j++) {
-        auto vs = _nOccupied + i;
-        auto os = j;
-        for (int s = 0; s < 2; s++) {
-          auto ti = fs[s];
-          auto oi = fs[1 - s];
-          auto vt = ti(vs, _nOrbitals);
-          auto vo = oi(vs, _nOrbitals);
-          auto ot = ti(os, _nOrbitals);
-          auto oo = oi(os, _nOrbitals);
-
-          OpType op1{{vt, 1}, {ot, 0}}, op2{{ot, 1}, {vt, 0}};
-          FermionOperator op(op1, 1.0, singleParams[count]);
-          FermionOperator opp(op2, -1., singleParams[count]);
-
-          OpType op3{{vt, 1}, {ot, 0}, {vo, 1}, {oo, 0}},
-              op4{{oo, 1}, {vo, 0}, {ot, 1}, {vt, 0}};
-          FermionOperator oppp(op3, -1., doubleParams1[count]);
-          FermionOperator opppp(op4, 1., doubleParams1[count]);
-
-          myOp += op + opp + oppp + opppp;
-        }
-        count++;
-      }
+  // With "cancel-ladders", the trailing ladder of a term and the leading
+  // ladder of the next one cancel on their common prefix of (qubit, Pauli):
+  // the basis changes of the prefix and the CNOTs between its qubits.
+  const bool cancelLadders = runtimeOptions.keyExists<bool>("cancel-ladders") &&
+                             runtimeOptions.get<bool>("cancel-ladders");
+  auto pi = xacc::constants::pi;
+  auto gateRegistry = xacc::getIRProvider("quantum");
+  const auto addBasisChange = [&](std::size_t qbitIdx,
+                                  const std::string &gateName, double sign) {
+    if (gateName == "X") {
+      addInstruction(gateRegistry->createInstruction(
+          "H", std::vector<std::size_t>{qbitIdx}));
+    } else if (gateName == "Y") {
+      auto rx = gateRegistry->createInstruction(
+          "Rx", std::vector<std::size_t>{qbitIdx});
+      InstructionParameter p(sign * (pi / 2.0));
+      rx->setParameter(0, p);
+      addInstruction(rx);
     }
-
-    count = 0;
-    // routine for converting amplitudes for use by UCCSD
-    std::vector<std::tuple<int, int>> tupleVec;
-    for (int i = 0; i < _nVirtual; i++) {
-      for (int j = 0; j < _nOccupied; j++) {
-        tupleVec.push_back(std::make_tuple(i, j));
+  };
+  const auto addCNOT = [&](std::size_t control, std::size_t target) {
+    addInstruction(gateRegistry->createInstruction(
+        "CNOT", std::vector<std::size_t>{control, target}));
+  };
+
+  // The trailing ladder of the previous term is held back until the next
+  // term is known.
+  std::vector<std::pair<int, std::string>> previous;
+  const auto addTrailingLadder = [&](std::size_t nbShared) {
+    for (int i = (int)previous.size() - 2; i >= 0; i--) {
+      if (i + 1 >= nbShared) {
+        addCNOT(previous[i].first, previous[i + 1].first);
       }
     }
-    // Combination lambda used to determine indices
-    auto Combination = [=](std::vector<std::tuple<int, int>> t) {
-      std::vector<std::tuple<int, int, int, int>> comboVec;
-      for (int i = 0; i < t.size(); i++) {
-        for (int j = i + 1; j < t.size(); j++) {
-          const std::tuple<int, int, int, int> newTuple =
-              std::tuple_cat(t[i], t[j]);
-          comboVec.push_back(newTuple);
-        }
-      }
-      return comboVec;
-    };
-
-    auto combineVec = Combination(tupleVec);
-    for (auto i : combineVec) {
-      auto p = std::get<0>(i);
-      auto q = std::get<1>(i);
-      auto r = std::get<2>(i);
-      auto s = std::get<3>(i);
-
-      auto vs1 = _nOccupied + p;
-      auto os1 = q;
-      auto vs2 = _nOccupied + r;
-      auto os2 = s;
-
-      for (int sa = 0; sa < 2; sa++) {
-        for (int sb = 0; sb < 2; sb++) {
-          auto ia = fs[sa];
-          auto ib = fs[sb];
-
-          auto v1a = ia(vs1, _nOrbitals);
-          auto o1a = ia(os1, _nOrbitals);
-          auto v2b = ib(vs2, _nOrbitals);
-          auto o2b = ib(os2, _nOrbitals);
-
-          OpType op5{{v1a, 1}, {o1a, 0}, {v2b, 1}, {o2b, 0}},
-              op6{{o2b, 1}, {o1a, 0}, {v2b, 1}, {o2b, 0}};
-          FermionOperator op(op5, -1., doubleParams2[count]);
-          FermionOperator op2(op6, 1., doubleParams2[count]);
-          myOp += op + op2;
-        }
-      }
-      count++;
+    for (int i = (int)previous.size() - 1; i >= (int)nbShared; i--) {
+      addBasisChange(previous[i].first, previous[i].second, -1.0);
     }
+  };
 
-    auto jw = xacc::getService<ObservableTransform>("jw");
-
-    auto compositeResult =
-        jw->transform(std::shared_ptr<Observable>(&myOp, [](Observable *) {}));
-
-    terms = std::dynamic_pointer_cast<PauliOperator>(compositeResult)->getTerms();
-
-  }
-
-  auto pi = xacc::constants::pi;
-int co = 0;
-  auto gateRegistry = xacc::getIRProvider("quantum");
-  for (auto inst : terms) {
-
-    // for (auto inst : s) {
+  for (auto &inst : terms) {
     Term spinInst = inst.second;
 
-    // Get the individual pauli terms
-    auto termsMap = std::get<2>(spinInst);
-
-    std::vector<std::pair<int, std::string>> terms;
-    for (auto &kv : termsMap) {
+    // Get the individual pauli terms, by increasing qubit index
+    std::vector<std::pair<int, std::string>> paulis;
+    for (auto &kv : spinInst.ops()) {
       if (kv.second != "I" && !kv.second.empty()) {
-        terms.push_back({kv.first, kv.second});
+        paulis.push_back({kv.first, kv.second});
       }
     }
-    // The largest qubit index is on the last term
-    int largestQbitIdx = terms[terms.size() - 1].first;
-    auto tempFunction = gateRegistry->createComposite("temp", {spinInst.var()});
-
-    for (int i = 0; i < terms.size(); i++) {
-
-      std::size_t qbitIdx = terms[i].first;
-      auto gateName = terms[i].second;
-
-      if (i < terms.size() - 1) {
-        std::size_t tmp = terms[i + 1].first;
-        auto cnot = gateRegistry->createInstruction(
-            "CNOT", std::vector<std::size_t>{qbitIdx, tmp});
-        tempFunction->addInstruction(cnot);
-      }
-
-      if (gateName == "X") {
-        auto hadamard = gateRegistry->createInstruction(
-            "H", std::vector<std::size_t>{qbitIdx});
-        tempFunction->insertInstruction(0, hadamard);
-      } else if (gateName == "Y") {
-
-        auto rx = gateRegistry->createInstruction(
-            "Rx", std::vector<std::size_t>{qbitIdx});
-        InstructionParameter p(pi / 2.0);
-        rx->setParameter(0, p);
-
-        // this is necessary for the qubit pool
-        // which has single Y terms
-        if(tempFunction->nInstructions() == 0){
-          tempFunction->addInstruction(rx);
-        } else {
-          tempFunction->insertInstruction(0, rx);
-        }
-
-      }
-
-      // Add the Rotation for the last term
-      if (i == terms.size() - 1) {
-        // FIXME DONT FORGET DIVIDE BY 2
-        std::stringstream ss;
-        ss << 2 * std::imag(std::get<0>(spinInst)) << " * "
-           << std::get<1>(spinInst);
-        auto rz = gateRegistry->createInstruction(
-            "Rz", std::vector<std::size_t>{qbitIdx});
-
-        InstructionParameter p(ss.str());
-        rz->setParameter(0, p);
-        tempFunction->addInstruction(rz);
-      }
-
+    if (paulis.empty()) {
+      // Global phase
+      continue;
     }
 
-    int counter = tempFunction->nInstructions();
-
-    // Add the instruction on the backend of the circuit
-
-    for (int i = terms.size() - 1; i >= 0; i--) {
-
-      std::size_t qbitIdx = terms[i].first;
-      auto gateName = terms[i].second;
-
-      if (i < terms.size() - 1) {
-        std::size_t tmp = terms[i + 1].first;
-        auto cnot = gateRegistry->createInstruction(
-            "CNOT", std::vector<std::size_t>{qbitIdx, tmp});
-
-        // this is necessary for the qubit pool 
-        if(counter == tempFunction->nInstructions()){
-          tempFunction->addInstruction(cnot);
-        } else {
-          tempFunction->insertInstruction(counter, cnot);
-        }
-        counter++;
-      }
-
-      if (gateName == "X") {
-        auto hadamard = gateRegistry->createInstruction(
-            "H", std::vector<std::size_t>{qbitIdx});
-        tempFunction->addInstruction(hadamard);
-      } else if (gateName == "Y") {
-        auto rx = gateRegistry->createInstruction(
-            "Rx", std::vector<std::size_t>{qbitIdx});
-        InstructionParameter p(-1.0 * (pi / 2.0));
-        rx->setParameter(0, p);
-        tempFunction->addInstruction(rx);
+    std::size_t nbShared = 0;
+    if (cancelLadders) {
+      while (nbShared < paulis.size() && nbShared < previous.size() &&
+             paulis[nbShared] == previous[nbShared]) {
+        nbShared++;
       }
     }
+    addTrailingLadder(nbShared);
 
-    
-    // Add to the total UCCSD State Prep function
-    for (auto inst : tempFunction->getInstructions()) {
-      addInstruction(inst);
+    for (int i = (int)paulis.size() - 1; i >= (int)nbShared; i--) {
+      addBasisChange(paulis[i].first, paulis[i].second, 1.0);
+    }
+    for (int i = 0; i < (int)paulis.size() - 1; i++) {
+      if (i + 1 >= nbShared) {
+        addCNOT(paulis[i].first, paulis[i + 1].first);
+      }
     }
 
+    // The rotation on the last qubit
+    // FIXME DONT FORGET DIVIDE BY 2
+    std::stringstream ss;
+    ss << 2 * std::imag(spinInst.coeff()) << " * " << spinInst.var();
+    auto rz = gateRegistry->createInstruction(
+        "Rz", std::vector<std::size_t>{(std::size_t)paulis.back().first});
+    InstructionParameter p(ss.str());
+    rz->setParameter(0, p);
+    addInstruction(rz);
+
+    previous = std::move(paulis);
   }
+  addTrailingLadder(0);
 
   for (int i = (nElectrons / 2) - 1; i >= 0; i--) {
     std::size_t alpha = (std::size_t)i;
@@ -15,9 +15,26 @@
 #include "Utils.hpp"
 #include "xacc.hpp"
 #include <fstream>
+#include <mutex>
 #include <set>
 #include <Eigen/Dense>
 
+#define RAPIDJSON_HAS_STDSTRING 1
+
+#include "rapidjson/document.h"
+
+namespace {
+// Tensored calibrations (cluster matrices) by calibrationKey()
+std::mutex calibrationCacheMutex;
+std::map<std::string, std::vector<Eigen::MatrixXd>> clusterKernelCache;
+
+// Value (0 or 1) of a qubit in a bit string
+int bitOf(const std::string &bitString, int qubit, bool isLsb) {
+  return (isLsb ? bitString[qubit]
+                : bitString[bitString.size() - qubit - 1]) == '1';
+}
+} // namespace
+
 namespace xacc {
 namespace quantum {
 void AssignmentErrorKernelDecorator::initialize(
@@ -47,8 +64,220 @@ void AssignmentErrorKernelDecorator::initialize(
     std::cout<<"layout recieved"<<std::endl;
     
   }
+  if (params.keyExists<int>("cluster-size")) {
+    clusterSize = params.get<int>("cluster-size");
+    if (clusterSize < 1) {
+      xacc::error("Invalid 'cluster-size' " + std::to_string(clusterSize) +
+                  ", must be positive.");
+    }
+  }
+  calibrationCache.initialize(params);
+  // A new configuration needs a new calibration
+  clusterKernels.clear();
 } // initialize
 
+std::string AssignmentErrorKernelDecorator::calibrationKey(int num_bits) {
+  auto properties = decoratedAccelerator->getProperties();
+  if (!properties.stringExists("total-json")) {
+    return "";
+  }
+  rapidjson::Document d;
+  d.Parse(properties.getString("total-json"));
+  if (d.HasParseError() || !d.IsObject() || !d.HasMember("last_update_date") ||
+      !d["last_update_date"].IsString()) {
+    return "";
+  }
+  std::stringstream ss;
+  ss << name() << "|" << decoratedAccelerator->name() << "|";
+  if (d.HasMember("backend_name") && d["backend_name"].IsString()) {
+    ss << d["backend_name"].GetString();
+  }
+  ss << "|" << d["last_update_date"].GetString() << "|" << num_bits << "|";
+  if (multiplex) {
+    ss << "tensored-" << clusterSize << "|";
+  } else {
+    ss << "full|";
+  }
+  for (auto bit : layout) {
+    ss << bit << ",";
+  }
+  return ss.str();
+}
+
+void AssignmentErrorKernelDecorator::generateTensoredKernels(
+    std::shared_ptr<AcceleratorBuffer> buffer) {
+  const int num_bits = buffer->size();
+  const int k = std::min(clusterSize, num_bits);
+  const int nbClusters = (num_bits + k - 1) / k;
+
+  const auto key = calibrationKey(num_bits);
+  if (!key.empty()) {
+    std::lock_guard<std::mutex> lock(calibrationCacheMutex);
+    auto iter = clusterKernelCache.find(key);
+    if (iter != clusterKernelCache.end()) {
+      xacc::info("Using the cached readout calibration " + key);
+      clusterKernels = iter->second;
+      gen_kernel = false;
+      return;
+    }
+  }
+  std::vector<std::vector<double>> cached;
+  if (!key.empty() && calibrationCache.load(key, cached) &&
+      cached.size() == nbClusters) {
+    clusterKernels.clear();
+    for (int c = 0; c < nbClusters; c++) {
+      const int dim = 1 << std::min(k, num_bits - c * k);
+      if (cached[c].size() != dim * dim) {
+        clusterKernels.clear();
+        break;
+      }
+      clusterKernels.push_back(
+          Eigen::Map<Eigen::MatrixXd>(cached[c].data(), dim, dim));
+    }
+    if (!clusterKernels.empty()) {
+      std::lock_guard<std::mutex> lock(calibrationCacheMutex);
+      clusterKernelCache[key] = clusterKernels;
+      gen_kernel = false;
+      return;
+    }
+  }
+
+  // Circuit s prepares every cluster in its local state s,
+  // i.e. qubit c * k + b is flipped if the bit b of s is set.
+  auto provider = xacc::getIRProvider("quantum");
+  std::vector<std::shared_ptr<CompositeInstruction>> circuits;
+  for (int s = 0; s < (1 << k); s++) {
+    auto circuit = provider->createComposite("tensored_cal_" +
+                                             std::to_string(s));
+    for (int q = 0; q < num_bits; q++) {
+      if ((s >> (q % k)) & 1) {
+        circuit->addInstruction(provider->createInstruction("X", q));
+      }
+    }
+    for (int q = 0; q < num_bits; q++) {
+      circuit->addInstruction(provider->createInstruction("Measure", q));
+    }
+    if (!layout.empty()) {
+      circuit->mapBits(layout);
+    }
+    circuits.push_back(circuit);
+  }
+  xacc::info("Calibrating the readout errors with " +
+             std::to_string(circuits.size()) + " circuits.");
+  auto tmpBuffer = xacc::qalloc(num_bits);
+  decoratedAccelerator->execute(tmpBuffer, circuits);
+  auto buffers = tmpBuffer->getChildren();
+  if (buffers.size() != circuits.size()) {
+    xacc::error("Invalid readout calibration results.");
+  }
+
+  // Marginal distributions of each cluster
+  const bool isLsb =
+      decoratedAccelerator->getBitOrder() == Accelerator::BitOrder::LSB;
+  clusterKernels.clear();
+  for (int c = 0; c < nbClusters; c++) {
+    const int first = c * k;
+    const int size = std::min(k, num_bits - first);
+    Eigen::MatrixXd A = Eigen::MatrixXd::Zero(1 << size, 1 << size);
+    for (int s = 0; s < (1 << size); s++) {
+      double shots = 0.0;
+      for (auto &[bitString, count] : buffers[s]->getMeasurementCounts()) {
+        int observed = 0;
+        for (int b = 0; b < size; b++) {
+          observed |= bitOf(bitString, first + b, isLsb) << b;
+        }
+        A(observed, s) += count;
+        shots += count;
+      }
+      if (shots > 0.0) {
+        A.col(s) /= shots;
+      }
+    }
+    clusterKernels.push_back(A);
+  }
+
+  if (!key.empty()) {
+    std::vector<std::vector<double>> data;
+    for (auto &A : clusterKernels) {
+      data.emplace_back(A.data(), A.data() + A.size());
+    }
+    calibrationCache.save(key, data);
+    std::lock_guard<std::mutex> lock(calibrationCacheMutex);
+    clusterKernelCache[key] = clusterKernels;
+  }
+  gen_kernel = false;
+}
+
+void AssignmentErrorKernelDecorator::mitigateTensored(
+    std::shared_ptr<AcceleratorBuffer> buffer) {
+  auto counts = buffer->getMeasurementCounts();
+  if (counts.empty() || clusterKernels.empty()) {
+    return;
+  }
+  const int num_bits = buffer->size();
+  const int k = std::min(clusterSize, num_bits);
+  const bool isLsb =
+      decoratedAccelerator->getBitOrder() == Accelerator::BitOrder::LSB;
+
+  // The observed bit strings, as local states of each cluster
+  std::vector<std::string> bitStrings;
+  std::vector<std::vector<int>> localStates;
+  Eigen::VectorXd probs(counts.size());
+  int shots = 0;
+  for (auto &[bitString, count] : counts) {
+    std::vector<int> states(clusterKernels.size(), 0);
+    for (int q = 0; q < num_bits; q++) {
+      states[q / k] |= bitOf(bitString, q, isLsb) << (q % k);
+    }
+    probs(bitStrings.size()) = count;
+    bitStrings.push_back(bitString);
+    localStates.push_back(states);
+    shots += count;
+  }
+  probs /= shots;
+
+  // Assignment matrix restricted to the observed subspace, the columns are
+  // renormalized to account for the probability leaving it.
+  const int nbStates = bitStrings.size();
+  Eigen::MatrixXd M(nbStates, nbStates);
+  xacc::getTaskScheduler()->parallelFor(
+      0, nbStates, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t j = begin; j < end; j++) {
+          for (int i = 0; i < nbStates; i++) {
+            double value = 1.0;
+            for (int c = 0; c < clusterKernels.size(); c++) {
+              value *= clusterKernels[c](localStates[i][c], localStates[j][c]);
+            }
+            M(i, j) = value;
+          }
+          const double norm = M.col(j).sum();
+          if (norm > 0.0) {
+            M.col(j) /= norm;
+          }
+        }
+      });
+  Eigen::VectorXd EM_state = M.partialPivLu().solve(probs);
+
+  // "clip and renorm"
+  double total = 0.0;
+  for (int i = 0; i < nbStates; i++) {
+    EM_state(i) = std::max(EM_state(i), 0.0);
+    total += EM_state(i);
+  }
+  std::map<std::string, double> origCounts;
+  std::map<std::string, int> mitigatedCounts;
+  for (int i = 0; i < nbStates; i++) {
+    origCounts[bitStrings[i]] = counts[bitStrings[i]];
+    const int count =
+        total > 0.0 ? floor(shots * EM_state(i) / total + 0.5) : 0;
+    if (count > 0) {
+      mitigatedCounts[bitStrings[i]] = count;
+    }
+  }
+  buffer->setMeasurements(mitigatedCounts);
+  buffer->addExtraInfo("unmitigated-counts", origCounts);
+}
+
 void AssignmentErrorKernelDecorator::execute(
     std::shared_ptr<AcceleratorBuffer> buffer,
     const std::shared_ptr<CompositeInstruction> function) {
@@ -57,6 +286,14 @@ void AssignmentErrorKernelDecorator::execute(
   if (!layout.empty()) {
      function->mapBits(layout);
   }
+  if (multiplex) {
+    if (gen_kernel || clusterKernels.empty()) {
+      generateTensoredKernels(buffer);
+    }
+    decoratedAccelerator->execute(buffer, function);
+    mitigateTensored(buffer);
+    return;
+  }
   // get the raw state
   decoratedAccelerator->execute(buffer, function);
   int shots = 0;
@@ -127,6 +364,21 @@ void AssignmentErrorKernelDecorator::execute(
     const std::shared_ptr<AcceleratorBuffer> buffer,
     const std::vector<std::shared_ptr<CompositeInstruction>> functions) {
   int num_bits = buffer->size();
+  if (multiplex) {
+    if (gen_kernel || clusterKernels.empty()) {
+      generateTensoredKernels(buffer);
+    }
+    if (!layout.empty()) {
+      for (auto &f : functions) {
+        f->mapBits(layout);
+      }
+    }
+    decoratedAccelerator->execute(buffer, functions);
+    for (auto &b : buffer->getChildren()) {
+      mitigateTensored(b);
+    }
+    return;
+  }
   if (gen_kernel) {
     if (decoratedAccelerator) {
       generateKernel(buffer);
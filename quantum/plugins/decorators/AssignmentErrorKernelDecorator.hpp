@@ -14,6 +14,7 @@
 #define XACC_ASSIGNMENTERRORKERNELDECORATOR_HPP_
 
 #include "AcceleratorDecorator.hpp"
+#include "CalibrationCache.hpp"
 #include <Eigen/Dense>
 #include "xacc.hpp"
 
@@ -21,13 +22,27 @@ namespace xacc {
 
 namespace quantum {
 
+// Readout error mitigation with assignment matrices. By default a full
+// 2^n x 2^n matrix is calibrated (2^n circuits) and its inverse is applied.
+// With "multiplex", the readout errors are assumed to be correlated only
+// within clusters of "cluster-size" consecutive qubits (default 1): the
+// matrix is a tensor product of 2^k x 2^k ones, all calibrated by the same
+// 2^k circuits, and the mitigated distribution is solved for on the
+// observed bit strings only. Calibrations are cached per backend and
+// calibration date ("last_update_date" of the properties), in process and
+// in the shared CalibrationCache file.
 class AssignmentErrorKernelDecorator : public AcceleratorDecorator {
 protected:
   bool gen_kernel;
   Eigen::MatrixXd errorKernel;
   std::vector<std::string> permutations = {""};
-  bool multiplex;
+  bool multiplex = false;
+  int clusterSize = 1;
+  // Tensored mode: the assignment matrix of each cluster,
+  // A(observed, prepared) in the cluster local bit order.
+  std::vector<Eigen::MatrixXd> clusterKernels;
   std::vector<std::size_t> layout;
+  CalibrationCache calibrationCache;
 
   std::vector<std::string> generatePermutations(int num_bits) {
     int pow_bits = std::pow(2, num_bits);
@@ -59,6 +74,17 @@ protected:
     int pow_bits = std::pow(2, num_bits);
     this->permutations = generatePermutations(num_bits);
 
+    const auto key = calibrationKey(num_bits);
+    std::vector<std::vector<double>> cached;
+    if (!key.empty() && calibrationCache.load(key, cached) &&
+        cached.size() == 1 && cached[0].size() == pow_bits * pow_bits) {
+      errorKernel =
+          Eigen::Map<Eigen::MatrixXd>(cached[0].data(), pow_bits, pow_bits);
+      buffer->addExtraInfo("error-kernel", cached[0]);
+      gen_kernel = false;
+      return;
+    }
+
     // permutations contains all possible permutationss to generate circuits,
     // there is direct mapping from permutations to circuit as follows:
     // permutations: 10 => X gate on zeroth qubit and nothing on first qubit and
@@ -124,15 +150,27 @@ protected:
     //std::cout << "INVERSE:\n" << errorKernel << "\n";
     std::vector<double> vec(errorKernel.data(), errorKernel.data() + errorKernel.rows()*errorKernel.cols());
     buffer->addExtraInfo("error-kernel", vec);
+    if (!key.empty()) {
+      calibrationCache.save(key, {vec});
+    }
 
     gen_kernel = false;
   }
 
+  // Calibration circuits and cluster matrices of the tensored mode
+  void generateTensoredKernels(std::shared_ptr<AcceleratorBuffer> buffer);
+  // Replaces the counts of buffer by the mitigated ones (tensored mode)
+  void mitigateTensored(std::shared_ptr<AcceleratorBuffer> buffer);
+  // Identifies the calibration, empty if the backend has no calibration date
+  std::string calibrationKey(int num_bits);
+
 public:
   AssignmentErrorKernelDecorator() = default;
   
   const std::vector<std::string> configurationKeys() override {
-    return {"gen-kernel"};
+    return {"gen-kernel",   "multiplex",
+            "cluster-size", "layout",
+            "calibration-cache-ttl", "calibration-cache-file"};
   }
 
   void initialize(const HeterogeneousMap &params = {}) override;
@@ -0,0 +1,160 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "CalibrationCache.hpp"
+
+#include "Utils.hpp"
+#include "json.hpp"
+#include "xacc.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+using json = nlohmann::json;
+
+int64_t now() {
+  return std::chrono::duration_cast<std::chrono::seconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// The cached entries, an empty object if the file is missing or invalid.
+json readCache(const std::string &in_fileName) {
+  std::ifstream stream(in_fileName);
+  if (!stream) {
+    return json::object();
+  }
+  std::stringstream ss;
+  ss << stream.rdbuf();
+  auto cache = json::parse(ss.str(), nullptr, false);
+  if (cache.is_discarded() || !cache.is_object()) {
+    return json::object();
+  }
+  return cache;
+}
+
+// Exclusive lock (for the lifetime of the object) of <file>.lock
+class CacheLock {
+public:
+  explicit CacheLock(const std::string &in_fileName) {
+    m_fd = open((in_fileName + ".lock").c_str(), O_RDWR | O_CREAT, 0644);
+    if (m_fd >= 0 && flock(m_fd, LOCK_EX) != 0) {
+      close(m_fd);
+      m_fd = -1;
+    }
+  }
+  ~CacheLock() {
+    if (m_fd >= 0) {
+      flock(m_fd, LOCK_UN);
+      close(m_fd);
+    }
+  }
+  bool locked() const { return m_fd >= 0; }
+
+private:
+  int m_fd = -1;
+};
+} // namespace
+
+namespace xacc {
+namespace quantum {
+CalibrationCache::CalibrationCache(int in_ttl, const std::string &in_fileName)
+    : m_ttl(in_ttl), m_fileName(in_fileName) {
+  if (m_fileName.empty()) {
+    const char *home = getenv("HOME");
+    m_fileName = std::string(home ? home : ".") +
+                 "/.xacc/calibration-cache.json";
+  }
+}
+
+void CalibrationCache::initialize(const HeterogeneousMap &in_params) {
+  if (in_params.keyExists<int>("calibration-cache-ttl")) {
+    m_ttl = in_params.get<int>("calibration-cache-ttl");
+  }
+  if (in_params.stringExists("calibration-cache-file")) {
+    m_fileName = in_params.getString("calibration-cache-file");
+  }
+}
+
+bool CalibrationCache::load(const std::string &in_key,
+                            std::vector<std::vector<double>> &out_data) const {
+  if (!enabled()) {
+    return false;
+  }
+  // The file is only ever replaced by a rename: no lock to read it.
+  const auto cache = readCache(m_fileName);
+  const auto iter = cache.find(in_key);
+  if (iter == cache.end() || !iter->count("saved") || !iter->count("data")) {
+    return false;
+  }
+  const auto age = now() - (*iter)["saved"].get<int64_t>();
+  if (age < 0 || age >= m_ttl) {
+    return false;
+  }
+  out_data = (*iter)["data"].get<std::vector<std::vector<double>>>();
+  xacc::info("Using the cached readout calibration " + in_key);
+  return true;
+}
+
+void CalibrationCache::save(
+    const std::string &in_key,
+    const std::vector<std::vector<double>> &in_data) const {
+  if (!enabled()) {
+    return;
+  }
+  const auto dir = m_fileName.substr(0, m_fileName.find_last_of('/'));
+  if (!dir.empty() && dir != m_fileName && !xacc::directoryExists(dir)) {
+    mkdir(dir.c_str(), S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH);
+  }
+
+  CacheLock lock(m_fileName);
+  if (!lock.locked()) {
+    xacc::warning("Could not lock the calibration cache " + m_fileName);
+    return;
+  }
+  // Drop the expired entries on the way
+  auto cache = readCache(m_fileName);
+  const auto time = now();
+  for (auto iter = cache.begin(); iter != cache.end();) {
+    if (!iter->is_object() || !iter->count("saved") ||
+        time - (*iter)["saved"].get<int64_t>() >= m_ttl) {
+      iter = cache.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+  cache[in_key] = {{"saved", time}, {"data", in_data}};
+
+  const auto tmpFileName = m_fileName + "." + std::to_string(getpid());
+  {
+    std::ofstream stream(tmpFileName);
+    stream << cache.dump();
+    if (!stream) {
+      xacc::warning("Could not write the calibration cache " + m_fileName);
+      return;
+    }
+  }
+  if (std::rename(tmpFileName.c_str(), m_fileName.c_str()) != 0) {
+    xacc::warning("Could not write the calibration cache " + m_fileName);
+    std::remove(tmpFileName.c_str());
+  }
+}
+} // namespace quantum
+} // namespace xacc
@@ -0,0 +1,53 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_CALIBRATIONCACHE_HPP_
+#define XACC_CALIBRATIONCACHE_HPP_
+
+#include "heterogeneous.hpp"
+
+#include <string>
+#include <vector>
+
+namespace xacc {
+namespace quantum {
+// Readout calibration data shared by the decorators (and processes), in a
+// JSON file ($HOME/.xacc/calibration-cache.json by default) keyed by the
+// calibration identity, e.g. accelerator, backend, calibration date and
+// qubit layout. Entries are valid for ttl seconds. Options:
+//   "calibration-cache-ttl"  (int) seconds, 0 disables the cache (3600),
+//   "calibration-cache-file" (string) the JSON file.
+// Updates hold an exclusive lock (flock on <file>.lock) and replace the file
+// by renaming a temporary one, so that readers never see a partial file.
+class CalibrationCache {
+public:
+  CalibrationCache(int in_ttl = 3600, const std::string &in_fileName = "");
+
+  // Updates the ttl and file from the decorator options
+  void initialize(const HeterogeneousMap &in_params);
+
+  bool enabled() const { return m_ttl > 0; }
+  // The cached data for that key, false if there are none or they expired.
+  bool load(const std::string &in_key,
+            std::vector<std::vector<double>> &out_data) const;
+  void save(const std::string &in_key,
+            const std::vector<std::vector<double>> &in_data) const;
+
+  const std::string &fileName() const { return m_fileName; }
+
+private:
+  int m_ttl;
+  std::string m_fileName;
+};
+} // namespace quantum
+} // namespace xacc
+#endif
@@ -15,6 +15,10 @@
 #include "ROErrorDecorator.hpp"
 #include "RichExtrapDecorator.hpp"
 #include "AssignmentErrorKernelDecorator.hpp"
+#include "ResultCacheDecorator.hpp"
+#include "PECDecorator.hpp"
+#include "SymmetryVerificationDecorator.hpp"
+#include "FederationDecorator.hpp"
 
 #include "cppmicroservices/BundleActivator.h"
 #include "cppmicroservices/BundleContext.h"
@@ -42,6 +46,10 @@ public:
 		auto c3 = std::make_shared<xacc::quantum::ROErrorDecorator>();
 		auto c4 = std::make_shared<xacc::quantum::RDMPurificationDecorator>();
         auto c5 = std::make_shared<xacc::quantum::AssignmentErrorKernelDecorator>();
+        auto c6 = std::make_shared<xacc::quantum::ResultCacheDecorator>();
+        auto c7 = std::make_shared<xacc::quantum::PECDecorator>();
+        auto c8 = std::make_shared<xacc::quantum::SymmetryVerificationDecorator>();
+        auto c9 = std::make_shared<xacc::quantum::FederationDecorator>();
 
 		context.RegisterService<xacc::AcceleratorDecorator>(c2);
         context.RegisterService<xacc::Accelerator>(c2);
@@ -58,6 +66,18 @@ public:
         context.RegisterService<xacc::AcceleratorDecorator>(c5);
         context.RegisterService<xacc::Accelerator>(c5);
 
+        context.RegisterService<xacc::AcceleratorDecorator>(c6);
+        context.RegisterService<xacc::Accelerator>(c6);
+
+        context.RegisterService<xacc::AcceleratorDecorator>(c7);
+        context.RegisterService<xacc::Accelerator>(c7);
+
+        context.RegisterService<xacc::AcceleratorDecorator>(c8);
+        context.RegisterService<xacc::Accelerator>(c8);
+
+        context.RegisterService<xacc::AcceleratorDecorator>(c9);
+        context.RegisterService<xacc::Accelerator>(c9);
+
 	}
 
 	/**
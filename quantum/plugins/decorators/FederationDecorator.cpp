@@ -0,0 +1,318 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "FederationDecorator.hpp"
+#include "Cloneable.hpp"
+#include "xacc.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <numeric>
+
+namespace {
+// Weight of the last job in the throughput estimates
+constexpr double SMOOTHING = 0.5;
+
+double elapsedMs(std::chrono::steady_clock::time_point in_start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - in_start)
+      .count();
+}
+} // namespace
+
+namespace xacc {
+namespace quantum {
+void FederationDecorator::initialize(const HeterogeneousMap &params) {
+  if (!decoratedAccelerator) {
+    xacc::error("Cannot run the FederationDecorator without a delegate "
+                "Accelerator.");
+  }
+  decoratedAccelerator->initialize(params);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_members.clear();
+  m_members.emplace_back(Member{decoratedAccelerator});
+  if (params.keyExists<std::vector<std::string>>("accelerators")) {
+    for (const auto &accName :
+         params.get<std::vector<std::string>>("accelerators")) {
+      auto acc = xacc::getAccelerator(accName, params);
+      const bool used =
+          std::any_of(m_members.begin(), m_members.end(),
+                      [&](const Member &m) { return m.accelerator == acc; });
+      if (used) {
+        // Concurrent jobs need their own instance.
+        auto cloneable =
+            std::dynamic_pointer_cast<xacc::Cloneable<Accelerator>>(acc);
+        if (!cloneable) {
+          xacc::error("FederationDecorator: " + accName +
+                      " is used twice and cannot be cloned.");
+        }
+        acc = cloneable->clone();
+        acc->initialize(params);
+      }
+      m_members.emplace_back(Member{acc});
+    }
+  }
+
+  if (params.keyExists<std::vector<double>>("throughputs")) {
+    const auto throughputs = params.get<std::vector<double>>("throughputs");
+    if (throughputs.size() != m_members.size()) {
+      xacc::error("FederationDecorator: expected one 'throughputs' entry per "
+                  "Accelerator (the decorated one first).");
+    }
+    for (size_t i = 0; i < throughputs.size(); ++i) {
+      if (throughputs[i] < 0.0) {
+        xacc::error("FederationDecorator: 'throughputs' must be positive.");
+      }
+      m_members[i].throughput = throughputs[i];
+    }
+  }
+  if (params.keyExists<std::vector<int>>("capacities")) {
+    const auto capacities = params.get<std::vector<int>>("capacities");
+    if (capacities.size() != m_members.size()) {
+      xacc::error("FederationDecorator: expected one 'capacities' entry per "
+                  "Accelerator (the decorated one first).");
+    }
+    for (size_t i = 0; i < capacities.size(); ++i) {
+      if (capacities[i] < 0) {
+        xacc::error("FederationDecorator: 'capacities' must be positive.");
+      }
+      m_members[i].capacity = capacities[i];
+    }
+  }
+}
+
+void FederationDecorator::updateConfiguration(const HeterogeneousMap &config) {
+  for (auto &acc : members()) {
+    acc->updateConfiguration(config);
+  }
+}
+
+const std::string FederationDecorator::getSignature() {
+  std::string signature = name() + ",";
+  const auto accs = members();
+  for (size_t i = 0; i < accs.size(); ++i) {
+    signature += (i > 0 ? "|" : "") + accs[i]->getSignature();
+  }
+  return signature;
+}
+
+std::vector<std::shared_ptr<Accelerator>> FederationDecorator::members() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::vector<std::shared_ptr<Accelerator>> accs;
+  for (const auto &member : m_members) {
+    accs.emplace_back(member.accelerator);
+  }
+  return accs;
+}
+
+std::vector<double> FederationDecorator::throughputs() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::vector<double> result;
+  for (const auto &member : m_members) {
+    result.emplace_back(member.throughput);
+  }
+  return result;
+}
+
+std::vector<double> FederationDecorator::estimates() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  double sum = 0.0;
+  size_t nbKnown = 0;
+  for (const auto &member : m_members) {
+    if (member.throughput > 0.0) {
+      sum += member.throughput;
+      ++nbKnown;
+    }
+  }
+  const double unknown = nbKnown > 0 ? sum / nbKnown : 1.0;
+  std::vector<double> result;
+  for (const auto &member : m_members) {
+    result.emplace_back(member.throughput > 0.0 ? member.throughput : unknown);
+  }
+  return result;
+}
+
+void FederationDecorator::updateThroughput(size_t in_member,
+                                           size_t in_nbCircuits,
+                                           double in_wallTimeMs) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto &member = m_members[in_member];
+  // The backend timing of the job if it reported it, e.g. without the
+  // download of the results of a remote job.
+  const auto metrics = member.accelerator->getLastExecutionMetrics();
+  double timeMs = in_wallTimeMs;
+  if (metrics.nbCircuits == in_nbCircuits && metrics.executionTimeMs > 0.0) {
+    timeMs = metrics.queueTimeMs + metrics.executionTimeMs;
+  }
+  if (timeMs <= 0.0) {
+    return;
+  }
+  const double measured = 1000.0 * in_nbCircuits / timeMs;
+  member.throughput =
+      member.throughput > 0.0
+          ? (1.0 - SMOOTHING) * member.throughput + SMOOTHING * measured
+          : measured;
+}
+
+std::vector<size_t>
+FederationDecorator::shares(size_t in_nbCircuits,
+                            const std::vector<double> &in_throughputs,
+                            const std::vector<size_t> &in_capacities) {
+  const size_t nbMembers = in_throughputs.size();
+  std::vector<size_t> result(nbMembers, 0);
+  // The capacities only bound the slices if they can hold all the circuits,
+  // otherwise the slices are submitted in several jobs anyway.
+  const bool bounded =
+      std::find(in_capacities.begin(), in_capacities.end(), 0) ==
+          in_capacities.end() &&
+      std::accumulate(in_capacities.begin(), in_capacities.end(), size_t{0}) >=
+          in_nbCircuits;
+  auto weights = in_throughputs;
+  std::vector<bool> active(nbMembers, true);
+  size_t remaining = in_nbCircuits;
+  for (;;) {
+    double sum = 0.0;
+    for (size_t i = 0; i < nbMembers; ++i) {
+      if (active[i]) {
+        sum += weights[i];
+      }
+    }
+    if (sum <= 0.0) {
+      // No estimate: even slices
+      for (size_t i = 0; i < nbMembers; ++i) {
+        weights[i] = active[i] ? 1.0 : 0.0;
+        sum += weights[i];
+      }
+    }
+    // Members saturated by their proportional share get their capacity.
+    bool saturated = false;
+    if (bounded) {
+      const size_t toAssign = remaining;
+      for (size_t i = 0; i < nbMembers; ++i) {
+        if (active[i] && toAssign * weights[i] / sum > in_capacities[i]) {
+          result[i] = in_capacities[i];
+          remaining -= in_capacities[i];
+          active[i] = false;
+          saturated = true;
+        }
+      }
+    }
+    if (saturated) {
+      continue;
+    }
+
+    // Largest remainders
+    std::vector<std::pair<double, size_t>> remainders;
+    size_t assigned = 0;
+    for (size_t i = 0; i < nbMembers; ++i) {
+      if (active[i]) {
+        const double ideal = remaining * weights[i] / sum;
+        result[i] = std::floor(ideal);
+        assigned += result[i];
+        remainders.emplace_back(result[i] - ideal, i);
+      }
+    }
+    std::stable_sort(remainders.begin(), remainders.end());
+    for (size_t k = 0; assigned < remaining; ++k, ++assigned) {
+      ++result[remainders[k % remainders.size()].second];
+    }
+    break;
+  }
+  return result;
+}
+
+void FederationDecorator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::shared_ptr<CompositeInstruction> function) {
+  const auto throughputs = estimates();
+  const size_t best =
+      std::max_element(throughputs.begin(), throughputs.end()) -
+      throughputs.begin();
+  auto acc = members()[best];
+  const auto start = std::chrono::steady_clock::now();
+  acc->execute(buffer, function);
+  updateThroughput(best, 1, elapsedMs(start));
+}
+
+void FederationDecorator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>> functions) {
+  if (functions.empty()) {
+    return;
+  }
+  const auto accs = members();
+  std::vector<size_t> capacities;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto &member : m_members) {
+      capacities.emplace_back(member.capacity);
+    }
+  }
+  const auto sizes = shares(functions.size(), estimates(), capacities);
+
+  // The jobs, in the order of the circuits: the slice of each member, in
+  // pieces of its capacity.
+  struct Job {
+    size_t member;
+    size_t round;
+    std::vector<std::shared_ptr<CompositeInstruction>> circuits;
+    std::shared_ptr<AcceleratorBuffer> results;
+  };
+  std::vector<Job> jobs;
+  size_t begin = 0, nbRounds = 0;
+  for (size_t i = 0; i < accs.size(); ++i) {
+    const size_t end = begin + sizes[i];
+    const size_t jobSize = capacities[i] > 0 ? capacities[i] : sizes[i];
+    for (size_t round = 0; begin < end; ++round, begin += jobSize) {
+      Job job{i, round};
+      job.circuits.assign(functions.begin() + begin,
+                          functions.begin() +
+                              std::min(end, begin + jobSize));
+      job.results = xacc::qalloc(buffer->size());
+      jobs.emplace_back(std::move(job));
+      nbRounds = std::max(nbRounds, round + 1);
+    }
+    begin = end;
+  }
+
+  // One job per member at a time, the members concurrently.
+  for (size_t round = 0; round < nbRounds; ++round) {
+    // The wall time of each job
+    std::vector<std::pair<Job *, std::future<double>>> running;
+    for (auto &job : jobs) {
+      if (job.round == round) {
+        auto acc = accs[job.member];
+        running.emplace_back(
+            &job, std::async(std::launch::async, [acc, &job]() {
+              const auto start = std::chrono::steady_clock::now();
+              acc->executeAsync(job.results, job.circuits).get();
+              return elapsedMs(start);
+            }));
+      }
+    }
+    for (auto &[job, future] : running) {
+      const double wallTimeMs = future.get();
+      updateThroughput(job->member, job->circuits.size(), wallTimeMs);
+    }
+  }
+
+  for (auto &job : jobs) {
+    for (auto &child : job.results->getChildren()) {
+      buffer->appendChild(child->name(), child);
+    }
+  }
+  buffer->addExtraInfo("federation-shares",
+                       std::vector<int>(sizes.begin(), sizes.end()));
+}
+} // namespace quantum
+} // namespace xacc
@@ -0,0 +1,89 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_FEDERATIONDECORATOR_HPP_
+#define XACC_FEDERATIONDECORATOR_HPP_
+
+#include "AcceleratorDecorator.hpp"
+#include <mutex>
+
+namespace xacc {
+
+namespace quantum {
+// Load-balances the circuits of an execution over several Accelerators (the
+// members: the decorated one and the "accelerators"), e.g. simulator nodes
+// and spare QPUs. Each member gets a contiguous slice of the circuits, in
+// proportion to its throughput estimate (circuits per second), executed
+// concurrently (executeAsync); the child buffers are appended in the order
+// of the circuits. The estimates are updated from the ExecutionMetrics of
+// each job. A single circuit runs on the member with the best estimate.
+// Options:
+//  - "accelerators" (vector<string>): the other members, an Accelerator
+//    used twice is cloned (e.g. two qpp instances).
+//  - "throughputs" (vector<double>): initial estimates of all the members
+//    (decorated first), default equal.
+//  - "capacities" (vector<int>): maximum number of circuits per job of each
+//    member, larger slices are submitted in several jobs (default: none).
+//    The slices are balanced within the capacities when possible.
+class FederationDecorator : public AcceleratorDecorator {
+public:
+  void initialize(const HeterogeneousMap &params = {}) override;
+  void updateConfiguration(const HeterogeneousMap &config) override;
+  const std::vector<std::string> configurationKeys() override {
+    return {"accelerators", "throughputs", "capacities"};
+  }
+  const std::string getSignature() override;
+
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::shared_ptr<CompositeInstruction> function) override;
+
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::vector<std::shared_ptr<CompositeInstruction>>
+                   functions) override;
+
+  const std::string name() const override { return "federation"; }
+  const std::string description() const override {
+    return "Load-balance circuit batches over several Accelerators.";
+  }
+
+  // The members, with the decorated Accelerator first
+  std::vector<std::shared_ptr<Accelerator>> members() const;
+  std::vector<double> throughputs() const;
+
+  // Slice sizes of in_nbCircuits circuits: proportional to the throughputs,
+  // within the capacities (0: unlimited) if their sum allows.
+  static std::vector<size_t> shares(size_t in_nbCircuits,
+                                    const std::vector<double> &in_throughputs,
+                                    const std::vector<size_t> &in_capacities);
+  ~FederationDecorator() override {}
+
+private:
+  struct Member {
+    std::shared_ptr<Accelerator> accelerator;
+    // Circuits per second, 0 if unknown
+    double throughput = 0.0;
+    // Circuits per job, 0 if unlimited
+    size_t capacity = 0;
+  };
+  // The throughputs, the unknown ones being the mean of the known ones
+  std::vector<double> estimates() const;
+  // Updates the estimate of a member from the metrics of its job
+  void updateThroughput(size_t in_member, size_t in_nbCircuits,
+                        double in_wallTimeMs);
+
+  std::vector<Member> m_members;
+  mutable std::mutex m_mutex;
+};
+
+} // namespace quantum
+} // namespace xacc
+#endif
@@ -13,6 +13,8 @@
 #include "ImprovedSamplingDecorator.hpp"
 #include "InstructionIterator.hpp"
 #include "xacc.hpp"
+#include <algorithm>
+#include <cmath>
 #include <numeric>
 
 namespace xacc {
@@ -60,6 +62,55 @@ void ImprovedSamplingDecorator::execute(
   return;
 }
 
+bool ImprovedSamplingDecorator::planStage(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>> &functions,
+    DecoratorStage &stage) {
+  if (!xacc::optionExists("sampler-n-execs")) {
+    xacc::error("Cannot find sampler-n-execs option. Skipping "
+                "ImprovedSamplingDecorator.");
+  }
+  const std::string allocation = xacc::optionExists("sampler-allocation")
+                                     ? xacc::getOption("sampler-allocation")
+                                     : "uniform";
+  if (allocation != "uniform" && allocation != "variance") {
+    xacc::error("Invalid sampler-allocation " + allocation +
+                ", valid values are uniform and variance.");
+  }
+  if (allocation == "variance") {
+    return false;
+  }
+
+  // All the runs of each function, one after the other. Accelerators may
+  // remap the circuits in place: the repeats are copies.
+  const int nRuns = std::max(1, std::stoi(xacc::getOption("sampler-n-execs")));
+  for (auto &f : functions) {
+    stage.circuits.push_back(f);
+    for (int i = 1; i < nRuns; i++) {
+      stage.circuits.push_back(
+          std::dynamic_pointer_cast<CompositeInstruction>(f->clone()));
+    }
+  }
+
+  stage.transform =
+      [nRuns](const std::vector<std::shared_ptr<AcceleratorBuffer>> &results) {
+        std::vector<std::shared_ptr<AcceleratorBuffer>> merged;
+        for (int i = 0; i < results.size(); i += nRuns) {
+          auto counts = results[i]->getMeasurementCounts();
+          for (int j = i + 1; j < i + nRuns; j++) {
+            for (auto &[bits, count] : results[j]->getMeasurementCounts()) {
+              counts[bits] += count;
+            }
+          }
+          results[i]->setMeasurements(counts);
+          results[i]->addExtraInfo("sampler-n-execs", nRuns);
+          merged.push_back(results[i]);
+        }
+        return merged;
+      };
+  return true;
+}
+
 void
 ImprovedSamplingDecorator::execute(
     std::shared_ptr<AcceleratorBuffer> buffer,
@@ -77,6 +128,11 @@ ImprovedSamplingDecorator::execute(
                 "ImprovedSamplingDecorator.");
   }
 
+  if (executePipeline(buffer, functions)) {
+    return;
+  }
+
+  // Variance allocation: the extra runs depend on a pilot run
   auto nRuns = std::stoi(xacc::getOption("sampler-n-execs"));
 
   auto tmpBuffer = xacc::qalloc(buffer->size());
@@ -88,13 +144,52 @@ ImprovedSamplingDecorator::execute(
     childrenCounts.insert({b->name(), b->getMeasurementCounts()});
   }
 
-  for (int i = 1; i < nRuns; i++) {
+  // Number of extra runs of each function: after this pilot run, the
+  // total of the uniform allocation split proportionally to |coeff| * sigma
+  // (optimal for the variance of the sum of the terms), where sigma^2 =
+  // 1 - <Z>^2 is the variance of the measured parity.
+  std::vector<int> extraRuns(functions.size(), nRuns - 1);
+  if (nRuns > 1 && buffers.size() == functions.size()) {
+    std::vector<double> weights;
+    for (int i = 0; i < functions.size(); i++) {
+      const double expVal = buffers[i]->getExpectationValueZ();
+      weights.push_back(std::abs(functions[i]->getCoefficient()) *
+                        std::sqrt(std::max(0.0, 1.0 - expVal * expVal)));
+    }
+    const double sumWeights =
+        std::accumulate(weights.begin(), weights.end(), 0.0);
+    if (sumWeights > 0.0) {
+      // Largest remainder rounding of the ideal allocation
+      const int totalExtraRuns = (nRuns - 1) * functions.size();
+      std::vector<std::pair<double, int>> remainders;
+      int allocated = 0;
+      for (int i = 0; i < functions.size(); i++) {
+        const double ideal = totalExtraRuns * weights[i] / sumWeights;
+        extraRuns[i] = std::floor(ideal);
+        allocated += extraRuns[i];
+        remainders.push_back({ideal - extraRuns[i], i});
+      }
+      std::sort(remainders.rbegin(), remainders.rend());
+      for (int k = 0; k < totalExtraRuns - allocated; k++) {
+        extraRuns[remainders[k].second]++;
+      }
+    }
+  }
+
+  // Round r executes the functions with at least r extra runs
+  const int nRounds = *std::max_element(extraRuns.begin(), extraRuns.end());
+  for (int r = 1; r <= nRounds; r++) {
+    std::vector<std::shared_ptr<CompositeInstruction>> roundFunctions;
+    for (int i = 0; i < functions.size(); i++) {
+      if (extraRuns[i] >= r) {
+        roundFunctions.push_back(functions[i]);
+      }
+    }
 
     auto tmpBuffer = xacc::qalloc(buffer->size());
-    decoratedAccelerator->execute(tmpBuffer, functions);
-    buffers = tmpBuffer->getChildren();
+    decoratedAccelerator->execute(tmpBuffer, roundFunctions);
 
-    for (auto &b : buffers) {
+    for (auto &b : tmpBuffer->getChildren()) {
       auto newCounts = b->getMeasurementCounts();
       childrenCounts[b->name()] =
           std::accumulate(childrenCounts[b->name()].begin(),
@@ -103,10 +198,16 @@ ImprovedSamplingDecorator::execute(
                              const std::pair<std::string, int> &p) {
                             return (m[p.first] += p.second, m);
                           });
+    }
+  }
 
-      b->setMeasurements(childrenCounts[b->name()]);
-      buffer->appendChild(b->name(), b);
+  for (int i = 0; i < buffers.size(); i++) {
+    auto &b = buffers[i];
+    b->setMeasurements(childrenCounts[b->name()]);
+    if (i < extraRuns.size()) {
+      b->addExtraInfo("sampler-n-execs", 1 + extraRuns[i]);
     }
+    buffer->appendChild(b->name(), b);
   }
 
   return;
@@ -19,6 +19,11 @@ namespace xacc {
 
 namespace quantum {
 
+// Executes the functions "sampler-n-execs" (global option) times and merges
+// the counts. With "sampler-allocation" set to "variance", a list of
+// functions (e.g. observed kernels) gets the same total number of runs,
+// but the runs after the first (pilot) one are distributed
+// proportionally to |kernel coefficient| * sigma of each function.
 class ImprovedSamplingDecorator : public AcceleratorDecorator {
 public:
  ImprovedSamplingDecorator() = default;
@@ -34,6 +39,12 @@ public:
   execute(std::shared_ptr<AcceleratorBuffer> buffer,
           const std::vector<std::shared_ptr<CompositeInstruction>> functions) override;
 
+  // Fusable with the uniform allocation
+  bool planStage(
+      std::shared_ptr<AcceleratorBuffer> buffer,
+      const std::vector<std::shared_ptr<CompositeInstruction>> &functions,
+      DecoratorStage &stage) override;
+
   const std::string name() const override { return "improved-sampling"; }
   const std::string description() const override { return ""; }
 
@@ -0,0 +1,351 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#include "PECDecorator.hpp"
+#include "Gate.hpp"
+#include "IRProvider.hpp"
+#include "InstructionIterator.hpp"
+#include "Utils.hpp"
+#include "xacc.hpp"
+#include "xacc_service.hpp"
+
+#include <cmath>
+#include <complex>
+#include <unordered_map>
+
+namespace {
+// Pauli strings on k qubits in the symplectic index x | z << k: qubit j is
+// X if only bit j of x is set, Z if only bit j of z is set, Y if both are.
+bool commute(int a, int b, int k) {
+  const int mask = (1 << k) - 1;
+  const int ax = a & mask, az = a >> k, bx = b & mask, bz = b >> k;
+  return ((__builtin_popcount(ax & bz) + __builtin_popcount(az & bx)) & 1) ==
+         0;
+}
+
+// Probabilities of the Pauli errors of the Pauli twirl of a Kraus channel,
+// p_P = sum_K |Tr(P K)|^2 / d^2.
+std::vector<double> pauliProbabilities(const xacc::NoiseChannelKraus &channel) {
+  const int k = channel.noise_qubits.size();
+  const int d = 1 << k;
+  // Bit of the matrix index of the j-th noise qubit
+  std::vector<int> position(k);
+  for (int j = 0; j < k; j++) {
+    position[j] = channel.bit_order == xacc::KrausMatBitOrder::LSB ? j : k - 1 - j;
+  }
+
+  std::vector<double> probs(d * d, 0.0);
+  for (int p = 0; p < d * d; p++) {
+    for (const auto &mat : channel.mats) {
+      // Tr(P^dag K): P has a single entry per row, <r|P|r ^ x>
+      std::complex<double> trace = 0.0;
+      for (int r = 0; r < d; r++) {
+        int c = r;
+        std::complex<double> element = 1.0;
+        for (int j = 0; j < k; j++) {
+          const bool x = (p >> j) & 1, z = (p >> (k + j)) & 1;
+          const bool rowBit = (r >> position[j]) & 1;
+          if (x) {
+            c ^= 1 << position[j];
+          }
+          if (x && z) {
+            // Y = [[0, -i], [i, 0]]
+            element *= rowBit ? std::complex<double>(0, 1)
+                              : std::complex<double>(0, -1);
+          } else if (z && rowBit) {
+            element *= -1.0;
+          }
+        }
+        trace += std::conj(element) * mat[r][c];
+      }
+      probs[p] += std::norm(trace) / (d * d);
+    }
+  }
+  return probs;
+}
+
+// Quasi-probabilities of the inverse of the Pauli channel: the channel has
+// eigenvalue f_Q = sum_P p_P (+1 if P, Q commute, -1 otherwise) on Pauli Q,
+// hence q_P = 4^-k sum_Q (+-1) / f_Q.
+std::vector<double> inverseQuasiProbabilities(const std::vector<double> &probs,
+                                              int k) {
+  const int n = probs.size();
+  std::vector<double> inverseEigenvalues(n);
+  for (int q = 0; q < n; q++) {
+    double f = 0.0;
+    for (int p = 0; p < n; p++) {
+      f += commute(p, q, k) ? probs[p] : -probs[p];
+    }
+    if (f < 1e-9) {
+      xacc::error("PEC - the noise channel is not invertible (Pauli "
+                  "eigenvalue " +
+                  std::to_string(f) + ").");
+    }
+    inverseEigenvalues[q] = 1.0 / f;
+  }
+  std::vector<double> quasiProbs(n, 0.0);
+  for (int p = 0; p < n; p++) {
+    for (int q = 0; q < n; q++) {
+      quasiProbs[p] +=
+          commute(p, q, k) ? inverseEigenvalues[q] : -inverseEigenvalues[q];
+    }
+    quasiProbs[p] /= n;
+  }
+  return quasiProbs;
+}
+} // namespace
+
+namespace xacc {
+namespace quantum {
+void PECDecorator::initialize(const HeterogeneousMap &params) {
+  if (params.pointerLikeExists<NoiseModel>("noise-model")) {
+    noiseModel =
+        xacc::as_shared_ptr(params.getPointerLike<NoiseModel>("noise-model"));
+  } else if (params.stringExists("backend")) {
+    noiseModel = xacc::getService<NoiseModel>("IBM");
+    noiseModel->initialize(params);
+  }
+  if (params.keyExists<int>("samples")) {
+    nbSamples = params.get<int>("samples");
+    if (nbSamples < 1) {
+      xacc::error("Invalid PEC samples " + std::to_string(nbSamples) +
+                  ", must be positive.");
+    }
+  }
+  rng.seed(params.keyExists<int>("seed") ? params.get<int>("seed")
+                                         : std::random_device{}());
+  templates.clear();
+}
+
+std::shared_ptr<PECDecorator::Template>
+PECDecorator::getTemplate(std::shared_ptr<CompositeInstruction> function) {
+  const auto hash = function->structuralHash();
+  auto iter = templates.find(hash);
+  if (iter != templates.end()) {
+    return iter->second;
+  }
+
+  auto provider = xacc::getService<IRProvider>("quantum");
+  auto result = std::make_shared<Template>();
+  // The slots of a gate only depend on its name, qubits and parameters
+  std::unordered_map<std::string, std::vector<Slot>> gateSlots;
+  InstructionIterator it(function);
+  while (it.hasNext()) {
+    auto nextInst = it.next();
+    if (nextInst->isComposite() || !nextInst->isEnabled()) {
+      continue;
+    }
+    result->gates.push_back(nextInst);
+    auto gate = std::dynamic_pointer_cast<Gate>(nextInst);
+    if (!gate || nextInst->name() == "Measure") {
+      continue;
+    }
+
+    const auto key = nextInst->toString();
+    auto slotsIter = gateSlots.find(key);
+    if (slotsIter == gateSlots.end()) {
+      auto channels = noiseModel->getNoiseChannels(*gate);
+      if (channels.empty()) {
+        // Depolarizing channel with the gate error probability
+        const double errorProb = noiseModel->gateErrorProb(*gate);
+        if (errorProb > 0.0) {
+          const auto bits = nextInst->bits();
+          const int k = bits.size();
+          const int d = 1 << k;
+          // Already a Pauli channel: e / (d^2 - 1) for each non-identity
+          Slot slot;
+          slot.qubits = bits;
+          std::vector<double> probs(d * d, errorProb / (d * d - 1));
+          probs[0] = 1.0 - errorProb;
+          slot.quasiProbs = inverseQuasiProbabilities(probs, k);
+          slotsIter = gateSlots.emplace(key, std::vector<Slot>{slot}).first;
+        } else {
+          slotsIter = gateSlots.emplace(key, std::vector<Slot>{}).first;
+        }
+      } else {
+        std::vector<Slot> slots;
+        for (const auto &channel : channels) {
+          Slot slot;
+          slot.qubits = channel.noise_qubits;
+          slot.quasiProbs = inverseQuasiProbabilities(
+              pauliProbabilities(channel), channel.noise_qubits.size());
+          slots.emplace_back(slot);
+        }
+        slotsIter = gateSlots.emplace(key, slots).first;
+      }
+    }
+
+    for (auto slot : slotsIter->second) {
+      double gamma = 0.0;
+      std::vector<double> weights;
+      for (auto q : slot.quasiProbs) {
+        gamma += std::abs(q);
+        weights.push_back(std::abs(q));
+      }
+      if (gamma - 1.0 < 1e-12) {
+        // Noiseless
+        continue;
+      }
+      slot.gateIdx = result->gates.size() - 1;
+      slot.sampler =
+          std::discrete_distribution<int>(weights.begin(), weights.end());
+      for (auto qubit : slot.qubits) {
+        std::array<InstPtr, 3> paulis;
+        const std::vector<std::string> names{"X", "Y", "Z"};
+        for (int op = 0; op < 3; op++) {
+          paulis[op] = provider->createInstruction(names[op], {qubit});
+          paulis[op]->setBufferNames({nextInst->getBufferName(0)});
+        }
+        slot.paulis.push_back(paulis);
+      }
+      result->gamma *= gamma;
+      result->slots.emplace_back(std::move(slot));
+    }
+  }
+
+  // Bounded: e.g. new parameters of each VQE iteration
+  if (templates.size() > 1024) {
+    templates.clear();
+  }
+  templates.emplace(hash, result);
+  return result;
+}
+
+bool PECDecorator::planStage(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>> &functions,
+    DecoratorStage &stage) {
+  if (!noiseModel) {
+    xacc::error("PEC - a noise-model or a backend is required.");
+  }
+  auto provider = xacc::getService<IRProvider>("quantum");
+
+  // The distinct instances of each function (first index in
+  // stage.circuits), with their sign and multiplicity.
+  std::vector<int> firstInstance(functions.size() + 1, 0);
+  std::vector<double> signs, multiplicities;
+  std::vector<double> gammas;
+  for (int i = 0; i < functions.size(); i++) {
+    auto tmpl = getTemplate(functions[i]);
+    gammas.push_back(tmpl->gamma);
+    firstInstance[i] = stage.circuits.size();
+
+    // Sample the Pauli of each slot, an instance is the string of the slot
+    // Pauli indices.
+    std::unordered_map<std::string, int> instanceIdx;
+    std::vector<std::string> instances;
+    std::string codes(tmpl->slots.size(), '\0');
+    for (int s = 0; s < nbSamples; s++) {
+      double sign = 1.0;
+      for (int j = 0; j < tmpl->slots.size(); j++) {
+        auto &slot = tmpl->slots[j];
+        const int code = slot.sampler(rng);
+        codes[j] = code;
+        if (slot.quasiProbs[code] < 0.0) {
+          sign = -sign;
+        }
+      }
+      auto iter = instanceIdx.find(codes);
+      if (iter == instanceIdx.end()) {
+        iter = instanceIdx.emplace(codes, instances.size()).first;
+        instances.push_back(codes);
+        signs.push_back(sign);
+        multiplicities.push_back(0.0);
+      }
+      multiplicities[firstInstance[i] + iter->second] += 1.0;
+    }
+
+    // Each distinct instance is written once: clones of the gates, with the
+    // sampled Paulis after the noisy ones (the identity adds nothing).
+    for (int n = 0; n < instances.size(); n++) {
+      std::vector<InstPtr> insts;
+      insts.reserve(tmpl->gates.size() + 2 * tmpl->slots.size());
+      int slotIdx = 0;
+      for (int g = 0; g < tmpl->gates.size(); g++) {
+        insts.push_back(tmpl->gates[g]->clone());
+        for (; slotIdx < tmpl->slots.size() &&
+               tmpl->slots[slotIdx].gateIdx == g;
+             slotIdx++) {
+          const auto &slot = tmpl->slots[slotIdx];
+          const int code = instances[n][slotIdx];
+          const int k = slot.qubits.size();
+          for (int j = 0; j < k; j++) {
+            const bool x = (code >> j) & 1, z = (code >> (k + j)) & 1;
+            if (x || z) {
+              insts.push_back(slot.paulis[j][x ? (z ? 1 : 0) : 2]->clone());
+            }
+          }
+        }
+      }
+      auto instance = provider->createComposite(
+          functions[i]->name() + "_pec_" + std::to_string(n),
+          functions[i]->getVariables());
+      instance->addInstructions(std::move(insts), false);
+      stage.circuits.push_back(instance);
+    }
+  }
+  firstInstance[functions.size()] = stage.circuits.size();
+
+  std::vector<std::string> names;
+  for (auto &f : functions) {
+    names.push_back(f->name());
+  }
+  const int nbBits = buffer->size();
+  const int samples = nbSamples;
+  stage.transform =
+      [names, firstInstance, signs, multiplicities, gammas, nbBits, samples](
+          const std::vector<std::shared_ptr<AcceleratorBuffer>> &results) {
+        std::vector<std::shared_ptr<AcceleratorBuffer>> estimates;
+        for (int i = 0; i < names.size(); i++) {
+          double sum = 0.0;
+          for (int n = firstInstance[i]; n < firstInstance[i + 1]; n++) {
+            sum += signs[n] * multiplicities[n] *
+                   results[n]->getExpectationValueZ();
+          }
+          auto result = std::make_shared<AcceleratorBuffer>(nbBits);
+          result->setName(names[i]);
+          result->addExtraInfo("exp-val-z", gammas[i] * sum / samples);
+          result->addExtraInfo("pec-gamma", gammas[i]);
+          result->addExtraInfo("pec-samples", samples);
+          result->addExtraInfo("pec-circuits",
+                               firstInstance[i + 1] - firstInstance[i]);
+          estimates.push_back(result);
+        }
+        return estimates;
+      };
+  return true;
+}
+
+void PECDecorator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::shared_ptr<CompositeInstruction> function) {
+  if (!decoratedAccelerator) {
+    xacc::error("PEC - Null Decorated Accelerator Error");
+  }
+  auto tmpBuffer = xacc::qalloc(buffer->size());
+  executePipeline(tmpBuffer, {function});
+  for (auto &[key, value] : tmpBuffer->getChildren()[0]->getInformation()) {
+    buffer->addExtraInfo(key, value);
+  }
+}
+
+void PECDecorator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>> functions) {
+  if (!decoratedAccelerator) {
+    xacc::error("PEC - Null Decorated Accelerator Error");
+  }
+  executePipeline(buffer, functions);
+}
+
+} // namespace quantum
+} // namespace xacc
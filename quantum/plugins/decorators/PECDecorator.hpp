@@ -0,0 +1,97 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_PECDECORATOR_HPP_
+#define XACC_PECDECORATOR_HPP_
+
+#include "AcceleratorDecorator.hpp"
+#include "NoiseModel.hpp"
+
+#include <array>
+#include <map>
+#include <random>
+
+namespace xacc {
+
+namespace quantum {
+
+// Probabilistic error cancellation.
+// The noise of each gate (the Kraus channels of a NoiseModel, or a
+// depolarizing channel with its gate error probability) is Pauli twirled
+// and inverted: the inverse is a quasi-probability mixture sum_P q_P P,
+// i.e. a Pauli P inserted after the gate with probability |q_P| / gamma and
+// sign sgn(q_P), gamma = sum_P |q_P|. Each function is estimated from
+// "samples" sign-weighted instances, <Z> = gamma * mean(sign * <Z>_instance)
+// (gamma of all the gates), and identical instances are executed once,
+// weighted by their multiplicity. Options:
+//   "noise-model"  the NoiseModel of the decorated accelerator, or
+//   "backend"      an IBM backend name (for the "IBM" noise model),
+//   "samples"      instances per function (default 1000),
+//   "seed"         of the instance sampler (random by default).
+// The result child of each function holds the mitigated "exp-val-z" (no
+// counts), "pec-gamma", "pec-samples" and "pec-circuits" (distinct
+// instances).
+class PECDecorator : public AcceleratorDecorator {
+protected:
+  std::shared_ptr<NoiseModel> noiseModel;
+  int nbSamples = 1000;
+  std::mt19937_64 rng;
+
+  // Pauli insertions after a noisy gate: Pauli strings on qubits, in the
+  // symplectic index x | z << k, with their quasi-probabilities.
+  struct Slot {
+    std::size_t gateIdx;
+    std::vector<std::size_t> qubits;
+    std::vector<double> quasiProbs;
+    std::discrete_distribution<int> sampler;
+    // X, Y and Z on each qubit, cloned into the instances
+    std::vector<std::array<InstPtr, 3>> paulis;
+  };
+  // A function, as the list of its gates and the slots after them
+  struct Template {
+    std::vector<InstPtr> gates;
+    std::vector<Slot> slots;
+    double gamma = 1.0;
+  };
+  // By structural hash
+  std::map<uint64_t, std::shared_ptr<Template>> templates;
+  std::shared_ptr<Template>
+  getTemplate(std::shared_ptr<CompositeInstruction> function);
+
+public:
+  void initialize(const HeterogeneousMap &params = {}) override;
+  const std::vector<std::string> configurationKeys() override {
+    return {"noise-model", "backend", "samples", "seed"};
+  }
+
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::shared_ptr<CompositeInstruction> function) override;
+  void
+  execute(std::shared_ptr<AcceleratorBuffer> buffer,
+          const std::vector<std::shared_ptr<CompositeInstruction>> functions) override;
+
+  // Fusable: the distinct instances of all the functions are executed
+  // together.
+  bool planStage(
+      std::shared_ptr<AcceleratorBuffer> buffer,
+      const std::vector<std::shared_ptr<CompositeInstruction>> &functions,
+      DecoratorStage &stage) override;
+
+  const std::string name() const override { return "pec"; }
+  const std::string description() const override { return ""; }
+
+  ~PECDecorator() override {}
+};
+
+} // namespace quantum
+} // namespace xacc
+#endif
@@ -17,16 +17,12 @@
 #include "FermionOperator.hpp"
 #include "PauliOperator.hpp"
 
+#include <Eigen/Dense>
 #include <unsupported/Eigen/CXX11/TensorSymmetry>
 #include <iomanip>
 
 namespace xacc {
 namespace quantum {
-using IP = Eigen::IndexPair<int>;
-using T2 = Eigen::Tensor<double, 2>;
-using T4 = Eigen::Tensor<double, 4>;
-using T0 = Eigen::Tensor<double, 0>;
-
 void RDMPurificationDecorator::initialize(const HeterogeneousMap &params) {
   if (!params.keyExists<std::shared_ptr<Observable>>("fermion-observable") &&
       !std::dynamic_pointer_cast<quantum::FermionOperator>(
@@ -38,6 +34,74 @@ void RDMPurificationDecorator::initialize(const HeterogeneousMap &params) {
 
   fermionObservable =
       params.get<std::shared_ptr<Observable>>("fermion-observable");
+  weightsNbQubits = -1;
+}
+
+void RDMPurificationDecorator::computeEnergyWeights(int nQubits) {
+  if (weightsNbQubits == nQubits) {
+    return;
+  }
+
+  // Column-major index of (p, q, r, s)
+  const int n = nQubits;
+  auto idx = [n](int p, int q, int r, int s) {
+    return p + n * (q + n * (r + n * s));
+  };
+
+  hpq.assign(n * n, 0.0);
+  hpqrs.assign(n * n * n * n, 0.0);
+  enuc = 0.0;
+  auto terms =
+      std::dynamic_pointer_cast<quantum::FermionOperator>(fermionObservable)
+          ->getTerms();
+  for (auto &kv : terms) {
+    auto ops = kv.second.ops();
+    for (auto &op : ops) {
+      if (op.first >= n) {
+        xacc::error("RDMPurificationDecorator - the fermion-observable acts "
+                    "on more than " +
+                    std::to_string(n) + " spin-orbitals.");
+      }
+    }
+    if (ops.size() == 4) {
+      hpqrs[idx(ops[0].first, ops[1].first, ops[2].first, ops[3].first)] =
+          std::real(kv.second.coeff());
+    } else if (ops.size() == 2) {
+      hpq[ops[0].first + n * ops[1].first] = std::real(kv.second.coeff());
+    } else {
+      enuc = std::real(kv.second.coeff());
+    }
+  }
+
+  // E = enuc + 0.5 sum hpqrs (rho(p, q, s, r) + rho(r, s, q, p))
+  //          + 0.5 sum hpq (rho_pq(p, q) + rho_pq(q, p)),
+  // with rho_pq(p, q) = sum_r rho(p, r, q, r).
+  energyWeights.assign(hpqrs.size(), 0.0);
+  for (int s = 0; s < n; s++) {
+    for (int r = 0; r < n; r++) {
+      for (int q = 0; q < n; q++) {
+        for (int p = 0; p < n; p++) {
+          const double h = hpqrs[idx(p, q, r, s)];
+          if (h != 0.0) {
+            energyWeights[idx(p, q, s, r)] += 0.5 * h;
+            energyWeights[idx(r, s, q, p)] += 0.5 * h;
+          }
+        }
+      }
+    }
+  }
+  for (int q = 0; q < n; q++) {
+    for (int p = 0; p < n; p++) {
+      const double h = hpq[p + n * q];
+      if (h != 0.0) {
+        for (int r = 0; r < n; r++) {
+          energyWeights[idx(p, r, q, r)] += 0.5 * h;
+          energyWeights[idx(q, r, p, r)] += 0.5 * h;
+        }
+      }
+    }
+  }
+  weightsNbQubits = nQubits;
 }
 
 void RDMPurificationDecorator::execute(
@@ -94,28 +158,7 @@ void RDMPurificationDecorator::execute(
   //     ansatz = tmp;
   //   }
 
-  Eigen::Tensor<double, 2> hpq(nQubits, nQubits);
-  hpq.setZero();
-  Eigen::Tensor<double, 4> hpqrs(nQubits, nQubits, nQubits, nQubits);
-  hpqrs.setZero();
-
-  double enuc = 0.0;
-  auto terms =
-      std::dynamic_pointer_cast<quantum::FermionOperator>(fermionObservable)
-          ->getTerms();
-  for (auto &kv : terms) {
-    auto ops = kv.second.ops();
-    if (ops.size() == 4) {
-      hpqrs(ops[0].first, ops[1].first, ops[2].first, ops[3].first) =
-          std::real(kv.second.coeff());
-    } else if (ops.size() == 2) {
-      hpq(ops[0].first, ops[1].first) = std::real(kv.second.coeff());
-    } else {
-      enuc = std::real(kv.second.coeff());
-    }
-  }
-
-  double energy = enuc;
+  computeEnergyWeights(nQubits);
 
   auto rdmGen = xacc::getAlgorithm(
       "rdm", {std::make_pair("accelerator", decoratedAccelerator),
@@ -123,155 +166,87 @@ void RDMPurificationDecorator::execute(
   rdmGen->execute(buffer);
   buffers = buffer->getChildren();
 
-  auto data = buffer->getInformation("2-rdm").as<std::vector<double>>();
-
-  Eigen::TensorMap<Eigen::Tensor<double, 4>> rho_pqrs(
-      data.data(), nQubits, nQubits, nQubits, nQubits);
+  auto rho_pqrs_data = buffer->getInformation("2-rdm").as<std::vector<double>>();
 
-  Eigen::Tensor<double, 4> realpqrs = hpqrs.real();
-  auto pqrstmp = realpqrs.data();
-  std::vector<double> hpqrs_vec(pqrstmp, pqrstmp + hpqrs.size());
-
-  Eigen::Tensor<double, 2> realpq = hpq.real();
-  auto pqtmp = realpq.data();
-  std::vector<double> hpq_vec(pqtmp, pqtmp + hpq.size());
-
-  //   //   auto rho_pq = generator.rho_pq;
-  //   //   T4 rho_pqrs = generator.rho_pqrs;
-  Eigen::Tensor<double, 4> realt = rho_pqrs.real();
-  auto real = realt.data();
-  std::vector<double> rho_pqrs_data(real, real + rho_pqrs.size());
-
-  double bad_energy = energy;
-  for (int p = 0; p < nQubits; p++) {
-    for (int q = 0; q < nQubits; q++) {
-      for (int r = 0; r < nQubits; r++) {
-        for (int s = 0; s < nQubits; s++) {
-          bad_energy +=
-              0.5 * std::real(hpqrs(p, q, r, s) *
-                              (rho_pqrs(p, q, s, r) + rho_pqrs(r, s, q, p)));
-        }
-      }
-    }
-  }
-
-  Eigen::array<int, 2> cc2({1, 3});
-  Eigen::DynamicSGroup rho_pqrs_Sym;
-  rho_pqrs_Sym.addAntiSymmetry(0, 1);
-  rho_pqrs_Sym.addAntiSymmetry(2, 3);
-
-  T2 bad_rhopq_tensor = rho_pqrs.trace(cc2);
-  for (int p = 0; p < nQubits; p++) {
-    for (int q = 0; q < nQubits; q++) {
-      bad_energy += 0.5 * std::real(hpq(p, q) * (bad_rhopq_tensor(p, q) +
-                                                 bad_rhopq_tensor(q, p)));
-    }
-  }
+  // rho_pqrs (column-major) is the matrix rho((p, q), (r, s)) of order
+  // nQubits^2, the contraction over (2, 0), (3, 1) is its matrix product and
+  // sum_pq rho(p, q, p, q) its trace.
+  const int dim = nQubits * nQubits;
+  const Eigen::Map<const Eigen::VectorXd> weights(energyWeights.data(),
+                                                  energyWeights.size());
+  const Eigen::Map<const Eigen::MatrixXd> rho_pqrs(rho_pqrs_data.data(), dim,
+                                                   dim);
 
+  double bad_energy =
+      enuc + weights.dot(Eigen::Map<const Eigen::VectorXd>(
+                 rho_pqrs_data.data(), rho_pqrs_data.size()));
   xacc::info("Non-purified Energy: " + std::to_string(bad_energy));
 
-  //   xacc::info("Filtering 2-RDM");
-  Eigen::Tensor<double, 4> filtered_rhopqrs(nQubits, nQubits, nQubits, nQubits);
-  filtered_rhopqrs.setZero();
-
-  for (int p = 0; p < nQubits; p++) {
-    for (int q = 0; q < nQubits; q++) {
-      for (int r = 0; r < nQubits; r++) {
-        for (int s = 0; s < nQubits; s++) {
-          if ((p <= q) && (r <= s)) {
-            filtered_rhopqrs(p, q, r, s) = rho_pqrs(p, q, r, s);
-            // filtered_rhopqrs(r, s, p, q) = rho_pqrs(p, q, r, s);
-          }
-        }
-      }
+  // Filtering 2-RDM: keep the (p <= q, r <= s) elements
+  Eigen::VectorXd pairMask(dim);
+  for (int q = 0; q < nQubits; q++) {
+    for (int p = 0; p < nQubits; p++) {
+      pairMask[p + nQubits * q] = p <= q ? 1.0 : 0.0;
     }
   }
+  Eigen::MatrixXd rdm =
+      pairMask.asDiagonal() * rho_pqrs * pairMask.asDiagonal();
 
-  T4 rdm = filtered_rhopqrs;
-  Eigen::array<IP, 2> sq_indices{IP(2, 0), IP(3, 1)};
-
-  T4 rdmSq = rdm.contract(rdm, sq_indices);
-  T4 diff = rdmSq - rdm;
-  T4 diffSq = diff.contract(diff, sq_indices);
+  // Tr(A * A) without the product
+  auto traceSq = [](const Eigen::MatrixXd &a) {
+    return a.cwiseProduct(a.transpose()).sum();
+  };
 
-  double tr_diff_sq = 0.0;
-  for (int p = 0; p < nQubits; p++) {
-    for (int q = 0; q < nQubits; q++) {
-      tr_diff_sq += std::real(diffSq(p, q, p, q));
-    }
-  }
+  Eigen::MatrixXd rdmSq = rdm * rdm;
+  Eigen::MatrixXd diff = rdmSq - rdm;
+  double tr_diff_sq = traceSq(diff);
 
   int count = 0;
   while (tr_diff_sq > 1e-8) {
-    auto tr_rdm = 0.0;
-    for (int p = 0; p < nQubits; p++) {
-      for (int q = 0; q < nQubits; q++) {
-        tr_rdm += std::real(rdm(p, q, p, q));
-      }
-    }
+    const double tr_rdm = rdm.trace();
 
     std::stringstream sss;
     sss << "diffsq_tr: " << std::setprecision(8) << tr_diff_sq
         << ", rdm_tr: " << tr_rdm;
     xacc::info("Iter: " + std::to_string(count) + ", diffsq_tr: " + sss.str());
-    rdm = rdm * rdm.constant(1. / tr_rdm);
+    rdm /= tr_rdm;
 
-    rdmSq = rdm.contract(rdm, sq_indices);
+    rdmSq.noalias() = rdm * rdm;
     diff = rdmSq - rdm;
-    diffSq = diff.contract(diff, sq_indices);
 
-    rdm = rdm.constant(3.) * rdmSq -
-          rdm.constant(2.) * rdm.contract(rdmSq, sq_indices);
+    rdm = 3. * rdmSq - 2. * (rdm * rdmSq);
 
-    tr_diff_sq = 0.0;
-    for (int p = 0; p < nQubits; p++) {
-      for (int q = 0; q < nQubits; q++) {
-        tr_diff_sq += std::real(diffSq(p, q, p, q));
-      }
-    }
+    tr_diff_sq = traceSq(diff);
 
     count++;
   }
 
   // reconstruct rhopqrs using symmetry rules
+  Eigen::DynamicSGroup rho_pqrs_Sym;
+  rho_pqrs_Sym.addAntiSymmetry(0, 1);
+  rho_pqrs_Sym.addAntiSymmetry(2, 3);
+  Eigen::Tensor<double, 4> rdmTensor =
+      Eigen::TensorMap<Eigen::Tensor<double, 4>>(rdm.data(), nQubits, nQubits,
+                                                 nQubits, nQubits);
   for (int p = 0; p < nQubits; p++) {
     for (int q = 0; q < nQubits; q++) {
       for (int r = 0; r < nQubits; r++) {
         for (int s = 0; s < nQubits; s++) {
-          rho_pqrs_Sym(rdm, p, q, r, s) = rdm(p, q, r, s);
-          rho_pqrs_Sym(rdm, r, s, p, q) = rdm(p, q, r, s);
+          rho_pqrs_Sym(rdmTensor, p, q, r, s) = rdmTensor(p, q, r, s);
+          rho_pqrs_Sym(rdmTensor, r, s, p, q) = rdmTensor(p, q, r, s);
         }
       }
     }
   }
 
-  realt = rdm.real();
-  real = realt.data();
-  std::vector<double> fixed_rho_pqrs_data(real, real + rho_pqrs.size());
+  rdm = Eigen::Map<Eigen::MatrixXd>(rdmTensor.data(), dim, dim);
+  std::vector<double> fixed_rho_pqrs_data(rdm.data(), rdm.data() + rdm.size());
 
-  T2 rhopq_tensor = rdm.trace(cc2);
-  T0 tmp = rhopq_tensor.trace();
-  auto rhopq_trace = std::real(tmp(0));
-  xacc::info("Tr(rhopq): " + std::to_string(rhopq_trace));
+  xacc::info("Tr(rhopq): " + std::to_string(rdm.trace()));
 
-  for (int p = 0; p < nQubits; p++) {
-    for (int q = 0; q < nQubits; q++) {
-      for (int r = 0; r < nQubits; r++) {
-        for (int s = 0; s < nQubits; s++) {
-          energy += 0.5 * std::real(hpqrs(p, q, r, s) *
-                                    (rdm(p, q, s, r) + rdm(r, s, q, p)));
-        }
-      }
-    }
-  }
-  //   xacc::info("Energy after 2-rdm: " + std::to_string(energy));
-
-  for (int p = 0; p < nQubits; p++) {
-    for (int q = 0; q < nQubits; q++) {
-      energy += 0.5 * std::real(hpq(p, q) *
-                                (rhopq_tensor(p, q) + rhopq_tensor(q, p)));
-    }
-  }
+  const double energy =
+      enuc + weights.dot(Eigen::Map<const Eigen::VectorXd>(rdm.data(),
+                                                           rdm.size()));
 
   xacc::info("Purified energy " + std::to_string(energy));
 
@@ -292,8 +267,8 @@ void RDMPurificationDecorator::execute(
 
   buffers[0]->addExtraInfo("noisy-rdm", ExtraInfo(rho_pqrs_data));
   buffers[0]->addExtraInfo("fixed-rdm", ExtraInfo(fixed_rho_pqrs_data));
-  buffers[0]->addExtraInfo("hpqrs", ExtraInfo(hpqrs_vec));
-  buffers[0]->addExtraInfo("hpq", ExtraInfo(hpq_vec));
+  buffers[0]->addExtraInfo("hpqrs", ExtraInfo(hpqrs));
+  buffers[0]->addExtraInfo("hpq", ExtraInfo(hpq));
 
   buffer->addExtraInfo("__internal__decorator_aggregate_vqe__", energy);
   return;
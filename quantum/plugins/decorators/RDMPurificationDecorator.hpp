@@ -23,6 +23,16 @@ class RDMPurificationDecorator : public AcceleratorDecorator {
 protected:
   std::shared_ptr<Observable> fermionObservable;
 
+  // The (column-major) hpq and hpqrs of the observable and the energy
+  // weights w, E = enuc + sum(w * rho_pqrs), for weightsNbQubits
+  // spin-orbitals. Computed by the first execution after initialize().
+  int weightsNbQubits = -1;
+  double enuc = 0.0;
+  std::vector<double> hpq;
+  std::vector<double> hpqrs;
+  std::vector<double> energyWeights;
+  void computeEnergyWeights(int nQubits);
+
 public:
   const std::vector<std::string> configurationKeys() override {
       return {"fermion-observable"};
@@ -16,6 +16,7 @@
 #include "xacc.hpp"
 #include <fstream>
 #include <set>
+#include <tuple>
 
 #define RAPIDJSON_HAS_STDSTRING 1
 
@@ -24,61 +25,100 @@ using namespace rapidjson;
 
 namespace xacc {
 namespace quantum {
-void ROErrorDecorator::execute(
-    std::shared_ptr<AcceleratorBuffer> buffer,
-    const std::shared_ptr<CompositeInstruction> function) {
-
-  if (decoratedAccelerator)
-    decoratedAccelerator->execute(buffer, function);
-
+bool ROErrorDecorator::loadErrorRates(std::shared_ptr<AcceleratorBuffer> buffer,
+                                      std::map<int, double> &piplus,
+                                      std::map<int, double> &piminus) {
   HeterogeneousMap properties;
   if (decoratedAccelerator) {
     properties = decoratedAccelerator->getProperties();
   }
 
-  std::map<int, double> piplus, piminus;
-
   if (properties.keyExists<std::vector<double>>("p01s") &&
       properties.keyExists<std::vector<double>>("p10s")) {
+    // The rates of a backend calibration are shared with the other
+    // decorators and processes.
+    std::string key;
+    if (properties.stringExists("total-json")) {
+      Document d;
+      d.Parse(properties.getString("total-json"));
+      if (!d.HasParseError() && d.IsObject() &&
+          d.HasMember("last_update_date") && d["last_update_date"].IsString()) {
+        key = "ro-error|" + decoratedAccelerator->name() + "|";
+        if (d.HasMember("backend_name") && d["backend_name"].IsString()) {
+          key += d["backend_name"].GetString();
+        }
+        key += std::string("|") + d["last_update_date"].GetString();
+      }
+    }
+    std::vector<std::vector<double>> cached;
+    if (!key.empty() && calibrationCache.load(key, cached) &&
+        cached.size() == 2 && cached[0].size() == cached[1].size()) {
+      for (int i = 0; i < cached[0].size(); i++) {
+        piplus.insert({i, cached[0][i]});
+        piminus.insert({i, cached[1][i]});
+      }
+      return true;
+    }
 
     auto p01s = properties.get<std::vector<double>>("p01s");
     auto p10s = properties.get<std::vector<double>>("p10s");
+    std::vector<double> plus, minus;
     for (int i = 0; i < p01s.size(); i++) {
       piplus.insert({i, p01s[i] + p10s[i]});
       piminus.insert({i, p01s[i] - p10s[i]});
+      plus.push_back(piplus[i]);
+      minus.push_back(piminus[i]);
     }
-  } else {
-    if (!xacc::fileExists(roErrorFile)) {
-      xacc::info(
-          "Cannot find readout erro file (key 'file'). Skipping ReadoutError "
-          "correction.");
-      return;
+    if (!key.empty()) {
+      calibrationCache.save(key, {plus, minus});
     }
+    return true;
+  }
 
-    // Get RO error probs
-    buffer->addExtraInfo("ro-error-file", ExtraInfo(roErrorFile));
+  if (!xacc::fileExists(roErrorFile)) {
+    xacc::info(
+        "Cannot find readout error file (key 'file'). Skipping ReadoutError "
+        "correction.");
+    return false;
+  }
 
-    std::ifstream t(roErrorFile);
-    std::string json((std::istreambuf_iterator<char>(t)),
-                     std::istreambuf_iterator<char>());
+  // Get RO error probs
+  buffer->addExtraInfo("ro-error-file", ExtraInfo(roErrorFile));
 
-    if (json.empty()) {
-      xacc::error("Invalid ROError JSON file: " + roErrorFile);
-    }
+  std::ifstream t(roErrorFile);
+  std::string json((std::istreambuf_iterator<char>(t)),
+                   std::istreambuf_iterator<char>());
+
+  if (json.empty()) {
+    xacc::error("Invalid ROError JSON file: " + roErrorFile);
+  }
 
-    Document d;
-    d.Parse(json);
+  Document d;
+  d.Parse(json);
 
-    for (auto itr = d.MemberBegin(); itr != d.MemberEnd(); ++itr) {
-      std::string key = itr->name.GetString();
-      if (key.compare("shots") != 0 && key.compare("backend") != 0) {
-        auto &value = d[itr->name.GetString()];
-        auto qbit = std::stoi(key);
-        piplus.insert({qbit, value["+"].GetDouble()});
-        piminus.insert({qbit, value["-"].GetDouble()});
-      }
+  for (auto itr = d.MemberBegin(); itr != d.MemberEnd(); ++itr) {
+    std::string key = itr->name.GetString();
+    if (key.compare("shots") != 0 && key.compare("backend") != 0) {
+      auto &value = d[itr->name.GetString()];
+      auto qbit = std::stoi(key);
+      piplus.insert({qbit, value["+"].GetDouble()});
+      piminus.insert({qbit, value["-"].GetDouble()});
     }
   }
+  return true;
+}
+
+void ROErrorDecorator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::shared_ptr<CompositeInstruction> function) {
+
+  if (decoratedAccelerator)
+    decoratedAccelerator->execute(buffer, function);
+
+  std::map<int, double> piplus, piminus;
+  if (!loadErrorRates(buffer, piplus, piminus)) {
+    return;
+  }
 
   auto supports = [](std::shared_ptr<CompositeInstruction> f) {
     std::set<int> supportSet;
@@ -87,7 +127,7 @@ void ROErrorDecorator::execute(
     InstructionIterator it(f);
     while (it.hasNext()) {
       auto nextInst = it.next();
-      if (nextInst->name() == "Measure") {
+      if (nextInst->opcode() == xacc::GateOpcode::Measure) {
         auto bits = nextInst->bits();
         supportSet.insert(bits[0]);
         support_to_creg_map.insert({bits[0], creg_count});
@@ -138,22 +178,10 @@ void ROErrorDecorator::execute(
   return;
 }
 
-void ROErrorDecorator::execute(
-    std::shared_ptr<AcceleratorBuffer> buffer,
-    const std::vector<std::shared_ptr<CompositeInstruction>> functions) {
-
-  std::vector<std::shared_ptr<AcceleratorBuffer>> buffers;
-  std::map<std::string, std::shared_ptr<CompositeInstruction>> nameToFunction;
-  std::map<std::string, std::pair<std::set<int>, std::map<int, int>>>
-      supportSets;
-
-  if (decoratedAccelerator) {
-    decoratedAccelerator->execute(buffer, functions);
-    buffers = buffer->getChildren();
-  } else {
-    buffers = buffer->getChildren();
-  }
-
+void ROErrorDecorator::correct(
+    const std::vector<std::shared_ptr<AcceleratorBuffer>> &buffers,
+    const std::vector<std::shared_ptr<CompositeInstruction>> &functions,
+    const std::map<int, double> &piplus, const std::map<int, double> &piminus) {
   auto supports = [](std::shared_ptr<CompositeInstruction> f) {
     std::set<int> supportSet;
     std::map<int, int> support_to_creg_map;
@@ -161,7 +189,7 @@ void ROErrorDecorator::execute(
     InstructionIterator it(f);
     while (it.hasNext()) {
       auto nextInst = it.next();
-      if (nextInst->name() == "Measure") {
+      if (nextInst->opcode() == xacc::GateOpcode::Measure) {
         auto bits = nextInst->bits();
         supportSet.insert(bits[0]);
         support_to_creg_map.insert({bits[0], creg_count});
@@ -173,58 +201,11 @@ void ROErrorDecorator::execute(
     }
     return std::make_pair(supportSet, support_to_creg_map);
   };
-
-  for (auto &f : functions) {
-    nameToFunction.insert({f->name(), f});
-    supportSets.insert({f->name(), supports(f)});
-  }
-
-  std::map<int, double> piplus, piminus;
-  HeterogeneousMap properties;
-  if (decoratedAccelerator) {
-    properties = decoratedAccelerator->getProperties();
-  }
-  if (properties.keyExists<std::vector<double>>("p01s") &&
-      properties.keyExists<std::vector<double>>("p10s")) {
-
-    auto p01s = properties.get<std::vector<double>>("p01s");
-    auto p10s = properties.get<std::vector<double>>("p10s");
-    for (int i = 0; i < p01s.size(); i++) {
-
-      piplus.insert({i, p01s[i] + p10s[i]});
-      piminus.insert({i, p01s[i] - p10s[i]});
-    }
-  } else {
-
-    if (!xacc::fileExists(roErrorFile)) {
-      xacc::info(
-          "Cannot find readout error file (key 'file'). Skipping ReadoutError "
-          "correction.");
-      return;
-    }
-    // Get RO error probs
-    buffer->addExtraInfo("ro-error-file", ExtraInfo(roErrorFile));
-
-    std::ifstream t(roErrorFile);
-    std::string json((std::istreambuf_iterator<char>(t)),
-                     std::istreambuf_iterator<char>());
-    if (json.empty()) {
-      xacc::error("Invalid ROError JSON file: " + roErrorFile);
-    }
-
-    Document d;
-    d.Parse(json);
-
-    for (auto itr = d.MemberBegin(); itr != d.MemberEnd(); ++itr) {
-      std::string key = itr->name.GetString();
-      if (key.compare("shots") != 0 && key.compare("backend") != 0) {
-        auto &value = d[itr->name.GetString()];
-        auto qbit = std::stoi(key);
-        piplus.insert({qbit, value["+"].GetDouble()});
-        piminus.insert({qbit, value["-"].GetDouble()});
-      }
-    }
-  }
+  // 0 for the qubits without error rates
+  auto rate = [](const std::map<int, double> &rates, int qubit) {
+    auto iter = rates.find(qubit);
+    return iter == rates.end() ? 0.0 : iter->second;
+  };
 
   // Get the number of shots first
   int nShots = 0;
@@ -238,25 +219,26 @@ void ROErrorDecorator::execute(
   for (auto &kv : tmpCounts) {
     nShots += kv.second;
   }
-  int counter = 0;
-  for (auto &b : buffers) {
+  for (int i = 0; i < buffers.size(); i++) {
+    auto &b = buffers[i];
     auto counts = b->getMeasurementCounts();
-    auto functionName = b->name();
-    auto f = nameToFunction[functionName];
-    auto [fSupports, support_to_creg_map] = supportSets[functionName];
-    auto exp_val = b->getExpectationValueZ();
+    std::set<int> fSupports;
+    std::map<int, int> support_to_creg_map;
+    if (functions[i]) {
+      std::tie(fSupports, support_to_creg_map) = supports(functions[i]);
+    }
     auto fixedExp = 0.0;
     for (auto &kv : counts) {
       auto prod = 1.0;
       std::string bitString = kv.first;
       auto count = kv.second;
       for (auto &j : fSupports) {
-        auto denom = (1.0 - piplus[j]);
+        auto denom = (1.0 - rate(piplus, j));
         double numerator =
             (bitString[bitString.length() - 1 - support_to_creg_map[j]] == '1'
                  ? -1
                  : 1) -
-            piminus[j];
+            rate(piminus, j);
         prod *= (numerator / denom);
       }
       fixedExp += ((double)count / (double)nShots) * prod;
@@ -268,11 +250,53 @@ void ROErrorDecorator::execute(
       fixedExp = -1.0;
     }
     b->addExtraInfo("ro-fixed-exp-val-z", ExtraInfo(fixedExp));
+  }
+}
 
-    counter++;
+bool ROErrorDecorator::planStage(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>> &functions,
+    DecoratorStage &stage) {
+  stage.circuits = functions;
+  std::map<int, double> piplus, piminus;
+  if (!loadErrorRates(buffer, piplus, piminus)) {
+    return true;
   }
+  stage.transform =
+      [this, functions, piplus, piminus](
+          const std::vector<std::shared_ptr<AcceleratorBuffer>> &results) {
+        correct(results, functions, piplus, piminus);
+        return results;
+      };
+  return true;
+}
 
-  return;
+void ROErrorDecorator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>> functions) {
+
+  if (executePipeline(buffer, functions)) {
+    return;
+  }
+
+  // No decorated accelerator: correct the results already in buffer
+  auto buffers = buffer->getChildren();
+  std::map<std::string, std::shared_ptr<CompositeInstruction>> nameToFunction;
+  for (auto &f : functions) {
+    nameToFunction.insert({f->name(), f});
+  }
+  std::vector<std::shared_ptr<CompositeInstruction>> bufferFunctions;
+  for (auto &b : buffers) {
+    auto iter = nameToFunction.find(b->name());
+    bufferFunctions.push_back(iter == nameToFunction.end() ? nullptr
+                                                           : iter->second);
+  }
+
+  std::map<int, double> piplus, piminus;
+  if (!loadErrorRates(buffer, piplus, piminus)) {
+    return;
+  }
+  correct(buffers, bufferFunctions, piplus, piminus);
 }
 
 } // namespace quantum
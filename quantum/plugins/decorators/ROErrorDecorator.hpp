@@ -14,6 +14,9 @@
 #define XACC_ROERRORDECORATOR_HPP_
 
 #include "AcceleratorDecorator.hpp"
+#include "CalibrationCache.hpp"
+
+#include <map>
 
 namespace xacc {
 
@@ -23,6 +26,19 @@ class ROErrorDecorator : public AcceleratorDecorator {
 protected:
 
    std::string roErrorFile = "";
+   // Error rates of the backend properties, by calibration
+   CalibrationCache calibrationCache;
+
+   // pi+ = p01 + p10 and pi- = p01 - p10 of each qubit, from the backend
+   // properties or the 'file'. Returns false if there are none.
+   bool loadErrorRates(std::shared_ptr<AcceleratorBuffer> buffer,
+                       std::map<int, double> &piplus,
+                       std::map<int, double> &piminus);
+   // Sets the "ro-fixed-exp-val-z" of the results of the functions
+   void correct(const std::vector<std::shared_ptr<AcceleratorBuffer>> &buffers,
+                const std::vector<std::shared_ptr<CompositeInstruction>> &functions,
+                const std::map<int, double> &piplus,
+                const std::map<int, double> &piminus);
 
 public:
 
@@ -30,6 +46,7 @@ public:
     if (params.stringExists("file")) {
         roErrorFile = params.getString("file");
     }
+    calibrationCache.initialize(params);
   }
 
   void updateConfiguration(const HeterogeneousMap &config) override {
@@ -37,9 +54,10 @@ public:
     if (config.stringExists("file")) {
         roErrorFile = config.getString("file");
     }
+    calibrationCache.initialize(config);
   }
   const std::vector<std::string> configurationKeys() override {
-      return {"file"};
+      return {"file", "calibration-cache-ttl", "calibration-cache-file"};
   }
 
   void execute(std::shared_ptr<AcceleratorBuffer> buffer,
@@ -48,6 +66,12 @@ public:
   execute(std::shared_ptr<AcceleratorBuffer> buffer,
           const std::vector<std::shared_ptr<CompositeInstruction>> functions) override;
 
+  // Fusable: the results are corrected in place
+  bool planStage(
+      std::shared_ptr<AcceleratorBuffer> buffer,
+      const std::vector<std::shared_ptr<CompositeInstruction>> &functions,
+      DecoratorStage &stage) override;
+
   const std::string name() const override { return "ro-error"; }
   const std::string description() const override { return ""; }
 
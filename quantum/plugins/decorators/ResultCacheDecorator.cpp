@@ -0,0 +1,246 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "ResultCacheDecorator.hpp"
+#include "StructuralHasher.hpp"
+#include "xacc.hpp"
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace {
+// Hash of a circuit with unbound (symbolic) parameters
+constexpr uint64_t UNCACHEABLE = 0;
+
+// Copy of the results (measurements and extra information) of a buffer.
+std::shared_ptr<xacc::AcceleratorBuffer>
+copyResults(std::shared_ptr<xacc::AcceleratorBuffer> in_buffer,
+            const std::string &in_name) {
+  auto result = std::make_shared<xacc::AcceleratorBuffer>(in_name,
+                                                          in_buffer->size());
+  result->setMeasurements(in_buffer->getMeasurementCounts());
+  for (auto &[k, v] : in_buffer->getInformation()) {
+    result->addExtraInfo(k, v);
+  }
+  return result;
+}
+
+std::string toHex(uint64_t in_key) {
+  std::stringstream ss;
+  ss << std::hex << in_key;
+  return ss.str();
+}
+} // namespace
+
+namespace xacc {
+namespace quantum {
+void ResultCacheDecorator::initialize(const HeterogeneousMap &params) {
+  decoratedAccelerator->initialize(params);
+  // A different backend configuration invalidates the results.
+  cache.clear();
+  lruKeys.clear();
+  hits = 0;
+  if (params.keyExists<double>("tolerance")) {
+    tolerance = params.get<double>("tolerance");
+    if (tolerance <= 0.0) {
+      xacc::error("ResultCacheDecorator: 'tolerance' must be positive.");
+    }
+  }
+  if (params.keyExists<int>("max-entries")) {
+    const int entries = params.get<int>("max-entries");
+    if (entries < 1) {
+      xacc::error("ResultCacheDecorator: 'max-entries' must be positive.");
+    }
+    maxEntries = entries;
+  }
+  if (params.stringExists("cache-file")) {
+    cacheFile = params.getString("cache-file");
+    loadCacheFile();
+  }
+}
+
+void ResultCacheDecorator::updateConfiguration(const HeterogeneousMap &config) {
+  decoratedAccelerator->updateConfiguration(config);
+  cache.clear();
+  lruKeys.clear();
+}
+
+void ResultCacheDecorator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::shared_ptr<CompositeInstruction> function) {
+  if (!decoratedAccelerator) {
+    xacc::error("Cannot run the ResultCacheDecorator without a delegate "
+                "Accelerator.");
+  }
+
+  const auto key = hashCircuit(function, buffer->size());
+  if (auto cached = lookup(key)) {
+    buffer->setMeasurements(cached->getMeasurementCounts());
+    for (auto &[k, v] : cached->getInformation()) {
+      buffer->addExtraInfo(k, v);
+    }
+    return;
+  }
+
+  decoratedAccelerator->execute(buffer, function);
+  store(key, copyResults(buffer, buffer->name()));
+}
+
+void ResultCacheDecorator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>> functions) {
+  if (!decoratedAccelerator) {
+    xacc::error("Cannot run the ResultCacheDecorator without a delegate "
+                "Accelerator.");
+  }
+
+  std::vector<uint64_t> keys;
+  std::vector<std::shared_ptr<AcceleratorBuffer>> results(functions.size());
+  std::vector<std::shared_ptr<CompositeInstruction>> misses;
+  for (size_t i = 0; i < functions.size(); ++i) {
+    keys.emplace_back(hashCircuit(functions[i], buffer->size()));
+    if (auto cached = lookup(keys[i])) {
+      // Circuits identical up to their names share the result.
+      results[i] = copyResults(cached, functions[i]->name());
+    } else {
+      misses.emplace_back(functions[i]);
+    }
+  }
+
+  if (!misses.empty()) {
+    // All misses are executed as one batch.
+    auto tmpBuffer = xacc::qalloc(buffer->size());
+    decoratedAccelerator->execute(tmpBuffer, misses);
+    for (auto &[k, v] : tmpBuffer->getInformation()) {
+      buffer->addExtraInfo(k, v);
+    }
+    auto children = tmpBuffer->getChildren();
+    if (children.size() != misses.size()) {
+      // The backend (e.g. an aggregating decorator) doesn't return one child
+      // per circuit: can't cache, just forward the results.
+      for (auto &child : children) {
+        buffer->appendChild(child->name(), child);
+      }
+      return;
+    }
+    size_t missIdx = 0;
+    for (size_t i = 0; i < functions.size(); ++i) {
+      if (!results[i]) {
+        results[i] = children[missIdx++];
+        store(keys[i], copyResults(results[i], results[i]->name()));
+      }
+    }
+  }
+
+  for (auto &result : results) {
+    buffer->appendChild(result->name(), result);
+  }
+}
+
+uint64_t
+ResultCacheDecorator::hashCircuit(std::shared_ptr<CompositeInstruction> function,
+                                  int nbQubits) {
+  // Stable across runs (for the on-disk cache)
+  StructuralHasher hasher;
+  hasher.add(decoratedAccelerator->getSignature());
+  hasher.add<int32_t>(nbQubits);
+  for (auto *inst : function->flatView()) {
+    if (inst->isComposite() || !inst->isEnabled()) {
+      continue;
+    }
+    hasher.add(inst->name());
+    for (const auto &bit : inst->bits()) {
+      hasher.add<uint64_t>(bit);
+    }
+    for (const auto &param : inst->getParameters()) {
+      double value;
+      if (param.which() == 2) {
+        // Only numeric strings are bound parameters
+        const auto &str = param.as<std::string>();
+        char *end = nullptr;
+        value = std::strtod(str.c_str(), &end);
+        if (end == str.c_str() || *end != '\0') {
+          return UNCACHEABLE;
+        }
+      } else {
+        value = InstructionParameterToDouble(param);
+      }
+      hasher.add<int64_t>(std::llround(value / tolerance));
+    }
+  }
+  const auto hash = hasher.value();
+  return hash == UNCACHEABLE ? hash + 1 : hash;
+}
+
+std::shared_ptr<AcceleratorBuffer> ResultCacheDecorator::lookup(uint64_t key) {
+  if (key == UNCACHEABLE) {
+    return nullptr;
+  }
+  auto iter = cache.find(key);
+  if (iter == cache.end()) {
+    return nullptr;
+  }
+  // Move to the front (most recently used)
+  lruKeys.splice(lruKeys.begin(), lruKeys, iter->second.second);
+  ++hits;
+  return iter->second.first;
+}
+
+void ResultCacheDecorator::store(uint64_t key,
+                                 std::shared_ptr<AcceleratorBuffer> result) {
+  if (key == UNCACHEABLE) {
+    return;
+  }
+  auto iter = cache.find(key);
+  if (iter != cache.end()) {
+    iter->second.first = result;
+    lruKeys.splice(lruKeys.begin(), lruKeys, iter->second.second);
+  } else {
+    lruKeys.push_front(key);
+    cache.emplace(key, std::make_pair(result, lruKeys.begin()));
+    if (cache.size() > maxEntries) {
+      cache.erase(lruKeys.back());
+      lruKeys.pop_back();
+    }
+  }
+
+  if (!cacheFile.empty()) {
+    std::ofstream out(cacheFile, std::ios::binary | std::ios::app);
+    AcceleratorBuffer::appendBinaryChild(out, toHex(key), result);
+  }
+}
+
+void ResultCacheDecorator::loadCacheFile() {
+  cache.clear();
+  lruKeys.clear();
+  std::ifstream in(cacheFile, std::ios::binary);
+  if (in.good() && in.peek() != std::char_traits<char>::eof()) {
+    AcceleratorBuffer stored;
+    stored.loadBinary(in);
+    // Later records are more recent (and replace earlier ones)
+    const std::string cacheFileName = cacheFile;
+    cacheFile.clear();
+    for (auto &child : stored.getChildren()) {
+      store(std::stoull(child->name(), nullptr, 16),
+            copyResults(child, child->name()));
+    }
+    cacheFile = cacheFileName;
+    return;
+  }
+
+  // New cache file: header record only, results are appended.
+  std::ofstream out(cacheFile, std::ios::binary | std::ios::trunc);
+  AcceleratorBuffer header("result-cache", 0);
+  header.printBinary(out);
+}
+} // namespace quantum
+} // namespace xacc
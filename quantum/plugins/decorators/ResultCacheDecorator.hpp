@@ -0,0 +1,77 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_RESULTCACHEDECORATOR_HPP_
+#define XACC_RESULTCACHEDECORATOR_HPP_
+
+#include "AcceleratorDecorator.hpp"
+#include <list>
+#include <unordered_map>
+
+namespace xacc {
+
+namespace quantum {
+// Memoizes the execution results of circuits, keyed by a structural hash
+// of the circuit (gates, qubits and parameters rounded to 'tolerance'),
+// i.e. independent of the circuit name.
+// Only meaningful for deterministic backends (e.g. simulators computing
+// expectation values): a cached sampled result is returned as is.
+// Options:
+//  - "tolerance" (double): parameter rounding, default 1e-12.
+//  - "max-entries" (int): LRU bound on the number of cached results.
+//  - "cache-file" (string): persist the cache (binary AcceleratorBuffer).
+class ResultCacheDecorator : public AcceleratorDecorator {
+public:
+  void initialize(const HeterogeneousMap &params = {}) override;
+  void updateConfiguration(const HeterogeneousMap &config) override;
+  const std::vector<std::string> configurationKeys() override {
+    return {"tolerance", "max-entries", "cache-file"};
+  }
+
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::shared_ptr<CompositeInstruction> function) override;
+
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::vector<std::shared_ptr<CompositeInstruction>>
+                   functions) override;
+
+  const std::string name() const override { return "result-cache"; }
+  const std::string description() const override {
+    return "Memoize circuit execution results by circuit structure.";
+  }
+
+  // Number of executions served from the cache
+  size_t nbHits() const { return hits; }
+  ~ResultCacheDecorator() override {}
+
+private:
+  uint64_t hashCircuit(std::shared_ptr<CompositeInstruction> function,
+                       int nbQubits);
+  std::shared_ptr<AcceleratorBuffer> lookup(uint64_t key);
+  void store(uint64_t key, std::shared_ptr<AcceleratorBuffer> result);
+  void loadCacheFile();
+
+  double tolerance = 1e-12;
+  size_t maxEntries = 1024;
+  std::string cacheFile;
+  size_t hits = 0;
+  // Most recently used first
+  std::list<uint64_t> lruKeys;
+  std::unordered_map<uint64_t,
+                     std::pair<std::shared_ptr<AcceleratorBuffer>,
+                               std::list<uint64_t>::iterator>>
+      cache;
+};
+
+} // namespace quantum
+} // namespace xacc
+#endif
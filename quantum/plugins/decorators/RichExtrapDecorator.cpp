@@ -14,68 +14,329 @@
 #include "InstructionIterator.hpp"
 #include "xacc.hpp"
 #include "IRProvider.hpp"
+#include "Pulse.hpp"
 #include "xacc_service.hpp"
+#include "json.hpp"
 
-namespace xacc {
-namespace quantum {
-void RichExtrapDecorator::execute(
-    std::shared_ptr<AcceleratorBuffer> buffer,
-    const std::shared_ptr<CompositeInstruction> function) {
+#include <algorithm>
+#include <cmath>
 
-  if (!decoratedAccelerator) {
-    xacc::error("Null Decorated Accelerator Error");
+namespace {
+// G^dag, nullptr if it is not a (bound) gate we know the inverse of.
+xacc::InstPtr inverseGate(std::shared_ptr<xacc::IRProvider> provider,
+                          xacc::Instruction *gate) {
+  std::vector<double> params;
+  for (auto &param : gate->getParameters()) {
+    if (param.which() == 2) {
+      const auto &str = param.as<std::string>();
+      char *end = nullptr;
+      const double value = std::strtod(str.c_str(), &end);
+      if (end == str.c_str() || *end != '\0') {
+        return nullptr;
+      }
+      params.push_back(value);
+    } else {
+      params.push_back(xacc::InstructionParameterToDouble(param));
+    }
   }
 
-  if (!xacc::optionExists("rich-extrap-r")) {
-    xacc::error(
-        "Cannot find rich-extrap-r. Skipping Richardson Extrapolation.");
-    return;
+  // Same buffer names and bits as the gate
+  auto renamed = [&](const std::string &name) {
+    auto inverse = provider->createInstruction(name, gate->bits());
+    inverse->setBufferNames(gate->getBufferNames());
+    return inverse;
+  };
+  auto negated = [&](const std::vector<double> &values) {
+    auto inverse = gate->clone();
+    for (int i = 0; i < values.size(); i++) {
+      inverse->setParameter(i, -values[i]);
+    }
+    return inverse;
+  };
+  switch (gate->opcode()) {
+  case xacc::GateOpcode::I:
+  case xacc::GateOpcode::H:
+  case xacc::GateOpcode::X:
+  case xacc::GateOpcode::Y:
+  case xacc::GateOpcode::Z:
+  case xacc::GateOpcode::CNOT:
+  case xacc::GateOpcode::CY:
+  case xacc::GateOpcode::CZ:
+  case xacc::GateOpcode::CH:
+  case xacc::GateOpcode::Swap:
+    return gate->clone();
+  case xacc::GateOpcode::S:
+    return renamed("Sdg");
+  case xacc::GateOpcode::Sdg:
+    return renamed("S");
+  case xacc::GateOpcode::T:
+    return renamed("Tdg");
+  case xacc::GateOpcode::Tdg:
+    return renamed("T");
+  case xacc::GateOpcode::Rx:
+  case xacc::GateOpcode::Ry:
+  case xacc::GateOpcode::Rz:
+  case xacc::GateOpcode::U1:
+  case xacc::GateOpcode::CRZ:
+  case xacc::GateOpcode::CPhase:
+    return negated(params);
+  case xacc::GateOpcode::U:
+    // U(theta, phi, lambda)^dag = U(-theta, -lambda, -phi)
+    return params.size() == 3 ? negated({params[0], params[2], params[1]})
+                              : nullptr;
+  default:
+    return nullptr;
   }
+}
 
-  // Get RO error probs
-  auto r = std::stoi(xacc::getOption("rich-extrap-r"));
-  buffer->addExtraInfo("rich-extrap-r", ExtraInfo(r));
+// The pulse stretched in time by scale, with its amplitude divided by scale
+// (same rotation for a resonant drive). Frame changes and the measurement
+// and acquisition channels are not stretched.
+xacc::InstPtr stretchPulse(xacc::InstPtr pulse, double scale) {
+  auto stretched = pulse->clone();
+  const auto channel = pulse->channel();
+  if (scale == 1.0 || pulse->name() == "fc" || pulse->name() == "acquire" ||
+      channel.empty() || channel[0] == 'm' || channel[0] == 'a') {
+    return stretched;
+  }
+  if (pulse->name() == "delay") {
+    stretched->setDuration(std::lround(scale * pulse->duration()));
+    return stretched;
+  }
+  if (pulse->name() == "parametric_pulse") {
+    auto pulseParams = pulse->getPulseParams();
+    auto params =
+        nlohmann::json::parse(pulseParams.getString("parameters_json"));
+    // Durations (in samples) scale, amplitudes scale down
+    for (const auto key : {"duration", "width"}) {
+      if (params.count(key)) {
+        params[key] = std::lround(scale * params[key].get<double>());
+      }
+    }
+    for (const auto key : {"sigma", "beta"}) {
+      if (params.count(key)) {
+        params[key] = scale * params[key].get<double>();
+      }
+    }
+    if (params.count("amp")) {
+      if (params["amp"].is_array()) {
+        for (auto &component : params["amp"]) {
+          component = component.get<double>() / scale;
+        }
+      } else {
+        params["amp"] = params["amp"].get<double>() / scale;
+      }
+    }
+    pulseParams.insert("parameters_json", params.dump());
+    stretched->setPulseParams(pulseParams);
+    if (params.count("duration")) {
+      stretched->setDuration(params["duration"].get<int64_t>());
+    }
+    return stretched;
+  }
 
-  auto provider = xacc::getService<IRProvider>("quantum");
+  // Sampled pulse: linear interpolation at the centers of the new samples.
+  // The stretched waveform is a new pulse library entry.
+  const auto samples = pulse->getSamples();
+  if (samples.empty()) {
+    return stretched;
+  }
+  const int nbSamples = std::max<long>(1, std::lround(scale * samples.size()));
+  std::vector<std::vector<double>> newSamples(nbSamples);
+  for (int k = 0; k < nbSamples; k++) {
+    const double t = std::clamp((k + 0.5) / scale - 0.5, 0.0,
+                                double(samples.size() - 1));
+    const int i = std::min<int>(t, samples.size() - 1);
+    const int j = std::min<int>(i + 1, samples.size() - 1);
+    const double w = t - i;
+    for (int c = 0; c < samples[i].size(); c++) {
+      newSamples[k].push_back(
+          ((1.0 - w) * samples[i][c] + w * samples[j][c]) / scale);
+    }
+  }
+  auto phase = pulse->getParameter(0);
+  auto renamed = std::make_shared<xacc::quantum::Pulse>(
+      pulse->name() + "_stretch_" + std::to_string(std::lround(scale * 1000)),
+      channel, phase, pulse->bits());
+  renamed->setSamples(newSamples);
+  renamed->setStart(pulse->start());
+  renamed->setPulseParams(pulse->getPulseParams());
+  return renamed;
+}
+} // namespace
 
-  auto f =
-      provider->createComposite(function->name(), function->getVariables());
+namespace xacc {
+namespace quantum {
+std::vector<InstPtr>
+RichExtrapDecorator::stretch(std::shared_ptr<CompositeInstruction> function,
+                             double scale, double &actualScale) {
+  actualScale = scale;
+  const auto key = std::make_pair(function->structuralHash(), scale);
+  auto iter = stretchCache.find(key);
+  if (iter != stretchCache.end()) {
+    return iter->second;
+  }
 
-  InstructionIterator it(function);
+  // Gate -> pulse lowering with the calibrated command definitions (e.g. the
+  // pulse library of an IBM backend in pulse mode)
+  if (!xacc::hasContributedService<Instruction>("fc")) {
+    decoratedAccelerator->contributeInstructions();
+  }
+  if (!xacc::hasService<IRTransformation>("ibm-pulse")) {
+    xacc::error("RichExtrap - the pulse-stretch scale mode requires the "
+                "ibm-pulse transformation.");
+  }
+  auto lowered = xacc::ir::asComposite(function->clone());
+  xacc::getService<IRTransformation>("ibm-pulse")
+      ->apply(lowered, decoratedAccelerator);
+
+  std::vector<InstPtr> pulses;
+  InstructionIterator it(lowered);
   while (it.hasNext()) {
     auto nextInst = it.next();
-
     if (!nextInst->isComposite() && nextInst->isEnabled()) {
-
-      if (nextInst->name() == "CNOT") {
-        for (int i = 0; i < r; i++) {
-          auto tmp = nextInst->clone();
-          tmp->setBits(nextInst->bits());
-          f->addInstruction(tmp);
-        }
-      } else {
-        f->addInstruction(nextInst);
-      }
+      pulses.push_back(stretchPulse(nextInst, scale));
     }
   }
+  if (pulses.empty() && function->nInstructions() > 0) {
+    xacc::error("RichExtrap - no pulse calibration for the gates of " +
+                function->name() + ", pulse-stretch requires a pulse backend "
+                "(e.g. an IBM backend with mode = pulse).");
+  }
+  // Bounded: e.g. new parameters of each VQE iteration
+  if (stretchCache.size() > 1024) {
+    stretchCache.clear();
+  }
+  stretchCache.emplace(key, pulses);
+  return pulses;
+}
 
-  //   std::cout << "HELLO: \n" << f->toString("q");
+std::vector<InstPtr>
+RichExtrapDecorator::fold(std::shared_ptr<CompositeInstruction> function,
+                          double scale, double &actualScale) {
+  std::vector<InstPtr> gates, inverses;
+  InstructionIterator it(function);
+  auto provider = xacc::getService<IRProvider>("quantum");
+  while (it.hasNext()) {
+    auto nextInst = it.next();
+    if (!nextInst->isComposite() && nextInst->isEnabled()) {
+      gates.push_back(nextInst);
+      inverses.push_back(inverseGate(provider, nextInst.get()));
+    }
+  }
+  const int nbFoldable =
+      std::count_if(inverses.begin(), inverses.end(),
+                    [](const InstPtr &inst) { return inst != nullptr; });
+  const int nbFolds =
+      nbFoldable > 0 ? std::lround((scale - 1.0) * nbFoldable / 2.0) : 0;
+  actualScale = nbFoldable > 0 ? 1.0 + 2.0 * nbFolds / nbFoldable : 1.0;
 
-  decoratedAccelerator->execute(buffer, f);
+  const auto key = std::make_pair(function->structuralHash(), actualScale);
+  auto iter = foldCache.find(key);
+  if (iter != foldCache.end()) {
+    return iter->second;
+  }
 
-  return;
+  // G (G^dag G)^n, the first (nbFolds % nbFoldable) gates are folded once
+  // more than the others.
+  std::vector<InstPtr> folded;
+  int foldableIdx = 0;
+  for (int i = 0; i < gates.size(); i++) {
+    folded.push_back(gates[i]->clone());
+    if (!inverses[i]) {
+      continue;
+    }
+    const int n = nbFolds / nbFoldable + (foldableIdx < nbFolds % nbFoldable);
+    for (int k = 0; k < n; k++) {
+      folded.push_back(inverses[i]);
+      folded.push_back(gates[i]);
+    }
+    foldableIdx++;
+  }
+  // Bounded: e.g. new parameters of each VQE iteration
+  if (foldCache.size() > 1024) {
+    foldCache.clear();
+  }
+  foldCache.emplace(key, folded);
+  return folded;
 }
 
-void RichExtrapDecorator::execute(
+void RichExtrapDecorator::planScaled(
     std::shared_ptr<AcceleratorBuffer> buffer,
-    const std::vector<std::shared_ptr<CompositeInstruction>> functions) {
+    const std::vector<std::shared_ptr<CompositeInstruction>> &functions,
+    DecoratorStage &stage) {
+  auto provider = xacc::getService<IRProvider>("quantum");
 
-  std::vector<std::shared_ptr<AcceleratorBuffer>> buffers;
+  // All the scales of all the functions, in one submission. Folds with the
+  // same actual scale (few gates) are only executed once.
+  std::vector<std::vector<double>> actualScales(functions.size());
+  std::vector<std::vector<int>> scaledIndices(functions.size());
+  for (int i = 0; i < functions.size(); i++) {
+    for (auto scale : scaleFactors) {
+      double actualScale;
+      auto gates = scaleMode == "pulse-stretch"
+                       ? stretch(functions[i], scale, actualScale)
+                       : fold(functions[i], scale, actualScale);
+      if (std::find(actualScales[i].begin(), actualScales[i].end(),
+                    actualScale) != actualScales[i].end()) {
+        continue;
+      }
+      const auto name = functions[i]->name() + "_scale_" +
+                        std::to_string(actualScales[i].size());
+      // Accelerators may remap the gates in place: each copy is a new gate.
+      auto f = provider->createComposite(name, functions[i]->getVariables());
+      for (auto &gate : gates) {
+        f->addInstruction(gate->clone());
+      }
+      actualScales[i].push_back(actualScale);
+      scaledIndices[i].push_back(stage.circuits.size());
+      stage.circuits.push_back(f);
+    }
+  }
 
-  if (!decoratedAccelerator) {
-    xacc::error("RichExtrap - Null Decorated Accelerator Error");
+  std::vector<std::string> names;
+  for (auto &f : functions) {
+    names.push_back(f->name());
   }
+  const int nbBits = buffer->size();
+  stage.transform =
+      [names, actualScales, scaledIndices,
+       nbBits](const std::vector<std::shared_ptr<AcceleratorBuffer>> &results) {
+        std::vector<std::shared_ptr<AcceleratorBuffer>> extrapolatedResults;
+        for (int i = 0; i < names.size(); i++) {
+          std::vector<double> expVals;
+          for (auto idx : scaledIndices[i]) {
+            expVals.push_back(results[idx]->getExpectationValueZ());
+          }
+
+          // Richardson: the value at 0 of the interpolating polynomial
+          const auto &x = actualScales[i];
+          double extrapolated = 0.0;
+          for (int j = 0; j < x.size(); j++) {
+            double weight = 1.0;
+            for (int k = 0; k < x.size(); k++) {
+              if (k != j) {
+                weight *= x[k] / (x[k] - x[j]);
+              }
+            }
+            extrapolated += weight * expVals[j];
+          }
 
+          auto result = std::make_shared<AcceleratorBuffer>(nbBits);
+          result->setName(names[i]);
+          result->addExtraInfo("exp-val-z", extrapolated);
+          result->addExtraInfo("rich-extrap-scales", x);
+          result->addExtraInfo("rich-extrap-exp-vals", expVals);
+          extrapolatedResults.push_back(result);
+        }
+        return extrapolatedResults;
+      };
+}
+
+void RichExtrapDecorator::planRepeated(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>> &functions,
+    DecoratorStage &stage) {
   if (!xacc::optionExists("rich-extrap-r")) {
     xacc::error(
         "Cannot find rich-extrap-r. Skipping Richardson Extrapolation.");
@@ -87,8 +348,6 @@ void RichExtrapDecorator::execute(
 
   auto provider = xacc::getService<IRProvider>("quantum");
 
-  std::vector<std::shared_ptr<CompositeInstruction>> newFuncs;
-
   for (auto &f : functions) {
     auto newF = provider->createComposite(f->name(), f->getVariables());
 
@@ -98,7 +357,7 @@ void RichExtrapDecorator::execute(
 
       if (!nextInst->isComposite() && nextInst->isEnabled()) {
 
-        if (nextInst->name() == "CNOT") {
+        if (nextInst->opcode() == xacc::GateOpcode::CNOT) {
           for (int i = 0; i < r; i++) {
             auto tmp = nextInst->clone();
             tmp->setBits(nextInst->bits());
@@ -110,12 +369,88 @@ void RichExtrapDecorator::execute(
       }
     }
 
-    // xacc::info("HI: " + newF->toString("q"));
+    stage.circuits.push_back(newF);
+  }
+}
+
+bool RichExtrapDecorator::planStage(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>> &functions,
+    DecoratorStage &stage) {
+  if (!scaleFactors.empty()) {
+    planScaled(buffer, functions, stage);
+  } else {
+    planRepeated(buffer, functions, stage);
+  }
+  return true;
+}
+
+void RichExtrapDecorator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::shared_ptr<CompositeInstruction> function) {
+
+  if (!decoratedAccelerator) {
+    xacc::error("Null Decorated Accelerator Error");
+  }
+
+  if (!scaleFactors.empty()) {
+    auto tmpBuffer = xacc::qalloc(buffer->size());
+    executePipeline(tmpBuffer, {function});
+    for (auto &[key, value] : tmpBuffer->getChildren()[0]->getInformation()) {
+      buffer->addExtraInfo(key, value);
+    }
+    return;
+  }
+
+  if (!xacc::optionExists("rich-extrap-r")) {
+    xacc::error(
+        "Cannot find rich-extrap-r. Skipping Richardson Extrapolation.");
+    return;
+  }
+
+  // Get RO error probs
+  auto r = std::stoi(xacc::getOption("rich-extrap-r"));
+  buffer->addExtraInfo("rich-extrap-r", ExtraInfo(r));
+
+  auto provider = xacc::getService<IRProvider>("quantum");
+
+  auto f =
+      provider->createComposite(function->name(), function->getVariables());
+
+  InstructionIterator it(function);
+  while (it.hasNext()) {
+    auto nextInst = it.next();
+
+    if (!nextInst->isComposite() && nextInst->isEnabled()) {
+
+      if (nextInst->opcode() == xacc::GateOpcode::CNOT) {
+        for (int i = 0; i < r; i++) {
+          auto tmp = nextInst->clone();
+          tmp->setBits(nextInst->bits());
+          f->addInstruction(tmp);
+        }
+      } else {
+        f->addInstruction(nextInst);
+      }
+    }
+  }
+
+  //   std::cout << "HELLO: \n" << f->toString("q");
+
+  decoratedAccelerator->execute(buffer, f);
 
-    newFuncs.push_back(newF);
+  return;
+}
+
+void RichExtrapDecorator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>> functions) {
+
+  if (!decoratedAccelerator) {
+    xacc::error("RichExtrap - Null Decorated Accelerator Error");
   }
 
-  decoratedAccelerator->execute(buffer, newFuncs);
+  executePipeline(buffer, functions);
 }
 
 } // namespace quantum
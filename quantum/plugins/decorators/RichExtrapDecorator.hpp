@@ -14,15 +14,73 @@
 #define XACC_RICHEXTRAPDECORATOR_HPP_
 
 #include "AcceleratorDecorator.hpp"
+#include "xacc.hpp"
+
+#include <map>
 
 namespace xacc {
 
 namespace quantum {
 
+// Richardson (zero-noise) extrapolation.
+// With "scale-factors" (e.g. {1.0, 1.5, 2.0, 3.0}), every function is
+// executed at each noise scale by unitary folding, all in one submission,
+// and its <Z> is extrapolated to the zero noise limit. A scale s folds
+// m = round((s - 1) * d / 2) of the d invertible gates (G -> G G^dag G),
+// spread over the whole circuit, i.e. the actual scale is 1 + 2m/d. The
+// result child of each function holds the extrapolated "exp-val-z" (no
+// counts), and "rich-extrap-scales" / "rich-extrap-exp-vals".
+// With "scale-mode" = "pulse-stretch", the functions are lowered to the
+// pulses of the backend calibrations (ibm-pulse) instead, and scale s
+// stretches the drive and control pulses s times with amplitudes divided
+// by s, i.e. more decoherence without more gates or depth.
+// Otherwise, the CNOTs are repeated "rich-extrap-r" (global option) times.
 class RichExtrapDecorator : public AcceleratorDecorator {
+protected:
+  std::vector<double> scaleFactors;
+  // "fold" (default) or "pulse-stretch"
+  std::string scaleMode = "fold";
+  // Folded gate sequences by (structural hash, scale)
+  std::map<std::pair<uint64_t, double>, std::vector<InstPtr>> foldCache;
+
+  // The gates of function at the given noise scale, and the actual scale
+  std::vector<InstPtr> fold(std::shared_ptr<CompositeInstruction> function,
+                            double scale, double &actualScale);
+  // The stages of the "scale-factors" and "rich-extrap-r" modes
+  // The stretched pulses of function at the given noise scale
+  std::vector<InstPtr> stretch(std::shared_ptr<CompositeInstruction> function,
+                               double scale, double &actualScale);
+  std::map<std::pair<uint64_t, double>, std::vector<InstPtr>> stretchCache;
+  void planScaled(
+      std::shared_ptr<AcceleratorBuffer> buffer,
+      const std::vector<std::shared_ptr<CompositeInstruction>> &functions,
+      DecoratorStage &stage);
+  void planRepeated(
+      std::shared_ptr<AcceleratorBuffer> buffer,
+      const std::vector<std::shared_ptr<CompositeInstruction>> &functions,
+      DecoratorStage &stage);
+
 public:
- const std::vector<std::string> configurationKeys() override {
-      return {};
+  void initialize(const HeterogeneousMap &params = {}) override {
+    if (params.keyExists<std::vector<double>>("scale-factors")) {
+      scaleFactors = params.get<std::vector<double>>("scale-factors");
+      for (auto scale : scaleFactors) {
+        if (scale < 1.0) {
+          xacc::error("Invalid rich-extrap scale factor " +
+                      std::to_string(scale) + ", must be at least 1.");
+        }
+      }
+    }
+    if (params.stringExists("scale-mode")) {
+      scaleMode = params.getString("scale-mode");
+      if (scaleMode != "fold" && scaleMode != "pulse-stretch") {
+        xacc::error("Invalid rich-extrap scale-mode " + scaleMode +
+                    ", valid modes are fold and pulse-stretch.");
+      }
+    }
+  }
+  const std::vector<std::string> configurationKeys() override {
+      return {"scale-factors", "scale-mode"};
   }
   void execute(std::shared_ptr<AcceleratorBuffer> buffer,
                const std::shared_ptr<CompositeInstruction> function) override;
@@ -31,6 +89,12 @@ public:
   execute(std::shared_ptr<AcceleratorBuffer> buffer,
           const std::vector<std::shared_ptr<CompositeInstruction>> functions) override;
 
+  // Fusable in both modes
+  bool planStage(
+      std::shared_ptr<AcceleratorBuffer> buffer,
+      const std::vector<std::shared_ptr<CompositeInstruction>> &functions,
+      DecoratorStage &stage) override;
+
   const std::string name() const override { return "rich-extrap"; }
   const std::string description() const override { return ""; }
 
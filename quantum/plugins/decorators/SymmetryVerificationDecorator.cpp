@@ -0,0 +1,265 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#include "SymmetryVerificationDecorator.hpp"
+#include "IRProvider.hpp"
+#include "InstructionIterator.hpp"
+#include "xacc.hpp"
+#include "xacc_service.hpp"
+
+#include <set>
+#include <sstream>
+
+namespace {
+// Gates that commute with a Z basis measurement
+const std::set<std::string> DIAGONAL_GATES{"I",   "Z", "Rz",  "U1",
+                                           "S",   "Sdg", "T", "Tdg"};
+
+// The filter of a circuit: its measured bits (the bit of a qubit is its
+// Measure index), and the Z masks over them of the verified symmetries.
+struct Filter {
+  std::size_t nbMeasured = 0;
+  std::vector<std::vector<int>> zMasks;
+  std::vector<int> parities;
+};
+
+// Parses "Z0 Z1 Z3" or "-Z0 Z2" into its mask and parity
+std::pair<uint64_t, int> parseSymmetry(const std::string &symmetry) {
+  std::stringstream ss(symmetry);
+  std::string token;
+  uint64_t mask = 0;
+  int parity = 0;
+  bool first = true;
+  while (ss >> token) {
+    if (first && (token[0] == '-' || token[0] == '+')) {
+      parity = token[0] == '-';
+      token = token.substr(1);
+    }
+    first = false;
+    if (token.empty()) {
+      continue;
+    }
+    if (token.size() < 2 || token[0] != 'Z' ||
+        token.find_first_not_of("0123456789", 1) != std::string::npos) {
+      xacc::error("Invalid symmetry " + symmetry +
+                  ", must be a product of Z operators (e.g. Z0 Z1).");
+    }
+    const int qubit = std::stoi(token.substr(1));
+    if (qubit >= 64) {
+      xacc::error("Symmetry verification supports at most 64 qubits.");
+    }
+    mask ^= 1ULL << qubit;
+  }
+  return {mask, parity};
+}
+} // namespace
+
+namespace xacc {
+namespace quantum {
+void SymmetryVerificationDecorator::initialize(const HeterogeneousMap &params) {
+  if (params.keyExists<std::vector<std::string>>("symmetries")) {
+    masks.clear();
+    parities.clear();
+    for (auto &symmetry : params.get<std::vector<std::string>>("symmetries")) {
+      auto [mask, parity] = parseSymmetry(symmetry);
+      masks.push_back(mask);
+      parities.push_back(parity);
+    }
+  } else if (params.keyExists<std::vector<int>>("symmetry-masks")) {
+    const auto gs = params.get<std::vector<int>>("symmetry-masks");
+    std::vector<int> sectors(gs.size(), 1);
+    if (params.keyExists<std::vector<int>>("symmetry-sectors")) {
+      sectors = params.get<std::vector<int>>("symmetry-sectors");
+      if (sectors.size() != gs.size()) {
+        xacc::error("Invalid symmetry-sectors, must have one +1 / -1 entry "
+                    "per symmetry mask.");
+      }
+    }
+    masks.clear();
+    parities.clear();
+    for (int i = 0; i < gs.size(); i++) {
+      if (sectors[i] != 1 && sectors[i] != -1) {
+        xacc::error("Invalid symmetry sector " + std::to_string(sectors[i]) +
+                    ", must be +1 or -1.");
+      }
+      masks.push_back(gs[i]);
+      parities.push_back(sectors[i] == -1);
+    }
+  }
+}
+
+bool SymmetryVerificationDecorator::planStage(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>> &functions,
+    DecoratorStage &stage) {
+  auto provider = xacc::getService<IRProvider>("quantum");
+  std::vector<Filter> filters;
+  for (auto &f : functions) {
+    Filter filter;
+    // Bits in Measure order
+    std::map<std::size_t, int> measuredBits;
+    std::string bufferName;
+    InstructionIterator it(f);
+    while (it.hasNext()) {
+      auto nextInst = it.next();
+      if (nextInst->isEnabled() && !nextInst->isComposite() &&
+          nextInst->name() == "Measure") {
+        measuredBits.emplace(nextInst->bits()[0], measuredBits.size());
+        bufferName = nextInst->getBufferNames().empty()
+                         ? ""
+                         : nextInst->getBufferNames()[0];
+      }
+    }
+    filter.nbMeasured = measuredBits.size();
+    if (measuredBits.empty()) {
+      stage.circuits.push_back(f);
+      filters.emplace_back(filter);
+      continue;
+    }
+
+    // Qubits rotated out of the Z basis in the measurement tail
+    uint64_t rotated = 0;
+    const auto insts = f->getInstructions();
+    for (auto iter = insts.rbegin(); iter != insts.rend(); ++iter) {
+      auto &inst = *iter;
+      if (inst->isComposite() || inst->bits().size() > 1) {
+        break;
+      }
+      if (inst->isEnabled() && inst->name() != "Measure" &&
+          !DIAGONAL_GATES.count(inst->name()) && inst->bits()[0] < 64) {
+        rotated |= 1ULL << inst->bits()[0];
+      }
+    }
+
+    std::vector<std::size_t> extraQubits;
+    for (int m = 0; m < masks.size(); m++) {
+      if (masks[m] & rotated) {
+        continue;
+      }
+      std::vector<int> zMask;
+      for (std::size_t q = 0; q < 64; q++) {
+        if (!((masks[m] >> q) & 1)) {
+          continue;
+        }
+        auto bit = measuredBits.find(q);
+        if (bit == measuredBits.end()) {
+          bit = measuredBits.emplace(q, measuredBits.size()).first;
+          extraQubits.push_back(q);
+        }
+        zMask.push_back(bit->second);
+      }
+      filter.zMasks.push_back(zMask);
+      filter.parities.push_back(parities[m]);
+    }
+
+    if (extraQubits.empty()) {
+      stage.circuits.push_back(f);
+    } else {
+      // The circuit, then the Measures of the other symmetry qubits
+      auto extended = provider->createComposite(f->name(), f->getVariables());
+      extended->setCoefficient(f->getCoefficient());
+      for (auto &arg : f->getArguments()) {
+        extended->addArgument(arg, 0);
+      }
+      for (auto &inst : insts) {
+        extended->addInstruction(inst);
+      }
+      for (auto q : extraQubits) {
+        auto meas = provider->createInstruction("Measure", {q});
+        if (!bufferName.empty()) {
+          meas->setBufferNames({bufferName});
+        }
+        InstructionParameter classicalIdx((int)q);
+        meas->setParameter(0, classicalIdx);
+        extended->addInstruction(meas);
+      }
+      stage.circuits.push_back(extended);
+    }
+    filters.emplace_back(filter);
+  }
+
+  const auto bitOrder =
+      decoratedAccelerator->getBitOrder() == Accelerator::BitOrder::LSB
+          ? AcceleratorBuffer::BitOrder::LSB
+          : AcceleratorBuffer::BitOrder::MSB;
+  stage.transform =
+      [filters, bitOrder](
+          const std::vector<std::shared_ptr<AcceleratorBuffer>> &results) {
+        for (int i = 0; i < results.size(); i++) {
+          auto &filter = filters[i];
+          auto &result = results[i];
+          if (filter.zMasks.empty()) {
+            continue;
+          }
+          auto counts = result->getMeasurementCounts();
+          long long total = 0;
+          for (auto &kv : counts) {
+            total += kv.second;
+          }
+          if (total == 0) {
+            continue;
+          }
+
+          const auto kept =
+              result->postSelect(filter.zMasks, filter.parities, bitOrder);
+          if (kept == 0) {
+            xacc::warning("Symmetry verification discarded all the shots of " +
+                          result->name() + ", keeping them all.");
+            result->setMeasurements(counts);
+          }
+          // Back to the bits measured by the circuit, the extra ones come
+          // last in Measure order
+          const auto nbBits = counts.begin()->first.size();
+          if (nbBits > filter.nbMeasured) {
+            std::vector<int> bits;
+            for (int b = 0; b < filter.nbMeasured; b++) {
+              bits.push_back(bitOrder == AcceleratorBuffer::BitOrder::LSB
+                                 ? b
+                                 : filter.nbMeasured - 1 - b);
+            }
+            result->setMeasurements(result->getMarginalCounts(bits, bitOrder));
+          }
+          result->addExtraInfo("exp-val-z", result->getExpectationValueZ());
+          result->addExtraInfo("symmetry-verification-acceptance",
+                               kept == 0 ? 0.0 : (double)kept / total);
+        }
+        return results;
+      };
+  return true;
+}
+
+void SymmetryVerificationDecorator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::shared_ptr<CompositeInstruction> function) {
+  if (!decoratedAccelerator) {
+    xacc::error("Symmetry Verification - Null Decorated Accelerator Error");
+  }
+  auto tmpBuffer = xacc::qalloc(buffer->size());
+  executePipeline(tmpBuffer, {function});
+  auto result = tmpBuffer->getChildren()[0];
+  buffer->setMeasurements(result->getMeasurementCounts());
+  for (auto &[key, value] : result->getInformation()) {
+    buffer->addExtraInfo(key, value);
+  }
+}
+
+void SymmetryVerificationDecorator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>> functions) {
+  if (!decoratedAccelerator) {
+    xacc::error("Symmetry Verification - Null Decorated Accelerator Error");
+  }
+  executePipeline(buffer, functions);
+}
+
+} // namespace quantum
+} // namespace xacc
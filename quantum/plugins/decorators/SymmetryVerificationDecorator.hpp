@@ -0,0 +1,70 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_SYMMETRYVERIFICATIONDECORATOR_HPP_
+#define XACC_SYMMETRYVERIFICATIONDECORATOR_HPP_
+
+#include "AcceleratorDecorator.hpp"
+
+namespace xacc {
+
+namespace quantum {
+
+// Post-selection of the shots on Z2 symmetries, e.g. the particle-number
+// or spin parities of a chemistry ansatz: the shots that are not in the
+// symmetry sector are discarded from the counts.
+// A symmetry Z^g (bit q of g is qubit q, as the qubit-tapering generators)
+// is verified on the circuits that measure the qubits of g in the Z basis,
+// i.e. without a non-diagonal gate on them in the measurement tail (the
+// top-level gates after the last composite or multi-qubit instruction, as
+// the basis changes of PauliOperator::observe()). The qubits of g that a
+// circuit does not measure get a Measure appended, the counts are filtered
+// then marginalized back to the measured bits of the circuit. Options:
+//   "symmetries"        Z strings, e.g. {"Z0 Z1 Z2 Z3", "-Z0 Z2"} (a
+//                       leading - for the -1 sector), or
+//   "symmetry-masks"    the masks g, with
+//   "symmetry-sectors"  their +1 / -1 eigenvalues (+1 by default).
+// The results get the "symmetry-verification-acceptance" fraction of shots
+// kept; they are left unfiltered (with a warning) if none are.
+class SymmetryVerificationDecorator : public AcceleratorDecorator {
+protected:
+  // Bit q of masks[i] is qubit q, parities[i] is 0 for the +1 sector
+  std::vector<uint64_t> masks;
+  std::vector<int> parities;
+
+public:
+  void initialize(const HeterogeneousMap &params = {}) override;
+  const std::vector<std::string> configurationKeys() override {
+    return {"symmetries", "symmetry-masks", "symmetry-sectors"};
+  }
+
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::shared_ptr<CompositeInstruction> function) override;
+  void
+  execute(std::shared_ptr<AcceleratorBuffer> buffer,
+          const std::vector<std::shared_ptr<CompositeInstruction>> functions) override;
+
+  // Fusable: the (extended) circuits are filtered in place
+  bool planStage(
+      std::shared_ptr<AcceleratorBuffer> buffer,
+      const std::vector<std::shared_ptr<CompositeInstruction>> &functions,
+      DecoratorStage &stage) override;
+
+  const std::string name() const override { return "symmetry-verification"; }
+  const std::string description() const override { return ""; }
+
+  ~SymmetryVerificationDecorator() override {}
+};
+
+} // namespace quantum
+} // namespace xacc
+#endif
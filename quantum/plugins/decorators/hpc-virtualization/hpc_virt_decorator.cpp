@@ -22,13 +22,151 @@
 #include <boost/serialization/vector.hpp>
 
 #include <mpi.h>
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <type_traits>
 
 using namespace boost;
+namespace {
+// Minimal binary encoding of child buffers (name, measurement counts and
+// scalar extra information) for the MPI exchange.
+class PackedBufferWriter {
+public:
+  template <typename T> void write(const T &in_val) {
+    static_assert(std::is_trivially_copyable<T>::value, "POD type required");
+    const auto *bytes = reinterpret_cast<const char *>(&in_val);
+    m_data.insert(m_data.end(), bytes, bytes + sizeof(T));
+  }
+  void write(const std::string &in_str) {
+    write<uint64_t>(in_str.size());
+    m_data.insert(m_data.end(), in_str.begin(), in_str.end());
+  }
+  std::vector<char> &data() { return m_data; }
+
+private:
+  std::vector<char> m_data;
+};
+
+class PackedBufferReader {
+public:
+  PackedBufferReader(const std::vector<char> &in_data) : m_data(in_data) {}
+  bool atEnd() const { return m_pos >= m_data.size(); }
+  template <typename T> T read() {
+    static_assert(std::is_trivially_copyable<T>::value, "POD type required");
+    T result;
+    std::memcpy(&result, m_data.data() + m_pos, sizeof(T));
+    m_pos += sizeof(T);
+    return result;
+  }
+  std::string readString() {
+    const auto length = read<uint64_t>();
+    std::string result(m_data.data() + m_pos, length);
+    m_pos += length;
+    return result;
+  }
+
+private:
+  const std::vector<char> &m_data;
+  size_t m_pos = 0;
+};
+
+// Same order as the ExtraInfo variant types.
+enum class PackedInfoType : uint8_t { Int = 0, Double = 1, String = 2 };
+
+std::vector<char>
+packChildBuffers(std::shared_ptr<xacc::AcceleratorBuffer> in_buffer) {
+  PackedBufferWriter writer;
+  for (auto &child : in_buffer->getChildren()) {
+    writer.write(child->name());
+    const auto counts = child->getMeasurementCounts();
+    writer.write<uint64_t>(counts.size());
+    for (const auto &[bitString, count] : counts) {
+      writer.write(bitString);
+      writer.write<int32_t>(count);
+    }
+    // Only scalar information is exchanged (e.g. exp-val-z)
+    std::vector<std::pair<std::string, xacc::ExtraInfo>> scalarInfo;
+    for (auto &[key, value] : child->getInformation()) {
+      if (value.which() <= static_cast<int>(PackedInfoType::String)) {
+        scalarInfo.emplace_back(key, value);
+      }
+    }
+    writer.write<uint64_t>(scalarInfo.size());
+    for (auto &[key, value] : scalarInfo) {
+      writer.write(key);
+      const auto type = static_cast<PackedInfoType>(value.which());
+      writer.write(type);
+      if (type == PackedInfoType::Int) {
+        writer.write<int32_t>(value.as<int>());
+      } else if (type == PackedInfoType::Double) {
+        writer.write<double>(value.as<double>());
+      } else {
+        writer.write(value.as<std::string>());
+      }
+    }
+  }
+  return std::move(writer.data());
+}
+
+std::vector<std::shared_ptr<xacc::AcceleratorBuffer>>
+unpackChildBuffers(const std::vector<char> &in_data, int in_nbQubits) {
+  std::vector<std::shared_ptr<xacc::AcceleratorBuffer>> result;
+  PackedBufferReader reader(in_data);
+  while (!reader.atEnd()) {
+    auto child = std::make_shared<xacc::AcceleratorBuffer>(reader.readString(),
+                                                           in_nbQubits);
+    const auto nbCounts = reader.read<uint64_t>();
+    for (uint64_t i = 0; i < nbCounts; ++i) {
+      const auto bitString = reader.readString();
+      child->appendMeasurement(bitString, reader.read<int32_t>());
+    }
+    const auto nbInfo = reader.read<uint64_t>();
+    for (uint64_t i = 0; i < nbInfo; ++i) {
+      const auto key = reader.readString();
+      switch (reader.read<PackedInfoType>()) {
+      case PackedInfoType::Int:
+        child->addExtraInfo(key, (int)reader.read<int32_t>());
+        break;
+      case PackedInfoType::Double:
+        child->addExtraInfo(key, reader.read<double>());
+        break;
+      case PackedInfoType::String:
+        child->addExtraInfo(key, reader.readString());
+        break;
+      }
+    }
+    result.emplace_back(child);
+  }
+  return result;
+}
+
+// Default cost estimate of a circuit: number of gates,
+// with multi-qubit gates weighted more (larger simulation kernels, lower
+// hardware fidelity/longer duration).
+double
+estimateCircuitCost(std::shared_ptr<xacc::CompositeInstruction> in_circuit) {
+  constexpr double multiQubitGateWeight = 4.0;
+  double cost = 1.0;
+  xacc::InstructionIterator it(in_circuit);
+  while (it.hasNext()) {
+    auto inst = it.next();
+    if (inst->isComposite() || !inst->isEnabled()) {
+      continue;
+    }
+    cost += inst->bits().size() > 1 ? multiQubitGateWeight : 1.0;
+  }
+  return cost;
+}
+} // namespace
+
 namespace xacc {
 namespace quantum {
 
 void HPCVirtDecorator::initialize(const HeterogeneousMap &params) {
   decoratedAccelerator->initialize(params);
+  // Re-initialized: re-send the communicator on the next execute.
+  comm_accelerator = nullptr;
 
   if (params.keyExists<int>("n-virtual-qpus")) {
     if (qpuComm && n_virtual_qpus != params.get<int>("n-virtual-qpus")) {
@@ -42,6 +180,25 @@ void HPCVirtDecorator::initialize(const HeterogeneousMap &params) {
     n_virtual_qpus = params.get<int>("n-virtual-qpus");
   }
 
+  if (params.stringExists("partition-strategy")) {
+    const auto strategy = params.getString("partition-strategy");
+    if (strategy != "cost" && strategy != "equal-count") {
+      xacc::error("HPCVirtDecorator: unknown partition-strategy '" + strategy +
+                  "'. Valid options are 'cost' and 'equal-count'.");
+    }
+    partition_strategy = strategy;
+  }
+
+  using CostModel = std::function<double(std::shared_ptr<CompositeInstruction>)>;
+  if (params.keyExists<CostModel>("cost-model")) {
+    cost_model = params.get<CostModel>("cost-model");
+    cached_partition_key.clear();
+  }
+
+  if (params.keyExists<bool>("reduce-energy-only")) {
+    reduce_energy_only = params.get<bool>("reduce-energy-only");
+  }
+
   // Initialize MPI together with decorator initialization
   int initialized, threadSupport;
   MPI_Initialized(&initialized);
@@ -58,6 +215,95 @@ void HPCVirtDecorator::initialize(const HeterogeneousMap &params) {
 
 }
 
+void HPCVirtDecorator::set_accelerator_comm() {
+  if (comm_accelerator == decoratedAccelerator.get()) {
+    // Already using the virtual QPU communicator
+    return;
+  }
+  void *qpu_comm_ptr = reinterpret_cast<void *>((MPI_Comm)*qpuComm);
+  decoratedAccelerator->updateConfiguration(
+      {{"mpi-communicator", qpu_comm_ptr}});
+  decoratedAccelerator->setVirtualComm(qpu_comm_ptr);
+  comm_accelerator = decoratedAccelerator.get();
+}
+
+bool HPCVirtDecorator::setup_comms() {
+  if (qpuComm) {
+    return distributed;
+  }
+  mpi::communicator world;
+  int world_rank = world.rank(), world_size = world.size();
+  distributed = world_size >= n_virtual_qpus;
+  if (!distributed) {
+    qpuComm = std::make_shared<boost::mpi::communicator>(world);
+    qpu_color = 0;
+    return false;
+  }
+
+  // Get the color for this rank
+  //int color = world_rank % n_virtual_qpus;
+  int bin_size = world_size / n_virtual_qpus;
+  int bin_remainder = world_size % n_virtual_qpus;
+  if(world_rank < ((bin_size + 1) * bin_remainder)){
+   qpu_color = world_rank / (bin_size + 1); //color = [0..bin_remainder-1]
+  }else{
+   qpu_color = bin_remainder +              //color = [bin_remainder..n_virtual_qpus-1]
+           (world_rank - ((bin_size + 1) * bin_remainder)) / bin_size;
+  }
+
+  // Split the communicator based on the color and use the
+  // original rank for ordering
+  qpuComm = std::make_shared<boost::mpi::communicator>(
+      world.split(qpu_color, world_rank));
+  // Ranks 0 of every sub-group (the ones exchanging the results)
+  rankZeroComm = std::make_shared<boost::mpi::communicator>(
+      world.split(qpuComm->rank() == 0, world_rank));
+  return true;
+}
+
+int HPCVirtDecorator::nbVirtualQpus() {
+  return setup_comms() ? n_virtual_qpus : 1;
+}
+
+int HPCVirtDecorator::virtualQpuIndex() {
+  return setup_comms() ? qpu_color : 0;
+}
+
+std::shared_ptr<Accelerator> HPCVirtDecorator::localAccelerator() {
+  setup_comms();
+  set_accelerator_comm();
+  return decoratedAccelerator;
+}
+
+void HPCVirtDecorator::allReduceSum(std::vector<double> &io_values) {
+  if (!setup_comms()) {
+    // Every rank has all the values
+    return;
+  }
+  // Each virtual QPU contributes once, from its rank 0.
+  if (qpuComm->rank() != 0) {
+    std::fill(io_values.begin(), io_values.end(), 0.0);
+  }
+  mpi::communicator world;
+  MPI_Allreduce(MPI_IN_PLACE, io_values.data(), io_values.size(), MPI_DOUBLE,
+                MPI_SUM, (MPI_Comm)world);
+}
+
+std::pair<double, int> HPCVirtDecorator::allReduceMaxLoc(double in_value,
+                                                         int in_index) {
+  if (!setup_comms()) {
+    return {in_value, in_index};
+  }
+  struct {
+    double value;
+    int index;
+  } local{in_value, in_index}, global;
+  mpi::communicator world;
+  MPI_Allreduce(&local, &global, 1, MPI_DOUBLE_INT, MPI_MAXLOC,
+                (MPI_Comm)world);
+  return {global.value, global.index};
+}
+
 void HPCVirtDecorator::updateConfiguration(const HeterogeneousMap &config) {
   decoratedAccelerator->updateConfiguration(config);
 }
@@ -90,153 +336,177 @@ void HPCVirtDecorator::execute(
   // Get the rank and size in the original communicator
   int world_rank = world.rank(), world_size = world.size();
 
-  if (world_size < n_virtual_qpus) {
+  if (!setup_comms()) {
     // The number of MPI processes is less than the number of requested virtual
     // QPUs, just execute as if there is only one virtual QPU and give the QPU
     // the whole MPI_COMM_WORLD.
     xacc::warning("MPI size < Number of virtual QPUs. Will perform serial execution " + std::to_string(world_size) + "x times.");
-    void *qpu_comm_ptr = reinterpret_cast<void *>((MPI_Comm)world);
-    if (!qpuComm) {
-      qpuComm = std::make_shared<boost::mpi::communicator>(world);
-    }
-    decoratedAccelerator->updateConfiguration(
-        {{"mpi-communicator", qpu_comm_ptr}});
-    decoratedAccelerator->setVirtualComm(qpu_comm_ptr);
+    set_accelerator_comm();
     // just execute
     decoratedAccelerator->execute(buffer, functions);
     return;
   }
 
   xacc::info("MPI size allows parallel QPU execution.");
-
-  // Get the color for this rank
-  //int color = world_rank % n_virtual_qpus;
-  int bin_size = world_size / n_virtual_qpus;
-  int bin_remainder = world_size % n_virtual_qpus;
-  int color = 0;
-  if(world_rank < ((bin_size + 1) * bin_remainder)){
-   color = world_rank / (bin_size + 1); //color = [0..bin_remainder-1]
-  }else{
-   color = bin_remainder +              //color = [bin_remainder..n_virtual_qpus-1]
-           (world_rank - ((bin_size + 1) * bin_remainder)) / bin_size;
-  }
-
-  // Split the communicator based on the color and use the
-  // original rank for ordering
-  if (!qpuComm) {
-    // Splits MPI_COMM_WORLD into sub-communicators if not already.
-    qpuComm = std::make_shared<boost::mpi::communicator>(
-        world.split(color, world_rank));
-  }
+  const int color = qpu_color;
   auto qpu_comm = *qpuComm;
 
   // current rank now has a color to indicate which sub-comm it belongs to
-  // Give that sub communicator to the accelerator
-  void *qpu_comm_ptr = reinterpret_cast<void *>((MPI_Comm)qpu_comm);
-  decoratedAccelerator->updateConfiguration(
-      {{"mpi-communicator", qpu_comm_ptr}});
-  decoratedAccelerator->setVirtualComm(qpu_comm_ptr);
+  // Give that sub communicator to the accelerator (once per session)
+  set_accelerator_comm();
 
   // Everybody split the CompositeInstructions vector into n_virtual_qpu
   // segments
-  auto split_vecs = split_vector(functions, n_virtual_qpus);
+  auto split_vecs = partition_strategy == "cost"
+                        ? partition_by_cost(functions, n_virtual_qpus)
+                        : split_vector(functions, n_virtual_qpus);
+  split_vecs.resize(n_virtual_qpus);
 
   // Get the segment corresponding to this color
   auto my_circuits = split_vecs[color];
 
   // Create a local buffer and execute
   auto my_buffer = xacc::qalloc(buffer->size());
-  decoratedAccelerator->execute(my_buffer, my_circuits);
-
-  // Create a mapping of all local buffer names to the buffer
-  std::map<std::string, std::shared_ptr<AcceleratorBuffer>>
-      local_name_to_buffer;
-  for (auto &child : my_buffer->getChildren()) {
-    local_name_to_buffer.insert({child->name(), child});
-  }
-
-  // Every sub-group compute local energy
-  double local_energy = 0.0;
-  for (auto &my_circuit : my_circuits) {
-    local_energy +=
-        std::real(my_circuit->getCoefficient()) *
-        local_name_to_buffer[my_circuit->name()]->getExpectationValueZ();
-  }
-  
-  // for all rank 0s on qpu_comms, split
-  // and add them to a new communicator, then
-  // all_gather each local_energy to all these ranks
-  auto split_along_rank_zeros = world.split(qpu_comm.rank() == 0, world_rank);
-  double global_energy = 0.0;
-  if (qpu_comm.rank() == 0) {
-    
-    // This will put every computed local_energy into each
-    // qpu sub-comm group, but on rank 0 only
-    std::vector<double> all_local_energies;
-    mpi::all_gather(split_along_rank_zeros, local_energy, all_local_energies);
-    // Sum them all up on all rank 0s to get the global energy
-    global_energy =
-        std::accumulate(all_local_energies.begin(), all_local_energies.end(),
-                        decltype(all_local_energies)::value_type(0));
+  if (!my_circuits.empty()) {
+    decoratedAccelerator->execute(my_buffer, my_circuits);
   }
 
-  qpu_comm.barrier();
+  if (reduce_energy_only) {
+    // Only the aggregated energy is needed: a single reduction over all
+    // ranks (each sub-group contributes its energy once, from its rank 0).
+    double local_energy = 0.0;
+    if (qpu_comm.rank() == 0) {
+      for (auto &f : my_circuits) {
+        auto child = my_buffer->getChildren(f->name());
+        if (!child.empty()) {
+          local_energy += std::real(f->getCoefficient()) *
+                          child.front()->getExpectationValueZ();
+        }
+      }
+    }
+    double global_energy = 0.0;
+    MPI_Request request;
+    MPI_Iallreduce(&local_energy, &global_energy, 1, MPI_DOUBLE, MPI_SUM,
+                   (MPI_Comm)world, &request);
+    // Overlap the reduction with the bookkeeping of the local results
+    for (auto &[k, v] : my_buffer->getInformation()) {
+      buffer->addExtraInfo(k, v);
+    }
+    MPI_Wait(&request, MPI_STATUS_IGNORE);
+    buffer->addExtraInfo("__internal__decorator_aggregate_vqe__",
+                         global_energy);
+    buffer->addExtraInfo("rank", world_rank);
+    return;
+  }
 
-  // Now broadcast that global_energy to all
-  // other ranks in the sub groups
-  mpi::broadcast(qpu_comm, global_energy, 0);
+  // Ranks 0 of every sub-group exchange their (packed) child buffers,
+  // then broadcast the full result to the other ranks of the sub-group.
+  auto split_along_rank_zeros = *rankZeroComm;
+  std::vector<char> all_packed_children;
+  if (qpu_comm.rank() == 0) {
+    const auto local_packed_children = packChildBuffers(my_buffer);
+    const int local_size = local_packed_children.size();
+    std::vector<int> all_sizes(split_along_rank_zeros.size());
+    MPI_Allgather(&local_size, 1, MPI_INT, all_sizes.data(), 1, MPI_INT,
+                  (MPI_Comm)split_along_rank_zeros);
+    std::vector<int> displacements(all_sizes.size(), 0);
+    std::partial_sum(all_sizes.begin(), all_sizes.end() - 1,
+                     displacements.begin() + 1);
+    all_packed_children.resize(displacements.back() + all_sizes.back());
+    MPI_Allgatherv(local_packed_children.data(), local_size, MPI_BYTE,
+                   all_packed_children.data(), all_sizes.data(),
+                   displacements.data(), MPI_BYTE,
+                   (MPI_Comm)split_along_rank_zeros);
+  }
 
-  // Setup a barrier
-  qpu_comm.barrier();
-  world.barrier();
+  uint64_t total_size = all_packed_children.size();
+  MPI_Bcast(&total_size, 1, MPI_UINT64_T, 0, (MPI_Comm)qpu_comm);
+  all_packed_children.resize(total_size);
+  MPI_Bcast(all_packed_children.data(), total_size, MPI_BYTE, 0,
+            (MPI_Comm)qpu_comm);
+
+  // Every rank now has the children of all the sub-groups:
+  // add them to the incoming buffer, in the same order as the functions.
+  std::map<std::string, std::shared_ptr<AcceleratorBuffer>> name_to_buffer;
+  for (auto &child : unpackChildBuffers(all_packed_children, buffer->size())) {
+    name_to_buffer.insert({child->name(), child});
+  }
 
-  // every rank should have global_energy now
-  buffer->addExtraInfo("__internal__decorator_aggregate_vqe__", global_energy);
+  double global_energy = 0.0;
+  for (auto &f : functions) {
+    auto iter = name_to_buffer.find(f->name());
+    if (iter == name_to_buffer.end()) {
+      xacc::error("HPCVirtDecorator: no result for circuit '" + f->name() +
+                  "'.");
+    }
+    buffer->appendChild(f->name(), iter->second);
+    global_energy +=
+        std::real(f->getCoefficient()) * iter->second->getExpectationValueZ();
+  }
 
-  // Strategy:
-  // Every process in a sub-communicator has the same
-  // children buffer data. I want each sub-group to share
-  // its results with the other subgroups. My thinking is
-  // to do an all_gather on all world ranks, all ranks will then
-  // have multiple copies of the data strings, so lets filter them
-  // out by using a std::set. Then just load the buffers and add them
-  // to the buffer.
-
-  // Need to distribute resultant children buffers to all ranks
-  //   std::vector<std::vector<std::string>> all_child_buffer_strings;
-  //   mpi::all_gather(world, my_child_buffer_strings,
-  //   all_child_buffer_strings);
-
-  //   // Everyone has all copies of child buffer strings, filter them out to be
-  //   // unique
-  //   std::set<std::string> unique_buffer_strings;
-  //   for (auto &child_buffer_strings : all_child_buffer_strings) {
-  //     for (auto child_buffer_string : child_buffer_strings) {
-  //       unique_buffer_strings.insert(child_buffer_string);
-  //     }
-  //   }
-
-  //   // everyone add the children buffers to the incoming buffer
-  //   std::map<std::string, std::shared_ptr<AcceleratorBuffer>> name_to_buffer;
-  //   for (auto &buffer_string : unique_buffer_strings) {
-  //     auto child_buffer = xacc::qalloc(buffer->size());
-  //     std::istringstream s(buffer_string);
-  //     child_buffer->load(s);
-  //     name_to_buffer.insert({child_buffer->name(), child_buffer});
-  //   }
-
-  //   // buffers need to be in same order as functions coming in
-  //   for (auto &f : functions) {
-  //     buffer->appendChild(f->name(), name_to_buffer[f->name()]);
-  //   }
-
-  //   qpu_comm.barrier();
-  //   world.barrier();
+  // Keep posting the aggregated energy for clients that rely on it.
+  buffer->addExtraInfo("__internal__decorator_aggregate_vqe__", global_energy);
 
   buffer->addExtraInfo("rank", world_rank);
   return;
 }
 
+std::vector<std::vector<std::shared_ptr<CompositeInstruction>>>
+HPCVirtDecorator::partition_by_cost(
+    const std::vector<std::shared_ptr<CompositeInstruction>> &functions,
+    size_t n) {
+  // The observed circuits of a VQE are re-generated every iteration,
+  // but the cost only depends on their structure: reuse the partition.
+  std::vector<std::string> key;
+  key.reserve(functions.size());
+  for (auto &f : functions) {
+    key.emplace_back(f->name());
+  }
+  if (key != cached_partition_key || cached_partition.size() != n) {
+    cached_partition = compute_cost_partition(functions, n);
+    cached_partition_key = std::move(key);
+  }
+
+  std::vector<std::vector<std::shared_ptr<CompositeInstruction>>> outVec(n);
+  for (size_t i = 0; i < n; ++i) {
+    for (const auto idx : cached_partition[i]) {
+      outVec[i].emplace_back(functions[idx]);
+    }
+  }
+  return outVec;
+}
+
+std::vector<std::vector<size_t>> HPCVirtDecorator::compute_cost_partition(
+    const std::vector<std::shared_ptr<CompositeInstruction>> &functions,
+    size_t n) {
+  std::vector<double> costs;
+  costs.reserve(functions.size());
+  for (auto &f : functions) {
+    costs.emplace_back(cost_model ? cost_model(f) : estimateCircuitCost(f));
+  }
+
+  // Most expensive first (stable: ties keep the input order)
+  std::vector<size_t> order(functions.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t a, size_t b) { return costs[a] > costs[b]; });
+
+  std::vector<double> loads(n, 0.0);
+  std::vector<std::vector<size_t>> bins(n);
+  for (const auto idx : order) {
+    const size_t bin = std::distance(
+        loads.begin(), std::min_element(loads.begin(), loads.end()));
+    loads[bin] += costs[idx];
+    bins[bin].emplace_back(idx);
+  }
+
+  for (auto &bin : bins) {
+    // Keep the original order within a segment.
+    std::sort(bin.begin(), bin.end());
+  }
+  return bins;
+}
+
 void HPCVirtTearDown::tearDown() {
   int finalized, initialized;
   MPI_Initialized(&initialized);
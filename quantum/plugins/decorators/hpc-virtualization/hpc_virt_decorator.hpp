@@ -14,7 +14,9 @@
 #define XACC_HPC_VIRT_DECORATOR_HPP_
 
 #include "AcceleratorDecorator.hpp"
+#include "DistributedExecution.hpp"
 #include "TearDown.hpp"
+#include <functional>
 namespace boost {
 namespace mpi {
 // Forward declaration
@@ -25,12 +27,31 @@ namespace xacc {
 
 namespace quantum {
 
-class HPCVirtDecorator : public AcceleratorDecorator {
+class HPCVirtDecorator : public AcceleratorDecorator,
+                         public DistributedExecution {
 protected:
 
   int n_virtual_qpus = 1;
   // The MPI communitor for each QPU.
   std::shared_ptr<boost::mpi::communicator> qpuComm;
+  // How to distribute the circuits among the virtual QPUs:
+  // "cost" (balance the estimated cost) or "equal-count".
+  std::string partition_strategy = "cost";
+  // Optional user-supplied cost model, default to the gate-based estimate.
+  std::function<double(std::shared_ptr<CompositeInstruction>)> cost_model;
+  // Only reduce the total energy (no child buffers gathered).
+  bool reduce_energy_only = false;
+  // Session state, i.e. kept across execute() calls (e.g. VQE iterations):
+  // sub-communicator of the sub-group ranks 0,
+  std::shared_ptr<boost::mpi::communicator> rankZeroComm;
+  // the accelerator which already has the QPU communicator,
+  const Accelerator *comm_accelerator = nullptr;
+  // and the last cost-based partition (circuit indices), keyed by names.
+  std::vector<std::string> cached_partition_key;
+  std::vector<std::vector<size_t>> cached_partition;
+  // The virtual QPU of this rank, if the MPI size allows parallel execution
+  int qpu_color = 0;
+  bool distributed = false;
 
 
 public:
@@ -46,6 +67,14 @@ public:
                const std::vector<std::shared_ptr<CompositeInstruction>>
                    functions) override;
 
+  // DistributedExecution: the classical work of the algorithms
+  int nbVirtualQpus() override;
+  int virtualQpuIndex() override;
+  std::shared_ptr<Accelerator> localAccelerator() override;
+  void allReduceSum(std::vector<double> &io_values) override;
+  std::pair<double, int> allReduceMaxLoc(double in_value,
+                                         int in_index) override;
+
   const std::string name() const override { return "hpc-virtualization"; }
   const std::string description() const override { return ""; }
 
@@ -73,6 +102,23 @@ private:
 
     return outVec;
   }
+
+  // Longest-processing-time (LPT) greedy partitioning:
+  // the most expensive circuits are assigned first, each one to the currently
+  // least loaded virtual QPU. This is deterministic, i.e. all ranks compute
+  // the same partition. Always returns n (possibly empty) segments.
+  std::vector<std::vector<std::shared_ptr<CompositeInstruction>>>
+  partition_by_cost(
+      const std::vector<std::shared_ptr<CompositeInstruction>> &functions,
+      size_t n);
+  std::vector<std::vector<size_t>> compute_cost_partition(
+      const std::vector<std::shared_ptr<CompositeInstruction>> &functions,
+      size_t n);
+  // Pass the virtual QPU communicator to the decorated accelerator.
+  void set_accelerator_comm();
+  // Splits MPI_COMM_WORLD into the virtual QPU communicators (once), returns
+  // false if the MPI size is less than the number of virtual QPUs.
+  bool setup_comms();
 };
 
 class HPCVirtTearDown : public xacc::TearDown {
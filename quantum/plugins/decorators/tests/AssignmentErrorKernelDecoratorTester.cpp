@@ -130,6 +130,47 @@ Measure(q[1]);
   }
 }
 
+TEST(AssignmentErrorKernelDecoratorTest, checkTensored) {
+  if (xacc::hasAccelerator("aer")) {
+    auto accelerator = xacc::getAccelerator(
+        "aer", {std::make_pair("shots", 4096),
+                std::make_pair("backend", "ibmq_johannesburg"),
+                std::make_pair("readout_error", true),
+                std::make_pair("gate_error", false),
+                std::make_pair("thermal_relaxation", false)});
+    xacc::qasm(R"(
+.compiler xasm
+.circuit ghz
+.qbit q
+H(q[0]);
+CX(q[0], q[1]);
+CX(q[1], q[2]);
+Measure(q[0]);
+Measure(q[1]);
+Measure(q[2]);
+)");
+    auto ghz = xacc::getCompiled("ghz");
+    auto buffer = xacc::qalloc(3);
+    auto decorator =
+        xacc::getService<AcceleratorDecorator>("assignment-error-kernel");
+    // Per-qubit matrices: 2 calibration circuits
+    decorator->initialize({std::make_pair("gen-kernel", true),
+                           std::make_pair("multiplex", true),
+                           std::make_pair("cluster-size", 1)});
+    decorator->setDecorated(accelerator);
+    decorator->execute(buffer, ghz);
+    buffer->print();
+
+    auto raw = mpark::get<std::map<std::string, double>>(
+        buffer->getInformation("unmitigated-counts"));
+    const double rawGhz = (raw["000"] + raw["111"]) / 4096;
+    const double mitigatedGhz = buffer->computeMeasurementProbability("000") +
+                                buffer->computeMeasurementProbability("111");
+    EXPECT_GT(mitigatedGhz, rawGhz);
+    EXPECT_NEAR(mitigatedGhz, 1.0, 0.05);
+  }
+}
+
 int main(int argc, char **argv) {
   int ret = 0;
   xacc::Initialize();
@@ -0,0 +1,54 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include <gtest/gtest.h>
+#include "xacc.hpp"
+#include "CalibrationCache.hpp"
+#include <cstdio>
+#include <unistd.h>
+
+using namespace xacc::quantum;
+
+TEST(CalibrationCacheTester, checkSharedEntries) {
+  const std::string cacheFile =
+      "/tmp/xacc_calibration_cache_" + std::to_string(getpid()) + ".json";
+  std::remove(cacheFile.c_str());
+
+  CalibrationCache writer;
+  writer.initialize({std::make_pair("calibration-cache-file", cacheFile)});
+  std::vector<std::vector<double>> data;
+  EXPECT_FALSE(writer.load("backend|2020-01-01", data));
+  writer.save("backend|2020-01-01", {{0.9, 0.1, 0.05, 0.95}, {0.01}});
+
+  // Another instance (e.g. process) sees it, for that calibration only
+  CalibrationCache reader(3600, cacheFile);
+  EXPECT_TRUE(reader.load("backend|2020-01-01", data));
+  EXPECT_EQ(2, data.size());
+  EXPECT_EQ(std::vector<double>({0.9, 0.1, 0.05, 0.95}), data[0]);
+  EXPECT_EQ(std::vector<double>({0.01}), data[1]);
+  EXPECT_FALSE(reader.load("backend|2020-01-02", data));
+
+  // Disabled with a zero ttl
+  CalibrationCache disabled(0, cacheFile);
+  EXPECT_FALSE(disabled.load("backend|2020-01-01", data));
+
+  std::remove(cacheFile.c_str());
+  std::remove((cacheFile + ".lock").c_str());
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize();
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
@@ -0,0 +1,89 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include <gtest/gtest.h>
+#include "xacc.hpp"
+#include "FederationDecorator.hpp"
+#include "xacc_service.hpp"
+
+using namespace xacc;
+
+TEST(FederationDecoratorTester, checkShares) {
+  using quantum::FederationDecorator;
+  EXPECT_EQ(FederationDecorator::shares(10, {1.0, 1.0}, {0, 0}),
+            (std::vector<size_t>{5, 5}));
+  EXPECT_EQ(FederationDecorator::shares(10, {3.0, 1.0}, {0, 0}),
+            (std::vector<size_t>{8, 2}));
+  EXPECT_EQ(FederationDecorator::shares(3, {1.0, 1.0, 1.0, 1.0}, {0, 0, 0, 0}),
+            (std::vector<size_t>{1, 1, 1, 0}));
+  // The fast member is capped, the rest is balanced over the others.
+  EXPECT_EQ(FederationDecorator::shares(12, {10.0, 1.0, 1.0}, {4, 10, 10}),
+            (std::vector<size_t>{4, 4, 4}));
+  // Not enough capacity: proportional (several jobs per member)
+  EXPECT_EQ(FederationDecorator::shares(12, {2.0, 1.0}, {2, 2}),
+            (std::vector<size_t>{8, 4}));
+  EXPECT_EQ(FederationDecorator::shares(5, {0.0, 0.0}, {0, 0}),
+            (std::vector<size_t>{3, 2}));
+}
+
+TEST(FederationDecoratorTester, checkExecute) {
+  if (xacc::hasAccelerator("qpp")) {
+    auto acc = xacc::getAccelerator("qpp", {{"shots", 1024}});
+    // qpp twice: a cloned instance
+    auto federation =
+        std::dynamic_pointer_cast<quantum::FederationDecorator>(
+            xacc::getAcceleratorDecorator(
+                "federation", acc,
+                {{"shots", 1024},
+                 {"accelerators", std::vector<std::string>{"qpp"}},
+                 {"capacities", std::vector<int>{2, 0}}}));
+    EXPECT_TRUE(federation != nullptr);
+    EXPECT_EQ(federation->members().size(), 2);
+    EXPECT_TRUE(federation->members()[0] != federation->members()[1]);
+
+    // X on qubit i % 2 of circuit i: results in the order of the circuits
+    std::vector<std::shared_ptr<CompositeInstruction>> circuits;
+    auto provider = xacc::getIRProvider("quantum");
+    for (int i = 0; i < 7; ++i) {
+      auto circuit = provider->createComposite("circuit_" + std::to_string(i));
+      circuit->addInstruction(provider->createInstruction("X", {i % 2}));
+      circuit->addInstruction(provider->createInstruction("Measure", {0}));
+      circuit->addInstruction(provider->createInstruction("Measure", {1}));
+      circuits.emplace_back(circuit);
+    }
+    auto buffer = xacc::qalloc(2);
+    federation->execute(buffer, circuits);
+    EXPECT_EQ(buffer->nChildren(), circuits.size());
+    const auto children = buffer->getChildren();
+    for (int i = 0; i < circuits.size(); ++i) {
+      EXPECT_EQ(children[i]->name(), circuits[i]->name());
+      // Qubit q is the character q
+      const std::string expected = i % 2 == 0 ? "10" : "01";
+      EXPECT_EQ(children[i]->getMeasurementCounts()[expected], 1024);
+    }
+    const auto shares =
+        buffer->getInformation("federation-shares").as<std::vector<int>>();
+    EXPECT_EQ(shares[0] + shares[1], circuits.size());
+    // Estimated from the jobs
+    for (auto throughput : federation->throughputs()) {
+      EXPECT_GT(throughput, 0.0);
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize();
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
@@ -98,6 +98,116 @@ TEST(ImprovedSamplingDecoratorTester, checkMultiple) {
     }
   }
 }
+TEST(ImprovedSamplingDecoratorTester, checkVarianceAllocation) {
+  int shots = 1024;
+  int nExecs = 4;
+
+  if (xacc::hasAccelerator("qpp")) {
+    auto acc = xacc::getAccelerator("qpp", {std::make_pair("shots", shots)});
+    auto buffer = xacc::qalloc(1);
+
+    auto compiler = xacc::getService<xacc::Compiler>("xasm");
+    auto ir = compiler->compile(R"src(__qpu__ void alloc_f(qbit q) {
+       H(q[0]);
+       Measure(q[0]);
+       }
+       __qpu__ void alloc_g(qbit q) {
+       X(q[0]);
+       Measure(q[0]);
+       } )src",
+                                acc);
+
+    auto decorator =
+        xacc::getService<AcceleratorDecorator>("improved-sampling");
+    decorator->setDecorated(acc);
+    xacc::setOption("sampler-n-execs", std::to_string(nExecs));
+    xacc::setOption("sampler-allocation", "variance");
+
+    decorator->execute(buffer,
+                       {ir->getComposite("alloc_f"), ir->getComposite("alloc_g")});
+    xacc::setOption("sampler-allocation", "uniform");
+
+    // Same total, all the extra runs go to the term with a nonzero variance
+    std::map<std::string, int> nshots;
+    for (auto &b : buffer->getChildren()) {
+      for (auto &kv : b->getMeasurementCounts()) {
+        nshots[b->name()] += kv.second;
+      }
+    }
+    EXPECT_EQ((2 * nExecs - 1) * shots, nshots["alloc_f"]);
+    EXPECT_EQ(shots, nshots["alloc_g"]);
+  }
+}
+
+// Counts the executions of the decorated accelerator (not fusable)
+class CountingDecorator : public AcceleratorDecorator {
+public:
+  int nbExecutions = 0;
+  int nbCircuits = 0;
+  const std::vector<std::string> configurationKeys() override { return {}; }
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::shared_ptr<CompositeInstruction> function) override {
+    nbExecutions++;
+    nbCircuits++;
+    decoratedAccelerator->execute(buffer, function);
+  }
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::vector<std::shared_ptr<CompositeInstruction>>
+                   functions) override {
+    nbExecutions++;
+    nbCircuits += functions.size();
+    decoratedAccelerator->execute(buffer, functions);
+  }
+  const std::string name() const override { return "counting"; }
+  const std::string description() const override { return ""; }
+};
+
+TEST(ImprovedSamplingDecoratorTester, checkFusedStack) {
+  int shots = 1024;
+  int nExecs = 3;
+
+  if (xacc::hasAccelerator("qpp")) {
+    auto acc = xacc::getAccelerator("qpp", {std::make_pair("shots", shots)});
+    auto counting = std::make_shared<CountingDecorator>();
+    counting->setDecorated(acc);
+    auto roError = xacc::getService<AcceleratorDecorator>("ro-error");
+    roError->setDecorated(counting);
+    auto decorator =
+        xacc::getService<AcceleratorDecorator>("improved-sampling");
+    decorator->setDecorated(roError);
+    xacc::setOption("sampler-n-execs", std::to_string(nExecs));
+
+    auto compiler = xacc::getService<xacc::Compiler>("xasm");
+    auto ir = compiler->compile(R"src(__qpu__ void fused_f(qbit q) {
+       H(q[0]);
+       Measure(q[0]);
+       }
+       __qpu__ void fused_g(qbit q) {
+       X(q[0]);
+       Measure(q[0]);
+       } )src",
+                                acc);
+    auto buffer = xacc::qalloc(1);
+    decorator->execute(buffer,
+                       {ir->getComposite("fused_f"), ir->getComposite("fused_g")});
+
+    // All the runs in a single execution of the base accelerator
+    EXPECT_EQ(1, counting->nbExecutions);
+    EXPECT_EQ(2 * nExecs, counting->nbCircuits);
+    auto buffers = buffer->getChildren();
+    EXPECT_EQ(2, buffers.size());
+    for (auto &b : buffers) {
+      int nshots = 0;
+      for (auto &kv : b->getMeasurementCounts()) {
+        nshots += kv.second;
+      }
+      EXPECT_EQ(nExecs * shots, nshots);
+    }
+    EXPECT_EQ("fused_g", buffers[1]->name());
+    EXPECT_NEAR(-1.0, buffers[1]->getExpectationValueZ(), 1e-12);
+  }
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize();
   ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,123 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#include <gtest/gtest.h>
+#include "xacc.hpp"
+
+#include "xacc_service.hpp"
+#include "AcceleratorDecorator.hpp"
+#include "Gate.hpp"
+#include "NoiseModel.hpp"
+
+#include <cmath>
+
+using namespace xacc;
+
+namespace {
+// Two-qubit depolarizing noise (probability p) after each CNOT
+class CNOTDepolarizingModel : public NoiseModel {
+public:
+  explicit CNOTDepolarizingModel(double in_p) : p(in_p) {}
+  void initialize(const HeterogeneousMap &params) override {}
+  std::string toJson() const override { return "{}"; }
+  RoErrors readoutError(size_t qubitIdx) const override { return {0.0, 0.0}; }
+  std::vector<RoErrors> readoutErrors() const override { return {}; }
+  std::vector<NoiseChannelKraus>
+  getNoiseChannels(xacc::quantum::Gate &gate) const override {
+    if (gate.name() != "CNOT") {
+      return {};
+    }
+    using Mat = NoiseChannelKraus::KrausMatType;
+    const std::complex<double> I(0, 1);
+    const std::vector<Mat> paulis{{{1, 0}, {0, 1}},
+                                  {{0, 1}, {1, 0}},
+                                  {{0, -I}, {I, 0}},
+                                  {{1, 0}, {0, -1}}};
+    std::vector<Mat> mats;
+    for (int a = 0; a < 4; a++) {
+      for (int b = 0; b < 4; b++) {
+        const double scale = a + b == 0 ? std::sqrt(1.0 - p)
+                                        : std::sqrt(p / 15.0);
+        Mat mat(4, std::vector<std::complex<double>>(4));
+        for (int r = 0; r < 4; r++) {
+          for (int c = 0; c < 4; c++) {
+            mat[r][c] = scale * paulis[a][r >> 1][c >> 1] * paulis[b][r & 1][c & 1];
+          }
+        }
+        mats.push_back(mat);
+      }
+    }
+    return {NoiseChannelKraus(gate.bits(), mats, KrausMatBitOrder::MSB)};
+  }
+  double gateErrorProb(xacc::quantum::Gate &gate) const override {
+    return gate.name() == "CNOT" ? p : 0.0;
+  }
+  size_t nQubits() const override { return 2; }
+  std::vector<double> averageSingleQubitGateFidelity() const override {
+    return {1.0, 1.0};
+  }
+  std::vector<std::tuple<size_t, size_t, double>>
+  averageTwoQubitGateFidelity() const override {
+    return {};
+  }
+  const std::string name() const override { return "cnot-depolarizing"; }
+  const std::string description() const override { return ""; }
+
+private:
+  double p;
+};
+} // namespace
+
+TEST(PECDecoratorTester, checkDepolarizing) {
+  auto model = std::make_shared<CNOTDepolarizingModel>(0.1);
+  auto acc = xacc::getAccelerator(
+      "qpp", {{"sim-type", "density_matrix"},
+              {"noise-model", std::dynamic_pointer_cast<NoiseModel>(model)}});
+
+  auto compiler = xacc::getService<xacc::Compiler>("xasm");
+  auto ir = compiler->compile(R"(__qpu__ void pec_foo(qbit q) {
+       Rx(q[0], 0.5);
+       CNOT(q[0], q[1]);
+       Measure(q[0]);
+       })",
+                              acc);
+  auto f = ir->getComposite("pec_foo");
+
+  auto noisy = xacc::qalloc(2);
+  acc->execute(noisy, f);
+  EXPECT_GT(std::abs(noisy->getExpectationValueZ() - std::cos(0.5)), 0.05);
+
+  auto decorator = xacc::getAcceleratorDecorator(
+      "pec", acc,
+      {{"noise-model", std::dynamic_pointer_cast<NoiseModel>(model)},
+       {"samples", 4000},
+       {"seed", 7}});
+  auto buffer = xacc::qalloc(2);
+  decorator->execute(buffer, {f});
+
+  EXPECT_EQ(1, buffer->nChildren());
+  auto result = buffer->getChildren()[0];
+  EXPECT_EQ("pec_foo", result->name());
+  EXPECT_GT(mpark::get<double>(result->getInformation("pec-gamma")), 1.0);
+  EXPECT_EQ(4000, mpark::get<int>(result->getInformation("pec-samples")));
+  // The 16 two-qubit Paulis after the CNOT
+  EXPECT_LE(mpark::get<int>(result->getInformation("pec-circuits")), 16);
+  EXPECT_NEAR(std::cos(0.5), result->getExpectationValueZ(), 0.06);
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize();
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
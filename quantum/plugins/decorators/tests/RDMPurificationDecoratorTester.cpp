@@ -120,6 +120,21 @@ TEST(RDMPurificationDecoratorTester, checkGround) {
                      buffers[0]->getInformation("purified-energy"))
               << "\n";
 
+    EXPECT_EQ(buffers[0]->getInformation("fixed-rdm").as<std::vector<double>>().size(), 256);
+
+    // The energy weights are reused by the next executions
+    auto buffer2 = xacc::qalloc(4);
+    accd->execute(buffer2, functions);
+    EXPECT_NEAR(mpark::get<double>(
+                    buffer2->getChildren()[0]->getInformation("purified-energy")),
+                mpark::get<double>(buffers[0]->getInformation("purified-energy")),
+                1e-8);
+    EXPECT_NEAR(mpark::get<double>(buffer2->getChildren()[0]->getInformation(
+                    "non-purified-energy")),
+                mpark::get<double>(
+                    buffers[0]->getInformation("non-purified-energy")),
+                1e-8);
+
     // buffers[0]->print(std::cout);
     // std::cout << "EXPVAL: " << buffers[0]->getExpectationValueZ() << "\n";
     // EXPECT_NEAR(energy, -1.1371, 1e-4);
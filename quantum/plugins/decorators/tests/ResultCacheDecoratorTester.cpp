@@ -0,0 +1,106 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include <gtest/gtest.h>
+#include "xacc.hpp"
+#include "ResultCacheDecorator.hpp"
+#include "xacc_service.hpp"
+#include <cstdio>
+
+using namespace xacc;
+
+namespace {
+const std::string src = R"src(__qpu__ void cache_f(qbit q) {
+       H(q[0]);
+       Ry(q[1], 0.5);
+       CNOT(q[0], q[1]);
+       Measure(q[0]);
+       Measure(q[1]);
+       }
+       __qpu__ void cache_g(qbit q) {
+       H(q[0]);
+       Ry(q[1], 0.5);
+       CNOT(q[0], q[1]);
+       Measure(q[0]);
+       Measure(q[1]);
+       }
+       __qpu__ void cache_h(qbit q) {
+       H(q[0]);
+       Ry(q[1], 0.25);
+       CNOT(q[0], q[1]);
+       Measure(q[0]);
+       Measure(q[1]);
+       })src";
+}
+
+TEST(ResultCacheDecoratorTester, checkSimple) {
+  if (xacc::hasAccelerator("qpp")) {
+    auto acc = xacc::getAccelerator("qpp");
+    auto decorator = std::dynamic_pointer_cast<quantum::ResultCacheDecorator>(
+        xacc::getAcceleratorDecorator("result-cache", acc));
+    EXPECT_TRUE(decorator != nullptr);
+    auto ir = xacc::getCompiler("xasm")->compile(src, acc);
+
+    auto buffer1 = xacc::qalloc(2);
+    decorator->execute(buffer1, ir->getComposite("cache_f"));
+    EXPECT_EQ(decorator->nbHits(), 0);
+    // Same circuit, different name
+    auto buffer2 = xacc::qalloc(2);
+    decorator->execute(buffer2, ir->getComposite("cache_g"));
+    EXPECT_EQ(decorator->nbHits(), 1);
+    EXPECT_NEAR(buffer1->getExpectationValueZ(),
+                buffer2->getExpectationValueZ(), 1e-12);
+    // Different parameter
+    auto buffer3 = xacc::qalloc(2);
+    decorator->execute(buffer3, ir->getComposite("cache_h"));
+    EXPECT_EQ(decorator->nbHits(), 1);
+  }
+}
+
+TEST(ResultCacheDecoratorTester, checkMultiple) {
+  if (xacc::hasAccelerator("qpp")) {
+    auto acc = xacc::getAccelerator("qpp");
+    const std::string cacheFile = "result_cache_test.bin";
+    std::remove(cacheFile.c_str());
+    auto decorator = std::dynamic_pointer_cast<quantum::ResultCacheDecorator>(
+        xacc::getAcceleratorDecorator("result-cache", acc,
+                                      {{"cache-file", cacheFile}}));
+    auto ir = xacc::getCompiler("xasm")->compile(src, acc);
+    auto buffer = xacc::qalloc(2);
+    decorator->execute(buffer, ir->getComposites());
+    EXPECT_EQ(buffer->nChildren(), 3);
+    // cache_f and cache_g are identical: both executed in the first batch.
+    EXPECT_EQ(decorator->nbHits(), 0);
+
+    // Reload from file: all hits
+    decorator->initialize({{"cache-file", cacheFile}});
+    auto buffer2 = xacc::qalloc(2);
+    decorator->execute(buffer2, ir->getComposites());
+    EXPECT_EQ(decorator->nbHits(), 3);
+    EXPECT_EQ(buffer2->nChildren(), 3);
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_EQ(buffer->getChildren()[i]->name(),
+                buffer2->getChildren()[i]->name());
+      EXPECT_NEAR(buffer->getChildren()[i]->getExpectationValueZ(),
+                  buffer2->getChildren()[i]->getExpectationValueZ(), 1e-12);
+    }
+    std::remove(cacheFile.c_str());
+  }
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize();
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
@@ -15,6 +15,10 @@
 
 #include "xacc_service.hpp"
 #include "AcceleratorDecorator.hpp"
+#include "IRProvider.hpp"
+#include "IRTransformation.hpp"
+#include "InstructionIterator.hpp"
+#include "Pulse.hpp"
 
 using namespace xacc;
 
@@ -88,6 +92,113 @@ TEST(ImprovedSamplingDecoratorTester, checkMultiple) {
 
 //   }
 }
+TEST(RichExtrapDecoratorTester, checkScaleFactors) {
+  auto acc = xacc::getAccelerator("qpp");
+  auto compiler = xacc::getService<xacc::Compiler>("xasm");
+  auto ir = compiler->compile(R"src(__qpu__ void zne_f(qbit q) {
+       Rx(q[0], 0.5);
+       CNOT(q[0],q[1]);
+       Measure(q[0]);
+       }
+       __qpu__ void zne_g(qbit q) {
+       H(q[0]);
+       S(q[0]);
+       H(q[0]);
+       Measure(q[0]);
+       }
+       )src",
+                             acc);
+
+  auto decorator = xacc::getService<AcceleratorDecorator>("rich-extrap");
+  decorator->setDecorated(acc);
+  decorator->initialize(
+      {std::make_pair("scale-factors", std::vector<double>{1.0, 2.0, 3.0})});
+
+  // Both functions at all the scales, folding is exact without noise.
+  auto buffer = xacc::qalloc(2);
+  decorator->execute(buffer, {ir->getComposite("zne_f"), ir->getComposite("zne_g")});
+  EXPECT_EQ(2, buffer->nChildren());
+  auto f = buffer->getChildren()[0];
+  EXPECT_EQ("zne_f", f->name());
+  // 2 invertible gates: 1 and 2 folds
+  EXPECT_EQ(std::vector<double>({1.0, 2.0, 3.0}),
+            f->getInformation("rich-extrap-scales").as<std::vector<double>>());
+  EXPECT_NEAR(std::cos(0.5), f->getExpectationValueZ(), 1e-6);
+  // 3 invertible gates: 2 (7/3) and 3 folds
+  auto g = buffer->getChildren()[1];
+  auto gScales =
+      g->getInformation("rich-extrap-scales").as<std::vector<double>>();
+  EXPECT_EQ(3, gScales.size());
+  EXPECT_NEAR(7.0 / 3.0, gScales[1], 1e-12);
+  EXPECT_NEAR(0.0, g->getExpectationValueZ(), 1e-6);
+}
+
+// <Z> decays with the total duration of the drive pulses
+class PulseDurationAccelerator : public AcceleratorDecorator {
+public:
+  std::vector<std::shared_ptr<CompositeInstruction>> executed;
+  const std::vector<std::string> configurationKeys() override { return {}; }
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::shared_ptr<CompositeInstruction> function) override {
+    execute(buffer, std::vector<std::shared_ptr<CompositeInstruction>>{function});
+  }
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::vector<std::shared_ptr<CompositeInstruction>>
+                   functions) override {
+    for (auto &f : functions) {
+      executed.push_back(f);
+      double duration = 0.0;
+      InstructionIterator it(f);
+      while (it.hasNext()) {
+        auto inst = it.next();
+        if (!inst->isComposite() && inst->channel() == "d0") {
+          duration += inst->duration();
+        }
+      }
+      auto child = xacc::qalloc(buffer->size());
+      child->setName(f->name());
+      child->addExtraInfo("exp-val-z", 1.0 - 0.001 * duration);
+      buffer->appendChild(f->name(), child);
+    }
+  }
+  const std::string name() const override { return "pulse-duration"; }
+  const std::string description() const override { return ""; }
+};
+
+TEST(RichExtrapDecoratorTester, checkPulseStretch) {
+  if (!xacc::hasService<IRTransformation>("ibm-pulse")) {
+    return;
+  }
+  // A calibrated X on qubit 0: 16 samples of amplitude 0.2
+  auto provider = xacc::getIRProvider("quantum");
+  auto xCmdDef = provider->createComposite("pulse::x_0");
+  auto xPulse = std::make_shared<xacc::quantum::Pulse>("stretch_test_x", "d0");
+  xPulse->setSamples(std::vector<std::vector<double>>(16, {0.2, 0.0}));
+  xCmdDef->addInstruction(xPulse);
+  xacc::contributeService("pulse::x_0", xCmdDef);
+  xacc::contributeService("fc", std::make_shared<xacc::quantum::Pulse>("fc"));
+
+  auto acc = std::make_shared<PulseDurationAccelerator>();
+  auto decorator = xacc::getService<AcceleratorDecorator>("rich-extrap");
+  decorator->setDecorated(acc);
+  decorator->initialize(
+      {std::make_pair("scale-factors", std::vector<double>{1.0, 2.0}),
+       std::make_pair("scale-mode", std::string("pulse-stretch"))});
+
+  auto f = provider->createComposite("stretch_f");
+  f->addInstruction(provider->createInstruction("X", {0}));
+  auto buffer = xacc::qalloc(1);
+  decorator->execute(buffer, {f});
+
+  // Same pulses, twice longer with half the amplitude
+  ASSERT_EQ(2, acc->executed.size());
+  auto stretched = acc->executed[1]->getInstruction(0);
+  EXPECT_EQ(32, stretched->getSamples().size());
+  EXPECT_NEAR(0.1, stretched->getSamples()[5][0], 1e-12);
+  EXPECT_EQ(1, buffer->nChildren());
+  EXPECT_NEAR(1.0, buffer->getChildren()[0]->getExpectationValueZ(), 1e-9);
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize();
   ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,70 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#include <gtest/gtest.h>
+#include "xacc.hpp"
+#include "PauliOperator.hpp"
+
+#include "xacc_service.hpp"
+#include "AcceleratorDecorator.hpp"
+
+#include <cmath>
+
+using namespace xacc;
+using namespace xacc::quantum;
+
+TEST(SymmetryVerificationDecoratorTester, checkPostSelection) {
+  auto acc = xacc::getAccelerator("qpp", {{"shots", 8192}});
+  auto compiler = xacc::getService<xacc::Compiler>("xasm");
+  // cos(0.4) |00> + sin(0.4) |11>
+  auto ir = compiler->compile(R"(__qpu__ void sym_ansatz(qbit q) {
+       Ry(q[0], 0.8);
+       CNOT(q[0], q[1]);
+       })",
+                              acc);
+  auto ansatz = ir->getComposite("sym_ansatz");
+
+  PauliOperator op("Z0 + X0");
+  auto decorator = xacc::getAcceleratorDecorator(
+      "symmetry-verification", acc,
+      {{"symmetries", std::vector<std::string>{"Z0 Z1", "Z1"}}});
+  auto buffer = xacc::qalloc(2);
+  decorator->execute(buffer, op.observe(ansatz));
+  EXPECT_EQ(2, buffer->nChildren());
+
+  const double acceptance = std::pow(std::cos(0.4), 2);
+  for (auto &child : buffer->getChildren()) {
+    EXPECT_NEAR(acceptance,
+                mpark::get<double>(
+                    child->getInformation("symmetry-verification-acceptance")),
+                0.03);
+    // Marginalized back to the measured qubit
+    for (auto &[bits, count] : child->getMeasurementCounts()) {
+      EXPECT_EQ(1, bits.size());
+    }
+  }
+  // Z0 Z1 is verified on the Z0 circuit only (q0 is rotated for X0), both
+  // keep the q1 = 0 shots.
+  auto z0 = buffer->getChildren()[0]->name() == "Z0"
+                ? buffer->getChildren()[0]
+                : buffer->getChildren()[1];
+  EXPECT_NEAR(1.0, z0->getExpectationValueZ(), 1e-12);
+  EXPECT_EQ(1, z0->getMeasurementCounts().size());
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize();
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
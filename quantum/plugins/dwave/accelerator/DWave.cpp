@@ -4,7 +4,10 @@
 #include "xacc.hpp"
 
 #include <algorithm>
+#include <numeric>
 #include "AnnealingProgram.hpp"
+#include "ArrayAnnealingProgram.hpp"
+#include "Unembedding.hpp"
 
 namespace xacc {
 
@@ -59,43 +62,58 @@ std::vector<std::pair<int, int>> DWave::getConnectivity() {
   return ret;
 }
 
-void DWave::execute(std::shared_ptr<AcceleratorBuffer> buffer,
-                    const std::shared_ptr<CompositeInstruction> problem) {
+void DWave::getHardware(std::shared_ptr<Graph> &out_graph,
+                        std::vector<sapi_ProblemEntry> &out_adjacency) {
+  std::lock_guard<std::mutex> lock(hardwareMutex);
+  // The solver adjacency does not change, build its graph once
+  if (!hardwareGraph) {
+    auto hardwareEdges = getConnectivity();
+    int maxBit = 0;
+    for (auto &e : hardwareEdges) {
+      if (e.first > maxBit) {
+        maxBit = e.first;
+      }
+      if (e.second > maxBit) {
+        maxBit = e.second;
+      }
+    }
 
-  // Compute embedding
-  // ------------------------------
-  Embedding embedding;
-  auto probGraph = problem->toGraph();
-  auto hardwareEdges = getConnectivity();
-  int num_variables = probGraph->order();
-  auto d = std::dynamic_pointer_cast<AnnealingProgram>(problem);
-  int maxBit = 0;
-  for (auto &e : hardwareEdges) {
-    if (e.first > maxBit) {
-      maxBit = e.first;
+    auto graph = xacc::getService<Graph>("boost-ugraph");
+    for (int i = 0; i < maxBit + 1; i++) {
+      HeterogeneousMap props{std::make_pair("bias", 1.0)};
+      graph->addVertex(props); //
     }
-    if (e.second > maxBit) {
-      maxBit = e.second;
+
+    for (auto &e : hardwareEdges) {
+      graph->addEdge(e.first, e.second);
+      hardwareAdjacency.emplace_back(sapi_ProblemEntry{e.first, e.second, 0.0});
     }
+    hardwareGraph = graph;
   }
+  out_graph = hardwareGraph;
+  out_adjacency = hardwareAdjacency;
+}
 
-  auto hardwareGraph = xacc::getService<Graph>("boost-ugraph");
-  for (int i = 0; i < maxBit + 1; i++) {
-    HeterogeneousMap props{std::make_pair("bias", 1.0)};
-    hardwareGraph->addVertex(props); //
-  }
+std::shared_ptr<DWave::Submission>
+DWave::submit(std::shared_ptr<AcceleratorBuffer> buffer,
+              const std::shared_ptr<CompositeInstruction> problem) {
+  auto submission = std::make_shared<Submission>();
+
+  // Compute embedding
+  // ------------------------------
+  Embedding embedding;
+  auto probGraph = problem->toGraph();
+  submission->num_variables = probGraph->order();
 
+  std::shared_ptr<Graph> hardware;
   std::vector<sapi_ProblemEntry> adjData;
-  for (auto &e : hardwareEdges) {
-    hardwareGraph->addEdge(e.first, e.second);
-    adjData.emplace_back(sapi_ProblemEntry{e.first, e.second, 0.0});
-  }
+  getHardware(hardware, adjData);
   auto adj = sapi_Problem{adjData.data(), adjData.size()};
 
   if (!buffer->hasExtraInfoKey("embedding")) {
 
     auto embeddingAlgo = xacc::getService<EmbeddingAlgorithm>(default_emb_algo);
-    embedding = embeddingAlgo->embed(probGraph, hardwareGraph);
+    embedding = embeddingAlgo->embed(probGraph, hardware);
     buffer->addExtraInfo("embedding", embedding);
 
   } else {
@@ -110,27 +128,36 @@ void DWave::execute(std::shared_ptr<AcceleratorBuffer> buffer,
   // embed problem
   // ------------------------------
 
-  std::vector<sapi_ProblemEntry> problemData;
-  for (auto &pInst : problem->getInstructions()) {
-    problemData.emplace_back(sapi_ProblemEntry{
-        (int)pInst->bits()[0], (int)pInst->bits()[1],
-        xacc::InstructionParameterToDouble(pInst->getParameter(0))});
+  // Array-backed problems are written directly, without instructions
+  if (auto arrays = std::dynamic_pointer_cast<ArrayAnnealingProgram>(problem)) {
+    arrays->writeEntries(submission->problemData);
+  } else {
+    for (auto &pInst : problem->getInstructionsView()) {
+      submission->problemData.emplace_back(sapi_ProblemEntry{
+          (int)pInst->bits()[0], (int)pInst->bits()[1],
+          xacc::InstructionParameterToDouble(pInst->getParameter(0))});
+    }
   }
-  auto sapiProblem = sapi_Problem{problemData.data(), problemData.size()};
+  auto sapiProblem = sapi_Problem{submission->problemData.data(),
+                                  submission->problemData.size()};
 
-  std::vector<int> embData(hardwareGraph->order(), -1);
+  submission->embData.assign(hardware->order(), -1);
   for (auto &kv : embedding) {
     for (auto &ii : kv.second) {
-      embData[ii] = kv.first;
+      submission->embData[ii] = kv.first;
     }
   }
 
-  auto sapiEmbeddings = sapi_Embeddings{embData.data(), embData.size()};
+  auto sapiEmbeddings = sapi_Embeddings{submission->embData.data(),
+                                        submission->embData.size()};
 
   sapi_EmbedProblemResult *r;
 
   auto code = sapi_embedProblem(&sapiProblem, &sapiEmbeddings, &adj, false,
                                 false, 0, &r, 0);
+  if (code != SAPI_OK) {
+    xacc::error("D-Wave could not embed the problem.");
+  }
   // ------------------------------
 
   std::vector<sapi_ProblemEntry> tmpEntries(r->problem.len); // + r->jc.len);
@@ -138,85 +165,200 @@ void DWave::execute(std::shared_ptr<AcceleratorBuffer> buffer,
 
   /* store embedded problem result in new problem */
   for (int i = 0; i < r->problem.len; i++) {
-    //   std::cout << "EMBEDDED R: " << r->problem.elements[i].i << ", " <<
-    //   r->problem.elements[i].j << ", "<< r->problem.elements[i].value <<
-    //   "\n";
     embedded_problem.elements[i].i = r->problem.elements[i].i;
     embedded_problem.elements[i].j = r->problem.elements[i].j;
     embedded_problem.elements[i].value = r->problem.elements[i].value;
   }
+  sapi_freeEmbedProblemResult(r);
 
-  // Execute embedded problem
+  // Submit embedded problem, the solve is not awaited
   // ------------------------------
   sapi_QuantumSolverParameters solver_params =
       SAPI_QUANTUM_SOLVER_DEFAULT_PARAMETERS;
   solver_params.num_reads = shots;
-  sapi_Solver *solver = NULL;
-  sapi_Connection *connection = NULL;
   char err_msg[SAPI_ERROR_MESSAGE_MAX_SIZE];
-  const sapi_SolverProperties *solver_properties = NULL;
-  sapi_IsingResult *answer = NULL;
-
-  sapi_globalInit();
-  code = sapi_remoteConnection("https://cloud.dwavesys.com/sapi",
-                               apiKey.c_str(), NULL, &connection, err_msg);
-  solver = sapi_getSolver(connection, backend.c_str());
-  solver_properties = sapi_getSolverProperties(solver);
 
+  submission->ising = problem->getTag() == "ising";
   if (problem->getTag() == "ising") {
-    code = sapi_solveIsing(solver, &embedded_problem,
-                           (sapi_SolverParameters *)&solver_params, &answer,
-                           err_msg);
+    code = sapi_asyncSolveIsing(solver, &embedded_problem,
+                                (sapi_SolverParameters *)&solver_params,
+                                &submission->submitted, err_msg);
   } else if (problem->getTag() == "qubo") {
-    code = sapi_solveQubo(solver, &embedded_problem,
-                          (sapi_SolverParameters *)&solver_params, &answer,
-                          err_msg);
+    code = sapi_asyncSolveQubo(solver, &embedded_problem,
+                               (sapi_SolverParameters *)&solver_params,
+                               &submission->submitted, err_msg);
+  } else {
+    xacc::error("D-Wave problem must be tagged ising or qubo, not '" +
+                problem->getTag() + "'.");
+  }
+
+  if (code != SAPI_OK || !submission->submitted) {
+    xacc::error("D-Wave submission failed: " + std::string(err_msg));
   }
+  return submission;
+}
+
+void DWave::collect(std::shared_ptr<AcceleratorBuffer> buffer,
+                    std::shared_ptr<Submission> submission) {
+  // Blocks until done (negative timeout)
+  const sapi_SubmittedProblem *submitted = submission->submitted;
+  sapi_awaitCompletion(&submitted, 1, 1, -1.0);
 
-  if (!answer) {
+  char err_msg[SAPI_ERROR_MESSAGE_MAX_SIZE];
+  sapi_IsingResult *answer = NULL;
+  auto code = sapi_asyncResult(submission->submitted, &answer, err_msg);
+  sapi_freeSubmittedProblem(submission->submitted);
+  submission->submitted = NULL;
+
+  if (code != SAPI_OK || !answer) {
     xacc::error("D-Wave Answer was Null");
   }
-  int *new_solutions = NULL;
-  int *nsr;
-  size_t num_new_solutions;
-  std::vector<int> nsrtmp(answer->num_solutions * num_variables);
-  nsr = nsrtmp.data();
-  new_solutions = nsr;
-  code = sapi_unembedAnswer(answer->solutions, answer->solution_len,
-                            answer->num_solutions, &sapiEmbeddings,
-                            SAPI_BROKEN_CHAINS_MINIMIZE_ENERGY, &sapiProblem,
-                            new_solutions, &num_new_solutions, err_msg);
-
-  int first;
+  const int num_variables = submission->num_variables;
+  const std::size_t num_solutions = answer->num_solutions;
+
+  // Majority vote over the chains, also giving the chain break statistics
+  std::vector<AnnealingTerm> logicalProblem;
+  for (auto &entry : submission->problemData) {
+    logicalProblem.emplace_back(AnnealingTerm{entry.i, entry.j, entry.value});
+  }
+  const bool majorityVote = unembedding == "majority-vote";
+  const auto unembedded = unembedSamples(
+      answer->solutions, num_solutions, answer->solution_len,
+      submission->embData, num_variables, answer->num_occurrences,
+      submission->ising, logicalProblem, majorityVote && greedy_descent);
+  buffer->addExtraInfo("chain-break-fraction", unembedded.chainBreakFraction);
+  buffer->addExtraInfo("variable-chain-break-fractions",
+                       unembedded.variableChainBreakFractions);
+
+  std::vector<std::string> bitStrings(num_solutions,
+                                      std::string(num_variables, '0'));
+  const double *energies = answer->energies;
+  if (majorityVote) {
+    xacc::getTaskScheduler()->parallelFor(
+        0, num_solutions, [&](std::size_t beginIdx, std::size_t endIdx) {
+          for (auto i = beginIdx; i < endIdx; ++i) {
+            for (int j = 0; j < num_variables; ++j) {
+              bitStrings[i][j] =
+                  unembedded.values[i * num_variables + j] == 1 ? '1' : '0';
+            }
+          }
+        });
+    energies = unembedded.energies.data();
+  } else {
+    auto sapiProblem = sapi_Problem{submission->problemData.data(),
+                                    submission->problemData.size()};
+    auto sapiEmbeddings = sapi_Embeddings{submission->embData.data(),
+                                          submission->embData.size()};
+    size_t num_new_solutions = 0;
+    std::vector<int> new_solutions(num_solutions * num_variables);
+    code = sapi_unembedAnswer(answer->solutions, answer->solution_len,
+                              num_solutions, &sapiEmbeddings,
+                              SAPI_BROKEN_CHAINS_MINIMIZE_ENERGY, &sapiProblem,
+                              new_solutions.data(), &num_new_solutions,
+                              err_msg);
+    if (code != SAPI_OK) {
+      sapi_freeIsingResult(answer);
+      xacc::error("D-Wave could not unembed the answer: " +
+                  std::string(err_msg));
+    }
+    bitStrings.resize(std::min(num_new_solutions, num_solutions));
+    xacc::getTaskScheduler()->parallelFor(
+        0, bitStrings.size(), [&](std::size_t beginIdx, std::size_t endIdx) {
+          for (auto i = beginIdx; i < endIdx; ++i) {
+            for (int j = 0; j < num_variables; ++j) {
+              bitStrings[i][j] =
+                  new_solutions[i * num_variables + j] == 1 ? '1' : '0';
+            }
+          }
+        });
+  }
+
   std::map<std::string, int> measurements;
   std::map<std::string, double> energies_map;
-  for (int i = 0; i < num_new_solutions; ++i) {
-    // printf("solution %d:\n", (int)i);
-    std::stringstream ss;
-    for (int j = 0; j < num_variables; ++j) {
-      ss << (new_solutions[i * num_variables + j] == -1
-                 ? 0
-                 : new_solutions[i * num_variables + j]);
-    }
-    // std::cout << ss.str() << ", " << answer->energies[i] << "\n";
-    if (measurements.count(ss.str())) {
-      measurements[ss.str()] += answer->num_occurrences[i];
+  for (std::size_t i = 0; i < bitStrings.size(); ++i) {
+    const auto &bitString = bitStrings[i];
+    auto iter = measurements.find(bitString);
+    if (iter != measurements.end()) {
+      iter->second += answer->num_occurrences[i];
+      // Majority vote can map samples of different energies to the same
+      // logical state
+      energies_map[bitString] = std::min(energies_map[bitString], energies[i]);
     } else {
-      measurements.insert({ss.str(), answer->num_occurrences[i]});
-      energies_map.insert({ss.str(), answer->energies[i]});
+      measurements.insert({bitString, answer->num_occurrences[i]});
+      energies_map.insert({bitString, energies[i]});
     }
   }
+  sapi_freeIsingResult(answer);
   buffer->setMeasurements(measurements);
   buffer->addExtraInfo("energies", energies_map);
+
+  ExecutionMetrics metrics;
+  metrics.nbCircuits = 1;
+  metrics.nbShots = shots;
+  reportExecutionMetrics(submission->timer.stop(metrics));
+}
+
+void DWave::execute(std::shared_ptr<AcceleratorBuffer> buffer,
+                    const std::shared_ptr<CompositeInstruction> problem) {
+  collect(buffer, submit(buffer, problem));
 }
 
 void DWave::execute(
     std::shared_ptr<AcceleratorBuffer> buffer,
     const std::vector<std::shared_ptr<CompositeInstruction>> functions) {
+  executeAsync(buffer, functions).get();
+}
+
+std::future<void>
+DWave::executeAsync(std::shared_ptr<AcceleratorBuffer> buffer,
+                    const std::shared_ptr<CompositeInstruction> problem) {
+  auto submission = submit(buffer, problem);
+  return std::async(std::launch::deferred, [this, buffer, submission]() {
+    collect(buffer, submission);
+  });
+}
+
+std::future<void> DWave::executeAsync(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>> functions) {
+  // All the problems are queued before any result is awaited
+  std::vector<std::shared_ptr<AcceleratorBuffer>> children;
+  std::vector<std::shared_ptr<Submission>> submissions;
   for (auto &f : functions) {
-    // FIXME MAKE CHILD BUFFER
-    execute(buffer, f);
+    auto child = std::make_shared<AcceleratorBuffer>(f->name(), buffer->size());
+    // A user provided embedding applies to all the problems
+    if (buffer->hasExtraInfoKey("embedding")) {
+      child->addExtraInfo("embedding", buffer->getInformation("embedding"));
+    }
+    submissions.emplace_back(submit(child, f));
+    children.emplace_back(child);
   }
+
+  return std::async(std::launch::deferred, [this, buffer, children,
+                                            submissions]() {
+    // Results are decoded in the order the solves complete
+    std::vector<size_t> pending(submissions.size());
+    std::iota(pending.begin(), pending.end(), 0);
+    while (!pending.empty()) {
+      std::vector<const sapi_SubmittedProblem *> submitted;
+      for (auto i : pending) {
+        submitted.emplace_back(submissions[i]->submitted);
+      }
+      sapi_awaitCompletion(submitted.data(), submitted.size(), 1, -1.0);
+      std::vector<size_t> stillPending;
+      for (auto i : pending) {
+        if (sapi_asyncDone(submissions[i]->submitted)) {
+          collect(children[i], submissions[i]);
+        } else {
+          stillPending.emplace_back(i);
+        }
+      }
+      pending = stillPending;
+    }
+    for (auto &child : children) {
+      buffer->appendChild(child->name(), child);
+    }
+  });
 }
 
 } // namespace quantum
@@ -16,6 +16,7 @@
 #include "AcceleratorDecorator.hpp"
 #include "Utils.hpp"
 #include "xacc_service.hpp"
+#include <mutex>
 #include <unordered_set>
 #include "dwave_sapi.h"
 #include "xacc.hpp"
@@ -34,10 +35,45 @@ protected:
   sapi_Connection *connection = NULL;
   const sapi_SolverProperties *solver_properties = NULL;
   std::string default_emb_algo = "cmr";
+  // "minimize-energy" (SAPI) or "majority-vote" over each chain
+  std::string unembedding = "minimize-energy";
+  // Majority vote followed by a greedy descent of each sample
+  bool greedy_descent = false;
 
   void searchAPIKey(std::string &key);
   void findApiKeyInFile(std::string &key, const std::string &p);
 
+  // An embedded problem queued on the solver
+  struct Submission {
+    std::vector<sapi_ProblemEntry> problemData;
+    std::vector<int> embData;
+    int num_variables = 0;
+    bool ising = true;
+    sapi_SubmittedProblem *submitted = NULL;
+    // From the embedding, SAPI does not tell when the solve starts so the
+    // time queued is part of the execution time.
+    ExecutionTimer timer;
+    ~Submission() {
+      if (submitted) {
+        sapi_cancelSubmittedProblem(submitted);
+        sapi_freeSubmittedProblem(submitted);
+      }
+    }
+  };
+  // Embeds the problem and submits it without waiting for the answer.
+  std::shared_ptr<Submission>
+  submit(std::shared_ptr<AcceleratorBuffer> buffer,
+         const std::shared_ptr<CompositeInstruction> problem);
+  // Waits for the answer and stores its measurements and energies.
+  void collect(std::shared_ptr<AcceleratorBuffer> buffer,
+               std::shared_ptr<Submission> submission);
+
+  std::mutex hardwareMutex;
+  std::shared_ptr<Graph> hardwareGraph;
+  std::vector<sapi_ProblemEntry> hardwareAdjacency;
+  void getHardware(std::shared_ptr<Graph> &out_graph,
+                   std::vector<sapi_ProblemEntry> &out_adjacency);
+
 public:
   DWave() {}
 
@@ -84,6 +120,16 @@ public:
     if (params.stringExists("embedding-algorithm")) {
         default_emb_algo = params.getString("embedding-algorithm");
     }
+    if (params.stringExists("unembedding")) {
+      unembedding = params.getString("unembedding");
+      if (unembedding != "minimize-energy" && unembedding != "majority-vote") {
+        xacc::error("[Dwave Backend] Invalid unembedding '" + unembedding +
+                    "', must be minimize-energy or majority-vote.");
+      }
+    }
+    if (params.keyExists<bool>("greedy-descent")) {
+      greedy_descent = params.get<bool>("greedy-descent");
+    }
   }
 
   std::vector<std::pair<int, int>> getConnectivity() override;
@@ -97,6 +143,16 @@ public:
                const std::vector<std::shared_ptr<CompositeInstruction>>
                    functions) override;
 
+  // The problems are queued on submission, only waiting for the answers is
+  // asynchronous. Each problem of a vector gets a child buffer.
+  std::future<void>
+  executeAsync(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::shared_ptr<CompositeInstruction> problem) override;
+  std::future<void>
+  executeAsync(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::vector<std::shared_ptr<CompositeInstruction>>
+                   functions) override;
+
   const std::string name() const override { return "dwave"; }
   const std::string description() const override { return ""; }
 
@@ -81,7 +81,7 @@ const std::string DWAccelerator::processInput(
 
   auto dwKernel = functions[0];
 
-  auto instructions = dwKernel->getInstructions();
+  const auto &instructions = dwKernel->getInstructionsView();
   auto newKernel = std::make_shared<AnnealingProgram>(dwKernel->name());
   // Add the instructions to the Kernel
   for (auto i : instructions) {
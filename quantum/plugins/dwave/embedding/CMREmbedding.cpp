@@ -10,20 +10,20 @@
  * Contributors:
  *   Alexander J. McCaskey - initial API and implementation
  *******************************************************************************/
+#include <algorithm>
 #include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
 
 #include "CMREmbedding.hpp"
 #include "find_embedding.hpp"
 
-namespace xacc {
-namespace cmr {
-
-xacc::quantum::Embedding
-CMREmbedding::embed(std::shared_ptr<xacc::Graph> problem,
-                    std::shared_ptr<xacc::Graph> hardware,
-                    std::map<std::string, std::string> params) {
-
-
+namespace {
 class XACCInteractions : public find_embedding::LocalInteraction {
 public:
   bool _canceled = false;
@@ -36,10 +36,74 @@ private:
   virtual bool cancelledImpl() const { return _canceled; }
 };
 
+// FNV-1a over the edge lists of both graphs
+std::string graphKey(int probN, const std::vector<int> &pa,
+                     const std::vector<int> &pb, int hardN,
+                     const std::vector<int> &ha, const std::vector<int> &hb) {
+  uint64_t hash = 14695981039346656037ULL;
+  const auto add = [&](int64_t value) {
+    for (int i = 0; i < 8; ++i) {
+      hash ^= (value >> (8 * i)) & 0xff;
+      hash *= 1099511628211ULL;
+    }
+  };
+  const auto addEdges = [&](int n, const std::vector<int> &a,
+                            const std::vector<int> &b) {
+    add(n);
+    add(a.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+      add(a[i]);
+      add(b[i]);
+    }
+  };
+  addEdges(probN, pa, pb);
+  addEdges(hardN, ha, hb);
+  char buffer[17];
+  std::snprintf(buffer, sizeof(buffer), "%016llx",
+                static_cast<unsigned long long>(hash));
+  return buffer;
+}
+
+std::string cacheFile(const std::string &key) {
+  return std::string(getenv("HOME")) + "/.xacc/embeddings/cmr-" + key + ".txt";
+}
+
+// Longest chain first, then total number of hardware qubits
+bool isBetter(const std::vector<std::vector<int>> &lhs,
+              const std::vector<std::vector<int>> &rhs) {
+  const auto score = [](const std::vector<std::vector<int>> &chains) {
+    size_t longest = 0, total = 0;
+    for (auto &chain : chains) {
+      longest = std::max(longest, chain.size());
+      total += chain.size();
+    }
+    return std::make_pair(longest, total);
+  };
+  return score(lhs) < score(rhs);
+}
+
+std::mutex cacheMutex;
+std::unordered_map<std::string, xacc::quantum::Embedding> embeddingCache;
+} // namespace
+
+namespace xacc {
+namespace cmr {
+
+// Params (all optional):
+//   "tries"   number of minorminer restarts (default 10), split over
+//             "threads" independent searches (default: the task scheduler
+//             size) with different seeds, the shortest chains are kept;
+//   "seed"    random seed of the first search;
+//   "cache"   "false" to always search. Otherwise embeddings are cached by
+//             problem and hardware graph, in memory and in
+//             ~/.xacc/embeddings.
+xacc::quantum::Embedding
+CMREmbedding::embed(std::shared_ptr<xacc::Graph> problem,
+                    std::shared_ptr<xacc::Graph> hardware,
+                    std::map<std::string, std::string> params) {
+
   // Local Declarations
   std::vector<int> pa, pb, ha, hb;
-  std::vector<std::vector<int>> chains;
-  int counter = 0;
   xacc::quantum::Embedding embedding;
 
   // Get the number of nodes on both graphs
@@ -65,21 +129,85 @@ private:
     }
   }
 
+  const bool useCache = !params.count("cache") || params["cache"] != "false";
+  const auto key = graphKey(probN, pa, pb, hardN, ha, hb);
+  if (useCache) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto iter = embeddingCache.find(key);
+    if (iter != embeddingCache.end()) {
+      return iter->second;
+    }
+    if (xacc::fileExists(cacheFile(key))) {
+      std::ifstream stream(cacheFile(key));
+      embedding.load(stream);
+      if (embedding.size() == static_cast<size_t>(probN)) {
+        embeddingCache.emplace(key, embedding);
+        return embedding;
+      }
+      embedding.clear();
+    }
+  }
+
+  const int nbTries = params.count("tries") ? std::stoi(params["tries"]) : 10;
+  const int nbSearches = std::max(
+      1, std::min(nbTries, params.count("threads")
+                               ? std::stoi(params["threads"])
+                               : xacc::getTaskScheduler()->getNumberOfThreads()));
+  const uint64_t seed = params.count("seed") ? std::stoull(params["seed"])
+                                             : std::random_device()();
+
   ::graph::input_graph prob(probN, pa, pb);
   ::graph::input_graph hard(hardN, ha, hb);
-  find_embedding::optional_parameters _params;
-  _params.localInteractionPtr =
-      std::make_shared<XACCInteractions>(); //.reset(new XACCInteractions());
-
-  if (find_embedding::findEmbedding(prob, hard, _params, chains)) {
-    for (auto chain : chains) {
-      embedding.insert(std::make_pair(counter, chain));
-      counter++;
+  std::vector<std::vector<std::vector<int>>> results(nbSearches);
+  std::vector<char> found(nbSearches, 0);
+  xacc::getTaskScheduler()->parallelFor(
+      0, nbSearches, [&](size_t beginIdx, size_t endIdx) {
+        for (size_t i = beginIdx; i < endIdx; ++i) {
+          find_embedding::optional_parameters _params;
+          _params.localInteractionPtr = std::make_shared<XACCInteractions>();
+          // Spread the tries over the searches
+          _params.tries = nbTries / nbSearches + (i < nbTries % nbSearches);
+          _params.seed(seed + i);
+          found[i] = find_embedding::findEmbedding(prob, hard, _params,
+                                                   results[i]);
+        }
+      });
+
+  int best = -1;
+  for (int i = 0; i < nbSearches; ++i) {
+    if (found[i] && (best < 0 || isBetter(results[i], results[best]))) {
+      best = i;
     }
-  } else {
+  }
+  if (best < 0) {
     xacc::error("Couldn't find embedding.");
   }
 
+  int counter = 0;
+  for (auto chain : results[best]) {
+    embedding.insert(std::make_pair(counter, chain));
+    counter++;
+  }
+
+  if (useCache) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    embeddingCache.emplace(key, embedding);
+    const auto fileName = cacheFile(key);
+    const auto dir = fileName.substr(0, fileName.find_last_of('/'));
+    if (!xacc::directoryExists(dir)) {
+      const auto mode = S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH;
+      mkdir((std::string(getenv("HOME")) + "/.xacc").c_str(), mode);
+      mkdir(dir.c_str(), mode);
+    }
+    // Other processes may read it meanwhile: write then rename
+    const auto tmpFileName = fileName + "." + std::to_string(getpid());
+    {
+      std::ofstream stream(tmpFileName);
+      embedding.persist(stream);
+    }
+    std::rename(tmpFileName.c_str(), fileName.c_str());
+  }
+
   return embedding;
 }
 
@@ -0,0 +1,189 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#include "Unembedding.hpp"
+#include "xacc.hpp"
+#include <algorithm>
+#include <mutex>
+
+namespace {
+// Bounds the greedy descent of a sample
+constexpr int MAX_SWEEPS = 1000;
+
+// The problem by variable: biases and the couplers of each variable
+struct Adjacency {
+  std::vector<double> biases;
+  std::vector<std::size_t> offsets;
+  std::vector<std::pair<std::size_t, double>> neighbors;
+
+  Adjacency(const std::vector<xacc::quantum::AnnealingTerm> &in_problem,
+            std::size_t in_nbVariables)
+      : biases(in_nbVariables, 0.0), offsets(in_nbVariables + 1, 0) {
+    const auto valid = [&](int var) {
+      return var >= 0 && (std::size_t)var < in_nbVariables;
+    };
+    for (auto &term : in_problem) {
+      if (!valid(term.i) || !valid(term.j)) {
+        continue;
+      }
+      if (term.i == term.j) {
+        biases[term.i] += term.value;
+      } else {
+        ++offsets[term.i + 1];
+        ++offsets[term.j + 1];
+      }
+    }
+    for (std::size_t var = 0; var < in_nbVariables; ++var) {
+      offsets[var + 1] += offsets[var];
+    }
+    neighbors.resize(offsets.back());
+    auto next = offsets;
+    for (auto &term : in_problem) {
+      if (valid(term.i) && valid(term.j) && term.i != term.j) {
+        neighbors[next[term.i]++] = {(std::size_t)term.j, term.value};
+        neighbors[next[term.j]++] = {(std::size_t)term.i, term.value};
+      }
+    }
+  }
+
+  double field(const std::int8_t *in_values, std::size_t in_var) const {
+    double result = biases[in_var];
+    for (auto k = offsets[in_var]; k < offsets[in_var + 1]; ++k) {
+      result += neighbors[k].second * in_values[neighbors[k].first];
+    }
+    return result;
+  }
+
+  // Each coupler is seen from both of its variables
+  double energy(const std::int8_t *in_values) const {
+    double result = 0.0;
+    for (std::size_t var = 0; var < biases.size(); ++var) {
+      result += in_values[var] * (biases[var] + field(in_values, var)) / 2.0;
+    }
+    return result;
+  }
+};
+} // namespace
+
+namespace xacc {
+namespace quantum {
+UnembeddedSamples
+unembedSamples(const int *in_samples, std::size_t in_nbSamples,
+               std::size_t in_sampleLength,
+               const std::vector<int> &in_qubitToVariable,
+               std::size_t in_nbVariables, const int *in_occurrences,
+               bool in_ising, const std::vector<AnnealingTerm> &in_problem,
+               bool in_greedyDescent) {
+  UnembeddedSamples result;
+  result.nbVariables = in_nbVariables;
+  result.values.assign(in_nbSamples * in_nbVariables, in_ising ? -1 : 0);
+  result.energies.assign(in_nbSamples, 0.0);
+  result.variableChainBreakFractions.assign(in_nbVariables, 0.0);
+  const Adjacency adjacency(in_problem, in_nbVariables);
+  const std::size_t nbQubits =
+      std::min(in_sampleLength, in_qubitToVariable.size());
+
+  std::vector<std::size_t> chainLengths(in_nbVariables, 0);
+  for (std::size_t qubit = 0; qubit < nbQubits; ++qubit) {
+    const int var = in_qubitToVariable[qubit];
+    if (var >= 0 && (std::size_t)var < in_nbVariables) {
+      ++chainLengths[var];
+    }
+  }
+  const auto nbChains =
+      std::count_if(chainLengths.begin(), chainLengths.end(),
+                    [](std::size_t length) { return length > 0; });
+
+  std::mutex statsMutex;
+  double totalOccurrences = 0.0;
+  xacc::getTaskScheduler()->parallelFor(
+      0, in_nbSamples, [&](std::size_t beginIdx, std::size_t endIdx) {
+        // Per variable: number of +1 (or 1), of qubits, first value
+        std::vector<int> ups(in_nbVariables), counts(in_nbVariables),
+            firsts(in_nbVariables);
+        std::vector<double> brokenWeights(in_nbVariables, 0.0);
+        double occurrences = 0.0;
+        for (auto sample = beginIdx; sample < endIdx; ++sample) {
+          const int *physical = in_samples + sample * in_sampleLength;
+          std::fill(ups.begin(), ups.end(), 0);
+          std::fill(counts.begin(), counts.end(), 0);
+          for (std::size_t qubit = 0; qubit < nbQubits; ++qubit) {
+            const int var = in_qubitToVariable[qubit];
+            const int value = physical[qubit];
+            if (var < 0 || (std::size_t)var >= in_nbVariables ||
+                (value != 1 && value != (in_ising ? -1 : 0))) {
+              continue;
+            }
+            if (counts[var]++ == 0) {
+              firsts[var] = value;
+            }
+            ups[var] += value == 1;
+          }
+
+          const double weight = in_occurrences ? in_occurrences[sample] : 1;
+          occurrences += weight;
+          auto *values = result.values.data() + sample * in_nbVariables;
+          for (std::size_t var = 0; var < in_nbVariables; ++var) {
+            if (counts[var] == 0) {
+              continue;
+            }
+            const int downs = counts[var] - ups[var];
+            if (ups[var] && downs) {
+              brokenWeights[var] += weight;
+            }
+            const int up =
+                ups[var] == downs ? firsts[var] == 1 : ups[var] > downs;
+            values[var] = up ? 1 : (in_ising ? -1 : 0);
+          }
+
+          if (in_greedyDescent) {
+            for (int sweep = 0; sweep < MAX_SWEEPS; ++sweep) {
+              bool flipped = false;
+              for (std::size_t var = 0; var < in_nbVariables; ++var) {
+                const double field = adjacency.field(values, var);
+                const double delta =
+                    in_ising ? -2.0 * values[var] * field
+                             : (1 - 2 * values[var]) * field;
+                if (delta < -1e-12) {
+                  values[var] = in_ising ? -values[var] : 1 - values[var];
+                  flipped = true;
+                }
+              }
+              if (!flipped) {
+                break;
+              }
+            }
+          }
+          result.energies[sample] = adjacency.energy(values);
+        }
+
+        std::lock_guard<std::mutex> lock(statsMutex);
+        totalOccurrences += occurrences;
+        for (std::size_t var = 0; var < in_nbVariables; ++var) {
+          result.variableChainBreakFractions[var] += brokenWeights[var];
+        }
+      });
+
+  if (totalOccurrences > 0.0) {
+    double broken = 0.0;
+    for (auto &fraction : result.variableChainBreakFractions) {
+      broken += fraction;
+      fraction /= totalOccurrences;
+    }
+    if (nbChains > 0) {
+      result.chainBreakFraction = broken / (totalOccurrences * nbChains);
+    }
+  }
+  return result;
+}
+} // namespace quantum
+} // namespace xacc
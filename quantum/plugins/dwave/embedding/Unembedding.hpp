@@ -0,0 +1,59 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_DWAVE_UNEMBEDDING_HPP_
+#define XACC_DWAVE_UNEMBEDDING_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace xacc {
+namespace quantum {
+
+// A bias (i == j) or coupler of the logical problem
+struct AnnealingTerm {
+  int i;
+  int j;
+  double value;
+};
+
+struct UnembeddedSamples {
+  std::size_t nbVariables = 0;
+  // nbSamples x nbVariables logical values, row-major: -1 / +1 (ising) or
+  // 0 / 1 (qubo), -1 / 0 for a variable without chain.
+  std::vector<std::int8_t> values;
+  // Energy of each sample for the logical problem
+  std::vector<double> energies;
+  // Fraction of the chains broken (not all qubits equal), weighted by the
+  // occurrences, over all the chains and for each variable.
+  double chainBreakFraction = 0.0;
+  std::vector<double> variableChainBreakFractions;
+};
+
+// Unembeds the physical samples (nbSamples x sampleLength, row-major, the
+// qubits of no chain ignored) by majority vote over each chain, ties going
+// to the first qubit of the chain. in_qubitToVariable maps the physical
+// qubits to the logical variables (-1 if unused). If in_greedyDescent, each
+// unembedded sample then flips its variables while that lowers the energy
+// of in_problem. The samples are processed in parallel on the task
+// scheduler.
+UnembeddedSamples
+unembedSamples(const int *in_samples, std::size_t in_nbSamples,
+               std::size_t in_sampleLength,
+               const std::vector<int> &in_qubitToVariable,
+               std::size_t in_nbVariables, const int *in_occurrences,
+               bool in_ising, const std::vector<AnnealingTerm> &in_problem,
+               bool in_greedyDescent = false);
+} // namespace quantum
+} // namespace xacc
+#endif
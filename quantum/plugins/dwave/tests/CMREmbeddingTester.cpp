@@ -64,6 +64,27 @@ TEST(CMREmbeddingTester, checkReduction) {
 	}
 }
 
+TEST(CMREmbeddingTester, checkCache) {
+  auto problem = xacc::getService<Graph>("boost-ugraph");
+  for (int i = 0; i < 3; i++) problem->addVertex();
+  problem->addEdge(0, 1);
+  problem->addEdge(1, 2);
+  problem->addEdge(0, 2);
+
+  auto k44 = xacc::getService<Graph>("boost-ugraph");
+  for (int i = 0; i < 8; i++) k44->addVertex();
+  for (int i = 0; i < 4; i++) {
+    for (int j = 4; j < 8; j++) k44->addEdge(i, j);
+  }
+
+  auto algo = std::make_shared<CMREmbedding>();
+  auto embedding = algo->embed(problem, k44, {{"tries", "4"}, {"threads", "2"}});
+  EXPECT_EQ(3, embedding.size());
+  // Same graphs: the cached embedding
+  auto cached = algo->embed(problem, k44, {{"tries", "4"}});
+  EXPECT_EQ(embedding, cached);
+}
+
 int main(int argc, char** argv) {
    xacc::Initialize();
    ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,62 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#include <gtest/gtest.h>
+#include "xacc.hpp"
+#include "Unembedding.hpp"
+
+using namespace xacc::quantum;
+
+namespace {
+// Variable 0 on qubits 0 and 1, variable 1 on qubits 2 to 4, qubit 5 unused
+const std::vector<int> EMBEDDING{0, 0, 1, 1, 1, -1};
+const std::vector<AnnealingTerm> PROBLEM{{0, 0, 1.0}, {0, 1, -1.0}};
+// 3 (SAPI's unused qubit) is ignored
+const std::vector<int> SAMPLES{1, 1, -1, -1, 1, 3, 1, -1, 1, 1, 1, 3};
+const std::vector<int> OCCURRENCES{3, 1};
+} // namespace
+
+TEST(UnembeddingTester, checkMajorityVote) {
+  auto result = unembedSamples(SAMPLES.data(), 2, 6, EMBEDDING, 2,
+                               OCCURRENCES.data(), true, PROBLEM);
+  // Tie broken by the first qubit of the chain
+  EXPECT_EQ(std::vector<std::int8_t>({1, -1, 1, 1}), result.values);
+  EXPECT_NEAR(2.0, result.energies[0], 1e-12);
+  EXPECT_NEAR(0.0, result.energies[1], 1e-12);
+  EXPECT_NEAR(0.5, result.chainBreakFraction, 1e-12);
+  EXPECT_NEAR(0.25, result.variableChainBreakFractions[0], 1e-12);
+  EXPECT_NEAR(0.75, result.variableChainBreakFractions[1], 1e-12);
+}
+
+TEST(UnembeddingTester, checkGreedyDescent) {
+  auto result = unembedSamples(SAMPLES.data(), 2, 6, EMBEDDING, 2,
+                               OCCURRENCES.data(), true, PROBLEM, true);
+  // The first sample reaches the ground state, the second is a local minimum
+  EXPECT_EQ(std::vector<std::int8_t>({-1, -1, 1, 1}), result.values);
+  EXPECT_NEAR(-2.0, result.energies[0], 1e-12);
+  EXPECT_NEAR(0.0, result.energies[1], 1e-12);
+
+  const std::vector<int> qubo{0, 0};
+  auto quboResult = unembedSamples(qubo.data(), 1, 2, {0, 0}, 1, nullptr,
+                                   false, {{0, 0, -1.0}}, true);
+  EXPECT_EQ(1, quboResult.values[0]);
+  EXPECT_NEAR(-1.0, quboResult.energies[0], 1e-12);
+  EXPECT_NEAR(0.0, quboResult.chainBreakFraction, 1e-12);
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize(argc, argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
@@ -12,14 +12,19 @@
  *******************************************************************************/
 #include "IBMAccelerator.hpp"
 #include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "Properties.hpp"
 #include "QObjectExperimentVisitor.hpp"
+#include "QObjectWriter.hpp"
 #include "OpenPulseVisitor.hpp"
 #include "CountGatesOfTypeVisitor.hpp"
-
-#include <cpr/cpr.h>
+#include "Emitter.hpp"
 
 #include "xacc.hpp"
 #include "xacc_service.hpp"
@@ -30,8 +35,11 @@
 #include "QObject.hpp"
 #include "PulseQObject.hpp"
 
+#include <functional>
 #include <regex>
+#include <zlib.h>
 #include <thread>
+#include <unordered_map>
 #include <cassert>
 namespace xacc {
 namespace quantum {
@@ -41,52 +49,41 @@ const std::string IBMAccelerator::IBM_API_URL =
     "https://api-qcon.quantum-computing.ibm.com";
 const std::string IBMAccelerator::DEFAULT_IBM_BACKEND = "ibmq_qasm_simulator";
 const std::string IBMAccelerator::IBM_LOGIN_PATH = "/api/users/loginWithToken";
+const std::string IBMAccelerator::IBM_RUNTIME_URL =
+    "https://runtime-us-east.quantum-computing.ibm.com";
 
 std::string hex_string_to_binary_string(std::string hex) {
   return integral_to_binary_string((int)strtol(hex.c_str(), NULL, 0));
 }
 
-std::vector<xacc::ibm_pulse::Instruction> alignMeasurePulseInstructions(
-    const std::vector<xacc::ibm_pulse::Instruction> &in_originalPulseSchedule) {
+// The pulse schedule (measurements aligned and frame changes coalesced by the
+// pulse scheduler) as QObj instructions: sorted by start time (frame changes
+// first, ordered by channel) and with a single acquire instruction for all
+// the measured qubits (IBM can only handle 1 acquire instruction at the
+// moment).
+std::vector<xacc::ibm_pulse::Instruction> toQObjInstructions(
+    const std::vector<xacc::ibm_pulse::Instruction> &in_pulseSchedule) {
   std::vector<xacc::ibm_pulse::Instruction> result;
   std::vector<xacc::ibm_pulse::Instruction> acquireInsts;
-  // Align stimulus measure pulses and combine acquire instructions.
-  // IBM can only handle 1 acquire instruction at the momemt.
-  std::optional<int> firstMeasureT0;
-  // A measurement pulse can contain multiple pulses!!!
-  std::string firstMeasChannel;
-  std::unordered_map<std::string, int> mChannelOffset;
-  for (const auto &ibmInst : in_originalPulseSchedule) {
-    if (ibmInst.get_name() != "acquire") {
-      if (!ibmInst.get_ch().empty() && ibmInst.get_ch()[0] == 'm') {
-        if (!firstMeasureT0.has_value()) {
-          firstMeasureT0 = ibmInst.get_t0();
-          firstMeasChannel = ibmInst.get_ch();
-          // This is the first one, hence offset = 0
-          mChannelOffset.emplace(ibmInst.get_ch(), 0);
-        }
-
-        auto offsetIter = mChannelOffset.find(ibmInst.get_ch());
-        if (offsetIter == mChannelOffset.end()) {
-          const auto offset = ibmInst.get_t0() - firstMeasureT0.value();
-          mChannelOffset.emplace(ibmInst.get_ch(), offset);
-        }
-        const auto t0_offset = mChannelOffset[ibmInst.get_ch()];
-        auto alignedMeasPulse = ibmInst;
-        // A measure composite is a set of pulses on the meas channel,
-        // we need to shift all of them according to the offset.
-        if (ibmInst.get_ch() != firstMeasChannel) {
-          const auto shiftT0 = ibmInst.get_t0() - t0_offset;
-          alignedMeasPulse.set_t0(shiftT0);
-        }
-        result.emplace_back(alignedMeasPulse);
-      } else {
-        result.emplace_back(ibmInst);
-      }
-    } else {
+  for (const auto &ibmInst : in_pulseSchedule) {
+    if (ibmInst.get_name() == "acquire") {
       acquireInsts.emplace_back(ibmInst);
+    } else {
+      result.emplace_back(ibmInst);
     }
   }
+  std::stable_sort(result.begin(), result.end(),
+                   [](const auto &lhs, const auto &rhs) {
+                     const bool lhsFc = lhs.get_name() == "fc";
+                     const bool rhsFc = rhs.get_name() == "fc";
+                     if (lhs.get_t0() != rhs.get_t0()) {
+                       return lhs.get_t0() < rhs.get_t0();
+                     }
+                     if (lhsFc != rhsFc) {
+                       return lhsFc;
+                     }
+                     return lhsFc && lhs.get_ch() < rhs.get_ch();
+                   });
 
   std::vector<int64_t> acquiredBits;
   for (const auto &aqInst : acquireInsts) {
@@ -106,54 +103,6 @@ std::vector<xacc::ibm_pulse::Instruction> alignMeasurePulseInstructions(
   return result;
 }
 
-std::vector<xacc::ibm_pulse::Instruction> orderFrameChangeInsts(
-    const std::vector<xacc::ibm_pulse::Instruction> &in_originalPulseSchedule) {
-  std::vector<xacc::ibm_pulse::Instruction> result;
-  std::vector<xacc::ibm_pulse::Instruction> fcInsts;
-
-  const auto sortFcInst =
-      [](std::vector<xacc::ibm_pulse::Instruction> &io_inst) {
-        for (size_t i = 1; i < io_inst.size(); ++i) {
-          assert(io_inst[i].get_t0() == io_inst[0].get_t0());
-        }
-        std::sort(io_inst.begin(), io_inst.end(),
-                  [](const auto &lhs, const auto &rhs) {
-                    return lhs.get_ch() < rhs.get_ch();
-                  });
-      };
-
-  for (const auto &ibmInst : in_originalPulseSchedule) {
-    if (ibmInst.get_name() == "fc") {
-      if (fcInsts.empty()) {
-        fcInsts.emplace_back(ibmInst);
-      } else {
-        if (ibmInst.get_t0() == fcInsts.back().get_t0()) {
-          fcInsts.emplace_back(ibmInst);
-        } else {
-          // Sort the list and add
-          sortFcInst(fcInsts);
-          for (auto &fcInst : fcInsts) {
-            result.emplace_back(fcInst);
-          }
-          fcInsts.clear();
-          fcInsts.emplace_back(ibmInst);
-        }
-      }
-    } else {
-      if (!fcInsts.empty()) {
-        sortFcInst(fcInsts);
-        for (auto &fcInst : fcInsts) {
-          result.emplace_back(fcInst);
-        }
-        fcInsts.clear();
-      }
-      result.emplace_back(ibmInst);
-    }
-  }
-  assert(result.size() == in_originalPulseSchedule.size());
-  return result;
-}
-
 bool hasMidCircuitMeasurement(
     const std::shared_ptr<CompositeInstruction> &in_circuit) {
   InstructionIterator it(in_circuit);
@@ -161,13 +110,13 @@ bool hasMidCircuitMeasurement(
   while (it.hasNext()) {
     auto nextInst = it.next();
     if (nextInst->isEnabled()) {
-      if (nextInst->name() == "Measure") {
+      if (nextInst->opcode() == xacc::GateOpcode::Measure) {
         // Flag that we have seen a Measure gate.
         measureEncountered = true;
       }
 
       // We have seen a Measure gate but this one is not another Measure gate.
-      if (measureEncountered && nextInst->name() != "Measure") {
+      if (measureEncountered && nextInst->opcode() != xacc::GateOpcode::Measure) {
         // This circuit has mid-circuit measurement
         return true;
       }
@@ -176,6 +125,193 @@ bool hasMidCircuitMeasurement(
   return false;
 }
 
+namespace {
+// The payload of the (possibly nested) {"__type__": ..., "__value__": ...}
+// encoding of the IBM Runtime results (qiskit RuntimeEncoder)
+const nlohmann::json &runtimeValue(const nlohmann::json &in_encoded) {
+  const nlohmann::json *value = &in_encoded;
+  while (value->is_object() && value->count("__type__") &&
+         value->count("__value__")) {
+    value = &(*value)["__value__"];
+  }
+  return *value;
+}
+
+std::string inflateZlib(const std::string &in_compressed) {
+  z_stream stream{};
+  if (inflateInit(&stream) != Z_OK) {
+    xacc::error("IBM Runtime: failed to initialize zlib.");
+  }
+  stream.next_in =
+      reinterpret_cast<Bytef *>(const_cast<char *>(in_compressed.data()));
+  stream.avail_in = in_compressed.size();
+  std::string result;
+  std::vector<char> chunk(1 << 16);
+  int status = Z_OK;
+  do {
+    stream.next_out = reinterpret_cast<Bytef *>(chunk.data());
+    stream.avail_out = chunk.size();
+    status = inflate(&stream, Z_NO_FLUSH);
+    if (status != Z_OK && status != Z_STREAM_END) {
+      inflateEnd(&stream);
+      xacc::error("IBM Runtime: invalid compressed array (zlib error " +
+                  std::to_string(status) + ").");
+    }
+    result.append(chunk.data(), chunk.size() - stream.avail_out);
+  } while (status != Z_STREAM_END);
+  inflateEnd(&stream);
+  return result;
+}
+
+// A NumPy array of the results, row-major ("descr" '<f8' or '|u1')
+struct RuntimeArray {
+  std::string descr;
+  std::vector<std::size_t> shape;
+  std::string data;
+
+  std::size_t size() const {
+    std::size_t result = 1;
+    for (auto dim : shape) {
+      result *= dim;
+    }
+    return result;
+  }
+  double real(std::size_t in_idx) const {
+    double value;
+    std::memcpy(&value, data.data() + in_idx * sizeof(double), sizeof(double));
+    return value;
+  }
+  uint8_t byte(std::size_t in_idx) const {
+    return static_cast<uint8_t>(data[in_idx]);
+  }
+};
+
+// An encoded ndarray: the base64 of the zlib-compressed .npy file, or
+// (object arrays) nested lists of numbers
+RuntimeArray decodeRuntimeArray(const nlohmann::json &in_encoded) {
+  const auto &value = runtimeValue(in_encoded);
+  RuntimeArray result;
+  if (value.is_array() || value.is_number()) {
+    result.descr = "<f8";
+    std::function<void(const nlohmann::json &, std::size_t)> flatten =
+        [&](const nlohmann::json &in_values, std::size_t in_depth) {
+          if (!in_values.is_array()) {
+            const double x = in_values.get<double>();
+            result.data.append(reinterpret_cast<const char *>(&x), sizeof(x));
+            return;
+          }
+          if (result.shape.size() == in_depth) {
+            result.shape.push_back(in_values.size());
+          }
+          for (auto &v : in_values) {
+            flatten(v, in_depth + 1);
+          }
+        };
+    flatten(value, 0);
+    return result;
+  }
+  if (!value.is_string()) {
+    xacc::error("IBM Runtime: unexpected array encoding " + value.dump());
+  }
+
+  const auto npy = inflateZlib(xacc::base64_decode(value.get<std::string>()));
+  const auto invalid = [](const std::string &in_reason) {
+    xacc::error("IBM Runtime: invalid result array, " + in_reason);
+  };
+  if (npy.size() < 10 || npy.compare(0, 6, "\x93NUMPY") != 0) {
+    invalid("not a .npy array.");
+  }
+  // 1.0: uint16 header length, 2.0 and 3.0: uint32
+  const auto *bytes = reinterpret_cast<const unsigned char *>(npy.data());
+  const std::size_t lengthBytes = bytes[6] == 1 ? 2 : 4;
+  std::size_t headerLength = 0;
+  for (std::size_t i = 0; i < lengthBytes; ++i) {
+    headerLength |= std::size_t{bytes[8 + i]} << (8 * i);
+  }
+  const auto dataOffset = 8 + lengthBytes + headerLength;
+  if (dataOffset > npy.size()) {
+    invalid("truncated header.");
+  }
+  const auto header = npy.substr(8 + lengthBytes, headerLength);
+  const auto descr = header.find("'descr'");
+  const auto descrBegin = header.find('\'', header.find(':', descr)) + 1;
+  result.descr = header.substr(descrBegin,
+                               header.find('\'', descrBegin) - descrBegin);
+  if (result.descr != "<f8" && result.descr != "|u1") {
+    invalid("unsupported dtype " + result.descr + ".");
+  }
+  if (header.find("'fortran_order': True") != std::string::npos) {
+    invalid("Fortran order is not supported.");
+  }
+  const auto shapeBegin = header.find('(', header.find("'shape'")) + 1;
+  std::stringstream shape(
+      header.substr(shapeBegin, header.find(')', shapeBegin) - shapeBegin));
+  std::string dim;
+  while (std::getline(shape, dim, ',')) {
+    if (dim.find_first_not_of(' ') != std::string::npos) {
+      result.shape.push_back(std::stoull(dim));
+    }
+  }
+  result.data = npy.substr(dataOffset);
+  const std::size_t itemSize = result.descr == "<f8" ? sizeof(double) : 1;
+  if (result.data.size() < result.size() * itemSize) {
+    invalid("truncated data.");
+  }
+  return result;
+}
+
+// The data fields (e.g. "evs", or the classical registers of the Sampler) of
+// each PUB (primitive unified bloc) result
+std::vector<nlohmann::json> runtimePubData(const nlohmann::json &in_results) {
+  const auto &results = runtimeValue(in_results);
+  std::vector<nlohmann::json> pubData;
+  if (!results.count("pub_results")) {
+    xacc::error("IBM Runtime: unexpected results " + results.dump());
+  }
+  for (auto &pub : results["pub_results"]) {
+    const auto &data = runtimeValue(runtimeValue(pub)["data"]);
+    pubData.emplace_back(data.count("fields") ? runtimeValue(data["fields"])
+                                              : data);
+  }
+  return pubData;
+}
+
+// The Pauli product measured by an observed kernel of ansatz (its basis
+// changes then measures), as a Qiskit label (qubit 0 right-most) on
+// in_nbQubits qubits, or empty if its measurements are not of that form.
+std::string measuredPauli(CompositeInstruction &in_kernel,
+                          CompositeInstruction &in_ansatz,
+                          std::size_t in_nbQubits) {
+  const bool nested = in_kernel.nInstructions() > 0 &&
+                      in_kernel.getInstruction(0)->isComposite();
+  std::string label(in_nbQubits, 'I');
+  std::map<std::size_t, char> basis;
+  bool measured = false;
+  for (std::size_t i = nested ? 1 : in_ansatz.nInstructions();
+       i < in_kernel.nInstructions(); ++i) {
+    auto inst = in_kernel.getInstruction(i);
+    if (inst->bits().size() != 1 || inst->bits()[0] >= in_nbQubits) {
+      return "";
+    }
+    const auto qubit = inst->bits()[0];
+    if (inst->name() == "H") {
+      basis[qubit] = 'X';
+    } else if (inst->name() == "Rx" &&
+               std::abs(xacc::InstructionParameterToDouble(
+                            inst->getParameter(0)) -
+                        xacc::constants::pi / 2.0) < 1e-9) {
+      basis[qubit] = 'Y';
+    } else if (inst->name() == "Measure") {
+      label[in_nbQubits - 1 - qubit] = basis.count(qubit) ? basis[qubit] : 'Z';
+      measured = true;
+    } else {
+      return "";
+    }
+  }
+  return measured ? label : "";
+}
+} // namespace
+
 void IBMAccelerator::initialize(const HeterogeneousMap &params) {
   if (!initialized) {
     std::string apiKey = "";
@@ -216,55 +352,62 @@ void IBMAccelerator::initialize(const HeterogeneousMap &params) {
     // set the temp API token
     currentApiToken = response_json["id"].get<std::string>();
 
-    // Get all backend information
-    response = get(IBM_API_URL, getBackendPath + currentApiToken);
-    backends_root = json::parse("{\"backends\":" + response + "}");
-    getBackendPropsResponse = "{\"backends\":" + response + "}";
-
-    // Get current backend properties
-    auto backend_props_response =
-        get(IBM_API_URL, getBackendPropertiesPath, {},
-            {std::make_pair("version", "1"),
-             std::make_pair("access_token", currentApiToken)});
-    xacc::info("Backend property:\n" + backend_props_response);
-    auto props = json::parse(backend_props_response);
-    backendProperties.insert({backend, props});
-    std::vector<std::string> your_available_backends;
-    for (auto &b : backends_root["backends"]) {
-      if (b.count("backend_name") &&
-          b["backend_name"].get<std::string>() == backend) {
-        availableBackends.insert(std::make_pair(backend, b));
-      }
-      if (b.count("backend_name")) {
-        your_available_backends.push_back(b["backend_name"].get<std::string>());
+    // The backend configuration, properties and defaults are only
+    // requested again once the cached ones are older than cacheTtl
+    if (!loadCachedBackend()) {
+      // Get all backend information
+      response = get(IBM_API_URL, getBackendPath + currentApiToken);
+      backends_root = json::parse("{\"backends\":" + response + "}");
+      getBackendPropsResponse = "{\"backends\":" + response + "}";
+
+      // Get current backend properties
+      auto backend_props_response =
+          get(IBM_API_URL, getBackendPropertiesPath, {},
+              {std::make_pair("version", "1"),
+               std::make_pair("access_token", currentApiToken)});
+      xacc::info("Backend property:\n" + backend_props_response);
+      backendPropertiesResponse = backend_props_response;
+      std::vector<std::string> your_available_backends;
+      for (auto &b : backends_root["backends"]) {
+        if (b.count("backend_name") &&
+            b["backend_name"].get<std::string>() == backend) {
+          availableBackends.insert(std::make_pair(backend, b));
+        }
+        if (b.count("backend_name")) {
+          your_available_backends.push_back(
+              b["backend_name"].get<std::string>());
+        }
       }
-    }
 
-    if (!xacc::container::contains(your_available_backends, backend)) {
-      std::stringstream error_ss;
-      error_ss << "IBM Initialization Error:\n";
-      error_ss << "Hub: " << hub << "\n";
-      error_ss << "Group: " << group << "\n";
-      error_ss << "Project: " << project << "\n";
-      error_ss << "The requested backend (" << backend
-               << ") is not available in this allocation.";
-      error_ss << "\n\nAvailable backends are:\n";
-      for (int i = 0; i < your_available_backends.size(); i++) {
-        error_ss << your_available_backends[i] << ( i < your_available_backends.size()-1 ? ", " : "");
-        if (i % 4 == 0) error_ss << "\n";
+      if (!xacc::container::contains(your_available_backends, backend)) {
+        std::stringstream error_ss;
+        error_ss << "IBM Initialization Error:\n";
+        error_ss << "Hub: " << hub << "\n";
+        error_ss << "Group: " << group << "\n";
+        error_ss << "Project: " << project << "\n";
+        error_ss << "The requested backend (" << backend
+                 << ") is not available in this allocation.";
+        error_ss << "\n\nAvailable backends are:\n";
+        for (int i = 0; i < your_available_backends.size(); i++) {
+          error_ss << your_available_backends[i]
+                   << (i < your_available_backends.size() - 1 ? ", " : "");
+          if (i % 4 == 0)
+            error_ss << "\n";
+        }
+        xacc::error(error_ss.str());
       }
-      xacc::error(error_ss.str());
-    }
 
-    chosenBackend = availableBackends[backend];
-    xacc::info("Backend config:\n" + chosenBackend.dump());
+      chosenBackend = availableBackends[backend];
+      xacc::info("Backend config:\n" + chosenBackend.dump());
+      defaults_response =
+          get(IBM_API_URL,
+              IBM_CREDENTIALS_PATH + "/devices/" + backend + "/defaults", {},
+              {std::make_pair("version", "1"),
+               std::make_pair("access_token", currentApiToken)});
+      xacc::info("Backend default:\n" + defaults_response);
+      saveCachedBackend();
+    }
     multi_meas_enabled = chosenBackend.value("multi_meas_enabled", false);
-    defaults_response =
-        get(IBM_API_URL,
-            IBM_CREDENTIALS_PATH + "/devices/" + backend + "/defaults", {},
-            {std::make_pair("version", "1"),
-             std::make_pair("access_token", currentApiToken)});
-    xacc::info("Backend default:\n" + defaults_response);
 
     initialized = true;
   }
@@ -276,6 +419,93 @@ void IBMAccelerator::execute(
   execute(buffer, std::vector<std::shared_ptr<CompositeInstruction>>{circuit});
 }
 
+std::string IBMAccelerator::backendCacheFile() const {
+  auto fileName = hub + "." + group + "." + project + "." + backend + ".json";
+  std::replace(fileName.begin(), fileName.end(), '/', '_');
+  return std::string(getenv("HOME")) + "/.xacc/ibm-cache/" + fileName;
+}
+
+bool IBMAccelerator::loadCachedBackend() {
+  if (cacheTtl <= 0) {
+    return false;
+  }
+  std::ifstream stream(backendCacheFile());
+  if (!stream) {
+    return false;
+  }
+  std::stringstream ss;
+  ss << stream.rdbuf();
+  auto cache = json::parse(ss.str(), nullptr, false);
+  if (cache.is_discarded() || !cache.count("saved") ||
+      !cache.count("backend") || !cache.count("properties") ||
+      !cache.count("defaults")) {
+    return false;
+  }
+  const auto age = std::chrono::duration_cast<std::chrono::seconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                       .count() -
+                   cache["saved"].get<int64_t>();
+  if (age < 0 || age >= cacheTtl) {
+    return false;
+  }
+
+  // Only the backend configuration is parsed here, the properties and
+  // defaults are parsed when first needed.
+  chosenBackend = cache["backend"];
+  availableBackends[backend] = chosenBackend;
+  getBackendPropsResponse = "{\"backends\":[" + chosenBackend.dump() + "]}";
+  backendPropertiesResponse = cache["properties"].get<std::string>();
+  defaults_response = cache["defaults"].get<std::string>();
+  xacc::info("Using the cached configuration of " + backend +
+             " (calibration " + cache.value("calibration", "unknown") + ").");
+  return true;
+}
+
+void IBMAccelerator::saveCachedBackend() const {
+  if (cacheTtl <= 0) {
+    return;
+  }
+  const auto fileName = backendCacheFile();
+  const auto dir = fileName.substr(0, fileName.find_last_of('/'));
+  if (!xacc::directoryExists(dir)) {
+    const auto mode = S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH;
+    mkdir((std::string(getenv("HOME")) + "/.xacc").c_str(), mode);
+    mkdir(dir.c_str(), mode);
+  }
+
+  json cache;
+  cache["saved"] = std::chrono::duration_cast<std::chrono::seconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                       .count();
+  cache["backend"] = chosenBackend;
+  cache["properties"] = backendPropertiesResponse;
+  cache["defaults"] = defaults_response;
+  auto props = json::parse(backendPropertiesResponse, nullptr, false);
+  if (!props.is_discarded() && props.count("last_update_date") &&
+      props["last_update_date"].is_string()) {
+    cache["calibration"] = props["last_update_date"].get<std::string>();
+  }
+
+  // Other processes may read it meanwhile: write then rename
+  const auto tmpFileName = fileName + "." + std::to_string(getpid());
+  {
+    std::ofstream stream(tmpFileName);
+    stream << cache.dump();
+    if (!stream) {
+      xacc::warning("Could not write the IBM backend cache " + fileName);
+      return;
+    }
+  }
+  std::rename(tmpFileName.c_str(), fileName.c_str());
+}
+
+const nlohmann::json &IBMAccelerator::getDefaultsJson() {
+  if (defaultsJson.is_null()) {
+    defaultsJson = json::parse(defaults_response);
+  }
+  return defaultsJson;
+}
+
 std::string QasmQObjGenerator::getQObjJsonStr(
     std::vector<std::shared_ptr<CompositeInstruction>> circuits,
     const int &shots, const nlohmann::json &backend,
@@ -283,12 +513,11 @@ std::string QasmQObjGenerator::getQObjJsonStr(
     std::vector<std::pair<int, int>> &connectivity,
     const nlohmann::json &backendDefaults) {
 
-  // Create a QObj
-  xacc::ibm::QObject qobj;
-  qobj.set_qobj_id("xacc-qobj-id");
-  qobj.set_schema_version("1.1.0");
-  qobj.set_type("QASM");
-  qobj.set_header(QObjectHeader());
+  // The QObj JSON is written one experiment at a time, each experiment
+  // being dropped once checked and written.
+  std::string qobjStr;
+  xacc::ibm::QObjectWriter writer(qobjStr);
+  writer.begin("xacc-qobj-id", "QASM", "1.1.0");
 
   const auto basis_gates =
       backend["basis_gates"].get<std::vector<std::string>>();
@@ -296,16 +525,14 @@ std::string QasmQObjGenerator::getQObjJsonStr(
   const auto gateSet = (xacc::container::contains(basis_gates, "u3"))
                            ? QObjectExperimentVisitor::GateSet::U_CX
                            : QObjectExperimentVisitor::GateSet::RZ_SX_CX;
-  // Create the Experiments
-  std::vector<xacc::ibm::Experiment> experiments;
+  const int nbQubits = backend["n_qubits"].get<int>();
   int maxMemSlots = 0;
   for (auto &kernel : circuits) {
 
     auto visitor = std::make_shared<QObjectExperimentVisitor>(
-        kernel->name(), backend["n_qubits"].get<int>(), gateSet);
+        kernel->name(), nbQubits, gateSet);
 
     InstructionIterator it(kernel);
-    int memSlots = 0;
     while (it.hasNext()) {
       auto nextInst = it.next();
       if (nextInst->isEnabled()) {
@@ -316,7 +543,6 @@ std::string QasmQObjGenerator::getQObjJsonStr(
     // After calling getExperiment, maxMemorySlots should be
     // maxClassicalBit + 1
     auto experiment = visitor->getExperiment();
-    experiments.push_back(experiment);
     if (visitor->maxMemorySlots > maxMemSlots) {
       maxMemSlots = visitor->maxMemorySlots;
     }
@@ -341,6 +567,8 @@ std::string QasmQObjGenerator::getQObjJsonStr(
         }
       }
     }
+    // Before the next visitor resets the measurement registers
+    writer.addExperiment(experiment);
   }
 
   // Create the QObj Config
@@ -351,26 +579,13 @@ std::string QasmQObjGenerator::getQObjJsonStr(
   config.set_memory_slots(maxMemSlots);
   config.set_meas_return("avg");
   config.set_memory_slot_size(100);
-  config.set_n_qubits(backend["n_qubits"].get<int>());
-
-  // Add the experiments and config
-  qobj.set_experiments(experiments);
-  qobj.set_config(config);
-
-  // Set the Backend
-  xacc::ibm::Backend bkend;
-  bkend.set_name(backend["backend_name"].get<std::string>());
+  config.set_n_qubits(nbQubits);
 
   xacc::ibm::QObjectHeader qobjHeader;
   qobjHeader.set_backend_version("1.0.0");
   qobjHeader.set_backend_name(backend["backend_name"].get<std::string>());
-  qobj.set_header(qobjHeader);
-
-  // Create the JSON String to send
-  nlohmann::json j;
-  nlohmann::to_json(j, qobj);
-
-  return j.dump();
+  writer.end(config, qobjHeader);
+  return qobjStr;
 }
 
 std::string PulseQObjGenerator::getQObjJsonStr(
@@ -423,8 +638,7 @@ std::string PulseQObjGenerator::getQObjJsonStr(
     hh.set_memory_slots(backend["n_qubits"].get<int>());
 
     xacc::ibm_pulse::Experiment experiment;
-    experiment.set_instructions(alignMeasurePulseInstructions(
-        orderFrameChangeInsts(visitor->instructions)));
+    experiment.set_instructions(toQObjInstructions(visitor->instructions));
     experiment.set_header(hh);
     experiments.push_back(experiment);
 
@@ -487,6 +701,598 @@ std::string PulseQObjGenerator::getQObjJsonStr(
 void IBMAccelerator::execute(
     std::shared_ptr<AcceleratorBuffer> buffer,
     const std::vector<std::shared_ptr<CompositeInstruction>> circuits) {
+  if (useSession) {
+    executeSampler(buffer, circuits);
+    return;
+  }
+  auto batches = splitIntoJobs(circuits);
+  runJobs(buffer, *batches);
+}
+
+std::future<void> IBMAccelerator::executeAsync(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::shared_ptr<CompositeInstruction> circuit) {
+  return executeAsync(
+      buffer, std::vector<std::shared_ptr<CompositeInstruction>>{circuit});
+}
+
+std::future<void> IBMAccelerator::executeAsync(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>> circuits) {
+  if (useSession) {
+    // The session keeps the backend reserved, only the job is waited on
+    return std::async(std::launch::async, [this, buffer, circuits]() {
+      executeSampler(buffer, circuits);
+    });
+  }
+  auto batches = splitIntoJobs(circuits);
+  submitPendingJobs(buffer, *batches);
+  return std::async(std::launch::async, [this, buffer, batches]() {
+    runJobs(buffer, *batches);
+  });
+}
+
+std::shared_ptr<IBMAccelerator::JobBatches> IBMAccelerator::splitIntoJobs(
+    const std::vector<std::shared_ptr<CompositeInstruction>> &circuits) {
+  std::size_t jobSize = maxExperiments;
+  if (jobSize == 0) {
+    jobSize = availableBackends[backend].value("max_experiments", 0);
+  }
+  if (jobSize == 0) {
+    jobSize = std::max<std::size_t>(1, circuits.size());
+  }
+
+  auto batches = std::make_shared<JobBatches>();
+  for (std::size_t i = 0; i < circuits.size(); i += jobSize) {
+    batches->circuits.emplace_back(
+        circuits.begin() + i,
+        circuits.begin() + std::min(circuits.size(), i + jobSize));
+  }
+  if (batches->circuits.empty()) {
+    batches->circuits.emplace_back();
+  }
+  batches->jobIds.resize(batches->circuits.size());
+  batches->completions.resize(batches->circuits.size());
+  batches->timers.resize(batches->circuits.size());
+  batches->results.resize(batches->circuits.size());
+  // A single circuit persists its counts to the buffer itself
+  batches->asChildren = circuits.size() > 1;
+  if (batches->circuits.size() > 1) {
+    xacc::info("Splitting " + std::to_string(circuits.size()) +
+               " circuits into " + std::to_string(batches->circuits.size()) +
+               " IBM jobs of at most " + std::to_string(jobSize) +
+               " experiments.");
+  }
+  return batches;
+}
+
+void IBMAccelerator::submitPendingJobs(
+    std::shared_ptr<AcceleratorBuffer> buffer, JobBatches &batches) {
+  while (batches.inFlight.size() < maxJobsInFlight &&
+         batches.nextToSubmit < batches.circuits.size()) {
+    const auto idx = batches.nextToSubmit++;
+    auto timer = std::make_shared<ExecutionTimer>();
+    const auto job_id = submitJob(buffer, batches.circuits[idx]);
+    batches.jobIds[idx] = job_id;
+    batches.timers[idx] = timer;
+    batches.completions[idx] = RemoteJobPoller::instance().watch(
+        [this, job_id, timer, dots = 1]() mutable {
+          return pollJobStatus(job_id, dots, *timer);
+        });
+    batches.inFlight.emplace_back(idx);
+  }
+  if (batches.circuits.size() > 1) {
+    std::vector<std::string> submitted(
+        batches.jobIds.begin(), batches.jobIds.begin() + batches.nextToSubmit);
+    buffer->addExtraInfo("ibm-job-ids", submitted);
+  }
+}
+
+void IBMAccelerator::runJobs(std::shared_ptr<AcceleratorBuffer> buffer,
+                             JobBatches &batches) {
+  while (batches.nextToMerge < batches.circuits.size()) {
+    submitPendingJobs(buffer, batches);
+
+    bool progress = false;
+    for (auto iter = batches.inFlight.begin();
+         iter != batches.inFlight.end();) {
+      const auto idx = *iter;
+      auto &completion = batches.completions[idx];
+      if (completion.wait_for(std::chrono::seconds(0)) !=
+          std::future_status::ready) {
+        ++iter;
+        continue;
+      }
+      // Rethrows a job failure
+      completion.get();
+      // Download as soon as the job is done, while the others still run
+      if (batches.circuits.size() == 1) {
+        batches.results[idx] = buffer;
+      } else {
+        batches.results[idx] =
+            std::make_shared<AcceleratorBuffer>(buffer->size());
+      }
+      persistJobResults(batches.results[idx], batches.circuits[idx],
+                        batches.jobIds[idx], batches.asChildren);
+      ExecutionMetrics metrics;
+      metrics.jobId = batches.jobIds[idx];
+      metrics.nbCircuits = batches.circuits[idx].size();
+      metrics.nbShots = shots;
+      reportExecutionMetrics(batches.timers[idx]->stop(metrics));
+      iter = batches.inFlight.erase(iter);
+      progress = true;
+    }
+
+    // Merge the children in the original circuit order
+    while (batches.nextToMerge < batches.circuits.size() &&
+           batches.results[batches.nextToMerge]) {
+      auto &results = batches.results[batches.nextToMerge];
+      if (results != buffer) {
+        for (auto &child : results->getChildren()) {
+          buffer->appendChild(child->name(), child);
+        }
+      }
+      results.reset();
+      batches.nextToMerge++;
+    }
+
+    if (!progress && !batches.inFlight.empty()) {
+      // The poller thread does the status requests, only wait on it here
+      batches.completions[batches.inFlight.front()].wait_for(
+          std::chrono::milliseconds(100));
+    }
+  }
+}
+
+IBMAccelerator::RuntimePubs IBMAccelerator::toRuntimePubs(
+    const std::vector<std::shared_ptr<CompositeInstruction>> &circuits) {
+  chosenBackend = availableBackends[backend];
+  const auto basis_gates =
+      chosenBackend["basis_gates"].get<std::vector<std::string>>();
+  const auto gateSet = (xacc::container::contains(basis_gates, "u3"))
+                           ? QObjectExperimentVisitor::GateSet::U_CX
+                           : QObjectExperimentVisitor::GateSet::RZ_SX_CX;
+  const int nbQubits = chosenBackend["n_qubits"].get<int>();
+  const auto connectivity = getConnectivity();
+
+  RuntimePubs pubs;
+  std::unordered_map<std::string, std::size_t> templateIds;
+  for (auto &circuit : circuits) {
+    if (circuit->isAnalog()) {
+      xacc::error("IBM Runtime sessions only run gate-level circuits, '" +
+                  circuit->name() + "' is a pulse program.");
+    }
+    // Lowered to the backend basis gates as for the QObj
+    auto visitor = std::make_shared<QObjectExperimentVisitor>(
+        circuit->name(), nbQubits, gateSet);
+    InstructionIterator it(circuit);
+    while (it.hasNext()) {
+      auto nextInst = it.next();
+      if (nextInst->isEnabled()) {
+        nextInst->accept(visitor);
+      }
+    }
+    const auto experiment = visitor->getExperiment();
+
+    // Every angle is an input of the template, named with a fixed width so
+    // that Qiskit orders them (by name) as they are declared.
+    std::size_t nbParams = 0;
+    for (auto &inst : experiment.get_instructions()) {
+      nbParams += inst.get_params().size();
+    }
+    const auto width = std::to_string(nbParams).size();
+    const auto paramName = [width](std::size_t in_idx) {
+      auto idx = std::to_string(in_idx);
+      return "p" + std::string(width - idx.size(), '0') + idx;
+    };
+
+    Emitter body;
+    std::vector<double> values;
+    for (auto &inst : experiment.get_instructions()) {
+      if (inst.isBfuc() || inst.get_condition_reg_id().has_value()) {
+        xacc::error("Circuit '" + circuit->name() +
+                    "' has conditional instructions, not supported by the "
+                    "IBM Runtime session mode");
+      }
+      const auto &qubits = inst.get_qubits();
+      if (inst.get_name() == "cx" &&
+          !xacc::container::contains(
+              connectivity, std::pair<int, int>(qubits[0], qubits[1]))) {
+        std::stringstream ss;
+        ss << "Invalid logical program connectivity, no connection between "
+           << qubits;
+        xacc::error(ss.str());
+      }
+      if (inst.get_name() == "measure") {
+        body << "c[" << inst.get_memory()[0] << "] = measure q[" << qubits[0]
+             << "];\n";
+        continue;
+      }
+      body << inst.get_name();
+      const auto params = inst.get_params();
+      for (std::size_t i = 0; i < params.size(); ++i) {
+        body << (i == 0 ? "(" : ", ") << paramName(values.size());
+        values.emplace_back(params[i]);
+      }
+      body << (params.empty() ? "" : ")");
+      for (std::size_t i = 0; i < qubits.size(); ++i) {
+        body << (i == 0 ? " q[" : ", q[") << qubits[i] << "]";
+      }
+      body << ";\n";
+    }
+
+    Emitter qasm;
+    qasm << "OPENQASM 3.0;\ninclude \"stdgates.inc\";\n";
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      qasm << "input float[64] " << paramName(i) << ";\n";
+    }
+    qasm << "qubit[" << nbQubits << "] q;\n";
+    if (visitor->maxMemorySlots > 0) {
+      qasm << "bit[" << visitor->maxMemorySlots << "] c;\n";
+    }
+    qasm << body.str();
+
+    auto inserted = templateIds.emplace(qasm.str(), pubs.templates.size());
+    if (inserted.second) {
+      pubs.templates.emplace_back(qasm.take());
+      pubs.bindings.emplace_back();
+    }
+    const auto templateId = inserted.first->second;
+    // Without parameters, the circuits of a template are the same one
+    if (!values.empty() || pubs.bindings[templateId].empty()) {
+      pubs.bindings[templateId].emplace_back(std::move(values));
+    }
+    pubs.circuits.emplace_back(templateId,
+                               pubs.bindings[templateId].size() - 1);
+  }
+  if (pubs.templates.size() < circuits.size()) {
+    xacc::info("IBM Runtime: " + std::to_string(circuits.size()) +
+               " circuits sent as " + std::to_string(pubs.templates.size()) +
+               " parameterized circuits.");
+  }
+  return pubs;
+}
+
+std::map<std::string, std::string> IBMAccelerator::runtimeHeaders() const {
+  return {{"Content-Type", "application/json"},
+          {"Connection", "keep-alive"},
+          {"X-Access-Token", currentApiToken}};
+}
+
+void IBMAccelerator::openSession() {
+  {
+    std::lock_guard<std::mutex> lock(runningJobsLock);
+    if (!sessionId.empty()) {
+      return;
+    }
+  }
+  nlohmann::json request;
+  request["backend"] = backend;
+  request["instance"] = hub + "/" + group + "/" + project;
+  request["mode"] = "dedicated";
+  request["max_ttl"] = sessionMaxTtl;
+  const auto requestStr = request.dump();
+  auto headers = runtimeHeaders();
+  headers["Content-Length"] = std::to_string(requestStr.length());
+  const auto response =
+      json::parse(post(IBM_RUNTIME_URL, "/sessions", requestStr, headers));
+  const auto id = response["id"].get<std::string>();
+
+  std::lock_guard<std::mutex> lock(runningJobsLock);
+  if (!sessionId.empty()) {
+    // Opened by a concurrent execution in the meantime
+    try {
+      restClient->del(IBM_RUNTIME_URL, "/sessions/" + id + "/close",
+                      runtimeHeaders());
+    } catch (std::exception &e) {
+      xacc::warning("Failed to close the IBM Runtime session " + id + ": " +
+                    e.what());
+    }
+    return;
+  }
+  sessionId = id;
+  xacc::info("Opened the IBM Runtime session " + sessionId + " on " +
+             backend + ".");
+}
+
+void IBMAccelerator::closeSession() {
+  std::string id;
+  {
+    std::lock_guard<std::mutex> lock(runningJobsLock);
+    std::swap(id, sessionId);
+  }
+  if (id.empty()) {
+    return;
+  }
+  // The jobs already queued in the session still run
+  try {
+    restClient->del(IBM_RUNTIME_URL, "/sessions/" + id + "/close",
+                    runtimeHeaders());
+    xacc::info("Closed the IBM Runtime session " + id + ".");
+  } catch (std::exception &e) {
+    xacc::warning("Failed to close the IBM Runtime session " + id + ": " +
+                  e.what());
+  }
+}
+
+nlohmann::json IBMAccelerator::runRuntimeJob(
+    const std::vector<std::shared_ptr<AcceleratorBuffer>> &buffers,
+    const std::string &program, const nlohmann::json &params,
+    std::size_t nbCircuits) {
+  openSession();
+  nlohmann::json job;
+  job["program_id"] = program;
+  job["backend"] = backend;
+  job["hub"] = hub;
+  job["group"] = group;
+  job["project"] = project;
+  {
+    std::lock_guard<std::mutex> lock(runningJobsLock);
+    job["session_id"] = sessionId;
+  }
+  job["params"] = params;
+  const auto jobStr = job.dump();
+  if (xacc::verbose) {
+    xacc::info("IBM Runtime job: " + jobStr);
+  }
+
+  auto headers = runtimeHeaders();
+  headers["Content-Length"] = std::to_string(jobStr.length());
+  auto timer = std::make_shared<ExecutionTimer>();
+  const auto response =
+      json::parse(post(IBM_RUNTIME_URL, "/jobs", jobStr, headers));
+  const auto job_id = response["id"].get<std::string>();
+  {
+    std::lock_guard<std::mutex> lock(runningJobsLock);
+    runningJobs.insert(job_id);
+  }
+  for (auto &buffer : buffers) {
+    buffer->addExtraInfo("ibm-job-id", job_id);
+    buffer->addExtraInfo("ibm-session-id", job["session_id"].get<std::string>());
+  }
+
+  RemoteJobPoller::instance().wait([this, job_id, timer]() {
+    return pollRuntimeJobStatus(job_id, *timer);
+  });
+  auto results = json::parse(
+      get(IBM_RUNTIME_URL, "/jobs/" + job_id + "/results", runtimeHeaders()));
+  if (xacc::verbose) {
+    xacc::info("Results Json:\n" + results.dump());
+  }
+
+  ExecutionMetrics metrics;
+  metrics.jobId = job_id;
+  metrics.nbCircuits = nbCircuits;
+  metrics.nbShots = shots;
+  reportExecutionMetrics(timer->stop(metrics));
+  return results;
+}
+
+bool IBMAccelerator::pollRuntimeJobStatus(const std::string &job_id,
+                                          ExecutionTimer &timer) {
+  auto job_json = json::parse(
+      get(IBM_RUNTIME_URL, "/jobs/" + job_id, runtimeHeaders()));
+  std::string status = job_json.value("status", "");
+  if (job_json.count("state") && job_json["state"].count("status")) {
+    status = job_json["state"]["status"].get<std::string>();
+  }
+  std::transform(status.begin(), status.end(), status.begin(), ::toupper);
+  if (xacc::verbose) {
+    xacc::info("IBM Runtime Job " + job_id + " Status: " + status);
+  }
+
+  if (status == "FAILED" || status == "CANCELLED" ||
+      status.find("ERROR") != std::string::npos) {
+    {
+      std::lock_guard<std::mutex> lock(runningJobsLock);
+      runningJobs.erase(job_id);
+    }
+    xacc::error("IBM Runtime Job Failed: " + job_json.dump(4));
+  }
+  if (status == "RUNNING" || status == "COMPLETED") {
+    timer.started();
+  }
+  if (status != "COMPLETED") {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(runningJobsLock);
+  runningJobs.erase(job_id);
+  return true;
+}
+
+void IBMAccelerator::executeSampler(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>> &circuits) {
+  for (auto &c : circuits) {
+    if (hasMidCircuitMeasurement(c) && !multi_meas_enabled) {
+      xacc::error("Circuit '" + c->name() +
+                  "' has mid-circuit measurement instructions but the backend "
+                  "doesn't support multiple measurement");
+    }
+  }
+  const auto pubs = toRuntimePubs(circuits);
+  nlohmann::json params;
+  params["version"] = 2;
+  params["pubs"] = nlohmann::json::array();
+  for (std::size_t t = 0; t < pubs.templates.size(); ++t) {
+    const bool parameterized = !pubs.bindings[t].front().empty();
+    params["pubs"].push_back(
+        {pubs.templates[t],
+         parameterized ? nlohmann::json(pubs.bindings[t]) : nlohmann::json(),
+         shots});
+  }
+  const auto pubData = runtimePubData(
+      runRuntimeJob({buffer}, "sampler", params, circuits.size()));
+  if (pubData.size() != pubs.templates.size()) {
+    xacc::error("IBM Runtime: expected " +
+                std::to_string(pubs.templates.size()) + " Sampler results.");
+  }
+
+  for (std::size_t i = 0; i < circuits.size(); ++i) {
+    const auto [templateId, bindingId] = pubs.circuits[i];
+    if (!pubData[templateId].count("c")) {
+      xacc::error("IBM Runtime: no measurement results for circuit '" +
+                  circuits[i]->name() + "'.");
+    }
+    // BitArray: the bits of each shot packed big-endian, for each binding
+    const auto &bitArray = runtimeValue(pubData[templateId]["c"]);
+    const auto array = decodeRuntimeArray(bitArray["array"]);
+    const auto nbBits = bitArray["num_bits"].get<std::size_t>();
+    if (array.descr != "|u1" || array.shape.size() < 2) {
+      xacc::error("IBM Runtime: unexpected Sampler bit array.");
+    }
+    const auto nbBytes = array.shape.back();
+    const auto nbShots = array.shape[array.shape.size() - 2];
+    std::map<std::string, int> counts;
+    std::string bits(8 * nbBytes, '0');
+    for (std::size_t shot = 0; shot < nbShots; ++shot) {
+      const auto row = (bindingId * nbShots + shot) * nbBytes;
+      for (std::size_t k = 0; k < nbBytes; ++k) {
+        const auto byte = array.byte(row + k);
+        for (int b = 0; b < 8; ++b) {
+          bits[8 * k + b] = (byte >> (7 - b)) & 1 ? '1' : '0';
+        }
+      }
+      // Classical bit 0 right-most, as in persistJobResults
+      counts[bits.substr(bits.size() - nbBits)]++;
+    }
+
+    if (circuits.size() == 1) {
+      for (auto &kv : counts) {
+        buffer->appendMeasurement(kv.first, kv.second);
+      }
+    } else {
+      auto child = std::make_shared<AcceleratorBuffer>(circuits[i]->name(),
+                                                       buffer->size());
+      for (auto &kv : counts) {
+        child->appendMeasurement(kv.first, kv.second);
+      }
+      buffer->appendChild(circuits[i]->name(), child);
+    }
+  }
+}
+
+void IBMAccelerator::executeEstimator(
+    const std::vector<std::shared_ptr<AcceleratorBuffer>> &buffers,
+    const std::vector<std::shared_ptr<CompositeInstruction>> &ansatzes,
+    std::shared_ptr<Observable> observable) {
+  if (buffers.size() != ansatzes.size()) {
+    xacc::error("computeExpectations: expected one buffer per ansatz.");
+  }
+  const auto nbQubits = availableBackends[backend]["n_qubits"].get<int>();
+  const auto nbTerms = observable->getNonIdentitySubTerms().size();
+  // The (non-identity) observed kernels of each ansatz and their Pauli labels
+  std::vector<std::vector<std::string>> kernelNames;
+  std::vector<std::string> labels;
+  bool estimated = true;
+  for (std::size_t i = 0; i < ansatzes.size() && estimated; ++i) {
+    std::vector<std::string> names;
+    std::vector<std::string> ansatzLabels;
+    for (auto &kernel : observable->observe(ansatzes[i])) {
+      const int nbInstructions =
+          (kernel->nInstructions() > 0 &&
+           kernel->getInstruction(0)->isComposite())
+              ? ansatzes[i]->nInstructions() + kernel->nInstructions() - 1
+              : kernel->nInstructions();
+      if (nbInstructions <= ansatzes[i]->nInstructions()) {
+        continue;
+      }
+      ansatzLabels.emplace_back(
+          measuredPauli(*kernel, *ansatzes[i], nbQubits));
+      names.emplace_back(kernel->name());
+    }
+    estimated = ansatzLabels.size() == nbTerms &&
+                !xacc::container::contains(ansatzLabels, std::string()) &&
+                (i == 0 || ansatzLabels == labels);
+    labels = std::move(ansatzLabels);
+    kernelNames.emplace_back(std::move(names));
+  }
+  if (!estimated) {
+    xacc::info("IBM Runtime: the observed kernels don't measure one Pauli "
+               "term each, sampling them.");
+    Accelerator::computeExpectations(buffers, ansatzes, observable);
+    return;
+  }
+  if (labels.empty()) {
+    return;
+  }
+
+  const auto pubs = toRuntimePubs(ansatzes);
+  // Shape (terms, 1), broadcast with the bindings: the expectation values of
+  // a PUB have the shape (terms, bindings).
+  auto observables = nlohmann::json::array();
+  for (auto &label : labels) {
+    observables.push_back({label});
+  }
+  nlohmann::json params;
+  params["version"] = 2;
+  params["resilience_level"] = resilienceLevel;
+  params["options"]["default_shots"] = shots;
+  params["pubs"] = nlohmann::json::array();
+  for (std::size_t t = 0; t < pubs.templates.size(); ++t) {
+    const bool parameterized = !pubs.bindings[t].front().empty();
+    params["pubs"].push_back(
+        {pubs.templates[t], observables,
+         parameterized ? nlohmann::json(pubs.bindings[t]) : nlohmann::json()});
+  }
+  const auto pubData = runtimePubData(
+      runRuntimeJob(buffers, "estimator", params, ansatzes.size()));
+  if (pubData.size() != pubs.templates.size()) {
+    xacc::error("IBM Runtime: expected " +
+                std::to_string(pubs.templates.size()) + " Estimator results.");
+  }
+
+  for (std::size_t i = 0; i < ansatzes.size(); ++i) {
+    const auto [templateId, bindingId] = pubs.circuits[i];
+    const auto evs = decodeRuntimeArray(pubData[templateId]["evs"]);
+    const auto stds = pubData[templateId].count("stds")
+                          ? decodeRuntimeArray(pubData[templateId]["stds"])
+                          : RuntimeArray{};
+    const auto nbBindings = pubs.bindings[templateId].front().empty()
+                                ? 1
+                                : pubs.bindings[templateId].size();
+    if (evs.descr != "<f8" || evs.size() != labels.size() * nbBindings) {
+      xacc::error("IBM Runtime: unexpected Estimator expectation values.");
+    }
+    for (std::size_t k = 0; k < labels.size(); ++k) {
+      const auto idx = k * nbBindings + bindingId;
+      auto child = std::make_shared<AcceleratorBuffer>(kernelNames[i][k],
+                                                       buffers[i]->size());
+      child->addExtraInfo("exp-val-z", evs.real(idx));
+      if (stds.descr == "<f8" && stds.size() == evs.size()) {
+        child->addExtraInfo("exp-val-z-stddev", stds.real(idx));
+      }
+      buffers[i]->appendChild(kernelNames[i][k], child);
+    }
+  }
+}
+
+void IBMAccelerator::computeExpectations(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::shared_ptr<CompositeInstruction> ansatz,
+    std::shared_ptr<Observable> observable) {
+  if (!useSession) {
+    Accelerator::computeExpectations(buffer, ansatz, observable);
+    return;
+  }
+  executeEstimator({buffer}, {ansatz}, observable);
+}
+
+void IBMAccelerator::computeExpectations(
+    const std::vector<std::shared_ptr<AcceleratorBuffer>> &buffers,
+    const std::vector<std::shared_ptr<CompositeInstruction>> &ansatzes,
+    std::shared_ptr<Observable> observable) {
+  if (!useSession) {
+    Accelerator::computeExpectations(buffers, ansatzes, observable);
+    return;
+  }
+  executeEstimator(buffers, ansatzes, observable);
+}
+
+std::string IBMAccelerator::submitJob(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>> circuits) {
 
   // Local Declarations
   std::string backendName = backend;
@@ -528,9 +1334,12 @@ void IBMAccelerator::execute(
   // Generate the QObject JSON
   auto jsonStr = qobjGen->getQObjJsonStr(circuits, shots, chosenBackend,
                                          getBackendPropsResponse, connectivity,
-                                         json::parse(defaults_response));
+                                         getDefaultsJson());
 
-  xacc::info("qobj: " + jsonStr);
+  if (xacc::verbose) {
+    // Large for many experiments: only copied when logged
+    xacc::info("qobj: " + jsonStr);
+  }
 
   // Now we have JSON QObj, lets start the object upload
   // First reserve the Job on IBM's end
@@ -549,7 +1358,10 @@ void IBMAccelerator::execute(
 
   // Job reserved, get the Job ID
   auto job_id = reserve_response_json["id"].get<std::string>();
-  currentJobId = job_id;
+  {
+    std::lock_guard<std::mutex> lock(runningJobsLock);
+    runningJobs.insert(job_id);
+  }
 
   buffer->addExtraInfo("ibm-job-id", job_id);
 
@@ -572,79 +1384,82 @@ void IBMAccelerator::execute(
                "/jobDataUploaded?access_token=" + currentApiToken,
            "");
   auto uploaded_response_json = json::parse(uploaded_response);
+  return job_id;
+}
 
-  // Get the Job status for the first time, will likely have
-  // just started
+bool IBMAccelerator::pollJobStatus(const std::string &job_id, int &dots,
+                                   ExecutionTimer &timer) {
   auto get_job_status =
       get(IBM_API_URL, IBM_CREDENTIALS_PATH + "/Jobs/" + job_id +
                            "?access_token=" + currentApiToken);
   auto get_job_status_json = json::parse(get_job_status);
-  jobIsRunning = true;
-
-  // Job has started, so watch for status == COMPLETED
-  int dots = 1;
-  while (true) {
-    get_job_status = get(IBM_API_URL, IBM_CREDENTIALS_PATH + "/Jobs/" + job_id +
-                                          "?access_token=" + currentApiToken);
-    get_job_status_json = json::parse(get_job_status);
-
-    // Bool to indicate if we should print status
-    // from infoQueue or just the job status itself
-    bool printInfoQueue =
-        get_job_status_json.find("infoQueue") != get_job_status_json.end() &&
-        get_job_status_json["infoQueue"]["status"].get<std::string>() !=
-            "RUNNING";
-
-    // Give the user some feedback on the currently
-    // running job
-    if (xacc::verbose) {
-      if (printInfoQueue) {
-        xacc::info(
-            "IBM Job " + job_id + " Status: " +
-            get_job_status_json["infoQueue"]["status"].get<std::string>());
-      } else {
-        xacc::info("IBM Job " + job_id + " Status: " +
-                   get_job_status_json["status"].get<std::string>());
-      }
-    } else {
-      std::stringstream ss;
-      if (printInfoQueue) {
-        ss << "\033[0;32m"
-           << "IBM Job "
-           << "\033[0;36m" << job_id << "\033[0;32m"
-           << " Status: "
-           << get_job_status_json["infoQueue"]["status"].get<std::string>();
-        std::cout << '\r' << std::setw(28) << std::setfill(' ') << ss.str()
-                  << std::flush;
-      } else {
-        if (dots > 4)
-          dots = 1;
-        ss << "\033[0;32m"
-           << "IBM Job "
-           << "\033[0;36m" << job_id << "\033[0;32m"
-           << " Status: " << get_job_status_json["status"].get<std::string>();
-        for (int i = 0; i < dots; i++)
-          ss << '.';
-        dots++;
-        std::cout << '\r' << ss.str() << std::setw(20) << std::setfill(' ')
-                  << std::flush;
-      }
-    }
 
-    if (get_job_status_json["status"].get<std::string>().find("ERROR") !=
-        std::string::npos) {
-      xacc::error("IBM Job Failed: " + get_job_status_json.dump(4));
+  // Bool to indicate if we should print status
+  // from infoQueue or just the job status itself
+  bool printInfoQueue =
+      get_job_status_json.find("infoQueue") != get_job_status_json.end() &&
+      get_job_status_json["infoQueue"]["status"].get<std::string>() !=
+          "RUNNING";
+
+  // Give the user some feedback on the currently
+  // running job
+  if (xacc::verbose) {
+    if (printInfoQueue) {
+      xacc::info(
+          "IBM Job " + job_id + " Status: " +
+          get_job_status_json["infoQueue"]["status"].get<std::string>());
+    } else {
+      xacc::info("IBM Job " + job_id + " Status: " +
+                 get_job_status_json["status"].get<std::string>());
     }
-    if (get_job_status_json["status"].get<std::string>() == "COMPLETED") {
-      break;
+  } else {
+    std::stringstream ss;
+    if (printInfoQueue) {
+      ss << "\033[0;32m"
+         << "IBM Job "
+         << "\033[0;36m" << job_id << "\033[0;32m"
+         << " Status: "
+         << get_job_status_json["infoQueue"]["status"].get<std::string>();
+      std::cout << '\r' << std::setw(28) << std::setfill(' ') << ss.str()
+                << std::flush;
+    } else {
+      if (dots > 4)
+        dots = 1;
+      ss << "\033[0;32m"
+         << "IBM Job "
+         << "\033[0;36m" << job_id << "\033[0;32m"
+         << " Status: " << get_job_status_json["status"].get<std::string>();
+      for (int i = 0; i < dots; i++)
+        ss << '.';
+      dots++;
+      std::cout << '\r' << ss.str() << std::setw(20) << std::setfill(' ')
+                << std::flush;
     }
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  if (get_job_status_json["status"].get<std::string>().find("ERROR") !=
+      std::string::npos) {
+    xacc::error("IBM Job Failed: " + get_job_status_json.dump(4));
+  }
+  const auto status = get_job_status_json["status"].get<std::string>();
+  if (status == "RUNNING" || status == "COMPLETED") {
+    timer.started();
+  }
+  if (status != "COMPLETED") {
+    return false;
   }
 
   std::cout << "\033[0m"
             << "\n";
-  jobIsRunning = false;
+  std::lock_guard<std::mutex> lock(runningJobsLock);
+  runningJobs.erase(job_id);
+  return true;
+}
 
+void IBMAccelerator::persistJobResults(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>> &circuits,
+    const std::string &job_id, const bool asChildren) {
   // Job is done, now get the results download URL from IBM
   auto result_download_response = get(
       IBM_API_URL, IBM_CREDENTIALS_PATH + "/Jobs/" + job_id +
@@ -680,14 +1495,14 @@ void IBMAccelerator::execute(
       for (int i = 0; i < nMeasures; i++)
         actual[actual.length() - 1 - i] = bitStr[bitStr.length() - i - 1];
 
-      if (results.size() == 1) {
+      if (!asChildren) {
         buffer->appendMeasurement(actual, nOccurrences);
       } else {
         tmpBuffer->appendMeasurement(actual, nOccurrences);
       }
     }
 
-    if (results.size() > 1) {
+    if (asChildren) {
       buffer->appendChild(currentExperiment, tmpBuffer);
     }
 
@@ -696,20 +1511,42 @@ void IBMAccelerator::execute(
 }
 
 void IBMAccelerator::cancel() {
-  xacc::info("Attempting to cancel IBM job " + currentJobId);
-  if (!hub.empty() && jobIsRunning && !currentJobId.empty()) {
-    xacc::info("Canceling IBM Job " + currentJobId);
+  {
+    std::lock_guard<std::mutex> lock(runningJobsLock);
+    xacc::info("Attempting to cancel " + std::to_string(runningJobs.size()) +
+               " IBM job(s)");
+    if (hub.empty()) {
+      return;
+    }
+    if (!sessionId.empty()) {
+      for (auto &job_id : runningJobs) {
+        xacc::info("Canceling IBM Runtime Job " + job_id);
+        try {
+          restClient->post(IBM_RUNTIME_URL, "/jobs/" + job_id + "/cancel", "",
+                           runtimeHeaders());
+        } catch (std::exception &e) {
+          xacc::warning("Failed to cancel IBM Runtime Job " + job_id + ": " +
+                        e.what());
+        }
+      }
+      runningJobs.clear();
+    }
+  }
+  closeSession();
+
+  std::lock_guard<std::mutex> lock(runningJobsLock);
+  for (auto &job_id : runningJobs) {
+    xacc::info("Canceling IBM Job " + job_id);
     std::map<std::string, std::string> headers{
         {"Content-Type", "application/x-www-form-urlencoded"},
         {"Connection", "keep-alive"},
         {"Content-Length", "0"}};
-    auto path = IBM_CREDENTIALS_PATH + "/Jobs/" + currentJobId +
+    auto path = IBM_CREDENTIALS_PATH + "/Jobs/" + job_id +
                 "/cancel?access_token=" + currentApiToken;
     auto response = post(IBM_API_URL, path, "", headers);
     xacc::info("Cancel Response: " + response);
-    jobIsRunning = false;
-    currentJobId = "";
   }
+  runningJobs.clear();
 }
 
 std::vector<std::pair<int, int>> IBMAccelerator::getConnectivity() {
@@ -797,6 +1634,10 @@ void IBMAccelerator::findApiKeyInFile(std::string &apiKey, std::string &hub,
 HeterogeneousMap IBMAccelerator::getProperties() {
   HeterogeneousMap m;
 
+  if (!backendProperties.count(backend) &&
+      !backendPropertiesResponse.empty()) {
+    backendProperties.insert({backend, json::parse(backendPropertiesResponse)});
+  }
   if (backendProperties.count(backend)) {
     auto props = backendProperties[backend];
 
@@ -831,7 +1672,7 @@ void IBMAccelerator::contributeInstructions(
   auto provider = xacc::getIRProvider("quantum");
   json j;
   if (custom_json_config.empty()) {
-    j = json::parse(defaults_response);
+    j = getDefaultsJson();
   } else {
     j = json::parse(custom_json_config);
   }
@@ -998,91 +1839,41 @@ void IBMAccelerator::contributeInstructions(
   //   }
 }
 
+// The requests go through xacc::Client, for its pooled keep-alive sessions.
 const std::string RestClient::post(const std::string &remoteUrl,
                                    const std::string &path,
                                    const std::string &postStr,
                                    std::map<std::string, std::string> headers) {
-
-  if (headers.empty()) {
-    headers.insert(std::make_pair("Content-type", "application/json"));
-    headers.insert(std::make_pair("Connection", "keep-alive"));
-    headers.insert(std::make_pair("Accept", "*/*"));
-  }
-
-  cpr::Header cprHeaders;
-  for (auto &kv : headers) {
-    cprHeaders.insert({kv.first, kv.second});
-  }
-
   if (verbose)
     xacc::info("Posting to " + remoteUrl + path + ", with data " + postStr);
 
-  auto r = cpr::Post(cpr::Url{remoteUrl + path}, cpr::Body(postStr), cprHeaders,
-                     cpr::VerifySsl(false));
-
-  if (r.status_code != 200)
-    throw std::runtime_error("HTTP POST Error - status code " +
-                             std::to_string(r.status_code) + ": " +
-                             r.error.message + ": " + r.text);
-
-  return r.text;
+  return Client().post(remoteUrl, path, postStr, headers);
 }
 
 void RestClient::put(const std::string &remoteUrl, const std::string &putStr,
                      std::map<std::string, std::string> headers) {
-  if (headers.empty()) {
-    headers.insert(std::make_pair("Content-type", "application/json"));
-    headers.insert(std::make_pair("Connection", "keep-alive"));
-    headers.insert(std::make_pair("Accept", "*/*"));
-  }
-
-  cpr::Header cprHeaders;
-  for (auto &kv : headers) {
-    cprHeaders.insert({kv.first, kv.second});
-  }
-
   if (verbose)
     xacc::info("PUT to " + remoteUrl + " with data " + putStr);
-  auto r = cpr::Put(cpr::Url{remoteUrl}, cpr::Body(putStr), cprHeaders,
-                    cpr::VerifySsl(false));
 
-  if (r.status_code != 200)
-    throw std::runtime_error("HTTP POST Error - status code " +
-                             std::to_string(r.status_code) + ": " +
-                             r.error.message + ": " + r.text);
-  return;
+  Client().put(remoteUrl, putStr, headers);
 }
+
 const std::string
 RestClient::get(const std::string &remoteUrl, const std::string &path,
                 std::map<std::string, std::string> headers,
                 std::map<std::string, std::string> extraParams) {
-  if (headers.empty()) {
-    headers.insert(std::make_pair("Content-type", "application/json"));
-    headers.insert(std::make_pair("Connection", "keep-alive"));
-    headers.insert(std::make_pair("Accept", "*/*"));
-  }
-
-  cpr::Header cprHeaders;
-  for (auto &kv : headers) {
-    cprHeaders.insert({kv.first, kv.second});
-  }
-
-  cpr::Parameters cprParams;
-  for (auto &kv : extraParams) {
-    cprParams.AddParameter({kv.first, kv.second});
-  }
-
   if (verbose)
     xacc::info("GET at " + remoteUrl + path);
-  auto r = cpr::Get(cpr::Url{remoteUrl + path}, cprHeaders, cprParams,
-                    cpr::VerifySsl(false));
 
-  if (r.status_code != 200)
-    throw std::runtime_error("HTTP GET Error - status code " +
-                             std::to_string(r.status_code) + ": " +
-                             r.error.message + ": " + r.text);
+  return Client().get(remoteUrl, path, headers, extraParams);
+}
+
+void RestClient::del(const std::string &remoteUrl, const std::string &path,
+                     std::map<std::string, std::string> headers) {
+  if (verbose)
+    xacc::info("DELETE at " + remoteUrl + path);
 
-  return r.text;
+  Client().del(remoteUrl, path, headers);
 }
 
 std::string IBMAccelerator::post(const std::string &_url,
@@ -1217,8 +2008,16 @@ void IBMPulseTransform::apply(std::shared_ptr<CompositeInstruction> program,
   }
   auto loweredKernel = pulseMapper->pulseComposite;
   xacc::info("Pulse-level kernel: \n" + loweredKernel->toString());
-  // Schedule the pulses
-  scheduler->schedule(loweredKernel);
+  // Schedule the pulses: command defs on disjoint channels run in parallel
+  // by default ("scheduler-policy" option), measurements start together.
+  const std::string policy =
+      options.stringExists("scheduler-policy")
+          ? options.getString("scheduler-policy")
+          : "asap";
+  scheduler->schedule(loweredKernel,
+                      {{"policy", policy},
+                       {"align-measurements", true},
+                       {"coalesce-frame-changes", true}});
   program->clear();
   program->addInstructions(loweredKernel->getInstructions());
 }
@@ -16,7 +16,11 @@
 #include "InstructionIterator.hpp"
 #include "Properties.hpp"
 #include "Accelerator.hpp"
+#include "RemoteAccelerator.hpp"
+#include <algorithm>
 #include <bitset>
+#include <mutex>
+#include <set>
 #include <type_traits>
 #include "Backends.hpp"
 #include "Properties.hpp"
@@ -72,6 +76,9 @@ public:
       std::map<std::string, std::string> headers =
           std::map<std::string, std::string>{},
       std::map<std::string, std::string> extraParams = {});
+  virtual void del(const std::string &remoteUrl, const std::string &path,
+                   std::map<std::string, std::string> headers =
+                       std::map<std::string, std::string>{});
 
   virtual ~RestClient() {}
 };
@@ -108,10 +115,37 @@ public:
     if (config.stringExists("mode")) {
       mode = config.getString("mode");
     }
+    // Job splitting: experiments per job (defaults to the backend's
+    // max_experiments) and number of jobs queued at the same time.
+    if (config.keyExists<int>("max-experiments")) {
+      maxExperiments = config.get<int>("max-experiments");
+    }
+    if (config.keyExists<int>("cache-ttl")) {
+      cacheTtl = config.get<int>("cache-ttl");
+    }
+    if (config.keyExists<int>("max-jobs-in-flight")) {
+      maxJobsInFlight = std::max(1, config.get<int>("max-jobs-in-flight"));
+    }
+    // IBM Runtime session mode (Sampler/Estimator primitives)
+    if (config.keyExists<bool>("session")) {
+      useSession = config.get<bool>("session");
+      if (!useSession) {
+        closeSession();
+      }
+    }
+    if (config.keyExists<int>("session-max-ttl")) {
+      sessionMaxTtl = config.get<int>("session-max-ttl");
+    }
+    if (config.keyExists<int>("resilience-level")) {
+      resilienceLevel = config.get<int>("resilience-level");
+    }
+    // Backoff and rate limit of the job status polls
+    RemoteJobPoller::instance().configure(config);
   }
 
   const std::vector<std::string> configurationKeys() override {
-    return {"shots", "backend"};
+    return {"shots", "backend", "session", "session-max-ttl",
+            "resilience-level"};
   }
 
   HeterogeneousMap getProperties() override;
@@ -144,12 +178,35 @@ public:
                const std::vector<std::shared_ptr<CompositeInstruction>>
                    circuits) override;
 
+  // Uploads the job before returning, only waiting
+  // on the job and retrieving results is asynchronous.
+  std::future<void>
+  executeAsync(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::shared_ptr<CompositeInstruction> circuit) override;
+
+  std::future<void>
+  executeAsync(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::vector<std::shared_ptr<CompositeInstruction>>
+                   circuits) override;
+
+  // In session mode, the observed terms are estimated by the Estimator
+  // primitive on the ansatz circuits (with the server-side mitigation of
+  // "resilience-level"), one child per term with its "exp-val-z". Grouped
+  // observables (a kernel for several terms), or no session, are sampled.
+  void computeExpectations(std::shared_ptr<AcceleratorBuffer> buffer,
+                           const std::shared_ptr<CompositeInstruction> ansatz,
+                           std::shared_ptr<Observable> observable) override;
+  void computeExpectations(
+      const std::vector<std::shared_ptr<AcceleratorBuffer>> &buffers,
+      const std::vector<std::shared_ptr<CompositeInstruction>> &ansatzes,
+      std::shared_ptr<Observable> observable) override;
+
   bool isRemote() override { return true; }
 
   IBMAccelerator()
       : Accelerator(), restClient(std::make_shared<RestClient>()) {}
 
-  virtual ~IBMAccelerator() {}
+  virtual ~IBMAccelerator() { closeSession(); }
 
 private:
   void searchAPIKey(std::string &key, std::string &hub, std::string &group,
@@ -158,10 +215,86 @@ private:
                         std::string &project, const std::string &p);
   std::shared_ptr<RestClient> restClient;
 
+  // Upload the circuits as a new IBM job and return its id
+  std::string
+  submitJob(std::shared_ptr<AcceleratorBuffer> buffer,
+            const std::vector<std::shared_ptr<CompositeInstruction>> circuits);
+  // Check the status of the given job (printing it) and return
+  // true if it has completed. dots animates the status line, timer is
+  // started once the job is seen running.
+  // Called from the RemoteJobPoller thread.
+  bool pollJobStatus(const std::string &job_id, int &dots,
+                     ExecutionTimer &timer);
+  // Download the results of a completed job and persist them to the buffer,
+  // as children if asChildren, else (a single circuit) as its measurements
+  void persistJobResults(
+      std::shared_ptr<AcceleratorBuffer> buffer,
+      const std::vector<std::shared_ptr<CompositeInstruction>> &circuits,
+      const std::string &job_id, const bool asChildren);
+
+  // Circuits of an execution, split into backend-sized jobs. Up to
+  // maxJobsInFlight of them are queued at a time, and the results of each
+  // job are downloaded as soon as it completes, then merged into the buffer
+  // in the original circuit order.
+  struct JobBatches {
+    std::vector<std::vector<std::shared_ptr<CompositeInstruction>>> circuits;
+    std::vector<std::string> jobIds;
+    std::vector<std::future<void>> completions;
+    // From the submission of each job, for its metrics
+    std::vector<std::shared_ptr<ExecutionTimer>> timers;
+    // Results of the completed jobs not merged yet
+    std::vector<std::shared_ptr<AcceleratorBuffer>> results;
+    std::vector<std::size_t> inFlight;
+    std::size_t nextToSubmit = 0;
+    std::size_t nextToMerge = 0;
+    bool asChildren = true;
+  };
+  std::shared_ptr<JobBatches> splitIntoJobs(
+      const std::vector<std::shared_ptr<CompositeInstruction>> &circuits);
+  void submitPendingJobs(std::shared_ptr<AcceleratorBuffer> buffer,
+                         JobBatches &batches);
+  void runJobs(std::shared_ptr<AcceleratorBuffer> buffer, JobBatches &batches);
+
+  // IBM Runtime session mode ("session"): the circuits are run by the
+  // Sampler and Estimator primitives, in a session opened on first use and
+  // kept across the executions (e.g. the iterations of an optimizer), so that
+  // its jobs don't wait in the fair-share queue again. The session is closed
+  // by cancel(), when the mode is turned off, or after "session-max-ttl"
+  // seconds.
+  // Circuits identical up to their angles share a parameterized OpenQASM 3
+  // template: each job sends the templates once, with a binding per circuit.
+  struct RuntimePubs {
+    std::vector<std::string> templates;
+    // Parameter values of each binding of each template
+    std::vector<std::vector<std::vector<double>>> bindings;
+    // (template, binding) of each circuit
+    std::vector<std::pair<std::size_t, std::size_t>> circuits;
+  };
+  RuntimePubs toRuntimePubs(
+      const std::vector<std::shared_ptr<CompositeInstruction>> &circuits);
+  std::map<std::string, std::string> runtimeHeaders() const;
+  void openSession();
+  void closeSession();
+  // Submits a primitive ("sampler" or "estimator") job in the session (its
+  // id added to the buffers) and returns its results once it has completed
+  nlohmann::json
+  runRuntimeJob(const std::vector<std::shared_ptr<AcceleratorBuffer>> &buffers,
+                const std::string &program, const nlohmann::json &params,
+                std::size_t nbCircuits);
+  bool pollRuntimeJobStatus(const std::string &job_id, ExecutionTimer &timer);
+  void executeSampler(
+      std::shared_ptr<AcceleratorBuffer> buffer,
+      const std::vector<std::shared_ptr<CompositeInstruction>> &circuits);
+  void executeEstimator(
+      const std::vector<std::shared_ptr<AcceleratorBuffer>> &buffers,
+      const std::vector<std::shared_ptr<CompositeInstruction>> &ansatzes,
+      std::shared_ptr<Observable> observable);
+
   static const std::string IBM_AUTH_URL;
   static const std::string IBM_API_URL;
   static const std::string DEFAULT_IBM_BACKEND;
   static const std::string IBM_LOGIN_PATH;
+  static const std::string IBM_RUNTIME_URL;
   std::string IBM_CREDENTIALS_PATH = "";
 
   std::string currentApiToken;
@@ -173,17 +306,39 @@ private:
   int shots = 1024;
   std::string backend = DEFAULT_IBM_BACKEND;
 
-  bool jobIsRunning = false;
-  std::string currentJobId = "";
+  // Experiments per job, 0 for the backend's max_experiments
+  int maxExperiments = 0;
+  int maxJobsInFlight = 5;
+
+  bool useSession = false;
+  int sessionMaxTtl = 8 * 3600;
+  int resilienceLevel = 1;
+  // Guarded by runningJobsLock
+  std::string sessionId;
+
+  // Ids of the submitted jobs that have not completed, for cancel()
+  std::mutex runningJobsLock;
+  std::set<std::string> runningJobs;
 
   std::map<std::string, nlohmann::json> availableBackends;
   nlohmann::json chosenBackend;
   bool multi_meas_enabled = false;
   bool initialized = false;
   nlohmann::json backends_root;
+  // Parsed from backendPropertiesResponse on first use
   std::map<std::string, nlohmann::json> backendProperties;
+  std::string backendPropertiesResponse;
   std::string getBackendPropsResponse = "{}";
   std::string defaults_response = "{}";
+  nlohmann::json defaultsJson;
+
+  // On-disk cache (~/.xacc/ibm-cache) of the backend configuration,
+  // properties and defaults, valid for cacheTtl seconds (0 disables it).
+  int cacheTtl = 3600;
+  std::string backendCacheFile() const;
+  bool loadCachedBackend();
+  void saveCachedBackend() const;
+  const nlohmann::json &getDefaultsJson();
   std::string mode = "qasm";
   std::string post(const std::string &_url, const std::string &path,
                    const std::string &postStr,
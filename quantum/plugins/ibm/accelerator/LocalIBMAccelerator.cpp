@@ -74,7 +74,7 @@ void LocalIBMAccelerator::execute(
       auto nextInst = it.next();
       if (nextInst->isEnabled()) {
         nextInst->accept(visitor);
-        if (nextInst->name() == "Measure") {
+        if (nextInst->opcode() == xacc::GateOpcode::Measure) {
           auto qbitIdx = nextInst->bits()[0];
           measurementSupports[kernelCounter].push_back(qbitIdx);
         }
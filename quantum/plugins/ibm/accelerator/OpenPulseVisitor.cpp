@@ -12,17 +12,41 @@
  *******************************************************************************/
 #include "OpenPulseVisitor.hpp"
 #include "xacc.hpp"
+#include <mutex>
+
 namespace {
-std::shared_ptr<xacc::CompositeInstruction>
-constructUCmdDefComposite(size_t qIdx, const std::string &uGateType) {
+std::string uCmdDefName(size_t qIdx, const std::string &uGateType) {
+  return "pulse::" + uGateType + "_" + std::to_string(qIdx);
+}
 
-  const auto cmdDefName = "pulse::" + uGateType + "_" + std::to_string(qIdx);
-  // If we have a pulse cmd-def defined for U3:
-  if (xacc::hasContributedService<xacc::Instruction>(cmdDefName)) {
-    return xacc::ir::asComposite(
-        xacc::getContributedService<xacc::Instruction>(cmdDefName));
+// Lowered cmd-defs by name and parameters (none for the non-parametric ones),
+// e.g. the u3 of each rotation angle of an ansatz, lowered again on every
+// iteration. A contributed service can't be replaced, so a name always refers
+// to the same cmd-def.
+std::mutex loweredCmdDefsMutex;
+std::map<std::pair<std::string, std::vector<double>>,
+         std::shared_ptr<xacc::Instruction>>
+    loweredCmdDefs;
+
+// A copy of the cmd-def evaluated at the parameters.
+std::shared_ptr<xacc::Instruction>
+lowerCmdDef(const std::string &cmdDefName, const std::vector<double> &params) {
+  auto key = std::make_pair(cmdDefName, params);
+  {
+    std::lock_guard<std::mutex> lock(loweredCmdDefsMutex);
+    auto iter = loweredCmdDefs.find(key);
+    if (iter != loweredCmdDefs.end()) {
+      return iter->second->clone();
+    }
+  }
+  std::shared_ptr<xacc::Instruction> lowered =
+      xacc::getContributedService<xacc::Instruction>(cmdDefName);
+  if (!params.empty()) {
+    lowered = (*xacc::ir::asComposite(lowered))(params);
   }
-  return nullptr;
+  std::lock_guard<std::mutex> lock(loweredCmdDefsMutex);
+  loweredCmdDefs.emplace(std::move(key), lowered->clone());
+  return lowered;
 }
 } // namespace
 namespace xacc {
@@ -36,13 +60,11 @@ void PulseMappingVisitor::visit(Hadamard &h) {
   const auto commandDef = constructPulseCommandDef(h);
 
   if (xacc::hasContributedService<xacc::Instruction>(commandDef)) {
-    auto pulseInst = xacc::getContributedService<xacc::Instruction>(commandDef);
+    auto pulseInst = lowerCmdDef(commandDef, {});
     pulseComposite->addInstruction(pulseInst);
   } else {
     // H = U2(0, pi) = U3(pi/2, 0, pi)
-    const auto asU2 = constructUCmdDefComposite(h.bits()[0], "u2");
-    auto hCmdDef =
-        (*asU2)({0.0, M_PI});
+    auto hCmdDef = lowerCmdDef(uCmdDefName(h.bits()[0], "u2"), {0.0, M_PI});
     pulseComposite->addInstruction(hCmdDef);
   }
 }
@@ -50,7 +72,7 @@ void PulseMappingVisitor::visit(Hadamard &h) {
 void PulseMappingVisitor::visit(CNOT &cnot) {
   const auto commandDef = constructPulseCommandDef(cnot);
   if (xacc::hasContributedService<xacc::Instruction>(commandDef)) {
-    auto pulseInst = xacc::getContributedService<xacc::Instruction>(commandDef);
+    auto pulseInst = lowerCmdDef(commandDef, {});
     pulseComposite->addInstruction(pulseInst);
   }
 }
@@ -59,12 +81,12 @@ void PulseMappingVisitor::visit(Rz &rz) {
   const auto commandDef = constructPulseCommandDef(rz);
 
   if (xacc::hasContributedService<xacc::Instruction>(commandDef)) {
-    auto pulseInst = xacc::getContributedService<xacc::Instruction>(commandDef);
+    auto pulseInst = lowerCmdDef(commandDef, {});
     pulseComposite->addInstruction(pulseInst);
   } else {
     // Rz(theta) = U1(theta) = U3(0, 0, theta)
-    const auto asU1 = constructUCmdDefComposite(rz.bits()[0], "u1");
-    auto rzCmdDef = (*asU1)({rz.getParameter(0).as<double>()});
+    auto rzCmdDef = lowerCmdDef(uCmdDefName(rz.bits()[0], "u1"),
+                                {rz.getParameter(0).as<double>()});
     pulseComposite->addInstruction(rzCmdDef);
   }
 }
@@ -73,12 +95,12 @@ void PulseMappingVisitor::visit(Ry &ry) {
   const auto commandDef = constructPulseCommandDef(ry);
 
   if (xacc::hasContributedService<xacc::Instruction>(commandDef)) {
-    auto pulseInst = xacc::getContributedService<xacc::Instruction>(commandDef);
+    auto pulseInst = lowerCmdDef(commandDef, {});
     pulseComposite->addInstruction(pulseInst);
   } else {
     // Ry(theta) = U3(theta, 0, 0)
-    const auto asU3 = constructUCmdDefComposite(ry.bits()[0], "u3");
-    auto ryCmdDef = (*asU3)({ry.getParameter(0).as<double>(), 0.0, 0.0});
+    auto ryCmdDef = lowerCmdDef(uCmdDefName(ry.bits()[0], "u3"),
+                                {ry.getParameter(0).as<double>(), 0.0, 0.0});
     pulseComposite->addInstruction(ryCmdDef);
   }
 }
@@ -87,14 +109,13 @@ void PulseMappingVisitor::visit(Rx &rx) {
   const auto commandDef = constructPulseCommandDef(rx);
 
   if (xacc::hasContributedService<xacc::Instruction>(commandDef)) {
-    auto pulseInst = xacc::getContributedService<xacc::Instruction>(commandDef);
+    auto pulseInst = lowerCmdDef(commandDef, {});
     pulseComposite->addInstruction(pulseInst);
   } else {
     // Rx(theta) = U3(theta, -pi/2, pi/2)
-    const auto asU3 = constructUCmdDefComposite(rx.bits()[0], "u3");
-    auto rxCmdDef =
-        (*asU3)({rx.getParameter(0).as<double>(), -M_PI/ 2.0,
-                 M_PI/ 2.0});
+    auto rxCmdDef = lowerCmdDef(
+        uCmdDefName(rx.bits()[0], "u3"),
+        {rx.getParameter(0).as<double>(), -M_PI / 2.0, M_PI / 2.0});
     pulseComposite->addInstruction(rxCmdDef);
   }
 }
@@ -103,12 +124,12 @@ void PulseMappingVisitor::visit(X &x) {
   const auto commandDef = constructPulseCommandDef(x);
 
   if (xacc::hasContributedService<xacc::Instruction>(commandDef)) {
-    auto pulseInst = xacc::getContributedService<xacc::Instruction>(commandDef);
+    auto pulseInst = lowerCmdDef(commandDef, {});
     pulseComposite->addInstruction(pulseInst);
   } else {
     // X = U3(pi, 0, pi)
-    const auto asU3 = constructUCmdDefComposite(x.bits()[0], "u3");
-    auto xCmdDef = (*asU3)({M_PI, 0.0, M_PI});
+    auto xCmdDef =
+        lowerCmdDef(uCmdDefName(x.bits()[0], "u3"), {M_PI, 0.0, M_PI});
     pulseComposite->addInstruction(xCmdDef);
   }
 }
@@ -117,13 +138,12 @@ void PulseMappingVisitor::visit(Y &y) {
   const auto commandDef = constructPulseCommandDef(y);
 
   if (xacc::hasContributedService<xacc::Instruction>(commandDef)) {
-    auto pulseInst = xacc::getContributedService<xacc::Instruction>(commandDef);
+    auto pulseInst = lowerCmdDef(commandDef, {});
     pulseComposite->addInstruction(pulseInst);
   } else {
     // Y = U3(pi, pi/2, pi/2)
-    const auto asU3 = constructUCmdDefComposite(y.bits()[0], "u3");
-    auto yCmdDef = (*asU3)({M_PI, M_PI/ 2.0,
-                            M_PI/ 2.0});
+    auto yCmdDef = lowerCmdDef(uCmdDefName(y.bits()[0], "u3"),
+                               {M_PI, M_PI / 2.0, M_PI / 2.0});
     pulseComposite->addInstruction(yCmdDef);
   }
 }
@@ -132,12 +152,11 @@ void PulseMappingVisitor::visit(Z &z) {
   const auto commandDef = constructPulseCommandDef(z);
 
   if (xacc::hasContributedService<xacc::Instruction>(commandDef)) {
-    auto pulseInst = xacc::getContributedService<xacc::Instruction>(commandDef);
+    auto pulseInst = lowerCmdDef(commandDef, {});
     pulseComposite->addInstruction(pulseInst);
   } else {
     // Z = U1(pi) = U3(0, 0, pi)
-    const auto asU1 = constructUCmdDefComposite(z.bits()[0], "u1");
-    auto zCmdDef = (*asU1)({M_PI});
+    auto zCmdDef = lowerCmdDef(uCmdDefName(z.bits()[0], "u1"), {M_PI});
     pulseComposite->addInstruction(zCmdDef);
   }
 }
@@ -177,8 +196,7 @@ void PulseMappingVisitor::visit(CRZ &crz) {
   // CX(a,b);
   const double theta = crz.getParameter(0).as<double>();
   {
-    const auto asU1 = constructUCmdDefComposite(crz.bits()[1], "u1");
-    auto cmdDef = (*asU1)({theta / 2.0});
+    auto cmdDef = lowerCmdDef(uCmdDefName(crz.bits()[1], "u1"), {theta / 2.0});
     pulseComposite->addInstruction(cmdDef);
   }
   {
@@ -186,8 +204,7 @@ void PulseMappingVisitor::visit(CRZ &crz) {
     visit(*cx);
   }
   {
-    const auto asU1 = constructUCmdDefComposite(crz.bits()[1], "u1");
-    auto cmdDef = (*asU1)({-theta / 2.0});
+    auto cmdDef = lowerCmdDef(uCmdDefName(crz.bits()[1], "u1"), {-theta / 2.0});
     pulseComposite->addInstruction(cmdDef);
   }
   {
@@ -232,12 +249,11 @@ void PulseMappingVisitor::visit(S &s) {
   const auto commandDef = constructPulseCommandDef(s);
 
   if (xacc::hasContributedService<xacc::Instruction>(commandDef)) {
-    auto pulseInst = xacc::getContributedService<xacc::Instruction>(commandDef);
+    auto pulseInst = lowerCmdDef(commandDef, {});
     pulseComposite->addInstruction(pulseInst);
   } else {
     // S = U1(pi/2) = U3(0,0,pi/2)
-    const auto asU1 = constructUCmdDefComposite(s.bits()[0], "u1");
-    auto sCmdDef = (*asU1)({M_PI/ 2.0});
+    auto sCmdDef = lowerCmdDef(uCmdDefName(s.bits()[0], "u1"), {M_PI / 2.0});
     pulseComposite->addInstruction(sCmdDef);
   }
 }
@@ -246,12 +262,12 @@ void PulseMappingVisitor::visit(Sdg &sdg) {
   const auto commandDef = constructPulseCommandDef(sdg);
 
   if (xacc::hasContributedService<xacc::Instruction>(commandDef)) {
-    auto pulseInst = xacc::getContributedService<xacc::Instruction>(commandDef);
+    auto pulseInst = lowerCmdDef(commandDef, {});
     pulseComposite->addInstruction(pulseInst);
   } else {
     // S-dagger = U1(-pi/2) = U3(0,0,-pi/2)
-    const auto asU1 = constructUCmdDefComposite(sdg.bits()[0], "u1");
-    auto sdgCmdDef = (*asU1)({-M_PI/ 2.0});
+    auto sdgCmdDef =
+        lowerCmdDef(uCmdDefName(sdg.bits()[0], "u1"), {-M_PI / 2.0});
     pulseComposite->addInstruction(sdgCmdDef);
   }
 }
@@ -260,12 +276,11 @@ void PulseMappingVisitor::visit(T &t) {
   const auto commandDef = constructPulseCommandDef(t);
 
   if (xacc::hasContributedService<xacc::Instruction>(commandDef)) {
-    auto pulseInst = xacc::getContributedService<xacc::Instruction>(commandDef);
+    auto pulseInst = lowerCmdDef(commandDef, {});
     pulseComposite->addInstruction(pulseInst);
   } else {
     // T = U1(pi/4) = U3(0,0,pi/4)
-    const auto asU1 = constructUCmdDefComposite(t.bits()[0], "u1");
-    auto tCmdDef = (*asU1)({M_PI/ 4.0});
+    auto tCmdDef = lowerCmdDef(uCmdDefName(t.bits()[0], "u1"), {M_PI / 4.0});
     pulseComposite->addInstruction(tCmdDef);
   }
 }
@@ -274,12 +289,12 @@ void PulseMappingVisitor::visit(Tdg &tdg) {
   const auto commandDef = constructPulseCommandDef(tdg);
 
   if (xacc::hasContributedService<xacc::Instruction>(commandDef)) {
-    auto pulseInst = xacc::getContributedService<xacc::Instruction>(commandDef);
+    auto pulseInst = lowerCmdDef(commandDef, {});
     pulseComposite->addInstruction(pulseInst);
   } else {
     // T-dagger = U1(-pi/4) = U3(0,0,-pi/4)
-    const auto asU1 = constructUCmdDefComposite(tdg.bits()[0], "u1");
-    auto tdgCmdDef = (*asU1)({-M_PI/ 4.0});
+    auto tdgCmdDef =
+        lowerCmdDef(uCmdDefName(tdg.bits()[0], "u1"), {-M_PI / 4.0});
     pulseComposite->addInstruction(tdgCmdDef);
   }
 }
@@ -295,8 +310,8 @@ void PulseMappingVisitor::visit(CPhase &cphase) {
   // }
   const double lambda = cphase.getParameter(0).as<double>();
   {
-    const auto asU1 = constructUCmdDefComposite(cphase.bits()[0], "u1");
-    auto cmdDef = (*asU1)({lambda / 2.0});
+    auto cmdDef =
+        lowerCmdDef(uCmdDefName(cphase.bits()[0], "u1"), {lambda / 2.0});
     pulseComposite->addInstruction(cmdDef);
   }
   {
@@ -304,8 +319,8 @@ void PulseMappingVisitor::visit(CPhase &cphase) {
     visit(*cx);
   }
   {
-    const auto asU1 = constructUCmdDefComposite(cphase.bits()[1], "u1");
-    auto cmdDef = (*asU1)({-lambda / 2.0});
+    auto cmdDef =
+        lowerCmdDef(uCmdDefName(cphase.bits()[1], "u1"), {-lambda / 2.0});
     pulseComposite->addInstruction(cmdDef);
   }
   {
@@ -313,8 +328,8 @@ void PulseMappingVisitor::visit(CPhase &cphase) {
     visit(*cx);
   }
   {
-    const auto asU1 = constructUCmdDefComposite(cphase.bits()[1], "u1");
-    auto cmdDef = (*asU1)({lambda / 2.0});
+    auto cmdDef =
+        lowerCmdDef(uCmdDefName(cphase.bits()[1], "u1"), {lambda / 2.0});
     pulseComposite->addInstruction(cmdDef);
   }
 }
@@ -324,21 +339,20 @@ void PulseMappingVisitor::visit(Identity &i) {
 }
 
 void PulseMappingVisitor::visit(U &u) {
-  const auto asU3 = constructUCmdDefComposite(u.bits()[0], "u3");
   // Just pass the params to the cmddef.
   std::vector<double> params;
   for (const auto &param : u.getParameters()) {
     params.emplace_back(param.as<double>());
   }
 
-  auto uCmdDef = (*asU3)(params);
+  auto uCmdDef = lowerCmdDef(uCmdDefName(u.bits()[0], "u3"), params);
   pulseComposite->addInstruction(uCmdDef);
 }
 
 void PulseMappingVisitor::visit(Measure &measure) {
   const auto commandDef = constructPulseCommandDef(measure);
   if (xacc::hasContributedService<xacc::Instruction>(commandDef)) {
-    auto pulseInst = xacc::getContributedService<xacc::Instruction>(commandDef);
+    auto pulseInst = lowerCmdDef(commandDef, {});
     pulseComposite->addInstruction(pulseInst);
   }
 }
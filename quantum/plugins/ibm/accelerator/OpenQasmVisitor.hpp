@@ -15,6 +15,7 @@
 
 #include <memory>
 #include "AllGateVisitor.hpp"
+#include "Emitter.hpp"
 #include "xacc.hpp"
 
 namespace xacc {
@@ -76,19 +77,16 @@ public:
 	 * Visit hadamard gates
 	 */
 	void visit(Hadamard& h) {
-		std::stringstream ss, js;
+		Emitter ss(native), js(operationsJsonStr);
 		ss << "u2(" << 0 << ", " << pi << ") q[" << h.bits()[0] << "];\n";
-		native += ss.str();
 
         js << "{\"name\":\"u2\",\"params\": [0.0," << pi << "],\"qubits\":[" << h.bits()[0]<<"]},";
-        operationsJsonStr += js.str();
 	}
 
 	void visit(Identity& i) {
-        std::stringstream js;
+        Emitter js(operationsJsonStr);
 		native += "id q[" + std::to_string(i.bits()[0]) + "];\n";
         js << "{\"name\":\"id\",\"params\": [],\"qubits\":[" << i.bits()[0]<<"]},";
-        operationsJsonStr += js.str();
 	}
 
 	void visit(CZ& cz) {
@@ -99,56 +97,46 @@ public:
 	 * Visit CNOT gates
 	 */
 	void visit(CNOT& cn) {
-		std::stringstream ss, js;
+		Emitter ss(native), js(operationsJsonStr);
 		ss << "cx q[" << cn.bits()[0] << "], q[" << cn.bits()[1] << "];\n";
-		native += ss.str();
 
         js << "{\"name\":\"cx\",\"params\": [],\"qubits\":[" << cn.bits()[0]<< ", " << cn.bits()[1] << "]},";
-        operationsJsonStr += js.str();
 	}
 
 	/**
 	 * Visit X gates
 	 */
 	void visit(X& x) {
-		std::stringstream ss, js;
+		Emitter ss(native), js(operationsJsonStr);
 		ss << "u3(" << pi << ", " << 0 << ", " << pi << ") q[" << x.bits()[0] << "];\n";
-		native += ss.str();
         js << "{\"name\":\"u3\",\"params\": [" << pi << ", " << 0 << ", " << pi << "],\"qubits\":[" << x.bits()[0]<< "]},";
-        operationsJsonStr += js.str();
 	}
 
 	/**
 	 *
 	 */
 	void visit(Y& y) {
-		std::stringstream ss, js;
+		Emitter ss(native), js(operationsJsonStr);
 		ss << "u3(" << pi << ", " << pi/2.0 << ", " << pi << ") q[" << y.bits()[0] << "];\n";
-		native += ss.str();
         js << "{\"name\":\"u3\",\"params\": [" << pi << ", " << pi/2.0 << ", " << pi << "],\"qubits\":[" << y.bits()[0]<< "]},";
-        operationsJsonStr += js.str();
 	}
 
 	/**
 	 * Visit Z gates
 	 */
 	void visit(Z& z) {
-		std::stringstream ss, js;
+		Emitter ss(native), js(operationsJsonStr);
 		ss << "u1(" << pi << ") q[" << z.bits()[0] << "];\n";
-		native += ss.str();
         js << "{\"name\":\"u1\",\"params\": [" << pi << "],\"qubits\":[" << z.bits()[0]<< "]},";
-        operationsJsonStr += js.str();
 	}
 
     void visit(U &u) {
-        std::stringstream ss, js;
+        Emitter ss(native), js(operationsJsonStr);
 		auto thetaStr = u.getParameter(0).toString();
         auto phiStr = u.getParameter(1).toString();
 		auto lambdaStr = u.getParameter(2).toString();
 		ss << "U(" << thetaStr << ", " << phiStr << ", " << lambdaStr << ") q[" << u.bits()[0] << "];\n";
-		native += ss.str();
         js << "{\"name\":\"U\",\"params\": [" << thetaStr << ", " << phiStr << ", " << lambdaStr << "],\"qubits\":[" << u.bits()[0]<< "]},";
-        operationsJsonStr += js.str();
     }
 	int classicalBitCounter = 0;
 	/**
@@ -157,41 +145,33 @@ public:
 	void visit(Measure& m) {
         std::string clbitname = "clbits";
         if (isIBMAcc) clbitname = "memory";
-		std::stringstream ss, js;
+		Emitter ss(native), js(operationsJsonStr);
 		ss << "creg c" << classicalBitCounter << "[1];\n";
 		ss << "measure q[" << m.bits()[0] << "] -> c" << classicalBitCounter << "[0];\n";
-		native += ss.str();
 		qubitToClassicalBitIndex.insert(std::make_pair(m.bits()[0], classicalBitCounter));
         js << "{\""+clbitname+"\":[" << classicalBitCounter << "],\"name\":\"measure\",\"qubits\":[" << m.bits()[0]<< "]},";
-        operationsJsonStr += js.str();
 		classicalBitCounter++;
 	}
 
 	void visit(Rx& rx) {
-		std::stringstream ss, js;
+		Emitter ss(native), js(operationsJsonStr);
 		auto angleStr = rx.getParameter(0).toString();
 		ss << "u3(" << angleStr << ", " << (-pi/2.0) << ", " << (pi/2.0) << ") q[" << rx.bits()[0] << "];\n";
-		native += ss.str();
         js << "{\"name\":\"u3\",\"params\": [" << angleStr << ", " << (-pi/2.0) << ", " << pi/2.0 << "],\"qubits\":[" << rx.bits()[0]<< "]},";
-        operationsJsonStr += js.str();
 	}
 
 	void visit(Ry& ry) {
-		std::stringstream ss, js;
+		Emitter ss(native), js(operationsJsonStr);
 		auto angleStr = ry.getParameter(0).toString();
 		ss << "u3(" << angleStr << ", 0, 0) q[" << ry.bits()[0] << "];\n";
-		native += ss.str();
         js << "{\"name\":\"u3\",\"params\": [" << angleStr << ", " << 0 << ", " << 0 << "],\"qubits\":[" << ry.bits()[0]<< "]},";
-        operationsJsonStr += js.str();
 	}
 
 	void visit(Rz& rz) {
-		std::stringstream ss, js;
+		Emitter ss(native), js(operationsJsonStr);
 		auto angleStr = rz.getParameter(0).toString();
 		ss << "u1(" << angleStr << ") q[" << rz.bits()[0] << "];\n";
-		native += ss.str();
         js << "{\"name\":\"u1\",\"params\": [" << angleStr << "],\"qubits\":[" << rz.bits()[0]<< "]},";
-        operationsJsonStr += js.str();
 	}
 
 	void visit(CPhase& cp) {
@@ -440,7 +440,7 @@ public:
     // All the instructions that are scoped inside this block must have a
     // `condition` field points to this register Id.
     conditionalRegId = regId;
-    for (auto &i : ifStmt.getInstructions()) {
+    for (auto &i : ifStmt.getInstructionsView()) {
       i->accept(this);
     }
     conditionalRegId.reset();
@@ -0,0 +1,260 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#ifndef QUANTUM_GATE_ACCELERATORS_IBMACCELERATOR_QOBJECTWRITER_HPP_
+#define QUANTUM_GATE_ACCELERATORS_IBMACCELERATOR_QOBJECTWRITER_HPP_
+
+#include "QObject.hpp"
+#include <cmath>
+#include <cstdio>
+
+namespace xacc {
+namespace ibm {
+// Writes a QASM QObject as JSON text, one experiment at a time, straight
+// into a string. Unlike to_json, no nlohmann::json document of the whole
+// QObject is built, so each experiment can be dropped once written. The
+// text parses to the same document as to_json (keys are not sorted).
+//
+//   QObjectWriter writer(str);
+//   writer.begin("xacc-qobj-id", "QASM", "1.1.0");
+//   for (...) writer.addExperiment(experiment);
+//   writer.end(config, header);
+//
+// beginRoot() / endRoot() around these wrap it in a QObjectRoot.
+class QObjectWriter {
+public:
+  QObjectWriter(std::string &out_json) : m_out(out_json) {}
+
+  void beginRoot() { m_out += "{\"qObject\":"; }
+  void endRoot(const Backend &in_backend, int64_t in_shots) {
+    m_out += ",\"backend\":{\"name\":";
+    writeString(in_backend.get_name());
+    m_out += "},\"shots\":";
+    writeInt(in_shots);
+    m_out += '}';
+  }
+
+  void begin(const std::string &in_qobjId, const std::string &in_type,
+             const std::string &in_schemaVersion) {
+    m_out += "{\"qobj_id\":";
+    writeString(in_qobjId);
+    m_out += ",\"type\":";
+    writeString(in_type);
+    m_out += ",\"schema_version\":";
+    writeString(in_schemaVersion);
+    m_out += ",\"experiments\":[";
+    m_nbExperiments = 0;
+  }
+
+  void addExperiment(const Experiment &in_experiment) {
+    if (m_nbExperiments++ > 0) {
+      m_out += ',';
+    }
+    const auto &config = in_experiment.get_config();
+    m_out += "{\"config\":{\"n_qubits\":";
+    writeInt(config.get_n_qubits());
+    m_out += ",\"memory_slots\":";
+    writeInt(config.get_memory_slots());
+
+    const auto &header = in_experiment.get_header();
+    m_out += "},\"header\":{\"name\":";
+    writeString(header.get_name());
+    m_out += ",\"qreg_sizes\":";
+    writeLabels(header.get_qreg_sizes());
+    m_out += ",\"n_qubits\":";
+    writeInt(header.get_n_qubits());
+    m_out += ",\"qubit_labels\":";
+    writeLabels(header.get_qubit_labels());
+    m_out += ",\"memory_slots\":";
+    writeInt(header.get_memory_slots());
+    m_out += ",\"creg_sizes\":";
+    writeLabels(header.get_creg_sizes());
+    m_out += ",\"clbit_labels\":";
+    writeLabels(header.get_clbit_labels());
+
+    m_out += "},\"instructions\":[";
+    bool first = true;
+    for (const auto &inst : in_experiment.get_instructions()) {
+      if (!first) {
+        m_out += ',';
+      }
+      first = false;
+      writeInstruction(inst);
+    }
+    m_out += "]}";
+  }
+
+  // The config is small: it goes through to_json (or is given as JSON,
+  // e.g. with simulator specific fields).
+  void end(const QObjectConfig &in_config, const QObjectHeader &in_header) {
+    nlohmann::json config;
+    nlohmann::to_json(config, in_config);
+    end(config, in_header);
+  }
+  void end(const nlohmann::json &in_config, const QObjectHeader &in_header) {
+    m_out += "],\"config\":";
+    m_out += in_config.dump();
+    m_out += ",\"header\":{\"backend_version\":";
+    writeString(in_header.get_backend_version());
+    m_out += ",\"backend_name\":";
+    writeString(in_header.get_backend_name());
+    m_out += "}}";
+  }
+
+private:
+  // Same fields as to_json(json &, const Instruction &)
+  void writeInstruction(const Instruction &in_inst) {
+    if (in_inst.isBfuc()) {
+      const auto bfunc = in_inst.get_bFunc().value();
+      m_out += "{\"name\":\"bfunc\",\"register\":";
+      writeInt(bfunc.registerId);
+      m_out += ",\"mask\":";
+      writeString(bfunc.hex_mask);
+      m_out += ",\"relation\":";
+      writeString(bfunc.relation);
+      m_out += ",\"val\":";
+      writeString(bfunc.hex_val);
+      m_out += '}';
+      return;
+    }
+
+    m_out += "{\"qubits\":";
+    writeArray(in_inst.get_qubits());
+    m_out += ",\"name\":";
+    writeString(in_inst.get_name());
+    const auto params = in_inst.get_params();
+    if (!params.empty()) {
+      m_out += ",\"params\":";
+      writeArray(params);
+    }
+    const auto memory = in_inst.get_memory();
+    if (!memory.empty()) {
+      m_out += ",\"memory\":";
+      writeArray(memory);
+      if (memory.size() == 1) {
+        const auto measRegisterId =
+            RegisterAllocator::getInstance()->getRegisterId(memory[0]);
+        if (measRegisterId.has_value()) {
+          m_out += ",\"register\":[";
+          writeInt(measRegisterId.value());
+          m_out += ']';
+        }
+      }
+    }
+    const auto conditional = in_inst.get_condition_reg_id();
+    if (conditional.has_value()) {
+      m_out += ",\"conditional\":";
+      writeInt(conditional.value());
+    }
+    m_out += '}';
+  }
+
+  template <typename Label>
+  void writeLabels(const std::vector<std::vector<Label>> &in_labels) {
+    m_out += '[';
+    for (size_t i = 0; i < in_labels.size(); ++i) {
+      m_out += i > 0 ? ",[" : "[";
+      for (size_t k = 0; k < in_labels[i].size(); ++k) {
+        if (k > 0) {
+          m_out += ',';
+        }
+        const auto &label = in_labels[i][k];
+        if (mpark::holds_alternative<std::string>(label)) {
+          writeString(mpark::get<std::string>(label));
+        } else {
+          writeInt(mpark::get<int64_t>(label));
+        }
+      }
+      m_out += ']';
+    }
+    m_out += ']';
+  }
+
+  template <typename T> void writeArray(const std::vector<T> &in_values) {
+    m_out += '[';
+    for (size_t i = 0; i < in_values.size(); ++i) {
+      if (i > 0) {
+        m_out += ',';
+      }
+      writeNumber(in_values[i]);
+    }
+    m_out += ']';
+  }
+
+  void writeNumber(int64_t in_value) { writeInt(in_value); }
+  void writeNumber(double in_value) {
+    // Written as null, like nlohmann::json does
+    if (!std::isfinite(in_value)) {
+      m_out += "null";
+      return;
+    }
+    // 17 significant digits round-trip exactly
+    char buffer[32];
+    const int length = std::snprintf(buffer, sizeof(buffer), "%.17g", in_value);
+    bool isIntegral = true;
+    for (int i = 0; i < length; ++i) {
+      // Locales with a decimal comma
+      if (buffer[i] == ',') {
+        buffer[i] = '.';
+      }
+      if (buffer[i] == '.' || buffer[i] == 'e') {
+        isIntegral = false;
+      }
+    }
+    m_out.append(buffer, length);
+    // Keep it a floating point number when parsed back
+    if (isIntegral) {
+      m_out += ".0";
+    }
+  }
+
+  void writeInt(int64_t in_value) { m_out += std::to_string(in_value); }
+
+  void writeString(const std::string &in_str) {
+    m_out += '"';
+    for (const char c : in_str) {
+      switch (c) {
+      case '"':
+        m_out += "\\\"";
+        break;
+      case '\\':
+        m_out += "\\\\";
+        break;
+      case '\n':
+        m_out += "\\n";
+        break;
+      case '\r':
+        m_out += "\\r";
+        break;
+      case '\t':
+        m_out += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buffer[8];
+          std::snprintf(buffer, sizeof(buffer), "\\u%04x",
+                        static_cast<unsigned char>(c));
+          m_out += buffer;
+        } else {
+          m_out += c;
+        }
+      }
+    }
+    m_out += '"';
+  }
+
+  std::string &m_out;
+  int m_nbExperiments = 0;
+};
+} // namespace ibm
+} // namespace xacc
+#endif
@@ -11,6 +11,7 @@
  *   Alexander J. McCaskey - initial API and implementation
  *******************************************************************************/
 #include "QObject.hpp"
+#include "QObjectWriter.hpp"
 #include <gtest/gtest.h>
 
 using namespace xacc::ibm;
@@ -216,6 +217,79 @@ TEST(IBMAcceleratorTester, checkFromJson) {
 
 }
 
+TEST(IBMAcceleratorTester, checkWriter) {
+  RegisterAllocator::getInstance()->reset();
+  Experiment experiment;
+  ExperimentConfig expConfig;
+  expConfig.set_n_qubits(2);
+  expConfig.set_memory_slots(1);
+  experiment.set_config(expConfig);
+  ExperimentHeader header;
+  header.set_name("exp \"0\"");
+  header.set_qreg_sizes({{QregSizeElement("q"), QregSizeElement(2)}});
+  header.set_n_qubits(2);
+  header.set_qubit_labels({{"q", 0}, {"q", 1}});
+  header.set_memory_slots(1);
+  header.set_clbit_labels({{"c0", 0}});
+  header.set_creg_sizes({{"c0", 1}});
+  experiment.set_header(header);
+
+  std::vector<Instruction> instructions(4);
+  instructions[0].set_name("u3");
+  instructions[0].set_qubits({0});
+  instructions[0].set_params({3.141592653589793, 0.0, -0.1});
+  instructions[1].set_name("measure");
+  instructions[1].set_qubits({0});
+  instructions[1].set_memory({0});
+  instructions[2] = Instruction::createConditionalInst(0);
+  instructions[3].set_name("cx");
+  instructions[3].set_qubits({0, 1});
+  instructions[3].set_condition_reg_id(1);
+  experiment.set_instructions(instructions);
+
+  QObjectConfig config;
+  config.set_shots(1024);
+  config.set_n_qubits(2);
+  config.set_memory_slots(1);
+  config.set_memory(false);
+  config.set_meas_return("avg");
+  config.set_meas_level(2);
+  config.set_memory_slot_size(100);
+  QObjectHeader qobjHeader;
+  qobjHeader.set_backend_name("ibmq_qasm_simulator");
+  qobjHeader.set_backend_version("1.0.0");
+  Backend backend;
+  backend.set_name("ibmq_qasm_simulator");
+
+  QObject qobj;
+  qobj.set_qobj_id("xacc-qobj-id");
+  qobj.set_type("QASM");
+  qobj.set_schema_version("1.1.0");
+  qobj.set_experiments({experiment, experiment});
+  qobj.set_config(config);
+  qobj.set_header(qobjHeader);
+  QObjectRoot root;
+  root.set_q_object(qobj);
+  root.set_backend(backend);
+  root.set_shots(1024);
+  nlohmann::json expected;
+  to_json(expected, root);
+
+  std::string str;
+  QObjectWriter writer(str);
+  writer.beginRoot();
+  writer.begin("xacc-qobj-id", "QASM", "1.1.0");
+  writer.addExperiment(experiment);
+  writer.addExperiment(experiment);
+  writer.end(config, qobjHeader);
+  writer.endRoot(backend, 1024);
+  EXPECT_EQ(nlohmann::json::parse(str), expected);
+  // Doubles stay doubles
+  auto params = nlohmann::json::parse(str)["qObject"]["experiments"][0]
+                                          ["instructions"][0]["params"];
+  EXPECT_TRUE(params[1].is_number_float());
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -12,6 +12,8 @@
  *******************************************************************************/
 #include "aer_accelerator.hpp"
 #include "aer_noise_model.hpp"
+#include "aer_ops_visitor.hpp"
+#include "aer_pulse_simulator.hpp"
 #include "CommonGates.hpp"
 #include "CountGatesOfTypeVisitor.hpp"
 #include "InstructionIterator.hpp"
@@ -29,7 +31,12 @@
 #include "xacc_service.hpp"
 
 #include <bitset>
+#include <cmath>
+#include <random>
+#include <set>
 #include "QObjGenerator.hpp"
+#include "QObjectExperimentVisitor.hpp"
+#include "QObjectWriter.hpp"
 #include "py-aer/aer_python_adapter.hpp"
 
 namespace xacc {
@@ -46,6 +53,25 @@ std::string integral_to_binary_string(T byte, IS_INTEGRAL(T)) {
 std::string hex_string_to_binary_string(std::string hex) {
   return integral_to_binary_string((int)strtol(hex.c_str(), NULL, 0));
 }
+// Convert an Aer memory hex string to an nBits bit string (msb).
+std::string memory_hex_to_bit_string(const std::string &hex, int nBits) {
+  const auto value = std::stoull(hex, nullptr, 16);
+  std::string bitStr(nBits, '0');
+  for (int i = 0; i < nBits; ++i) {
+    if ((value >> i) & 1ULL) {
+      bitStr[nBits - 1 - i] = '1';
+    }
+  }
+  return bitStr;
+}
+// Append the (hex) counts of an Aer qasm experiment to the buffer.
+void append_counts(std::shared_ptr<AcceleratorBuffer> buffer,
+                   const std::map<std::string, int> &counts, int nMeasures) {
+  for (const auto &[hexStr, nOccurrences] : counts) {
+    buffer->appendMeasurement(memory_hex_to_bit_string(hexStr, nMeasures),
+                              nOccurrences);
+  }
+}
 
 HeterogeneousMap AerAccelerator::getProperties() {
   return physical_backend_properties;
@@ -55,16 +81,32 @@ void AerAccelerator::initialize(const HeterogeneousMap &params) {
 
   m_options = params;
   noise_model.clear();
+  nativeNoiseModel.reset();
+  noiseModelObj.reset();
+  applySession.reset();
   m_simtype = "qasm";
+  controller_config = nlohmann::json::object();
   connectivity.clear();
 
   xacc_to_qobj = xacc::getCompiler("qobj");
   if (params.keyExists<int>("shots")) {
     m_shots = params.get<int>("shots");
   }
+  // Controller parallelization options
+  for (const std::string &key :
+       {"max-parallel-threads", "max-parallel-experiments",
+        "max-parallel-shots"}) {
+    if (params.keyExists<int>(key)) {
+      auto aerKey = key;
+      std::replace(aerKey.begin(), aerKey.end(), '-', '_');
+      controller_config[aerKey] = params.get<int>(key);
+    }
+  }
   if (params.stringExists("sim-type")) {
     if (!xacc::container::contains(
-            std::vector<std::string>{"qasm", "statevector", "pulse", "density_matrix"},
+            std::vector<std::string>{"qasm", "statevector", "pulse",
+                                     "density_matrix", "matrix_product_state",
+                                     "stabilizer", "extended_stabilizer"},
             params.getString("sim-type"))) {
       xacc::warning("[Aer] warning, invalid sim-type (" +
                     params.getString("sim-type") +
@@ -73,6 +115,78 @@ void AerAccelerator::initialize(const HeterogeneousMap &params) {
       m_simtype = params.getString("sim-type");
     }
   }
+  if (m_simtype == "matrix_product_state" || m_simtype == "stabilizer" ||
+      m_simtype == "extended_stabilizer") {
+    // Select the QasmController simulation method
+    controller_config["method"] = m_simtype;
+  }
+  // Floating-point precision of the simulated state: single precision halves
+  // the memory of the state vector (and density matrix). The amplitudes are
+  // exported as doubles regardless.
+  if (params.stringExists("precision")) {
+    const auto precision = params.getString("precision");
+    if (precision != "single" && precision != "double") {
+      xacc::warning("[Aer] warning, invalid precision (" + precision +
+                    "), must be single or double.");
+    } else {
+      controller_config["precision"] = precision;
+    }
+  }
+  // MPS: max bond dimension (0: no limit) and the truncation threshold,
+  // i.e. the max. total weight of the discarded Schmidt coefficients.
+  if (params.keyExists<int>("mps-max-bond-dimension")) {
+    controller_config["matrix_product_state_max_bond_dimension"] =
+        params.get<int>("mps-max-bond-dimension");
+  }
+  if (params.keyExists<double>("mps-truncation-threshold")) {
+    controller_config["matrix_product_state_truncation_threshold"] =
+        params.get<double>("mps-truncation-threshold");
+  }
+
+  m_pulseSolver = "native";
+  if (params.stringExists("pulse-solver")) {
+    m_pulseSolver = params.getString("pulse-solver");
+    if (m_pulseSolver != "native" && m_pulseSolver != "python") {
+      xacc::error("[Aer] invalid pulse-solver (" + m_pulseSolver +
+                  "), must be native or python.");
+    }
+  }
+  m_pulseRtol = params.get_or_default("pulse-rtol", 1e-6);
+  m_pulseAtol = params.get_or_default("pulse-atol", 1e-8);
+
+  m_device = "CPU";
+  if (params.stringExists("device")) {
+    auto device = params.getString("device");
+    std::transform(device.begin(), device.end(), device.begin(), ::toupper);
+    if (device != "CPU" && device != "GPU") {
+      xacc::warning("[Aer] warning, invalid device (" +
+                    params.getString("device") + "), must be CPU or GPU.");
+    } else {
+      m_device = device;
+    }
+  }
+  if (m_device == "GPU") {
+#ifndef AER_THRUST_CUDA
+    xacc::error("[Aer] GPU device requested, but the aer plugin was not "
+                "built with GPU support (XACC_AER_GPU).");
+#endif
+    if (m_simtype != "qasm" && m_simtype != "statevector" &&
+        m_simtype != "density_matrix") {
+      xacc::warning("[Aer] " + m_simtype +
+                    " simulation doesn't support GPU, using CPU.");
+    } else {
+      // Thrust/CUDA simulation methods
+      controller_config["method"] = m_simtype == "density_matrix"
+                                        ? "density_matrix_gpu"
+                                        : "statevector_gpu";
+    }
+  }
+  if (params.keyExists<bool>("blocking_enable") ||
+      params.keyExists<int>("blocking_qubits")) {
+    // Chunked (multi-GPU) simulation is not available in the bundled Aer.
+    xacc::warning("[Aer] blocking_enable/blocking_qubits are not supported by "
+                  "this Aer version and will be ignored.");
+  }
 
   if (params.stringExists("backend")) {
     auto ibm_noise_model = xacc::getService<NoiseModel>("IBM");
@@ -119,6 +233,18 @@ void AerAccelerator::initialize(const HeterogeneousMap &params) {
   }
   initialized = true;
 }
+double AerAccelerator::stateBytes(std::size_t nbQubits) const {
+  if (m_simtype == "qasm" || m_simtype == "statevector" ||
+      m_simtype == "pulse") {
+    return std::ldexp(sizeof(std::complex<double>), nbQubits);
+  }
+  if (m_simtype == "density_matrix") {
+    return std::ldexp(sizeof(std::complex<double>), 2 * nbQubits);
+  }
+  // Depends on the circuit (bond dimensions, stabilizer rank...)
+  return -1.0;
+}
+
 double AerAccelerator::calcExpectationValueZ(
     const std::vector<std::pair<double, double>> &in_stateVec,
     const std::vector<std::size_t> &in_bits) {
@@ -169,16 +295,253 @@ double AerAccelerator::calcExpectationValueZFromDensityMatrix(
   return result;
 }
 
+bool AerAccelerator::executeNative(
+    const std::vector<std::shared_ptr<AcceleratorBuffer>> &buffers,
+    const std::vector<std::shared_ptr<CompositeInstruction>> &programs) {
+  const bool isStateVec = m_simtype == "statevector";
+  std::vector<AER::Circuit> circuits;
+  std::vector<int> nMeasures;
+  std::vector<std::vector<std::size_t>> measuredBits;
+  circuits.reserve(programs.size());
+  for (auto &program : programs) {
+    // The stabilizer engines need the Clifford gates by name.
+    auto visitor = std::make_shared<AerOpsVisitor>(
+        program->name(), program->nPhysicalBits(), true,
+        m_simtype == "stabilizer" || m_simtype == "extended_stabilizer");
+    InstructionIterator it(program);
+    while (it.hasNext()) {
+      auto nextInst = it.next();
+      if (nextInst->isEnabled()) {
+        nextInst->accept(visitor);
+      }
+    }
+    if (!visitor->isSupported()) {
+      return false;
+    }
+
+    auto ops = visitor->getOps();
+    std::vector<std::size_t> bits;
+    if (isStateVec) {
+      // remove all measures, don't need them
+      ops.erase(std::remove_if(ops.begin(), ops.end(),
+                               [&](const AER::Operations::Op &op) {
+                                 if (op.type ==
+                                     AER::Operations::OpType::measure) {
+                                   bits.emplace_back(op.qubits[0]);
+                                   return true;
+                                 }
+                                 return false;
+                               }),
+                ops.end());
+    }
+    AER::Circuit circ(ops);
+    if (!isStateVec) {
+      circ.shots = m_shots;
+    }
+    circ.num_qubits =
+        std::max<AER::uint_t>(circ.num_qubits, program->nPhysicalBits());
+    circuits.emplace_back(std::move(circ));
+    nMeasures.emplace_back(visitor->nMeasures());
+    measuredBits.emplace_back(bits);
+  }
+
+  if (!nativeNoiseModel) {
+    nativeNoiseModel = std::make_shared<AER::Noise::NoiseModel>(noise_model);
+  }
+  const nlohmann::json &config = controller_config;
+  auto result = [&]() {
+    if (isStateVec) {
+      AER::Simulator::StatevectorController controller;
+      controller.set_config(config);
+      return controller.execute(circuits, *nativeNoiseModel, config);
+    }
+    AER::Simulator::QasmController controller;
+    controller.set_config(config);
+    return controller.execute(circuits, *nativeNoiseModel, config);
+  }();
+
+  if (result.status == AER::Result::Status::error) {
+    xacc::error("Aer Error: " + result.message);
+  }
+
+  for (int i = 0; i < result.results.size(); ++i) {
+    auto &expResult = result.results[i];
+    if (expResult.status == AER::ExperimentResult::Status::error) {
+      xacc::error("Aer Error: " + expResult.message);
+    }
+    if (isStateVec) {
+      const auto &aerStateVec =
+          expResult.data.additional_cvector_data_["statevector"];
+      std::vector<std::pair<double, double>> state_vector;
+      state_vector.reserve(aerStateVec.size());
+      for (const auto &amp : aerStateVec) {
+        state_vector.emplace_back(amp.real(), amp.imag());
+      }
+      buffers[i]->addExtraInfo("exp-val-z",
+                               calcExpectationValueZ(state_vector,
+                                                     measuredBits[i]));
+      buffers[i]->addExtraInfo("state", state_vector);
+    } else {
+      for (const auto &[hexStr, nOccurrences] : expResult.data.counts_) {
+        buffers[i]->appendMeasurement(
+            memory_hex_to_bit_string(hexStr, nMeasures[i]), nOccurrences);
+      }
+    }
+  }
+  return true;
+}
+
+void AerAccelerator::executePulseNative(
+    const std::vector<std::shared_ptr<AcceleratorBuffer>> &buffers,
+    const std::vector<std::shared_ptr<CompositeInstruction>> &programs) {
+  if (!physical_backend_properties.stringExists("config-json")) {
+    xacc::error("[Aer] The pulse sim-type requires a 'backend'.");
+  }
+  const auto backendConfig = nlohmann::json::parse(
+      physical_backend_properties.getString("config-json"));
+  const auto backendDefaults = nlohmann::json::parse(
+      physical_backend_properties.getString("defaults-json"));
+  const double dt = backendConfig["dt"].get<double>();
+  const auto qubitFreqEst =
+      backendDefaults["qubit_freq_est"].get<std::vector<double>>();
+  // Drive channels at their qubit frequency, control channels at the
+  // combination of the qubit frequencies (u_channel_lo).
+  std::map<std::string, double> loFreqs;
+  for (size_t q = 0; q < qubitFreqEst.size(); ++q) {
+    loFreqs["D" + std::to_string(q)] = qubitFreqEst[q];
+  }
+  if (backendConfig.count("u_channel_lo")) {
+    const auto &uLoFreqs = backendConfig["u_channel_lo"];
+    for (size_t u = 0; u < uLoFreqs.size(); ++u) {
+      double freq = 0.0;
+      for (const auto &loConfig : uLoFreqs[u]) {
+        const auto &scale = loConfig["scale"];
+        freq += (scale.is_array() ? scale[0].get<double>()
+                                  : scale.get<double>()) *
+                qubitFreqEst[loConfig["q"].get<int>()];
+      }
+      loFreqs["U" + std::to_string(u)] = freq;
+    }
+  }
+
+  // Pulse lowering (services are not thread-safe), then the simulations in
+  // parallel.
+  struct PulseJob {
+    std::shared_ptr<xacc::aer::PulseHamiltonian> hamiltonian;
+    std::map<std::string, xacc::aer::PulseChannel> channels;
+    std::vector<size_t> measuredBits;
+  };
+  std::vector<PulseJob> jobs;
+  auto ibmPulseAssembler = xacc::getService<IRTransformation>("ibm-pulse");
+  for (auto &program : programs) {
+    PulseJob job;
+    auto kernel = xacc::ir::asComposite(program->clone());
+    kernel->clear();
+    std::set<size_t> qubits;
+    InstructionIterator iter(program);
+    while (iter.hasNext()) {
+      auto next = iter.next();
+      if (next->isComposite() || !next->isEnabled()) {
+        continue;
+      }
+      const auto bits = next->bits();
+      qubits.insert(bits.begin(), bits.end());
+      if (next->opcode() == GateOpcode::Measure) {
+        job.measuredBits.emplace_back(bits[0]);
+      } else {
+        kernel->addInstruction(next);
+      }
+    }
+    ibmPulseAssembler->apply(kernel, nullptr);
+    job.hamiltonian = std::make_shared<xacc::aer::PulseHamiltonian>(
+        backendConfig["hamiltonian"],
+        std::vector<size_t>(qubits.begin(), qubits.end()));
+    job.channels = xacc::aer::toPulseChannels(kernel, loFreqs);
+    jobs.emplace_back(std::move(job));
+  }
+
+  xacc::aer::PulseSolverOptions options;
+  options.rtol = m_pulseRtol;
+  options.atol = m_pulseAtol;
+  const uint64_t seed = std::random_device{}();
+  xacc::getTaskScheduler()->parallelFor(
+      0, jobs.size(), [&](size_t beginIdx, size_t endIdx) {
+        for (size_t i = beginIdx; i < endIdx; ++i) {
+          const auto &job = jobs[i];
+          const auto &hamiltonian = *job.hamiltonian;
+          const auto state = xacc::aer::simulatePulseSchedule(
+              hamiltonian, job.channels, dt, options);
+          std::vector<double> probs;
+          std::vector<std::pair<double, double>> stateVec;
+          for (const auto &amp : state) {
+            probs.emplace_back(std::norm(amp));
+            stateVec.emplace_back(amp.real(), amp.imag());
+          }
+
+          // Outcome (msb) of a basis state, the excited levels (> 1
+          // included) read as 1.
+          const auto &simQubits = hamiltonian.qubits();
+          const auto nMeasures = job.measuredBits.size();
+          const auto toBitString = [&](size_t in_basisIdx) {
+            std::string bitStr(nMeasures, '0');
+            size_t stride = 1;
+            for (size_t k = 0; k < simQubits.size(); ++k) {
+              const auto levels = hamiltonian.levels()[k];
+              if ((in_basisIdx / stride) % levels > 0) {
+                for (size_t m = 0; m < nMeasures; ++m) {
+                  if (job.measuredBits[m] == simQubits[k]) {
+                    bitStr[nMeasures - 1 - m] = '1';
+                  }
+                }
+              }
+              stride *= levels;
+            }
+            return bitStr;
+          };
+          if (nMeasures > 0) {
+            std::mt19937_64 rng(seed + i);
+            std::discrete_distribution<size_t> dist(probs.begin(),
+                                                    probs.end());
+            std::map<std::string, int> counts;
+            for (int shot = 0; shot < m_shots; ++shot) {
+              counts[toBitString(dist(rng))]++;
+            }
+            for (const auto &[bitStr, count] : counts) {
+              buffers[i]->appendMeasurement(bitStr, count);
+            }
+          }
+          buffers[i]->addExtraInfo("state", stateVec);
+        }
+      });
+}
+
 void AerAccelerator::execute(
     std::shared_ptr<AcceleratorBuffer> buffer,
     const std::shared_ptr<CompositeInstruction> program) {
+  ScopedExecutionMetrics metrics(*this, 1, shotCount());
+  metrics.metrics().peakMemoryBytes = stateBytes(buffer->size());
+  if ((isShotsSimType() || m_simtype == "statevector") &&
+      executeNative({buffer}, {program})) {
+    return;
+  }
 
-  if (m_simtype == "qasm") {
+  if (m_simtype == "pulse" && m_pulseSolver == "native") {
+    executePulseNative({buffer}, {program});
+    return;
+  }
+
+  if (m_simtype == "stabilizer" || m_simtype == "extended_stabilizer") {
+    xacc::error("[Aer] conditional circuits are not supported by the " +
+                m_simtype + " sim-type.");
+  }
+
+  if (isShotsSimType()) {
     auto qobj_str = xacc_to_qobj->translate(program);
 
     nlohmann::json j = nlohmann::json::parse(qobj_str)["qObject"];
     j["config"]["shots"] = m_shots;
     j["config"]["noise_model"] = noise_model;
+    j["config"].update(controller_config);
 
     // xacc::set_verbose(true);
     // xacc::info("Shots Qobj:\n" + j.dump(2));
@@ -188,22 +551,8 @@ void AerAccelerator::execute(
     auto results = *results_json["results"].begin();
 
     auto counts = results["data"]["counts"].get<std::map<std::string, int>>();
-    for (auto &kv : counts) {
-      std::string hexStr = kv.first;
-      int nOccurrences = kv.second;
-      auto bitStr = hex_string_to_binary_string(hexStr);
-
-      // Process bitStr to be an n-Measure string in msb
-      std::string actual = "";
-      CountGatesOfTypeVisitor<Measure> cc(program);
-      int nMeasures = cc.countGates();
-      for (int i = 0; i < nMeasures; i++)
-        actual += "0";
-      for (int i = 0; i < nMeasures; i++)
-        actual[actual.length() - 1 - i] = bitStr[bitStr.length() - i - 1];
-
-      buffer->appendMeasurement(actual, nOccurrences);
-    }
+    CountGatesOfTypeVisitor<Measure> cc(program);
+    append_counts(buffer, counts, cc.countGates());
   } else if (m_simtype == "pulse") {
     // Get the correct QObject Generator
     auto qobjGen = xacc::getService<QObjGenerator>("pulse");
@@ -220,9 +569,9 @@ void AerAccelerator::execute(
     std::vector<size_t> measured_bits;
     while (iter.hasNext()) {
       auto next = iter.next();
-      if (!next->isComposite() && next->name() != "Measure") {
+      if (!next->isComposite() && next->opcode() != GateOpcode::Measure) {
         kernel->addInstruction(next);
-      } else if (next->name() == "Measure") {
+      } else if (next->opcode() == GateOpcode::Measure) {
         measured_bits.push_back(next->bits()[0]);
       }
     }
@@ -283,9 +632,9 @@ void AerAccelerator::execute(
     InstructionIterator iter(program);
     while (iter.hasNext()) {
       auto next = iter.next();
-      if (!next->isComposite() && next->name() != "Measure") {
+      if (!next->isComposite() && next->opcode() != GateOpcode::Measure) {
         tmp->addInstruction(next);
-      } else if (next->name() == "Measure") {
+      } else if (next->opcode() == GateOpcode::Measure) {
         measured_bits.push_back(next->bits()[0]);
       }
     }
@@ -296,6 +645,7 @@ void AerAccelerator::execute(
     xacc::info("Qobj:\n" + j.dump());
     j["config"]["noise_model"] = noise_model;
     j["config"]["method"] = "density_matrix";
+    j["config"].update(controller_config);
     auto snapshotInst = nlohmann::json::object();
     snapshotInst["label"] = "dm_snapshot";
     snapshotInst["name"] = "snapshot";
@@ -328,9 +678,9 @@ void AerAccelerator::execute(
     InstructionIterator iter(program);
     while (iter.hasNext()) {
       auto next = iter.next();
-      if (!next->isComposite() && next->name() != "Measure") {
+      if (!next->isComposite() && next->opcode() != GateOpcode::Measure) {
         tmp->addInstruction(next);
-      } else if (next->name() == "Measure") {
+      } else if (next->opcode() == GateOpcode::Measure) {
         measured_bits.push_back(next->bits()[0]);
       }
     }
@@ -338,6 +688,7 @@ void AerAccelerator::execute(
 
     nlohmann::json j = nlohmann::json::parse(qobj_str)["qObject"];
     j["config"]["noise_model"] = noise_model;
+    j["config"].update(controller_config);
     // xacc::info("StateVec Qobj:\n" + j.dump(2));
 
     auto results_json = nlohmann::json::parse(
@@ -366,6 +717,91 @@ void AerAccelerator::execute(
     std::shared_ptr<AcceleratorBuffer> buffer,
     const std::vector<std::shared_ptr<CompositeInstruction>>
         compositeInstructions) {
+  ScopedExecutionMetrics metrics(*this, compositeInstructions.size(),
+                                 shotCount());
+  metrics.metrics().peakMemoryBytes = stateBytes(buffer->size());
+  if (m_simtype == "pulse" && m_pulseSolver == "native") {
+    std::vector<std::shared_ptr<AcceleratorBuffer>> childBuffers;
+    for (auto &f : compositeInstructions) {
+      childBuffers.emplace_back(
+          std::make_shared<xacc::AcceleratorBuffer>(f->name(), buffer->size()));
+    }
+    executePulseNative(childBuffers, compositeInstructions);
+    for (auto &childBuffer : childBuffers) {
+      buffer->appendChild(childBuffer->name(), childBuffer);
+    }
+    return;
+  }
+
+  if (isShotsSimType() || m_simtype == "statevector") {
+    // Run all the circuits in a single Aer execution.
+    std::vector<std::shared_ptr<AcceleratorBuffer>> childBuffers;
+    for (auto &f : compositeInstructions) {
+      childBuffers.emplace_back(
+          std::make_shared<xacc::AcceleratorBuffer>(f->name(), buffer->size()));
+    }
+    if (executeNative(childBuffers, compositeInstructions)) {
+      for (auto &childBuffer : childBuffers) {
+        buffer->appendChild(childBuffer->name(), childBuffer);
+      }
+      return;
+    }
+
+    if (m_simtype == "qasm" || m_simtype == "matrix_product_state") {
+      // Not supported natively (e.g. conditionals):
+      // submit a single multi-experiment QObj, written directly as JSON.
+      std::string qobjStr;
+      xacc::ibm::QObjectWriter writer(qobjStr);
+      writer.begin("xacc-qobj-id", "QASM", "1.1.0");
+      std::vector<int> nMeasures;
+      int maxMemSlots = 0;
+      for (auto &f : compositeInstructions) {
+        QObjectExperimentVisitor visitor(f->name(), f->nPhysicalBits());
+        InstructionIterator it(f);
+        while (it.hasNext()) {
+          auto nextInst = it.next();
+          if (nextInst->isEnabled()) {
+            nextInst->accept(&visitor);
+          }
+        }
+        writer.addExperiment(visitor.getExperiment());
+        maxMemSlots = std::max(maxMemSlots, visitor.maxMemorySlots);
+        CountGatesOfTypeVisitor<Measure> cc(f);
+        nMeasures.emplace_back(cc.countGates());
+      }
+      xacc::ibm::QObjectConfig qobjConfig;
+      qobjConfig.set_shots(m_shots);
+      qobjConfig.set_memory(false);
+      qobjConfig.set_meas_level(2);
+      qobjConfig.set_memory_slots(maxMemSlots);
+      qobjConfig.set_meas_return("avg");
+      qobjConfig.set_memory_slot_size(100);
+      qobjConfig.set_n_qubits(50);
+      nlohmann::json config;
+      nlohmann::to_json(config, qobjConfig);
+      config["noise_model"] = noise_model;
+      config.update(controller_config);
+      writer.end(config, xacc::ibm::QObjectHeader());
+      auto results_json = nlohmann::json::parse(
+          AER::controller_execute_json<AER::Simulator::QasmController>(
+              qobjStr));
+      if (results_json["status"].get<std::string>().find("ERROR") !=
+          std::string::npos) {
+        xacc::error("Aer Error: " + results_json["status"].get<std::string>());
+      }
+
+      auto results = results_json["results"];
+      assert(results.size() == childBuffers.size());
+      for (int i = 0; i < childBuffers.size(); ++i) {
+        auto counts =
+            results[i]["data"]["counts"].get<std::map<std::string, int>>();
+        append_counts(childBuffers[i], counts, nMeasures[i]);
+        buffer->appendChild(childBuffers[i]->name(), childBuffers[i]);
+      }
+      return;
+    }
+  }
+
   for (auto &f : compositeInstructions) {
     auto tmpBuffer =
         std::make_shared<xacc::AcceleratorBuffer>(f->name(), buffer->size());
@@ -374,46 +810,63 @@ void AerAccelerator::execute(
   }
 }
 
+struct AerAccelerator::ApplySession {
+  AcceleratorBuffer *buffer;
+  size_t nbQubits;
+  AER::Statevector::State<QV::QubitVector<double>> state;
+  AER::RngEngine rng;
+};
+
 void AerAccelerator::apply(std::shared_ptr<AcceleratorBuffer> buffer,
                            std::shared_ptr<Instruction> inst) {
-  static AER::Statevector::State<QV::QubitVector<double>> stateVec;
-  static auto provider = xacc::getIRProvider("quantum");
-  static AER::RngEngine rng(time(NULL));
+  apply(buffer, std::vector<std::shared_ptr<Instruction>>{inst});
+}
 
+void AerAccelerator::apply(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<Instruction>> &insts) {
   if (!noiseModelObj) {
     noiseModelObj = std::make_shared<AER::Noise::NoiseModel>(noise_model);
-    stateVec.initialize_qreg(buffer->size());
   }
-  if (inst->isComposite() || inst->isAnalog()) {
-    xacc::error("Only gates are allowed.");
+  // The state lives as long as the same buffer is used.
+  if (!applySession || applySession->buffer != buffer.get()) {
+    applySession = std::make_shared<ApplySession>();
+    applySession->buffer = buffer.get();
+    applySession->nbQubits = buffer->size();
+    applySession->state.initialize_qreg(buffer->size());
+    applySession->rng.set_seed(time(NULL));
+  }
+  if (buffer->size() != applySession->nbQubits) {
+    xacc::error("Qubit (de)allocation is not supported.");
   }
 
-  auto tempComp = provider->createComposite("tmp");
-  tempComp->addInstruction(inst);
-  auto qobj_str = xacc_to_qobj->translate(tempComp);
-  auto qObjJson = nlohmann::json::parse(qobj_str)["qObject"];
-  AER::Qobj qobj(qObjJson);
-  assert(qobj.circuits.size() == 1);
-  auto circ = qobj.circuits[0];
+  // Aer ops straight from the IR, one memory slot per Measure
+  auto visitor =
+      std::make_shared<AerOpsVisitor>("apply", applySession->nbQubits);
+  for (auto &inst : insts) {
+    if (inst->isComposite() || inst->isAnalog()) {
+      xacc::error("Only gates are allowed.");
+    }
+    inst->accept(visitor);
+  }
+  if (!visitor->isSupported()) {
+    xacc::error("Conditional instructions are not supported by apply.");
+  }
+  AER::Circuit circ(visitor->getOps());
 
-  // Output data container
+  auto &state = applySession->state;
   AER::ExperimentData data;
-  data.add_metadata("method", stateVec.name());
-  data.add_metadata("measure_sampling", false);
-  auto noiseCirc = noiseModelObj->sample_noise(circ, rng);
-  stateVec.initialize_creg(circ.num_memory, circ.num_registers);
-  stateVec.apply_ops(noiseCirc.ops, data, rng);
-  stateVec.add_creg_to_data(data);
-  // If it was a Measure op:
-  if (inst->name() == "Measure") {
-    xacc::info("Experiment data: \n" + data.json().dump() + "\n");
-    auto countData = data.json()["counts"].get<std::map<std::string, int>>();
-    // In this mode, we only measure 1 qubit for 1 shot
-    assert(countData.size() == 1);
-    int zeroCount = countData.find("0x0") == countData.end() ? 0 : 1;
-    int oneCount = countData.find("0x1") == countData.end() ? 0 : 1;
-    assert((zeroCount + oneCount) == 1);
-    buffer->measure(inst->bits()[0], (oneCount > 0 ? 1 : 0));
+  const auto noiseCirc = noiseModelObj->sample_noise(circ, applySession->rng);
+  state.initialize_creg(circ.num_memory, circ.num_registers);
+  state.apply_ops(noiseCirc.ops, data, applySession->rng);
+
+  // Measurement results straight from the classical register (LSB last)
+  const auto &memory = state.creg().memory_bin();
+  for (const auto &op : circ.ops) {
+    if (op.type == AER::Operations::OpType::measure) {
+      const auto slot = op.memory[0];
+      buffer->measure(op.qubits[0], memory[memory.size() - 1 - slot] == '1');
+    }
   }
 }
 
@@ -425,6 +878,8 @@ void IbmqNoiseModel::initialize(const HeterogeneousMap &params) {
   m_gateDurations.clear();
   m_roErrors.clear();
   m_connectivity.clear();
+  m_singleQubitChannels.clear();
+  m_cxChannels.clear();
   // Note: we support both remote backend JSON and cache JSON string.
   // So that we can test this with offline JSON.
   if (params.stringExists("backend") || params.stringExists("backend-json")) {
@@ -542,32 +997,62 @@ void IbmqNoiseModel::initialize(const HeterogeneousMap &params) {
         }
       }
     }
+
+    // Noise channel tables: a gate only depends on its universal equivalent
+    // (u1, u2, u3 or cx) and its qubits.
+    m_singleQubitChannels.resize(3 * m_nbQubits);
+    for (size_t qIdx = 0; qIdx < m_nbQubits; ++qIdx) {
+      Z gateU1(qIdx);
+      Hadamard gateU2(qIdx);
+      X gateU3(qIdx);
+      m_singleQubitChannels[3 * qIdx] = computeNoiseChannels(gateU1);
+      m_singleQubitChannels[3 * qIdx + 1] = computeNoiseChannels(gateU2);
+      m_singleQubitChannels[3 * qIdx + 2] = computeNoiseChannels(gateU3);
+    }
+    for (const auto &[gateName, gateDuration] : m_gateDurations) {
+      if (gateName.rfind("cx", 0) == 0) {
+        const std::size_t pos = gateName.find("_");
+        const size_t control = std::atoi(gateName.substr(2, pos - 2).c_str());
+        const size_t target = std::atoi(gateName.substr(pos + 1).c_str());
+        if (control < m_nbQubits && target < m_nbQubits) {
+          CNOT cx(std::vector<std::size_t>{control, target});
+          m_cxChannels.emplace(control * m_nbQubits + target,
+                               computeNoiseChannels(cx));
+        }
+      }
+    }
+  }
+}
+
+int IbmqNoiseModel::universalGateType(xacc::quantum::Gate &in_gate) const {
+  const auto nbBits = in_gate.bits().size();
+  if (nbBits == 2) {
+    return 3;
+  }
+  if (nbBits != 1 || in_gate.opcode() == GateOpcode::Measure) {
+    return -1;
   }
+  // Note: rotation around Z is a noiseless *u1* operation;
+  // *u2* operations are those that requires a half-length rotation;
+  // *u3* operations are those that requires a full-length rotation.
+  static const std::unordered_map<std::string, int> SINGLE_QUBIT_GATE_MAP{
+      {"X", 2},   {"Y", 2},   {"Z", 0}, {"H", 1},  {"U", 2},  {"T", 0},
+      {"Tdg", 0}, {"S", 0},   {"Sdg", 0}, {"Rz", 0}, {"Rx", 2}, {"Ry", 2}};
+  const auto iter = SINGLE_QUBIT_GATE_MAP.find(in_gate.name());
+  // If cannot find the gate, just treat that as a noiseless u1 op.
+  return (iter == SINGLE_QUBIT_GATE_MAP.end()) ? 0 : iter->second;
 }
 
 std::string
 IbmqNoiseModel::getUniversalGateEquiv(xacc::quantum::Gate &in_gate) const {
-  if (in_gate.bits().size() == 1 && in_gate.name() != "Measure") {
-    // Note: rotation around Z is a noiseless *u1* operation;
-    // *u2* operations are those that requires a half-length rotation;
-    // *u3* operations are those that requires a full-length rotation.
-    static const std::unordered_map<std::string, std::string>
-        SINGLE_QUBIT_GATE_MAP{{"X", "u3"},   {"Y", "u3"},  {"Z", "u1"},
-                              {"H", "u2"},   {"U", "u3"},  {"T", "u1"},
-                              {"Tdg", "u1"}, {"S", "u1"},  {"Sdg", "u1"},
-                              {"Rz", "u1"},  {"Rx", "u3"}, {"Ry", "u3"}};
-    const auto iter = SINGLE_QUBIT_GATE_MAP.find(in_gate.name());
-    // If cannot find the gate, just treat that as a noiseless u1 op.
-    const std::string universalGateName =
-        (iter == SINGLE_QUBIT_GATE_MAP.end()) ? "u1" : iter->second;
-    return universalGateName + std::to_string(in_gate.bits()[0]);
-  }
-
-  if (in_gate.bits().size() == 2) {
+  const int type = universalGateType(in_gate);
+  if (type == 3) {
     return "cx" + std::to_string(in_gate.bits()[0]) + "_" +
            std::to_string(in_gate.bits()[1]);
   }
-
+  if (type >= 0) {
+    return "u" + std::to_string(type + 1) + std::to_string(in_gate.bits()[0]);
+  }
   return "id" + std::to_string(in_gate.bits()[0]);
 }
 
@@ -655,9 +1140,32 @@ double IbmqNoiseModel::gateErrorProb(xacc::quantum::Gate &gate) const {
 
 std::vector<NoiseChannelKraus>
 IbmqNoiseModel::getNoiseChannels(xacc::quantum::Gate &gate) const {
+  return noiseChannels(gate);
+}
+
+const std::vector<NoiseChannelKraus> &
+IbmqNoiseModel::noiseChannels(xacc::quantum::Gate &gate) const {
+  // Measure, gates on more than two qubits, or without backend data
+  static const std::vector<NoiseChannelKraus> noChannels;
+  const auto bits = gate.bits();
+  const int type = universalGateType(gate);
+  if (type >= 0 && type < 3 && bits[0] < m_nbQubits) {
+    return m_singleQubitChannels[3 * bits[0] + type];
+  }
+  if (type == 3 && bits[0] < m_nbQubits && bits[1] < m_nbQubits) {
+    const auto iter = m_cxChannels.find(bits[0] * m_nbQubits + bits[1]);
+    if (iter != m_cxChannels.end()) {
+      return iter->second;
+    }
+  }
+  return noChannels;
+}
+
+std::vector<NoiseChannelKraus>
+IbmqNoiseModel::computeNoiseChannels(xacc::quantum::Gate &gate) const {
   std::vector<NoiseChannelKraus> krausOps;
   const auto noiseUtils = xacc::getService<NoiseModelUtils>("default");
-  if (gate.bits().size() == 1 && gate.name() != "Measure") {
+  if (gate.bits().size() == 1 && gate.opcode() != GateOpcode::Measure) {
     // Amplitude damping + dephasing
     const auto [gateDuration, qubitT1, qubitT2] =
         relaxationParams(gate, gate.bits()[0]);
@@ -736,14 +1244,14 @@ std::string IbmqNoiseModel::toJson() const {
         {"u2", &gateU2}, {"u3", &gateU3}};
 
     for (const auto &[gateName, gate] : gateMap) {
-      const auto errorChannels = getNoiseChannels(*gate);
+      const auto &errorChannels = noiseChannels(*gate);
       nlohmann::json element;
       element["type"] = "qerror";
       element["operations"] = std::vector<std::string>{gateName};
       element["gate_qubits"] = std::vector<std::vector<std::size_t>>{{qIdx}};
       std::vector<nlohmann::json> krausOps;
       for (const auto &error : errorChannels) {
-        const auto krausOpMats = error.mats;
+        const auto &krausOpMats = error.mats;
         nlohmann::json instruction;
         instruction["name"] = "kraus";
         instruction["qubits"] = std::vector<std::size_t>{0};
@@ -766,7 +1274,7 @@ std::string IbmqNoiseModel::toJson() const {
     CNOT cx2(std::vector<std::size_t>{(size_t)qubit2, (size_t)qubit1});
     const std::vector<xacc::quantum::Gate *> cxGates{&cx1, &cx2};
     for (const auto &cx : cxGates) {
-      const auto errorChannels = getNoiseChannels(*cx);
+      const auto &errorChannels = noiseChannels(*cx);
       assert(errorChannels.size() == 2);
       nlohmann::json element;
       element["type"] = "qerror";
@@ -777,7 +1285,7 @@ std::string IbmqNoiseModel::toJson() const {
       std::vector<nlohmann::json> krausOps;
       size_t noiseBitIdx = 0;
       for (const auto &error : errorChannels) {
-        const auto krausOpMats = error.mats;
+        const auto &krausOpMats = error.mats;
         nlohmann::json instruction;
         instruction["name"] = "kraus";
         instruction["qubits"] = std::vector<std::size_t>{noiseBitIdx++};
@@ -59,6 +59,8 @@ public:
 
   void apply(std::shared_ptr<AcceleratorBuffer> buffer,
              std::shared_ptr<Instruction> inst) override;
+  void apply(std::shared_ptr<AcceleratorBuffer> buffer,
+             const std::vector<std::shared_ptr<Instruction>> &insts) override;
   bool isInitialized() const { return initialized; }
 
 private:
@@ -66,6 +68,33 @@ private:
       const std::vector<std::pair<double, double>> &in_stateVec,
       const std::vector<std::size_t> &in_bits);
 
+  // Measurement-sampling simulation types (QasmController)
+  bool isShotsSimType() const {
+    return m_simtype == "qasm" || m_simtype == "matrix_product_state" ||
+           m_simtype == "stabilizer" || m_simtype == "extended_stabilizer";
+  }
+  // Shots of an execution, -1 for exact expectation values
+  int shotCount() const {
+    return m_simtype == "statevector" || m_simtype == "density_matrix"
+               ? -1
+               : m_shots;
+  }
+  // Memory footprint of the simulation state, -1 if unknown
+  double stateBytes(std::size_t nbQubits) const;
+
+  // Executes the programs (shots or statevector sim-type) by constructing
+  // Aer circuits directly, i.e. no QObj JSON round-trip.
+  // Returns false if a program is not supported by this path.
+  bool executeNative(
+      const std::vector<std::shared_ptr<AcceleratorBuffer>> &buffers,
+      const std::vector<std::shared_ptr<CompositeInstruction>> &programs);
+
+  // Pulse sim-type: lowers the programs to pulses (backend cmd-defs) and
+  // integrates the backend Hamiltonian in-process, programs in parallel.
+  void executePulseNative(
+      const std::vector<std::shared_ptr<AcceleratorBuffer>> &buffers,
+      const std::vector<std::shared_ptr<CompositeInstruction>> &programs);
+
   static double calcExpectationValueZFromDensityMatrix(
       const std::vector<std::vector<std::pair<double, double>>> &in_densityMat,
       const std::vector<std::size_t> &in_bits);
@@ -73,11 +102,24 @@ private:
   std::shared_ptr<Compiler> xacc_to_qobj;
   int m_shots = 1024;
   std::string m_simtype = "qasm";
+  // Simulation device: CPU or GPU
+  std::string m_device = "CPU";
+  // Pulse simulation: "native" (in-process ODE solver) or "python" (Qiskit)
+  std::string m_pulseSolver = "native";
+  double m_pulseRtol = 1e-6;
+  double m_pulseAtol = 1e-8;
   nlohmann::json noise_model;
+  // Aer controller (parallelization) options
+  nlohmann::json controller_config;
   std::vector<std::pair<int, int>> connectivity;
   HeterogeneousMap m_options;
   bool initialized = false;
   std::shared_ptr<AER::Noise::NoiseModel> noiseModelObj;
+  // Live state vector of the gate-by-gate (apply) mode, for one buffer.
+  struct ApplySession;
+  std::shared_ptr<ApplySession> applySession;
+  // Noise model used by the native execution path
+  std::shared_ptr<AER::Noise::NoiseModel> nativeNoiseModel;
   HeterogeneousMap physical_backend_properties;
 
 };
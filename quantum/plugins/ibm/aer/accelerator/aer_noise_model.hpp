@@ -20,6 +20,10 @@ public:
   }
   virtual std::vector<NoiseChannelKraus>
   getNoiseChannels(xacc::quantum::Gate &gate) const override;
+  // Same channels, without copy: from the tables built with the backend
+  // properties.
+  const std::vector<NoiseChannelKraus> &
+  noiseChannels(xacc::quantum::Gate &gate) const;
   std::vector<RoErrors> readoutErrors() const override { return m_roErrors; }
   double gateErrorProb(xacc::quantum::Gate &gate) const override;
   size_t nQubits() const override { return m_nbQubits; }
@@ -42,6 +46,11 @@ private:
       xacc::quantum::Gate &in_gate,
       const std::vector<std::vector<std::complex<double>>> &in_relaxationError) const;
 
+  // Universal gate (0: u1, 1: u2, 2: u3, 3: cx, -1: none) of a gate.
+  int universalGateType(xacc::quantum::Gate &in_gate) const;
+  std::vector<NoiseChannelKraus>
+  computeNoiseChannels(xacc::quantum::Gate &in_gate) const;
+
   // Helper to construct the Choi matrix represents overall thermal relaxation:
   // i.e. amplitude damping + dephasing.
   std::vector<std::vector<std::complex<double>>>
@@ -58,6 +67,10 @@ private:
   std::vector<std::pair<double, double>> m_roErrors;
   std::vector<std::pair<int, int>> m_connectivity;
   std::string m_backendPropertiesJson;
+  // Noise channels of the u1, u2, u3 gates (3 * qubit + type) and of the cx
+  // gates of the backend (control * nbQubits + target).
+  std::vector<std::vector<NoiseChannelKraus>> m_singleQubitChannels;
+  std::unordered_map<size_t, std::vector<NoiseChannelKraus>> m_cxChannels;
 };
 } // namespace quantum
 } // namespace xacc
@@ -0,0 +1,133 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#pragma once
+#include "QObjectExperimentVisitor.hpp"
+#include "framework/operations.hpp"
+
+namespace xacc {
+namespace quantum {
+// Maps XACC IR directly to Aer operations, i.e. without the
+// QObj JSON serialization round-trip.
+// The gate decomposition ({u1, u2, u3, cx} gate set) and the memory slot
+// assignment are the same as the QObj visitor.
+// For the (extended) stabilizer engines, which don't support u1/u2/u3,
+// Clifford+T gates can be kept as named gates instead.
+class AerOpsVisitor : public QObjectExperimentVisitor {
+public:
+  using QObjectExperimentVisitor::visit;
+  AerOpsVisitor(const std::string expName, const int nQubits,
+                bool ignoreIdGate = true, bool useNamedGates = false)
+      : QObjectExperimentVisitor(expName, nQubits, GateSet::U_CX,
+                                 ignoreIdGate),
+        namedGates(useNamedGates) {}
+
+  const std::string name() const override { return "aer-ops-visitor"; }
+
+  const std::string description() const override {
+    return "Map XACC IR to Aer operations.";
+  }
+
+  void visit(Hadamard &h) override {
+    namedGates ? addNamedGate("h", h.bits())
+               : QObjectExperimentVisitor::visit(h);
+  }
+  void visit(X &x) override {
+    namedGates ? addNamedGate("x", x.bits())
+               : QObjectExperimentVisitor::visit(x);
+  }
+  void visit(Y &y) override {
+    namedGates ? addNamedGate("y", y.bits())
+               : QObjectExperimentVisitor::visit(y);
+  }
+  void visit(Z &z) override {
+    namedGates ? addNamedGate("z", z.bits())
+               : QObjectExperimentVisitor::visit(z);
+  }
+  void visit(S &s) override {
+    namedGates ? addNamedGate("s", s.bits())
+               : QObjectExperimentVisitor::visit(s);
+  }
+  void visit(Sdg &sdg) override {
+    namedGates ? addNamedGate("sdg", sdg.bits())
+               : QObjectExperimentVisitor::visit(sdg);
+  }
+  void visit(T &t) override {
+    namedGates ? addNamedGate("t", t.bits())
+               : QObjectExperimentVisitor::visit(t);
+  }
+  void visit(Tdg &tdg) override {
+    namedGates ? addNamedGate("tdg", tdg.bits())
+               : QObjectExperimentVisitor::visit(tdg);
+  }
+  void visit(CZ &cz) override {
+    namedGates ? addNamedGate("cz", cz.bits()) : AllGateVisitor::visit(cz);
+  }
+
+  // Conditional (bfunc) instructions are only supported via the QObj path.
+  bool isSupported() const {
+    for (const auto &inst : instructions) {
+      if (inst.isBfuc() || inst.get_condition_reg_id().has_value()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Number of memory slots (one per Measure)
+  int nMeasures() const { return maxMemorySlots; }
+
+  std::vector<AER::Operations::Op> getOps() const {
+    std::vector<AER::Operations::Op> ops;
+    ops.reserve(instructions.size());
+    for (const auto &inst : instructions) {
+      AER::Operations::Op op;
+      op.name = inst.get_name();
+      for (const auto &qubit : inst.get_qubits()) {
+        op.qubits.emplace_back(qubit);
+      }
+      if (op.name == "measure") {
+        op.type = AER::Operations::OpType::measure;
+        for (const auto &slot : inst.get_memory()) {
+          op.memory.emplace_back(slot);
+        }
+      } else if (op.name == "reset") {
+        op.type = AER::Operations::OpType::reset;
+      } else {
+        op.type = AER::Operations::OpType::gate;
+        for (const auto &param : inst.get_params()) {
+          op.params.emplace_back(param);
+        }
+        // Gate label (used by the noise model) is the gate name.
+        op.string_params = {op.name};
+      }
+      ops.emplace_back(std::move(op));
+    }
+    return ops;
+  }
+
+private:
+  void addNamedGate(const std::string &gateName,
+                    const std::vector<std::size_t> &bits) {
+    xacc::ibm::Instruction inst;
+    for (const auto &bit : bits) {
+      inst.get_mutable_qubits().push_back(bit);
+    }
+    inst.get_mutable_name() = gateName;
+    setConditional(inst);
+    instructions.push_back(inst);
+  }
+
+  bool namedGates;
+};
+} // namespace quantum
+} // namespace xacc
@@ -0,0 +1,714 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "aer_pulse_simulator.hpp"
+#include "InstructionIterator.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+
+namespace {
+using xacc::aer::Amplitude;
+constexpr Amplitude I_UNIT(0.0, 1.0);
+// Dense simulation: bound on the Hilbert space dimension.
+constexpr size_t MAX_DIMENSION = 4096;
+
+// Row-major dense operator on the simulated Hilbert space
+struct DenseOp {
+  size_t dim = 0;
+  std::vector<Amplitude> data;
+
+  static DenseOp identity(size_t in_dim, Amplitude in_scale = 1.0) {
+    DenseOp result{in_dim, std::vector<Amplitude>(in_dim * in_dim, 0.0)};
+    for (size_t i = 0; i < in_dim; ++i) {
+      result.data[i * in_dim + i] = in_scale;
+    }
+    return result;
+  }
+  Amplitude &operator()(size_t in_row, size_t in_col) {
+    return data[in_row * dim + in_col];
+  }
+  Amplitude operator()(size_t in_row, size_t in_col) const {
+    return data[in_row * dim + in_col];
+  }
+};
+
+DenseOp multiply(const DenseOp &in_a, const DenseOp &in_b) {
+  DenseOp result{in_a.dim, std::vector<Amplitude>(in_a.data.size(), 0.0)};
+  for (size_t i = 0; i < in_a.dim; ++i) {
+    for (size_t k = 0; k < in_a.dim; ++k) {
+      const auto a = in_a(i, k);
+      if (a == 0.0) {
+        continue;
+      }
+      for (size_t j = 0; j < in_a.dim; ++j) {
+        result(i, j) += a * in_b(k, j);
+      }
+    }
+  }
+  return result;
+}
+
+// Scalar or operator valued (sub-)expression of a Hamiltonian term
+struct TermValue {
+  bool isOp = false;
+  Amplitude scalar = 1.0;
+  DenseOp op;
+};
+
+// Recursive descent parser of an (expanded) Hamiltonian term, e.g.
+// "wq0/2*(I0-Z0)" or "jq0q1*Sp0*Sm1". Operators are I, X, Y, Z, Sp/C
+// (raising), Sm/A (lowering) and O/N (number) followed by the qubit index,
+// the other identifiers being variables.
+class TermParser {
+public:
+  TermParser(const std::string &in_expr,
+             const std::map<std::string, double> &in_vars,
+             const xacc::aer::PulseHamiltonian &in_model)
+      : m_expr(in_expr), m_vars(in_vars), m_model(in_model) {}
+
+  TermValue parse() {
+    auto result = parseSum();
+    skipSpaces();
+    if (m_pos != m_expr.size()) {
+      fail("unexpected '" + m_expr.substr(m_pos) + "'");
+    }
+    return result;
+  }
+  // One of the operators acts on a qubit which is not simulated.
+  bool actsOnOtherQubits() const { return m_otherQubits; }
+
+private:
+  void fail(const std::string &in_msg) const {
+    xacc::error("[Aer] Invalid Hamiltonian term '" + m_expr + "': " + in_msg);
+  }
+  void skipSpaces() {
+    while (m_pos < m_expr.size() && std::isspace(m_expr[m_pos])) {
+      ++m_pos;
+    }
+  }
+  bool consume(char in_char) {
+    skipSpaces();
+    if (m_pos < m_expr.size() && m_expr[m_pos] == in_char) {
+      ++m_pos;
+      return true;
+    }
+    return false;
+  }
+
+  DenseOp asOp(const TermValue &in_val) const {
+    return in_val.isOp ? in_val.op
+                       : DenseOp::identity(m_model.dimension(), in_val.scalar);
+  }
+  TermValue add(const TermValue &in_a, const TermValue &in_b,
+                double in_sign) const {
+    TermValue result;
+    if (!in_a.isOp && !in_b.isOp) {
+      result.scalar = in_a.scalar + in_sign * in_b.scalar;
+      return result;
+    }
+    result.isOp = true;
+    result.op = asOp(in_a);
+    const auto b = asOp(in_b);
+    for (size_t i = 0; i < b.data.size(); ++i) {
+      result.op.data[i] += in_sign * b.data[i];
+    }
+    return result;
+  }
+  TermValue mul(const TermValue &in_a, const TermValue &in_b) const {
+    TermValue result;
+    if (in_a.isOp && in_b.isOp) {
+      result.isOp = true;
+      result.op = multiply(in_a.op, in_b.op);
+    } else if (in_a.isOp || in_b.isOp) {
+      result = in_a.isOp ? in_a : in_b;
+      const auto scale = in_a.isOp ? in_b.scalar : in_a.scalar;
+      for (auto &val : result.op.data) {
+        val *= scale;
+      }
+    } else {
+      result.scalar = in_a.scalar * in_b.scalar;
+    }
+    return result;
+  }
+
+  TermValue parseSum() {
+    auto result = parseProduct();
+    for (;;) {
+      if (consume('+')) {
+        result = add(result, parseProduct(), 1.0);
+      } else if (consume('-')) {
+        result = add(result, parseProduct(), -1.0);
+      } else {
+        return result;
+      }
+    }
+  }
+  TermValue parseProduct() {
+    auto result = parseUnary();
+    for (;;) {
+      if (consume('*')) {
+        result = mul(result, parseUnary());
+      } else if (consume('/')) {
+        auto divisor = parseUnary();
+        if (divisor.isOp) {
+          fail("division by an operator");
+        }
+        divisor.scalar = 1.0 / divisor.scalar;
+        result = mul(result, divisor);
+      } else {
+        return result;
+      }
+    }
+  }
+  TermValue parseUnary() {
+    if (consume('-')) {
+      TermValue minusOne;
+      minusOne.scalar = -1.0;
+      return mul(minusOne, parseUnary());
+    }
+    if (consume('+')) {
+      return parseUnary();
+    }
+    return parseAtom();
+  }
+  TermValue parseAtom() {
+    if (consume('(')) {
+      auto result = parseSum();
+      if (!consume(')')) {
+        fail("missing ')'");
+      }
+      return result;
+    }
+    skipSpaces();
+    if (m_pos >= m_expr.size()) {
+      fail("unexpected end");
+    }
+    const size_t begin = m_pos;
+    if (std::isdigit(m_expr[m_pos]) || m_expr[m_pos] == '.') {
+      size_t length = 0;
+      TermValue result;
+      result.scalar = std::stod(m_expr.substr(begin), &length);
+      m_pos += length;
+      return result;
+    }
+    while (m_pos < m_expr.size() &&
+           (std::isalnum(m_expr[m_pos]) || m_expr[m_pos] == '_')) {
+      ++m_pos;
+    }
+    const auto name = m_expr.substr(begin, m_pos - begin);
+    if (name.empty()) {
+      fail("unexpected '" + m_expr.substr(begin) + "'");
+    }
+    TermValue result;
+    if (name == "pi") {
+      result.scalar = M_PI;
+      return result;
+    }
+    if (std::isupper(name[0])) {
+      const size_t digitsPos = name.find_first_of("0123456789");
+      if (digitsPos != std::string::npos &&
+          name.find_first_not_of("0123456789", digitsPos) == std::string::npos) {
+        result.isOp = true;
+        result.op =
+            localOperator(name.substr(0, digitsPos),
+                          std::stoul(name.substr(digitsPos)));
+        return result;
+      }
+    }
+    const auto iter = m_vars.find(name);
+    if (iter == m_vars.end()) {
+      fail("unknown variable '" + name + "'");
+    }
+    result.scalar = iter->second;
+    return result;
+  }
+
+  // Single-qubit operator, in the whole simulated space
+  DenseOp localOperator(const std::string &in_name, size_t in_qubit) {
+    const auto &qubits = m_model.qubits();
+    const auto dim = m_model.dimension();
+    const auto qubitIter = std::find(qubits.begin(), qubits.end(), in_qubit);
+    if (qubitIter == qubits.end()) {
+      m_otherQubits = true;
+      return DenseOp::identity(dim);
+    }
+    const size_t pos = std::distance(qubits.begin(), qubitIter);
+    const size_t levels = m_model.levels()[pos];
+    size_t stride = 1;
+    for (size_t i = 0; i < pos; ++i) {
+      stride *= m_model.levels()[i];
+    }
+
+    // Level basis matrix elements
+    std::vector<Amplitude> local(levels * levels, 0.0);
+    const auto set = [&](size_t in_row, size_t in_col, Amplitude in_val) {
+      local[in_row * levels + in_col] += in_val;
+    };
+    for (size_t l = 0; l < levels; ++l) {
+      const double sqrtL = std::sqrt(static_cast<double>(l));
+      if (in_name == "I") {
+        set(l, l, 1.0);
+      } else if (in_name == "O" || in_name == "N") {
+        set(l, l, static_cast<double>(l));
+      } else if (in_name == "Z") {
+        set(l, l, 1.0 - 2.0 * l);
+      } else if (l > 0) {
+        if (in_name == "Sp" || in_name == "C") {
+          set(l, l - 1, sqrtL);
+        } else if (in_name == "Sm" || in_name == "A") {
+          set(l - 1, l, sqrtL);
+        } else if (in_name == "X") {
+          set(l, l - 1, sqrtL);
+          set(l - 1, l, sqrtL);
+        } else if (in_name == "Y") {
+          set(l, l - 1, I_UNIT * sqrtL);
+          set(l - 1, l, -I_UNIT * sqrtL);
+        } else {
+          fail("unknown operator '" + in_name + "'");
+        }
+      }
+    }
+
+    DenseOp result{dim, std::vector<Amplitude>(dim * dim, 0.0)};
+    for (size_t i = 0; i < dim; ++i) {
+      const size_t level = (i / stride) % levels;
+      const size_t base = i - level * stride;
+      for (size_t l = 0; l < levels; ++l) {
+        result(i, base + l * stride) = local[level * levels + l];
+      }
+    }
+    return result;
+  }
+
+  const std::string &m_expr;
+  const std::map<std::string, double> &m_vars;
+  const xacc::aer::PulseHamiltonian &m_model;
+  size_t m_pos = 0;
+  bool m_otherQubits = false;
+};
+
+// Splits "expr||channel"
+std::pair<std::string, std::string> splitChannel(const std::string &in_term) {
+  const auto channelPos = in_term.find("||");
+  if (channelPos == std::string::npos) {
+    return {in_term, ""};
+  }
+  auto channel = in_term.substr(channelPos + 2);
+  channel.erase(std::remove(channel.begin(), channel.end(), ' '),
+                channel.end());
+  return {in_term.substr(0, channelPos), channel};
+}
+
+// Expands the _SUM[i,begin,end,body] terms, e.g. body with {i} or {i+1}.
+// Returns the (operator expression, channel) of each term.
+std::vector<std::pair<std::string, std::string>>
+expandTerm(const std::string &in_term) {
+  const auto sumPos = in_term.find("_SUM[");
+  if (sumPos == std::string::npos) {
+    return {splitChannel(in_term)};
+  }
+  const auto end = in_term.rfind(']');
+  // e.g. a sign
+  const auto prefix = in_term.substr(0, sumPos);
+  const auto args = in_term.substr(sumPos + 5, end - sumPos - 5);
+  std::vector<std::string> fields;
+  size_t start = 0;
+  for (int i = 0; i < 3; ++i) {
+    const auto comma = args.find(',', start);
+    if (comma == std::string::npos) {
+      xacc::error("[Aer] Invalid Hamiltonian term '" + in_term + "'.");
+    }
+    fields.emplace_back(args.substr(start, comma - start));
+    start = comma + 1;
+  }
+  const auto body = args.substr(start);
+  const auto var = fields[0];
+
+  std::vector<std::pair<std::string, std::string>> result;
+  for (int value = std::stoi(fields[1]); value <= std::stoi(fields[2]);
+       ++value) {
+    std::string expanded;
+    size_t pos = 0;
+    for (auto open = body.find('{'); open != std::string::npos;
+         open = body.find('{', pos)) {
+      const auto close = body.find('}', open);
+      expanded += body.substr(pos, open - pos);
+      auto index = body.substr(open + 1, close - open - 1);
+      index.erase(std::remove(index.begin(), index.end(), ' '), index.end());
+      int indexValue = value;
+      if (index.size() > var.size() &&
+          index.compare(0, var.size(), var) == 0) {
+        indexValue += std::stoi(index.substr(var.size()));
+      } else if (index != var) {
+        xacc::error("[Aer] Invalid index '" + index +
+                    "' in Hamiltonian term '" + in_term + "'.");
+      }
+      expanded += std::to_string(indexValue);
+      pos = close + 1;
+    }
+    expanded += body.substr(pos);
+    auto [expr, channel] = splitChannel(expanded);
+    result.emplace_back(prefix + "(" + expr + ")", channel);
+  }
+  return result;
+}
+
+xacc::aer::PulseHamiltonian::SparseOp toSparse(const DenseOp &in_op,
+                                               bool in_offDiagonalOnly) {
+  xacc::aer::PulseHamiltonian::SparseOp result;
+  for (size_t i = 0; i < in_op.dim; ++i) {
+    for (size_t j = 0; j < in_op.dim; ++j) {
+      if ((in_offDiagonalOnly && i == j) || std::abs(in_op(i, j)) < 1e-15) {
+        continue;
+      }
+      result.rows.emplace_back(i);
+      result.cols.emplace_back(j);
+      result.values.emplace_back(in_op(i, j));
+    }
+  }
+  return result;
+}
+
+Amplitude toAmplitude(const nlohmann::json &in_json) {
+  if (in_json.is_array()) {
+    return {in_json[0].get<double>(), in_json[1].get<double>()};
+  }
+  return in_json.get<double>();
+}
+
+// Lifted gaussian sampled at the middle of each dt (as Qiskit), zero at
+// +/- in_zeroedWidth / 2 from the center.
+double liftedGaussian(double in_t, double in_center, double in_sigma,
+                      double in_zeroedWidth) {
+  const auto gaussian = [&](double in_x) {
+    return std::exp(-0.5 * (in_x / in_sigma) * (in_x / in_sigma));
+  };
+  const double zero = gaussian(0.5 * in_zeroedWidth);
+  return (gaussian(in_t - in_center) - zero) / (1.0 - zero);
+}
+
+std::vector<Amplitude> parametricSamples(const xacc::HeterogeneousMap &in_params) {
+  const auto shape = in_params.getString("pulse_shape");
+  const auto params = nlohmann::json::parse(in_params.getString("parameters_json"));
+  const int duration = params["duration"].get<int>();
+  const auto amp = toAmplitude(params["amp"]);
+  std::vector<Amplitude> samples(duration);
+  for (int k = 0; k < duration; ++k) {
+    const double t = k + 0.5;
+    const double center = 0.5 * duration;
+    if (shape == "constant") {
+      samples[k] = amp;
+    } else if (shape == "gaussian" || shape == "drag") {
+      const double sigma = params["sigma"].get<double>();
+      samples[k] = amp * liftedGaussian(t, center, sigma, duration + 2.0);
+      if (shape == "drag") {
+        const double x = t - center;
+        samples[k] += I_UNIT * params["beta"].get<double>() * amp *
+                      (-x / (sigma * sigma)) *
+                      std::exp(-0.5 * (x / sigma) * (x / sigma));
+      }
+    } else if (shape == "gaussian_square") {
+      const double sigma = params["sigma"].get<double>();
+      const double width = params["width"].get<double>();
+      const double riseFall = 0.5 * (duration - width);
+      if (t < riseFall) {
+        samples[k] = amp * liftedGaussian(t, riseFall, sigma, 2.0 * riseFall + 2.0);
+      } else if (t > riseFall + width) {
+        samples[k] = amp * liftedGaussian(t, riseFall + width, sigma,
+                                          2.0 * riseFall + 2.0);
+      } else {
+        samples[k] = amp;
+      }
+    } else {
+      xacc::error("[Aer] Parametric pulse '" + shape +
+                  "' is not supported by the pulse simulator.");
+    }
+  }
+  return samples;
+}
+} // namespace
+
+namespace xacc {
+namespace aer {
+PulseHamiltonian::PulseHamiltonian(const nlohmann::json &in_hamiltonian,
+                                   const std::vector<size_t> &in_qubits)
+    : m_qubits(in_qubits) {
+  std::sort(m_qubits.begin(), m_qubits.end());
+  m_qubits.erase(std::unique(m_qubits.begin(), m_qubits.end()), m_qubits.end());
+  for (const auto qubit : m_qubits) {
+    const auto key = std::to_string(qubit);
+    size_t levels = 2;
+    if (in_hamiltonian.count("qub") && in_hamiltonian["qub"].count(key)) {
+      levels = in_hamiltonian["qub"][key].get<size_t>();
+    }
+    m_levels.emplace_back(levels);
+    m_dimension *= levels;
+  }
+  if (m_dimension > MAX_DIMENSION) {
+    xacc::error("[Aer] The pulse simulation Hilbert space is too large (" +
+                std::to_string(m_dimension) + " levels).");
+  }
+
+  std::map<std::string, double> vars;
+  if (in_hamiltonian.count("vars")) {
+    for (auto iter = in_hamiltonian["vars"].begin();
+         iter != in_hamiltonian["vars"].end(); ++iter) {
+      vars[iter.key()] = toAmplitude(iter.value()).real();
+    }
+  }
+
+  auto staticOp = DenseOp::identity(m_dimension, 0.0);
+  std::map<std::string, DenseOp> channelOps;
+  for (const auto &hStr : in_hamiltonian["h_str"]) {
+    for (const auto &[expr, channel] : expandTerm(hStr.get<std::string>())) {
+      TermParser parser(expr, vars, *this);
+      const auto value = parser.parse();
+      if (parser.actsOnOtherQubits()) {
+        continue;
+      }
+      const auto op = value.isOp
+                          ? value.op
+                          : DenseOp::identity(m_dimension, value.scalar);
+      auto &sum = channel.empty() ? staticOp
+                                  : channelOps.emplace(channel,
+                                                       DenseOp::identity(m_dimension, 0.0))
+                                        .first->second;
+      for (size_t i = 0; i < op.data.size(); ++i) {
+        sum.data[i] += op.data[i];
+      }
+    }
+  }
+
+  for (size_t i = 0; i < m_dimension; ++i) {
+    m_energies.emplace_back(staticOp(i, i).real());
+  }
+  m_static = toSparse(staticOp, true);
+  for (const auto &[channel, op] : channelOps) {
+    m_terms.push_back({channel, toSparse(op, false)});
+  }
+}
+
+std::map<std::string, PulseChannel>
+toPulseChannels(const std::shared_ptr<CompositeInstruction> &in_pulseProgram,
+                const std::map<std::string, double> &in_loFreqs) {
+  std::map<std::string, PulseChannel> result;
+  std::map<std::string, std::vector<std::pair<size_t, double>>> frameChanges;
+  InstructionIterator iter(in_pulseProgram);
+  while (iter.hasNext()) {
+    auto inst = iter.next();
+    if (inst->isComposite() || !inst->isEnabled()) {
+      continue;
+    }
+    auto channel = inst->channel();
+    std::transform(channel.begin(), channel.end(), channel.begin(), ::toupper);
+    // Measure and acquire channels do not enter the Hamiltonian.
+    if (channel.empty() || channel[0] == 'M' || channel[0] == 'A') {
+      continue;
+    }
+    const auto &name = inst->name();
+    const size_t t0 = inst->start();
+    if (name == "fc") {
+      frameChanges[channel].emplace_back(
+          t0, InstructionParameterToDouble(inst->getParameter(0)));
+      continue;
+    }
+    if (name == "acquire" || name == "delay") {
+      continue;
+    }
+    std::vector<Amplitude> samples;
+    if (name == "parametric_pulse") {
+      samples = parametricSamples(inst->getPulseParams());
+    } else {
+      for (const auto &sample : inst->getSamples()) {
+        samples.emplace_back(sample[0], sample.size() > 1 ? sample[1] : 0.0);
+      }
+    }
+    auto &channelSamples = result[channel].samples;
+    if (channelSamples.size() < t0 + samples.size()) {
+      channelSamples.resize(t0 + samples.size(), 0.0);
+    }
+    for (size_t k = 0; k < samples.size(); ++k) {
+      channelSamples[t0 + k] += samples[k];
+    }
+  }
+
+  for (auto &[channel, changes] : frameChanges) {
+    auto &samples = result[channel].samples;
+    std::stable_sort(
+        changes.begin(), changes.end(),
+        [](const auto &a, const auto &b) { return a.first < b.first; });
+    for (const auto &[t0, phase] : changes) {
+      const auto rotation = std::exp(I_UNIT * phase);
+      for (size_t k = t0; k < samples.size(); ++k) {
+        samples[k] *= rotation;
+      }
+    }
+  }
+  for (auto &[channel, pulseChannel] : result) {
+    const auto iter = in_loFreqs.find(channel);
+    if (iter != in_loFreqs.end()) {
+      pulseChannel.loFreq = iter->second;
+    }
+  }
+  return result;
+}
+
+std::vector<Amplitude>
+simulatePulseSchedule(const PulseHamiltonian &in_hamiltonian,
+                      const std::map<std::string, PulseChannel> &in_channels,
+                      double in_dt, const PulseSolverOptions &in_options) {
+  const size_t dim = in_hamiltonian.dimension();
+  const auto &energies = in_hamiltonian.frameEnergies();
+
+  // Frame oscillation frequency of each entry
+  const auto frequencies = [&](const PulseHamiltonian::SparseOp &in_op) {
+    std::vector<double> result;
+    for (size_t k = 0; k < in_op.values.size(); ++k) {
+      result.emplace_back(energies[in_op.rows[k]] - energies[in_op.cols[k]]);
+    }
+    return result;
+  };
+  struct DriveTerm {
+    const PulseHamiltonian::SparseOp *op;
+    std::vector<double> frequencies;
+    const PulseChannel *channel;
+  };
+  std::vector<DriveTerm> driveTerms;
+  size_t nbSamples = 0;
+  for (const auto &term : in_hamiltonian.channelTerms()) {
+    const auto iter = in_channels.find(term.channel);
+    if (iter == in_channels.end() || term.op.values.empty()) {
+      continue;
+    }
+    driveTerms.push_back({&term.op, frequencies(term.op), &iter->second});
+    nbSamples = std::max(nbSamples, iter->second.samples.size());
+  }
+  const auto &staticOp = in_hamiltonian.staticOffDiagonal();
+  const auto staticFrequencies = frequencies(staticOp);
+
+  // d(phi)/dt = -i exp(iEt) (H - E) exp(-iEt) phi, the envelope of the
+  // rotated drive applied to the lower triangle and its conjugate to the
+  // upper one.
+  const auto rhs = [&](double in_t, size_t in_sampleIdx,
+                       const std::vector<Amplitude> &in_state,
+                       std::vector<Amplitude> &out_deriv) {
+    std::fill(out_deriv.begin(), out_deriv.end(), 0.0);
+    const auto accumulate = [&](const PulseHamiltonian::SparseOp &in_op,
+                                const std::vector<double> &in_freqs,
+                                Amplitude in_coeff, bool in_isDrive) {
+      for (size_t k = 0; k < in_op.values.size(); ++k) {
+        const auto row = in_op.rows[k];
+        const auto col = in_op.cols[k];
+        const auto coeff =
+            (in_isDrive && row < col) ? std::conj(in_coeff) : in_coeff;
+        out_deriv[row] += coeff * in_op.values[k] *
+                          std::exp(I_UNIT * (in_freqs[k] * in_t)) *
+                          in_state[col];
+      }
+    };
+    accumulate(staticOp, staticFrequencies, 1.0, false);
+    for (const auto &term : driveTerms) {
+      const auto &samples = term.channel->samples;
+      if (in_sampleIdx >= samples.size() || samples[in_sampleIdx] == 0.0) {
+        continue;
+      }
+      const auto value =
+          samples[in_sampleIdx] *
+          std::exp(-I_UNIT * (2.0 * M_PI * term.channel->loFreq * in_t));
+      accumulate(*term.op, term.frequencies, value, true);
+    }
+    for (auto &val : out_deriv) {
+      val *= -I_UNIT;
+    }
+  };
+
+  // Dormand-Prince 5(4) tableau
+  static const double c[7] = {0.0, 1.0 / 5, 3.0 / 10, 4.0 / 5, 8.0 / 9, 1.0, 1.0};
+  static const double a[7][6] = {
+      {},
+      {1.0 / 5},
+      {3.0 / 40, 9.0 / 40},
+      {44.0 / 45, -56.0 / 15, 32.0 / 9},
+      {19372.0 / 6561, -25360.0 / 2187, 64448.0 / 6561, -212.0 / 729},
+      {9017.0 / 3168, -355.0 / 33, 46732.0 / 5247, 49.0 / 176,
+       -5103.0 / 18656},
+      {35.0 / 384, 0.0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784,
+       11.0 / 84}};
+  // 5th order minus embedded 4th order weights
+  static const double e[7] = {35.0 / 384 - 5179.0 / 57600,
+                              0.0,
+                              500.0 / 1113 - 7571.0 / 16695,
+                              125.0 / 192 - 393.0 / 640,
+                              -2187.0 / 6784 + 92097.0 / 339200,
+                              11.0 / 84 - 187.0 / 2100,
+                              -1.0 / 40};
+
+  std::vector<Amplitude> state(dim, 0.0);
+  state[0] = 1.0;
+  std::vector<std::vector<Amplitude>> k(7, std::vector<Amplitude>(dim));
+  std::vector<Amplitude> stage(dim), next(dim);
+  double step = 0.1 * in_dt;
+  // The envelopes are piecewise constant: one integration per sample.
+  for (size_t sampleIdx = 0; sampleIdx < nbSamples; ++sampleIdx) {
+    double t = sampleIdx * in_dt;
+    const double tEnd = t + in_dt;
+    rhs(t, sampleIdx, state, k[0]);
+    while (t < tEnd - 1e-12 * in_dt) {
+      const double h = std::min(step, tEnd - t);
+      for (int s = 1; s < 7; ++s) {
+        for (size_t i = 0; i < dim; ++i) {
+          Amplitude sum = 0.0;
+          for (int j = 0; j < s; ++j) {
+            sum += a[s][j] * k[j][i];
+          }
+          stage[i] = state[i] + h * sum;
+        }
+        rhs(t + c[s] * h, sampleIdx, stage, k[s]);
+      }
+      // The last stage is the 5th order solution (FSAL).
+      next = stage;
+      double errNorm = 0.0;
+      for (size_t i = 0; i < dim; ++i) {
+        Amplitude err = 0.0;
+        for (int s = 0; s < 7; ++s) {
+          err += e[s] * k[s][i];
+        }
+        const double scale =
+            in_options.atol +
+            in_options.rtol * std::max(std::abs(state[i]), std::abs(next[i]));
+        errNorm = std::max(errNorm, std::abs(h * err) / scale);
+      }
+      const double factor =
+          errNorm == 0.0 ? 5.0
+                         : std::min(5.0, std::max(0.2, 0.9 * std::pow(errNorm, -0.2)));
+      if (errNorm <= 1.0) {
+        t += h;
+        state.swap(next);
+        std::swap(k[0], k[6]);
+        // A step shortened by the end of the sample is not grown.
+        step = h < step ? step * std::min(1.0, factor) : h * factor;
+      } else {
+        step = h * factor;
+      }
+    }
+  }
+
+  // Back to the lab frame
+  const double tFinal = nbSamples * in_dt;
+  for (size_t i = 0; i < dim; ++i) {
+    state[i] *= std::exp(-I_UNIT * (energies[i] * tFinal));
+  }
+  return state;
+}
+} // namespace aer
+} // namespace xacc
@@ -0,0 +1,95 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#pragma once
+#include "xacc.hpp"
+#include <complex>
+#include <map>
+#include <nlohmann/json.hpp>
+
+namespace xacc {
+namespace aer {
+using Amplitude = std::complex<double>;
+
+// Hamiltonian of an OpenPulse backend, from the 'hamiltonian' field of its
+// configuration (Qiskit string format, e.g. "_SUM[i,0,4,wq{i}/2*(I{i}-Z{i})]"
+// or "omegad0*X0||D0"), restricted to a subset of the qubits: terms acting
+// on the other qubits are dropped.
+// Units are the backend ones, i.e. ns and GHz.
+class PulseHamiltonian {
+public:
+  PulseHamiltonian(const nlohmann::json &in_hamiltonian,
+                   const std::vector<size_t> &in_qubits);
+
+  // The (sorted) simulated qubits
+  const std::vector<size_t> &qubits() const { return m_qubits; }
+  // Number of levels of each simulated qubit
+  const std::vector<size_t> &levels() const { return m_levels; }
+  // Basis states index the qubit levels qubits()[0] first (least
+  // significant).
+  size_t dimension() const { return m_dimension; }
+
+  // Non-zero entries of an operator
+  struct SparseOp {
+    std::vector<size_t> rows;
+    std::vector<size_t> cols;
+    std::vector<Amplitude> values;
+  };
+  // (Hermitian) time-independent part, its diagonal being the frame of the
+  // simulation.
+  const SparseOp &staticOffDiagonal() const { return m_static; }
+  const std::vector<double> &frameEnergies() const { return m_energies; }
+  // Terms multiplied by the value of a channel (e.g. "D0", "U1")
+  struct ChannelTerm {
+    std::string channel;
+    SparseOp op;
+  };
+  const std::vector<ChannelTerm> &channelTerms() const { return m_terms; }
+
+private:
+  std::vector<size_t> m_qubits;
+  std::vector<size_t> m_levels;
+  size_t m_dimension = 1;
+  SparseOp m_static;
+  std::vector<double> m_energies;
+  std::vector<ChannelTerm> m_terms;
+};
+
+// Complex envelope of a channel, one value per dt, frame changes included,
+// modulated at loFreq (GHz).
+struct PulseChannel {
+  double loFreq = 0.0;
+  std::vector<Amplitude> samples;
+};
+
+// Channel envelopes ("D0", "U1", etc.) of a scheduled pulse program
+// (sample, parametric and frame change pulses), given the LO frequency of
+// each channel.
+std::map<std::string, PulseChannel>
+toPulseChannels(const std::shared_ptr<CompositeInstruction> &in_pulseProgram,
+                const std::map<std::string, double> &in_loFreqs);
+
+struct PulseSolverOptions {
+  double rtol = 1e-6;
+  double atol = 1e-8;
+};
+
+// Integrates the Schrodinger equation from the ground state with an adaptive
+// Dormand-Prince (RK45) solver, in the rotating frame of the static
+// diagonal and with the drive terms as in Qiskit (rotating wave).
+// Returns the final state (lab frame).
+std::vector<Amplitude>
+simulatePulseSchedule(const PulseHamiltonian &in_hamiltonian,
+                      const std::map<std::string, PulseChannel> &in_channels,
+                      double in_dt, const PulseSolverOptions &in_options);
+} // namespace aer
+} // namespace xacc
@@ -373,6 +373,13 @@ void State::set_config(const json_t &config) {
   if (JSON::get_value(index_size, "mps_sample_measure_opt", config)) {
     MPS::set_sample_measure_index_size(index_size);
   }
+
+  // Set the bond dimension and truncation threshold of the SVD
+  uint_t max_bond_dimension = 0;
+  double truncation_threshold = 0.0;
+  JSON::get_value(max_bond_dimension, "matrix_product_state_max_bond_dimension", config);
+  JSON::get_value(truncation_threshold, "matrix_product_state_truncation_threshold", config);
+  set_svd_truncation(max_bond_dimension, truncation_threshold);
 }
 
 //=========================================================================
@@ -95,11 +95,41 @@ uint_t num_of_SV(rvector_t S, double threshold)
 	return sum;
 }
 
+static uint_t svd_max_bond_dimension = 0;
+static double svd_truncation_threshold = 0.0;
+
+void set_svd_truncation(uint_t max_bond_dimension, double truncation_threshold) {
+  svd_max_bond_dimension = max_bond_dimension;
+  svd_truncation_threshold = truncation_threshold;
+}
+
 void reduce_zeros(cmatrix_t &U, rvector_t &S, cmatrix_t &V) {
   uint_t SV_num = num_of_SV(S, 1e-16);
-  U.resize(U.GetRows(), SV_num);
-  S.resize(SV_num);
-  V.resize(V.GetRows(), SV_num);
+  uint_t new_SV_num = SV_num;
+  if (svd_max_bond_dimension > 0 && svd_max_bond_dimension < new_SV_num)
+    new_SV_num = svd_max_bond_dimension;
+  // The singular values are sorted, discard the smallest ones
+  double discarded = 0.0;
+  while (new_SV_num > 1 &&
+         discarded + std::norm(S[new_SV_num - 1]) < svd_truncation_threshold) {
+    discarded += std::norm(S[new_SV_num - 1]);
+    new_SV_num--;
+  }
+  if (new_SV_num < SV_num) {
+    // Renormalize the remaining coefficients
+    double total = 0.0, kept = 0.0;
+    for (uint_t i = 0; i < SV_num; ++i) {
+      total += std::norm(S[i]);
+      if (i < new_SV_num)
+        kept += std::norm(S[i]);
+    }
+    const double factor = std::sqrt(total / kept);
+    for (uint_t i = 0; i < new_SV_num; ++i)
+      S[i] *= factor;
+  }
+  U.resize(U.GetRows(), new_SV_num);
+  S.resize(new_SV_num);
+  V.resize(V.GetRows(), new_SV_num);
 }
 
 // added cut-off at the end
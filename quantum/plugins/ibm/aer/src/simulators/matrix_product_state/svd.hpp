@@ -33,6 +33,10 @@ rvector_t reshape_S_after_SVD(rvector_t S);
 std::vector<cmatrix_t> reshape_V_after_SVD(const cmatrix_t V);
 uint_t num_of_SV(rvector_t S, double threshold);
 void reduce_zeros(cmatrix_t &U, rvector_t &S, cmatrix_t &V);
+// Truncation applied by reduce_zeros: keep at most max_bond_dimension
+// Schmidt coefficients (0: no limit) and discard the smallest ones whose
+// total weight (sum of squares) is below truncation_threshold.
+void set_svd_truncation(uint_t max_bond_dimension, double truncation_threshold);
 status csvd(cmatrix_t &C, cmatrix_t &U,rvector_t &S,cmatrix_t &V);
 void csvd_wrapper(cmatrix_t &C, cmatrix_t &U,rvector_t &S,cmatrix_t &V);
 
@@ -298,6 +298,134 @@ TEST(AerAcceleratorTester, checkApply) {
   EXPECT_EQ(resultQ0, resultQ1);
 }
 
+TEST(AerAcceleratorTester, checkApplyBatch) {
+  auto accelerator = xacc::getAccelerator("aer");
+  auto xasmCompiler = xacc::getCompiler("xasm");
+  auto ir = xasmCompiler->compile(R"(__qpu__ void ghz(qbit q) {
+      H(q[0]);
+      CX(q[0], q[1]);
+      CX(q[1], q[2]);
+      Measure(q[0]);
+    })",
+                                  accelerator);
+  auto program = ir->getComposite("ghz");
+  auto provider = xacc::getIRProvider("quantum");
+
+  for (int i = 0; i < 10; ++i) {
+    auto buffer = xacc::qalloc(3);
+    accelerator->apply(buffer, program->getInstructions());
+    // The state persists: the other qubits follow the first measurement.
+    accelerator->apply(buffer, std::vector<std::shared_ptr<xacc::Instruction>>{
+                                   provider->createInstruction("Measure", {1}),
+                                   provider->createInstruction("Measure", {2})});
+    EXPECT_EQ((*buffer)[0], (*buffer)[1]);
+    EXPECT_EQ((*buffer)[1], (*buffer)[2]);
+  }
+}
+
+TEST(AerAcceleratorTester, checkBatchExecute) {
+  auto xasmCompiler = xacc::getCompiler("xasm");
+  auto ir = xasmCompiler->compile(R"(__qpu__ void flip(qbit q, double theta) {
+      Rx(q[0], theta);
+      CX(q[0], q[1]);
+      Measure(q[0]);
+      Measure(q[1]);
+    })");
+  auto program = ir->getComposite("flip");
+  std::vector<std::shared_ptr<xacc::CompositeInstruction>> circuits;
+  for (int i = 0; i < 20; ++i) {
+    // Alternate between |00> and |11>
+    circuits.emplace_back(program->operator()({(i % 2) * M_PI}));
+  }
+
+  {
+    auto accelerator =
+        xacc::getAccelerator("aer", {std::make_pair("shots", 1024)});
+    auto buffer = xacc::qalloc(2);
+    accelerator->execute(buffer, circuits);
+    auto children = buffer->getChildren();
+    EXPECT_EQ(children.size(), circuits.size());
+    for (int i = 0; i < children.size(); ++i) {
+      EXPECT_NEAR(children[i]->computeMeasurementProbability(
+                      i % 2 == 0 ? "00" : "11"),
+                  1.0, 1e-12);
+    }
+  }
+  {
+    auto accelerator = xacc::getAccelerator(
+        "aer", {std::make_pair("sim-type", "statevector")});
+    auto buffer = xacc::qalloc(2);
+    accelerator->execute(buffer, circuits);
+    auto children = buffer->getChildren();
+    EXPECT_EQ(children.size(), circuits.size());
+    for (int i = 0; i < children.size(); ++i) {
+      // < Z0 Z1 > = 1.0 for both states
+      EXPECT_NEAR(children[i]->getExpectationValueZ(), 1.0, 1e-9);
+    }
+  }
+}
+
+TEST(AerAcceleratorTester, checkBatchConditional) {
+  auto accelerator = xacc::getAccelerator(
+      "aer", {std::make_pair("shots", 1024),
+              std::make_pair("max-parallel-experiments", 4)});
+  auto xasmCompiler = xacc::getCompiler("xasm");
+  auto ir = xasmCompiler->compile(R"(__qpu__ void conditionalFlip(qbit q, double theta) {
+      Rx(q[0], theta);
+      Measure(q[0]);
+      if (q[0]) {
+        X(q[1]);
+      }
+      Measure(q[1]);
+    })",
+                                  accelerator);
+  auto program = ir->getComposite("conditionalFlip");
+  std::vector<std::shared_ptr<xacc::CompositeInstruction>> circuits;
+  for (int i = 0; i < 8; ++i) {
+    circuits.emplace_back(program->operator()({(i % 2) * M_PI}));
+  }
+  auto buffer = xacc::qalloc(2);
+  accelerator->execute(buffer, circuits);
+  auto children = buffer->getChildren();
+  EXPECT_EQ(children.size(), circuits.size());
+  for (int i = 0; i < children.size(); ++i) {
+    EXPECT_NEAR(
+        children[i]->computeMeasurementProbability(i % 2 == 0 ? "00" : "11"),
+        1.0, 1e-12);
+  }
+}
+
+TEST(AerAcceleratorTester, checkLargeGhz) {
+  // 60-qubit GHZ state: beyond statevector, fine for MPS/stabilizer.
+  const int nQubits = 60;
+  auto provider = xacc::getIRProvider("quantum");
+  auto program = provider->createComposite("ghz");
+  program->addInstruction(provider->createInstruction("H", {0}));
+  for (int i = 0; i < nQubits - 1; ++i) {
+    program->addInstruction(provider->createInstruction(
+        "CNOT", {static_cast<size_t>(i), static_cast<size_t>(i + 1)}));
+  }
+  for (int i = 0; i < nQubits; ++i) {
+    program->addInstruction(
+        provider->createInstruction("Measure", {static_cast<size_t>(i)}));
+  }
+
+  for (const std::string simType : {"matrix_product_state", "stabilizer"}) {
+    auto accelerator = xacc::getAccelerator(
+        "aer", {std::make_pair("sim-type", simType),
+                std::make_pair("shots", 1024),
+                std::make_pair("mps-max-bond-dimension", 4)});
+    auto buffer = xacc::qalloc(nQubits);
+    accelerator->execute(buffer, program);
+    const auto p0 =
+        buffer->computeMeasurementProbability(std::string(nQubits, '0'));
+    const auto p1 =
+        buffer->computeMeasurementProbability(std::string(nQubits, '1'));
+    EXPECT_NEAR(p0 + p1, 1.0, 1e-12);
+    EXPECT_NEAR(p0, 0.5, 0.1);
+  }
+}
+
 TEST(AerAcceleratorTester, checkConditional) {
   auto accelerator = xacc::getAccelerator("aer");
   xacc::set_verbose(true);
@@ -2,6 +2,7 @@
 #include <gtest/gtest.h>
 #include "xacc_service.hpp"
 #include "NoiseModel.hpp"
+#include "CommonGates.hpp"
 
 // Note: this test can only be run if having IBMQ credential.
 TEST(AerNoiseModelTester, checkSimple) {
@@ -52,6 +53,25 @@ TEST(AerNoiseModelTester, checkNoiseModelJson) {
   EXPECT_GT(buffer->computeMeasurementProbability("11"), 0.4);
 }
 
+TEST(AerNoiseModelTester, checkNoiseChannelTables) {
+  auto noiseModel = xacc::getService<xacc::NoiseModel>("IBM");
+  noiseModel->initialize({{"backend", "ibmq_ourense"}});
+  // Gates with the same universal equivalent share their channels.
+  xacc::quantum::X x(1);
+  xacc::quantum::Rx rx(1, 0.123);
+  const auto xChannels = noiseModel->getNoiseChannels(x);
+  const auto rxChannels = noiseModel->getNoiseChannels(rx);
+  EXPECT_EQ(xChannels.size(), rxChannels.size());
+  for (size_t i = 0; i < xChannels.size(); ++i) {
+    EXPECT_EQ(xChannels[i].noise_qubits, rxChannels[i].noise_qubits);
+    EXPECT_EQ(xChannels[i].mats, rxChannels[i].mats);
+  }
+  xacc::quantum::CNOT cx(std::vector<std::size_t>{0, 1});
+  EXPECT_EQ(noiseModel->getNoiseChannels(cx).size(), 2);
+  xacc::quantum::Measure meas(0);
+  EXPECT_TRUE(noiseModel->getNoiseChannels(meas).empty());
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize();
 
@@ -21,6 +21,7 @@
 #include "OQASMCompiler.hpp"
 #include "OQASMErrorListener.hpp"
 #include "OQASMToXACCListener.hpp"
+#include "AntlrParseCache.hpp"
 
 using namespace oqasm;
 using namespace antlr4;
@@ -28,26 +29,25 @@ using namespace antlr4;
 namespace xacc {
 
 namespace quantum {
+using OQASMParseCache = AntlrParseCache<OQASM2Lexer, OQASM2Parser>;
 
 OQASMCompiler::OQASMCompiler() = default;
 
 std::shared_ptr<IR> OQASMCompiler::compile(const std::string &src,
                                            std::shared_ptr<Accelerator> acc) {
-  ANTLRInputStream input(src);
-  OQASM2Lexer lexer(&input);
-  CommonTokenStream tokens(&lexer);
-  OQASM2Parser parser(&tokens);
-  parser.removeErrorListeners();
-  auto e = new OQASMErrorListener;
-  parser.addErrorListener(e);
+  OQASMErrorListener el;
+  auto parse = OQASMParseCache::instance().get(
+      src, [&](OQASMParseCache::Parse &p) {
+        p.parser.removeErrorListeners();
+        p.parser.addErrorListener(&el);
+        return p.parser.xaccsrc();
+      });
 
   auto ir = xacc::getService<IRProvider>("quantum")->createIR();
 
-  tree::ParseTree *tree = parser.xaccsrc();
   OQASMToXACCListener listener(ir);
-  tree::ParseTreeWalker::DEFAULT.walk(&listener, tree);
+  tree::ParseTreeWalker::DEFAULT.walk(&listener, parse->tree);
 
-  delete e;
   return ir;
   //   accelerator = acc;
   //   return compile(src);
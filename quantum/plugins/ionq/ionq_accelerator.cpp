@@ -18,6 +18,9 @@
 #include "ionq_program.hpp"
 #include "ionq_program_visitor.hpp"
 
+#include <algorithm>
+#include <bitset>
+#include <cmath>
 #include <regex>
 #include <thread>
 
@@ -53,23 +56,32 @@ const std::string IonQAccelerator::processInput(
   prog.set_shots(shots);
   prog.set_target(backend);
 
-  auto visitor = std::make_shared<IonQProgramVisitor>();
+  const auto toIonQ = [](std::shared_ptr<CompositeInstruction> function) {
+    auto visitor = std::make_shared<IonQProgramVisitor>();
 
-  InstructionIterator it(functions[0]);
-  while (it.hasNext()) {
-    auto nextInst = it.next();
-    if (nextInst->isEnabled()) {
-      nextInst->accept(visitor);
+    InstructionIterator it(function);
+    while (it.hasNext()) {
+      auto nextInst = it.next();
+      if (nextInst->isEnabled()) {
+        nextInst->accept(visitor);
+      }
     }
-  }
-
-  // After calling getExperiment, maxMemorySlots should be
-  // maxClassicalBit + 1
-  auto insts = visitor->getCircuitInstructions();
+    return visitor->getCircuitInstructions();
+  };
 
   xacc::ionq::Body b;
-  b.set_circuit(insts);
   b.set_qubits(buffer->size());
+  if (functions.size() == 1) {
+    b.set_circuit(toIonQ(functions[0]));
+  } else {
+    // Multi-circuit job
+    for (auto &function : functions) {
+      xacc::ionq::NamedCircuit circuit;
+      circuit.set_name(function->name());
+      circuit.set_circuit(toIonQ(function));
+      b.get_mutable_circuits().emplace_back(circuit);
+    }
+  }
 
   prog.set_body(b);
   using json = nlohmann::json;
@@ -81,28 +93,82 @@ const std::string IonQAccelerator::processInput(
 
 void IonQAccelerator::processResponse(std::shared_ptr<AcceleratorBuffer> buffer,
                                       const std::string &response) {
+  // Posted by RemoteAccelerator::execute()
+  watchJob(response, {buffer}, std::make_shared<ExecutionTimer>()).get();
+}
 
+std::future<void> IonQAccelerator::watchJob(
+    const std::string &response,
+    std::vector<std::shared_ptr<AcceleratorBuffer>> buffers,
+    std::shared_ptr<ExecutionTimer> timer) {
   using json = nlohmann::json;
-  xacc::ionq::IonQProgram root;
-  auto j = json::parse(response);
-
-  std::string jobId = j["id"].get<std::string>();
-  std::string msg;
-  bool jobCompleted = false;
-  while (!jobCompleted) {
-
-    msg = handleExceptionRestClientGet(url, "/jobs/" + jobId, headers);
-    j = json::parse(msg);
-    if (j["status"].get<std::string>() == "completed") {
-      jobCompleted = true;
+  const auto jobId = json::parse(response)["id"].get<std::string>();
+  auto status = std::make_shared<json>();
+  auto completed = RemoteJobPoller::instance()
+                       .watch([this, jobId, status, timer]() {
+                         auto msg = handleExceptionRestClientGet(
+                             url, "/jobs/" + jobId, headers);
+                         *status = json::parse(msg);
+                         const auto state =
+                             (*status)["status"].get<std::string>();
+                         if (state == "failed" || state == "canceled") {
+                           throw std::runtime_error("IonQ job " + jobId +
+                                                    " " + state + ".");
+                         }
+                         if (state == "running" || state == "completed") {
+                           timer->started();
+                         }
+                         return state == "completed";
+                       })
+                       .share();
+
+  // Results are stored by the thread waiting on the future
+  return std::async(std::launch::deferred, [this, jobId, status, buffers,
+                                            completed, timer]() {
+    try {
+      completed.get();
+    } catch (std::exception &e) {
+      xacc::error(e.what());
     }
+    storeResults(jobId, *status, buffers);
+    ExecutionMetrics metrics;
+    metrics.jobId = jobId;
+    metrics.nbCircuits = buffers.size();
+    metrics.nbShots = shots;
+    reportExecutionMetrics(timer->stop(metrics));
+  });
+}
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+void IonQAccelerator::storeResults(
+    const std::string &jobId, const nlohmann::json &status,
+    const std::vector<std::shared_ptr<AcceleratorBuffer>> &buffers) {
+  using json = nlohmann::json;
+  if (buffers.size() == 1 && status.count("data") &&
+      status["data"].count("histogram")) {
+    storeHistogram(buffers[0], status["data"]["histogram"]);
+    return;
   }
 
-  std::map<std::string, double> histogram =
-      j["data"]["histogram"].get<std::map<std::string, double>>();
+  // Histograms of a multi-circuit job, by child job id
+  auto results = json::parse(handleExceptionRestClientGet(
+      url, "/jobs/" + jobId + "/results", headers));
+  if (!status.count("children")) {
+    storeHistogram(buffers[0], results);
+    return;
+  }
+  const auto children = status["children"];
+  if (children.size() != buffers.size()) {
+    xacc::error("IonQ job " + jobId + " has " +
+                std::to_string(children.size()) + " circuits, expected " +
+                std::to_string(buffers.size()) + ".");
+  }
+  for (std::size_t i = 0; i < buffers.size(); ++i) {
+    storeHistogram(buffers[i], results[children[i].get<std::string>()]);
+  }
+}
 
+void IonQAccelerator::storeHistogram(std::shared_ptr<AcceleratorBuffer> buffer,
+                                     const nlohmann::json &histogram) {
   int n = buffer->size();
   auto getBitStrForInt = [&](std::uint64_t i) {
     std::stringstream s;
@@ -111,11 +177,75 @@ void IonQAccelerator::processResponse(std::shared_ptr<AcceleratorBuffer> buffer,
     return s.str();
   };
 
-  for (auto &kv : histogram) {
-    buffer->appendMeasurement(getBitStrForInt(std::stoi(kv.first)),
-                              std::ceil(kv.second * shots));
+  // The exact probabilities, and the Z expectation value from them
+  std::map<std::string, double> probabilities;
+  double expValZ = 0.0;
+  for (auto &kv : histogram.items()) {
+    const auto state = std::stoull(kv.key());
+    const auto probability = kv.value().get<double>();
+    const auto bitStr = getBitStrForInt(state);
+    probabilities[bitStr] = probability;
+    expValZ += (std::bitset<64>(state).count() % 2 ? -1.0 : 1.0) * probability;
+    if (histogramToCounts) {
+      buffer->appendMeasurement(bitStr, std::llround(probability * shots));
+    }
+  }
+  buffer->addExtraInfo("probabilities", probabilities);
+  buffer->addExtraInfo("exp-val-z", expValZ);
+}
+
+std::future<void> IonQAccelerator::executeAsync(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::shared_ptr<CompositeInstruction> circuit) {
+  auto timer = std::make_shared<ExecutionTimer>();
+  auto jsonPostStr = processInput(
+      buffer, std::vector<std::shared_ptr<CompositeInstruction>>{circuit});
+  auto responseStr =
+      handleExceptionRestClientPost(remoteUrl, postPath, jsonPostStr, headers);
+  return watchJob(responseStr, {buffer}, timer);
+}
+
+void IonQAccelerator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>> circuits) {
+  executeAsync(buffer, circuits).get();
+}
+
+std::future<void> IonQAccelerator::executeAsync(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>> circuits) {
+  // Multi-circuit jobs of up to maxCircuitsPerJob circuits, all posted up
+  // front and tracked together by the job poller.
+  std::vector<std::shared_ptr<AcceleratorBuffer>> childBuffers;
+  std::vector<std::future<void>> jobs;
+  const std::size_t jobSize = std::max(maxCircuitsPerJob, 1);
+  for (std::size_t begin = 0; begin < circuits.size(); begin += jobSize) {
+    const auto end = std::min(circuits.size(), begin + jobSize);
+    std::vector<std::shared_ptr<CompositeInstruction>> program(
+        circuits.begin() + begin, circuits.begin() + end);
+    std::vector<std::shared_ptr<AcceleratorBuffer>> jobBuffers;
+    for (auto &circuit : program) {
+      jobBuffers.emplace_back(
+          std::make_shared<AcceleratorBuffer>(circuit->name(), buffer->size()));
+    }
+    auto timer = std::make_shared<ExecutionTimer>();
+    auto jsonPostStr = processInput(buffer, program);
+    jobs.emplace_back(watchJob(handleExceptionRestClientPost(
+                                   remoteUrl, postPath, jsonPostStr, headers),
+                               jobBuffers, timer));
+    childBuffers.insert(childBuffers.end(), jobBuffers.begin(),
+                        jobBuffers.end());
   }
-  return;
+
+  return std::async(std::launch::deferred, [buffer, childBuffers,
+                                            jobs = std::move(jobs)]() mutable {
+    for (auto &job : jobs) {
+      job.get();
+    }
+    for (auto &childBuffer : childBuffers) {
+      buffer->appendChild(childBuffer->name(), childBuffer);
+    }
+  });
 }
 
 void IonQAccelerator::cancel() {}
@@ -14,6 +14,7 @@
 #define QUANTUM_GATE_ACCELERATORS_IONQACCELERATOR_HPP_
 
 #include "RemoteAccelerator.hpp"
+#include "json.hpp"
 
 #include <bitset>
 #include <type_traits>
@@ -33,10 +34,18 @@ public:
     if (config.stringExists("backend")) {
       backend = config.getString("backend");
     }
+    if (config.keyExists<int>("max-circuits-per-job")) {
+      maxCircuitsPerJob = config.get<int>("max-circuits-per-job");
+    }
+    if (config.keyExists<bool>("histogram-to-counts")) {
+      histogramToCounts = config.get<bool>("histogram-to-counts");
+    }
+    // Backoff and rate limit of the job status polls
+    RemoteJobPoller::instance().configure(config);
   }
 
   const std::vector<std::string> configurationKeys() override {
-    return {"shots", "backend"};
+    return {"shots", "backend", "max-circuits-per-job", "histogram-to-counts"};
   }
 
   HeterogeneousMap getProperties() override;
@@ -55,6 +64,23 @@ public:
   void processResponse(std::shared_ptr<AcceleratorBuffer> buffer,
                        const std::string &response) override;
 
+  // The circuits are submitted as multi-circuit jobs.
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::vector<std::shared_ptr<CompositeInstruction>>
+                   circuits) override;
+  using RemoteAccelerator::execute;
+
+  // Posts the job(s) before returning, only polling
+  // for completion is asynchronous.
+  std::future<void>
+  executeAsync(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::shared_ptr<CompositeInstruction> circuit) override;
+
+  std::future<void>
+  executeAsync(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::vector<std::shared_ptr<CompositeInstruction>>
+                   circuits) override;
+
   IonQAccelerator() : RemoteAccelerator() {}
 
   IonQAccelerator(std::shared_ptr<Client> client) : RemoteAccelerator(client) {}
@@ -66,6 +92,23 @@ private:
   void findApiKeyInFile(std::string &key, std::string &url,
                         const std::string &p);
 
+  // Tracks the job posted with that response, its results are stored in
+  // buffers (one per circuit) and its metrics reported when the future is
+  // waited on. timer was created before posting the job.
+  std::future<void>
+  watchJob(const std::string &response,
+           std::vector<std::shared_ptr<AcceleratorBuffer>> buffers,
+           std::shared_ptr<ExecutionTimer> timer);
+  // The results of the completed job of that status
+  void
+  storeResults(const std::string &jobId, const nlohmann::json &status,
+               const std::vector<std::shared_ptr<AcceleratorBuffer>> &buffers);
+  // The IonQ probabilities are stored as the "probabilities" (bit string to
+  // probability) and "exp-val-z" extra info, and as shot counts only with
+  // histogramToCounts.
+  void storeHistogram(std::shared_ptr<AcceleratorBuffer> buffer,
+                      const nlohmann::json &histogram);
+
   std::string currentApiToken;
 
   std::string url;
@@ -73,6 +116,9 @@ private:
   int shots = 1024;
   std::string backend = "simulator";
 
+  int maxCircuitsPerJob = 100;
+  bool histogramToCounts = false;
+
   bool jobIsRunning = false;
   std::string currentJobId = "";
 
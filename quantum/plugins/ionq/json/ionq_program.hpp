@@ -50,6 +50,24 @@ namespace ionq {
         void set_rotation(double value) { this->rotation = value; }
     };
 
+    // One of the circuits of a multi-circuit job
+    class NamedCircuit {
+        public:
+        NamedCircuit() = default;
+        virtual ~NamedCircuit() = default;
+
+        private:
+        std::string name;
+        std::vector<CircuitInstruction> circuit;
+
+        public:
+        const std::string & get_name() const { return name; }
+        void set_name(const std::string & value) { this->name = value; }
+
+        const std::vector<CircuitInstruction> & get_circuit() const { return circuit; }
+        void set_circuit(const std::vector<CircuitInstruction> & value) { this->circuit = value; }
+    };
+
     class Body {
         public:
         Body() = default;
@@ -58,6 +76,8 @@ namespace ionq {
         private:
         std::int64_t qubits;
         std::vector<CircuitInstruction> circuit;
+        // Multi-circuit job (instead of circuit) if not empty
+        std::vector<NamedCircuit> circuits;
 
         public:
         const int64_t & get_qubits() const { return qubits; }
@@ -67,6 +87,10 @@ namespace ionq {
         const std::vector<CircuitInstruction> & get_circuit() const { return circuit; }
         std::vector<CircuitInstruction> & get_mutable_circuit() { return circuit; }
         void set_circuit(const std::vector<CircuitInstruction> & value) { this->circuit = value; }
+
+        const std::vector<NamedCircuit> & get_circuits() const { return circuits; }
+        std::vector<NamedCircuit> & get_mutable_circuits() { return circuits; }
+        void set_circuits(const std::vector<NamedCircuit> & value) { this->circuits = value; }
     };
 
     class IonQProgram {
@@ -104,6 +128,9 @@ namespace nlohmann {
     void from_json(const json & j, xacc::ionq::CircuitInstruction & x);
     void to_json(json & j, const xacc::ionq::CircuitInstruction & x);
 
+    void from_json(const json & j, xacc::ionq::NamedCircuit & x);
+    void to_json(json & j, const xacc::ionq::NamedCircuit & x);
+
     void from_json(const json & j, xacc::ionq::Body & x);
     void to_json(json & j, const xacc::ionq::Body & x);
 
@@ -129,15 +156,34 @@ namespace nlohmann {
         }
     }
 
+    inline void from_json(const json & j, xacc::ionq::NamedCircuit& x) {
+        x.set_name(xacc::ionq::get_optional<std::string>(j, "name"));
+        x.set_circuit(j.at("circuit").get<std::vector<xacc::ionq::CircuitInstruction>>());
+    }
+
+    inline void to_json(json & j, const xacc::ionq::NamedCircuit & x) {
+        j = json::object();
+        j["name"] = x.get_name();
+        j["circuit"] = x.get_circuit();
+    }
+
     inline void from_json(const json & j, xacc::ionq::Body& x) {
         x.set_qubits(j.at("qubits").get<std::int64_t>());
+        if (j.find("circuits") != j.end()) {
+        x.set_circuits(j.at("circuits").get<std::vector<xacc::ionq::NamedCircuit>>());
+        } else {
         x.set_circuit(j.at("circuit").get<std::vector<xacc::ionq::CircuitInstruction>>());
+        }
     }
 
     inline void to_json(json & j, const xacc::ionq::Body & x) {
         j = json::object();
         j["qubits"] = x.get_qubits();
+        if (!x.get_circuits().empty()) {
+        j["circuits"] = x.get_circuits();
+        } else {
         j["circuit"] = x.get_circuit();
+        }
     }
 
     inline void from_json(const json & j, xacc::ionq::IonQProgram& x) {
@@ -54,6 +54,42 @@ TEST(IonQProgramTester, checkFromJson) {
 
 }
 
+TEST(IonQProgramTester, checkMultiCircuit) {
+  auto str = R"json({
+    "lang": "json",
+    "target": "qpu",
+    "shots": 100,
+    "body": {
+        "qubits": 2,
+        "circuits": [
+            {
+                "name": "bell",
+                "circuit": [
+                    {"gate": "h", "target": 0},
+                    {"gate": "cnot", "control": 0, "target": 1}
+                ]
+            },
+            {
+                "name": "x",
+                "circuit": [{"gate": "x", "target": 1}]
+            }
+        ]
+    }
+})json";
+  using json = nlohmann::json;
+  xacc::ionq::IonQProgram root;
+  from_json(json::parse(str), root);
+  EXPECT_EQ(2, root.get_body().get_circuits().size());
+  EXPECT_EQ("bell", root.get_body().get_circuits()[0].get_name());
+  EXPECT_EQ(2, root.get_body().get_circuits()[0].get_circuit().size());
+
+  json jj;
+  to_json(jj, root);
+  EXPECT_EQ(0, jj["body"].count("circuit"));
+  EXPECT_EQ(2, jj["body"]["circuits"].size());
+  EXPECT_EQ("x", jj["body"]["circuits"][1]["name"].get<std::string>());
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
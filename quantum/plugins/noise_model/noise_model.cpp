@@ -5,6 +5,7 @@
 #include <Eigen/Dense>
 #include "CommonGates.hpp"
 #include "Cloneable.hpp"
+#include <limits>
 
 namespace {
 constexpr double NUM_TOL = 1e-9;
@@ -75,13 +76,11 @@ cMatPair convertToMatOfPairs(const cMat &in_mat) {
 } // namespace
 
 namespace xacc {
+// The JSON is compiled on initialize() into per-gate tables of the channels,
+// already in the NoiseChannelKraus form of the simulators, so that the
+// per-gate (per-shot) getNoiseChannels queries are lookups.
 class JsonNoiseModel : public NoiseModel, public Cloneable<NoiseModel> {
 public:
-  struct KrausChannel {
-    std::vector<std::string> bit_locs;
-    std::vector<Eigen::MatrixXcd> matrix;
-  };
-
   // Identifiable interface impls
   const std::string name() const override { return "json"; }
   const std::string description() const override {
@@ -107,8 +106,10 @@ public:
       }
     }
 
-    // Debug:
-    // std::cout << "HOWDY: \n" << m_noiseModel.dump() << "\n";
+    m_gateNoise.clear();
+    m_qubitLabels.clear();
+    m_connectivity.clear();
+    m_roError.clear();
     const auto bit_order = m_noiseModel["bit_order"].get<std::string>();
     if (bit_order == "MSB") {
       m_bitOrder = KrausMatBitOrder::MSB;
@@ -126,6 +127,7 @@ public:
         const auto register_location =
             noise_info["register_location"].get<std::vector<std::string>>();
         const auto gateKey = createGateLookupKey(gate_name, register_location);
+        std::vector<size_t> gateBits;
         for (const auto &qLabel : register_location) {
           m_qubitLabels.emplace(qLabel);
         }
@@ -134,6 +136,9 @@ public:
           // We only support up to 2-q gate at the moment.
           xacc::error("Invalid data in 'register_location'.");
         }
+        for (const auto &qLabel : register_location) {
+          gateBits.emplace_back(std::stoi(qLabel));
+        }
 
         if (register_location.size() == 2) {
           const auto firstQ = std::stoi(register_location[0]);
@@ -150,17 +155,15 @@ public:
 
         // std::cout << "Process: " << gateKey << "\n";
         auto noise_channels = noise_info["noise_channels"];
-        std::vector<KrausChannel> noise_ops;
+        std::vector<NoiseChannelKraus> noise_ops;
         for (auto channel_iter = noise_channels.begin();
              channel_iter != noise_channels.end(); ++channel_iter) {
-          KrausChannel newOp;
           auto channel = *channel_iter;
-          if (channel.find("noise_qubits") != channel.end()) {
-            newOp.bit_locs =
-                channel["noise_qubits"].get<std::vector<std::string>>();
-          } else {
-            newOp.bit_locs = register_location;
-          }
+          const auto bit_locs =
+              (channel.find("noise_qubits") != channel.end())
+                  ? channel["noise_qubits"].get<std::vector<std::string>>()
+                  : register_location;
+          std::vector<Eigen::MatrixXcd> matrix;
 
           const auto op_mats =
               channel["matrix"]
@@ -168,7 +171,7 @@ public:
                       std::vector<std::vector<std::pair<double, double>>>>>();
           for (const auto &op_mat : op_mats) {
             const auto nbRows = op_mat.size();
-            if (nbRows != (1ULL << newOp.bit_locs.size())) {
+            if (nbRows != (1ULL << bit_locs.size())) {
               xacc::error("Kraus operator matrix dimension doesn't match the "
                           "number of qubits.");
             }
@@ -187,17 +190,26 @@ public:
               }
             }
 
-            newOp.matrix.emplace_back(mat);
+            matrix.emplace_back(mat);
           }
 
-          if (!validateKrausCPTP(newOp.matrix)) {
+          if (!validateKrausCPTP(matrix)) {
             xacc::error("The list of Kraus operators for gate " + gateKey +
                         " don't satisfy the CPTP condition.");
           }
-          noise_ops.emplace_back(newOp);
+          std::vector<size_t> bits;
+          for (const auto &regLabel : bit_locs) {
+            bits.emplace_back(std::stoi(regLabel));
+          }
+          decltype(NoiseChannelKraus::mats) krausMats;
+          for (const auto &op : matrix) {
+            krausMats.emplace_back(convertToStdMat(op));
+          }
+          noise_ops.emplace_back(
+              NoiseChannelKraus(bits, krausMats, m_bitOrder));
         }
 
-        m_gateNoise.emplace(gateKey, noise_ops);
+        m_gateNoise[gate_name].emplace(qubitsKey(gateBits), noise_ops);
       }
     }
 
@@ -217,6 +229,11 @@ public:
         m_roError[qubit] = std::make_pair(prob_meas0_prep1, prob_meas1_prep0);
       }
     }
+
+    m_roErrors.clear();
+    for (size_t i = 0; i < nQubits(); ++i) {
+      m_roErrors.emplace_back(readoutError(i));
+    }
   }
 
   virtual std::string toJson() const override {
@@ -240,7 +257,7 @@ public:
           {"u2", &gateU2}, {"u3", &gateU3}, {"id", &gateId}};
 
       for (const auto &[gateName, gate] : gateMap) {
-        const auto errorChannels = getNoiseChannels(*gate);
+        const auto &errorChannels = noiseChannels(*gate);
         for (auto &errorChannel : errorChannels) {
           nlohmann::json element;
           element["type"] = "qerror";
@@ -280,7 +297,7 @@ public:
       xacc::quantum::CNOT gateCX2(q2, q1);
       std::vector<xacc::quantum::CNOT> gatePair{gateCX1, gateCX2};
       for (auto &gate : gatePair) {
-        const auto errorChannels = getNoiseChannels(gate);
+        const auto &errorChannels = noiseChannels(gate);
         for (auto &errorChannel : errorChannels) {
           nlohmann::json element;
           element["type"] = "qerror";
@@ -336,47 +353,27 @@ public:
   }
 
   virtual std::vector<RoErrors> readoutErrors() const override {
-    std::vector<RoErrors> result;
-    for (size_t i = 0; i < nQubits(); ++i) {
-      result.emplace_back(readoutError(i));
-    }
-
-    return result;
+    return m_roErrors;
   }
 
   virtual std::vector<NoiseChannelKraus>
   getNoiseChannels(xacc::quantum::Gate &gate) const override {
-    std::string gateKey = gate.name() + "_" + std::to_string(gate.bits()[0]);
-    if (gate.bits().size() > 1) {
-      for (int i = 1; i < gate.bits().size(); ++i) {
-        gateKey += ("_" + std::to_string(gate.bits()[i]));
-      }
-    }
-    const auto iter = m_gateNoise.find(gateKey);
-    // Cannot find the noise info:
-    if (iter == m_gateNoise.end()) {
-      // std::cout << "Failed to find noise configuration for gate "
-      //           << gate.toString() << "\n";
-      // Just assume no noise.
-      return {};
-    }
+    return noiseChannels(gate);
+  }
 
-    const auto noiseChans = iter->second;
-    std::vector<NoiseChannelKraus> result;
-    for (const auto &chan : noiseChans) {
-      std::vector<size_t> bits;
-      for (const auto &regLabel : chan.bit_locs) {
-        bits.emplace_back(std::stoi(regLabel));
-      }
-      decltype(NoiseChannelKraus::mats) krausMats;
-      for (const auto &op : chan.matrix) {
-        krausMats.emplace_back(convertToStdMat(op));
-      }
-      result.emplace_back(NoiseChannelKraus(bits, krausMats, m_bitOrder));
+  // The table entry of the gate, empty if the model has no noise info for it
+  // (i.e. assume no noise).
+  const std::vector<NoiseChannelKraus> &
+  noiseChannels(xacc::quantum::Gate &gate) const {
+    static const std::vector<NoiseChannelKraus> noChannels;
+    const auto gateIter = m_gateNoise.find(gate.name());
+    if (gateIter == m_gateNoise.end()) {
+      return noChannels;
     }
-    return result;
+    const auto iter = gateIter->second.find(qubitsKey(gate.bits()));
+    return (iter == gateIter->second.end()) ? noChannels : iter->second;
   }
-  
+
   // Query Fidelity information:
   virtual size_t nQubits() const override { return m_qubitLabels.size(); }
   
@@ -408,15 +405,29 @@ private:
     return result;
   }
 
+  // Qubits of a (1 or 2-qubit) gate as a single integer key
+  static uint64_t qubitsKey(const std::vector<size_t> &in_bits) {
+    if (in_bits.empty() || in_bits.size() > 2) {
+      return std::numeric_limits<uint64_t>::max();
+    }
+    return (uint64_t(in_bits[0]) << 32) |
+           (in_bits.size() == 2 ? uint64_t(in_bits[1]) + 1 : 0);
+  }
+
 private:
   nlohmann::json m_noiseModel;
   KrausMatBitOrder m_bitOrder;
-  std::unordered_map<std::string, std::vector<KrausChannel>> m_gateNoise;
+  // Gate name -> qubits key -> noise channels
+  std::unordered_map<std::string,
+                     std::unordered_map<uint64_t, std::vector<NoiseChannelKraus>>>
+      m_gateNoise;
   std::set<std::string> m_qubitLabels;
   // Track pairs of qubits that have 2-q noise channels.
   std::set<std::pair<int, int>> m_connectivity;
   // Readout error: pair of meas0Prep1, meas1Prep0
   std::unordered_map<size_t, RoErrors> m_roError;
+  // readoutErrors() of qubits 0..nQubits()-1
+  std::vector<RoErrors> m_roErrors;
 };
 } // namespace xacc
 
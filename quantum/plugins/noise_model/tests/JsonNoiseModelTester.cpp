@@ -4,6 +4,7 @@
 #include "NoiseModel.hpp"
 #include "PauliOperator.hpp"
 #include "xacc_observable.hpp"
+#include "CommonGates.hpp"
 
 namespace {
 // A sample Json for testing
@@ -103,6 +104,27 @@ TEST(JsonNoiseModelTester, checkSimple) {
   }
 }
 
+TEST(JsonNoiseModelTester, checkNoiseChannelLookup) {
+  auto noiseModel = xacc::getService<xacc::NoiseModel>("json");
+  noiseModel->initialize({{"noise-model", msb_noise_model}});
+  xacc::quantum::CNOT cx01(0, 1);
+  xacc::quantum::CNOT cx10(1, 0);
+  xacc::quantum::X x0(0);
+  const auto channels = noiseModel->getNoiseChannels(cx01);
+  EXPECT_EQ(channels.size(), 1);
+  EXPECT_EQ(channels[0].noise_qubits, (std::vector<size_t>{0, 1}));
+  EXPECT_EQ(channels[0].mats.size(), 4);
+  EXPECT_EQ(channels[0].mats[0].size(), 4);
+  EXPECT_NEAR(std::real(channels[0].mats[0][0][0]), 0.99498743710662, 1e-12);
+  EXPECT_TRUE(noiseModel->getNoiseChannels(cx10).empty());
+  EXPECT_TRUE(noiseModel->getNoiseChannels(x0).empty());
+
+  // Re-initialization replaces the tables.
+  noiseModel->initialize({{"noise-model", ad_json}});
+  EXPECT_TRUE(noiseModel->getNoiseChannels(cx01).empty());
+  EXPECT_EQ(noiseModel->getNoiseChannels(x0).size(), 1);
+}
+
 TEST(JsonNoiseModelTester, checkBitOrdering) {
   auto xasmCompiler = xacc::getCompiler("xasm");
   auto program = xasmCompiler
@@ -1,7 +1,9 @@
 #include "qubit_tapering.hpp"
 
 #include <armadillo>
+#include <bitset>
 #include <iomanip>
+#include <unordered_set>
 
 #include "FermionOperator.hpp"
 #include "xacc_observable.hpp"
@@ -9,6 +11,12 @@
 #include "xacc_service.hpp"
 #include "xacc.hpp"
 
+namespace {
+// Below this many terms, U^dagger H U is computed serially.
+constexpr size_t PARALLEL_MIN_TERMS = 256;
+constexpr size_t MAX_CACHED_BASES = 64;
+}  // namespace
+
 namespace xacc {
 
 template <typename T>
@@ -16,12 +24,19 @@ bool ptr_is_a(std::shared_ptr<Observable> ptr) {
   return std::dynamic_pointer_cast<T>(ptr) != nullptr;
 }
 std::shared_ptr<xacc::Observable> QubitTapering::transform(
-    std::shared_ptr<xacc::Observable> Hptr_input) {
+    std::shared_ptr<xacc::Observable> Hptr_input,
+    const HeterogeneousMap &options) {
 
   // First we pre-process the observable to a PauliOperator
   auto obs_str = Hptr_input->toString();
-  auto fermi_to_pauli = xacc::getService<xacc::ObservableTransform>("jw");
+  const std::string fermionTransform =
+      options.stringExists("fermion-transform")
+          ? options.getString("fermion-transform")
+          : "jw";
+  auto fermi_to_pauli =
+      xacc::getService<xacc::ObservableTransform>(fermionTransform);
   std::shared_ptr<xacc::Observable> Hptr;
+  bool isFermionic = true;
   if (ptr_is_a<FermionOperator>(Hptr_input)) {  
     Hptr = fermi_to_pauli->transform(Hptr_input);
   } else if (obs_str.find("^") != std::string::npos) {
@@ -29,158 +44,34 @@ std::shared_ptr<xacc::Observable> QubitTapering::transform(
     Hptr = fermi_to_pauli->transform(fermionObservable);
   } else if (ptr_is_a<PauliOperator>(Hptr_input)) {
     Hptr = Hptr_input;
+    isFermionic = false;
   } else if (obs_str.find("X") != std::string::npos ||
              obs_str.find("Y") != std::string::npos ||
              obs_str.find("Z") != std::string::npos) {
     Hptr = xacc::quantum::getObservable("pauli", obs_str);
+    isFermionic = false;
   } else {
     xacc::error("[Qubit Tapering] Error, cannot cast incoming Observable ptr to something we can process.");
   }
 
   // Convert the IR into a Hamiltonian
   PauliOperator &H = dynamic_cast<PauliOperator &>(*Hptr.get());
+  if (isFermionic && fermionTransform == "parity") {
+    // The symmetries of the parity mapping are known
+    return parityReduction(H);
+  }
 
   auto n = H.nQubits();
   int counter = 0;
 
-  // Compute Tableaux of the hamiltonian,
-  // This is the E matrix from arxiv:1701.08213
-  Eigen::MatrixXi tableaux = computeTableaux(H, n);
-  std::vector<int> pivotCols;
-
-  // Convert tableaux to rref
-  Eigen::MatrixXi b = gauss(tableaux, pivotCols);
-
-  // Get linear independent vectors from rref
-  int ker_dim = 2 * n - pivotCols.size();
-  Eigen::MatrixXi linIndVecs(pivotCols.size(), 2 * n);
-  linIndVecs.setZero();
-  std::vector<std::vector<int>> linIndVecsVector;
-  for (int i = 0; i < pivotCols.size(); i++) {
-    linIndVecs.row(i) = b.row(i);
-  }
-
-  // Build up the symmetry group generators
-  std::vector<int> zero(2 * n);
-  std::set<std::vector<int>> generators, generated;
-  generated.insert(zero);
-
-  // Get all g_z (combinations of nqubit 1s and 0s)
-  auto combinations = generateCombinations(n);
-
-  // Lambda to compute the union of 2 sets
-  auto getUnion = [](const std::set<std::vector<int>> &a,
-                     const std::set<std::vector<int>> &b) {
-    std::set<std::vector<int>> result = a;
-    result.insert(b.begin(), b.end());
-    return result;
-  };
-
-  // Loop over the g_z 0s and 1s combinations
-  for (auto &gz : combinations) {
-    std::vector<int> tau(n);
-    tau.insert(tau.end(), gz.begin(), gz.end());
-
-    if (generated.find(tau) != generated.end()) {
-      continue;
-    } else {
-      int sum = 0;
-      for (int i = 0; i < linIndVecs.rows(); i++) {
-        Eigen::VectorXi row = linIndVecs.row(i);
-        std::vector<int> h(2 * n);
-        Eigen::VectorXi::Map(&h[0], 2 * n) = row;
-        sum += binaryVectorInnerProduct(tau, h);
-      }
-
-      if (sum == 0) {
-        generators.insert(tau);
-        counter++;
-
-        if (counter == ker_dim) break;
-
-        for (auto &g : generators) {
-          std::vector<int> s(2 * n);
-          for (int i = 0; i < 2 * n; i++) {
-            s[i] = (tau[i] + g[i]) % 2;
-          }
-
-          std::set<std::vector<int>> unionSet = getUnion(generators, generated);
-          if (unionSet.find(s) == unionSet.end()) {
-            generated.insert(s);
-          }
-        }
-      }
-    }
-  }
-
-  // Create the tau generators
-  std::vector<PauliOperator> taus;
-  for (auto &g : generators) {
-    std::map<int, std::string> terms;
-    for (int i = 0; i < 2 * n; i++) {
-      if (g[i] == 1) {
-        if (i < n) {
-          terms.insert({i, "X"});
-        } else {
-          terms.insert({i - n, "Z"});
-        }
-      }
-    }
-    taus.emplace_back(terms);
-  }
-
-  //   for (auto t : taus) std::cout << "GEN: " << t.toString() << "\n";
-
-  // Lambda to compute hermitian conjugate of PauliOperator
-  auto hc = [](PauliOperator &op) {
-    PauliOperator newOp = op;
-    for (auto &kv : newOp) {
-      kv.second.coeff() = std::conj(kv.second.coeff());
-    }
-    return newOp;
-  };
-
-  // Compute U = U1 U2 U3 ...
-  double invSqrt2 = 1.0 / std::sqrt(2.0);
-  PauliOperator U(1.0);
-  for (auto &t : taus) {
-    int i = t.getTerms().begin()->second.ops().begin()->first;
-    U *= (t + PauliOperator({{i, "X"}})) * invSqrt2;
-    U *= (PauliOperator({{i, "X"}}) + PauliOperator({{i, "Z"}})) *
-         (1.0 / std::sqrt(2));
-  }
+  // The symmetry generators, U and the kept sites only depend on the Pauli
+  // strings of H, and are cached across calls
+  const auto basis = getSymmetryBasis(H, n);
+  const std::set<int> &phase_sites = basis->phaseSites;
+  const std::set<int> &keep_sites = basis->keepSites;
 
   // Use U to compute HPrime
-  PauliOperator HPrime = hc(U) * H * U;
-
-  // Compute rref of HPrime
-  Eigen::MatrixXi hPrimeTableaux = computeTableaux(HPrime, n);
-  std::vector<int> hPrimePivotCols;
-  Eigen::MatrixXi b2 = gauss(hPrimeTableaux, hPrimePivotCols);
-
-  // Convert to hPrimePivotCols vector to a set
-  std::set<int> hPrimePivotColsSet(hPrimePivotCols.begin(),
-                                   hPrimePivotCols.end()),
-      doubleNSet, nSet;
-
-  // Generate range(2*n)
-  for (int i = 0; i < 2 * n; i++) doubleNSet.insert(i);
-
-  // Generate range(n)
-  for (int i = 0; i < n; i++) nSet.insert(i);
-
-  // Create the phase_sites set which is the difference between
-  // range(2*nQ) and the hPrimePivotSet
-  std::set<int> phase_sites, keep_sites;
-  std::set_difference(doubleNSet.begin(), doubleNSet.end(),
-                      hPrimePivotColsSet.begin(), hPrimePivotColsSet.end(),
-                      std::inserter(phase_sites, phase_sites.end()));
-
-  // Create the keep_sites set, i.e. the qubit sites we
-  // are keeping in the reduction
-  std::set_difference(nSet.begin(), nSet.end(), phase_sites.begin(),
-                      phase_sites.end(),
-                      std::inserter(keep_sites, keep_sites.end()));
+  PauliOperator HPrime = applyCliffords(H, basis->cliffords);
 
   // Generate all 1s and 0s of list size phase_sites.size(), map
   // all 0s to -1s.
@@ -270,6 +161,261 @@ std::shared_ptr<xacc::Observable> QubitTapering::transform(
   //   return newIR;
 }
 
+std::shared_ptr<xacc::Observable>
+QubitTapering::parityReduction(PauliOperator &H) {
+  const int n = H.nQubits();
+  if (n < 2 || n % 2 != 0) {
+    xacc::error("[Qubit Tapering] The parity reduction requires an even "
+                "number of spin orbitals.");
+  }
+  const int alphaSite = n / 2 - 1, totalSite = n - 1;
+  for (auto &kv : H) {
+    for (auto &termKv : kv.second.ops()) {
+      if ((termKv.first == alphaSite || termKv.first == totalSite) &&
+          termKv.second != "Z" && termKv.second != "I") {
+        xacc::error("[Qubit Tapering] The Hamiltonian doesn't conserve the "
+                    "parity of the spin-up and of all the orbitals (the "
+                    "spin-up orbitals are expected first).");
+      }
+    }
+  }
+
+  std::map<int, int> keepSites2Logical;
+  int counter = 0;
+  for (int i = 0; i < n; i++) {
+    if (i != alphaSite && i != totalSite) {
+      keepSites2Logical.insert({i, counter++});
+    }
+  }
+
+  std::shared_ptr<PauliOperator> actualReduced;
+  double energy = 0.0;
+  for (int alphaPhase : {-1, 1}) {
+    for (int totalPhase : {-1, 1}) {
+      auto reduced = std::make_shared<PauliOperator>();
+      for (auto &kv : H) {
+        auto term = kv.second;
+        std::map<int, std::string> newTerm;
+        double phase = 1.0;
+        for (auto &termKv : term.ops()) {
+          if (termKv.first == alphaSite) {
+            phase *= termKv.second == "Z" ? alphaPhase : 1;
+          } else if (termKv.first == totalSite) {
+            phase *= termKv.second == "Z" ? totalPhase : 1;
+          } else {
+            newTerm.insert(termKv);
+          }
+        }
+        reduced->operator+=(PauliOperator(newTerm, phase * term.coeff()));
+      }
+      reduced->mapQubitSites(keepSites2Logical);
+
+      const auto reducedEnergy = computeGroundStateEnergy(*reduced, n - 2);
+      if (!actualReduced || reducedEnergy < energy) {
+        energy = reducedEnergy;
+        actualReduced = reduced;
+      }
+    }
+  }
+
+  std::stringstream s;
+  s << std::setprecision(12) << energy;
+  xacc::info("Reduced Hamiltonian:" + actualReduced->toString() +
+             ", with energy = " + s.str());
+  return actualReduced;
+}
+
+std::shared_ptr<const QubitTapering::SymmetryBasis>
+QubitTapering::getSymmetryBasis(PauliOperator &H, const int n) {
+  if (n > 63) {
+    xacc::error("[Qubit Tapering] The symmetry search supports at most 63 "
+                "qubits.");
+  }
+  std::vector<SymplecticPauli> paulis;
+  std::vector<std::pair<uint64_t, uint64_t>> masks;
+  for (auto &kv : H) {
+    SymplecticPauli pauli(kv.second.ops());
+    if (!pauli.isIdentity()) {
+      masks.emplace_back(pauli.xWords()[0], pauli.zWords()[0]);
+      paulis.emplace_back(std::move(pauli));
+    }
+  }
+  std::sort(masks.begin(), masks.end());
+  std::vector<uint64_t> key{static_cast<uint64_t>(n)};
+  for (auto &[x, z] : masks) {
+    key.emplace_back(x);
+    key.emplace_back(z);
+  }
+
+  std::lock_guard<std::mutex> guard(cacheLock);
+  auto iter = symmetryCache.find(key);
+  if (iter != symmetryCache.end()) {
+    return iter->second;
+  }
+
+  // Compute Tableaux of the hamiltonian,
+  // This is the E matrix from arxiv:1701.08213,
+  // and its linearly independent rows
+  BinaryMatrix linIndVecs = computeTableaux(paulis, n);
+  std::vector<int> pivotCols;
+  const int ker_dim = 2 * n - gauss(linIndVecs, 2 * n, pivotCols);
+
+  // Build up the symmetry group generators tau = Z^g (bit q of g is qubit
+  // q), commuting with a row iff g . x is even. The g are searched by
+  // number of ones, then in lexicographic order (qubit 0 first), and the
+  // generators are kept in that lexicographic order.
+  const auto lexLess = [](uint64_t a, uint64_t b) {
+    const uint64_t diff = a ^ b;
+    return (b & diff & (~diff + 1)) != 0;
+  };
+  std::set<uint64_t, decltype(lexLess)> generators(lexLess);
+  std::unordered_set<uint64_t> generated{0};
+  const uint64_t xMask = (1ULL << n) - 1;
+  int counter = 0;
+  bool done = false;
+  for (int nOnes = 1; nOnes <= n && !done; nOnes++) {
+    // Gosper's hack on the bit-reversed g: lexicographic order
+    for (uint64_t r = (1ULL << nOnes) - 1; r <= xMask;) {
+      uint64_t g = 0;
+      for (int i = 0; i < n; i++) {
+        g |= ((r >> (n - 1 - i)) & 1ULL) << i;
+      }
+      const uint64_t lowest = r & (~r + 1);
+      const uint64_t ripple = r + lowest;
+      r = (((ripple ^ r) >> 2) / lowest) | ripple;
+
+      if (generated.count(g)) {
+        continue;
+      }
+      bool commutes = true;
+      for (auto &row : linIndVecs) {
+        if (std::bitset<64>(g & row[0] & xMask).count() % 2 != 0) {
+          commutes = false;
+          break;
+        }
+      }
+      if (commutes) {
+        generators.insert(g);
+        counter++;
+
+        if (counter == ker_dim) {
+          done = true;
+          break;
+        }
+
+        for (auto &other : generators) {
+          generated.insert(g ^ other);
+        }
+      }
+    }
+  }
+
+  // Compute U = U1 U2 U3 ..., with Ui = (tau + X_i) / sqrt(2) (X_i on the
+  // first qubit of tau) followed by the Hadamard (X_i + Z_i) / sqrt(2)
+  auto basis = std::make_shared<SymmetryBasis>();
+  const auto addFactor = [&](SymplecticPauli a, SymplecticPauli b) {
+    CliffordFactor factor;
+    factor.abPhase = SymplecticPauli::multiply(a, b, factor.ab);
+    factor.a = std::move(a);
+    factor.b = std::move(b);
+    basis->cliffords.emplace_back(std::move(factor));
+  };
+  for (auto &g : generators) {
+    const uint64_t first = g & (~g + 1);
+    const SymplecticPauli tau({0}, {g}), x({first}, {0}), z({0}, {first});
+    addFactor(tau, x);
+    addFactor(x, z);
+  }
+
+  // Compute rref of HPrime (the image of each Pauli string)
+  for (auto &pauli : paulis) {
+    for (auto &factor : basis->cliffords) {
+      conjugate(factor, pauli);
+    }
+  }
+  BinaryMatrix hPrimeTableaux = computeTableaux(paulis, n);
+  std::vector<int> hPrimePivotCols;
+  gauss(hPrimeTableaux, 2 * n, hPrimePivotCols);
+
+  // Convert to hPrimePivotCols vector to a set
+  std::set<int> hPrimePivotColsSet(hPrimePivotCols.begin(),
+                                   hPrimePivotCols.end());
+
+  // Create the phase_sites set which is the difference between
+  // range(2*nQ) and the hPrimePivotSet
+  for (int i = 0; i < 2 * n; i++) {
+    if (!hPrimePivotColsSet.count(i)) {
+      basis->phaseSites.insert(i);
+    }
+  }
+
+  // Create the keep_sites set, i.e. the qubit sites we
+  // are keeping in the reduction
+  for (int i = 0; i < n; i++) {
+    if (!basis->phaseSites.count(i)) {
+      basis->keepSites.insert(i);
+    }
+  }
+
+  // Bound the cache, e.g. for long-running scans over many molecules
+  if (symmetryCache.size() >= MAX_CACHED_BASES) {
+    symmetryCache.clear();
+  }
+  symmetryCache.emplace(std::move(key), basis);
+  return basis;
+}
+
+int QubitTapering::conjugate(const CliffordFactor &factor,
+                             SymplecticPauli &io_pauli) {
+  // U P U = P if P commutes with A and B, -P if it commutes with neither,
+  // P A B if it only commutes with A, and -P A B if it only commutes with B.
+  const bool commutesA = io_pauli.commutes(factor.a);
+  const bool commutesB = io_pauli.commutes(factor.b);
+  if (commutesA == commutesB) {
+    return commutesA ? 0 : 2;
+  }
+  SymplecticPauli product;
+  const int phase = SymplecticPauli::multiply(io_pauli, factor.ab, product);
+  io_pauli = std::move(product);
+  return (phase + factor.abPhase + (commutesA ? 0 : 2)) % 4;
+}
+
+PauliOperator
+QubitTapering::applyCliffords(PauliOperator &H,
+                              const std::vector<CliffordFactor> &cliffords) {
+  struct ConjugatedTerm {
+    SymplecticPauli pauli;
+    std::complex<double> coeff;
+    std::string var;
+  };
+  std::vector<ConjugatedTerm> terms;
+  for (auto &kv : H) {
+    terms.push_back({SymplecticPauli(kv.second.ops()), kv.second.coeff(),
+                     kv.second.var()});
+  }
+
+  const std::complex<double> phases[4] = {{1.0, 0.0}, {0.0, 1.0}, {-1.0, 0.0},
+                                          {0.0, -1.0}};
+  const auto conjugateTerms = [&](size_t beginIdx, size_t endIdx) {
+    for (size_t i = beginIdx; i < endIdx; i++) {
+      for (auto &factor : cliffords) {
+        terms[i].coeff *= phases[conjugate(factor, terms[i].pauli)];
+      }
+    }
+  };
+  if (terms.size() >= PARALLEL_MIN_TERMS && xacc::isInitialized()) {
+    xacc::getTaskScheduler()->parallelFor(0, terms.size(), conjugateTerms);
+  } else {
+    conjugateTerms(0, terms.size());
+  }
+
+  PauliOperator HPrime;
+  for (auto &term : terms) {
+    HPrime += PauliOperator(term.pauli.toOps(), term.coeff, term.var);
+  }
+  return HPrime;
+}
+
 const double QubitTapering::computeGroundStateEnergy(PauliOperator &op,
                                                      const int n) {
   auto n_qubits = op.nQubits();
@@ -346,29 +492,30 @@ const double QubitTapering::computeGroundStateEnergy(PauliOperator &op,
   return reducedEnergy;
 }
 
-Eigen::MatrixXi QubitTapering::computeTableaux(PauliOperator &H, const int n) {
-  int nRows = 0;
-  Eigen::MatrixXi tableaux;
-  for (auto &term : H) {
-    Eigen::VectorXi x(n), z(n), row(2 * n);
-    auto p = term.second.toBinaryVector(n);
-    int c = 0;
-    for (auto &i : p.first) {
-      z(c) = i;
-      c++;
-    }
-    c = 0;
-    for (auto &i : p.second) {
-      x(c) = i;
-      c++;
+QubitTapering::BinaryMatrix
+QubitTapering::computeTableaux(const std::vector<SymplecticPauli> &paulis,
+                               const int n) {
+  // Columns x_0 ... x_{n-1} z_0 ... z_{n-1}, n <= 63
+  const size_t nWords = (2 * n + 63) / 64;
+  const auto setColumn = [](std::vector<uint64_t> &row, const int col) {
+    row[col / 64] |= 1ULL << (col % 64);
+  };
+  BinaryMatrix tableaux;
+  for (auto &pauli : paulis) {
+    if (pauli.isIdentity()) {
+      continue;
     }
-
-    row << x, z;
-    if (row != Eigen::VectorXi::Zero(2 * n)) {
-      nRows++;
-      tableaux.conservativeResize(nRows, 2 * n);
-      tableaux.row(nRows - 1) = row;
+    std::vector<uint64_t> row(nWords, 0);
+    const uint64_t x = pauli.xWords()[0], z = pauli.zWords()[0];
+    for (int i = 0; i < n; i++) {
+      if ((x >> i) & 1ULL) {
+        setColumn(row, i);
+      }
+      if ((z >> i) & 1ULL) {
+        setColumn(row, n + i);
+      }
     }
+    tableaux.emplace_back(std::move(row));
   }
   return tableaux;
 }
@@ -393,65 +540,35 @@ std::vector<std::vector<int>> QubitTapering::generateCombinations(
   return combinations;
 }
 
-int QubitTapering::binaryVectorInnerProduct(std::vector<int> &bv1,
-                                            std::vector<int> &bv2) {
-  std::vector<int> ax(bv1.begin(), bv1.begin() + bv1.size() / 2);
-  std::vector<int> az(bv1.begin() + bv1.size() / 2, bv1.begin() + bv1.size());
-  std::vector<int> bx(bv2.begin(), bv2.begin() + bv2.size() / 2);
-  std::vector<int> bz(bv2.begin() + bv2.size() / 2, bv2.begin() + bv2.size());
-  Eigen::VectorXi axv = Eigen::Map<Eigen::VectorXi>(ax.data(), ax.size());
-  Eigen::VectorXi azv = Eigen::Map<Eigen::VectorXi>(az.data(), az.size());
-  Eigen::VectorXi bxv = Eigen::Map<Eigen::VectorXi>(bx.data(), bx.size());
-  Eigen::VectorXi bzv = Eigen::Map<Eigen::VectorXi>(bz.data(), bz.size());
-  return (axv.dot(bzv) + azv.dot(bxv)) % 2;
-}
-
-Eigen::MatrixXi QubitTapering::gauss(Eigen::MatrixXi &A,
-                                     std::vector<int> &pivotCols) {
-  int n = A.rows();
-  int m = A.cols();
-
-  int sc = 0;
-
-  for (int i = 0; i < m; i++) {
-    bool found_row = false;
-    int ip = i - sc;
-    for (int k = ip; k < n; k++) {
-      if (A(k, i) == 1) {
-        found_row = true;
-
-        if (k > ip) {
-          for (int j = i; j < m; j++) {
-            auto tmp = A(k, j);
-            A(k, j) = A(ip, j);
-            A(ip, j) = tmp;
-          }
-        }
-
-        for (int l = ip + 1; l < n; l++) {
-          if (A(l, i) != 0) {
-            for (int j = ip; j < m; j++) {
-              A(l, j) = (A(l, j) + A(ip, j)) % 2;
-            }
-          }
+int QubitTapering::gauss(BinaryMatrix &A, const int nCols,
+                         std::vector<int> &pivotCols) {
+  // GF(2) elimination, a whole word of columns per XOR
+  size_t rank = 0;
+  for (int col = 0; col < nCols && rank < A.size(); col++) {
+    const size_t word = col / 64;
+    const uint64_t bit = 1ULL << (col % 64);
+    size_t pivot = rank;
+    while (pivot < A.size() && !(A[pivot][word] & bit)) {
+      pivot++;
+    }
+    if (pivot == A.size()) {
+      continue;
+    }
+    std::swap(A[rank], A[pivot]);
+    for (size_t row = rank + 1; row < A.size(); row++) {
+      if (A[row][word] & bit) {
+        for (size_t j = word; j < A[row].size(); j++) {
+          A[row][j] ^= A[rank][j];
         }
-        break;
       }
     }
-    if (!found_row) sc += 1;
-  }
-
-  unsigned row2 = 0;
-  for (unsigned col = 0; col < A.cols() && row2 < A.rows(); col++) {
-    if (std::fabs(A(row2, col)) < 1e-12) continue;
-
     pivotCols.push_back(col);
-    row2++;
+    rank++;
   }
-
-  return A;
+  A.resize(rank);
+  return rank;
 }
 
 }  // namespace xacc
 
-REGISTER_PLUGIN(xacc::QubitTapering, xacc::ObservableTransform)
\ No newline at end of file
+REGISTER_PLUGIN(xacc::QubitTapering, xacc::ObservableTransform)
@@ -1,9 +1,12 @@
 #pragma once
 
-#include <Eigen/Dense>
+#include <map>
+#include <mutex>
+#include <set>
 
 #include "ObservableTransform.hpp"
 #include "PauliOperator.hpp"
+#include "SymplecticPauli.hpp"
 
 using namespace xacc::quantum;
 
@@ -13,7 +16,16 @@ class QubitTapering : public xacc::ObservableTransform {
  public:
   QubitTapering() = default;
   std::shared_ptr<xacc::Observable> transform(
-      std::shared_ptr<xacc::Observable> obs) override;
+      std::shared_ptr<xacc::Observable> obs) override {
+    return transform(obs, {});
+  }
+  // Options:
+  //  - "fermion-transform" (string): mapping of fermionic observables,
+  //    "jw" by default. With "parity", the two parity qubits (spin-up and
+  //    total) are removed directly instead of searching the symmetries.
+  std::shared_ptr<xacc::Observable> transform(
+      std::shared_ptr<xacc::Observable> obs,
+      const HeterogeneousMap &options) override;
 
   const std::string name() const override { return "qubit-tapering"; }
   const std::string description() const override {
@@ -21,14 +33,51 @@ class QubitTapering : public xacc::ObservableTransform {
   }
 
  private:
-  Eigen::MatrixXi computeTableaux(PauliOperator &H, const int nQubits);
+  // Bit-packed binary matrix, one vector of words per row
+  using BinaryMatrix = std::vector<std::vector<uint64_t>>;
+  // U = (A + B) / sqrt(2) for anticommuting Pauli strings A and B, so that
+  // U P U is a single Pauli string for any P.
+  struct CliffordFactor {
+    SymplecticPauli a, b;
+    // a * b = i^abPhase ab
+    SymplecticPauli ab;
+    int abPhase;
+  };
+  // What only depends on the Pauli strings of the Hamiltonian, not on their
+  // coefficients: computed once for e.g. all the bond lengths of a molecule.
+  struct SymmetryBasis {
+    // U = F_1 F_2 ... built from the Z2 symmetry generators
+    std::vector<CliffordFactor> cliffords;
+    // Sites of U^dagger H U fixed to +-1, and the kept ones
+    std::set<int> phaseSites, keepSites;
+  };
+
+  std::shared_ptr<const SymmetryBasis> getSymmetryBasis(PauliOperator &H,
+                                                        const int nQubits);
+  // U^dagger H U, in parallel across the terms
+  PauliOperator applyCliffords(PauliOperator &H,
+                               const std::vector<CliffordFactor> &cliffords);
+  // Replaces io_pauli by U P U (up to the returned phase i^k)
+  static int conjugate(const CliffordFactor &factor, SymplecticPauli &io_pauli);
+
+  // Rows [x | z] of the non-identity Pauli strings
+  BinaryMatrix computeTableaux(const std::vector<SymplecticPauli> &paulis,
+                               const int nQubits);
   std::vector<std::vector<int>> generateCombinations(
       const int nQubits, std::function<void(std::vector<int> &)> &&f =
                              [](std::vector<int> &tmp) { return; });
-  int binaryVectorInnerProduct(std::vector<int> &bv1, std::vector<int> &bv2);
     const double computeGroundStateEnergy(PauliOperator &op, const int n);
 
-  Eigen::MatrixXi gauss(Eigen::MatrixXi &A, std::vector<int> &pivotCols);
+  // Remove qubits n/2 - 1 and n - 1 of a parity-mapped Hamiltonian, in the
+  // sector of lowest ground-state energy.
+  std::shared_ptr<xacc::Observable> parityReduction(PauliOperator &H);
+
+  // Row echelon form (in place, zero rows dropped), returns the rank
+  int gauss(BinaryMatrix &A, const int nCols, std::vector<int> &pivotCols);
 
+  std::mutex cacheLock;
+  // Keyed on the number of qubits and the sorted Pauli strings
+  std::map<std::vector<uint64_t>, std::shared_ptr<const SymmetryBasis>>
+      symmetryCache;
 };
 }  // namespace xacc
\ No newline at end of file
@@ -61,6 +61,54 @@ TEST(QubitTaperingTester, checkH2) {
   EXPECT_TRUE(test == expected);
 }
 
+TEST(QubitTaperingTester, checkH2Parity) {
+  auto H_vqe = xacc::quantum::getObservable("fermion", str);
+
+  auto transformation =
+      xacc::getService<xacc::ObservableTransform>("qubit-tapering");
+  auto transformed =
+      transformation->transform(H_vqe, {{"fermion-transform", "parity"}});
+  auto reduced =
+      std::dynamic_pointer_cast<xacc::quantum::PauliOperator>(transformed);
+  EXPECT_EQ(2, reduced->nQubits());
+
+  // Same ground state energy as the full Jordan-Wigner Hamiltonian
+  auto groundStateEnergy = [](std::shared_ptr<xacc::Observable> obs, int n) {
+    auto data = std::dynamic_pointer_cast<xacc::quantum::PauliOperator>(obs)
+                    ->toDenseMatrix(n);
+    Eigen::MatrixXcd m = Eigen::Map<Eigen::MatrixXcd>(data.data(), 1 << n,
+                                                      1 << n);
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXcd> solver(m);
+    return solver.eigenvalues()(0);
+  };
+  auto jw = xacc::getService<xacc::ObservableTransform>("jw");
+  EXPECT_NEAR(groundStateEnergy(jw->transform(H_vqe), 4),
+              groundStateEnergy(reduced, 2), 1e-6);
+}
+
+TEST(QubitTaperingTester, checkSameStructure) {
+  // Same terms, different coefficients: the cached symmetries are re-used
+  auto jw = xacc::getService<xacc::ObservableTransform>("jw");
+  auto H = std::dynamic_pointer_cast<xacc::quantum::PauliOperator>(
+      jw->transform(xacc::quantum::getObservable("fermion", str)));
+  auto scaledH = std::make_shared<xacc::quantum::PauliOperator>(2.0 * (*H));
+
+  auto transformation =
+      xacc::getService<xacc::ObservableTransform>("qubit-tapering");
+  auto reduced = std::dynamic_pointer_cast<xacc::quantum::PauliOperator>(
+      transformation->transform(H));
+  auto scaledReduced = std::dynamic_pointer_cast<xacc::quantum::PauliOperator>(
+      transformation->transform(scaledH));
+
+  EXPECT_EQ(1, reduced->nQubits());
+  EXPECT_EQ(reduced->nTerms(), scaledReduced->nTerms());
+  auto scaledTerms = scaledReduced->getTerms();
+  for (auto &kv : reduced->getTerms()) {
+    EXPECT_NEAR(2.0 * kv.second.coeff().real(),
+                scaledTerms[kv.first].coeff().real(), 1e-9);
+  }
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize(argc, argv);
   ::testing::InitGoogleTest(&argc, argv);
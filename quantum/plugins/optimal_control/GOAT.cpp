@@ -4,9 +4,15 @@
 #include "xacc_service.hpp"
 #include "xacc_observable.hpp"
 #include "PauliOperator.hpp"
+#include <Eigen/SparseCore>
 
 namespace {
 constexpr int DEFAULT_NUMBER_STEPS = 10000;
+// Max step of the adaptive integrator (fraction of the stop time), not to step over narrow pulses.
+constexpr double MAX_STEP_FRACTION = 0.01;
+// Hamiltonian terms with less than this fraction of non-zero elements are applied as sparse matrices.
+constexpr double SPARSE_DENSITY_THRESHOLD = 0.1;
+constexpr int SPARSE_MIN_DIMENSION = 16;
 const std::complex<double> I(0.0, 1.0);
 
 using namespace xacc;
@@ -83,6 +89,40 @@ Matrix getPauliMatrix(const std::string& in_pauli)
     return Matrix::Identity(2, 2);
 }
 
+// Hamiltonian term, stored as a sparse matrix if it couples few levels.
+class HamiltonianOperator
+{
+public:
+    HamiltonianOperator(const Matrix& in_mat)
+    {
+        const auto dim = in_mat.rows();
+        const auto nbNonZeros = (in_mat.cwiseAbs().array() > 0.0).count();
+        m_isSparse = dim >= SPARSE_MIN_DIMENSION && nbNonZeros < SPARSE_DENSITY_THRESHOLD * dim * dim;
+        if (m_isSparse)
+        {
+            m_sparse = in_mat.sparseView();
+        }
+        else
+        {
+            m_dense = in_mat;
+        }
+    }
+
+    Matrix apply(const Eigen::Ref<const Matrix>& in_mat) const
+    {
+        if (m_isSparse)
+        {
+            return m_sparse * in_mat;
+        }
+        return m_dense * in_mat;
+    }
+
+private:
+    bool m_isSparse;
+    Matrix m_dense;
+    Eigen::SparseMatrix<std::complex<double>> m_sparse;
+};
+
 Matrix kron(const Matrix& in_mat1, const Matrix& in_mat2)
 {
     const auto nbRowsMat1 = in_mat1.rows();
@@ -188,15 +228,22 @@ void GoatHamiltonian::construct(int in_dimension, const std::string& in_H0, cons
     hamiltonian = [this](double in_time, OptimParams in_paramVals) -> Matrix {      
         assert(in_paramVals.size() == params.size());
        
-        Matrix hamMat = m_h0;
-        for (int i = 0; i < hamOps.size(); ++i)
+        std::vector<double> evaled(hamOps.size());
         {
-            const auto& expression = m_exprs[i];
+            std::lock_guard<std::mutex> lock(m_evalMutex);
             // Set the variables before evaluation
             m_paramVals = in_paramVals;
             m_time = in_time;
-            const auto evaled = expression.value();
-            hamMat = hamMat + evaled * hamOps[i].second;
+            for (int i = 0; i < hamOps.size(); ++i)
+            {
+                evaled[i] = m_exprs[i].value();
+            }
+        }
+
+        Matrix hamMat = m_h0;
+        for (int i = 0; i < hamOps.size(); ++i)
+        {
+            hamMat = hamMat + evaled[i] * hamOps[i].second;
         }
         
         return hamMat;
@@ -208,16 +255,23 @@ void GoatHamiltonian::construct(int in_dimension, const std::string& in_H0, cons
         // Differential of H w.r.t. sigma parameter
         dHda.emplace_back([this, idx](double in_time, OptimParams in_paramVals) -> Matrix {
             assert(in_paramVals.size() == params.size());
-            Matrix hamMat = Matrix::Zero(1 << dimension, 1 << dimension);
-            for (int i = 0; i < hamOps.size(); ++i)
+            std::vector<double> derivativeEvaled(hamOps.size());
             {
-                const auto& expression = m_exprs[i];
+                std::lock_guard<std::mutex> lock(m_evalMutex);
                 // Set the variables before evaluation
                 m_paramVals = in_paramVals;
                 m_time = in_time;
-                // Calculate the derivative w.r.t. the parameter
-                const auto derivativeEvaled = exprtk::derivative(expression, params[idx]);
-                hamMat = hamMat + derivativeEvaled * hamOps[i].second;
+                for (int i = 0; i < hamOps.size(); ++i)
+                {
+                    // Calculate the derivative w.r.t. the parameter
+                    derivativeEvaled[i] = exprtk::derivative(m_exprs[i], params[idx]);
+                }
+            }
+
+            Matrix hamMat = Matrix::Zero(1 << dimension, 1 << dimension);
+            for (int i = 0; i < hamOps.size(); ++i)
+            {
+                hamMat = hamMat + derivativeEvaled[i] * hamOps[i].second;
             }
             
             return hamMat;
@@ -274,46 +328,11 @@ double GOAT_PulseOptim::eval(const OptimParams& in_params, std::vector<double>&
     const auto initialH = m_hamiltonian(0, params);
     // Hamiltonian must be a square matrix
     assert(initialH.rows() == initialH.cols());
-    const auto dimH = initialH.rows();
+    assert(initialH.rows() == m_targetU.rows());
     
     const auto integrateResult = m_integrator->integrate(m_hamiltonian, m_dHda, params, m_maxTime);
-    // We expect the result is a matrix that has (nb_params+1)*dimH rows and dimH columns
-    // i.e. we have U(T) and a vector of dUda(T) (one for each param) stacked on each other.
-    assert(integrateResult.cols() == dimH);
-    assert(integrateResult.rows() == dimH * (1 + params.size()));
-
-    const auto evalCostFn = [this](const Matrix& in_uMat) -> double {
-        assert(m_targetU.rows() == in_uMat.rows() && m_targetU.cols() == in_uMat.cols());
-        // Cost/goal function, i.e. Eq. (4)
-        return 1.0 - (1.0/m_targetU.rows())*std::abs((m_targetU.adjoint() * in_uMat).trace());
-    };
-
-    const auto evalCostFnGradient = [this, dimH](const std::vector<Matrix>& in_duMats, const OptimParams& in_params, double in_costVal) -> std::vector<double> {
-        assert(in_duMats.size() == in_params.size());
-        std::vector<double> results;
-
-        for (int i = 0; i < in_params.size(); ++i)
-        {
-            assert(in_duMats[i].rows() == m_targetU.rows() && m_targetU.cols() == in_duMats[i].cols());  
-            // Cost function gradients, i.e., Eq. (6)
-            const auto gradResult = -std::real((1.0/dimH)*(m_targetU.adjoint() * in_duMats[i]).trace());
-            results.emplace_back(gradResult);
-        }
-
-        return results;
-    }; 
-
-    const auto uMat = integrateResult(Eigen::seqN(0, dimH), Eigen::all);
-    std::vector<Matrix> duMats;
-    for (int i = 0; i < params.size(); ++i)
-    {
-        // Vector of dUda (one for each param)
-        duMats.emplace_back(integrateResult(Eigen::seqN(dimH + i*dimH, dimH), Eigen::all));
-    }
 
-    fx = evalCostFn(uMat);
-    // Evaluate the gradients
-    out_grads = evalCostFnGradient(duMats, params, fx);
+    fx = evalCost(integrateResult, params.size(), out_grads);
 
     const auto vecToString = [](const std::vector<double>& in_vec){
         std::string result;
@@ -344,6 +363,48 @@ double GOAT_PulseOptim::eval(const OptimParams& in_params, std::vector<double>&
     return fx;
 }
 
+std::vector<double> GOAT_PulseOptim::evalBatch(const std::vector<OptimParams>& in_paramsBatch, std::vector<std::vector<double>>& out_grads)
+{
+    const auto integrateResults = m_integrator->integrateBatch(m_hamiltonian, m_dHda, in_paramsBatch, m_maxTime);
+    assert(integrateResults.size() == in_paramsBatch.size());
+    std::vector<double> results;
+    out_grads.clear();
+    for (int i = 0; i < in_paramsBatch.size(); ++i)
+    {
+        std::vector<double> grads;
+        results.emplace_back(evalCost(integrateResults[i], in_paramsBatch[i].size(), grads));
+        out_grads.emplace_back(std::move(grads));
+    }
+
+    return results;
+}
+
+double GOAT_PulseOptim::evalCost(const Matrix& in_integrateResult, size_t in_nbParams, std::vector<double>& out_grads) const
+{
+    const auto dimH = m_targetU.rows();
+    // We expect the result is a matrix that has (nb_params+1)*dimH rows and dimH columns
+    // i.e. we have U(T) and a vector of dUda(T) (one for each param) stacked on each other.
+    assert(in_integrateResult.cols() == dimH);
+    assert(in_integrateResult.rows() == dimH * (1 + in_nbParams));
+
+    const auto uMat = in_integrateResult(Eigen::seqN(0, dimH), Eigen::all);
+    assert(m_targetU.rows() == uMat.rows() && m_targetU.cols() == uMat.cols());
+    // Cost/goal function, i.e. Eq. (4)
+    const double fx = 1.0 - (1.0/dimH)*std::abs((m_targetU.adjoint() * uMat).trace());
+
+    out_grads.clear();
+    for (int i = 0; i < in_nbParams; ++i)
+    {
+        // Vector of dUda (one for each param)
+        const auto duMat = in_integrateResult(Eigen::seqN(dimH + i*dimH, dimH), Eigen::all);
+        // Cost function gradients, i.e., Eq. (6)
+        const auto gradResult = -std::real((1.0/dimH)*(m_targetU.adjoint() * duMat).trace());
+        out_grads.emplace_back(gradResult);
+    }
+
+    return fx;
+}
+
 GOAT_PulseOptim::DefaultIntegrator::DefaultIntegrator(double in_dt):
     m_dt(in_dt)
 {}
@@ -403,6 +464,118 @@ Matrix GOAT_PulseOptim::DefaultIntegrator::integrate(const Hamiltonian& in_hamil
     return result;
 }
 
+GOAT_PulseOptim::AdaptiveIntegrator::AdaptiveIntegrator(double in_rtol, double in_atol, bool in_parallelBatch):
+    m_rtol(in_rtol),
+    m_atol(in_atol),
+    m_parallelBatch(in_parallelBatch)
+{}
+
+Matrix GOAT_PulseOptim::AdaptiveIntegrator::integrate(const Hamiltonian& in_hamiltonian, const dHdalpha& in_dHda, const OptimParams& in_params, double in_stopTime)
+{
+    const auto nbParams = in_dHda.size();
+    const auto dimH = in_hamiltonian(0, in_params).rows();
+
+    // The state is [U, dU/dalpha_1, ..., dU/dalpha_n] side by side, so that H is applied to all with one product:
+    // dU/dt = -iHU and d(dU/dalpha)/dt = -i(dH/dalpha U + H dU/dalpha)
+    // initial condition: U(0) = I, dUdalpha(0) = 0
+    Matrix state = Matrix::Zero(dimH, dimH * (1 + nbParams));
+    state.leftCols(dimH) = Matrix::Identity(dimH, dimH);
+    const auto rhs = [&](double in_time, const Matrix& in_state) -> Matrix {
+        const HamiltonianOperator hamOp(in_hamiltonian(in_time, in_params));
+        Matrix result = -I * hamOp.apply(in_state);
+        for (int i = 0; i < nbParams; ++i)
+        {
+            const HamiltonianOperator dHdaOp(in_dHda[i](in_time, in_params));
+            result.middleCols(dimH * (1 + i), dimH) += -I * dHdaOp.apply(in_state.leftCols(dimH));
+        }
+        return result;
+    };
+
+    // Dormand-Prince 5(4) tableau
+    static const double c[7] = { 0.0, 1.0 / 5, 3.0 / 10, 4.0 / 5, 8.0 / 9, 1.0, 1.0 };
+    static const double a[7][6] = {
+        {},
+        { 1.0 / 5 },
+        { 3.0 / 40, 9.0 / 40 },
+        { 44.0 / 45, -56.0 / 15, 32.0 / 9 },
+        { 19372.0 / 6561, -25360.0 / 2187, 64448.0 / 6561, -212.0 / 729 },
+        { 9017.0 / 3168, -355.0 / 33, 46732.0 / 5247, 49.0 / 176, -5103.0 / 18656 },
+        { 35.0 / 384, 0.0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784, 11.0 / 84 }
+    };
+    // 5th order minus embedded 4th order weights
+    static const double e[7] = { 35.0 / 384 - 5179.0 / 57600, 0.0, 500.0 / 1113 - 7571.0 / 16695, 125.0 / 192 - 393.0 / 640, 
+        -2187.0 / 6784 + 92097.0 / 339200, 11.0 / 84 - 187.0 / 2100, -1.0 / 40 };
+
+    const double maxStep = MAX_STEP_FRACTION * in_stopTime;
+    double step = maxStep;
+    double time = 0.0;
+    std::vector<Matrix> k(7);
+    k[0] = rhs(time, state);
+    while (time < in_stopTime * (1.0 - 1e-12))
+    {
+        const double h = std::min(step, in_stopTime - time);
+        Matrix stage;
+        for (int s = 1; s < 7; ++s)
+        {
+            stage = state;
+            for (int j = 0; j < s; ++j)
+            {
+                if (a[s][j] != 0.0)
+                {
+                    stage += (h * a[s][j]) * k[j];
+                }
+            }
+            k[s] = rhs(time + c[s] * h, stage);
+        }
+        // The last stage is the 5th order solution (FSAL).
+        Matrix error = Matrix::Zero(state.rows(), state.cols());
+        for (int s = 0; s < 7; ++s)
+        {
+            if (e[s] != 0.0)
+            {
+                error += (h * e[s]) * k[s];
+            }
+        }
+        const Eigen::ArrayXXd scale = m_atol + m_rtol * state.cwiseAbs().array().max(stage.cwiseAbs().array());
+        const double errNorm = (error.cwiseAbs().array() / scale).maxCoeff();
+        const double factor = errNorm == 0.0 ? 5.0 : std::min(5.0, std::max(0.2, 0.9 * std::pow(errNorm, -0.2)));
+        if (errNorm <= 1.0)
+        {
+            time += h;
+            state = std::move(stage);
+            std::swap(k[0], k[6]);
+        }
+        step = std::min(maxStep, h * factor);
+    }
+
+    // Stacked on each other: U(T) then dUda(T) (one for each param)
+    Matrix result(dimH * (1 + nbParams), dimH);
+    for (int i = 0; i <= nbParams; ++i)
+    {
+        result.middleRows(dimH * i, dimH) = state.middleCols(dimH * i, dimH);
+    }
+
+    return result;
+}
+
+std::vector<Matrix> GOAT_PulseOptim::AdaptiveIntegrator::integrateBatch(const Hamiltonian& in_hamiltonian, const dHdalpha& in_dHda, const std::vector<OptimParams>& in_paramsBatch, double in_stopTime)
+{
+    if (!m_parallelBatch)
+    {
+        return IIntegrator::integrateBatch(in_hamiltonian, in_dHda, in_paramsBatch, in_stopTime);
+    }
+
+    std::vector<Matrix> results(in_paramsBatch.size());
+    xacc::getTaskScheduler()->parallelFor(0, in_paramsBatch.size(), [&](size_t beginIdx, size_t endIdx) {
+        for (size_t i = beginIdx; i < endIdx; ++i)
+        {
+            results[i] = integrate(in_hamiltonian, in_dHda, in_paramsBatch[i], in_stopTime);
+        }
+    });
+
+    return results;
+}
+
 void GOAT_PulseOptim::DefaultGradientStepper::optimize(xacc::OptFunction* io_problem, const OptimParams& in_initialParams) 
 {
     // TODO: get rid of this Default Stepper.
@@ -478,6 +651,11 @@ void GOAT_PulseOptim::MLPackGradientStepper::optimize(xacc::OptFunction* io_prob
 // - Required: { "max-time" : double }: max control time horizon
 //
 // - Optional: { "optimizer" : string }: can be "ml-pack" or "default"
+//
+// - Optional: { "integrator" : string }: "rk45" (adaptive step Dormand-Prince, default) or "rk4" (fixed steps)
+//
+// - Optional: { "integrator-rtol" : double, "integrator-atol" : double }: tolerances of the adaptive integrator
+//  (default = 1e-8 and 1e-10)
 void PulseOptimGOAT::setOptions(const HeterogeneousMap& in_options)
 {   
     const auto fatalError = [](const std::string& in_fieldName){
@@ -563,6 +741,24 @@ void PulseOptimGOAT::setOptions(const HeterogeneousMap& in_options)
         optimizer = in_options.getString("optimizer");
     }
 
+    std::string integrator = "rk45";
+    if (in_options.stringExists("integrator")) 
+    {
+        integrator = in_options.getString("integrator");
+    }
+
+    double rtol = 1e-8;
+    if (in_options.keyExists<double>("integrator-rtol")) 
+    {
+        rtol = in_options.get<double>("integrator-rtol");
+    }
+
+    double atol = 1e-10;
+    if (in_options.keyExists<double>("integrator-atol")) 
+    {
+        atol = in_options.get<double>("integrator-atol");
+    }
+
     if (dimension < 1 || dimension > 10)
     {
         xacc::error("Invalid system dimension.");
@@ -605,6 +801,18 @@ void PulseOptimGOAT::setOptions(const HeterogeneousMap& in_options)
         return;
     }
     
+    if (integrator != "rk45" && integrator != "rk4")
+    {
+        xacc::error("Invalid integrator.");
+        return;
+    }
+
+    if (rtol <= 0.0 || atol <= 0.0)
+    {
+        xacc::error("Invalid integrator tolerances.");
+        return;
+    }
+
     std::unique_ptr<IGradientStepper> gradientOptimizer = [](const std::string& in_optimizerName) -> std::unique_ptr<IGradientStepper> {
         if (in_optimizerName == "ml-pack") 
         {
@@ -618,7 +826,13 @@ void PulseOptimGOAT::setOptions(const HeterogeneousMap& in_options)
     m_hamiltonian = std::make_unique<GoatHamiltonian>();
     m_hamiltonian->construct(dimension, H0, controlOps, controlFuncs, controlParams);
     // All parameters have been validated: construct the GOAT pulse optimizer
-    m_goatOptimizer = std::make_unique<GOAT_PulseOptim>(targetUmat, m_hamiltonian->hamiltonian, m_hamiltonian->dHda, initParams, tMax, nullptr, std::move(gradientOptimizer));
+    // Note: the GoatHamiltonian functions are thread-safe, hence batches can be integrated in parallel.
+    std::unique_ptr<IIntegrator> propagator;
+    if (integrator == "rk45")
+    {
+        propagator = std::make_unique<GOAT_PulseOptim::AdaptiveIntegrator>(rtol, atol, true);
+    }
+    m_goatOptimizer = std::make_unique<GOAT_PulseOptim>(targetUmat, m_hamiltonian->hamiltonian, m_hamiltonian->dHda, initParams, tMax, std::move(propagator), std::move(gradientOptimizer));
 }
 
 OptResult PulseOptimGOAT::optimize() 
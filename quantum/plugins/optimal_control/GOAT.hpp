@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <Eigen/Dense>
 #include "xacc.hpp"
 #include "exprtk.hpp"
@@ -37,7 +38,19 @@ using costFunctionalGradient = std::function<std::vector<double>(costFunctional,
 // Integrator/propagator (i.e. solving Eq. (7))
 struct IIntegrator
 {
+    virtual ~IIntegrator() = default;
     virtual Matrix integrate(const Hamiltonian& in_hamiltonian, const dHdalpha& in_dHda, const OptimParams& in_params, double in_stopTime) = 0;
+    // Integrates multiple parameter sets (e.g. candidates of population-based or line-search optimizers),
+    // one result per parameter set. By default, one after the other.
+    virtual std::vector<Matrix> integrateBatch(const Hamiltonian& in_hamiltonian, const dHdalpha& in_dHda, const std::vector<OptimParams>& in_paramsBatch, double in_stopTime)
+    {
+        std::vector<Matrix> results;
+        for (const auto& params : in_paramsBatch)
+        {
+            results.emplace_back(integrate(in_hamiltonian, in_dHda, params, in_stopTime));
+        }
+        return results;
+    }
 };
 
 // Abstract gradient-based step search (e.g. BFGS)
@@ -63,6 +76,8 @@ private:
     parser_t m_parser;
     std::vector<double> m_paramVals;
     double m_time;
+    // Guards the above (shared by all expressions), i.e. the Hamiltonian functions are thread-safe.
+    std::mutex m_evalMutex;
     // Compiled expressions
     std::vector<expression_t> m_exprs;
     Matrix m_h0;
@@ -81,6 +96,22 @@ public:
         double m_dt;
     };
 
+    // Adaptive step Dormand-Prince 5(4) integration of the coupled U and dU/dalpha equations,
+    // using sparse products for Hamiltonian terms that couple few levels.
+    // If in_parallelBatch, the parameter sets of a batch are integrated concurrently,
+    // hence the Hamiltonian functions must be thread-safe.
+    struct AdaptiveIntegrator : public IIntegrator
+    {
+        AdaptiveIntegrator(double in_rtol = 1e-8, double in_atol = 1e-10, bool in_parallelBatch = false);
+        virtual Matrix integrate(const Hamiltonian& in_hamiltonian, const dHdalpha& in_dHda, const OptimParams& in_params, double in_stopTime) override;
+        virtual std::vector<Matrix> integrateBatch(const Hamiltonian& in_hamiltonian, const dHdalpha& in_dHda, const std::vector<OptimParams>& in_paramsBatch, double in_stopTime) override;
+
+    private:
+        double m_rtol;
+        double m_atol;
+        bool m_parallelBatch;
+    };
+
     struct DefaultGradientStepper : public IGradientStepper
     {
         virtual void optimize(xacc::OptFunction* io_problem, const OptimParams& in_initialParams) override;
@@ -109,8 +140,13 @@ public:
     
     // Entry point for the gradient stepper to call
     double eval(const OptimParams& in_params, std::vector<double>& out_grads); 
+    // Cost function values and gradients of multiple parameter sets (batched integration)
+    std::vector<double> evalBatch(const std::vector<OptimParams>& in_paramsBatch, std::vector<std::vector<double>>& out_grads);
 
 private:
+    // Cost function and its gradients from the stacked U and dU/dalpha matrices
+    double evalCost(const Matrix& in_integrateResult, size_t in_nbParams, std::vector<double>& out_grads) const;
+
     Matrix m_targetU;
     const Hamiltonian& m_hamiltonian;
     const dHdalpha& m_dHda;
@@ -34,6 +34,9 @@ GrapePulseOptim::GrapePulseOptim(const GrapeConfigs& in_configs):
     m_configs(in_configs)
 {
     m_pulses.emplace_back(in_configs.initial_pulses);
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXcd> driftSolver(in_configs.H0);
+    m_driftEigenVals = driftSolver.eigenvalues();
+    m_driftEigenVecs = driftSolver.eigenvectors();
 }
 
 GrapeResult GrapePulseOptim::optimize(int in_nIters, double in_tol)
@@ -64,69 +67,137 @@ GrapeResult GrapePulseOptim::optimize(int in_nIters, double in_tol)
 
 std::vector<std::vector<double>> GrapePulseOptim::evaluate()
 {
-    const auto evalHmatAtStep = [](int in_timeStepIdx,  
-                                    const GrapeConfigs& in_configs, 
-                                    const std::vector<std::vector<double>>& in_ctrlFields) {
-        const auto& H0 = in_configs.H0;
-        const auto& H_ops = in_configs.H_ops;
-        auto resultMat = H0;
-        for (int i = 0; i < H_ops.size(); ++i)
+    const int nbSamples = m_configs.nbSamples;
+    const auto dim = m_configs.H0.rows();
+    const auto& H_ops = m_configs.H_ops;
+    const std::vector<std::vector<double>>& oldPulses = m_pulses.back();
+    const Eigen::MatrixXcd identity = Eigen::MatrixXcd::Identity(dim, dim);
+
+    // Time slice propagators (independent, hence in parallel) from the
+    // eigendecomposition of each (Hermitian) slice Hamiltonian, which is also
+    // used by the exact gradients.
+    // Slices without control reuse the drift decomposition.
+    std::vector<Eigen::MatrixXcd> U_list(nbSamples);
+    std::vector<Eigen::MatrixXcd> eigenVecs(nbSamples);
+    std::vector<Eigen::VectorXd> eigenVals(nbSamples);
+    xacc::getTaskScheduler()->parallelFor(0, nbSamples, [&](size_t beginIdx, size_t endIdx) {
+        for (size_t timeIdx = beginIdx; timeIdx < endIdx; ++timeIdx)
         {
-            resultMat += (in_ctrlFields[i][in_timeStepIdx] * H_ops[i]);
+            Eigen::MatrixXcd hMat = m_configs.H0;
+            bool isDrift = true;
+            for (int i = 0; i < H_ops.size(); ++i)
+            {
+                if (oldPulses[i][timeIdx] != 0.0)
+                {
+                    hMat += (oldPulses[i][timeIdx] * H_ops[i]);
+                    isDrift = false;
+                }
+            }
+            if (isDrift)
+            {
+                eigenVals[timeIdx] = m_driftEigenVals;
+                eigenVecs[timeIdx] = m_driftEigenVecs;
+            }
+            else
+            {
+                Eigen::SelfAdjointEigenSolver<Eigen::MatrixXcd> solver(hMat);
+                eigenVals[timeIdx] = solver.eigenvalues();
+                eigenVecs[timeIdx] = solver.eigenvectors();
+            }
+            const Eigen::VectorXcd phases = (-I * m_configs.dt * eigenVals[timeIdx]).array().exp();
+            U_list[timeIdx] = eigenVecs[timeIdx] * phases.asDiagonal() * eigenVecs[timeIdx].adjoint();
         }
+    });
 
-        return resultMat;  
-    };
-
-    std::vector<Eigen::MatrixXcd> U_list;
-    U_list.reserve(m_configs.nbSamples);
-    // Compute incremental U aling the time series
-    for (int i = 0; i < m_configs.nbSamples; ++i)
-    {
-        const Eigen::MatrixXcd hMat = evalHmatAtStep(i, m_configs, m_pulses.back());
-        U_list.emplace_back((-I * hMat * m_configs.dt).exp());
-    }
-
-    // Forward and backward unitary matrices
-    std::vector<Eigen::MatrixXcd> U_f_list;
-    std::vector<Eigen::MatrixXcd> U_b_list;
-    U_f_list.reserve(m_configs.nbSamples);
-    U_b_list.reserve(m_configs.nbSamples);
-    Eigen::MatrixXcd  U_f = Eigen::MatrixXcd::Identity(m_configs.H0.rows(), m_configs.H0.cols());
-    Eigen::MatrixXcd  U_b = Eigen::MatrixXcd::Identity(m_configs.H0.rows(), m_configs.H0.cols());
-    
-    // Calculate the forward and backward propagators
-    for (int i = 0; i < m_configs.nbSamples - 1; ++i)
-    {
-        U_f = U_list[i] * U_f;
-        U_f_list.emplace_back(U_f);
-
-        U_b_list.insert(U_b_list.begin(), U_b);
-        U_b = U_list[m_configs.nbSamples - 2 - i].adjoint() * U_b;
-    }
+    // Forward and backward unitary matrices:
+    // U_f_list[t] = U_t ... U_0 and U_b_list[t] = (U_{N-2} ... U_{t+1})^dagger,
+    // the two (sequential) chains are computed concurrently.
+    std::vector<Eigen::MatrixXcd> U_f_list(nbSamples - 1);
+    std::vector<Eigen::MatrixXcd> U_b_list(nbSamples - 1);
+    xacc::getTaskScheduler()->parallelFor(0, 2, [&](size_t beginIdx, size_t endIdx) {
+        for (size_t chainIdx = beginIdx; chainIdx < endIdx; ++chainIdx)
+        {
+            Eigen::MatrixXcd U_chain = identity;
+            if (chainIdx == 0)
+            {
+                for (int i = 0; i < nbSamples - 1; ++i)
+                {
+                    U_chain = U_list[i] * U_chain;
+                    U_f_list[i] = U_chain;
+                }
+            }
+            else
+            {
+                for (int i = nbSamples - 2; i >= 0; --i)
+                {
+                    U_b_list[i] = U_chain;
+                    U_chain = U_list[i].adjoint() * U_chain;
+                }
+            }
+        }
+    });
 
     // Save the final unitary at this iteration
-    m_uMats.emplace_back(U_f);
+    m_uMats.emplace_back(U_f_list.back());
+    const std::complex<double> overlap = overlapCalc(m_configs.targetU, m_uMats.back());
 
     // New pulse vector
-    const std::vector<std::vector<double>>& oldPulses = m_pulses.back();
     std::vector<std::vector<double>> newPulses(oldPulses);
-    for (int i = 0; i < m_configs.H_ops.size(); ++i)
-    {
-        for (int timeIdx = 0; timeIdx < m_configs.nbSamples - 1; ++timeIdx)
+    xacc::getTaskScheduler()->parallelFor(0, nbSamples - 1, [&](size_t beginIdx, size_t endIdx) {
+        for (size_t timeIdx = beginIdx; timeIdx < endIdx; ++timeIdx)
         {
             const auto& U = m_configs.targetU;
-            const auto& H_ops = m_configs.H_ops;
-            const auto P = U_b_list[timeIdx] * U;
-            const auto Q = I * m_configs.dt * H_ops[i] * U_f_list[timeIdx];
-            // Note: we will be using a global-phase insensitive optimization.
-            // This simplifies the implementation and makes it consistent across optimization methods.
-            const std::complex<double> du = -2.0*overlapCalc(P, Q)*overlapCalc(U_f_list[timeIdx], P);
-            // Gradient-based update
-            newPulses[i][timeIdx] = oldPulses[i][timeIdx] + m_configs.eps * du.real();
+            const Eigen::MatrixXcd P = U_b_list[timeIdx] * U;
+            if (m_configs.approximateGradient)
+            {
+                // First order: dU_t/du = -i * dt * H_op * U_t
+                for (int i = 0; i < H_ops.size(); ++i)
+                {
+                    const Eigen::MatrixXcd Q = I * m_configs.dt * H_ops[i] * U_f_list[timeIdx];
+                    // Note: we will be using a global-phase insensitive optimization.
+                    // This simplifies the implementation and makes it consistent across optimization methods.
+                    const std::complex<double> du = -2.0*overlapCalc(P, Q)*overlapCalc(U_f_list[timeIdx], P);
+                    // Gradient-based update
+                    newPulses[i][timeIdx] = oldPulses[i][timeIdx] + m_configs.eps * du.real();
+                }
+                continue;
+            }
+
+            // Exact: in the eigenbasis of the slice Hamiltonian,
+            // dU_t/du = V (G o (V^dagger H_op V)) V^dagger with
+            // G_ab = (exp(-i*dt*l_a) - exp(-i*dt*l_b))/(l_a - l_b) (divided differences).
+            const auto& V = eigenVecs[timeIdx];
+            const auto& lambdas = eigenVals[timeIdx];
+            Eigen::MatrixXcd G(dim, dim);
+            for (int a = 0; a < dim; ++a)
+            {
+                const auto phaseA = std::exp(-I * m_configs.dt * lambdas(a));
+                for (int b = 0; b < dim; ++b)
+                {
+                    const double diff = lambdas(a) - lambdas(b);
+                    G(a, b) = std::abs(diff * m_configs.dt) < 1e-8 ?
+                        -I * m_configs.dt * phaseA :
+                        (phaseA - std::exp(-I * m_configs.dt * lambdas(b))) / diff;
+                }
+            }
+            // <P| dU_t U_(t-1)...U_0> = Tr(dU_t * M) / dim
+            const Eigen::MatrixXcd M = timeIdx == 0 ? Eigen::MatrixXcd(P.adjoint()) : Eigen::MatrixXcd(U_f_list[timeIdx - 1] * P.adjoint());
+            const Eigen::MatrixXcd W = V.adjoint() * M * V;
+            for (int i = 0; i < H_ops.size(); ++i)
+            {
+                const Eigen::MatrixXcd A = V.adjoint() * H_ops[i] * V;
+                const std::complex<double> dOverlap = (G.cwiseProduct(A).cwiseProduct(W.transpose())).sum() / static_cast<double>(dim);
+                // d|<U_target|U>|^2/du
+                const std::complex<double> du = 2.0 * std::conj(overlap) * dOverlap;
+                newPulses[i][timeIdx] = oldPulses[i][timeIdx] + m_configs.eps * du.real();
+            }
         }
+    });
+
+    for (int i = 0; i < H_ops.size(); ++i)
+    {
         // Last sample is equal the one before
-        newPulses[i][m_configs.nbSamples - 1] = newPulses[i][m_configs.nbSamples - 2];
+        newPulses[i][nbSamples - 1] = newPulses[i][nbSamples - 2];
     }
         
     return newPulses;
@@ -155,6 +226,8 @@ std::vector<std::vector<double>> GrapePulseOptim::evaluate()
 // Note: initial-pulses and max-time are both optional *BUT* at least one of them
 // must be provided.
 // - Optional: { "eps": double}: gradient step size multiplier (default = 0.1 * (2 * pi) / max-time)
+// - Optional: { "grape-gradient": string}: "exact" (default) or "approximate",
+//   i.e. first-order in dt derivatives of the slice propagators (cheaper but less accurate for large dt).
 void PulseOptimGRAPE::setOptions(const HeterogeneousMap& in_options) 
 {
     int dimension = 0;
@@ -274,6 +347,24 @@ void PulseOptimGRAPE::setOptions(const HeterogeneousMap& in_options)
         eps = in_options.get<double>("eps");
     }
 
+    bool approximateGradient = false;
+    if (in_options.stringExists("grape-gradient"))
+    {
+        const auto gradientType = in_options.getString("grape-gradient");
+        if (gradientType != "exact" && gradientType != "approximate")
+        {
+            xacc::error("Invalid 'grape-gradient' parameter: must be 'exact' or 'approximate'.");
+            return;
+        }
+        approximateGradient = gradientType == "approximate";
+    }
+
+    if (nbSamples < 2)
+    {
+        xacc::error("GRAPE requires at least two pulse samples.");
+        return;
+    }
+
     struct GrapeConfigs configs;
     {
         configs.targetU = targetUmat;
@@ -283,6 +374,7 @@ void PulseOptimGRAPE::setOptions(const HeterogeneousMap& in_options)
         configs.nbSamples = nbSamples;
         configs.initial_pulses = initialPulses;
         configs.eps = eps;
+        configs.approximateGradient = approximateGradient;
     }
 
     m_optimizer = std::make_unique<GrapePulseOptim>(configs);
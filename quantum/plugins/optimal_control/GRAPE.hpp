@@ -19,6 +19,8 @@ struct GrapeConfigs
     std::vector<std::vector<double>> initial_pulses;
     // Gradient step size multiplier
     double eps;
+    // First-order (in dt) gradients instead of the exact propagator derivatives
+    bool approximateGradient = false;
 };
 
 struct GrapeResult
@@ -40,6 +42,9 @@ private:
     GrapeConfigs m_configs;
     std::vector<std::vector<std::vector<double>>> m_pulses;
     std::vector<Eigen::MatrixXcd> m_uMats; 
+    // Eigendecomposition of the drift (static) Hamiltonian
+    Eigen::VectorXd m_driftEigenVals;
+    Eigen::MatrixXcd m_driftEigenVecs;
 };
 
 // Public GRAPE pulse optimization interface
@@ -219,6 +219,38 @@ TEST(GOATTester, testMlPack)
     std::cout << "##########################################\n";
 }
 
+TEST(GOATTester, testAdaptiveIntegratorBatch)
+{
+    // Constant drive: H = omega * X, i.e. U(T) = cos(omega*T) I - i sin(omega*T) X
+    // and dU/domega = -i T X U(T).
+    const std::complex<double> I(0.0, 1.0);
+    Matrix pauliX{ Matrix::Zero(2, 2) };
+    pauliX << 0, 1, 1, 0;
+    const double tMax = 10.0;
+    const Hamiltonian ham = [&](double in_time, OptimParams in_params) -> Matrix {
+        return in_params[0] * pauliX;
+    };
+    const dHdalpha dHdparams { [&](double in_time, OptimParams in_params) -> Matrix {
+        return pauliX;
+    } };
+
+    const std::vector<OptimParams> paramsBatch { { 0.1 }, { 0.25 }, { M_PI / 20 } };
+    GOAT_PulseOptim::AdaptiveIntegrator integrator;
+    const auto results = integrator.integrateBatch(ham, dHdparams, paramsBatch, tMax);
+    EXPECT_EQ(results.size(), paramsBatch.size());
+    for (int i = 0; i < paramsBatch.size(); ++i)
+    {
+        const double omega = paramsBatch[i][0];
+        const Matrix expectedU = std::cos(omega * tMax) * Matrix::Identity(2, 2) - I * std::sin(omega * tMax) * pauliX;
+        const Matrix expectedDu = -I * tMax * pauliX * expectedU;
+        EXPECT_EQ(results[i].rows(), 4);
+        EXPECT_NEAR((results[i].topRows(2) - expectedU).norm(), 0.0, 1e-6);
+        EXPECT_NEAR((results[i].bottomRows(2) - expectedDu).norm(), 0.0, 1e-6);
+        // Same as a single integration
+        EXPECT_NEAR((results[i] - integrator.integrate(ham, dHdparams, paramsBatch[i], tMax)).norm(), 0.0, 1e-12);
+    }
+}
+
 int main(int argc, char **argv) 
 {
     xacc::Initialize();
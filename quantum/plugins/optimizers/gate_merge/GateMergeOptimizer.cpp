@@ -1,7 +1,11 @@
 #include <cassert>
 #include "GateMergeOptimizer.hpp"
 #include "GateFusion.hpp"
+#include "StructuralHasher.hpp"
 #include "xacc_service.hpp"
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace {
 bool compareMatIgnoreGlobalPhase(const Eigen::Matrix4cd& in_a, const Eigen::Matrix4cd& in_b)
@@ -81,6 +85,171 @@ getBufferList(const std::shared_ptr<CompositeInstruction> &program) {
   std::vector<std::string> result(allBuffers.begin(), allBuffers.end());
   return result;
 }
+
+// Lower bound on the number of gates of the KAK decomposition of a two-qubit
+// unitary: its interaction part has 14 gates if it needs 3 CNOTs, at least 5
+// otherwise.
+// Uses the criterion of Shende, Markov and Bullock: U in SU(4) needs (at most)
+// 2 CNOTs iff tr(U (Y x Y) U^T (Y x Y)) is real. The imaginary part is bounded
+// by 8|z|, with z the ZZ coefficient of the interaction, hence the (loose)
+// tolerance only classifies as 3 CNOTs the unitaries that the KAK will also
+// decompose with 3 CZs.
+size_t minKakGateCount(const Eigen::Matrix4cd& in_uMat)
+{
+    // Y x Y
+    Eigen::Matrix4cd YY;
+    YY << 0, 0, 0, -1, 0, 0, 1, 0, 0, 1, 0, 0, -1, 0, 0, 0;
+    const std::complex<double> trace = (in_uMat * YY * in_uMat.transpose() * YY).trace() / std::sqrt(in_uMat.determinant());
+    return std::abs(trace.imag()) > 1e-6 ? 14 : 5;
+}
+
+// Bound on the number of cached decompositions (cleared when reached).
+constexpr size_t MAX_CACHED_DECOMPOSITIONS = 1024;
+// Unitaries are compared after rounding their entries to this precision.
+constexpr double UNITARY_QUANTUM = 1e-9;
+
+// KAK decomposition of the unitary of a block (bits { 0, 1 })
+struct Decomposition 
+{
+    // Quantized real and imaginary parts (row-major), for the exact comparison
+    std::vector<int64_t> key;
+    std::vector<xacc::InstPtr> instructions;
+    // Whether the decomposition reproduces the unitary
+    bool valid;
+};
+
+std::vector<int64_t> quantize(const Eigen::Matrix4cd& in_uMat)
+{
+    std::vector<int64_t> result;
+    result.reserve(2 * in_uMat.size());
+    for (int row = 0; row < in_uMat.rows(); ++row)
+    {
+        for (int col = 0; col < in_uMat.cols(); ++col)
+        {
+            result.emplace_back(std::llround(in_uMat(row, col).real() / UNITARY_QUANTUM));
+            result.emplace_back(std::llround(in_uMat(row, col).imag() / UNITARY_QUANTUM));
+        }
+    }
+    return result;
+}
+
+uint64_t hashKey(const std::vector<int64_t>& in_key)
+{
+    xacc::StructuralHasher hasher;
+    for (const auto& val : in_key)
+    {
+        hasher.add<int64_t>(val);
+    }
+    return hasher.value();
+}
+
+std::mutex& cacheMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::unordered_multimap<uint64_t, std::shared_ptr<const Decomposition>>& cache()
+{
+    static std::unordered_multimap<uint64_t, std::shared_ptr<const Decomposition>> entries;
+    return entries;
+}
+
+// Requires the cache mutex to be held.
+std::shared_ptr<const Decomposition> findCached(uint64_t in_hash, const std::vector<int64_t>& in_key)
+{
+    const auto range = cache().equal_range(in_hash);
+    for (auto iter = range.first; iter != range.second; ++iter)
+    {
+        if (iter->second->key == in_key)
+        {
+            return iter->second;
+        }
+    }
+    return nullptr;
+}
+
+// The (fused) unitary of a block, as computed by the GateFuser.
+// Safe to call concurrently: the "default" GateFuser service is shared, hence
+// not used here.
+Eigen::Matrix4cd calcBlockUnitary(const std::shared_ptr<xacc::CompositeInstruction>& in_block)
+{
+    xacc::quantum::GateFuser fuser;
+    fuser.initialize(in_block);
+    return fuser.calcFusedGate(2);
+}
+
+// KAK decomposition of the unitary of a block, cached by unitary (up to the
+// rounding): identical blocks, e.g. the Trotter steps of a circuit, are only
+// decomposed once.
+std::shared_ptr<const Decomposition> decompose(const Eigen::Matrix4cd& in_uMat)
+{
+    auto key = quantize(in_uMat);
+    const auto hash = hashKey(key);
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex());
+        if (auto cached = findCached(hash, key))
+        {
+            return cached;
+        }
+    }
+
+    // The KAK takes the unitary in row-major order.
+    std::vector<std::complex<double>> flattenedUnitary;
+    for (int row = 0; row < in_uMat.rows(); ++row)
+    {
+        for (int col = 0; col < in_uMat.cols(); ++col)
+        {
+            flattenedUnitary.emplace_back(in_uMat(row, col));
+        }
+    }
+    auto kak = std::dynamic_pointer_cast<xacc::quantum::Circuit>(xacc::getService<xacc::Instruction>("kak"));
+    const bool expandOk = kak->expand({ 
+        std::make_pair("unitary", flattenedUnitary)
+    });
+    assert(expandOk);
+    auto decomposition = std::make_shared<Decomposition>();
+    decomposition->key = std::move(key);
+    decomposition->instructions = kak->getInstructions();
+    decomposition->valid = compareMatIgnoreGlobalPhase(in_uMat, calcBlockUnitary(kak));
+
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    // Another thread may have computed it in the meantime.
+    if (auto cached = findCached(hash, decomposition->key))
+    {
+        return cached;
+    }
+    if (cache().size() >= MAX_CACHED_DECOMPOSITIONS)
+    {
+        cache().clear();
+    }
+    cache().emplace(hash, decomposition);
+    return decomposition;
+}
+
+// Bits of a block mapped to { 0, 1 } for fusing
+std::vector<size_t> mapBits(const std::vector<size_t>& in_bits, const std::pair<size_t, size_t>& in_qubitPair)
+{
+    const auto translate = [&in_qubitPair](size_t bit) -> size_t {
+        assert(bit == in_qubitPair.first || bit == in_qubitPair.second);
+        assert(in_qubitPair.first  != in_qubitPair.second);
+        if (in_qubitPair.first < in_qubitPair.second)
+        {
+            return (bit == in_qubitPair.first) ? 1 : 0;
+        }
+        else
+        {
+            return (bit == in_qubitPair.first) ? 0 : 1;
+        }
+    }; 
+
+    std::vector<size_t> newBits;
+    for (const auto& bit: in_bits)         
+    {
+        newBits.emplace_back(translate(bit));
+    }   
+    return newBits;
+}
 } // namespace
 namespace xacc {
 namespace quantum {
@@ -142,7 +311,7 @@ void MergeSingleQubitGatesOptimizer::apply(std::shared_ptr<CompositeInstruction>
                 program->removeDisabled();
                 if (program->nInstructions() == sequence[0])
                 {
-                    for (auto& newInst: zyz->getInstructions())
+                    for (auto& newInst: zyz->getInstructionsView())
                     {
                         newInst->setBits({bitIdx});
                         newInst->setBufferNames({ buffer_names[0] });
@@ -152,7 +321,7 @@ void MergeSingleQubitGatesOptimizer::apply(std::shared_ptr<CompositeInstruction>
                 else
                 {
                     auto locationToInsert = sequence[0];
-                    for (auto& newInst: zyz->getInstructions())
+                    for (auto& newInst: zyz->getInstructionsView())
                     {
                         newInst->setBits({bitIdx});
                         newInst->setBufferNames({ buffer_names[0] });
@@ -174,7 +343,7 @@ std::vector<size_t> MergeSingleQubitGatesOptimizer::findSingleQubitGateSequence(
     assert(in_startIdx < nbInstructions);
     auto firstInst = in_program->getInstruction(in_startIdx);
     // Not a single-qubit gate.
-    if (firstInst->bits().size() > 1 || firstInst->name() == "Measure")
+    if (firstInst->bits().size() > 1 || firstInst->opcode() == xacc::GateOpcode::Measure)
     {
         return {};
     }
@@ -193,7 +362,7 @@ std::vector<size_t> MergeSingleQubitGatesOptimizer::findSingleQubitGateSequence(
         // Matching bitIdx
         if (instPtr->bits().size() == 1 && instPtr->bits()[0] == bitIdx)
         {
-            if (instPtr->name() != "Measure")
+            if (instPtr->opcode() != xacc::GateOpcode::Measure)
             {
                 gateSequence.emplace_back(instIdx);
             }
@@ -222,7 +391,6 @@ void MergeTwoQubitBlockOptimizer::apply(std::shared_ptr<CompositeInstruction> pr
         // due to qubit Id ambiguity.
         return;
     }
-    auto gateRegistry = xacc::getService<xacc::IRProvider>("quantum");
     flattenComposite(program);
     // No need to optimize block with less than 6 gates
     // since the KAK decomposition will result in at least 5 gate.
@@ -231,36 +399,19 @@ void MergeTwoQubitBlockOptimizer::apply(std::shared_ptr<CompositeInstruction> pr
     {
         return;
     }
+    // The rewrite below is sequential (each rewrite changes the blocks after it),
+    // decompose the blocks of the input circuit in parallel beforehand:
+    // the blocks that are not modified by a rewrite get the cached decompositions.
+    if (xacc::getTaskScheduler()->getNumberOfThreads() > 1)
+    {
+        decomposeBlocks(program, MIN_SIZE);
+    }
     for (size_t instIdx = 0; instIdx < program->nInstructions(); ++instIdx)
     {
         std::pair<size_t, size_t> qubitPair = std::make_pair(0, 0);
         const auto sequence = findGateSequence(program, instIdx, MIN_SIZE, qubitPair);
         if (!sequence.empty()) 
         {
-            auto tmpKernel = gateRegistry->createComposite("__TMP__");
-            
-            const auto mapBits = [&qubitPair](const std::vector<size_t>& in_bits){
-                const auto translate = [&qubitPair](size_t bit) {
-                    assert(bit == qubitPair.first || bit == qubitPair.second);
-                    assert(qubitPair.first  != qubitPair.second);
-                    if (qubitPair.first < qubitPair.second)
-                    {
-                        return (bit == qubitPair.first) ? 1 : 0;
-                    }
-                    else
-                    {
-                        return (bit == qubitPair.first) ? 0 : 1;
-                    }
-                }; 
-
-                std::vector<size_t> newBits;
-                for (const auto& bit: in_bits)         
-                {
-                    newBits.emplace_back(translate(bit));
-                }   
-                return newBits;
-            };
-
             // Map { 0, 1 } bits back to original bits
             const auto remapBits = [&qubitPair](const std::vector<size_t>& in_bits){
                 const auto translate = [&qubitPair](size_t bit) {
@@ -284,38 +435,26 @@ void MergeTwoQubitBlockOptimizer::apply(std::shared_ptr<CompositeInstruction> pr
                 return newBits;
             };
 
-            for (const auto& instIdx: sequence)
+            const Eigen::Matrix4cd uMat = calcBlockUnitary(createBlock(program, sequence, qubitPair));
+            // The decomposition cannot have fewer gates.
+            if (sequence.size() <= minKakGateCount(uMat))
             {
-                auto instrPtr = program->getInstruction(instIdx)->clone();
-                instrPtr->setBits(mapBits(instrPtr->bits()));
-                tmpKernel->addInstruction(instrPtr);
+                continue;
             }
-            auto fuser = xacc::getService<xacc::quantum::GateFuser>("default");
-            fuser->initialize(tmpKernel);
-            Eigen::Matrix4cd uMat = fuser->calcFusedGate(2);
-            uMat.transposeInPlace();
-            Eigen::VectorXcd matAsVec(Eigen::Map<Eigen::VectorXcd>(uMat.data(), uMat.cols()*uMat.rows()));
-            std::vector<std::complex<double>> flattenedUnitary;
-            flattenedUnitary.resize(matAsVec.size());
-            Eigen::VectorXcd::Map(&flattenedUnitary[0], flattenedUnitary.size()) = matAsVec;
-            auto kak = std::dynamic_pointer_cast<quantum::Circuit>(xacc::getService<Instruction>("kak"));
-            const bool expandOk = kak->expand({ 
-                std::make_pair("unitary", flattenedUnitary)
-            });
-            assert(expandOk);
-            
-            const auto calcUopt = [](const std::shared_ptr<CompositeInstruction> composite) {
-                auto fuser = xacc::getService<xacc::quantum::GateFuser>("default");
-                fuser->initialize(composite);
-                return fuser->calcFusedGate(2);
-            };
-            
+            const auto decomposition = decompose(uMat);
             // Optimized decomposed sequence:
-            const auto nbInstructionsAfter = kak->nInstructions();
-            uMat.transposeInPlace();
+            const auto nbInstructionsAfter = decomposition->instructions.size();
             // A simplified sequence was found.
-            if (nbInstructionsAfter < sequence.size() && compareMatIgnoreGlobalPhase(uMat, calcUopt(kak)))
+            if (nbInstructionsAfter < sequence.size() && decomposition->valid)
             {
+                std::vector<InstPtr> newInsts;
+                for (const auto& inst: decomposition->instructions)
+                {
+                    auto newInst = inst->clone();
+                    newInst->setBits(remapBits(newInst->bits()));
+                    newInst->setBufferNames(std::vector<std::string>(newInst->bits().size(), buffer_names[0]));
+                    newInsts.emplace_back(newInst);
+                }
                 // Disable to remove:
                 const auto programLengthBefore = program->nInstructions();
                 for (const auto& instIdx: sequence)
@@ -326,21 +465,14 @@ void MergeTwoQubitBlockOptimizer::apply(std::shared_ptr<CompositeInstruction> pr
                 program->removeDisabled();
                 if (program->nInstructions() == sequence[0])
                 {
-                    for (auto& newInst: kak->getInstructions())
-                    {
-                        newInst->setBits(remapBits(newInst->bits()));
-                        newInst->setBufferNames(std::vector<std::string>(newInst->bits().size(), buffer_names[0]));
-                        program->addInstruction(newInst->clone());
-                    }
+                    program->addInstructions(newInsts);
                 }
                 else
                 {
                     auto locationToInsert = sequence[0];
-                    for (auto& newInst: kak->getInstructions())
+                    for (auto& newInst: newInsts)
                     {
-                        newInst->setBits(remapBits(newInst->bits()));
-                        newInst->setBufferNames(std::vector<std::string>(newInst->bits().size(), buffer_names[0]));
-                        program->insertInstruction(locationToInsert, newInst->clone());
+                        program->insertInstruction(locationToInsert, newInst);
                         locationToInsert++;
                     }
                 }
@@ -353,12 +485,65 @@ void MergeTwoQubitBlockOptimizer::apply(std::shared_ptr<CompositeInstruction> pr
     }
 }
 
+std::shared_ptr<CompositeInstruction> MergeTwoQubitBlockOptimizer::createBlock(const std::shared_ptr<CompositeInstruction> in_program, const std::vector<size_t>& in_sequence, const std::pair<size_t, size_t>& in_qubitPair) const
+{
+    auto gateRegistry = xacc::getService<xacc::IRProvider>("quantum");
+    auto tmpKernel = gateRegistry->createComposite("__TMP__");
+    for (const auto& instIdx: in_sequence)
+    {
+        auto instrPtr = in_program->getInstruction(instIdx)->clone();
+        instrPtr->setBits(mapBits(instrPtr->bits(), in_qubitPair));
+        tmpKernel->addInstruction(instrPtr);
+    }
+    return tmpKernel;
+}
+
+void MergeTwoQubitBlockOptimizer::decomposeBlocks(const std::shared_ptr<CompositeInstruction> in_program, size_t in_lengthLimit) const
+{
+    std::vector<std::shared_ptr<CompositeInstruction>> blocks;
+    for (size_t instIdx = 0; instIdx < in_program->nInstructions(); ++instIdx)
+    {
+        std::pair<size_t, size_t> qubitPair = std::make_pair(0, 0);
+        const auto sequence = findGateSequence(in_program, instIdx, in_lengthLimit, qubitPair);
+        if (!sequence.empty())
+        {
+            blocks.emplace_back(createBlock(in_program, sequence, qubitPair));
+        }
+    }
+
+    std::vector<Eigen::Matrix4cd> uMats(blocks.size());
+    std::vector<char> toDecompose(blocks.size(), 0);
+    xacc::getTaskScheduler()->parallelFor(0, blocks.size(), [&](size_t beginIdx, size_t endIdx) {
+        for (size_t i = beginIdx; i < endIdx; ++i)
+        {
+            uMats[i] = calcBlockUnitary(blocks[i]);
+            toDecompose[i] = blocks[i]->nInstructions() > minKakGateCount(uMats[i]);
+        }
+    });
+    // Repeated blocks are decomposed once.
+    std::vector<size_t> uniqueBlocks;
+    std::unordered_set<uint64_t> hashes;
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        if (toDecompose[i] && hashes.emplace(hashKey(quantize(uMats[i]))).second)
+        {
+            uniqueBlocks.emplace_back(i);
+        }
+    }
+    xacc::getTaskScheduler()->parallelFor(0, uniqueBlocks.size(), [&](size_t beginIdx, size_t endIdx) {
+        for (size_t i = beginIdx; i < endIdx; ++i)
+        {
+            decompose(uMats[uniqueBlocks[i]]);
+        }
+    });
+}
+
 std::vector<size_t> MergeTwoQubitBlockOptimizer::findGateSequence(const std::shared_ptr<CompositeInstruction> in_program, size_t in_startIdx, size_t in_lengthLimit, std::pair<size_t, size_t>& out_qubitPair) const
 {
     const auto nbInstructions = in_program->nInstructions();
     assert(in_startIdx < nbInstructions);
     auto firstInst = in_program->getInstruction(in_startIdx);
-    if (firstInst->name() == "Measure")
+    if (firstInst->opcode() == xacc::GateOpcode::Measure)
     {
         return {};
     }
@@ -404,7 +589,7 @@ std::vector<size_t> MergeTwoQubitBlockOptimizer::findGateSequence(const std::sha
         {
             if (instPtr->bits()[0] == qubitPair.first || instPtr->bits()[0] == qubitPair.second)
             {
-                if (instPtr->name() == "Measure")
+                if (instPtr->opcode() == xacc::GateOpcode::Measure)
                 {
                     return returnSeq(gateSequence);
                 }
@@ -37,6 +37,10 @@ public:
 private:
     // Finds the sequence of gates (from the start index) which forms a two-qubit block (with no connections to outside the block)
     std::vector<size_t> findGateSequence(const std::shared_ptr<CompositeInstruction> in_program, size_t in_startIdx, size_t in_lengthLimit, std::pair<size_t, size_t>& out_qubitPair) const;    
+    // Copy of the gates of a block, on bits { 0, 1 }
+    std::shared_ptr<CompositeInstruction> createBlock(const std::shared_ptr<CompositeInstruction> in_program, const std::vector<size_t>& in_sequence, const std::pair<size_t, size_t>& in_qubitPair) const;
+    // Decompose (in parallel) the blocks starting at each gate of the circuit, into the decomposition cache
+    void decomposeBlocks(const std::shared_ptr<CompositeInstruction> in_program, size_t in_lengthLimit) const;
 };
 }
 }
\ No newline at end of file
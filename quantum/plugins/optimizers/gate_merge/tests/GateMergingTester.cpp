@@ -1142,6 +1142,80 @@ h q[0];
     compareMatToGlobalPhase(uMatBeforeLinAlg, uMatOriginal);
 }
 
+TEST(GateMergingTester, checkTwoQubitRepeatedBlocks) 
+{
+    // The same block on qubits (0, 1) and (2, 3), interleaved: 
+    // 4 x (ZZ rotation - X rotations)
+    auto gateRegistry = xacc::getService<xacc::IRProvider>("quantum");
+    auto f = gateRegistry->createComposite("test_repeated");
+    for (int step = 0; step < 4; ++step)
+    {
+        for (const size_t offset : { 0, 2 })
+        {
+            f->addInstructions({
+                gateRegistry->createInstruction("CNOT", { offset, offset + 1 }),
+                gateRegistry->createInstruction("Rz", { offset + 1 }, { 0.1 + step }),
+                gateRegistry->createInstruction("CNOT", { offset, offset + 1 }),
+                gateRegistry->createInstruction("H", { offset }),
+                gateRegistry->createInstruction("Rz", { offset }, { 0.2 }),
+                gateRegistry->createInstruction("H", { offset }),
+                gateRegistry->createInstruction("H", { offset + 1 }),
+                gateRegistry->createInstruction("Rz", { offset + 1 }, { 0.3 }),
+                gateRegistry->createInstruction("H", { offset + 1 })
+            });
+        }
+    }
+    for (auto& inst : f->getInstructions())
+    {
+        inst->setBufferNames(std::vector<std::string>(inst->bits().size(), "q"));
+    }
+    
+    // Gates of a pair, on qubits { 0, 1 }
+    const auto getPair = [&](const std::shared_ptr<xacc::CompositeInstruction>& in_program, size_t in_offset) {
+        auto result = gateRegistry->createComposite("pair");
+        for (auto& inst : in_program->getInstructions())
+        {
+            if (inst->bits()[0] == in_offset || inst->bits()[0] == in_offset + 1)
+            {
+                auto newInst = inst->clone();
+                std::vector<size_t> bits;
+                for (const auto& bit : inst->bits())
+                {
+                    bits.emplace_back(bit - in_offset);
+                }
+                newInst->setBits(bits);
+                result->addInstruction(newInst);
+            }
+        }
+        return result;
+    };
+    const auto calcUMat = [](const std::shared_ptr<xacc::CompositeInstruction>& in_program) {
+        auto fuser = xacc::getService<xacc::quantum::GateFuser>("default");
+        fuser->initialize(in_program);
+        return Eigen::MatrixXcd(fuser->calcFusedGate(2));
+    };
+    const Eigen::MatrixXcd uMatBefore = calcUMat(getPair(f, 0));
+    EXPECT_TRUE(uMatBefore.isApprox(calcUMat(getPair(f, 2)), 1e-12));
+    
+    auto opt = xacc::getService<xacc::IRTransformation>("two-qubit-block-merging");
+    opt->apply(f, nullptr);
+    EXPECT_LT(f->nInstructions(), 72);
+    auto pair1 = getPair(f, 0);
+    auto pair2 = getPair(f, 2);
+    ASSERT_EQ(pair1->nInstructions(), pair2->nInstructions());
+    EXPECT_EQ(f->nInstructions(), 2 * pair1->nInstructions());
+    for (size_t i = 0; i < pair1->nInstructions(); ++i)
+    {
+        EXPECT_EQ(pair1->getInstruction(i)->toString(), pair2->getInstruction(i)->toString());
+    }
+    // Equal up to a global phase
+    for (const auto& pair : { pair1, pair2 })
+    {
+        const auto uMatAfter = calcUMat(pair);
+        EXPECT_NEAR(std::abs((uMatBefore.adjoint() * uMatAfter).trace()), 4.0, 1e-6);
+    }
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize(argc, argv);
   ::testing::InitGoogleTest(&argc, argv);
@@ -5,6 +5,8 @@
 #include <math.h> 
 #include "exprtk.hpp"
 #include "Pulse.hpp"
+#include <mutex>
+#include <sstream>
 
 using symbol_table_t = exprtk::symbol_table<double>;
 using expression_t = exprtk::expression<double>;
@@ -50,6 +52,34 @@ namespace {
         }
         return result;
     }
+
+    // Optimized pulses of the previous solves, by system and optimization
+    // configs, e.g. the same gate sequence lowered for each circuit of a batch.
+    std::mutex g_optimPulsesMutex;
+    std::map<std::string, std::vector<std::shared_ptr<xacc::Instruction>>> g_optimPulses;
+
+    std::string optimPulsesKey(const xacc::HeterogeneousMap& in_configs)
+    {
+        std::stringstream ss;
+        ss.precision(17);
+        const auto addList = [&ss](const auto& in_list) {
+            ss << in_list.size() << ":";
+            for (const auto& elem : in_list)
+            {
+                ss << elem << ";";
+            }
+            ss << "|";
+        };
+        ss << in_configs.getString("method") << "|" << in_configs.get<int>("dimension") << "|";
+        addList(in_configs.get<std::vector<std::complex<double>>>("target-U"));
+        addList(in_configs.get<std::vector<std::string>>("control-params"));
+        addList(in_configs.get<std::vector<std::string>>("control-funcs"));
+        addList(in_configs.get<std::vector<double>>("initial-parameters"));
+        addList(in_configs.get<std::vector<std::string>>("control-H"));
+        ss << in_configs.getString("static-H") << "|" << in_configs.get<double>("max-time") << "|"
+           << in_configs.get<double>("dt") << "|" << in_configs.getString("hamiltonian-json");
+        return ss.str();
+    }
 }
 
 namespace xacc {
@@ -63,6 +93,8 @@ namespace quantum {
     // This must match the number and order of channels available.
     // Uncontrolled channels can be left as empty strings.
     // (5) 'max-time': time duration for the pulse optimizer when doing pulse optimization.
+    // (6) 'cache': false to always run the optimization. Otherwise, the optimized
+    // pulses are reused for the same target unitary, system and configs.
     void PulseTransform::apply(std::shared_ptr<CompositeInstruction> program, 
                                 const std::shared_ptr<Accelerator> accelerator,
                                 const HeterogeneousMap& options)
@@ -193,6 +225,23 @@ namespace quantum {
             std::make_pair("hamiltonian-json", hamJsonStr)
         };
 
+        const bool useCache = !options.keyExists<bool>("cache") || options.get<bool>("cache");
+        const std::string cacheKey = useCache ? optimPulsesKey(pulseOptimConfigs) : "";
+        if (useCache)
+        {
+            std::lock_guard<std::mutex> lock(g_optimPulsesMutex);
+            const auto iter = g_optimPulses.find(cacheKey);
+            if (iter != g_optimPulses.end())
+            {
+                program->clear();
+                for (const auto& pulse : iter->second)
+                {
+                    program->addInstruction(pulse->clone());
+                }
+                return;
+            }
+        }
+
         auto optimizer = xacc::getOptimizer("quantum-control", pulseOptimConfigs);
         // Perform pulse IR transformation
         const auto optimResult = optimizer->optimize();
@@ -284,6 +333,17 @@ namespace quantum {
             }
         }
 
+        if (useCache)
+        {
+            std::vector<std::shared_ptr<xacc::Instruction>> pulses;
+            for (auto& pulse : program->getInstructions())
+            {
+                pulses.emplace_back(pulse->clone());
+            }
+            std::lock_guard<std::mutex> lock(g_optimPulsesMutex);
+            g_optimPulses.emplace(cacheKey, std::move(pulses));
+        }
+
         // Debug:
         std::cout << "Transformed Composite: \n" << program->toString() << "\n";
     }
@@ -15,6 +15,7 @@
 #include "CountGatesOfTypeVisitor.hpp"
 #include "CommonGates.hpp"
 #include "Circuit.hpp"
+#include "CircuitDag.hpp"
 #include "GateIR.hpp"
 #include "Utils.hpp"
 #include "xacc_service.hpp"
@@ -22,6 +23,8 @@
 #include <assert.h>
 #include "PhasePolynomialRepresentation.hpp"
 #include <regex>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace {
   // Convert InstructionParameter (i.e. a variant) to double,
@@ -73,169 +76,107 @@ void CircuitOptimizer::apply(std::shared_ptr<CompositeInstruction> gateFunction,
 
   tryPermuteAndCancelXGate(gateFunction);
   tryReduceHadamardGates(gateFunction);
-  tryRotationMergingUsingPhasePolynomials(gateFunction);
+  // The whole-circuit phase folding subsumes the sub-circuit rotation merging.
+  if (options.keyExists<bool>("phase-folding") &&
+      options.get<bool>("phase-folding")) {
+    tryPhaseFolding(gateFunction);
+  } else {
+    tryRotationMergingUsingPhasePolynomials(gateFunction);
+  }
 
-  auto isRotation = [](const std::string inst) {
+  auto isRotation = [](const std::string &inst) {
     return inst == "Rz" || inst == "Ry" || inst == "Rx";
   };
 
-  auto ipToDouble = [](xacc::InstructionParameter p) {
-    if (p.which() == 0) {
-      return (double)p.as<int>();
-    } else if (p.which() == 1) {
-      return p.as<double>();
-    } else {
-      std::stringstream s;
-      s << p.toString();
-      xacc::error("CircuitOptimizer: invalid gate parameter " +
-                  std::to_string(p.which()) + ", " + s.str());
+  std::shared_ptr<ExpressionParsingUtil> parsingUtil;
+  // Zero rotations: Rz(theta<1e-12), or things like Rz(0 * t)
+  auto isZeroRotation = [&](const InstPtr &inst) {
+    auto param = inst->getParameter(0);
+    if (!param.isVariable()) {
+      return std::fabs(ipToDouble(param)) < 1e-12;
     }
-    return 0.0;
+    auto split = xacc::split(param.toString(), '*');
+    if (split.size() != 2) {
+      return false;
+    }
+    xacc::trim(split[0]);
+    xacc::trim(split[1]);
+    if (!parsingUtil) {
+      parsingUtil = xacc::getService<ExpressionParsingUtil>("exprtk");
+    }
+    double d;
+    return parsingUtil->isConstant(split[0], d) && std::fabs(d) < 1e-12 &&
+           xacc::container::contains(gateFunction->getVariables(), split[1]);
   };
 
-  int nTries = 2;
-
-  //   for (auto &k : gateir->getComposites()) {
-  for (int j = 0; j < nTries; ++j) {
-
-    // Remove any zero rotations (Rz(theta<1e-12))
-    for (int i = 0; i < gateFunction->nInstructions(); i++) {
-      auto inst = gateFunction->getInstruction(i);
-      if (isRotation(inst->name())) {
-        auto param = inst->getParameter(0);
-        if (!param.isVariable()) {
-          double val = ipToDouble(param);
-          if (std::fabs(val) < 1e-12) {
-            inst->disable();
-          }
-        } else {
-            // Check for 0 * t or things like that
-            auto parsingUtil = xacc::getService<ExpressionParsingUtil>("exprtk");
-            auto expr = param.toString();
-            auto split = xacc::split(expr, '*');
-            if (split.size() == 2) {
-                xacc::trim(split[0]);
-                xacc::trim(split[1]);
-                auto coeff_str = split[0];
-                double d;
-                bool is_constant = parsingUtil->isConstant(coeff_str, d);
-                if (is_constant && std::fabs(d) < 1e-12 && xacc::container::contains(gateFunction->getVariables(), split[1])) {
-                    // then this is 0 * var, can remove
-                    inst->disable();
-                }
-            }
-        }
-      }
+  // The peephole rewrites below are applied to a fixed point with a
+  // worklist: a rewrite can only create new matches for the nodes before
+  // it on its wires, hence only those are revisited.
+  CircuitDag dag(gateFunction);
+  std::vector<CircuitDag::NodeId> worklist;
+  std::vector<bool> inWorklist(dag.nbNodes(), true);
+  worklist.reserve(dag.nbNodes());
+  // Popped in circuit order
+  for (CircuitDag::NodeId node = dag.nbNodes(); node-- > 0;) {
+    worklist.emplace_back(node);
+  }
+  const auto enqueue = [&](CircuitDag::NodeId node) {
+    if (node != CircuitDag::NONE && !inWorklist[node]) {
+      inWorklist[node] = true;
+      worklist.emplace_back(node);
     }
-    
-    // Remove all CNOT(p,q) CNOT(p,q) pairs
-    while (true) {
-      bool modified = false;
-      gateFunction->removeDisabled();
-      // gateFunction = std::dynamic_pointer_cast<Circuit>(
-      // gateFunction->enabledView());
-      auto graphView = gateFunction->toGraph();
-      for (int i = 1; i < graphView->order() - 2; i++) {
-        auto node = graphView->getVertexProperties(i);
-        if (node.getString("name") == "CNOT" &&
-            gateFunction->getInstruction(node.get<std::size_t>("id") - 1)
-                ->isEnabled()) {
-          auto nAsVec = graphView->getNeighborList(node.get<std::size_t>("id"));
-          // std::vector<int> nAsVec(neighbors.begin(), neighbors.end());
-          // Note: There is an edge-case if the CNOT is last gate on a pair of qubit wires,
-          // i.e. both of its neighbors will be the final state node.
-          // In that case, we need to skip.
-          if (nAsVec[0] == nAsVec[1] && nAsVec[0] != graphView->order() - 1) {
-            // Check that the neighbor gate is indeed a CNOT gate, i.e. not a different 2-qubit gate.
-            if (gateFunction->getInstruction(nAsVec[0] - 1)->name() == "CNOT") {
-              gateFunction->getInstruction(node.get<std::size_t>("id") - 1)->disable();
-              gateFunction->getInstruction(nAsVec[0] - 1)->disable();
-              modified = true;
-              break;
-            }
-          }
-        }
-      }
-      if (!modified)
-        break;
+  };
+  const auto removeNode = [&](CircuitDag::NodeId node) {
+    for (const auto qubit : dag.wires(node)) {
+      enqueue(dag.prev(node, qubit));
     }
-    // Remove all H(p)H(p) pairs
-    while (true) {
-      bool modified = false;
-      gateFunction->removeDisabled();
-      // gateFunction = std::dynamic_pointer_cast<Circuit>(
-      // gateFunction->enabledView());
-      auto graphView = gateFunction->toGraph();
-
-      for (int i = 1; i < graphView->order() - 2; ++i) {
-        auto node = graphView->getVertexProperties(i);
-
-        auto nAsVec = graphView->getNeighborList(node.get<std::size_t>("id"));
-        //   std::vector<int> nAsVec(adj.begin(), adj.end());
-        if (nAsVec.size() == 1) {
-          auto nextNode = graphView->getVertexProperties(nAsVec[0]);
-          if (node.getString("name") == "H" &&
-              nextNode.getString("name") == "H") {
-            gateFunction->getInstruction(node.get<std::size_t>("id") - 1)->disable();
-            gateFunction->getInstruction(nAsVec[0] - 1)->disable();
-            modified = true;
-            break;
-          }
-        }
-      }
+    dag.remove(node);
+  };
 
-      if (!modified)
-        break;
+  while (!worklist.empty()) {
+    const auto node = worklist.back();
+    worklist.pop_back();
+    inWorklist[node] = false;
+    if (dag.isRemoved(node)) {
+      continue;
+    }
+    const auto &inst = dag.instruction(node);
+    const auto name = inst->name();
+    if (isRotation(name) && isZeroRotation(inst)) {
+      removeNode(node);
+      continue;
+    }
+    const auto nextNode = dag.commonSuccessor(node);
+    if (nextNode == CircuitDag::NONE) {
+      continue;
+    }
+    const auto &nextInst = dag.instruction(nextNode);
+    if (nextInst->name() != name) {
+      continue;
+    }
+    // Remove CNOT(p,q) CNOT(p,q) and H(p)H(p) pairs
+    if ((name == "CNOT" && nextInst->bits() == inst->bits()) || name == "H") {
+      removeNode(node);
+      dag.remove(nextNode);
+      continue;
     }
     // Merge adjacent rotation gates Rz()Rz() or Rx()Rx() or Ry()Ry()
-    while (true) {
-      bool modified = false;
-      gateFunction->removeDisabled();
-
-      // gateFunction =
-      // std::dynamic_pointer_cast<Circuit>(gateFunction->enabledView());
-      auto graphView = gateFunction->toGraph();
-      // start/end nodes get added: start at 1, stop at n-2 b/c last will be n-2
-      // neighbor
-      for (int i = 1; i < graphView->order() - 2; i++) {
-        auto node = graphView->getVertexProperties(i);
-        auto nAsVec = graphView->getNeighborList(node.get<std::size_t>("id"));
-        // if it has more than 1 neighbor, don't consider
-        if (nAsVec.size() == 1) {
-          auto nextNode = graphView->getVertexProperties(nAsVec[0]);
-          if (isRotation(node.getString("name")) &&
-              isRotation(nextNode.getString("name")) &&
-              node.getString("name") == nextNode.getString("name")) {
-            auto val1 =
-                ipToDouble(gateFunction->getInstruction(node.get<std::size_t>("id") - 1)
-                               ->getParameter(0));
-            auto val2 = ipToDouble(
-                gateFunction->getInstruction(nextNode.get<std::size_t>("id") - 1)
-                    ->getParameter(0));
-
-            if (std::fabs(val1 + val2) < 1e-12) {
-              gateFunction->getInstruction(node.get<std::size_t>("id") - 1)->disable();
-              gateFunction->getInstruction(nextNode.get<std::size_t>("id") - 1)
-                  ->disable();
-            } else {
-              InstructionParameter tmp(val1 + val2);
-              gateFunction->getInstruction(node.get<std::size_t>("id") - 1)
-                  ->setParameter(0, tmp);
-              gateFunction->getInstruction(nextNode.get<std::size_t>("id") - 1)
-                  ->disable();
-            }
-            modified = true;
-            break;
-          }
-        }
+    if (isRotation(name) && !inst->getParameter(0).isVariable() &&
+        !nextInst->getParameter(0).isVariable()) {
+      const auto val1 = ipToDouble(inst->getParameter(0));
+      const auto val2 = ipToDouble(nextInst->getParameter(0));
+      dag.remove(nextNode);
+      if (std::fabs(val1 + val2) < 1e-12) {
+        removeNode(node);
+      } else {
+        InstructionParameter tmp(val1 + val2);
+        inst->setParameter(0, tmp);
+        // Absorb the following rotations
+        enqueue(node);
       }
-
-      if (!modified)
-        break;
     }
   }
-  //   }
-  return;
+  dag.toCircuit(gateFunction);
 }
 
 bool CircuitOptimizer::tryPermuteAndCancelXGate(std::shared_ptr<CompositeInstruction>& io_program) {
@@ -247,55 +188,39 @@ bool CircuitOptimizer::tryPermuteAndCancelXGate(std::shared_ptr<CompositeInstruc
   // and *negate* that control line. Then, the negated control can be further optimized during decomposition.
   // See Section 4.3 of https://arxiv.org/pdf/1710.07345.pdf for details.
   // ========================================
-  std::vector<int> removedInstructionIdx;
-  for (int i = 0; i < io_program->nInstructions(); ++i) {
-    const auto& inst = io_program->getInstruction(i);
-    if (inst->name() == "X") {
-      if (container::contains(removedInstructionIdx, i)) {
-        // If this X gate has been marked for removal (by looking ahead from a previous X gate),
-        // just skip it and continue to the next gate.
-        continue;
+  // Walk the qubit wire of each X gate: the gates on other qubits are not on
+  // the wire, hence are permuted through implicitly.
+  CircuitDag dag(io_program);
+  bool removed = false;
+  for (CircuitDag::NodeId node = 0; node < dag.nbNodes(); ++node) {
+    if (dag.isRemoved(node) ||
+        dag.instruction(node)->opcode() != GateOpcode::X) {
+      continue;
+    }
+    const auto qubitIdx = dag.instruction(node)->bits()[0];
+    for (auto nextNode = dag.next(node, qubitIdx);
+         nextNode != CircuitDag::NONE; nextNode = dag.next(nextNode, qubitIdx)) {
+      const auto &nextInst = dag.instruction(nextNode);
+      if (nextInst->opcode() == GateOpcode::X) {
+        // Found an adjacent X after permutation
+        // Cancel both of them and stop the look-ahead
+        dag.remove(node);
+        dag.remove(nextNode);
+        removed = true;
+        break;
       }
-
-      const auto qubitIdx = inst->bits()[0];
-      for (int lookAheadIdx = i + 1; lookAheadIdx < io_program->nInstructions(); ++lookAheadIdx) {
-        const auto& nextInst = io_program->getInstruction(lookAheadIdx);
-        if (nextInst->name() == "X" && nextInst->bits()[0] == qubitIdx) {
-          // Found an adjacent X after permutation
-          // Cancel both of them and break the look-ahead loop
-          removedInstructionIdx.emplace_back(i);
-          removedInstructionIdx.emplace_back(lookAheadIdx);
-          break;
-        }
-
-        if ((nextInst->name() == "I") ||
-            !container::contains(nextInst->bits(), qubitIdx) ||
-            (nextInst->name() == "CNOT" &&  nextInst->bits()[1] == qubitIdx)) {
-              continue;
-        } else {
-          // we cannot move any further, break the look-ahead loop.
-          break;
-        }
+      if (nextInst->opcode() != GateOpcode::I &&
+          !(nextInst->opcode() == GateOpcode::CNOT && nextInst->bits()[1] == qubitIdx)) {
+        // we cannot move any further, stop the look-ahead.
+        break;
       }
     }
   }
-  // There must be pairs of X gates.
-  assert(removedInstructionIdx.size() % 2 == 0);
-  // This list must only contain unique indices.
-  assert(std::unique(removedInstructionIdx.begin(), removedInstructionIdx.end()) == removedInstructionIdx.end());
-  // Sort the list of instruction indices before removal (left to right)
-  std::sort(removedInstructionIdx.begin(), removedInstructionIdx.end());
-  // Remove those X instructions from the circuit
-  for (int i = 0; i < removedInstructionIdx.size(); ++i) {
-    // Since we are removing one instruction at a time,
-    // the indices will be shifted by one after each removal.
-    // Hence, adjust the index accordingly.
-    const int instIndexToRemove = removedInstructionIdx[i] - i;
-    assert(io_program->getInstruction(instIndexToRemove)->name() == "X");
-    io_program->removeInstruction(instIndexToRemove);
-  }
   // If we have found and removed some redundant X instructions, returns true.
-  return !removedInstructionIdx.empty();
+  if (removed) {
+    dag.toCircuit(io_program);
+  }
+  return removed;
 }
 
 bool CircuitOptimizer::tryReduceHadamardGates(std::shared_ptr<CompositeInstruction>& io_program) {
@@ -310,6 +235,15 @@ bool CircuitOptimizer::tryReduceHadamardGates(std::shared_ptr<CompositeInstructi
       hadamardNodeIds.emplace_back(node.get<std::size_t>("id"));
     }
   }
+  // For constant time lookups: the set of Hadamard nodes, and the Hadamard
+  // nodes (in order) before each node.
+  const std::unordered_set<std::size_t> hadamardNodeSet(hadamardNodeIds.begin(),
+                                                        hadamardNodeIds.end());
+  std::unordered_map<std::size_t, std::vector<std::size_t>> hadamardsBefore;
+  for (const auto& hadamardNode : hadamardNodeIds) {
+    hadamardsBefore[graphView->getNeighborList(hadamardNode)[0]].emplace_back(
+        hadamardNode);
+  }
 
   std::vector<std::vector<std::size_t>> matchedReductionPatterns;
   // Set of Hadamard node Ids that have already been matched against a pattern,
@@ -319,7 +253,7 @@ bool CircuitOptimizer::tryReduceHadamardGates(std::shared_ptr<CompositeInstructi
   std::unordered_set<std::size_t> matchedHadamardNodeIds;
 
   for (const auto& hadamardNode: hadamardNodeIds) {
-    if (container::contains(matchedHadamardNodeIds, hadamardNode)) {
+    if (matchedHadamardNodeIds.count(hadamardNode)) {
       continue;
     }
 
@@ -342,11 +276,11 @@ bool CircuitOptimizer::tryReduceHadamardGates(std::shared_ptr<CompositeInstructi
       const auto cnotInst = io_program->getInstruction(nextNode.get<std::size_t>("id") - 1);
       const auto cnotNeighborNodes = graphView->getNeighborList(nextNode.get<std::size_t>("id"));
       if (cnotNeighborNodes.size() == 2) {
-        if (container::contains(hadamardNodeIds, cnotNeighborNodes[0]) && container::contains(hadamardNodeIds, cnotNeighborNodes[1])) {
+        if (hadamardNodeSet.count(cnotNeighborNodes[0]) && hadamardNodeSet.count(cnotNeighborNodes[1])) {
           // Try to find the remaining left leg
           std::size_t remainingHadamardNodeId = 0;
-          for (const auto& checkNode: hadamardNodeIds) {
-            if (checkNode != hadamardNode && graphView->getNeighborList(checkNode)[0] == nextNode.get<std::size_t>("id")) {
+          for (const auto& checkNode: hadamardsBefore[nextNode.get<std::size_t>("id")]) {
+            if (checkNode != hadamardNode) {
               remainingHadamardNodeId = checkNode;
               break;
             }
@@ -385,7 +319,7 @@ bool CircuitOptimizer::tryReduceHadamardGates(std::shared_ptr<CompositeInstructi
         const auto phaseGateNeighborNode = graphView->getVertexProperties(phaseGateNeighborNodeIds.front());
         if (phaseGateNeighborNode.getString("name") == "H") {
           // Got it, this is the H - P - H (or P dagger)
-          assert(container::contains(hadamardNodeIds, phaseGateNeighborNode.get<std::size_t>("id")));
+          assert(hadamardNodeSet.count(phaseGateNeighborNode.get<std::size_t>("id")));
           matchedReductionPatterns.emplace_back(std::vector<std::size_t>({ hadamardNode, nextNode.get<std::size_t>("id"), phaseGateNeighborNode.get<std::size_t>("id") }));
           // Add the two Hadamard gates to the tracking list
           matchedHadamardNodeIds.emplace(hadamardNode);
@@ -403,7 +337,7 @@ bool CircuitOptimizer::tryReduceHadamardGates(std::shared_ptr<CompositeInstructi
             const auto instIdx = nodeProps.get<std::size_t>("id") - 1;
             if (instIdx < io_program->nInstructions()) {
               const auto inst = io_program->getInstruction(instIdx);
-              if (inst->name() == "CNOT" && inst->bits()[1] == in_qubitIndex) {
+              if (inst->opcode() == GateOpcode::CNOT && inst->bits()[1] == in_qubitIndex) {
                 io_cnotNodeIdToAppend.emplace_back(neighbor);
                 return true;
               }
@@ -452,7 +386,7 @@ bool CircuitOptimizer::tryReduceHadamardGates(std::shared_ptr<CompositeInstructi
           if (matchingRzNodeIdAfterCnot != 0) {
             // Check the last H gate of the pattern
             const auto lastNodeToCheck = graphView->getNeighborList(matchingRzNodeIdAfterCnot)[0];
-            if (container::contains(hadamardNodeIds, lastNodeToCheck)) {
+            if (hadamardNodeSet.count(lastNodeToCheck)) {
               // Found the complete pattern
               // Sanity check: it is indeed an Hadamard on the same qubit line
               assert(io_program->getInstruction(lastNodeToCheck - 1)->bits()[0] == qubitIndex);
@@ -504,7 +438,7 @@ bool CircuitOptimizer::tryReduceHadamardGates(std::shared_ptr<CompositeInstructi
         io_program->replaceInstruction(matchedPattern[2] - 1,
           gateRegistry->createInstruction("Rz", phaseGate->bits(), { M_PI_2 }));
       }
-    } else if (matchedPattern.size() == 5 && container::contains(hadamardNodeIds, matchedPattern[0]) && container::contains(hadamardNodeIds, matchedPattern[1])) {
+    } else if (matchedPattern.size() == 5 && hadamardNodeSet.count(matchedPattern[0]) && hadamardNodeSet.count(matchedPattern[1])) {
       // Pattern: H - H - CNOT - H - H pattern
       // Remove all four H gates and invert the CNOT
       io_program->getInstruction(matchedPattern[0] - 1)->disable();
@@ -525,14 +459,14 @@ bool CircuitOptimizer::tryReduceHadamardGates(std::shared_ptr<CompositeInstructi
       // Last case: H-P-CNOT-P_dag-H
       assert(matchedPattern.size() >= 5);
       // We just need to remove the leading and trailing H gates then inverse the normalized Rz phase.
-      assert(io_program->getInstruction(matchedPattern.front() - 1)->name() == "H");
-      assert(io_program->getInstruction(matchedPattern.back() - 1)->name() == "H");
+      assert(io_program->getInstruction(matchedPattern.front() - 1)->opcode() == GateOpcode::H);
+      assert(io_program->getInstruction(matchedPattern.back() - 1)->opcode() == GateOpcode::H);
       io_program->getInstruction(matchedPattern.front() - 1)->disable();
       io_program->getInstruction(matchedPattern.back() - 1)->disable();
       // Inverse the normalized rotation phase: P->P_dag and vice versa
       auto headRz = io_program->getInstruction(matchedPattern[1] - 1);
       auto tailRz = io_program->getInstruction(matchedPattern[matchedPattern.size() - 2]- 1);
-      assert(headRz->name() == "Rz" && tailRz->name() == "Rz");
+      assert(headRz->opcode() == GateOpcode::Rz && tailRz->opcode() == GateOpcode::Rz);
       const auto headRzAngle = getNormalizedRotationAngle(ipToDouble(headRz->getParameter(0)));
       const auto tailRzAngle = getNormalizedRotationAngle(ipToDouble(tailRz->getParameter(0)));
       // They must have opposite side (+/- pi/2)
@@ -583,7 +517,7 @@ bool CircuitOptimizer::tryRotationMergingUsingPhasePolynomials(std::shared_ptr<C
             continue;
           }
           const auto& inst = io_program->getInstruction(*it - 1);
-          if (inst->name() != "Rz" && inst->name() != "X") {
+          if (inst->opcode() != GateOpcode::Rz && inst->opcode() != GateOpcode::X) {
             // It is no longer { X, Rz, CNOT } sub-circuit
             return *it;
           }
@@ -602,14 +536,14 @@ bool CircuitOptimizer::tryRotationMergingUsingPhasePolynomials(std::shared_ptr<C
       const std::function<void(int, int)> findRightBoundary = [&](int in_qbitIdx, int in_startNodeId) -> void {
         if (in_startNodeId < graphView->order() - 1) {
           const auto& inst = io_program->getInstruction(in_startNodeId - 1);
-          if (inst->name() == "Rz" || inst->name() == "X") {
+          if (inst->opcode() == GateOpcode::Rz || inst->opcode() == GateOpcode::X) {
             assert(inst->bits().size() == 1 && inst->bits()[0] == in_qbitIdx);
             const auto subsequentNodes = graphView->getNeighborList(in_startNodeId);
             assert(subsequentNodes.size() == 1);
             // Traverse to the right
             assert(inst->bits()[0] == in_qbitIdx);
             return findRightBoundary(inst->bits()[0], subsequentNodes[0]);
-          } else if (inst->name() == "CNOT") {
+          } else if (inst->opcode() == GateOpcode::CNOT) {
             for (const auto& bit: inst->bits()) {
               const auto neighborNodes = graphView->getNeighborList(in_startNodeId);
               if (qubitToBoundary.find(bit) == qubitToBoundary.end()) {
@@ -678,7 +612,7 @@ bool CircuitOptimizer::tryRotationMergingUsingPhasePolynomials(std::shared_ptr<C
             }
           }
           else if (instruction->bits().size() == 2) {
-            assert(instruction->name() == "CNOT");
+            assert(instruction->opcode() == GateOpcode::CNOT);
             // If the control is *outside* the boundary, we need to terminate, hence prune the subcircuit.
             const auto controlIdx = instruction->bits()[0];
             const auto targetIdx = instruction->bits()[1];
@@ -697,7 +631,7 @@ bool CircuitOptimizer::tryRotationMergingUsingPhasePolynomials(std::shared_ptr<C
 
         int countRz = 0;
         for (const auto& inst: subCircuit) {
-          if (inst->name() == "Rz") {
+          if (inst->opcode() == GateOpcode::Rz) {
             countRz++;
           }
         }
@@ -713,7 +647,7 @@ bool CircuitOptimizer::tryRotationMergingUsingPhasePolynomials(std::shared_ptr<C
           PhasePolynomialRep phasePolynomialRep(qubitToNodeIds.size(), subCircuit);
           if (phasePolynomialRep.hasMergableGates()) {
             for (const auto& gate: subCircuit) {
-              if (gate->name() == "Rz" && gate->isEnabled()) {
+              if (gate->opcode() == GateOpcode::Rz && gate->isEnabled()) {
                 const auto& affineFunc = phasePolynomialRep.getAffineFunctionOfRzGate(gate.get());
                 const auto& gatesThatHaveSameAffineFunc = phasePolynomialRep.getRzGatesWithAffineFunction(affineFunc);
                 if (gatesThatHaveSameAffineFunc.size() > 1) {
@@ -747,5 +681,71 @@ bool CircuitOptimizer::tryRotationMergingUsingPhasePolynomials(std::shared_ptr<C
 
   return true;
 }
+
+bool CircuitOptimizer::tryPhaseFolding(std::shared_ptr<CompositeInstruction>& io_program) {
+  const auto instructions = io_program->getInstructions();
+  PhaseFoldingRep phaseFoldingRep(instructions);
+  auto gateRegistry = xacc::getService<IRProvider>("quantum");
+  // The merged rotation of each term replaces its first gate.
+  std::vector<bool> isMerged(instructions.size(), false);
+  std::unordered_map<size_t, std::vector<InstPtr>> replacements;
+  for (const auto& term: phaseFoldingRep.getPhaseTerms()) {
+    if (term.gates.size() < 2) {
+      continue;
+    }
+    double totalAngle = 0.0;
+    // Only Z, S, T (and daggers): keep a Clifford+T circuit
+    bool isCliffordT = true;
+    for (size_t i = 0; i < term.gates.size(); ++i) {
+      const auto& inst = instructions[term.gates[i]];
+      double angle = 0.0;
+      PhaseFoldingRep::getPhaseAngle(*inst, angle);
+      totalAngle += term.negated[i] ? -angle : angle;
+      isCliffordT = isCliffordT && inst->opcode() != GateOpcode::Rz &&
+                    inst->opcode() != GateOpcode::U1;
+      isMerged[term.gates[i]] = true;
+    }
+
+    const auto& firstInst = instructions[term.gates[0]];
+    const double angle = getNormalizedRotationAngle(term.negated[0] ? -totalAngle : totalAngle);
+    auto& newGates = replacements[term.gates[0]];
+    const long nbQuarterPis = std::lround(angle / M_PI_4);
+    if (std::fabs(angle) < ANGLE_EPS_RAD) {
+      // Cancelled out
+    } else if (isCliffordT && std::fabs(angle - nbQuarterPis * M_PI_4) < ANGLE_EPS_RAD) {
+      static const std::unordered_map<long, std::vector<std::string>> QUARTER_PI_GATES {
+        { -3, { "Sdg", "Tdg" } }, { -2, { "Sdg" } }, { -1, { "Tdg" } }, { 1, { "T" } }, 
+        { 2, { "S" } }, { 3, { "S", "T" } }, { 4, { "Z" } }
+      };
+      for (const auto& gateName: QUARTER_PI_GATES.at(nbQuarterPis)) {
+        newGates.emplace_back(gateRegistry->createInstruction(gateName, firstInst->bits()));
+      }
+    } else {
+      newGates.emplace_back(gateRegistry->createInstruction("Rz", firstInst->bits(), { angle }));
+    }
+    for (auto& newGate: newGates) {
+      newGate->setBufferNames(firstInst->getBufferNames());
+    }
+  }
+
+  if (replacements.empty()) {
+    return false;
+  }
+  std::vector<InstPtr> newInstructions;
+  newInstructions.reserve(instructions.size());
+  for (size_t i = 0; i < instructions.size(); ++i) {
+    if (!isMerged[i]) {
+      newInstructions.emplace_back(instructions[i]);
+      continue;
+    }
+    const auto iter = replacements.find(i);
+    if (iter != replacements.end()) {
+      newInstructions.insert(newInstructions.end(), iter->second.begin(), iter->second.end());
+    }
+  }
+  io_program->clear();
+  io_program->addInstructions(std::move(newInstructions), false);
+  return true;
+}
 } // namespace quantum
 } // namespace xacc
\ No newline at end of file
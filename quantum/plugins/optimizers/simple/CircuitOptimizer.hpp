@@ -53,6 +53,12 @@ private:
   // Identify and merge Rz rotation gates using the *phase polynomials* representation.
   // This implements routine #4 in https://arxiv.org/pdf/1710.07345.pdf
   bool tryRotationMergingUsingPhasePolynomials(std::shared_ptr<CompositeInstruction>& io_program);
+
+  // Merge the Rz and phase (Z, S, T, ...) gates of the whole circuit that apply to
+  // the same parity of the qubits (PhaseFoldingRep), i.e. phase folding: 
+  // reduces the T-count of Clifford+T circuits in linear time.
+  // Enabled by the "phase-folding" option (instead of the sub-circuit merging above).
+  bool tryPhaseFolding(std::shared_ptr<CompositeInstruction>& io_program);
 };
 } // namespace quantum
 } // namespace xacc
@@ -1,6 +1,8 @@
 #include "PhasePolynomialRepresentation.hpp"
 #include "Instruction.hpp"
 #include <cassert>
+#include <cmath>
+#include <unordered_set>
 
 namespace {
     // Combine two affine func:
@@ -16,6 +18,44 @@ namespace {
 
         return result;
     }
+
+    constexpr size_t BITS_PER_WORD = 64;
+    constexpr size_t NO_BIT = static_cast<size_t>(-1);
+    // Size of the parities for a number of wires: room for as many 
+    // new variables as wires (and at least 64) before a compaction.
+    size_t nbWords(size_t in_nbWires) {
+        return (2 * in_nbWires + 2 * BITS_PER_WORD - 1) / BITS_PER_WORD;
+    }
+
+    bool testBit(const PackedParity& in_parity, size_t in_bit) {
+        return (in_parity[in_bit / BITS_PER_WORD] >> (in_bit % BITS_PER_WORD)) & 1;
+    }
+
+    void setBit(PackedParity& io_parity, size_t in_bit) {
+        io_parity[in_bit / BITS_PER_WORD] |= uint64_t(1) << (in_bit % BITS_PER_WORD);
+    }
+
+    void xorParity(PackedParity& io_parity, const PackedParity& in_other) {
+        assert(io_parity.size() == in_other.size());
+        for (size_t i = 0; i < io_parity.size(); ++i) {
+            io_parity[i] ^= in_other[i];
+        }
+    }
+
+    size_t lowestBit(const PackedParity& in_parity) {
+        for (size_t i = 0; i < in_parity.size(); ++i) {
+            if (in_parity[i]) {
+                return i * BITS_PER_WORD + __builtin_ctzll(in_parity[i]);
+            }
+        }
+        return NO_BIT;
+    }
+
+    // Gates that don't change the value of their wires.
+    bool isDiagonal(const std::string& in_name) {
+        static const std::unordered_set<std::string> DIAGONAL_GATES { "I", "Rz", "U1", "Z", "S", "Sdg", "T", "Tdg", "CZ", "CPhase", "CRZ" };
+        return DIAGONAL_GATES.count(in_name) > 0;
+    }
 }
 
 using xacc::Instruction;
@@ -29,7 +69,8 @@ namespace xacc { namespace quantum {
     {
         // This sub-circuit must only contain X, CNOT, or Rz gates.
         assert(std::find_if(in_subCircuit.begin(), in_subCircuit.end(), [](const std::shared_ptr<Instruction>& in_gatePtr){
-            return in_gatePtr->name() != "X" && in_gatePtr->name() != "Rz" && in_gatePtr->name() != "CNOT";
+            const auto opcode = in_gatePtr->opcode();
+            return opcode != xacc::GateOpcode::X && opcode != xacc::GateOpcode::Rz && opcode != xacc::GateOpcode::CNOT;
         }) == in_subCircuit.end());
 
         // Running boolean sequences (left to right) on a particular qubit line
@@ -45,19 +86,19 @@ namespace xacc { namespace quantum {
         }
 
         for (const auto& gate: in_subCircuit) {
-            if (gate->name() == "X") {
+            if (gate->opcode() == xacc::GateOpcode::X) {
                 auto& curentBooleanSequence = currentBooleanSequencePerQubit[gate->bits()[0]];
                 // flip the offset k0 term
                 curentBooleanSequence[0] = !curentBooleanSequence[0];
             }
             
-            if (gate->name() == "CNOT") {
+            if (gate->opcode() == xacc::GateOpcode::CNOT) {
                 const auto& controlAffineFunc = currentBooleanSequencePerQubit[gate->bits()[0]];
                 auto& targetAffineFunc = currentBooleanSequencePerQubit[gate->bits()[1]];
                 targetAffineFunc = combineAffineFunc(controlAffineFunc, targetAffineFunc);    
             }
 
-            if (gate->name() == "Rz") {
+            if (gate->opcode() == xacc::GateOpcode::Rz) {
                 auto& curentBooleanSequence = currentBooleanSequencePerQubit[gate->bits()[0]];
                 // Save the expression
                 m_affineFuncs[gate.get()] = curentBooleanSequence;
@@ -95,5 +136,151 @@ namespace xacc { namespace quantum {
 
         return false;
     }
+
+    size_t PhaseFoldingRep::ParityHash::operator()(const PackedParity& in_parity) const {
+        uint64_t hash = in_parity.size();
+        for (const auto& word: in_parity) {
+            // splitmix64 finalizer
+            uint64_t mixed = word + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+            mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111ebULL;
+            hash ^= mixed ^ (mixed >> 31);
+        }
+        return hash;
+    }
+
+    PhaseFoldingRep::PhaseFoldingRep(const std::vector<std::shared_ptr<Instruction>>& in_circuit) {
+        size_t nbWires = 0;
+        for (const auto& inst: in_circuit) {
+            for (const auto& bit: inst->bits()) {
+                nbWires = std::max(nbWires, bit + 1);
+            }
+        }
+        // Initially, each wire has its own variable.
+        m_nbVariables = nbWires;
+        m_parities.assign(nbWires, PackedParity(nbWords(nbWires), 0));
+        for (size_t wire = 0; wire < nbWires; ++wire) {
+            setBit(m_parities[wire], wire);
+        }
+        m_negated.assign(nbWires, false);
+
+        for (size_t gateIdx = 0; gateIdx < in_circuit.size(); ++gateIdx) {
+            const auto& inst = in_circuit[gateIdx];
+            if (!inst->isEnabled()) {
+                continue;
+            }
+            const auto name = inst->name();
+            const auto bits = inst->bits();
+            double angle = 0.0;
+            if (inst->isComposite() || bits.empty() || name == "Measure" || name == "Reset") {
+                // Barrier: no parity before can be found after.
+                for (size_t wire = 0; wire < nbWires; ++wire) {
+                    setNewVariable(wire);
+                }
+                m_parityToTerm.clear();
+            }
+            else if (name == "CNOT") {
+                xorParity(m_parities[bits[1]], m_parities[bits[0]]);
+                m_negated[bits[1]] = (m_negated[bits[1]] != m_negated[bits[0]]);
+            }
+            else if (name == "X") {
+                m_negated[bits[0]] = !m_negated[bits[0]];
+            }
+            else if (name == "Swap") {
+                std::swap(m_parities[bits[0]], m_parities[bits[1]]);
+                const bool negated = m_negated[bits[0]];
+                m_negated[bits[0]] = m_negated[bits[1]];
+                m_negated[bits[1]] = negated;
+            }
+            else if (bits.size() == 1 && getPhaseAngle(*inst, angle)) {
+                const auto& parity = m_parities[bits[0]];
+                auto iter = m_parityToTerm.find(parity);
+                if (iter == m_parityToTerm.end()) {
+                    iter = m_parityToTerm.emplace(parity, m_terms.size()).first;
+                    m_terms.emplace_back();
+                }
+                auto& term = m_terms[iter->second];
+                term.gates.emplace_back(gateIdx);
+                term.negated.emplace_back(m_negated[bits[0]]);
+            }
+            else if (!isDiagonal(name)) {
+                for (const auto& bit: bits) {
+                    setNewVariable(bit);
+                }
+            }
+        }
+    }
+
+    bool PhaseFoldingRep::getPhaseAngle(Instruction& in_inst, double& out_angle) {
+        const auto name = in_inst.name();
+        if (name == "Rz" || name == "U1") {
+            const auto param = in_inst.getParameter(0);
+            if (param.isVariable()) {
+                return false;
+            }
+            if (param.which() == 0) {
+                out_angle = param.as<int>();
+                return true;
+            }
+            if (param.which() == 1) {
+                out_angle = param.as<double>();
+                return true;
+            }
+            return false;
+        }
+        static const std::unordered_map<std::string, double> FIXED_ANGLES { 
+            { "Z", M_PI }, { "S", M_PI_2 }, { "Sdg", -M_PI_2 }, { "T", M_PI_4 }, { "Tdg", -M_PI_4 } 
+        };
+        const auto iter = FIXED_ANGLES.find(name);
+        if (iter != FIXED_ANGLES.end()) {
+            out_angle = iter->second;
+            return true;
+        }
+        return false;
+    }
+
+    void PhaseFoldingRep::setNewVariable(size_t in_wire) {
+        if (m_nbVariables == m_parities[in_wire].size() * BITS_PER_WORD) {
+            compact();
+        }
+        std::fill(m_parities[in_wire].begin(), m_parities[in_wire].end(), 0);
+        setBit(m_parities[in_wire], m_nbVariables++);
+        m_negated[in_wire] = false;
+    }
+
+    void PhaseFoldingRep::compact() {
+        // Gaussian elimination of the wire parities: the new variables are the basis vectors,
+        // each with a distinct pivot (lowest bit) cleared from the other vectors after it. 
+        const auto nbWires = m_parities.size();
+        std::vector<PackedParity> basis;
+        std::vector<size_t> pivots;
+        std::vector<PackedParity> newParities(nbWires, PackedParity(nbWords(nbWires), 0));
+        for (size_t wire = 0; wire < nbWires; ++wire) {
+            auto residual = m_parities[wire];
+            for (size_t i = 0; i < basis.size(); ++i) {
+                if (testBit(residual, pivots[i])) {
+                    xorParity(residual, basis[i]);
+                    setBit(newParities[wire], i);
+                }
+            }
+            const auto pivot = lowestBit(residual);
+            if (pivot != NO_BIT) {
+                setBit(newParities[wire], basis.size());
+                pivots.emplace_back(pivot);
+                basis.emplace_back(std::move(residual));
+            }
+        }
+
+        std::unordered_map<PackedParity, size_t, ParityHash> parityToTerm;
+        for (size_t wire = 0; wire < nbWires; ++wire) {
+            const auto iter = m_parityToTerm.find(m_parities[wire]);
+            if (iter != m_parityToTerm.end()) {
+                parityToTerm.emplace(newParities[wire], iter->second);
+            }
+        }
+        m_parityToTerm = std::move(parityToTerm);
+        m_parities = std::move(newParities);
+        m_nbVariables = basis.size();
+    }
 } // namespace xacc
 } // namespace quantum
\ No newline at end of file
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <vector>
 #include <unordered_map>
 #include <string>
@@ -6,6 +7,8 @@
 
 // A boolean affine function is a vector of ki's boolean coefficients.
 using BoolAffineFuncType = std::vector<bool>;
+// A boolean linear function packed in 64-bit words: bit i is the coefficient of variable i.
+using PackedParity = std::vector<uint64_t>;
 
 namespace xacc { 
     class Instruction;    
@@ -36,5 +39,49 @@ private:
     std::unordered_map<Instruction*, BoolAffineFuncType> m_affineFuncs;
     std::unordered_map<BoolAffineFuncType, std::vector<Instruction*>> m_affineFuncToGates;
 };
+
+// Phase polynomial of a whole circuit, for *phase folding*: the generalization 
+// of the above to arbitrary circuits (see e.g. https://arxiv.org/pdf/1303.2042.pdf).
+// The value of each qubit wire is an affine function of boolean variables:
+// CNOT, X and Swap gates update the functions, diagonal gates leave them as is  
+// and any other gate sets its wires to new variables (composites, Measure and Reset to all wires).
+// Phase gates (Rz, U1, Z, S, Sdg, T, Tdg with a numeric angle) that have the same parity, 
+// anywhere in the circuit, add up to a single rotation.
+// Parities are grouped by hashing, hence the construction is linear in the number of gates.
+// To bound the size of the parities, the variables are re-expressed in a basis of the wire parities
+// (at most one variable per qubit) when they run out: the phase gates after that point are only merged
+// with those before which have the parity of a wire at that point.
+class PhaseFoldingRep {
+public:
+    // The phase gates of a parity
+    struct PhaseTerm {
+        // Indices in the circuit, in order
+        std::vector<size_t> gates;
+        // Whether the wire has the negated parity (1 + f) at that gate,
+        // i.e. the gate angle adds up with the opposite sign (up to a global phase).
+        std::vector<bool> negated;
+    };
+    PhaseFoldingRep(const std::vector<std::shared_ptr<Instruction>>& in_circuit);
+    // In order of their first gate
+    const std::vector<PhaseTerm>& getPhaseTerms() const { return m_terms; }
+    // The angle of a phase gate (diag(1, exp(i * angle)) up to a global phase), 
+    // false if the instruction is not one (e.g. symbolic angle).
+    static bool getPhaseAngle(Instruction& in_inst, double& out_angle);
+
+private:
+    struct ParityHash {
+        size_t operator()(const PackedParity& in_parity) const;
+    };
+    // Set a wire to a new variable
+    void setNewVariable(size_t in_wire);
+    // Re-express the wire parities (and the terms that have one of them) in a basis of the wire parities.
+    void compact();
+
+    size_t m_nbVariables;
+    std::vector<PackedParity> m_parities;
+    std::vector<bool> m_negated;
+    std::unordered_map<PackedParity, size_t, ParityHash> m_parityToTerm;
+    std::vector<PhaseTerm> m_terms;
+};
 } // end namespace quantum
 } // end namespace xacc
@@ -327,6 +327,25 @@ TEST(CircuitOptimizerTester, checkSimple) {
 
 }
 
+TEST(CircuitOptimizerTester, checkNestedCancellation) {
+    // Each cancellation makes the enclosing pair adjacent.
+    auto compiler = xacc::getService<xacc::Compiler>("xasm");
+    auto program = compiler->compile(
+        R"(__qpu__ void test_nested(qbit q) {
+            CX(q[0], q[1]);
+            H(q[1]);
+            CX(q[1], q[2]);
+            Rz(q[2], 0.5);
+            Rz(q[2], -0.5);
+            CX(q[1], q[2]);
+            H(q[1]);
+            CX(q[0], q[1]);
+        })")->getComposites()[0];
+    auto optimizer = xacc::getService<IRTransformation>("circuit-optimizer");
+    optimizer->apply(program, nullptr);
+    EXPECT_EQ(0, program->nInstructions());
+}
+
 TEST(CircuitOptimizerTester, checkPermuteAndCancelXGate) {
     // Case 1: back-to-back X gates
     {
@@ -677,6 +696,52 @@ TEST(CircuitOptimizerTester, checkRotationMergingUsingPhasePolynomials) {
     }
 }
 
+TEST(CircuitOptimizerTester, checkPhaseFolding) {
+    const auto countGates = [](const std::shared_ptr<CompositeInstruction>& in_program, const std::string& in_name) {
+        int count = 0;
+        for (int i = 0; i < in_program->nInstructions(); ++i) {
+            if (in_program->getInstruction(i)->name() == in_name) {
+                ++count;
+            }
+        }
+        return count;
+    };
+    const auto src = R"(__qpu__ void test_phase_folding(qbit q) {
+        H(q[1]);
+        T(q[0]);
+        CNOT(q[0], q[1]);
+        T(q[1]);
+        CNOT(q[0], q[1]);
+        H(q[1]);
+        CNOT(q[0], q[1]);
+        Tdg(q[0]);
+        T(q[2]);
+        X(q[2]);
+        T(q[2]);
+        X(q[2]);
+    })";
+    auto compiler = xacc::getService<xacc::Compiler>("xasm");
+    auto optimizer = xacc::getService<IRTransformation>("circuit-optimizer");
+    {
+        // Not enabled by default
+        auto program = compiler->compile(src)->getComposites()[0];
+        optimizer->apply(program, nullptr);
+        EXPECT_EQ(countGates(program, "T"), 3);
+        EXPECT_EQ(countGates(program, "Tdg"), 1);
+    }
+    {
+        auto program = compiler->compile(src)->getComposites()[0];
+        optimizer->apply(program, nullptr, {{"phase-folding", true}});
+        std::cout << "FINAL CIRCUIT:\n" << program->toString() << "\n";
+        // T(q[0]) and Tdg(q[0]) (same parity, across the H gates on q[1]) cancel out,
+        // so do the T gates on q[2] and its negation.
+        EXPECT_EQ(program->nInstructions(), 8);
+        EXPECT_EQ(countGates(program, "T"), 1);
+        EXPECT_EQ(countGates(program, "Tdg"), 0);
+        EXPECT_EQ(countGates(program, "X"), 2);
+    }
+}
+
 TEST(CircuitOptimizerTester, checkCCCX) {
   auto compiler = xacc::getService<xacc::Compiler>("staq");
   auto program = compiler
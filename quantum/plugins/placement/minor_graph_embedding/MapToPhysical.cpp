@@ -15,6 +15,17 @@
 #include "xacc.hpp"
 #include "xacc_service.hpp"
 #include "EmbeddingAlgorithm.hpp"
+#include <mutex>
+
+namespace {
+  // Placements by device (signature and connectivity) and program
+  // interaction edges, e.g. the same ansatz placed on each VQE iteration.
+  using PlacementKey =
+      std::tuple<std::string, std::vector<std::pair<int, int>>,
+                 std::vector<std::pair<int, int>>>;
+  std::mutex placementMutex;
+  std::map<PlacementKey, std::vector<std::size_t>> placementCache;
+}
 
 namespace xacc {
 namespace quantum {
@@ -23,12 +34,44 @@ namespace quantum {
                             const std::shared_ptr<Accelerator> acc,
                             const HeterogeneousMap &options) {
 
-    auto embeddingAlgorithm = xacc::getService<EmbeddingAlgorithm>("cmr");
-
     /* BUILD HW GRAPH */
     // get hardware edges
     auto hwConnectivity = acc->getConnectivity();
 
+    std::set<int> nUniquePbBits;
+    std::set<std::pair<int, int>> uniquePbEdges;
+    std::vector<std::pair<int,int>> pbEdges;
+    InstructionIterator it(function);
+    while (it.hasNext()) {
+      // Get next node in the tree
+      auto nextInst = it.next();
+      if (nextInst->isEnabled() && nextInst->bits().size() == 2) {
+        const int q1 = nextInst->bits()[0], q2 = nextInst->bits()[1];
+        if (uniquePbEdges.insert({std::min(q1, q2), std::max(q1, q2)}).second) {
+          pbEdges.push_back({q1, q2});
+        }
+        nUniquePbBits.insert(q1);
+        nUniquePbBits.insert(q2);
+      }
+    }
+
+    // Disabled by 'cache': false
+    const bool useCache =
+        !options.keyExists<bool>("cache") || options.get<bool>("cache");
+    const PlacementKey key{
+        acc->getSignature(),
+        std::vector<std::pair<int, int>>(uniquePbEdges.begin(),
+                                         uniquePbEdges.end()),
+        hwConnectivity};
+    if (useCache) {
+      std::lock_guard<std::mutex> lock(placementMutex);
+      auto iter = placementCache.find(key);
+      if (iter != placementCache.end()) {
+        function->mapBits(iter->second);
+        return;
+      }
+    }
+
     std::map<int, int> physical2Logical, logical2Physical;
     int counter = 0;
     std::set<int> nUniqueBits;
@@ -61,21 +104,6 @@ namespace quantum {
     /* BUILD PB GRAPH from IR */
 
     // passed in a CompositeInstruction
-    auto logicalGraph = function->toGraph();
-    InstructionIterator it(function);
-    std::set<int> nUniquePbBits;
-
-    std::vector<std::pair<int,int>> pbEdges;
-    while (it.hasNext()) {
-      // Get next node in the tree
-      auto nextInst = it.next();
-      if (nextInst->isEnabled() && nextInst->bits().size() == 2) {
-        pbEdges.push_back({nextInst->bits()[0], nextInst->bits()[1]});
-        nUniquePbBits.insert(nextInst->bits()[0]);
-        nUniquePbBits.insert(nextInst->bits()[1]);
-      }
-    }
-
     auto nPbBits = nUniquePbBits.size();
     // create xacc::Graph where everything gets stored
     auto pbGraph = xacc::getService<Graph>("boost-ugraph");
@@ -91,8 +119,19 @@ namespace quantum {
       }
     }
 
-    // Compute the minor graph embedding
-    auto embedding =  embeddingAlgorithm->embed(pbGraph, hwGraph);
+    // Compute the minor graph embedding, the searches (tries) running
+    // concurrently on the task scheduler.
+    std::map<std::string, std::string> embedParams;
+    for (const std::string param : {"tries", "threads", "seed"}) {
+      if (options.keyExists<int>(param)) {
+        embedParams[param] = std::to_string(options.get<int>(param));
+      }
+    }
+    if (!useCache) {
+      embedParams["cache"] = "false";
+    }
+    auto embeddingAlgorithm = xacc::getService<EmbeddingAlgorithm>("cmr");
+    auto embedding = embeddingAlgorithm->embed(pbGraph, hwGraph, embedParams);
     
     std::vector<std::size_t> physicalMap;
     // check the output
@@ -102,6 +141,10 @@ namespace quantum {
       }
       physicalMap.push_back(kv.second[0]);
     }
+    if (useCache) {
+      std::lock_guard<std::mutex> lock(placementMutex);
+      placementCache.emplace(key, physicalMap);
+    }
     // embeddinge values get stored over initial (clobbering)
     function->mapBits(physicalMap);
 
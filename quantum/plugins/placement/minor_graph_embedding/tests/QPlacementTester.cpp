@@ -60,6 +60,26 @@ TEST(QPlacementTester, checkBellSimple) {
 //  EXPECT_EQ(std::vector<int>{4}, bell_composite->getInstruction(3)->bits());
 }
 
+TEST(QPlacementTester, checkCachedPlacement) {
+  auto acc = xacc::getAccelerator("dummy");
+  auto compiler = xacc::getCompiler("xasm");
+  auto A = xacc::getIRTransformation("minor-graph-embedding-placement");
+  std::vector<std::vector<std::size_t>> mappedBits;
+  for (const bool cache : {true, true, false}) {
+    auto program = compiler->compile(R"(__qpu__ void bell_cached(qbit q) {
+      H(q[0]);
+      CX(q[0], q[1]);
+    })")->getComposites()[0];
+    A->apply(program, acc, {{"cache", cache}, {"tries", 4}});
+    mappedBits.push_back(program->getInstruction(1)->bits());
+  }
+  // The cached placement is the one of the first search
+  EXPECT_EQ(mappedBits[0], mappedBits[1]);
+  for (const auto &bits : mappedBits) {
+    EXPECT_TRUE((std::vector<std::size_t>{4, 3}) == bits ||
+                (std::vector<std::size_t>{3, 4}) == bits);
+  }
+}
 
 // subclass Accelerator since can't run real in a test: no http calls
 class DummyAccelerator : public xacc::Accelerator {
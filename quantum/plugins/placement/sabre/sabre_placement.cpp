@@ -0,0 +1,616 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "sabre_placement.hpp"
+#include "xacc.hpp"
+#include "xacc_service.hpp"
+#include "Topology.hpp"
+#include "NoiseModel.hpp"
+#include "StructuralHasher.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <unordered_map>
+
+namespace {
+// The decay of the swapped qubits is reset after this number of SWAPs.
+constexpr size_t DECAY_RESET_INTERVAL = 5;
+
+struct SabreOptions {
+  int iterations = 3;
+  size_t lookaheadSize = 20;
+  double lookaheadWeight = 0.5;
+  double decay = 0.001;
+  // Penalize the candidate SWAPs by their error in the cost function
+  bool noiseAware = false;
+};
+
+// Calibration data of a backend
+struct Calibration {
+  xacc::Topology::Fidelities twoQubitFidelities;
+  // Average of P(0|1) and P(1|0) of each qubit
+  std::vector<double> readoutErrors;
+};
+// Bound on the number of cached calibrations (cleared when reached).
+constexpr size_t MAX_CACHED_CALIBRATIONS = 16;
+
+// Calibration of an IBM backend (properties JSON), only parsed again when
+// the JSON changes.
+std::shared_ptr<const Calibration>
+getCalibration(const std::string &in_backendJson) {
+  using CacheEntry = std::pair<std::string, std::shared_ptr<const Calibration>>;
+  static std::mutex cacheMutex;
+  static std::unordered_multimap<uint64_t, CacheEntry> cache;
+  xacc::StructuralHasher hasher;
+  hasher.add(in_backendJson);
+  const auto key = hasher.value();
+  {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    const auto range = cache.equal_range(key);
+    for (auto iter = range.first; iter != range.second; ++iter) {
+      if (iter->second.first == in_backendJson) {
+        return iter->second.second;
+      }
+    }
+  }
+
+  auto noiseModel = xacc::getService<xacc::NoiseModel>("IBM");
+  noiseModel->initialize({{"backend-json", in_backendJson}});
+  auto calibration = std::make_shared<Calibration>();
+  calibration->twoQubitFidelities = noiseModel->averageTwoQubitGateFidelity();
+  for (const auto &[meas0Prep1, meas1Prep0] : noiseModel->readoutErrors()) {
+    calibration->readoutErrors.emplace_back(0.5 * (meas0Prep1 + meas1Prep0));
+  }
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  if (cache.size() >= MAX_CACHED_CALIBRATIONS) {
+    cache.clear();
+  }
+  cache.emplace(key, CacheEntry{in_backendJson, calibration});
+  return calibration;
+}
+
+// Dependencies between the operations (by logical qubit).
+struct OperationDag {
+  OperationDag(const std::vector<std::vector<size_t>> &in_operations,
+               size_t in_nbQubits)
+      : operations(in_operations), successors(in_operations.size()),
+        predecessors(in_operations.size()) {
+    std::vector<int> lastOperations(in_nbQubits, -1);
+    for (size_t opIdx = 0; opIdx < operations.size(); ++opIdx) {
+      for (const auto qubit : operations[opIdx]) {
+        const int lastOperation = lastOperations[qubit];
+        if (lastOperation >= 0 &&
+            (successors[lastOperation].empty() ||
+             successors[lastOperation].back() != opIdx)) {
+          successors[lastOperation].emplace_back(opIdx);
+          predecessors[opIdx].emplace_back(lastOperation);
+        }
+        lastOperations[qubit] = opIdx;
+      }
+    }
+  }
+
+  const std::vector<std::vector<size_t>> &operations;
+  std::vector<std::vector<size_t>> successors;
+  std::vector<std::vector<size_t>> predecessors;
+};
+
+// A step of the routed program: an operation (opIdx >= 0) or a SWAP of two
+// physical qubits.
+struct RoutingStep {
+  int opIdx;
+  size_t physical1;
+  size_t physical2;
+};
+
+struct RoutingResult {
+  std::vector<RoutingStep> steps;
+  size_t nbSwaps = 0;
+  // Logical -> physical qubits after the last operation
+  std::vector<size_t> finalLayout;
+};
+
+// Routes the operations (in reverse order if in_reversed) from the given
+// initial layout (logical -> physical qubits).
+RoutingResult route(const OperationDag &in_dag, bool in_reversed,
+                    const std::vector<size_t> &in_layout,
+                    const xacc::Topology &in_graph,
+                    const SabreOptions &in_options, std::mt19937 &io_rng) {
+  const auto &successors = in_reversed ? in_dag.predecessors : in_dag.successors;
+  const auto &predecessors = in_reversed ? in_dag.successors : in_dag.predecessors;
+  const auto &operations = in_dag.operations;
+  // Number of SWAPs without executing an operation after which the first
+  // blocked operation is routed along a shortest path (avoids live-locks).
+  const size_t maxSwapsWithoutProgress = 10 * in_graph.qubits().size();
+
+  RoutingResult result;
+  std::vector<size_t> layout(in_layout);
+  std::vector<int> physicalToLogical(in_graph.size(), -1);
+  for (size_t logical = 0; logical < layout.size(); ++logical) {
+    physicalToLogical[layout[logical]] = logical;
+  }
+  const auto distance = [&](size_t in_opIdx) {
+    const auto &qubits = operations[in_opIdx];
+    return in_graph.distance(layout[qubits[0]], layout[qubits[1]]);
+  };
+  const auto isExecutable = [&](size_t in_opIdx) {
+    return operations[in_opIdx].size() < 2 || distance(in_opIdx) == 1;
+  };
+  const auto applySwap = [&](size_t in_physical1, size_t in_physical2) {
+    const int logical1 = physicalToLogical[in_physical1];
+    const int logical2 = physicalToLogical[in_physical2];
+    if (logical1 >= 0) {
+      layout[logical1] = in_physical2;
+    }
+    if (logical2 >= 0) {
+      layout[logical2] = in_physical1;
+    }
+    std::swap(physicalToLogical[in_physical1], physicalToLogical[in_physical2]);
+  };
+
+  std::vector<size_t> nbRemainingPredecessors(operations.size());
+  std::vector<size_t> front;
+  for (size_t opIdx = 0; opIdx < operations.size(); ++opIdx) {
+    nbRemainingPredecessors[opIdx] = predecessors[opIdx].size();
+    if (nbRemainingPredecessors[opIdx] == 0) {
+      front.emplace_back(opIdx);
+    }
+  }
+
+  std::vector<double> decay(in_graph.size(), 1.0);
+  size_t swapsSinceProgress = 0;
+  size_t swapsSinceDecayReset = 0;
+  std::vector<size_t> visitStamps(operations.size(), 0);
+  size_t currentStamp = 0;
+  std::vector<size_t> extendedSet;
+  std::vector<std::pair<size_t, size_t>> candidates;
+  std::vector<std::pair<size_t, size_t>> bestCandidates;
+  while (!front.empty()) {
+    // Execute all the operations that are (or become) executable.
+    bool progressed = false;
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      std::vector<size_t> blocked;
+      for (const auto opIdx : front) {
+        if (!isExecutable(opIdx)) {
+          blocked.emplace_back(opIdx);
+          continue;
+        }
+        result.steps.push_back({static_cast<int>(opIdx), 0, 0});
+        for (const auto successor : successors[opIdx]) {
+          if (--nbRemainingPredecessors[successor] == 0) {
+            blocked.emplace_back(successor);
+          }
+        }
+        changed = true;
+      }
+      front.swap(blocked);
+      progressed = progressed || changed;
+    }
+    if (front.empty()) {
+      break;
+    }
+    if (progressed) {
+      std::fill(decay.begin(), decay.end(), 1.0);
+      swapsSinceProgress = 0;
+      swapsSinceDecayReset = 0;
+    }
+
+    if (swapsSinceProgress >= maxSwapsWithoutProgress) {
+      // Release valve: bring the qubits of the first blocked operation
+      // together along a shortest (highest fidelity if noise-aware) path.
+      const auto &qubits = operations[front.front()];
+      while (distance(front.front()) > 1) {
+        const auto physical1 = layout[qubits[0]];
+        const auto physical2 = layout[qubits[1]];
+        const auto nextHop =
+            in_options.noiseAware
+                ? in_graph.nextWeightedHop(physical1, physical2)
+                : in_graph.nextHop(physical1, physical2);
+        result.steps.push_back({-1, physical1, nextHop});
+        applySwap(physical1, nextHop);
+        ++result.nbSwaps;
+      }
+      std::fill(decay.begin(), decay.end(), 1.0);
+      swapsSinceProgress = 0;
+      swapsSinceDecayReset = 0;
+      continue;
+    }
+
+    // Extended set: the next two-qubit operations (breadth-first) after the
+    // front layer.
+    extendedSet.clear();
+    ++currentStamp;
+    std::queue<size_t> queue;
+    for (const auto opIdx : front) {
+      visitStamps[opIdx] = currentStamp;
+      queue.push(opIdx);
+    }
+    while (!queue.empty() && extendedSet.size() < in_options.lookaheadSize) {
+      const auto opIdx = queue.front();
+      queue.pop();
+      for (const auto successor : successors[opIdx]) {
+        if (visitStamps[successor] != currentStamp) {
+          visitStamps[successor] = currentStamp;
+          queue.push(successor);
+          if (operations[successor].size() == 2 &&
+              extendedSet.size() < in_options.lookaheadSize) {
+            extendedSet.emplace_back(successor);
+          }
+        }
+      }
+    }
+
+    // Candidate SWAPs: the couplings of the qubits of the front layer.
+    candidates.clear();
+    for (const auto opIdx : front) {
+      for (const auto logical : operations[opIdx]) {
+        const auto physical = layout[logical];
+        for (const auto neighbor : in_graph.neighbors(physical)) {
+          candidates.emplace_back(std::min(physical, neighbor),
+                                  std::max(physical, neighbor));
+        }
+      }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                     candidates.end());
+
+    double bestScore = std::numeric_limits<double>::max();
+    bestCandidates.clear();
+    for (const auto &[physical1, physical2] : candidates) {
+      applySwap(physical1, physical2);
+      double frontCost = 0.0;
+      for (const auto opIdx : front) {
+        frontCost += distance(opIdx);
+      }
+      double extendedCost = 0.0;
+      for (const auto opIdx : extendedSet) {
+        extendedCost += distance(opIdx);
+      }
+      applySwap(physical1, physical2);
+      double score = frontCost / front.size();
+      if (!extendedSet.empty()) {
+        score += in_options.lookaheadWeight * extendedCost / extendedSet.size();
+      }
+      score *= std::max(decay[physical1], decay[physical2]);
+      if (in_options.noiseAware) {
+        // Error of the SWAP itself (3 CNOTs)
+        score -= 3.0 * std::log(std::max(
+                           in_graph.fidelity(physical1, physical2), 1e-10));
+      }
+      if (score < bestScore - 1e-12) {
+        bestScore = score;
+        bestCandidates.clear();
+      }
+      if (score < bestScore + 1e-12) {
+        bestCandidates.emplace_back(physical1, physical2);
+      }
+    }
+
+    const auto [physical1, physical2] =
+        bestCandidates[std::uniform_int_distribution<size_t>(
+            0, bestCandidates.size() - 1)(io_rng)];
+    result.steps.push_back({-1, physical1, physical2});
+    applySwap(physical1, physical2);
+    ++result.nbSwaps;
+    ++swapsSinceProgress;
+    if (++swapsSinceDecayReset == DECAY_RESET_INTERVAL) {
+      std::fill(decay.begin(), decay.end(), 1.0);
+      swapsSinceDecayReset = 0;
+    } else {
+      decay[physical1] += in_options.decay;
+      decay[physical2] += in_options.decay;
+    }
+  }
+
+  result.finalLayout = layout;
+  return result;
+}
+
+// Layout refinement by alternating forward and backward passes, then the
+// forward routing from that layout.
+RoutingResult runTrial(const OperationDag &in_dag, std::vector<size_t> in_layout,
+                       const xacc::Topology &in_graph,
+                       const SabreOptions &in_options, std::mt19937 &io_rng) {
+  for (int iter = 0; iter < in_options.iterations; ++iter) {
+    in_layout = route(in_dag, false, in_layout, in_graph, in_options, io_rng)
+                    .finalLayout;
+    in_layout = route(in_dag, true, in_layout, in_graph, in_options, io_rng)
+                    .finalLayout;
+  }
+  auto result = route(in_dag, false, in_layout, in_graph, in_options, io_rng);
+  // The initial layout is kept in the (otherwise unused) final layout field
+  // of the routed result.
+  result.finalLayout = in_layout;
+  return result;
+}
+
+// Noise-aware initial layout: a connected set of qubits grown from the best
+// coupling, adding the neighbor with the best coupling and readout fidelity.
+std::vector<size_t>
+selectGoodQubits(const xacc::Topology &in_graph,
+                 const std::vector<double> &in_readoutErrors,
+                 size_t in_nbQubits) {
+  const auto readoutLogFidelity = [&](size_t in_qubit) {
+    return in_qubit < in_readoutErrors.size()
+               ? std::log(std::max(1.0 - in_readoutErrors[in_qubit], 1e-10))
+               : 0.0;
+  };
+  const auto score = [&](size_t in_q1, size_t in_q2) {
+    return std::log(std::max(in_graph.fidelity(in_q1, in_q2), 1e-10)) +
+           readoutLogFidelity(in_q2);
+  };
+
+  std::vector<size_t> selected;
+  if (in_nbQubits == 0) {
+    return selected;
+  }
+  double bestScore = -std::numeric_limits<double>::infinity();
+  for (const auto &[q1, q2] : in_graph.edges()) {
+    const double edgeScore = score(q1, q2) + readoutLogFidelity(q1);
+    if (edgeScore > bestScore) {
+      bestScore = edgeScore;
+      selected = {static_cast<size_t>(q1), static_cast<size_t>(q2)};
+    }
+  }
+  std::vector<bool> isSelected(in_graph.size(), false);
+  for (const auto qubit : selected) {
+    isSelected[qubit] = true;
+  }
+  while (selected.size() < in_nbQubits) {
+    bestScore = -std::numeric_limits<double>::infinity();
+    size_t bestQubit = 0;
+    for (const auto qubit : selected) {
+      for (const auto neighbor : in_graph.neighbors(qubit)) {
+        if (!isSelected[neighbor] && score(qubit, neighbor) > bestScore) {
+          bestScore = score(qubit, neighbor);
+          bestQubit = neighbor;
+        }
+      }
+    }
+    isSelected[bestQubit] = true;
+    selected.emplace_back(bestQubit);
+  }
+  selected.resize(in_nbQubits);
+  return selected;
+}
+
+// Log of the estimated success probability of a routed program: fidelity of
+// the two-qubit gates (3 CNOTs per SWAP) and of the measurements.
+double
+logSuccessProbability(const RoutingResult &in_result,
+                      const std::vector<std::vector<size_t>> &in_operations,
+                      const std::vector<bool> &in_isMeasure,
+                      const xacc::Topology &in_graph,
+                      const std::vector<double> &in_readoutErrors) {
+  const auto logFidelity = [&](size_t in_q1, size_t in_q2) {
+    return std::log(std::max(in_graph.fidelity(in_q1, in_q2), 1e-10));
+  };
+  std::vector<size_t> layout(in_result.finalLayout);
+  std::vector<int> physicalToLogical(in_graph.size(), -1);
+  for (size_t logical = 0; logical < layout.size(); ++logical) {
+    physicalToLogical[layout[logical]] = logical;
+  }
+  double result = 0.0;
+  for (const auto &step : in_result.steps) {
+    if (step.opIdx < 0) {
+      result += 3.0 * logFidelity(step.physical1, step.physical2);
+      const int logical1 = physicalToLogical[step.physical1];
+      const int logical2 = physicalToLogical[step.physical2];
+      if (logical1 >= 0) {
+        layout[logical1] = step.physical2;
+      }
+      if (logical2 >= 0) {
+        layout[logical2] = step.physical1;
+      }
+      std::swap(physicalToLogical[step.physical1],
+                physicalToLogical[step.physical2]);
+      continue;
+    }
+    const auto &qubits = in_operations[step.opIdx];
+    if (qubits.size() == 2) {
+      result += logFidelity(layout[qubits[0]], layout[qubits[1]]);
+    } else if (in_isMeasure[step.opIdx] &&
+               layout[qubits[0]] < in_readoutErrors.size()) {
+      result += std::log(
+          std::max(1.0 - in_readoutErrors[layout[qubits[0]]], 1e-10));
+    }
+  }
+  return result;
+}
+} // namespace
+
+namespace xacc {
+namespace quantum {
+void SabrePlacement::apply(std::shared_ptr<CompositeInstruction> program,
+                           const std::shared_ptr<Accelerator> accelerator,
+                           const HeterogeneousMap &options) {
+  if (!accelerator) {
+    xacc::warning("[SABRE Placement] Provided QPU was null. Cannot run SABRE "
+                  "placement.");
+    return;
+  }
+  const auto connectivity = accelerator->getConnectivity();
+  if (connectivity.empty()) {
+    // Fully-connected, nothing to do.
+    return;
+  }
+
+  SabreOptions sabreOptions;
+  int nbTrials = 8;
+  int seed = 0;
+  if (options.keyExists<int>("trials")) {
+    nbTrials = options.get<int>("trials");
+  }
+  if (options.keyExists<int>("seed")) {
+    seed = options.get<int>("seed");
+  }
+  if (options.keyExists<int>("iterations")) {
+    sabreOptions.iterations = options.get<int>("iterations");
+  }
+  if (options.keyExists<int>("lookahead-size")) {
+    const int lookaheadSize = options.get<int>("lookahead-size");
+    if (lookaheadSize < 0) {
+      xacc::error("[SABRE Placement] Invalid 'lookahead-size' parameter.");
+    }
+    sabreOptions.lookaheadSize = lookaheadSize;
+  }
+  if (options.keyExists<double>("lookahead-weight")) {
+    sabreOptions.lookaheadWeight = options.get<double>("lookahead-weight");
+  }
+  if (options.keyExists<double>("decay")) {
+    sabreOptions.decay = options.get<double>("decay");
+  }
+  // Noise-aware mode: calibration data from the 'backend-json' option or
+  // from the accelerator (remote IBM backend).
+  std::shared_ptr<const Calibration> calibration;
+  if (options.keyExists<bool>("noise-aware") &&
+      options.get<bool>("noise-aware")) {
+    std::string backendJson;
+    if (options.stringExists("backend-json")) {
+      backendJson = options.getString("backend-json");
+    } else if (accelerator->getProperties().stringExists("total-json")) {
+      backendJson = accelerator->getProperties().getString("total-json");
+    }
+    if (backendJson.empty()) {
+      xacc::warning("[SABRE Placement] No backend calibration data for "
+                    "noise-aware routing, using hop distances.");
+    } else {
+      calibration = getCalibration(backendJson);
+      sabreOptions.noiseAware = true;
+    }
+  }
+  if (nbTrials < 1 || sabreOptions.iterations < 0) {
+    xacc::error("[SABRE Placement] Invalid 'trials' or 'iterations' parameter.");
+  }
+
+  std::vector<Instruction *> instructions;
+  std::vector<std::vector<size_t>> operations;
+  std::vector<bool> isMeasure;
+  size_t nbLogicalQubits = 0;
+  for (auto *inst : program->flatView()) {
+    if (!inst->isEnabled()) {
+      continue;
+    }
+    if (inst->isComposite()) {
+      if (inst->name() == "ifstmt") {
+        xacc::error("[SABRE Placement] Conditionals are not supported.");
+      }
+      continue;
+    }
+    const auto bits = inst->bits();
+    if (bits.size() > 2) {
+      xacc::error("[SABRE Placement] Only one and two-qubit gates are "
+                  "supported, got '" + inst->name() + "'.");
+    }
+    for (const auto bit : bits) {
+      nbLogicalQubits = std::max(nbLogicalQubits, bit + 1);
+    }
+    instructions.emplace_back(inst);
+    operations.emplace_back(bits.begin(), bits.end());
+    isMeasure.emplace_back(inst->opcode() == xacc::GateOpcode::Measure);
+  }
+
+  const auto topology =
+      calibration ? Topology::get(connectivity, calibration->twoQubitFidelities)
+                  : Topology::get(connectivity);
+  if (!topology->isConnected()) {
+    xacc::error("[SABRE Placement] The connectivity graph of the "
+                "accelerator must be connected.");
+  }
+  const auto &graph = *topology;
+  if (nbLogicalQubits > graph.qubits().size()) {
+    xacc::error("[SABRE Placement] The program uses " +
+                std::to_string(nbLogicalQubits) +
+                " qubits but the accelerator connectivity only has " +
+                std::to_string(graph.qubits().size()) + ".");
+  }
+  const OperationDag dag(operations, nbLogicalQubits);
+
+  std::vector<RoutingResult> trialResults(nbTrials);
+  xacc::getTaskScheduler()->parallelFor(
+      0, nbTrials, [&](size_t beginIdx, size_t endIdx) {
+        for (size_t trialIdx = beginIdx; trialIdx < endIdx; ++trialIdx) {
+          std::mt19937 rng(seed + trialIdx);
+          // The first trial starts from the trivial layout (the best qubits
+          // if noise-aware), the others from random ones.
+          std::vector<size_t> physicalQubits(graph.qubits());
+          if (trialIdx > 0) {
+            std::shuffle(physicalQubits.begin(), physicalQubits.end(), rng);
+          } else if (calibration) {
+            physicalQubits = selectGoodQubits(
+                graph, calibration->readoutErrors, nbLogicalQubits);
+          }
+          physicalQubits.resize(nbLogicalQubits);
+          trialResults[trialIdx] =
+              runTrial(dag, physicalQubits, graph, sabreOptions, rng);
+        }
+      });
+
+  // Fewest SWAPs, or highest estimated success probability if noise-aware
+  std::vector<double> trialCosts;
+  for (const auto &trialResult : trialResults) {
+    trialCosts.emplace_back(
+        calibration ? -logSuccessProbability(trialResult, operations,
+                                             isMeasure, graph,
+                                             calibration->readoutErrors)
+                    : trialResult.nbSwaps);
+  }
+  const size_t bestTrialIdx =
+      std::min_element(trialCosts.begin(), trialCosts.end()) -
+      trialCosts.begin();
+  const auto &bestResult = trialResults[bestTrialIdx];
+
+  // Rebuild the program on the physical qubits.
+  auto provider = xacc::getIRProvider("quantum");
+  std::vector<size_t> layout(bestResult.finalLayout);
+  std::vector<int> physicalToLogical(graph.size(), -1);
+  for (size_t logical = 0; logical < layout.size(); ++logical) {
+    physicalToLogical[layout[logical]] = logical;
+  }
+  std::vector<InstPtr> routedInstructions;
+  for (const auto &step : bestResult.steps) {
+    if (step.opIdx < 0) {
+      routedInstructions.emplace_back(provider->createInstruction(
+          "Swap", {step.physical1, step.physical2}));
+      const int logical1 = physicalToLogical[step.physical1];
+      const int logical2 = physicalToLogical[step.physical2];
+      if (logical1 >= 0) {
+        layout[logical1] = step.physical2;
+      }
+      if (logical2 >= 0) {
+        layout[logical2] = step.physical1;
+      }
+      std::swap(physicalToLogical[step.physical1],
+                physicalToLogical[step.physical2]);
+      continue;
+    }
+    auto inst = instructions[step.opIdx]->clone();
+    std::vector<size_t> physicalBits;
+    for (const auto bit : operations[step.opIdx]) {
+      physicalBits.emplace_back(layout[bit]);
+    }
+    inst->setBits(physicalBits);
+    routedInstructions.emplace_back(inst);
+  }
+
+  program->clear();
+  program->addInstructions(routedInstructions);
+}
+} // namespace quantum
+} // namespace xacc
@@ -0,0 +1,60 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#pragma once
+
+#include "IRTransformation.hpp"
+
+namespace xacc {
+namespace quantum {
+// SABRE (SWAP-based BidiREctional heuristic search) qubit mapping and
+// routing (Li, Ding and Xie, ASPLOS 2019) directly on the XACC IR and the
+// accelerator connectivity: the initial layout of each trial is a random one
+// refined by forward/backward routing passes, the result is that of the
+// trial with the fewest SWAP gates.
+//
+// Options:
+//  - "trials" (int, default 8): initial layouts (the first one trivial, the
+//    others random), routed in parallel;
+//  - "seed" (int, default 0);
+//  - "iterations" (int, default 3): forward/backward routing passes refining
+//    the initial layout of each trial, before the final (forward) routing;
+//  - "lookahead-size" (int, default 20) and "lookahead-weight" (double,
+//    default 0.5): the extended set of two-qubit gates in the cost function;
+//  - "decay" (double, default 0.001): penalty increment of the recently
+//    swapped qubits (favoring parallel SWAPs);
+//  - "noise-aware" (bool, default false): use the backend calibration
+//    ("backend-json" option or the "total-json" accelerator property, as for
+//    TriQ): candidate SWAPs are penalized by their error (-3 log of the CNOT
+//    fidelity), blocked gates are routed along the highest fidelity paths,
+//    the first trial starts on a connected set of good qubits (CNOT and
+//    readout fidelities),
+//    and the result is that of the trial with the highest estimated success
+//    probability. Calibrations are cached, i.e. only parsed again when the
+//    backend JSON changes.
+class SabrePlacement : public IRTransformation {
+public:
+  SabrePlacement() {}
+  void apply(std::shared_ptr<CompositeInstruction> program,
+             const std::shared_ptr<Accelerator> accelerator,
+             const HeterogeneousMap &options = {}) override;
+  const IRTransformationType type() const override {
+    return IRTransformationType::Placement;
+  }
+
+  const std::string name() const override { return "sabre"; }
+  const std::string description() const override {
+    return "SABRE qubit mapping and routing.";
+  }
+};
+} // namespace quantum
+} // namespace xacc
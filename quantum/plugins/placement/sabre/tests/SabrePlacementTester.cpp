@@ -0,0 +1,148 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "gtest/gtest.h"
+
+#include "xacc.hpp"
+#include "xacc_service.hpp"
+#include <set>
+using namespace xacc;
+
+class AcceleratorWithConnectivity : public xacc::Accelerator {
+protected:
+  std::vector<std::pair<int, int>> edges;
+
+public:
+  AcceleratorWithConnectivity(std::vector<std::pair<int, int>> &&connections)
+      : edges(connections) {}
+  const std::string name() const override { return "acc_with_connectivity"; }
+  const std::string description() const override { return ""; }
+  void initialize(const HeterogeneousMap &params = {}) override { return; }
+  void execute(std::shared_ptr<xacc::AcceleratorBuffer> buf,
+               std::shared_ptr<xacc::CompositeInstruction> f) override {}
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::vector<std::shared_ptr<CompositeInstruction>>
+                   functions) override {}
+  void updateConfiguration(const HeterogeneousMap &config) override {}
+  const std::vector<std::string> configurationKeys() override { return {}; }
+
+  std::vector<std::pair<int, int>> getConnectivity() override { return edges; }
+};
+
+namespace {
+const std::vector<std::pair<int, int>> EDGES{
+    {0, 1}, {0, 5}, {1, 2}, {1, 4}, {2, 3}, {3, 4},
+    {3, 8}, {4, 5}, {4, 7}, {5, 6}, {6, 7}, {7, 8}};
+
+size_t countSwaps(std::shared_ptr<CompositeInstruction> program) {
+  size_t nbSwaps = 0;
+  for (size_t i = 0; i < program->nInstructions(); ++i) {
+    if (program->getInstruction(i)->name() == "Swap") {
+      ++nbSwaps;
+    }
+  }
+  return nbSwaps;
+}
+
+void checkCoupling(std::shared_ptr<CompositeInstruction> program) {
+  std::set<std::pair<size_t, size_t>> couplings;
+  for (const auto &[q1, q2] : EDGES) {
+    couplings.emplace(q1, q2);
+    couplings.emplace(q2, q1);
+  }
+  for (size_t i = 0; i < program->nInstructions(); ++i) {
+    const auto bits = program->getInstruction(i)->bits();
+    if (bits.size() == 2) {
+      EXPECT_EQ(1, couplings.count({bits[0], bits[1]}));
+    }
+  }
+}
+} // namespace
+
+TEST(SabrePlacementTester, checkRouting) {
+  auto qpu = std::make_shared<AcceleratorWithConnectivity>(
+      std::vector<std::pair<int, int>>(EDGES));
+  auto irt = xacc::getIRTransformation("sabre");
+  auto compiler = xacc::getCompiler("xasm");
+  auto program = compiler->compile(R"(__qpu__ void sabre_routing(qreg q) {
+      H(q[0]);
+      CX(q[0], q[8]);
+      CX(q[2], q[6]);
+      CX(q[1], q[7]);
+      Rz(q[7], 0.3);
+      CX(q[3], q[5]);
+      CX(q[8], q[2]);
+      CX(q[6], q[0]);
+      CX(q[4], q[1]);
+      CX(q[5], q[7]);
+      Measure(q[0]);
+      Measure(q[7]);
+  })")->getComposite("sabre_routing");
+  const auto nbInstructions = program->nInstructions();
+
+  irt->apply(program, nullptr);
+  EXPECT_EQ(nbInstructions, program->nInstructions());
+
+  irt->apply(program, qpu, {{"trials", 16}, {"seed", 1}});
+  std::cout << program->toString() << "\n";
+  const auto nbSwaps = countSwaps(program);
+  EXPECT_EQ(nbInstructions + nbSwaps, program->nInstructions());
+  EXPECT_GT(nbSwaps, 0);
+  EXPECT_LT(nbSwaps, 16);
+  checkCoupling(program);
+}
+
+TEST(SabrePlacementTester, checkNoSwapNeeded) {
+  auto qpu = std::make_shared<AcceleratorWithConnectivity>(
+      std::vector<std::pair<int, int>>(EDGES));
+  auto irt = xacc::getIRTransformation("sabre");
+  auto compiler = xacc::getCompiler("xasm");
+  auto program = compiler->compile(R"(__qpu__ void sabre_trivial(qreg q) {
+      H(q[0]);
+      CX(q[0], q[1]);
+      CX(q[1], q[2]);
+      CX(q[2], q[3]);
+      CX(q[3], q[8]);
+  })")->getComposite("sabre_trivial");
+
+  irt->apply(program, qpu);
+  EXPECT_EQ(0, countSwaps(program));
+  EXPECT_EQ(5, program->nInstructions());
+  checkCoupling(program);
+}
+
+TEST(SabrePlacementTester, checkDeterministic) {
+  auto qpu = std::make_shared<AcceleratorWithConnectivity>(
+      std::vector<std::pair<int, int>>(EDGES));
+  auto irt = xacc::getIRTransformation("sabre");
+  auto compiler = xacc::getCompiler("xasm");
+  const std::string src = R"(__qpu__ void sabre_ghz(qreg q) {
+      H(q[0]);
+      for (int i = 0; i < 8; i++) {
+        CX(q[0], q[i + 1]);
+      }
+  })";
+  auto program1 = compiler->compile(src)->getComposite("sabre_ghz");
+  irt->apply(program1, qpu, {{"seed", 42}});
+  auto program2 = compiler->compile(src)->getComposite("sabre_ghz");
+  irt->apply(program2, qpu, {{"seed", 42}});
+  EXPECT_EQ(program1->toString(), program2->toString());
+  checkCoupling(program1);
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize(argc, argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
@@ -14,6 +14,10 @@
 #include "cppmicroservices/BundleContext.h"
 #include "cppmicroservices/ServiceProperties.h"
 #include "QppAccelerator.hpp"
+#include "StabilizerAccelerator.hpp"
+#include "PauliPropagationAccelerator.hpp"
+#include "SparseStateVectorAccelerator.hpp"
+#include "TensorNetworkAccelerator.hpp"
 
 using namespace cppmicroservices;
 
@@ -24,6 +28,10 @@ public:
   void Start(BundleContext context) {
     auto acc = std::make_shared<xacc::quantum::QppAccelerator>();
     context.RegisterService<xacc::Accelerator>(acc);
+    context.RegisterService<xacc::Accelerator>(std::make_shared<xacc::quantum::StabilizerAccelerator>());
+    context.RegisterService<xacc::Accelerator>(std::make_shared<xacc::quantum::TensorNetworkAccelerator>());
+    context.RegisterService<xacc::Accelerator>(std::make_shared<xacc::quantum::PauliPropagationAccelerator>());
+    context.RegisterService<xacc::Accelerator>(std::make_shared<xacc::quantum::SparseStateVectorAccelerator>());
     context.RegisterService<xacc::NoiseModelUtils>(std::make_shared<xacc::quantum::DefaultNoiseModelUtils>());
   }
 
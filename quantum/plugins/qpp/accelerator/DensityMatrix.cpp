@@ -0,0 +1,210 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "DensityMatrix.hpp"
+#include "xacc.hpp"
+#include <algorithm>
+#include <array>
+#include <bitset>
+
+namespace {
+using Amplitude = xacc::quantum::DensityMatrix::Amplitude;
+constexpr size_t MAX_SUPEROP_DIM =
+    1ULL << (2 * xacc::quantum::DensityMatrix::MAX_SUPEROP_QUBITS);
+
+// Applies the superoperator to the 4^n elements of io_data (see
+// DensityMatrix::applySuperOp), only with stack buffers.
+void applySuperOpInPlace(std::vector<Amplitude> &io_data, size_t in_nbQubits,
+                         const Eigen::MatrixXcd &in_superOp,
+                         const std::vector<size_t> &in_bits) {
+  const size_t k = in_bits.size();
+  const size_t dim = 1ULL << (2 * k);
+  if (k > xacc::quantum::DensityMatrix::MAX_SUPEROP_QUBITS ||
+      static_cast<size_t>(in_superOp.rows()) != dim ||
+      static_cast<size_t>(in_superOp.cols()) != dim) {
+    xacc::error("Invalid superoperator on " + std::to_string(k) + " qubits.");
+  }
+  // Bit j < k of the local index is the column bit of in_bits[j] (bit
+  // in_bits[j] of the global index), bit k + j its row bit.
+  std::vector<size_t> vecBits;
+  for (const auto bit : in_bits) {
+    vecBits.emplace_back(bit);
+  }
+  for (const auto bit : in_bits) {
+    vecBits.emplace_back(in_nbQubits + bit);
+  }
+  std::array<uint64_t, MAX_SUPEROP_DIM> offsets;
+  for (size_t l = 0; l < dim; ++l) {
+    offsets[l] = 0;
+    for (size_t j = 0; j < 2 * k; ++j) {
+      offsets[l] |= ((l >> j) & 1ULL) << vecBits[j];
+    }
+  }
+  std::sort(vecBits.begin(), vecBits.end());
+
+  const Amplitude *superOp = in_superOp.data();
+  const auto applyGroups = [&](size_t beginIdx, size_t endIdx) {
+    std::array<Amplitude, MAX_SUPEROP_DIM> in, out;
+    for (size_t group = beginIdx; group < endIdx; ++group) {
+      // Insert zeros at the (sorted) superoperator bits
+      uint64_t base = group;
+      for (const auto bit : vecBits) {
+        const uint64_t low = base & ((1ULL << bit) - 1);
+        base = ((base >> bit) << (bit + 1)) | low;
+      }
+      for (size_t l = 0; l < dim; ++l) {
+        in[l] = io_data[base + offsets[l]];
+      }
+      for (size_t row = 0; row < dim; ++row) {
+        out[row] = 0.0;
+      }
+      // Column-major
+      for (size_t col = 0; col < dim; ++col) {
+        const auto value = in[col];
+        if (value == 0.0) {
+          continue;
+        }
+        const Amplitude *column = superOp + col * dim;
+        for (size_t row = 0; row < dim; ++row) {
+          out[row] += column[row] * value;
+        }
+      }
+      for (size_t l = 0; l < dim; ++l) {
+        io_data[base + offsets[l]] = out[l];
+      }
+    }
+  };
+
+  const size_t nbGroups = io_data.size() / dim;
+  // Not worth the scheduling below ~16K elements
+  if (io_data.size() < (1ULL << 14)) {
+    applyGroups(0, nbGroups);
+  } else {
+    xacc::getTaskScheduler()->parallelFor(0, nbGroups, applyGroups);
+  }
+}
+} // namespace
+
+namespace xacc {
+namespace quantum {
+DensityMatrix::DensityMatrix(size_t in_nbQubits) : m_nbQubits(in_nbQubits) {
+  if (2 * in_nbQubits >= 64) {
+    xacc::error("Too many qubits (" + std::to_string(in_nbQubits) +
+                ") for a density matrix.");
+  }
+  m_data.assign(1ULL << (2 * in_nbQubits), 0.0);
+  m_data[0] = 1.0;
+}
+
+void DensityMatrix::applySuperOp(const Eigen::MatrixXcd &in_superOp,
+                                 const std::vector<size_t> &in_bits) {
+  for (const auto bit : in_bits) {
+    assert(bit < m_nbQubits);
+  }
+  applySuperOpInPlace(m_data, m_nbQubits, in_superOp, in_bits);
+}
+
+Eigen::MatrixXcd DensityMatrix::krausToSuperOp(
+    const std::vector<Eigen::MatrixXcd> &in_krausMats) {
+  assert(!in_krausMats.empty());
+  const size_t d = in_krausMats[0].rows();
+  // S[(r << k) | c][(r' << k) | c'] = sum_i K_i[r][r'] conj(K_i[c][c'])
+  Eigen::MatrixXcd superOp = Eigen::MatrixXcd::Zero(d * d, d * d);
+  for (const auto &kraus : in_krausMats) {
+    for (size_t r = 0; r < d; ++r) {
+      for (size_t rp = 0; rp < d; ++rp) {
+        const auto krr = kraus(r, rp);
+        if (krr == 0.0) {
+          continue;
+        }
+        for (size_t c = 0; c < d; ++c) {
+          for (size_t cp = 0; cp < d; ++cp) {
+            superOp(r * d + c, rp * d + cp) += krr * std::conj(kraus(c, cp));
+          }
+        }
+      }
+    }
+  }
+  return superOp;
+}
+
+Eigen::MatrixXcd DensityMatrix::embed(const Eigen::MatrixXcd &in_superOp,
+                                      const std::vector<size_t> &in_bits,
+                                      const std::vector<size_t> &in_targetBits) {
+  std::vector<size_t> localBits;
+  for (const auto bit : in_bits) {
+    const auto iter =
+        std::find(in_targetBits.begin(), in_targetBits.end(), bit);
+    assert(iter != in_targetBits.end());
+    localBits.emplace_back(std::distance(in_targetBits.begin(), iter));
+  }
+  // Column l is the image of the l-th basis element
+  const size_t m = in_targetBits.size();
+  const size_t dim = 1ULL << (2 * m);
+  Eigen::MatrixXcd result(dim, dim);
+  std::vector<Amplitude> basis(dim);
+  for (size_t l = 0; l < dim; ++l) {
+    std::fill(basis.begin(), basis.end(), 0.0);
+    basis[l] = 1.0;
+    applySuperOpInPlace(basis, m, in_superOp, localBits);
+    for (size_t row = 0; row < dim; ++row) {
+      result(row, l) = basis[row];
+    }
+  }
+  return result;
+}
+
+double DensityMatrix::expectationValueZ(const std::vector<size_t> &in_bits) const {
+  uint64_t mask = 0;
+  for (const auto bit : in_bits) {
+    mask ^= 1ULL << bit;
+  }
+  double result = 0.0;
+  for (uint64_t i = 0; i < (1ULL << m_nbQubits); ++i) {
+    result += (std::bitset<64>(i & mask).count() % 2 ? -1.0 : 1.0) *
+              probability(i);
+  }
+  return result;
+}
+
+void SuperOpCircuit::add(const Eigen::MatrixXcd &in_superOp,
+                         const std::vector<size_t> &in_bits) {
+  if (!m_ops.empty()) {
+    auto &last = m_ops.back();
+    auto fusedBits = last.bits;
+    for (const auto bit : in_bits) {
+      if (std::find(fusedBits.begin(), fusedBits.end(), bit) ==
+          fusedBits.end()) {
+        fusedBits.emplace_back(bit);
+      }
+    }
+    if (fusedBits.size() <= m_maxWidth) {
+      // The new one is applied after the last one
+      const auto lastMat = fusedBits.size() == last.bits.size()
+                               ? last.mat
+                               : DensityMatrix::embed(last.mat, last.bits,
+                                                      fusedBits);
+      last.mat = DensityMatrix::embed(in_superOp, in_bits, fusedBits) * lastMat;
+      last.bits = fusedBits;
+      return;
+    }
+  }
+  m_ops.emplace_back(SuperOp{in_bits, in_superOp});
+}
+
+void SuperOpCircuit::apply(DensityMatrix &io_densityMatrix) const {
+  for (const auto &op : m_ops) {
+    io_densityMatrix.applySuperOp(op.mat, op.bits);
+  }
+}
+} // namespace quantum
+} // namespace xacc
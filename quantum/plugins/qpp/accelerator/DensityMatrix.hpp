@@ -0,0 +1,85 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#pragma once
+#include <Eigen/Dense>
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+namespace xacc {
+namespace quantum {
+// Density matrix of n qubits, element (r, c) stored at index (r << n) | c
+// (bit q of r and c is qubit q, XACC convention), i.e. row-major.
+// Gates and noise channels are superoperators on a few qubits: acting on
+// vec(rho) they only mix the 4^k elements that differ in the row and column
+// bits of those qubits, so they are applied in place.
+class DensityMatrix {
+public:
+  using Amplitude = std::complex<double>;
+  // Superoperators act on at most this many qubits (64 x 64 matrices).
+  static constexpr size_t MAX_SUPEROP_QUBITS = 3;
+
+  // |0...0><0...0|
+  DensityMatrix(size_t in_nbQubits);
+
+  // vec(rho) <- S vec(rho), S of dimension 4^k on in_bits (k qubits). The
+  // local index of S is (r << k) | c, with bit j of r and c being in_bits[j].
+  void applySuperOp(const Eigen::MatrixXcd &in_superOp,
+                    const std::vector<size_t> &in_bits);
+
+  // Superoperator of the channel rho -> sum_i K_i rho K_i^dagger (the Kraus
+  // operators indexed with the first qubit as the LSB, as applySuperOp).
+  static Eigen::MatrixXcd
+  krausToSuperOp(const std::vector<Eigen::MatrixXcd> &in_krausMats);
+  // Superoperator of in_superOp (on in_bits) on the qubits in_targetBits, a
+  // superset of in_bits.
+  static Eigen::MatrixXcd embed(const Eigen::MatrixXcd &in_superOp,
+                                const std::vector<size_t> &in_bits,
+                                const std::vector<size_t> &in_targetBits);
+
+  size_t nbQubits() const { return m_nbQubits; }
+  // <r|rho|r>
+  double probability(uint64_t in_basisState) const {
+    return m_data[(in_basisState << m_nbQubits) | in_basisState].real();
+  }
+  // <Z...Z> over in_bits
+  double expectationValueZ(const std::vector<size_t> &in_bits) const;
+  const std::vector<Amplitude> &data() const { return m_data; }
+
+private:
+  size_t m_nbQubits;
+  std::vector<Amplitude> m_data;
+};
+
+// A circuit of superoperators. Each one added is fused into the previous one
+// as long as they act on at most in_maxWidth qubits together, e.g. a gate
+// and its noise channels, so that the density matrix is swept once per
+// fused block.
+class SuperOpCircuit {
+public:
+  SuperOpCircuit(size_t in_maxWidth) : m_maxWidth(in_maxWidth) {}
+  void add(const Eigen::MatrixXcd &in_superOp,
+           const std::vector<size_t> &in_bits);
+  void apply(DensityMatrix &io_densityMatrix) const;
+  size_t size() const { return m_ops.size(); }
+
+private:
+  struct SuperOp {
+    std::vector<size_t> bits;
+    Eigen::MatrixXcd mat;
+  };
+  size_t m_maxWidth;
+  std::vector<SuperOp> m_ops;
+};
+} // namespace quantum
+} // namespace xacc
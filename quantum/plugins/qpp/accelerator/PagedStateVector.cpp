@@ -0,0 +1,445 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "PagedStateVector.hpp"
+#include "StateVectorFile.hpp"
+#include "xacc.hpp"
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <numeric>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+using xacc::quantum::PagedStateVector;
+using Amplitude = PagedStateVector::Amplitude;
+constexpr size_t MAX_GATE_DIM = 1ULL << PagedStateVector::MAX_GATE_QUBITS;
+// Gates on a high qubit used again within that many gates trigger a swap.
+constexpr size_t SWAP_LOOKAHEAD = 256;
+// Not worth the scheduling below ~16K amplitudes
+constexpr uint64_t MIN_PARALLEL_SIZE = 1ULL << 14;
+
+template <typename F>
+void parallelFor(uint64_t in_size, uint64_t in_work, F &&in_f) {
+  if (in_work < MIN_PARALLEL_SIZE) {
+    in_f(0, in_size);
+  } else {
+    xacc::getTaskScheduler()->parallelFor(0, in_size, in_f);
+  }
+}
+
+// Index of the group-th block of 2^k amplitudes, i.e. group with zeros
+// inserted at the (sorted) in_sortedBits.
+inline uint64_t groupBase(uint64_t in_group,
+                          const std::vector<size_t> &in_sortedBits) {
+  uint64_t base = in_group;
+  for (const auto bit : in_sortedBits) {
+    const uint64_t low = base & ((1ULL << bit) - 1);
+    base = ((base >> bit) << (bit + 1)) | low;
+  }
+  return base;
+}
+
+// A gate on physical qubits, applied with stack buffers only.
+struct Kernel {
+  Kernel(const Eigen::MatrixXcd &in_mat, const std::vector<size_t> &in_bits)
+      : mat(in_mat.data()), dim(1ULL << in_bits.size()),
+        sortedBits(in_bits) {
+    for (size_t l = 0; l < dim; ++l) {
+      offsets[l] = 0;
+      for (size_t j = 0; j < in_bits.size(); ++j) {
+        offsets[l] |= ((l >> j) & 1ULL) << in_bits[j];
+      }
+    }
+    std::sort(sortedBits.begin(), sortedBits.end());
+  }
+
+  // Groups [in_begin, in_end) of the 2^k amplitudes of io_data
+  void apply(Amplitude *io_data, uint64_t in_begin, uint64_t in_end) const {
+    std::array<Amplitude, MAX_GATE_DIM> in, out;
+    for (uint64_t group = in_begin; group < in_end; ++group) {
+      Amplitude *block = io_data + groupBase(group, sortedBits);
+      for (size_t l = 0; l < dim; ++l) {
+        in[l] = block[offsets[l]];
+        out[l] = 0.0;
+      }
+      // Column-major
+      for (size_t col = 0; col < dim; ++col) {
+        const auto value = in[col];
+        if (value == 0.0) {
+          continue;
+        }
+        const Amplitude *column = mat + col * dim;
+        for (size_t row = 0; row < dim; ++row) {
+          out[row] += column[row] * value;
+        }
+      }
+      for (size_t l = 0; l < dim; ++l) {
+        block[offsets[l]] = out[l];
+      }
+    }
+  }
+
+  const Amplitude *mat;
+  size_t dim;
+  std::array<uint64_t, MAX_GATE_DIM> offsets;
+  std::vector<size_t> sortedBits;
+};
+} // namespace
+
+namespace xacc {
+namespace quantum {
+PagedStateVector::PagedStateVector(size_t in_nbQubits, size_t in_nbChunkQubits,
+                                   const std::string &in_dir)
+    : m_nbQubits(in_nbQubits),
+      m_nbChunkQubits(std::min(in_nbChunkQubits, in_nbQubits)),
+      m_physical(in_nbQubits), m_logical(in_nbQubits) {
+  if (in_nbQubits >= 60) {
+    xacc::error("Too many qubits (" + std::to_string(in_nbQubits) +
+                ") for a paged state vector.");
+  }
+  std::iota(m_physical.begin(), m_physical.end(), 0);
+  std::iota(m_logical.begin(), m_logical.end(), 0);
+
+  // The file is unlinked right away: it is reclaimed when closed, even if
+  // the process dies. Its zero (sparse) content is |0...0> up to data[0].
+  auto path = (in_dir.empty() ? std::string("/tmp") : in_dir) +
+              "/xacc_paged_XXXXXX";
+  m_fd = mkstemp(&path[0]);
+  if (m_fd < 0) {
+    xacc::error("Failed to create a paging file in " + in_dir + ": " +
+                std::strerror(errno));
+  }
+  unlink(path.c_str());
+  const uint64_t bytes = sizeof(Amplitude) * size();
+  void *mapped = MAP_FAILED;
+  if (ftruncate(m_fd, bytes) == 0) {
+    mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+  }
+  if (mapped == MAP_FAILED) {
+    const std::string reason = std::strerror(errno);
+    close(m_fd);
+    m_fd = -1;
+    xacc::error("Failed to map a paging file of " + std::to_string(bytes) +
+                " bytes in " + in_dir + ": " + reason);
+  }
+  m_data = static_cast<Amplitude *>(mapped);
+  m_data[0] = 1.0;
+}
+
+PagedStateVector::~PagedStateVector() {
+  if (m_data) {
+    munmap(m_data, sizeof(Amplitude) * size());
+  }
+  if (m_fd >= 0) {
+    close(m_fd);
+  }
+}
+
+void PagedStateVector::apply(const std::vector<Gate> &in_gates) {
+  // Gates using each qubit, to look up the next use of a qubit
+  std::vector<std::vector<size_t>> uses(m_nbQubits);
+  for (size_t i = 0; i < in_gates.size(); ++i) {
+    const auto &gate = in_gates[i];
+    const size_t k = gate.bits.size();
+    const size_t dim = 1ULL << k;
+    if (k > MAX_GATE_QUBITS || static_cast<size_t>(gate.mat.rows()) != dim ||
+        static_cast<size_t>(gate.mat.cols()) != dim) {
+      xacc::error("Invalid gate on " + std::to_string(k) + " qubits.");
+    }
+    for (const auto bit : gate.bits) {
+      if (bit >= m_nbQubits || std::count(gate.bits.begin(), gate.bits.end(),
+                                          bit) != 1) {
+        xacc::error("Invalid gate qubit " + std::to_string(bit) + ".");
+      }
+      uses[bit].emplace_back(i);
+    }
+  }
+  const auto nextUse = [&](size_t in_qubit, size_t in_after) {
+    const auto &qubitUses = uses[in_qubit];
+    const auto iter =
+        std::upper_bound(qubitUses.begin(), qubitUses.end(), in_after);
+    return iter == qubitUses.end() ? std::numeric_limits<size_t>::max()
+                                   : *iter;
+  };
+  const auto physicalBits = [&](const Gate &in_gate) {
+    std::vector<size_t> bits;
+    for (const auto bit : in_gate.bits) {
+      bits.emplace_back(m_physical[bit]);
+    }
+    return bits;
+  };
+  const auto isLocal = [&](const Gate &in_gate) {
+    return std::all_of(in_gate.bits.begin(), in_gate.bits.end(),
+                       [&](size_t bit) {
+                         return m_physical[bit] < m_nbChunkQubits;
+                       });
+  };
+
+  // Runs of local gates, applied chunk by chunk
+  std::vector<Gate> segment;
+  const auto flush = [&]() {
+    applyLocal(segment);
+    segment.clear();
+  };
+  for (size_t i = 0; i < in_gates.size(); ++i) {
+    const auto &gate = in_gates[i];
+    if (!isLocal(gate)) {
+      flush();
+      for (const auto bit : gate.bits) {
+        const auto next = nextUse(bit, i);
+        if (m_physical[bit] < m_nbChunkQubits || next > i + SWAP_LOOKAHEAD) {
+          continue;
+        }
+        // The local qubit (not of this gate) used furthest in the future,
+        // if after this one
+        size_t victim = m_nbChunkQubits;
+        size_t victimNext = next;
+        for (size_t p = 0; p < m_nbChunkQubits; ++p) {
+          const auto qubit = m_logical[p];
+          if (std::find(gate.bits.begin(), gate.bits.end(), qubit) !=
+              gate.bits.end()) {
+            continue;
+          }
+          const auto qubitNext = nextUse(qubit, i);
+          if (qubitNext > victimNext) {
+            victim = p;
+            victimNext = qubitNext;
+          }
+        }
+        if (victim < m_nbChunkQubits) {
+          swapPhysical(victim, m_physical[bit]);
+        }
+      }
+    }
+    if (isLocal(gate)) {
+      segment.emplace_back(Gate{physicalBits(gate), gate.mat});
+    } else {
+      applyGlobal(Gate{physicalBits(gate), gate.mat});
+    }
+  }
+  flush();
+}
+
+void PagedStateVector::applyLocal(const std::vector<Gate> &in_gates) {
+  if (in_gates.empty()) {
+    return;
+  }
+  std::vector<Kernel> kernels;
+  for (const auto &gate : in_gates) {
+    kernels.emplace_back(gate.mat, gate.bits);
+  }
+  // Each chunk goes through all the gates while paged in.
+  parallelFor(nbChunks(), size(), [&](uint64_t in_begin, uint64_t in_end) {
+    for (uint64_t chunk = in_begin; chunk < in_end; ++chunk) {
+      Amplitude *chunkData = m_data + chunk * chunkSize();
+      for (const auto &kernel : kernels) {
+        kernel.apply(chunkData, 0, chunkSize() / kernel.dim);
+      }
+    }
+  });
+}
+
+void PagedStateVector::applyGlobal(const Gate &in_gate) {
+  const Kernel kernel(in_gate.mat, in_gate.bits);
+  parallelFor(size() / kernel.dim, size(),
+              [&](uint64_t in_begin, uint64_t in_end) {
+                kernel.apply(m_data, in_begin, in_end);
+              });
+}
+
+void PagedStateVector::swapPhysical(size_t in_local, size_t in_high) {
+  const std::vector<size_t> sortedBits{in_local, in_high};
+  parallelFor(size() / 4, size(), [&](uint64_t in_begin, uint64_t in_end) {
+    for (uint64_t group = in_begin; group < in_end; ++group) {
+      const auto base = groupBase(group, sortedBits);
+      std::swap(m_data[base | (1ULL << in_local)],
+                m_data[base | (1ULL << in_high)]);
+    }
+  });
+  std::swap(m_logical[in_local], m_logical[in_high]);
+  m_physical[m_logical[in_local]] = in_local;
+  m_physical[m_logical[in_high]] = in_high;
+  ++m_nbSwaps;
+}
+
+template <typename F>
+std::vector<double> PagedStateVector::chunkSums(F &&in_f) const {
+  std::vector<double> sums(nbChunks(), 0.0);
+  parallelFor(nbChunks(), size(), [&](uint64_t in_begin, uint64_t in_end) {
+    for (uint64_t chunk = in_begin; chunk < in_end; ++chunk) {
+      const uint64_t offset = chunk * chunkSize();
+      double sum = 0.0;
+      for (uint64_t i = 0; i < chunkSize(); ++i) {
+        sum += in_f(offset + i, std::norm(m_data[offset + i]));
+      }
+      sums[chunk] = sum;
+    }
+  });
+  return sums;
+}
+
+double
+PagedStateVector::expectationValueZ(const std::vector<size_t> &in_bits) const {
+  uint64_t mask = 0;
+  for (const auto bit : in_bits) {
+    assert(bit < m_nbQubits);
+    mask ^= 1ULL << m_physical[bit];
+  }
+  const auto sums = chunkSums([mask](uint64_t in_idx, double in_prob) {
+    return std::bitset<64>(in_idx & mask).count() % 2 ? -in_prob : in_prob;
+  });
+  return std::accumulate(sums.begin(), sums.end(), 0.0);
+}
+
+std::map<uint64_t, int>
+PagedStateVector::sample(const std::vector<size_t> &in_bits, int in_shots,
+                         std::mt19937_64 &io_rng) const {
+  std::map<uint64_t, int> counts;
+  if (in_shots < 1) {
+    return counts;
+  }
+  const auto norms =
+      chunkSums([](uint64_t, double in_prob) { return in_prob; });
+  std::vector<double> cumulative(norms.size());
+  std::partial_sum(norms.begin(), norms.end(), cumulative.begin());
+  std::uniform_real_distribution<double> dist(0.0, cumulative.back());
+  std::vector<double> draws(in_shots);
+  for (auto &draw : draws) {
+    draw = dist(io_rng);
+  }
+  std::sort(draws.begin(), draws.end());
+
+  // First draw of each chunk, then the draws of each chunk are located within
+  // it: the state is read once more.
+  std::vector<size_t> firstDraw(nbChunks() + 1, draws.size());
+  for (size_t chunk = 0, d = 0; chunk < nbChunks(); ++chunk) {
+    firstDraw[chunk] = d;
+    if (chunk + 1 < nbChunks()) {
+      while (d < draws.size() && draws[d] < cumulative[chunk]) {
+        ++d;
+      }
+    } else {
+      d = draws.size();
+    }
+  }
+  std::vector<uint64_t> indices(draws.size());
+  parallelFor(nbChunks(), size(), [&](uint64_t in_begin, uint64_t in_end) {
+    for (uint64_t chunk = in_begin; chunk < in_end; ++chunk) {
+      size_t d = firstDraw[chunk];
+      if (d == firstDraw[chunk + 1]) {
+        continue;
+      }
+      const uint64_t offset = chunk * chunkSize();
+      double sum = chunk > 0 ? cumulative[chunk - 1] : 0.0;
+      uint64_t lastNonZero = offset;
+      for (uint64_t i = 0; i < chunkSize() && d < firstDraw[chunk + 1];
+           ++i) {
+        const double prob = std::norm(m_data[offset + i]);
+        if (prob == 0.0) {
+          continue;
+        }
+        sum += prob;
+        lastNonZero = offset + i;
+        while (d < firstDraw[chunk + 1] && draws[d] < sum) {
+          indices[d++] = offset + i;
+        }
+      }
+      // Rounding errors
+      while (d < firstDraw[chunk + 1]) {
+        indices[d++] = lastNonZero;
+      }
+    }
+  });
+
+  for (const auto idx : indices) {
+    uint64_t outcome = 0;
+    for (size_t j = 0; j < in_bits.size(); ++j) {
+      outcome |= ((idx >> m_physical[in_bits[j]]) & 1ULL) << j;
+    }
+    ++counts[outcome];
+  }
+  return counts;
+}
+
+PagedStateVector::Amplitude
+PagedStateVector::amplitude(uint64_t in_basisState) const {
+  uint64_t idx = 0;
+  for (size_t q = 0; q < m_nbQubits; ++q) {
+    idx |= ((in_basisState >> q) & 1ULL) << m_physical[q];
+  }
+  return m_data[idx];
+}
+
+template <typename F>
+void PagedStateVector::forEachLogicalBlock(F &&in_f) const {
+  // The physical index of the low logical bits of a block is looked up, that
+  // of the high bits computed once per block.
+  const size_t lowBits = std::min<size_t>(m_nbQubits, 16);
+  std::vector<uint64_t> lowIdx(1ULL << lowBits, 0);
+  for (uint64_t j = 0; j < lowIdx.size(); ++j) {
+    for (size_t q = 0; q < lowBits; ++q) {
+      lowIdx[j] |= ((j >> q) & 1ULL) << m_physical[q];
+    }
+  }
+  std::vector<uint64_t> physical(lowIdx.size());
+  for (uint64_t offset = 0; offset < size(); offset += lowIdx.size()) {
+    uint64_t high = 0;
+    for (size_t q = lowBits; q < m_nbQubits; ++q) {
+      high |= ((offset >> q) & 1ULL) << m_physical[q];
+    }
+    for (uint64_t j = 0; j < lowIdx.size(); ++j) {
+      physical[j] = lowIdx[j] | high;
+    }
+    in_f(offset, physical);
+  }
+}
+
+void PagedStateVector::load(const StateVectorReader &in_file) {
+  if (in_file.nbQubits() != m_nbQubits) {
+    xacc::error("The state vector file is of " +
+                std::to_string(in_file.nbQubits()) + " qubits, not " +
+                std::to_string(m_nbQubits) + ".");
+  }
+  forEachLogicalBlock(
+      [&](uint64_t in_offset, const std::vector<uint64_t> &in_physical) {
+        const Amplitude *block = in_file.data() + in_offset;
+        for (uint64_t j = 0; j < in_physical.size(); ++j) {
+          m_data[in_physical[j]] = block[j];
+        }
+      });
+}
+
+void PagedStateVector::save(StateVectorWriter &io_file) const {
+  if (io_file.size() != size()) {
+    xacc::error("The state vector file is of " +
+                std::to_string(io_file.size()) + " amplitudes, not " +
+                std::to_string(size()) + ".");
+  }
+  std::vector<Amplitude> block;
+  forEachLogicalBlock(
+      [&](uint64_t in_offset, const std::vector<uint64_t> &in_physical) {
+        block.resize(in_physical.size());
+        for (uint64_t j = 0; j < in_physical.size(); ++j) {
+          block[j] = m_data[in_physical[j]];
+        }
+        io_file.write(in_offset, block.data(), block.size());
+      });
+}
+} // namespace quantum
+} // namespace xacc
@@ -0,0 +1,101 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#pragma once
+#include <Eigen/Dense>
+#include <complex>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace xacc {
+class StateVectorReader;
+class StateVectorWriter;
+
+namespace quantum {
+// Out-of-core state vector of n qubits: the amplitudes live in a scratch file
+// (e.g. on NVMe) mapped in memory, the OS paging them in and out, and are
+// processed in chunks of 2^c amplitudes.
+// The c low physical qubits are 'local' (within a chunk), the others select
+// the chunk. Runs of gates on local qubits are applied chunk by chunk, i.e.
+// the state is streamed once per run rather than once per gate. Before a
+// gate on a high qubit that is used again afterwards, that qubit is swapped
+// with the local one used furthest in the future, so that the gates on it
+// become local; other high qubit gates stream the state once.
+class PagedStateVector {
+public:
+  using Amplitude = std::complex<double>;
+  // A dense unitary on its qubits, bit j of the matrix index being bits[j].
+  struct Gate {
+    std::vector<size_t> bits;
+    Eigen::MatrixXcd mat;
+  };
+  // Gates act on at most this many qubits.
+  static constexpr size_t MAX_GATE_QUBITS = 5;
+
+  // |0...0> in a new (already unlinked) file of in_dir
+  PagedStateVector(size_t in_nbQubits, size_t in_nbChunkQubits,
+                   const std::string &in_dir);
+  ~PagedStateVector();
+  PagedStateVector(const PagedStateVector &) = delete;
+  PagedStateVector &operator=(const PagedStateVector &) = delete;
+
+  void apply(const std::vector<Gate> &in_gates);
+
+  // <Z...Z> over in_bits
+  double expectationValueZ(const std::vector<size_t> &in_bits) const;
+  // Outcome -> count of in_shots draws, bit j of the outcome being the result
+  // of in_bits[j]. The state is streamed twice, whatever the number of bits.
+  std::map<uint64_t, int> sample(const std::vector<size_t> &in_bits,
+                                 int in_shots, std::mt19937_64 &io_rng) const;
+  // <in_basisState|psi> (qubit q is bit q of in_basisState)
+  Amplitude amplitude(uint64_t in_basisState) const;
+  // Replaces the state by that of the file (of the same number of qubits),
+  // and writes the state to a file, block by block in the logical order
+  // (qubit q is bit q of the index), whatever the physical permutation.
+  void load(const StateVectorReader &in_file);
+  void save(StateVectorWriter &io_file) const;
+
+  size_t nbQubits() const { return m_nbQubits; }
+  size_t nbChunkQubits() const { return m_nbChunkQubits; }
+  // Number of swaps of a high qubit with a local one so far
+  size_t nbSwaps() const { return m_nbSwaps; }
+
+private:
+  uint64_t size() const { return 1ULL << m_nbQubits; }
+  uint64_t chunkSize() const { return 1ULL << m_nbChunkQubits; }
+  uint64_t nbChunks() const { return size() >> m_nbChunkQubits; }
+  // Applies the gates (on local physical qubits) to each chunk
+  void applyLocal(const std::vector<Gate> &in_gates);
+  // Applies the gate (on physical qubits) over the whole state
+  void applyGlobal(const Gate &in_gate);
+  // Exchanges the physical qubits in_local and in_high
+  void swapPhysical(size_t in_local, size_t in_high);
+  // Sums of f(physical index, |amplitude|^2) of each chunk
+  template <typename F> std::vector<double> chunkSums(F &&in_f) const;
+  // Calls in_f(logical offset, physical indices) for each block of
+  // consecutive logical indices, in order.
+  template <typename F> void forEachLogicalBlock(F &&in_f) const;
+
+  size_t m_nbQubits;
+  size_t m_nbChunkQubits;
+  int m_fd = -1;
+  Amplitude *m_data = nullptr;
+  // Physical bit of each (logical) qubit, and the reverse
+  std::vector<size_t> m_physical;
+  std::vector<size_t> m_logical;
+  size_t m_nbSwaps = 0;
+};
+} // namespace quantum
+} // namespace xacc
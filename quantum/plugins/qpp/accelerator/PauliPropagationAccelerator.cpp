@@ -0,0 +1,308 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "PauliPropagationAccelerator.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+using xacc::quantum::PauliPropagator;
+
+double angle(xacc::Instruction &in_inst, size_t in_idx) {
+  return xacc::InstructionParameterToDouble(in_inst.getParameter(in_idx));
+}
+
+// O <- G^dagger O G, rotations being exp(-i theta/2 Q) up to a phase
+void conjugate(PauliPropagator &io_observable, xacc::Instruction &in_inst) {
+  const auto bits = in_inst.bits();
+  switch (in_inst.opcode()) {
+  case xacc::GateOpcode::I:
+    break;
+  case xacc::GateOpcode::H:
+    io_observable.h(bits[0]);
+    break;
+  case xacc::GateOpcode::X:
+    io_observable.x(bits[0]);
+    break;
+  case xacc::GateOpcode::Y:
+    io_observable.y(bits[0]);
+    break;
+  case xacc::GateOpcode::Z:
+    io_observable.z(bits[0]);
+    break;
+  case xacc::GateOpcode::S:
+    io_observable.s(bits[0]);
+    break;
+  case xacc::GateOpcode::Sdg:
+    io_observable.sdg(bits[0]);
+    break;
+  case xacc::GateOpcode::T:
+    io_observable.rotate({{bits[0], 'Z'}}, M_PI_4);
+    break;
+  case xacc::GateOpcode::Tdg:
+    io_observable.rotate({{bits[0], 'Z'}}, -M_PI_4);
+    break;
+  case xacc::GateOpcode::Rx:
+    io_observable.rotate({{bits[0], 'X'}}, angle(in_inst, 0));
+    break;
+  case xacc::GateOpcode::Ry:
+    io_observable.rotate({{bits[0], 'Y'}}, angle(in_inst, 0));
+    break;
+  case xacc::GateOpcode::Rz:
+  case xacc::GateOpcode::U1:
+    io_observable.rotate({{bits[0], 'Z'}}, angle(in_inst, 0));
+    break;
+  case xacc::GateOpcode::U:
+    // U(theta, phi, lambda) = Rz(phi) Ry(theta) Rz(lambda): last first
+    io_observable.rotate({{bits[0], 'Z'}}, angle(in_inst, 1));
+    io_observable.rotate({{bits[0], 'Y'}}, angle(in_inst, 0));
+    io_observable.rotate({{bits[0], 'Z'}}, angle(in_inst, 2));
+    break;
+  case xacc::GateOpcode::CNOT:
+    io_observable.cx(bits[0], bits[1]);
+    break;
+  case xacc::GateOpcode::CZ:
+    io_observable.cz(bits[0], bits[1]);
+    break;
+  case xacc::GateOpcode::CY:
+    // CY = S_t CNOT Sdg_t: last first
+    io_observable.s(bits[1]);
+    io_observable.cx(bits[0], bits[1]);
+    io_observable.sdg(bits[1]);
+    break;
+  case xacc::GateOpcode::Swap:
+    io_observable.swap(bits[0], bits[1]);
+    break;
+  case xacc::GateOpcode::CRZ: {
+    // Rz_t(theta/2) exp(i theta/4 Z_c Z_t)
+    const double theta = angle(in_inst, 0);
+    io_observable.rotate({{bits[1], 'Z'}}, theta / 2);
+    io_observable.rotate({{bits[0], 'Z'}, {bits[1], 'Z'}}, -theta / 2);
+    break;
+  }
+  case xacc::GateOpcode::CPhase: {
+    // Rz_a(phi/2) Rz_b(phi/2) exp(i phi/4 Z_a Z_b), up to a phase
+    const double phi = angle(in_inst, 0);
+    io_observable.rotate({{bits[0], 'Z'}}, phi / 2);
+    io_observable.rotate({{bits[1], 'Z'}}, phi / 2);
+    io_observable.rotate({{bits[0], 'Z'}, {bits[1], 'Z'}}, -phi / 2);
+    break;
+  }
+  case xacc::GateOpcode::iSwap:
+  case xacc::GateOpcode::fSim: {
+    // exp(-i theta/2 (XX + YY)) then CPhase(-phi), all commuting;
+    // iSwap = fSim(-pi/2, 0).
+    const bool isISwap = in_inst.opcode() == xacc::GateOpcode::iSwap;
+    const double theta = isISwap ? -M_PI_2 : angle(in_inst, 0);
+    const double phi = isISwap ? 0.0 : angle(in_inst, 1);
+    io_observable.rotate({{bits[0], 'X'}, {bits[1], 'X'}}, theta);
+    io_observable.rotate({{bits[0], 'Y'}, {bits[1], 'Y'}}, theta);
+    if (phi != 0.0) {
+      io_observable.rotate({{bits[0], 'Z'}}, -phi / 2);
+      io_observable.rotate({{bits[1], 'Z'}}, -phi / 2);
+      io_observable.rotate({{bits[0], 'Z'}, {bits[1], 'Z'}}, phi / 2);
+    }
+    break;
+  }
+  default:
+    xacc::error("Gate '" + in_inst.name() +
+                "' is not supported by the Pauli propagation simulator.");
+  }
+}
+
+// Not worth the scheduling for fewer kernels
+void parallelFor(size_t in_size, const std::function<void(size_t)> &in_f) {
+  if (in_size < 2) {
+    for (size_t i = 0; i < in_size; ++i) {
+      in_f(i);
+    }
+    return;
+  }
+  xacc::getTaskScheduler()->parallelFor(
+      0, in_size, [&](size_t beginIdx, size_t endIdx) {
+        for (size_t i = beginIdx; i < endIdx; ++i) {
+          in_f(i);
+        }
+      });
+}
+} // namespace
+
+namespace xacc {
+namespace quantum {
+void PauliPropagationAccelerator::initialize(const HeterogeneousMap &params) {
+  if (params.keyExists<int>("shots") && params.get<int>("shots") > 0) {
+    xacc::error("The Pauli propagation simulator does not support sampling "
+                "(shots), only exp-val-z.");
+  }
+  m_threshold = 1e-10;
+  if (params.keyExists<double>("truncation-threshold")) {
+    m_threshold = params.get<double>("truncation-threshold");
+    if (m_threshold < 0.0) {
+      xacc::error("Invalid 'truncation-threshold' parameter: must be "
+                  "non-negative.");
+    }
+  }
+}
+
+void PauliPropagationAccelerator::addInstruction(Instruction *in_inst,
+                                                 Program &io_program) {
+  if (!in_inst->isEnabled()) {
+    return;
+  }
+  if (in_inst->isComposite()) {
+    if (in_inst->name() == "ifstmt") {
+      xacc::error("Conditionals are not supported by the Pauli propagation "
+                  "simulator.");
+    }
+    addInstructions(*dynamic_cast<CompositeInstruction *>(in_inst),
+                    io_program);
+    return;
+  }
+  const auto bits = in_inst->bits();
+  for (const auto bit : bits) {
+    if (xacc::container::contains(io_program.measured, bit)) {
+      xacc::error("Mid-circuit measurements are not supported by the Pauli "
+                  "propagation simulator.");
+    }
+  }
+  if (in_inst->opcode() == GateOpcode::Measure) {
+    io_program.measured.emplace_back(bits[0]);
+  } else if (in_inst->opcode() == GateOpcode::Reset) {
+    xacc::error("Resets are not supported by the Pauli propagation "
+                "simulator.");
+  } else if (in_inst->opcode() != GateOpcode::I) {
+    io_program.gates.emplace_back(in_inst);
+  }
+}
+
+void PauliPropagationAccelerator::addInstructions(
+    CompositeInstruction &in_composite, Program &io_program) {
+  for (size_t i = 0; i < in_composite.nInstructions(); ++i) {
+    addInstruction(in_composite.getInstruction(i).get(), io_program);
+  }
+}
+
+void PauliPropagationAccelerator::propagate(const Program *in_prefix,
+                                            const Program &in_program,
+                                            AcceleratorBuffer &io_buffer) const {
+  if (in_program.measured.empty()) {
+    return;
+  }
+  PauliPropagator observable(io_buffer.size(), m_threshold);
+  observable.addZTerm(in_program.measured, 1.0);
+  for (auto iter = in_program.gates.rbegin(); iter != in_program.gates.rend();
+       ++iter) {
+    conjugate(observable, **iter);
+  }
+  if (in_prefix) {
+    for (auto iter = in_prefix->gates.rbegin();
+         iter != in_prefix->gates.rend(); ++iter) {
+      conjugate(observable, **iter);
+    }
+  }
+  io_buffer.addExtraInfo("exp-val-z", observable.expectationValue());
+  io_buffer.addExtraInfo("pauli-terms",
+                         static_cast<int>(observable.maxNbTerms()));
+}
+
+void PauliPropagationAccelerator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::shared_ptr<CompositeInstruction> compositeInstruction) {
+  ScopedExecutionMetrics metrics(*this, 1, -1);
+  Program program;
+  addInstructions(*compositeInstruction, program);
+  propagate(nullptr, program, *buffer);
+}
+
+void PauliPropagationAccelerator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>>
+        compositeInstructions) {
+  ScopedExecutionMetrics metrics(*this, compositeInstructions.size(), -1);
+  // Checked up front: no errors from the worker threads
+  std::vector<Program> programs(compositeInstructions.size());
+  std::vector<std::shared_ptr<AcceleratorBuffer>> results;
+  for (size_t i = 0; i < compositeInstructions.size(); ++i) {
+    addInstructions(*compositeInstructions[i], programs[i]);
+    results.emplace_back(std::make_shared<AcceleratorBuffer>(
+        compositeInstructions[i]->name(), buffer->size()));
+  }
+  parallelFor(programs.size(),
+              [&](size_t i) { propagate(nullptr, programs[i], *results[i]); });
+  for (size_t i = 0; i < results.size(); ++i) {
+    buffer->appendChild(compositeInstructions[i]->name(), results[i]);
+  }
+}
+
+void PauliPropagationAccelerator::computeExpectations(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::shared_ptr<CompositeInstruction> ansatz,
+    std::shared_ptr<Observable> observable) {
+  computeExpectations(std::vector<std::shared_ptr<AcceleratorBuffer>>{buffer},
+                      std::vector<std::shared_ptr<CompositeInstruction>>{ansatz},
+                      observable);
+}
+
+void PauliPropagationAccelerator::computeExpectations(
+    const std::vector<std::shared_ptr<AcceleratorBuffer>> &buffers,
+    const std::vector<std::shared_ptr<CompositeInstruction>> &ansatzes,
+    std::shared_ptr<Observable> observable) {
+  if (buffers.size() != ansatzes.size()) {
+    xacc::error("computeExpectations: expected one buffer per ansatz.");
+  }
+  // The observed kernels are the ansatz followed by the basis change and
+  // measurements: the ansatz gates are collected once, and each measured
+  // kernel (term) is a job.
+  struct Job {
+    size_t ansatz;
+    bool afterAnsatz;
+    Program tail;
+    std::string name;
+    std::shared_ptr<AcceleratorBuffer> result;
+  };
+  std::vector<Program> prefixes(ansatzes.size());
+  std::vector<Job> jobs;
+  for (size_t i = 0; i < ansatzes.size(); ++i) {
+    addInstructions(*ansatzes[i], prefixes[i]);
+    for (auto &kernel : observable->observe(ansatzes[i])) {
+      const bool startsWithAnsatz = ansatzes[i]->nInstructions() > 0 &&
+                                    kernel->nInstructions() > 0 &&
+                                    kernel->getInstruction(0)->isComposite();
+      Job job{i, startsWithAnsatz,
+              Program{{}, startsWithAnsatz ? prefixes[i].measured
+                                           : std::vector<size_t>{}},
+              kernel->name(), nullptr};
+      for (size_t k = startsWithAnsatz ? 1 : 0; k < kernel->nInstructions();
+           ++k) {
+        addInstruction(kernel->getInstruction(k).get(), job.tail);
+      }
+      // Identity term: nothing to measure
+      if (job.tail.measured.empty()) {
+        continue;
+      }
+      job.result =
+          std::make_shared<AcceleratorBuffer>(job.name, buffers[i]->size());
+      jobs.emplace_back(std::move(job));
+    }
+  }
+  ScopedExecutionMetrics metrics(*this, jobs.size(), -1);
+  parallelFor(jobs.size(), [&](size_t i) {
+    const auto &job = jobs[i];
+    propagate(job.afterAnsatz ? &prefixes[job.ansatz] : nullptr, job.tail,
+              *job.result);
+  });
+  for (auto &job : jobs) {
+    buffers[job.ansatz]->appendChild(job.name, job.result);
+  }
+}
+} // namespace quantum
+} // namespace xacc
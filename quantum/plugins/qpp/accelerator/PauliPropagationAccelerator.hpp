@@ -0,0 +1,79 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#pragma once
+#include "xacc.hpp"
+#include "PauliPropagator.hpp"
+
+namespace xacc {
+namespace quantum {
+// Noiseless expectation values of circuits with many qubits but few
+// non-Clifford rotations: the measured Z...Z is propagated backward through
+// the circuit (Heisenberg picture, PauliPropagator), then evaluated on
+// |0...0>. Only "exp-val-z" is computed (no shots). The Pauli terms of at
+// most "truncation-threshold" are dropped (0: exact, exponential in the
+// number of non-Clifford rotations); "pauli-terms" is the largest number of
+// terms of the propagation.
+// The kernels of a batch, or of the observable terms of computeExpectations,
+// are propagated in parallel, the ansatz being flattened once.
+class PauliPropagationAccelerator : public Accelerator {
+public:
+  // Identifiable interface impls
+  const std::string name() const override { return "pauli-propagation"; }
+  const std::string description() const override {
+    return "XACC Simulation Accelerator computing expectation values by "
+           "Pauli propagation in the Heisenberg picture.";
+  }
+
+  // Accelerator interface impls
+  void initialize(const HeterogeneousMap &params = {}) override;
+  void updateConfiguration(const HeterogeneousMap &config) override {
+    initialize(config);
+  };
+  const std::vector<std::string> configurationKeys() override {
+    return {"truncation-threshold"};
+  }
+  BitOrder getBitOrder() override { return BitOrder::LSB; }
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::shared_ptr<CompositeInstruction>
+                   compositeInstruction) override;
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::vector<std::shared_ptr<CompositeInstruction>>
+                   compositeInstructions) override;
+  void computeExpectations(std::shared_ptr<AcceleratorBuffer> buffer,
+                           const std::shared_ptr<CompositeInstruction> ansatz,
+                           std::shared_ptr<Observable> observable) override;
+  void computeExpectations(
+      const std::vector<std::shared_ptr<AcceleratorBuffer>> &buffers,
+      const std::vector<std::shared_ptr<CompositeInstruction>> &ansatzes,
+      std::shared_ptr<Observable> observable) override;
+
+private:
+  // The gates of a circuit and its measured qubits
+  struct Program {
+    std::vector<Instruction *> gates;
+    std::vector<size_t> measured;
+  };
+  // Appends the (supported) enabled gates and measurements to io_program;
+  // measured qubits can't be acted on again.
+  static void addInstruction(Instruction *in_inst, Program &io_program);
+  static void addInstructions(CompositeInstruction &in_composite,
+                              Program &io_program);
+  // <0...0|program^dagger Z...Z program|0...0>, the gates of in_prefix
+  // (if any) coming before those of in_program. Stored as "exp-val-z".
+  void propagate(const Program *in_prefix, const Program &in_program,
+                 AcceleratorBuffer &io_buffer) const;
+
+  double m_threshold = 1e-10;
+};
+} // namespace quantum
+} // namespace xacc
@@ -0,0 +1,333 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "PauliPropagator.hpp"
+#include "xacc.hpp"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace {
+// Below that, cos/sin of a rotation angle are zero (Clifford angles), and
+// the terms are mapped in place rather than split.
+constexpr double ZERO_TOLERANCE = 1e-14;
+
+inline bool bit(const uint64_t *in_row, size_t in_qubit) {
+  return (in_row[in_qubit / 64] >> (in_qubit % 64)) & 1ULL;
+}
+inline void flipBit(uint64_t *io_row, size_t in_qubit) {
+  io_row[in_qubit / 64] ^= 1ULL << (in_qubit % 64);
+}
+inline void setBit(uint64_t *io_row, size_t in_qubit, bool in_value) {
+  if (bit(io_row, in_qubit) != in_value) {
+    flipBit(io_row, in_qubit);
+  }
+}
+
+// p * q = i^k r for single-qubit Paulis of (x, z) bits: k = +1 for XY, YZ,
+// ZX, -1 for YX, ZY, XZ, 0 otherwise.
+int productPhase(bool in_x1, bool in_z1, bool in_x2, bool in_z2) {
+  const int p = in_x1 ? (in_z1 ? 2 : 1) : (in_z1 ? 3 : 0);
+  const int q = in_x2 ? (in_z2 ? 2 : 1) : (in_z2 ? 3 : 0);
+  if (p == 0 || q == 0 || p == q) {
+    return 0;
+  }
+  // X = 1, Y = 2, Z = 3: cyclic order is +1
+  return (q - p + 3) % 3 == 1 ? 1 : -1;
+}
+
+uint64_t hashRow(const uint64_t *in_x, const uint64_t *in_z,
+                 size_t in_nbWords) {
+  uint64_t hash = 0x9e3779b97f4a7c15ULL;
+  const auto mix = [&hash](uint64_t in_word) {
+    hash ^= in_word + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+  };
+  for (size_t word = 0; word < in_nbWords; ++word) {
+    mix(in_x[word]);
+    mix(in_z[word]);
+  }
+  return hash;
+}
+} // namespace
+
+namespace xacc {
+namespace quantum {
+PauliPropagator::PauliPropagator(size_t in_nbQubits, double in_threshold)
+    : m_nbQubits(in_nbQubits), m_nbWords((in_nbQubits + 63) / 64),
+      m_threshold(in_threshold) {}
+
+void PauliPropagator::addZTerm(const std::vector<size_t> &in_qubits,
+                               double in_coefficient) {
+  std::vector<uint64_t> x(m_nbWords, 0), z(m_nbWords, 0);
+  for (const auto qubit : in_qubits) {
+    if (qubit >= m_nbQubits) {
+      xacc::error("Invalid qubit " + std::to_string(qubit) + ".");
+    }
+    flipBit(z.data(), qubit);
+  }
+  merge(x, z, {in_coefficient});
+}
+
+void PauliPropagator::h(size_t in_qubit) {
+  for (size_t term = 0; term < nbTerms(); ++term) {
+    auto *x = xRow(term);
+    auto *z = zRow(term);
+    const bool xBit = bit(x, in_qubit), zBit = bit(z, in_qubit);
+    if (xBit && zBit) {
+      m_coefficients[term] = -m_coefficients[term];
+    }
+    if (xBit != zBit) {
+      flipBit(x, in_qubit);
+      flipBit(z, in_qubit);
+    }
+  }
+}
+
+// S^dagger X S = -Y, S^dagger Y S = X
+void PauliPropagator::s(size_t in_qubit) {
+  for (size_t term = 0; term < nbTerms(); ++term) {
+    auto *x = xRow(term);
+    auto *z = zRow(term);
+    if (bit(x, in_qubit)) {
+      if (!bit(z, in_qubit)) {
+        m_coefficients[term] = -m_coefficients[term];
+      }
+      flipBit(z, in_qubit);
+    }
+  }
+}
+
+// S X S^dagger = Y, S Y S^dagger = -X
+void PauliPropagator::sdg(size_t in_qubit) {
+  for (size_t term = 0; term < nbTerms(); ++term) {
+    auto *x = xRow(term);
+    auto *z = zRow(term);
+    if (bit(x, in_qubit)) {
+      if (bit(z, in_qubit)) {
+        m_coefficients[term] = -m_coefficients[term];
+      }
+      flipBit(z, in_qubit);
+    }
+  }
+}
+
+void PauliPropagator::x(size_t in_qubit) {
+  for (size_t term = 0; term < nbTerms(); ++term) {
+    if (bit(zRow(term), in_qubit)) {
+      m_coefficients[term] = -m_coefficients[term];
+    }
+  }
+}
+
+void PauliPropagator::y(size_t in_qubit) {
+  for (size_t term = 0; term < nbTerms(); ++term) {
+    if (bit(xRow(term), in_qubit) != bit(zRow(term), in_qubit)) {
+      m_coefficients[term] = -m_coefficients[term];
+    }
+  }
+}
+
+void PauliPropagator::z(size_t in_qubit) {
+  for (size_t term = 0; term < nbTerms(); ++term) {
+    if (bit(xRow(term), in_qubit)) {
+      m_coefficients[term] = -m_coefficients[term];
+    }
+  }
+}
+
+// X_c -> X_c X_t, Z_t -> Z_c Z_t (self-adjoint, as the tableau update)
+void PauliPropagator::cx(size_t in_control, size_t in_target) {
+  for (size_t term = 0; term < nbTerms(); ++term) {
+    auto *x = xRow(term);
+    auto *z = zRow(term);
+    const bool xc = bit(x, in_control), zc = bit(z, in_control);
+    const bool xt = bit(x, in_target), zt = bit(z, in_target);
+    if (xc && zt && (xt == zc)) {
+      m_coefficients[term] = -m_coefficients[term];
+    }
+    if (xc) {
+      flipBit(x, in_target);
+    }
+    if (zt) {
+      flipBit(z, in_control);
+    }
+  }
+}
+
+// X_a -> X_a Z_b, X_b -> Z_a X_b
+void PauliPropagator::cz(size_t in_qubit1, size_t in_qubit2) {
+  for (size_t term = 0; term < nbTerms(); ++term) {
+    auto *x = xRow(term);
+    auto *z = zRow(term);
+    const bool x1 = bit(x, in_qubit1), z1 = bit(z, in_qubit1);
+    const bool x2 = bit(x, in_qubit2), z2 = bit(z, in_qubit2);
+    if (x1 && x2 && (z1 != z2)) {
+      m_coefficients[term] = -m_coefficients[term];
+    }
+    if (x2) {
+      flipBit(z, in_qubit1);
+    }
+    if (x1) {
+      flipBit(z, in_qubit2);
+    }
+  }
+}
+
+void PauliPropagator::swap(size_t in_qubit1, size_t in_qubit2) {
+  for (size_t term = 0; term < nbTerms(); ++term) {
+    for (auto *row : {xRow(term), zRow(term)}) {
+      const bool bit1 = bit(row, in_qubit1), bit2 = bit(row, in_qubit2);
+      setBit(row, in_qubit1, bit2);
+      setBit(row, in_qubit2, bit1);
+    }
+  }
+}
+
+// exp(i t Q) P exp(-i t Q) = P exp(-2 i t Q) if P anticommutes with Q:
+// cos(theta) P + sin(theta) (-i P Q), -i P Q being a Hermitian string.
+void PauliPropagator::rotate(const std::vector<std::pair<size_t, char>> &in_pauli,
+                             double in_angle) {
+  const double cosAngle = std::cos(in_angle);
+  const double sinAngle = std::sin(in_angle);
+  const bool isCosZero = std::abs(cosAngle) < ZERO_TOLERANCE;
+  const bool isSinZero = std::abs(sinAngle) < ZERO_TOLERANCE;
+  for (const auto &[qubit, op] : in_pauli) {
+    if (qubit >= m_nbQubits || (op != 'X' && op != 'Y' && op != 'Z')) {
+      xacc::error("Invalid rotation Pauli " + std::string(1, op) +
+                  std::to_string(qubit) + ".");
+    }
+  }
+
+  std::vector<uint64_t> newX, newZ;
+  std::vector<double> newCoefficients;
+  const size_t nbOldTerms = nbTerms();
+  for (size_t term = 0; term < nbOldTerms; ++term) {
+    auto *x = xRow(term);
+    auto *z = zRow(term);
+    bool anticommutes = false;
+    int phase = 0;
+    for (const auto &[qubit, op] : in_pauli) {
+      const bool px = bit(x, qubit), pz = bit(z, qubit);
+      const bool qx = op != 'Z', qz = op != 'X';
+      anticommutes ^= (px && qz) != (pz && qx);
+      phase += productPhase(px, pz, qx, qz);
+    }
+    if (!anticommutes) {
+      continue;
+    }
+    // P Q = i^phase R, phase odd: -i P Q = +/- R
+    const double sign = ((phase % 4) + 4) % 4 == 1 ? 1.0 : -1.0;
+    if (isSinZero) {
+      m_coefficients[term] *= cosAngle;
+      continue;
+    }
+    // The product string: only the bits of the rotation qubits change.
+    if (isCosZero) {
+      for (const auto &[qubit, op] : in_pauli) {
+        if (op != 'Z') {
+          flipBit(x, qubit);
+        }
+        if (op != 'X') {
+          flipBit(z, qubit);
+        }
+      }
+      m_coefficients[term] *= sign * sinAngle;
+      continue;
+    }
+    newX.insert(newX.end(), x, x + m_nbWords);
+    newZ.insert(newZ.end(), z, z + m_nbWords);
+    auto *productX = &newX[newX.size() - m_nbWords];
+    auto *productZ = &newZ[newZ.size() - m_nbWords];
+    for (const auto &[qubit, op] : in_pauli) {
+      if (op != 'Z') {
+        flipBit(productX, qubit);
+      }
+      if (op != 'X') {
+        flipBit(productZ, qubit);
+      }
+    }
+    newCoefficients.emplace_back(m_coefficients[term] * sign * sinAngle);
+    m_coefficients[term] *= cosAngle;
+  }
+  // Anticommuting strings times Q map one-to-one, hence the in place cases
+  // need no merging.
+  if (newCoefficients.empty()) {
+    truncate();
+  } else {
+    merge(newX, newZ, newCoefficients);
+  }
+}
+
+void PauliPropagator::merge(const std::vector<uint64_t> &in_x,
+                            const std::vector<uint64_t> &in_z,
+                            const std::vector<double> &in_coefficients) {
+  std::unordered_multimap<uint64_t, size_t> index;
+  index.reserve(nbTerms() + in_coefficients.size());
+  for (size_t term = 0; term < nbTerms(); ++term) {
+    index.emplace(hashRow(xRow(term), zRow(term), m_nbWords), term);
+  }
+  for (size_t i = 0; i < in_coefficients.size(); ++i) {
+    const auto *x = &in_x[i * m_nbWords];
+    const auto *z = &in_z[i * m_nbWords];
+    const auto hash = hashRow(x, z, m_nbWords);
+    bool found = false;
+    const auto range = index.equal_range(hash);
+    for (auto iter = range.first; iter != range.second; ++iter) {
+      if (std::equal(x, x + m_nbWords, xRow(iter->second)) &&
+          std::equal(z, z + m_nbWords, zRow(iter->second))) {
+        m_coefficients[iter->second] += in_coefficients[i];
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      index.emplace(hash, nbTerms());
+      m_x.insert(m_x.end(), x, x + m_nbWords);
+      m_z.insert(m_z.end(), z, z + m_nbWords);
+      m_coefficients.emplace_back(in_coefficients[i]);
+    }
+  }
+  m_maxNbTerms = std::max(m_maxNbTerms, nbTerms());
+  truncate();
+}
+
+void PauliPropagator::truncate() {
+  size_t kept = 0;
+  for (size_t term = 0; term < nbTerms(); ++term) {
+    if (std::abs(m_coefficients[term]) <= m_threshold) {
+      continue;
+    }
+    if (kept != term) {
+      std::copy_n(xRow(term), m_nbWords, xRow(kept));
+      std::copy_n(zRow(term), m_nbWords, zRow(kept));
+      m_coefficients[kept] = m_coefficients[term];
+    }
+    ++kept;
+  }
+  m_x.resize(kept * m_nbWords);
+  m_z.resize(kept * m_nbWords);
+  m_coefficients.resize(kept);
+}
+
+double PauliPropagator::expectationValue() const {
+  double expectation = 0.0;
+  for (size_t term = 0; term < nbTerms(); ++term) {
+    const auto *x = &m_x[term * m_nbWords];
+    if (std::all_of(x, x + m_nbWords,
+                    [](uint64_t in_word) { return in_word == 0; })) {
+      expectation += m_coefficients[term];
+    }
+  }
+  return expectation;
+}
+} // namespace quantum
+} // namespace xacc
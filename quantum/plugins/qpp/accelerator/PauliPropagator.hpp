@@ -0,0 +1,76 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace xacc {
+namespace quantum {
+// An observable as a real combination of Pauli strings, evolved in the
+// Heisenberg picture: each gate call conjugates it, O <- G^dagger O G, so
+// that the gates of a circuit are applied last to first. The strings are
+// packed as in the stabilizer tableau (X and Z bits, 64 qubits per word).
+// Clifford gates map each string to another one; a rotation exp(-i theta/2 Q)
+// splits the strings anticommuting with Q in two (cos(theta) P and
+// sin(theta) (-i P Q)), merged with the existing ones. The terms of at
+// most the truncation threshold (in absolute value) are dropped, so that the
+// cost only grows with the number of non-Clifford rotations.
+class PauliPropagator {
+public:
+  // The zero observable
+  PauliPropagator(size_t in_nbQubits, double in_threshold);
+
+  // O <- O + in_coefficient Z...Z on in_qubits
+  void addZTerm(const std::vector<size_t> &in_qubits, double in_coefficient);
+
+  void h(size_t in_qubit);
+  void s(size_t in_qubit);
+  void sdg(size_t in_qubit);
+  void x(size_t in_qubit);
+  void y(size_t in_qubit);
+  void z(size_t in_qubit);
+  void cx(size_t in_control, size_t in_target);
+  void cz(size_t in_qubit1, size_t in_qubit2);
+  void swap(size_t in_qubit1, size_t in_qubit2);
+  // exp(-i in_angle/2 Q), Q given as (qubit, 'X', 'Y' or 'Z') pairs
+  void rotate(const std::vector<std::pair<size_t, char>> &in_pauli,
+              double in_angle);
+
+  // <0...0|O|0...0>: the sum of the coefficients of the Z-only strings
+  double expectationValue() const;
+  size_t nbTerms() const { return m_coefficients.size(); }
+  // The largest number of terms so far
+  size_t maxNbTerms() const { return m_maxNbTerms; }
+
+private:
+  uint64_t *xRow(size_t in_term) { return &m_x[in_term * m_nbWords]; }
+  uint64_t *zRow(size_t in_term) { return &m_z[in_term * m_nbWords]; }
+  // Appends the strings of in_x/in_z (in_coefficients.size() rows), adding
+  // the coefficients of those already there, then drops the small terms.
+  void merge(const std::vector<uint64_t> &in_x,
+             const std::vector<uint64_t> &in_z,
+             const std::vector<double> &in_coefficients);
+  void truncate();
+
+  size_t m_nbQubits;
+  size_t m_nbWords;
+  double m_threshold;
+  std::vector<uint64_t> m_x;
+  std::vector<uint64_t> m_z;
+  std::vector<double> m_coefficients;
+  size_t m_maxNbTerms = 0;
+};
+} // namespace quantum
+} // namespace xacc
@@ -11,209 +11,212 @@
  *   Thien Nguyen - initial API and implementation
  *******************************************************************************/
 #include "QppAccelerator.hpp"
-#include <thread>
-#include <mutex>
 #include "IRUtils.hpp"
+#include "MeasurementSampler.hpp"
+#include "Circuit.hpp"
+#include "GateFusion.hpp"
+#include "xacc.hpp"
+#include "xacc_service.hpp"
+#include "DensityMatrix.hpp"
+#include "PagedStateVector.hpp"
+#include "StabilizerAccelerator.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <numeric>
+#include <random>
 
 namespace {
-    inline bool isMeasureGate(const xacc::InstPtr& in_instr)
+    inline bool isMeasureGate(xacc::Instruction* in_instr)
     {
-        return (in_instr->name() == "Measure");
+        return (in_instr->opcode() == xacc::GateOpcode::Measure);
     }
 
-    inline size_t getNumberOfThreads()
+    inline bool isMeasureGate(const xacc::InstPtr& in_instr)
     {
-        static const size_t NB_THREADS = std::thread::hardware_concurrency();
-        return NB_THREADS;
+        return isMeasureGate(in_instr.get());
     }
 
-    inline double generateRandomProbability() 
+    Eigen::MatrixXcd convertToEigenMat(const NoiseModelUtils::cMat& in_stdMat)
     {
-        auto randFunc = std::bind(std::uniform_real_distribution<double>(0, 1), std::mt19937(std::chrono::high_resolution_clock::now().time_since_epoch().count()));
-        return randFunc();
+        Eigen::MatrixXcd result =  Eigen::MatrixXcd::Zero(in_stdMat.size(), in_stdMat.size());
+        for (size_t row = 0; row < in_stdMat.size(); ++row)
+        {
+            for (size_t col = 0; col < in_stdMat.size(); ++col)
+            {
+                result(row, col) = in_stdMat[row][col];
+            }
+        }
+        return result;
     }
 
-    bool applyMeasureOp(KetVectorType& io_psi, size_t in_qubitIndex)
+    NoiseModelUtils::cMat convertToStdMat(const Eigen::MatrixXcd& in_eigenMat)
     {
-        const auto N = io_psi.size();
-        const auto k_range = 1ULL << in_qubitIndex;        
-        const double randProbPick = generateRandomProbability();
-        double cumulativeProb = 0.0;
-        size_t stateSelect = 0;
-        //select a state based on cumulative distribution
-        while (cumulativeProb < randProbPick && stateSelect < N)
+        const size_t dim = in_eigenMat.rows();
+        NoiseModelUtils::cMat result;
+        for (size_t row = 0; row < dim; ++row)
         {
-            cumulativeProb += std::norm(io_psi[stateSelect++]);
+            std::vector<std::complex<double>> rowVec;
+            for (size_t col = 0; col < dim; ++col)
+            {
+                rowVec.emplace_back(in_eigenMat(row, col)); 
+            }
+            result.emplace_back(rowVec);
         }
-        stateSelect--;
+        return result;
+    }
 
-        //take the value of the measured bit
-        bool result = ((stateSelect >> in_qubitIndex) & 1);
-        // Collapse the state vector according to the measurement result
-        double measProb = 0.0;
-        for (size_t g = 0; g < N; g += (k_range * 2))
+    // Qubits of a noise channel, the first one being the LSB of its Kraus
+    // matrices (same qubit order as the Aer noise model generated from it).
+    std::vector<size_t> noiseChannelBits(const NoiseChannelKraus& in_channel, size_t in_nbQubits)
+    {
+        auto bits = in_channel.noise_qubits;
+        if (in_channel.bit_order == KrausMatBitOrder::LSB)
         {
-            for (size_t i = 0; i < k_range; ++i)
-            {
-                if ((((i + g) >> in_qubitIndex) & 1) == result)
-                {
-                    measProb += std::norm(io_psi[i + g]);
-                    io_psi[i + g + k_range] = 0.0; 
-                }
-                else
-                {
-                    measProb += std::norm(io_psi[i + g + k_range]);
-                    io_psi[i + g] = 0.0;
-                }
-            }
+            std::reverse(bits.begin(), bits.end());
         }
-        // Renormalize the state
-        measProb = std::sqrt(measProb);
-        for (size_t g = 0; g < N; g += (k_range * 2))
+        for (const auto bit : bits)
         {
-            for (size_t i = 0; i < k_range; i += 1)
+            if (bit >= in_nbQubits)
             {
-                if ((((i + g) >> in_qubitIndex) & 1) == result)
-                {
-                    io_psi[i + g] /= measProb;
-                }
-                else
-                {
-                    io_psi[i + g + k_range] /= measProb;
-                }    
+                xacc::error("Noise channel on qubit " + std::to_string(bit) + " is out of range.");
             }
         }
-
-        return result;
+        return bits;
     }
 
-    void generateMeasureBitString(std::shared_ptr<xacc::AcceleratorBuffer> in_buffer, const std::vector<size_t>& in_bits, const KetVectorType& in_stateVec, int in_shotCount, bool in_multiThread = false)
+    // Bit string of a sampled outcome (bit j is the j-th measured qubit), each
+    // bit flipped with its readout error (meas0Prep1, meas1Prep0) probability.
+    std::string toNoisyBitString(uint64_t in_outcome, const std::vector<RoErrors>& in_roErrors, std::mt19937_64& io_rng)
     {
-        if (!in_multiThread)
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+        std::string bitString;
+        for (size_t j = 0; j < in_roErrors.size(); ++j)
         {
-            // Sequential execution
-            for (int i = 0; i < in_shotCount; ++i)
+            bool bit = (in_outcome >> j) & 1ULL;
+            const double flipProb = bit ? in_roErrors[j].first : in_roErrors[j].second;
+            if (flipProb > 0.0 && dist(io_rng) < flipProb)
             {
-                std::string bitString;
-                auto stateVecCopy = in_stateVec;
-                for (const auto& bit : in_bits)    
-                {
-                    bitString.append(std::to_string(applyMeasureOp(stateVecCopy, bit)));
-                }
-
-                in_buffer->appendMeasurement(bitString);
+                bit = !bit;
             }
+            bitString.push_back(bit ? '1' : '0');
         }
-        else
+        return bitString;
+    }
+
+    // Gates that the GateFuser can compute the matrix of.
+    bool isFusibleGate(const xacc::Instruction* in_instr)
+    {
+        using xacc::GateOpcode;
+        switch (in_instr->opcode())
         {
-            // Parallel execution: divide the shot counts to threads.
-            std::vector<std::string> bitStringArray(in_shotCount);
-            std::vector<std::thread> threads(getNumberOfThreads());
-            std::mutex critical;
-            for(int t = 0; t < getNumberOfThreads(); ++t)
-            {
-                threads[t] = std::thread(std::bind([&](int beginIdx, int endIdx, int threadIdx) {
-                    for(int i = beginIdx; i < endIdx; ++i)
-                    {
-                        std::string bitString;
-                        auto stateVecCopy = in_stateVec;
-                        for (const auto& bit : in_bits)    
-                        {
-                            bitString.append(std::to_string(applyMeasureOp(stateVecCopy, bit)));
-                        }
-                        bitStringArray[i] = bitString;
-                    }
-                    {
-                        // Add measurement bitstring to the buffer:
-                        std::lock_guard<std::mutex> lock(critical);
-                        for(int i = beginIdx; i < endIdx; ++i)
-                        {
-                            in_buffer->appendMeasurement(bitStringArray[i]);
-                        }
-                    }
-                }, 
-                t * in_shotCount / getNumberOfThreads(), 
-                (t+1) == getNumberOfThreads() ? in_shotCount: (t+1) * in_shotCount/getNumberOfThreads(), 
-                t));
-            }
-            std::for_each(threads.begin(),threads.end(),[](std::thread& x){
-                x.join();
-            });
+        case GateOpcode::H: case GateOpcode::CNOT: case GateOpcode::Rx: case GateOpcode::Ry:
+        case GateOpcode::Rz: case GateOpcode::X: case GateOpcode::Y: case GateOpcode::Z:
+        case GateOpcode::CY: case GateOpcode::CZ: case GateOpcode::Swap: case GateOpcode::CRZ:
+        case GateOpcode::CH: case GateOpcode::S: case GateOpcode::Sdg: case GateOpcode::T:
+        case GateOpcode::Tdg: case GateOpcode::CPhase: case GateOpcode::I: case GateOpcode::U:
+            return true;
+        default:
+            return false;
         }
     }
 
-    // Helper to determine if shot count distribution can be simulated by 
-    // sampling the final state vector.
-    // Requirements: no reset and measure at the very end and nothing after measure.
-    bool shotCountFromFinalStateVec(const std::shared_ptr<CompositeInstruction>& in_composite)
+    // Greedy gate fusion: consecutive unitary gates are merged into a
+    // single dense matrix as long as they act on at most 'maxWidth' qubits,
+    // so that the state vector is swept once per fused block.
+    // Any other instruction (Measure, Reset, IfStmt, etc.) flushes the pending block
+    // and is then visited as usual.
+    class FusedGateApplicator
     {
-        InstructionIterator it(in_composite);
-        bool measureAtTheEnd = true;
-        bool measureEncountered = false;
-        bool hasReset = false;
-        while (it.hasNext())
+    public:
+        FusedGateApplicator(std::shared_ptr<QppVisitor> in_visitor, int in_maxWidth):
+            m_visitor(std::move(in_visitor)),
+            m_maxWidth(in_maxWidth)
+        {}
+
+        // The instruction must outlive the next flush().
+        void apply(xacc::Instruction* in_inst)
         {
-            auto nextInst = it.next();
-            if (nextInst->isEnabled())
+            if (m_maxWidth < 2 || !isFusibleGate(in_inst))
             {
-                if (nextInst->name() == "Reset") {
-                    hasReset = true;
-                }
-
-                if (isMeasureGate(nextInst))
-                {
-                    // Flag that we have seen a Measure gate.
-                    measureEncountered = true;
-                }
+                flush();
+                in_inst->accept(m_visitor);
+                return;
+            }
 
-                // We have seen a Measure gate but this one is not another Measure gate.
-                if (measureEncountered && !isMeasureGate(nextInst))
+            std::vector<size_t> newBits;
+            for (const auto& bit : in_inst->bits())
+            {
+                if (std::find(m_bits.begin(), m_bits.end(), bit) == m_bits.end())
                 {
-                    measureAtTheEnd = false;
+                    newBits.emplace_back(bit);
                 }
             }
+            if (m_bits.size() + newBits.size() > m_maxWidth)
+            {
+                flush();
+                newBits = in_inst->bits();
+            }
+            m_bits.insert(m_bits.end(), newBits.begin(), newBits.end());
+            m_pending.emplace_back(in_inst);
         }
 
-        // If Measure gates are at the very end and no reset,
-        // this Composite can be simulated by random sampling from the state vec.
-        return !hasReset && measureAtTheEnd;
-    }
-
-    Eigen::MatrixXcd convertToEigenMat(const NoiseModelUtils::cMat& in_stdMat)
-    {
-        Eigen::MatrixXcd result =  Eigen::MatrixXcd::Zero(in_stdMat.size(), in_stdMat.size());
-        for (size_t row = 0; row < in_stdMat.size(); ++row)
+        void apply(const xacc::InstPtr& in_inst)
         {
-            for (size_t col = 0; col < in_stdMat.size(); ++col)
-            {
-                result(row, col) = in_stdMat[row][col];
-            }
+            apply(in_inst.get());
         }
-        return result;
-    }
 
-    NoiseModelUtils::cMat convertToStdMat(const Eigen::MatrixXcd& in_eigenMat)
-    {
-        const size_t dim = in_eigenMat.rows();
-        NoiseModelUtils::cMat result;
-        for (size_t row = 0; row < dim; ++row)
+        // Apply the pending block (if any)
+        void flush()
         {
-            std::vector<std::complex<double>> rowVec;
-            for (size_t col = 0; col < dim; ++col)
+            if (m_pending.size() == 1)
             {
-                rowVec.emplace_back(in_eigenMat(row, col)); 
+                m_pending[0]->accept(m_visitor);
             }
-            result.emplace_back(rowVec);
+            else if (!m_pending.empty())
+            {
+                // Map the block onto qubits [0, width) to compute its matrix.
+                auto block = std::make_shared<xacc::quantum::Circuit>("fused_block");
+                for (const auto& inst : m_pending)
+                {
+                    std::vector<size_t> localBits;
+                    for (const auto& bit : inst->bits())
+                    {
+                        localBits.emplace_back(std::distance(m_bits.begin(), std::find(m_bits.begin(), m_bits.end(), bit)));
+                    }
+                    auto localInst = inst->clone();
+                    localInst->setBits(localBits);
+                    block->addInstruction(localInst);
+                }
+                GateFuser fuser;
+                fuser.initialize(block);
+                m_visitor->applyFusedGate(fuser.calcFusedGate(m_bits.size()), m_bits);
+            }
+            m_pending.clear();
+            m_bits.clear();
         }
-        return result;
-    }
+
+    private:
+        std::shared_ptr<QppVisitor> m_visitor;
+        size_t m_maxWidth;
+        std::vector<xacc::Instruction*> m_pending;
+        std::vector<size_t> m_bits;
+    };
 }
 
 namespace xacc {
 namespace quantum {
 
+    std::shared_ptr<Accelerator> QppAccelerator::clone()
+    {
+        auto accelerator = std::make_shared<QppAccelerator>();
+        accelerator->m_memoryLimit = m_memoryLimit;
+        accelerator->initialize();
+        return accelerator;
+    }
+
     void QppAccelerator::initialize(const HeterogeneousMap& params)
     {
+        m_config = params;
         m_visitor = std::make_shared<QppVisitor>();
         // Default: no shots (unless otherwise specified)
         m_shots = -1;
@@ -237,33 +240,512 @@ namespace quantum {
             }
         }
 
+        // Reuse the state after the gates an ansatz shares with the previous
+        // computeExpectations() one, e.g. the frozen layers of an ADAPT step.
+        m_prefixCache = true;
+        if (params.keyExists<bool>("prefix-cache"))
+        {
+            m_prefixCache = params.get<bool>("prefix-cache");
+        }
+        m_prefixGates.clear();
+        m_prefixLength = 0;
+        m_prefixState = KetVectorType();
+
+        // Simulate independent circuits of a batch concurrently
+        // (only applies when not in VQE mode).
+        m_parallelBatch = false;
+        if (params.keyExists<bool>("parallel-batch"))
+        {
+            m_parallelBatch = params.get<bool>("parallel-batch");
+        }
+
+        // Gate fusion: merge runs of gates acting on up to 'fusion-max-width'
+        // qubits into a single dense unitary (0: disabled).
+        m_fusionMaxWidth = 0;
+        if (params.keyExists<int>("fusion-max-width"))
+        {
+            m_fusionMaxWidth = params.get<int>("fusion-max-width");
+            if (m_fusionMaxWidth != 0 && (m_fusionMaxWidth < 2 || m_fusionMaxWidth > 5))
+            {
+                xacc::error("Invalid 'fusion-max-width' parameter: must be in the range [2, 5] (or 0 to disable).");
+            }
+        }
+
+        // The qpp state vector, density matrix and fused gate blocks are
+        // Eigen complex<double> types: single precision is not available.
+        if (params.stringExists("precision") && params.getString("precision") != "double")
+        {
+            xacc::warning("qpp only supports double precision simulation. Ignoring 'precision: " + params.getString("precision") + "'.");
+        }
+
+        // Noise model: a NoiseModel (e.g. the "IBM" one initialized for a
+        // backend) or the JSON of the "json" noise model (or its file name).
+        m_noiseModel.reset();
+        if (params.pointerLikeExists<NoiseModel>("noise-model"))
+        {
+            m_noiseModel = xacc::as_shared_ptr(params.getPointerLike<NoiseModel>("noise-model"));
+        }
+        else if (params.stringExists("noise-model"))
+        {
+            m_noiseModel = xacc::getService<NoiseModel>("json");
+            m_noiseModel->initialize({{"noise-model", params.getString("noise-model")}});
+        }
+        // Exact (density matrix) simulation of the noise rather than trajectories
+        m_densityMatrix = false;
+        m_pagedStateVector = false;
+        if (params.stringExists("sim-type"))
+        {
+            const auto simType = params.getString("sim-type");
+            if (simType != "statevector" && simType != "density_matrix" && simType != "paged_statevector")
+            {
+                xacc::error("Invalid 'sim-type' parameter '" + simType + "': must be statevector, density_matrix or paged_statevector.");
+            }
+            m_densityMatrix = (simType == "density_matrix");
+            m_pagedStateVector = (simType == "paged_statevector");
+        }
+        if (m_pagedStateVector && m_noiseModel)
+        {
+            xacc::error("Noisy simulation is not supported in paged_statevector mode.");
+        }
+        // Out-of-core state vectors: the directory of their (temporary)
+        // files, and the number of qubits of their memory chunks.
+        m_pagingDir.clear();
+        if (params.stringExists("paging-dir"))
+        {
+            m_pagingDir = params.getString("paging-dir");
+        }
+        m_pagingChunkQubits = 24;
+        if (params.keyExists<int>("paging-chunk-qubits"))
+        {
+            m_pagingChunkQubits = params.get<int>("paging-chunk-qubits");
+            if (m_pagingChunkQubits < 1)
+            {
+                xacc::error("Invalid 'paging-chunk-qubits' parameter: must be positive.");
+            }
+        }
+        // Initial state of the circuits, from a .npy state vector file (e.g.
+        // written by exportState()): loaded in memory, or chunk by chunk into
+        // the paged state vector.
+        m_initialStateFile.clear();
+        if (params.stringExists("initial-state-file"))
+        {
+            m_initialStateFile = params.getString("initial-state-file");
+            if (m_densityMatrix)
+            {
+                xacc::error("'initial-state-file' is not supported in density_matrix mode.");
+            }
+            StateVectorReader file(m_initialStateFile);
+            if (!usePaging(file.nbQubits()))
+            {
+                auto initialState = std::make_shared<KetVectorType>(file.size());
+                file.read(0, file.size(), initialState->data());
+                m_visitor->setInitialState(std::move(initialState));
+            }
+        }
+        if (m_noiseModel && !m_densityMatrix && m_shots < 1)
+        {
+            xacc::error("Noisy simulation requires the 'shots' parameter.");
+        }
+
+        // Shots of Clifford-only circuits are simulated on a stabilizer
+        // tableau instead (unless "clifford-dispatch" is false).
+        m_cliffordDispatch = true;
+        if (params.keyExists<bool>("clifford-dispatch"))
+        {
+            m_cliffordDispatch = params.get<bool>("clifford-dispatch");
+        }
+        m_stabilizer.reset();
+        if (m_cliffordDispatch && m_shots > 0 && m_initialStateFile.empty())
+        {
+            m_stabilizer = std::make_shared<StabilizerAccelerator>();
+            m_stabilizer->initialize({{"shots", m_shots}});
+        }
+
         if (params.keyExists<std::vector<std::pair<int,int>>>("connectivity")) {
             m_connectivity = params.get<std::vector<std::pair<int,int>>>("connectivity");
         }
     }
 
     void QppAccelerator::execute(std::shared_ptr<AcceleratorBuffer> buffer, const std::shared_ptr<CompositeInstruction> compositeInstruction)
+    {
+        ScopedExecutionMetrics metrics(*this, 1, m_shots);
+        const size_t nbQubits = buffer->size();
+        m_pagedState.reset();
+        if (m_densityMatrix)
+        {
+            metrics.metrics().peakMemoryBytes = stateBytes(nbQubits);
+            executeDensityMatrix(buffer, compositeInstruction);
+            return;
+        }
+        if (m_noiseModel)
+        {
+            // The trajectories in flight and the reference state
+            metrics.metrics().peakMemoryBytes = stateBytes(nbQubits, std::min<size_t>(std::max(m_shots, 1), maxStatesInFlight(nbQubits)) + 1);
+            executeNoisyTrajectories(buffer, compositeInstruction);
+            return;
+        }
+        if (usePaging(nbQubits))
+        {
+            // One chunk per thread is paged in at a time.
+            m_executionInfo = {};
+            metrics.metrics().peakMemoryBytes = stateBytes(std::min<size_t>(nbQubits, m_pagingChunkQubits), xacc::getTaskScheduler()->getNumberOfThreads());
+            executePaged(buffer, compositeInstruction);
+            return;
+        }
+        if (m_stabilizer && StabilizerAccelerator::isCliffordCircuit(compositeInstruction))
+        {
+            // No state vector to cache
+            m_executionInfo = {};
+            // The 2n x (2n + 1) bit tableau
+            metrics.metrics().peakMemoryBytes = 2.0 * nbQubits * (2 * nbQubits + 1) / 8;
+            m_stabilizer->execute(buffer, compositeInstruction);
+            return;
+        }
+        metrics.metrics().peakMemoryBytes = stateBytes(nbQubits);
+        executeCircuit(m_visitor, buffer, compositeInstruction, true);
+    }
+
+    void QppAccelerator::executeDensityMatrix(std::shared_ptr<AcceleratorBuffer> buffer, const std::shared_ptr<CompositeInstruction> compositeInstruction)
+    {
+        const size_t nbQubits = buffer->size();
+        if (m_memoryLimit > 0 && (nbQubits >= 30 || sizeof(std::complex<double>) * (1ULL << (2 * nbQubits)) > m_memoryLimit))
+        {
+            xacc::error("The density matrix of " + std::to_string(nbQubits) + " qubits exceeds the memory limit.");
+        }
+
+        // Gates, their noise channels, and mid-circuit measurements and
+        // resets (non-selective) are all superoperators, fused into blocks
+        // of up to 'fusion-max-width' (default 2, at most 3) qubits.
+        const size_t fusionWidth = m_fusionMaxWidth > 0 ? std::min<size_t>(m_fusionMaxWidth, DensityMatrix::MAX_SUPEROP_QUBITS) : 2;
+        SuperOpCircuit circuit(fusionWidth);
+        const bool terminalMeasures = canSampleFromFinalState(compositeInstruction);
+        std::vector<size_t> measureBitIdxs;
+        for (auto* nextInst : compositeInstruction->flatView())
+        {
+            if (!nextInst->isEnabled() || nextInst->isComposite())
+            {
+                if (nextInst->name() == "ifstmt")
+                {
+                    xacc::error("Conditional execution is not supported in density_matrix mode.");
+                }
+                continue;
+            }
+            const auto bits = nextInst->bits();
+            if (isMeasureGate(nextInst) || nextInst->opcode() == xacc::GateOpcode::Reset)
+            {
+                Eigen::MatrixXcd proj0 = Eigen::MatrixXcd::Zero(2, 2), proj1 = Eigen::MatrixXcd::Zero(2, 2);
+                proj0(0, 0) = 1.0;
+                if (isMeasureGate(nextInst))
+                {
+                    measureBitIdxs.emplace_back(bits[0]);
+                    if (terminalMeasures)
+                    {
+                        continue;
+                    }
+                    proj1(1, 1) = 1.0;
+                }
+                else
+                {
+                    // |0><1|
+                    proj1(0, 1) = 1.0;
+                }
+                circuit.add(DensityMatrix::krausToSuperOp({ proj0, proj1 }), bits);
+                continue;
+            }
+            if (!isFusibleGate(nextInst))
+            {
+                xacc::error("Gate " + nextInst->name() + " is not supported in density_matrix mode.");
+            }
+            // Gate matrix on qubits [0, k)
+            auto block = std::make_shared<xacc::quantum::Circuit>("dm_gate");
+            auto localInst = nextInst->clone();
+            std::vector<size_t> localBits(bits.size());
+            std::iota(localBits.begin(), localBits.end(), 0);
+            localInst->setBits(localBits);
+            block->addInstruction(localInst);
+            GateFuser fuser;
+            fuser.initialize(block);
+            circuit.add(DensityMatrix::krausToSuperOp({ fuser.calcFusedGate(bits.size()) }), bits);
+
+            auto* gate = dynamic_cast<xacc::quantum::Gate*>(nextInst);
+            if (m_noiseModel && gate)
+            {
+                for (const auto& channel : m_noiseModel->getNoiseChannels(*gate))
+                {
+                    std::vector<Eigen::MatrixXcd> krausMats;
+                    for (const auto& mat : channel.mats)
+                    {
+                        krausMats.emplace_back(convertToEigenMat(mat));
+                    }
+                    circuit.add(DensityMatrix::krausToSuperOp(krausMats), noiseChannelBits(channel, nbQubits));
+                }
+            }
+        }
+
+        DensityMatrix densityMatrix(nbQubits);
+        circuit.apply(densityMatrix);
+
+        // Same results as the Aer density_matrix mode
+        std::vector<std::pair<double, double>> flattenDm;
+        flattenDm.reserve(densityMatrix.data().size());
+        for (const auto& elem : densityMatrix.data())
+        {
+            flattenDm.emplace_back(elem.real(), elem.imag());
+        }
+        buffer->addExtraInfo("density_matrix", flattenDm);
+        if (measureBitIdxs.empty())
+        {
+            return;
+        }
+        buffer->addExtraInfo("exp-val-z", densityMatrix.expectationValueZ(measureBitIdxs));
+
+        if (m_shots > 0)
+        {
+            // Sampled from the diagonal, then readout errors
+            struct DiagonalAmplitudes
+            {
+                const DensityMatrix& dm;
+                uint64_t size() const { return 1ULL << dm.nbQubits(); }
+                std::complex<double> operator[](uint64_t i) const { return std::sqrt(std::max(0.0, dm.probability(i))); }
+            };
+            std::vector<RoErrors> roErrors;
+            for (const auto bit : measureBitIdxs)
+            {
+                roErrors.emplace_back(m_noiseModel ? m_noiseModel->readoutError(bit) : RoErrors{ 0.0, 0.0 });
+            }
+            std::mt19937_64 rng(std::random_device{}());
+            for (const auto& [outcome, count] : MeasurementSampler(DiagonalAmplitudes{ densityMatrix }, measureBitIdxs).sample(m_shots, rng))
+            {
+                for (int i = 0; i < count; ++i)
+                {
+                    buffer->appendMeasurement(toNoisyBitString(outcome, roErrors, rng));
+                }
+            }
+        }
+    }
+
+    bool QppAccelerator::usePaging(size_t nbQubits) const
+    {
+        if (m_pagedStateVector)
+        {
+            return true;
+        }
+        return !m_pagingDir.empty() && m_memoryLimit > 0 && !m_noiseModel && !m_densityMatrix && stateBytes(nbQubits) > m_memoryLimit;
+    }
+
+    void QppAccelerator::executePaged(std::shared_ptr<AcceleratorBuffer> buffer, const std::shared_ptr<CompositeInstruction> compositeInstruction)
+    {
+        // The state is only read back to measure it: no collapse mid-circuit.
+        if (!canSampleFromFinalState(compositeInstruction))
+        {
+            xacc::error("Mid-circuit measurements, resets and conditional execution are not supported in paged_statevector mode.");
+        }
+        const size_t nbQubits = buffer->size();
+        std::vector<PagedStateVector::Gate> gates;
+        std::vector<size_t> measureBitIdxs;
+        for (auto* nextInst : compositeInstruction->flatView())
+        {
+            if (!nextInst->isEnabled() || nextInst->isComposite())
+            {
+                continue;
+            }
+            const auto bits = nextInst->bits();
+            if (isMeasureGate(nextInst))
+            {
+                measureBitIdxs.emplace_back(bits[0]);
+                continue;
+            }
+            if (!isFusibleGate(nextInst))
+            {
+                xacc::error("Gate " + nextInst->name() + " is not supported in paged_statevector mode.");
+            }
+            // Gate matrix on qubits [0, k)
+            auto block = std::make_shared<xacc::quantum::Circuit>("paged_gate");
+            auto localInst = nextInst->clone();
+            std::vector<size_t> localBits(bits.size());
+            std::iota(localBits.begin(), localBits.end(), 0);
+            localInst->setBits(localBits);
+            block->addInstruction(localInst);
+            GateFuser fuser;
+            fuser.initialize(block);
+            gates.emplace_back(PagedStateVector::Gate{ bits, fuser.calcFusedGate(bits.size()) });
+        }
+
+        const char* tmpDir = std::getenv("TMPDIR");
+        const std::string pagingDir = !m_pagingDir.empty() ? m_pagingDir : (tmpDir ? tmpDir : "/tmp");
+        // Kept (mapped) until the next execution, for exportState()
+        m_pagedState = std::make_shared<PagedStateVector>(nbQubits, m_pagingChunkQubits, pagingDir);
+        auto& state = *m_pagedState;
+        if (!m_initialStateFile.empty())
+        {
+            state.load(StateVectorReader(m_initialStateFile));
+        }
+        state.apply(gates);
+        if (measureBitIdxs.empty())
+        {
+            return;
+        }
+        if (m_shots < 0)
+        {
+            buffer->addExtraInfo("exp-val-z", state.expectationValueZ(measureBitIdxs));
+            return;
+        }
+        std::mt19937_64 rng(std::random_device{}());
+        for (const auto& [outcome, count] : state.sample(measureBitIdxs, m_shots, rng))
+        {
+            // Bit j is the j-th measured qubit
+            std::string bitString;
+            for (size_t j = 0; j < measureBitIdxs.size(); ++j)
+            {
+                bitString.push_back((outcome >> j) & 1ULL ? '1' : '0');
+            }
+            buffer->appendMeasurement(bitString, count);
+        }
+    }
+
+    void QppAccelerator::executeNoisyTrajectories(std::shared_ptr<AcceleratorBuffer> buffer, const std::shared_ptr<CompositeInstruction> compositeInstruction)
+    {
+        struct TrajectoryChannel
+        {
+            // LSB first
+            std::vector<size_t> bits;
+            std::vector<qpp::cmat> krausMats;
+        };
+        struct TrajectoryInstruction
+        {
+            xacc::Instruction* inst;
+            std::vector<TrajectoryChannel> channels;
+        };
+
+        // The noise channels of each gate are looked up once, not per trajectory.
+        const bool sampleFinalState = canSampleFromFinalState(compositeInstruction);
+        std::vector<TrajectoryInstruction> program;
+        std::vector<size_t> measureBitIdxs;
+        for (auto* nextInst : compositeInstruction->flatView())
+        {
+            if (sampleFinalState && isMeasureGate(nextInst))
+            {
+                if (nextInst->isEnabled())
+                {
+                    measureBitIdxs.emplace_back(nextInst->bits()[0]);
+                }
+                continue;
+            }
+            TrajectoryInstruction trajectoryInst{ nextInst, {} };
+            auto* gate = dynamic_cast<xacc::quantum::Gate*>(nextInst);
+            if (gate && !isMeasureGate(nextInst))
+            {
+                for (const auto& channel : m_noiseModel->getNoiseChannels(*gate))
+                {
+                    TrajectoryChannel trajectoryChannel;
+                    trajectoryChannel.bits = noiseChannelBits(channel, buffer->size());
+                    for (const auto& mat : channel.mats)
+                    {
+                        trajectoryChannel.krausMats.emplace_back(convertToEigenMat(mat));
+                    }
+                    trajectoryInst.channels.emplace_back(std::move(trajectoryChannel));
+                }
+            }
+            program.emplace_back(std::move(trajectoryInst));
+        }
+
+        const auto runTrajectory = [&](std::shared_ptr<QppVisitor> visitor, std::mt19937_64& rng) {
+            std::uniform_real_distribution<double> dist(0.0, 1.0);
+            for (auto& trajectoryInst : program)
+            {
+                if (!trajectoryInst.inst->isEnabled())
+                {
+                    continue;
+                }
+                trajectoryInst.inst->accept(visitor);
+                for (const auto& channel : trajectoryInst.channels)
+                {
+                    visitor->applyKrausChannel(channel.krausMats, channel.bits, dist(rng));
+                }
+            }
+        };
+
+        if (!sampleFinalState)
+        {
+            // Mid-circuit measurements draw from the qpp global random
+            // engine, which is not thread-safe: trajectories run serially
+            // and the visitor records each shot (without readout errors).
+            std::mt19937_64 rng(std::random_device{}());
+            for (int i = 0; i < m_shots; ++i)
+            {
+                m_visitor->initialize(buffer, true);
+                runTrajectory(m_visitor, rng);
+                m_visitor->finalize();
+            }
+            return;
+        }
+
+        // Readout error (meas0Prep1, meas1Prep0) of each measured bit
+        std::vector<RoErrors> roErrors;
+        for (const auto bit : measureBitIdxs)
+        {
+            roErrors.emplace_back(m_noiseModel->readoutError(bit));
+        }
+
+        // Shots are split in as many chunks as state vectors fit in memory,
+        // each chunk on its own visitor and random engine.
+        const size_t nbChunks = std::min<size_t>(m_shots, maxStatesInFlight(buffer->size()));
+        const uint64_t seed = std::random_device{}();
+        std::vector<std::map<std::string, int>> chunkCounts(nbChunks);
+        xacc::getTaskScheduler()->parallelFor(0, nbChunks, [&](size_t beginIdx, size_t endIdx) {
+            auto visitor = m_visitor->clone();
+            for (size_t chunk = beginIdx; chunk < endIdx; ++chunk)
+            {
+                std::mt19937_64 rng(seed + chunk);
+                const int chunkShots = m_shots / nbChunks + (chunk < m_shots % nbChunks ? 1 : 0);
+                for (int shot = 0; shot < chunkShots; ++shot)
+                {
+                    visitor->initialize(buffer);
+                    runTrajectory(visitor, rng);
+                    const auto outcome = MeasurementSampler(visitor->getStateVec(), measureBitIdxs).sample(1, rng).begin()->first;
+                    visitor->finalize();
+                    const auto bitString = toNoisyBitString(outcome, roErrors, rng);
+                    chunkCounts[chunk][bitString]++;
+                }
+            }
+        });
+
+        std::map<std::string, int> counts;
+        for (const auto& chunk : chunkCounts)
+        {
+            for (const auto& [bitString, count] : chunk)
+            {
+                counts[bitString] += count;
+            }
+        }
+        for (const auto& [bitString, count] : counts)
+        {
+            buffer->appendMeasurement(bitString, count);
+        }
+    }
+
+    void QppAccelerator::executeCircuit(std::shared_ptr<QppVisitor> visitor, std::shared_ptr<AcceleratorBuffer> buffer, const std::shared_ptr<CompositeInstruction> compositeInstruction, bool cacheInfo)
     {
         const auto runCircuit = [&](bool shotsMode){
-            m_visitor->initialize(buffer, shotsMode);
+            visitor->initialize(buffer, shotsMode);
+            FusedGateApplicator applicator(visitor, m_fusionMaxWidth);
 
             // Walk the IR tree, and visit each node
-            InstructionIterator it(compositeInstruction);
-            while (it.hasNext())
+            for (auto* nextInst : compositeInstruction->flatView())
             {
-                auto nextInst = it.next();
                 if (nextInst->isEnabled())
                 {
-                    nextInst->accept(m_visitor);
+                    applicator.apply(nextInst);
                 }
             }
+            applicator.flush();
 
-            m_visitor->finalize();
+            visitor->finalize();
         };
 
         // Not possible to simulate shot count by direct sampling,
         // e.g. must collapse the state vector.
-        if(!shotCountFromFinalStateVec(compositeInstruction))
+        if(!canSampleFromFinalState(compositeInstruction))
         {
             if (m_shots < 0)
             {
@@ -271,27 +753,23 @@ namespace quantum {
             }
             else
             {
-                for (int i = 0; i < m_shots; ++i)
-                {
-                    runCircuit(true);
-                }
+                executeBranchTree(visitor, buffer, compositeInstruction);
             }
         }
         else
         {
             // Index of measure bits
             std::vector<size_t> measureBitIdxs;
-            m_visitor->initialize(buffer);
+            visitor->initialize(buffer);
+            FusedGateApplicator applicator(visitor, m_fusionMaxWidth);
             // Walk the IR tree, and visit each node
-            InstructionIterator it(compositeInstruction);
-            while (it.hasNext())
+            for (auto* nextInst : compositeInstruction->flatView())
             {
-                auto nextInst = it.next();
                 if (nextInst->isEnabled())
                 {
                     if (!isMeasureGate(nextInst))
                     {
-                        nextInst->accept(m_visitor);
+                        applicator.apply(nextInst);
                     }
                     else
                     {
@@ -300,32 +778,197 @@ namespace quantum {
                     }
                 }
             }
+            applicator.flush();
             
             // Run bit-string simulation
-            if (!measureBitIdxs.empty())
+            measureFinalState(*visitor, buffer, measureBitIdxs);
+            // Note: must save the state-vector before finalizing the visitor.
+            if (cacheInfo)
+            {
+                cacheExecutionInfo(*visitor);
+            }
+            visitor->finalize();
+        }
+    }
+    
+    void QppAccelerator::executeBranchTree(std::shared_ptr<QppVisitor> visitor, std::shared_ptr<AcceleratorBuffer> buffer, const std::shared_ptr<CompositeInstruction> compositeInstruction)
+    {
+        if (m_shots <= 0)
+        {
+            return;
+        }
+        const auto flatView = compositeInstruction->flatView();
+        const std::vector<xacc::Instruction*> program(flatView.begin(), flatView.end());
+        const auto isCollapse = [](xacc::Instruction* in_inst) {
+            return isMeasureGate(in_inst) || in_inst->opcode() == xacc::GateOpcode::Reset;
+        };
+
+        // A pending branch: its shots share the (instruction index, outcome)
+        // results of the measurements and resets before 'next'. Its state
+        // (before the last collapse) is saved within the memory budget
+        // (defaults to 1GB), otherwise replayed from the outcomes.
+        struct Branch
+        {
+            size_t next;
+            int shots;
+            std::vector<std::pair<size_t, bool>> outcomes;
+            KetVectorType state;
+        };
+        const uint64_t budget = m_memoryLimit > 0 ? m_memoryLimit : (1ULL << 30);
+        const size_t maxSavedStates = buffer->size() >= 48 ? 0 : budget / (sizeof(std::complex<double>) * (1ULL << buffer->size()));
+        size_t nbSavedStates = 0;
+        std::mt19937_64 rng(std::random_device{}());
+
+        // in_prob1: probability of outcome 1
+        const auto collapse = [&](size_t in_idx, bool in_value, double in_prob1) {
+            auto* inst = program[in_idx];
+            const auto bit = inst->bits()[0];
+            visitor->collapse(bit, in_value, in_value ? in_prob1 : 1.0 - in_prob1);
+            if (auto* measure = dynamic_cast<Measure*>(inst))
+            {
+                visitor->recordMeasurement(*measure, in_value);
+            }
+            else if (in_value)
+            {
+                X flip(bit);
+                visitor->applyGate(flip);
+            }
+        };
+        // The state of a branch, from its saved state or replayed
+        const auto restore = [&](Branch& io_branch) {
+            if (io_branch.state.size() > 0)
             {
-                const auto& stateVec = m_visitor->getStateVec();
-                if (m_shots < 0)
+                visitor->setStateVec(io_branch.state);
+                io_branch.state.resize(0);
+                --nbSavedStates;
+                // The classical registers of the path, for the conditionals
+                for (size_t k = 0; k + 1 < io_branch.outcomes.size(); ++k)
                 {
-                    const double expectedValueZ = QppVisitor::calcExpectationValueZ(stateVec, measureBitIdxs);
-                    buffer->addExtraInfo("exp-val-z", expectedValueZ);
+                    if (auto* measure = dynamic_cast<Measure*>(program[io_branch.outcomes[k].first]))
+                    {
+                        visitor->recordMeasurement(*measure, io_branch.outcomes[k].second);
+                    }
                 }
-                else
+                const auto [idx, value] = io_branch.outcomes.back();
+                collapse(idx, value, visitor->probabilityOne(program[idx]->bits()[0]));
+                return;
+            }
+            visitor->initialize(buffer);
+            FusedGateApplicator applicator(visitor, m_fusionMaxWidth);
+            auto outcome = io_branch.outcomes.begin();
+            for (size_t i = 0; i < io_branch.next; ++i)
+            {
+                if (!program[i]->isEnabled())
+                {
+                    continue;
+                }
+                if (!isCollapse(program[i]))
                 {
-                    // Try multi-threaded execution if there are many shots.
-                    const bool multiThreadEnabled = (m_shots > 1024);
-                    generateMeasureBitString(buffer, measureBitIdxs, stateVec, m_shots, multiThreadEnabled);
+                    applicator.apply(program[i]);
+                    continue;
                 }
+                applicator.flush();
+                assert(outcome != io_branch.outcomes.end() && outcome->first == i);
+                collapse(i, outcome->second, visitor->probabilityOne(program[i]->bits()[0]));
+                ++outcome;
             }
-            // Note: must save the state-vector before finalizing the visitor.
-            cacheExecutionInfo();
-            m_visitor->finalize();
+            applicator.flush();
+        };
+
+        std::map<std::string, int> counts;
+        std::vector<Branch> pending;
+        pending.emplace_back(Branch{ 0, m_shots, {}, {} });
+        visitor->initialize(buffer);
+        while (!pending.empty())
+        {
+            auto branch = std::move(pending.back());
+            pending.pop_back();
+            if (branch.next > 0)
+            {
+                restore(branch);
+            }
+
+            FusedGateApplicator applicator(visitor, m_fusionMaxWidth);
+            for (size_t i = branch.next; i < program.size(); ++i)
+            {
+                auto* inst = program[i];
+                if (!inst->isEnabled())
+                {
+                    continue;
+                }
+                if (!isCollapse(inst))
+                {
+                    applicator.apply(inst);
+                    continue;
+                }
+                applicator.flush();
+                const double prob1 = visitor->probabilityOne(inst->bits()[0]);
+                const int shots1 = prob1 <= 0.0 ? 0 : (prob1 >= 1.0 ? branch.shots : std::binomial_distribution<int>(branch.shots, prob1)(rng));
+                const int shots0 = branch.shots - shots1;
+                if (shots0 > 0 && shots1 > 0)
+                {
+                    // Outcome 1 is deferred, this branch goes on with 0.
+                    Branch deferred{ i + 1, shots1, branch.outcomes, {} };
+                    deferred.outcomes.emplace_back(i, true);
+                    if (nbSavedStates < maxSavedStates)
+                    {
+                        deferred.state = visitor->getStateVec();
+                        ++nbSavedStates;
+                    }
+                    pending.emplace_back(std::move(deferred));
+                }
+                const bool value = shots0 == 0;
+                branch.shots = value ? shots1 : shots0;
+                branch.outcomes.emplace_back(i, value);
+                collapse(i, value, prob1);
+            }
+            applicator.flush();
+
+            // Measurement results in circuit order
+            std::string bitString;
+            for (const auto& [idx, value] : branch.outcomes)
+            {
+                if (isMeasureGate(program[idx]))
+                {
+                    bitString.push_back(value ? '1' : '0');
+                }
+            }
+            counts[bitString] += branch.shots;
+        }
+        visitor->finalize();
+
+        for (const auto& [bitString, count] : counts)
+        {
+            buffer->appendMeasurement(bitString, count);
         }
     }
-    
+
+    void QppAccelerator::measureFinalState(const QppVisitor& visitor, std::shared_ptr<AcceleratorBuffer> buffer, const std::vector<size_t>& measureBitIdxs)
+    {
+        if (!measureBitIdxs.empty())
+        {
+            const auto& stateVec = visitor.getStateVec();
+            if (m_shots < 0)
+            {
+                const double expectedValueZ = QppVisitor::calcExpectationValueZ(stateVec, measureBitIdxs);
+                buffer->addExtraInfo("exp-val-z", expectedValueZ);
+            }
+            else
+            {
+                MeasurementSampler(stateVec, measureBitIdxs).appendMeasurements(buffer, m_shots);
+            }
+        }
+    }
+
     void QppAccelerator::execute(std::shared_ptr<AcceleratorBuffer> buffer, const std::vector<std::shared_ptr<CompositeInstruction>> compositeInstructions)
     {
-        if (!m_vqeMode || compositeInstructions.size() <= 1) 
+        ScopedExecutionMetrics metrics(*this, compositeInstructions.size(), m_shots);
+        metrics.metrics().peakMemoryBytes = stateBytes(buffer->size());
+        if (isStateVectorSim() && !m_vqeMode && m_parallelBatch && compositeInstructions.size() > 1)
+        {
+            executeParallelBatch(buffer, compositeInstructions);
+        }
+        else if (!isStateVectorSim() || !m_vqeMode || compositeInstructions.size() <= 1) 
         {
             for (auto& f : compositeInstructions)
             {
@@ -344,16 +987,16 @@ namespace quantum {
             auto baseKernel = kernelDecomposed.getBase();
             // Basis-change + measures
             auto obsCircuits = kernelDecomposed.getObservedSubCircuits();
+            FusedGateApplicator applicator(m_visitor, m_fusionMaxWidth);
             // Walk the base IR tree, and visit each node
-            InstructionIterator it(baseKernel);
-            while (it.hasNext()) 
+            for (auto* nextInst : baseKernel->flatView())
             {
-                auto nextInst = it.next();
                 if (nextInst->isEnabled() && !nextInst->isComposite()) 
                 {
-                    nextInst->accept(m_visitor);
+                    applicator.apply(nextInst);
                 }
             }
+            applicator.flush();
 
             // Now we have a wavefunction that represents execution of the ansatz.
             // Run the observable sub-circuits (change of basis + measurements)
@@ -368,6 +1011,288 @@ namespace quantum {
         }
     }
 
+    void QppAccelerator::executeParallelBatch(std::shared_ptr<AcceleratorBuffer> buffer, const std::vector<std::shared_ptr<CompositeInstruction>>& compositeInstructions)
+    {
+        const size_t nbCircuits = compositeInstructions.size();
+        // Nested in that of execute(), for the peak memory
+        ScopedExecutionMetrics metrics(*this, nbCircuits, m_shots);
+        std::vector<std::shared_ptr<AcceleratorBuffer>> childBuffers(nbCircuits);
+        std::vector<size_t> parallelIdxs;
+        for (size_t i = 0; i < nbCircuits; ++i)
+        {
+            childBuffers[i] = std::make_shared<xacc::AcceleratorBuffer>(compositeInstructions[i]->name(), buffer->size());
+            // Mid-circuit measurements draw from the qpp global random
+            // engine, which is not thread-safe: run those serially below.
+            if (canSampleFromFinalState(compositeInstructions[i]))
+            {
+                // Build the (cached) flat view up front,
+                // the tasks only read it.
+                compositeInstructions[i]->flatView();
+                parallelIdxs.emplace_back(i);
+            }
+            else
+            {
+                executeCircuit(m_visitor, childBuffers[i], compositeInstructions[i], i == nbCircuits - 1);
+            }
+        }
+
+        auto scheduler = xacc::getTaskScheduler();
+        const size_t maxInFlight = maxStatesInFlight(buffer->size());
+        // The states in flight and that of m_visitor
+        metrics.metrics().peakMemoryBytes = stateBytes(buffer->size(), std::min(parallelIdxs.size(), maxInFlight) + 1);
+
+        for (size_t waveBegin = 0; waveBegin < parallelIdxs.size(); waveBegin += maxInFlight)
+        {
+            const size_t waveEnd = std::min(parallelIdxs.size(), waveBegin + maxInFlight);
+            scheduler->parallelFor(waveBegin, waveEnd, [&](size_t beginIdx, size_t endIdx) {
+                // Each task simulates on its own visitor (state vector).
+                auto visitor = m_visitor->clone();
+                for (size_t i = beginIdx; i < endIdx; ++i)
+                {
+                    const auto circuitIdx = parallelIdxs[i];
+                    executeCircuit(visitor, childBuffers[circuitIdx], compositeInstructions[circuitIdx], circuitIdx == nbCircuits - 1);
+                }
+            });
+        }
+
+        // Append in input order
+        for (size_t i = 0; i < nbCircuits; ++i)
+        {
+            buffer->appendChild(compositeInstructions[i]->name(), childBuffers[i]);
+        }
+    }
+
+    size_t QppAccelerator::maxStatesInFlight(size_t nbQubits) const
+    {
+        // Memory guard: each in-flight simulation holds its state vector plus
+        // a working copy (shot sampling, gate or Kraus operator application).
+        size_t maxInFlight = std::max(1, xacc::getTaskScheduler()->getNumberOfThreads());
+        if (m_memoryLimit > 0 && nbQubits >= 48)
+        {
+            maxInFlight = 1;
+        }
+        else if (m_memoryLimit > 0)
+        {
+            const uint64_t bytesPerState = 2 * sizeof(std::complex<double>) * (1ULL << nbQubits);
+            maxInFlight = std::max<uint64_t>(1, std::min<uint64_t>(maxInFlight, m_memoryLimit / bytesPerState));
+        }
+        return maxInFlight;
+    }
+
+    void QppAccelerator::executeWithPrefixSharing(std::shared_ptr<AcceleratorBuffer> buffer, const std::vector<std::shared_ptr<CompositeInstruction>> compositeInstructions)
+    {
+        ScopedExecutionMetrics metrics(*this, compositeInstructions.size(), m_shots);
+        // Checkpoint memory budget, defaults to 1GB.
+        const uint64_t budget = m_memoryLimit > 0 ? m_memoryLimit : (1ULL << 30);
+        const size_t maxCheckpoints = buffer->size() >= 48 ? 0 : budget / (sizeof(std::complex<double>) * (1ULL << buffer->size()));
+        if (compositeInstructions.size() <= 1 || maxCheckpoints == 0 || !isStateVectorSim())
+        {
+            execute(buffer, compositeInstructions);
+            return;
+        }
+
+        const auto batch = PrefixSharedBatch::fromComposites(compositeInstructions, maxCheckpoints);
+        const auto& checkpoints = batch.getCheckpoints();
+        metrics.metrics().peakMemoryBytes = stateBytes(buffer->size(), checkpoints.size() + 1);
+        // Simulate the shared prefix of the reference circuit once,
+        // saving the state at each checkpoint.
+        std::vector<KetVectorType> checkpointStates;
+        if (!checkpoints.empty())
+        {
+            const auto& reference = batch.getInstructions(0);
+            m_visitor->initialize(buffer);
+            FusedGateApplicator applicator(m_visitor, m_fusionMaxWidth);
+            size_t nbApplied = 0;
+            for (const auto& checkpoint : checkpoints)
+            {
+                for (; nbApplied < checkpoint; ++nbApplied)
+                {
+                    applicator.apply(reference[nbApplied]);
+                }
+                applicator.flush();
+                checkpointStates.emplace_back(m_visitor->getStateVec());
+            }
+            m_visitor->finalize();
+        }
+
+        for (size_t i = 0; i < compositeInstructions.size(); ++i)
+        {
+            const auto& composite = compositeInstructions[i];
+            auto tmpBuffer = std::make_shared<xacc::AcceleratorBuffer>(composite->name(), buffer->size());
+            const int startCheckpoint = batch.getStartCheckpoint(i);
+            if (startCheckpoint < 0 || !canSampleFromFinalState(composite))
+            {
+                // Nothing shared or needs mid-circuit measurements.
+                executeCircuit(m_visitor, tmpBuffer, composite, i == compositeInstructions.size() - 1);
+            }
+            else
+            {
+                const auto& instructions = batch.getInstructions(i);
+                std::vector<size_t> measureBitIdxs;
+                m_visitor->initialize(tmpBuffer);
+                m_visitor->setStateVec(checkpointStates[startCheckpoint]);
+                FusedGateApplicator applicator(m_visitor, m_fusionMaxWidth);
+                for (size_t idx = checkpoints[startCheckpoint]; idx < instructions.size(); ++idx)
+                {
+                    if (!isMeasureGate(instructions[idx]))
+                    {
+                        applicator.apply(instructions[idx]);
+                    }
+                    else
+                    {
+                        measureBitIdxs.emplace_back(instructions[idx]->bits()[0]);
+                    }
+                }
+                applicator.flush();
+                measureFinalState(*m_visitor, tmpBuffer, measureBitIdxs);
+                if (i == compositeInstructions.size() - 1)
+                {
+                    cacheExecutionInfo(*m_visitor);
+                }
+                m_visitor->finalize();
+            }
+            buffer->appendChild(composite->name(), tmpBuffer);
+        }
+    }
+
+    void QppAccelerator::computeExpectations(std::shared_ptr<AcceleratorBuffer> buffer, const std::shared_ptr<CompositeInstruction> ansatz, std::shared_ptr<Observable> observable)
+    {
+        ScopedExecutionMetrics metrics(*this, 1, m_shots);
+        metrics.metrics().peakMemoryBytes = stateBytes(buffer->size());
+        // The ansatz state can only be reused if it is a pure state preparation (and noiseless).
+        bool canReuseState = true;
+        InstructionIterator ansatzIt(ansatz);
+        while (ansatzIt.hasNext())
+        {
+            auto nextInst = ansatzIt.next();
+            if (nextInst->isEnabled() && (isMeasureGate(nextInst) || nextInst->opcode() == xacc::GateOpcode::Reset))
+            {
+                canReuseState = false;
+            }
+        }
+
+        // Observed kernels are the (cloned) ansatz followed by
+        // the basis change and measure instructions.
+        auto kernels = observable->observe(ansatz);
+        const size_t tailBegin = ansatz->nInstructions() > 0 ? 1 : 0;
+        for (auto& kernel : kernels)
+        {
+            if (tailBegin > 0 && (kernel->nInstructions() == 0 || !kernel->getInstruction(0)->isComposite()))
+            {
+                canReuseState = false;
+            }
+        }
+
+        if (!canReuseState || !isStateVectorSim())
+        {
+            Accelerator::computeExpectations(buffer, ansatz, observable);
+            return;
+        }
+
+        // Prepare the ansatz state once
+        std::vector<xacc::Instruction*> gates;
+        std::vector<GateSignature> signatures;
+        for (auto* nextInst : ansatz->flatView())
+        {
+            if (nextInst->isEnabled() && !nextInst->isComposite())
+            {
+                gates.emplace_back(nextInst);
+                signatures.emplace_back(nextInst->name(), nextInst->bits(), nextInst->getParameters());
+            }
+        }
+        // Number of leading gates in common with the previous ansatz
+        size_t sharedLength = 0;
+        while (sharedLength < std::min(signatures.size(), m_prefixGates.size()) && signatures[sharedLength] == m_prefixGates[sharedLength])
+        {
+            ++sharedLength;
+        }
+        const uint64_t stateBytes = buffer->size() >= 48 ? 0 : sizeof(std::complex<double>) * (1ULL << buffer->size());
+        const bool canCache = m_prefixCache && stateBytes > 0 && (m_memoryLimit == 0 || 2 * stateBytes <= m_memoryLimit);
+
+        m_visitor->initialize(buffer);
+        size_t startIdx = 0;
+        if (canCache && m_prefixLength > 0 && sharedLength >= m_prefixLength && m_prefixState.size() * sizeof(std::complex<double>) == stateBytes)
+        {
+            m_visitor->setStateVec(m_prefixState);
+            startIdx = m_prefixLength;
+        }
+        else
+        {
+            // Checkpoint at the first gate that differs from the previous ansatz
+            m_prefixLength = canCache ? sharedLength : 0;
+            m_prefixState = KetVectorType();
+        }
+        FusedGateApplicator applicator(m_visitor, m_fusionMaxWidth);
+        for (size_t i = startIdx; i <= gates.size(); ++i)
+        {
+            if (startIdx == 0 && i == m_prefixLength && m_prefixLength > 0)
+            {
+                applicator.flush();
+                m_prefixState = m_visitor->getStateVec();
+            }
+            if (i < gates.size())
+            {
+                applicator.apply(gates[i]);
+            }
+        }
+        applicator.flush();
+        m_prefixGates = std::move(signatures);
+        const KetVectorType ansatzState = m_visitor->getStateVec();
+        cacheExecutionInfo(*m_visitor);
+        m_visitor->finalize();
+
+        for (auto& kernel : kernels)
+        {
+            std::vector<InstPtr> tail;
+            std::vector<size_t> measureBitIdxs;
+            for (size_t i = tailBegin; i < kernel->nInstructions(); ++i)
+            {
+                auto inst = kernel->getInstruction(i);
+                if (!inst->isEnabled())
+                {
+                    continue;
+                }
+                if (isMeasureGate(inst))
+                {
+                    measureBitIdxs.emplace_back(inst->bits()[0]);
+                }
+                else
+                {
+                    tail.emplace_back(inst);
+                }
+            }
+            // Identity term: nothing to measure
+            if (measureBitIdxs.empty())
+            {
+                continue;
+            }
+
+            auto tmpBuffer = std::make_shared<xacc::AcceleratorBuffer>(kernel->name(), buffer->size());
+            m_visitor->initialize(tmpBuffer);
+            m_visitor->setStateVec(ansatzState);
+            for (auto& inst : tail)
+            {
+                inst->accept(m_visitor);
+            }
+            measureFinalState(*m_visitor, tmpBuffer, measureBitIdxs);
+            m_visitor->finalize();
+            buffer->appendChild(kernel->name(), tmpBuffer);
+        }
+    }
+
+    void QppAccelerator::computeExpectations(const std::vector<std::shared_ptr<AcceleratorBuffer>>& buffers, const std::vector<std::shared_ptr<CompositeInstruction>>& ansatzes, std::shared_ptr<Observable> observable)
+    {
+        ScopedExecutionMetrics metrics(*this, ansatzes.size(), m_shots);
+        if (buffers.size() != ansatzes.size())
+        {
+            xacc::error("computeExpectations: expected one buffer per ansatz.");
+        }
+        for (size_t i = 0; i < ansatzes.size(); ++i)
+        {
+            computeExpectations(buffers[i], ansatzes[i], observable);
+        }
+    }
+
     void QppAccelerator::apply(std::shared_ptr<AcceleratorBuffer> buffer, std::shared_ptr<Instruction> inst) 
     {
         if (!m_visitor->isInitialized()) {
@@ -392,7 +1317,7 @@ namespace quantum {
         {
             xacc::error("Only gates are allowed.");
         }
-        if (inst->name() == "Measure")
+        if (isMeasureGate(inst))
         {
             const auto measRes = m_visitor->measure(inst->bits()[0]);
             buffer->measure(inst->bits()[0], (measRes ? 1 : 0));
@@ -405,11 +1330,37 @@ namespace quantum {
         }
     }
 
-    void QppAccelerator::cacheExecutionInfo() {
+    xacc::HeterogeneousMap QppAccelerator::getExecutionInfo() const
+    {
+        auto info = Accelerator::getExecutionInfo();
+        info.merge(m_executionInfo);
+        return info;
+    }
+
+    void QppAccelerator::exportState(const std::string& path)
+    {
+        // The paged state is streamed from its file, never in memory as a whole.
+        if (m_pagedState)
+        {
+            StateVectorWriter file(path, m_pagedState->nbQubits());
+            m_pagedState->save(file);
+            return;
+        }
+        Accelerator::exportState(path);
+    }
+
+    double QppAccelerator::stateBytes(size_t nbQubits, size_t nbStates) const
+    {
+        // 4^n entries for a density matrix
+        return std::ldexp(sizeof(std::complex<double>) * nbStates, (m_densityMatrix ? 2 : 1) * nbQubits);
+    }
+
+    void QppAccelerator::cacheExecutionInfo(const QppVisitor &visitor) {
+      m_pagedState.reset();
       // Cache the state-vector:
       // Note: qpp stores wavefunction in Eigen vectors,
       // hence, maps to std::vector.
-      auto stateVec = m_visitor->getStateVec();
+      auto stateVec = visitor.getStateVec();
       ExecutionInfo::WaveFuncType waveFunc(stateVec.data(),
                                            stateVec.data() + stateVec.size());
       m_executionInfo = {
@@ -14,41 +14,125 @@
 #include "xacc.hpp"
 #include "QppVisitor.hpp"
 #include "NoiseModel.hpp"
+#include "StabilizerAccelerator.hpp"
+#include <tuple>
 
 namespace xacc {
 namespace quantum {
+class PagedStateVector;
 
-class QppAccelerator : public Accelerator {
+// The service instance is shared (e.g. by xacc::getAccelerator); clone() gives
+// an independent instance, e.g. one per thread running its own workflow.
+class QppAccelerator : public Accelerator, public xacc::Cloneable<Accelerator> {
 public:
+    // Cloneable interface impls: new instance with the default configuration
+    // and the same memory limit, to be re-initialized as needed.
+    std::shared_ptr<Accelerator> clone() override;
+    bool shouldClone() override { return false; }
     // Identifiable interface impls
     virtual const std::string name() const override { return "qpp"; }
     virtual const std::string description() const override { return "XACC Simulation Accelerator based on qpp library."; }
 
     // Accelerator interface impls
     virtual void initialize(const HeterogeneousMap& params = {}) override;
-    virtual void updateConfiguration(const HeterogeneousMap& config) override {initialize(config);};
+    // Only the given options change, e.g. the "shots" of a shot-adaptive optimizer
+    virtual void updateConfiguration(const HeterogeneousMap& config) override
+    {
+        auto merged = m_config;
+        merged.merge(config);
+        initialize(merged);
+    }
     virtual const std::vector<std::string> configurationKeys() override { return {}; }
     virtual BitOrder getBitOrder() override {return BitOrder::LSB;}
     virtual void execute(std::shared_ptr<AcceleratorBuffer> buffer, const std::shared_ptr<CompositeInstruction> compositeInstruction) override;
     virtual void execute(std::shared_ptr<AcceleratorBuffer> buffer, const std::vector<std::shared_ptr<CompositeInstruction>> compositeInstructions) override;
+    virtual void executeWithPrefixSharing(std::shared_ptr<AcceleratorBuffer> buffer, const std::vector<std::shared_ptr<CompositeInstruction>> compositeInstructions) override;
+    virtual void computeExpectations(std::shared_ptr<AcceleratorBuffer> buffer, const std::shared_ptr<CompositeInstruction> ansatz, std::shared_ptr<Observable> observable) override;
+    // Batched: ansatz by ansatz, each sharing its state between the terms
+    virtual void computeExpectations(const std::vector<std::shared_ptr<AcceleratorBuffer>>& buffers, const std::vector<std::shared_ptr<CompositeInstruction>>& ansatzes, std::shared_ptr<Observable> observable) override;
     virtual void apply(std::shared_ptr<AcceleratorBuffer> buffer, std::shared_ptr<Instruction> inst) override;
+    // Batched apply, gate by gate on the same state
+    using Accelerator::apply;
+    // Bounds how many circuits of a parallel batch are simulated at once.
+    virtual void setMemoryLimit(uint64_t bytes) override { m_memoryLimit = bytes; }
     std::vector<std::pair<int, int>> getConnectivity() override {
       return m_connectivity;
     }
-    // ExecutionInfo implementation:
-    virtual xacc::HeterogeneousMap getExecutionInfo() const override { return m_executionInfo; }
+    // ExecutionInfo implementation: the state of the last execution and its metrics
+    virtual xacc::HeterogeneousMap getExecutionInfo() const override;
+    // The state of the last execution (in memory or paged) to a .npy file
+    virtual void exportState(const std::string& path) override;
   
   private:
+    // Simulate a single circuit on the given visitor
+    void executeCircuit(std::shared_ptr<QppVisitor> visitor, std::shared_ptr<AcceleratorBuffer> buffer, const std::shared_ptr<CompositeInstruction> compositeInstruction, bool cacheInfo);
+    // Shots of a dynamic circuit (mid-circuit Measure, Reset, IfStmt) as a
+    // tree of branches: the state is simulated once up to each measurement
+    // or reset, then projected onto each of its outcomes, the shots being
+    // split between them. Shots of identical classical histories are merged.
+    void executeBranchTree(std::shared_ptr<QppVisitor> visitor, std::shared_ptr<AcceleratorBuffer> buffer, const std::shared_ptr<CompositeInstruction> compositeInstruction);
+    // Simulate independent circuits concurrently, one visitor per task
+    void executeParallelBatch(std::shared_ptr<AcceleratorBuffer> buffer, const std::vector<std::shared_ptr<CompositeInstruction>>& compositeInstructions);
+    // Noisy simulation: one quantum trajectory per shot, the noise channels
+    // of each gate being sampled, run in parallel on the task scheduler.
+    void executeNoisyTrajectories(std::shared_ptr<AcceleratorBuffer> buffer, const std::shared_ptr<CompositeInstruction> compositeInstruction);
+    // Exact noisy simulation ("sim-type": "density_matrix"), the density
+    // matrix flattened in the "density_matrix" extra info.
+    void executeDensityMatrix(std::shared_ptr<AcceleratorBuffer> buffer, const std::shared_ptr<CompositeInstruction> compositeInstruction);
+    // Out-of-core state vector simulation ("sim-type": "paged_statevector",
+    // or a state beyond the memory limit with a "paging-dir"): the state is
+    // memory-mapped from a file of the paging directory (e.g. on NVMe).
+    void executePaged(std::shared_ptr<AcceleratorBuffer> buffer, const std::shared_ptr<CompositeInstruction> compositeInstruction);
+    // Whether execute() simulates a circuit of nbQubits with executePaged()
+    bool usePaging(size_t nbQubits) const;
+    // Noiseless state vector simulation: the state reuse shortcuts
+    // (VQE mode, prefix sharing, etc.) apply.
+    bool isStateVectorSim() const { return !m_noiseModel && !m_densityMatrix && !m_pagedStateVector; }
+    // Number of state vectors that can be simulated at once within the memory limit
+    size_t maxStatesInFlight(size_t nbQubits) const;
+    // Compute the results of the terminal measurements from the final state
+    void measureFinalState(const QppVisitor& visitor, std::shared_ptr<AcceleratorBuffer> buffer, const std::vector<size_t>& measureBitIdxs);
     // Cache execution info after execution
-    void cacheExecutionInfo();
+    void cacheExecutionInfo(const QppVisitor& visitor);
+    // Memory footprint of nbStates states (state vectors or density matrices)
+    double stateBytes(size_t nbQubits, size_t nbStates = 1) const;
     std::shared_ptr<QppVisitor> m_visitor;
     // Number of 'shots' if random sampling simulation is enabled.
     // -1 means disabled (no shots, just expectation value)
     int m_shots = -1;
     bool m_vqeMode;
+    bool m_parallelBatch = false;
+    // Max number of qubits of a fused gate block (0: no gate fusion)
+    int m_fusionMaxWidth = 0;
+    // 0 means no limit
+    uint64_t m_memoryLimit = 0;
+    // Noisy (trajectory) simulation if set ("noise-model" option)
+    std::shared_ptr<NoiseModel> m_noiseModel;
+    bool m_densityMatrix = false;
+    // Paged state vector: always if set, else beyond the memory limit when
+    // m_pagingDir is set. The chunks are of 2^m_pagingChunkQubits amplitudes.
+    bool m_pagedStateVector = false;
+    std::string m_pagingDir;
+    int m_pagingChunkQubits = 24;
+    // The paged state of the last execution, if paged (for exportState())
+    std::shared_ptr<PagedStateVector> m_pagedState;
+    // Initial state of the circuits ("initial-state-file"), instead of |0...0>
+    std::string m_initialStateFile;
+    // Clifford circuits with shots go to the stabilizer simulator if set
+    bool m_cliffordDispatch = true;
+    std::shared_ptr<StabilizerAccelerator> m_stabilizer;
     std::vector<std::pair<int,int>> m_connectivity;
     xacc::HeterogeneousMap m_executionInfo;
+    // The options of the last initialize()
+    xacc::HeterogeneousMap m_config;
     std::pair<AcceleratorBuffer*, size_t> m_currentBuffer;
+    // computeExpectations() prefix cache: the gates of the last ansatz and the
+    // state after its first m_prefixLength gates (0: no cached state).
+    using GateSignature = std::tuple<std::string, std::vector<std::size_t>, std::vector<InstructionParameter>>;
+    bool m_prefixCache = true;
+    std::vector<GateSignature> m_prefixGates;
+    size_t m_prefixLength = 0;
+    KetVectorType m_prefixState;
 };
 
 class DefaultNoiseModelUtils : public NoiseModelUtils 
@@ -12,6 +12,7 @@
  *******************************************************************************/
 
 #include "QppVisitor.hpp"
+#include "StateVectorKernels.hpp"
 #include "xacc.hpp"
 
 namespace {
@@ -51,6 +52,13 @@ namespace {
 
       return gateMat;
     }
+
+    // Row major entries of a 1-qubit gate matrix
+    std::array<std::complex<double>, 4> toArray(const qpp::cmat& in_mat)
+    {
+        assert(in_mat.rows() == 2 && in_mat.cols() == 2);
+        return { in_mat(0, 0), in_mat(0, 1), in_mat(1, 0), in_mat(1, 1) };
+    }
 }
 
 namespace xacc {
@@ -58,8 +66,19 @@ namespace quantum {
     void QppVisitor::initialize(std::shared_ptr<AcceleratorBuffer> buffer, bool shotsMode)
     {
         m_buffer = std::move(buffer);
-        const std::vector<qpp::idx> initialState(m_buffer->size(), 0);
-        m_stateVec = qpp::mket(initialState);
+        if (m_initialState)
+        {
+            if (m_initialState->size() != (1LL << m_buffer->size()))
+            {
+                xacc::error("The initial state has " + std::to_string(m_initialState->size()) + " amplitudes, the buffer " + std::to_string(m_buffer->size()) + " qubits.");
+            }
+            m_stateVec = *m_initialState;
+        }
+        else
+        {
+            const std::vector<qpp::idx> initialState(m_buffer->size(), 0);
+            m_stateVec = qpp::mket(initialState);
+        }
         const std::vector<qpp::idx> dims(m_buffer->size(), 2);
         m_dims = std::move(dims);
         m_measureBits.clear();
@@ -114,139 +133,110 @@ namespace quantum {
 
     void QppVisitor::visit(Hadamard& h)
     {
-       const auto qubitIdx = xaccIdxToQppIdx(h.bits()[0]);
-       m_stateVec = qpp::apply(m_stateVec, qpp::Gates::get_instance().H, { qubitIdx });
+        kernels::applyMatrix<false>(m_stateVec.data(), m_stateVec.size(), h.bits()[0], 0, toArray(qpp::Gates::get_instance().H));
     }
 
     void QppVisitor::visit(CNOT& cnot)
     {
-        const auto ctrlIdx = xaccIdxToQppIdx(cnot.bits()[0]);
-        const auto targetIdx = xaccIdxToQppIdx(cnot.bits()[1]);
-        m_stateVec = qpp::apply(m_stateVec, qpp::Gates::get_instance().CNOT, { ctrlIdx,  targetIdx}, m_dims);
+        kernels::applyX<true>(m_stateVec.data(), m_stateVec.size(), cnot.bits()[1], cnot.bits()[0]);
     }
 
     void QppVisitor::visit(Rz& rz)
     {
-        const auto qubitIdx = xaccIdxToQppIdx(rz.bits()[0]);
         const auto angleTheta = InstructionParameterToDouble(rz.getParameter(0));
-        m_stateVec = qpp::apply(m_stateVec, qpp::Gates::get_instance().RZ(angleTheta), { qubitIdx });
+        kernels::applyDiagonal<false>(m_stateVec.data(), m_stateVec.size(), rz.bits()[0], 0, std::polar(1.0, -angleTheta / 2.0), std::polar(1.0, angleTheta / 2.0));
     }
 
     void QppVisitor::visit(Ry& ry)
     {
-        const auto qubitIdx = xaccIdxToQppIdx(ry.bits()[0]);
         const auto angleTheta = InstructionParameterToDouble(ry.getParameter(0));
-        m_stateVec = qpp::apply(m_stateVec, qpp::Gates::get_instance().RY(angleTheta), { qubitIdx });
+        kernels::applyMatrix<false>(m_stateVec.data(), m_stateVec.size(), ry.bits()[0], 0, toArray(qpp::Gates::get_instance().RY(angleTheta)));
     }
 
     void QppVisitor::visit(Rx& rx)
     {
-        const auto qubitIdx = xaccIdxToQppIdx(rx.bits()[0]);
         const auto angleTheta = InstructionParameterToDouble(rx.getParameter(0));
-        m_stateVec = qpp::apply(m_stateVec, qpp::Gates::get_instance().RX(angleTheta), { qubitIdx });
+        kernels::applyMatrix<false>(m_stateVec.data(), m_stateVec.size(), rx.bits()[0], 0, toArray(qpp::Gates::get_instance().RX(angleTheta)));
     }
 
     void QppVisitor::visit(X& x)
     {
-        const auto qubitIdx = xaccIdxToQppIdx(x.bits()[0]);
-        m_stateVec = qpp::apply(m_stateVec, qpp::Gates::get_instance().X, { qubitIdx });
+        kernels::applyX<false>(m_stateVec.data(), m_stateVec.size(), x.bits()[0], 0);
     }
 
     void QppVisitor::visit(Y& y)
     {
-        const auto qubitIdx = xaccIdxToQppIdx(y.bits()[0]);
-        m_stateVec = qpp::apply(m_stateVec, qpp::Gates::get_instance().Y, { qubitIdx });
+        kernels::applyY<false>(m_stateVec.data(), m_stateVec.size(), y.bits()[0], 0);
     }
 
     void QppVisitor::visit(Z& z)
     {
-        const auto qubitIdx = xaccIdxToQppIdx(z.bits()[0]);
-        m_stateVec = qpp::apply(m_stateVec, qpp::Gates::get_instance().Z, { qubitIdx });
+        kernels::applyPhase<false>(m_stateVec.data(), m_stateVec.size(), z.bits()[0], 0, -1.0);
     }
 
     void QppVisitor::visit(CY& cy)
     {
-        const auto ctrlIdx = xaccIdxToQppIdx(cy.bits()[0]);
-        const auto targetIdx = xaccIdxToQppIdx(cy.bits()[1]);
-        m_stateVec = qpp::applyCTRL(m_stateVec, qpp::Gates::get_instance().Y, { ctrlIdx } ,  { targetIdx });
+        kernels::applyY<true>(m_stateVec.data(), m_stateVec.size(), cy.bits()[1], cy.bits()[0]);
     }
 
     void QppVisitor::visit(CZ& cz)
     {
-        const auto ctrlIdx = xaccIdxToQppIdx(cz.bits()[0]);
-        const auto targetIdx = xaccIdxToQppIdx(cz.bits()[1]);
-        m_stateVec = qpp::apply(m_stateVec, qpp::Gates::get_instance().CZ, { ctrlIdx,  targetIdx}, m_dims);
+        kernels::applyPhase<true>(m_stateVec.data(), m_stateVec.size(), cz.bits()[1], cz.bits()[0], -1.0);
     }
 
     void QppVisitor::visit(Swap& s)
     {
-        const auto qIdx1 = xaccIdxToQppIdx(s.bits()[0]);
-        const auto qIdx2 = xaccIdxToQppIdx(s.bits()[1]);
-        m_stateVec = qpp::apply(m_stateVec, qpp::Gates::get_instance().SWAP, { qIdx1, qIdx2 });
+        kernels::applySwap(m_stateVec.data(), m_stateVec.size(), s.bits()[0], s.bits()[1]);
     }
 
     void QppVisitor::visit(CRZ& crz)
     {
-        const auto ctrlIdx = xaccIdxToQppIdx(crz.bits()[0]);
-        const auto targetIdx = xaccIdxToQppIdx(crz.bits()[1]);
         const auto angleTheta = InstructionParameterToDouble(crz.getParameter(0));
-        m_stateVec = qpp::applyCTRL(m_stateVec, qpp::Gates::get_instance().RZ(angleTheta), { ctrlIdx } ,  { targetIdx });
+        kernels::applyDiagonal<true>(m_stateVec.data(), m_stateVec.size(), crz.bits()[1], crz.bits()[0], std::polar(1.0, -angleTheta / 2.0), std::polar(1.0, angleTheta / 2.0));
     }
 
     void QppVisitor::visit(CH& ch)
     {
-        const auto ctrlIdx = xaccIdxToQppIdx(ch.bits()[0]);
-        const auto targetIdx = xaccIdxToQppIdx(ch.bits()[1]);
-        m_stateVec = qpp::applyCTRL(m_stateVec, qpp::Gates::get_instance().H, { ctrlIdx } ,  { targetIdx });
+        kernels::applyMatrix<true>(m_stateVec.data(), m_stateVec.size(), ch.bits()[1], ch.bits()[0], toArray(qpp::Gates::get_instance().H));
     }
 
     void QppVisitor::visit(S& s)
     {
-        const auto qubitIdx = xaccIdxToQppIdx(s.bits()[0]);
-        m_stateVec = qpp::apply(m_stateVec, qpp::Gates::get_instance().S, { qubitIdx });
+        kernels::applyPhase<false>(m_stateVec.data(), m_stateVec.size(), s.bits()[0], 0, std::complex<double>(0.0, 1.0));
     }
 
     void QppVisitor::visit(Sdg& sdg)
     {
-        const auto qubitIdx = xaccIdxToQppIdx(sdg.bits()[0]);
-        m_stateVec = qpp::apply(m_stateVec, qpp::Gates::get_instance().S.adjoint(), { qubitIdx });
+        kernels::applyPhase<false>(m_stateVec.data(), m_stateVec.size(), sdg.bits()[0], 0, std::complex<double>(0.0, -1.0));
     }
 
     void QppVisitor::visit(T& t)
     {
-        const auto qubitIdx = xaccIdxToQppIdx(t.bits()[0]);
-        m_stateVec = qpp::apply(m_stateVec, qpp::Gates::get_instance().T, { qubitIdx });
+        kernels::applyPhase<false>(m_stateVec.data(), m_stateVec.size(), t.bits()[0], 0, std::polar(1.0, M_PI / 4.0));
     }
 
     void QppVisitor::visit(Tdg& tdg)
     {
-        const auto qubitIdx = xaccIdxToQppIdx(tdg.bits()[0]);
-        m_stateVec = qpp::apply(m_stateVec, qpp::Gates::get_instance().T.adjoint(), { qubitIdx });
+        kernels::applyPhase<false>(m_stateVec.data(), m_stateVec.size(), tdg.bits()[0], 0, std::polar(1.0, -M_PI / 4.0));
     }
 
     void QppVisitor::visit(CPhase& cphase)
     {
-        const auto ctrlIdx = xaccIdxToQppIdx(cphase.bits()[0]);
-        const auto targetIdx = xaccIdxToQppIdx(cphase.bits()[1]);
         const auto angleTheta = InstructionParameterToDouble(cphase.getParameter(0));
-        qpp::cmat gateMat { qpp::cmat::Zero(2, 2)};       
-        gateMat << 1, 0, 0, std::exp(std::complex<double>(0.0, angleTheta));
-        m_stateVec = qpp::applyCTRL(m_stateVec, gateMat, { ctrlIdx } ,  { targetIdx });
+        kernels::applyPhase<true>(m_stateVec.data(), m_stateVec.size(), cphase.bits()[1], cphase.bits()[0], std::polar(1.0, angleTheta));
     }
 
     void QppVisitor::visit(Identity& i)
     {
-        const auto qubitIdx = xaccIdxToQppIdx(i.bits()[0]);
-        m_stateVec = qpp::apply(m_stateVec, qpp::Gates::get_instance().Id2, { qubitIdx });
+        // Nothing to do
     }
 
     void QppVisitor::visit(U& u)
     {
-        const auto qubitIdx = xaccIdxToQppIdx(u.bits()[0]);
         const auto theta = InstructionParameterToDouble(u.getParameter(0));
         const auto phi = InstructionParameterToDouble(u.getParameter(1));
         const auto lambda = InstructionParameterToDouble(u.getParameter(2));
-        m_stateVec = qpp::apply(m_stateVec, u3GateMat(theta, phi, lambda), { qubitIdx });
+        kernels::applyMatrix<false>(m_stateVec.data(), m_stateVec.size(), u.bits()[0], 0, toArray(u3GateMat(theta, phi, lambda)));
     }
 
     void QppVisitor::visit(iSwap& in_iSwapGate) 
@@ -307,18 +297,23 @@ namespace quantum {
             std::cout << ">> State after measurement: " << qpp::disp(m_stateVec, ", ") << "\n";
         }
 
-        if (measure.hasClassicalRegAssignment()) 
+        recordMeasurement(measure, randomSelectedResult == 1);
+    }
+
+    void QppVisitor::recordMeasurement(Measure& in_measure, bool in_value)
+    {
+        if (in_measure.hasClassicalRegAssignment()) 
         {
           // Store the measurement to the corresponding classical buffer.
-          m_buffer->measure(measure.getBufferNames()[1],
-                            measure.getClassicalBitIndex(),
-                            randomSelectedResult);
+          m_buffer->measure(in_measure.getBufferNames()[1],
+                            in_measure.getClassicalBitIndex(),
+                            in_value);
         } 
         else 
         {
           // Add the measurement data to the acceleration buffer (e.g. for
           // conditional execution branching)
-          m_buffer->measure(measure.bits()[0], randomSelectedResult);
+          m_buffer->measure(in_measure.bits()[0], in_value);
         }
     }
     
@@ -351,13 +346,58 @@ namespace quantum {
     
     void QppVisitor::applyGate(Gate& in_gate) 
     {
-        if (in_gate.name() == "Measure")
+        if (in_gate.opcode() == xacc::GateOpcode::Measure)
         {
             xacc::error("Only unitary gates are allowed.");
         }
         in_gate.accept(this);
     }
 
+    void QppVisitor::applyFusedGate(const qpp::cmat& in_gateMat, const std::vector<size_t>& in_bits)
+    {
+        assert(in_gateMat.rows() == (1LL << in_bits.size()));
+        // QPP treats the first target as the MSB of the gate matrix,
+        // hence, list the targets from in_bits.back() to in_bits.front().
+        std::vector<qpp::idx> targetIdxs;
+        for (auto it = in_bits.rbegin(); it != in_bits.rend(); ++it)
+        {
+            targetIdxs.emplace_back(xaccIdxToQppIdx(*it));
+        }
+        m_stateVec = qpp::apply(m_stateVec, in_gateMat, targetIdxs);
+    }
+
+    void QppVisitor::applyKrausChannel(const std::vector<qpp::cmat>& in_krausMats, const std::vector<size_t>& in_bits, double in_random)
+    {
+        assert(!in_krausMats.empty());
+        std::vector<qpp::idx> targetIdxs;
+        for (auto it = in_bits.rbegin(); it != in_bits.rend(); ++it)
+        {
+            targetIdxs.emplace_back(xaccIdxToQppIdx(*it));
+        }
+        // Only the operators up to the selected one are applied:
+        // the probabilities of a CPTP channel sum up to 1.
+        double cumulativeProb = 0.0;
+        KetVectorType selected;
+        double selectedProb = 0.0;
+        for (const auto& krausMat : in_krausMats)
+        {
+            KetVectorType nextState = qpp::apply(m_stateVec, krausMat, targetIdxs);
+            const double prob = nextState.squaredNorm();
+            cumulativeProb += prob;
+            // Round-off: fall back to the last non-zero branch
+            if (prob > 0.0)
+            {
+                selected = std::move(nextState);
+                selectedProb = prob;
+            }
+            if (in_random < cumulativeProb && selectedProb > 0.0)
+            {
+                break;
+            }
+        }
+        m_stateVec = selected / std::sqrt(selectedProb);
+    }
+
     bool QppVisitor::measure(size_t in_bit) 
     {
         const auto qubitIdx = xaccIdxToQppIdx(in_bit);
@@ -385,6 +425,39 @@ namespace quantum {
         return (randomSelectedResult == 1);
     }
 
+    double QppVisitor::probabilityOne(size_t in_bit) const
+    {
+        // Qubit in_bit is bit in_bit of the state vector index (LSB first).
+        const uint64_t mask = 1ULL << in_bit;
+        double result = 0.0;
+        for (int64_t i = 0; i < m_stateVec.size(); ++i)
+        {
+            if (i & mask)
+            {
+                result += std::norm(m_stateVec(i));
+            }
+        }
+        return result;
+    }
+
+    void QppVisitor::collapse(size_t in_bit, bool in_value, double in_prob)
+    {
+        assert(in_prob > 0.0);
+        const uint64_t mask = 1ULL << in_bit;
+        const double scale = 1.0 / std::sqrt(in_prob);
+        for (int64_t i = 0; i < m_stateVec.size(); ++i)
+        {
+            if (((i & mask) != 0) == in_value)
+            {
+                m_stateVec(i) *= scale;
+            }
+            else
+            {
+                m_stateVec(i) = 0.0;
+            }
+        }
+    }
+
     double QppVisitor::getExpectationValueZ(std::shared_ptr<CompositeInstruction> in_composite) 
     {
         auto cachedStateVec = m_stateVec;
@@ -396,7 +469,7 @@ namespace quantum {
             auto nextInst = it.next();
             if (nextInst->isEnabled() && !nextInst->isComposite()) 
             {
-                if (nextInst->name() == "Measure") 
+                if (nextInst->opcode() == xacc::GateOpcode::Measure) 
                 {
                     measureBitIdxs.emplace_back(nextInst->bits()[0]);
                 }
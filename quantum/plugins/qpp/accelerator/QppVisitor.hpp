@@ -53,14 +53,39 @@ public:
   void visit(iSwap& in_iSwapGate) override;
   void visit(fSim& in_fsimGate) override;
   void visit(Reset& in_resetGate) override;
-  virtual std::shared_ptr<QppVisitor> clone() override { return std::make_shared<QppVisitor>(); }
+  virtual std::shared_ptr<QppVisitor> clone() override
+  {
+    auto visitor = std::make_shared<QppVisitor>();
+    visitor->m_initialState = m_initialState;
+    return visitor;
+  }
+  // The state of initialize() rather than |0...0> (null: |0...0>), e.g.
+  // loaded from a state vector file; shared by the clones.
+  void setInitialState(std::shared_ptr<const KetVectorType> in_initialState) { m_initialState = std::move(in_initialState); }
   const KetVectorType& getStateVec() const { return m_stateVec; }
+  // Restore a previously saved state (same number of qubits)
+  void setStateVec(const KetVectorType& in_stateVec) { m_stateVec = in_stateVec; }
   static double calcExpectationValueZ(const KetVectorType& in_stateVec, const std::vector<qpp::idx>& in_bits);
   double getExpectationValueZ(std::shared_ptr<CompositeInstruction> in_composite);
 
   // Gate-by-gate API (FTQC)
   void applyGate(Gate& in_gate);
+  // Apply a dense (fused) unitary on the given qubits.
+  // Note: the matrix is indexed with in_bits[0] as the LSB (GateFuser convention).
+  void applyFusedGate(const qpp::cmat& in_gateMat, const std::vector<size_t>& in_bits);
+  // Quantum trajectory step of a noise channel: apply one of the Kraus
+  // operators, K_i with probability ||K_i psi||^2 picked by in_random
+  // (uniform in [0, 1)), and renormalize.
+  // Note: the matrices are indexed with in_bits[0] as the LSB.
+  void applyKrausChannel(const std::vector<qpp::cmat>& in_krausMats, const std::vector<size_t>& in_bits, double in_random);
   bool measure(size_t in_bit);
+  // Probability of measuring 1 on in_bit
+  double probabilityOne(size_t in_bit) const;
+  // Project in_bit onto in_value, of probability in_prob, and renormalize.
+  void collapse(size_t in_bit, bool in_value, double in_prob);
+  // Store a measurement result to the buffer, i.e. to its classical register
+  // if any (e.g. for conditional execution branching).
+  void recordMeasurement(Measure& in_measure, bool in_value);
   bool isInitialized() const { return m_initialized; }
   // Allocate more qubits (zero state)
   void allocateQubits(size_t in_nbQubits);
@@ -70,6 +95,7 @@ private:
   std::shared_ptr<AcceleratorBuffer> m_buffer;  
   std::vector<qpp::idx> m_dims;
   KetVectorType m_stateVec;
+  std::shared_ptr<const KetVectorType> m_initialState;
   std::vector<qpp::idx> m_measureBits;
   // If true, it will perform a trajectory simulation and return the bit string of measurement results.
   // Otherwise, it will only compute the expectation value.
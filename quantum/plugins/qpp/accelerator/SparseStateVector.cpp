@@ -0,0 +1,259 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "SparseStateVector.hpp"
+#include "xacc.hpp"
+#include <algorithm>
+
+namespace {
+// Matrix entries treated as zero by the permutation check
+constexpr double ZERO_TOLERANCE = 1e-12;
+constexpr size_t MIN_CAPACITY = 16;
+
+// splitmix64 finalizer: consecutive basis states spread over the table
+uint64_t hashKey(uint64_t in_key) {
+  in_key ^= in_key >> 30;
+  in_key *= 0xbf58476d1ce4e5b9ULL;
+  in_key ^= in_key >> 27;
+  in_key *= 0x94d049bb133111ebULL;
+  return in_key ^ (in_key >> 31);
+}
+} // namespace
+
+namespace xacc {
+namespace quantum {
+AmplitudeMap::AmplitudeMap(size_t in_expectedSize) {
+  size_t capacity = MIN_CAPACITY;
+  while (capacity < 2 * in_expectedSize) {
+    capacity *= 2;
+  }
+  m_keys.resize(capacity);
+  m_amplitudes.resize(capacity);
+  m_used.resize(capacity, 0);
+}
+
+size_t AmplitudeMap::slot(uint64_t in_key) const {
+  const size_t mask = m_used.size() - 1;
+  size_t slot = hashKey(in_key) & mask;
+  while (m_used[slot] && m_keys[slot] != in_key) {
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+const AmplitudeMap::Amplitude *AmplitudeMap::find(uint64_t in_key) const {
+  const auto idx = slot(in_key);
+  return m_used[idx] ? &m_amplitudes[idx] : nullptr;
+}
+
+AmplitudeMap::Amplitude &AmplitudeMap::operator[](uint64_t in_key) {
+  auto idx = slot(in_key);
+  if (m_used[idx]) {
+    return m_amplitudes[idx];
+  }
+  if (2 * (m_size + 1) > m_used.size()) {
+    grow();
+    idx = slot(in_key);
+  }
+  m_used[idx] = 1;
+  m_keys[idx] = in_key;
+  m_amplitudes[idx] = 0.0;
+  ++m_size;
+  return m_amplitudes[idx];
+}
+
+void AmplitudeMap::grow() {
+  AmplitudeMap grown(m_used.size());
+  forEach([&](uint64_t in_key, const Amplitude &in_amplitude) {
+    const auto idx = grown.slot(in_key);
+    grown.m_used[idx] = 1;
+    grown.m_keys[idx] = in_key;
+    grown.m_amplitudes[idx] = in_amplitude;
+  });
+  grown.m_size = m_size;
+  *this = std::move(grown);
+}
+
+SparseStateVector::SparseStateVector(size_t in_nbQubits,
+                                     double in_pruningThreshold)
+    : m_nbQubits(in_nbQubits), m_threshold(in_pruningThreshold) {
+  if (in_nbQubits > 64) {
+    xacc::error("The sparse state vector supports up to 64 qubits, not " +
+                std::to_string(in_nbQubits) + ".");
+  }
+  m_amplitudes[0] = 1.0;
+}
+
+void SparseStateVector::apply(const std::vector<size_t> &in_qubits,
+                              const std::vector<Amplitude> &in_matrix) {
+  const size_t dim = 1ULL << in_qubits.size();
+  if (in_matrix.size() != dim * dim) {
+    xacc::error("Invalid gate matrix size for " +
+                std::to_string(in_qubits.size()) + " qubits.");
+  }
+  // The basis state offset of each local index (bit j: in_qubits[j])
+  uint64_t mask = 0;
+  std::vector<uint64_t> offsets(dim, 0);
+  for (size_t j = 0; j < in_qubits.size(); ++j) {
+    if (in_qubits[j] >= m_nbQubits || ((mask >> in_qubits[j]) & 1ULL)) {
+      xacc::error("Invalid gate qubits.");
+    }
+    mask |= 1ULL << in_qubits[j];
+    for (uint64_t local = 0; local < dim; ++local) {
+      offsets[local] |= ((local >> j) & 1ULL) << in_qubits[j];
+    }
+  }
+  const auto localIndex = [&](uint64_t in_key) {
+    uint64_t local = 0;
+    for (size_t j = 0; j < in_qubits.size(); ++j) {
+      local |= ((in_key >> in_qubits[j]) & 1ULL) << j;
+    }
+    return local;
+  };
+
+  // A single non-zero entry per column: column c -> (row, entry)
+  std::vector<uint64_t> rows(dim);
+  std::vector<Amplitude> entries(dim);
+  bool isPermutation = true;
+  bool isDiagonal = true;
+  for (uint64_t col = 0; col < dim && isPermutation; ++col) {
+    size_t nbNonZeros = 0;
+    for (uint64_t row = 0; row < dim; ++row) {
+      if (std::abs(in_matrix[row * dim + col]) > ZERO_TOLERANCE) {
+        rows[col] = row;
+        entries[col] = in_matrix[row * dim + col];
+        ++nbNonZeros;
+      }
+    }
+    isPermutation = nbNonZeros == 1;
+    isDiagonal = isDiagonal && isPermutation && rows[col] == col;
+  }
+
+  if (isDiagonal) {
+    m_amplitudes.forEach([&](uint64_t in_key, Amplitude &io_amplitude) {
+      io_amplitude *= entries[localIndex(in_key)];
+    });
+    return;
+  }
+
+  if (isPermutation) {
+    AmplitudeMap permuted(m_amplitudes.size());
+    m_amplitudes.forEach([&](uint64_t in_key, const Amplitude &in_amplitude) {
+      const auto local = localIndex(in_key);
+      permuted[(in_key & ~mask) | offsets[rows[local]]] =
+          in_amplitude * entries[local];
+    });
+    m_amplitudes = std::move(permuted);
+    return;
+  }
+
+  // Each group of basis states differing on the gate qubits is mixed once,
+  // from its (present) state of lowest local index.
+  AmplitudeMap mixed(2 * m_amplitudes.size());
+  std::vector<Amplitude> in(dim);
+  m_amplitudes.forEach([&](uint64_t in_key, const Amplitude &) {
+    const auto local = localIndex(in_key);
+    const auto base = in_key & ~mask;
+    for (uint64_t other = 0; other < local; ++other) {
+      if (m_amplitudes.find(base | offsets[other])) {
+        return;
+      }
+    }
+    for (uint64_t col = 0; col < dim; ++col) {
+      const auto *amplitude = m_amplitudes.find(base | offsets[col]);
+      in[col] = amplitude ? *amplitude : 0.0;
+    }
+    for (uint64_t row = 0; row < dim; ++row) {
+      Amplitude out = 0.0;
+      for (uint64_t col = 0; col < dim; ++col) {
+        out += in_matrix[row * dim + col] * in[col];
+      }
+      if (std::abs(out) > m_threshold) {
+        mixed[base | offsets[row]] = out;
+      } else {
+        m_prunedProbability += std::norm(out);
+      }
+    }
+  });
+  m_amplitudes = std::move(mixed);
+}
+
+SparseStateVector::Amplitude
+SparseStateVector::amplitude(uint64_t in_basisState) const {
+  const auto *amplitude = m_amplitudes.find(in_basisState);
+  return amplitude ? *amplitude : 0.0;
+}
+
+double
+SparseStateVector::expectationValueZ(const std::vector<size_t> &in_bits) const {
+  uint64_t mask = 0;
+  for (const auto bit : in_bits) {
+    mask |= 1ULL << bit;
+  }
+  double result = 0.0;
+  m_amplitudes.forEach([&](uint64_t in_key, const Amplitude &in_amplitude) {
+    const double sign = __builtin_popcountll(in_key & mask) % 2 ? -1.0 : 1.0;
+    result += sign * std::norm(in_amplitude);
+  });
+  return result;
+}
+
+std::map<uint64_t, int>
+SparseStateVector::sample(const std::vector<size_t> &in_bits, int in_shots,
+                          std::mt19937_64 &io_rng) const {
+  // Sorted uniforms walked along the cumulative distribution of the
+  // amplitudes (renormalized, if some were pruned)
+  std::vector<uint64_t> keys;
+  std::vector<double> cumulative;
+  keys.reserve(m_amplitudes.size());
+  cumulative.reserve(m_amplitudes.size());
+  double total = 0.0;
+  m_amplitudes.forEach([&](uint64_t in_key, const Amplitude &in_amplitude) {
+    total += std::norm(in_amplitude);
+    keys.emplace_back(in_key);
+    cumulative.emplace_back(total);
+  });
+  std::uniform_real_distribution<double> uniform(0.0, total);
+  std::vector<double> draws(std::max(in_shots, 0));
+  for (auto &draw : draws) {
+    draw = uniform(io_rng);
+  }
+  std::sort(draws.begin(), draws.end());
+
+  std::map<uint64_t, int> counts;
+  size_t entry = 0;
+  for (const auto draw : draws) {
+    while (entry + 1 < cumulative.size() && cumulative[entry] <= draw) {
+      ++entry;
+    }
+    uint64_t outcome = 0;
+    for (size_t j = 0; j < in_bits.size(); ++j) {
+      outcome |= ((keys[entry] >> in_bits[j]) & 1ULL) << j;
+    }
+    counts[outcome]++;
+  }
+  return counts;
+}
+
+std::vector<SparseStateVector::Amplitude> SparseStateVector::toDense() const {
+  if (m_nbQubits > 40) {
+    xacc::error("Too many qubits (" + std::to_string(m_nbQubits) +
+                ") for a dense state vector.");
+  }
+  std::vector<Amplitude> dense(1ULL << m_nbQubits, 0.0);
+  m_amplitudes.forEach([&](uint64_t in_key, const Amplitude &in_amplitude) {
+    dense[in_key] = in_amplitude;
+  });
+  return dense;
+}
+} // namespace quantum
+} // namespace xacc
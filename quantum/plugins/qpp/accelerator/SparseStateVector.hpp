@@ -0,0 +1,105 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#pragma once
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace xacc {
+namespace quantum {
+// Amplitudes by basis state, in an open-addressing hash table (linear
+// probing, power of 2 capacity, at most half full).
+class AmplitudeMap {
+public:
+  using Amplitude = std::complex<double>;
+
+  explicit AmplitudeMap(size_t in_expectedSize = 0);
+
+  // nullptr if absent
+  const Amplitude *find(uint64_t in_key) const;
+  // Inserted as 0 if absent
+  Amplitude &operator[](uint64_t in_key);
+  size_t size() const { return m_size; }
+
+  // in_f(key, amplitude) on each entry
+  template <typename Function> void forEach(Function in_f) const {
+    for (size_t slot = 0; slot < m_used.size(); ++slot) {
+      if (m_used[slot]) {
+        in_f(m_keys[slot], m_amplitudes[slot]);
+      }
+    }
+  }
+  template <typename Function> void forEach(Function in_f) {
+    for (size_t slot = 0; slot < m_used.size(); ++slot) {
+      if (m_used[slot]) {
+        in_f(m_keys[slot], m_amplitudes[slot]);
+      }
+    }
+  }
+
+private:
+  size_t slot(uint64_t in_key) const;
+  void grow();
+
+  std::vector<uint64_t> m_keys;
+  std::vector<Amplitude> m_amplitudes;
+  std::vector<uint8_t> m_used;
+  size_t m_size = 0;
+};
+
+// A state vector of up to 64 qubits holding only its non-zero amplitudes,
+// keyed by basis state (bit q is qubit q, as in XACC), for circuits keeping
+// a small support (arithmetic, oracles, permutations of classical inputs).
+// A gate whose matrix has a single non-zero entry per column (a permutation
+// with phases: X, CNOT, Swap, and all the diagonal gates) moves or rescales
+// each amplitude. The other gates combine the amplitudes of each group of
+// basis states only differing on the gate qubits, the results of at most
+// the pruning threshold (in absolute value) being dropped.
+class SparseStateVector {
+public:
+  using Amplitude = AmplitudeMap::Amplitude;
+
+  // |0...0>
+  SparseStateVector(size_t in_nbQubits, double in_pruningThreshold);
+
+  // in_matrix: row-major, 2^k x 2^k on the k qubits, bit j of the row and
+  // column indices being in_qubits[j]
+  void apply(const std::vector<size_t> &in_qubits,
+             const std::vector<Amplitude> &in_matrix);
+
+  size_t nbQubits() const { return m_nbQubits; }
+  size_t nbAmplitudes() const { return m_amplitudes.size(); }
+  // Total probability of the pruned amplitudes
+  double prunedProbability() const { return m_prunedProbability; }
+  Amplitude amplitude(uint64_t in_basisState) const;
+
+  // <Z...Z> on in_bits
+  double expectationValueZ(const std::vector<size_t> &in_bits) const;
+  // Outcome -> count after in_shots draws, bit j of an outcome being the
+  // result of in_bits[j]
+  std::map<uint64_t, int> sample(const std::vector<size_t> &in_bits,
+                                 int in_shots, std::mt19937_64 &io_rng) const;
+  // All the 2^n amplitudes
+  std::vector<Amplitude> toDense() const;
+
+private:
+  size_t m_nbQubits;
+  double m_threshold;
+  double m_prunedProbability = 0.0;
+  AmplitudeMap m_amplitudes;
+};
+} // namespace quantum
+} // namespace xacc
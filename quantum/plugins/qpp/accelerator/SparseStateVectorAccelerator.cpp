@@ -0,0 +1,239 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "SparseStateVectorAccelerator.hpp"
+#include "Circuit.hpp"
+#include "GateFusion.hpp"
+#include "MeasurementSampler.hpp"
+#include "QppVisitor.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <unordered_set>
+
+namespace {
+using Amplitude = xacc::quantum::SparseStateVector::Amplitude;
+// Gates that the GateFuser can compute the matrix of.
+const std::unordered_set<std::string> SUPPORTED_GATES{
+    "H", "CNOT", "Rx",  "Ry", "Rz",  "X",   "Y",      "Z",  "CY", "CZ",
+    "Swap", "CRZ", "CH", "S", "Sdg", "T", "Tdg", "CPhase", "I", "U"};
+
+// Row-major, bit j of the row and column indices being gate qubit j
+std::vector<Amplitude> gateMatrix(xacc::Instruction &in_gate) {
+  const size_t nbBits = in_gate.bits().size();
+  std::vector<size_t> localBits(nbBits);
+  std::iota(localBits.begin(), localBits.end(), 0);
+  auto localGate = in_gate.clone();
+  localGate->setBits(localBits);
+  auto block = std::make_shared<xacc::quantum::Circuit>("gate");
+  block->addInstruction(localGate);
+  GateFuser fuser;
+  fuser.initialize(block);
+  const auto matrix = fuser.calcFusedGate(nbBits);
+
+  const size_t dim = 1ULL << nbBits;
+  std::vector<Amplitude> data(dim * dim);
+  for (size_t row = 0; row < dim; ++row) {
+    for (size_t col = 0; col < dim; ++col) {
+      data[row * dim + col] = matrix(row, col);
+    }
+  }
+  return data;
+}
+
+// Not worth the scheduling for fewer circuits
+void parallelFor(size_t in_size, const std::function<void(size_t)> &in_f) {
+  if (in_size < 2) {
+    for (size_t i = 0; i < in_size; ++i) {
+      in_f(i);
+    }
+    return;
+  }
+  xacc::getTaskScheduler()->parallelFor(
+      0, in_size, [&](size_t beginIdx, size_t endIdx) {
+        for (size_t i = beginIdx; i < endIdx; ++i) {
+          in_f(i);
+        }
+      });
+}
+} // namespace
+
+namespace xacc {
+namespace quantum {
+void SparseStateVectorAccelerator::initialize(const HeterogeneousMap &params) {
+  m_shots = -1;
+  if (params.keyExists<int>("shots")) {
+    m_shots = params.get<int>("shots");
+    if (m_shots < 1) {
+      xacc::error("Invalid 'shots' parameter.");
+    }
+  }
+  m_threshold = 1e-12;
+  if (params.keyExists<double>("pruning-threshold")) {
+    m_threshold = params.get<double>("pruning-threshold");
+    if (m_threshold < 0.0) {
+      xacc::error("Invalid 'pruning-threshold' parameter: must be "
+                  "non-negative.");
+    }
+  }
+  m_denseFraction = 0.25;
+  if (params.keyExists<double>("dense-fraction")) {
+    m_denseFraction = params.get<double>("dense-fraction");
+    if (m_denseFraction <= 0.0) {
+      xacc::error("Invalid 'dense-fraction' parameter: must be positive.");
+    }
+  }
+}
+
+SparseStateVectorAccelerator::Program
+SparseStateVectorAccelerator::toProgram(CompositeInstruction &in_circuit) {
+  Program program;
+  addInstructions(in_circuit, program);
+  return program;
+}
+
+void SparseStateVectorAccelerator::addInstruction(Instruction *in_inst,
+                                                  Program &io_program) {
+  if (!in_inst->isEnabled()) {
+    return;
+  }
+  if (in_inst->isComposite()) {
+    if (in_inst->name() == "ifstmt") {
+      xacc::error("Conditionals are not supported by the sparse state "
+                  "vector simulator.");
+    }
+    addInstructions(*dynamic_cast<CompositeInstruction *>(in_inst),
+                    io_program);
+    return;
+  }
+  const auto bits = in_inst->bits();
+  for (const auto bit : bits) {
+    if (xacc::container::contains(io_program.measured, bit)) {
+      xacc::error("Mid-circuit measurements are not supported by the sparse "
+                  "state vector simulator.");
+    }
+  }
+  if (in_inst->opcode() == GateOpcode::Measure) {
+    io_program.measured.emplace_back(bits[0]);
+  } else if (in_inst->opcode() == GateOpcode::Reset) {
+    xacc::error("Resets are not supported by the sparse state vector "
+                "simulator.");
+  } else if (SUPPORTED_GATES.count(in_inst->name()) == 0) {
+    xacc::error("Gate '" + in_inst->name() +
+                "' is not supported by the sparse state vector simulator.");
+  } else if (in_inst->opcode() != GateOpcode::I) {
+    io_program.gates.emplace_back(in_inst);
+  }
+}
+
+void SparseStateVectorAccelerator::addInstructions(
+    CompositeInstruction &in_composite, Program &io_program) {
+  for (size_t i = 0; i < in_composite.nInstructions(); ++i) {
+    addInstruction(in_composite.getInstruction(i).get(), io_program);
+  }
+}
+
+void SparseStateVectorAccelerator::simulate(
+    const Program &in_program,
+    std::shared_ptr<AcceleratorBuffer> io_buffer) const {
+  const size_t nbQubits = io_buffer->size();
+  SparseStateVector state(nbQubits, m_threshold);
+  const double maxSparseAmplitudes =
+      m_denseFraction * std::ldexp(1.0, nbQubits);
+  size_t maxAmplitudes = 1;
+  size_t next = 0;
+  for (; next < in_program.gates.size() &&
+         state.nbAmplitudes() <= maxSparseAmplitudes;
+       ++next) {
+    auto *gate = in_program.gates[next];
+    state.apply(gate->bits(), gateMatrix(*gate));
+    maxAmplitudes = std::max(maxAmplitudes, state.nbAmplitudes());
+  }
+  io_buffer->addExtraInfo("max-amplitudes", static_cast<int>(maxAmplitudes));
+  if (state.prunedProbability() > 0.0) {
+    io_buffer->addExtraInfo("pruned-probability", state.prunedProbability());
+  }
+
+  if (next < in_program.gates.size()) {
+    // The support is too large: the remaining gates on the dense state
+    io_buffer->addExtraInfo("dense-fallback-gate", static_cast<int>(next));
+    const auto dense = state.toDense();
+    auto visitor = std::make_shared<QppVisitor>();
+    visitor->setInitialState(std::make_shared<const KetVectorType>(
+        Eigen::Map<const KetVectorType>(dense.data(), dense.size())));
+    visitor->initialize(io_buffer);
+    for (; next < in_program.gates.size(); ++next) {
+      in_program.gates[next]->accept(visitor);
+    }
+    const auto &stateVec = visitor->getStateVec();
+    if (!in_program.measured.empty()) {
+      if (m_shots < 0) {
+        io_buffer->addExtraInfo("exp-val-z",
+                                QppVisitor::calcExpectationValueZ(
+                                    stateVec, in_program.measured));
+      } else {
+        MeasurementSampler(stateVec, in_program.measured)
+            .appendMeasurements(io_buffer, m_shots);
+      }
+    }
+    visitor->finalize();
+    return;
+  }
+
+  if (in_program.measured.empty()) {
+    return;
+  }
+  if (m_shots < 0) {
+    io_buffer->addExtraInfo("exp-val-z",
+                            state.expectationValueZ(in_program.measured));
+    return;
+  }
+  std::mt19937_64 rng(std::random_device{}());
+  for (const auto &[outcome, count] :
+       state.sample(in_program.measured, m_shots, rng)) {
+    // Bit j is the j-th measured qubit
+    std::string bitString;
+    for (size_t j = 0; j < in_program.measured.size(); ++j) {
+      bitString.push_back((outcome >> j) & 1ULL ? '1' : '0');
+    }
+    io_buffer->appendMeasurement(bitString, count);
+  }
+}
+
+void SparseStateVectorAccelerator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::shared_ptr<CompositeInstruction> compositeInstruction) {
+  ScopedExecutionMetrics metrics(*this, 1, m_shots);
+  simulate(toProgram(*compositeInstruction), buffer);
+}
+
+void SparseStateVectorAccelerator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>>
+        compositeInstructions) {
+  ScopedExecutionMetrics metrics(*this, compositeInstructions.size(),
+                                 m_shots);
+  std::vector<Program> programs;
+  std::vector<std::shared_ptr<AcceleratorBuffer>> results;
+  for (auto &circuit : compositeInstructions) {
+    programs.emplace_back(toProgram(*circuit));
+    results.emplace_back(
+        std::make_shared<AcceleratorBuffer>(circuit->name(), buffer->size()));
+  }
+  parallelFor(programs.size(),
+              [&](size_t i) { simulate(programs[i], results[i]); });
+  for (size_t i = 0; i < results.size(); ++i) {
+    buffer->appendChild(compositeInstructions[i]->name(), results[i]);
+  }
+}
+} // namespace quantum
+} // namespace xacc
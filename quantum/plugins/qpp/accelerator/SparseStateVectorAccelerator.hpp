@@ -0,0 +1,73 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#pragma once
+#include "xacc.hpp"
+#include "SparseStateVector.hpp"
+
+namespace xacc {
+namespace quantum {
+// Noiseless simulation of circuits with few non-zero amplitudes (reversible
+// logic, arithmetic or QPE on classical inputs) on up to 64 qubits, with a
+// SparseStateVector. The amplitudes of at most "pruning-threshold" (1e-12)
+// are dropped ("pruned-probability" is their total probability), and
+// "max-amplitudes" is the largest support of the simulation.
+// Once the support exceeds "dense-fraction" (0.25) of the 2^n amplitudes,
+// the rest of the circuit is simulated by qpp on the dense state vector
+// ("dense-fallback-gate" being the index of its first gate).
+// Measurements are at the end of the circuit: "exp-val-z" without "shots",
+// else the sampled bit strings.
+class SparseStateVectorAccelerator : public Accelerator {
+public:
+  // Identifiable interface impls
+  const std::string name() const override { return "sparse"; }
+  const std::string description() const override {
+    return "XACC Simulation Accelerator storing only the non-zero amplitudes "
+           "of the state vector.";
+  }
+
+  // Accelerator interface impls
+  void initialize(const HeterogeneousMap &params = {}) override;
+  void updateConfiguration(const HeterogeneousMap &config) override {
+    initialize(config);
+  };
+  const std::vector<std::string> configurationKeys() override {
+    return {"shots", "pruning-threshold", "dense-fraction"};
+  }
+  BitOrder getBitOrder() override { return BitOrder::LSB; }
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::shared_ptr<CompositeInstruction>
+                   compositeInstruction) override;
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::vector<std::shared_ptr<CompositeInstruction>>
+                   compositeInstructions) override;
+
+private:
+  // The gates of a circuit and its measured qubits
+  struct Program {
+    std::vector<Instruction *> gates;
+    std::vector<size_t> measured;
+  };
+  // Checked before any simulation: no errors from the worker threads
+  static Program toProgram(CompositeInstruction &in_circuit);
+  static void addInstruction(Instruction *in_inst, Program &io_program);
+  static void addInstructions(CompositeInstruction &in_composite,
+                              Program &io_program);
+  void simulate(const Program &in_program,
+                std::shared_ptr<AcceleratorBuffer> io_buffer) const;
+
+  int m_shots = -1;
+  double m_threshold = 1e-12;
+  double m_denseFraction = 0.25;
+};
+} // namespace quantum
+} // namespace xacc
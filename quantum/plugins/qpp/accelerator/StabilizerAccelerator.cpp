@@ -0,0 +1,269 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "StabilizerAccelerator.hpp"
+#include "MeasurementSampler.hpp"
+#include <cmath>
+#include <functional>
+
+namespace {
+// Rotation angle as a number of quarter turns (mod 4), -1 if it is not a
+// (bound) multiple of pi/2.
+int quarterTurns(const xacc::InstructionParameter &in_param) {
+  if (in_param.which() == 2) {
+    const auto str = in_param.toString();
+    char *end = nullptr;
+    strtod(str.c_str(), &end);
+    if (end == str.c_str() || *end != '\0') {
+      return -1;
+    }
+  }
+  const double turns = xacc::InstructionParameterToDouble(in_param) / M_PI_2;
+  const double rounded = std::round(turns);
+  if (std::abs(turns - rounded) > 1e-9) {
+    return -1;
+  }
+  return ((static_cast<int64_t>(rounded) % 4) + 4) % 4;
+}
+
+void rz(xacc::quantum::StabilizerTableau &io_tableau, size_t in_qubit,
+        int in_quarterTurns) {
+  switch (in_quarterTurns) {
+  case 1:
+    io_tableau.s(in_qubit);
+    break;
+  case 2:
+    io_tableau.z(in_qubit);
+    break;
+  case 3:
+    io_tableau.sdg(in_qubit);
+    break;
+  default:
+    break;
+  }
+}
+
+void rx(xacc::quantum::StabilizerTableau &io_tableau, size_t in_qubit,
+        int in_quarterTurns) {
+  io_tableau.h(in_qubit);
+  rz(io_tableau, in_qubit, in_quarterTurns);
+  io_tableau.h(in_qubit);
+}
+
+// Ry = S Rx Sdg
+void ry(xacc::quantum::StabilizerTableau &io_tableau, size_t in_qubit,
+        int in_quarterTurns) {
+  io_tableau.sdg(in_qubit);
+  rx(io_tableau, in_qubit, in_quarterTurns);
+  io_tableau.s(in_qubit);
+}
+
+const std::vector<std::string> &supportedGates() {
+  static const std::vector<std::string> gates{
+      "H",  "S",  "Sdg",  "X", "Y",  "Z",  "CNOT",    "CZ", "CY",
+      "Swap", "I", "Rx", "Ry", "Rz", "U1", "U", "Measure", "Reset"};
+  return gates;
+}
+} // namespace
+
+namespace xacc {
+namespace quantum {
+void StabilizerAccelerator::initialize(const HeterogeneousMap &params) {
+  m_shots = -1;
+  if (params.keyExists<int>("shots")) {
+    m_shots = params.get<int>("shots");
+    if (m_shots < 1) {
+      xacc::error("Invalid 'shots' parameter.");
+    }
+  }
+  m_hasSeed = params.keyExists<int>("seed");
+  if (m_hasSeed) {
+    m_seed = params.get<int>("seed");
+  }
+}
+
+bool StabilizerAccelerator::isCliffordCircuit(
+    const std::shared_ptr<CompositeInstruction> &in_composite) {
+  for (auto *inst : in_composite->flatView()) {
+    if (!inst->isEnabled()) {
+      continue;
+    }
+    if (inst->isComposite()) {
+      // e.g. conditionals
+      if (inst->name() == "ifstmt") {
+        return false;
+      }
+      continue;
+    }
+    if (!xacc::container::contains(supportedGates(), inst->name())) {
+      return false;
+    }
+    for (const auto &param : inst->getParameters()) {
+      if (quarterTurns(param) < 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void StabilizerAccelerator::applyInstruction(StabilizerTableau &io_tableau,
+                                             Instruction &in_inst,
+                                             std::mt19937_64 &io_rng,
+                                             std::string *io_bitString) {
+  const auto &name = in_inst.name();
+  const auto bits = in_inst.bits();
+  if (name == "H") {
+    io_tableau.h(bits[0]);
+  } else if (name == "S") {
+    io_tableau.s(bits[0]);
+  } else if (name == "Sdg") {
+    io_tableau.sdg(bits[0]);
+  } else if (name == "X") {
+    io_tableau.x(bits[0]);
+  } else if (name == "Y") {
+    io_tableau.y(bits[0]);
+  } else if (name == "Z") {
+    io_tableau.z(bits[0]);
+  } else if (name == "CNOT") {
+    io_tableau.cx(bits[0], bits[1]);
+  } else if (name == "CZ") {
+    io_tableau.cz(bits[0], bits[1]);
+  } else if (name == "CY") {
+    io_tableau.cy(bits[0], bits[1]);
+  } else if (name == "Swap") {
+    io_tableau.swap(bits[0], bits[1]);
+  } else if (name == "Rx") {
+    rx(io_tableau, bits[0], quarterTurns(in_inst.getParameter(0)));
+  } else if (name == "Ry") {
+    ry(io_tableau, bits[0], quarterTurns(in_inst.getParameter(0)));
+  } else if (name == "Rz" || name == "U1") {
+    rz(io_tableau, bits[0], quarterTurns(in_inst.getParameter(0)));
+  } else if (name == "U") {
+    // U(theta, phi, lambda) = Rz(phi) Ry(theta) Rz(lambda), up to a phase
+    rz(io_tableau, bits[0], quarterTurns(in_inst.getParameter(2)));
+    ry(io_tableau, bits[0], quarterTurns(in_inst.getParameter(0)));
+    rz(io_tableau, bits[0], quarterTurns(in_inst.getParameter(1)));
+  } else if (name == "Measure") {
+    const bool outcome = io_tableau.measure(bits[0], io_rng);
+    if (io_bitString) {
+      io_bitString->push_back(outcome ? '1' : '0');
+    }
+  } else if (name == "Reset") {
+    io_tableau.reset(bits[0], io_rng);
+  } else if (name != "I") {
+    xacc::error("Gate '" + name + "' is not supported by the stabilizer "
+                "simulator.");
+  }
+}
+
+void StabilizerAccelerator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::shared_ptr<CompositeInstruction> compositeInstruction) {
+  if (!isCliffordCircuit(compositeInstruction)) {
+    xacc::error("Circuit '" + compositeInstruction->name() +
+                "' is not a Clifford circuit.");
+  }
+  std::vector<Instruction *> program;
+  for (auto *inst : compositeInstruction->flatView()) {
+    if (inst->isEnabled() && !inst->isComposite()) {
+      program.emplace_back(inst);
+    }
+  }
+  const uint64_t seed = m_hasSeed ? m_seed : std::random_device{}();
+  StabilizerTableau initialState(buffer->size());
+
+  // Shots are split in chunks, one per thread, each with its own random
+  // engine.
+  using Sampler =
+      std::function<std::map<std::string, int>(int, std::mt19937_64 &)>;
+  const auto sampleInChunks = [&](const Sampler &in_sample) {
+    const size_t nbChunks = std::min<size_t>(
+        m_shots, std::max(1, xacc::getTaskScheduler()->getNumberOfThreads()));
+    std::vector<std::map<std::string, int>> chunkCounts(nbChunks);
+    xacc::getTaskScheduler()->parallelFor(
+        0, nbChunks, [&](size_t beginIdx, size_t endIdx) {
+          for (size_t chunk = beginIdx; chunk < endIdx; ++chunk) {
+            std::mt19937_64 rng(seed + chunk);
+            const int chunkShots = m_shots / nbChunks +
+                                   (chunk < m_shots % nbChunks ? 1 : 0);
+            chunkCounts[chunk] = in_sample(chunkShots, rng);
+          }
+        });
+    std::map<std::string, int> counts;
+    for (const auto &chunk : chunkCounts) {
+      for (const auto &[bitString, count] : chunk) {
+        counts[bitString] += count;
+      }
+    }
+    for (const auto &[bitString, count] : counts) {
+      buffer->appendMeasurement(bitString, count);
+    }
+  };
+
+  if (canSampleFromFinalState(compositeInstruction)) {
+    std::mt19937_64 rng(seed);
+    std::vector<size_t> measureBitIdxs;
+    for (auto *inst : program) {
+      if (inst->opcode() == xacc::GateOpcode::Measure) {
+        measureBitIdxs.emplace_back(inst->bits()[0]);
+      } else {
+        applyInstruction(initialState, *inst, rng, nullptr);
+      }
+    }
+    if (measureBitIdxs.empty()) {
+      return;
+    }
+    const auto distribution =
+        initialState.measurementDistribution(measureBitIdxs);
+    if (m_shots < 0) {
+      buffer->addExtraInfo("exp-val-z", distribution.expectationValueZ());
+      return;
+    }
+    sampleInChunks([&](int in_shots, std::mt19937_64 &io_rng) {
+      return distribution.sample(in_shots, io_rng);
+    });
+    return;
+  }
+
+  if (m_shots < 0) {
+    xacc::error("Mid-circuit measurements and resets require the 'shots' "
+                "parameter.");
+  }
+  // Each shot runs the whole circuit, collapsing the state.
+  sampleInChunks([&](int in_shots, std::mt19937_64 &io_rng) {
+    std::map<std::string, int> counts;
+    for (int shot = 0; shot < in_shots; ++shot) {
+      auto tableau = initialState;
+      std::string bitString;
+      for (auto *inst : program) {
+        applyInstruction(tableau, *inst, io_rng, &bitString);
+      }
+      counts[bitString]++;
+    }
+    return counts;
+  });
+}
+
+void StabilizerAccelerator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>>
+        compositeInstructions) {
+  for (auto &f : compositeInstructions) {
+    auto tmpBuffer =
+        std::make_shared<xacc::AcceleratorBuffer>(f->name(), buffer->size());
+    execute(tmpBuffer, f);
+    buffer->appendChild(f->name(), tmpBuffer);
+  }
+}
+} // namespace quantum
+} // namespace xacc
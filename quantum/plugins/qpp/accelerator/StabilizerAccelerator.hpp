@@ -0,0 +1,67 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#pragma once
+#include "xacc.hpp"
+#include "StabilizerTableau.hpp"
+
+namespace xacc {
+namespace quantum {
+// Noiseless simulation of Clifford circuits (H, S, Sdg, X, Y, Z, CNOT, CZ,
+// CY, Swap, I, and Rx/Ry/Rz/U1 by multiples of pi/2, Measure, Reset) on a
+// stabilizer tableau, i.e. polynomial in the number of qubits. Terminal
+// measurements are sampled from the final state without re-simulating the
+// circuit.
+class StabilizerAccelerator : public Accelerator {
+public:
+  // Identifiable interface impls
+  const std::string name() const override { return "stabilizer"; }
+  const std::string description() const override {
+    return "XACC Simulation Accelerator for Clifford circuits based on a "
+           "stabilizer tableau.";
+  }
+
+  // Accelerator interface impls
+  void initialize(const HeterogeneousMap &params = {}) override;
+  void updateConfiguration(const HeterogeneousMap &config) override {
+    initialize(config);
+  };
+  const std::vector<std::string> configurationKeys() override {
+    return {"shots", "seed"};
+  }
+  BitOrder getBitOrder() override { return BitOrder::LSB; }
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::shared_ptr<CompositeInstruction>
+                   compositeInstruction) override;
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::vector<std::shared_ptr<CompositeInstruction>>
+                   compositeInstructions) override;
+
+  // True if all the (enabled) instructions are supported, e.g. no
+  // conditionals or non-Clifford rotation angles.
+  static bool isCliffordCircuit(
+      const std::shared_ptr<CompositeInstruction> &in_composite);
+
+private:
+  // Applies a supported instruction, measurement results appended to
+  // io_bitString (nullptr if not recorded).
+  static void applyInstruction(StabilizerTableau &io_tableau,
+                               Instruction &in_inst,
+                               std::mt19937_64 &io_rng,
+                               std::string *io_bitString);
+  // -1: exp-val-z only
+  int m_shots = -1;
+  uint64_t m_seed;
+  bool m_hasSeed = false;
+};
+} // namespace quantum
+} // namespace xacc
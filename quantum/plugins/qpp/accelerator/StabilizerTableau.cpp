@@ -0,0 +1,411 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "StabilizerTableau.hpp"
+#include <algorithm>
+#include <cassert>
+
+namespace {
+size_t nbWordsOf(size_t in_nbBits) { return (in_nbBits + 63) / 64; }
+
+bool getBit(const uint64_t *in_words, size_t in_bit) {
+  return (in_words[in_bit / 64] >> (in_bit % 64)) & 1ULL;
+}
+
+void setBit(uint64_t *io_words, size_t in_bit) {
+  io_words[in_bit / 64] |= 1ULL << (in_bit % 64);
+}
+
+// Pauli string product P_target <- P_source * P_target (both Hermitian, i.e.
+// commuting or the phase of the target is irrelevant). The i^k phase is the
+// sum over the qubits of the CHP g function, +1/-1 terms counted word by
+// word.
+void rowMultiply(uint64_t *io_xTarget, uint64_t *io_zTarget,
+                 uint8_t &io_rTarget, const uint64_t *in_xSource,
+                 const uint64_t *in_zSource, uint8_t in_rSource,
+                 size_t in_nbWords) {
+  int64_t phase = 2 * io_rTarget + 2 * in_rSource;
+  for (size_t w = 0; w < in_nbWords; ++w) {
+    const uint64_t x1 = in_xSource[w], z1 = in_zSource[w];
+    const uint64_t x2 = io_xTarget[w], z2 = io_zTarget[w];
+    // Source Y, X or Z against the target Pauli
+    const uint64_t y1 = x1 & z1, xOnly1 = x1 & ~z1, zOnly1 = ~x1 & z1;
+    const uint64_t plus = (y1 & z2 & ~x2) | (xOnly1 & z2 & x2) |
+                          (zOnly1 & x2 & ~z2);
+    const uint64_t minus = (y1 & x2 & ~z2) | (xOnly1 & z2 & ~x2) |
+                           (zOnly1 & x2 & z2);
+    phase += __builtin_popcountll(plus);
+    phase -= __builtin_popcountll(minus);
+    io_xTarget[w] = x1 ^ x2;
+    io_zTarget[w] = z1 ^ z2;
+  }
+  phase = ((phase % 4) + 4) % 4;
+  assert(phase == 0 || phase == 2);
+  io_rTarget = phase == 2;
+}
+} // namespace
+
+namespace xacc {
+namespace quantum {
+std::map<std::string, int>
+StabilizerMeasurementDistribution::sample(int in_shots,
+                                          std::mt19937_64 &io_rng) const {
+  std::map<std::vector<uint64_t>, int> packedCounts;
+  if (m_basis.empty()) {
+    packedCounts[m_offset] = in_shots;
+  } else {
+    std::vector<uint64_t> outcome(m_offset.size());
+    for (int shot = 0; shot < in_shots; ++shot) {
+      outcome = m_offset;
+      uint64_t random = 0;
+      for (size_t k = 0; k < m_basis.size(); ++k) {
+        if (k % 64 == 0) {
+          random = io_rng();
+        }
+        if ((random >> (k % 64)) & 1ULL) {
+          const auto &vec = m_basis[k];
+          for (size_t w = 0; w < outcome.size(); ++w) {
+            outcome[w] ^= vec[w];
+          }
+        }
+      }
+      packedCounts[outcome]++;
+    }
+  }
+
+  std::map<std::string, int> counts;
+  for (const auto &[packed, count] : packedCounts) {
+    std::string bitString(m_nbBits, '0');
+    for (size_t j = 0; j < m_nbBits; ++j) {
+      if (getBit(packed.data(), j)) {
+        bitString[j] = '1';
+      }
+    }
+    counts[bitString] = count;
+  }
+  return counts;
+}
+
+double StabilizerMeasurementDistribution::expectationValueZ() const {
+  const auto parity = [](const std::vector<uint64_t> &in_vec) {
+    size_t count = 0;
+    for (const auto word : in_vec) {
+      count += __builtin_popcountll(word);
+    }
+    return count % 2;
+  };
+  for (const auto &vec : m_basis) {
+    if (parity(vec)) {
+      return 0.0;
+    }
+  }
+  return parity(m_offset) ? -1.0 : 1.0;
+}
+
+StabilizerTableau::StabilizerTableau(size_t in_nbQubits)
+    : m_nbQubits(in_nbQubits), m_nbWords(nbWordsOf(in_nbQubits)),
+      m_x((2 * in_nbQubits + 1) * m_nbWords, 0),
+      m_z((2 * in_nbQubits + 1) * m_nbWords, 0), m_r(2 * in_nbQubits + 1, 0) {
+  // Destabilizer X_i, stabilizer Z_i
+  for (size_t i = 0; i < in_nbQubits; ++i) {
+    setBit(xRow(i), i);
+    setBit(zRow(in_nbQubits + i), i);
+  }
+}
+
+void StabilizerTableau::h(size_t in_qubit) {
+  const size_t w = in_qubit / 64;
+  const uint64_t mask = 1ULL << (in_qubit % 64);
+  for (size_t row = 0; row < 2 * m_nbQubits; ++row) {
+    uint64_t &xw = m_x[row * m_nbWords + w];
+    uint64_t &zw = m_z[row * m_nbWords + w];
+    const bool xb = xw & mask, zb = zw & mask;
+    m_r[row] ^= xb & zb;
+    if (xb != zb) {
+      xw ^= mask;
+      zw ^= mask;
+    }
+  }
+}
+
+void StabilizerTableau::s(size_t in_qubit) {
+  const size_t w = in_qubit / 64;
+  const uint64_t mask = 1ULL << (in_qubit % 64);
+  for (size_t row = 0; row < 2 * m_nbQubits; ++row) {
+    const uint64_t xw = m_x[row * m_nbWords + w];
+    uint64_t &zw = m_z[row * m_nbWords + w];
+    if (xw & mask) {
+      m_r[row] ^= (zw & mask) != 0;
+      zw ^= mask;
+    }
+  }
+}
+
+void StabilizerTableau::sdg(size_t in_qubit) {
+  const size_t w = in_qubit / 64;
+  const uint64_t mask = 1ULL << (in_qubit % 64);
+  for (size_t row = 0; row < 2 * m_nbQubits; ++row) {
+    const uint64_t xw = m_x[row * m_nbWords + w];
+    uint64_t &zw = m_z[row * m_nbWords + w];
+    if (xw & mask) {
+      m_r[row] ^= (zw & mask) == 0;
+      zw ^= mask;
+    }
+  }
+}
+
+void StabilizerTableau::x(size_t in_qubit) {
+  for (size_t row = 0; row < 2 * m_nbQubits; ++row) {
+    m_r[row] ^= zBit(row, in_qubit);
+  }
+}
+
+void StabilizerTableau::y(size_t in_qubit) {
+  for (size_t row = 0; row < 2 * m_nbQubits; ++row) {
+    m_r[row] ^= xBit(row, in_qubit) ^ zBit(row, in_qubit);
+  }
+}
+
+void StabilizerTableau::z(size_t in_qubit) {
+  for (size_t row = 0; row < 2 * m_nbQubits; ++row) {
+    m_r[row] ^= xBit(row, in_qubit);
+  }
+}
+
+void StabilizerTableau::cx(size_t in_control, size_t in_target) {
+  assert(in_control != in_target);
+  const size_t wc = in_control / 64, wt = in_target / 64;
+  const uint64_t mc = 1ULL << (in_control % 64), mt = 1ULL << (in_target % 64);
+  for (size_t row = 0; row < 2 * m_nbQubits; ++row) {
+    uint64_t *xr = xRow(row);
+    uint64_t *zr = zRow(row);
+    const bool xc = xr[wc] & mc, zc = zr[wc] & mc;
+    const bool xt = xr[wt] & mt, zt = zr[wt] & mt;
+    m_r[row] ^= xc & zt & !(xt ^ zc);
+    if (xc) {
+      xr[wt] ^= mt;
+    }
+    if (zt) {
+      zr[wc] ^= mc;
+    }
+  }
+}
+
+void StabilizerTableau::cz(size_t in_qubit1, size_t in_qubit2) {
+  h(in_qubit2);
+  cx(in_qubit1, in_qubit2);
+  h(in_qubit2);
+}
+
+void StabilizerTableau::cy(size_t in_control, size_t in_target) {
+  sdg(in_target);
+  cx(in_control, in_target);
+  s(in_target);
+}
+
+void StabilizerTableau::swap(size_t in_qubit1, size_t in_qubit2) {
+  cx(in_qubit1, in_qubit2);
+  cx(in_qubit2, in_qubit1);
+  cx(in_qubit1, in_qubit2);
+}
+
+bool StabilizerTableau::measure(size_t in_qubit, std::mt19937_64 &io_rng) {
+  const size_t n = m_nbQubits;
+  size_t p = n;
+  while (p < 2 * n && !xBit(p, in_qubit)) {
+    ++p;
+  }
+
+  if (p < 2 * n) {
+    // Random outcome: the stabilizer p anti-commutes with Z (its
+    // destabilizer, the only row anti-commuting with it, is replaced).
+    for (size_t row = 0; row < 2 * n; ++row) {
+      if (row != p && row != p - n && xBit(row, in_qubit)) {
+        rowMult(row, p);
+      }
+    }
+    copyRow(p - n, p);
+    setRowToPauli(p, in_qubit, true);
+    const bool outcome = io_rng() & 1ULL;
+    m_r[p] = outcome;
+    return outcome;
+  }
+
+  // Deterministic: Z is the product of the stabilizers whose destabilizer
+  // anti-commutes with it, accumulated in the scratch row.
+  const size_t scratch = 2 * n;
+  std::fill_n(xRow(scratch), m_nbWords, 0);
+  std::fill_n(zRow(scratch), m_nbWords, 0);
+  m_r[scratch] = 0;
+  for (size_t row = 0; row < n; ++row) {
+    if (xBit(row, in_qubit)) {
+      rowMult(scratch, row + n);
+    }
+  }
+  return m_r[scratch];
+}
+
+void StabilizerTableau::reset(size_t in_qubit, std::mt19937_64 &io_rng) {
+  if (measure(in_qubit, io_rng)) {
+    x(in_qubit);
+  }
+}
+
+StabilizerMeasurementDistribution StabilizerTableau::measurementDistribution(
+    const std::vector<size_t> &in_bits) const {
+  const size_t n = m_nbQubits;
+  // Stabilizer generators, reduced so that the X parts of rows
+  // [0, xRank) are independent and the other rows are Z-only.
+  std::vector<uint64_t> xs(m_x.begin() + n * m_nbWords,
+                           m_x.begin() + 2 * n * m_nbWords);
+  std::vector<uint64_t> zs(m_z.begin() + n * m_nbWords,
+                           m_z.begin() + 2 * n * m_nbWords);
+  std::vector<uint8_t> rs(m_r.begin() + n, m_r.begin() + 2 * n);
+  const auto swapRows = [&](size_t i, size_t j) {
+    std::swap_ranges(&xs[i * m_nbWords], &xs[(i + 1) * m_nbWords],
+                     &xs[j * m_nbWords]);
+    std::swap_ranges(&zs[i * m_nbWords], &zs[(i + 1) * m_nbWords],
+                     &zs[j * m_nbWords]);
+    std::swap(rs[i], rs[j]);
+  };
+  const auto multRows = [&](size_t target, size_t source) {
+    rowMultiply(&xs[target * m_nbWords], &zs[target * m_nbWords], rs[target],
+                &xs[source * m_nbWords], &zs[source * m_nbWords], rs[source],
+                m_nbWords);
+  };
+
+  size_t xRank = 0;
+  for (size_t q = 0; q < n && xRank < n; ++q) {
+    size_t pivot = xRank;
+    while (pivot < n && !getBit(&xs[pivot * m_nbWords], q)) {
+      ++pivot;
+    }
+    if (pivot == n) {
+      continue;
+    }
+    swapRows(xRank, pivot);
+    for (size_t row = 0; row < n; ++row) {
+      if (row != xRank && getBit(&xs[row * m_nbWords], q)) {
+        multRows(row, xRank);
+      }
+    }
+    ++xRank;
+  }
+
+  // The Z-only stabilizers are the parity constraints (z . x = r) of the
+  // outcomes, in reduced row echelon form.
+  std::vector<size_t> pivotCols;
+  size_t zRank = xRank;
+  for (size_t q = 0; q < n && zRank < n; ++q) {
+    size_t pivot = zRank;
+    while (pivot < n && !getBit(&zs[pivot * m_nbWords], q)) {
+      ++pivot;
+    }
+    if (pivot == n) {
+      continue;
+    }
+    swapRows(zRank, pivot);
+    for (size_t row = xRank; row < n; ++row) {
+      if (row != zRank && getBit(&zs[row * m_nbWords], q)) {
+        multRows(row, zRank);
+      }
+    }
+    pivotCols.emplace_back(q);
+    ++zRank;
+  }
+
+  // All qubits: a particular solution (free variables at 0) and one
+  // solution of the homogeneous system per free variable, projected on the
+  // measured qubits.
+  const size_t nbBits = in_bits.size();
+  const size_t nbBitWords = nbWordsOf(nbBits);
+  const auto project = [&](const std::vector<uint8_t> &in_solution) {
+    std::vector<uint64_t> result(nbBitWords, 0);
+    for (size_t j = 0; j < nbBits; ++j) {
+      if (in_solution[in_bits[j]]) {
+        setBit(result.data(), j);
+      }
+    }
+    return result;
+  };
+  std::vector<uint8_t> isPivot(n, 0);
+  std::vector<uint8_t> solution(n, 0);
+  for (size_t k = 0; k < pivotCols.size(); ++k) {
+    isPivot[pivotCols[k]] = 1;
+    solution[pivotCols[k]] = rs[xRank + k];
+  }
+  const auto offset = project(solution);
+
+  // Independent projections only (Gaussian elimination on the fly, each
+  // kept vector with a distinct leading bit)
+  std::vector<std::vector<uint64_t>> basis;
+  std::vector<size_t> leadingBits;
+  for (size_t f = 0; f < n; ++f) {
+    if (isPivot[f]) {
+      continue;
+    }
+    std::fill(solution.begin(), solution.end(), 0);
+    solution[f] = 1;
+    for (size_t k = 0; k < pivotCols.size(); ++k) {
+      if (getBit(&zs[(xRank + k) * m_nbWords], f)) {
+        solution[pivotCols[k]] = 1;
+      }
+    }
+    auto vec = project(solution);
+    for (size_t k = 0; k < basis.size(); ++k) {
+      if (getBit(vec.data(), leadingBits[k])) {
+        for (size_t w = 0; w < nbBitWords; ++w) {
+          vec[w] ^= basis[k][w];
+        }
+      }
+    }
+    size_t lead = 0;
+    while (lead < nbBits && !getBit(vec.data(), lead)) {
+      ++lead;
+    }
+    if (lead == nbBits) {
+      continue;
+    }
+    // Keep the basis reduced at that bit as well
+    for (auto &other : basis) {
+      if (getBit(other.data(), lead)) {
+        for (size_t w = 0; w < nbBitWords; ++w) {
+          other[w] ^= vec[w];
+        }
+      }
+    }
+    basis.emplace_back(std::move(vec));
+    leadingBits.emplace_back(lead);
+  }
+  return StabilizerMeasurementDistribution(nbBits, offset, std::move(basis));
+}
+
+void StabilizerTableau::rowMult(size_t in_target, size_t in_source) {
+  rowMultiply(xRow(in_target), zRow(in_target), m_r[in_target],
+              xRow(in_source), zRow(in_source), m_r[in_source], m_nbWords);
+}
+
+void StabilizerTableau::copyRow(size_t in_target, size_t in_source) {
+  std::copy_n(xRow(in_source), m_nbWords, xRow(in_target));
+  std::copy_n(zRow(in_source), m_nbWords, zRow(in_target));
+  m_r[in_target] = m_r[in_source];
+}
+
+void StabilizerTableau::setRowToPauli(size_t in_row, size_t in_qubit,
+                                      bool in_isZ) {
+  std::fill_n(xRow(in_row), m_nbWords, 0);
+  std::fill_n(zRow(in_row), m_nbWords, 0);
+  setBit(in_isZ ? zRow(in_row) : xRow(in_row), in_qubit);
+  m_r[in_row] = 0;
+}
+} // namespace quantum
+} // namespace xacc
@@ -0,0 +1,103 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#pragma once
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace xacc {
+namespace quantum {
+// Outcome distribution of measuring some qubits of a stabilizer state in the
+// Z basis: uniform over the affine space offset + span(basis), so that a
+// shot is a few XORs of packed bit strings (bit j is the j-th measured
+// qubit).
+class StabilizerMeasurementDistribution {
+public:
+  StabilizerMeasurementDistribution(size_t in_nbBits,
+                                    std::vector<uint64_t> in_offset,
+                                    std::vector<std::vector<uint64_t>> in_basis)
+      : m_nbBits(in_nbBits), m_offset(std::move(in_offset)),
+        m_basis(std::move(in_basis)) {}
+
+  // Bit string (character j is the j-th measured qubit) -> count
+  std::map<std::string, int> sample(int in_shots,
+                                    std::mt19937_64 &io_rng) const;
+  // <Z...Z> over the measured qubits: +/-1 if the outcome parity is fixed,
+  // 0 otherwise.
+  double expectationValueZ() const;
+  // Number of random bits of an outcome (log2 of the number of outcomes)
+  size_t rank() const { return m_basis.size(); }
+
+private:
+  size_t m_nbBits;
+  std::vector<uint64_t> m_offset;
+  std::vector<std::vector<uint64_t>> m_basis;
+};
+
+// Stabilizer state of n qubits as an Aaronson-Gottesman (CHP) tableau:
+// n destabilizer then n stabilizer rows, each a Pauli string with its X and
+// Z parts packed 64 qubits per word, and a sign bit. Clifford gates update
+// one bit of each row; measurements multiply whole rows, word by word.
+class StabilizerTableau {
+public:
+  // |0...0>
+  StabilizerTableau(size_t in_nbQubits);
+
+  size_t nbQubits() const { return m_nbQubits; }
+
+  void h(size_t in_qubit);
+  void s(size_t in_qubit);
+  void sdg(size_t in_qubit);
+  void x(size_t in_qubit);
+  void y(size_t in_qubit);
+  void z(size_t in_qubit);
+  void cx(size_t in_control, size_t in_target);
+  void cz(size_t in_qubit1, size_t in_qubit2);
+  void cy(size_t in_control, size_t in_target);
+  void swap(size_t in_qubit1, size_t in_qubit2);
+
+  // Z-basis measurement (the state collapses), random outcomes drawn from
+  // io_rng.
+  bool measure(size_t in_qubit, std::mt19937_64 &io_rng);
+  // Back to |0>
+  void reset(size_t in_qubit, std::mt19937_64 &io_rng);
+  // Joint distribution of measuring in_bits, the state left unchanged.
+  StabilizerMeasurementDistribution
+  measurementDistribution(const std::vector<size_t> &in_bits) const;
+
+private:
+  uint64_t *xRow(size_t in_row) { return &m_x[in_row * m_nbWords]; }
+  uint64_t *zRow(size_t in_row) { return &m_z[in_row * m_nbWords]; }
+  bool xBit(size_t in_row, size_t in_qubit) const {
+    return (m_x[in_row * m_nbWords + in_qubit / 64] >> (in_qubit % 64)) & 1ULL;
+  }
+  bool zBit(size_t in_row, size_t in_qubit) const {
+    return (m_z[in_row * m_nbWords + in_qubit / 64] >> (in_qubit % 64)) & 1ULL;
+  }
+  // Row in_target <- row in_source * row in_target
+  void rowMult(size_t in_target, size_t in_source);
+  void copyRow(size_t in_target, size_t in_source);
+  // Row in_row <- the single qubit Pauli Z (or X), with a + sign
+  void setRowToPauli(size_t in_row, size_t in_qubit, bool in_isZ);
+
+  size_t m_nbQubits;
+  size_t m_nbWords;
+  // 2n + 1 rows, the last one being scratch space.
+  std::vector<uint64_t> m_x;
+  std::vector<uint64_t> m_z;
+  std::vector<uint8_t> m_r;
+};
+} // namespace quantum
+} // namespace xacc
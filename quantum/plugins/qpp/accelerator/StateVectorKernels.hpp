@@ -0,0 +1,142 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#pragma once
+#include <algorithm>
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// In-place state vector kernels of the common 1 and 2-qubit gates.
+// Compared to qpp::apply, which handles arbitrary matrices, dims and
+// subsystems, there is no matrix product, no index decomposition and no
+// allocation of the result vector: each kernel sweeps the amplitudes it
+// changes once, with the gate as an inlined functor, e.g. a swap for X and
+// CNOT, a phase multiplication for Z, S, T, Rz and CPhase.
+// Qubit q is the bit q of the amplitude index (XACC convention).
+namespace xacc {
+namespace quantum {
+namespace kernels {
+using Amplitude = std::complex<double>;
+
+// Parallelize the sweeps of (sub)vectors of at least that many amplitudes
+constexpr int64_t ParallelThreshold = int64_t(1) << 14;
+
+// The k-th index with zeros at the given (ascending) bit positions
+template <std::size_t N>
+inline uint64_t insertZeroBits(uint64_t in_k, const std::array<std::size_t, N>& in_sortedBits)
+{
+    for (const auto bit : in_sortedBits)
+    {
+        const uint64_t lowMask = (uint64_t(1) << bit) - 1;
+        in_k = ((in_k & ~lowMask) << 1) | (in_k & lowMask);
+    }
+    return in_k;
+}
+
+// Calls in_op(a0, a1) on the amplitudes pairs whose indices only differ by
+// the target bit (0 in a0, 1 in a1) and have the control bit (if any) set.
+template <bool Controlled, typename PairOp>
+inline void forEachPair(Amplitude* io_state, uint64_t in_size, std::size_t in_target, std::size_t in_ctrl, PairOp in_op)
+{
+    const uint64_t targetMask = uint64_t(1) << in_target;
+    std::array<std::size_t, Controlled ? 2 : 1> sortedBits;
+    uint64_t baseMask = 0;
+    if constexpr (Controlled)
+    {
+        sortedBits = { std::min(in_target, in_ctrl), std::max(in_target, in_ctrl) };
+        baseMask = uint64_t(1) << in_ctrl;
+    }
+    else
+    {
+        sortedBits = { in_target };
+    }
+    const int64_t nbPairs = in_size >> sortedBits.size();
+#ifdef WITH_OPENMP_
+#pragma omp parallel for if (nbPairs >= ParallelThreshold)
+#endif
+    for (int64_t k = 0; k < nbPairs; ++k)
+    {
+        const uint64_t i0 = insertZeroBits(k, sortedBits) | baseMask;
+        in_op(io_state[i0], io_state[i0 | targetMask]);
+    }
+}
+
+// Dense 1-qubit gate (row major matrix), optionally controlled
+template <bool Controlled>
+inline void applyMatrix(Amplitude* io_state, uint64_t in_size, std::size_t in_target, std::size_t in_ctrl, const std::array<Amplitude, 4>& in_mat)
+{
+    const auto m00 = in_mat[0], m01 = in_mat[1], m10 = in_mat[2], m11 = in_mat[3];
+    forEachPair<Controlled>(io_state, in_size, in_target, in_ctrl, [=](Amplitude& a0, Amplitude& a1) {
+        const auto b0 = a0;
+        a0 = m00 * b0 + m01 * a1;
+        a1 = m10 * b0 + m11 * a1;
+    });
+}
+
+// Diagonal 1-qubit gate diag(in_d0, in_d1), optionally controlled
+template <bool Controlled>
+inline void applyDiagonal(Amplitude* io_state, uint64_t in_size, std::size_t in_target, std::size_t in_ctrl, Amplitude in_d0, Amplitude in_d1)
+{
+    forEachPair<Controlled>(io_state, in_size, in_target, in_ctrl, [=](Amplitude& a0, Amplitude& a1) {
+        a0 *= in_d0;
+        a1 *= in_d1;
+    });
+}
+
+// diag(1, in_phase), optionally controlled: the |0> amplitudes are not touched.
+template <bool Controlled>
+inline void applyPhase(Amplitude* io_state, uint64_t in_size, std::size_t in_target, std::size_t in_ctrl, Amplitude in_phase)
+{
+    forEachPair<Controlled>(io_state, in_size, in_target, in_ctrl, [=](Amplitude&, Amplitude& a1) { a1 *= in_phase; });
+}
+
+// X (CNOT if controlled)
+template <bool Controlled>
+inline void applyX(Amplitude* io_state, uint64_t in_size, std::size_t in_target, std::size_t in_ctrl)
+{
+    forEachPair<Controlled>(io_state, in_size, in_target, in_ctrl, [](Amplitude& a0, Amplitude& a1) { std::swap(a0, a1); });
+}
+
+// Y (CY if controlled)
+template <bool Controlled>
+inline void applyY(Amplitude* io_state, uint64_t in_size, std::size_t in_target, std::size_t in_ctrl)
+{
+    forEachPair<Controlled>(io_state, in_size, in_target, in_ctrl, [](Amplitude& a0, Amplitude& a1) {
+        const auto b0 = a0;
+        // (a0, a1) <- (-i a1, i a0)
+        a0 = Amplitude(a1.imag(), -a1.real());
+        a1 = Amplitude(-b0.imag(), b0.real());
+    });
+}
+
+// Swap of the qubits in_q1 and in_q2 (different)
+inline void applySwap(Amplitude* io_state, uint64_t in_size, std::size_t in_q1, std::size_t in_q2)
+{
+    const std::array<std::size_t, 2> sortedBits { std::min(in_q1, in_q2), std::max(in_q1, in_q2) };
+    const uint64_t mask1 = uint64_t(1) << in_q1;
+    const uint64_t mask2 = uint64_t(1) << in_q2;
+    const int64_t nbQuads = in_size >> 2;
+#ifdef WITH_OPENMP_
+#pragma omp parallel for if (nbQuads >= ParallelThreshold)
+#endif
+    for (int64_t k = 0; k < nbQuads; ++k)
+    {
+        const uint64_t i00 = insertZeroBits(k, sortedBits);
+        std::swap(io_state[i00 | mask1], io_state[i00 | mask2]);
+    }
+}
+} // namespace kernels
+} // namespace quantum
+} // namespace xacc
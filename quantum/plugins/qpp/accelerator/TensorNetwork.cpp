@@ -0,0 +1,335 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "TensorNetwork.hpp"
+#include "xacc.hpp"
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+using Amplitude = xacc::quantum::TensorNetwork::Amplitude;
+using RowMajorMatrix =
+    Eigen::Matrix<Amplitude, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+// Slices are assignments of a 64-bit word.
+constexpr size_t MAX_SLICED_LEGS = 40;
+
+struct Tensor {
+  std::vector<int> legs;
+  std::vector<Amplitude> data;
+};
+
+// Legs of the contraction of two tensors (shared legs are summed over)
+std::vector<int> contractedLegs(const std::vector<int> &in_legs1,
+                                const std::vector<int> &in_legs2) {
+  std::vector<int> result;
+  for (const auto leg : in_legs1) {
+    if (std::find(in_legs2.begin(), in_legs2.end(), leg) == in_legs2.end()) {
+      result.emplace_back(leg);
+    }
+  }
+  for (const auto leg : in_legs2) {
+    if (std::find(in_legs1.begin(), in_legs1.end(), leg) == in_legs1.end()) {
+      result.emplace_back(leg);
+    }
+  }
+  return result;
+}
+
+size_t nbUnslicedLegs(const std::vector<int> &in_legs,
+                      const std::unordered_set<int> &in_slicedLegs) {
+  size_t count = 0;
+  for (const auto leg : in_legs) {
+    count += in_slicedLegs.count(leg) == 0;
+  }
+  return count;
+}
+
+// Data of in_tensor with its legs in the in_legs order
+std::vector<Amplitude> permute(const Tensor &in_tensor,
+                               const std::vector<int> &in_legs) {
+  if (in_legs == in_tensor.legs) {
+    return in_tensor.data;
+  }
+  const size_t rank = in_legs.size();
+  std::vector<uint64_t> strides(rank);
+  for (size_t k = 0; k < rank; ++k) {
+    const auto pos = std::distance(
+        in_tensor.legs.begin(),
+        std::find(in_tensor.legs.begin(), in_tensor.legs.end(), in_legs[k]));
+    strides[k] = 1ULL << (rank - 1 - pos);
+  }
+  std::vector<Amplitude> result(in_tensor.data.size());
+  for (uint64_t i = 0; i < result.size(); ++i) {
+    uint64_t source = 0;
+    for (size_t k = 0; k < rank; ++k) {
+      if ((i >> (rank - 1 - k)) & 1ULL) {
+        source += strides[k];
+      }
+    }
+    result[i] = in_tensor.data[source];
+  }
+  return result;
+}
+
+// Fixes the sliced legs of in_tensor to their value in in_assignment
+// (bit k for in_slicedLegs[k]).
+Tensor slice(const std::vector<int> &in_legs,
+             const std::vector<Amplitude> &in_data,
+             const std::vector<int> &in_slicedLegs, uint64_t in_assignment) {
+  Tensor result;
+  const size_t rank = in_legs.size();
+  uint64_t fixedBits = 0;
+  std::vector<uint64_t> freeStrides;
+  for (size_t pos = 0; pos < rank; ++pos) {
+    const auto iter =
+        std::find(in_slicedLegs.begin(), in_slicedLegs.end(), in_legs[pos]);
+    const uint64_t stride = 1ULL << (rank - 1 - pos);
+    if (iter == in_slicedLegs.end()) {
+      result.legs.emplace_back(in_legs[pos]);
+      freeStrides.emplace_back(stride);
+    } else if ((in_assignment >> std::distance(in_slicedLegs.begin(), iter)) &
+               1ULL) {
+      fixedBits += stride;
+    }
+  }
+  if (result.legs.size() == rank) {
+    result.data = in_data;
+    return result;
+  }
+  const size_t freeRank = freeStrides.size();
+  result.data.resize(1ULL << freeRank);
+  for (uint64_t i = 0; i < result.data.size(); ++i) {
+    uint64_t source = fixedBits;
+    for (size_t k = 0; k < freeRank; ++k) {
+      if ((i >> (freeRank - 1 - k)) & 1ULL) {
+        source += freeStrides[k];
+      }
+    }
+    result.data[i] = in_data[source];
+  }
+  return result;
+}
+
+// Sum over the shared legs as a (free1 x shared) * (shared x free2) matrix
+// product.
+Tensor contractPair(const Tensor &in_tensor1, const Tensor &in_tensor2) {
+  std::vector<int> shared, free1, free2;
+  for (const auto leg : in_tensor1.legs) {
+    if (std::find(in_tensor2.legs.begin(), in_tensor2.legs.end(), leg) !=
+        in_tensor2.legs.end()) {
+      shared.emplace_back(leg);
+    } else {
+      free1.emplace_back(leg);
+    }
+  }
+  for (const auto leg : in_tensor2.legs) {
+    if (std::find(shared.begin(), shared.end(), leg) == shared.end()) {
+      free2.emplace_back(leg);
+    }
+  }
+
+  auto legs1 = free1;
+  legs1.insert(legs1.end(), shared.begin(), shared.end());
+  auto legs2 = shared;
+  legs2.insert(legs2.end(), free2.begin(), free2.end());
+  const auto data1 = permute(in_tensor1, legs1);
+  const auto data2 = permute(in_tensor2, legs2);
+
+  Tensor result;
+  result.legs = free1;
+  result.legs.insert(result.legs.end(), free2.begin(), free2.end());
+  result.data.resize(1ULL << result.legs.size());
+  const Eigen::Index rows = 1LL << free1.size();
+  const Eigen::Index inner = 1LL << shared.size();
+  const Eigen::Index cols = 1LL << free2.size();
+  Eigen::Map<RowMajorMatrix>(result.data.data(), rows, cols).noalias() =
+      Eigen::Map<const RowMajorMatrix>(data1.data(), rows, inner) *
+      Eigen::Map<const RowMajorMatrix>(data2.data(), inner, cols);
+  return result;
+}
+} // namespace
+
+namespace xacc {
+namespace quantum {
+size_t TensorNetwork::addTensor(std::vector<int> in_legs,
+                                std::vector<Amplitude> in_data) {
+  assert(in_data.size() == (1ULL << in_legs.size()));
+  m_legs.emplace_back(std::move(in_legs));
+  m_data.emplace_back(std::move(in_data));
+  return m_legs.size() - 1;
+}
+
+TensorNetwork::ContractionPlan
+TensorNetwork::findPlan(size_t in_maxLog2Size) const {
+  ContractionPlan plan;
+  // Legs of the inputs then of the intermediate tensors (by index)
+  std::vector<std::vector<int>> legs(m_legs);
+  std::vector<bool> alive(legs.size(), true);
+  std::unordered_map<int, std::vector<size_t>> owners;
+  for (size_t i = 0; i < legs.size(); ++i) {
+    for (const auto leg : legs[i]) {
+      owners[leg].emplace_back(i);
+    }
+  }
+  for (const auto &[leg, tensors] : owners) {
+    if (tensors.size() != 2) {
+      xacc::error("Tensor network leg " + std::to_string(leg) + " is on " +
+                  std::to_string(tensors.size()) + " tensors.");
+    }
+  }
+
+  size_t nbAlive = legs.size();
+  while (nbAlive > 1) {
+    std::pair<size_t, size_t> best;
+    double bestScore = 0.0;
+    size_t bestRank = 0;
+    bool found = false;
+    for (const auto &[leg, tensors] : owners) {
+      const auto result = contractedLegs(legs[tensors[0]], legs[tensors[1]]);
+      const double score = std::ldexp(1.0, result.size()) -
+                           std::ldexp(1.0, legs[tensors[0]].size()) -
+                           std::ldexp(1.0, legs[tensors[1]].size());
+      if (!found || score < bestScore ||
+          (score == bestScore && result.size() < bestRank)) {
+        best = {tensors[0], tensors[1]};
+        bestScore = score;
+        bestRank = result.size();
+        found = true;
+      }
+    }
+    if (!found) {
+      // Disconnected parts, all contracted to scalars by now
+      std::vector<size_t> remaining;
+      for (size_t i = 0; i < legs.size() && remaining.size() < 2; ++i) {
+        if (alive[i]) {
+          remaining.emplace_back(i);
+        }
+      }
+      best = {remaining[0], remaining[1]};
+    }
+
+    const size_t newIdx = legs.size();
+    legs.emplace_back(contractedLegs(legs[best.first], legs[best.second]));
+    for (const auto idx : {best.first, best.second}) {
+      for (const auto leg : legs[idx]) {
+        auto &legOwners = owners[leg];
+        legOwners.erase(std::remove(legOwners.begin(), legOwners.end(), idx),
+                        legOwners.end());
+      }
+      alive[idx] = false;
+    }
+    for (const auto leg : legs[newIdx]) {
+      owners[leg].emplace_back(newIdx);
+    }
+    for (auto iter = owners.begin(); iter != owners.end();) {
+      iter = iter->second.empty() ? owners.erase(iter) : std::next(iter);
+    }
+    alive.emplace_back(true);
+    plan.steps.emplace_back(best);
+    --nbAlive;
+  }
+
+  // Slice the leg on the most oversized tensors until none is left.
+  std::unordered_set<int> sliced;
+  const auto maxSize = [&]() {
+    size_t result = 0;
+    for (const auto &tensorLegs : legs) {
+      result = std::max(result, nbUnslicedLegs(tensorLegs, sliced));
+    }
+    return result;
+  };
+  while (maxSize() > in_maxLog2Size) {
+    std::unordered_map<int, size_t> counts;
+    for (const auto &tensorLegs : legs) {
+      if (nbUnslicedLegs(tensorLegs, sliced) > in_maxLog2Size) {
+        for (const auto leg : tensorLegs) {
+          if (!sliced.count(leg)) {
+            counts[leg]++;
+          }
+        }
+      }
+    }
+    const auto leg =
+        std::max_element(counts.begin(), counts.end(),
+                         [](const auto &a, const auto &b) {
+                           return a.second < b.second ||
+                                  (a.second == b.second && a.first > b.first);
+                         })
+            ->first;
+    sliced.emplace(leg);
+    plan.slicedLegs.emplace_back(leg);
+    if (sliced.size() > MAX_SLICED_LEGS) {
+      xacc::error("The tensor network cannot be contracted with tensors of "
+                  "at most 2^" +
+                  std::to_string(in_maxLog2Size) + " elements.");
+    }
+  }
+  plan.maxLog2Size = maxSize();
+
+  double flops = 0.0;
+  for (const auto &[idx1, idx2] : plan.steps) {
+    auto allLegs = legs[idx1];
+    allLegs.insert(allLegs.end(), legs[idx2].begin(), legs[idx2].end());
+    std::sort(allLegs.begin(), allLegs.end());
+    allLegs.erase(std::unique(allLegs.begin(), allLegs.end()), allLegs.end());
+    flops += std::ldexp(1.0, nbUnslicedLegs(allLegs, sliced));
+  }
+  plan.log2Flops =
+      flops > 0.0 ? std::log2(flops) + plan.slicedLegs.size() : 0.0;
+  return plan;
+}
+
+TensorNetwork::Amplitude
+TensorNetwork::contract(const ContractionPlan &in_plan) const {
+  if (m_legs.empty()) {
+    return 1.0;
+  }
+  const auto contractSlice = [&](uint64_t in_assignment) {
+    std::vector<Tensor> tensors;
+    tensors.reserve(m_legs.size() + in_plan.steps.size());
+    for (size_t i = 0; i < m_legs.size(); ++i) {
+      tensors.emplace_back(
+          slice(m_legs[i], m_data[i], in_plan.slicedLegs, in_assignment));
+    }
+    for (const auto &[idx1, idx2] : in_plan.steps) {
+      tensors.emplace_back(contractPair(tensors[idx1], tensors[idx2]));
+      // Not needed anymore
+      tensors[idx1].data = {};
+      tensors[idx2].data = {};
+    }
+    assert(tensors.back().legs.empty());
+    return tensors.back().data[0];
+  };
+
+  const uint64_t nbSlices = 1ULL << in_plan.slicedLegs.size();
+  if (nbSlices == 1) {
+    return contractSlice(0);
+  }
+  std::vector<Amplitude> sliceValues(nbSlices);
+  xacc::getTaskScheduler()->parallelFor(
+      0, nbSlices, [&](size_t beginIdx, size_t endIdx) {
+        for (size_t i = beginIdx; i < endIdx; ++i) {
+          sliceValues[i] = contractSlice(i);
+        }
+      });
+  Amplitude result = 0.0;
+  for (const auto &value : sliceValues) {
+    result += value;
+  }
+  return result;
+}
+} // namespace quantum
+} // namespace xacc
@@ -0,0 +1,61 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#pragma once
+#include <complex>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace xacc {
+namespace quantum {
+// A closed network of qubit tensors (all legs of dimension 2, each leg
+// shared by exactly two tensors), contracted pairwise to a scalar.
+// The data of a tensor is row-major over its legs, i.e. the first leg is
+// the most significant bit of the element index.
+class TensorNetwork {
+public:
+  using Amplitude = std::complex<double>;
+
+  // Sequence of pairwise contractions, the result of step i being tensor
+  // nbTensors() + i, and the legs summed over outside of the contraction
+  // (one contraction per assignment of their values) so that no tensor
+  // exceeds the memory bound.
+  struct ContractionPlan {
+    std::vector<std::pair<size_t, size_t>> steps;
+    std::vector<int> slicedLegs;
+    // log2 of the number of elements of the largest (sliced) tensor
+    size_t maxLog2Size = 0;
+    // log2 of the number of multiply-adds over all the slices
+    double log2Flops = 0.0;
+  };
+
+  // Returns the tensor index.
+  size_t addTensor(std::vector<int> in_legs, std::vector<Amplitude> in_data);
+  size_t nbTensors() const { return m_legs.size(); }
+
+  // Greedy path: the pair of connected tensors whose contraction reduces
+  // the total size the most goes first. Legs are then sliced until the
+  // largest tensor has at most 2^in_maxLog2Size elements.
+  // Only depends on the legs, so it can be reused by any network with the
+  // same structure.
+  ContractionPlan findPlan(size_t in_maxLog2Size) const;
+  // The contracted value, slices in parallel on the task scheduler, each
+  // pairwise contraction as a matrix product (Eigen).
+  Amplitude contract(const ContractionPlan &in_plan) const;
+
+private:
+  std::vector<std::vector<int>> m_legs;
+  std::vector<std::vector<Amplitude>> m_data;
+};
+} // namespace quantum
+} // namespace xacc
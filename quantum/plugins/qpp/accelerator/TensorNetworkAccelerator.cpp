@@ -0,0 +1,234 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "TensorNetworkAccelerator.hpp"
+#include "Circuit.hpp"
+#include "GateFusion.hpp"
+#include "StructuralHasher.hpp"
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <set>
+#include <unordered_set>
+
+namespace {
+using Amplitude = xacc::quantum::TensorNetwork::Amplitude;
+// Gates that the GateFuser can compute the matrix of.
+const std::unordered_set<std::string> SUPPORTED_GATES{
+    "H", "CNOT", "Rx",  "Ry", "Rz",  "X",   "Y",      "Z",  "CY", "CZ",
+    "Swap", "CRZ", "CH", "S", "Sdg", "T", "Tdg", "CPhase", "I", "U"};
+// Bound on the number of cached plans (cleared when reached).
+constexpr size_t MAX_CACHED_PLANS = 1024;
+
+// The gate matrix as a tensor with legs [out_{k-1}, ..., out_0, in_{k-1},
+// ..., in_0], i.e. row-major M(out, in), bit q of out/in being gate qubit q.
+void addGateTensor(xacc::quantum::TensorNetwork &io_network,
+                   xacc::Instruction &in_gate,
+                   const std::vector<int> &in_inLegs,
+                   const std::vector<int> &in_outLegs, bool in_conjugate) {
+  const size_t nbBits = in_inLegs.size();
+  std::vector<size_t> localBits(nbBits);
+  std::iota(localBits.begin(), localBits.end(), 0);
+  auto localGate = in_gate.clone();
+  localGate->setBits(localBits);
+  auto block = std::make_shared<xacc::quantum::Circuit>("gate");
+  block->addInstruction(localGate);
+  GateFuser fuser;
+  fuser.initialize(block);
+  const auto matrix = fuser.calcFusedGate(nbBits);
+
+  std::vector<int> legs(in_outLegs.rbegin(), in_outLegs.rend());
+  legs.insert(legs.end(), in_inLegs.rbegin(), in_inLegs.rend());
+  const size_t dim = 1ULL << nbBits;
+  std::vector<Amplitude> data(dim * dim);
+  for (size_t row = 0; row < dim; ++row) {
+    for (size_t col = 0; col < dim; ++col) {
+      data[row * dim + col] =
+          in_conjugate ? std::conj(matrix(row, col)) : matrix(row, col);
+    }
+  }
+  io_network.addTensor(std::move(legs), std::move(data));
+}
+
+// Adds U|0...0> on in_qubits (or its conjugate), returns the output leg of
+// each qubit.
+std::map<size_t, int>
+addCircuit(xacc::quantum::TensorNetwork &io_network,
+           const std::vector<xacc::Instruction *> &in_gates,
+           const std::set<size_t> &in_qubits, int &io_nextLeg,
+           bool in_conjugate) {
+  std::map<size_t, int> currentLegs;
+  for (const auto qubit : in_qubits) {
+    currentLegs[qubit] = io_nextLeg++;
+    io_network.addTensor({currentLegs[qubit]}, {1.0, 0.0});
+  }
+  for (auto *gate : in_gates) {
+    std::vector<int> inLegs, outLegs;
+    for (const auto bit : gate->bits()) {
+      inLegs.emplace_back(currentLegs[bit]);
+      outLegs.emplace_back(io_nextLeg++);
+      currentLegs[bit] = outLegs.back();
+    }
+    addGateTensor(io_network, *gate, inLegs, outLegs, in_conjugate);
+  }
+  return currentLegs;
+}
+} // namespace
+
+namespace xacc {
+namespace quantum {
+void TensorNetworkAccelerator::initialize(const HeterogeneousMap &params) {
+  if (params.keyExists<int>("shots") && params.get<int>("shots") > 0) {
+    xacc::error("The tensor network simulator does not support sampling "
+                "(shots), only amplitudes and exp-val-z.");
+  }
+  m_bitString.clear();
+  if (params.keyExists<std::vector<int>>("bitstring")) {
+    m_bitString = params.get<std::vector<int>>("bitstring");
+  }
+  m_maxLog2Size = 26;
+  if (params.keyExists<int>("max-tensor-size")) {
+    const int maxLog2Size = params.get<int>("max-tensor-size");
+    if (maxLog2Size < 1) {
+      xacc::error("Invalid 'max-tensor-size' parameter.");
+    }
+    m_maxLog2Size = maxLog2Size;
+  }
+}
+
+TensorNetwork::ContractionPlan
+TensorNetworkAccelerator::getPlan(uint64_t in_key,
+                                  const TensorNetwork &in_network) {
+  {
+    std::lock_guard<std::mutex> lock(m_planCacheMutex);
+    const auto iter = m_planCache.find(in_key);
+    if (iter != m_planCache.end()) {
+      return iter->second;
+    }
+  }
+  auto plan = in_network.findPlan(m_maxLog2Size);
+  std::lock_guard<std::mutex> lock(m_planCacheMutex);
+  if (m_planCache.size() >= MAX_CACHED_PLANS) {
+    m_planCache.clear();
+  }
+  m_planCache.emplace(in_key, plan);
+  return plan;
+}
+
+void TensorNetworkAccelerator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::shared_ptr<CompositeInstruction> compositeInstruction) {
+  const size_t nbQubits = buffer->size();
+  std::vector<Instruction *> gates;
+  std::vector<size_t> measureBitIdxs;
+  std::set<size_t> measured;
+  for (auto *inst : compositeInstruction->flatView()) {
+    if (!inst->isEnabled()) {
+      continue;
+    }
+    if (inst->isComposite()) {
+      if (inst->name() == "ifstmt") {
+        xacc::error("Conditionals are not supported by the tensor network "
+                    "simulator.");
+      }
+      continue;
+    }
+    if (inst->opcode() == xacc::GateOpcode::Measure) {
+      measureBitIdxs.emplace_back(inst->bits()[0]);
+      measured.emplace(inst->bits()[0]);
+      continue;
+    }
+    if (SUPPORTED_GATES.count(inst->name()) == 0) {
+      xacc::error("Gate '" + inst->name() +
+                  "' is not supported by the tensor network simulator.");
+    }
+    for (const auto bit : inst->bits()) {
+      if (measured.count(bit)) {
+        xacc::error("Mid-circuit measurements are not supported by the "
+                    "tensor network simulator.");
+      }
+    }
+    if (inst->opcode() != xacc::GateOpcode::I) {
+      gates.emplace_back(inst);
+    }
+  }
+
+  const bool isAmplitude = !m_bitString.empty();
+  StructuralHasher hasher;
+  hasher.add<uint64_t>(
+      compositeInstruction->structuralHash(ParameterHashMode::Symbolic));
+  hasher.add<uint64_t>(nbQubits);
+  hasher.add<uint8_t>(isAmplitude);
+  hasher.add<uint64_t>(m_maxLog2Size);
+
+  TensorNetwork network;
+  int nextLeg = 0;
+  if (isAmplitude) {
+    if (m_bitString.size() != nbQubits) {
+      xacc::error("The 'bitstring' parameter must have one value per qubit.");
+    }
+    std::set<size_t> qubits;
+    for (size_t qubit = 0; qubit < nbQubits; ++qubit) {
+      qubits.emplace(qubit);
+    }
+    const auto outLegs = addCircuit(network, gates, qubits, nextLeg, false);
+    for (const auto &[qubit, leg] : outLegs) {
+      network.addTensor({leg}, m_bitString[qubit] ? std::vector<Amplitude>{0.0, 1.0}
+                                                  : std::vector<Amplitude>{1.0, 0.0});
+    }
+    const auto amplitude = network.contract(getPlan(hasher.value(), network));
+    buffer->addExtraInfo("amplitude-real", amplitude.real());
+    buffer->addExtraInfo("amplitude-imag", amplitude.imag());
+    return;
+  }
+
+  if (measureBitIdxs.empty()) {
+    return;
+  }
+  // Gates outside of the (backward) light cone of the measured qubits
+  // cancel out in <psi|Z...Z|psi>.
+  std::set<size_t> lightCone(measured);
+  std::vector<Instruction *> coneGates;
+  for (auto iter = gates.rbegin(); iter != gates.rend(); ++iter) {
+    const auto bits = (*iter)->bits();
+    if (std::any_of(bits.begin(), bits.end(),
+                    [&](size_t bit) { return lightCone.count(bit) > 0; })) {
+      lightCone.insert(bits.begin(), bits.end());
+      coneGates.emplace_back(*iter);
+    }
+  }
+  std::reverse(coneGates.begin(), coneGates.end());
+
+  const auto ketLegs = addCircuit(network, coneGates, lightCone, nextLeg, false);
+  const auto braLegs = addCircuit(network, coneGates, lightCone, nextLeg, true);
+  for (const auto qubit : lightCone) {
+    network.addTensor({ketLegs.at(qubit), braLegs.at(qubit)},
+                      measured.count(qubit) ? std::vector<Amplitude>{1.0, 0.0, 0.0, -1.0}
+                                            : std::vector<Amplitude>{1.0, 0.0, 0.0, 1.0});
+  }
+  const auto expectation = network.contract(getPlan(hasher.value(), network));
+  buffer->addExtraInfo("exp-val-z", expectation.real());
+}
+
+void TensorNetworkAccelerator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>>
+        compositeInstructions) {
+  for (auto &f : compositeInstructions) {
+    auto tmpBuffer =
+        std::make_shared<xacc::AcceleratorBuffer>(f->name(), buffer->size());
+    execute(tmpBuffer, f);
+    buffer->appendChild(f->name(), tmpBuffer);
+  }
+}
+} // namespace quantum
+} // namespace xacc
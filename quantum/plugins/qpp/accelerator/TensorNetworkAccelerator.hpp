@@ -0,0 +1,64 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#pragma once
+#include "xacc.hpp"
+#include "TensorNetwork.hpp"
+#include <mutex>
+#include <unordered_map>
+
+namespace xacc {
+namespace quantum {
+// Noiseless simulation of a circuit as a network of gate tensors, contracted
+// to a single value rather than storing the state vector:
+//  - "bitstring" (vector<int>, one value per qubit): the amplitude
+//    <bitstring|U|0...0> ("amplitude-real" and "amplitude-imag");
+//  - otherwise, "exp-val-z" of the measured qubits, from the <psi|Z...Z|psi>
+//    network restricted to the gates in the light cone of the measurements.
+// Contraction plans are cached by circuit structure (angles excluded), e.g.
+// for variational algorithms.
+class TensorNetworkAccelerator : public Accelerator {
+public:
+  // Identifiable interface impls
+  const std::string name() const override { return "tensor-network"; }
+  const std::string description() const override {
+    return "XACC Simulation Accelerator based on tensor network contraction.";
+  }
+
+  // Accelerator interface impls
+  void initialize(const HeterogeneousMap &params = {}) override;
+  void updateConfiguration(const HeterogeneousMap &config) override {
+    initialize(config);
+  };
+  const std::vector<std::string> configurationKeys() override {
+    return {"bitstring", "max-tensor-size"};
+  }
+  BitOrder getBitOrder() override { return BitOrder::LSB; }
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::shared_ptr<CompositeInstruction>
+                   compositeInstruction) override;
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::vector<std::shared_ptr<CompositeInstruction>>
+                   compositeInstructions) override;
+
+private:
+  TensorNetwork::ContractionPlan getPlan(uint64_t in_key,
+                                         const TensorNetwork &in_network);
+
+  std::vector<int> m_bitString;
+  // log2 of the max number of elements of a tensor (then sliced)
+  size_t m_maxLog2Size = 26;
+  std::mutex m_planCacheMutex;
+  std::unordered_map<uint64_t, TensorNetwork::ContractionPlan> m_planCache;
+};
+} // namespace quantum
+} // namespace xacc
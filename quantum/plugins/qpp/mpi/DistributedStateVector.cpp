@@ -0,0 +1,226 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "DistributedStateVector.hpp"
+#include <algorithm>
+
+namespace {
+// Max number of amplitudes per MPI message (16 MB)
+constexpr uint64_t EXCHANGE_CHUNK_SIZE = 1ULL << 20;
+} // namespace
+
+namespace xacc {
+namespace quantum {
+DistributedStateVector::DistributedStateVector(size_t in_nbQubits,
+                                               MPI_Comm in_comm)
+    : m_nbQubits(in_nbQubits), m_comm(in_comm) {
+  int commSize;
+  MPI_Comm_rank(m_comm, &m_rank);
+  MPI_Comm_size(m_comm, &commSize);
+  // Largest power of 2 that fits the communicator, keeping at least one local
+  // qubit per rank.
+  size_t nbGlobalQubits = 0;
+  while ((2 << nbGlobalQubits) <= commSize && nbGlobalQubits + 1 < m_nbQubits) {
+    ++nbGlobalQubits;
+  }
+  m_nbActiveRanks = 1 << nbGlobalQubits;
+  m_nbLocalQubits = m_nbQubits - nbGlobalQubits;
+  if (isActive()) {
+    m_localState.resize(1ULL << m_nbLocalQubits);
+    if (nbGlobalQubits > 0) {
+      m_exchangeBuffer.resize(
+          std::min<uint64_t>(m_localState.size(), EXCHANGE_CHUNK_SIZE));
+    }
+  }
+  initialize();
+}
+
+void DistributedStateVector::initialize() {
+  std::fill(m_localState.begin(), m_localState.end(), 0.0);
+  if (m_rank == 0 && !m_localState.empty()) {
+    m_localState[0] = 1.0;
+  }
+}
+
+void DistributedStateVector::applyGate(const Matrix2 &in_mat,
+                                       size_t in_target) {
+  if (!isLocal(in_target)) {
+    applyGlobalGate(in_mat, in_target, [](uint64_t) { return true; });
+    return;
+  }
+  const uint64_t stride = 1ULL << in_target;
+  const uint64_t size = m_localState.size();
+  for (uint64_t base = 0; base < size; base += 2 * stride) {
+    for (uint64_t i = base; i < base + stride; ++i) {
+      const auto a0 = m_localState[i];
+      const auto a1 = m_localState[i + stride];
+      m_localState[i] = in_mat[0] * a0 + in_mat[1] * a1;
+      m_localState[i + stride] = in_mat[2] * a0 + in_mat[3] * a1;
+    }
+  }
+}
+
+void DistributedStateVector::applyControlledGate(const Matrix2 &in_mat,
+                                                 size_t in_control,
+                                                 size_t in_target) {
+  if (!isActive()) {
+    return;
+  }
+  if (!isLocal(in_control)) {
+    // The control bit is the same for the whole block (and for the partner
+    // block of a global target, which only differs at the target bit).
+    if ((offset() >> in_control) & 1ULL) {
+      applyGate(in_mat, in_target);
+    }
+    return;
+  }
+
+  const auto controlOn = [in_control](uint64_t in_idx) {
+    return (in_idx >> in_control) & 1ULL;
+  };
+  if (!isLocal(in_target)) {
+    applyGlobalGate(in_mat, in_target, controlOn);
+    return;
+  }
+  const uint64_t stride = 1ULL << in_target;
+  const uint64_t size = m_localState.size();
+  for (uint64_t base = 0; base < size; base += 2 * stride) {
+    for (uint64_t i = base; i < base + stride; ++i) {
+      if (controlOn(i)) {
+        const auto a0 = m_localState[i];
+        const auto a1 = m_localState[i + stride];
+        m_localState[i] = in_mat[0] * a0 + in_mat[1] * a1;
+        m_localState[i + stride] = in_mat[2] * a0 + in_mat[3] * a1;
+      }
+    }
+  }
+}
+
+template <typename FilterT>
+void DistributedStateVector::applyGlobalGate(const Matrix2 &in_mat,
+                                             size_t in_target,
+                                             FilterT &&in_filter) {
+  if (!isActive()) {
+    return;
+  }
+  const int partner = partnerRank(in_target);
+  const bool isUpperHalf = (offset() >> in_target) & 1ULL;
+  // Coefficients of (mine, theirs) for the new local amplitude
+  const auto cMine = isUpperHalf ? in_mat[3] : in_mat[0];
+  const auto cTheirs = isUpperHalf ? in_mat[2] : in_mat[1];
+  const uint64_t size = m_localState.size();
+  // Both ranks exchange the original amplitudes chunk by chunk, then update
+  // their own half: the partner never needs the updated values.
+  for (uint64_t begin = 0; begin < size; begin += m_exchangeBuffer.size()) {
+    const uint64_t count =
+        std::min<uint64_t>(m_exchangeBuffer.size(), size - begin);
+    MPI_Sendrecv(m_localState.data() + begin, 2 * count, MPI_DOUBLE, partner,
+                 0, m_exchangeBuffer.data(), 2 * count, MPI_DOUBLE, partner, 0,
+                 m_comm, MPI_STATUS_IGNORE);
+    for (uint64_t i = 0; i < count; ++i) {
+      if (in_filter(begin + i)) {
+        m_localState[begin + i] =
+            cMine * m_localState[begin + i] + cTheirs * m_exchangeBuffer[i];
+      }
+    }
+  }
+}
+
+void DistributedStateVector::applyDiagonal(
+    const std::vector<size_t> &in_qubits,
+    const std::vector<Amplitude> &in_diag) {
+  if (!isActive()) {
+    return;
+  }
+  // The global qubits contribute a fixed part of the diagonal index.
+  uint64_t globalPart = 0;
+  std::vector<std::pair<size_t, size_t>> localQubits;
+  for (size_t j = 0; j < in_qubits.size(); ++j) {
+    if (isLocal(in_qubits[j])) {
+      localQubits.emplace_back(in_qubits[j], j);
+    } else {
+      globalPart |= ((offset() >> in_qubits[j]) & 1ULL) << j;
+    }
+  }
+
+  if (localQubits.empty()) {
+    if (in_diag[globalPart] != 1.0) {
+      for (auto &amp : m_localState) {
+        amp *= in_diag[globalPart];
+      }
+    }
+    return;
+  }
+
+  const uint64_t size = m_localState.size();
+  for (uint64_t i = 0; i < size; ++i) {
+    uint64_t k = globalPart;
+    for (const auto &[qubit, j] : localQubits) {
+      k |= ((i >> qubit) & 1ULL) << j;
+    }
+    m_localState[i] *= in_diag[k];
+  }
+}
+
+double DistributedStateVector::expectationValueZ(
+    const std::vector<size_t> &in_bits) const {
+  uint64_t mask = 0;
+  for (const auto &bit : in_bits) {
+    mask |= 1ULL << bit;
+  }
+  double localResult = 0.0;
+  const uint64_t size = m_localState.size();
+  for (uint64_t i = 0; i < size; ++i) {
+    const bool isOdd = __builtin_parityll((offset() | i) & mask);
+    localResult += (isOdd ? -1.0 : 1.0) * std::norm(m_localState[i]);
+  }
+  double result = 0.0;
+  MPI_Allreduce(&localResult, &result, 1, MPI_DOUBLE, MPI_SUM, m_comm);
+  return result;
+}
+
+std::vector<double> DistributedStateVector::probabilities(
+    const std::vector<size_t> &in_bits) const {
+  std::vector<double> localProbs(1ULL << in_bits.size(), 0.0);
+  const uint64_t size = m_localState.size();
+  for (uint64_t i = 0; i < size; ++i) {
+    const uint64_t globalIdx = offset() | i;
+    uint64_t outcome = 0;
+    for (size_t j = 0; j < in_bits.size(); ++j) {
+      outcome |= ((globalIdx >> in_bits[j]) & 1ULL) << j;
+    }
+    localProbs[outcome] += std::norm(m_localState[i]);
+  }
+  std::vector<double> result(localProbs.size());
+  MPI_Allreduce(localProbs.data(), result.data(), localProbs.size(),
+                MPI_DOUBLE, MPI_SUM, m_comm);
+  return result;
+}
+
+std::vector<DistributedStateVector::Amplitude>
+DistributedStateVector::gather() const {
+  int commSize;
+  MPI_Comm_size(m_comm, &commSize);
+  // Amplitudes are sent as pairs of doubles.
+  std::vector<int> counts(commSize, 0), displacements(commSize, 0);
+  for (int i = 0; i < m_nbActiveRanks; ++i) {
+    counts[i] = 2 << m_nbLocalQubits;
+    displacements[i] = i * counts[i];
+  }
+  std::vector<Amplitude> result(1ULL << m_nbQubits);
+  MPI_Allgatherv(m_localState.data(), 2 * m_localState.size(), MPI_DOUBLE,
+                 result.data(), counts.data(), displacements.data(),
+                 MPI_DOUBLE, m_comm);
+  return result;
+}
+} // namespace quantum
+} // namespace xacc
@@ -0,0 +1,87 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#pragma once
+#include <mpi.h>
+#include <array>
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+namespace xacc {
+namespace quantum {
+// State vector whose amplitudes are sharded across the ranks of an MPI
+// communicator.
+// With P = 2^p active ranks, each one holds a contiguous 2^(n-p) block:
+// the low (n-p) qubits are 'local' (in-rank strides), the high p qubits are
+// 'global' (encoded in the rank index).
+// Gates on a global qubit exchange the amplitudes pairwise with the partner
+// rank (rank with that bit flipped), diagonal gates never communicate.
+// If the communicator size is not a power of 2 (or larger than the state
+// allows), the extra ranks hold no amplitudes and only join the reductions.
+class DistributedStateVector {
+public:
+  using Amplitude = std::complex<double>;
+  // Row-major 2x2 matrix
+  using Matrix2 = std::array<Amplitude, 4>;
+
+  DistributedStateVector(size_t in_nbQubits, MPI_Comm in_comm);
+
+  // Reset to |0...0>
+  void initialize();
+  // Arbitrary single-qubit gate
+  void applyGate(const Matrix2 &in_mat, size_t in_target);
+  // Single-qubit gate controlled by in_control
+  void applyControlledGate(const Matrix2 &in_mat, size_t in_control,
+                           size_t in_target);
+  // Diagonal gate on in_qubits: in_diag[k] is the phase of the basis state k
+  // of those qubits (bit j of k is in_qubits[j]). No communication.
+  void applyDiagonal(const std::vector<size_t> &in_qubits,
+                     const std::vector<Amplitude> &in_diag);
+
+  // <Z...Z> over in_bits (same on all ranks)
+  double expectationValueZ(const std::vector<size_t> &in_bits) const;
+  // Marginal probability distribution of in_bits, 2^m entries
+  // (bit j of the index is in_bits[j]), same on all ranks.
+  std::vector<double> probabilities(const std::vector<size_t> &in_bits) const;
+  // Full state vector on all ranks (only for small states, e.g. debugging).
+  std::vector<Amplitude> gather() const;
+
+  size_t nbQubits() const { return m_nbQubits; }
+  size_t nbLocalQubits() const { return m_nbLocalQubits; }
+  int nbActiveRanks() const { return m_nbActiveRanks; }
+
+private:
+  bool isLocal(size_t in_qubit) const { return in_qubit < m_nbLocalQubits; }
+  bool isActive() const { return m_rank < m_nbActiveRanks; }
+  // Global index of the first local amplitude
+  uint64_t offset() const { return uint64_t(m_rank) << m_nbLocalQubits; }
+  int partnerRank(size_t in_globalQubit) const {
+    return m_rank ^ (1 << (in_globalQubit - m_nbLocalQubits));
+  }
+  // Apply the gate on a global target: in_filter(local index) selects the
+  // amplitudes to update (e.g. a local control bit).
+  template <typename FilterT>
+  void applyGlobalGate(const Matrix2 &in_mat, size_t in_target,
+                       FilterT &&in_filter);
+
+  size_t m_nbQubits;
+  size_t m_nbLocalQubits;
+  MPI_Comm m_comm;
+  int m_rank;
+  int m_nbActiveRanks;
+  std::vector<Amplitude> m_localState;
+  // Receive buffer for the pairwise exchanges (bounded chunk size)
+  std::vector<Amplitude> m_exchangeBuffer;
+};
+} // namespace quantum
+} // namespace xacc
@@ -0,0 +1,287 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "QppMpiAccelerator.hpp"
+#include "AllGateVisitor.hpp"
+#include "MeasurementSampler.hpp"
+#include "TearDown.hpp"
+#include <random>
+
+namespace {
+using Amplitude = xacc::quantum::DistributedStateVector::Amplitude;
+using Matrix2 = xacc::quantum::DistributedStateVector::Matrix2;
+constexpr Amplitude I(0.0, 1.0);
+
+// Set if MPI was initialized by this plugin (finalized at tear-down)
+bool mpiInitializedByPlugin = false;
+
+// Maps gates to the distributed state-vector operations.
+// Diagonal gates are applied as phases (no communication needed).
+class DistributedGateVisitor : public xacc::quantum::AllGateVisitor {
+public:
+  using xacc::quantum::AllGateVisitor::visit;
+  DistributedGateVisitor(xacc::quantum::DistributedStateVector &io_state)
+      : m_state(io_state) {}
+
+  void visit(xacc::quantum::Hadamard &h) override {
+    const double s = M_SQRT1_2;
+    m_state.applyGate({s, s, s, -s}, h.bits()[0]);
+  }
+  void visit(xacc::quantum::X &x) override {
+    m_state.applyGate({0.0, 1.0, 1.0, 0.0}, x.bits()[0]);
+  }
+  void visit(xacc::quantum::Y &y) override {
+    m_state.applyGate({0.0, -I, I, 0.0}, y.bits()[0]);
+  }
+  void visit(xacc::quantum::Z &z) override { phase(z.bits()[0], -1.0); }
+  void visit(xacc::quantum::S &s) override { phase(s.bits()[0], I); }
+  void visit(xacc::quantum::Sdg &sdg) override { phase(sdg.bits()[0], -I); }
+  void visit(xacc::quantum::T &t) override {
+    phase(t.bits()[0], std::exp(I * M_PI_4));
+  }
+  void visit(xacc::quantum::Tdg &tdg) override {
+    phase(tdg.bits()[0], std::exp(-I * M_PI_4));
+  }
+  void visit(xacc::quantum::U1 &u1) override {
+    phase(u1.bits()[0], std::exp(I * angle(u1, 0)));
+  }
+  void visit(xacc::quantum::Rz &rz) override {
+    const double theta = angle(rz, 0);
+    m_state.applyDiagonal({rz.bits()[0]},
+                          {std::exp(-I * theta / 2.0), std::exp(I * theta / 2.0)});
+  }
+  void visit(xacc::quantum::Rx &rx) override {
+    const double theta = angle(rx, 0);
+    const double c = std::cos(theta / 2.0), s = std::sin(theta / 2.0);
+    m_state.applyGate({c, -I * s, -I * s, c}, rx.bits()[0]);
+  }
+  void visit(xacc::quantum::Ry &ry) override {
+    const double theta = angle(ry, 0);
+    const double c = std::cos(theta / 2.0), s = std::sin(theta / 2.0);
+    m_state.applyGate({c, -s, s, c}, ry.bits()[0]);
+  }
+  void visit(xacc::quantum::U &u) override {
+    const double theta = angle(u, 0), phi = angle(u, 1), lambda = angle(u, 2);
+    const double c = std::cos(theta / 2.0), s = std::sin(theta / 2.0);
+    m_state.applyGate({c, -std::exp(I * lambda) * s, std::exp(I * phi) * s,
+                       std::exp(I * (phi + lambda)) * c},
+                      u.bits()[0]);
+  }
+  void visit(xacc::quantum::Identity &i) override {}
+
+  void visit(xacc::quantum::CNOT &cnot) override {
+    m_state.applyControlledGate({0.0, 1.0, 1.0, 0.0}, cnot.bits()[0],
+                                cnot.bits()[1]);
+  }
+  void visit(xacc::quantum::CY &cy) override {
+    m_state.applyControlledGate({0.0, -I, I, 0.0}, cy.bits()[0],
+                                cy.bits()[1]);
+  }
+  void visit(xacc::quantum::CH &ch) override {
+    const double s = M_SQRT1_2;
+    m_state.applyControlledGate({s, s, s, -s}, ch.bits()[0], ch.bits()[1]);
+  }
+  void visit(xacc::quantum::CZ &cz) override {
+    m_state.applyDiagonal(cz.bits(), {1.0, 1.0, 1.0, -1.0});
+  }
+  void visit(xacc::quantum::CPhase &cphase) override {
+    m_state.applyDiagonal(cphase.bits(),
+                          {1.0, 1.0, 1.0, std::exp(I * angle(cphase, 0))});
+  }
+  void visit(xacc::quantum::CRZ &crz) override {
+    // Bit 0 of the diagonal index is the control.
+    const double theta = angle(crz, 0);
+    m_state.applyDiagonal(crz.bits(), {1.0, std::exp(-I * theta / 2.0), 1.0,
+                                       std::exp(I * theta / 2.0)});
+  }
+  void visit(xacc::quantum::Swap &s) override {
+    const Matrix2 x{0.0, 1.0, 1.0, 0.0};
+    m_state.applyControlledGate(x, s.bits()[0], s.bits()[1]);
+    m_state.applyControlledGate(x, s.bits()[1], s.bits()[0]);
+    m_state.applyControlledGate(x, s.bits()[0], s.bits()[1]);
+  }
+  void visit(xacc::quantum::iSwap &in_iSwapGate) override {
+    // iSwap = Swap * CZ * (S x S)
+    m_state.applyDiagonal(in_iSwapGate.bits(), {1.0, I, I, 1.0});
+    xacc::quantum::Swap s(in_iSwapGate.bits());
+    visit(s);
+  }
+  void visit(xacc::quantum::fSim &in_fsimGate) override {
+    unsupported(in_fsimGate);
+  }
+  void visit(xacc::quantum::XY &in_xyGate) override { unsupported(in_xyGate); }
+
+  void visit(xacc::quantum::Measure &measure) override {
+    m_measureBits.emplace_back(measure.bits()[0]);
+  }
+
+  const std::vector<size_t> &getMeasureBits() const { return m_measureBits; }
+
+private:
+  void phase(size_t in_qubit, Amplitude in_phase) {
+    m_state.applyDiagonal({in_qubit}, {1.0, in_phase});
+  }
+  static double angle(xacc::quantum::Gate &in_gate, int in_idx) {
+    return xacc::InstructionParameterToDouble(in_gate.getParameter(in_idx));
+  }
+  static void unsupported(xacc::quantum::Gate &in_gate) {
+    xacc::error("qpp-mpi: gate '" + in_gate.name() + "' is not supported.");
+  }
+
+  xacc::quantum::DistributedStateVector &m_state;
+  std::vector<size_t> m_measureBits;
+};
+} // namespace
+
+namespace xacc {
+namespace quantum {
+void QppMpiAccelerator::initialize(const HeterogeneousMap &params) {
+  int initialized;
+  MPI_Initialized(&initialized);
+  if (!initialized) {
+    MPI_Init(&xacc::argc, &xacc::argv);
+    mpiInitializedByPlugin = true;
+  }
+
+  m_comm = MPI_COMM_WORLD;
+  m_shots = -1;
+  updateConfiguration(params);
+}
+
+void QppMpiAccelerator::updateConfiguration(const HeterogeneousMap &config) {
+  if (config.keyExists<int>("shots")) {
+    m_shots = config.get<int>("shots");
+    if (m_shots < 1) {
+      xacc::error("Invalid 'shots' parameter.");
+    }
+  }
+  if (config.keyExists<void *>("mpi-communicator")) {
+    setVirtualComm(config.get<void *>("mpi-communicator"));
+  }
+}
+
+void QppMpiAccelerator::setVirtualComm(void *comm) {
+  // The handle value itself is passed (MPI_Comm may be a pointer or an int)
+  const auto newComm = (MPI_Comm)reinterpret_cast<intptr_t>(comm);
+  if (newComm != m_comm) {
+    m_comm = newComm;
+    m_state.reset();
+  }
+}
+
+void QppMpiAccelerator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::shared_ptr<CompositeInstruction> compositeInstruction) {
+  if (!canSampleFromFinalState(compositeInstruction)) {
+    xacc::error("qpp-mpi: only terminal measurements are supported (no "
+                "mid-circuit measurement, reset or conditional).");
+  }
+
+  if (!m_state || m_state->nbQubits() != buffer->size()) {
+    m_state = std::make_unique<DistributedStateVector>(buffer->size(), m_comm);
+  } else {
+    m_state->initialize();
+  }
+
+  DistributedGateVisitor visitor(*m_state);
+  for (auto *nextInst : compositeInstruction->flatView()) {
+    if (nextInst->isEnabled() && !nextInst->isComposite()) {
+      nextInst->accept(&visitor);
+    }
+  }
+
+  const auto &measureBits = visitor.getMeasureBits();
+  if (measureBits.empty()) {
+    return;
+  }
+  if (m_shots < 0) {
+    buffer->addExtraInfo("exp-val-z", m_state->expectationValueZ(measureBits));
+  } else {
+    sampleMeasurements(buffer, measureBits);
+  }
+}
+
+void QppMpiAccelerator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>>
+        compositeInstructions) {
+  for (auto &f : compositeInstructions) {
+    auto tmpBuffer =
+        std::make_shared<xacc::AcceleratorBuffer>(f->name(), buffer->size());
+    execute(tmpBuffer, f);
+    buffer->appendChild(f->name(), tmpBuffer);
+  }
+}
+
+void QppMpiAccelerator::sampleMeasurements(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<size_t> &measureBits) {
+  // The marginal distribution is reduced on all ranks: sampling it with a
+  // common seed gives the same bit strings everywhere, no extra messages.
+  const auto probs = m_state->probabilities(measureBits);
+  uint64_t seed = std::random_device{}();
+  MPI_Bcast(&seed, 1, MPI_UINT64_T, 0, m_comm);
+  std::mt19937_64 rng(seed);
+  std::discrete_distribution<uint64_t> dist(probs.begin(), probs.end());
+  std::vector<int> counts(probs.size(), 0);
+  for (int i = 0; i < m_shots; ++i) {
+    counts[dist(rng)]++;
+  }
+  for (uint64_t outcome = 0; outcome < counts.size(); ++outcome) {
+    if (counts[outcome] > 0) {
+      std::string bitString;
+      for (size_t j = 0; j < measureBits.size(); ++j) {
+        bitString.push_back(((outcome >> j) & 1ULL) ? '1' : '0');
+      }
+      buffer->appendMeasurement(bitString, counts[outcome]);
+    }
+  }
+}
+
+class QppMpiTearDown : public xacc::TearDown {
+public:
+  void tearDown() override {
+    int finalized, initialized;
+    MPI_Initialized(&initialized);
+    MPI_Finalized(&finalized);
+    if (mpiInitializedByPlugin && initialized && !finalized) {
+      MPI_Finalize();
+    }
+  }
+  std::string name() const override { return "xacc-qpp-mpi"; }
+};
+} // namespace quantum
+} // namespace xacc
+
+#include "cppmicroservices/BundleActivator.h"
+#include "cppmicroservices/BundleContext.h"
+#include "cppmicroservices/ServiceProperties.h"
+
+using namespace cppmicroservices;
+
+namespace {
+class US_ABI_LOCAL QppMpiActivator : public BundleActivator {
+public:
+  QppMpiActivator() {}
+
+  void Start(BundleContext context) {
+    context.RegisterService<xacc::Accelerator>(
+        std::make_shared<xacc::quantum::QppMpiAccelerator>());
+    context.RegisterService<xacc::TearDown>(
+        std::make_shared<xacc::quantum::QppMpiTearDown>());
+  }
+
+  void Stop(BundleContext /*context*/) {}
+};
+} // namespace
+
+CPPMICROSERVICES_EXPORT_BUNDLE_ACTIVATOR(QppMpiActivator)
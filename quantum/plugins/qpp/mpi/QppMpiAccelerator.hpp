@@ -0,0 +1,58 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#pragma once
+#include "xacc.hpp"
+#include "DistributedStateVector.hpp"
+
+namespace xacc {
+namespace quantum {
+// Distributed (MPI) state-vector simulator: the amplitudes are sharded
+// across the ranks of the communicator (MPI_COMM_WORLD by default, or the
+// virtual QPU communicator when used with the HPC virtualization decorator),
+// so the simulated qubit count is not bound by the memory of a single node.
+// Results are identical on all ranks.
+class QppMpiAccelerator : public Accelerator {
+public:
+  // Identifiable interface impls
+  const std::string name() const override { return "qpp-mpi"; }
+  const std::string description() const override {
+    return "XACC distributed (MPI) state-vector simulation Accelerator.";
+  }
+
+  // Accelerator interface impls
+  void initialize(const HeterogeneousMap &params = {}) override;
+  void updateConfiguration(const HeterogeneousMap &config) override;
+  const std::vector<std::string> configurationKeys() override {
+    return {"shots"};
+  }
+  BitOrder getBitOrder() override { return BitOrder::LSB; }
+  void setVirtualComm(void *comm) override;
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::shared_ptr<CompositeInstruction>
+                   compositeInstruction) override;
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::vector<std::shared_ptr<CompositeInstruction>>
+                   compositeInstructions) override;
+
+private:
+  // Sample the terminal measurements (same outcomes on all ranks)
+  void sampleMeasurements(std::shared_ptr<AcceleratorBuffer> buffer,
+                          const std::vector<size_t> &measureBits);
+  MPI_Comm m_comm = MPI_COMM_WORLD;
+  // -1: no shots, just the expectation value.
+  int m_shots = -1;
+  // Re-used across circuits with the same number of qubits.
+  std::unique_ptr<DistributedStateVector> m_state;
+};
+} // namespace quantum
+} // namespace xacc
@@ -12,7 +12,9 @@
  *******************************************************************************/
 #include <gtest/gtest.h>
 #include <string>
+#include <thread>
 #include "xacc.hpp"
+#include "StabilizerAccelerator.hpp"
 #include "Optimizer.hpp"
 #include "xacc_observable.hpp"
 #include "xacc_service.hpp"
@@ -83,6 +85,326 @@ TEST(QppAcceleratorTester, testDeuteron)
     }
 }
 
+TEST(QppAcceleratorTester, testExecuteAsync)
+{
+    auto accelerator = xacc::getAccelerator("qpp");
+    auto xasmCompiler = xacc::getCompiler("xasm");
+    auto ir = xasmCompiler->compile(R"(__qpu__ void ansatz_async(qbit q, double t) {
+      X(q[0]);
+      Ry(q[1], t);
+      CX(q[1], q[0]);
+      H(q[0]);
+      H(q[1]);
+      Measure(q[0]);
+      Measure(q[1]);
+    })", accelerator);
+
+    auto program = ir->getComposite("ansatz_async");
+    auto buffer = xacc::qalloc(2);
+    auto result = accelerator->executeAsync(
+        buffer, {program->operator()({ 0.0 }), program->operator()({ 0.5 })});
+    result.get();
+    auto children = buffer->getChildren();
+    EXPECT_EQ(2, children.size());
+    auto ref = xacc::qalloc(2);
+    accelerator->execute(ref, program->operator()({ 0.5 }));
+    EXPECT_NEAR(children[1]->getExpectationValueZ(), ref->getExpectationValueZ(), 1e-6);
+
+    // Single program
+    auto single = xacc::qalloc(2);
+    accelerator->executeAsync(single, program->operator()({ 0.5 })).get();
+    EXPECT_NEAR(single->getExpectationValueZ(), ref->getExpectationValueZ(), 1e-6);
+}
+
+TEST(QppAcceleratorTester, testParallelBatch)
+{
+    auto accelerator = xacc::getAccelerator("qpp", {{"vqe-mode", false}, {"parallel-batch", true}});
+    auto serialAcc = xacc::getAccelerator("qpp", {{"vqe-mode", false}});
+    auto xasmCompiler = xacc::getCompiler("xasm");
+    auto ir = xasmCompiler->compile(R"(__qpu__ void ansatz_batch(qbit q, double t) {
+      X(q[0]);
+      Ry(q[1], t);
+      CX(q[1], q[0]);
+      H(q[0]);
+      H(q[1]);
+      Measure(q[0]);
+      Measure(q[1]);
+    })", accelerator);
+
+    auto program = ir->getComposite("ansatz_batch");
+    std::vector<std::shared_ptr<xacc::CompositeInstruction>> circuits;
+    for (int i = 0; i < 20; ++i)
+    {
+        auto circuit = program->operator()({ 0.1 * i });
+        circuit->setName("circuit_" + std::to_string(i));
+        circuits.emplace_back(circuit);
+    }
+
+    // Also exercise the memory guard (one circuit at a time)
+    for (const uint64_t memLimit : { 0ULL, 1ULL })
+    {
+        accelerator->setMemoryLimit(memLimit);
+        auto buffer = xacc::qalloc(2);
+        auto ref = xacc::qalloc(2);
+        accelerator->execute(buffer, circuits);
+        serialAcc->execute(ref, circuits);
+        auto children = buffer->getChildren();
+        auto refChildren = ref->getChildren();
+        EXPECT_EQ(circuits.size(), children.size());
+        for (int i = 0; i < children.size(); ++i)
+        {
+            // Children are in input order
+            EXPECT_EQ(circuits[i]->name(), children[i]->name());
+            EXPECT_NEAR(children[i]->getExpectationValueZ(), refChildren[i]->getExpectationValueZ(), 1e-6);
+        }
+    }
+}
+
+TEST(QppAcceleratorTester, testPrefixSharing)
+{
+    // Parameter-shift style batch: each circuit shifts one angle
+    auto accelerator = xacc::getAccelerator("qpp", {{"vqe-mode", false}});
+    auto xasmCompiler = xacc::getCompiler("xasm");
+    auto ir = xasmCompiler->compile(R"(__qpu__ void ansatz_prefix(qbit q, double t0, double t1, double t2) {
+      H(q[0]);
+      Ry(q[0], t0);
+      CX(q[0], q[1]);
+      Ry(q[1], t1);
+      CX(q[1], q[2]);
+      Ry(q[2], t2);
+      H(q[1]);
+      Measure(q[0]);
+      Measure(q[1]);
+      Measure(q[2]);
+    })", accelerator);
+
+    auto program = ir->getComposite("ansatz_prefix");
+    const std::vector<double> x { 0.3, -0.7, 1.1 };
+    std::vector<std::shared_ptr<xacc::CompositeInstruction>> circuits { program->operator()(x) };
+    for (int i = 0; i < x.size(); ++i)
+    {
+        for (double sign : { 1.0, -1.0 })
+        {
+            auto shiftedX = x;
+            shiftedX[i] += sign * M_PI / 2.0;
+            circuits.emplace_back(program->operator()(shiftedX));
+        }
+    }
+
+    for (const uint64_t memLimit : { 0ULL, 300ULL })
+    {
+        // 300 bytes: only two 3-qubit checkpoints
+        accelerator->setMemoryLimit(memLimit);
+        auto buffer = xacc::qalloc(3);
+        auto ref = xacc::qalloc(3);
+        accelerator->executeWithPrefixSharing(buffer, circuits);
+        accelerator->execute(ref, circuits);
+        auto children = buffer->getChildren();
+        auto refChildren = ref->getChildren();
+        EXPECT_EQ(circuits.size(), children.size());
+        for (int i = 0; i < children.size(); ++i)
+        {
+            EXPECT_NEAR(children[i]->getExpectationValueZ(), refChildren[i]->getExpectationValueZ(), 1e-9);
+        }
+    }
+}
+
+TEST(QppAcceleratorTester, testComputeExpectations)
+{
+    auto accelerator = xacc::getAccelerator("qpp", {{"vqe-mode", false}});
+    auto xasmCompiler = xacc::getCompiler("xasm");
+    auto ir = xasmCompiler->compile(R"(__qpu__ void ansatz_expectations(qbit q, double t0, double t1) {
+      X(q[0]);
+      Ry(q[1], t0);
+      CX(q[1], q[0]);
+      Ry(q[2], t1);
+      CX(q[0], q[2]);
+    })", accelerator);
+
+    auto program = ir->getComposite("ansatz_expectations")->operator()({ 0.59, -0.31 });
+    auto H_N_3 = xacc::quantum::getObservable(
+        "pauli",
+        std::string("5.907 - 2.1433 X0X1 - 2.1433 Y0Y1 + .21829 Z0 - 6.125 Z1 + "
+                    "9.625 - 9.625 Z2 - 3.91 X1 X2 - 3.91 Y1 Y2"));
+
+    auto buffer = xacc::qalloc(3);
+    accelerator->computeExpectations(buffer, program, H_N_3);
+
+    // Reference: execute all the non-identity observed kernels
+    std::vector<std::shared_ptr<xacc::CompositeInstruction>> measured;
+    for (auto& kernel : H_N_3->observe(program))
+    {
+        if (kernel->nInstructions() > 1)
+        {
+            measured.emplace_back(kernel);
+        }
+    }
+    auto ref = xacc::qalloc(3);
+    accelerator->execute(ref, measured);
+
+    auto children = buffer->getChildren();
+    auto refChildren = ref->getChildren();
+    EXPECT_EQ(measured.size(), children.size());
+    for (int i = 0; i < children.size(); ++i)
+    {
+        EXPECT_EQ(children[i]->name(), refChildren[i]->name());
+        EXPECT_NEAR(children[i]->getExpectationValueZ(), refChildren[i]->getExpectationValueZ(), 1e-9);
+    }
+    EXPECT_NEAR(H_N_3->postProcess(buffer), H_N_3->postProcess(ref), 1e-9);
+}
+
+TEST(QppAcceleratorTester, testComputeExpectationsPrefixCache)
+{
+    auto accelerator = xacc::getAccelerator("qpp", {{"vqe-mode", false}});
+    auto reference = xacc::getAccelerator("qpp", {{"vqe-mode", false}, {"prefix-cache", false}});
+    auto xasmCompiler = xacc::getCompiler("xasm");
+    auto ir = xasmCompiler->compile(R"(__qpu__ void ansatz_prefix_cache(qbit q, double t0, double t1) {
+      X(q[0]);
+      Ry(q[1], t0);
+      CX(q[1], q[0]);
+      Ry(q[2], t1);
+      CX(q[0], q[2]);
+    })", accelerator);
+    auto H_N_3 = xacc::quantum::getObservable(
+        "pauli",
+        std::string("5.907 - 2.1433 X0X1 - 2.1433 Y0Y1 + .21829 Z0 - 6.125 Z1 + "
+                    "9.625 - 9.625 Z2 - 3.91 X1 X2 - 3.91 Y1 Y2"));
+
+    // Only the last parameter changes (frozen prefix), then both change.
+    const std::vector<std::vector<double>> params { { 0.59, -0.31 }, { 0.59, 0.2 }, { 0.59, 1.3 }, { 0.59, 1.3 }, { -0.7, 1.3 } };
+    for (const auto& x : params)
+    {
+        auto program = ir->getComposite("ansatz_prefix_cache")->operator()(x);
+        auto buffer = xacc::qalloc(3);
+        auto ref = xacc::qalloc(3);
+        accelerator->computeExpectations(buffer, program, H_N_3);
+        reference->computeExpectations(ref, program, H_N_3);
+        EXPECT_NEAR(H_N_3->postProcess(buffer), H_N_3->postProcess(ref), 1e-9);
+    }
+}
+
+TEST(QppAcceleratorTester, testComputeExpectationsBatched)
+{
+    auto accelerator = xacc::getAccelerator("qpp", {{"vqe-mode", false}});
+    auto xasmCompiler = xacc::getCompiler("xasm");
+    auto ir = xasmCompiler->compile(R"(__qpu__ void ansatz_batched(qbit q, double t0, double t1) {
+      X(q[0]);
+      Ry(q[1], t0);
+      CX(q[1], q[0]);
+      Ry(q[2], t1);
+      CX(q[0], q[2]);
+    })", accelerator);
+    auto H_N_3 = xacc::quantum::getObservable(
+        "pauli",
+        std::string("5.907 - 2.1433 X0X1 - 2.1433 Y0Y1 + .21829 Z0 - 6.125 Z1 + "
+                    "9.625 - 9.625 Z2 - 3.91 X1 X2 - 3.91 Y1 Y2"));
+
+    const std::vector<std::vector<double>> params { { 0.59, -0.31 }, { -0.7, 1.3 }, { 0.1, 0.2 } };
+    std::vector<std::shared_ptr<xacc::AcceleratorBuffer>> buffers, executed;
+    std::vector<std::shared_ptr<xacc::CompositeInstruction>> programs;
+    for (const auto& x : params)
+    {
+        programs.emplace_back(ir->getComposite("ansatz_batched")->operator()(x));
+        buffers.emplace_back(xacc::qalloc(3));
+        executed.emplace_back(xacc::qalloc(3));
+    }
+    accelerator->computeExpectations(buffers, programs, H_N_3);
+    // The default: all the observed kernels in one execution
+    accelerator->Accelerator::computeExpectations(executed, programs, H_N_3);
+    for (size_t i = 0; i < params.size(); ++i)
+    {
+        auto ref = xacc::qalloc(3);
+        accelerator->computeExpectations(ref, programs[i], H_N_3);
+        EXPECT_EQ(ref->nChildren(), buffers[i]->nChildren());
+        EXPECT_EQ(ref->nChildren(), executed[i]->nChildren());
+        EXPECT_NEAR(H_N_3->postProcess(ref), H_N_3->postProcess(buffers[i]), 1e-9);
+        EXPECT_NEAR(H_N_3->postProcess(ref), H_N_3->postProcess(executed[i]), 1e-9);
+    }
+}
+
+TEST(QppAcceleratorTester, testGateFusion)
+{
+    auto xasmCompiler = xacc::getCompiler("xasm");
+    auto ir = xasmCompiler->compile(R"(__qpu__ void fusion_test(qbit q, double t) {
+      H(q[0]);
+      H(q[1]);
+      CX(q[0], q[1]);
+      Ry(q[2], t);
+      CZ(q[1], q[2]);
+      Rx(q[3], 2.0 * t);
+      CX(q[2], q[3]);
+      T(q[4]);
+      CPhase(q[3], q[4], t);
+      U(q[5], t, 0.3, -0.7);
+      Swap(q[4], q[5]);
+      CX(q[5], q[0]);
+      Rz(q[1], -t);
+      CRZ(q[0], q[3], t);
+      Sdg(q[2]);
+      CH(q[4], q[1]);
+    })");
+    auto program = ir->getComposite("fusion_test")->operator()({ 0.37 });
+
+    const auto getWaveFunction = [&](int maxWidth) {
+        auto accelerator = xacc::getAccelerator("qpp", {{"fusion-max-width", maxWidth}});
+        auto buffer = xacc::qalloc(6);
+        accelerator->execute(buffer, program);
+        return *accelerator->getExecutionInfo<xacc::ExecutionInfo::WaveFuncPtrType>(xacc::ExecutionInfo::WaveFuncKey);
+    };
+
+    const auto expected = getWaveFunction(0);
+    for (int maxWidth = 2; maxWidth <= 5; ++maxWidth)
+    {
+        const auto fused = getWaveFunction(maxWidth);
+        EXPECT_EQ(fused.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            EXPECT_NEAR(std::abs(fused[i] - expected[i]), 0.0, 1e-9);
+        }
+    }
+}
+
+TEST(QppAcceleratorTester, testGateKernels)
+{
+    // The gates not covered above, on a superposition with distinct amplitudes:
+    // specialized kernels (no fusion) vs. the fused gate matrices.
+    auto xasmCompiler = xacc::getCompiler("xasm");
+    auto ir = xasmCompiler->compile(R"(__qpu__ void kernels_test(qbit q) {
+      H(q[0]);
+      Ry(q[1], 0.3);
+      U(q[2], 1.1, 0.2, 0.5);
+      Rx(q[3], -0.8);
+      X(q[1]);
+      Y(q[2]);
+      Z(q[0]);
+      S(q[3]);
+      Tdg(q[1]);
+      I(q[2]);
+      CY(q[3], q[0]);
+      CX(q[2], q[1]);
+      CZ(q[0], q[3]);
+      Swap(q[3], q[1]);
+      Y(q[3]);
+      CY(q[0], q[2]);
+    })");
+    auto program = ir->getComposite("kernels_test");
+
+    const auto getWaveFunction = [&](int maxWidth) {
+        auto accelerator = xacc::getAccelerator("qpp", {{"fusion-max-width", maxWidth}});
+        auto buffer = xacc::qalloc(4);
+        accelerator->execute(buffer, program);
+        return *accelerator->getExecutionInfo<xacc::ExecutionInfo::WaveFuncPtrType>(xacc::ExecutionInfo::WaveFuncKey);
+    };
+
+    const auto expected = getWaveFunction(4);
+    const auto actual = getWaveFunction(0);
+    EXPECT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        EXPECT_NEAR(std::abs(actual[i] - expected[i]), 0.0, 1e-9);
+    }
+}
+
 TEST(QppAcceleratorTester, testDeuteronVqeH2)
 {
     // Use Qpp accelerator
@@ -397,6 +719,41 @@ TEST(QppAcceleratorTester, testConditional)
     EXPECT_EQ(resultCount, nbTests);
 }
 
+TEST(QppAcceleratorTester, checkBranchTree)
+{
+    // Mid-circuit measurement, conditional and reset: the shots are split
+    // between the two branches of the first measurement.
+    const int nbShots = 10000;
+    auto xasmCompiler = xacc::getCompiler("xasm");
+    auto ir = xasmCompiler->compile(R"(__qpu__ void branches(qbit q) {
+        Ry(q[0], 1.0);
+        Measure(q[0]);
+        if (q[0])
+        {
+            X(q[1]);
+        }
+        Reset(q[0]);
+        Measure(q[1]);
+        Measure(q[0]);
+    })");
+    auto program = ir->getComposite("branches");
+    // Saved branch states, then all the branches replayed (no memory)
+    for (const uint64_t memoryLimit : { 0ULL, 1ULL })
+    {
+        auto accelerator = xacc::getAccelerator("qpp", { std::make_pair("shots", nbShots) });
+        accelerator->setMemoryLimit(memoryLimit);
+        auto buffer = xacc::qalloc(2);
+        buffer->setName("q");
+        xacc::storeBuffer(buffer);
+        accelerator->execute(buffer, program);
+        auto counts = buffer->getMeasurementCounts();
+        EXPECT_EQ(counts.size(), 2);
+        EXPECT_EQ(counts["000"] + counts["110"], nbShots);
+        // sin^2(0.5)
+        EXPECT_NEAR(counts["110"] / (double)nbShots, 0.2298, 0.02);
+    }
+}
+
 TEST(QppAcceleratorTester, testISwap)
 {
     // Get reference to the Accelerator
@@ -661,6 +1018,529 @@ TEST(QppAcceleratorTester, testFtqcApply)
     EXPECT_TRUE(nb00 > 100 && nb11 > 100);
 }
 
+TEST(QppAcceleratorTester, checkNoisyTrajectories)
+{
+    // Amplitude damping (gamma = 0.25) after X on q0,
+    // and a 10% readout error (0 read as 1) on q1.
+    const std::string noiseModel = R"({"gate_noise": [{"gate_name": "X", "register_location": ["0"], "noise_channels": [{"matrix": [[[[1.0, 0.0], [0.0, 0.0]], [[0.0, 0.0], [0.8660254037844386, 0.0]]], [[[0.0, 0.0], [0.5, 0.0]], [[0.0, 0.0], [0.0, 0.0]]]]}]}], "bit_order": "MSB", "readout_errors": [{"register_location": "1", "prob_meas0_prep1": 0.0, "prob_meas1_prep0": 0.1}]})";
+    const int nbShots = 8192;
+    auto accelerator = xacc::getAccelerator("qpp", {{"shots", nbShots}, {"noise-model", noiseModel}});
+    auto xasmCompiler = xacc::getCompiler("xasm");
+    auto program = xasmCompiler->compile(R"(__qpu__ void noisyX(qbit q) {
+        X(q[0]);
+        Measure(q[0]);
+        Measure(q[1]);
+    })", accelerator)->getComposites()[0];
+
+    auto buffer = xacc::qalloc(2);
+    accelerator->execute(buffer, program);
+    int nbTotal = 0;
+    for (const auto& [bitString, count] : buffer->getMeasurementCounts())
+    {
+        nbTotal += count;
+    }
+    EXPECT_EQ(nbTotal, nbShots);
+    // Bit j of the strings is the j-th measured qubit
+    const auto probability = [&](char bit, size_t idx) {
+        int nbMatches = 0;
+        for (const auto& [bitString, count] : buffer->getMeasurementCounts())
+        {
+            nbMatches += bitString[idx] == bit ? count : 0;
+        }
+        return static_cast<double>(nbMatches) / nbShots;
+    };
+    EXPECT_NEAR(probability('0', 0), 0.25, 0.03);
+    EXPECT_NEAR(probability('1', 1), 0.1, 0.03);
+}
+
+TEST(QppAcceleratorTester, checkDensityMatrix)
+{
+    // Same amplitude damping (gamma = 0.25) after X on q0
+    const std::string noiseModel = R"({"gate_noise": [{"gate_name": "X", "register_location": ["0"], "noise_channels": [{"matrix": [[[[1.0, 0.0], [0.0, 0.0]], [[0.0, 0.0], [0.8660254037844386, 0.0]]], [[[0.0, 0.0], [0.5, 0.0]], [[0.0, 0.0], [0.0, 0.0]]]]}]}], "bit_order": "MSB"})";
+    auto accelerator = xacc::getAccelerator("qpp", {{"sim-type", "density_matrix"}, {"noise-model", noiseModel}});
+    auto xasmCompiler = xacc::getCompiler("xasm");
+    auto program = xasmCompiler->compile(R"(__qpu__ void noisyBell(qbit q) {
+        X(q[0]);
+        H(q[1]);
+        CNOT(q[1], q[2]);
+        Measure(q[0]);
+    })", accelerator)->getComposites()[0];
+
+    auto buffer = xacc::qalloc(3);
+    accelerator->execute(buffer, program);
+    // <Z> = 0.25 - 0.75
+    EXPECT_NEAR(buffer->getExpectationValueZ(), -0.5, 1e-9);
+    const auto dm = (*buffer)["density_matrix"].as<std::vector<std::pair<double, double>>>();
+    EXPECT_EQ(dm.size(), 64);
+    // Element (r, c) at r * 8 + c: <001|rho|001> = 0.75 * 0.5 (Bell pair on q1, q2)
+    EXPECT_NEAR(dm[1 * 8 + 1].first, 0.375, 1e-9);
+    EXPECT_NEAR(dm[1 * 8 + 7].first, 0.375, 1e-9);
+    EXPECT_NEAR(dm[0 * 8 + 6].first, 0.125, 1e-9);
+}
+
+TEST(QppAcceleratorTester, checkPagedStateVector)
+{
+    // Chunks of 2^3 amplitudes: high qubit gates are swapped in or global.
+    const int nbQubits = 8;
+    auto provider = xacc::getIRProvider("quantum");
+    auto circuit = provider->createComposite("paged_circuit");
+    for (size_t layer = 0; layer < 3; ++layer)
+    {
+        for (size_t i = 0; i < nbQubits; ++i)
+        {
+            circuit->addInstruction(provider->createInstruction("Ry", {i}, {0.3 + 0.2 * i + layer}));
+            circuit->addInstruction(provider->createInstruction("Rz", {i}, {0.7 * i - layer}));
+        }
+        for (size_t i = 0; i + 1 < nbQubits; ++i)
+        {
+            circuit->addInstruction(provider->createInstruction("CNOT", {(i + layer) % nbQubits, (i + layer + 1) % nbQubits}));
+        }
+        circuit->addInstruction(provider->createInstruction("CZ", {7, 0}));
+    }
+    for (size_t i = 0; i < nbQubits; i += 3)
+    {
+        circuit->addInstruction(provider->createInstruction("Measure", {i}));
+    }
+
+    auto reference = xacc::getAccelerator("qpp");
+    auto refBuffer = xacc::qalloc(nbQubits);
+    reference->execute(refBuffer, circuit);
+    auto accelerator = xacc::getAccelerator("qpp", {{"sim-type", "paged_statevector"}, {"paging-chunk-qubits", 3}});
+    auto buffer = xacc::qalloc(nbQubits);
+    accelerator->execute(buffer, circuit);
+    EXPECT_NEAR(buffer->getExpectationValueZ(), refBuffer->getExpectationValueZ(), 1e-9);
+
+    // GHZ shots: only 0...0 and 1...1
+    auto ghz = provider->createComposite("paged_ghz");
+    ghz->addInstruction(provider->createInstruction("H", {0}));
+    for (size_t i = 1; i < nbQubits; ++i)
+    {
+        ghz->addInstruction(provider->createInstruction("CNOT", {i - 1, i}));
+    }
+    for (size_t i = 0; i < nbQubits; ++i)
+    {
+        ghz->addInstruction(provider->createInstruction("Measure", {i}));
+    }
+    const int nbShots = 4096;
+    accelerator->updateConfiguration({{"shots", nbShots}});
+    auto ghzBuffer = xacc::qalloc(nbQubits);
+    accelerator->execute(ghzBuffer, ghz);
+    auto counts = ghzBuffer->getMeasurementCounts();
+    EXPECT_EQ(counts.size(), 2);
+    const auto nbZeros = counts[std::string(nbQubits, '0')];
+    EXPECT_EQ(nbZeros + counts[std::string(nbQubits, '1')], nbShots);
+    EXPECT_NEAR(nbZeros / static_cast<double>(nbShots), 0.5, 0.05);
+
+    // Paged beyond the memory limit if a paging directory is set
+    auto autoPaged = xacc::getAccelerator("qpp", {{"paging-dir", std::string("/tmp")}, {"paging-chunk-qubits", 3}});
+    autoPaged->setMemoryLimit(1024);
+    auto autoBuffer = xacc::qalloc(nbQubits);
+    autoPaged->execute(autoBuffer, circuit);
+    EXPECT_NEAR(autoBuffer->getExpectationValueZ(), refBuffer->getExpectationValueZ(), 1e-9);
+    autoPaged->setMemoryLimit(0);
+}
+
+TEST(QppAcceleratorTester, checkStateVectorFile)
+{
+    const int nbQubits = 5;
+    auto provider = xacc::getIRProvider("quantum");
+    const auto addLayer = [&](std::shared_ptr<xacc::CompositeInstruction> circuit, double angle) {
+        for (size_t i = 0; i < nbQubits; ++i)
+        {
+            circuit->addInstruction(provider->createInstruction("Ry", {i}, {angle + 0.3 * i}));
+        }
+        for (size_t i = 0; i + 1 < nbQubits; ++i)
+        {
+            circuit->addInstruction(provider->createInstruction("CNOT", {i, i + 1}));
+        }
+    };
+    auto first = provider->createComposite("state_file_first");
+    addLayer(first, 0.4);
+    auto second = provider->createComposite("state_file_second");
+    addLayer(second, -1.1);
+    auto both = provider->createComposite("state_file_both");
+    addLayer(both, 0.4);
+    addLayer(both, -1.1);
+    const auto waveFunction = [](std::shared_ptr<xacc::Accelerator> accelerator) {
+        return *accelerator->getExecutionInfo<xacc::ExecutionInfo::WaveFuncPtrType>(xacc::ExecutionInfo::WaveFuncKey);
+    };
+
+    auto reference = xacc::getAccelerator("qpp");
+    reference->execute(xacc::qalloc(nbQubits), both);
+    const auto expected = waveFunction(reference);
+
+    // Export after the first layer, resume from the file
+    const std::string path = "/tmp/xacc_qpp_state_file.npy";
+    reference->execute(xacc::qalloc(nbQubits), first);
+    reference->exportState(path);
+    {
+        xacc::StateVectorReader file(path);
+        EXPECT_EQ(file.nbQubits(), nbQubits);
+    }
+    auto resumed = xacc::getAccelerator("qpp", {{"initial-state-file", path}});
+    resumed->execute(xacc::qalloc(nbQubits), second);
+    const auto result = waveFunction(resumed);
+    ASSERT_EQ(result.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        EXPECT_NEAR(std::abs(result[i] - expected[i]), 0.0, 1e-9);
+    }
+
+    // Paged: loaded and exported chunk by chunk, the qubits being permuted
+    // by the swaps in between.
+    auto paged = xacc::getAccelerator("qpp", {{"sim-type", "paged_statevector"}, {"paging-chunk-qubits", 2}, {"initial-state-file", path}});
+    paged->execute(xacc::qalloc(nbQubits), second);
+    paged->exportState(path);
+    xacc::StateVectorReader file(path);
+    ASSERT_EQ(file.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        EXPECT_NEAR(std::abs(file.data()[i] - expected[i]), 0.0, 1e-9);
+    }
+    paged->initialize();
+}
+
+TEST(QppAcceleratorTester, checkStabilizer)
+{
+    // 1000-qubit GHZ state, only 0...0 and 1...1
+    const int nbQubits = 1000;
+    const int nbShots = 100000;
+    auto provider = xacc::getIRProvider("quantum");
+    auto ghz = provider->createComposite("ghz_1000");
+    ghz->addInstruction(provider->createInstruction("H", {0}));
+    for (size_t i = 1; i < nbQubits; ++i)
+    {
+        ghz->addInstruction(provider->createInstruction("CNOT", {i - 1, i}));
+    }
+    for (size_t i = 0; i < nbQubits; ++i)
+    {
+        ghz->addInstruction(provider->createInstruction("Measure", {i}));
+    }
+    auto accelerator = xacc::getAccelerator("stabilizer", {{"shots", nbShots}});
+    auto buffer = xacc::qalloc(nbQubits);
+    accelerator->execute(buffer, ghz);
+    auto counts = buffer->getMeasurementCounts();
+    EXPECT_EQ(counts.size(), 2);
+    const auto nbZeros = counts[std::string(nbQubits, '0')];
+    EXPECT_EQ(nbZeros + counts[std::string(nbQubits, '1')], nbShots);
+    EXPECT_NEAR(nbZeros / static_cast<double>(nbShots), 0.5, 0.01);
+
+    // qpp forwards the Clifford circuits (Rx(pi/2) is one), with mid-circuit
+    // measurements and resets.
+    auto xasmCompiler = xacc::getCompiler("xasm");
+    auto ir = xasmCompiler->compile(R"(__qpu__ void clifford_reset(qbit q) {
+      Rx(q[0], 1.5707963267948966);
+      CX(q[0], q[1]);
+      Measure(q[0]);
+      Reset(q[0]);
+      X(q[0]);
+      Measure(q[0]);
+      Measure(q[1]);
+    })");
+    auto program = ir->getComposite("clifford_reset");
+    EXPECT_TRUE(xacc::quantum::StabilizerAccelerator::isCliffordCircuit(program));
+    auto qpp = xacc::getAccelerator("qpp", {{"shots", 1024}});
+    auto qppBuffer = xacc::qalloc(2);
+    qpp->execute(qppBuffer, program);
+    // First and last results are equal, the middle one is 1.
+    auto qppCounts = qppBuffer->getMeasurementCounts();
+    EXPECT_EQ(qppCounts["010"] + qppCounts["111"], 1024);
+    EXPECT_GT(qppCounts["010"], 400);
+    EXPECT_GT(qppCounts["111"], 400);
+
+    // Exact exp-val-z without shots
+    auto exact = xacc::getAccelerator("stabilizer");
+    auto bell = xasmCompiler->compile(R"(__qpu__ void stabilizer_bell(qbit q) {
+      H(q[0]);
+      CX(q[0], q[1]);
+      Measure(q[0]);
+      Measure(q[1]);
+    })")->getComposite("stabilizer_bell");
+    auto bellBuffer = xacc::qalloc(2);
+    exact->execute(bellBuffer, bell);
+    EXPECT_NEAR(bellBuffer->getExpectationValueZ(), 1.0, 1e-12);
+}
+
+TEST(QppAcceleratorTester, checkTensorNetwork)
+{
+    auto xasmCompiler = xacc::getCompiler("xasm");
+    auto ir = xasmCompiler->compile(R"(__qpu__ void tn_circuit(qbit q) {
+      Ry(q[0], 0.3);
+      H(q[1]);
+      CNOT(q[0], q[2]);
+      T(q[2]);
+      Rx(q[3], 1.2);
+      CZ(q[1], q[2]);
+      CNOT(q[2], q[3]);
+      Rz(q[0], -0.7);
+      CNOT(q[3], q[0]);
+      Measure(q[0]);
+      Measure(q[2]);
+    })");
+    auto program = ir->getComposite("tn_circuit");
+    auto qpp = xacc::getAccelerator("qpp");
+    auto qppBuffer = xacc::qalloc(4);
+    qpp->execute(qppBuffer, program);
+    // Small tensors to exercise slicing
+    auto tensorNetwork = xacc::getAccelerator("tensor-network", {{"max-tensor-size", 3}});
+    auto tnBuffer = xacc::qalloc(4);
+    tensorNetwork->execute(tnBuffer, program);
+    EXPECT_NEAR(tnBuffer->getExpectationValueZ(), qppBuffer->getExpectationValueZ(), 1e-9);
+
+    // 100-qubit GHZ amplitudes
+    const int nbQubits = 100;
+    auto provider = xacc::getIRProvider("quantum");
+    auto ghz = provider->createComposite("tn_ghz");
+    ghz->addInstruction(provider->createInstruction("H", {0}));
+    for (size_t i = 1; i < nbQubits; ++i)
+    {
+        ghz->addInstruction(provider->createInstruction("CNOT", {i - 1, i}));
+    }
+    auto allOnes = xacc::getAccelerator("tensor-network", {{"bitstring", std::vector<int>(nbQubits, 1)}});
+    auto ghzBuffer = xacc::qalloc(nbQubits);
+    allOnes->execute(ghzBuffer, ghz);
+    EXPECT_NEAR((*ghzBuffer)["amplitude-real"].as<double>(), 1.0 / std::sqrt(2.0), 1e-12);
+    EXPECT_NEAR((*ghzBuffer)["amplitude-imag"].as<double>(), 0.0, 1e-12);
+    std::vector<int> mixed(nbQubits, 0);
+    mixed[nbQubits / 2] = 1;
+    auto mixedAcc = xacc::getAccelerator("tensor-network", {{"bitstring", mixed}});
+    auto mixedBuffer = xacc::qalloc(nbQubits);
+    mixedAcc->execute(mixedBuffer, ghz);
+    EXPECT_NEAR((*mixedBuffer)["amplitude-real"].as<double>(), 0.0, 1e-12);
+}
+
+TEST(QppAcceleratorTester, checkPauliPropagation)
+{
+    // Same exp-val-z as qpp (exact, no truncation), all the gate kinds
+    auto xasmCompiler = xacc::getCompiler("xasm");
+    auto ir = xasmCompiler->compile(R"(__qpu__ void pauli_prop(qbit q) {
+      H(q[0]);
+      T(q[1]);
+      CX(q[0], q[1]);
+      Rx(q[2], 0.3);
+      CY(q[1], q[2]);
+      U(q[3], 0.4, -0.7, 1.1);
+      CPhase(q[2], q[3], 0.9);
+      CRZ(q[3], q[0], -1.2);
+      iSwap(q[0], q[2]);
+      Tdg(q[3]);
+      Swap(q[1], q[3]);
+      CZ(q[0], q[1]);
+      Ry(q[1], 0.8);
+      S(q[2]);
+      Sdg(q[0]);
+      Measure(q[0]);
+      Measure(q[2]);
+      Measure(q[3]);
+    })");
+    auto program = ir->getComposite("pauli_prop");
+    auto qpp = xacc::getAccelerator("qpp");
+    auto refBuffer = xacc::qalloc(4);
+    qpp->execute(refBuffer, program);
+    auto accelerator = xacc::getAccelerator("pauli-propagation", {{"truncation-threshold", 0.0}});
+    auto buffer = xacc::qalloc(4);
+    accelerator->execute(buffer, program);
+    EXPECT_NEAR(buffer->getExpectationValueZ(), refBuffer->getExpectationValueZ(), 1e-9);
+
+    // computeExpectations of an observable, batched
+    auto ansatzIr = xasmCompiler->compile(R"(__qpu__ void pauli_prop_ansatz(qbit q, double t0, double t1) {
+      X(q[0]);
+      Ry(q[1], t0);
+      CX(q[1], q[0]);
+      Ry(q[2], t1);
+      CX(q[0], q[2]);
+    })", accelerator);
+    auto H_N_3 = xacc::quantum::getObservable(
+        "pauli",
+        std::string("5.907 - 2.1433 X0X1 - 2.1433 Y0Y1 + .21829 Z0 - 6.125 Z1 + "
+                    "9.625 - 9.625 Z2 - 3.91 X1 X2 - 3.91 Y1 Y2"));
+    const std::vector<std::vector<double>> params { { 0.59, -0.31 }, { -0.7, 1.3 } };
+    std::vector<std::shared_ptr<xacc::AcceleratorBuffer>> buffers;
+    std::vector<std::shared_ptr<xacc::CompositeInstruction>> programs;
+    for (const auto& x : params)
+    {
+        programs.emplace_back(ansatzIr->getComposite("pauli_prop_ansatz")->operator()(x));
+        buffers.emplace_back(xacc::qalloc(3));
+    }
+    accelerator->computeExpectations(buffers, programs, H_N_3);
+    for (size_t i = 0; i < params.size(); ++i)
+    {
+        auto ref = xacc::qalloc(3);
+        qpp->computeExpectations(ref, programs[i], H_N_3);
+        EXPECT_EQ(ref->nChildren(), buffers[i]->nChildren());
+        EXPECT_NEAR(H_N_3->postProcess(ref), H_N_3->postProcess(buffers[i]), 1e-9);
+    }
+
+    // 200-qubit GHZ state with a rotation: <Z0 Z199> = cos(theta)
+    const int nbQubits = 200;
+    const double theta = 0.37;
+    auto provider = xacc::getIRProvider("quantum");
+    auto ghz = provider->createComposite("pauli_prop_ghz");
+    ghz->addInstruction(provider->createInstruction("H", {0}));
+    for (size_t i = 1; i < nbQubits; ++i)
+    {
+        ghz->addInstruction(provider->createInstruction("CNOT", {i - 1, i}));
+    }
+    ghz->addInstruction(provider->createInstruction("Rx", {nbQubits - 1}, {theta}));
+    ghz->addInstruction(provider->createInstruction("Measure", {0}));
+    ghz->addInstruction(provider->createInstruction("Measure", {nbQubits - 1}));
+    auto ghzBuffer = xacc::qalloc(nbQubits);
+    accelerator->execute(ghzBuffer, ghz);
+    EXPECT_NEAR(ghzBuffer->getExpectationValueZ(), std::cos(theta), 1e-9);
+}
+
+TEST(QppAcceleratorTester, checkSparseStateVector)
+{
+    // Same exp-val-z as qpp (exact, no pruning and no dense fallback)
+    auto xasmCompiler = xacc::getCompiler("xasm");
+    auto ir = xasmCompiler->compile(R"(__qpu__ void sparse_sv(qbit q) {
+      H(q[0]);
+      T(q[1]);
+      CX(q[0], q[1]);
+      Rx(q[2], 0.3);
+      CY(q[1], q[2]);
+      U(q[3], 0.4, -0.7, 1.1);
+      CPhase(q[2], q[3], 0.9);
+      CRZ(q[3], q[0], -1.2);
+      Tdg(q[3]);
+      Swap(q[1], q[3]);
+      CZ(q[0], q[1]);
+      Ry(q[1], 0.8);
+      S(q[2]);
+      Sdg(q[0]);
+      Measure(q[0]);
+      Measure(q[2]);
+      Measure(q[3]);
+    })");
+    auto program = ir->getComposite("sparse_sv");
+    auto qpp = xacc::getAccelerator("qpp");
+    auto refBuffer = xacc::qalloc(4);
+    qpp->execute(refBuffer, program);
+    auto accelerator = xacc::getAccelerator("sparse", {{"pruning-threshold", 0.0}, {"dense-fraction", 2.0}});
+    auto buffer = xacc::qalloc(4);
+    accelerator->execute(buffer, program);
+    EXPECT_NEAR(buffer->getExpectationValueZ(), refBuffer->getExpectationValueZ(), 1e-9);
+    EXPECT_FALSE(buffer->hasExtraInfoKey("dense-fallback-gate"));
+
+    // Same circuit, falling back to qpp after the first gates
+    auto denseAccelerator = xacc::getAccelerator("sparse", {{"dense-fraction", 0.1}});
+    auto denseBuffer = xacc::qalloc(4);
+    denseAccelerator->execute(denseBuffer, program);
+    EXPECT_NEAR(denseBuffer->getExpectationValueZ(), refBuffer->getExpectationValueZ(), 1e-9);
+    EXPECT_TRUE(denseBuffer->hasExtraInfoKey("dense-fallback-gate"));
+
+    // 50-qubit classical circuit: a single amplitude, a single bit string
+    const int nbQubits = 50;
+    auto provider = xacc::getIRProvider("quantum");
+    auto chain = provider->createComposite("sparse_sv_perm");
+    chain->addInstruction(provider->createInstruction("X", {0}));
+    chain->addInstruction(provider->createInstruction("X", {2}));
+    for (size_t i = 1; i < nbQubits; ++i)
+    {
+        chain->addInstruction(provider->createInstruction("CNOT", {i - 1, i}));
+    }
+    chain->addInstruction(provider->createInstruction("Measure", {0}));
+    chain->addInstruction(provider->createInstruction("Measure", {1}));
+    chain->addInstruction(provider->createInstruction("Measure", {2}));
+    chain->addInstruction(provider->createInstruction("Measure", {nbQubits - 1}));
+    auto shotsAccelerator = xacc::getAccelerator("sparse", {{"shots", 100}});
+    auto permBuffer = xacc::qalloc(nbQubits);
+    shotsAccelerator->execute(permBuffer, chain);
+    EXPECT_EQ(permBuffer->getMeasurementCounts().size(), 1);
+    // q[0] = 1, q[1] = 1, q[2] = 0, ..., q[49] = 0
+    EXPECT_EQ(permBuffer->getMeasurementCounts()["1100"], 100);
+    EXPECT_EQ((*permBuffer)["max-amplitudes"].as<int>(), 1);
+}
+
+TEST(QppAcceleratorTester, checkClonePerThread)
+{
+    auto accelerator = xacc::getAccelerator("qpp");
+    auto cloneable = std::dynamic_pointer_cast<xacc::Cloneable<xacc::Accelerator>>(accelerator);
+    ASSERT_TRUE(cloneable != nullptr);
+    // Still a shared service instance
+    EXPECT_EQ(accelerator, xacc::getAccelerator("qpp"));
+
+    auto provider = xacc::getIRProvider("quantum");
+    auto bell = provider->createComposite("bell_clone_test");
+    bell->addInstruction(provider->createInstruction("H", {0}));
+    bell->addInstruction(provider->createInstruction("CNOT", {0, 1}));
+    bell->addInstruction(provider->createInstruction("Measure", {0}));
+    bell->addInstruction(provider->createInstruction("Measure", {1}));
+
+    // Each thread configures its own instance, with a different number of shots.
+    const int nbThreads = 4;
+    std::vector<std::shared_ptr<xacc::AcceleratorBuffer>> buffers(nbThreads);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < nbThreads; ++i)
+    {
+        threads.emplace_back([&, i]() {
+            auto qpp = cloneable->clone();
+            qpp->initialize({std::make_pair("shots", 100 * (i + 1))});
+            for (int j = 0; j < 10; ++j)
+            {
+                buffers[i] = xacc::qalloc(2);
+                qpp->execute(buffers[i], bell);
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    for (int i = 0; i < nbThreads; ++i)
+    {
+        int nbShots = 0;
+        for (const auto& [bits, count] : buffers[i]->getMeasurementCounts())
+        {
+            EXPECT_TRUE(bits == "00" || bits == "11");
+            nbShots += count;
+        }
+        EXPECT_EQ(100 * (i + 1), nbShots);
+    }
+}
+
+TEST(QppAcceleratorTester, checkExecutionMetrics)
+{
+    auto accelerator = xacc::getAccelerator("qpp", {std::make_pair("shots", 100)});
+    auto provider = xacc::getIRProvider("quantum");
+    std::vector<std::shared_ptr<xacc::CompositeInstruction>> programs;
+    for (int i = 0; i < 3; ++i)
+    {
+        auto program = provider->createComposite("metrics_" + std::to_string(i));
+        program->addInstruction(provider->createInstruction("Rx", {0}, {0.1 * (i + 1)}));
+        program->addInstruction(provider->createInstruction("CNOT", {0, 1}));
+        program->addInstruction(provider->createInstruction("Measure", {0}));
+        program->addInstruction(provider->createInstruction("Measure", {1}));
+        programs.emplace_back(program);
+    }
+
+    std::vector<xacc::ExecutionMetrics> reported;
+    accelerator->setExecutionMetricsCallback([&](const xacc::ExecutionMetrics& metrics) { reported.emplace_back(metrics); });
+    // One report for the batch, not one per circuit
+    auto buffer = xacc::qalloc(2);
+    accelerator->execute(buffer, programs);
+    ASSERT_EQ(reported.size(), 1);
+    EXPECT_EQ(reported[0].accelerator, accelerator->getSignature());
+    EXPECT_EQ(reported[0].nbCircuits, 3);
+    EXPECT_EQ(reported[0].nbShots, 100);
+    EXPECT_EQ(reported[0].queueTimeMs, 0.0);
+    EXPECT_GE(reported[0].executionTimeMs, 0.0);
+    // A 2-qubit state vector
+    EXPECT_EQ(reported[0].peakMemoryBytes, 64.0);
+
+    accelerator->execute(xacc::qalloc(2), programs[0]);
+    ASSERT_EQ(reported.size(), 2);
+    EXPECT_EQ(reported[1].nbCircuits, 1);
+    auto info = accelerator->getExecutionInfo();
+    EXPECT_EQ(info.get<int>(xacc::ExecutionInfo::CircuitCountKey), 1);
+    EXPECT_EQ(info.get<int>(xacc::ExecutionInfo::ShotCountKey), 100);
+    EXPECT_EQ(info.get<double>(xacc::ExecutionInfo::PeakMemoryKey), 64.0);
+    // Along with the state vector
+    EXPECT_TRUE(info.keyExists<xacc::ExecutionInfo::WaveFuncPtrType>(xacc::ExecutionInfo::WaveFuncKey));
+    accelerator->setExecutionMetricsCallback(nullptr);
+    accelerator->initialize();
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize();
 
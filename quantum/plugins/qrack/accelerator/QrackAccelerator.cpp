@@ -12,7 +12,10 @@
  *   Daniel Strano - adaption from Quantum++ to Qrack
  *******************************************************************************/
 #include <typeinfo>
+#include <cmath>
+#include <cstdlib>
 #include "QrackAccelerator.hpp"
+#include "MeasurementSampler.hpp"
 
 namespace xacc {
 namespace quantum {
@@ -68,50 +71,109 @@ namespace quantum {
                 xacc::error("Invalid 'zero_threshold' parameter. (Must be >= 0.)");
             }
         }
-    }
-
-    void QrackAccelerator::execute(std::shared_ptr<AcceleratorBuffer> buffer, const std::shared_ptr<CompositeInstruction> compositeInstruction)
-    {
-        bool canSample = true;
-        if (m_shots > 1) {
-            bool didMeasure = false;
 
-            InstructionIterator shotsIt(compositeInstruction);
-            while (shotsIt.hasNext())
+        // Explicit engine stack, outermost layer first, instead of the one
+        // derived from the use_* flags
+        if (params.keyExists<std::vector<std::string>>("engine_layers"))
+        {
+            m_engine_layers = params.get<std::vector<std::string>>("engine_layers");
+            if (m_engine_layers.empty() || m_engine_layers.size() > 3)
             {
-                auto nextInst = shotsIt.next();
-                if (!nextInst->isEnabled()) {
-                    continue;
-                }
+                xacc::error("Invalid 'engine_layers' parameter. (Must have 1 to 3 layers.)");
+            }
+        }
 
-                if (nextInst->name() == "Identity") {
-                    continue;
-                }
+        // Devices the QPager layer spreads its pages over, e.g. "0,1" or
+        // "2.0" (Qrack device list syntax), read by Qrack at construction.
+        if (params.stringExists("qpager_devices"))
+        {
+            setenv("QRACK_QPAGER_DEVICES", params.getString("qpager_devices").c_str(), 1);
+        }
 
-                if (nextInst->name() == "ifstmt") {
-                    canSample = false;
-                    break;
-                }
+        if (params.keyExists<bool>("reuse_engine"))
+        {
+            m_reuse_engine = params.get<bool>("reuse_engine");
+        }
 
-                if (nextInst->name() == "Measure")
-                {
-                    didMeasure = true;
-                }
-                else if (didMeasure)
+        m_engine_config.layers = m_engine_layers.empty() ? defaultEngineLayers() : toEngineLayers(m_engine_layers);
+        m_engine_config.device_id = m_device_id;
+        m_engine_config.doNormalize = m_do_normalize;
+        m_engine_config.zero_threshold = m_zero_threshold;
+        m_engine_config.reuse_engine = m_reuse_engine;
+    }
+
+    std::vector<Qrack::QInterfaceEngine> QrackAccelerator::defaultEngineLayers() const
+    {
+        if (m_use_qunit)
+        {
+            return {
+                m_use_opencl_multi ? Qrack::QINTERFACE_QUNIT_MULTI : Qrack::QINTERFACE_QUNIT,
+                m_use_stabilizer ? Qrack::QINTERFACE_STABILIZER_HYBRID : (m_use_opencl ? Qrack::QINTERFACE_OPTIMAL_SCHROEDINGER : Qrack::QINTERFACE_CPU),
+                m_use_opencl ? (m_use_stabilizer ? Qrack::QINTERFACE_OPTIMAL_SCHROEDINGER : Qrack::QINTERFACE_OPTIMAL_SINGLE_PAGE) : Qrack::QINTERFACE_CPU
+            };
+        }
+        return {
+            m_use_stabilizer ? Qrack::QINTERFACE_STABILIZER_HYBRID : (m_use_opencl ? Qrack::QINTERFACE_OPTIMAL_SCHROEDINGER : Qrack::QINTERFACE_CPU),
+            m_use_opencl ? (m_use_stabilizer ? Qrack::QINTERFACE_OPTIMAL_SCHROEDINGER : Qrack::QINTERFACE_OPTIMAL_SINGLE_PAGE) : Qrack::QINTERFACE_CPU,
+            Qrack::QINTERFACE_OPTIMAL_SINGLE_PAGE
+        };
+    }
+
+    std::vector<Qrack::QInterfaceEngine> QrackAccelerator::toEngineLayers(const std::vector<std::string>& names)
+    {
+        static const std::map<std::string, Qrack::QInterfaceEngine> engines {
+            { "qunit", Qrack::QINTERFACE_QUNIT },
+            { "qunit-multi", Qrack::QINTERFACE_QUNIT_MULTI },
+            { "stabilizer-hybrid", Qrack::QINTERFACE_STABILIZER_HYBRID },
+            { "qpager", Qrack::QINTERFACE_QPAGER },
+            { "hybrid", Qrack::QINTERFACE_HYBRID },
+            { "opencl", Qrack::QINTERFACE_OPENCL },
+            { "cpu", Qrack::QINTERFACE_CPU },
+            { "optimal", Qrack::QINTERFACE_OPTIMAL_SCHROEDINGER },
+            { "optimal-single-page", Qrack::QINTERFACE_OPTIMAL_SINGLE_PAGE }
+        };
+
+        std::vector<Qrack::QInterfaceEngine> layers;
+        for (const auto& name : names)
+        {
+            const auto iter = engines.find(name);
+            if (iter == engines.end())
+            {
+                std::string validNames;
+                for (const auto& engine : engines)
                 {
-                    canSample = false;
-                    break;
+                    validNames += (validNames.empty() ? "" : ", ") + engine.first;
                 }
+                xacc::error("Invalid Qrack engine layer '" + name + "'. (Must be one of " + validNames + ".)");
             }
+            layers.emplace_back(iter->second);
+        }
+        return layers;
+    }
 
-            if (!canSample && xacc::verbose)
-            {
-                std::cout << "Cannot sample; must repeat circuit per shot. If possible, consider removing conditionals, running 1 shot, and/or only measuring at the end of the circuit." << std::endl;
-            }
+    double QrackAccelerator::stateBytes(size_t nbQubits) const
+    {
+        // The QUnit and stabilizer hybrid layers depend on the
+        // entanglement, otherwise a (single precision) state vector.
+        if (!m_engine_layers.empty() || m_use_qunit || m_use_stabilizer)
+        {
+            return -1.0;
+        }
+        return std::ldexp(sizeof(std::complex<float>), nbQubits);
+    }
+
+    void QrackAccelerator::execute(std::shared_ptr<AcceleratorBuffer> buffer, const std::shared_ptr<CompositeInstruction> compositeInstruction)
+    {
+        ScopedExecutionMetrics metrics(*this, 1, m_shots);
+        metrics.metrics().peakMemoryBytes = stateBytes(buffer->size());
+        const bool canSample = canSampleFromFinalState(compositeInstruction);
+        if (m_shots > 1 && !canSample && xacc::verbose)
+        {
+            std::cout << "Cannot sample; must repeat circuit per shot. If possible, consider removing conditionals, running 1 shot, and/or only measuring at the end of the circuit." << std::endl;
         }
 
         const auto runCircuit = [&](int shots){
-            m_visitor->initialize(buffer, shots, m_use_opencl, m_use_qunit, m_use_opencl_multi, m_use_stabilizer, m_device_id, m_do_normalize, m_zero_threshold);
+            m_visitor->initialize(buffer, shots, m_engine_config);
 
             // Walk the IR tree, and visit each node
             InstructionIterator it(compositeInstruction);
@@ -141,6 +203,7 @@ namespace quantum {
     }
     void QrackAccelerator::execute(std::shared_ptr<AcceleratorBuffer> buffer, const std::vector<std::shared_ptr<CompositeInstruction>> compositeInstructions)
     {
+        ScopedExecutionMetrics metrics(*this, compositeInstructions.size(), m_shots);
         for (auto& f : compositeInstructions)
         {
             auto tmpBuffer = std::make_shared<xacc::AcceleratorBuffer>(f->name(), buffer->size());
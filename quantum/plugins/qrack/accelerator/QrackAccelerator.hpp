@@ -27,11 +27,19 @@ public:
     // Accelerator interface impls
     virtual void initialize(const HeterogeneousMap& params = {}) override;
     virtual void updateConfiguration(const HeterogeneousMap& config) override {initialize(config);};
-    virtual const std::vector<std::string> configurationKeys() override { return {}; }
+    virtual const std::vector<std::string> configurationKeys() override {
+        return { "shots", "use_opencl", "use_qunit", "use_opencl_multi", "use_stabilizer", "device_id", "do_normalize", "zero_threshold", "engine_layers", "qpager_devices", "reuse_engine" };
+    }
     virtual BitOrder getBitOrder() override {return BitOrder::LSB;}
     virtual void execute(std::shared_ptr<AcceleratorBuffer> buffer, const std::shared_ptr<CompositeInstruction> compositeInstruction) override;
     virtual void execute(std::shared_ptr<AcceleratorBuffer> buffer, const std::vector<std::shared_ptr<CompositeInstruction>> compositeInstructions) override;
 private:
+    // Engine stack of the use_* flags
+    std::vector<Qrack::QInterfaceEngine> defaultEngineLayers() const;
+    static std::vector<Qrack::QInterfaceEngine> toEngineLayers(const std::vector<std::string>& names);
+    // Memory footprint of the simulation, -1 if it depends on the circuit
+    double stateBytes(size_t nbQubits) const;
+
     std::shared_ptr<QrackVisitor> m_visitor;
     int m_shots = -1;
     bool m_use_opencl = true;
@@ -41,5 +49,8 @@ private:
     int m_device_id = -1;
     bool m_do_normalize = false;
     double m_zero_threshold = REAL1_EPSILON;
+    std::vector<std::string> m_engine_layers;
+    bool m_reuse_engine = false;
+    QrackEngineConfig m_engine_config;
 };
 }}
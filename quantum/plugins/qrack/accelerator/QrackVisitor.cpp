@@ -15,26 +15,50 @@
 #include "QrackVisitor.hpp"
 #include "xacc.hpp"
 
-#define MAKE_ENGINE(num_qubits, perm) Qrack::CreateQuantumInterface(qIType1, qIType2, qIType3, num_qubits, perm, nullptr, Qrack::CMPLX_DEFAULT_ARG, doNormalize, false, false, device_id, true, zero_threshold)
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+#define MAKE_ENGINE(num_qubits, perm) Qrack::CreateQuantumInterface(qIType1, qIType2, qIType3, num_qubits, perm, nullptr, Qrack::CMPLX_DEFAULT_ARG, config.doNormalize, false, false, config.device_id, true, config.zero_threshold)
+
+namespace {
+    // Engines kept between executes, by configuration and width
+    std::mutex enginePoolMutex;
+    std::map<std::string, std::vector<Qrack::QInterfacePtr>> enginePool;
+}
 
 namespace xacc {
 namespace quantum {
-    void QrackVisitor::initialize(std::shared_ptr<AcceleratorBuffer> buffer, int shots, bool use_opencl, bool use_qunit, bool use_opencl_multi, bool use_stabilizer, int device_id, bool doNormalize, double zero_threshold)
+    void QrackVisitor::initialize(std::shared_ptr<AcceleratorBuffer> buffer, int shots, const QrackEngineConfig& config)
     {
         m_buffer = std::move(buffer);
         m_measureBits.clear();
         m_shots = shots;
         m_shotsMode = shots > 1;
 
-        Qrack::QInterfaceEngine qIType1, qIType2, qIType3;
-        if (use_qunit) {
-            qIType1 = use_opencl_multi ? Qrack::QINTERFACE_QUNIT_MULTI : Qrack::QINTERFACE_QUNIT;
-            qIType2 = use_stabilizer ? Qrack::QINTERFACE_STABILIZER_HYBRID : (use_opencl ? Qrack::QINTERFACE_OPTIMAL_SCHROEDINGER : Qrack::QINTERFACE_CPU);
-            qIType3 = use_opencl ? (use_stabilizer ? Qrack::QINTERFACE_OPTIMAL_SCHROEDINGER : Qrack::QINTERFACE_OPTIMAL_SINGLE_PAGE ) : Qrack::QINTERFACE_CPU;
-        } else {
-            qIType1 = use_stabilizer ? Qrack::QINTERFACE_STABILIZER_HYBRID : (use_opencl ? Qrack::QINTERFACE_OPTIMAL_SCHROEDINGER : Qrack::QINTERFACE_CPU);
-            qIType2 = use_opencl ? (use_stabilizer ? Qrack::QINTERFACE_OPTIMAL_SCHROEDINGER : Qrack::QINTERFACE_OPTIMAL_SINGLE_PAGE) : Qrack::QINTERFACE_CPU;
-            qIType3 = Qrack::QINTERFACE_OPTIMAL_SINGLE_PAGE;
+        if (config.layers.empty() || config.layers.size() > 3)
+        {
+            xacc::error("Qrack engine stack must have 1 to 3 layers.");
+        }
+        const auto layer = [&](size_t i) { return config.layers[std::min(i, config.layers.size() - 1)]; };
+        const Qrack::QInterfaceEngine qIType1 = layer(0), qIType2 = layer(1), qIType3 = layer(2);
+
+        m_engineKey.clear();
+        if (config.reuse_engine)
+        {
+            std::stringstream key;
+            key << qIType1 << "," << qIType2 << "," << qIType3 << ":" << config.device_id << ":" << config.doNormalize << ":" << config.zero_threshold << ":" << m_buffer->size();
+            m_engineKey = key.str();
+            std::lock_guard<std::mutex> lock(enginePoolMutex);
+            auto& engines = enginePool[m_engineKey];
+            if (!engines.empty())
+            {
+                m_qReg = engines.back();
+                engines.pop_back();
+                m_qReg->SetPermutation(0);
+                return;
+            }
         }
 
         m_qReg = MAKE_ENGINE(m_buffer->size(), 0);
@@ -82,6 +106,20 @@ namespace quantum {
 
     void QrackVisitor::finalize()
     {
+        // Back to the pool once the results are read
+        struct EngineReleaser
+        {
+            QrackVisitor& visitor;
+            ~EngineReleaser()
+            {
+                if (!visitor.m_engineKey.empty() && visitor.m_qReg)
+                {
+                    std::lock_guard<std::mutex> lock(enginePoolMutex);
+                    enginePool[visitor.m_engineKey].emplace_back(std::move(visitor.m_qReg));
+                }
+            }
+        } releaser{ *this };
+
         if (m_shots < 0)
         {
             const double expectedValueZ = calcExpectationValueZ();
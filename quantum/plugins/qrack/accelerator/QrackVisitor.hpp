@@ -32,9 +32,22 @@ using namespace xacc;
 
 namespace xacc {
 namespace quantum {
+// Qrack engine construction options
+struct QrackEngineConfig {
+  // From the outermost layer (e.g. QUnit) to the innermost one (e.g.
+  // OpenCL), up to 3 (the last one is repeated if fewer).
+  std::vector<Qrack::QInterfaceEngine> layers;
+  int device_id = -1;
+  bool doNormalize = false;
+  double zero_threshold = REAL1_EPSILON;
+  // Keep the engines in a process-wide pool between executes rather than
+  // allocating (OpenCL buffers, etc.) one per execute/shot.
+  bool reuse_engine = false;
+};
+
 class QrackVisitor : public AllGateVisitor, public OptionsProvider, public xacc::Cloneable<QrackVisitor> {
 public:
-  void initialize(std::shared_ptr<AcceleratorBuffer> buffer, int shots, bool use_opencl, bool use_qunit, bool use_opencl_multi, bool use_stabilizer, int device_id, bool doNormalize, double zero_threshold);
+  void initialize(std::shared_ptr<AcceleratorBuffer> buffer, int shots, const QrackEngineConfig& config);
   void finalize();
 
   void visit(Hadamard& h) override;
@@ -73,6 +86,9 @@ private:
   bool m_shotsMode;
   std::string m_bitString;
 
+  // Pool key of the engine when reused (empty otherwise)
+  std::string m_engineKey;
+
   double calcExpectationValueZ() const;
   std::map<bitCapInt, int> measure_shots();
 };
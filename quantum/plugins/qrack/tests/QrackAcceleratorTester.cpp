@@ -216,6 +216,30 @@ MEASURE 1 [1]
     }
 }
 
+TEST(QrackAcceleratorTester, testEngineLayers)
+{
+    const int nbShots = 100;
+    // CPU-only stack, engine reused across executes
+    auto accelerator = xacc::getAccelerator("qrack", { std::make_pair("shots", nbShots),
+        std::make_pair("engine_layers", std::vector<std::string>{ "qunit", "stabilizer-hybrid", "cpu" }),
+        std::make_pair("reuse_engine", true) });
+    auto quilCompiler = xacc::getCompiler("quil");
+    auto ir = quilCompiler->compile(R"(__qpu__ void testLayers(qbit q) {
+X 0
+CX 0 1
+MEASURE 0 [0]
+MEASURE 1 [1]
+})", accelerator);
+    for (int i = 0; i < 2; ++i)
+    {
+        // Reused engines are reset to |00>
+        auto buffer = xacc::qalloc(2);
+        accelerator->execute(buffer, ir->getComposites()[0]);
+        EXPECT_EQ(buffer->getMeasurementCounts().size(), 1);
+        EXPECT_EQ(buffer->getMeasurementCounts()["11"], nbShots);
+    }
+}
+
 TEST(QrackAcceleratorTester, testConditional)
 {
     // Get reference to the Accelerator
@@ -13,37 +13,22 @@
 #include "QsimAccelerator.hpp"
 #include "xacc_plugin.hpp"
 #include "IRUtils.hpp"
+#include "MeasurementSampler.hpp"
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <optional>
+#include <sstream>
+#include <thread>
 
 namespace {
 inline bool isMeasureGate(const xacc::InstPtr &in_instr) {
-  return (in_instr->name() == "Measure");
+  return (in_instr->opcode() == xacc::GateOpcode::Measure);
 }
 
-bool shotCountFromFinalStateVec(
-    const std::shared_ptr<xacc::CompositeInstruction> &in_composite) {
-  xacc::InstructionIterator it(in_composite);
-  bool measureAtTheEnd = true;
-  bool measureEncountered = false;
-
-  while (it.hasNext()) {
-    auto nextInst = it.next();
-    if (nextInst->isEnabled()) {
-      if (isMeasureGate(nextInst)) {
-        // Flag that we have seen a Measure gate.
-        measureEncountered = true;
-      }
-
-      // We have seen a Measure gate but this one is not another Measure gate.
-      if (measureEncountered && !isMeasureGate(nextInst)) {
-        measureAtTheEnd = false;
-      }
-    }
-  }
-
-  // If Measure gates are at the very end,
-  // this Composite can be simulated by random sampling from the state vec.
-  return measureAtTheEnd;
+// Memory footprint of nbStates (single precision) state vectors
+double stateBytes(size_t nbQubits, size_t nbStates = 1) {
+  return std::ldexp(sizeof(std::complex<float>) * nbStates, nbQubits);
 }
 
 // For debug:
@@ -68,7 +53,7 @@ void PrintAmplitudes(unsigned num_qubits, const StateSpace &state_space,
 // 1. Copy state onto scratch
 // 2. Evolve scratch forward with Z terms
 // 3. Compute < state | scratch >
-template <typename StateSpace, typename State>
+template <typename SimulatorT, typename StateSpace, typename State>
 double computeExpValZ(size_t num_threads, const std::vector<size_t> &meas_bits,
                       const StateSpace &state_space, const State &state) {
   auto scratch = state_space.Create(state.num_qubits());
@@ -85,12 +70,81 @@ double computeExpValZ(size_t num_threads, const std::vector<size_t> &meas_bits,
   auto fused_circuit =
       qsim::BasicGateFuser<qsim::IO, qsim::GateQSim<float>>().FuseGates(
           meas_circuit.num_qubits, meas_circuit.gates);
-  xacc::quantum::QsimAccelerator::Simulator sim(num_threads);
+  SimulatorT sim(num_threads);
   for (const auto &fused_gate : fused_circuit) {
     qsim::ApplyFusedGate(sim, fused_gate, scratch);
   }
   return state_space.RealInnerProduct(state, scratch);
 }
+
+// Newer qsim versions make the max size of fused gates configurable,
+// returns false if the runner parameter has no such field.
+template <typename ParamT>
+auto setMaxFusedSize(ParamT &io_param, unsigned in_size, int)
+    -> decltype(io_param.max_fused_size = in_size, bool()) {
+  io_param.max_fused_size = in_size;
+  return true;
+}
+
+template <typename ParamT>
+bool setMaxFusedSize(ParamT &io_param, unsigned in_size, long) {
+  return false;
+}
+
+template <typename SimulatorT> struct SimulatorTag {
+  using type = SimulatorT;
+};
+
+// Names of the vectorized simulators available in this build.
+std::vector<std::string> availableSimulators() {
+  std::vector<std::string> result;
+#ifdef __AVX2__
+  result.emplace_back("avx");
+#endif
+#ifdef __SSE4_1__
+  result.emplace_back("sse");
+#endif
+  result.emplace_back("basic");
+  return result;
+}
+
+#ifdef XACC_QSIM_GPU
+// The qsim circuit of the enabled gates of in_composite, and the measured
+// qubits.
+xacc::quantum::QsimCudaBackend::Circuit
+toQsimCircuit(const std::shared_ptr<xacc::CompositeInstruction> &in_composite,
+              size_t in_nbQubits, std::vector<size_t> &out_measured) {
+  xacc::quantum::QsimCircuitVisitor visitor(in_nbQubits);
+  xacc::InstructionIterator it(in_composite);
+  while (it.hasNext()) {
+    auto nextInst = it.next();
+    if (nextInst->isEnabled() && !nextInst->isComposite()) {
+      if (!isMeasureGate(nextInst)) {
+        nextInst->accept(&visitor);
+      } else {
+        out_measured.emplace_back(nextInst->bits()[0]);
+      }
+    }
+  }
+  return visitor.getQsimCircuit();
+}
+#endif
+
+// Invoke in_func with the tag of the selected qsim simulator type.
+template <typename Func>
+void withSimulator(const std::string &in_simType, Func &&in_func) {
+#ifdef __AVX2__
+  if (in_simType == "avx") {
+    return in_func(SimulatorTag<qsim::SimulatorAVX<qsim::For>>{});
+  }
+#endif
+#ifdef __SSE4_1__
+  if (in_simType == "sse") {
+    return in_func(SimulatorTag<qsim::SimulatorSSE<qsim::For>>{});
+  }
+#endif
+  return in_func(SimulatorTag<qsim::SimulatorBasic<qsim::For>>{});
+}
 } // namespace
 
 namespace xacc {
@@ -113,7 +167,11 @@ void QsimAccelerator::initialize(const HeterogeneousMap &params) {
   }
 
   if (params.keyExists<int>("threads")) {
-    m_qsimParam.num_threads = params.get<int>("threads");
+    const int nbThreads = params.get<int>("threads");
+    // Non-positive value: use all the hardware threads.
+    m_qsimParam.num_threads =
+        nbThreads > 0 ? nbThreads
+                      : std::max(1u, std::thread::hardware_concurrency());
   }
   // Enable VQE mode by default if not using shots.
   // Note: in VQE mode, only expectation values are computed.
@@ -124,14 +182,143 @@ void QsimAccelerator::initialize(const HeterogeneousMap &params) {
       xacc::info("Enable VQE Mode.");
     }
   }
+
+  // Vectorized simulator: default to the best one available (same as simmux).
+  const auto simulators = availableSimulators();
+  m_simType = simulators.front();
+  if (params.stringExists("simulator")) {
+    m_simType = params.getString("simulator");
+    if (std::find(simulators.begin(), simulators.end(), m_simType) ==
+        simulators.end()) {
+      std::stringstream ss;
+      ss << "Invalid 'simulator' parameter '" << m_simType
+         << "'. Available simulators in this build:";
+      for (const auto &sim : simulators) {
+        ss << " " << sim;
+      }
+      xacc::error(ss.str());
+    }
+  }
+
+  // CUDA simulator (if built with XACC_QSIM_GPU)
+  m_device = "cpu";
+  if (params.stringExists("device")) {
+    m_device = params.getString("device");
+    if (m_device != "cpu" && m_device != "gpu") {
+      xacc::error("Invalid 'device' parameter '" + m_device +
+                  "': must be cpu or gpu.");
+    }
+#ifndef XACC_QSIM_GPU
+    if (m_device == "gpu") {
+      xacc::error("'device: gpu' requires the qsim plugin built with "
+                  "XACC_QSIM_GPU (CUDA).");
+    }
+#else
+    if (m_device == "gpu" && !m_gpu) {
+      m_gpu = std::make_shared<QsimCudaBackend>();
+    }
+#endif
+  }
+
+  // qsim simulators store complex<float> amplitudes
+  if (params.stringExists("precision")) {
+    const auto precision = params.getString("precision");
+    if (precision == "double") {
+      xacc::warning("qsim only supports single precision simulation. "
+                    "Ignoring 'precision: double'.");
+    } else if (precision != "single") {
+      xacc::error("Invalid 'precision' parameter '" + precision +
+                  "': must be single or double.");
+    }
+  }
+  m_waveFuncExporter = nullptr;
+
+  // Max number of qubits of fused gates.
+  m_maxFusedSize = 2;
+  if (params.keyExists<int>("max-fused-size")) {
+    const int maxFusedSize = params.get<int>("max-fused-size");
+    if (maxFusedSize < 1) {
+      xacc::error("Invalid 'max-fused-size' parameter.");
+    }
+    m_maxFusedSize = maxFusedSize;
+    if (!setMaxFusedSize(m_qsimParam, m_maxFusedSize, 0)) {
+      xacc::warning("The qsim gate fuser of this build has a fixed maximum "
+                    "fused gate size (2 qubits). Ignoring 'max-fused-size'.");
+    }
+  }
+}
+
+template <typename RunnerT>
+typename RunnerT::Parameter QsimAccelerator::getRunnerParam() const {
+  typename RunnerT::Parameter param;
+  param.seed = m_qsimParam.seed;
+  param.num_threads = m_qsimParam.num_threads;
+  param.verbosity = m_qsimParam.verbosity;
+  setMaxFusedSize(param, m_maxFusedSize, 0);
+  return param;
 }
 
 void QsimAccelerator::execute(
     std::shared_ptr<AcceleratorBuffer> buffer,
     const std::shared_ptr<CompositeInstruction> compositeInstruction) {
+  ScopedExecutionMetrics metrics(*this, 1, m_shots);
+  metrics.metrics().peakMemoryBytes = stateBytes(buffer->size());
+#ifdef XACC_QSIM_GPU
+  if (runsOnGpu(compositeInstruction)) {
+    executeOnGpu(buffer, compositeInstruction);
+    // Copied from the device when requested
+    auto gpu = m_gpu;
+    m_waveFuncExporter = [gpu]() { return gpu->stateVector(); };
+    return;
+  }
+#endif
+  withSimulator(m_simType, [&](auto tag) {
+    using SimulatorT = typename decltype(tag)::type;
+    typename SimulatorT::StateSpace stateSpace(m_qsimParam.num_threads);
+    std::optional<typename SimulatorT::StateSpace::State> state;
+    this->template executeCircuit<SimulatorT>(buffer, compositeInstruction,
+                                              stateSpace, state);
+    m_waveFuncExporter = nullptr;
+    if (state.has_value()) {
+      // Keep the final state in single precision until it is requested.
+      using StateT = typename SimulatorT::StateSpace::State;
+      auto finalState = std::make_shared<StateT>(std::move(*state));
+      const unsigned nbThreads = m_qsimParam.num_threads;
+      m_waveFuncExporter = [finalState, nbThreads]() {
+        typename SimulatorT::StateSpace stateSpace(nbThreads);
+        const uint64_t size = uint64_t{1} << finalState->num_qubits();
+        ExecutionInfo::WaveFuncType waveFunc;
+        waveFunc.reserve(size);
+        for (uint64_t i = 0; i < size; ++i) {
+          const auto amp = stateSpace.GetAmpl(*finalState, i);
+          waveFunc.emplace_back(std::real(amp), std::imag(amp));
+        }
+        return waveFunc;
+      };
+    }
+  });
+}
+
+HeterogeneousMap QsimAccelerator::getExecutionInfo() const {
+  auto info = Accelerator::getExecutionInfo();
+  if (m_waveFuncExporter) {
+    info.insert(ExecutionInfo::WaveFuncKey,
+                std::make_shared<ExecutionInfo::WaveFuncType>(
+                    m_waveFuncExporter()));
+  }
+  return info;
+}
+
+template <typename SimulatorT>
+void QsimAccelerator::executeCircuit(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::shared_ptr<CompositeInstruction> compositeInstruction,
+    typename SimulatorT::StateSpace &stateSpace,
+    std::optional<typename SimulatorT::StateSpace::State> &io_state) {
+  using RunnerT = QsimRunner<SimulatorT>;
   const bool qsimSimulateSamples = m_shots > 0;
   const bool areAllMeasurementsTerminal =
-      shotCountFromFinalStateVec(compositeInstruction);
+      canSampleFromFinalState(compositeInstruction);
 
   if (!qsimSimulateSamples || areAllMeasurementsTerminal) {
     // Construct Qsim circuit:
@@ -152,11 +339,15 @@ void QsimAccelerator::execute(
     }
 
     auto circuit = visitor.getQsimCircuit();
-    StateSpace stateSpace(m_qsimParam.num_threads);
-    State state = stateSpace.Create(circuit.num_qubits);
+    // Reuse the state vector of the previous circuit (same width)
+    // rather than reallocating 2^n amplitudes.
+    if (!io_state.has_value() || io_state->num_qubits() != circuit.num_qubits) {
+      io_state.emplace(stateSpace.Create(circuit.num_qubits));
+    }
+    auto &state = *io_state;
     stateSpace.SetStateZero(state);
 
-    if (Runner::Run(m_qsimParam, circuit, state)) {
+    if (RunnerT::Run(getRunnerParam<RunnerT>(), circuit, state)) {
       // PrintAmplitudes(circuit.num_qubits, stateSpace, state);
       if (qsimSimulateSamples) {
         // Generate bit strings
@@ -173,7 +364,7 @@ void QsimAccelerator::execute(
           buffer->appendMeasurement(bitString);
         }
       } else {
-        const double expectedValueZ = computeExpValZ(
+        const double expectedValueZ = computeExpValZ<SimulatorT>(
             m_qsimParam.num_threads, measureBitIdxs, stateSpace, state);
         // Just add exp-val-z info
         buffer->addExtraInfo("exp-val-z", expectedValueZ);
@@ -215,12 +406,112 @@ void QsimAccelerator::execute(
     std::shared_ptr<AcceleratorBuffer> buffer,
     const std::vector<std::shared_ptr<CompositeInstruction>>
         compositeInstructions) {
+  ScopedExecutionMetrics metrics(*this, compositeInstructions.size(), m_shots);
+  // VQE mode: the ansatz state and a copy per observed sub-circuit
+  metrics.metrics().peakMemoryBytes = stateBytes(
+      buffer->size(), m_vqeMode && compositeInstructions.size() > 1 ? 2 : 1);
+  m_waveFuncExporter = nullptr;
+#ifdef XACC_QSIM_GPU
+  if (m_device == "gpu") {
+    executeBatchOnGpu(buffer, compositeInstructions);
+    return;
+  }
+#endif
+  withSimulator(m_simType, [&](auto tag) {
+    using SimulatorT = typename decltype(tag)::type;
+    this->template executeBatch<SimulatorT>(buffer, compositeInstructions);
+  });
+}
+
+#ifdef XACC_QSIM_GPU
+bool QsimAccelerator::runsOnGpu(
+    const std::shared_ptr<CompositeInstruction> &circuit) const {
+  // Intermediate measurements are simulated shot by shot (apply), on the CPU.
+  return m_device == "gpu" &&
+         (m_shots < 1 || canSampleFromFinalState(circuit));
+}
+
+void QsimAccelerator::executeOnGpu(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::shared_ptr<CompositeInstruction> circuit) {
+  std::vector<size_t> measureBitIdxs;
+  m_gpu->run(toQsimCircuit(circuit, buffer->size(), measureBitIdxs));
+  if (m_shots > 0) {
+    for (const auto &sample : m_gpu->sample(m_shots, m_qsimParam.seed)) {
+      std::string bitString;
+      for (const auto &bit : measureBitIdxs) {
+        const auto bit_mask = 1ULL << bit;
+        bitString.push_back((sample & bit_mask) == bit_mask ? '1' : '0');
+      }
+      buffer->appendMeasurement(bitString);
+    }
+  } else {
+    QsimCudaBackend::Circuit noBasisChange;
+    noBasisChange.num_qubits = buffer->size();
+    buffer->addExtraInfo("exp-val-z",
+                         m_gpu->expectationValueZ(noBasisChange,
+                                                  measureBitIdxs));
+  }
+}
+
+void QsimAccelerator::executeBatchOnGpu(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>> &circuits) {
+  if (m_vqeMode && circuits.size() > 1) {
+    xacc::info("Running VQE mode on the GPU");
+    auto kernelDecomposed = ObservedAnsatz::fromObservedComposites(circuits);
+    assert(kernelDecomposed.validate(circuits));
+    // The ansatz once, then each term on the resident state
+    std::vector<size_t> unused;
+    m_gpu->run(
+        toQsimCircuit(kernelDecomposed.getBase(), buffer->size(), unused));
+    for (auto &obsCircuit : kernelDecomposed.getObservedSubCircuits()) {
+      std::vector<size_t> measureBitIdxs;
+      const auto basisChange =
+          toQsimCircuit(obsCircuit, buffer->size(), measureBitIdxs);
+      auto tmpBuffer = std::make_shared<xacc::AcceleratorBuffer>(
+          obsCircuit->name(), buffer->size());
+      tmpBuffer->addExtraInfo(
+          "exp-val-z", m_gpu->expectationValueZ(basisChange, measureBitIdxs));
+      buffer->appendChild(obsCircuit->name(), tmpBuffer);
+    }
+    return;
+  }
+
+  for (auto &f : circuits) {
+    auto tmpBuffer =
+        std::make_shared<xacc::AcceleratorBuffer>(f->name(), buffer->size());
+    if (runsOnGpu(f)) {
+      executeOnGpu(tmpBuffer, f);
+    } else {
+      withSimulator(m_simType, [&](auto tag) {
+        using SimulatorT = typename decltype(tag)::type;
+        typename SimulatorT::StateSpace stateSpace(m_qsimParam.num_threads);
+        std::optional<typename SimulatorT::StateSpace::State> state;
+        this->template executeCircuit<SimulatorT>(tmpBuffer, f, stateSpace,
+                                                  state);
+      });
+    }
+    buffer->appendChild(f->name(), tmpBuffer);
+  }
+}
+#endif
+
+template <typename SimulatorT>
+void QsimAccelerator::executeBatch(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>>
+        &compositeInstructions) {
+  using RunnerT = QsimRunner<SimulatorT>;
+  typename SimulatorT::StateSpace stateSpace(m_qsimParam.num_threads);
   if (!m_vqeMode || compositeInstructions.size() <= 1) {
-    // Cannot run VQE mode, just run each composite independently.
+    // Cannot run VQE mode, just run each composite independently,
+    // sharing the state vector allocation.
+    std::optional<typename SimulatorT::StateSpace::State> state;
     for (auto &f : compositeInstructions) {
       auto tmpBuffer =
           std::make_shared<xacc::AcceleratorBuffer>(f->name(), buffer->size());
-      execute(tmpBuffer, f);
+      executeCircuit<SimulatorT>(tmpBuffer, f, stateSpace, state);
       buffer->appendChild(f->name(), tmpBuffer);
     }
   } else {
@@ -245,11 +536,11 @@ void QsimAccelerator::execute(
 
     // Run the base circuit:
     auto circuit = visitor.getQsimCircuit();
-    StateSpace stateSpace(m_qsimParam.num_threads);
-    State state = stateSpace.Create(circuit.num_qubits);
+    auto state = stateSpace.Create(circuit.num_qubits);
     stateSpace.SetStateZero(state);
 
-    const bool runOk = Runner::Run(m_qsimParam, circuit, state);
+    const bool runOk =
+        RunnerT::Run(getRunnerParam<RunnerT>(), circuit, state);
     assert(runOk);
 
     // Now we have a wavefunction that represents execution of the ansatz.
@@ -257,16 +548,19 @@ void QsimAccelerator::execute(
     for (int i = 0; i < obsCircuits.size(); ++i) {
       auto tmpBuffer = std::make_shared<xacc::AcceleratorBuffer>(
           obsCircuits[i]->name(), buffer->size());
-      const double e = getExpectationValueZ(obsCircuits[i], stateSpace, state);
+      const double e =
+          getExpectationValueZ<SimulatorT>(obsCircuits[i], stateSpace, state);
       tmpBuffer->addExtraInfo("exp-val-z", e);
       buffer->appendChild(obsCircuits[i]->name(), tmpBuffer);
     }
   }
 }
 
+template <typename SimulatorT>
 double QsimAccelerator::getExpectationValueZ(
     std::shared_ptr<CompositeInstruction> compositeInstruction,
-    const StateSpace &stateSpace, const State &state) const {
+    const typename SimulatorT::StateSpace &stateSpace,
+    const typename SimulatorT::StateSpace::State &state) const {
   // Construct Qsim circuit:
   QsimCircuitVisitor visitor(state.num_qubits());
   std::vector<size_t> measureBitIdxs;
@@ -293,15 +587,15 @@ double QsimAccelerator::getExpectationValueZ(
     auto fused_circuit =
         qsim::BasicGateFuser<qsim::IO, qsim::GateQSim<float>>().FuseGates(
             circuit.num_qubits, circuit.gates);
-    xacc::quantum::QsimAccelerator::Simulator sim(m_qsimParam.num_threads);
+    SimulatorT sim(m_qsimParam.num_threads);
     for (const auto &fused_gate : fused_circuit) {
       qsim::ApplyFusedGate(sim, fused_gate, scratch);
     }
-    return computeExpValZ(m_qsimParam.num_threads, measureBitIdxs, stateSpace,
-                          scratch);
+    return computeExpValZ<SimulatorT>(m_qsimParam.num_threads, measureBitIdxs,
+                                      stateSpace, scratch);
   } else {
-    return computeExpValZ(m_qsimParam.num_threads, measureBitIdxs, stateSpace,
-                          state);
+    return computeExpValZ<SimulatorT>(m_qsimParam.num_threads, measureBitIdxs,
+                                      stateSpace, state);
   }
 }
 
@@ -32,7 +32,19 @@
 #include "fuser_basic.h"
 #include "run_qsim.h"
 #include "simmux.h"
+#include "simulator_basic.h"
+#ifdef __SSE4_1__
+#include "simulator_sse.h"
+#endif
+#ifdef __AVX2__
+#include "simulator_avx.h"
+#endif
 #include "io_file.h"
+#ifdef XACC_QSIM_GPU
+#include "QsimCudaBackend.hpp"
+#endif
+#include <functional>
+#include <optional>
 
 namespace xacc {
 namespace quantum {
@@ -203,13 +215,17 @@ private:
 class QsimAccelerator : public Accelerator {
 public:
   // Qsim type:
+  // Note: execute() can select the simulator type at runtime ('simulator'
+  // option), apply() always uses the default one (simmux).
+  template <typename SimulatorT>
+  using QsimRunner =
+      qsim::QSimRunner<qsim::IO,
+                       qsim::BasicGateFuser<qsim::IO, qsim::GateQSim<float>>,
+                       SimulatorT>;
   using Simulator = qsim::Simulator<qsim::For>;
   using StateSpace = Simulator::StateSpace;
   using State = StateSpace::State;
-  using Runner =
-      qsim::QSimRunner<qsim::IO,
-                       qsim::BasicGateFuser<qsim::IO, qsim::GateQSim<float>>,
-                       Simulator>;
+  using Runner = QsimRunner<Simulator>;
 
   // Identifiable interface impls
   virtual const std::string name() const override { return "qsim"; }
@@ -226,6 +242,9 @@ public:
     return {};
   }
   virtual BitOrder getBitOrder() override { return BitOrder::MSB; }
+  // The state vector of the last executed circuit (WaveFuncKey), converted
+  // from single to double precision on each call.
+  virtual HeterogeneousMap getExecutionInfo() const override;
   virtual void execute(std::shared_ptr<AcceleratorBuffer> buffer,
                        const std::shared_ptr<CompositeInstruction>
                            compositeInstruction) override;
@@ -234,14 +253,51 @@ public:
                            compositeInstructions) override;
   virtual void apply(std::shared_ptr<AcceleratorBuffer> buffer,
                      std::shared_ptr<Instruction> inst) override;
+  // Batched apply, gate by gate on the same state
+  using Accelerator::apply;
 
 private:
+  // Simulate a circuit, the state vector is only (re)allocated
+  // if io_state is empty or has a different number of qubits.
+  template <typename SimulatorT>
+  void executeCircuit(
+      std::shared_ptr<AcceleratorBuffer> buffer,
+      const std::shared_ptr<CompositeInstruction> compositeInstruction,
+      typename SimulatorT::StateSpace &stateSpace,
+      std::optional<typename SimulatorT::StateSpace::State> &io_state);
+  template <typename SimulatorT>
+  void executeBatch(std::shared_ptr<AcceleratorBuffer> buffer,
+                    const std::vector<std::shared_ptr<CompositeInstruction>>
+                        &compositeInstructions);
+  template <typename SimulatorT>
   double getExpectationValueZ(
       std::shared_ptr<CompositeInstruction> compositeInstruction,
-      const StateSpace &stateSpace, const State &state) const;
+      const typename SimulatorT::StateSpace &stateSpace,
+      const typename SimulatorT::StateSpace::State &state) const;
+  template <typename RunnerT>
+  typename RunnerT::Parameter getRunnerParam() const;
+#ifdef XACC_QSIM_GPU
+  // 'device: gpu': circuits without intermediate measurements run on the
+  // CUDA simulator, the others on the CPU.
+  void executeOnGpu(std::shared_ptr<AcceleratorBuffer> buffer,
+                    const std::shared_ptr<CompositeInstruction> circuit);
+  void executeBatchOnGpu(
+      std::shared_ptr<AcceleratorBuffer> buffer,
+      const std::vector<std::shared_ptr<CompositeInstruction>> &circuits);
+  bool runsOnGpu(const std::shared_ptr<CompositeInstruction> &circuit) const;
+  // Persistent: the device state is only reallocated for another width.
+  std::shared_ptr<QsimCudaBackend> m_gpu;
+#endif
   Runner::Parameter m_qsimParam;
   int m_shots;
   bool m_vqeMode;
+  // Vectorized simulator type: "avx", "sse" or "basic"
+  std::string m_simType;
+  // "cpu" or "gpu"
+  std::string m_device = "cpu";
+  unsigned m_maxFusedSize = 2;
+  // Exports the (single precision) final state of the last executed circuit.
+  std::function<ExecutionInfo::WaveFuncType()> m_waveFuncExporter;
 };
 } // namespace quantum
 } // namespace xacc
@@ -0,0 +1,120 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "QsimCudaBackend.hpp"
+#include "fuser_basic.h"
+#include "io.h"
+#include "simulator_cuda.h"
+#include "xacc.hpp"
+#include <optional>
+
+namespace {
+using Simulator = qsim::SimulatorCUDA<float>;
+using StateSpace = Simulator::StateSpace;
+using State = StateSpace::State;
+using Fuser = qsim::BasicGateFuser<qsim::IO, qsim::GateQSim<float>>;
+
+void applyCircuit(const Simulator &in_sim,
+                  const xacc::quantum::QsimCudaBackend::Circuit &in_circuit,
+                  State &io_state) {
+  if (in_circuit.gates.empty()) {
+    return;
+  }
+  for (const auto &fusedGate :
+       Fuser().FuseGates(in_circuit.num_qubits, in_circuit.gates)) {
+    qsim::ApplyFusedGate(in_sim, fusedGate, io_state);
+  }
+}
+} // namespace
+
+namespace xacc {
+namespace quantum {
+struct QsimCudaBackend::Impl {
+  StateSpace stateSpace{StateSpace::Parameter()};
+  Simulator simulator;
+  std::optional<State> state;
+  std::optional<State> scratch;
+
+  // (Re)allocates in_state for in_nbQubits qubits
+  void allocate(std::optional<State> &io_state, unsigned in_nbQubits) {
+    if (!io_state.has_value() || io_state->num_qubits() != in_nbQubits) {
+      io_state.reset();
+      io_state.emplace(stateSpace.Create(in_nbQubits));
+      if (stateSpace.IsNull(*io_state)) {
+        io_state.reset();
+        xacc::error("qsim: could not allocate the " +
+                    std::to_string(in_nbQubits) +
+                    "-qubit state vector on the GPU.");
+      }
+    }
+  }
+};
+
+QsimCudaBackend::QsimCudaBackend() : m_impl(std::make_unique<Impl>()) {}
+QsimCudaBackend::~QsimCudaBackend() = default;
+
+void QsimCudaBackend::run(const Circuit &in_circuit) {
+  m_impl->allocate(m_impl->state, in_circuit.num_qubits);
+  m_impl->stateSpace.SetStateZero(*m_impl->state);
+  applyCircuit(m_impl->simulator, in_circuit, *m_impl->state);
+}
+
+double QsimCudaBackend::expectationValueZ(const Circuit &in_basisChange,
+                                          const std::vector<size_t> &in_bits) {
+  auto &state = *m_impl->state;
+  // U^dagger Z...Z U |psi>: only one scratch state, and <psi| it is the
+  // expectation value.
+  Circuit observed = in_basisChange;
+  observed.num_qubits = state.num_qubits();
+  unsigned time =
+      observed.gates.empty() ? 0 : observed.gates.back().time + 1;
+  for (const auto &bit : in_bits) {
+    observed.gates.emplace_back(qsim::GateZ<float>::Create(time++, bit));
+  }
+  for (auto iter = in_basisChange.gates.rbegin();
+       iter != in_basisChange.gates.rend(); ++iter) {
+    auto gate = *iter;
+    gate.time = time++;
+    qsim::MatrixDagger(unsigned{1} << gate.qubits.size(), gate.matrix);
+    observed.gates.emplace_back(std::move(gate));
+  }
+
+  m_impl->allocate(m_impl->scratch, state.num_qubits());
+  m_impl->stateSpace.Copy(state, *m_impl->scratch);
+  applyCircuit(m_impl->simulator, observed, *m_impl->scratch);
+  return m_impl->stateSpace.RealInnerProduct(state, *m_impl->scratch);
+}
+
+std::vector<uint64_t> QsimCudaBackend::sample(unsigned in_shots,
+                                              unsigned in_seed) {
+  return m_impl->stateSpace.Sample(*m_impl->state, in_shots, in_seed);
+}
+
+std::vector<std::complex<double>> QsimCudaBackend::stateVector() {
+  auto &state = *m_impl->state;
+  // The device layout is not the normal order: reordered on the scratch.
+  m_impl->allocate(m_impl->scratch, state.num_qubits());
+  m_impl->stateSpace.Copy(state, *m_impl->scratch);
+  m_impl->stateSpace.InternalToNormalOrder(*m_impl->scratch);
+  const uint64_t size = uint64_t{1} << state.num_qubits();
+  // MinSize: number of floats (re, im) of the state
+  std::vector<float> host(StateSpace::MinSize(state.num_qubits()));
+  m_impl->stateSpace.Copy(*m_impl->scratch, host.data());
+  std::vector<std::complex<double>> result;
+  result.reserve(size);
+  for (uint64_t i = 0; i < size; ++i) {
+    result.emplace_back(host[2 * i], host[2 * i + 1]);
+  }
+  return result;
+}
+} // namespace quantum
+} // namespace xacc
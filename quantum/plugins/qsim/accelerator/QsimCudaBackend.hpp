@@ -0,0 +1,54 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#pragma once
+#include "circuit.h"
+#include "gates_qsim.h"
+#include <complex>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace xacc {
+namespace quantum {
+// The qsim CUDA simulator ('device: gpu'), built with XACC_QSIM_GPU (the
+// implementation is compiled by nvcc). The state vector stays on the device
+// across calls: expectation values and samples only copy scalars back, the
+// amplitudes are copied on stateVector() only. The state and the scratch
+// state of the expectation values are only reallocated for another number
+// of qubits.
+class QsimCudaBackend {
+public:
+  using Circuit = qsim::Circuit<qsim::GateQSim<float>>;
+
+  QsimCudaBackend();
+  ~QsimCudaBackend();
+  QsimCudaBackend(const QsimCudaBackend &) = delete;
+  QsimCudaBackend &operator=(const QsimCudaBackend &) = delete;
+
+  // The state is |0...0> evolved by in_circuit, fused once
+  void run(const Circuit &in_circuit);
+  // <psi|U^dagger Z...Z U|psi>, the Z on in_bits, U the basis change
+  // in_basisChange (may be empty): computed on the scratch state, psi is
+  // unchanged.
+  double expectationValueZ(const Circuit &in_basisChange,
+                           const std::vector<size_t> &in_bits);
+  std::vector<uint64_t> sample(unsigned in_shots, unsigned in_seed);
+  // Copied from the device (normal order, qubit 0 least significant)
+  std::vector<std::complex<double>> stateVector();
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> m_impl;
+};
+} // namespace quantum
+} // namespace xacc
@@ -132,6 +132,47 @@ TEST(QsimAcceleratorTester, testDeuteron) {
   }
 }
 
+TEST(QsimAcceleratorTester, testBatchSimulatorOptions) {
+  auto xasmCompiler = xacc::getCompiler("xasm");
+  auto ir = xasmCompiler->compile(R"(__qpu__ void ansatz_batch(qbit q, double t) {
+      X(q[0]);
+      Ry(q[1], t);
+      CX(q[1], q[0]);
+      H(q[0]);
+      H(q[1]);
+      Measure(q[0]);
+      Measure(q[1]);
+    })");
+  auto program = ir->getComposite("ansatz_batch");
+  const auto angles = linspace(-xacc::constants::pi, xacc::constants::pi, 5);
+  std::vector<std::shared_ptr<xacc::CompositeInstruction>> circuits;
+  for (const auto &angle : angles) {
+    circuits.emplace_back(program->operator()({angle}));
+  }
+
+  // Reference: one circuit at a time with the default simulator.
+  auto reference = xacc::getAccelerator("qsim");
+  std::vector<double> expectedResults;
+  for (auto &circuit : circuits) {
+    auto buffer = xacc::qalloc(2);
+    reference->execute(buffer, circuit);
+    expectedResults.emplace_back(buffer->getExpectationValueZ());
+  }
+
+  // Batch execution (shared state vector) with the basic simulator,
+  // all hardware threads.
+  auto accelerator = xacc::getAccelerator(
+      "qsim",
+      {{"vqe-mode", false}, {"simulator", "basic"}, {"threads", -1}});
+  auto buffer = xacc::qalloc(2);
+  accelerator->execute(buffer, circuits);
+  auto children = buffer->getChildren();
+  EXPECT_EQ(children.size(), circuits.size());
+  for (size_t i = 0; i < children.size(); ++i) {
+    EXPECT_NEAR(children[i]->getExpectationValueZ(), expectedResults[i], 1e-6);
+  }
+}
+
 TEST(QsimAcceleratorTester, testISwap) {
   // Get reference to the Accelerator
   xacc::set_verbose(false);
@@ -225,6 +266,31 @@ TEST(QsimAcceleratorTester, testVqeMode) {
   EXPECT_NEAR((*buffer)["opt-val"].as<double>(), -1.74886, 1e-3);
 }
 
+TEST(QsimAcceleratorTester, testWaveFunction) {
+  auto accelerator =
+      xacc::getAccelerator("qsim", {{"precision", "single"}});
+  auto xasmCompiler = xacc::getCompiler("xasm");
+  auto program = xasmCompiler
+                     ->compile(R"(__qpu__ void testWaveFunc(qbit q) {
+      H(q[0]);
+      CNOT(q[0], q[1]);
+      X(q[2]);
+    })",
+                               accelerator)
+                     ->getComposites()[0];
+  auto buffer = xacc::qalloc(3);
+  accelerator->execute(buffer, program);
+  auto waveFunc = accelerator->getExecutionInfo<
+      xacc::ExecutionInfo::WaveFuncPtrType>(xacc::ExecutionInfo::WaveFuncKey);
+  ASSERT_EQ(waveFunc->size(), 8);
+  // (|100> + |111>)/sqrt(2), qubit 0 is the least significant bit.
+  for (size_t i = 0; i < waveFunc->size(); ++i) {
+    const double expected = (i == 4 || i == 7) ? M_SQRT1_2 : 0.0;
+    EXPECT_NEAR((*waveFunc)[i].real(), expected, 1e-6);
+    EXPECT_NEAR((*waveFunc)[i].imag(), 0.0, 1e-6);
+  }
+}
+
 TEST(QsimAcceleratorTester, testConditional) {
   const int nbTests = 100;
   auto accelerator = xacc::getAccelerator("qsim", {{"shots", nbTests}});
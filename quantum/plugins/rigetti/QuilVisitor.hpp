@@ -15,6 +15,7 @@
 
 #include <memory>
 #include "AllGateVisitor.hpp"
+#include "Emitter.hpp"
 #include "xacc.hpp"
 
 namespace xacc {
@@ -23,10 +24,10 @@ namespace quantum {
 class QuilVisitor : public AllGateVisitor {
 protected:
 
-  std::string quilStr;
+  Emitter quilStr;
   constexpr static double pi = 3.1415926;
 
-  std::string classicalAddresses;
+  Emitter classicalAddresses;
 
   std::map<int, int> qubitToClassicalBitIndex;
 
@@ -43,9 +44,8 @@ public:
   QuilVisitor(bool measures, bool retain) : includeMeasures(measures), retain_xacc_gates(retain) {}
 
   void visit(Hadamard &h) {
-    std::string qubit = std::to_string(h.bits()[0]);
     if (retain_xacc_gates) {
-      quilStr += "H " + qubit + "\n";
+      quilStr << "H " << h.bits()[0] << '\n';
     } else {
       Rz rz1(h.bits()[0], xacc::constants::pi/2.);
       Rx rx1(h.bits()[0], xacc::constants::pi/2.);
@@ -57,23 +57,15 @@ public:
     }
   }
 
-  void visit(Identity &i) {
-    std::string qubit = std::to_string(i.bits()[0]);
-    quilStr += "I " + qubit + "\n";
-  }
+  void visit(Identity &i) { quilStr << "I " << i.bits()[0] << '\n'; }
 
   void visit(CZ &cz) {
-    std::string q1 = std::to_string(cz.bits()[0]);
-    std::string q2 = std::to_string(cz.bits()[1]);
-    quilStr += "CZ " + q1 + " " +
-               q2 + "\n";
+    quilStr << "CZ " << cz.bits()[0] << ' ' << cz.bits()[1] << '\n';
   }
 
   void visit(CNOT &cn) {
-    std::string q1 = std::to_string(cn.bits()[0]);
-    std::string q2 = std::to_string(cn.bits()[1]);
     if (retain_xacc_gates) {
-      quilStr += "CNOT " + q1 + " " + q2 + "\n";
+      quilStr << "CNOT " << cn.bits()[0] << ' ' << cn.bits()[1] << '\n';
     } else {
       Rz rz1(cn.bits()[1], -xacc::constants::pi/2.);
       Rx rx1(cn.bits()[1], xacc::constants::pi/2.);
@@ -91,26 +83,21 @@ public:
     }
   }
 
-  void visit(X &x) {
-      std::string qubit = std::to_string(x.bits()[0]);
-      auto angleStr = std::to_string(pi);
-      quilStr += "RX(pi) " + qubit + "\n"; }
+  void visit(X &x) { quilStr << "RX(pi) " << x.bits()[0] << '\n'; }
 
   void visit(Y &y) {
-      std::string qubit = std::to_string(y.bits()[0]);
-      quilStr += "RZ(pi) " + qubit + "\nRX(pi) " + qubit + "\n"; }
+    quilStr << "RZ(pi) " << y.bits()[0] << "\nRX(pi) " << y.bits()[0] << '\n';
+  }
 
-  void visit(Z &z) {
-      std::string qubit = std::to_string(z.bits()[0]);
-      quilStr += "RZ(pi) " + qubit + "\n"; }
+  void visit(Z &z) { quilStr << "RZ(pi) " << z.bits()[0] << '\n'; }
   int countMeasures = 0;
   void visit(Measure &m) {
     if (includeMeasures) {
       int classicalBitIdx = m.getClassicalBitIndex();
-      quilStr += "MEASURE " + std::to_string(m.bits()[0]) + " ro[" +
-                 std::to_string(countMeasures) + "]\n";
+      quilStr << "MEASURE " << m.bits()[0] << " ro[" << countMeasures
+              << "]\n";
      countMeasures++;
-      classicalAddresses += std::to_string(classicalBitIdx) + ", ";
+      classicalAddresses << classicalBitIdx << ", ";
       numAddresses++;
       qubitToClassicalBitIndex.insert(
           std::make_pair(m.bits()[0], classicalBitIdx));
@@ -121,29 +108,28 @@ public:
   }
 
   void visit(Rx &rx) {
-    std::string qubit = std::to_string(rx.bits()[0]);
-    auto angleStr = rx.getParameter(0).toString();
+    const auto qubit = rx.bits()[0];
+    const auto &angle = rx.getParameter(0);
 
     auto angleDouble = rx.getParameter(0).as<double>();
     
     if (retain_xacc_gates) {
-      quilStr += "RX("+angleStr+") " + qubit + "\n";
+      quilStr << "RX(" << angle << ") " << qubit << '\n';
     } else {
       if (std::fabs(std::fmod(angleDouble, xacc::constants::pi)) < 1e-6 || std::fabs(std::fmod(angleDouble,xacc::constants::pi/2.)) < 1e-6) {
-        quilStr += "RX("+angleStr+") " + qubit + "\n";
+        quilStr << "RX(" << angle << ") " << qubit << '\n';
       } else {
         // decompose into rigetti gate set
-        quilStr += "RZ(pi/2) " + qubit + "\nRX(pi/2) " + qubit +"\nRZ(" + angleStr + ") " + qubit + "\nRX(-pi/2) " + qubit + "\nRZ(-pi/2) "+ qubit + "\n";
+        quilStr << "RZ(pi/2) " << qubit << "\nRX(pi/2) " << qubit << "\nRZ("
+                << angle << ") " << qubit << "\nRX(-pi/2) " << qubit
+                << "\nRZ(-pi/2) " << qubit << '\n';
       }
     }
   }
 
   void visit(Ry &ry) {
-    auto angleStr = ry.getParameter(0).toString();
-    std::string qubit = std::to_string(ry.bits()[0]);
-      
     if (retain_xacc_gates) {
-        quilStr += "RY("+angleStr+") " + qubit + "\n";
+      quilStr << "RY(" << ry.getParameter(0) << ") " << ry.bits()[0] << '\n';
     } else {
       Rx rx1(ry.bits()[0], xacc::constants::pi/2.);
       Rz rz1(ry.bits()[0], ry.getParameter(0).as<double>());
@@ -157,17 +143,12 @@ public:
   }
 
   void visit(Rz &rz) {
-    std::string qubit = std::to_string(rz.bits()[0]);
-    auto angleStr = rz.getParameter(0).toString();
-    quilStr += "RZ(" + angleStr + ") " + qubit + "\n";
+    quilStr << "RZ(" << rz.getParameter(0) << ") " << rz.bits()[0] << '\n';
   }
 
   void visit(CPhase &cp) {
-    std::string q1 = std::to_string(cp.bits()[0]);
-    std::string q2 = std::to_string(cp.bits()[1]);
-    auto angleStr = cp.getParameter(0).toString();
-    quilStr += "CPHASE(" + angleStr + ") " + q1 +
-               " " + q2 + "\n";
+    quilStr << "CPHASE(" << cp.getParameter(0) << ") " << cp.bits()[0] << ' '
+            << cp.bits()[1] << '\n';
   }
 
   void visit(Swap &s) {
@@ -204,23 +185,34 @@ public:
   }
 
   void visit(XY& xy) override {
-    auto angleStr = xy.getParameter(0).toString();
-    std::string ctrl = std::to_string(xy.bits()[0]);
-    std::string tgt = std::to_string(xy.bits()[1]);
-    quilStr += "XY("+angleStr+") " +ctrl + " " + tgt + "\n";
+    quilStr << "XY(" << xy.getParameter(0) << ") " << xy.bits()[0] << ' '
+            << xy.bits()[1] << '\n';
   }
 
   /**
    * Return the quil string
    */
-  std::string getQuilString() { return quilStr; }
+  std::string getQuilString() { return quilStr.str(); }
+
+  /**
+   * Presize the quil string for about nbGates gates
+   */
+  void reserve(size_t nbGates) { quilStr.reserve(nbGates * 16); }
+
+  /**
+   * Write the quil program to out rather than to the quil string
+   * (flushed by flushQuil())
+   */
+  void streamTo(std::ostream &out) { quilStr = Emitter(out); }
+  void flushQuil() { quilStr.flush(); }
 
   /**
    * Return the classical measurement indices
    * as a json int array represented as a string.
    */
   std::string getClassicalAddresses() {
-    auto retStr = classicalAddresses.substr(0, classicalAddresses.size() - 2);
+    const auto &addresses = classicalAddresses.str();
+    auto retStr = addresses.substr(0, addresses.size() - 2);
     return "[" + retStr + "]";
   }
 
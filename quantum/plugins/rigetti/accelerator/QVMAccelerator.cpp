@@ -23,9 +23,46 @@ using namespace rapidjson;
 namespace xacc {
 namespace quantum {
 
+void QVMAccelerator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>> functions) {
+  std::vector<std::shared_ptr<AcceleratorBuffer>> tmpBuffers;
+  std::vector<std::string> requests;
+  std::vector<std::vector<int>> measurementSupports(functions.size());
+  for (std::size_t i = 0; i < functions.size(); ++i) {
+    xacc::info("QVM Executing kernel = " + functions[i]->name());
+    tmpBuffers.emplace_back(std::make_shared<AcceleratorBuffer>(
+        buffer->name() + std::to_string(i), buffer->size()));
+    requests.emplace_back(
+        createRequest(tmpBuffers[i], functions[i], measurementSupports[i]));
+  }
+
+  std::vector<std::string> responses(functions.size());
+  runConcurrently(functions.size(), maxRequestsInFlight, [&](std::size_t i) {
+    responses[i] =
+        handleExceptionRestClientPost(remoteUrl, postPath, requests[i], headers);
+  });
+
+  for (std::size_t i = 0; i < functions.size(); ++i) {
+    decodeResponse(tmpBuffers[i], responses[i], measurementSupports[i]);
+    buffer->appendChild(tmpBuffers[i]->name(), tmpBuffers[i]);
+  }
+}
+
 const std::string QVMAccelerator::processInput(
     std::shared_ptr<AcceleratorBuffer> buffer,
     std::vector<std::shared_ptr<CompositeInstruction>> functions) {
+  if (functions.size() > 1)
+    xacc::error("Rigetti QVMAccelerator can only launch one job at a time.");
+
+  currentMeasurementSupports.clear();
+  return createRequest(buffer, functions[0], currentMeasurementSupports);
+}
+
+std::string QVMAccelerator::createRequest(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    std::shared_ptr<CompositeInstruction> function,
+    std::vector<int> &out_measurementSupports) {
   // Get the runtime options map, and initialize
   // some basic variables we are going to need
   std::string type = "multishot";
@@ -57,17 +94,14 @@ const std::string QVMAccelerator::processInput(
     trials = xacc::getOption("rigetti-shots");
   }
 
-  if (functions.size() > 1)
-    xacc::error("Rigetti QVMAccelerator can only launch one job at a time.");
-
-  InstructionIterator it(functions[0]);
+  InstructionIterator it(function);
   while (it.hasNext()) {
     // Get the next node in the tree
     auto nextInst = it.next();
     if (nextInst->isEnabled()) {
       nextInst->accept(visitor);
       if (nextInst->name() == "Measure") {
-        currentMeasurementSupports.push_back(nextInst->bits()[0]);
+        out_measurementSupports.push_back(nextInst->bits()[0]);
       }
     }
   }
@@ -90,6 +124,13 @@ const std::string QVMAccelerator::processInput(
 void
 QVMAccelerator::processResponse(std::shared_ptr<AcceleratorBuffer> buffer,
                                     const std::string &response) {
+  decodeResponse(buffer, response, currentMeasurementSupports);
+  currentMeasurementSupports.clear();
+}
+
+void QVMAccelerator::decodeResponse(
+    std::shared_ptr<AcceleratorBuffer> buffer, const std::string &response,
+    const std::vector<int> &measurementSupports) {
 //   xacc::info(response);
 
   Document document;;
@@ -102,7 +143,7 @@ QVMAccelerator::processResponse(std::shared_ptr<AcceleratorBuffer> buffer,
     for (int i = 0; i < buffer->size(); ++i)
         bitString += "0";
     for (SizeType j = 0; j < results[i].Size(); ++j){
-        bitString.replace(buffer->size() - currentMeasurementSupports[j] - 1, 1, std::to_string(results[i][j].GetInt()));
+        bitString.replace(buffer->size() - measurementSupports[j] - 1, 1, std::to_string(results[i][j].GetInt()));
     }
     if (counts.find(bitString) != counts.end()) {
         counts[bitString]++;
@@ -114,10 +155,6 @@ QVMAccelerator::processResponse(std::shared_ptr<AcceleratorBuffer> buffer,
   for (auto &kv : counts) {
     buffer->appendMeasurement(kv.first, kv.second);
   }
-
-  currentMeasurementSupports.clear();
-
-  return;
 }
 
 } // namespace quantum
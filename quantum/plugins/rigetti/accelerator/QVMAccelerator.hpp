@@ -39,32 +39,24 @@ public:
       : RemoteAccelerator(client) {}
   const std::string getSignature() override {return name()+":";}
 
+  // The kernels are posted concurrently, up to "max-requests-in-flight"
+  // (default 8) at a time.
   void
   execute(std::shared_ptr<AcceleratorBuffer> buffer,
-          const std::vector<std::shared_ptr<CompositeInstruction>> functions) override {
-    int counter = 0;
-    std::vector<std::shared_ptr<AcceleratorBuffer>> tmpBuffers;
-    for (auto f : functions) {
-      xacc::info("QVM Executing kernel = " + f->name());
-      auto tmpBuffer = std::make_shared<AcceleratorBuffer>(buffer->name() + std::to_string(counter),
-                                    buffer->size());
-      RemoteAccelerator::execute(tmpBuffer, f);
-      tmpBuffers.push_back(tmpBuffer);
-      buffer->appendChild(tmpBuffer->name(), tmpBuffer);
-      counter++;
-    }
+          const std::vector<std::shared_ptr<CompositeInstruction>> functions) override;
 
-    return;
+  void initialize(const HeterogeneousMap& params = {}) override {
+    updateConfiguration(params);
   }
-
-  void initialize(const HeterogeneousMap& params = {}) override {}
   const std::vector<std::string> configurationKeys() override {
-      return {};
+      return {"max-requests-in-flight"};
   }
   void updateConfiguration(const HeterogeneousMap &config) override {
+    if (config.keyExists<int>("max-requests-in-flight")) {
+      maxRequestsInFlight = config.get<int>("max-requests-in-flight");
+    }
   }
 
-
   const std::string
   processInput(std::shared_ptr<AcceleratorBuffer> buffer,
                std::vector<std::shared_ptr<CompositeInstruction>> functions) override;
@@ -83,7 +75,17 @@ public:
   virtual ~QVMAccelerator() {}
 
 private:
+  // Sets up the request headers and URL, then maps the kernel to the QVM
+  // JSON request, out_measurementSupports being its measured qubits.
+  std::string createRequest(std::shared_ptr<AcceleratorBuffer> buffer,
+                            std::shared_ptr<CompositeInstruction> function,
+                            std::vector<int> &out_measurementSupports);
+  void decodeResponse(std::shared_ptr<AcceleratorBuffer> buffer,
+                      const std::string &response,
+                      const std::vector<int> &measurementSupports);
+
   std::vector<int> currentMeasurementSupports;
+  int maxRequestsInFlight = 8;
 
 };
 
@@ -19,6 +19,7 @@
 #include "QuilToXACCListener.hpp"
 #include "QuilErrorListener.hpp"
 #include "xacc_service.hpp"
+#include "AntlrParseCache.hpp"
 
 using namespace quil;
 using namespace antlr4;
@@ -26,6 +27,7 @@ using namespace antlr4;
 namespace xacc {
 
 namespace quantum {
+using QuilParseCache = AntlrParseCache<QuilLexer, QuilParser>;
 
 QuilCompiler::QuilCompiler() = default;
 
@@ -60,21 +62,19 @@ bool QuilCompiler::canParse(const std::string &src) {
 std::shared_ptr<IR> QuilCompiler::compile(const std::string &src,
                                           std::shared_ptr<Accelerator> acc) {
 //  std::cout << "SRC: " << src << "\n";
-  ANTLRInputStream input(src);
-  QuilLexer lexer(&input);
-  CommonTokenStream tokens(&lexer);
-  QuilParser parser(&tokens);
-  parser.removeErrorListeners();
-  auto e = new QuilErrorListener();
-  parser.addErrorListener(e);
+  QuilErrorListener el;
+  auto parse = QuilParseCache::instance().get(
+      src, [&](QuilParseCache::Parse &p) {
+        p.parser.removeErrorListeners();
+        p.parser.addErrorListener(&el);
+        return p.parser.xaccsrc();
+      });
 
   auto ir = xacc::getService<IRProvider>("quantum")->createIR();
 
-  tree::ParseTree *tree = parser.xaccsrc();
   QuilToXACCListener listener;
-  tree::ParseTreeWalker::DEFAULT.walk(&listener, tree);
+  tree::ParseTreeWalker::DEFAULT.walk(&listener, parse->tree);
 
-  delete e;
   auto f = listener.getFunction();
   xacc::appendCompiled(f);
 
@@ -88,6 +88,7 @@ std::shared_ptr<IR> QuilCompiler::compile(const std::string &src) {
 const std::string
 QuilCompiler::translate(std::shared_ptr<CompositeInstruction> function) {
   auto visitor = std::make_shared<QuilVisitor>();
+  visitor->reserve(function->nInstructions());
   InstructionIterator it(function);
   while (it.hasNext()) {
     // Get the next node in the tree
@@ -100,6 +101,20 @@ QuilCompiler::translate(std::shared_ptr<CompositeInstruction> function) {
   return visitor->getQuilString();
 }
 
+void QuilCompiler::translateStream(
+    std::shared_ptr<CompositeInstruction> function, std::ostream &out) {
+  auto visitor = std::make_shared<QuilVisitor>();
+  visitor->streamTo(out);
+  InstructionIterator it(function);
+  while (it.hasNext()) {
+    auto nextInst = it.next();
+    if (nextInst->isEnabled()) {
+      nextInst->accept(visitor);
+    }
+  }
+  visitor->flushQuil();
+}
+
 } // namespace quantum
 
 } // namespace xacc
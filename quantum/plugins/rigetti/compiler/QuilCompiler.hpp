@@ -52,6 +52,8 @@ public:
    * @return src The source code as a string
    */
   virtual const std::string translate(std::shared_ptr<CompositeInstruction> function);
+  void translateStream(std::shared_ptr<CompositeInstruction> function,
+                       std::ostream &out) override;
 
   virtual const std::string name() const { return "quil"; }
 
@@ -19,7 +19,44 @@
 #include <Eigen/Dense>
 #include <regex>
 #include <chrono>
-#include <cpr/cpr.h>
+#include <deque>
+
+namespace {
+// Replaces the numeric RZ angles of native Quil lines by references to a
+// theta memory region, so that programs differing only by those angles have
+// the same text. The angles are returned in region order.
+std::string parameterizeAngles(const std::string &in_quil,
+                               std::vector<double> &out_angles) {
+  std::string result;
+  for (const auto &line : xacc::split(in_quil, '\n')) {
+    const auto close = line.find(')');
+    if (line.rfind("RZ(", 0) == 0 && close != std::string::npos) {
+      const auto angleStr = line.substr(3, close - 3);
+      size_t pos = 0;
+      double angle = 0.0;
+      try {
+        angle = std::stod(angleStr, &pos);
+      } catch (...) {
+        pos = 0;
+      }
+      if (pos > 0 && pos == angleStr.size()) {
+        result += "RZ(theta[" + std::to_string(out_angles.size()) + "])" +
+                  line.substr(close + 1) + "\n";
+        out_angles.emplace_back(angle);
+        continue;
+      }
+    }
+    if (!line.empty()) {
+      result += line + "\n";
+    }
+  }
+  if (!out_angles.empty()) {
+    result = "DECLARE theta REAL[" + std::to_string(out_angles.size()) +
+             "]\n" + result;
+  }
+  return result;
+}
+} // namespace
 
 namespace xacc {
 namespace quantum {
@@ -95,13 +132,29 @@ result = str(np)
 void QCSAccelerator::execute(
     std::shared_ptr<AcceleratorBuffer> buffer,
     const std::vector<std::shared_ptr<CompositeInstruction>> functions) {
+  std::vector<std::shared_ptr<AcceleratorBuffer>> tmpBuffers;
   for (auto f : functions) {
-    auto tmpBuffer =
-        std::make_shared<AcceleratorBuffer>(f->name(), buffer->size());
-    execute(tmpBuffer, f);
-    buffer->appendChild(tmpBuffer->name(), tmpBuffer);
+    tmpBuffers.emplace_back(
+        std::make_shared<AcceleratorBuffer>(f->name(), buffer->size()));
+  }
+  std::vector<NativeProgram> programs;
+  std::vector<std::string> binaries;
+  compilePrograms(tmpBuffers, functions, programs, binaries);
+
+  // Keep up to maxJobsInFlight programs queued on the QPU
+  std::deque<py::dict> jobs;
+  std::size_t nextToQueue = 0;
+  for (std::size_t i = 0; i < programs.size(); ++i) {
+    while (nextToQueue < programs.size() &&
+           nextToQueue < i + std::max(maxJobsInFlight, 1)) {
+      jobs.emplace_back(
+          queueProgram(binaries[nextToQueue], programs[nextToQueue].angles));
+      ++nextToQueue;
+    }
+    retrieveJobResults(tmpBuffers[i], jobs.front());
+    jobs.pop_front();
+    buffer->appendChild(tmpBuffers[i]->name(), tmpBuffers[i]);
   }
-  return;
 }
 
 void QCSAccelerator::initialize(const HeterogeneousMap &params) {
@@ -205,9 +258,71 @@ void QCSAccelerator::_internal_init() {
 void QCSAccelerator::execute(
     std::shared_ptr<AcceleratorBuffer> buffer,
     const std::shared_ptr<CompositeInstruction> function) {
+  auto job = submitJob(buffer, function);
+  retrieveJobResults(buffer, job);
+}
 
-  using json = nlohmann::json;
+std::future<void> QCSAccelerator::executeAsync(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::shared_ptr<CompositeInstruction> function) {
+  auto job = submitJob(buffer, function);
+  // Retrieval runs Python, so it is deferred to the
+  // thread that waits on the future (the GIL holder).
+  return std::async(std::launch::deferred,
+                    [this, buffer, job]() { retrieveJobResults(buffer, job); });
+}
 
+std::future<void> QCSAccelerator::executeAsync(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>> functions) {
+  std::vector<std::shared_ptr<AcceleratorBuffer>> tmpBuffers;
+  for (auto f : functions) {
+    tmpBuffers.emplace_back(
+        std::make_shared<AcceleratorBuffer>(f->name(), buffer->size()));
+  }
+  std::vector<NativeProgram> programs;
+  std::vector<std::string> binaries;
+  compilePrograms(tmpBuffers, functions, programs, binaries);
+
+  // Queue every program on the QPU up front
+  std::vector<std::pair<std::shared_ptr<AcceleratorBuffer>, py::dict>> jobs;
+  for (std::size_t i = 0; i < programs.size(); ++i) {
+    jobs.emplace_back(tmpBuffers[i],
+                      queueProgram(binaries[i], programs[i].angles));
+  }
+  return std::async(std::launch::deferred, [this, buffer, jobs]() {
+    for (auto &[tmpBuffer, job] : jobs) {
+      retrieveJobResults(tmpBuffer, job);
+      buffer->appendChild(tmpBuffer->name(), tmpBuffer);
+    }
+  });
+}
+
+py::dict QCSAccelerator::submitJob(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::shared_ptr<CompositeInstruction> function) {
+  auto program = toNativeProgram(buffer, function);
+  return queueProgram(getBinary(program), program.angles);
+}
+
+void QCSAccelerator::compilePrograms(
+    const std::vector<std::shared_ptr<AcceleratorBuffer>> &buffers,
+    const std::vector<std::shared_ptr<CompositeInstruction>> &functions,
+    std::vector<NativeProgram> &out_programs,
+    std::vector<std::string> &out_binaries) {
+  for (std::size_t i = 0; i < functions.size(); ++i) {
+    out_programs.emplace_back(toNativeProgram(buffers[i], functions[i]));
+  }
+  // Only HTTP requests, no Python: the uncached ones run concurrently
+  out_binaries.resize(out_programs.size());
+  runConcurrently(out_programs.size(), maxJobsInFlight, [&](std::size_t i) {
+    out_binaries[i] = getBinary(out_programs[i]);
+  });
+}
+
+QCSAccelerator::NativeProgram QCSAccelerator::toNativeProgram(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::shared_ptr<CompositeInstruction> function) {
   // Map IR to Native Quil string
   auto visitor = std::make_shared<QuilVisitor>(true);
   InstructionIterator it(function);
@@ -218,22 +333,40 @@ void QCSAccelerator::execute(
     }
   }
     
-  CountGatesOfTypeVisitor<Measure> count(function);
-  int nMeasures = count.countGates();
   auto quilStr = visitor->getQuilString();
   quilStr =
       "DECLARE ro BIT[" + std::to_string(buffer->size()) + "]\n" + quilStr;
   
 //   std::cout << "\nBefore Quil Program:\n" << quilStr << "\n";
 
+  // The RZ angles are bound at execution time: circuits that only differ
+  // by them (e.g. successive VQE iterations) share one binary.
+  NativeProgram program;
+  if (parametricCompilation) {
+    quilStr = parameterizeAngles(quilStr, program.angles);
+  }
+
   quilStr = std::regex_replace(quilStr, std::regex("1.5708"), "pi/2");
   quilStr = std::regex_replace(quilStr, std::regex("3.14159"), "pi");
 
 //   std::cout << "\nAfter Quil Program:\n" << quilStr << "\n";
+  program.quil = quilStr;
+  return program;
+}
+
+std::string QCSAccelerator::getBinary(const NativeProgram &program) {
+  const auto cacheKey =
+      backend + ":" + std::to_string(shots) + "\n" + program.quil;
+  {
+    std::lock_guard<std::mutex> guard(binaryCacheLock);
+    auto cached = binaryCache.find(cacheKey);
+    if (cached != binaryCache.end()) {
+      return cached->second;
+    }
+  }
 
-    
   json j;
-  j["quil"] = quilStr;
+  j["quil"] = program.quil;
   j["num_shots"] = shots;
   j["_type"] = "QuilBinaryExecutableRequest";
   std::string json_data = j.dump();
@@ -246,10 +379,33 @@ void QCSAccelerator::execute(
   auto resp = post(qpu_compiler_endpoint,
                    "/devices/" + backend + "/native_quil_to_binary", json_data,
                    headers);
-  std::string prog = json::parse(resp)["program"].get<std::string>();
+  auto binary = json::parse(resp)["program"].get<std::string>();
+
+  std::lock_guard<std::mutex> guard(binaryCacheLock);
+  if (binaryCache.size() >= MAX_CACHED_BINARIES) {
+    binaryCache.clear();
+  }
+  binaryCache.emplace(cacheKey, binary);
+  return binary;
+}
+
+py::dict QCSAccelerator::queueProgram(const std::string &binary,
+                                      const std::vector<double> &angles) {
+  const auto submitted = std::chrono::steady_clock::now();
+  auto patchValues = py::dict();
+  if (!angles.empty()) {
+    py::list theta;
+    for (const auto angle : angles) {
+      theta.append(angle);
+    }
+    patchValues["theta"] = theta;
+  }
 
   auto locals = py::dict();
-  locals["program"] = prog;
+  locals["program"] = binary;
+  locals["patch_values"] = patchValues;
+  // The RPC client (and its connection) is created once
+  locals["client"] = rpcClient ? rpcClient : py::none();
   locals["client_public_key"] = py::bytes(client_public);
   locals["client_secret_key"] = py::bytes(client_secret);
   locals["server_public_key"] = py::bytes(server_public);
@@ -264,27 +420,49 @@ import uuid, numpy as np
 from rpcq._client import Client, ClientAuthConfig
 from rpcq.messages import QuiltBinaryExecutableResponse, QPURequest
 
-client = None
-if locals()['use_rpcq_auth_config']:
+client = locals()['client']
+if client is None and locals()['use_rpcq_auth_config']:
     auth = ClientAuthConfig(client_public_key=locals()['client_public_key'],
                      client_secret_key=locals()['client_secret_key'],
                      server_public_key=locals()['server_public_key'])
     client = Client(locals()['endpoint'], auth_config=auth)
-else: 
+elif client is None:
     client = Client(locals()['endpoint'])
 
-request = QPURequest(program=locals()['program'], patch_values={}, id=str(uuid.uuid4()))
+request = QPURequest(program=locals()['program'], patch_values=locals()['patch_values'], id=str(uuid.uuid4()))
 job_id = client.call('execute_qpu_request', request=request, user=locals()['userId'], priority=1)
-buffers = client.call("get_buffers", job_id, wait=True)
+)#";
+
+  // return;
+  try {
+    py::exec(py_src, py::globals(), locals);
+  } catch (std::exception &e) {
+    std::stringstream ss;
+    ss << "XACC QCS Exec Error:\n";
+    ss << e.what();
+    xacc::error(ss.str());
+  }
+
+  rpcClient = locals["client"];
+  // For the metrics of the job
+  locals["submitted"] =
+      static_cast<int64_t>(submitted.time_since_epoch().count());
+  return locals;
+}
+
+void QCSAccelerator::retrieveJobResults(
+    std::shared_ptr<AcceleratorBuffer> buffer, py::dict job) {
+  auto py_src =
+      R"#(import numpy as np
+buffers = locals()['client'].call("get_buffers", locals()['job_id'], wait=True)
 results = {}
 for k, v in buffers.items():
     buf = np.frombuffer(v["data"], dtype=v["dtype"])
     results[k] = buf.reshape(v["shape"])
 )#";
 
-  // return;
   try {
-    py::exec(py_src, py::globals(), locals);
+    py::exec(py_src, py::globals(), job);
   } catch (std::exception &e) {
     std::stringstream ss;
     ss << "XACC QCS Exec Error:\n";
@@ -292,12 +470,21 @@ for k, v in buffers.items():
     xacc::error(ss.str());
   }
 
-  auto results = locals["results"];
+  auto results = job["results"];
 //   py::print("C++ Results:\n",results);
 
   // Decode the results, update AcceleratorBuffer
   if (endpoint == backend) ResultsDecoder().decode(buffer, results, shots);
-  return;
+
+  // get_buffers waits for the job: the time it was queued is part of its
+  // execution time.
+  ExecutionMetrics metrics;
+  metrics.jobId = job["job_id"].cast<std::string>();
+  metrics.nbCircuits = 1;
+  metrics.nbShots = shots;
+  const std::chrono::steady_clock::time_point submitted(
+      std::chrono::steady_clock::duration(job["submitted"].cast<int64_t>()));
+  reportExecutionMetrics(ExecutionTimer(submitted).stop(metrics));
 }
 
 void ResultsDecoder::decode(std::shared_ptr<AcceleratorBuffer> buffer,
@@ -412,68 +599,25 @@ QCSAccelerator::get(const std::string &_url, const std::string &path,
   return getResponse;
 }
 
+// The requests go through xacc::Client, for its pooled keep-alive sessions.
 const std::string
 QCSRestClient::post(const std::string &remoteUrl, const std::string &path,
                     const std::string &postStr,
                     std::map<std::string, std::string> headers) {
-
-  if (headers.empty()) {
-    headers.insert(std::make_pair("Content-type", "application/json"));
-    headers.insert(std::make_pair("Connection", "keep-alive"));
-    headers.insert(std::make_pair("Accept", "*/*"));
-  }
-
-  cpr::Header cprHeaders;
-  for (auto &kv : headers) {
-    cprHeaders.insert({kv.first, kv.second});
-  }
-
   if (verbose)
     xacc::info("Posting to " + remoteUrl + path + ", with data " + postStr);
 
-  auto r = cpr::Post(cpr::Url{remoteUrl + path}, cpr::Body(postStr), cprHeaders,
-                     cpr::VerifySsl(false));
-
-  if (r.status_code != 200)
-    throw std::runtime_error("HTTP POST Error - status code " +
-                             std::to_string(r.status_code) + ": " +
-                             r.error.message + ": " + r.text);
-
-  return r.text;
+  return Client().post(remoteUrl, path, postStr, headers);
 }
 
 const std::string
 QCSRestClient::get(const std::string &remoteUrl, const std::string &path,
                    std::map<std::string, std::string> headers,
                    std::map<std::string, std::string> extraParams) {
-  if (headers.empty()) {
-    headers.insert(std::make_pair("Content-type", "application/json"));
-    headers.insert(std::make_pair("Connection", "keep-alive"));
-    headers.insert(std::make_pair("Accept", "*/*"));
-  }
-
-  cpr::Header cprHeaders;
-  for (auto &kv : headers) {
-    cprHeaders.insert({kv.first, kv.second});
-  }
-
-  cpr::Parameters cprParams;
-  for (auto &kv : extraParams) {
-    cprParams.AddParameter({kv.first, kv.second});
-  }
-
   if (verbose)
     xacc::info("GET at " + remoteUrl + path);
 
-  auto r = cpr::Get(cpr::Url{remoteUrl + path}, cprHeaders, cprParams,
-                    cpr::VerifySsl(false));
-
-  if (r.status_code != 200)
-    throw std::runtime_error("HTTP GET Error - status code " +
-                             std::to_string(r.status_code) + ": " +
-                             r.error.message + ": " + r.text);
-
-  return r.text;
+  return Client().get(remoteUrl, path, headers, extraParams);
 }
 } // namespace quantum
 } // namespace xacc
@@ -17,6 +17,8 @@
 #include "RemoteAccelerator.hpp"
 
 #include <fstream>
+#include <mutex>
+#include <unordered_map>
 #include "IRTransformation.hpp"
 #include "xacc.hpp"
 #include "xacc_service.hpp"
@@ -95,7 +97,18 @@ protected:
   std::string forest_server_url = "https://forest-server.qcs.rigetti.com";
 
   int shots = 1024;
-  
+
+  // Compile the programs with their RZ angles as parameters, so that one
+  // binary serves all the angle values.
+  bool parametricCompilation = true;
+  // Binaries by backend, shots and (parametric) native Quil
+  static constexpr size_t MAX_CACHED_BINARIES = 256;
+  std::unordered_map<std::string, std::string> binaryCache;
+  std::mutex binaryCacheLock;
+  // Concurrent compilation requests, and programs queued on the QPU, of a
+  // multi-circuit execute
+  int maxJobsInFlight = 8;
+
   std::string qpu_compiler_endpoint;
   std::string qpu_endpoint;
   std::shared_ptr<QCSRestClient> restClient;
@@ -111,6 +124,34 @@ protected:
   std::shared_ptr<py::scoped_interpreter> guard;
 
   void _internal_init();
+
+  // Native Quil of a circuit, its RZ angles being parameters (bound to angles)
+  // with parametricCompilation.
+  struct NativeProgram {
+    std::string quil;
+    std::vector<double> angles;
+  };
+  NativeProgram toNativeProgram(std::shared_ptr<AcceleratorBuffer> buffer,
+                                const std::shared_ptr<CompositeInstruction> function);
+  // Cached or compiled binary of the program, thread safe.
+  std::string getBinary(const NativeProgram &program);
+  void compilePrograms(
+      const std::vector<std::shared_ptr<AcceleratorBuffer>> &buffers,
+      const std::vector<std::shared_ptr<CompositeInstruction>> &functions,
+      std::vector<NativeProgram> &out_programs,
+      std::vector<std::string> &out_binaries);
+  // Queue the binary on the QPU with the given theta values
+  py::dict queueProgram(const std::string &binary,
+                        const std::vector<double> &angles);
+  // rpcq client, reused by all the jobs
+  py::object rpcClient;
+
+  // Compile the program and queue it on the QPU, returning the
+  // Python locals (client, job_id) needed to retrieve its results
+  py::dict submitJob(std::shared_ptr<AcceleratorBuffer> buffer,
+                     const std::shared_ptr<CompositeInstruction> function);
+  void retrieveJobResults(std::shared_ptr<AcceleratorBuffer> buffer,
+                          py::dict job);
   
 public:
   QCSAccelerator()
@@ -122,6 +163,16 @@ public:
                const std::vector<std::shared_ptr<CompositeInstruction>>
                    functions) override;
 
+  // Programs are queued before returning, results are retrieved
+  // when the returned future is waited on.
+  std::future<void>
+  executeAsync(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::shared_ptr<CompositeInstruction> function) override;
+  std::future<void>
+  executeAsync(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::vector<std::shared_ptr<CompositeInstruction>>
+                   functions) override;
+
   void initialize(const HeterogeneousMap &params = {}) override;
 
   void updateConfiguration(const HeterogeneousMap &config) override {
@@ -131,10 +182,17 @@ public:
     if (config.stringExists("backend")) {
       backend = config.getString("backend");
     }
+    if (config.keyExists<bool>("parametric-compilation")) {
+      parametricCompilation = config.get<bool>("parametric-compilation");
+    }
+    if (config.keyExists<int>("max-jobs-in-flight")) {
+      maxJobsInFlight = config.get<int>("max-jobs-in-flight");
+    }
   }
 
   const std::vector<std::string> configurationKeys() override {
-    return {"shots", "backend"};
+    return {"shots", "backend", "parametric-compilation",
+            "max-jobs-in-flight"};
   }
 
   HeterogeneousMap getProperties() override { return HeterogeneousMap(); }
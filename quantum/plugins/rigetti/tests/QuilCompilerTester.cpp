@@ -100,6 +100,22 @@ RY(theta1) 0
   auto evaled = ir->getComposites()[0]->operator()(v); //({2.2});
   std::cout << "TEST:\n" << evaled->toString() << "\n\n";
 }
+
+TEST(QuilCompilerTester, checkTranslateStream) {
+  auto provider = xacc::getIRProvider("quantum");
+  auto f = provider->createComposite("f");
+  f->addInstruction(provider->createInstruction("Rz", {0}, {0.5}));
+  f->addInstruction(provider->createInstruction("CZ", {0, 1}));
+  f->addInstruction(provider->createInstruction("Measure", {1}));
+
+  const auto quil = xacc::translate(f, "quil");
+  EXPECT_EQ(quil, "RZ(0.5) 0\nCZ 0 1\nMEASURE 1 ro[0]\n");
+  // The same program, written to the stream
+  std::stringstream ss;
+  xacc::translate(f, "quil", ss);
+  EXPECT_EQ(ss.str(), quil);
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize();
   ::testing::InitGoogleTest(&argc, argv);
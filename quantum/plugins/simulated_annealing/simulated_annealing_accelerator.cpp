@@ -0,0 +1,288 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#include "simulated_annealing_accelerator.hpp"
+#include "ArrayAnnealingProgram.hpp"
+#include "xacc.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <random>
+
+namespace {
+using Problem = xacc::quantum::SimulatedAnnealingAccelerator::Problem;
+
+struct Entry {
+  int i;
+  int j;
+  double value;
+};
+
+// A state of the problem with the local field of each variable, kept up to
+// date on every flip so a flip costs the degree of its variable.
+struct Chain {
+  std::vector<std::int8_t> values;
+  std::vector<double> fields;
+  double energy = 0.0;
+
+  Chain(const Problem &problem, std::mt19937_64 &rng)
+      : values(problem.size()), fields(problem.biases) {
+    std::bernoulli_distribution coin;
+    for (auto &value : values) {
+      value = coin(rng) ? 1 : (problem.ising ? -1 : 0);
+    }
+    for (std::size_t var = 0; var < problem.size(); ++var) {
+      for (auto k = problem.offsets[var]; k < problem.offsets[var + 1]; ++k) {
+        fields[var] += problem.weights[k] * values[problem.neighbors[k]];
+      }
+    }
+    energy = xacc::quantum::SimulatedAnnealingAccelerator::energy(problem,
+                                                                   values);
+  }
+
+  // Change of the value of var if flipped, the energy change being
+  // step * fields[var].
+  int step(const Problem &problem, std::size_t var) const {
+    return problem.ising ? -2 * values[var] : 1 - 2 * values[var];
+  }
+
+  // One Metropolis sweep at beta
+  void sweep(const Problem &problem, double beta, std::mt19937_64 &rng) {
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    const auto *neighbors = problem.neighbors.data();
+    const auto *weights = problem.weights.data();
+    auto *localFields = fields.data();
+    for (std::size_t var = 0; var < problem.size(); ++var) {
+      const int d = step(problem, var);
+      const double delta = d * localFields[var];
+      if (delta > 0.0 && uniform(rng) >= std::exp(-beta * delta)) {
+        continue;
+      }
+      values[var] += d;
+      energy += delta;
+      const auto end = problem.offsets[var + 1];
+      for (auto k = problem.offsets[var]; k < end; ++k) {
+        localFields[neighbors[k]] += weights[k] * d;
+      }
+    }
+  }
+};
+
+// beta_k, k = 0..n-1, geometric from hot to cold
+double geometricBeta(const std::vector<double> &range, int k, int n) {
+  if (n < 2) {
+    return range[1];
+  }
+  return range[0] * std::pow(range[1] / range[0], double(k) / (n - 1));
+}
+
+std::vector<double> defaultBetaRange(const Problem &problem) {
+  const double scale = problem.ising ? 2.0 : 1.0;
+  double maxDelta = 0.0;
+  double minDelta = std::numeric_limits<double>::max();
+  const auto update = [&](double value) {
+    if (value != 0.0) {
+      minDelta = std::min(minDelta, scale * std::abs(value));
+    }
+  };
+  for (std::size_t var = 0; var < problem.size(); ++var) {
+    double delta = std::abs(problem.biases[var]);
+    update(problem.biases[var]);
+    for (auto k = problem.offsets[var]; k < problem.offsets[var + 1]; ++k) {
+      delta += std::abs(problem.weights[k]);
+      update(problem.weights[k]);
+    }
+    maxDelta = std::max(maxDelta, scale * delta);
+  }
+  if (maxDelta == 0.0) {
+    return {1.0, 1.0};
+  }
+  return {std::log(2.0) / maxDelta,
+          std::max(std::log(2.0) / maxDelta, std::log(100.0) / minDelta)};
+}
+} // namespace
+
+namespace xacc {
+namespace quantum {
+
+SimulatedAnnealingAccelerator::Problem SimulatedAnnealingAccelerator::toProblem(
+    std::shared_ptr<CompositeInstruction> program) {
+  Problem problem;
+  const auto tag = program->getTag();
+  if (tag != "ising" && tag != "qubo") {
+    xacc::error("simulated-annealing: problem must be tagged ising or qubo, "
+                "not '" +
+                tag + "'.");
+  }
+  problem.ising = tag == "ising";
+
+  std::vector<Entry> entries;
+  if (auto arrays = std::dynamic_pointer_cast<ArrayAnnealingProgram>(program)) {
+    arrays->writeEntries(entries);
+  } else {
+    for (auto &inst : program->getInstructionsView()) {
+      auto bits = inst->bits();
+      if (bits.size() != 2 || inst->nParameters() != 1 ||
+          inst->getParameter(0).isVariable()) {
+        xacc::error("simulated-annealing: invalid problem instruction " +
+                    inst->toString() + ".");
+      }
+      entries.push_back(
+          Entry{(int)bits[0], (int)bits[1],
+                xacc::InstructionParameterToDouble(inst->getParameter(0))});
+    }
+  }
+
+  std::size_t nbVariables = 0;
+  std::map<std::pair<int, int>, double> couplers;
+  for (auto &entry : entries) {
+    nbVariables = std::max<std::size_t>(
+        nbVariables, std::max(entry.i, entry.j) + 1);
+    if (entry.i != entry.j) {
+      couplers[{std::min(entry.i, entry.j), std::max(entry.i, entry.j)}] +=
+          entry.value;
+    }
+  }
+  problem.biases.assign(nbVariables, 0.0);
+  problem.offsets.assign(nbVariables + 1, 0);
+  for (auto &entry : entries) {
+    if (entry.i == entry.j) {
+      problem.biases[entry.i] += entry.value;
+    }
+  }
+  for (auto &kv : couplers) {
+    ++problem.offsets[kv.first.first + 1];
+    ++problem.offsets[kv.first.second + 1];
+  }
+  for (std::size_t var = 0; var < nbVariables; ++var) {
+    problem.offsets[var + 1] += problem.offsets[var];
+  }
+  problem.neighbors.resize(problem.offsets.back());
+  problem.weights.resize(problem.offsets.back());
+  auto next = problem.offsets;
+  for (auto &kv : couplers) {
+    const int i = kv.first.first, j = kv.first.second;
+    problem.neighbors[next[i]] = j;
+    problem.weights[next[i]++] = kv.second;
+    problem.neighbors[next[j]] = i;
+    problem.weights[next[j]++] = kv.second;
+  }
+  return problem;
+}
+
+double
+SimulatedAnnealingAccelerator::energy(const Problem &problem,
+                                      const std::vector<std::int8_t> &values) {
+  double result = 0.0;
+  for (std::size_t var = 0; var < problem.size(); ++var) {
+    // Each coupler is seen from both of its variables
+    double couplings = 0.0;
+    for (auto k = problem.offsets[var]; k < problem.offsets[var + 1]; ++k) {
+      couplings += problem.weights[k] * values[problem.neighbors[k]];
+    }
+    result += values[var] * (problem.biases[var] + couplings / 2.0);
+  }
+  return result;
+}
+
+void SimulatedAnnealingAccelerator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::shared_ptr<CompositeInstruction> program) {
+  ExecutionTimer timer;
+  const auto problem = toProblem(program);
+  const auto n = problem.size();
+  const auto betas = betaRange.empty() ? defaultBetaRange(problem) : betaRange;
+  const auto baseSeed =
+      seed >= 0 ? (std::uint64_t)seed : (std::uint64_t)std::random_device()();
+  const bool tempering = algorithm == "tempering";
+  const int nbReplicas = std::max(replicas, 2);
+
+  // The reads are independent, each one seeded from its index
+  std::vector<std::int8_t> samples(shots * n);
+  std::vector<double> energies(shots);
+  xacc::getTaskScheduler()->parallelFor(
+      0, shots, [&](std::size_t beginIdx, std::size_t endIdx) {
+        for (auto read = beginIdx; read < endIdx; ++read) {
+          std::mt19937_64 rng(baseSeed + read);
+          std::vector<Chain> chains;
+          if (tempering) {
+            std::vector<double> replicaBetas(nbReplicas);
+            for (int k = 0; k < nbReplicas; ++k) {
+              chains.emplace_back(problem, rng);
+              replicaBetas[k] = geometricBeta(betas, k, nbReplicas);
+            }
+            std::uniform_real_distribution<double> uniform(0.0, 1.0);
+            for (int s = 0; s < sweeps; ++s) {
+              for (int k = 0; k < nbReplicas; ++k) {
+                chains[k].sweep(problem, replicaBetas[k], rng);
+              }
+              // Neighbouring temperatures exchange their states
+              for (int k = 0; k + 1 < nbReplicas; ++k) {
+                const double exponent =
+                    (replicaBetas[k] - replicaBetas[k + 1]) *
+                    (chains[k].energy - chains[k + 1].energy);
+                if (exponent >= 0.0 || uniform(rng) < std::exp(exponent)) {
+                  std::swap(chains[k], chains[k + 1]);
+                }
+              }
+            }
+          } else {
+            chains.emplace_back(problem, rng);
+            for (int s = 0; s < sweeps; ++s) {
+              chains[0].sweep(problem, geometricBeta(betas, s, sweeps), rng);
+            }
+          }
+          // The coldest state
+          const auto &values = chains.back().values;
+          std::copy(values.begin(), values.end(), samples.begin() + read * n);
+          energies[read] = energy(problem, values);
+        }
+      });
+
+  std::map<std::string, int> measurements;
+  std::map<std::string, double> energies_map;
+  std::string bitString(n, '0');
+  for (int read = 0; read < shots; ++read) {
+    for (std::size_t var = 0; var < n; ++var) {
+      bitString[var] = samples[read * n + var] == 1 ? '1' : '0';
+    }
+    if (measurements.count(bitString)) {
+      measurements[bitString] += 1;
+    } else {
+      measurements.insert({bitString, 1});
+      energies_map.insert({bitString, energies[read]});
+    }
+  }
+  buffer->setMeasurements(measurements);
+  buffer->addExtraInfo("energies", energies_map);
+  buffer->addExtraInfo("beta-range", betas);
+
+  ExecutionMetrics metrics;
+  metrics.accelerator = getSignature();
+  metrics.nbCircuits = 1;
+  metrics.nbShots = shots;
+  reportExecutionMetrics(timer.stop(metrics));
+}
+
+void SimulatedAnnealingAccelerator::execute(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>> problems) {
+  for (auto &problem : problems) {
+    auto child =
+        std::make_shared<AcceleratorBuffer>(problem->name(), buffer->size());
+    execute(child, problem);
+    buffer->appendChild(problem->name(), child);
+  }
+}
+} // namespace quantum
+} // namespace xacc
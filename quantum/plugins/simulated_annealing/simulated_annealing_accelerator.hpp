@@ -0,0 +1,112 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#ifndef QUANTUM_AQC_ACCELERATORS_SIMULATEDANNEALINGACCELERATOR_HPP_
+#define QUANTUM_AQC_ACCELERATORS_SIMULATEDANNEALINGACCELERATOR_HPP_
+
+#include "xacc.hpp"
+
+namespace xacc {
+namespace quantum {
+
+// Classical sampler of the ising / qubo AnnealingProgram problems executed on
+// dwave, with the same measurements and energies in the buffer. Each read is
+// a simulated annealing run over a geometric beta schedule ("annealing") or
+// the coldest replica of a parallel tempering run ("tempering"), the reads
+// being distributed over the task scheduler.
+class SimulatedAnnealingAccelerator : public Accelerator {
+public:
+  // The problem in CSR form, the couplers of each variable stored as
+  // separate index and weight arrays.
+  struct Problem {
+    bool ising = true;
+    std::vector<double> biases;
+    std::vector<std::size_t> offsets;
+    std::vector<int> neighbors;
+    std::vector<double> weights;
+    std::size_t size() const { return biases.size(); }
+  };
+
+  void initialize(const HeterogeneousMap &params = {}) override {
+    updateConfiguration(params);
+  }
+  void updateConfiguration(const HeterogeneousMap &config) override {
+    if (config.keyExists<int>("shots")) {
+      shots = config.get<int>("shots");
+    }
+    if (config.keyExists<int>("sweeps")) {
+      sweeps = config.get<int>("sweeps");
+    }
+    if (config.stringExists("algorithm")) {
+      algorithm = config.getString("algorithm");
+      if (algorithm != "annealing" && algorithm != "tempering") {
+        xacc::error("simulated-annealing: invalid algorithm '" + algorithm +
+                    "', must be annealing or tempering.");
+      }
+    }
+    if (config.keyExists<int>("replicas")) {
+      replicas = config.get<int>("replicas");
+    }
+    if (config.keyExists<std::vector<double>>("beta-range")) {
+      betaRange = config.get<std::vector<double>>("beta-range");
+      if (betaRange.size() != 2 || betaRange[0] <= 0.0 ||
+          betaRange[1] < betaRange[0]) {
+        xacc::error("simulated-annealing: beta-range must be {hot, cold} with "
+                    "0 < hot <= cold.");
+      }
+    }
+    if (config.keyExists<int>("seed")) {
+      seed = config.get<int>("seed");
+    }
+  }
+
+  const std::vector<std::string> configurationKeys() override {
+    return {"shots", "sweeps", "algorithm", "replicas", "beta-range", "seed"};
+  }
+
+  const std::string getSignature() override {
+    return "simulated-annealing:" + algorithm;
+  }
+
+  const std::string name() const override { return "simulated-annealing"; }
+  const std::string description() const override {
+    return "Multithreaded simulated annealing / parallel tempering sampler of "
+           "ising and qubo problems.";
+  }
+
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::shared_ptr<CompositeInstruction> problem) override;
+  // Each problem gets a child buffer
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::vector<std::shared_ptr<CompositeInstruction>>
+                   problems) override;
+
+  // The couplers of the problem, biases on the diagonal, merged per pair.
+  static Problem toProblem(std::shared_ptr<CompositeInstruction> problem);
+  // Energy of the -1 / +1 (ising) or 0 / 1 (qubo) values
+  static double energy(const Problem &problem,
+                       const std::vector<std::int8_t> &values);
+
+protected:
+  int shots = 100;
+  int sweeps = 1000;
+  std::string algorithm = "annealing";
+  int replicas = 8;
+  // From the problem if empty: hot allows the largest flip half the time,
+  // cold rejects the smallest with probability 0.99.
+  std::vector<double> betaRange;
+  int seed = -1;
+};
+
+} // namespace quantum
+} // namespace xacc
+#endif
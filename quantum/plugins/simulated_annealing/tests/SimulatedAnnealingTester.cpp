@@ -0,0 +1,69 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#include <gtest/gtest.h>
+#include "xacc.hpp"
+#include "ArrayAnnealingProgram.hpp"
+
+using namespace xacc::quantum;
+
+TEST(SimulatedAnnealingTester, checkIsing) {
+  // Ferromagnetic chain, the bias selecting all +1 (energy -5.5)
+  auto problem = std::make_shared<AnnealingProgram>("chain");
+  problem->addInstruction(std::make_shared<DWQMI>(0, -0.5));
+  for (int i = 0; i < 5; ++i) {
+    problem->addInstruction(std::make_shared<DWQMI>(i, i + 1, -1.0));
+  }
+  problem->setTag("ising");
+
+  for (const std::string algorithm : {"annealing", "tempering"}) {
+    auto acc = xacc::getAccelerator("simulated-annealing",
+                                    {std::make_pair("shots", 50),
+                                     std::make_pair("sweeps", 200),
+                                     std::make_pair("algorithm", algorithm),
+                                     std::make_pair("seed", 7)});
+    auto buffer = xacc::qalloc(6);
+    acc->execute(buffer, problem);
+    auto counts = buffer->getMeasurementCounts();
+    EXPECT_GT(counts["111111"], 40);
+    auto energies = buffer->getInformation("energies")
+                        .as<std::map<std::string, double>>();
+    EXPECT_NEAR(-5.5, energies["111111"], 1e-12);
+  }
+}
+
+TEST(SimulatedAnnealingTester, checkQubo) {
+  // Either variable set, not both
+  auto problem = std::make_shared<ArrayAnnealingProgram>(
+      "qubo", std::vector<double>{-1.0, -1.0},
+      std::vector<ArrayAnnealingProgram::Coupler>{{0, 1, 2.0}});
+  problem->setTag("qubo");
+  auto acc = xacc::getAccelerator(
+      "simulated-annealing",
+      {std::make_pair("shots", 20), std::make_pair("seed", 3)});
+  auto buffer = xacc::qalloc(2);
+  acc->execute(buffer, problem);
+  auto energies =
+      buffer->getInformation("energies").as<std::map<std::string, double>>();
+  for (auto &kv : buffer->getMeasurementCounts()) {
+    EXPECT_TRUE(kv.first == "10" || kv.first == "01");
+    EXPECT_NEAR(-1.0, energies[kv.first], 1e-12);
+  }
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize(argc, argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
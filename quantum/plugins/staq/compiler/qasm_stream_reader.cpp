@@ -0,0 +1,529 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "qasm_stream_reader.hpp"
+#include "CommonGates.hpp"
+#include "GateArena.hpp"
+#include "xacc.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+using namespace xacc::quantum;
+using Tokens = std::vector<std::string_view>;
+// Register name and qubit index
+using Qubit = std::pair<std::string_view, std::size_t>;
+
+Tokens tokenize(const std::string &in_statement) {
+  Tokens tokens;
+  const std::string_view s(in_statement);
+  std::size_t i = 0;
+  while (i < s.size()) {
+    const auto c = static_cast<unsigned char>(s[i]);
+    const auto start = i;
+    if (std::isspace(c)) {
+      ++i;
+      continue;
+    }
+    if (std::isalpha(c) || c == '_') {
+      while (i < s.size() && (std::isalnum(static_cast<unsigned char>(s[i])) ||
+                              s[i] == '_')) {
+        ++i;
+      }
+    } else if (std::isdigit(c) || c == '.') {
+      // strtod validates the number when evaluated
+      while (i < s.size() && (std::isalnum(static_cast<unsigned char>(s[i])) ||
+                              s[i] == '.' ||
+                              ((s[i] == '+' || s[i] == '-') &&
+                               (s[i - 1] == 'e' || s[i - 1] == 'E')))) {
+        ++i;
+      }
+    } else if (c == '"') {
+      i = s.find('"', i + 1);
+      i = i == std::string_view::npos ? s.size() : i + 1;
+    } else if (s.compare(i, 2, "->") == 0 || s.compare(i, 2, "==") == 0) {
+      i += 2;
+    } else {
+      ++i;
+    }
+    tokens.emplace_back(s.substr(start, i - start));
+  }
+  return tokens;
+}
+
+// Constant expressions of the gate parameters
+class ExpressionEvaluator {
+public:
+  ExpressionEvaluator(const Tokens &in_tokens, std::size_t in_pos)
+      : m_tokens(in_tokens), m_pos(in_pos) {}
+  std::size_t pos() const { return m_pos; }
+
+  // exp : term (('+' | '-') term)*
+  bool eval(double &out_value) {
+    if (!term(out_value)) {
+      return false;
+    }
+    while (accept("+") || accept("-")) {
+      const bool isPlus = m_tokens[m_pos - 1] == "+";
+      double rhs;
+      if (!term(rhs)) {
+        return false;
+      }
+      out_value = isPlus ? out_value + rhs : out_value - rhs;
+    }
+    return true;
+  }
+
+private:
+  bool accept(std::string_view in_token) {
+    if (m_pos < m_tokens.size() && m_tokens[m_pos] == in_token) {
+      ++m_pos;
+      return true;
+    }
+    return false;
+  }
+  // term : unary (('*' | '/') unary)*
+  bool term(double &out_value) {
+    if (!unary(out_value)) {
+      return false;
+    }
+    while (accept("*") || accept("/")) {
+      const bool isTimes = m_tokens[m_pos - 1] == "*";
+      double rhs;
+      if (!unary(rhs)) {
+        return false;
+      }
+      out_value = isTimes ? out_value * rhs : out_value / rhs;
+    }
+    return true;
+  }
+  // unary : '-' unary | power
+  bool unary(double &out_value) {
+    if (accept("-")) {
+      if (!unary(out_value)) {
+        return false;
+      }
+      out_value = -out_value;
+      return true;
+    }
+    return power(out_value);
+  }
+  // power : primary ('^' unary)?
+  bool power(double &out_value) {
+    if (!primary(out_value)) {
+      return false;
+    }
+    if (accept("^")) {
+      double exponent;
+      if (!unary(exponent)) {
+        return false;
+      }
+      out_value = std::pow(out_value, exponent);
+    }
+    return true;
+  }
+  bool primary(double &out_value) {
+    if (m_pos == m_tokens.size()) {
+      return false;
+    }
+    const auto token = m_tokens[m_pos++];
+    if (token == "(") {
+      return eval(out_value) && accept(")");
+    }
+    if (token == "pi") {
+      out_value = xacc::constants::pi;
+      return true;
+    }
+    static const std::unordered_map<std::string_view, double (*)(double)>
+        functions{{"sin", [](double x) { return std::sin(x); }},
+                  {"cos", [](double x) { return std::cos(x); }},
+                  {"tan", [](double x) { return std::tan(x); }},
+                  {"exp", [](double x) { return std::exp(x); }},
+                  {"ln", [](double x) { return std::log(x); }},
+                  {"sqrt", [](double x) { return std::sqrt(x); }}};
+    const auto function = functions.find(token);
+    if (function != functions.end()) {
+      if (!accept("(") || !eval(out_value) || !accept(")")) {
+        return false;
+      }
+      out_value = function->second(out_value);
+      return true;
+    }
+    if (!std::isdigit(static_cast<unsigned char>(token[0])) &&
+        token[0] != '.') {
+      return false;
+    }
+    const std::string number(token);
+    char *end = nullptr;
+    out_value = std::strtod(number.c_str(), &end);
+    return end == number.c_str() + number.size();
+  }
+
+  const Tokens &m_tokens;
+  std::size_t m_pos;
+};
+
+template <typename GateT>
+xacc::InstPtr createGate(const std::vector<Qubit> &in_qubits,
+                         const std::vector<double> &in_params = {}) {
+  std::vector<std::size_t> bits;
+  std::vector<std::string> bufferNames;
+  for (const auto &[reg, idx] : in_qubits) {
+    bits.emplace_back(idx);
+    bufferNames.emplace_back(reg);
+  }
+  auto gate = xacc::quantum::makeGate<GateT>(bits);
+  for (std::size_t i = 0; i < in_params.size(); ++i) {
+    xacc::InstructionParameter param(in_params[i]);
+    gate->setParameter(i, param);
+  }
+  gate->setBufferNames(bufferNames);
+  return gate;
+}
+
+struct GateSpec {
+  std::size_t nQubits;
+  std::size_t nParams;
+  std::function<void(const std::vector<Qubit> &, const std::vector<double> &,
+                     std::vector<xacc::InstPtr> &)>
+      append;
+};
+
+template <typename GateT> GateSpec nativeGate(std::size_t in_nQubits,
+                                              std::size_t in_nParams = 0) {
+  return {in_nQubits, in_nParams,
+          [](const std::vector<Qubit> &q, const std::vector<double> &p,
+             std::vector<xacc::InstPtr> &out) {
+            out.emplace_back(createGate<GateT>(q, p));
+          }};
+}
+
+// U(theta, phi, lambda) from the gate parameters
+GateSpec uGate(std::size_t in_nParams,
+               std::function<std::vector<double>(const std::vector<double> &)>
+                   in_params) {
+  return {1, in_nParams,
+          [in_params](const std::vector<Qubit> &q, const std::vector<double> &p,
+                      std::vector<xacc::InstPtr> &out) {
+            out.emplace_back(createGate<U>(q, in_params(p)));
+          }};
+}
+
+// The qelib1.inc gates, translated to the XACC gates as in the staq
+// translation (u1, u2 and u3 to U).
+const std::unordered_map<std::string_view, GateSpec> &getGates() {
+  static const std::unordered_map<std::string_view, GateSpec> gates{
+      {"U", uGate(3, [](const std::vector<double> &p) { return p; })},
+      {"u3", uGate(3, [](const std::vector<double> &p) { return p; })},
+      {"u", uGate(3, [](const std::vector<double> &p) { return p; })},
+      {"u2", uGate(2,
+                   [](const std::vector<double> &p) {
+                     return std::vector<double>{xacc::constants::pi / 2.0, p[0],
+                                                p[1]};
+                   })},
+      {"u1", uGate(1,
+                   [](const std::vector<double> &p) {
+                     return std::vector<double>{0.0, 0.0, p[0]};
+                   })},
+      {"p", uGate(1,
+                  [](const std::vector<double> &p) {
+                    return std::vector<double>{0.0, 0.0, p[0]};
+                  })},
+      {"CX", nativeGate<CNOT>(2)},
+      {"cx", nativeGate<CNOT>(2)},
+      {"id", nativeGate<Identity>(1)},
+      {"x", nativeGate<X>(1)},
+      {"y", nativeGate<Y>(1)},
+      {"z", nativeGate<Z>(1)},
+      {"h", nativeGate<Hadamard>(1)},
+      {"s", nativeGate<S>(1)},
+      {"sdg", nativeGate<Sdg>(1)},
+      {"t", nativeGate<T>(1)},
+      {"tdg", nativeGate<Tdg>(1)},
+      {"rx", nativeGate<Rx>(1, 1)},
+      {"ry", nativeGate<Ry>(1, 1)},
+      {"rz", nativeGate<Rz>(1, 1)},
+      {"cz", nativeGate<CZ>(2)},
+      {"cy", nativeGate<CY>(2)},
+      {"swap", nativeGate<Swap>(2)},
+      {"ch", nativeGate<CH>(2)},
+      {"crz", nativeGate<CRZ>(2, 1)},
+      {"cu1", nativeGate<CPhase>(2, 1)},
+      {"ccx",
+       {3, 0,
+        [](const std::vector<Qubit> &q, const std::vector<double> &,
+           std::vector<xacc::InstPtr> &out) {
+          // The qelib1.inc decomposition
+          const auto &a = q[0], &b = q[1], &c = q[2];
+          out.emplace_back(createGate<Hadamard>({c}));
+          out.emplace_back(createGate<CNOT>({b, c}));
+          out.emplace_back(createGate<Tdg>({c}));
+          out.emplace_back(createGate<CNOT>({a, c}));
+          out.emplace_back(createGate<T>({c}));
+          out.emplace_back(createGate<CNOT>({b, c}));
+          out.emplace_back(createGate<Tdg>({c}));
+          out.emplace_back(createGate<CNOT>({a, c}));
+          out.emplace_back(createGate<T>({b}));
+          out.emplace_back(createGate<T>({c}));
+          out.emplace_back(createGate<Hadamard>({c}));
+          out.emplace_back(createGate<CNOT>({a, b}));
+          out.emplace_back(createGate<T>({a}));
+          out.emplace_back(createGate<Tdg>({b}));
+          out.emplace_back(createGate<CNOT>({a, b}));
+        }}}};
+  return gates;
+}
+} // namespace
+
+namespace xacc {
+namespace internal_staq {
+bool QasmStreamReader::read() {
+  std::string statement;
+  while (true) {
+    switch (nextStatement(statement)) {
+    case Next::End:
+      return true;
+    case Next::Unsupported:
+      return false;
+    case Next::Statement:
+      if (!readStatement(statement)) {
+        return false;
+      }
+    }
+  }
+}
+
+QasmStreamReader::Next
+QasmStreamReader::nextStatement(std::string &out_statement) {
+  out_statement.clear();
+  bool isBlank = true;
+  auto *buffer = m_src.rdbuf();
+  while (true) {
+    const auto c = buffer->sbumpc();
+    if (c == std::char_traits<char>::eof()) {
+      m_src.setstate(std::ios::eofbit);
+      // Unterminated statement
+      return isBlank ? Next::End : Next::Unsupported;
+    }
+    if (c == ';') {
+      return Next::Statement;
+    }
+    if (c == '{' || c == '}') {
+      // Gate declarations
+      return Next::Unsupported;
+    }
+    if (c == '/' && buffer->sgetc() == '/') {
+      // Comment, up to the end of the line
+      int next;
+      do {
+        next = buffer->sbumpc();
+      } while (next != '\n' && next != std::char_traits<char>::eof());
+      out_statement += ' ';
+      continue;
+    }
+    isBlank = isBlank && std::isspace(c);
+    out_statement += static_cast<char>(c);
+  }
+}
+
+bool QasmStreamReader::readStatement(const std::string &in_statement) {
+  const auto tokens = tokenize(in_statement);
+  if (tokens.empty()) {
+    return true;
+  }
+  std::size_t pos = 0;
+  const auto accept = [&](std::string_view in_token) {
+    if (pos < tokens.size() && tokens[pos] == in_token) {
+      ++pos;
+      return true;
+    }
+    return false;
+  };
+  const auto isId = [&](std::size_t in_pos) {
+    return in_pos < tokens.size() &&
+           (std::isalpha(static_cast<unsigned char>(tokens[in_pos][0])) ||
+            tokens[in_pos][0] == '_');
+  };
+  const auto readInt = [&](std::size_t &out_value) {
+    if (pos == tokens.size() ||
+        tokens[pos].find_first_not_of("0123456789") != std::string_view::npos) {
+      return false;
+    }
+    out_value = std::stoul(std::string(tokens[pos++]));
+    return true;
+  };
+  // A register or one of its elements, 'size' elements for a register
+  struct Argument {
+    std::string_view reg;
+    std::size_t idx;
+    std::size_t size;
+  };
+  const auto readArgument = [&](const std::map<std::string, std::size_t>
+                                    &in_regs,
+                                Argument &out_arg) {
+    if (!isId(pos)) {
+      return false;
+    }
+    const auto reg = in_regs.find(std::string(tokens[pos]));
+    if (reg == in_regs.end()) {
+      return false;
+    }
+    out_arg = {reg->first, 0, reg->second};
+    ++pos;
+    if (accept("[")) {
+      if (!readInt(out_arg.idx) || !accept("]") || out_arg.idx >= reg->second) {
+        return false;
+      }
+      out_arg.size = 0;
+    }
+    return true;
+  };
+  // The number of applications of a gate to these arguments (broadcast)
+  const auto getRepeats = [](const std::vector<Argument> &in_args,
+                             std::size_t &out_repeats) {
+    out_repeats = 1;
+    bool isBroadcast = false;
+    for (const auto &arg : in_args) {
+      if (arg.size > 0) {
+        if (isBroadcast && arg.size != out_repeats) {
+          return false;
+        }
+        isBroadcast = true;
+        out_repeats = arg.size;
+      }
+    }
+    return true;
+  };
+  const auto getQubit = [](const Argument &in_arg, std::size_t in_repeat) {
+    return Qubit{in_arg.reg, in_arg.size > 0 ? in_repeat : in_arg.idx};
+  };
+
+  const auto keyword = tokens[0];
+  if (keyword == "OPENQASM") {
+    return tokens.size() == 2;
+  }
+  if (keyword == "include") {
+    // The gates of other files are not known
+    return tokens.size() == 2 && tokens[1] == "\"qelib1.inc\"";
+  }
+  if (keyword == "qreg" || keyword == "creg") {
+    pos = 1;
+    std::size_t size;
+    if (!isId(pos)) {
+      return false;
+    }
+    const std::string name(tokens[pos++]);
+    if (!accept("[") || !readInt(size) || !accept("]") ||
+        pos != tokens.size() || m_qregSizes.count(name) ||
+        m_cregSizes.count(name)) {
+      return false;
+    }
+    if (keyword == "qreg") {
+      m_qregs.emplace_back(name);
+      m_qregSizes.emplace(name, size);
+    } else {
+      m_cregSizes.emplace(name, size);
+    }
+    return true;
+  }
+  if (keyword == "barrier") {
+    // Not translated
+    return true;
+  }
+  if (keyword == "measure") {
+    pos = 1;
+    Argument qarg, carg;
+    std::size_t repeats;
+    if (!readArgument(m_qregSizes, qarg) || !accept("->") ||
+        !readArgument(m_cregSizes, carg) || pos != tokens.size() ||
+        (qarg.size > 0) != (carg.size > 0) ||
+        !getRepeats({qarg, carg}, repeats)) {
+      return false;
+    }
+    for (std::size_t i = 0; i < repeats; ++i) {
+      const auto qubit = getQubit(qarg, i);
+      auto measure = quantum::makeGate<quantum::Measure>(qubit.second);
+      measure->setBufferNames({std::string(qubit.first)});
+      m_instructions.emplace_back(measure);
+    }
+    return true;
+  }
+  if (keyword == "reset") {
+    pos = 1;
+    Argument arg;
+    std::size_t repeats;
+    if (!readArgument(m_qregSizes, arg) || pos != tokens.size() ||
+        !getRepeats({arg}, repeats)) {
+      return false;
+    }
+    for (std::size_t i = 0; i < repeats; ++i) {
+      m_instructions.emplace_back(
+          createGate<quantum::Reset>({getQubit(arg, i)}));
+    }
+    return true;
+  }
+
+  // Gate application: name ('(' explist ')')? arglist
+  const auto gate = getGates().find(keyword);
+  if (gate == getGates().end()) {
+    return false;
+  }
+  const auto &spec = gate->second;
+  pos = 1;
+  std::vector<double> params;
+  if (accept("(")) {
+    if (!accept(")")) {
+      do {
+        ExpressionEvaluator evaluator(tokens, pos);
+        double value;
+        if (!evaluator.eval(value)) {
+          return false;
+        }
+        params.emplace_back(value);
+        pos = evaluator.pos();
+      } while (accept(","));
+      if (!accept(")")) {
+        return false;
+      }
+    }
+  }
+  std::vector<Argument> args(spec.nQubits);
+  for (std::size_t i = 0; i < spec.nQubits; ++i) {
+    if ((i > 0 && !accept(",")) || !readArgument(m_qregSizes, args[i])) {
+      return false;
+    }
+  }
+  std::size_t repeats;
+  if (params.size() != spec.nParams || pos != tokens.size() ||
+      !getRepeats(args, repeats)) {
+    return false;
+  }
+  std::vector<Qubit> qubits(spec.nQubits);
+  for (std::size_t r = 0; r < repeats; ++r) {
+    for (std::size_t i = 0; i < spec.nQubits; ++i) {
+      qubits[i] = getQubit(args[i], r);
+      if (std::find(qubits.begin(), qubits.begin() + i, qubits[i]) !=
+          qubits.begin() + i) {
+        return false;
+      }
+    }
+    spec.append(qubits, params, m_instructions);
+  }
+  return true;
+}
+} // namespace internal_staq
+} // namespace xacc
@@ -0,0 +1,59 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_STAQ_QASM_STREAM_READER_HPP_
+#define XACC_STAQ_QASM_STREAM_READER_HPP_
+
+#include "CompositeInstruction.hpp"
+#include <istream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace xacc {
+namespace internal_staq {
+// Incremental reader of flat OpenQASM 2 programs, e.g. the benchmark circuits
+// exported by other frameworks: register declarations, qelib1.inc gates
+// (register arguments broadcast), measure, reset and barrier statements.
+// The statements are read one at a time from the stream and translated to
+// gates (allocated from the GateArena), hence the memory is that of the
+// circuit, not of the source and its AST.
+// The gates are translated as written, i.e. without the staq desugaring and
+// optimization passes of StaqCompiler::compile.
+class QasmStreamReader {
+public:
+  explicit QasmStreamReader(std::istream &in_src) : m_src(in_src) {}
+
+  // Reads the program up to the end of the stream. Returns false at the first
+  // statement which is not supported (gate declarations, conditionals, ...)
+  // or is invalid, leaving the rest of the stream unread.
+  bool read();
+
+  // The quantum registers, in declaration order
+  const std::vector<std::string> &getQregs() const { return m_qregs; }
+  std::vector<InstPtr> takeInstructions() { return std::move(m_instructions); }
+
+private:
+  enum class Next { Statement, End, Unsupported };
+  // The next statement, without its terminating semicolon and comments.
+  Next nextStatement(std::string &out_statement);
+  bool readStatement(const std::string &in_statement);
+
+  std::istream &m_src;
+  std::vector<std::string> m_qregs;
+  std::map<std::string, std::size_t> m_qregSizes;
+  std::map<std::string, std::size_t> m_cregSizes;
+  std::vector<InstPtr> m_instructions;
+};
+} // namespace internal_staq
+} // namespace xacc
+#endif
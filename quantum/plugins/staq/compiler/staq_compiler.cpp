@@ -19,6 +19,7 @@
 #include "AcceleratorBuffer.hpp"
 
 #include "staq_visitors.hpp"
+#include "qasm_stream_reader.hpp"
 
 #include "transformations/desugar.hpp"
 #include "transformations/inline.hpp"
@@ -116,6 +117,24 @@ gate u(theta,phi,lambda) q { U(theta,phi,lambda) q; })#"},
   u2(0,pi) c;
 })#"}};
 
+namespace {
+// Name of the kernels of the plain OpenQASM sources
+std::string getTmpKernelName() {
+  std::string name = "tmp";
+  if (xacc::hasCompiled(name)) {
+    int counter = 0;
+    while (true) {
+      name = "tmp" + std::to_string(counter);
+      if (!xacc::hasCompiled(name)) {
+        break;
+      }
+      counter++;
+    }
+  }
+  return name;
+}
+} // namespace
+
 StaqCompiler::StaqCompiler() {}
 
 bool StaqCompiler::canParse(const std::string &src) {
@@ -345,30 +364,22 @@ std::shared_ptr<IR> StaqCompiler::compile(const std::string &src,
 
   //   std::cout <<"PROG: " << *prog << "\n";
   
-  // Determine the number of qreqs
-  internal_staq::CountQregs countQreq;
-  dynamic_cast<ast::Traverse &>(countQreq).visit(*prog);
-  const auto nbQreqs = countQreq.qregs.size() + ancillas.ancillas.size();
-  // Direct Staq's AST -> XACC's IR translation:
-  // This can only be used (reliably) for simple QASM source,
-  // that uses a single qreg (we can use simple qubit indexing to construct IR)
-  // Note: we don't handle *embedded* QASM source in this direct translate mode.
-  if (!isXaccKernel && nbQreqs == 1) {
-    // Create a temporary kernel name:
-    std::string name = "tmp";
-    if (xacc::hasCompiled(name)) {
-      int counter = 0;
-      while (true) {
-        name = "tmp" + std::to_string(counter);
-        if (!xacc::hasCompiled(name)) {
-          break;
-        }
-        counter++;
-      }
+  // Direct Staq's AST -> XACC's IR translation (qubit indexing per register)
+  // Note: we don't handle *embedded* QASM source in this direct translate
+  // mode, XACC kernels are recompiled by xasm to get their signature.
+  if (!isXaccKernel) {
+    const auto name = getTmpKernelName();
+
+    // Registers: qregs, then ancillas
+    internal_staq::CountQregs countQreq;
+    dynamic_cast<ast::Traverse &>(countQreq).visit(*prog);
+    auto regNames = countQreq.qregs;
+    for (auto &kv : ancillas.ancillas) {
+      regNames.emplace_back(kv.first);
     }
 
     // Direct translation
-    internal_staq::StaqToIr translate(name, countQreq.qregs[0]);
+    internal_staq::StaqToIr translate(name, regNames);
     translate.visit(*prog);
     return translate.getIr();
   }
@@ -379,43 +390,15 @@ std::shared_ptr<IR> StaqCompiler::compile(const std::string &src,
   translate.visit(*prog);
 
   std::string kernel;
-  if (isXaccKernel) {
-    if (!ancillas.ancillas.empty()) {
-      kernel = prototype.substr(0, prototype.find_first_of(")"));
-      for (auto &kv : ancillas.ancillas) {
-        kernel += ", qreg " + kv.first;
-      }
-      kernel += ") {\n" + translate.ss.str() + "}";
-    } else {
-      kernel = prototype.substr(0, prototype.length() - 1) + "\n" +
-               translate.ss.str() + "}";
-    }
-  } else {
-    internal_staq::CountQregs c;
-    dynamic_cast<ast::Traverse &>(c).visit(*prog);
-
-    std::stringstream xx;
-    std::string name = "tmp";
-    if (xacc::hasCompiled(name)) {
-      int counter = 0;
-      while (true) {
-        name = "tmp" + std::to_string(counter);
-        if (!xacc::hasCompiled(name)) {
-          break;
-        }
-        counter++;
-      }
-    }
-    xx << "__qpu__ void " << name << "(";
-    xx << "qreg " << c.qregs[0];
-    for (int i = 1; i < c.qregs.size(); i++) {
-      xx << ", qreg " << c.qregs[i];
-    }
+  if (!ancillas.ancillas.empty()) {
+    kernel = prototype.substr(0, prototype.find_first_of(")"));
     for (auto &kv : ancillas.ancillas) {
-      xx << ", qreg " << kv.first;
+      kernel += ", qreg " + kv.first;
     }
-    xx << ") {\n" << translate.ss.str() << "}";
-    kernel = xx.str();
+    kernel += ") {\n" + translate.ss.str() + "}";
+  } else {
+    kernel = prototype.substr(0, prototype.length() - 1) + "\n" +
+             translate.ss.str() + "}";
   }
   // std::cout << "\n\nFinal:\n" << kernel << "\n";
   return xasm->compile(kernel, acc);
@@ -425,8 +408,36 @@ std::shared_ptr<IR> StaqCompiler::compile(const std::string &src) {
   return compile(src, nullptr);
 }
 
-const std::string
-StaqCompiler::translate(std::shared_ptr<xacc::CompositeInstruction> function) {
+std::shared_ptr<IR>
+StaqCompiler::compileStream(std::istream &src,
+                            std::shared_ptr<Accelerator> acc) {
+  const auto start = src.tellg();
+  internal_staq::QasmStreamReader reader(src);
+  if (!reader.read()) {
+    // Reported by staq, or written with gate declarations, etc.
+    if (start == std::istream::pos_type(-1)) {
+      xacc::error("[Staq Compiler] This OpenQASM source can only be compiled "
+                  "from a seekable stream, or from a string.");
+    }
+    src.clear();
+    src.seekg(start);
+    return Compiler::compileStream(src, acc);
+  }
+
+  auto provider = xacc::getService<IRProvider>("quantum");
+  auto composite = provider->createComposite(getTmpKernelName());
+  composite->setBufferNames(reader.getQregs());
+  // Validated while reading
+  composite->addInstructions(reader.takeInstructions(), false);
+  auto ir = provider->createIR();
+  ir->addComposite(composite);
+  return ir;
+}
+
+namespace {
+// The size of each register used by the function
+std::map<std::string, int>
+bufferSizes(std::shared_ptr<xacc::CompositeInstruction> function) {
   std::map<std::string, int> bufNamesToSize;
   InstructionIterator iter(function);
   // First search buffer names and see if we have
@@ -446,18 +457,37 @@ StaqCompiler::translate(std::shared_ptr<xacc::CompositeInstruction> function) {
       }
     }
   }
+  return bufNamesToSize;
+}
 
-  auto translate =
-      std::make_shared<internal_staq::XACCToStaqOpenQasm>(bufNamesToSize);
-  InstructionIterator iter2(function);
-  while (iter2.hasNext()) {
-    auto &next = *iter2.next();
+void visitEnabled(std::shared_ptr<xacc::CompositeInstruction> function,
+                  std::shared_ptr<BaseInstructionVisitor> visitor) {
+  InstructionIterator iter(function);
+  while (iter.hasNext()) {
+    auto &next = *iter.next();
     if (next.isEnabled()) {
-      next.accept(translate);
+      next.accept(visitor);
     }
   }
+}
+} // namespace
 
-  return translate->ss.str();
+const std::string
+StaqCompiler::translate(std::shared_ptr<xacc::CompositeInstruction> function) {
+  auto translate = std::make_shared<internal_staq::XACCToStaqOpenQasm>(
+      bufferSizes(function));
+  // About 24 characters per gate
+  translate->ss.reserve(translate->ss.size() + 24 * function->nInstructions());
+  visitEnabled(function, translate);
+  return translate->ss.take();
+}
+
+void StaqCompiler::translateStream(
+    std::shared_ptr<xacc::CompositeInstruction> function, std::ostream &out) {
+  auto translate = std::make_shared<internal_staq::XACCToStaqOpenQasm>(
+      bufferSizes(function), out);
+  visitEnabled(function, translate);
+  translate->ss.flush();
 }
 
 const std::string
@@ -467,37 +497,8 @@ StaqCompiler::translate(std::shared_ptr<CompositeInstruction> program,
     auto langType = options.getString("lang-type");
 
     // map xacc to staq program
-    std::map<std::string, int> bufNamesToSize;
-    InstructionIterator iter(program);
-    // First search buffer names and see if we have
-    while (iter.hasNext()) {
-      auto &next = *iter.next();
-      if (next.isEnabled()) {
-        for (int i = 0; i < next.nRequiredBits(); i++) {
-          auto bufName = next.getBufferName(i);
-          int size = next.bits()[i] + 1;
-          if (bufNamesToSize.count(bufName)) {
-            if (bufNamesToSize[bufName] < size) {
-              bufNamesToSize[bufName] = size;
-            }
-          } else {
-            bufNamesToSize.insert({bufName, size});
-          }
-        }
-      }
-    }
-    auto translate =
-        std::make_shared<internal_staq::XACCToStaqOpenQasm>(bufNamesToSize);
-    InstructionIterator iter2(program);
-    while (iter2.hasNext()) {
-      auto &next = *iter2.next();
-      if (next.isEnabled()) {
-        next.accept(translate);
-      }
-    }
-    // std::cout << "HELLO:\n" << translate->ss.str() << "\n";
     using namespace staq;
-    auto prog = parser::parse_string(translate->ss.str());
+    auto prog = internal_staq::toStaqAst(program);
     transformations::desugar(*prog);
     transformations::synthesize_oracles(*prog);
 
@@ -28,6 +28,11 @@ public:
                                     std::shared_ptr<Accelerator> acc) override;
 
   std::shared_ptr<xacc::IR> compile(const std::string &src) override;
+  // Flat OpenQASM programs are translated as they are read, without the staq
+  // passes. Others are compiled as a string if the stream is seekable.
+  std::shared_ptr<xacc::IR>
+  compileStream(std::istream &src,
+                std::shared_ptr<Accelerator> acc = nullptr) override;
   void setExtraOptions(const HeterogeneousMap options) override {
     if (options.keyExists<bool>("no-optimize") && options.get<bool>("no-optimize")) {
         run_staq_optimize = false;
@@ -37,6 +42,8 @@ public:
 
   const std::string
   translate(std::shared_ptr<CompositeInstruction> function) override;
+  void translateStream(std::shared_ptr<CompositeInstruction> function,
+                       std::ostream &out) override;
 
   const std::string translate(std::shared_ptr<CompositeInstruction> program,
                               HeterogeneousMap &options) override;
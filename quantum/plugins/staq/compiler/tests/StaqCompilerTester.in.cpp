@@ -14,6 +14,7 @@
 
 #include "xacc.hpp"
 #include "xacc_service.hpp"
+#include <sstream>
 
 namespace {
   // CU1 decompose: 5 instructions
@@ -246,6 +247,40 @@ TEST(StaqCompilerTester, checkFloatingPointFormat) {
   EXPECT_NEAR(rxInst->getParameter(0).as<double>(), 2.5e-07, 1e-12);
 }
 
+TEST(StaqCompilerTester, checkCompileStream) {
+  auto compiler = xacc::getCompiler("staq");
+  std::stringstream src(R"(OPENQASM 2.0;
+                      include "qelib1.inc";
+                      qreg q[2];
+                      creg c[2];
+                      h q;
+                      cx q[0], q[1];
+                      u2(0, pi/2) q[1];
+                      barrier q;
+                      measure q -> c;
+                      )");
+  auto IR = compiler->compileStream(src);
+  auto hello = IR->getComposites()[0];
+  std::cout << "HELLO:\n" << hello->toString() << "\n";
+  EXPECT_EQ(hello->nInstructions(), 6);
+  EXPECT_EQ(hello->getInstruction(2)->name(), "CNOT");
+  EXPECT_EQ(hello->getInstruction(3)->name(), "U");
+  EXPECT_NEAR(hello->getInstruction(3)->getParameter(0).as<double>(), M_PI_2,
+              1e-12);
+  EXPECT_EQ(hello->getInstruction(5)->bits()[0], 1);
+
+  // Gate declarations are compiled from the whole source.
+  std::stringstream srcWithGate(R"(OPENQASM 2.0;
+                      include "qelib1.inc";
+                      qreg q[2];
+                      gate bell a, b { h a; cx a, b; }
+                      bell q[0], q[1];
+                      )");
+  IR = compiler->compileStream(srcWithGate);
+  hello = IR->getComposites()[0];
+  EXPECT_EQ(hello->nInstructions(), 2);
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize(argc, argv);
   xacc::set_verbose(true);
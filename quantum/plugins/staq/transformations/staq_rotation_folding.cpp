@@ -27,31 +27,18 @@ void RotationFolding::apply(std::shared_ptr<CompositeInstruction> program,
                             const std::shared_ptr<Accelerator> accelerator,
                             const HeterogeneousMap &options) {
 
-  // map to openqasm
-  auto staq = xacc::getCompiler("staq");
-  auto src = staq->translate(program);
-
-  // parse that to get staq ast
-  auto prog = parser::parse_string(src);
+  // build the staq ast directly from the xacc ir
+  auto prog = internal_staq::toStaqAst(program);
 
   // fold rotations
   optimization::fold_rotations(*prog);
   optimization::simplify(*prog);
 
-  // map prog back to staq src string and
-  // compile to ir
-  std::stringstream ss;
-  // Staq has a *bug* whereby it cannot parse floating point parameters in
-  // scientific notation form, yet happily 'pretty_print' parameters in that
-  // form => cannot recompile itself.
-  // Hence, we need to set the fixed format here to work around that.
-  ss << std::fixed << std::setprecision(16);
-  prog->pretty_print(ss);
-  auto ir = staq->compile(ss.str());
-
-  // reset the program and add optimized instructions
+  // map prog back to xacc ir and
+  // reset the program with the optimized instructions
+  auto optimized = internal_staq::toXaccInstructions(*prog);
   program->clear();
-  program->addInstructions(ir->getComposites()[0]->getInstructions());
+  program->addInstructions(optimized);
 
   return;
 }
@@ -18,7 +18,49 @@
 #include "xacc.hpp"
 #include "staq_visitors.hpp"
 
-#include <regex>
+#include "Topology.hpp"
+
+#include <mutex>
+
+namespace {
+// Bound on the number of cached devices (cleared when reached).
+constexpr size_t MAX_CACHED_DEVICES = 64;
+
+// The staq device of a topology, its all-pairs shortest paths (Floyd-Warshall)
+// being computed only once per topology.
+staq::mapping::Device
+getDevice(const std::string &in_name,
+          const std::shared_ptr<const xacc::Topology> &in_topology) {
+  using DeviceKey = std::pair<std::string, const xacc::Topology *>;
+  // The topology is kept alive to not reuse its address as a key.
+  using DeviceEntry =
+      std::pair<std::shared_ptr<const xacc::Topology>, staq::mapping::Device>;
+  static std::mutex cacheMutex;
+  static std::map<DeviceKey, DeviceEntry> cache;
+
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  const DeviceKey key{in_name, in_topology.get()};
+  const auto iter = cache.find(key);
+  if (iter != cache.end()) {
+    return iter->second.second;
+  }
+
+  const int nQubits = in_topology->size();
+  std::vector<std::vector<bool>> adj(nQubits, std::vector<bool>(nQubits));
+  for (const auto &[q1, q2] : in_topology->edges()) {
+    adj[q1][q2] = true;
+    adj[q2][q1] = true;
+  }
+  staq::mapping::Device device(in_name, nQubits, adj);
+  // Computes (and stores) the shortest paths
+  device.distance(0, 0);
+  if (cache.size() >= MAX_CACHED_DEVICES) {
+    cache.clear();
+  }
+  cache.emplace(key, DeviceEntry{in_topology, device});
+  return device;
+}
+} // namespace
 
 namespace xacc {
 namespace quantum {
@@ -36,45 +78,16 @@ void SwapShort::apply(std::shared_ptr<CompositeInstruction> program,
     return;
   }
 
-  // First get total number of qubits on device
-  std::set<int> qbitIdxs;
-  auto connectivity = qpu->getConnectivity();
-  for (auto &edge : connectivity) {
-    qbitIdxs.insert(edge.first);
-    qbitIdxs.insert(edge.second);
-  }
-  auto nQubits = *std::max_element(qbitIdxs.begin(), qbitIdxs.end()) + 1;
-
-  // Create the adjacency matrix, init to all 0s first
-  std::vector<std::vector<bool>> adj(nQubits);
-  for (int i = 0; i < nQubits; i++) {
-    adj[i] = std::vector<bool>(nQubits);
-  }
-
-  // Now set true where there are connections
-  for (auto &edge : connectivity) {
-    adj[edge.first][edge.second] = true;
-    adj[edge.second][edge.first] = true;
-  }
-
-  // map to openqasm
-  auto staq = xacc::getCompiler("staq");
-  auto src = staq->translate(program);
-
-  //   std::cout << "HELLO WORLD:\n" << src << "\n";
-  // parse that to get staq ast
-  ast::ptr<ast::Program> prog;
-  try {
-    prog = parser::parse_string(src);
-  } catch (std::exception &e) {
-    std::stringstream ss;
-    ss << e.what();
-    ss << "\nXACC Error in Staq Swap Short, here was the src:\n" << src << "\n";
-    xacc::error(ss.str());
+  auto topology = Topology::get(*qpu);
+  if (!topology) {
+    // Fully-connected, nothing to do.
+    return;
   }
 
+  // build the staq ast directly from the xacc ir
+  auto prog = internal_staq::toStaqAst(program);
 
-  mapping::Device device(qpu->getSignature(), nQubits, adj);
+  auto device = getDevice(qpu->getSignature(), topology);
 
   // map qreg_NAME -> q
   auto layout = mapping::compute_basic_layout(device, *prog);
@@ -82,19 +95,11 @@ void SwapShort::apply(std::shared_ptr<CompositeInstruction> program,
 
   mapping::map_onto_device(device, *prog);
 
-  // map prog back to staq src string and
-  // compile to ir
-  std::stringstream ss;
-  prog->pretty_print(ss);
-  src = ss.str();
-
-  // std::cout << "AGAIN\n" << src << "\n";
-  auto ir = staq->compile(src);
-  //   std::cout << "PASSED HERE\n";
-
-  // reset the program and add optimized instructions
+  // map prog back to xacc ir and
+  // reset the program with the mapped instructions
+  auto mapped = internal_staq::toXaccInstructions(*prog);
   program->clear();
-  program->addInstructions(ir->getComposites()[0]->getInstructions());
+  program->addInstructions(mapped);
 
   return;
 }
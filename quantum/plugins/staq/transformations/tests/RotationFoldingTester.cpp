@@ -104,6 +104,36 @@ TEST(Staq_RotationFoldingTester, checkSimple) {
   EXPECT_NEAR(0.00000005, program->getInstruction(0)->getParameter(0).as<double>(), 1e-12);
 }
 
+TEST(Staq_RotationFoldingTester, checkMultipleRegisters) {
+  auto irt = xacc::getIRTransformation("rotation-folding");
+  auto compiler = xacc::getCompiler("xasm");
+  auto program = compiler->compile(R"(__qpu__ void test_two_regs(qreg q, qreg r) {
+      T(q[0]);
+      CX(q[0], r[0]);
+      T(q[0]);
+      Rz(r[1], 0.123456789012);
+  })")->getComposite("test_two_regs");
+
+  irt->apply(program, nullptr);
+
+  EXPECT_EQ(3, program->nInstructions());
+  for (int i = 0; i < program->nInstructions(); i++) {
+    auto inst = program->getInstruction(i);
+    if (inst->name() == "CNOT") {
+      EXPECT_EQ("q", inst->getBufferName(0));
+      EXPECT_EQ("r", inst->getBufferName(1));
+    } else if (inst->name() == "Rz") {
+      EXPECT_EQ("r", inst->getBufferName(0));
+      EXPECT_EQ(1, inst->bits()[0]);
+      // No precision lost (no OpenQASM source round trip)
+      EXPECT_NEAR(0.123456789012, inst->getParameter(0).as<double>(), 1e-14);
+    } else {
+      EXPECT_EQ("S", inst->name());
+      EXPECT_EQ("q", inst->getBufferName(0));
+    }
+  }
+}
+
 
 int main(int argc, char **argv) {
   xacc::Initialize(argc, argv);
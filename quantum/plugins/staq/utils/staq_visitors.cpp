@@ -12,10 +12,23 @@
  *******************************************************************************/
 #include "staq_visitors.hpp"
 #include "Instruction.hpp"
+#include "InstructionIterator.hpp"
+#include "transformations/inline.hpp"
 
 namespace xacc {
 namespace internal_staq {
 XACCToStaqOpenQasm::XACCToStaqOpenQasm(std::map<std::string, int> bufNamesToSize) {
+  declareRegisters(bufNamesToSize);
+}
+
+XACCToStaqOpenQasm::XACCToStaqOpenQasm(std::map<std::string, int> bufNamesToSize,
+                                       std::ostream &out)
+    : ss(out) {
+  declareRegisters(bufNamesToSize);
+}
+
+void XACCToStaqOpenQasm::declareRegisters(
+    const std::map<std::string, int> &bufNamesToSize) {
   ss << "OPENQASM 2.0;\ninclude \"qelib1.inc\";\n";
   for (auto &kv : bufNamesToSize) {
     ss << "qreg " << kv.first << "[" << kv.second << "];\n";
@@ -33,15 +46,15 @@ void XACCToStaqOpenQasm::visit(CNOT &cx) {
      << "[" << cx.bits()[0] << "], " << (cx.getBufferNames().empty() ? "q" : cx.getBufferName(1)) << "[" << cx.bits()[1] << "];\n";
 }
 void XACCToStaqOpenQasm::visit(Rz &rz) {
-  ss << "rz(" << std::fixed << std::setprecision(16) << xacc::InstructionParameterToDouble(rz.getParameter(0)) << ") " << (rz.getBufferNames().empty() ? "q" : rz.getBufferName(0))
+  ss << "rz(" << Emitter::fixed(16) << xacc::InstructionParameterToDouble(rz.getParameter(0)) << ") " << (rz.getBufferNames().empty() ? "q" : rz.getBufferName(0))
      << rz.bits() << ";\n";
 }
 void XACCToStaqOpenQasm::visit(Ry &ry) {
-  ss << "ry(" << std::fixed << std::setprecision(16) << xacc::InstructionParameterToDouble(ry.getParameter(0)) << ") " << (ry.getBufferNames().empty() ? "q" : ry.getBufferName(0))
+  ss << "ry(" << Emitter::fixed(16) << xacc::InstructionParameterToDouble(ry.getParameter(0)) << ") " << (ry.getBufferNames().empty() ? "q" : ry.getBufferName(0))
      << ry.bits() << ";\n";
 }
 void XACCToStaqOpenQasm::visit(Rx &rx) {
-  ss << "rx(" << std::fixed << std::setprecision(16) << xacc::InstructionParameterToDouble(rx.getParameter(0)) << ") " << (rx.getBufferNames().empty() ? "q" : rx.getBufferName(0))
+  ss << "rx(" << Emitter::fixed(16) << xacc::InstructionParameterToDouble(rx.getParameter(0)) << ") " << (rx.getBufferNames().empty() ? "q" : rx.getBufferName(0))
      << rx.bits() << ";\n";
 }
 void XACCToStaqOpenQasm::visit(X &x) {
@@ -69,7 +82,7 @@ void XACCToStaqOpenQasm::visit(Swap &s) {
      << "[" << s.bits()[0] << "], " << (s.getBufferNames().empty() ? "q" : s.getBufferName(1)) << "[" << s.bits()[1] << "];\n";
 }
 void XACCToStaqOpenQasm::visit(CRZ &crz) {
-  ss << "crz(" << std::fixed << std::setprecision(16) << xacc::InstructionParameterToDouble(crz.getParameter(0)) << ") " << (crz.getBufferNames().empty() ? "q" : crz.getBufferName(0))
+  ss << "crz(" << Emitter::fixed(16) << xacc::InstructionParameterToDouble(crz.getParameter(0)) << ") " << (crz.getBufferNames().empty() ? "q" : crz.getBufferName(0))
      << "[" << crz.bits()[0] << "], " << (crz.getBufferNames().empty() ? "q" : crz.getBufferName(1)) << "[" << crz.bits()[1] << "];\n";
 }
 void XACCToStaqOpenQasm::visit(CH &ch) {
@@ -93,7 +106,7 @@ void XACCToStaqOpenQasm::visit(Tdg &tdg) {
      << tdg.bits() << ";\n";
 }
 void XACCToStaqOpenQasm::visit(CPhase &cphase) {
-  ss << "cu1(" << std::fixed << std::setprecision(16) << xacc::InstructionParameterToDouble(cphase.getParameter(0)) << ") " << (cphase.getBufferNames().empty() ? "q" : cphase.getBufferName(0))
+  ss << "cu1(" << Emitter::fixed(16) << xacc::InstructionParameterToDouble(cphase.getParameter(0)) << ") " << (cphase.getBufferNames().empty() ? "q" : cphase.getBufferName(0))
      << "[" << cphase.bits()[0] << "], " << (cphase.getBufferNames().empty() ? "q" : cphase.getBufferName(1)) << "[" << cphase.bits()[1] << "];\n";
 }
 void XACCToStaqOpenQasm::visit(Measure &m) {
@@ -101,8 +114,139 @@ void XACCToStaqOpenQasm::visit(Measure &m) {
 }
 void XACCToStaqOpenQasm::visit(Identity &i) {}
 void XACCToStaqOpenQasm::visit(U &u) {
-    ss << "u3(" << std::fixed << std::setprecision(16) << xacc::InstructionParameterToDouble(u.getParameter(0)) << "," << xacc::InstructionParameterToDouble(u.getParameter(1)) << "," <<xacc::InstructionParameterToDouble(u.getParameter(2)) << ") " << (u.getBufferNames().empty() ? "q" : u.getBufferName(0)) << u.bits() << ";\n";
+    ss << "u3(" << Emitter::fixed(16) << xacc::InstructionParameterToDouble(u.getParameter(0)) << "," << xacc::InstructionParameterToDouble(u.getParameter(1)) << "," <<xacc::InstructionParameterToDouble(u.getParameter(2)) << ") " << (u.getBufferNames().empty() ? "q" : u.getBufferName(0)) << u.bits() << ";\n";
 }
 void XACCToStaqOpenQasm::visit(IfStmt &ifStmt) {}
+
+namespace {
+VarAccess qubitAccess(Instruction &inst, int idx) {
+  return VarAccess(staq::parser::Position(),
+                   inst.getBufferNames().empty() ? "q" : inst.getBufferName(idx),
+                   inst.bits()[idx]);
+}
+} // namespace
+
+XACCToStaqAst::XACCToStaqAst(std::map<std::string, int> bufNamesToSize) {
+  // The qelib1.inc declarations are only parsed once.
+  static const auto stdlib = staq::parser::parse_string(
+      "OPENQASM 2.0;\ninclude \"qelib1.inc\";\n", "qelib1.inc");
+  stdlib->foreach_stmt([this](auto &stmt) {
+    m_body.emplace_back(staq::ast::ptr<Stmt>(stmt.clone()));
+  });
+  for (auto &kv : bufNamesToSize) {
+    m_body.emplace_back(RegisterDecl::create(staq::parser::Position(),
+                                             kv.first, true, kv.second));
+    m_cregNames.insert({kv.first, kv.first + "_c"});
+    m_body.emplace_back(RegisterDecl::create(
+        staq::parser::Position(), kv.first + "_c", false, kv.second));
+  }
+}
+
+void XACCToStaqAst::addGate(const std::string &in_name, Instruction &in_inst,
+                            const std::vector<double> &in_params) {
+  std::vector<staq::ast::ptr<Expr>> cargs;
+  for (const auto param : in_params) {
+    cargs.emplace_back(RealExpr::create(staq::parser::Position(), param));
+  }
+  std::vector<VarAccess> qargs;
+  for (int i = 0; i < in_inst.nRequiredBits(); i++) {
+    qargs.emplace_back(qubitAccess(in_inst, i));
+  }
+  m_body.emplace_back(DeclaredGate::create(
+      staq::parser::Position(), in_name, std::move(cargs), std::move(qargs)));
+}
+
+void XACCToStaqAst::visit(Hadamard &h) { addGate("h", h); }
+void XACCToStaqAst::visit(CNOT &cx) {
+  m_body.emplace_back(CNOTGate::create(
+      staq::parser::Position(), qubitAccess(cx, 0), qubitAccess(cx, 1)));
+}
+void XACCToStaqAst::visit(Rz &rz) {
+  addGate("rz", rz, {xacc::InstructionParameterToDouble(rz.getParameter(0))});
+}
+void XACCToStaqAst::visit(Ry &ry) {
+  addGate("ry", ry, {xacc::InstructionParameterToDouble(ry.getParameter(0))});
+}
+void XACCToStaqAst::visit(Rx &rx) {
+  addGate("rx", rx, {xacc::InstructionParameterToDouble(rx.getParameter(0))});
+}
+void XACCToStaqAst::visit(X &x) { addGate("x", x); }
+void XACCToStaqAst::visit(Y &y) { addGate("y", y); }
+void XACCToStaqAst::visit(Z &z) { addGate("z", z); }
+void XACCToStaqAst::visit(CY &cy) { addGate("cy", cy); }
+void XACCToStaqAst::visit(CZ &cz) { addGate("cz", cz); }
+void XACCToStaqAst::visit(Swap &s) { addGate("swap", s); }
+void XACCToStaqAst::visit(CRZ &crz) {
+  addGate("crz", crz,
+          {xacc::InstructionParameterToDouble(crz.getParameter(0))});
+}
+void XACCToStaqAst::visit(CH &ch) { addGate("ch", ch); }
+void XACCToStaqAst::visit(S &s) { addGate("s", s); }
+void XACCToStaqAst::visit(Sdg &sdg) { addGate("sdg", sdg); }
+void XACCToStaqAst::visit(T &t) { addGate("t", t); }
+void XACCToStaqAst::visit(Tdg &tdg) { addGate("tdg", tdg); }
+void XACCToStaqAst::visit(CPhase &cphase) {
+  addGate("cu1", cphase,
+          {xacc::InstructionParameterToDouble(cphase.getParameter(0))});
+}
+void XACCToStaqAst::visit(Measure &m) {
+  auto qubit = qubitAccess(m, 0);
+  VarAccess cbit(staq::parser::Position(), m_cregNames[qubit.var()],
+                 qubit.offset());
+  m_body.emplace_back(MeasureStmt::create(staq::parser::Position(),
+                                          std::move(qubit), std::move(cbit)));
+}
+void XACCToStaqAst::visit(Identity &i) {}
+void XACCToStaqAst::visit(U &u) {
+  addGate("u3", u,
+          {xacc::InstructionParameterToDouble(u.getParameter(0)),
+           xacc::InstructionParameterToDouble(u.getParameter(1)),
+           xacc::InstructionParameterToDouble(u.getParameter(2))});
+}
+void XACCToStaqAst::visit(IfStmt &ifStmt) {}
+
+staq::ast::ptr<Program> XACCToStaqAst::getProgram() {
+  return Program::create(staq::parser::Position(), true, std::move(m_body));
+}
+
+staq::ast::ptr<Program>
+toStaqAst(std::shared_ptr<CompositeInstruction> program) {
+  std::map<std::string, int> bufNamesToSize;
+  InstructionIterator iter(program);
+  while (iter.hasNext()) {
+    auto &next = *iter.next();
+    if (next.isEnabled()) {
+      for (int i = 0; i < next.nRequiredBits(); i++) {
+        auto bufName =
+            next.getBufferNames().empty() ? "q" : next.getBufferName(i);
+        int size = next.bits()[i] + 1;
+        if (bufNamesToSize[bufName] < size) {
+          bufNamesToSize[bufName] = size;
+        }
+      }
+    }
+  }
+
+  auto translate = std::make_shared<XACCToStaqAst>(bufNamesToSize);
+  InstructionIterator iter2(program);
+  while (iter2.hasNext()) {
+    auto &next = *iter2.next();
+    if (next.isEnabled()) {
+      next.accept(translate);
+    }
+  }
+  return translate->getProgram();
+}
+
+std::vector<InstPtr> toXaccInstructions(Program &prog) {
+  using namespace staq;
+  transformations::inline_ast(
+      prog, {false, transformations::default_overrides, "anc"});
+  CountQregs countQreg;
+  dynamic_cast<Traverse &>(countQreg).visit(prog);
+  StaqToIr translate("", countQreg.qregs);
+  translate.visit(prog);
+  return translate.getInstructions();
+}
 } // namespace internal_staq
 } // namespace xacc
\ No newline at end of file
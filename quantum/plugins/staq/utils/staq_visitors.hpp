@@ -21,6 +21,7 @@
 #include "xacc.hpp"
 #include "xacc_service.hpp"
 #include "AllGateVisitor.hpp"
+#include "Emitter.hpp"
 
 using namespace staq::ast;
 
@@ -107,7 +108,7 @@ public:
 
 class StaqToXasm : public staq::ast::Visitor {
 public:
-  std::stringstream ss;
+  Emitter ss;
   void visit(VarAccess &) override {}
   // Expressions
   void visit(BExpr &) override {}
@@ -138,7 +139,7 @@ public:
     ss << "U(" << u.arg().var() << "[" << u.arg().offset().value() << "], "
        // This is used internally for source-source translation,
        // hence we don't want to lose any precision.
-       << std::fixed << std::setprecision(16) << u.theta().constant_eval().value() << ", "
+       << Emitter::fixed(16) << u.theta().constant_eval().value() << ", "
        << u.phi().constant_eval().value() << ", "
        << u.lambda().constant_eval().value() << ");\n";
   }
@@ -157,7 +158,7 @@ public:
     }
 
     if (g.num_cargs() > 0) {
-      ss << std::fixed << std::setprecision(16) << ", " << g.carg(0).constant_eval().value();
+      ss << Emitter::fixed(16) << ", " << g.carg(0).constant_eval().value();
       for (int i = 1; i < g.num_cargs(); i++) {
         ss << ", " << g.carg(i).constant_eval().value() << "\n";
       }
@@ -171,7 +172,11 @@ public:
 class StaqToIr : public staq::ast::Visitor {
 public:
   StaqToIr(const std::string &in_kernelName, const std::string &in_regName)
-      : m_kernelName(in_kernelName), m_regName(in_regName), m_provider(xacc::getIRProvider("quantum")) {}
+      : StaqToIr(in_kernelName, std::vector<std::string>{in_regName}) {}
+  StaqToIr(const std::string &in_kernelName,
+           const std::vector<std::string> &in_regNames)
+      : m_kernelName(in_kernelName), m_regNames(in_regNames),
+        m_provider(xacc::getIRProvider("quantum")) {}
   void visit(VarAccess &) override {}
   // Expressions
   void visit(BExpr &) override {}
@@ -181,8 +186,9 @@ public:
   void visit(RealExpr &r) override {}
   void visit(VarExpr &v) override {}
   void visit(ResetStmt &reset) override {
-    m_runtimeInsts.emplace_back(
-        std::make_shared<xacc::quantum::Reset>(reset.arg().offset().value()));
+    addInstruction(
+        std::make_shared<xacc::quantum::Reset>(reset.arg().offset().value()),
+        {reset.arg().var()});
   }
   void visit(IfStmt &) override {}
   void visit(BarrierGate &) override {}
@@ -198,27 +204,36 @@ public:
   }
 
   void visit(MeasureStmt &m) override {
-    m_runtimeInsts.emplace_back(
-        std::make_shared<xacc::quantum::Measure>(m.q_arg().offset().value()));
+    addInstruction(
+        std::make_shared<xacc::quantum::Measure>(m.q_arg().offset().value()),
+        {m.q_arg().var()});
   }
 
   void visit(UGate &u) override {
-    m_runtimeInsts.emplace_back(std::make_shared<xacc::quantum::U>(
-        u.arg().offset().value(), u.theta().constant_eval().value(),
-        u.phi().constant_eval().value(), u.lambda().constant_eval().value()));
+    addInstruction(std::make_shared<xacc::quantum::U>(
+                       u.arg().offset().value(),
+                       u.theta().constant_eval().value(),
+                       u.phi().constant_eval().value(),
+                       u.lambda().constant_eval().value()),
+                   {u.arg().var()});
   }
 
   void visit(CNOTGate &cx) override {
-    m_runtimeInsts.emplace_back(std::make_shared<xacc::quantum::CNOT>(
-        cx.ctrl().offset().value(), cx.tgt().offset().value()));
+    addInstruction(std::make_shared<xacc::quantum::CNOT>(
+                       cx.ctrl().offset().value(), cx.tgt().offset().value()),
+                   {cx.ctrl().var(), cx.tgt().var()});
   }
 
   void visit(DeclaredGate &g) override {
+    std::vector<std::string> regNames;
+    for (int i = 0; i < g.num_qargs(); i++) {
+      regNames.emplace_back(g.qarg(i).var());
+    }
     // Handle common gates:
     auto funcIter = staq_to_xacc_ir_ctor.find(g.name());
     if (funcIter != staq_to_xacc_ir_ctor.end()) {
       const auto &ctorFunc = funcIter->second;
-      m_runtimeInsts.emplace_back(ctorFunc(g));
+      addInstruction(ctorFunc(g), std::move(regNames));
     } else {
       auto xacc_name = staq_to_xacc.at(g.name());
       // Otherwise, just do generic construction
@@ -231,19 +246,16 @@ public:
         gate_params.emplace_back(g.carg(i).constant_eval().value());
       }
 
-      m_runtimeInsts.emplace_back(
-          m_provider->createInstruction(xacc_name, gate_bits, gate_params));
+      addInstruction(
+          m_provider->createInstruction(xacc_name, gate_bits, gate_params),
+          std::move(regNames));
     }
   }
 
   std::shared_ptr<IR> getIr() {
     auto composite =
         xacc::getService<IRProvider>("quantum")->createComposite(m_kernelName);
-    composite->setBufferNames({m_regName});
-    for (auto &gate: m_runtimeInsts) {
-      std::vector regNames(gate->bits().size(), m_regName);
-      gate->setBufferNames(regNames);
-    }
+    composite->setBufferNames(m_regNames);
     // Since the instructions were *compiled* by staq (valid AST),
     // hence, we skip all validation.
     composite->addInstructions(std::move(m_runtimeInsts), false);
@@ -252,11 +264,19 @@ public:
     return ir;
   }
 
+  // The translated instructions (of the last visited program)
+  std::vector<InstPtr> getInstructions() { return std::move(m_runtimeInsts); }
+
 private:
+  void addInstruction(InstPtr in_inst, std::vector<std::string> in_regNames) {
+    in_inst->setBufferNames(in_regNames);
+    m_runtimeInsts.emplace_back(std::move(in_inst));
+  }
+
   std::vector<InstPtr> m_runtimeInsts;
-  std::shared_ptr<IRProvider> m_provider;
   std::string m_kernelName;
-  std::string m_regName;
+  std::vector<std::string> m_regNames;
+  std::shared_ptr<IRProvider> m_provider;
 };
 
 using namespace xacc::quantum;
@@ -264,10 +284,46 @@ using namespace xacc::quantum;
 class XACCToStaqOpenQasm : public AllGateVisitor {
 
 public:
-  std::stringstream ss;
+  Emitter ss;
   std::map<std::string, std::string> cregNames;
 
   XACCToStaqOpenQasm(std::map<std::string, int> bufNamesToSize);
+  // Writes the program to out (flushed by ss.flush())
+  XACCToStaqOpenQasm(std::map<std::string, int> bufNamesToSize,
+                     std::ostream &out);
+  void visit(Hadamard &h) override;
+  void visit(CNOT &cnot) override;
+  void visit(Rz &rz) override;
+  void visit(Ry &ry) override;
+  void visit(Rx &rx) override;
+  void visit(X &x) override;
+  void visit(Y &y) override;
+  void visit(Z &z) override;
+  void visit(CY &cy) override;
+  void visit(CZ &cz) override;
+  void visit(Swap &s) override;
+  void visit(CRZ &crz) override;
+  void visit(CH &ch) override;
+  void visit(S &s) override;
+  void visit(Sdg &sdg) override;
+  void visit(T &t) override;
+  void visit(Tdg &tdg) override;
+  void visit(CPhase &cphase) override;
+  void visit(Measure &measure) override;
+  void visit(Identity &i) override;
+  void visit(U &u) override;
+  void visit(IfStmt &ifStmt) override;
+
+private:
+  void declareRegisters(const std::map<std::string, int> &bufNamesToSize);
+};
+
+// XACC IR to Staq AST, built in memory, i.e. without printing and parsing
+// OpenQASM source. The program includes the qelib1.inc declarations, as if
+// it was parsed from the XACCToStaqOpenQasm output.
+class XACCToStaqAst : public AllGateVisitor {
+public:
+  XACCToStaqAst(std::map<std::string, int> bufNamesToSize);
   void visit(Hadamard &h) override;
   void visit(CNOT &cnot) override;
   void visit(Rz &rz) override;
@@ -290,8 +346,26 @@ public:
   void visit(Identity &i) override;
   void visit(U &u) override;
   void visit(IfStmt &ifStmt) override;
+
+  // Moves the program out of the visitor.
+  staq::ast::ptr<staq::ast::Program> getProgram();
+
+private:
+  void addGate(const std::string &in_name, Instruction &in_inst,
+               const std::vector<double> &in_params = {});
+
+  std::list<staq::ast::ptr<staq::ast::Stmt>> m_body;
+  std::map<std::string, std::string> m_cregNames;
 };
 
+// The Staq AST of the enabled instructions of an XACC program.
+staq::ast::ptr<staq::ast::Program>
+toStaqAst(std::shared_ptr<CompositeInstruction> program);
+
+// XACC instructions of a Staq AST (e.g. after a Staq pass): inlines the
+// program (in place) into the gates known to XACC, then translates it.
+std::vector<InstPtr> toXaccInstructions(staq::ast::Program &prog);
+
 } // namespace internal_staq
 } // namespace xacc
 
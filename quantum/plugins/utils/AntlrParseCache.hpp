@@ -0,0 +1,135 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_ANTLR_PARSE_CACHE_HPP_
+#define XACC_ANTLR_PARSE_CACHE_HPP_
+
+#include "antlr4-runtime.h"
+#include "xacc.hpp"
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace xacc {
+// Process-wide cache of the ANTLR parse trees of the sources compiled by a
+// compiler, e.g. the same kernel source compiled for each task of a
+// parameter sweep. Compilers walk the cached tree with their listener as
+// usual: the IR is built afresh, the kernel calls, buffer sizes, etc. being
+// resolved against the current runtime state, and only the lexing and parsing
+// are skipped. The trees are read-only, so can be walked concurrently.
+// Disabled by the 'no-parse-cache' runtime option.
+template <typename LexerT, typename ParserT> class AntlrParseCache {
+public:
+  // A source string parse. The tree refers to the tokens, hence keep the
+  // Parse alive while walking it.
+  class Parse {
+  public:
+    explicit Parse(const std::string &in_src)
+        : input(in_src), lexer(&input), tokens(&lexer), parser(&tokens) {}
+    Parse(const Parse &) = delete;
+    Parse &operator=(const Parse &) = delete;
+
+    antlr4::ANTLRInputStream input;
+    LexerT lexer;
+    antlr4::CommonTokenStream tokens;
+    ParserT parser;
+    // Owned by the parser
+    antlr4::tree::ParseTree *tree = nullptr;
+  };
+  // Sets the error listeners of the lexer and parser, and returns the tree
+  // parsed from the start rule. The error listeners are removed afterwards.
+  using ParseFunction = std::function<antlr4::tree::ParseTree *(Parse &)>;
+
+  static AntlrParseCache &instance() {
+    static AntlrParseCache cache;
+    return cache;
+  }
+
+  std::shared_ptr<const Parse> get(const std::string &in_src,
+                                   const ParseFunction &in_parse) {
+    const bool enabled = !xacc::optionExists("no-parse-cache");
+    if (enabled) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      auto iter = m_entries.find(in_src);
+      if (iter != m_entries.end()) {
+        // Most recently used last
+        m_order.splice(m_order.end(), m_order, iter->second.order);
+        ++m_hits;
+        return iter->second.parse;
+      }
+    }
+
+    // Parse outside of the lock, concurrent misses may parse the same source.
+    auto parse = std::make_shared<Parse>(in_src);
+    parse->tree = in_parse(*parse);
+    parse->lexer.removeErrorListeners();
+    parse->parser.removeErrorListeners();
+    // Sources with errors are reported again on each compile.
+    if (enabled && parse->lexer.getNumberOfSyntaxErrors() == 0 &&
+        parse->parser.getNumberOfSyntaxErrors() == 0) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      auto [iter, inserted] = m_entries.emplace(in_src, Entry{parse, {}});
+      if (inserted) {
+        iter->second.order = m_order.insert(m_order.end(), &iter->first);
+        if (m_entries.size() > m_maxEntries) {
+          m_entries.erase(*m_order.front());
+          m_order.pop_front();
+        }
+      }
+    }
+    return parse;
+  }
+
+  void setMaxEntries(size_t in_maxEntries) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxEntries = std::max<size_t>(in_maxEntries, 1);
+    while (m_entries.size() > m_maxEntries) {
+      m_entries.erase(*m_order.front());
+      m_order.pop_front();
+    }
+  }
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+  }
+  size_t getHits() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hits;
+  }
+  void clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_order.clear();
+    m_hits = 0;
+  }
+
+private:
+  AntlrParseCache() = default;
+
+  struct Entry {
+    std::shared_ptr<const Parse> parse;
+    // Position in m_order
+    typename std::list<const std::string *>::iterator order;
+  };
+  // Keyed by the source string itself, i.e. no false hits.
+  std::unordered_map<std::string, Entry> m_entries;
+  // Keys of m_entries (stable in a node-based map), least recently used first
+  std::list<const std::string *> m_order;
+  size_t m_maxEntries = 256;
+  size_t m_hits = 0;
+  mutable std::mutex m_mutex;
+};
+} // namespace xacc
+#endif
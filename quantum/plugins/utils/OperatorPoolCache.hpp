@@ -0,0 +1,120 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Daniel Claudino - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_OPERATOR_POOL_CACHE_HPP_
+#define XACC_OPERATOR_POOL_CACHE_HPP_
+
+#include "FermionOperator.hpp"
+#include "Observable.hpp"
+#include "ObservableTransform.hpp"
+#include "xacc.hpp"
+#include "xacc_service.hpp"
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <map>
+
+namespace xacc {
+namespace quantum {
+// Process-wide cache of the operators generated by the operator pools, keyed
+// by (pool type, number of qubits, number of electrons), e.g. the same pool
+// generated on each ADAPT run or UCCSD expansion of a parameter sweep. A pool
+// is generated on its first request only, and the cached operators are
+// read-only, so can be shared by concurrent runs.
+// Disabled by the 'no-pool-cache' runtime option.
+class OperatorPoolCache {
+public:
+  struct Pool {
+    // The operators as defined by the pool (e.g. fermionic excitations)
+    std::vector<std::shared_ptr<Observable>> operators;
+    // Their qubit (anti-hermitian, JW) images
+    std::vector<std::shared_ptr<Observable>> qubitOperators;
+  };
+  using GenerateFunction = std::function<Pool()>;
+
+  static OperatorPoolCache &instance() {
+    static OperatorPoolCache cache;
+    return cache;
+  }
+
+  // Electron-independent pools use in_nElectrons = -1.
+  std::shared_ptr<const Pool> get(const std::string &in_poolName,
+                                  int in_nQubits, int in_nElectrons,
+                                  const GenerateFunction &in_generate) {
+    const bool enabled = !xacc::optionExists("no-pool-cache");
+    const auto key = std::make_tuple(in_poolName, in_nQubits, in_nElectrons);
+    if (enabled) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      auto iter = m_pools.find(key);
+      if (iter != m_pools.end()) {
+        ++m_hits;
+        return iter->second;
+      }
+    }
+
+    // Generate outside of the lock: generation may use the task scheduler,
+    // and concurrent misses may generate the same pool.
+    auto pool = std::make_shared<const Pool>(in_generate());
+    if (enabled) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_pools.emplace(key, pool).first->second;
+    }
+    return pool;
+  }
+
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pools.size();
+  }
+  size_t getHits() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hits;
+  }
+  void clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pools.clear();
+    m_hits = 0;
+  }
+
+private:
+  OperatorPoolCache() = default;
+
+  std::map<std::tuple<std::string, int, int>, std::shared_ptr<const Pool>>
+      m_pools;
+  size_t m_hits = 0;
+  mutable std::mutex m_mutex;
+};
+
+// The anti-hermitian qubit images (op - op^dagger, normalized, through the jw
+// transform) of fermionic excitation operators, transformed in parallel.
+inline std::vector<std::shared_ptr<Observable>>
+jordanWignerPool(const std::vector<std::shared_ptr<Observable>> &in_operators) {
+  std::vector<std::shared_ptr<Observable>> pool(in_operators.size());
+  auto jw = xacc::getService<ObservableTransform>("jw");
+  xacc::getTaskScheduler()->parallelFor(
+      0, in_operators.size(), [&](std::size_t beginIdx, std::size_t endIdx) {
+        for (auto i = beginIdx; i < endIdx; ++i) {
+          auto tmp =
+              *std::dynamic_pointer_cast<FermionOperator>(in_operators[i]);
+          tmp -= tmp.hermitianConjugate();
+          tmp.normalize();
+          pool[i] = jw->transform(std::make_shared<FermionOperator>(tmp));
+        }
+      });
+  return pool;
+}
+} // namespace quantum
+} // namespace xacc
+#endif
@@ -574,6 +574,87 @@ TEST(XASMCompilerTester, checkAnnealInstructions) {
   }
 }
 
+TEST(XASMCompilerTester, checkRecompile) {
+  // Compiled again from the cached parse tree, against the current runtime
+  // state.
+  auto compiler = xacc::getCompiler("xasm");
+  const std::string callee = R"(__qpu__ void recompile_callee(qbit q) {
+  X(q[0]);
+})";
+  const std::string src = R"(__qpu__ void recompile_test(qbit r, double t) {
+  H(r);
+  Rx(r[0], t);
+  recompile_callee(r);
+})";
+  auto r = xacc::qalloc(2);
+  r->setName("r");
+  xacc::storeBuffer(r);
+  compiler->compile(callee);
+  auto first = compiler->compile(src)->getComposite("recompile_test");
+  EXPECT_EQ(4, first->nInstructions());
+
+  auto r3 = xacc::qalloc(3);
+  r3->setName("r");
+  xacc::storeBuffer(r3);
+  auto second = compiler->compile(src)->getComposite("recompile_test");
+  EXPECT_NE(first, second);
+  EXPECT_EQ(5, second->nInstructions());
+  EXPECT_EQ(second, xacc::getCompiled("recompile_test"));
+
+  // Independent runtime arguments
+  auto evaled = (*first)({1.5});
+  EXPECT_NEAR(1.5, evaled->getInstruction(2)->getParameter(0).as<double>(),
+              1e-12);
+  evaled = (*second)({0.5});
+  EXPECT_NEAR(0.5, evaled->getInstruction(3)->getParameter(0).as<double>(),
+              1e-12);
+
+  // Kernel calls resolve to the current definition
+  compiler->compile(R"(__qpu__ void recompile_callee(qbit q) {
+  X(q[0]);
+  Y(q[0]);
+})");
+  auto third = compiler->compile(src)->getComposite("recompile_test");
+  ASSERT_EQ(5, third->nInstructions());
+  EXPECT_EQ(2, xacc::ir::asComposite(third->getInstruction(4))->nInstructions());
+}
+
+TEST(XASMCompilerTester, checkFastParser) {
+  // Straight-line kernels have the same IR with or without the fast parser.
+  auto compiler = xacc::getCompiler("xasm");
+  const std::string src = R"(__qpu__ void fast_parser_test(qreg q, double t, std::vector<double> x) {
+  // comments between the statements
+  H(q[0]);
+  CX(q[0], q[1]);
+  Rx(q[0], t);
+  Rz(q[1], 2.2*t+pi);
+  Ry(q[1], x[1]);
+  U(q[0], x[0], -x[1], sin(t)/2);
+  Measure(q[0]);
+})";
+  auto fast = compiler->compile(src)->getComposite("fast_parser_test");
+  xacc::setOption("no-xasm-fast-parser", "");
+  auto antlr = compiler->compile(src)->getComposite("fast_parser_test");
+  xacc::unsetOption("no-xasm-fast-parser");
+
+  EXPECT_EQ(7, fast->nInstructions());
+  EXPECT_EQ(antlr->toString(), fast->toString());
+  EXPECT_EQ(antlr->getVariables(), fast->getVariables());
+  EXPECT_EQ(antlr->getBufferNames(), fast->getBufferNames());
+  auto fastEvaled = (*fast)({0.5, 1.0, 2.0});
+  auto antlrEvaled = (*antlr)({0.5, 1.0, 2.0});
+  EXPECT_EQ(antlrEvaled->toString(), fastEvaled->toString());
+  EXPECT_EQ(std::vector<std::string>{"q"}, compiler->getKernelBufferNames(src));
+
+  // Anything else is parsed by ANTLR
+  auto loop = compiler->compile(R"(__qpu__ void fast_parser_loop(qreg q) {
+  for (int i = 0; i < 3; i++) {
+    H(q[i]);
+  }
+})")->getComposite("fast_parser_loop");
+  EXPECT_EQ(3, loop->nInstructions());
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize(argc, argv);
   xacc::set_verbose(true);
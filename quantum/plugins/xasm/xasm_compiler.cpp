@@ -18,14 +18,23 @@
 #include "xasmParser.h"
 #include "xasm_compiler.hpp"
 #include "xasm_errorlistener.hpp"
+#include "xasm_fast_parser.hpp"
 #include "xasm_listener.hpp"
 #include "xasm_visitor.hpp"
 #include "InstructionIterator.hpp"
+#include "AntlrParseCache.hpp"
 
 using namespace xasm;
 using namespace antlr4;
 
 namespace xacc {
+using XASMParseCache = AntlrParseCache<xasmLexer, xasmParser>;
+
+namespace {
+// The straight-line sources are parsed by the XASMFastParser, unless disabled
+// by the 'no-xasm-fast-parser' runtime option.
+bool useFastParser() { return !xacc::optionExists("no-xasm-fast-parser"); }
+} // namespace
 
 XASMCompiler::XASMCompiler() = default;
 
@@ -63,20 +72,20 @@ bool XASMCompiler::canParse(const std::string &src) {
 
 std::shared_ptr<IR> XASMCompiler::compile(const std::string &src,
                                           std::shared_ptr<Accelerator> acc) {
-  ANTLRInputStream input(src);
-  xasmLexer lexer(&input);
-  lexer.removeErrorListeners();
-  CommonTokenStream tokens(&lexer);
-  xasmParser parser(&tokens);
-  parser.removeErrorListeners();
-  XASMErrorListener el;
-  parser.addErrorListener(&el);
-
   auto ir = xacc::getService<IRProvider>("quantum")->createIR();
 
-  tree::ParseTree *tree = parser.xaccsrc();
   XASMListener listener;
-  tree::ParseTreeWalker::DEFAULT.walk(&listener, tree);
+  if (!useFastParser() || !XASMFastParser::parse(src, listener)) {
+    XASMErrorListener el;
+    auto parse = XASMParseCache::instance().get(
+        src, [&](XASMParseCache::Parse &p) {
+          p.lexer.removeErrorListeners();
+          p.parser.removeErrorListeners();
+          p.parser.addErrorListener(&el);
+          return p.parser.xaccsrc();
+        });
+    tree::ParseTreeWalker::DEFAULT.walk(&listener, parse->tree);
+  }
 
   auto f = listener.getFunction();
   if (f->name() != "tmp_lambda")
@@ -96,6 +105,11 @@ std::shared_ptr<IR> XASMCompiler::compile(const std::string &src) {
 
 std::vector<std::string>
 XASMCompiler::getKernelBufferNames(const std::string &src) {
+  XASMListener fastListener;
+  if (useFastParser() && XASMFastParser::parse(src, fastListener)) {
+    return fastListener.getBufferNames();
+  }
+
   ANTLRInputStream input(src);
   xasmLexer lexer(&input);
   CommonTokenStream tokens(&lexer);
@@ -0,0 +1,449 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "xasm_fast_parser.hpp"
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+enum class TokenType { Id, Keyword, Int, Real, Symbol, Comment, End, Invalid };
+
+struct Token {
+  TokenType type;
+  std::string_view text;
+  bool is(TokenType in_type, std::string_view in_text) const {
+    return type == in_type && text == in_text;
+  }
+  bool isSymbol(std::string_view in_text) const {
+    return is(TokenType::Symbol, in_text);
+  }
+};
+
+// The literal tokens of the xasm grammar that would otherwise be IDs.
+bool isKeyword(std::string_view in_text) {
+  static const std::vector<std::string_view> keywords{
+      "void", "auto", "int", "for", "if",  "return", "pi",
+      "sin",  "cos",  "tan", "exp", "ln", "sqrt"};
+  for (const auto &k : keywords) {
+    if (k == in_text) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool isUnaryOp(const Token &in_token) {
+  return in_token.type == TokenType::Keyword &&
+         (in_token.text == "sin" || in_token.text == "cos" ||
+          in_token.text == "tan" || in_token.text == "exp" ||
+          in_token.text == "ln" || in_token.text == "sqrt");
+}
+
+// Same tokens as the ANTLR lexer, but for the strings, which are only used by
+// the constructs left to ANTLR.
+class Lexer {
+public:
+  explicit Lexer(const std::string &in_src) : m_src(in_src), m_pos(0) {}
+
+  Token next() {
+    while (m_pos < m_src.size() && (m_src[m_pos] == ' ' || m_src[m_pos] == '\t' ||
+                                    m_src[m_pos] == '\r' || m_src[m_pos] == '\n')) {
+      ++m_pos;
+    }
+    if (m_pos == m_src.size()) {
+      return {TokenType::End, {}};
+    }
+    const auto start = m_pos;
+    const char c = m_src[m_pos];
+    if (c == '/' && peek(1) == '/') {
+      // Up to and including the end of line, which is required.
+      while (m_pos < m_src.size() && m_src[m_pos] != '\r' &&
+             m_src[m_pos] != '\n') {
+        ++m_pos;
+      }
+      if (peek(0) == '\r') {
+        ++m_pos;
+      }
+      if (peek(0) != '\n') {
+        return {TokenType::Invalid, {}};
+      }
+      ++m_pos;
+      return token(TokenType::Comment, start);
+    }
+    if (std::isalpha(static_cast<unsigned char>(c))) {
+      while (m_pos < m_src.size() &&
+             (std::isalnum(static_cast<unsigned char>(m_src[m_pos])) ||
+              m_src[m_pos] == '_')) {
+        ++m_pos;
+      }
+      auto id = token(TokenType::Id, start);
+      if (isKeyword(id.text)) {
+        id.type = TokenType::Keyword;
+      }
+      return id;
+    }
+    if (m_src.compare(m_pos, 7, "__qpu__") == 0) {
+      m_pos += 7;
+      return token(TokenType::Keyword, start);
+    }
+    if (std::isdigit(static_cast<unsigned char>(c)) ||
+        (c == '.' && std::isdigit(static_cast<unsigned char>(peek(1))))) {
+      skipDigits();
+      auto type = TokenType::Int;
+      if (peek(0) == '.' && std::isdigit(static_cast<unsigned char>(peek(1)))) {
+        ++m_pos;
+        skipDigits();
+        type = TokenType::Real;
+      }
+      return token(type, start);
+    }
+    // The two-character tokens first, e.g. '--' is not '-' '-'.
+    for (const char *symbol : {"::", "++", "--", "<=", ">="}) {
+      if (m_src.compare(m_pos, 2, symbol) == 0) {
+        m_pos += 2;
+        return token(TokenType::Symbol, start);
+      }
+    }
+    static const std::string_view symbols = "()[]{},;&*=+-/^<>";
+    if (symbols.find(c) != std::string_view::npos) {
+      ++m_pos;
+      return token(TokenType::Symbol, start);
+    }
+    return {TokenType::Invalid, {}};
+  }
+
+private:
+  char peek(std::size_t in_offset) const {
+    return m_pos + in_offset < m_src.size() ? m_src[m_pos + in_offset] : '\0';
+  }
+  void skipDigits() {
+    while (m_pos < m_src.size() &&
+           std::isdigit(static_cast<unsigned char>(m_src[m_pos]))) {
+      ++m_pos;
+    }
+  }
+  Token token(TokenType in_type, std::size_t in_start) const {
+    return {in_type, std::string_view(m_src).substr(in_start, m_pos - in_start)};
+  }
+
+  const std::string &m_src;
+  std::size_t m_pos;
+};
+
+using Tokens = std::vector<Token>;
+
+std::string getText(const Tokens &in_tokens, std::size_t in_begin,
+                    std::size_t in_end) {
+  std::string text;
+  for (auto i = in_begin; i < in_end; ++i) {
+    text += in_tokens[i].text;
+  }
+  return text;
+}
+
+// The xasm 'exp' rule but for the strings, on [io_pos, in_end).
+bool parseExp(const Tokens &in_tokens, std::size_t &io_pos,
+              std::size_t in_end);
+
+bool parsePrimary(const Tokens &in_tokens, std::size_t &io_pos,
+                  std::size_t in_end) {
+  if (io_pos == in_end) {
+    return false;
+  }
+  const auto &t = in_tokens[io_pos++];
+  if (t.type == TokenType::Int || t.type == TokenType::Real ||
+      t.is(TokenType::Keyword, "pi")) {
+    return true;
+  }
+  if (t.type == TokenType::Id) {
+    if (io_pos < in_end && in_tokens[io_pos].isSymbol("[")) {
+      // var_name[INT|ID]
+      if (io_pos + 2 >= in_end ||
+          (in_tokens[io_pos + 1].type != TokenType::Int &&
+           in_tokens[io_pos + 1].type != TokenType::Id) ||
+          !in_tokens[io_pos + 2].isSymbol("]")) {
+        return false;
+      }
+      io_pos += 3;
+    }
+    return true;
+  }
+  if (isUnaryOp(t)) {
+    if (io_pos == in_end || !in_tokens[io_pos].isSymbol("(")) {
+      return false;
+    }
+    ++io_pos;
+  } else if (!t.isSymbol("(")) {
+    return false;
+  }
+  if (!parseExp(in_tokens, io_pos, in_end) || io_pos == in_end ||
+      !in_tokens[io_pos].isSymbol(")")) {
+    return false;
+  }
+  ++io_pos;
+  return true;
+}
+
+bool parseExp(const Tokens &in_tokens, std::size_t &io_pos,
+              std::size_t in_end) {
+  while (true) {
+    while (io_pos < in_end && in_tokens[io_pos].isSymbol("-")) {
+      ++io_pos;
+    }
+    if (!parsePrimary(in_tokens, io_pos, in_end)) {
+      return false;
+    }
+    if (io_pos == in_end) {
+      return true;
+    }
+    const auto &op = in_tokens[io_pos];
+    if (!op.isSymbol("+") && !op.isSymbol("-") && !op.isSymbol("*") &&
+        !op.isSymbol("/") && !op.isSymbol("^")) {
+      return true;
+    }
+    ++io_pos;
+  }
+}
+
+// Is [in_begin, in_end) exactly an expression.
+bool isExp(const Tokens &in_tokens, std::size_t in_begin, std::size_t in_end) {
+  auto pos = in_begin;
+  return parseExp(in_tokens, pos, in_end) && pos == in_end;
+}
+
+// Is [in_begin, in_end) exactly a 'bufferIndex', i.e. name[exp].
+bool isBufferIndex(const Tokens &in_tokens, std::size_t in_begin,
+                   std::size_t in_end) {
+  return in_end - in_begin >= 4 && in_tokens[in_begin].type == TokenType::Id &&
+         in_tokens[in_begin + 1].isSymbol("[") &&
+         in_tokens[in_end - 1].isSymbol("]") &&
+         isExp(in_tokens, in_begin + 2, in_end - 1);
+}
+
+class Recognizer {
+public:
+  // Only recognizes the source if io_listener is null.
+  Recognizer(const std::string &in_src, xacc::XASMListener *io_listener)
+      : m_lexer(in_src), m_listener(io_listener) {}
+
+  bool run() {
+    if (!parseHeader()) {
+      return false;
+    }
+    while (true) {
+      auto t = m_lexer.next();
+      if (t.isSymbol("}")) {
+        // Nothing may follow the kernel.
+        return m_lexer.next().type == TokenType::End;
+      }
+      if (t.type == TokenType::Comment) {
+        continue;
+      }
+      m_statement.clear();
+      while (!t.isSymbol(";")) {
+        if (t.type == TokenType::End || t.type == TokenType::Invalid ||
+            t.type == TokenType::Comment || t.isSymbol("{") ||
+            t.isSymbol("}")) {
+          return false;
+        }
+        m_statement.push_back(t);
+        t = m_lexer.next();
+      }
+      if (!parseStatement()) {
+        return false;
+      }
+    }
+  }
+
+private:
+  bool expect(std::string_view in_symbol) {
+    return m_lexer.next().isSymbol(in_symbol);
+  }
+
+  // xacckernel or xacclambda, up to the opening brace of the body.
+  bool parseHeader() {
+    std::string name = "tmp_lambda";
+    auto t = m_lexer.next();
+    if (t.is(TokenType::Keyword, "__qpu__")) {
+      if (!m_lexer.next().is(TokenType::Keyword, "void")) {
+        return false;
+      }
+      t = m_lexer.next();
+      if (t.type != TokenType::Id || !expect("(")) {
+        return false;
+      }
+      name = std::string(t.text);
+    } else if (t.isSymbol("[")) {
+      t = m_lexer.next();
+      if (t.isSymbol("&") || t.isSymbol("=")) {
+        t = m_lexer.next();
+      }
+      if (!t.isSymbol("]") || !expect("(")) {
+        return false;
+      }
+    } else {
+      return false;
+    }
+
+    std::vector<std::pair<std::string, std::string>> typedParams;
+    do {
+      // type ('&' | '*')? variable_param_name
+      std::string type;
+      t = m_lexer.next();
+      if (t.is(TokenType::Keyword, "auto") || t.is(TokenType::Keyword, "int")) {
+        type = std::string(t.text);
+        t = m_lexer.next();
+      } else if (t.type == TokenType::Id) {
+        type = std::string(t.text);
+        t = m_lexer.next();
+        if (t.isSymbol("::")) {
+          t = m_lexer.next();
+          if (t.type != TokenType::Id) {
+            return false;
+          }
+          type += "::" + std::string(t.text);
+          t = m_lexer.next();
+        }
+        if (t.isSymbol("<")) {
+          type += '<';
+          for (bool first = true;; first = false) {
+            t = m_lexer.next();
+            if (t.type != TokenType::Id) {
+              return false;
+            }
+            type += t.text;
+            t = m_lexer.next();
+            if (t.isSymbol(">")) {
+              break;
+            }
+            if (!first || !t.isSymbol(",")) {
+              return false;
+            }
+            type += ',';
+          }
+          type += '>';
+          t = m_lexer.next();
+        }
+      } else {
+        return false;
+      }
+      if (t.isSymbol("&") || t.isSymbol("*")) {
+        t = m_lexer.next();
+      }
+      if (t.type != TokenType::Id) {
+        return false;
+      }
+      typedParams.emplace_back(type, std::string(t.text));
+      t = m_lexer.next();
+    } while (t.isSymbol(","));
+    if (!t.isSymbol(")") || !expect("{")) {
+      return false;
+    }
+
+    if (m_listener) {
+      m_listener->beginFunction(name, typedParams);
+    }
+    return true;
+  }
+
+  // 'return' or an instruction, without the semicolon.
+  bool parseStatement() {
+    const auto &s = m_statement;
+    if (s.size() == 1 && s[0].is(TokenType::Keyword, "return")) {
+      return true;
+    }
+    if (s.size() < 3 || s[0].type != TokenType::Id || !s[1].isSymbol("(") ||
+        !s.back().isSymbol(")")) {
+      return false;
+    }
+    // The arguments, the expressions have no commas.
+    m_args.clear();
+    std::size_t begin = 2;
+    for (std::size_t i = 2; i < s.size(); ++i) {
+      if (s[i].isSymbol(",") || i == s.size() - 1) {
+        m_args.emplace_back(begin, i);
+        begin = i + 1;
+      }
+    }
+
+    // One or two buffer indices, the second one being preferred over a
+    // parameter like the ANTLR parser does, e.g. Ry(q[0], x[0]).
+    std::size_t nBits = 0;
+    while (nBits < std::min<std::size_t>(2, m_args.size()) &&
+           isBufferIndex(s, m_args[nBits].first, m_args[nBits].second)) {
+      ++nBits;
+    }
+    if (nBits == 0) {
+      return false;
+    }
+    for (auto i = nBits; i < m_args.size(); ++i) {
+      if (!isExp(s, m_args[i].first, m_args[i].second)) {
+        return false;
+      }
+    }
+    if (!m_listener) {
+      return true;
+    }
+
+    m_listener->beginInstruction(std::string(s[0].text));
+    for (std::size_t i = 0; i < nBits; ++i) {
+      const auto [first, last] = m_args[i];
+      // Has the index expression an INT child, i.e. is it INT or id[INT]
+      const bool isIntIdx =
+          (last - first == 4 && s[first + 2].type == TokenType::Int) ||
+          (last - first == 7 && s[first + 3].isSymbol("[") &&
+           s[first + 4].type == TokenType::Int);
+      if (!m_listener->addBufferIndex(i, nBits, std::string(s[first].text),
+                                      getText(s, first + 2, last - 1),
+                                      isIntIdx)) {
+        break;
+      }
+    }
+    for (auto i = nBits; i < m_args.size(); ++i) {
+      const auto [first, last] = m_args[i];
+      if (last - first == 4 && s[first].type == TokenType::Id &&
+          s[first + 1].isSymbol("[")) {
+        // var_name[idx], the only expression of this form
+        m_listener->addParameter(getText(s, first, last),
+                                 std::string(s[first].text),
+                                 std::string(s[first + 2].text));
+      } else {
+        m_listener->addParameter(getText(s, first, last));
+      }
+    }
+    m_listener->endInstruction();
+    return true;
+  }
+
+  Lexer m_lexer;
+  xacc::XASMListener *m_listener;
+  // The tokens of the current statement, and its argument ranges.
+  Tokens m_statement;
+  std::vector<std::pair<std::size_t, std::size_t>> m_args;
+};
+} // namespace
+
+namespace xacc {
+bool XASMFastParser::parse(const std::string &in_src,
+                           XASMListener &io_listener) {
+  // Recognize the whole source first, the IR building steps may raise errors
+  // which must not precede the syntax errors reported by ANTLR.
+  if (!Recognizer(in_src, nullptr).run()) {
+    return false;
+  }
+  Recognizer(in_src, &io_listener).run();
+  return true;
+}
+} // namespace xacc
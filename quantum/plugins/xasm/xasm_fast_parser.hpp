@@ -0,0 +1,36 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_XASM_FAST_PARSER_HPP_
+#define XACC_XASM_FAST_PARSER_HPP_
+
+#include "xasm_listener.hpp"
+#include <string>
+
+namespace xacc {
+// Hand-written recognizer of the straight-line xasm kernels: a kernel or
+// lambda header followed by gate calls on indexed qubits, with literal,
+// variable or expression parameters, and comments. That is most of the
+// generated (e.g. transpiled or synthesized) sources, whose ANTLR parse trees
+// cost much more time and memory than the IR itself.
+// The statements are read one at a time and given to the XASMListener IR
+// building steps, hence the IR is the one of the ANTLR parse. Sources with any
+// other construct (for loops, if statements, composite generators, ...) or
+// with syntax errors are left to the ANTLR parser.
+class XASMFastParser {
+public:
+  // Builds the kernel of in_src with io_listener. Returns false, without
+  // calling io_listener, if in_src is not a straight-line kernel.
+  static bool parse(const std::string &in_src, XASMListener &io_listener);
+};
+} // namespace xacc
+#endif
@@ -237,43 +237,43 @@ XASMListener::XASMListener() {
   parsingUtil = xacc::getService<ExpressionParsingUtil>("exprtk");
 }
 
-void XASMListener::enterXacckernel(xasmParser::XacckernelContext *ctx) {
+void XASMListener::beginFunction(
+    const std::string &name,
+    const std::vector<std::pair<std::string, std::string>> &typedParams) {
   std::vector<std::string> variables,
       validTypes{"double", "float", "std::vector<double>", "int"};
 
-  function = irProvider->createComposite(ctx->kernelname->getText());
-  for (int i = 0; i < ctx->typedparam().size(); i++) {
-    auto type = ctx->typedparam(i)->type()->getText();
-    auto vname = ctx->typedparam(i)->variable_param_name()->getText();
+  function = irProvider->createComposite(name);
+  for (auto &[type, vname] : typedParams) {
     function->addArgument(vname, type);
     if (type == "qreg" || type == "qbit") {
       functionBufferNames.push_back(vname);
     }
-    if (xacc::container::contains(validTypes,
-                                  ctx->typedparam(i)->type()->getText())) {
+    if (xacc::container::contains(validTypes, type)) {
       variables.push_back(vname);
     }
   }
   function->addVariables(variables);
 }
 
+void XASMListener::enterXacckernel(xasmParser::XacckernelContext *ctx) {
+  std::vector<std::pair<std::string, std::string>> typedParams;
+  for (int i = 0; i < ctx->typedparam().size(); i++) {
+    typedParams.emplace_back(
+        ctx->typedparam(i)->type()->getText(),
+        ctx->typedparam(i)->variable_param_name()->getText());
+  }
+  beginFunction(ctx->kernelname->getText(), typedParams);
+}
+
 void XASMListener::enterXacclambda(xasmParser::XacclambdaContext *ctx) {
-  std::vector<std::string> variables,
-      validTypes{"double", "float", "std::vector<double>", "int"};
-  function = irProvider->createComposite("tmp_lambda", variables);
+  std::vector<std::pair<std::string, std::string>> typedParams;
   for (int i = 0; i < ctx->typedparam().size(); i++) {
-    auto type = ctx->typedparam(i)->type()->getText();
-    auto vname = ctx->typedparam(i)->variable_param_name()->getText();
-    function->addArgument(vname, type);
-    if (type == "qreg" || type == "qbit") {
-      functionBufferNames.push_back(vname);
-    }
-    if (xacc::container::contains(validTypes,
-                                  ctx->typedparam(i)->type()->getText())) {
-      variables.push_back(vname);
-    }
+    typedParams.emplace_back(
+        ctx->typedparam(i)->type()->getText(),
+        ctx->typedparam(i)->variable_param_name()->getText());
   }
-  function->addVariables(variables);
+  beginFunction("tmp_lambda", typedParams);
 }
 
 void XASMListener::enterForstmt(xasmParser::ForstmtContext *ctx) {
@@ -378,138 +378,165 @@ void XASMListener::exitIfstmt(xasmParser::IfstmtContext *ctx) {
 }
 
 void XASMListener::enterInstruction(xasmParser::InstructionContext *ctx) {
-  currentInstructionName = ctx->inst_name->ID()->getText();
+  beginInstruction(ctx->inst_name->ID()->getText());
+}
+
+void XASMListener::beginInstruction(const std::string &name) {
+  currentInstructionName = name;
   xacc::debug("[XasmCompiler] Current Instruction Name: " +
               currentInstructionName, debug_predicate);
 }
 void XASMListener::enterBufferList(xasmParser::BufferListContext *ctx) {
   auto nBits = ctx->bufferIndex().size();
   for (int i = 0; i < nBits; i++) {
-    auto name = ctx->bufferIndex(i)->buffer_name->ID()->getText();
-
-    // We may have something like Ry(q[0], x[0]) which will cause this
-    // code to add x as a buffer name even though it is a std::vector<double>.
-    // So here we make sure that name is in functionBufferNames and if not, then
-    // we assume it is a parameter
-    if (!functionBufferNames.empty() &&
-        !xacc::container::contains(functionBufferNames, name)) {
-
-      // Measure instructions which have explicit classical register indexing:
-      // e.g. Measure(q[0], cReg[2]);
-      if (currentInstructionName == "Measure") {
-        xacc::debug("[XasmCompiler] Found classical buffer bit in Measure gate expression.");
-
-        if (nBits > 2) {
-          xacc::error("[XasmCompiler] Illegal Measure  gate variable list. Max "
-                      "number of arguments = 2; Received " +
-                      std::to_string(nBits));
-        }
-        // TODO: support for loops...
-        auto bit_idx_str = ctx->bufferIndex(i)->idx->getText();
-        auto bit = std::stoi(bit_idx_str);
-        measure_cReg = std::make_pair(name, bit);
-        currentBufferNames.push_back(name);
-        return;
-      }
-      xacc::debug("[XasmCompiler] Found parameter in buffer list. " + name,debug_predicate);
-
-      // FIXME HANDLE things like x[i] or x[i+1]
-      auto newVar = name + ctx->bufferIndex(i)->idx->getText();
+    auto bufferIndex = ctx->bufferIndex(i);
+    if (!addBufferIndex(i, nBits, bufferIndex->buffer_name->ID()->getText(),
+                        bufferIndex->idx->getText(),
+                        bufferIndex->idx->INT() != nullptr)) {
+      return;
+    }
+  }
+}
 
-      if (!inForLoop) {
-        new_var_to_vector_idx.insert(
-            {newVar, std::stoi(ctx->bufferIndex(i)->idx->getText())});
+bool XASMListener::addBufferIndex(int i, std::size_t nBits,
+                                  const std::string &name,
+                                  const std::string &idx, bool isIntIdx) {
+  // We may have something like Ry(q[0], x[0]) which will cause this
+  // code to add x as a buffer name even though it is a std::vector<double>.
+  // So here we make sure that name is in functionBufferNames and if not, then
+  // we assume it is a parameter
+  if (!functionBufferNames.empty() &&
+      !xacc::container::contains(functionBufferNames, name)) {
+
+    // Measure instructions which have explicit classical register indexing:
+    // e.g. Measure(q[0], cReg[2]);
+    if (currentInstructionName == "Measure") {
+      xacc::debug("[XasmCompiler] Found classical buffer bit in Measure gate expression.");
+
+      if (nBits > 2) {
+        xacc::error("[XasmCompiler] Illegal Measure  gate variable list. Max "
+                    "number of arguments = 2; Received " +
+                    std::to_string(nBits));
       }
+      // TODO: support for loops...
+      auto bit = std::stoi(idx);
+      measure_cReg = std::make_pair(name, bit);
+      currentBufferNames.push_back(name);
+      return false;
+    }
+    xacc::debug("[XasmCompiler] Found parameter in buffer list. " + name,debug_predicate);
 
-      // Check if we have a for-loop parameterized parameter
-      double ref;
-      if (inForLoop &&
-          !parsingUtil->isConstant(ctx->bufferIndex(i)->idx->getText(), ref)) {
-        newVar = name + "[" + ctx->bufferIndex(i)->idx->getText() + "]";
-      }
+    // FIXME HANDLE things like x[i] or x[i+1]
+    auto newVar = name + idx;
 
-      // If x is in existingVars (like std::vector<double> x) then
-      // replace it with newVar
-      if (xacc::container::contains(function->getVariables(), name)) {
-        function->replaceVariable(name, newVar);
-        if (inForLoop)
-          for_function->replaceVariable(name, newVar);
-        if (inIfStmt)
-          if_stmt->replaceVariable(name, newVar);
-      } else {
-        function->addVariable(newVar);
-        if (inForLoop)
-          for_function->addVariable(newVar);
-        if (inIfStmt)
-          if_stmt->addVariable(newVar);
-      }
-      currentParameters.push_back(newVar);
-      return;
+    if (!inForLoop) {
+      new_var_to_vector_idx.insert(
+          {newVar, std::stoi(idx)});
     }
 
-    xacc::debug("[XasmCompiler] Adding buffer name " + name,debug_predicate);
-
-    currentBufferNames.push_back(name);
-    if (ctx->bufferIndex(i)->idx->INT() != nullptr) {
-      auto bit_idx_str = ctx->bufferIndex(i)->idx->getText();
-      std::size_t bit = std::stoi(bit_idx_str);
-      currentBits.push_back(bit);
-      // By default, measure cReg data is uninitialized:
-      // i.e. assuming user is using the form Measure(q[0]);
-      // using an empty 
-      if (currentInstructionName == "Measure") {
-        measure_cReg = std::make_pair("", -1);
-      }
+    // Check if we have a for-loop parameterized parameter
+    double ref;
+    if (inForLoop &&
+        !parsingUtil->isConstant(idx, ref)) {
+      newVar = name + "[" + idx + "]";
+    }
+
+    // If x is in existingVars (like std::vector<double> x) then
+    // replace it with newVar
+    if (xacc::container::contains(function->getVariables(), name)) {
+      function->replaceVariable(name, newVar);
+      if (inForLoop)
+        for_function->replaceVariable(name, newVar);
+      if (inIfStmt)
+        if_stmt->replaceVariable(name, newVar);
     } else {
-      // this was a variable bit for a forstmt, add a -1
-      currentBits.push_back(-1);
-      // Map bit idx to the expression
-      currentBitIdxExpressions.insert({i, ctx->bufferIndex(i)->idx->getText()});
+      function->addVariable(newVar);
+      if (inForLoop)
+        for_function->addVariable(newVar);
+      if (inIfStmt)
+        if_stmt->addVariable(newVar);
     }
+    currentParameters.push_back(newVar);
+    return false;
   }
+
+  xacc::debug("[XasmCompiler] Adding buffer name " + name,debug_predicate);
+
+  currentBufferNames.push_back(name);
+  if (isIntIdx) {
+    std::size_t bit = std::stoi(idx);
+    currentBits.push_back(bit);
+    // By default, measure cReg data is uninitialized:
+    // i.e. assuming user is using the form Measure(q[0]);
+    // using an empty 
+    if (currentInstructionName == "Measure") {
+      measure_cReg = std::make_pair("", -1);
+    }
+  } else {
+    // this was a variable bit for a forstmt, add a -1
+    currentBits.push_back(-1);
+    // Map bit idx to the expression
+    currentBitIdxExpressions.insert({i, idx});
+  }
+  return true;
 }
 
 void XASMListener::enterParamList(xasmParser::ParamListContext *ctx) {
   for (int i = 0; i < ctx->parameter().size(); i++) {
     auto param = ctx->parameter(i)->exp();
     if (param->var_name != nullptr) {
-      // this param is a x[0]-like parameter
-      // our goal here is to replace x[0] with x0
-      // and update the function variable list accordingly
-      std::string newVar = param->var_name->getText() + param->idx->getText();
-      auto existingVars = function->getVariables();
-
-      new_var_to_vector_idx.insert({newVar, std::stoi(param->idx->getText())});
-
-      // If x is in existingVars (like std::vector<double> x) then
-      // replace it with newVar
-      if (xacc::container::contains(existingVars, param->var_name->getText())) {
-        function->replaceVariable(param->var_name->getText(), newVar);
-      } else {
-        function->addVariable(newVar);
-      }
+      addParameter(param->getText(), param->var_name->getText(),
+                   param->idx->getText());
+    } else {
+      addParameter(param->getText());
+    }
+  }
+}
 
-      currentParameters.push_back(newVar);
+void XASMListener::addParameter(const std::string &text,
+                                const std::string &varName,
+                                const std::string &varIdx) {
+  if (!varName.empty()) {
+    // this param is a x[0]-like parameter
+    // our goal here is to replace x[0] with x0
+    // and update the function variable list accordingly
+    std::string newVar = varName + varIdx;
+    auto existingVars = function->getVariables();
+
+    new_var_to_vector_idx.insert({newVar, std::stoi(varIdx)});
+
+    // If x is in existingVars (like std::vector<double> x) then
+    // replace it with newVar
+    if (xacc::container::contains(existingVars, varName)) {
+      function->replaceVariable(varName, newVar);
     } else {
+      function->addVariable(newVar);
+    }
 
-      xacc::debug("[XasmCompiler] Parameter was " + param->getText(),debug_predicate);
-      // This could be like just a string, or an expression like pi/2
-      double value;
-      if (parsingUtil->isConstant(param->getText(), value)) {
-        xacc::debug("[XasmCompiler] Parameter added is " +
-                    std::to_string(value),debug_predicate);
-        currentParameters.emplace_back(value);
-      } else {
-        xacc::debug("[XasmCompiler] Parameter added is " + param->getText(),debug_predicate);
-        InstructionParameter p(param->getText());
-        p.storeOriginalExpression();
-        currentParameters.push_back(p);
-      }
+    currentParameters.push_back(newVar);
+  } else {
+
+    xacc::debug("[XasmCompiler] Parameter was " + text,debug_predicate);
+    // This could be like just a string, or an expression like pi/2
+    double value;
+    if (parsingUtil->isConstant(text, value)) {
+      xacc::debug("[XasmCompiler] Parameter added is " +
+                  std::to_string(value),debug_predicate);
+      currentParameters.emplace_back(value);
+    } else {
+      xacc::debug("[XasmCompiler] Parameter added is " + text,debug_predicate);
+      InstructionParameter p(text);
+      p.storeOriginalExpression();
+      currentParameters.push_back(p);
     }
   }
 }
 
 void XASMListener::exitInstruction(xasmParser::InstructionContext *ctx) {
+  endInstruction();
+}
+
+void XASMListener::endInstruction() {
   auto inst = irProvider->createInstruction(currentInstructionName, currentBits,
                                             currentParameters);
 
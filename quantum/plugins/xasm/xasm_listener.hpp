@@ -80,6 +80,21 @@ public:
   
   std::shared_ptr<CompositeInstruction> getFunction() { return function; }
 
+  // The IR building steps, called with the text of the parsed constructs, by
+  // the callbacks below and by the XASMFastParser.
+  void beginFunction(
+      const std::string &name,
+      const std::vector<std::pair<std::string, std::string>> &typedParams);
+  void beginInstruction(const std::string &name);
+  // The i-th of the nBits buffer list entries, name[idx]. Returns false if
+  // the remaining entries are to be skipped.
+  bool addBufferIndex(int i, std::size_t nBits, const std::string &name,
+                      const std::string &idx, bool isIntIdx);
+  // varName and varIdx are set for the varName[varIdx] parameters.
+  void addParameter(const std::string &text, const std::string &varName = "",
+                    const std::string &varIdx = "");
+  void endInstruction();
+
   void enterXacckernel(xasmParser::XacckernelContext * /*ctx*/) override;
   void enterXacclambda(xasmParser::XacclambdaContext * /*ctx*/) override;
 
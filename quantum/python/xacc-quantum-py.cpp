@@ -15,6 +15,7 @@
 #include "FermionOperator.hpp"
 #include "ObservableTransform.hpp"
 #include "PauliOperator.hpp"
+#include "ResourceEstimator.hpp"
 #include "py_heterogeneous_map.hpp"
 #include "py_observable.hpp"
 #include "xacc.hpp"
@@ -143,6 +144,83 @@ void bind_quantum(py::module &m) {
            }
            return mat;
       })
+      .def_static(
+          "from_symplectic",
+          [](py::array_t<bool, py::array::c_style | py::array::forcecast> x,
+             py::array_t<bool, py::array::c_style | py::array::forcecast> z,
+             py::array_t<std::complex<double>,
+                         py::array::c_style | py::array::forcecast>
+                 coeffs) {
+            if (x.ndim() != 2 || z.ndim() != 2 || coeffs.ndim() != 1 ||
+                x.shape(0) != z.shape(0) || x.shape(1) != z.shape(1) ||
+                x.shape(0) != coeffs.shape(0)) {
+              xacc::error("PauliOperator.from_symplectic: x and z must be "
+                          "(terms, qubits) bit arrays, coeffs of size terms.");
+            }
+            const size_t nbTerms = x.shape(0), nbQubits = x.shape(1);
+            const size_t nbWords = (nbQubits + 63) / 64;
+            std::vector<uint64_t> xw(nbTerms * nbWords, 0),
+                zw(nbTerms * nbWords, 0);
+            auto xb = x.unchecked<2>();
+            auto zb = z.unchecked<2>();
+            for (size_t t = 0; t < nbTerms; ++t) {
+              for (size_t q = 0; q < nbQubits; ++q) {
+                xw[t * nbWords + q / 64] |= uint64_t(xb(t, q)) << (q % 64);
+                zw[t * nbWords + q / 64] |= uint64_t(zb(t, q)) << (q % 64);
+              }
+            }
+            PauliOperator op;
+            {
+              py::gil_scoped_release release;
+              op.fromSymplectic(xw.data(), zw.data(), nbWords, coeffs.data(),
+                                nbTerms);
+            }
+            return op;
+          },
+          "The sum of coeffs[t] P_t, the Pauli string P_t with X (Z) on the "
+          "qubits q where x[t, q] (z[t, q]) is set, Y where both are.",
+          py::arg("x"), py::arg("z"), py::arg("coeffs"))
+      .def(
+          "to_scipy_sparse",
+          [](PauliOperator &op) {
+            std::vector<SparseTriplet> elements;
+            {
+              py::gil_scoped_release release;
+              elements = op.getSparseMatrixElements();
+            }
+            const size_t size = size_t(1) << op.nBits();
+            py::array_t<std::complex<double>> data(elements.size());
+            py::array_t<int64_t> rows(elements.size()), cols(elements.size());
+            auto d = data.mutable_unchecked<1>();
+            auto r = rows.mutable_unchecked<1>();
+            auto c = cols.mutable_unchecked<1>();
+            for (size_t i = 0; i < elements.size(); ++i) {
+              d(i) = elements[i].coeff();
+              r(i) = elements[i].row();
+              c(i) = elements[i].col();
+            }
+            return py::module::import("scipy.sparse")
+                .attr("csr_matrix")(
+                    py::make_tuple(data, py::make_tuple(rows, cols)),
+                    py::arg("shape") = py::make_tuple(size, size));
+          },
+          "The matrix as a scipy.sparse CSR matrix.")
+      .def(
+          "expectation",
+          [](PauliOperator &op,
+             py::array_t<std::complex<double>,
+                         py::array::c_style | py::array::forcecast>
+                 state) {
+            if (state.ndim() != 1) {
+              xacc::error("PauliOperator.expectation: the state must be a 1D "
+                          "array of amplitudes.");
+            }
+            py::gil_scoped_release release;
+            return op.expectationValue(state.data(), state.shape(0));
+          },
+          "<psi|H|psi> of the state vector psi (qubit 0 is the most "
+          "significant bit of the index, as to_numpy).",
+          py::arg("state"))
       .def(
           "__iter__",
           [](PauliOperator &op) {
@@ -244,4 +322,48 @@ void bind_quantum(py::module &m) {
       .def("getGradientExecutions",
            &AlgorithmGradientStrategy::getGradientExecutions)
       .def("compute", &AlgorithmGradientStrategy::compute);
-}
\ No newline at end of file
+
+  py::class_<TimingModel>(k, "TimingModel",
+                          "Gate durations (ns) of a backend, for the "
+                          "ResourceEstimator.")
+      .def(py::init<>())
+      .def_readwrite("singleQubitNs", &TimingModel::singleQubitNs)
+      .def_readwrite("twoQubitNs", &TimingModel::twoQubitNs)
+      .def_readwrite("measureNs", &TimingModel::measureNs)
+      .def_readwrite("shotOverheadNs", &TimingModel::shotOverheadNs)
+      .def_readwrite("singleQubitOverrides",
+                     &TimingModel::singleQubitOverrides)
+      .def_readwrite("measureOverrides", &TimingModel::measureOverrides)
+      .def_readwrite("twoQubitOverrides", &TimingModel::twoQubitOverrides)
+      .def_static("fromIbmProperties", &TimingModel::fromIbmProperties,
+                  py::arg("properties"), py::arg("config") = "")
+      .def_static("fromAccelerator", &TimingModel::fromAccelerator);
+  py::class_<ResourceEstimate>(k, "ResourceEstimate")
+      .def_readonly("nbQubits", &ResourceEstimate::nbQubits)
+      .def_readonly("nbGates", &ResourceEstimate::nbGates)
+      .def_readonly("nbTwoQubitGates", &ResourceEstimate::nbTwoQubitGates)
+      .def_readonly("nbTGates", &ResourceEstimate::nbTGates)
+      .def_readonly("nbNonCliffordRotations",
+                    &ResourceEstimate::nbNonCliffordRotations)
+      .def_readonly("nbMeasurements", &ResourceEstimate::nbMeasurements)
+      .def_readonly("depth", &ResourceEstimate::depth)
+      .def_readonly("stateVectorBytes", &ResourceEstimate::stateVectorBytes)
+      .def_readonly("durationNs", &ResourceEstimate::durationNs)
+      .def_readonly("runtimeSeconds", &ResourceEstimate::runtimeSeconds);
+  py::class_<ResourceEstimator>(
+      k, "ResourceEstimator",
+      "Estimates the gate counts, depth, memory and runtime of circuits "
+      "before their execution.")
+      .def(py::init<const TimingModel &>(), py::arg("model") = TimingModel())
+      .def(py::init<const std::shared_ptr<xacc::Accelerator> &>())
+      .def("estimate",
+           py::overload_cast<const std::shared_ptr<CompositeInstruction> &,
+                             int>(&ResourceEstimator::estimate, py::const_),
+           py::arg("program"), py::arg("shots") = 1)
+      .def("estimate",
+           py::overload_cast<
+               const std::vector<std::shared_ptr<CompositeInstruction>> &,
+               int>(&ResourceEstimator::estimate, py::const_),
+           py::arg("programs"), py::arg("shots") = 1)
+      .def("getTimingModel", &ResourceEstimator::getTimingModel);
+}
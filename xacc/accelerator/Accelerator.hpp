@@ -19,8 +19,14 @@
 #include "Identifiable.hpp"
 #include "Utils.hpp"
 #include "Observable.hpp"
+#include "StateVectorFile.hpp"
 #include "heterogeneous.hpp"
+#include <algorithm>
+#include <chrono>
 #include <complex>
+#include <functional>
+#include <future>
+#include <mutex>
 
 namespace xacc {
 
@@ -39,8 +45,54 @@ const std::string DmKey = "density-matrix";
 // Row-by-row matrix
 using DensityMatrixType = std::vector<WaveFuncType>;
 using DensityMatrixPtrType = std::shared_ptr<DensityMatrixType>;
+
+// Metrics of the last execution, reported by all the Accelerators (doubles
+// unless noted, see ExecutionMetrics):
+// Time (ms) the job waited in the backend queue
+const std::string QueueTimeKey = "queue-time-ms";
+// Time (ms) from the start of the job to its results
+const std::string ExecutionTimeKey = "execution-time-ms";
+// Peak memory (bytes) of the simulation
+const std::string PeakMemoryKey = "peak-memory-bytes";
+// Number of circuits (int)
+const std::string CircuitCountKey = "circuit-count";
+// Number of shots per circuit (int)
+const std::string ShotCountKey = "shot-count";
 } // namespace ExecutionInfo
 
+// The metrics of an execution (one job) of an Accelerator. Unknown values
+// are negative, e.g. the shots of an exact expectation value calculation
+// or the memory footprint of a remote backend.
+struct ExecutionMetrics {
+  // Signature of the Accelerator, and backend job id if any
+  std::string accelerator;
+  std::string jobId;
+  double queueTimeMs = 0.0;
+  double executionTimeMs = 0.0;
+  double peakMemoryBytes = -1.0;
+  int nbCircuits = 0;
+  int nbShots = -1;
+
+  HeterogeneousMap toExecutionInfo() const {
+    HeterogeneousMap info;
+    info.insert(ExecutionInfo::QueueTimeKey, queueTimeMs);
+    info.insert(ExecutionInfo::ExecutionTimeKey, executionTimeMs);
+    if (peakMemoryBytes >= 0.0) {
+      info.insert(ExecutionInfo::PeakMemoryKey, peakMemoryBytes);
+    }
+    info.insert(ExecutionInfo::CircuitCountKey, nbCircuits);
+    if (nbShots >= 0) {
+      info.insert(ExecutionInfo::ShotCountKey, nbShots);
+    }
+    return info;
+  }
+};
+
+// Receives the metrics of each execution, e.g. a scheduler placing jobs on
+// the cheapest adequate backend. May be called from the thread of an
+// executeAsync() call.
+using ExecutionMetricsCallback = std::function<void(const ExecutionMetrics &)>;
+
 // The Accelerator is the primary interface connecting programmers/clients
 // with an available post-Moore's law co-processor (or accelerator, think GPU).
 // Accelerators primarily expose execution functionality, which takes
@@ -106,6 +158,112 @@ public:
                        const std::vector<std::shared_ptr<CompositeInstruction>>
                            CompositeInstructions) = 0;
 
+  // Non-blocking variants of execute. Results are persisted to the
+  // buffer exactly as execute would, and are available once the returned
+  // future is ready. The default runs execute on a separate thread.
+  // Backends with a remote job queue should override these to submit
+  // immediately and only wait on the job in the returned future.
+  // Outstanding calls on the same instance may run concurrently.
+  virtual std::future<void>
+  executeAsync(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::shared_ptr<CompositeInstruction> program) {
+    return std::async(std::launch::async,
+                      [this, buffer, program]() { execute(buffer, program); });
+  }
+
+  virtual std::future<void>
+  executeAsync(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::vector<std::shared_ptr<CompositeInstruction>>
+                   programs) {
+    return std::async(std::launch::async, [this, buffer, programs]() {
+      execute(buffer, programs);
+    });
+  }
+
+  // Execute a batch of programs that share long leading gate sequences,
+  // e.g. the shifted circuits of a gradient calculation. Results are the
+  // same as execute(buffer, programs). State-vector simulators may
+  // checkpoint the state at gate boundaries and start each program from
+  // the nearest checkpoint rather than from |0> (prefix sharing).
+  // The default just calls execute.
+  virtual void executeWithPrefixSharing(
+      std::shared_ptr<AcceleratorBuffer> buffer,
+      const std::vector<std::shared_ptr<CompositeInstruction>> programs) {
+    execute(buffer, programs);
+  }
+
+  // Evaluate the terms of an observable on the state prepared by the
+  // ansatz. Appends one child buffer per measured (i.e. non-identity)
+  // kernel of observable->observe(ansatz), in that order and named as the
+  // kernel, so that Observable::postProcess() can be applied to buffer.
+  // The default executes the observed kernels; state-vector simulators
+  // can override this to prepare the ansatz state only once.
+  virtual void
+  computeExpectations(std::shared_ptr<AcceleratorBuffer> buffer,
+                      const std::shared_ptr<CompositeInstruction> ansatz,
+                      std::shared_ptr<Observable> observable) {
+    std::vector<std::shared_ptr<CompositeInstruction>> measured;
+    for (auto &kernel : observable->observe(ansatz)) {
+      // The identity kernel only contains the ansatz.
+      const int nbInstructions =
+          (kernel->nInstructions() > 0 &&
+           kernel->getInstruction(0)->isComposite())
+              ? ansatz->nInstructions() + kernel->nInstructions() - 1
+              : kernel->nInstructions();
+      if (nbInstructions > ansatz->nInstructions()) {
+        measured.emplace_back(kernel);
+      }
+    }
+    execute(buffer, measured);
+  }
+
+  // Batched computeExpectations: the observable on the state of each
+  // ansatzes[i], the children appended to buffers[i] as above. The default
+  // submits the measured kernels of all the ansatzes as one execution (e.g.
+  // a single remote job for a generation of a population-based optimizer).
+  virtual void computeExpectations(
+      const std::vector<std::shared_ptr<AcceleratorBuffer>> &buffers,
+      const std::vector<std::shared_ptr<CompositeInstruction>> &ansatzes,
+      std::shared_ptr<Observable> observable) {
+    if (buffers.size() != ansatzes.size()) {
+      XACCLogger::instance()->error(
+          "computeExpectations: expected one buffer per ansatz.");
+    }
+    std::vector<std::shared_ptr<CompositeInstruction>> measured;
+    std::vector<std::size_t> nbMeasured;
+    for (auto &ansatz : ansatzes) {
+      std::size_t count = 0;
+      for (auto &kernel : observable->observe(ansatz)) {
+        const int nbInstructions =
+            (kernel->nInstructions() > 0 &&
+             kernel->getInstruction(0)->isComposite())
+                ? ansatz->nInstructions() + kernel->nInstructions() - 1
+                : kernel->nInstructions();
+        if (nbInstructions > ansatz->nInstructions()) {
+          measured.emplace_back(kernel);
+          count++;
+        }
+      }
+      nbMeasured.push_back(count);
+    }
+    if (measured.empty()) {
+      return;
+    }
+    auto tmpBuffer = std::make_shared<AcceleratorBuffer>(buffers[0]->size());
+    execute(tmpBuffer, measured);
+    auto children = tmpBuffer->getChildren();
+    if (children.size() != measured.size()) {
+      XACCLogger::instance()->error(
+          "computeExpectations: expected one result per kernel.");
+    }
+    std::size_t next = 0;
+    for (std::size_t i = 0; i < buffers.size(); i++) {
+      for (std::size_t k = 0; k < nbMeasured[i]; k++, next++) {
+        buffers[i]->appendChild(children[next]->name(), children[next]);
+      }
+    }
+  }
+
   virtual void cancel(){};
 
   virtual std::vector<std::pair<int, int>> getConnectivity() {
@@ -117,6 +275,39 @@ public:
     return std::vector<std::complex<double>>{};
   }
 
+  // Writes the state vector of the last execution to a NumPy .npy file
+  // (StateVectorFile.hpp), e.g. as the initial state of another simulation.
+  // By default, the ExecutionInfo wave function, written in chunks to the
+  // mapped file; simulators not holding the state in memory (paged) override
+  // it to stream it.
+  virtual void exportState(const std::string &path) {
+    const auto info = getExecutionInfo();
+    auto waveFn =
+        info.find<ExecutionInfo::WaveFuncPtrType>(ExecutionInfo::WaveFuncKey);
+    if (!waveFn || !*waveFn || (*waveFn)->empty()) {
+      XACCLogger::instance()->error("Accelerator '" + name() +
+                                    "' has no state vector to export.");
+      return;
+    }
+    const auto &amplitudes = **waveFn;
+    size_t nbQubits = 0;
+    while ((1ULL << nbQubits) < amplitudes.size()) {
+      ++nbQubits;
+    }
+    if ((1ULL << nbQubits) != amplitudes.size()) {
+      XACCLogger::instance()->error(
+          "Invalid state vector of " + std::to_string(amplitudes.size()) +
+          " amplitudes.");
+      return;
+    }
+    StateVectorWriter writer(path, nbQubits);
+    constexpr size_t chunkSize = 1 << 20;
+    for (size_t offset = 0; offset < amplitudes.size(); offset += chunkSize) {
+      writer.write(offset, amplitudes.data() + offset,
+                   std::min(chunkSize, amplitudes.size() - offset));
+    }
+  }
+
   virtual bool isRemote() { return false; }
   // Gate-by-gate application (with a persistent underlying quantum state)
   virtual void apply(std::shared_ptr<AcceleratorBuffer> buffer,
@@ -124,24 +315,160 @@ public:
     throw std::logic_error("Accelerator '" + name() +
                            "' doesn't support single gate application.");
   }
+  // Applies a sequence of gates to the same persistent state, e.g. the gates
+  // between two mid-circuit measurements. Measurement results are stored on
+  // the buffer (buffer->measure(bit, result)), read with (*buffer)[bit].
+  virtual void apply(std::shared_ptr<AcceleratorBuffer> buffer,
+                     const std::vector<std::shared_ptr<Instruction>> &insts) {
+    for (auto &inst : insts) {
+      apply(buffer, inst);
+    }
+  }
 
   // Custom execution-related information (specific to each Acc implementation)
-  virtual HeterogeneousMap getExecutionInfo() const { return {}; }
+  // and the metrics of the last execution (ExecutionInfo keys above).
+  virtual HeterogeneousMap getExecutionInfo() const {
+    return getLastExecutionMetrics().toExecutionInfo();
+  }
+
+  // Metrics of each execution: the callback is called with the metrics of
+  // every job, getLastExecutionMetrics() returns those of the last one.
+  virtual void setExecutionMetricsCallback(ExecutionMetricsCallback callback) {
+    std::lock_guard<std::mutex> lock(m_metricsMutex);
+    m_metricsCallback = std::move(callback);
+  }
+  virtual ExecutionMetrics getLastExecutionMetrics() const {
+    std::lock_guard<std::mutex> lock(m_metricsMutex);
+    return m_lastMetrics;
+  }
+  // Called by the implementations at the end of each execution
+  void reportExecutionMetrics(ExecutionMetrics metrics) {
+    if (metrics.accelerator.empty()) {
+      metrics.accelerator = getSignature();
+    }
+    ExecutionMetricsCallback callback;
+    {
+      std::lock_guard<std::mutex> lock(m_metricsMutex);
+      m_lastMetrics = metrics;
+      callback = m_metricsCallback;
+    }
+    if (callback) {
+      callback(metrics);
+    }
+  }
 
   // Retrieve a particular execution-related information.
+  // Note: getExecutionInfo() builds the map, fetch it once.
   template <typename T> T getExecutionInfo(const std::string &key) {
-    if (!getExecutionInfo().keyExists<T>(key)) {
-      XACCLogger::instance()->error(
-          "getExecutionInfo() error - Invalid information key (" + key + ").");
-    } else {
-      return getExecutionInfo().get<T>(key);
+    const auto info = getExecutionInfo();
+    if (auto value = info.find<T>(key)) {
+      return *value;
     }
+    XACCLogger::instance()->error(
+        "getExecutionInfo() error - Invalid information key (" + key + ").");
     return T();
   }
 
   virtual ~Accelerator() {}
+
+private:
+  mutable std::mutex m_metricsMutex;
+  ExecutionMetrics m_lastMetrics;
+  ExecutionMetricsCallback m_metricsCallback;
+};
+
+// Times a job from its submission (construction) to stop(). started()
+// marks the start of its execution, the time before was spent queuing,
+// e.g. called by a remote job status check when first seen running.
+class ExecutionTimer {
+public:
+  ExecutionTimer()
+      : m_submitted(std::chrono::steady_clock::now()), m_started(m_submitted) {}
+  explicit ExecutionTimer(std::chrono::steady_clock::time_point submitted)
+      : m_submitted(submitted), m_started(submitted) {}
+
+  // The first call only
+  void started() {
+    if (!m_isStarted) {
+      m_isStarted = true;
+      m_started = std::chrono::steady_clock::now();
+    }
+  }
+
+  // io_metrics with the queue and execution times of the job
+  ExecutionMetrics &stop(ExecutionMetrics &io_metrics) const {
+    using ms = std::chrono::duration<double, std::milli>;
+    io_metrics.queueTimeMs = ms(m_started - m_submitted).count();
+    io_metrics.executionTimeMs =
+        ms(std::chrono::steady_clock::now() - m_started).count();
+    return io_metrics;
+  }
+
+private:
+  std::chrono::steady_clock::time_point m_submitted;
+  std::chrono::steady_clock::time_point m_started;
+  bool m_isStarted = false;
+};
+
+// Measures an execution of an Accelerator, reported by
+// Accelerator::reportExecutionMetrics() at the end of the scope:
+//   ScopedExecutionMetrics metrics(*this, programs.size(), shots);
+//   metrics.metrics().peakMemoryBytes = ...;
+// Only the outermost scope of an Accelerator reports, e.g. not the
+// execute(program) calls of its execute(programs), nor an execution that
+// throws. The peak memory of the nested scopes is that of the outermost.
+class ScopedExecutionMetrics {
+public:
+  ScopedExecutionMetrics(Accelerator &accelerator, int nbCircuits,
+                         int nbShots = -1)
+      : m_accelerator(accelerator), m_outer(find(accelerator)),
+        m_nbExceptions(std::uncaught_exceptions()) {
+    m_metrics.nbCircuits = nbCircuits;
+    m_metrics.nbShots = nbShots;
+    if (!m_outer) {
+      active().push_back(this);
+    }
+  }
+  ScopedExecutionMetrics(const ScopedExecutionMetrics &) = delete;
+  ScopedExecutionMetrics &operator=(const ScopedExecutionMetrics &) = delete;
+
+  ExecutionMetrics &metrics() { return m_metrics; }
+
+  ~ScopedExecutionMetrics() {
+    if (m_outer) {
+      m_outer->m_metrics.peakMemoryBytes = std::max(
+          m_outer->m_metrics.peakMemoryBytes, m_metrics.peakMemoryBytes);
+      return;
+    }
+    active().erase(std::find(active().begin(), active().end(), this));
+    if (std::uncaught_exceptions() > m_nbExceptions) {
+      return;
+    }
+    m_accelerator.reportExecutionMetrics(m_timer.stop(m_metrics));
+  }
+
+private:
+  // The outermost scopes on this thread, one per Accelerator
+  static std::vector<ScopedExecutionMetrics *> &active() {
+    static thread_local std::vector<ScopedExecutionMetrics *> scopes;
+    return scopes;
+  }
+  static ScopedExecutionMetrics *find(const Accelerator &accelerator) {
+    for (auto scope : active()) {
+      if (&scope->m_accelerator == &accelerator) {
+        return scope;
+      }
+    }
+    return nullptr;
+  }
+
+  Accelerator &m_accelerator;
+  ScopedExecutionMetrics *const m_outer;
+  const int m_nbExceptions;
+  ExecutionTimer m_timer;
+  ExecutionMetrics m_metrics;
 };
 
-template Accelerator* HeterogeneousMap::getPointerLike<Accelerator>(const std::string key) const;
+template Accelerator* HeterogeneousMap::getPointerLike<Accelerator>(const std::string &key) const;
 } // namespace xacc
 #endif
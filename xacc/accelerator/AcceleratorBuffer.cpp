@@ -161,6 +161,185 @@ void ToJsonVisitor<T>::operator()(
 
 template class ToJsonVisitor<PrettyWriter<StringBuffer>>;
 
+namespace {
+constexpr char binaryMagic[8] = {'X', 'A', 'C', 'C', 'B', 'U', 'F', '\0'};
+constexpr std::uint32_t binaryVersion = 1;
+constexpr char binaryRootRecord = 'R';
+constexpr char binaryChildRecord = 'C';
+
+template <typename T> void writeBinary(std::ostream &stream, const T &t) {
+  stream.write(reinterpret_cast<const char *>(&t), sizeof(T));
+}
+
+template <typename T> T readBinary(std::istream &stream) {
+  T t;
+  if (!stream.read(reinterpret_cast<char *>(&t), sizeof(T))) {
+    xacc::error("Invalid AcceleratorBuffer binary stream, unexpected end.");
+  }
+  return t;
+}
+
+void writeBinary(std::ostream &stream, const std::string &str) {
+  writeBinary<std::uint64_t>(stream, str.size());
+  stream.write(str.data(), str.size());
+}
+
+template <> std::string readBinary<std::string>(std::istream &stream) {
+  std::string str(readBinary<std::uint64_t>(stream), '\0');
+  if (!stream.read(&str[0], str.size())) {
+    xacc::error("Invalid AcceleratorBuffer binary stream, unexpected end.");
+  }
+  return str;
+}
+
+template <typename T>
+void writeBinary(std::ostream &stream, const std::vector<T> &vec) {
+  writeBinary<std::uint64_t>(stream, vec.size());
+  for (auto &v : vec) {
+    writeBinary(stream, v);
+  }
+}
+
+template <typename T> std::vector<T> readBinaryVector(std::istream &stream) {
+  std::vector<T> vec(readBinary<std::uint64_t>(stream));
+  for (auto &v : vec) {
+    v = readBinary<T>(stream);
+  }
+  return vec;
+}
+
+template <typename K, typename V>
+void writeBinary(std::ostream &stream, const std::map<K, V> &map) {
+  writeBinary<std::uint64_t>(stream, map.size());
+  for (auto &kv : map) {
+    writeBinary(stream, kv.first);
+    writeBinary(stream, kv.second);
+  }
+}
+
+template <typename K, typename V>
+void readBinaryMap(std::istream &stream, std::map<K, V> &map) {
+  const auto n = readBinary<std::uint64_t>(stream);
+  for (std::uint64_t i = 0; i < n; i++) {
+    auto key = readBinary<K>(stream);
+    map.emplace(std::move(key), readBinary<V>(stream));
+  }
+}
+
+class ToBinaryVisitor {
+private:
+  std::ostream &stream;
+
+public:
+  ToBinaryVisitor(std::ostream &s) : stream(s) {}
+  template <typename T> void operator()(const T &t) { writeBinary(stream, t); }
+  void operator()(const std::vector<std::pair<double, double>> &vec) {
+    writeBinary<std::uint64_t>(stream, vec.size());
+    for (auto &v : vec) {
+      writeBinary(stream, v.first);
+      writeBinary(stream, v.second);
+    }
+  }
+};
+
+void writeBinaryExtraInfo(std::ostream &stream, const ExtraInfo &info) {
+  writeBinary<std::uint8_t>(stream, info.index());
+  ToBinaryVisitor vis(stream);
+  mpark::visit(vis, info);
+}
+
+// Indices follow the order of the ExtraInfo alternatives
+ExtraInfo readBinaryExtraInfo(std::istream &stream) {
+  const auto index = readBinary<std::uint8_t>(stream);
+  switch (index) {
+  case 0:
+    return readBinary<int>(stream);
+  case 1:
+    return readBinary<double>(stream);
+  case 2:
+    return readBinary<std::string>(stream);
+  case 3:
+    return readBinaryVector<int>(stream);
+  case 4:
+    return readBinaryVector<double>(stream);
+  case 5:
+    return readBinaryVector<std::string>(stream);
+  case 6: {
+    std::map<int, std::vector<int>> map;
+    const auto n = readBinary<std::uint64_t>(stream);
+    for (std::uint64_t i = 0; i < n; i++) {
+      auto key = readBinary<int>(stream);
+      map.emplace(key, readBinaryVector<int>(stream));
+    }
+    return map;
+  }
+  case 7: {
+    std::vector<std::pair<double, double>> vec(
+        readBinary<std::uint64_t>(stream));
+    for (auto &v : vec) {
+      v.first = readBinary<double>(stream);
+      v.second = readBinary<double>(stream);
+    }
+    return vec;
+  }
+  case 8: {
+    std::map<int, int> map;
+    readBinaryMap(stream, map);
+    return map;
+  }
+  case 9: {
+    std::map<std::string, double> map;
+    readBinaryMap(stream, map);
+    return map;
+  }
+  default:
+    xacc::error("Invalid AcceleratorBuffer binary stream, unknown ExtraInfo "
+                "type " +
+                std::to_string(index) + ".");
+  }
+  return ExtraInfo();
+}
+
+// Hash of an ExtraInfo value, consistent with its exact equality.
+void hashCombine(std::size_t &seed, const std::size_t value) {
+  seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+template <typename T> std::size_t hashValue(const T &value) {
+  return std::hash<T>()(value);
+}
+template <typename T> std::size_t hashValue(const std::vector<T> &value);
+template <typename K, typename V>
+std::size_t hashValue(const std::map<K, V> &value);
+template <typename T, typename U>
+std::size_t hashValue(const std::pair<T, U> &value) {
+  auto seed = hashValue(value.first);
+  hashCombine(seed, hashValue(value.second));
+  return seed;
+}
+template <typename T> std::size_t hashValue(const std::vector<T> &value) {
+  std::size_t seed = value.size();
+  for (const auto &element : value) {
+    hashCombine(seed, hashValue(element));
+  }
+  return seed;
+}
+template <typename K, typename V>
+std::size_t hashValue(const std::map<K, V> &value) {
+  std::size_t seed = value.size();
+  for (const auto &element : value) {
+    hashCombine(seed, hashValue(element));
+  }
+  return seed;
+}
+std::size_t hashExtraInfo(const ExtraInfo &info) {
+  auto seed = mpark::visit(
+      [](const auto &value) -> std::size_t { return hashValue(value); },
+      info);
+  hashCombine(seed, info.index());
+  return seed;
+}
+} // namespace
+
 AcceleratorBuffer::AcceleratorBuffer(const int N) : bufferId(""), nBits(N) {}
 
 AcceleratorBuffer::AcceleratorBuffer(const std::string &str, const int N)
@@ -215,14 +394,43 @@ std::map<std::string, ExtraInfo> AcceleratorBuffer::getInformation() {
 void AcceleratorBuffer::appendChild(const std::string name,
                                     std::shared_ptr<AcceleratorBuffer> buffer) {
   children.push_back(std::make_pair(name, buffer));
+  indexChild(children.size() - 1);
+}
+
+void AcceleratorBuffer::indexChild(const std::size_t idx) {
+  auto &child = children[idx];
+  childNameIndex[child.first].push_back(idx);
+  for (auto &[infoName, index] : childInfoIndices) {
+    auto &childInfo = child.second->info;
+    auto iter = childInfo.find(infoName);
+    if (iter != childInfo.end()) {
+      index[hashExtraInfo(iter->second)].push_back(idx);
+    }
+  }
+}
+
+void AcceleratorBuffer::reindexChildren() {
+  childNameIndex.clear();
+  for (auto &kv : childInfoIndices) {
+    kv.second.clear();
+  }
+  for (std::size_t i = 0; i < children.size(); i++) {
+    indexChild(i);
+  }
+}
+
+void AcceleratorBuffer::indexChildrenBy(const std::string infoName) {
+  childInfoIndices[infoName];
+  reindexChildren();
 }
 
 std::vector<std::shared_ptr<AcceleratorBuffer>>
 AcceleratorBuffer::getChildren(const std::string name) {
   std::vector<std::shared_ptr<AcceleratorBuffer>> childrenWithName;
-  for (auto &child : children) {
-    if (child.first == name) {
-      childrenWithName.push_back(child.second);
+  auto iter = childNameIndex.find(name);
+  if (iter != childNameIndex.end()) {
+    for (const auto idx : iter->second) {
+      childrenWithName.push_back(children[idx].second);
     }
   }
 
@@ -253,6 +461,22 @@ AcceleratorBuffer::getChildren(const std::string infoName, ExtraInfo i) {
 
   std::vector<std::shared_ptr<AcceleratorBuffer>> childrenWithExtraInfo;
 
+  auto indexIter = childInfoIndices.find(infoName);
+  if (indexIter != childInfoIndices.end()) {
+    auto iter = indexIter->second.find(hashExtraInfo(i));
+    if (iter != indexIter->second.end()) {
+      for (const auto idx : iter->second) {
+        auto &childInfo = children[idx].second->info;
+        auto infoIter = childInfo.find(infoName);
+        // Hash collisions or values changed since indexing
+        if (infoIter != childInfo.end() && infoIter->second == i) {
+          childrenWithExtraInfo.push_back(children[idx].second);
+        }
+      }
+    }
+    return childrenWithExtraInfo;
+  }
+
   for (auto &child : children) {
     if (child.second->hasExtraInfoKey(infoName)) {
       auto childExtraInfo = child.second->getInformation(infoName);
@@ -317,24 +541,160 @@ const std::string AcceleratorBuffer::name() const { return bufferId; }
  */
 void AcceleratorBuffer::resetBuffer() {
   //   measurements.clear();
-  bitStringToCounts.clear();
+  clearMeasurements();
   children.clear();
+  reindexChildren();
   info.clear();
   single_measurements.clear();
 }
 
 void AcceleratorBuffer::appendMeasurement(const std::string &measurement) {
-
-  bitStringToCounts[measurement]++;
+  packedCounts[findOrAddMeasurement(measurement)]++;
+  countsAreMaterialized = false;
 }
 
 void AcceleratorBuffer::appendMeasurement(const std::string measurement,
                                           const int count) {
-  bitStringToCounts[measurement] = count;
-
+  packedCounts[findOrAddMeasurement(measurement)] = count;
+  countsAreMaterialized = false;
   return;
 }
 
+void AcceleratorBuffer::clearMeasurements() {
+  // measurements.clear();
+  bitStringToCounts.clear();
+  packedBitStrings.clear();
+  packedCounts.clear();
+  packedLengths.clear();
+  packedWords = 1;
+  irregularBitStrings.clear();
+  packedIndex.clear();
+  countsAreMaterialized = true;
+}
+
+void AcceleratorBuffer::setMeasurements(std::map<std::string, int> counts) {
+  clearMeasurements();
+  for (auto &kv : counts) {
+    appendMeasurement(kv.first, kv.second);
+  }
+}
+
+std::uint64_t
+AcceleratorBuffer::hashPackedRow(const std::uint64_t *row,
+                                 const std::size_t length) const {
+  std::uint64_t hash = length;
+  for (std::size_t w = 0; w < packedWords; w++) {
+    hash ^= row[w] + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+  }
+  return hash;
+}
+
+void AcceleratorBuffer::widenPackedMeasurements(const std::size_t nWords) {
+  std::vector<std::uint64_t> widened(packedCounts.size() * nWords, 0);
+  for (std::size_t i = 0; i < packedCounts.size(); i++) {
+    std::copy(packedBitStrings.begin() + i * packedWords,
+              packedBitStrings.begin() + (i + 1) * packedWords,
+              widened.begin() + i * nWords);
+  }
+  packedBitStrings = std::move(widened);
+  packedWords = nWords;
+
+  packedIndex.clear();
+  for (std::size_t i = 0; i < packedCounts.size(); i++) {
+    packedIndex.emplace(
+        hashPackedRow(&packedBitStrings[i * packedWords], packedLengths[i]),
+        i);
+  }
+}
+
+bool AcceleratorBuffer::packMeasurement(
+    const std::string &measurement, std::vector<std::uint64_t> &row) const {
+  row.assign(packedWords, 0);
+  bool isRegular = true;
+  // Bit k is the k-th character from the right
+  for (std::size_t k = 0; k < measurement.size(); k++) {
+    const auto c = measurement[measurement.size() - k - 1];
+    if (c == '1') {
+      row[k / 64] |= (1ULL << (k % 64));
+    } else if (c != '0') {
+      isRegular = false;
+    }
+  }
+  return isRegular;
+}
+
+std::size_t
+AcceleratorBuffer::findPackedRow(const std::vector<std::uint64_t> &row,
+                                 const std::string &measurement,
+                                 bool isRegular, std::uint64_t hash) const {
+  auto range = packedIndex.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    const auto i = it->second;
+    if (packedLengths[i] != measurement.size() ||
+        !std::equal(row.begin(), row.end(),
+                    packedBitStrings.begin() + i * packedWords)) {
+      continue;
+    }
+    auto irregular = irregularBitStrings.find(i);
+    if (isRegular ? irregular == irregularBitStrings.end()
+                  : irregular != irregularBitStrings.end() &&
+                        irregular->second == measurement) {
+      return i;
+    }
+  }
+  return std::string::npos;
+}
+
+std::size_t
+AcceleratorBuffer::findOrAddMeasurement(const std::string &measurement) {
+  const auto nWords = (measurement.size() + 63) / 64;
+  if (nWords > packedWords) {
+    widenPackedMeasurements(nWords);
+  }
+
+  std::vector<std::uint64_t> row;
+  const bool isRegular = packMeasurement(measurement, row);
+  const auto hash = hashPackedRow(row.data(), measurement.size());
+  const auto found = findPackedRow(row, measurement, isRegular, hash);
+  if (found != std::string::npos) {
+    return found;
+  }
+
+  const auto i = packedCounts.size();
+  packedBitStrings.insert(packedBitStrings.end(), row.begin(), row.end());
+  packedCounts.push_back(0);
+  packedLengths.push_back(measurement.size());
+  if (!isRegular) {
+    irregularBitStrings.emplace(i, measurement);
+  }
+  packedIndex.emplace(hash, i);
+  return i;
+}
+
+void AcceleratorBuffer::materializeMeasurementCounts() {
+  if (countsAreMaterialized) {
+    return;
+  }
+
+  bitStringToCounts.clear();
+  for (std::size_t i = 0; i < packedCounts.size(); i++) {
+    auto irregular = irregularBitStrings.find(i);
+    if (irregular != irregularBitStrings.end()) {
+      bitStringToCounts.emplace(irregular->second, packedCounts[i]);
+      continue;
+    }
+    const auto *row = &packedBitStrings[i * packedWords];
+    std::string bitStr(packedLengths[i], '0');
+    for (std::size_t k = 0; k < bitStr.size(); k++) {
+      if ((row[k / 64] >> (k % 64)) & 1ULL) {
+        bitStr[bitStr.size() - k - 1] = '1';
+      }
+    }
+    bitStringToCounts.emplace(std::move(bitStr), packedCounts[i]);
+  }
+  countsAreMaterialized = true;
+}
+
 bool AcceleratorBuffer::operator[](const std::size_t &i) {
   if (!single_measurements.count(i)) {
     xacc::error("This bit (" + std::to_string(i) +
@@ -383,12 +743,19 @@ AcceleratorBuffer::single_measurements_to_bitstring(BitOrder bitOrder,
 
 double
 AcceleratorBuffer::computeMeasurementProbability(const std::string &bitStr) {
-  return (double)bitStringToCounts[bitStr] /
-         std::accumulate(
-             bitStringToCounts.begin(), bitStringToCounts.end(), 0,
-             [](int value, const std::map<std::string, int>::value_type &p) {
-               return value + p.second;
-             });
+  // Look-up only: an unmeasured bit string is not added as a zero count.
+  if ((bitStr.size() + 63) / 64 > packedWords) {
+    return 0.0;
+  }
+  std::vector<std::uint64_t> row;
+  const bool isRegular = packMeasurement(bitStr, row);
+  const auto i = findPackedRow(row, bitStr, isRegular,
+                               hashPackedRow(row.data(), bitStr.size()));
+  if (i == std::string::npos) {
+    return 0.0;
+  }
+  return (double)packedCounts[i] /
+         std::accumulate(packedCounts.begin(), packedCounts.end(), 0LL);
 }
 
 std::shared_ptr<AcceleratorBuffer> AcceleratorBuffer::clone() {
@@ -411,33 +778,284 @@ std::shared_ptr<AcceleratorBuffer> AcceleratorBuffer::clone() {
  */
 const double AcceleratorBuffer::getExpectationValueZ() {
   double aver = 0.0;
-  auto has_even_parity = [](unsigned int x) -> int {
-    unsigned int count = 0, i, b = 1;
-    for (i = 0; i < 32; i++) {
-      if (x & (b << i)) {
-        count++;
+  if (packedCounts.empty() && this->hasExtraInfoKey("exp-val-z")) {
+    aver = mpark::get<double>(getInformation("exp-val-z"));
+  } else {
+    // The parity of the whole bit string is the
+    // parity of the sum of the popcounts of its words.
+    long long signedCounts = 0, totalCounts = 0;
+    for (std::size_t i = 0; i < packedCounts.size(); i++) {
+      const auto *word = &packedBitStrings[i * packedWords];
+      int parity = 0;
+      for (std::size_t w = 0; w < packedWords; w++) {
+        parity ^= __builtin_popcountll(word[w]) & 1;
       }
+      signedCounts += parity ? -packedCounts[i] : packedCounts[i];
+      totalCounts += packedCounts[i];
     }
-    if ((count % 2)) {
-      return 0;
+    if (totalCounts > 0) {
+      aver = (double)signedCounts / totalCounts;
     }
-    return 1;
+  }
+  return aver;
+}
+
+std::vector<std::uint64_t>
+AcceleratorBuffer::packZMasks(const std::vector<std::vector<int>> &zMasks,
+                              bool lsbOrder, const std::size_t length) const {
+  // In LSB order the masks depend on the bit string length.
+  std::vector<std::uint64_t> masks(zMasks.size() * packedWords, 0);
+  for (std::size_t m = 0; m < zMasks.size(); m++) {
+    for (auto bit : zMasks[m]) {
+      if (bit < 0 || bit >= length) {
+        xacc::error("Invalid Z mask bit index " + std::to_string(bit) +
+                    " for bit strings of length " + std::to_string(length) +
+                    ".");
+      }
+      const std::size_t k = lsbOrder ? length - bit - 1 : bit;
+      masks[m * packedWords + k / 64] |= (1ULL << (k % 64));
+    }
+  }
+  return masks;
+}
+
+std::vector<double> AcceleratorBuffer::getExpectationValueZ(
+    const std::vector<std::vector<int>> &zMasks, BitOrder bitOrder) {
+  std::map<std::size_t, std::vector<std::uint64_t>> packedMasks;
+  const auto getPackedMasks = [&](const std::size_t length) -> const auto & {
+    auto iter = packedMasks.find(length);
+    if (iter == packedMasks.end()) {
+      iter = packedMasks
+                 .emplace(length, packZMasks(zMasks, bitOrder == BitOrder::LSB,
+                                             length))
+                 .first;
+    }
+    return iter->second;
   };
 
-  if (bitStringToCounts.empty() && this->hasExtraInfoKey("exp-val-z")) {
-    aver = mpark::get<double>(getInformation("exp-val-z"));
+  std::vector<long long> signedCounts(zMasks.size(), 0);
+  long long totalCounts = 0;
+  for (std::size_t i = 0; i < packedCounts.size(); i++) {
+    const auto *word = &packedBitStrings[i * packedWords];
+    const auto &masks = getPackedMasks(packedLengths[i]);
+    const auto count = packedCounts[i];
+    for (std::size_t m = 0; m < zMasks.size(); m++) {
+      const auto *mask = &masks[m * packedWords];
+      int parity = 0;
+      for (std::size_t w = 0; w < packedWords; w++) {
+        parity ^= __builtin_popcountll(word[w] & mask[w]) & 1;
+      }
+      signedCounts[m] += parity ? -count : count;
+    }
+    totalCounts += count;
+  }
+
+  std::vector<double> expVals(zMasks.size(), 0.0);
+  if (totalCounts > 0) {
+    for (std::size_t m = 0; m < zMasks.size(); m++) {
+      expVals[m] = (double)signedCounts[m] / totalCounts;
+    }
+  }
+  return expVals;
+}
+
+std::vector<AcceleratorBuffer::ZStatistics> AcceleratorBuffer::getZStatistics(
+    const std::vector<std::shared_ptr<AcceleratorBuffer>> &buffers,
+    const std::vector<std::vector<std::vector<int>>> &zMasks,
+    const std::vector<std::vector<double>> &coefficients, BitOrder bitOrder) {
+  if (zMasks.size() != buffers.size() ||
+      (!coefficients.empty() && coefficients.size() != buffers.size())) {
+    xacc::error("getZStatistics: expected Z masks (and coefficients) for " +
+                std::to_string(buffers.size()) + " buffers.");
+  }
+
+  std::vector<ZStatistics> stats(buffers.size());
+  // Only reads the buffers
+  const auto reduce = [&](std::size_t b) {
+    auto &buffer = *buffers[b];
+    auto &result = stats[b];
+    const bool fullParity = zMasks[b].empty();
+    const auto nMasks = fullParity ? 1 : zMasks[b].size();
+    std::vector<double> coeffs(nMasks, 1.0);
+    if (!coefficients.empty() && !coefficients[b].empty()) {
+      if (coefficients[b].size() != nMasks) {
+        xacc::error("getZStatistics: " + std::to_string(nMasks) +
+                    " Z masks but " + std::to_string(coefficients[b].size()) +
+                    " coefficients for buffer " + buffer.name() + ".");
+      }
+      coeffs = coefficients[b];
+    }
+    result.expVals.assign(nMasks, 0.0);
+    if (buffer.packedCounts.empty()) {
+      if (fullParity && buffer.hasExtraInfoKey("exp-val-z")) {
+        result.expVals[0] =
+            mpark::get<double>(buffer.getInformation("exp-val-z"));
+        result.mean = coeffs[0] * result.expVals[0];
+      }
+      return;
+    }
+
+    std::map<std::size_t, std::vector<std::uint64_t>> packedMasks;
+    std::vector<long long> signedCounts(nMasks, 0);
+    double sum = 0.0, squares = 0.0;
+    const auto words = buffer.packedWords;
+    for (std::size_t i = 0; i < buffer.packedCounts.size(); i++) {
+      const auto *word = &buffer.packedBitStrings[i * words];
+      const std::uint64_t *mask = nullptr;
+      if (!fullParity) {
+        auto iter = packedMasks.find(buffer.packedLengths[i]);
+        if (iter == packedMasks.end()) {
+          iter = packedMasks
+                     .emplace(buffer.packedLengths[i],
+                              buffer.packZMasks(zMasks[b],
+                                                bitOrder == BitOrder::LSB,
+                                                buffer.packedLengths[i]))
+                     .first;
+        }
+        mask = iter->second.data();
+      }
+      const auto count = buffer.packedCounts[i];
+      double value = 0.0;
+      for (std::size_t m = 0; m < nMasks; m++) {
+        int parity = 0;
+        for (std::size_t w = 0; w < words; w++) {
+          parity ^= __builtin_popcountll(mask ? word[w] & mask[m * words + w]
+                                              : word[w]) &
+                    1;
+        }
+        signedCounts[m] += parity ? -count : count;
+        value += parity ? -coeffs[m] : coeffs[m];
+      }
+      sum += value * count;
+      squares += value * value * count;
+      result.shots += count;
+    }
+
+    if (result.shots > 0) {
+      for (std::size_t m = 0; m < nMasks; m++) {
+        result.expVals[m] = (double)signedCounts[m] / result.shots;
+      }
+      result.mean = sum / result.shots;
+      result.variance = squares / result.shots - result.mean * result.mean;
+    }
+  };
+
+  if (buffers.size() > 1 && xacc::isInitialized()) {
+    xacc::getTaskScheduler()->parallelFor(
+        0, buffers.size(), [&](std::size_t beginIdx, std::size_t endIdx) {
+          for (auto b = beginIdx; b < endIdx; ++b) {
+            reduce(b);
+          }
+        });
   } else {
-    for (auto &kv : bitStringToCounts) {
-      int i = std::stoi(kv.first, nullptr, 2);
-      auto par = has_even_parity(i);
-      auto p = computeMeasurementProbability(kv.first);
-      if (!par) {
-        p = -p;
+    for (std::size_t b = 0; b < buffers.size(); ++b) {
+      reduce(b);
+    }
+  }
+  return stats;
+}
+
+std::vector<std::pair<double, int>> AcceleratorBuffer::getDiagonalValues(
+    const std::vector<std::vector<int>> &zMasks,
+    const std::vector<double> &coefficients, BitOrder bitOrder) {
+  if (zMasks.size() != coefficients.size()) {
+    xacc::error("getDiagonalValues: " + std::to_string(zMasks.size()) +
+                " Z masks but " + std::to_string(coefficients.size()) +
+                " coefficients.");
+  }
+  std::map<std::size_t, std::vector<std::uint64_t>> packedMasks;
+  std::vector<std::pair<double, int>> values;
+  values.reserve(packedCounts.size());
+  for (std::size_t i = 0; i < packedCounts.size(); i++) {
+    auto iter = packedMasks.find(packedLengths[i]);
+    if (iter == packedMasks.end()) {
+      iter = packedMasks
+                 .emplace(packedLengths[i],
+                          packZMasks(zMasks, bitOrder == BitOrder::LSB,
+                                     packedLengths[i]))
+                 .first;
+    }
+    const auto *word = &packedBitStrings[i * packedWords];
+    const auto *mask = iter->second.data();
+    double value = 0.0;
+    for (std::size_t m = 0; m < zMasks.size(); m++, mask += packedWords) {
+      int parity = 0;
+      for (std::size_t w = 0; w < packedWords; w++) {
+        parity ^= __builtin_popcountll(word[w] & mask[w]) & 1;
       }
-      aver += p;
+      value += parity ? -coefficients[m] : coefficients[m];
     }
+    values.emplace_back(value, packedCounts[i]);
   }
-  return aver;
+  return values;
+}
+
+long long
+AcceleratorBuffer::postSelect(const std::vector<std::vector<int>> &zMasks,
+                              const std::vector<int> &parities,
+                              BitOrder bitOrder) {
+  if (zMasks.size() != parities.size()) {
+    xacc::error("postSelect: " + std::to_string(zMasks.size()) +
+                " Z masks but " + std::to_string(parities.size()) +
+                " parities.");
+  }
+  std::map<std::size_t, std::vector<std::uint64_t>> packedMasks;
+  // Compact the kept rows in place
+  std::size_t nKept = 0;
+  long long keptCounts = 0;
+  std::map<std::size_t, std::string> keptIrregular;
+  for (std::size_t i = 0; i < packedCounts.size(); i++) {
+    auto iter = packedMasks.find(packedLengths[i]);
+    if (iter == packedMasks.end()) {
+      iter = packedMasks
+                 .emplace(packedLengths[i],
+                          packZMasks(zMasks, bitOrder == BitOrder::LSB,
+                                     packedLengths[i]))
+                 .first;
+    }
+    const auto *word = &packedBitStrings[i * packedWords];
+    const auto *mask = iter->second.data();
+    bool keep = true;
+    for (std::size_t m = 0; keep && m < zMasks.size();
+         m++, mask += packedWords) {
+      int parity = 0;
+      for (std::size_t w = 0; w < packedWords; w++) {
+        parity ^= __builtin_popcountll(word[w] & mask[w]) & 1;
+      }
+      keep = parity == (parities[m] & 1);
+    }
+    if (!keep) {
+      continue;
+    }
+    if (nKept != i) {
+      std::copy(packedBitStrings.begin() + i * packedWords,
+                packedBitStrings.begin() + (i + 1) * packedWords,
+                packedBitStrings.begin() + nKept * packedWords);
+      packedCounts[nKept] = packedCounts[i];
+      packedLengths[nKept] = packedLengths[i];
+    }
+    auto irregular = irregularBitStrings.find(i);
+    if (irregular != irregularBitStrings.end()) {
+      keptIrregular.emplace(nKept, irregular->second);
+    }
+    keptCounts += packedCounts[nKept];
+    nKept++;
+  }
+
+  if (nKept != packedCounts.size()) {
+    packedBitStrings.resize(nKept * packedWords);
+    packedCounts.resize(nKept);
+    packedLengths.resize(nKept);
+    irregularBitStrings = std::move(keptIrregular);
+    packedIndex.clear();
+    for (std::size_t i = 0; i < nKept; i++) {
+      packedIndex.emplace(
+          hashPackedRow(&packedBitStrings[i * packedWords], packedLengths[i]),
+          i);
+    }
+    countsAreMaterialized = false;
+  }
+  return keptCounts;
 }
 
 void AcceleratorBuffer::setExpectationValueZ(const double exp) {
@@ -452,14 +1070,16 @@ void AcceleratorBuffer::setExpectationValueZ(const double exp) {
  * @return bitStrings List of bit strings.
  */
 const std::vector<std::string> AcceleratorBuffer::getMeasurements() {
+  materializeMeasurementCounts();
   std::vector<std::string> strs;
-  for (auto m : bitStringToCounts) {
+  for (auto &m : bitStringToCounts) {
     strs.push_back(m.first);
   }
   return strs;
 }
 
 std::map<std::string, int> AcceleratorBuffer::getMeasurementCounts() {
+  materializeMeasurementCounts();
   return bitStringToCounts;
 }
 
@@ -467,27 +1087,61 @@ std::map<std::string, int>
 AcceleratorBuffer::getMarginalCounts(const std::vector<int> &measIdxs,
                                      BitOrder bitOrder) {
   std::map<std::string, int> result;
-
-  const auto bitMask = [&](const std::string &bitString) {
-    std::string marginalBitString;
-    for (const auto &bit : measIdxs) {
-      if (bitOrder == BitOrder::MSB) {
-        marginalBitString.push_back(bitString[bitString.size() - bit - 1]);
-      } else {
-        marginalBitString.push_back(bitString[bit]);
+  if (!irregularBitStrings.empty()) {
+    materializeMeasurementCounts();
+    const auto bitMask = [&](const std::string &bitString) {
+      std::string marginalBitString;
+      for (const auto &bit : measIdxs) {
+        if (bitOrder == BitOrder::MSB) {
+          marginalBitString.push_back(bitString[bitString.size() - bit - 1]);
+        } else {
+          marginalBitString.push_back(bitString[bit]);
+        }
       }
+      return marginalBitString;
+    };
+    for (const auto &[bitString, count] : bitStringToCounts) {
+      result[bitMask(bitString)] += count;
     }
-    return marginalBitString;
-  };
-  for (const auto &[bitString, count] : bitStringToCounts) {
-    auto marginalBitStr = bitMask(bitString);
-    if (result.find(marginalBitStr) != result.end()) {
-      result[marginalBitStr] += count;
-    } else {
-      result[marginalBitStr] = count;
+    return result;
+  }
+
+  // Marginals are accumulated packed, one string per distinct marginal.
+  // Character j of the marginal is bit measIdxs[j], i.e. packed bit
+  // measIdxs.size() - j - 1 of the marginal row.
+  const auto nBits = measIdxs.size();
+  const auto nWords = std::max<std::size_t>((nBits + 63) / 64, 1);
+  std::map<std::vector<std::uint64_t>, long long> marginals;
+  std::vector<std::uint64_t> marginal(nWords);
+  for (std::size_t i = 0; i < packedCounts.size(); i++) {
+    const auto *row = &packedBitStrings[i * packedWords];
+    const auto length = packedLengths[i];
+    std::fill(marginal.begin(), marginal.end(), 0);
+    for (std::size_t j = 0; j < nBits; j++) {
+      const int bit = measIdxs[j];
+      if (bit < 0 || bit >= length) {
+        xacc::error("Invalid marginal bit index " + std::to_string(bit) +
+                    " for bit strings of length " + std::to_string(length) +
+                    ".");
+      }
+      const std::size_t k = bitOrder == BitOrder::MSB ? bit : length - bit - 1;
+      if ((row[k / 64] >> (k % 64)) & 1ULL) {
+        const auto target = nBits - j - 1;
+        marginal[target / 64] |= (1ULL << (target % 64));
+      }
     }
+    marginals[marginal] += packedCounts[i];
   }
 
+  for (const auto &[row, count] : marginals) {
+    std::string bitStr(nBits, '0');
+    for (std::size_t k = 0; k < nBits; k++) {
+      if ((row[k / 64] >> (k % 64)) & 1ULL) {
+        bitStr[nBits - k - 1] = '1';
+      }
+    }
+    result.emplace(std::move(bitStr), count);
+  }
   return result;
 }
 /**
@@ -529,6 +1183,7 @@ void AcceleratorBuffer::print(std::ostream &stream) {
   if (!cacheFile) {
     writer.Key("Measurements");
     writer.StartObject();
+    materializeMeasurementCounts();
     for (auto &kv : bitStringToCounts) {
       writer.Key(kv.first);
       writer.Int(kv.second);
@@ -585,6 +1240,11 @@ const std::string AcceleratorBuffer::toString() {
 }
 
 void AcceleratorBuffer::load(std::istream &stream) {
+  if (stream.peek() == binaryMagic[0]) {
+    loadBinary(stream);
+    return;
+  }
+
   std::string json(std::istreambuf_iterator<char>(stream), {});
   Document doc;
   doc.Parse(json);
@@ -755,4 +1415,118 @@ void AcceleratorBuffer::load(std::istream &stream) {
   }
 }
 
+void AcceleratorBuffer::writeBinaryRecord(std::ostream &stream) {
+  writeBinary<std::uint64_t>(stream, info.size());
+  for (auto &kv : info) {
+    writeBinary(stream, kv.first);
+    writeBinaryExtraInfo(stream, kv.second);
+  }
+
+  // The packed measurements are written as is
+  writeBinary<std::uint64_t>(stream, packedCounts.size());
+  writeBinary<std::uint64_t>(stream, packedWords);
+  for (std::size_t i = 0; i < packedCounts.size(); i++) {
+    writeBinary<std::uint64_t>(stream, packedLengths[i]);
+    writeBinary<std::int32_t>(stream, packedCounts[i]);
+  }
+  stream.write(reinterpret_cast<const char *>(packedBitStrings.data()),
+               packedBitStrings.size() * sizeof(std::uint64_t));
+  writeBinary<std::uint64_t>(stream, irregularBitStrings.size());
+  for (auto &kv : irregularBitStrings) {
+    writeBinary<std::uint64_t>(stream, kv.first);
+    writeBinary(stream, kv.second);
+  }
+}
+
+void AcceleratorBuffer::readBinaryRecord(std::istream &stream) {
+  const auto nInfo = readBinary<std::uint64_t>(stream);
+  for (std::uint64_t i = 0; i < nInfo; i++) {
+    auto key = readBinary<std::string>(stream);
+    addExtraInfo(key, readBinaryExtraInfo(stream));
+  }
+
+  clearMeasurements();
+  const auto nRows = readBinary<std::uint64_t>(stream);
+  const auto nWords = readBinary<std::uint64_t>(stream);
+  if (nWords == 0) {
+    xacc::error("Invalid AcceleratorBuffer binary stream, zero row width.");
+  }
+  packedLengths.resize(nRows);
+  packedCounts.resize(nRows);
+  for (std::uint64_t i = 0; i < nRows; i++) {
+    packedLengths[i] = readBinary<std::uint64_t>(stream);
+    packedCounts[i] = readBinary<std::int32_t>(stream);
+  }
+  packedBitStrings.resize(nRows * nWords);
+  if (!stream.read(reinterpret_cast<char *>(packedBitStrings.data()),
+                   packedBitStrings.size() * sizeof(std::uint64_t))) {
+    xacc::error("Invalid AcceleratorBuffer binary stream, unexpected end.");
+  }
+  const auto nIrregular = readBinary<std::uint64_t>(stream);
+  for (std::uint64_t i = 0; i < nIrregular; i++) {
+    auto row = readBinary<std::uint64_t>(stream);
+    irregularBitStrings.emplace(row, readBinary<std::string>(stream));
+  }
+  // Rebuilds the row index
+  widenPackedMeasurements(nWords);
+  countsAreMaterialized = nRows == 0;
+}
+
+void AcceleratorBuffer::printBinary(std::ostream &stream) {
+  stream.write(binaryMagic, sizeof(binaryMagic));
+  writeBinary(stream, binaryVersion);
+
+  writeBinary(stream, binaryRootRecord);
+  writeBinary(stream, name());
+  writeBinary<std::int32_t>(stream, size());
+  writeBinaryRecord(stream);
+
+  for (auto &pair : children) {
+    appendBinaryChild(stream, pair.first, pair.second);
+  }
+}
+
+void AcceleratorBuffer::appendBinaryChild(
+    std::ostream &stream, const std::string &name,
+    std::shared_ptr<AcceleratorBuffer> child) {
+  writeBinary(stream, binaryChildRecord);
+  writeBinary(stream, name);
+  child->writeBinaryRecord(stream);
+}
+
+void AcceleratorBuffer::loadBinary(std::istream &stream) {
+  char magic[sizeof(binaryMagic)];
+  if (!stream.read(magic, sizeof(magic)) ||
+      !std::equal(magic, magic + sizeof(magic), binaryMagic)) {
+    xacc::error("Invalid AcceleratorBuffer binary stream, bad header.");
+  }
+  const auto version = readBinary<std::uint32_t>(stream);
+  if (version > binaryVersion) {
+    xacc::error("AcceleratorBuffer binary format version " +
+                std::to_string(version) + " is not supported (expected <= " +
+                std::to_string(binaryVersion) + ").");
+  }
+
+  resetBuffer();
+  if (readBinary<char>(stream) != binaryRootRecord) {
+    xacc::error("Invalid AcceleratorBuffer binary stream, missing buffer "
+                "record.");
+  }
+  bufferId = readBinary<std::string>(stream);
+  nBits = readBinary<std::int32_t>(stream);
+  readBinaryRecord(stream);
+
+  // Children are read one record at a time
+  while (stream.peek() != std::char_traits<char>::eof()) {
+    if (readBinary<char>(stream) != binaryChildRecord) {
+      xacc::error("Invalid AcceleratorBuffer binary stream, bad child "
+                  "record.");
+    }
+    auto childName = readBinary<std::string>(stream);
+    auto childBuffer = std::make_shared<AcceleratorBuffer>(childName, nBits);
+    childBuffer->readBinaryRecord(stream);
+    appendChild(childName, childBuffer);
+  }
+}
+
 } // namespace xacc
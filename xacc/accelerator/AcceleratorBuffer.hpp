@@ -15,6 +15,7 @@
 
 #include <string>
 #include <set>
+#include <unordered_map>
 #include <sstream>
 #include <iostream>
 #include "Utils.hpp"
@@ -122,6 +123,15 @@ protected:
   std::string bufferId;
   int nBits;
   std::vector<AcceleratorBufferChildPair> children;
+  // Positions in children of each child name, in append order.
+  std::unordered_map<std::string, std::vector<std::size_t>> childNameIndex;
+  // Optional indices of the children by ExtraInfo key (see indexChildrenBy):
+  // key -> hash of the child's value -> positions in children.
+  std::map<std::string,
+           std::unordered_map<std::size_t, std::vector<std::size_t>>>
+      childInfoIndices;
+  void indexChild(const std::size_t idx);
+  void reindexChildren();
   std::map<std::string, ExtraInfo> info;
   bool cacheFile = false;
   std::map<int, int> bit2IndexMap;
@@ -129,6 +139,44 @@ protected:
   std::map<std::size_t, bool> single_measurements;
   std::map<std::pair<std::string, std::size_t>, std::size_t> cReg_to_single_measurements;
 
+  // Measurement counts are stored packed, one row per distinct bit string.
+  // Each row occupies packedWords 64-bit words of packedBitStrings, where
+  // bit k holds the k-th character from the right of the bit string, i.e.
+  // bit index k in MSB order. bitStringToCounts is only materialized
+  // when the string-keyed counts are requested.
+  std::vector<std::uint64_t> packedBitStrings;
+  std::vector<int> packedCounts;
+  std::vector<std::size_t> packedLengths;
+  std::size_t packedWords = 1;
+  // Rows whose bit string contains characters other than 0 and 1
+  // keep the original string, keyed by row index.
+  std::map<std::size_t, std::string> irregularBitStrings;
+  // Hash of a packed row to row indices
+  std::unordered_multimap<std::uint64_t, std::size_t> packedIndex;
+  bool countsAreMaterialized = true;
+
+  std::size_t findOrAddMeasurement(const std::string &measurement);
+  // Packs a bit string in the row layout, false if it is irregular
+  bool packMeasurement(const std::string &measurement,
+                       std::vector<std::uint64_t> &row) const;
+  // Row of a packed bit string (npos if not measured)
+  std::size_t findPackedRow(const std::vector<std::uint64_t> &row,
+                            const std::string &measurement, bool isRegular,
+                            std::uint64_t hash) const;
+  std::uint64_t hashPackedRow(const std::uint64_t *row,
+                              const std::size_t length) const;
+  void widenPackedMeasurements(const std::size_t nWords);
+  // Z masks packed in the layout of the bit strings of the given length
+  std::vector<std::uint64_t>
+  packZMasks(const std::vector<std::vector<int>> &zMasks, bool lsbOrder,
+             const std::size_t length) const;
+  void materializeMeasurementCounts();
+
+  // Write / read the extra info and measurements of this
+  // buffer as a record of the binary serialization format.
+  void writeBinaryRecord(std::ostream &stream);
+  void readBinaryRecord(std::istream &stream);
+
 public:
   enum BitOrder {LSB, MSB};
 
@@ -161,18 +209,25 @@ public:
     bit2IndexMap = bitMap;
   }
 
-  const int nChildren() { return getChildren().size(); }
+  const int nChildren() { return children.size(); }
 
   // Return all children with ExtraInfo infoName equal
   // to the given ExtraInfo i.
   std::vector<std::shared_ptr<AcceleratorBuffer>>
   getChildren(const std::string infoName, ExtraInfo i);
 
+  // Index the children by their ExtraInfo infoName, so that
+  // getChildren(infoName, i) looks them up by value (exact match) rather
+  // than scanning all of them. The indexed values are the ones at
+  // appendChild (or at this call) time, call it again after changing them.
+  void indexChildrenBy(const std::string infoName);
+
   // FIXME GET ALL UNIQUE ExtraInfo values at given ExtraInfo key...
   std::vector<ExtraInfo> getAllUnique(const std::string name);
 
   void removeChild(const std::size_t idx) {
     children.erase(children.begin() + idx);
+    reindexChildren();
   }
 
   void setSize(const int s) {nBits = s;}
@@ -187,8 +242,50 @@ public:
   virtual double computeMeasurementProbability(const std::string &bitStr);
 
   virtual const double getExpectationValueZ();
+  // Compute the expectation values of many Z-strings in a single pass
+  // over the measurement counts. Each mask lists the bit indices
+  // (interpreted in the given bit order, as for getMarginalCounts)
+  // that the Z-string acts on.
+  virtual std::vector<double>
+  getExpectationValueZ(const std::vector<std::vector<int>> &zMasks,
+                       BitOrder bitOrder = BitOrder::MSB);
+  // Value of the diagonal observable sum_m coefficients[m] * Z(zMasks[m])
+  // (masks as for getExpectationValueZ) on each distinct measured bit string,
+  // with its count, e.g. for CVaR-like objectives over the samples.
+  virtual std::vector<std::pair<double, int>>
+  getDiagonalValues(const std::vector<std::vector<int>> &zMasks,
+                    const std::vector<double> &coefficients,
+                    BitOrder bitOrder = BitOrder::MSB);
+  // Keeps only the measurements whose Z-string parities (masks as for
+  // getExpectationValueZ) are the given ones (0: +1 eigenvalue, 1: -1),
+  // e.g. to post-select on symmetries. Returns the number of kept shots.
+  virtual long long postSelect(const std::vector<std::vector<int>> &zMasks,
+                               const std::vector<int> &parities,
+                               BitOrder bitOrder = BitOrder::MSB);
   virtual void setExpectationValueZ(const double exp);
 
+  // Z-string statistics of a buffer, see getZStatistics.
+  struct ZStatistics {
+    // <Z(mask)> of each mask
+    std::vector<double> expVals;
+    // Mean and (per-shot) sample variance of sum_m coefficients[m] Z(mask m)
+    double mean = 0.0;
+    double variance = 0.0;
+    long long shots = 0;
+  };
+  // Z-string statistics of many buffers at once, e.g. all the children of
+  // an observable evaluation: each buffer is reduced in a single pass over
+  // its packed counts, the buffers in parallel. zMasks[i] (masks as for
+  // getExpectationValueZ) and coefficients[i] (empty: all 1) apply to
+  // buffers[i]; an empty zMasks[i] is the parity of the whole bit string,
+  // i.e. getExpectationValueZ(), which also covers buffers holding an
+  // exp-val-z but no counts (with no shots nor variance).
+  static std::vector<ZStatistics>
+  getZStatistics(const std::vector<std::shared_ptr<AcceleratorBuffer>> &buffers,
+                 const std::vector<std::vector<std::vector<int>>> &zMasks,
+                 const std::vector<std::vector<double>> &coefficients = {},
+                 BitOrder bitOrder = BitOrder::MSB);
+
   virtual const std::vector<std::string> getMeasurements();
   virtual std::map<std::string, int> getMeasurementCounts();
   // Get the marginal counts bitstring for a list of bit indices.
@@ -196,13 +293,27 @@ public:
   getMarginalCounts(const std::vector<int> &measIdxs,
                     BitOrder bitOrder = BitOrder::MSB);
 
-  virtual void clearMeasurements() {
-    // measurements.clear();
-    bitStringToCounts.clear();
+  virtual void clearMeasurements();
+  virtual void setMeasurements(std::map<std::string, int> counts);
+
+  // Read-only access to the packed measurement counts (no string
+  // conversion), e.g. for zero-copy NumPy views: row i is the words
+  // [i * getPackedWords(), (i + 1) * getPackedWords()) of
+  // getPackedBitStrings() (bit k is the k-th character from the right),
+  // its bit string length and count are getPackedLengths()[i] and
+  // getPackedCounts()[i]. Invalidated by any change of the measurements.
+  // Rows with characters other than 0 and 1 (hasIrregularMeasurements())
+  // are only exact in getMeasurementCounts().
+  const std::vector<std::uint64_t> &getPackedBitStrings() const {
+    return packedBitStrings;
+  }
+  const std::vector<int> &getPackedCounts() const { return packedCounts; }
+  const std::vector<std::size_t> &getPackedLengths() const {
+    return packedLengths;
   }
-  virtual void setMeasurements(std::map<std::string, int> counts) {
-    clearMeasurements();
-    bitStringToCounts = counts;
+  std::size_t getPackedWords() const { return packedWords; }
+  bool hasIrregularMeasurements() const {
+    return !irregularBitStrings.empty();
   }
 
   virtual void print();
@@ -259,8 +370,20 @@ public:
   void setName(const std::string n) { bufferId = n; }
 
   virtual void print(std::ostream &stream);
+  // Load from the output of print or printBinary; the
+  // format is detected from the start of the stream.
   virtual void load(std::istream &stream);
 
+  // Compact binary alternative to print(stream). The stream holds a
+  // versioned header, a record for this buffer, then one record per child.
+  // Records are length-prefixed and written in host byte order.
+  virtual void printBinary(std::ostream &stream);
+  virtual void loadBinary(std::istream &stream);
+  // Append a single child record to a stream written by printBinary,
+  // without needing the parent buffer in memory.
+  static void appendBinaryChild(std::ostream &stream, const std::string &name,
+                                std::shared_ptr<AcceleratorBuffer> child);
+
   bool operator[](const std::size_t &i);
   bool getCregValue(const std::string &cregName, const std::size_t &i);
 
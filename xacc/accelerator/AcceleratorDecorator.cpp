@@ -0,0 +1,59 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#include "AcceleratorDecorator.hpp"
+#include "xacc.hpp"
+
+namespace xacc {
+bool AcceleratorDecorator::executePipeline(
+    std::shared_ptr<AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<CompositeInstruction>> &circuits) {
+  std::vector<DecoratorStage> stages(1);
+  if (!decoratedAccelerator || !planStage(buffer, circuits, stages[0])) {
+    return false;
+  }
+
+  auto base = decoratedAccelerator;
+  while (auto decorator =
+             std::dynamic_pointer_cast<AcceleratorDecorator>(base)) {
+    DecoratorStage stage;
+    if (!decorator->getDecorated() ||
+        !decorator->planStage(buffer, stages.back().circuits, stage)) {
+      break;
+    }
+    stages.emplace_back(std::move(stage));
+    base = decorator->getDecorated();
+  }
+
+  auto tmpBuffer = std::make_shared<AcceleratorBuffer>(buffer->size());
+  base->execute(tmpBuffer, stages.back().circuits);
+  for (auto &[key, value] : tmpBuffer->getInformation()) {
+    buffer->addExtraInfo(key, value);
+  }
+
+  auto results = tmpBuffer->getChildren();
+  for (auto stage = stages.rbegin(); stage != stages.rend(); ++stage) {
+    if (results.size() != stage->circuits.size()) {
+      xacc::error("Decorator pipeline - " + base->name() + " returned " +
+                  std::to_string(results.size()) + " results for " +
+                  std::to_string(stage->circuits.size()) + " circuits.");
+    }
+    if (stage->transform) {
+      results = stage->transform(results);
+    }
+  }
+  for (auto &result : results) {
+    buffer->appendChild(result->name(), result);
+  }
+  return true;
+}
+} // namespace xacc
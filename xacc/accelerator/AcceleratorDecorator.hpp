@@ -15,8 +15,21 @@
 
 #include "Accelerator.hpp"
 
+#include <functional>
+
 namespace xacc {
 
+// A decorator's share of a fused execution of a decorator stack: the
+// circuits to execute in place of the given ones (pre-execution rewrite)
+// and the map of their results, in the order of circuits, to the results
+// of the given circuits (post-execution transform, identity if empty).
+struct DecoratorStage {
+  std::vector<std::shared_ptr<CompositeInstruction>> circuits;
+  std::function<std::vector<std::shared_ptr<AcceleratorBuffer>>(
+      const std::vector<std::shared_ptr<AcceleratorBuffer>> &)>
+      transform;
+};
+
 // The AcceleratorDecorator implements the familiar decorator
 // pattern for Accelerators. This enables delegation to a
 // concrete Accelerator, with the opportunity to introduce general
@@ -41,6 +54,11 @@ public:
     decoratedAccelerator->updateConfiguration(config);
   }
 
+  void
+  contributeInstructions(const std::string &custom_json_config = "") override {
+    decoratedAccelerator->contributeInstructions(custom_json_config);
+  }
+
   std::vector<std::pair<int, int>> getConnectivity() override {
     return decoratedAccelerator->getConnectivity();
   }
@@ -60,9 +78,48 @@ public:
                const std::vector<std::shared_ptr<CompositeInstruction>>
                    CompositeInstructions) override = 0;
 
+  // The metrics are those of the executions of the decorated Accelerator
+  HeterogeneousMap getExecutionInfo() const override {
+    return decoratedAccelerator->getExecutionInfo();
+  }
+  void exportState(const std::string &path) override {
+    decoratedAccelerator->exportState(path);
+  }
+  void setExecutionMetricsCallback(ExecutionMetricsCallback callback) override {
+    decoratedAccelerator->setExecutionMetricsCallback(std::move(callback));
+  }
+  ExecutionMetrics getLastExecutionMetrics() const override {
+    return decoratedAccelerator->getLastExecutionMetrics();
+  }
+
   bool isRemote() override { return decoratedAccelerator->isRemote(); }
+  BitOrder getBitOrder() override {
+    return decoratedAccelerator->getBitOrder();
+  }
+
+  // Decorators that can be fused with the decorators they wrap plan their
+  // execution of a list of circuits as a DecoratorStage instead of
+  // executing the decorated accelerator. Returns false if it cannot (the
+  // default), e.g. for adaptive executions.
+  virtual bool planStage(
+      std::shared_ptr<AcceleratorBuffer> buffer,
+      const std::vector<std::shared_ptr<CompositeInstruction>> &circuits,
+      DecoratorStage &stage) {
+    return false;
+  }
 
   virtual ~AcceleratorDecorator() {}
+
+protected:
+  // Executes the circuits through this decorator and the chain of fusable
+  // decorators it wraps: the rewrites are applied top-down, the first
+  // accelerator that cannot be fused executes the union of the circuits
+  // once, and the transforms are applied bottom-up, each in one pass over
+  // the results. The results are appended to buffer. Returns false, without
+  // executing anything, if this decorator cannot plan the execution.
+  bool executePipeline(
+      std::shared_ptr<AcceleratorBuffer> buffer,
+      const std::vector<std::shared_ptr<CompositeInstruction>> &circuits);
 };
 
 } // namespace xacc
@@ -0,0 +1,56 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_ACCELERATOR_DISTRIBUTEDEXECUTION_HPP_
+#define XACC_ACCELERATOR_DISTRIBUTEDEXECUTION_HPP_
+
+#include "Accelerator.hpp"
+#include <utility>
+#include <vector>
+
+namespace xacc {
+
+// Implemented by the Accelerators distributing the circuits over MPI ranks
+// (hpc-virtualization), so that the algorithms can partition their classical
+// work as well, e.g. the commutators of an operator pool: each virtual QPU
+// builds and measures its slice, then the results are reduced. This keeps
+// MPI out of the algorithm plugins. The calls are collective: all the ranks
+// must make them, in the same order.
+class DistributedExecution {
+public:
+  // The number of virtual QPUs, and the one of this rank
+  virtual int nbVirtualQpus() = 0;
+  virtual int virtualQpuIndex() = 0;
+  // The Accelerator of the virtual QPU of this rank, not distributing
+  virtual std::shared_ptr<Accelerator> localAccelerator() = 0;
+
+  // The reductions over the virtual QPUs, all the ranks of a virtual QPU
+  // holding the same values.
+  // Element-wise sum, in place
+  virtual void allReduceSum(std::vector<double> &io_values) = 0;
+  // Maximum of in_value and the index given with it (MPI_MAXLOC: the
+  // smallest index on ties)
+  virtual std::pair<double, int> allReduceMaxLoc(double in_value,
+                                                 int in_index) = 0;
+
+  // [begin, end) of the slice of in_nbItems items of this rank
+  std::pair<size_t, size_t> localRange(size_t in_nbItems) {
+    const size_t nbQpus = nbVirtualQpus();
+    const size_t qpu = virtualQpuIndex();
+    return {in_nbItems * qpu / nbQpus, in_nbItems * (qpu + 1) / nbQpus};
+  }
+
+  virtual ~DistributedExecution() = default;
+};
+
+} // namespace xacc
+#endif
@@ -0,0 +1,240 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "StateVectorFile.hpp"
+#include "xacc.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+// .npy format 1.0: magic, version, little-endian uint16 header length, then
+// the header (a Python dict literal) padded with spaces and ended by '\n' so
+// that the data is 64-byte aligned.
+const char NPY_MAGIC[] = "\x93NUMPY";
+constexpr size_t NPY_MAGIC_SIZE = 6;
+constexpr size_t NPY_ALIGNMENT = 64;
+
+std::string npyHeader(uint64_t in_size) {
+  std::string dict = "{'descr': '<c16', 'fortran_order': False, 'shape': (" +
+                     std::to_string(in_size) + ",), }";
+  const size_t prefix = NPY_MAGIC_SIZE + 2 + 2;
+  const size_t total =
+      (prefix + dict.size() + 1 + NPY_ALIGNMENT - 1) / NPY_ALIGNMENT *
+      NPY_ALIGNMENT;
+  dict.append(total - prefix - dict.size() - 1, ' ');
+  dict.push_back('\n');
+  std::string header(NPY_MAGIC, NPY_MAGIC_SIZE);
+  header.push_back('\x01');
+  header.push_back('\x00');
+  header.push_back(static_cast<char>(dict.size() & 0xff));
+  header.push_back(static_cast<char>(dict.size() >> 8));
+  return header + dict;
+}
+
+// The value of in_key in the header dict, up to the next ',' (or ')' for a
+// tuple)
+std::string npyField(const std::string &in_dict, const std::string &in_key) {
+  const auto pos = in_dict.find("'" + in_key + "'");
+  if (pos == std::string::npos) {
+    return "";
+  }
+  auto begin = in_dict.find(':', pos);
+  if (begin == std::string::npos) {
+    return "";
+  }
+  begin = in_dict.find_first_not_of(' ', begin + 1);
+  const auto end = in_dict.find(in_dict[begin] == '(' ? ')' : ',', begin);
+  if (begin == std::string::npos || end == std::string::npos) {
+    return "";
+  }
+  return in_dict.substr(begin, end - begin + 1);
+}
+
+void *mapFile(int in_fd, uint64_t in_bytes, bool in_writable) {
+  return mmap(nullptr, in_bytes,
+              in_writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED,
+              in_fd, 0);
+}
+} // namespace
+
+namespace xacc {
+StateVectorWriter::StateVectorWriter(const std::string &in_path,
+                                     size_t in_nbQubits)
+    : m_path(in_path), m_size(1ULL << in_nbQubits) {
+  if (in_nbQubits >= 60) {
+    xacc::error("Too many qubits (" + std::to_string(in_nbQubits) +
+                ") for a state vector file.");
+  }
+  const auto header = npyHeader(m_size);
+  m_fd = open(in_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (m_fd < 0) {
+    xacc::error("Failed to create the state vector file " + in_path + ": " +
+                std::strerror(errno));
+  }
+  m_mappedBytes = header.size() + sizeof(Amplitude) * m_size;
+  void *mapped = MAP_FAILED;
+  if (ftruncate(m_fd, m_mappedBytes) == 0) {
+    mapped = mapFile(m_fd, m_mappedBytes, true);
+  }
+  if (mapped == MAP_FAILED) {
+    const std::string reason = std::strerror(errno);
+    ::close(m_fd);
+    m_fd = -1;
+    xacc::error("Failed to map the state vector file " + in_path + " (" +
+                std::to_string(m_mappedBytes) + " bytes): " + reason);
+  }
+  m_mapped = static_cast<char *>(mapped);
+  std::memcpy(m_mapped, header.data(), header.size());
+  m_data = reinterpret_cast<Amplitude *>(m_mapped + header.size());
+}
+
+StateVectorWriter::~StateVectorWriter() { close(); }
+
+void StateVectorWriter::checkRange(uint64_t in_offset,
+                                   uint64_t in_count) const {
+  if (!m_data) {
+    xacc::error("The state vector file " + m_path + " is closed.");
+  }
+  if (in_offset > m_size || in_count > m_size - in_offset) {
+    xacc::error("Amplitudes [" + std::to_string(in_offset) + ", " +
+                std::to_string(in_offset + in_count) +
+                ") out of the state vector of " + std::to_string(m_size) +
+                " amplitudes.");
+  }
+}
+
+void StateVectorWriter::write(uint64_t in_offset, const Amplitude *in_data,
+                              uint64_t in_count) {
+  checkRange(in_offset, in_count);
+  std::copy(in_data, in_data + in_count, m_data + in_offset);
+}
+
+void StateVectorWriter::write(uint64_t in_offset,
+                              const std::complex<float> *in_data,
+                              uint64_t in_count) {
+  checkRange(in_offset, in_count);
+  std::transform(in_data, in_data + in_count, m_data + in_offset,
+                 [](const std::complex<float> &amplitude) {
+                   return Amplitude(amplitude.real(), amplitude.imag());
+                 });
+}
+
+void StateVectorWriter::close() {
+  if (m_mapped) {
+    msync(m_mapped, m_mappedBytes, MS_SYNC);
+    munmap(m_mapped, m_mappedBytes);
+    m_mapped = nullptr;
+    m_data = nullptr;
+  }
+  if (m_fd >= 0) {
+    ::close(m_fd);
+    m_fd = -1;
+  }
+}
+
+StateVectorReader::StateVectorReader(const std::string &in_path)
+    : m_path(in_path) {
+  m_fd = open(in_path.c_str(), O_RDONLY);
+  struct stat status;
+  if (m_fd < 0 || fstat(m_fd, &status) != 0) {
+    xacc::error("Failed to open the state vector file " + in_path + ": " +
+                std::strerror(errno));
+  }
+  m_mappedBytes = status.st_size;
+  void *mapped =
+      m_mappedBytes > 0 ? mapFile(m_fd, m_mappedBytes, false) : MAP_FAILED;
+  if (mapped == MAP_FAILED) {
+    const std::string reason = std::strerror(errno);
+    ::close(m_fd);
+    m_fd = -1;
+    xacc::error("Failed to map the state vector file " + in_path + ": " +
+                reason);
+  }
+  m_mapped = static_cast<char *>(mapped);
+
+  const auto invalid = [&](const std::string &in_reason) {
+    xacc::error("Invalid state vector file " + in_path + ": " + in_reason);
+  };
+  if (m_mappedBytes < NPY_MAGIC_SIZE + 4 ||
+      std::memcmp(m_mapped, NPY_MAGIC, NPY_MAGIC_SIZE) != 0) {
+    invalid("not a .npy file.");
+  }
+  // 1.0: uint16 header length, 2.0 and 3.0: uint32
+  const auto *bytes = reinterpret_cast<const unsigned char *>(m_mapped);
+  const int version = bytes[NPY_MAGIC_SIZE];
+  if (version < 1 || version > 3) {
+    invalid(".npy version " + std::to_string(version) + " not supported.");
+  }
+  const size_t lengthBytes = version == 1 ? 2 : 4;
+  uint64_t headerLength = 0;
+  for (size_t i = 0; i < lengthBytes; ++i) {
+    headerLength |= uint64_t{bytes[NPY_MAGIC_SIZE + 2 + i]} << (8 * i);
+  }
+  const uint64_t dataOffset = NPY_MAGIC_SIZE + 2 + lengthBytes + headerLength;
+  if (dataOffset > m_mappedBytes) {
+    invalid("truncated header.");
+  }
+  const std::string dict(m_mapped + NPY_MAGIC_SIZE + 2 + lengthBytes,
+                         headerLength);
+  if (npyField(dict, "descr") != "'<c16',") {
+    invalid("the amplitudes must be complex128 ('<c16').");
+  }
+  if (npyField(dict, "fortran_order") != "False,") {
+    invalid("Fortran order is not supported.");
+  }
+  const auto shape = npyField(dict, "shape");
+  uint64_t size = 0;
+  try {
+    size_t parsed = 0;
+    size = std::stoull(shape.substr(1), &parsed);
+    if (shape.substr(1 + parsed) != ",)") {
+      size = 0;
+    }
+  } catch (...) {
+    size = 0;
+  }
+  if (size == 0 || (size & (size - 1)) != 0) {
+    invalid("the shape must be (2^n,), not " + shape + ".");
+  }
+  while ((1ULL << m_nbQubits) < size) {
+    ++m_nbQubits;
+  }
+  if (m_mappedBytes - dataOffset < sizeof(Amplitude) * size) {
+    invalid("truncated data.");
+  }
+  m_data = reinterpret_cast<const Amplitude *>(m_mapped + dataOffset);
+}
+
+StateVectorReader::~StateVectorReader() {
+  if (m_mapped) {
+    munmap(m_mapped, m_mappedBytes);
+  }
+  if (m_fd >= 0) {
+    ::close(m_fd);
+  }
+}
+
+void StateVectorReader::read(uint64_t in_offset, uint64_t in_count,
+                             Amplitude *out_data) const {
+  if (in_offset > size() || in_count > size() - in_offset) {
+    xacc::error("Amplitudes [" + std::to_string(in_offset) + ", " +
+                std::to_string(in_offset + in_count) + ") out of " + m_path +
+                ".");
+  }
+  std::copy(m_data + in_offset, m_data + in_offset + in_count, out_data);
+}
+} // namespace xacc
@@ -0,0 +1,82 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_ACCELERATOR_STATEVECTORFILE_HPP_
+#define XACC_ACCELERATOR_STATEVECTORFILE_HPP_
+
+#include <complex>
+#include <cstdint>
+#include <string>
+
+namespace xacc {
+
+// State vectors in NumPy .npy files: 1-D complex128 ('<c16') arrays of 2^n
+// amplitudes, bit q of the index being qubit q (numpy.load() reads them).
+// The files are memory-mapped: the amplitudes are written and read in chunks,
+// the state is never copied as a whole.
+class StateVectorWriter {
+public:
+  using Amplitude = std::complex<double>;
+  // A new file (truncated if it exists) for in_nbQubits qubits
+  StateVectorWriter(const std::string &in_path, size_t in_nbQubits);
+  ~StateVectorWriter();
+  StateVectorWriter(const StateVectorWriter &) = delete;
+  StateVectorWriter &operator=(const StateVectorWriter &) = delete;
+
+  // in_count amplitudes, from the amplitude in_offset
+  void write(uint64_t in_offset, const Amplitude *in_data, uint64_t in_count);
+  // Single precision amplitudes (e.g. qsim), converted
+  void write(uint64_t in_offset, const std::complex<float> *in_data,
+             uint64_t in_count);
+  // The mapped amplitudes, to be filled in place
+  Amplitude *data() { return m_data; }
+  uint64_t size() const { return m_size; }
+  // Unmaps and closes the file (done by the destructor)
+  void close();
+
+private:
+  void checkRange(uint64_t in_offset, uint64_t in_count) const;
+
+  std::string m_path;
+  uint64_t m_size;
+  int m_fd = -1;
+  char *m_mapped = nullptr;
+  uint64_t m_mappedBytes = 0;
+  Amplitude *m_data = nullptr;
+};
+
+class StateVectorReader {
+public:
+  using Amplitude = std::complex<double>;
+  explicit StateVectorReader(const std::string &in_path);
+  ~StateVectorReader();
+  StateVectorReader(const StateVectorReader &) = delete;
+  StateVectorReader &operator=(const StateVectorReader &) = delete;
+
+  size_t nbQubits() const { return m_nbQubits; }
+  uint64_t size() const { return 1ULL << m_nbQubits; }
+  // in_count amplitudes from the amplitude in_offset
+  void read(uint64_t in_offset, uint64_t in_count, Amplitude *out_data) const;
+  // The mapped amplitudes, paged in as they are read
+  const Amplitude *data() const { return m_data; }
+
+private:
+  std::string m_path;
+  size_t m_nbQubits = 0;
+  int m_fd = -1;
+  char *m_mapped = nullptr;
+  uint64_t m_mappedBytes = 0;
+  const Amplitude *m_data = nullptr;
+};
+
+} // namespace xacc
+#endif
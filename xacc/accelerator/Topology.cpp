@@ -0,0 +1,248 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "Topology.hpp"
+#include "Accelerator.hpp"
+#include "StructuralHasher.hpp"
+#include "xacc.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+
+namespace {
+// Bound on the number of cached topologies (cleared when reached).
+constexpr size_t MAX_CACHED_TOPOLOGIES = 64;
+
+struct CacheEntry {
+  xacc::Topology::Edges edges;
+  xacc::Topology::Fidelities fidelities;
+  std::shared_ptr<const xacc::Topology> topology;
+};
+
+std::mutex &cacheMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::unordered_multimap<uint64_t, CacheEntry> &cache() {
+  static std::unordered_multimap<uint64_t, CacheEntry> entries;
+  return entries;
+}
+
+// Requires the cache mutex to be held.
+std::shared_ptr<const xacc::Topology>
+findCached(uint64_t in_key, const xacc::Topology::Edges &in_edges,
+           const xacc::Topology::Fidelities &in_fidelities) {
+  const auto range = cache().equal_range(in_key);
+  for (auto iter = range.first; iter != range.second; ++iter) {
+    if (iter->second.edges == in_edges &&
+        iter->second.fidelities == in_fidelities) {
+      return iter->second.topology;
+    }
+  }
+  return nullptr;
+}
+} // namespace
+
+namespace xacc {
+constexpr size_t Topology::UNREACHABLE;
+constexpr double Topology::DEFAULT_FIDELITY;
+
+Topology::Topology(const Edges &in_edges, const Fidelities &in_fidelities) {
+  for (const auto &[q1, q2] : in_edges) {
+    if (q1 < 0 || q2 < 0) {
+      xacc::error("Invalid coupling (" + std::to_string(q1) + ", " +
+                  std::to_string(q2) + ").");
+    }
+    if (q1 != q2) {
+      m_edges.emplace_back(std::min(q1, q2), std::max(q1, q2));
+    }
+  }
+  std::sort(m_edges.begin(), m_edges.end());
+  m_edges.erase(std::unique(m_edges.begin(), m_edges.end()), m_edges.end());
+  if (m_edges.empty()) {
+    return;
+  }
+
+  // Couplings may be given in both directions, keep the best fidelity.
+  std::map<std::pair<size_t, size_t>, double> fidelities;
+  for (const auto &[q1, q2, fidelity] : in_fidelities) {
+    auto &edgeFidelity =
+        fidelities
+            .emplace(std::make_pair(std::min(q1, q2), std::max(q1, q2)), 0.0)
+            .first->second;
+    edgeFidelity = std::max(edgeFidelity, fidelity);
+  }
+
+  size_t nbQubits = 0;
+  for (const auto &[q1, q2] : m_edges) {
+    nbQubits = std::max<size_t>(nbQubits, q2 + 1);
+  }
+  m_neighbors.resize(nbQubits);
+  std::vector<std::vector<double>> weights(nbQubits);
+  for (const auto &[q1, q2] : m_edges) {
+    m_neighbors[q1].emplace_back(q2);
+    m_neighbors[q2].emplace_back(q1);
+  }
+  m_fidelities.assign(nbQubits * nbQubits, 0.0);
+  for (size_t qubit = 0; qubit < nbQubits; ++qubit) {
+    auto &neighbors = m_neighbors[qubit];
+    std::sort(neighbors.begin(), neighbors.end());
+    if (!neighbors.empty()) {
+      m_qubits.emplace_back(qubit);
+    }
+    for (const auto neighbor : neighbors) {
+      const auto iter = fidelities.find(
+          std::make_pair(std::min(qubit, neighbor), std::max(qubit, neighbor)));
+      const double fidelity =
+          iter == fidelities.end() ? DEFAULT_FIDELITY : iter->second;
+      m_fidelities[index(qubit, neighbor)] = fidelity;
+      // Same cap as staq's device model for (near) zero fidelities
+      weights[qubit].emplace_back(-std::log(std::max(fidelity, 1e-10)));
+    }
+  }
+
+  const auto nbEntries = nbQubits * nbQubits;
+  m_distances.assign(nbEntries, UNREACHABLE);
+  m_nextHops.assign(nbEntries, UNREACHABLE);
+  m_weightedDistances.assign(nbEntries,
+                             std::numeric_limits<double>::infinity());
+  m_nextWeightedHops.assign(nbEntries, UNREACHABLE);
+  // Searches are rooted at the destination, so that the parent of a qubit in
+  // the search tree is its next hop.
+  for (const auto target : m_qubits) {
+    m_distances[index(target, target)] = 0;
+    m_nextHops[index(target, target)] = target;
+    std::queue<size_t> queue;
+    queue.push(target);
+    while (!queue.empty()) {
+      const auto qubit = queue.front();
+      queue.pop();
+      for (const auto neighbor : m_neighbors[qubit]) {
+        if (m_distances[index(neighbor, target)] == UNREACHABLE) {
+          m_distances[index(neighbor, target)] =
+              m_distances[index(qubit, target)] + 1;
+          m_nextHops[index(neighbor, target)] = qubit;
+          queue.push(neighbor);
+        }
+      }
+    }
+
+    // Dijkstra
+    using QueueEntry = std::pair<double, size_t>;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>,
+                        std::greater<QueueEntry>>
+        priorityQueue;
+    m_weightedDistances[index(target, target)] = 0.0;
+    m_nextWeightedHops[index(target, target)] = target;
+    priorityQueue.emplace(0.0, target);
+    while (!priorityQueue.empty()) {
+      const auto [weightedDistance, qubit] = priorityQueue.top();
+      priorityQueue.pop();
+      if (weightedDistance > m_weightedDistances[index(qubit, target)]) {
+        continue;
+      }
+      const auto &neighbors = m_neighbors[qubit];
+      for (size_t i = 0; i < neighbors.size(); ++i) {
+        const auto neighbor = neighbors[i];
+        const double newDistance = weightedDistance + weights[qubit][i];
+        if (newDistance < m_weightedDistances[index(neighbor, target)]) {
+          m_weightedDistances[index(neighbor, target)] = newDistance;
+          m_nextWeightedHops[index(neighbor, target)] = qubit;
+          priorityQueue.emplace(newDistance, neighbor);
+        }
+      }
+    }
+  }
+
+  for (const auto q1 : m_qubits) {
+    for (const auto q2 : m_qubits) {
+      if (m_distances[index(q1, q2)] == UNREACHABLE) {
+        m_isConnected = false;
+      }
+    }
+  }
+}
+
+std::vector<size_t> Topology::shortestPath(size_t in_q1, size_t in_q2) const {
+  if (distance(in_q1, in_q2) == UNREACHABLE) {
+    return {};
+  }
+  std::vector<size_t> path{in_q1};
+  while (path.back() != in_q2) {
+    path.emplace_back(nextHop(path.back(), in_q2));
+  }
+  return path;
+}
+
+std::vector<size_t> Topology::highestFidelityPath(size_t in_q1,
+                                                  size_t in_q2) const {
+  if (nextWeightedHop(in_q1, in_q2) == UNREACHABLE) {
+    return {};
+  }
+  std::vector<size_t> path{in_q1};
+  while (path.back() != in_q2) {
+    path.emplace_back(nextWeightedHop(path.back(), in_q2));
+  }
+  return path;
+}
+
+std::shared_ptr<const Topology> Topology::get(const Edges &in_edges,
+                                              const Fidelities &in_fidelities) {
+  StructuralHasher hasher;
+  hasher.add<uint64_t>(in_edges.size());
+  for (const auto &[q1, q2] : in_edges) {
+    hasher.add<int>(q1);
+    hasher.add<int>(q2);
+  }
+  hasher.add<uint64_t>(in_fidelities.size());
+  for (const auto &[q1, q2, fidelity] : in_fidelities) {
+    hasher.add<uint64_t>(q1);
+    hasher.add<uint64_t>(q2);
+    hasher.add<double>(fidelity);
+  }
+  const auto key = hasher.value();
+  {
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    if (auto cached = findCached(key, in_edges, in_fidelities)) {
+      return cached;
+    }
+  }
+  auto topology = std::make_shared<const Topology>(in_edges, in_fidelities);
+  std::lock_guard<std::mutex> lock(cacheMutex());
+  // Another thread may have computed it in the meantime.
+  if (auto cached = findCached(key, in_edges, in_fidelities)) {
+    return cached;
+  }
+  if (cache().size() >= MAX_CACHED_TOPOLOGIES) {
+    cache().clear();
+  }
+  cache().emplace(key, CacheEntry{in_edges, in_fidelities, topology});
+  return topology;
+}
+
+std::shared_ptr<const Topology> Topology::get(Accelerator &in_accelerator) {
+  const auto connectivity = in_accelerator.getConnectivity();
+  if (connectivity.empty()) {
+    return nullptr;
+  }
+  return get(connectivity);
+}
+
+void Topology::clearCache() {
+  std::lock_guard<std::mutex> lock(cacheMutex());
+  cache().clear();
+}
+} // namespace xacc
@@ -0,0 +1,105 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_ACCELERATOR_TOPOLOGY_HPP_
+#define XACC_ACCELERATOR_TOPOLOGY_HPP_
+
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace xacc {
+class Accelerator;
+
+// Undirected coupling graph of a device with precomputed all-pairs shortest
+// paths: hop distances and next-hop tables, and the same for error-weighted
+// distances (each coupling costs -log(fidelity)).
+// Topologies are immutable, get() returns the one shared by all the callers
+// with the same connectivity (and fidelities), computed once.
+class Topology {
+public:
+  using Edges = std::vector<std::pair<int, int>>;
+  // (qubit, qubit, two-qubit gate fidelity)
+  using Fidelities = std::vector<std::tuple<size_t, size_t, double>>;
+  static constexpr size_t UNREACHABLE = std::numeric_limits<size_t>::max();
+  // Fidelity of the couplings that have none specified
+  static constexpr double DEFAULT_FIDELITY = 0.99;
+
+  Topology(const Edges &in_edges, const Fidelities &in_fidelities = {});
+
+  // Cached topologies
+  static std::shared_ptr<const Topology>
+  get(const Edges &in_edges, const Fidelities &in_fidelities = {});
+  // nullptr if the accelerator has no connectivity (fully-connected).
+  static std::shared_ptr<const Topology> get(Accelerator &in_accelerator);
+  static void clearCache();
+
+  // Number of qubits, i.e. the largest qubit index + 1
+  size_t size() const { return m_neighbors.size(); }
+  // Qubits that have at least one coupling (sorted)
+  const std::vector<size_t> &qubits() const { return m_qubits; }
+  const std::vector<size_t> &neighbors(size_t in_qubit) const {
+    return m_neighbors[in_qubit];
+  }
+  const Edges &edges() const { return m_edges; }
+  bool coupled(size_t in_q1, size_t in_q2) const {
+    return m_distances[index(in_q1, in_q2)] == 1;
+  }
+  // Fidelity of a coupling (0.0 if the qubits are not coupled)
+  double fidelity(size_t in_q1, size_t in_q2) const {
+    return m_fidelities[index(in_q1, in_q2)];
+  }
+  // Whether all the qubits() are reachable from each other
+  bool isConnected() const { return m_isConnected; }
+
+  // Number of couplings on a shortest path, UNREACHABLE if none
+  size_t distance(size_t in_q1, size_t in_q2) const {
+    return m_distances[index(in_q1, in_q2)];
+  }
+  // The qubit after in_q1 on a shortest path to in_q2 (in_q2 if adjacent,
+  // in_q1 if equal), UNREACHABLE if none
+  size_t nextHop(size_t in_q1, size_t in_q2) const {
+    return m_nextHops[index(in_q1, in_q2)];
+  }
+  // Qubits of a shortest path (both ends included), empty if none
+  std::vector<size_t> shortestPath(size_t in_q1, size_t in_q2) const;
+
+  // Same for the highest fidelity paths: the distance is the sum of the
+  // -log(fidelity) of the couplings.
+  double weightedDistance(size_t in_q1, size_t in_q2) const {
+    return m_weightedDistances[index(in_q1, in_q2)];
+  }
+  size_t nextWeightedHop(size_t in_q1, size_t in_q2) const {
+    return m_nextWeightedHops[index(in_q1, in_q2)];
+  }
+  std::vector<size_t> highestFidelityPath(size_t in_q1, size_t in_q2) const;
+
+private:
+  size_t index(size_t in_q1, size_t in_q2) const {
+    return in_q1 * size() + in_q2;
+  }
+
+  Edges m_edges;
+  std::vector<size_t> m_qubits;
+  std::vector<std::vector<size_t>> m_neighbors;
+  bool m_isConnected = true;
+  // Row-major (size() x size()) tables
+  std::vector<double> m_fidelities;
+  std::vector<size_t> m_distances;
+  std::vector<size_t> m_nextHops;
+  std::vector<double> m_weightedDistances;
+  std::vector<size_t> m_nextWeightedHops;
+};
+} // namespace xacc
+#endif
@@ -13,30 +13,242 @@
 #include "RemoteAccelerator.hpp"
 #include "xacc.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <cpr/cpr.h>
 
 namespace xacc {
 
-const std::string Client::post(const std::string &remoteUrl,
-                               const std::string &path,
-                               const std::string &postStr,
-                               std::map<std::string, std::string> headers) {
+RemoteJobPoller &RemoteJobPoller::instance() {
+  static RemoteJobPoller poller;
+  return poller;
+}
+
+void RemoteJobPoller::configure(const HeterogeneousMap &options) {
+  std::lock_guard<std::mutex> guard(lock);
+  if (options.keyExists<int>("poll-initial-delay-ms")) {
+    initialDelay = std::chrono::milliseconds(
+        std::max(1, options.get<int>("poll-initial-delay-ms")));
+  }
+  if (options.keyExists<int>("poll-max-delay-ms")) {
+    maxDelay = std::chrono::milliseconds(
+        std::max(1, options.get<int>("poll-max-delay-ms")));
+  }
+  if (options.keyExists<double>("poll-backoff")) {
+    backoff = std::max(1.0, options.get<double>("poll-backoff"));
+  }
+  if (options.keyExists<double>("poll-jitter")) {
+    jitter = std::min(1.0, std::max(0.0, options.get<double>("poll-jitter")));
+  }
+  if (options.keyExists<double>("max-polls-per-second")) {
+    maxPollsPerSecond = options.get<double>("max-polls-per-second");
+  }
+}
+
+std::future<void> RemoteJobPoller::watch(StatusCheck check) {
+  auto job = std::make_shared<Job>();
+  job->check = std::move(check);
+  auto future = job->completed.get_future();
+  std::lock_guard<std::mutex> guard(lock);
+  job->delay = initialDelay;
+  jobs.emplace(Clock::now() + initialDelay, job);
+  if (!worker.joinable()) {
+    worker = std::thread([this]() { run(); });
+  }
+  wakeUp.notify_one();
+  return future;
+}
+
+void RemoteJobPoller::run() {
+  std::unique_lock<std::mutex> guard(lock);
+  while (!stopping) {
+    if (jobs.empty()) {
+      wakeUp.wait(guard);
+      continue;
+    }
+    auto due = jobs.begin()->first;
+    if (maxPollsPerSecond > 0.0) {
+      due = std::max(due, lastPoll + std::chrono::duration_cast<
+                                         Clock::duration>(
+                                         std::chrono::duration<double>(
+                                             1.0 / maxPollsPerSecond)));
+    }
+    if (Clock::now() < due) {
+      wakeUp.wait_until(guard, due);
+      continue;
+    }
+    auto job = jobs.begin()->second;
+    jobs.erase(jobs.begin());
+    lastPoll = Clock::now();
+
+    guard.unlock();
+    bool done = false;
+    try {
+      done = job->check();
+    } catch (...) {
+      job->completed.set_exception(std::current_exception());
+      guard.lock();
+      continue;
+    }
+    guard.lock();
+
+    if (done) {
+      job->completed.set_value();
+      continue;
+    }
+    job->delay = std::min(
+        maxDelay, std::chrono::milliseconds(static_cast<int64_t>(
+                      job->delay.count() * backoff)));
+    std::uniform_real_distribution<double> spread(1.0 - jitter, 1.0 + jitter);
+    const auto delay = std::chrono::milliseconds(
+        static_cast<int64_t>(job->delay.count() * spread(rng)));
+    jobs.emplace(Clock::now() + delay, job);
+  }
+
+  for (auto &kv : jobs) {
+    kv.second->completed.set_exception(std::make_exception_ptr(
+        std::runtime_error("Remote job poller stopped.")));
+  }
+  jobs.clear();
+}
+
+RemoteJobPoller::~RemoteJobPoller() {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stopping = true;
+  }
+  wakeUp.notify_one();
+  if (worker.joinable()) {
+    worker.join();
+  }
+}
+
+void runConcurrently(std::size_t nbTasks, std::size_t maxConcurrency,
+                     const std::function<void(std::size_t)> &task) {
+  std::atomic<std::size_t> next(0);
+  std::mutex errorLock;
+  std::exception_ptr error;
+  const auto work = [&]() {
+    for (auto i = next++; i < nbTasks; i = next++) {
+      try {
+        task(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> guard(errorLock);
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  const auto nbThreads =
+      std::min(nbTasks, std::max<std::size_t>(maxConcurrency, 1));
+  for (std::size_t i = 1; i < nbThreads; ++i) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+namespace {
+// Idle sessions kept per host and method
+constexpr std::size_t MAX_IDLE_SESSIONS = 8;
+
+// Keep-alive sessions by request method and host. A cpr::Session keeps its
+// curl handle, hence the open connection and TLS session, from one request
+// to the next. Sessions aren't thread-safe: each request checks one out (or
+// makes a new one) and returns it when done.
+class SessionPool {
+public:
+  static SessionPool &instance() {
+    static SessionPool pool;
+    return pool;
+  }
+
+  std::unique_ptr<cpr::Session> acquire(const std::string &key) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto &sessions = idle[key];
+    if (sessions.empty()) {
+      return std::make_unique<cpr::Session>();
+    }
+    auto session = std::move(sessions.back());
+    sessions.pop_back();
+    return session;
+  }
+
+  void release(const std::string &key, std::unique_ptr<cpr::Session> session) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto &sessions = idle[key];
+    if (sessions.size() < MAX_IDLE_SESSIONS) {
+      sessions.emplace_back(std::move(session));
+    }
+  }
+
+private:
+  std::mutex lock;
+  std::map<std::string, std::vector<std::unique_ptr<cpr::Session>>> idle;
+};
 
+void addDefaultHeaders(std::map<std::string, std::string> &headers) {
   if (headers.empty()) {
     headers.insert(std::make_pair("Content-type", "application/json"));
     headers.insert(std::make_pair("Connection", "keep-alive"));
     headers.insert(std::make_pair("Accept", "*/*"));
   }
+}
+
+// Sends the request on a pooled session of the url's host.
+cpr::Response sendRequest(const std::string &method, const std::string &url,
+                          const std::map<std::string, std::string> &headers,
+                          const std::string &body,
+                          const std::map<std::string, std::string> &params) {
+  // scheme://host[:port]
+  const auto hostBegin = url.find("://");
+  const auto hostEnd =
+      url.find('/', hostBegin == std::string::npos ? 0 : hostBegin + 3);
+  const auto key = method + " " + url.substr(0, hostEnd);
 
   cpr::Header cprHeaders;
   for (auto &kv : headers) {
     cprHeaders.insert({kv.first, kv.second});
   }
+  cpr::Parameters cprParams;
+  for (auto &kv : params) {
+    cprParams.AddParameter({kv.first, kv.second});
+  }
 
-  auto r = cpr::Post(cpr::Url{remoteUrl + path}, cpr::Body(postStr), cprHeaders,
-                     cpr::VerifySsl(false));
+  auto session = SessionPool::instance().acquire(key);
+  // Every option of the previous request is overwritten
+  session->SetUrl(cpr::Url{url});
+  session->SetHeader(cprHeaders);
+  session->SetParameters(std::move(cprParams));
+  session->SetBody(cpr::Body(body));
+  session->SetVerifySsl(cpr::VerifySsl(false));
+  auto r = method == "GET"      ? session->Get()
+           : method == "POST"   ? session->Post()
+           : method == "DELETE" ? session->Delete()
+                                : session->Put();
+  // Only keep the sessions whose connection is still good
+  if (r.error.code == cpr::ErrorCode::OK) {
+    SessionPool::instance().release(key, std::move(session));
+  }
+  return r;
+}
+} // namespace
 
-  if (r.status_code != 200)
+const std::string Client::post(const std::string &remoteUrl,
+                               const std::string &path,
+                               const std::string &postStr,
+                               std::map<std::string, std::string> headers) {
+  addDefaultHeaders(headers);
+  auto r = sendRequest("POST", remoteUrl + path, headers, postStr, {});
+
+  if (r.status_code / 100 != 2)
     throw std::runtime_error("HTTP POST Error - status code " +
                              std::to_string(r.status_code) + ": " +
                              r.error.message + ": " + r.text);
@@ -44,30 +256,25 @@ const std::string Client::post(const std::string &remoteUrl,
   return r.text;
 }
 
+void Client::put(const std::string &remoteUrl, const std::string &putStr,
+                 std::map<std::string, std::string> headers) {
+  addDefaultHeaders(headers);
+  auto r = sendRequest("PUT", remoteUrl, headers, putStr, {});
+
+  if (r.status_code / 100 != 2)
+    throw std::runtime_error("HTTP PUT Error - status code " +
+                             std::to_string(r.status_code) + ": " +
+                             r.error.message + ": " + r.text);
+}
+
 const std::string Client::get(const std::string &remoteUrl,
                               const std::string &path,
                               std::map<std::string, std::string> headers,
                               std::map<std::string, std::string> extraParams) {
-  if (headers.empty()) {
-    headers.insert(std::make_pair("Content-type", "application/json"));
-    headers.insert(std::make_pair("Connection", "keep-alive"));
-    headers.insert(std::make_pair("Accept", "*/*"));
-  }
-
-  cpr::Header cprHeaders;
-  for (auto &kv : headers) {
-    cprHeaders.insert({kv.first, kv.second});
-  }
+  addDefaultHeaders(headers);
+  auto r = sendRequest("GET", remoteUrl + path, headers, "", extraParams);
 
-  cpr::Parameters cprParams;
-  for (auto &kv : extraParams) {
-    cprParams.AddParameter({kv.first, kv.second});
-  }
-
-  auto r = cpr::Get(cpr::Url{remoteUrl + path}, cprHeaders, cprParams,
-                    cpr::VerifySsl(false));
-
-  if (r.status_code != 200)
+  if (r.status_code / 100 != 2)
     throw std::runtime_error("HTTP GET Error - status code " +
                              std::to_string(r.status_code) + ": " +
                              r.error.message + ": " + r.text);
@@ -75,6 +282,17 @@ const std::string Client::get(const std::string &remoteUrl,
   return r.text;
 }
 
+void Client::del(const std::string &remoteUrl, const std::string &path,
+                 std::map<std::string, std::string> headers) {
+  addDefaultHeaders(headers);
+  auto r = sendRequest("DELETE", remoteUrl + path, headers, "", {});
+
+  if (r.status_code / 100 != 2)
+    throw std::runtime_error("HTTP DELETE Error - status code " +
+                             std::to_string(r.status_code) + ": " +
+                             r.error.message + ": " + r.text);
+}
+
 void RemoteAccelerator::execute(
     std::shared_ptr<AcceleratorBuffer> buffer,
     const std::shared_ptr<CompositeInstruction> circuit) {
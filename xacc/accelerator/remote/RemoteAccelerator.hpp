@@ -15,8 +15,20 @@
 
 #include "Accelerator.hpp"
 
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+
 namespace xacc {
 
+// HTTP client of the remote accelerators. Requests to the same host reuse
+// pooled keep-alive sessions (shared by all the clients) rather than
+// opening a new connection each time.
 class Client {
 
 public:
@@ -26,15 +38,80 @@ public:
                                  std::map<std::string, std::string> headers =
                                      std::map<std::string, std::string>{});
 
+  virtual void put(const std::string &remoteUrl, const std::string &putStr,
+                   std::map<std::string, std::string> headers =
+                       std::map<std::string, std::string>{});
+
   virtual const std::string
   get(const std::string &remoteUrl, const std::string &path,
       std::map<std::string, std::string> headers =
           std::map<std::string, std::string>{},
       std::map<std::string, std::string> extraParams = {});
 
+  virtual void del(const std::string &remoteUrl, const std::string &path,
+                   std::map<std::string, std::string> headers =
+                       std::map<std::string, std::string>{});
+
   virtual ~Client() {}
 };
 
+// Process-wide poller of remote job statuses. A single thread checks all
+// the outstanding jobs, each one with an exponential backoff (and jitter, so
+// that many workers don't poll in lock-step), and the checks of all jobs are
+// rate limited together.
+class RemoteJobPoller {
+public:
+  // Checks the job status once: returns true if the job has completed,
+  // throws if it has failed.
+  using StatusCheck = std::function<bool()>;
+
+  static RemoteJobPoller &instance();
+
+  // Polling settings (for the jobs watched afterwards):
+  // "poll-initial-delay-ms" (100), "poll-max-delay-ms" (10000), "poll-backoff"
+  // (2.0), "poll-jitter" (0.2, fraction of the delay) and
+  // "max-polls-per-second" (20, across all the jobs).
+  void configure(const HeterogeneousMap &options);
+
+  // The future is ready once check returns true (or has the exception it
+  // threw). Checks run on the poller thread, don't wait from a check.
+  std::future<void> watch(StatusCheck check);
+  void wait(StatusCheck check) { watch(std::move(check)).get(); }
+
+  ~RemoteJobPoller();
+
+private:
+  using Clock = std::chrono::steady_clock;
+  struct Job {
+    StatusCheck check;
+    std::chrono::milliseconds delay;
+    std::promise<void> completed;
+  };
+  RemoteJobPoller() {}
+  void run();
+
+  std::mutex lock;
+  std::condition_variable wakeUp;
+  // Jobs by next poll time
+  std::multimap<Clock::time_point, std::shared_ptr<Job>> jobs;
+  std::thread worker;
+  bool stopping = false;
+  Clock::time_point lastPoll;
+  std::mt19937 rng{std::random_device{}()};
+
+  std::chrono::milliseconds initialDelay{100};
+  std::chrono::milliseconds maxDelay{10000};
+  double backoff = 2.0;
+  double jitter = 0.2;
+  double maxPollsPerSecond = 20.0;
+};
+
+// Runs task(0), ..., task(nbTasks - 1) on up to maxConcurrency threads (the
+// calling one included), e.g. to have several blocking requests in flight.
+// Rethrows the first exception of a task once all of them are done.
+void runConcurrently(std::size_t nbTasks, std::size_t maxConcurrency,
+                     const std::function<void(std::size_t)> &task);
+
 class RemoteAccelerator : public Accelerator {
 
 public:
@@ -55,6 +55,232 @@ TEST(AcceleratorBufferTester, checkGetExpectationValueZ) {
   EXPECT_TRUE(std::fabs(b.getExpectationValueZ() - 0.178955078125) < 1e-6);
 }
 
+TEST(AcceleratorBufferTester, checkBatchedExpectationValueZ) {
+  AcceleratorBuffer b("qreg", 7);
+  b.appendMeasurement("0000000", 3513);
+  b.appendMeasurement("0000001", 904);
+  b.appendMeasurement("0000010", 2459);
+  b.appendMeasurement("0000011", 1316);
+
+  // MSB: bit 0 is the right-most character
+  auto expVals = b.getExpectationValueZ({{}, {0}, {1}, {0, 1}, {0, 1, 6}});
+  EXPECT_EQ(5, expVals.size());
+  EXPECT_NEAR(1.0, expVals[0], 1e-12);
+  EXPECT_NEAR((3513. - 904. + 2459. - 1316.) / 8192., expVals[1], 1e-12);
+  EXPECT_NEAR((3513. + 904. - 2459. - 1316.) / 8192., expVals[2], 1e-12);
+  EXPECT_NEAR(b.getExpectationValueZ(), expVals[3], 1e-12);
+  EXPECT_NEAR(expVals[3], expVals[4], 1e-12);
+
+  // LSB: bit 0 is the left-most character
+  auto lsbExpVals =
+      b.getExpectationValueZ({{6}, {5}}, AcceleratorBuffer::BitOrder::LSB);
+  EXPECT_NEAR(expVals[1], lsbExpVals[0], 1e-12);
+  EXPECT_NEAR(expVals[2], lsbExpVals[1], 1e-12);
+
+  // More than 64 bits
+  AcceleratorBuffer big("qreg", 70);
+  std::string s1(70, '0'), s2(70, '0');
+  s1[0] = '1';
+  s2[0] = '1';
+  s2[69] = '1';
+  big.appendMeasurement(s1, 300);
+  big.appendMeasurement(s2, 100);
+  EXPECT_NEAR((100. - 300.) / 400., big.getExpectationValueZ(), 1e-12);
+  auto bigExpVals = big.getExpectationValueZ({{69}, {0}, {0, 69}});
+  EXPECT_NEAR(-1.0, bigExpVals[0], 1e-12);
+  EXPECT_NEAR((300. - 100.) / 400., bigExpVals[1], 1e-12);
+  EXPECT_NEAR((100. - 300.) / 400., bigExpVals[2], 1e-12);
+}
+
+TEST(AcceleratorBufferTester, checkZStatistics) {
+  auto a = std::make_shared<AcceleratorBuffer>("a", 2);
+  a->appendMeasurement("00", 600);
+  a->appendMeasurement("01", 300);
+  a->appendMeasurement("11", 100);
+  auto b = std::make_shared<AcceleratorBuffer>("b", 1);
+  b->addExtraInfo("exp-val-z", 0.25);
+
+  // a: Z0, Z1 with coefficients 2 and -1, b: whole string parity
+  auto stats = AcceleratorBuffer::getZStatistics(
+      {a, b}, {{{0}, {1}}, {}}, {{2.0, -1.0}, {}});
+  ASSERT_EQ(2, stats.size());
+  EXPECT_EQ(1000, stats[0].shots);
+  EXPECT_NEAR(a->getExpectationValueZ({{0}})[0], stats[0].expVals[0], 1e-12);
+  EXPECT_NEAR(a->getExpectationValueZ({{1}})[0], stats[0].expVals[1], 1e-12);
+  // Values 1, -3 and -1 on 00, 01 and 11
+  const double mean = (600. - 900. - 100.) / 1000.;
+  EXPECT_NEAR(mean, stats[0].mean, 1e-12);
+  EXPECT_NEAR((600. + 2700. + 100.) / 1000. - mean * mean, stats[0].variance,
+              1e-12);
+  EXPECT_NEAR(0.25, stats[1].expVals[0], 1e-12);
+  EXPECT_EQ(0, stats[1].shots);
+
+  // Look-up only, no zero-count row added
+  EXPECT_NEAR(0.0, a->computeMeasurementProbability("10"), 1e-12);
+  EXPECT_EQ(3, a->getMeasurementCounts().size());
+  EXPECT_NEAR(0.3, a->computeMeasurementProbability("01"), 1e-12);
+}
+
+TEST(AcceleratorBufferTester, checkDiagonalValues) {
+  AcceleratorBuffer b("qreg", 3);
+  b.appendMeasurement("000", 10);
+  b.appendMeasurement("011", 20);
+  b.appendMeasurement("110", 30);
+
+  // 1.5 - 0.5 Z0 Z1 - 0.5 Z1 Z2 (identity as an empty mask)
+  const std::vector<std::vector<int>> masks{{}, {0, 1}, {1, 2}};
+  const std::vector<double> coeffs{1.5, -0.5, -0.5};
+  // MSB: bit 0 is the right-most character
+  auto values = b.getDiagonalValues(masks, coeffs);
+  EXPECT_EQ(3, values.size());
+  std::map<int, double> countToValue;
+  for (const auto &[value, count] : values) {
+    countToValue.emplace(count, value);
+  }
+  EXPECT_NEAR(0.5, countToValue[10], 1e-12);
+  EXPECT_NEAR(1.5, countToValue[20], 1e-12);
+  EXPECT_NEAR(1.5, countToValue[30], 1e-12);
+
+  // LSB: bit 0 is the left-most character
+  auto lsbValues = b.getDiagonalValues({{1, 2}}, {1.0},
+                                       AcceleratorBuffer::BitOrder::LSB);
+  double expVal = 0.0;
+  for (const auto &[value, count] : lsbValues) {
+    expVal += value * count / 60.;
+  }
+  EXPECT_NEAR(b.getExpectationValueZ({{1, 2}},
+                                     AcceleratorBuffer::BitOrder::LSB)[0],
+              expVal, 1e-12);
+}
+
+TEST(AcceleratorBufferTester, checkPostSelect) {
+  AcceleratorBuffer b("qreg", 4);
+  b.appendMeasurement("0000", 10);
+  b.appendMeasurement("0011", 20);
+  b.appendMeasurement("0001", 30);
+  b.appendMeasurement("1101", 40);
+
+  // Even parity of all the bits (MSB: bit 0 is the right-most character)
+  EXPECT_EQ(30, b.postSelect({{0, 1, 2, 3}}, {0}));
+  auto counts = b.getMeasurementCounts();
+  EXPECT_EQ(2, counts.size());
+  EXPECT_EQ(10, counts["0000"]);
+  EXPECT_EQ(20, counts["0011"]);
+  // LSB: bit 3 is the right-most character
+  EXPECT_EQ(10, b.postSelect({{3}}, {0}, AcceleratorBuffer::BitOrder::LSB));
+  EXPECT_EQ(1, b.getMeasurementCounts().size());
+  EXPECT_NEAR(1.0, b.getExpectationValueZ(), 1e-12);
+  // The packed index is rebuilt
+  b.appendMeasurement("0000");
+  EXPECT_EQ(11, b.getMeasurementCounts()["0000"]);
+}
+
+TEST(AcceleratorBufferTester, checkPackedMeasurementCounts) {
+  AcceleratorBuffer b("qreg", 3);
+  b.appendMeasurement("010");
+  b.appendMeasurement("010");
+  b.appendMeasurement("10");
+  b.appendMeasurement("110", 5);
+  std::string wide(100, '0');
+  wide[0] = '1';
+  b.appendMeasurement(wide, 2);
+  b.appendMeasurement("1x0", 4);
+  b.appendMeasurement("110", 6);
+
+  std::map<std::string, int> expected{
+      {"010", 2}, {"10", 1}, {"110", 6}, {wide, 2}, {"1x0", 4}};
+  EXPECT_EQ(expected, b.getMeasurementCounts());
+  EXPECT_EQ(5, b.getMeasurements().size());
+  EXPECT_NEAR(6. / 15., b.computeMeasurementProbability("110"), 1e-12);
+
+  b.setMeasurements({{"00", 1}, {"11", 3}});
+  EXPECT_EQ(2, b.getMeasurementCounts().size());
+  EXPECT_EQ(3, b.getMeasurementCounts()["11"]);
+  EXPECT_NEAR(1.0, b.getExpectationValueZ(), 1e-12);
+
+  b.clearMeasurements();
+  EXPECT_TRUE(b.getMeasurementCounts().empty());
+}
+
+TEST(AcceleratorBufferTester, checkPackedAccess) {
+  AcceleratorBuffer b("qreg", 3);
+  b.appendMeasurement("011", 7);
+  b.appendMeasurement("100");
+  b.appendMeasurement("100");
+  EXPECT_EQ(1, b.getPackedWords());
+  EXPECT_EQ(std::vector<std::uint64_t>({3, 4}), b.getPackedBitStrings());
+  EXPECT_EQ(std::vector<int>({7, 2}), b.getPackedCounts());
+  EXPECT_EQ(std::vector<std::size_t>({3, 3}), b.getPackedLengths());
+  EXPECT_FALSE(b.hasIrregularMeasurements());
+
+  std::string wide(70, '0');
+  wide[0] = '1';
+  b.appendMeasurement(wide, 5);
+  EXPECT_EQ(2, b.getPackedWords());
+  const auto &words = b.getPackedBitStrings();
+  EXPECT_EQ(6, words.size());
+  EXPECT_EQ(3, words[0]);
+  EXPECT_EQ(0, words[1]);
+  // Bit 69 of the last row
+  EXPECT_EQ(0, words[4]);
+  EXPECT_EQ(1ULL << 5, words[5]);
+  b.appendMeasurement("1x0");
+  EXPECT_TRUE(b.hasIrregularMeasurements());
+}
+
+TEST(AcceleratorBufferTester, checkBinaryPrintLoad) {
+  AcceleratorBuffer b("qreg", 2);
+  b.addExtraInfo("opt-val", -1.137);
+  b.addExtraInfo("opt-params", std::vector<double>{0.5, 0.25});
+  b.addExtraInfo("qubits", std::vector<int>{0, 1});
+  b.addExtraInfo("names", std::vector<std::string>{"a", "b"});
+  b.addExtraInfo("bitmap", std::map<int, int>{{0, 1}, {1, 0}});
+  b.addExtraInfo("term-exp-vals", std::map<std::string, double>{{"Z0", 0.5}});
+  b.addExtraInfo("embedding", std::map<int, std::vector<int>>{{0, {1, 2}}});
+  b.addExtraInfo("trace", std::vector<std::pair<double, double>>{{1., 2.}});
+  b.appendMeasurement("01", 10);
+  b.appendMeasurement("11", 20);
+
+  auto child = std::make_shared<AcceleratorBuffer>("Z0", 2);
+  child->addExtraInfo("kernel", std::string("Z0"));
+  child->addExtraInfo("coefficient", 0.5);
+  child->appendMeasurement("00", 323);
+  child->appendMeasurement("01", 701);
+  b.appendChild("Z0", child);
+
+  std::stringstream ss;
+  b.printBinary(ss);
+  // Streaming append of another child
+  auto child2 = std::make_shared<AcceleratorBuffer>("Z1", 2);
+  child2->addExtraInfo("kernel", std::string("Z1"));
+  child2->appendMeasurement("10", 5);
+  AcceleratorBuffer::appendBinaryChild(ss, "Z1", child2);
+
+  AcceleratorBuffer loaded;
+  loaded.load(ss);
+  EXPECT_EQ("qreg", loaded.name());
+  EXPECT_EQ(2, loaded.size());
+  EXPECT_EQ(b.getMeasurementCounts(), loaded.getMeasurementCounts());
+  for (auto &key : b.listExtraInfoKeys()) {
+    auto original = b.getInformation(key);
+    auto restored = loaded.getInformation(key);
+    EXPECT_EQ(original.index(), restored.index());
+    EXPECT_TRUE(mpark::visit(CheckEqualVisitor(original), restored));
+  }
+
+  EXPECT_EQ(2, loaded.nChildren());
+  auto loadedChild = loaded.getChildren("Z0")[0];
+  EXPECT_EQ("Z0",
+            mpark::get<std::string>(loadedChild->getInformation("kernel")));
+  EXPECT_NEAR(0.5,
+              mpark::get<double>(loadedChild->getInformation("coefficient")),
+              1e-12);
+  EXPECT_EQ(child->getMeasurementCounts(), loadedChild->getMeasurementCounts());
+  EXPECT_EQ(child2->getMeasurementCounts(),
+            loaded.getChildren("Z1")[0]->getMeasurementCounts());
+  EXPECT_EQ(b.getChildren("Z0")[0]->toString(), loadedChild->toString());
+}
+
 TEST(AcceleratorBufferTester, checkLoad) {
   const std::string bufferStr = R"bufferStr({
     "AcceleratorBuffer": {
@@ -276,6 +502,50 @@ TEST(AcceleratorBufferTester, checkMarginalCount) {
   }
 }
 
+TEST(AcceleratorBufferTester, checkIndexedChildren) {
+  AcceleratorBuffer b("qreg", 2);
+  for (int i = 0; i < 10; i++) {
+    auto child = std::make_shared<AcceleratorBuffer>(
+        i % 2 ? "Z0" : "X0", 2);
+    child->addExtraInfo("parameters", std::vector<double>{0.1 * (i / 2)});
+    child->addExtraInfo("iteration", i / 2);
+    b.appendChild(child->name(), child);
+  }
+  // A secondary index before and after appending children
+  b.indexChildrenBy("parameters");
+
+  auto z0 = b.getChildren("Z0");
+  EXPECT_EQ(5, z0.size());
+  for (int i = 0; i < z0.size(); i++) {
+    EXPECT_EQ(i, mpark::get<int>(z0[i]->getInformation("iteration")));
+  }
+  EXPECT_TRUE(b.getChildren("Y0").empty());
+
+  auto atParams = b.getChildren("parameters", std::vector<double>{0.2});
+  EXPECT_EQ(2, atParams.size());
+  EXPECT_EQ("X0", atParams[0]->name());
+  EXPECT_EQ("Z0", atParams[1]->name());
+  // Non-indexed key
+  EXPECT_EQ(2, b.getChildren("iteration", 2).size());
+
+  auto child = std::make_shared<AcceleratorBuffer>("I", 2);
+  child->addExtraInfo("parameters", std::vector<double>{0.2});
+  b.appendChild("I", child);
+  EXPECT_EQ(3, b.getChildren("parameters", std::vector<double>{0.2}).size());
+  EXPECT_EQ(11, b.nChildren());
+
+  // Positions are re-indexed on removal
+  b.removeChild(0);
+  EXPECT_EQ(4, b.getChildren("X0").size());
+  EXPECT_EQ(1, mpark::get<int>(
+                   b.getChildren("X0")[0]->getInformation("iteration")));
+  EXPECT_EQ("I", b.getChildren("parameters", std::vector<double>{0.2})
+                     .back()
+                     ->name());
+  b.resetBuffer();
+  EXPECT_TRUE(b.getChildren("Z0").empty());
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
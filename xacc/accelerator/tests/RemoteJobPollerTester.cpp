@@ -0,0 +1,100 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include <gtest/gtest.h>
+
+#include "RemoteAccelerator.hpp"
+#include <algorithm>
+#include <atomic>
+
+using namespace xacc;
+
+TEST(RemoteJobPollerTester, checkManyJobs) {
+  auto &poller = RemoteJobPoller::instance();
+  poller.configure({{"poll-initial-delay-ms", 1},
+                    {"poll-max-delay-ms", 8},
+                    {"max-polls-per-second", 0.0}});
+  // Job i completes at its (i % 5 + 1)-th status check
+  std::vector<int> nbChecks(50, 0);
+  std::vector<std::future<void>> completions;
+  for (int i = 0; i < nbChecks.size(); i++) {
+    completions.emplace_back(poller.watch(
+        [&nbChecks, i]() { return ++nbChecks[i] == i % 5 + 1; }));
+  }
+  for (int i = 0; i < completions.size(); i++) {
+    completions[i].get();
+    EXPECT_EQ(i % 5 + 1, nbChecks[i]);
+  }
+
+  // Failures are forwarded to the waiting thread
+  EXPECT_THROW(poller.wait([]() -> bool {
+    throw std::runtime_error("job failed");
+  }),
+               std::runtime_error);
+}
+
+TEST(RemoteJobPollerTester, checkRateLimit) {
+  auto &poller = RemoteJobPoller::instance();
+  poller.configure({{"poll-initial-delay-ms", 1},
+                    {"poll-max-delay-ms", 1},
+                    {"max-polls-per-second", 100.0}});
+  std::atomic<int> nbChecks(0);
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::future<void>> completions;
+  for (int i = 0; i < 4; i++) {
+    completions.emplace_back(
+        poller.watch([&nbChecks]() { return ++nbChecks >= 20; }));
+  }
+  for (auto &completion : completions) {
+    completion.get();
+  }
+  // At least 20 checks, at most one every 10 ms across the jobs
+  EXPECT_GE(nbChecks, 20);
+  EXPECT_GE(std::chrono::steady_clock::now() - start,
+            std::chrono::milliseconds(190));
+}
+
+TEST(RemoteJobPollerTester, checkRunConcurrently) {
+  std::mutex lock;
+  int running = 0, maxRunning = 0;
+  std::vector<int> done(20, 0);
+  runConcurrently(done.size(), 4, [&](std::size_t i) {
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      maxRunning = std::max(maxRunning, ++running);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    done[i]++;
+    std::lock_guard<std::mutex> guard(lock);
+    --running;
+  });
+  EXPECT_EQ(std::count(done.begin(), done.end(), 1), 20);
+  EXPECT_LE(maxRunning, 4);
+  EXPECT_GT(maxRunning, 1);
+
+  // All the tasks still run
+  std::atomic<int> nbRun(0);
+  EXPECT_THROW(runConcurrently(10, 3,
+                               [&](std::size_t i) {
+                                 nbRun++;
+                                 if (i == 2) {
+                                   throw std::runtime_error("failed");
+                                 }
+                               }),
+               std::runtime_error);
+  EXPECT_EQ(nbRun, 10);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
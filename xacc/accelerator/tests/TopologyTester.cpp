@@ -0,0 +1,85 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include <gtest/gtest.h>
+
+#include "Topology.hpp"
+#include <cmath>
+using namespace xacc;
+
+TEST(TopologyTester, checkDistances) {
+  // Ring of 6 qubits, couplings given in both directions
+  Topology::Edges edges;
+  for (int i = 0; i < 6; ++i) {
+    edges.emplace_back(i, (i + 1) % 6);
+    edges.emplace_back((i + 1) % 6, i);
+  }
+  Topology topology(edges);
+  EXPECT_EQ(6, topology.size());
+  EXPECT_EQ(6, topology.qubits().size());
+  EXPECT_EQ(6, topology.edges().size());
+  EXPECT_TRUE(topology.isConnected());
+  EXPECT_TRUE(topology.coupled(5, 0));
+  EXPECT_NEAR(Topology::DEFAULT_FIDELITY, topology.fidelity(5, 0), 1e-12);
+  EXPECT_FALSE(topology.coupled(0, 2));
+  EXPECT_EQ(0, topology.distance(2, 2));
+  EXPECT_EQ(1, topology.distance(0, 5));
+  EXPECT_EQ(3, topology.distance(0, 3));
+  EXPECT_EQ(2, topology.distance(4, 0));
+  EXPECT_EQ(5, topology.nextHop(4, 0));
+
+  const auto path = topology.shortestPath(1, 4);
+  EXPECT_EQ(4, path.size());
+  EXPECT_EQ(1, path.front());
+  EXPECT_EQ(4, path.back());
+  for (size_t i = 1; i < path.size(); ++i) {
+    EXPECT_TRUE(topology.coupled(path[i - 1], path[i]));
+  }
+}
+
+TEST(TopologyTester, checkWeightedDistances) {
+  // Square 0-1-2-3-0, the 0-1-2 side being noisy
+  const Topology::Edges edges{{0, 1}, {1, 2}, {2, 3}, {3, 0}};
+  const Topology::Fidelities fidelities{
+      {0, 1, 0.9}, {1, 2, 0.9}, {2, 3, 0.99}, {3, 0, 0.99}};
+  Topology topology(edges, fidelities);
+  EXPECT_EQ(2, topology.distance(0, 2));
+  EXPECT_NEAR(0.9, topology.fidelity(1, 0), 1e-12);
+  EXPECT_NEAR(0.0, topology.fidelity(0, 2), 1e-12);
+  const std::vector<size_t> expected{0, 3, 2};
+  EXPECT_EQ(expected, topology.highestFidelityPath(0, 2));
+  EXPECT_EQ(3, topology.nextWeightedHop(0, 2));
+  EXPECT_NEAR(-2.0 * std::log(0.99), topology.weightedDistance(0, 2), 1e-12);
+  EXPECT_NEAR(-std::log(0.9), topology.weightedDistance(1, 0), 1e-12);
+}
+
+TEST(TopologyTester, checkDisconnected) {
+  Topology topology({{0, 1}, {2, 3}});
+  EXPECT_FALSE(topology.isConnected());
+  EXPECT_EQ(Topology::UNREACHABLE, topology.distance(0, 3));
+  EXPECT_EQ(Topology::UNREACHABLE, topology.nextHop(0, 3));
+  EXPECT_TRUE(topology.shortestPath(0, 3).empty());
+}
+
+TEST(TopologyTester, checkCache) {
+  const Topology::Edges edges{{0, 1}, {1, 2}};
+  auto topology1 = Topology::get(edges);
+  auto topology2 = Topology::get(edges);
+  EXPECT_EQ(topology1.get(), topology2.get());
+  auto topology3 = Topology::get({{0, 1}, {1, 2}, {2, 0}});
+  EXPECT_NE(topology1.get(), topology3.get());
+  EXPECT_EQ(1, topology3->distance(0, 2));
+  Topology::clearCache();
+  auto topology4 = Topology::get(edges);
+  EXPECT_NE(topology1.get(), topology4.get());
+  EXPECT_EQ(2, topology4->distance(0, 2));
+}
@@ -41,6 +41,11 @@ public:
     return;
   }
 
+  // Pass the (post-processed) results of the energy evaluation at the point
+  // of the gradient, which finite differences can reuse for the base point.
+  virtual void setBaseResults(
+      const std::vector<std::shared_ptr<AcceleratorBuffer>> &baseResults) {}
+
   // Pass parameters to initialize specific gradient implementation
   virtual bool initialize(const HeterogeneousMap parameters) = 0;
 
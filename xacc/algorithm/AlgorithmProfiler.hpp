@@ -0,0 +1,78 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_ALGORITHM_ALGORITHMPROFILER_HPP_
+#define XACC_ALGORITHM_ALGORITHMPROFILER_HPP_
+
+#include "AcceleratorBuffer.hpp"
+#include "Utils.hpp"
+#include "heterogeneous.hpp"
+
+#include <memory>
+
+namespace xacc {
+
+// Time spans of a variational algorithm execution, e.g. an "iteration"
+// span per objective evaluation with "bind", "execute", "post-process"...
+// phases, when enabled by the options:
+//   "profile"       true: the durations of each span and of its phases in
+//                   the buffer, "profile-<span>-ms" and
+//                   "profile-<span>-<phase>-ms", one entry per span,
+//   "profile-trace" a file name: all the spans as a Chrome trace
+//                   (chrome://tracing, Perfetto), implies "profile".
+class AlgorithmProfiler {
+public:
+  void initialize(const HeterogeneousMap &in_parameters) {
+    m_enabled = false;
+    m_traceFile.clear();
+    if (in_parameters.keyExists<bool>("profile")) {
+      m_enabled = in_parameters.get<bool>("profile");
+    }
+    if (in_parameters.stringExists("profile-trace")) {
+      m_traceFile = in_parameters.getString("profile-trace");
+      m_enabled = true;
+    }
+  }
+
+  // The recorder of one execution, null (no timing) if not enabled
+  std::unique_ptr<SpanRecorder> recorder() const {
+    return m_enabled ? std::make_unique<SpanRecorder>() : nullptr;
+  }
+
+  // The breakdowns of the spans named in_spanNames to io_buffer, then the
+  // trace file.
+  void record(const SpanRecorder *in_recorder,
+              const std::vector<std::string> &in_spanNames,
+              AcceleratorBuffer &io_buffer) const {
+    if (!in_recorder) {
+      return;
+    }
+    for (auto &spanName : in_spanNames) {
+      for (auto &[phase, durations] : in_recorder->breakdown(spanName)) {
+        io_buffer.addExtraInfo(
+            "profile-" +
+                (phase == spanName ? spanName : spanName + "-" + phase) +
+                "-ms",
+            durations);
+      }
+    }
+    if (!m_traceFile.empty()) {
+      in_recorder->writeChromeTrace(m_traceFile);
+    }
+  }
+
+private:
+  bool m_enabled = false;
+  std::string m_traceFile;
+};
+} // namespace xacc
+#endif
@@ -0,0 +1,253 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "Checkpoint.hpp"
+
+#include "xacc.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+
+namespace {
+// Extra info of the checkpoint buffer, the others are the algorithm state.
+const std::string keyInfo = "__checkpoint_key__";
+const std::string stageInfo = "__checkpoint_stage__";
+// One child per logged evaluation
+const std::string evaluationChild = "evaluation";
+} // namespace
+
+namespace xacc {
+Checkpoint::Checkpoint(const std::string &in_fileName, int in_interval)
+    : m_fileName(in_fileName), m_interval(in_interval),
+      m_state(std::make_shared<AcceleratorBuffer>("checkpoint", 0)) {
+  if (m_interval < 1) {
+    xacc::error("'checkpoint-interval' must be positive.");
+  }
+}
+
+std::shared_ptr<Checkpoint>
+Checkpoint::fromParameters(const HeterogeneousMap &in_parameters) {
+  if (in_parameters.keyExists<std::shared_ptr<Checkpoint>>("checkpoint")) {
+    return in_parameters.get<std::shared_ptr<Checkpoint>>("checkpoint");
+  }
+  if (!in_parameters.stringExists("checkpoint")) {
+    return nullptr;
+  }
+  int interval = 1;
+  if (in_parameters.keyExists<int>("checkpoint-interval")) {
+    interval = in_parameters.get<int>("checkpoint-interval");
+  }
+  return std::make_shared<Checkpoint>(in_parameters.getString("checkpoint"),
+                                      interval);
+}
+
+bool Checkpoint::restore(const std::string &in_key) {
+  if (m_restoreAttempted) {
+    return m_restored;
+  }
+  m_restoreAttempted = true;
+  m_key = in_key;
+  m_state->addExtraInfo(keyInfo, m_key);
+  std::ifstream stream(m_fileName, std::ios::binary);
+  if (!stream) {
+    return false;
+  }
+
+  auto loaded = std::make_shared<AcceleratorBuffer>();
+  try {
+    loaded->loadBinary(stream);
+  } catch (std::exception &e) {
+    xacc::warning("Ignoring the invalid checkpoint " + m_fileName + ": " +
+                  e.what());
+    return false;
+  }
+  if (!loaded->hasExtraInfoKey(keyInfo) ||
+      loaded->getInformation(keyInfo).as<std::string>() != m_key) {
+    xacc::warning("Ignoring the checkpoint " + m_fileName +
+                  " of another problem.");
+    return false;
+  }
+
+  m_stage = loaded->hasExtraInfoKey(stageInfo)
+                ? loaded->getInformation(stageInfo).as<int>()
+                : 0;
+  for (auto &child : loaded->getChildren(evaluationChild)) {
+    Evaluation evaluation;
+    evaluation.parameters =
+        child->getInformation("parameters").as<std::vector<double>>();
+    evaluation.value = child->getInformation("value").as<double>();
+    if (child->hasExtraInfoKey("gradient")) {
+      evaluation.gradient =
+          child->getInformation("gradient").as<std::vector<double>>();
+    }
+    evaluation.shots = child->getInformation("shots").as<int>();
+    evaluation.variance = child->getInformation("variance").as<double>();
+    m_evaluations.emplace_back(std::move(evaluation));
+  }
+  m_state = std::make_shared<AcceleratorBuffer>("checkpoint", 0);
+  for (auto &[key, value] : loaded->getInformation()) {
+    m_state->addExtraInfo(key, value);
+  }
+  m_restored = true;
+  xacc::info("Restored the checkpoint " + m_fileName + " (stage " +
+             std::to_string(m_stage) + ", " +
+             std::to_string(m_evaluations.size()) + " evaluations).");
+  return true;
+}
+
+void Checkpoint::beginStage(int in_stage) {
+  if (in_stage != m_stage) {
+    m_evaluations.clear();
+    m_stage = in_stage;
+  }
+  m_replayPos = 0;
+}
+
+bool Checkpoint::replay(const std::vector<double> &in_x, bool in_needGradient,
+                        int in_shots, Evaluation &out_evaluation) {
+  if (m_replayPos >= m_evaluations.size()) {
+    return false;
+  }
+  const auto &next = m_evaluations[m_replayPos];
+  if (next.parameters != in_x || next.shots != in_shots ||
+      (in_needGradient && next.gradient.size() != in_x.size())) {
+    // Another trajectory from here: the rest of the log is stale.
+    xacc::warning("Checkpoint replay stopped after " +
+                  std::to_string(m_replayPos) +
+                  " evaluations: the optimizer took another iterate.");
+    m_evaluations.resize(m_replayPos);
+    return false;
+  }
+  out_evaluation = next;
+  ++m_replayPos;
+  ++m_nbReplayed;
+  return true;
+}
+
+void Checkpoint::record(Evaluation in_evaluation) {
+  // Evaluated (not replayed) past the end of the log
+  m_evaluations.resize(m_replayPos);
+  m_evaluations.emplace_back(std::move(in_evaluation));
+  ++m_replayPos;
+  if (++m_nbUnsaved >= m_interval) {
+    save();
+  }
+}
+
+void Checkpoint::save() {
+  auto buffer = std::make_shared<AcceleratorBuffer>("checkpoint", 0);
+  for (auto &[key, value] : m_state->getInformation()) {
+    buffer->addExtraInfo(key, value);
+  }
+  buffer->addExtraInfo(keyInfo, m_key);
+  buffer->addExtraInfo(stageInfo, m_stage);
+
+  const auto tmpFileName = m_fileName + "." + std::to_string(getpid());
+  {
+    std::ofstream stream(tmpFileName, std::ios::binary);
+    buffer->printBinary(stream);
+    for (const auto &evaluation : m_evaluations) {
+      auto child = std::make_shared<AcceleratorBuffer>(evaluationChild, 0);
+      child->addExtraInfo("parameters", evaluation.parameters);
+      child->addExtraInfo("value", evaluation.value);
+      if (!evaluation.gradient.empty()) {
+        child->addExtraInfo("gradient", evaluation.gradient);
+      }
+      child->addExtraInfo("shots", evaluation.shots);
+      child->addExtraInfo("variance", evaluation.variance);
+      AcceleratorBuffer::appendBinaryChild(stream, evaluationChild, child);
+    }
+    if (!stream) {
+      xacc::warning("Could not write the checkpoint " + m_fileName);
+      std::remove(tmpFileName.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmpFileName.c_str(), m_fileName.c_str()) != 0) {
+    xacc::warning("Could not write the checkpoint " + m_fileName);
+    std::remove(tmpFileName.c_str());
+    return;
+  }
+  m_nbUnsaved = 0;
+}
+
+double CheckpointedOptFunction::operator()(const std::vector<double> &x,
+                                           std::vector<double> &dx) {
+  Checkpoint::Evaluation evaluation;
+  if (replay(x, !dx.empty(), -1, evaluation)) {
+    if (!dx.empty()) {
+      dx = evaluation.gradient;
+    }
+    return evaluation.value;
+  }
+  evaluation.parameters = x;
+  evaluation.value = m_function(x, dx);
+  evaluation.gradient = dx;
+  const double value = evaluation.value;
+  m_checkpoint->record(std::move(evaluation));
+  return value;
+}
+
+double CheckpointedOptFunction::operator()(const std::vector<double> &x,
+                                           const int in_shots,
+                                           double &out_variance) {
+  Checkpoint::Evaluation evaluation;
+  if (replay(x, false, in_shots, evaluation)) {
+    out_variance = evaluation.variance;
+    return evaluation.value;
+  }
+  evaluation.parameters = x;
+  evaluation.value = m_function(x, in_shots, out_variance);
+  evaluation.shots = in_shots;
+  evaluation.variance = out_variance;
+  const double value = evaluation.value;
+  m_checkpoint->record(std::move(evaluation));
+  return value;
+}
+
+std::vector<double> CheckpointedOptFunction::evaluate(
+    const std::vector<std::vector<double>> &xs) {
+  std::vector<double> values;
+  Checkpoint::Evaluation evaluation;
+  while (values.size() < xs.size() &&
+         replay(xs[values.size()], false, -1, evaluation)) {
+    values.emplace_back(evaluation.value);
+  }
+  if (values.size() == xs.size()) {
+    return values;
+  }
+  const std::vector<std::vector<double>> remaining(xs.begin() + values.size(),
+                                                   xs.end());
+  const auto remainingValues = m_function.evaluate(remaining);
+  for (std::size_t i = 0; i < remaining.size(); ++i) {
+    Checkpoint::Evaluation newEvaluation;
+    newEvaluation.parameters = remaining[i];
+    newEvaluation.value = remainingValues[i];
+    m_checkpoint->record(std::move(newEvaluation));
+    values.emplace_back(remainingValues[i]);
+  }
+  return values;
+}
+
+bool CheckpointedOptFunction::replay(const std::vector<double> &x,
+                                     bool in_needGradient, int in_shots,
+                                     Checkpoint::Evaluation &out_evaluation) {
+  if (!m_checkpoint->replay(x, in_needGradient, in_shots, out_evaluation)) {
+    return false;
+  }
+  if (m_onReplay) {
+    m_onReplay(out_evaluation);
+  }
+  return true;
+}
+} // namespace xacc
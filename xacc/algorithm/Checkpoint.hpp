@@ -0,0 +1,136 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_ALGORITHM_CHECKPOINT_HPP_
+#define XACC_ALGORITHM_CHECKPOINT_HPP_
+
+#include "AcceleratorBuffer.hpp"
+#include "Optimizer.hpp"
+#include "heterogeneous.hpp"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace xacc {
+
+// Checkpoint / restart of a long-running algorithm, e.g. a preempted ADAPT
+// run resuming at its last operator. Options of the algorithms that use it:
+//   "checkpoint"          the file (binary AcceleratorBuffer format), or a
+//                         Checkpoint shared with a sub-algorithm,
+//   "checkpoint-interval" number of objective evaluations between writes
+//                         (default 1).
+// The file holds the algorithm state (extra info of state(), e.g. the ADAPT
+// operators) and the log of the objective evaluations of the current stage
+// (e.g. ADAPT iteration). On restart, the optimizer runs again from the same
+// initial parameters and the logged evaluations are replayed without running
+// their circuits: a deterministic optimizer (or a seeded stochastic one)
+// goes through the same iterates, i.e. resumes with the same internal state.
+// The replay stops at the first iterate that differs from the log.
+// The file is replaced by renaming a temporary one: a preemption while
+// writing leaves the previous checkpoint.
+class Checkpoint {
+public:
+  struct Evaluation {
+    std::vector<double> parameters;
+    double value = 0.0;
+    // Empty if not computed
+    std::vector<double> gradient;
+    // Shots of a shot-adaptive evaluation (-1: exact), and its variance
+    int shots = -1;
+    double variance = -1.0;
+  };
+
+  Checkpoint(const std::string &in_fileName, int in_interval = 1);
+
+  // nullptr if there is no "checkpoint" option.
+  static std::shared_ptr<Checkpoint>
+  fromParameters(const HeterogeneousMap &in_parameters);
+
+  // Loads the file on the first call: false if there is none, or if it is
+  // invalid or of another problem than in_key (it is then overwritten).
+  bool restore(const std::string &in_key);
+  bool restored() const { return m_restored; }
+
+  // The algorithm state, saved as the extra info of a buffer
+  AcceleratorBuffer &state() { return *m_state; }
+  int stage() const { return m_stage; }
+  // Starts a stage: the evaluations of another stage are dropped, those of
+  // the same one (i.e. interrupted) are replayed from the first one.
+  void beginStage(int in_stage);
+
+  // The next logged evaluation if it is at in_x (with a gradient if
+  // in_needGradient, with in_shots shots).
+  bool replay(const std::vector<double> &in_x, bool in_needGradient,
+              int in_shots, Evaluation &out_evaluation);
+  // Logs an evaluation, saved every "checkpoint-interval" evaluations
+  void record(Evaluation in_evaluation);
+  std::size_t nbReplayed() const { return m_nbReplayed; }
+
+  // Writes the checkpoint now
+  void save();
+  const std::string &fileName() const { return m_fileName; }
+
+private:
+  std::string m_fileName;
+  int m_interval;
+  bool m_restoreAttempted = false;
+  bool m_restored = false;
+  std::string m_key;
+  std::shared_ptr<AcceleratorBuffer> m_state;
+  int m_stage = 0;
+  std::vector<Evaluation> m_evaluations;
+  // Next logged evaluation to replay
+  std::size_t m_replayPos = 0;
+  std::size_t m_nbReplayed = 0;
+  int m_nbUnsaved = 0;
+};
+
+// The objective of an optimizer with the evaluations logged in (and
+// replayed from) a checkpoint. in_onReplay is called with each replayed
+// evaluation, e.g. to restore the energy history of the algorithm.
+class CheckpointedOptFunction : public OptFunction {
+public:
+  using ReplayCallback = std::function<void(const Checkpoint::Evaluation &)>;
+
+  CheckpointedOptFunction(OptFunction &in_function,
+                          std::shared_ptr<Checkpoint> in_checkpoint,
+                          ReplayCallback in_onReplay = {})
+      : m_function(in_function), m_checkpoint(std::move(in_checkpoint)),
+        m_onReplay(std::move(in_onReplay)) {}
+
+  const int dimensions() const override { return m_function.dimensions(); }
+  double operator()(const std::vector<double> &x,
+                    std::vector<double> &dx) override;
+  double operator()(const std::vector<double> &&x) override {
+    std::vector<double> dx;
+    return operator()(x, dx);
+  }
+  bool acceptsShots() const override { return m_function.acceptsShots(); }
+  double operator()(const std::vector<double> &x, const int in_shots,
+                    double &out_variance) override;
+  bool acceptsBatches() const override { return m_function.acceptsBatches(); }
+  // The replayed prefix of xs, then the others as one batch.
+  std::vector<double>
+  evaluate(const std::vector<std::vector<double>> &xs) override;
+
+private:
+  bool replay(const std::vector<double> &x, bool in_needGradient,
+              int in_shots, Checkpoint::Evaluation &out_evaluation);
+
+  OptFunction &m_function;
+  std::shared_ptr<Checkpoint> m_checkpoint;
+  ReplayCallback m_onReplay;
+};
+} // namespace xacc
+#endif
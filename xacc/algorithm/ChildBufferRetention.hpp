@@ -0,0 +1,187 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_ALGORITHM_CHILDBUFFERRETENTION_HPP_
+#define XACC_ALGORITHM_CHILDBUFFERRETENTION_HPP_
+
+#include "AcceleratorBuffer.hpp"
+#include "heterogeneous.hpp"
+#include "xacc.hpp"
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+namespace xacc {
+
+// Decides which per-iteration child buffers of a variational algorithm
+// are kept on the user buffer ("child-buffer-retention" option):
+//   "all"            every iteration (default, appended as they come),
+//   "keep-last"      the last "retain-iterations" (default 1) iterations,
+//   "keep-best"      the iteration with the lowest cost value,
+//   "aggregate-only" none, only the aggregate results.
+// The children of the best iteration and of the retained ones are also
+// indexed by parameter vector, so that the final lookup does not scan the
+// buffer.
+class ChildBufferRetention {
+public:
+  enum class Policy { All, KeepLast, KeepBest, AggregateOnly };
+  using Children = std::vector<std::shared_ptr<AcceleratorBuffer>>;
+
+  ChildBufferRetention(Policy in_policy = Policy::All,
+                       int in_nbIterations = 1)
+      : m_policy(in_policy), m_nbIterations(in_nbIterations) {}
+
+  // Reads the retention options (all by default), out_nbIterations is only
+  // set for keep-last.
+  static Policy fromParameters(const HeterogeneousMap &in_parameters,
+                               int &out_nbIterations) {
+    out_nbIterations = 1;
+    if (!in_parameters.stringExists("child-buffer-retention")) {
+      return Policy::All;
+    }
+    const auto name = in_parameters.getString("child-buffer-retention");
+    if (name == "all") {
+      return Policy::All;
+    }
+    if (name == "keep-best") {
+      return Policy::KeepBest;
+    }
+    if (name == "aggregate-only") {
+      return Policy::AggregateOnly;
+    }
+    if (name != "keep-last") {
+      xacc::error("Invalid child-buffer-retention '" + name +
+                  "', must be one of all, keep-last, keep-best or "
+                  "aggregate-only.");
+    }
+    if (in_parameters.keyExists<int>("retain-iterations")) {
+      out_nbIterations = in_parameters.get<int>("retain-iterations");
+      if (out_nbIterations < 1) {
+        xacc::error("'retain-iterations' must be positive.");
+      }
+    }
+    return Policy::KeepLast;
+  }
+
+  // Records the children of one evaluation at in_params with cost value
+  // in_value (lower is better). With the all policy they are appended to
+  // io_buffer right away.
+  void addIteration(std::shared_ptr<AcceleratorBuffer> io_buffer,
+                    const std::vector<double> &in_params, double in_value,
+                    Children in_children) {
+    auto iteration = std::make_shared<Iteration>(
+        Iteration{in_params, in_value, std::move(in_children)});
+    if (m_policy == Policy::All) {
+      for (auto &child : iteration->children) {
+        io_buffer->appendChild(child->name(), child);
+      }
+      m_index[in_params] = iteration;
+    }
+    if (!m_best || in_value < m_best->value) {
+      auto previous = m_best;
+      m_best = iteration;
+      m_index[in_params] = iteration;
+      release(previous);
+    }
+    if (m_policy == Policy::KeepLast) {
+      m_retained.emplace_back(iteration);
+      m_index[in_params] = iteration;
+      if (m_retained.size() > static_cast<size_t>(m_nbIterations)) {
+        auto oldest = m_retained.front();
+        m_retained.pop_front();
+        release(oldest);
+      }
+    }
+  }
+
+  // Children of the last kept evaluation at in_params (empty if none).
+  Children getChildren(const std::vector<double> &in_params) const {
+    auto iter = m_index.find(in_params);
+    return iter == m_index.end() ? Children{} : iter->second->children;
+  }
+
+  // Appends the retained children to io_buffer (all of them were already
+  // appended with the all policy), in iteration order.
+  void finalize(std::shared_ptr<AcceleratorBuffer> io_buffer) const {
+    Children children;
+    if (m_policy == Policy::KeepLast) {
+      for (auto &iteration : m_retained) {
+        children.insert(children.end(), iteration->children.begin(),
+                        iteration->children.end());
+      }
+    } else if (m_policy == Policy::KeepBest && m_best) {
+      children = m_best->children;
+    }
+    for (auto &child : children) {
+      io_buffer->appendChild(child->name(), child);
+    }
+  }
+
+private:
+  struct Iteration {
+    std::vector<double> params;
+    double value;
+    Children children;
+  };
+  struct ParamsHash {
+    size_t operator()(const std::vector<double> &in_params) const {
+      size_t seed = in_params.size();
+      for (const auto param : in_params) {
+        seed ^= std::hash<double>()(param) + 0x9e3779b9 + (seed << 6) +
+                (seed >> 2);
+      }
+      return seed;
+    }
+  };
+
+  // Drops in_iteration from the index once neither the best nor in the
+  // keep-last window, falling back to an older kept evaluation at the same
+  // parameters.
+  void release(const std::shared_ptr<Iteration> &in_iteration) {
+    if (!in_iteration || m_policy == Policy::All || in_iteration == m_best) {
+      return;
+    }
+    for (auto &iteration : m_retained) {
+      if (iteration == in_iteration) {
+        return;
+      }
+    }
+    auto iter = m_index.find(in_iteration->params);
+    if (iter == m_index.end() || iter->second != in_iteration) {
+      return;
+    }
+    for (auto kept = m_retained.rbegin(); kept != m_retained.rend(); ++kept) {
+      if ((*kept)->params == in_iteration->params) {
+        iter->second = *kept;
+        return;
+      }
+    }
+    if (m_best->params == in_iteration->params) {
+      iter->second = m_best;
+      return;
+    }
+    m_index.erase(iter);
+  }
+
+  Policy m_policy;
+  int m_nbIterations;
+  std::shared_ptr<Iteration> m_best;
+  // Keep-last window, oldest first
+  std::deque<std::shared_ptr<Iteration>> m_retained;
+  std::unordered_map<std::vector<double>, std::shared_ptr<Iteration>,
+                     ParamsHash>
+      m_index;
+};
+} // namespace xacc
+#endif
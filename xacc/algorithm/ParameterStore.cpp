@@ -0,0 +1,174 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include "ParameterStore.hpp"
+
+#include "json.hpp"
+#include "xacc.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <sys/file.h>
+#include <unistd.h>
+
+namespace {
+using json = nlohmann::json;
+
+// Entries are {"parameters": [...], "cost": c, "updated": unix time},
+// under "<fingerprint>#<number of parameters>".
+std::string entryKey(const std::string &in_fingerprint,
+                     std::size_t in_nbParams) {
+  return in_fingerprint + "#" + std::to_string(in_nbParams);
+}
+
+// The stored entries, an empty object if the file is missing or invalid.
+json readStore(const std::string &in_fileName) {
+  std::ifstream stream(in_fileName);
+  if (!stream) {
+    return json::object();
+  }
+  std::stringstream ss;
+  ss << stream.rdbuf();
+  auto store = json::parse(ss.str(), nullptr, false);
+  if (store.is_discarded() || !store.is_object()) {
+    xacc::warning("Ignoring the invalid parameter store " + in_fileName);
+    return json::object();
+  }
+  return store;
+}
+
+// Exclusive lock (for the lifetime of the object) of <file>.lock
+class StoreLock {
+public:
+  explicit StoreLock(const std::string &in_fileName) {
+    m_fd = open((in_fileName + ".lock").c_str(), O_RDWR | O_CREAT, 0644);
+    if (m_fd >= 0 && flock(m_fd, LOCK_EX) != 0) {
+      close(m_fd);
+      m_fd = -1;
+    }
+  }
+  ~StoreLock() {
+    if (m_fd >= 0) {
+      flock(m_fd, LOCK_UN);
+      close(m_fd);
+    }
+  }
+  bool locked() const { return m_fd >= 0; }
+
+private:
+  int m_fd = -1;
+};
+} // namespace
+
+namespace xacc {
+ParameterStore::ParameterStore(const std::string &in_fileName,
+                               Update in_update, const std::string &in_key)
+    : m_fileName(in_fileName), m_update(in_update), m_key(in_key) {}
+
+std::shared_ptr<ParameterStore>
+ParameterStore::fromParameters(const HeterogeneousMap &in_parameters,
+                               Update in_defaultUpdate) {
+  if (!in_parameters.stringExists("parameter-store")) {
+    return nullptr;
+  }
+  auto update = in_defaultUpdate;
+  if (in_parameters.stringExists("parameter-store-update")) {
+    const auto name = in_parameters.getString("parameter-store-update");
+    if (name == "best") {
+      update = Update::Best;
+    } else if (name == "latest") {
+      update = Update::Latest;
+    } else {
+      xacc::error("Invalid 'parameter-store-update' " + name +
+                  ", must be 'best' or 'latest'.");
+    }
+  }
+  const std::string key = in_parameters.stringExists("parameter-store-key")
+                              ? in_parameters.getString("parameter-store-key")
+                              : "";
+  return std::make_shared<ParameterStore>(
+      in_parameters.getString("parameter-store"), update, key);
+}
+
+bool ParameterStore::lookup(const std::string &in_fingerprint,
+                            std::size_t in_nbParams,
+                            std::vector<double> &out_params) const {
+  // The file is only ever replaced by a rename: no lock to read it.
+  const auto store = readStore(m_fileName);
+  const auto iter = store.find(entryKey(in_fingerprint, in_nbParams));
+  if (iter == store.end() || !iter->count("parameters")) {
+    return false;
+  }
+  auto params = (*iter)["parameters"].get<std::vector<double>>();
+  if (params.size() != in_nbParams) {
+    return false;
+  }
+  out_params = std::move(params);
+  return true;
+}
+
+bool ParameterStore::record(const std::string &in_fingerprint,
+                            const std::vector<double> &in_params,
+                            double in_cost) {
+  StoreLock lock(m_fileName);
+  if (!lock.locked()) {
+    xacc::warning("Could not lock the parameter store " + m_fileName);
+    return false;
+  }
+  auto store = readStore(m_fileName);
+  const auto key = entryKey(in_fingerprint, in_params.size());
+  if (m_update == Update::Best && store.count(key) &&
+      store[key].count("cost") && store[key]["cost"].get<double>() <= in_cost) {
+    return false;
+  }
+
+  json entry;
+  entry["parameters"] = in_params;
+  entry["cost"] = in_cost;
+  entry["updated"] = std::chrono::duration_cast<std::chrono::seconds>(
+                         std::chrono::system_clock::now().time_since_epoch())
+                         .count();
+  store[key] = entry;
+
+  const auto tmpFileName = m_fileName + "." + std::to_string(getpid());
+  {
+    std::ofstream stream(tmpFileName);
+    stream << store.dump(2);
+    if (!stream) {
+      xacc::warning("Could not write the parameter store " + m_fileName);
+      return false;
+    }
+  }
+  if (std::rename(tmpFileName.c_str(), m_fileName.c_str()) != 0) {
+    xacc::warning("Could not write the parameter store " + m_fileName);
+    std::remove(tmpFileName.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool ParameterStore::warmStart(const std::string &in_fingerprint,
+                               std::size_t in_nbParams,
+                               Optimizer &io_optimizer) const {
+  std::vector<double> params;
+  if (!lookup(in_fingerprint, in_nbParams, params)) {
+    return false;
+  }
+  xacc::info("Warm start from the parameter store " + m_fileName + " (" +
+             in_fingerprint + ").");
+  io_optimizer.appendOption("initial-parameters", params);
+  return true;
+}
+} // namespace xacc
@@ -0,0 +1,76 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_ALGORITHM_PARAMETERSTORE_HPP_
+#define XACC_ALGORITHM_PARAMETERSTORE_HPP_
+
+#include "Optimizer.hpp"
+#include "heterogeneous.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace xacc {
+
+// File-backed store of the optimal variational parameters of problem
+// families, keyed by a problem fingerprint (and the number of parameters),
+// e.g. to warm start QAOA on graphs of the same family or VQE on the next
+// bond length of a sweep. Options of the algorithms that use it:
+//   "parameter-store"        the JSON file (the store is off without it),
+//   "parameter-store-key"    a fingerprint replacing the algorithm's one,
+//   "parameter-store-update" "best": keep the lowest cost entry,
+//                            "latest": keep the last optimum.
+// The file can be shared by processes: an update holds an exclusive lock
+// (flock on <file>.lock) over its read-modify-write and replaces the file by
+// renaming a temporary one, so that readers never see a partial file.
+class ParameterStore {
+public:
+  enum class Update { Best, Latest };
+
+  ParameterStore(const std::string &in_fileName,
+                 Update in_update = Update::Best,
+                 const std::string &in_key = "");
+
+  // nullptr if there is no "parameter-store" option, in_defaultUpdate unless
+  // "parameter-store-update" is given.
+  static std::shared_ptr<ParameterStore>
+  fromParameters(const HeterogeneousMap &in_parameters,
+                 Update in_defaultUpdate);
+
+  // The "parameter-store-key" if any, in_fingerprint otherwise
+  std::string fingerprint(const std::string &in_fingerprint) const {
+    return m_key.empty() ? in_fingerprint : m_key;
+  }
+
+  // The stored parameters, false if there are none for that problem.
+  bool lookup(const std::string &in_fingerprint, std::size_t in_nbParams,
+              std::vector<double> &out_params) const;
+  // Records an optimum (cost as minimized by the optimizer), returns true if
+  // it replaced the stored entry.
+  bool record(const std::string &in_fingerprint,
+              const std::vector<double> &in_params, double in_cost);
+
+  // Sets the stored parameters (if any) as the "initial-parameters" of the
+  // optimizer, returns true if it did.
+  bool warmStart(const std::string &in_fingerprint, std::size_t in_nbParams,
+                 Optimizer &io_optimizer) const;
+
+  const std::string &fileName() const { return m_fileName; }
+
+private:
+  std::string m_fileName;
+  Update m_update;
+  std::string m_key;
+};
+} // namespace xacc
+#endif
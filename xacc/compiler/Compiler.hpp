@@ -13,7 +13,10 @@
 #ifndef XACC_COMPILER_HPP_
 #define XACC_COMPILER_HPP_
 
+#include <istream>
 #include <memory>
+#include <ostream>
+#include <sstream>
 #include "IR.hpp"
 #include "Accelerator.hpp"
 
@@ -30,6 +33,15 @@ public:
   virtual std::shared_ptr<IR> compile() {
     return compile("");
   }
+  // Compile the source read from the given stream, e.g. a file stream.
+  // By default, the whole source is read into memory then compiled. Compilers
+  // of large sources override this to process the statements incrementally.
+  virtual std::shared_ptr<IR>
+  compileStream(std::istream &src, std::shared_ptr<Accelerator> acc = nullptr) {
+    std::stringstream ss;
+    ss << src.rdbuf();
+    return compile(ss.str(), acc);
+  }
   virtual void setExtraOptions(const HeterogeneousMap options) {
       return;
   }
@@ -59,6 +71,13 @@ public:
     // default just call translate
     return translate(program,options);
   }
+  // Write the translation of the program to the given stream, e.g. a file or
+  // a socket stream. By default, the translated string is written. Compilers
+  // of large programs override this to emit the output incrementally.
+  virtual void translateStream(std::shared_ptr<CompositeInstruction> program,
+                               std::ostream &out) {
+    out << translate(program);
+  }
   virtual const std::shared_ptr<CompositeInstruction>
   compile(std::shared_ptr<CompositeInstruction> f,
           std::shared_ptr<Accelerator> acc) {
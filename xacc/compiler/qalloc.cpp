@@ -1,6 +1,7 @@
 #include "qalloc.hpp"
 #include "xacc.hpp"
 #include <algorithm>
+#include <atomic>
 
 namespace xacc {
 namespace internal_compiler {
@@ -19,21 +20,16 @@ void qreg::write_file(const std::string &file_name) {
   return;
 }
 
-std::string qreg::random_string(std::size_t length) {
-  auto randchar = []() -> char {
-    const char charset[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-                           "abcdefghijklmnopqrstuvwxyz";
-    const size_t max_index = (sizeof(charset) - 1);
-    return charset[rand() % max_index];
-  };
-  std::string str(length, 0);
-  std::generate_n(str.begin(), length, randchar);
-  return str;
+std::string qreg::unique_name() {
+  // Counter-based: no rand() call per register, and no collisions between
+  // the registers stored under these names.
+  static std::atomic<std::size_t> counter(0);
+  return "qrg_" + std::to_string(counter++);
 }
 
 qreg::qreg(const int n) {
   buffer = xacc::qalloc(n);
-  auto name = "qrg_" + random_string(5);
+  auto name = unique_name();
   xacc::storeBuffer(name, buffer);
   cReg classicalReg(buffer);
   creg = classicalReg;
@@ -51,7 +47,7 @@ qubit qreg::operator[](const std::size_t i) { return internal_qubits[i]; }
 
 qreg::qreg(std::vector<qubit> &qubits) {
   buffer = xacc::qalloc(qubits.size());
-  auto name = "qrg_" + random_string(5);
+  auto name = unique_name();
   xacc::storeBuffer(name, buffer);
   cReg classicalReg(buffer);
   creg = classicalReg;
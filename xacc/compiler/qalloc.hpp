@@ -50,7 +50,7 @@ private:
 class qreg {
 private:
   std::vector<qubit> internal_qubits;
-  std::string random_string(std::size_t length);
+  static std::string unique_name();
 
 protected:
   std::shared_ptr<AcceleratorBuffer> buffer;
@@ -7,7 +7,11 @@
 #include "xacc_service.hpp"
 #include "InstructionIterator.hpp"
 #include <CompositeInstruction.hpp>
+#include <functional>
+#include <mutex>
+#include <sstream>
 #include <stdlib.h>
+#include <unordered_map>
 
 namespace xacc {
 namespace internal_compiler {
@@ -165,31 +169,13 @@ void execute(AcceleratorBuffer *buffer,
   qpu->execute(xacc::as_shared_ptr(buffer), programs);
 }
 
-// Execute on the specified QPU, persisting results to
-// the provided buffer.
-void execute(AcceleratorBuffer *buffer,
-             std::shared_ptr<CompositeInstruction> program,
-             double *parameters) {
-
-  std::shared_ptr<CompositeInstruction> program_as_shared;
-  if (parameters) {
-    std::vector<double> values(parameters, parameters + program->nVariables());
-    program = program->operator()(values);
-  }
-  auto buffer_as_shared = std::shared_ptr<AcceleratorBuffer>(
-      buffer, xacc::empty_delete<AcceleratorBuffer>());
-
-  qpu->execute(buffer_as_shared, program);
-}
-
-void execute(AcceleratorBuffer **buffers, const int nBuffers,
-             std::shared_ptr<CompositeInstruction> program,
-             double *parameters) {
-
-  //  Should take vector of buffers, and we collapse them
-  //  into a single unified buffer for execution, then set the
-  //  measurement counts accordingly in postprocessing.
-
+namespace {
+// The buffers of a multi-register kernel: the given ones, then the unknown
+// (ancilla) registers found in the program, allocated here.
+std::vector<AcceleratorBuffer *>
+collectBuffers(AcceleratorBuffer **buffers, const int nBuffers,
+               std::shared_ptr<CompositeInstruction> program,
+               std::vector<std::shared_ptr<AcceleratorBuffer>> &extras) {
   std::vector<AcceleratorBuffer *> bvec(buffers, buffers + nBuffers);
   std::vector<std::string> buffer_names;
   for (auto &a : bvec)
@@ -197,7 +183,6 @@ void execute(AcceleratorBuffer **buffers, const int nBuffers,
 
   // Do we have any unknown ancilla bits?
   std::vector<std::string> possible_extra_buffers;
-  int possible_size = -1;
   InstructionIterator it(program);
   while (it.hasNext()) {
     auto &next = *it.next();
@@ -226,32 +211,26 @@ void execute(AcceleratorBuffer **buffers, const int nBuffers,
     extra->setName(possible_buffer);
     xacc::debug("[xacc_internal_compiler] Adding extra buffer " +
                 possible_buffer + " of size " + std::to_string(size));
+    extras.push_back(extra);
     bvec.push_back(extra.get());
   }
+  return bvec;
+}
 
-  // Merge the buffers. Keep track of buffer_name to shift in
-  // all bit indices operating on that buffer_name, a map of
-  // buffer names to the buffer ptr, and start a map to collect
-  // buffer names to measurement counts
+// Shifts the bit indices of the program (in place) onto the merged register
+// of the buffers, in order. Returns the register size and the measured bits.
+int mergeRegisters(const std::vector<AcceleratorBuffer *> &bvec,
+                   std::shared_ptr<CompositeInstruction> program,
+                   std::vector<std::size_t> &measure_idxs) {
+  // Keep track of buffer_name to shift in all bit indices operating on that
+  // buffer_name
   int global_reg_size = 0;
   std::map<std::string, int> shift_map;
-  std::vector<std::string> shift_map_names;
-  std::vector<int> shift_map_shifts;
-  std::map<std::string, AcceleratorBuffer *> buf_map;
-  std::map<std::string, std::map<std::string, int>> buf_counts;
   for (auto &b : bvec) {
     shift_map.insert({b->name(), global_reg_size});
-    shift_map_names.push_back(b->name());
-    shift_map_shifts.push_back(global_reg_size);
-    buf_map.insert({b->name(), b});
-    buf_counts.insert({b->name(), {}});
     global_reg_size += b->size();
   }
 
-  xacc::debug("[xacc_internal_compiler] Creating register of size " +
-              std::to_string(global_reg_size));
-  auto tmp = xacc::qalloc(global_reg_size);
-
   // Update Program bit indices based on new global
   // qubit register
   InstructionIterator iter(program);
@@ -274,7 +253,7 @@ void execute(AcceleratorBuffer **buffers, const int nBuffers,
     next.setBufferNames(unified_buf_names);
   }
 
-  std::vector<std::size_t> measure_idxs;
+  measure_idxs.clear();
   InstructionIterator iter2(program);
   while (iter2.hasNext()) {
     auto &next = *iter2.next();
@@ -282,21 +261,23 @@ void execute(AcceleratorBuffer **buffers, const int nBuffers,
       measure_idxs.push_back(next.bits()[0]);
     }
   }
+  return global_reg_size;
+}
 
-  // Now execute using the global merged register
-  execute(tmp.get(), program, parameters);
-
-  // Take bit strings and map to buffer individual bit strings
-  for (auto &kv : tmp->getMeasurementCounts()) {
+// Distributes the bit strings measured on the merged register to the buffers
+void splitCounts(AcceleratorBuffer *merged,
+                 const std::vector<AcceleratorBuffer *> &bvec,
+                 const std::vector<std::size_t> &measure_idxs,
+                 Accelerator::BitOrder bitOrder) {
+  const int global_reg_size = merged->size();
+  std::vector<std::map<std::string, int>> buf_counts(bvec.size());
+  for (auto &kv : merged->getMeasurementCounts()) {
     auto bitstring = kv.first;
 
     // Some backends return bitstring of size = number of measures
     // instead of size = global_reg_size, adjust if so
     if (bitstring.size() == measure_idxs.size()) {
-      std::string tmps = "";
-      for (int j = 0; j < global_reg_size; j++)
-        tmps += "0";
-
+      std::string tmps(global_reg_size, '0');
       for (int j = 0; j < measure_idxs.size(); j++) {
         tmps[measure_idxs[j]] = bitstring[j];
       }
@@ -305,36 +286,193 @@ void execute(AcceleratorBuffer **buffers, const int nBuffers,
     }
 
     // The following processing the bit string assuming LSB
-    if (qpu->getBitOrder() == Accelerator::BitOrder::MSB) {
+    if (bitOrder == Accelerator::BitOrder::MSB) {
       std::reverse(bitstring.begin(), bitstring.end());
     }
 
-    for (int j = 0; j < shift_map_names.size(); j++) {
-
-      auto shift = shift_map_shifts[j];
-      auto buff_name = shift_map_names[j];
-      auto buffer = buf_map[buff_name];
-
-      auto buffer_bitstring = bitstring.substr(shift, buffer->size());
+    int shift = 0;
+    for (int j = 0; j < bvec.size(); j++) {
+      auto buffer_bitstring = bitstring.substr(shift, bvec[j]->size());
+      shift += bvec[j]->size();
 
-      if (qpu->getBitOrder() == Accelerator::BitOrder::MSB) {
+      if (bitOrder == Accelerator::BitOrder::MSB) {
         std::reverse(buffer_bitstring.begin(), buffer_bitstring.end());
       }
+      buf_counts[j][buffer_bitstring] += kv.second;
+    }
+  }
 
-      if (buf_counts[buff_name].count(buffer_bitstring)) {
-        buf_counts[buff_name][buffer_bitstring] += kv.second;
-      } else {
-        buf_counts[buff_name].insert({buffer_bitstring, kv.second});
-      }
+  for (int j = 0; j < bvec.size(); j++) {
+    bvec[j]->setMeasurements(buf_counts[j]);
+    bvec[j]->addExtraInfo("endianness", bitOrder == Accelerator::BitOrder::LSB
+                                            ? "lsb"
+                                            : "msb");
+  }
+}
+
+void executeOn(std::shared_ptr<Accelerator> accelerator,
+               AcceleratorBuffer *buffer,
+               std::shared_ptr<CompositeInstruction> program,
+               double *parameters) {
+  if (parameters) {
+    std::vector<double> values(parameters, parameters + program->nVariables());
+    program = program->operator()(values);
+  }
+  auto buffer_as_shared = std::shared_ptr<AcceleratorBuffer>(
+      buffer, xacc::empty_delete<AcceleratorBuffer>());
+
+  accelerator->execute(buffer_as_shared, program);
+}
+
+// Prepared kernels by compiler, options, source and QPU
+std::mutex prepared_kernels_mutex;
+std::unordered_map<std::string, std::shared_ptr<PreparedKernel>>
+    prepared_kernels;
+
+std::shared_ptr<PreparedKernel>
+findPrepared(const std::string &key,
+             std::function<std::shared_ptr<CompositeInstruction>()> compile,
+             bool do_optimize, bool do_placement, const OptLevel opt) {
+  {
+    std::lock_guard<std::mutex> lock(prepared_kernels_mutex);
+    auto iter = prepared_kernels.find(key);
+    if (iter != prepared_kernels.end()) {
+      return iter->second;
     }
   }
 
-  for (auto &b : bvec) {
-    b->setMeasurements(buf_counts[b->name()]);
-    b->addExtraInfo("endianness",
-                    qpu->getBitOrder() == Accelerator::BitOrder::LSB ? "lsb"
-                                                                     : "msb");
+  auto program = compile();
+  if (!program) {
+    return nullptr;
+  }
+  if (do_optimize) {
+    optimize(program, opt);
+  }
+  if (do_placement && !qpu->getConnectivity().empty()) {
+    auto placement =
+        xacc::getIRTransformation(qpu->defaultPlacementTransformation());
+    placement->apply(program, qpu);
+  }
+  auto kernel = std::make_shared<PreparedKernel>();
+  kernel->program = program;
+  kernel->accelerator = qpu;
+
+  std::lock_guard<std::mutex> lock(prepared_kernels_mutex);
+  return prepared_kernels.emplace(key, kernel).first->second;
+}
+
+std::string preparedKey(const std::string &in_kernel, bool do_optimize,
+                        bool do_placement, const OptLevel opt) {
+  if (!qpu) {
+    xacc::error("[InternalCompiler] No QPU to prepare a kernel for, call "
+                "setAccelerator first.");
   }
+  std::stringstream ss;
+  ss << qpu.get() << ':' << qpu->getSignature() << ':' << do_optimize << ':'
+     << do_placement << ':' << opt << ':' << in_kernel;
+  return ss.str();
+}
+} // namespace
+
+// Execute on the specified QPU, persisting results to
+// the provided buffer.
+void execute(AcceleratorBuffer *buffer,
+             std::shared_ptr<CompositeInstruction> program,
+             double *parameters) {
+  executeOn(qpu, buffer, program, parameters);
+}
+
+void execute(AcceleratorBuffer **buffers, const int nBuffers,
+             std::shared_ptr<CompositeInstruction> program,
+             double *parameters) {
+
+  //  Should take vector of buffers, and we collapse them
+  //  into a single unified buffer for execution, then set the
+  //  measurement counts accordingly in postprocessing.
+  std::vector<std::shared_ptr<AcceleratorBuffer>> extras;
+  auto bvec = collectBuffers(buffers, nBuffers, program, extras);
+
+  std::vector<std::size_t> measure_idxs;
+  const int global_reg_size = mergeRegisters(bvec, program, measure_idxs);
+  xacc::debug("[xacc_internal_compiler] Creating register of size " +
+              std::to_string(global_reg_size));
+  auto tmp = xacc::qalloc(global_reg_size);
+
+  // Now execute using the global merged register
+  execute(tmp.get(), program, parameters);
+
+  // Take bit strings and map to buffer individual bit strings
+  splitCounts(tmp.get(), bvec, measure_idxs, qpu->getBitOrder());
+}
+
+std::shared_ptr<PreparedKernel> prepare(const char *compiler_name,
+                                        const char *kernel_src,
+                                        bool do_optimize, bool do_placement,
+                                        const OptLevel opt) {
+  const auto key =
+      preparedKey(std::string("src:") + compiler_name + '\0' + kernel_src,
+                  do_optimize, do_placement, opt);
+  return findPrepared(
+      key, [&]() { return compile(compiler_name, kernel_src); }, do_optimize,
+      do_placement, opt);
+}
+
+std::shared_ptr<PreparedKernel> getPrepared(const char *kernel_name) {
+  // Compiled kernels are prepared as they are (no further passes)
+  const auto key = preparedKey(std::string("name:") + kernel_name, false,
+                               false, DEFAULT);
+  return findPrepared(
+      key, [&]() { return getCompiled(kernel_name); }, false, false, DEFAULT);
+}
+
+void clearPreparedKernels() {
+  std::lock_guard<std::mutex> lock(prepared_kernels_mutex);
+  prepared_kernels.clear();
+}
+
+void execute(AcceleratorBuffer *buffer, PreparedKernel &kernel,
+             double *parameters) {
+  executeOn(kernel.accelerator, buffer, kernel.program, parameters);
+}
+
+void execute(AcceleratorBuffer **buffers, const int nBuffers,
+             PreparedKernel &kernel, double *parameters) {
+  bool sameRegisters = kernel.mergedProgram &&
+                       nBuffers + kernel.extraBuffers.size() ==
+                           kernel.bufferNames.size();
+  for (int i = 0; sameRegisters && i < nBuffers; i++) {
+    sameRegisters = buffers[i]->name() == kernel.bufferNames[i] &&
+                    buffers[i]->size() == kernel.bufferSizes[i];
+  }
+
+  std::vector<AcceleratorBuffer *> bvec(buffers, buffers + nBuffers);
+  if (sameRegisters) {
+    for (auto &extra : kernel.extraBuffers) {
+      bvec.push_back(extra.get());
+    }
+    kernel.mergedRegister->resetBuffer();
+  } else {
+    // Merge a copy, the kernel program stays on its own registers
+    kernel.mergedProgram = std::dynamic_pointer_cast<CompositeInstruction>(
+        kernel.program->clone());
+    kernel.extraBuffers.clear();
+    bvec = collectBuffers(buffers, nBuffers, kernel.mergedProgram,
+                          kernel.extraBuffers);
+    const int global_reg_size =
+        mergeRegisters(bvec, kernel.mergedProgram, kernel.measureIdxs);
+    kernel.mergedRegister = xacc::qalloc(global_reg_size);
+    kernel.bufferNames.clear();
+    kernel.bufferSizes.clear();
+    for (auto &b : bvec) {
+      kernel.bufferNames.push_back(b->name());
+      kernel.bufferSizes.push_back(b->size());
+    }
+  }
+
+  executeOn(kernel.accelerator, kernel.mergedRegister.get(),
+            kernel.mergedProgram, parameters);
+  splitCounts(kernel.mergedRegister.get(), bvec, kernel.measureIdxs,
+              kernel.accelerator->getBitOrder());
 }
 
 } // namespace internal_compiler
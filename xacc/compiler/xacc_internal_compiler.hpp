@@ -13,8 +13,9 @@
 #ifndef XACC_XACC_INTERNAL_COMPILER_HPP_
 #define XACC_XACC_INTERNAL_COMPILER_HPP_
 
-#include <vector>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace xacc {
 class CompositeInstruction;
@@ -60,6 +61,43 @@ void execute(AcceleratorBuffer *buffer,
 void execute(AcceleratorBuffer **buffers, const int nBuffers,
              std::shared_ptr<CompositeInstruction> program,
              double *parameters = nullptr);
+
+// A kernel prepared once for repeated invocations from host code, e.g. a
+// small kernel called in a tight loop: compiled, optionally optimized and
+// placed, with the accelerator it is executed on resolved. Executing it
+// skips the compilation, the optimization / placement passes and the backend
+// resolution, and multi-register invocations reuse the merged program and
+// register of the previous call with the same registers.
+struct PreparedKernel {
+  std::shared_ptr<CompositeInstruction> program;
+  std::shared_ptr<Accelerator> accelerator;
+
+  // Multi-register execution: the program on the merged register, for the
+  // register names and sizes it was merged for (extra registers last).
+  std::vector<std::string> bufferNames;
+  std::vector<int> bufferSizes;
+  std::shared_ptr<CompositeInstruction> mergedProgram;
+  std::shared_ptr<AcceleratorBuffer> mergedRegister;
+  std::vector<std::shared_ptr<AcceleratorBuffer>> extraBuffers;
+  std::vector<std::size_t> measureIdxs;
+};
+
+// Compiles kernel_src for the current QPU, or returns the kernel prepared
+// by a previous call with the same source, options and QPU.
+std::shared_ptr<PreparedKernel> prepare(const char *compiler_name,
+                                        const char *kernel_src,
+                                        bool do_optimize = false,
+                                        bool do_placement = false,
+                                        const OptLevel opt = DEFAULT);
+// The compiled kernel of that name prepared for the current QPU (nullptr if
+// it was not compiled).
+std::shared_ptr<PreparedKernel> getPrepared(const char *kernel_name);
+void clearPreparedKernels();
+
+void execute(AcceleratorBuffer *buffer, PreparedKernel &kernel,
+             double *parameters = nullptr);
+void execute(AcceleratorBuffer **buffers, const int nBuffers,
+             PreparedKernel &kernel, double *parameters = nullptr);
 } // namespace internal_compiler
 } // namespace xacc
 
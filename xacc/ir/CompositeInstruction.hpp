@@ -13,6 +13,7 @@
 #ifndef XACC_IR_CompositeInstruction_HPP_
 #define XACC_IR_CompositeInstruction_HPP_
 
+#include <algorithm>
 #include <vector>
 #include <complex>
 #include <set>
@@ -25,6 +26,64 @@ namespace xacc {
 
 using InstPtr = std::shared_ptr<Instruction>;
 
+// Non-owning, contiguous view of Instructions.
+class InstructionSpan {
+public:
+  using iterator = Instruction *const *;
+  InstructionSpan() = default;
+  InstructionSpan(iterator first, iterator last) : m_first(first), m_last(last) {}
+  iterator begin() const { return m_first; }
+  iterator end() const { return m_last; }
+  std::size_t size() const { return m_last - m_first; }
+  bool empty() const { return m_first == m_last; }
+  Instruction *operator[](std::size_t idx) const { return m_first[idx]; }
+
+private:
+  iterator m_first = nullptr;
+  iterator m_last = nullptr;
+};
+
+// Gates scheduled as soon as possible, layer by layer.
+using InstructionLayers = std::vector<std::vector<Instruction *>>;
+
+// Incremental as-soon-as-possible layering: each enabled gate goes to the
+// layer after the last one holding any of its bits, i.e. a single sweep over
+// the per-bit frontiers. Composite nodes (their gates being listed after them,
+// e.g. in a flatView()) and disabled instructions are skipped.
+class InstructionLayering {
+public:
+  void add(Instruction *in_inst) {
+    if (in_inst->isComposite() || !in_inst->isEnabled()) {
+      return;
+    }
+    const auto bits = in_inst->bits();
+    std::size_t layer = 0;
+    for (const auto bit : bits) {
+      if (bit >= m_frontier.size()) {
+        m_frontier.resize(bit + 1, 0);
+      }
+      layer = std::max(layer, m_frontier[bit]);
+    }
+    for (const auto bit : bits) {
+      m_frontier[bit] = layer + 1;
+    }
+    if (layer >= m_layers.size()) {
+      m_layers.resize(layer + 1);
+    }
+    m_layers[layer].emplace_back(in_inst);
+  }
+  void clear() {
+    m_frontier.clear();
+    m_layers.clear();
+  }
+  const InstructionLayers &layers() const { return m_layers; }
+
+private:
+  // Next free layer of each bit
+  std::vector<std::size_t> m_frontier;
+  InstructionLayers m_layers;
+};
+
 // CompositeInstructions are Instructions that contain further Instructions
 // (which of course can be other CompositeInstructions). This forms the familiar
 // tree, or composite pattern, where nodes are CompositeInstructions and leaves
@@ -100,6 +159,44 @@ protected:
     _internal_counter = 0;
   }
 
+  // Flattened tree: the nodes (pre-order) and the
+  // references keeping them alive (all but the root).
+  struct FlatTree {
+    std::vector<Instruction *> nodes;
+    std::vector<InstPtr> owners;
+  };
+  FlatTree flatTree;
+
+  // Storage of the default layers() implementation
+  InstructionLayering layering;
+
+  // Storage of the default getInstructionsView() implementation
+  std::vector<InstPtr> instructionsView;
+
+  void buildFlatTree(FlatTree &io_tree) {
+    io_tree.nodes.clear();
+    io_tree.owners.clear();
+    io_tree.nodes.emplace_back(this);
+    // (composite, next child index)
+    std::vector<std::pair<CompositeInstruction *, int>> pending{{this, 0}};
+    while (!pending.empty()) {
+      auto composite = pending.back().first;
+      const int idx = pending.back().second++;
+      if (idx >= composite->nInstructions()) {
+        pending.pop_back();
+        continue;
+      }
+      auto child = composite->getInstruction(idx);
+      io_tree.nodes.emplace_back(child.get());
+      if (child->isComposite()) {
+        if (auto nested = dynamic_cast<CompositeInstruction *>(child.get())) {
+          pending.emplace_back(nested, 0);
+        }
+      }
+      io_tree.owners.emplace_back(std::move(child));
+    }
+  }
+
   void countArgs() {}
   template <typename First, typename... Rest>
   void countArgs(First firstArg, Rest... rest) {
@@ -167,7 +264,24 @@ public:
   virtual void setName(const std::string name) = 0;
 
   virtual InstPtr getInstruction(const std::size_t idx) = 0;
+  // The nodes of this tree, in the InstructionIterator (pre-order) sequence,
+  // stored contiguously: traversing it involves no reference counting.
+  // The view (and the nodes it references) stays valid until the next call,
+  // which rebuilds it; implementations that can track changes to the tree
+  // should only rebuild it when needed.
+  virtual InstructionSpan flatView() {
+    buildFlatTree(flatTree);
+    return InstructionSpan(flatTree.nodes.data(),
+                           flatTree.nodes.data() + flatTree.nodes.size());
+  }
   virtual std::vector<InstPtr> getInstructions() = 0;
+  // The direct children, without copying them: prefer over getInstructions()
+  // when only reading them. The reference is invalidated by any change to the
+  // children of this CompositeInstruction.
+  virtual const std::vector<InstPtr> &getInstructionsView() {
+    instructionsView = getInstructions();
+    return instructionsView;
+  }
   virtual void removeInstruction(const std::size_t idx) = 0;
   virtual void replaceInstruction(const std::size_t idx, InstPtr newInst) = 0;
   virtual void insertInstruction(const std::size_t idx, InstPtr newInst) = 0;
@@ -195,6 +309,15 @@ public:
   virtual const std::size_t nVariables() = 0;
 
   virtual const int depth() = 0;
+  // The enabled gates of this tree, in flatView() order, as soon as possible
+  // layers. The view stays valid until the next call or change to the tree.
+  virtual const InstructionLayers &layers() {
+    layering.clear();
+    for (auto *inst : flatView()) {
+      layering.add(inst);
+    }
+    return layering.layers();
+  }
   virtual const std::string persistGraph() = 0;
   virtual std::shared_ptr<Graph> toGraph() = 0;
 
@@ -223,10 +346,10 @@ public:
 
 template CompositeInstruction *
 HeterogeneousMap::getPointerLike<CompositeInstruction>(
-    const std::string key) const;
+    const std::string &key) const;
 template bool
 HeterogeneousMap::pointerLikeExists<CompositeInstruction>(
-    const std::string key) const;
+    const std::string &key) const;
 
 } // namespace xacc
 #endif
@@ -17,10 +17,44 @@
 #include "Cloneable.hpp"
 #include "InstructionVisitor.hpp"
 #include "heterogeneous.hpp"
+#include "StructuralHasher.hpp"
 
 namespace xacc {
 using InstructionParameter = Variant<int, double, std::string>;
 
+// Compact identifier of the common gates, for switch dispatch without
+// comparing (or copying) the instruction names in hot loops.
+// Unknown for any other instruction, e.g. composites or pulses.
+enum class GateOpcode : uint8_t {
+  Unknown,
+  I,
+  H,
+  X,
+  Y,
+  Z,
+  S,
+  Sdg,
+  T,
+  Tdg,
+  Rx,
+  Ry,
+  Rz,
+  U1,
+  U,
+  CNOT,
+  CY,
+  CZ,
+  CH,
+  CRZ,
+  CPhase,
+  Swap,
+  iSwap,
+  fSim,
+  XY,
+  Measure,
+  Reset
+};
+
 // Util func to get a double parameter from an InstructionParameter variant.
 // Note: most of the cases, we have double-type parameters (e.g. rotation
 // angles). This also handles int->double and string->double conversion if
@@ -60,6 +94,38 @@ InstructionParameterToDouble(const xacc::InstructionParameter &in_parameter) {
   return 0.0;
 }
 
+// How instruction parameters contribute to a structural hash.
+enum class ParameterHashMode {
+  // Bound numeric values (exact) and symbolic parameters by expression.
+  Numeric,
+  // Circuit template: all numeric values hash the same, symbolic parameters
+  // by expression.
+  Symbolic
+};
+
+static void hashInstructionParameter(StructuralHasher &io_hasher,
+                                     const InstructionParameter &in_parameter,
+                                     ParameterHashMode in_mode) {
+  bool isNumeric = in_parameter.which() != 2;
+  if (!isNumeric) {
+    // Numeric strings are bound values too.
+    const auto &str = in_parameter.as<std::string>();
+    char *end = nullptr;
+    strtod(str.c_str(), &end);
+    isNumeric = (end != str.c_str()) && (*end == '\0');
+    if (!isNumeric) {
+      io_hasher.add<char>('s');
+      io_hasher.add(str);
+      return;
+    }
+  }
+  io_hasher.add<char>('n');
+  if (in_mode == ParameterHashMode::Numeric) {
+    // + 0.0: -0.0 and 0.0 hash the same.
+    io_hasher.add<double>(InstructionParameterToDouble(in_parameter) + 0.0);
+  }
+}
+
 class CompositeInstruction;
 
 class CompositeArgument {
@@ -189,6 +255,24 @@ public:
   }
 
   virtual const bool isAnalog() const { return false; }
+  // The name of the common gates, as an opcode
+  virtual GateOpcode opcode() const { return GateOpcode::Unknown; }
+
+  // Stable fingerprint of the instruction (name, bits, parameters), e.g.
+  // for caching or deduplicating circuits. Equal instructions have equal
+  // hashes, see IRUtils structurallyEqual for an exact comparison.
+  virtual uint64_t
+  structuralHash(ParameterHashMode mode = ParameterHashMode::Numeric) {
+    StructuralHasher hasher;
+    hasher.add(name());
+    for (const auto &bit : bits()) {
+      hasher.add<uint64_t>(bit);
+    }
+    for (const auto &param : getParameters()) {
+      hashInstructionParameter(hasher, param, mode);
+    }
+    return hasher.value();
+  }
   virtual const int nRequiredBits() const = 0;
 
   virtual ~Instruction() {}
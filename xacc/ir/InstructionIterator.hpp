@@ -12,7 +12,7 @@
  *******************************************************************************/
 #ifndef XACC_COMPILER_INSTRUCTIONITERATOR_HPP_
 #define XACC_COMPILER_INSTRUCTIONITERATOR_HPP_
-#include <stack>
+#include <vector>
 #include "CompositeInstruction.hpp"
 
 namespace xacc {
@@ -32,7 +32,7 @@ protected:
   /**
    * A stack used to implement the tree traversal
    */
-  std::stack<std::shared_ptr<Instruction>> instStack;
+  std::vector<std::shared_ptr<Instruction>> instStack;
 
 public:
   /**
@@ -42,7 +42,7 @@ public:
    * @param r
    */
   InstructionIterator(std::shared_ptr<Instruction> r) : root(r) {
-    instStack.push(root);
+    instStack.push_back(root);
   }
 
   /**
@@ -56,12 +56,14 @@ public:
    * @return
    */
   std::shared_ptr<Instruction> next() {
-    std::shared_ptr<Instruction> next = instStack.top();
-    instStack.pop();
-    auto f = std::dynamic_pointer_cast<CompositeInstruction>(next);
-    if (f) {
-      for (int i = f->nInstructions() - 1; i >= 0; i--) {
-        instStack.push(f->getInstruction(i));
+    std::shared_ptr<Instruction> next = std::move(instStack.back());
+    instStack.pop_back();
+    if (next->isComposite()) {
+      auto f = dynamic_cast<CompositeInstruction *>(next.get());
+      if (f) {
+        for (int i = f->nInstructions() - 1; i >= 0; i--) {
+          instStack.emplace_back(f->getInstruction(i));
+        }
       }
     }
     return next;
@@ -80,9 +80,9 @@ public:
 };
 
 template Observable *
-HeterogeneousMap::getPointerLike<Observable>(const std::string key) const;
+HeterogeneousMap::getPointerLike<Observable>(const std::string &key) const;
 template bool
-HeterogeneousMap::pointerLikeExists<Observable>(const std::string key) const;
+HeterogeneousMap::pointerLikeExists<Observable>(const std::string &key) const;
 
 } // namespace xacc
 #endif
\ No newline at end of file
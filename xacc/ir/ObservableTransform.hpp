@@ -19,6 +19,11 @@ class ObservableTransform : public Identifiable {
 public:
   virtual std::shared_ptr<Observable>
   transform(std::shared_ptr<Observable> obs) = 0;
+  // Transform with transform-specific options (ignored by default)
+  virtual std::shared_ptr<Observable>
+  transform(std::shared_ptr<Observable> obs, const HeterogeneousMap &options) {
+    return transform(obs);
+  }
 };
 
 } // namespace xacc
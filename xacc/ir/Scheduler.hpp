@@ -21,6 +21,11 @@ namespace xacc {
 class Scheduler : public Identifiable {
 public:
   virtual void schedule(std::shared_ptr<CompositeInstruction> program) = 0;
+  // Scheduling with implementation-specific options, ignored by default.
+  virtual void schedule(std::shared_ptr<CompositeInstruction> program,
+                        const HeterogeneousMap &options) {
+    schedule(program);
+  }
 };
 
 }
@@ -28,6 +28,14 @@ using OptimizerFunctorNoGrad =
     std::function<double(const std::vector<double> &)>;
 using OptimizerFunctor =
     std::function<double(const std::vector<double> &, std::vector<double> &)>;
+// Objective estimated with a number of shots: returns the estimate and sets
+// the variance of a single shot (negative if unknown).
+using OptimizerFunctorShots =
+    std::function<double(const std::vector<double> &, int, double &)>;
+// Objective at a population of points at once (no gradients), e.g. a
+// generation of a population-based optimizer submitted as one batch.
+using OptimizerFunctorBatch = std::function<std::vector<double>(
+    const std::vector<std::vector<double>> &)>;
 using OptResult = std::pair<double, std::vector<double>>;
 
 using OptFunctionPtr = double (*)(const std::vector<double> &,
@@ -35,6 +43,8 @@ using OptFunctionPtr = double (*)(const std::vector<double> &,
 class OptFunction {
 protected:
   OptimizerFunctor _function;
+  OptimizerFunctorShots _shotsFunction;
+  OptimizerFunctorBatch _batchFunction;
   int _dim = 0;
 
 public:
@@ -48,12 +58,19 @@ public:
           return f(x);
         }),
         _dim(d) {}
+  // With an estimator at a given number of shots, for the shot-adaptive
+  // optimizers (e.g. "icans").
+  OptFunction(OptimizerFunctor f, OptimizerFunctorShots fShots, const int d)
+      : _function(f), _shotsFunction(fShots), _dim(d) {}
   // OptFunction(OptimizerFunctorNoGradValue f, const int d)
   //     : _function([&](const std::vector<double> &x, std::vector<double> &) {
   //         return f(x);
   //       }),
   //       _dim(d) {}
   virtual const int dimensions() const { return _dim; }
+  // The value at x, and the gradient in dx if it has dimensions() entries.
+  // An empty dx asks for the value only, the objective can then skip the
+  // gradient computation (e.g. VQE does not run the gradient circuits).
   virtual double operator()(const std::vector<double> &x,
                             std::vector<double> &dx) {
     return _function(x, dx);
@@ -62,6 +79,36 @@ public:
     std::vector<double> dx;
     return _function(x, dx);
   }
+  virtual bool acceptsShots() const { return (bool)_shotsFunction; }
+  // The estimate with in_shots shots, the exact value (and a negative
+  // variance) if there is no shots estimator.
+  virtual double operator()(const std::vector<double> &x, const int in_shots,
+                            double &out_variance) {
+    if (_shotsFunction) {
+      return _shotsFunction(x, in_shots, out_variance);
+    }
+    out_variance = -1.0;
+    std::vector<double> dx;
+    return _function(x, dx);
+  }
+  // Evaluates all the points at once if a batch function was set.
+  void setBatchFunction(OptimizerFunctorBatch fBatch) {
+    _batchFunction = fBatch;
+  }
+  virtual bool acceptsBatches() const { return (bool)_batchFunction; }
+  // The objective at each of xs (one by one without a batch function).
+  virtual std::vector<double>
+  evaluate(const std::vector<std::vector<double>> &xs) {
+    if (_batchFunction) {
+      return _batchFunction(xs);
+    }
+    std::vector<double> values;
+    std::vector<double> dx;
+    for (auto &x : xs) {
+      values.push_back(operator()(x, dx));
+    }
+    return values;
+  }
 };
 
 class Optimizer : public xacc::Identifiable {
@@ -25,6 +25,8 @@ namespace xacc {
 class MLPACKFunction {
 protected:
   std::vector<double> grad;
+  // The point grad was computed at
+  std::vector<double> gradX;
   OptFunction &opt_function;
 
 public:
@@ -34,10 +36,12 @@ public:
   void Shuffle() { /* Nothing to do here */
   }
 
-  // Given parameters x, return the value of f(x).
+  // Given parameters x, return the value of f(x). The value only (empty
+  // gradient), e.g. the line-search probes do not run gradient circuits.
   double Evaluate(const arma::mat &x) {
     auto x_vec = arma::conv_to<std::vector<double>>::from(x);
-    return opt_function(x_vec, grad);
+    std::vector<double> noGrad;
+    return opt_function(x_vec, noGrad);
   }
 
   double Evaluate(const arma::mat &coordinates, const size_t begin,
@@ -46,21 +50,25 @@ public:
   }
   double EvaluateWithGradient(const arma::mat &coordinates,
                               arma::mat &gradient) {
-    auto val = Evaluate(coordinates);
-    Gradient(coordinates, gradient);
+    gradX = arma::conv_to<std::vector<double>>::from(coordinates);
+    grad.assign(opt_function.dimensions(), 0.0);
+    auto val = opt_function(gradX, grad);
+    gradient = arma::mat(grad);
     return val;
   }
   double EvaluateWithGradient(const arma::mat &coordinates, std::size_t bb,
                               arma::mat &gradient, std::size_t b) {
-    auto val = Evaluate(coordinates);
-    Gradient(coordinates, gradient);
-    return val;
+    return EvaluateWithGradient(coordinates, gradient);
   }
   // Given parameters x and a matrix g, store f'(x) in the provided matrix g.
-  // g should have the same size (rows, columns) as x.
+  // g should have the same size (rows, columns) as x. Reuses the last
+  // gradient if it was computed at x.
   void Gradient(const arma::mat &x, arma::mat &gradient) {
-    arma::mat g(grad);
-    gradient = g;
+    if (arma::conv_to<std::vector<double>>::from(x) != gradX) {
+      EvaluateWithGradient(x, gradient);
+      return;
+    }
+    gradient = arma::mat(grad);
   }
 };
 
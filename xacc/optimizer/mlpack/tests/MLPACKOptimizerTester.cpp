@@ -77,6 +77,34 @@ TEST(NLOptimizerTester, checkGradientRosenbrock) {
   EXPECT_NEAR(result.second[1], 1.0, 1e-4);
 
 }
+TEST(MLPACKOptimizerTester, checkValueOnlyEvaluations) {
+  auto optimizer = xacc::getService<Optimizer>("mlpack");
+  // Points the gradient was requested at
+  std::vector<std::vector<double>> gradientPoints;
+  OptFunction f(
+      [&](const std::vector<double> &x, std::vector<double> &grad) {
+        if (!grad.empty()) {
+          EXPECT_EQ(2, grad.size());
+          gradientPoints.push_back(x);
+          grad[0] = -2 * (1 - x[0]) + 400 * (std::pow(x[0], 3) - x[1] * x[0]);
+          grad[1] = 200 * (x[1] - std::pow(x[0], 2));
+        }
+        return 100 * std::pow(x[1] - std::pow(x[0], 2), 2) +
+               std::pow(1 - x[0], 2);
+      },
+      2);
+  optimizer->setOptions(
+      HeterogeneousMap{std::make_pair("mlpack-optimizer", "l-bfgs")});
+  auto result = optimizer->optimize(f);
+  EXPECT_NEAR(result.first, 0.0, 1e-4);
+  EXPECT_NEAR(result.second[0], 1.0, 1e-4);
+  EXPECT_NEAR(result.second[1], 1.0, 1e-4);
+  // A gradient is computed at most once per point
+  for (int i = 1; i < gradientPoints.size(); i++) {
+    EXPECT_NE(gradientPoints[i - 1], gradientPoints[i]);
+  }
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize(argc, argv);
   ::testing::InitGoogleTest(&argc, argv);
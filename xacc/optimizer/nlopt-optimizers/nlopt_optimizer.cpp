@@ -14,6 +14,8 @@
 #include "nlopt.hpp"
 
 #include "xacc.hpp"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 using namespace std::placeholders;
 
@@ -24,6 +26,14 @@ namespace xacc {
 double c_wrapper(const std::vector<double> &x, std::vector<double> &grad,
                  void *extra) {
   auto e = reinterpret_cast<ExtraNLOptData *>(extra);
+  if (grad.empty() && !e->prefetched.empty()) {
+    auto iter = e->prefetched.find(x);
+    if (iter != e->prefetched.end()) {
+      const double value = iter->second;
+      e->prefetched.erase(iter);
+      return value;
+    }
+  }
   return e->f(x, grad);
 }
 
@@ -166,6 +176,45 @@ OptResult NLOptimizer::optimize(OptFunction &function) {
                 std::to_string(dim) +
                 ", param_size == " + std::to_string(x.size()));
   }
+  // Nelder-Mead starts by evaluating x and its dim neighbours x + dx_i (as
+  // nldrmd builds the initial simplex), submit them as one batch.
+  if (algo == nlopt::algorithm::LN_NELDERMEAD && function.acceptsBatches() &&
+      dim > 0) {
+    for (int i = 0; i < dim; i++) {
+      x[i] = std::min(upperBounds[i], std::max(lowerBounds[i], x[i]));
+    }
+    std::vector<double> dx(dim);
+    _opt.get_initial_step(x, dx);
+    std::vector<std::vector<double>> simplex{x};
+    for (int i = 0; i < dim; i++) {
+      auto pt = x;
+      const double step = std::fabs(dx[i]);
+      pt[i] += dx[i];
+      if (pt[i] > upperBounds[i]) {
+        pt[i] = upperBounds[i] - x[i] > step * 0.1 ? upperBounds[i]
+                                                   : x[i] - step;
+      }
+      if (pt[i] < lowerBounds[i]) {
+        if (x[i] - lowerBounds[i] > step * 0.1) {
+          pt[i] = lowerBounds[i];
+        } else {
+          pt[i] = x[i] + step;
+          if (pt[i] > upperBounds[i]) {
+            pt[i] = 0.5 * ((upperBounds[i] - x[i] > x[i] - lowerBounds[i]
+                                ? upperBounds[i]
+                                : lowerBounds[i]) +
+                           x[i]);
+          }
+        }
+      }
+      simplex.emplace_back(pt);
+    }
+    const auto values = function.evaluate(simplex);
+    for (int i = 0; i < simplex.size(); i++) {
+      data.prefetched.emplace(simplex[i], values[i]);
+    }
+  }
+
   double optF;
   nlopt::result r;
   try {
@@ -13,20 +13,33 @@
 #ifndef XACC_NLOPT_OPTIMIZER_HPP_
 #define XACC_NLOPT_OPTIMIZER_HPP_
 
+#include <map>
 #include <type_traits>
 #include <utility>
 
+#include "Cloneable.hpp"
 #include "Optimizer.hpp"
 
 namespace xacc {
 
 struct ExtraNLOptData {
     std::function<double(const std::vector<double>&, std::vector<double>&)> f;
+    // Values evaluated ahead in one batch (the initial Nelder-Mead simplex),
+    // used once when the optimizer asks for them.
+    std::map<std::vector<double>, double> prefetched;
 };
 
-class NLOptimizer : public Optimizer {
+// getOptimizer() returns a shared instance, clone() gives an independent one
+// (with a copy of the options), e.g. for concurrent optimizations.
+class NLOptimizer : public Optimizer, public Cloneable<Optimizer> {
 public:
   OptResult optimize(OptFunction &function) override;
+  std::shared_ptr<Optimizer> clone() override {
+    auto copy = std::make_shared<NLOptimizer>();
+    copy->setOptions(options);
+    return copy;
+  }
+  bool shouldClone() override { return false; }
   const bool isGradientBased() const override;
   virtual const std::string get_algorithm() const;
 
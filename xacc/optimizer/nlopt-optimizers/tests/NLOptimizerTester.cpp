@@ -85,6 +85,62 @@ TEST(NLOptimizerTester, checkGradientRosenbrock) {
   EXPECT_NEAR(result.second[1], 1.0, 1e-4);
 
 }
+
+TEST(NLOptimizerTester, checkClone) {
+  auto optimizer = xacc::getOptimizer("nlopt");
+  // Shared instance
+  EXPECT_EQ(optimizer, xacc::getOptimizer("nlopt"));
+  optimizer->setOptions(
+      HeterogeneousMap{std::make_pair("initial-parameters", std::vector<double>{1.0})});
+
+  auto cloneable = std::dynamic_pointer_cast<Cloneable<Optimizer>>(optimizer);
+  ASSERT_TRUE(cloneable != nullptr);
+  auto copy = cloneable->clone();
+  EXPECT_NE(optimizer, copy);
+  EXPECT_EQ("nlopt", copy->name());
+  // Starts from the copied initial parameters
+  copy->appendOption("nlopt-maxeval", 20);
+
+  OptFunction f([](const std::vector<double> &x, std::vector<double>& g) { return x[0] * x[0] + 5; },
+                1);
+  auto result = copy->optimize(f);
+  EXPECT_NEAR(result.first, 5.0, 1e-4);
+}
+
+TEST(NLOptimizerTester, checkNelderMeadBatchedSimplex) {
+  auto optimizer = xacc::getService<Optimizer>("nlopt");
+  int nbCalls = 0;
+  std::vector<std::size_t> batchSizes;
+  const auto paraboloid = [](const std::vector<double> &x) {
+    return (x[0] - 0.5) * (x[0] - 0.5) + (x[1] + 0.25) * (x[1] + 0.25);
+  };
+  OptFunction f(
+      [&](const std::vector<double> &x, std::vector<double> &) {
+        nbCalls++;
+        return paraboloid(x);
+      },
+      2);
+  f.setBatchFunction([&](const std::vector<std::vector<double>> &xs) {
+    batchSizes.push_back(xs.size());
+    std::vector<double> values;
+    for (auto &x : xs) {
+      values.push_back(paraboloid(x));
+    }
+    return values;
+  });
+
+  optimizer->setOptions(
+      HeterogeneousMap{std::make_pair("nlopt-maxeval", 200),
+                       std::make_pair("nlopt-optimizer", "nelder-mead")});
+  auto result = optimizer->optimize(f);
+  EXPECT_NEAR(0.0, result.first, 1e-6);
+  EXPECT_NEAR(0.5, result.second[0], 1e-3);
+  EXPECT_NEAR(-0.25, result.second[1], 1e-3);
+  // The initial simplex in one batch, the other points one by one
+  EXPECT_EQ(std::vector<std::size_t>{3}, batchSizes);
+  EXPECT_GT(nbCalls, 0);
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize(argc, argv);
   ::testing::InitGoogleTest(&argc, argv);
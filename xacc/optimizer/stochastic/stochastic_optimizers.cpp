@@ -0,0 +1,415 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#include "stochastic_optimizers.hpp"
+#include "xacc.hpp"
+
+#include "cppmicroservices/BundleActivator.h"
+#include "cppmicroservices/BundleContext.h"
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+
+namespace {
+std::vector<double> initialParameters(const xacc::HeterogeneousMap &options,
+                                      const int dim) {
+  std::vector<double> x(dim, 0.0);
+  if (options.keyExists<std::vector<double>>("initial-parameters")) {
+    x = options.get<std::vector<double>>("initial-parameters");
+  } else if (options.keyExists<std::vector<int>>("initial-parameters")) {
+    const auto tmpx = options.get<std::vector<int>>("initial-parameters");
+    x = std::vector<double>(tmpx.begin(), tmpx.end());
+  }
+  if (x.size() != dim) {
+    xacc::error("Invalid initial-parameters, expected " +
+                std::to_string(dim) + " parameters.");
+  }
+  return x;
+}
+
+template <typename T>
+T optionOr(const xacc::HeterogeneousMap &options, const std::string &key,
+             T defaultValue) {
+  return options.keyExists<T>(key) ? options.get<T>(key) : defaultValue;
+}
+
+// A double option that can be given as an int
+double getDouble(const xacc::HeterogeneousMap &options, const std::string &key,
+                 double defaultValue) {
+  if (options.keyExists<int>(key)) {
+    return options.get<int>(key);
+  }
+  return optionOr<double>(options, key, defaultValue);
+}
+} // namespace
+
+namespace xacc {
+
+OptResult SPSAOptimizer::optimize(OptFunction &function) {
+  const int dim = function.dimensions();
+  auto x = initialParameters(options, dim);
+  const int maxiter = optionOr<int>(options, "maxeval", 100);
+  const double a = getDouble(options, "spsa-a", 0.2);
+  const double c = getDouble(options, "spsa-c", 0.1);
+  const double A = getDouble(options, "spsa-A", 0.1 * maxiter);
+  const double alpha = getDouble(options, "spsa-alpha", 0.602);
+  const double gamma = getDouble(options, "spsa-gamma", 0.101);
+  const int shots = optionOr<int>(options, "shots", 0);
+  std::mt19937_64 rng(options.keyExists<int>("seed")
+                          ? options.get<int>("seed")
+                          : std::random_device{}());
+  std::bernoulli_distribution coin(0.5);
+
+  const auto evaluate = [&](const std::vector<double> &params) {
+    if (shots > 0 && function.acceptsShots()) {
+      double variance;
+      return function(params, shots, variance);
+    }
+    std::vector<double> dx;
+    return function(params, dx);
+  };
+
+  std::vector<double> delta(dim), xPlus(dim), xMinus(dim);
+  for (int k = 0; k < maxiter; k++) {
+    const double ak = a / std::pow(k + 1 + A, alpha);
+    const double ck = c / std::pow(k + 1, gamma);
+    for (int i = 0; i < dim; i++) {
+      delta[i] = coin(rng) ? 1.0 : -1.0;
+      xPlus[i] = x[i] + ck * delta[i];
+      xMinus[i] = x[i] - ck * delta[i];
+    }
+    const double diff = evaluate(xPlus) - evaluate(xMinus);
+    for (int i = 0; i < dim; i++) {
+      // delta[i] = 1 / delta[i]
+      x[i] -= ak * diff / (2.0 * ck) * delta[i];
+    }
+  }
+  return {evaluate(x), x};
+}
+
+OptResult ICANSOptimizer::optimize(OptFunction &function) {
+  const int dim = function.dimensions();
+  auto x = initialParameters(options, dim);
+  const int maxiter = optionOr<int>(options, "maxeval", 100);
+  const double lipschitz = getDouble(options, "icans-lipschitz", 1.0);
+  const double lr = getDouble(options, "icans-learning-rate", 1.0 / lipschitz);
+  if (lipschitz <= 0.0 || lr <= 0.0 || lr >= 2.0 / lipschitz) {
+    xacc::error("Invalid iCANS icans-lipschitz / icans-learning-rate, the "
+                "learning rate must be in (0, 2 / L).");
+  }
+  const int minShots = optionOr<int>(options, "icans-min-shots", 2);
+  const int maxShots = optionOr<int>(options, "icans-max-shots", 100000);
+  const long long budget = optionOr<int>(options, "icans-shot-budget", 0);
+  const double mu = getDouble(options, "icans-mu", 0.99);
+  const double b = getDouble(options, "icans-b", 1e-6);
+  const double shift = getDouble(options, "icans-shift", M_PI / 2.0);
+  const int finalShots = optionOr<int>(options, "icans-final-shots", 1024);
+  if (minShots < 1 || maxShots < minShots) {
+    xacc::error("Invalid iCANS icans-min-shots / icans-max-shots.");
+  }
+
+  const double gradScale = 1.0 / (2.0 * std::sin(shift));
+  std::vector<int> shots(dim, minShots);
+  std::vector<double> grad(dim), chi(dim, 0.0), xi(dim, 0.0);
+  long long usedShots = 0;
+  for (int k = 0; k < maxiter; k++) {
+    // Parameter-shift gradient, component i with shots[i] shots
+    std::vector<double> variances(dim, 0.0);
+    auto shifted = x;
+    for (int i = 0; i < dim; i++) {
+      const auto estimate = [&](double &variance) {
+        double vPlus, vMinus;
+        shifted[i] = x[i] + shift;
+        const double fPlus = function(shifted, shots[i], vPlus);
+        shifted[i] = x[i] - shift;
+        const double fMinus = function(shifted, shots[i], vMinus);
+        shifted[i] = x[i];
+        usedShots += 2 * shots[i];
+        variance = vPlus < 0.0 || vMinus < 0.0
+                       ? -1.0
+                       : (vPlus + vMinus) * gradScale * gradScale;
+        return (fPlus - fMinus) * gradScale;
+      };
+      double variance;
+      grad[i] = estimate(variance);
+      if (variance < 0.0 && function.acceptsShots()) {
+        // From the spread of two estimates: E[(g1 - g2)^2] = 2 S / s
+        double unused;
+        const double other = estimate(unused);
+        variance = shots[i] * (grad[i] - other) * (grad[i] - other) / 2.0;
+        grad[i] = (grad[i] + other) / 2.0;
+      }
+      variances[i] = std::max(variance, 0.0);
+    }
+
+    for (int i = 0; i < dim; i++) {
+      x[i] -= lr * grad[i];
+    }
+
+    // Running averages (bias corrected) and the next shot counts
+    const double correction = 1.0 - std::pow(mu, k + 1);
+    std::vector<double> gains(dim);
+    for (int i = 0; i < dim; i++) {
+      xi[i] = mu * xi[i] + (1.0 - mu) * variances[i];
+      chi[i] = mu * chi[i] + (1.0 - mu) * grad[i];
+      const double xiHat = xi[i] / correction;
+      const double chiHat = chi[i] / correction;
+      const double s =
+          std::ceil(2.0 * lipschitz * lr / (2.0 - lipschitz * lr) * xiHat /
+                    (chiHat * chiHat + b * std::pow(mu, k)));
+      shots[i] = std::max<double>(minShots, std::min<double>(maxShots, s));
+      gains[i] = ((lr - lipschitz * lr * lr / 2.0) * chiHat * chiHat -
+                  lipschitz * lr * lr / (2.0 * shots[i]) * xiHat) /
+                 shots[i];
+    }
+    const int cap =
+        shots[std::max_element(gains.begin(), gains.end()) - gains.begin()];
+    for (auto &s : shots) {
+      s = std::max(minShots, std::min(s, cap));
+    }
+
+    if (budget > 0 && usedShots >= budget) {
+      xacc::info("iCANS shot budget reached after " + std::to_string(k + 1) +
+                 " iterations.");
+      break;
+    }
+  }
+
+  double variance;
+  return {function(x, finalShots, variance), x};
+}
+
+OptResult CMAESOptimizer::optimize(OptFunction &function) {
+  const int dim = function.dimensions();
+  const auto x0 = initialParameters(options, dim);
+  const int maxiter = optionOr<int>(options, "maxeval", 100);
+  const int lambda = std::max(
+      2, optionOr<int>(options, "cmaes-lambda",
+                       4 + (int)std::floor(3.0 * std::log((double)dim))));
+  double sigma = getDouble(options, "cmaes-sigma", 0.3);
+  const double lower = getDouble(options, "cmaes-lower-bound",
+                                 -std::numeric_limits<double>::infinity());
+  const double upper = getDouble(options, "cmaes-upper-bound",
+                                 std::numeric_limits<double>::infinity());
+  const double tol = getDouble(options, "cmaes-tolerance", 1e-8);
+  if (sigma <= 0.0 || lower >= upper) {
+    xacc::error("Invalid cmaes-sigma or cmaes bounds.");
+  }
+  std::mt19937_64 rng(options.keyExists<int>("seed")
+                          ? options.get<int>("seed")
+                          : std::random_device{}());
+  std::normal_distribution<double> normal(0.0, 1.0);
+
+  // Selection and adaptation constants (Hansen's defaults)
+  const double n = dim;
+  const int mu = lambda / 2;
+  Eigen::VectorXd weights(mu);
+  for (int i = 0; i < mu; i++) {
+    weights(i) = std::log(mu + 0.5) - std::log(i + 1.0);
+  }
+  weights /= weights.sum();
+  const double mueff = 1.0 / weights.squaredNorm();
+  const double cc = (4.0 + mueff / n) / (n + 4.0 + 2.0 * mueff / n);
+  const double cs = (mueff + 2.0) / (n + mueff + 5.0);
+  const double c1 = 2.0 / ((n + 1.3) * (n + 1.3) + mueff);
+  const double cmu =
+      std::min(1.0 - c1, 2.0 * (mueff - 2.0 + 1.0 / mueff) /
+                             ((n + 2.0) * (n + 2.0) + mueff));
+  const double damps =
+      1.0 + 2.0 * std::max(0.0, std::sqrt((mueff - 1.0) / (n + 1.0)) - 1.0) +
+      cs;
+  const double chiN =
+      std::sqrt(n) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+
+  Eigen::VectorXd mean = Eigen::Map<const Eigen::VectorXd>(x0.data(), dim);
+  Eigen::VectorXd pc = Eigen::VectorXd::Zero(dim);
+  Eigen::VectorXd ps = Eigen::VectorXd::Zero(dim);
+  Eigen::MatrixXd C = Eigen::MatrixXd::Identity(dim, dim);
+  Eigen::MatrixXd B = Eigen::MatrixXd::Identity(dim, dim);
+  Eigen::VectorXd D = Eigen::VectorXd::Ones(dim);
+
+  double bestValue = std::numeric_limits<double>::max();
+  std::vector<double> bestX = x0;
+  std::vector<std::vector<double>> candidates(lambda,
+                                              std::vector<double>(dim));
+  Eigen::MatrixXd steps(dim, lambda);
+  for (int k = 0; k < maxiter; k++) {
+    for (int j = 0; j < lambda; j++) {
+      Eigen::VectorXd z(dim);
+      for (int i = 0; i < dim; i++) {
+        z(i) = normal(rng);
+      }
+      Eigen::VectorXd x = mean + sigma * (B * D.asDiagonal() * z);
+      for (int i = 0; i < dim; i++) {
+        x(i) = std::min(upper, std::max(lower, x(i)));
+        candidates[j][i] = x(i);
+      }
+      // The (repaired) step, so that the update sees the evaluated point
+      steps.col(j) = (x - mean) / sigma;
+    }
+
+    const auto values = function.evaluate(candidates);
+    std::vector<int> order(lambda);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&](int a, int b) { return values[a] < values[b]; });
+    if (values[order[0]] < bestValue) {
+      bestValue = values[order[0]];
+      bestX = candidates[order[0]];
+    }
+
+    Eigen::VectorXd meanStep = Eigen::VectorXd::Zero(dim);
+    Eigen::MatrixXd selected(dim, mu);
+    for (int i = 0; i < mu; i++) {
+      selected.col(i) = steps.col(order[i]);
+      meanStep += weights(i) * selected.col(i);
+    }
+    mean += sigma * meanStep;
+
+    // Evolution paths, C^-1/2 = B D^-1 B^T
+    ps = (1.0 - cs) * ps + std::sqrt(cs * (2.0 - cs) * mueff) *
+                               (B * D.cwiseInverse().asDiagonal() *
+                                B.transpose() * meanStep);
+    const bool hsig =
+        ps.norm() / std::sqrt(1.0 - std::pow(1.0 - cs, 2.0 * (k + 1))) /
+            chiN <
+        1.4 + 2.0 / (n + 1.0);
+    pc = (1.0 - cc) * pc +
+         (hsig ? std::sqrt(cc * (2.0 - cc) * mueff) : 0.0) * meanStep;
+
+    C = (1.0 - c1 - cmu) * C +
+        c1 * (pc * pc.transpose() +
+              (hsig ? 0.0 : cc * (2.0 - cc)) * C) +
+        cmu * selected * weights.asDiagonal() * selected.transpose();
+    sigma *= std::exp(cs / damps * (ps.norm() / chiN - 1.0));
+
+    C = (C + C.transpose()) / 2.0;
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eigen(C);
+    B = eigen.eigenvectors();
+    D = eigen.eigenvalues().cwiseMax(1e-20).cwiseSqrt();
+
+    if (sigma * D.maxCoeff() < tol) {
+      xacc::info("CMA-ES converged after " + std::to_string(k + 1) +
+                 " generations.");
+      break;
+    }
+  }
+  return {bestValue, bestX};
+}
+
+OptResult DifferentialEvolutionOptimizer::optimize(OptFunction &function) {
+  const int dim = function.dimensions();
+  const int maxiter = optionOr<int>(options, "maxeval", 100);
+  const int np =
+      optionOr<int>(options, "de-population", std::max(5, 10 * dim));
+  const double F = getDouble(options, "de-f", 0.8);
+  const double CR = getDouble(options, "de-cr", 0.9);
+  const double lower = getDouble(options, "de-lower-bound", -M_PI);
+  const double upper = getDouble(options, "de-upper-bound", M_PI);
+  const double tol = getDouble(options, "de-tolerance", 1e-10);
+  if (np < 4) {
+    xacc::error("Invalid de-population, differential evolution needs at "
+                "least 4 members.");
+  }
+  if (lower >= upper || CR < 0.0 || CR > 1.0) {
+    xacc::error("Invalid de-cr or de bounds.");
+  }
+  std::mt19937_64 rng(options.keyExists<int>("seed")
+                          ? options.get<int>("seed")
+                          : std::random_device{}());
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  std::uniform_int_distribution<int> member(0, np - 1);
+  std::uniform_int_distribution<int> component(0, std::max(0, dim - 1));
+
+  std::vector<std::vector<double>> population(np, std::vector<double>(dim));
+  for (auto &x : population) {
+    for (auto &xi : x) {
+      xi = lower + (upper - lower) * uniform(rng);
+    }
+  }
+  if (options.keyExists<std::vector<double>>("initial-parameters") ||
+      options.keyExists<std::vector<int>>("initial-parameters")) {
+    population[0] = initialParameters(options, dim);
+  }
+  auto values = function.evaluate(population);
+
+  std::vector<std::vector<double>> trials(np, std::vector<double>(dim));
+  for (int k = 0; k < maxiter; k++) {
+    for (int i = 0; i < np; i++) {
+      int a, b, c;
+      do {
+        a = member(rng);
+      } while (a == i);
+      do {
+        b = member(rng);
+      } while (b == i || b == a);
+      do {
+        c = member(rng);
+      } while (c == i || c == a || c == b);
+      const int forced = component(rng);
+      for (int j = 0; j < dim; j++) {
+        trials[i][j] =
+            j == forced || uniform(rng) < CR
+                ? population[a][j] + F * (population[b][j] - population[c][j])
+                : population[i][j];
+        trials[i][j] = std::min(upper, std::max(lower, trials[i][j]));
+      }
+    }
+
+    const auto trialValues = function.evaluate(trials);
+    for (int i = 0; i < np; i++) {
+      if (trialValues[i] <= values[i]) {
+        population[i] = trials[i];
+        values[i] = trialValues[i];
+      }
+    }
+
+    const auto [minIt, maxIt] =
+        std::minmax_element(values.begin(), values.end());
+    if (*maxIt - *minIt < tol) {
+      xacc::info("Differential evolution converged after " +
+                 std::to_string(k + 1) + " generations.");
+      break;
+    }
+  }
+  const auto best = std::min_element(values.begin(), values.end()) -
+                    values.begin();
+  return {values[best], population[best]};
+}
+} // namespace xacc
+
+namespace {
+using namespace cppmicroservices;
+class US_ABI_LOCAL StochasticOptimizersActivator : public BundleActivator {
+public:
+  StochasticOptimizersActivator() {}
+
+  void Start(BundleContext context) {
+    context.RegisterService<xacc::Optimizer>(
+        std::make_shared<xacc::SPSAOptimizer>());
+    context.RegisterService<xacc::Optimizer>(
+        std::make_shared<xacc::ICANSOptimizer>());
+    context.RegisterService<xacc::Optimizer>(
+        std::make_shared<xacc::CMAESOptimizer>());
+    context.RegisterService<xacc::Optimizer>(
+        std::make_shared<xacc::DifferentialEvolutionOptimizer>());
+  }
+
+  void Stop(BundleContext /*context*/) {}
+};
+} // namespace
+
+CPPMICROSERVICES_EXPORT_BUNDLE_ACTIVATOR(StochasticOptimizersActivator)
@@ -0,0 +1,151 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_STOCHASTIC_OPTIMIZERS_HPP_
+#define XACC_STOCHASTIC_OPTIMIZERS_HPP_
+
+#include "Cloneable.hpp"
+#include "Optimizer.hpp"
+
+namespace xacc {
+
+// Simultaneous perturbation stochastic approximation (Spall): the gradient
+// is estimated from the objective at x +- c_k Delta, Delta a random +-1
+// vector, i.e. two evaluations per iteration whatever the dimension, and
+// x -= a_k g, a_k = a / (k + 1 + A)^alpha, c_k = c / (k + 1)^gamma.
+// Options:
+//   "initial-parameters",
+//   "maxeval"      iterations (default 100),
+//   "spsa-a", "spsa-c", "spsa-A", "spsa-alpha", "spsa-gamma"
+//                  (default 0.2, 0.1, 10% of maxeval, 0.602, 0.101),
+//   "shots"        of each evaluation, if the objective accepts shots,
+//   "seed"         of the perturbations (random by default).
+// The returned value is the objective at the final parameters.
+class SPSAOptimizer : public Optimizer, public Cloneable<Optimizer> {
+public:
+  OptResult optimize(OptFunction &function) override;
+  std::shared_ptr<Optimizer> clone() override {
+    auto copy = std::make_shared<SPSAOptimizer>();
+    copy->setOptions(options);
+    return copy;
+  }
+  bool shouldClone() override { return false; }
+  const std::string get_algorithm() const override { return "spsa"; }
+
+  const std::string name() const override { return "spsa"; }
+  const std::string description() const override { return ""; }
+};
+
+// Individual coupled adaptive number of shots (iCANS1, Kuebler et al.):
+// gradient descent on parameter-shift gradients, each component estimated
+// with its own number of shots s_i, chosen from running averages of the
+// gradient (chi) and of its single-shot variance (xi) so that the expected
+// gain per shot is maximal: low-shot estimates far from the optimum, more
+// shots as the gradient vanishes.
+//   s_i = ceil(2 L lr / (2 - L lr) xi_i / (chi_i^2 + b mu^k)),
+// capped by the s of the component with the largest expected gain per shot.
+// The objective should accept shots (e.g. VQE, otherwise this is an exact
+// parameter-shift gradient descent). The single-shot variances it reports
+// are used, or the spread of two estimates of the gradient if it does not
+// report them. Options:
+//   "initial-parameters",
+//   "maxeval"            iterations (default 100),
+//   "icans-lipschitz" L  of the gradient (default 1, e.g. the sum of the
+//                        absolute Pauli coefficients of the observable),
+//   "icans-learning-rate" lr (default 1 / L, at most 2 / L),
+//   "icans-min-shots"    (default 2), "icans-max-shots" per evaluation
+//                        (default 1e5),
+//   "icans-shot-budget"  total shots (default: unlimited),
+//   "icans-mu", "icans-b" (default 0.99, 1e-6),
+//   "icans-shift"        of the parameter-shift rule (default pi / 2),
+//   "icans-final-shots"  of the returned estimate (default 1024).
+class ICANSOptimizer : public Optimizer, public Cloneable<Optimizer> {
+public:
+  OptResult optimize(OptFunction &function) override;
+  std::shared_ptr<Optimizer> clone() override {
+    auto copy = std::make_shared<ICANSOptimizer>();
+    copy->setOptions(options);
+    return copy;
+  }
+  bool shouldClone() override { return false; }
+  const std::string get_algorithm() const override { return "icans"; }
+
+  const std::string name() const override { return "icans"; }
+  const std::string description() const override { return ""; }
+};
+
+// The population-based optimizers below evaluate each generation with
+// OptFunction::evaluate(), i.e. as one batch if the objective accepts
+// batches (e.g. VQE and QAOA submit all the candidate circuits at once).
+
+// Covariance matrix adaptation evolution strategy ((mu/mu_w, lambda)-CMA-ES,
+// Hansen): lambda candidates sampled from N(m, sigma^2 C) per generation, the
+// mean moved to the weighted mean of the best mu = lambda / 2, C and sigma
+// adapted from the evolution paths (rank-one and rank-mu updates, cumulative
+// step-size adaptation). Options:
+//   "initial-parameters" the initial mean,
+//   "maxeval"            generations (default 100),
+//   "cmaes-lambda"       population (default 4 + 3 ln(dim)),
+//   "cmaes-sigma"        initial step size (default 0.3),
+//   "cmaes-lower-bound", "cmaes-upper-bound"
+//                        the candidates are clamped to (unbounded by default),
+//   "cmaes-tolerance"    stop when sigma times the largest axis of C is below
+//                        (default 1e-8),
+//   "seed"               of the sampling (random by default).
+// The returned value is the best evaluated one.
+class CMAESOptimizer : public Optimizer, public Cloneable<Optimizer> {
+public:
+  OptResult optimize(OptFunction &function) override;
+  std::shared_ptr<Optimizer> clone() override {
+    auto copy = std::make_shared<CMAESOptimizer>();
+    copy->setOptions(options);
+    return copy;
+  }
+  bool shouldClone() override { return false; }
+  const std::string get_algorithm() const override { return "cmaes"; }
+
+  const std::string name() const override { return "cmaes"; }
+  const std::string description() const override { return ""; }
+};
+
+// Differential evolution (DE/rand/1/bin, Storn and Price): for each member
+// x_i of the population, the mutant a + F (b - c) of three other random
+// members is crossed over with x_i (each component with probability CR, at
+// least one), and the trial replaces x_i if it is not worse. Options:
+//   "initial-parameters" a member of the initial population (the others are
+//                        uniform in the bounds),
+//   "maxeval"            generations (default 100),
+//   "de-population"      (default max(5, 10 dim)),
+//   "de-f", "de-cr"      (default 0.8, 0.9),
+//   "de-lower-bound", "de-upper-bound" of the parameters (default -pi, pi),
+//   "de-tolerance"       stop when the spread of the population values is
+//                        below (default 1e-10),
+//   "seed"               (random by default).
+class DifferentialEvolutionOptimizer : public Optimizer,
+                                       public Cloneable<Optimizer> {
+public:
+  OptResult optimize(OptFunction &function) override;
+  std::shared_ptr<Optimizer> clone() override {
+    auto copy = std::make_shared<DifferentialEvolutionOptimizer>();
+    copy->setOptions(options);
+    return copy;
+  }
+  bool shouldClone() override { return false; }
+  const std::string get_algorithm() const override {
+    return "differential-evolution";
+  }
+
+  const std::string name() const override { return "differential-evolution"; }
+  const std::string description() const override { return ""; }
+};
+} // namespace xacc
+#endif
@@ -0,0 +1,150 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#include <gtest/gtest.h>
+#include "xacc.hpp"
+#include "xacc_service.hpp"
+
+#include <cmath>
+#include <random>
+
+using namespace xacc;
+
+namespace {
+// -cos(x0) - cos(x1) / 2, minimum -1.5 at 0
+double energy(const std::vector<double> &x) {
+  return -std::cos(x[0]) - 0.5 * std::cos(x[1]);
+}
+} // namespace
+
+TEST(StochasticOptimizersTester, checkSPSA) {
+  auto optimizer = xacc::getOptimizer(
+      "spsa", {{"initial-parameters", std::vector<double>{1.0, -0.8}},
+               {"maxeval", 300},
+               {"spsa-a", 1.0},
+               {"seed", 11}});
+  OptFunction f(
+      [](const std::vector<double> &x, std::vector<double> &) {
+        return energy(x);
+      },
+      2);
+  auto result = optimizer->optimize(f);
+  EXPECT_NEAR(-1.5, result.first, 1e-2);
+  EXPECT_NEAR(0.0, result.second[0], 0.1);
+  EXPECT_NEAR(0.0, result.second[1], 0.15);
+}
+
+TEST(StochasticOptimizersTester, checkICANS) {
+  // Shot noise of a unit single-shot variance
+  std::mt19937_64 rng(5);
+  std::vector<int> requestedShots;
+  OptFunction f(
+      [](const std::vector<double> &x, std::vector<double> &) {
+        return energy(x);
+      },
+      [&](const std::vector<double> &x, int shots, double &variance) {
+        requestedShots.push_back(shots);
+        variance = 1.0;
+        std::normal_distribution<double> noise(0.0, 1.0 / std::sqrt(shots));
+        return energy(x) + noise(rng);
+      },
+      2);
+  EXPECT_TRUE(f.acceptsShots());
+
+  auto optimizer = xacc::getOptimizer(
+      "icans", {{"initial-parameters", std::vector<double>{1.0, -0.8}},
+                {"maxeval", 100},
+                {"icans-final-shots", 100000}});
+  auto result = optimizer->optimize(f);
+  EXPECT_NEAR(-1.5, result.first, 2e-2);
+  EXPECT_NEAR(0.0, result.second[0], 0.15);
+  EXPECT_NEAR(0.0, result.second[1], 0.25);
+  // Cheap estimates first, more shots near the optimum
+  EXPECT_EQ(2, requestedShots.front());
+  EXPECT_GT(requestedShots[requestedShots.size() - 2], 20);
+}
+
+TEST(StochasticOptimizersTester, checkBatchedEvaluation) {
+  int nbCalls = 0;
+  std::vector<std::size_t> batchSizes;
+  OptFunction f(
+      [&](const std::vector<double> &x, std::vector<double> &) {
+        nbCalls++;
+        return energy(x);
+      },
+      2);
+  EXPECT_FALSE(f.acceptsBatches());
+  EXPECT_EQ(std::vector<double>({-1.5, -0.5}),
+            f.evaluate({{0.0, 0.0}, {M_PI / 2.0, 0.0}}));
+  EXPECT_EQ(2, nbCalls);
+
+  f.setBatchFunction([&](const std::vector<std::vector<double>> &xs) {
+    batchSizes.push_back(xs.size());
+    std::vector<double> values;
+    for (auto &x : xs) {
+      values.push_back(energy(x));
+    }
+    return values;
+  });
+  EXPECT_TRUE(f.acceptsBatches());
+
+  // Whole generations at once
+  auto optimizer = xacc::getOptimizer(
+      "cmaes", {{"initial-parameters", std::vector<double>{1.0, -0.8}},
+                {"maxeval", 200},
+                {"cmaes-lambda", 8},
+                {"seed", 3}});
+  auto result = optimizer->optimize(f);
+  EXPECT_NEAR(-1.5, result.first, 1e-6);
+  EXPECT_NEAR(0.0, result.second[0], 1e-2);
+  EXPECT_NEAR(0.0, result.second[1], 1e-2);
+  EXPECT_EQ(2, nbCalls);
+  EXPECT_FALSE(batchSizes.empty());
+  for (auto size : batchSizes) {
+    EXPECT_EQ(8, size);
+  }
+}
+
+TEST(StochasticOptimizersTester, checkDifferentialEvolution) {
+  std::vector<std::size_t> batchSizes;
+  OptFunction f(
+      [](const std::vector<double> &x, std::vector<double> &) {
+        return energy(x);
+      },
+      2);
+  f.setBatchFunction([&](const std::vector<std::vector<double>> &xs) {
+    batchSizes.push_back(xs.size());
+    std::vector<double> values;
+    for (auto &x : xs) {
+      values.push_back(energy(x));
+    }
+    return values;
+  });
+  auto optimizer = xacc::getOptimizer(
+      "differential-evolution", {{"maxeval", 200}, {"seed", 7}});
+  auto result = optimizer->optimize(f);
+  EXPECT_NEAR(-1.5, result.first, 1e-6);
+  EXPECT_NEAR(0.0, result.second[0], 1e-2);
+  EXPECT_NEAR(0.0, result.second[1], 1e-2);
+  // The initial population then one batch per generation of 10 dim members
+  for (auto size : batchSizes) {
+    EXPECT_EQ(20, size);
+  }
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize(argc, argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
@@ -13,10 +13,31 @@
 #include "ServiceRegistry.hpp"
 #include "xacc_config.hpp"
 #include "xacc.hpp"
+#include "json.hpp"
+#include <cppmicroservices/Constants.h>
+#include <fstream>
+#include <set>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr const char *PLUGIN_INDEX_FILE = "plugin_index.json";
+
+bool getFileStamp(const std::string &in_path, int64_t &out_size,
+                  int64_t &out_modified) {
+  struct stat info;
+  if (stat(in_path.c_str(), &info) != 0) {
+    return false;
+  }
+  out_size = info.st_size;
+  out_modified = info.st_mtime;
+  return true;
+}
+} // namespace
 
 namespace xacc {
 
-void ServiceRegistry::initialize(const std::string rootPath) {
+void ServiceRegistry::initialize(const std::string rootPath, bool lazyPlugins) {
 
   if (!initialized) {
     framework = FrameworkFactory().NewFramework();
@@ -27,6 +48,8 @@ void ServiceRegistry::initialize(const std::string rootPath) {
     if (!context) {
       XACCLogger::instance()->error("Invalid XACC Framework plugin context.");
     }
+    context.AddServiceListener(
+        [this](const ServiceEvent &) { clearServiceIndex(); });
 
     std::string libDir = rootPath + std::string("/lib");
     std::string pluginDir = rootPath + std::string("/plugins");
@@ -50,6 +73,7 @@ void ServiceRegistry::initialize(const std::string rootPath) {
     }
 
     // Load plugins
+    std::map<std::string, std::vector<Bundle>> plugins;
     for (auto& path : extra_search_paths) {
       DIR *dir2;
       struct dirent *ent2;
@@ -58,7 +82,8 @@ void ServiceRegistry::initialize(const std::string rootPath) {
         while ((ent2 = readdir(dir2)) != NULL) {
           if (std::string(ent2->d_name).find("lib") != std::string::npos) {
             //   std::cout << "INSTALLING: " << path << "/" << std::string(ent2->d_name) << "\n";
-            context.InstallBundles(path + "/" + std::string(ent2->d_name));
+            const auto pluginFile = path + "/" + std::string(ent2->d_name);
+            plugins[pluginFile] = context.InstallBundles(pluginFile);
           }
         }
         closedir(dir2);
@@ -70,20 +95,238 @@ void ServiceRegistry::initialize(const std::string rootPath) {
     // Start the framework itself.
     framework.Start();
 
+    const std::string indexPath = rootPath + "/tmp/" + PLUGIN_INDEX_FILE;
+    if (lazyPlugins && loadPluginIndex(indexPath, plugins)) {
+      std::set<long> pluginBundleIds;
+      for (const auto &[pluginFile, bundles] : plugins) {
+        for (const auto &b : bundles) {
+          pluginBundleIds.emplace(b.GetBundleId());
+        }
+      }
+      pendingBundles = plugins;
+      for (const auto &[pluginFile, bundles] : pendingBundles) {
+        nbPendingBundles += bundles.size();
+      }
+      for (auto b : context.GetBundles()) {
+        if (!pluginBundleIds.count(b.GetBundleId())) {
+          startBundle(b);
+        }
+      }
+      initialized = true;
+      return;
+    }
+
     // Our bundles depend on each other in the sense that the consumer
     // bundle expects a ServiceTime service in its activator Start()
     // function. This is done here for simplicity, but is actually
     // bad practice.
     auto bundles = context.GetBundles();
     for (auto b : bundles) {
-      try {
-        b.Start();
-      } catch (std::exception &e) {
-        xacc::error("Could not load " + b.GetSymbolicName() + ", error message: " + e.what());
-      }
+      startBundle(b);
+    }
+
+    if (lazyPlugins) {
+      buildPluginIndex(plugins);
+      savePluginIndex(indexPath);
     }
 
     initialized = true;
   }
 }
+
+void ServiceRegistry::startBundle(Bundle &bundle) {
+  try {
+    bundle.Start();
+  } catch (std::exception &e) {
+    xacc::error("Could not load " + bundle.GetSymbolicName() + ", error message: " + e.what());
+  }
+}
+
+void ServiceRegistry::startPlugins(
+    const std::function<bool(const PluginServices &)> &in_filter) {
+  std::lock_guard<std::recursive_mutex> lock(pendingMutex);
+  std::vector<Bundle> toStart;
+  for (auto iter = pendingBundles.begin(); iter != pendingBundles.end();) {
+    const auto plugin = pluginIndex.find(iter->first);
+    if (plugin == pluginIndex.end() || in_filter(plugin->second)) {
+      toStart.insert(toStart.end(), iter->second.begin(), iter->second.end());
+      iter = pendingBundles.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+  // Not pending anymore before starting, in case the activators request
+  // services.
+  nbPendingBundles -= toStart.size();
+  for (auto &b : toStart) {
+    xacc::debug("Lazily starting " + b.GetSymbolicName());
+    startBundle(b);
+  }
+}
+
+void ServiceRegistry::startProviders(const std::string &in_interfaceId,
+                                     const std::string &in_name) {
+  const auto provides = [&](const PluginServices &in_plugin, bool in_anyName) {
+    for (const auto &[interfaceId, name] : in_plugin.services) {
+      if (interfaceId == in_interfaceId && (in_anyName || name == in_name)) {
+        return true;
+      }
+    }
+    return false;
+  };
+  std::lock_guard<std::recursive_mutex> lock(pendingMutex);
+  bool isIndexed = false;
+  if (!in_name.empty()) {
+    for (const auto &[pluginFile, plugin] : pluginIndex) {
+      if (provides(plugin, false)) {
+        isIndexed = true;
+        break;
+      }
+    }
+  }
+  startPlugins([&](const PluginServices &in_plugin) {
+    return provides(in_plugin, !isIndexed);
+  });
+}
+
+std::vector<OptionPairs> ServiceRegistry::getRegisteredOptions() {
+  std::vector<OptionPairs> values;
+  // Get all OptionsProvider services and call getOptions
+  auto optionProviders = getServices<xacc::OptionsProvider>(false);
+  for (auto o : optionProviders) {
+    values.push_back(o->getOptions());
+  }
+  std::lock_guard<std::recursive_mutex> lock(pendingMutex);
+  for (const auto &[pluginFile, bundles] : pendingBundles) {
+    const auto plugin = pluginIndex.find(pluginFile);
+    if (plugin != pluginIndex.end() && !plugin->second.options.empty()) {
+      values.push_back(plugin->second.options);
+    }
+  }
+  return values;
+}
+
+template <typename ServiceInterface>
+void ServiceRegistry::indexServiceNames(
+    const std::map<long, std::string> &in_bundleFiles) {
+  for (auto &s : context.GetServiceReferences<ServiceInterface>()) {
+    const auto pluginFile = in_bundleFiles.find(s.GetBundle().GetBundleId());
+    auto identifiable =
+        std::dynamic_pointer_cast<xacc::Identifiable>(context.GetService(s));
+    if (pluginFile != in_bundleFiles.end() && identifiable) {
+      pluginIndex[pluginFile->second].services.emplace_back(
+          us_service_interface_iid<ServiceInterface>(), identifiable->name());
+    }
+  }
+}
+
+void ServiceRegistry::buildPluginIndex(
+    const std::map<std::string, std::vector<Bundle>> &in_plugins) {
+  pluginIndex.clear();
+  std::map<long, std::string> bundleFiles;
+  for (const auto &[pluginFile, bundles] : in_plugins) {
+    auto &plugin = pluginIndex[pluginFile];
+    getFileStamp(pluginFile, plugin.size, plugin.modified);
+    for (const auto &b : bundles) {
+      bundleFiles.emplace(b.GetBundleId(), pluginFile);
+      for (const auto &s : b.GetRegisteredServices()) {
+        for (const auto &interfaceId : any_cast<std::vector<std::string>>(
+                 s.GetProperty(Constants::OBJECTCLASS))) {
+          plugin.services.emplace_back(interfaceId, "");
+        }
+      }
+    }
+  }
+
+  // The services requested by name
+  indexServiceNames<Accelerator>(bundleFiles);
+  indexServiceNames<AcceleratorDecorator>(bundleFiles);
+  indexServiceNames<Algorithm>(bundleFiles);
+  indexServiceNames<Compiler>(bundleFiles);
+  indexServiceNames<Instruction>(bundleFiles);
+  indexServiceNames<IRProvider>(bundleFiles);
+  indexServiceNames<IRTransformation>(bundleFiles);
+  indexServiceNames<Observable>(bundleFiles);
+  indexServiceNames<Optimizer>(bundleFiles);
+
+  for (auto &s : context.GetServiceReferences<OptionsProvider>()) {
+    const auto pluginFile = bundleFiles.find(s.GetBundle().GetBundleId());
+    if (pluginFile != bundleFiles.end()) {
+      const auto options = context.GetService(s)->getOptions();
+      pluginIndex[pluginFile->second].options.insert(options.begin(),
+                                                     options.end());
+    }
+  }
+}
+
+bool ServiceRegistry::loadPluginIndex(
+    const std::string &in_indexPath,
+    const std::map<std::string, std::vector<Bundle>> &in_plugins) {
+  pluginIndex.clear();
+  std::ifstream indexFile(in_indexPath);
+  if (!indexFile) {
+    return false;
+  }
+  try {
+    const auto json = nlohmann::json::parse(indexFile);
+    for (const auto &entry : json["plugins"]) {
+      auto &plugin = pluginIndex[entry["file"].get<std::string>()];
+      plugin.size = entry["size"].get<int64_t>();
+      plugin.modified = entry["modified"].get<int64_t>();
+      plugin.services =
+          entry["services"]
+              .get<std::vector<std::pair<std::string, std::string>>>();
+      plugin.options = entry["options"].get<OptionPairs>();
+    }
+  } catch (std::exception &e) {
+    xacc::warning("Invalid plugin index " + in_indexPath + ": " + e.what());
+    pluginIndex.clear();
+    return false;
+  }
+
+  // Must be the index of exactly these plugin files.
+  bool isValid = pluginIndex.size() == in_plugins.size();
+  for (const auto &[pluginFile, bundles] : in_plugins) {
+    const auto plugin = pluginIndex.find(pluginFile);
+    int64_t size, modified;
+    if (!isValid || plugin == pluginIndex.end() ||
+        !getFileStamp(pluginFile, size, modified) ||
+        size != plugin->second.size || modified != plugin->second.modified) {
+      isValid = false;
+      break;
+    }
+  }
+  if (!isValid) {
+    xacc::info("The plugins changed, rebuilding the plugin index.");
+    pluginIndex.clear();
+  }
+  return isValid;
+}
+
+void ServiceRegistry::savePluginIndex(const std::string &in_indexPath) const {
+  nlohmann::json plugins = nlohmann::json::array();
+  for (const auto &[pluginFile, plugin] : pluginIndex) {
+    plugins.push_back({{"file", pluginFile},
+                       {"size", plugin.size},
+                       {"modified", plugin.modified},
+                       {"services", plugin.services},
+                       {"options", plugin.options}});
+  }
+  const auto indexDir = in_indexPath.substr(0, in_indexPath.rfind('/'));
+  mkdir(indexDir.c_str(), S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH);
+  // Concurrent processes may write it: write a temporary file then rename.
+  const auto tmpPath = in_indexPath + "." + std::to_string(getpid());
+  {
+    std::ofstream indexFile(tmpPath);
+    indexFile << nlohmann::json{{"plugins", plugins}}.dump();
+    if (!indexFile) {
+      xacc::warning("Failed to write the plugin index " + in_indexPath);
+      return;
+    }
+  }
+  if (std::rename(tmpPath.c_str(), in_indexPath.c_str()) != 0) {
+    std::remove(tmpPath.c_str());
+    xacc::warning("Failed to write the plugin index " + in_indexPath);
+  }
+}
 } // namespace xacc
@@ -32,8 +32,15 @@
 #include <cppmicroservices/BundleContext.h>
 #include <cppmicroservices/Bundle.h>
 #include <cppmicroservices/BundleImport.h>
+#include <cppmicroservices/ServiceEvent.h>
+#include <cppmicroservices/ServiceInterface.h>
 
+#include <atomic>
+#include <functional>
 #include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
 #include <dirent.h>
 
 using namespace cppmicroservices;
@@ -56,14 +63,134 @@ protected:
   std::string rootPathStr = "";
 
   std::map<std::string, ContributableService> runtimeContributed;
+  std::mutex runtimeContributedMutex;
+
+  // Services contributed on their first request, e.g. those of the Python
+  // plugins, whose interpreter is only started then. By service name, the
+  // function contributing them (all its names at once), called once.
+  struct DeferredContributor {
+    std::function<void()> contribute;
+    bool called = false;
+  };
+  std::map<std::string, std::shared_ptr<DeferredContributor>>
+      deferredContributors;
+  std::atomic<size_t> nbDeferredContributors{0};
+  // Recursive: the contributor may request contributed services, the other
+  // threads wait for it.
+  std::recursive_mutex deferredContributorsMutex;
+
+  void contributeDeferred(const std::string &name) {
+    if (nbDeferredContributors == 0) {
+      return;
+    }
+    std::lock_guard<std::recursive_mutex> lock(deferredContributorsMutex);
+    auto iter = deferredContributors.find(name);
+    if (iter == deferredContributors.end() || iter->second->called) {
+      return;
+    }
+    auto contributor = iter->second;
+    contributor->called = true;
+    contributor->contribute();
+  }
  
   std::vector<std::string> extra_search_paths;
 
+  // Lazy plugin loading: the bundles of the plugin directories are installed
+  // but only started on the first request for one of their services, found
+  // in an index of the services of each plugin file. The index is cached on
+  // disk, and built by starting all the bundles (i.e. the eager mode)
+  // whenever it is missing or the plugin files changed.
+  struct PluginServices {
+    // To validate the cached index
+    int64_t size = 0;
+    int64_t modified = 0;
+    // (interface id, name) of the registered services, the name is empty
+    // for the interfaces that are not indexed by name.
+    std::vector<std::pair<std::string, std::string>> services;
+    // Of the OptionsProvider services
+    OptionPairs options;
+  };
+  // By plugin file
+  std::map<std::string, PluginServices> pluginIndex;
+  std::map<std::string, std::vector<Bundle>> pendingBundles;
+  std::atomic<size_t> nbPendingBundles{0};
+  // Recursive: activators may request services.
+  std::recursive_mutex pendingMutex;
+
+  void startBundle(Bundle &bundle);
+  // Start the pending bundles of the plugin files for which in_filter is true.
+  void startPlugins(const std::function<bool(const PluginServices &)> &in_filter);
+  // Start the pending bundles which provide the service, or all the providers
+  // of the interface if the name is empty or not in the index.
+  void startProviders(const std::string &in_interfaceId,
+                      const std::string &in_name);
+  template <typename ServiceInterface>
+  void startProviders(const std::string &in_name = "") {
+    if (nbPendingBundles > 0) {
+      startProviders(us_service_interface_iid<ServiceInterface>(), in_name);
+    }
+  }
+  template <typename ServiceInterface>
+  void indexServiceNames(const std::map<long, std::string> &in_bundleFiles);
+  void
+  buildPluginIndex(const std::map<std::string, std::vector<Bundle>> &in_plugins);
+  bool loadPluginIndex(
+      const std::string &in_indexPath,
+      const std::map<std::string, std::vector<Bundle>> &in_plugins);
+  void savePluginIndex(const std::string &in_indexPath) const;
+
+  // Services looked up by (interface id, name): the shared_ptr of the
+  // interface of the key, null if not found. Cleared on any service
+  // (un)registration.
+  std::unordered_map<std::string, std::shared_ptr<void>> serviceIndex;
+  uint64_t serviceIndexVersion = 0;
+  std::shared_mutex serviceIndexMutex;
+
+  void clearServiceIndex() {
+    std::unique_lock<std::shared_mutex> lock(serviceIndexMutex);
+    serviceIndex.clear();
+    ++serviceIndexVersion;
+  }
+
+  template <typename ServiceInterface>
+  std::shared_ptr<ServiceInterface> findService(const std::string &name) {
+    startProviders<ServiceInterface>(name);
+    const auto key = us_service_interface_iid<ServiceInterface>() + '\n' + name;
+    uint64_t version;
+    {
+      std::shared_lock<std::shared_mutex> lock(serviceIndexMutex);
+      auto iter = serviceIndex.find(key);
+      if (iter != serviceIndex.end()) {
+        return std::static_pointer_cast<ServiceInterface>(iter->second);
+      }
+      version = serviceIndexVersion;
+    }
+
+    // The last match, if several services have this name.
+    std::shared_ptr<ServiceInterface> ret;
+    auto allServiceRefs = context.GetServiceReferences<ServiceInterface>();
+    for (auto s : allServiceRefs) {
+      auto service = context.GetService(s);
+      auto identifiable =
+          std::dynamic_pointer_cast<xacc::Identifiable>(service);
+      if (identifiable && identifiable->name() == name) {
+        ret = service;
+      }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(serviceIndexMutex);
+    // Unless the services changed during the search
+    if (version == serviceIndexVersion) {
+      serviceIndex.emplace(key, ret);
+    }
+    return ret;
+  }
+
 public:
   ServiceRegistry() : framework(FrameworkFactory().NewFramework()) {}
   const std::string getRootPathString() { return rootPathStr; }
 
-  void initialize(const std::string rootPath);
+  void initialize(const std::string rootPath, bool lazyPlugins = false);
   void finalize() {
     auto bundles = context.GetBundles();
     for (auto b : bundles) {
@@ -79,56 +206,51 @@ public:
 
   void contributeService(const std::string name,
                          ContributableService &service) {
+    std::lock_guard<std::mutex> lock(runtimeContributedMutex);
     if (runtimeContributed.count(name)) {
       XACCLogger::instance()->error("Service already contributed.");
     }
     runtimeContributed.insert({name, service});
   }
 
-  template <typename ServiceInterface> bool hasService(const std::string name) {
-    auto allServiceRefs = context.GetServiceReferences<ServiceInterface>();
-    for (auto s : allServiceRefs) {
-      auto service = context.GetService(s);
-      auto identifiable =
-          std::dynamic_pointer_cast<xacc::Identifiable>(service);
-      if (identifiable && identifiable->name() == name) {
-        return true;
-      }
+  // The services (by name) are contributed by in_contribute on the first
+  // request of one of them.
+  void deferContributedServices(const std::vector<std::string> &names,
+                                std::function<void()> in_contribute) {
+    auto contributor = std::make_shared<DeferredContributor>();
+    contributor->contribute = std::move(in_contribute);
+    std::lock_guard<std::recursive_mutex> lock(deferredContributorsMutex);
+    for (const auto &name : names) {
+      deferredContributors[name] = contributor;
     }
+    nbDeferredContributors = deferredContributors.size();
+  }
 
-    return false;
+  template <typename ServiceInterface> bool hasService(const std::string name) {
+    return findService<ServiceInterface>(name) != nullptr;
   }
 
   template <typename ServiceInterface>
   std::shared_ptr<ServiceInterface> getService(const std::string name) {
-    std::shared_ptr<ServiceInterface> ret;
-    auto allServiceRefs = context.GetServiceReferences<ServiceInterface>();
-    for (auto s : allServiceRefs) {
-      auto service = context.GetService(s);
-      auto identifiable =
-          std::dynamic_pointer_cast<xacc::Identifiable>(service);
-      if (identifiable && identifiable->name() == name) {
-        auto checkCloneable =
-            std::dynamic_pointer_cast<xacc::Cloneable<ServiceInterface>>(
-                service);
-        if (checkCloneable && checkCloneable->shouldClone()) {
-          ret = checkCloneable->clone();
-        } else {
-          ret = service;
-        }
-      }
+    auto service = findService<ServiceInterface>(name);
+    auto checkCloneable =
+        std::dynamic_pointer_cast<xacc::Cloneable<ServiceInterface>>(service);
+    if (checkCloneable && checkCloneable->shouldClone()) {
+      return checkCloneable->clone();
     }
-
-    return ret;
+    return service;
   }
 
   template <typename ServiceInterface>
   std::shared_ptr<ServiceInterface>
   getContributedService(const std::string name) {
+    contributeDeferred(name);
     std::shared_ptr<ServiceInterface> ret;
 
+    std::unique_lock<std::mutex> lock(runtimeContributedMutex);
     if (runtimeContributed.count(name)) {
       ret = runtimeContributed[name].as<std::shared_ptr<ServiceInterface>>();
+      lock.unlock();
       auto checkCloneable =
           std::dynamic_pointer_cast<xacc::Cloneable<ServiceInterface>>(ret);
       if (checkCloneable && checkCloneable->shouldClone()) {
@@ -141,6 +263,8 @@ public:
 
   template <typename Service>
   bool hasContributedService(const std::string name) {
+    contributeDeferred(name);
+    std::lock_guard<std::mutex> lock(runtimeContributedMutex);
     if (runtimeContributed.count(name)) {
       try {
         auto tmp =
@@ -153,8 +277,14 @@ public:
     return false;
   }
 
+  // With in_startPlugins = false, only the services of the bundles already
+  // started (lazy mode).
   template <typename ServiceInterface>
-  std::vector<std::shared_ptr<ServiceInterface>> getServices() {
+  std::vector<std::shared_ptr<ServiceInterface>>
+  getServices(bool in_startPlugins = true) {
+    if (in_startPlugins) {
+      startProviders<ServiceInterface>();
+    }
     std::vector<std::shared_ptr<ServiceInterface>> services;
     auto allServiceRefs = context.GetServiceReferences<ServiceInterface>();
     for (auto s : allServiceRefs) {
@@ -166,6 +296,7 @@ public:
 
   template <typename ServiceInterface>
   std::vector<std::string> getRegisteredIds() {
+    startProviders<ServiceInterface>();
     std::vector<std::string> ids;
     auto allServiceRefs = context.GetServiceReferences<ServiceInterface>();
     for (auto s : allServiceRefs) {
@@ -179,20 +310,24 @@ public:
     return ids;
   }
 
-  std::vector<OptionPairs> getRegisteredOptions() {
-    std::vector<OptionPairs> values;
-    // Get all OptionsProvider services and call getOptions
-    auto optionProviders = getServices<xacc::OptionsProvider>();
-    for (auto o : optionProviders) {
-      values.push_back(o->getOptions());
-    }
-    return values;
-  }
+  // In lazy mode, the options of the pending plugins come from the index.
+  std::vector<OptionPairs> getRegisteredOptions();
 
   bool handleOptions(const std::map<std::string, std::string> &map) {
     auto returnedTrue = false;
+    // Only the pending plugins that have one of the given options are needed.
+    if (nbPendingBundles > 0) {
+      startPlugins([&](const PluginServices &in_plugin) {
+        for (const auto &kv : map) {
+          if (in_plugin.options.count(kv.first)) {
+            return true;
+          }
+        }
+        return false;
+      });
+    }
     // Get all OptionProvider services and call handleOptions
-    auto optionProviders = getServices<xacc::OptionsProvider>();
+    auto optionProviders = getServices<xacc::OptionsProvider>(false);
     for (auto o : optionProviders) {
       if (o->handleOptions(map)) {
         returnedTrue = true;
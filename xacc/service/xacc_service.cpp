@@ -37,7 +37,10 @@ void ServiceAPI_Initialize(int argc, char **argv) {
 
     options_description desc("tmp");
     desc.allow_unrecognised_options().add_options()("xacc-root-path", "",
-                                                    value<std::string>());
+                                                    value<std::string>())(
+        "xacc-lazy-plugins",
+        "Only load the plugins on the first request for one of their "
+        "services (using a cached index of the plugin services).");
     auto vm = desc.parse(argc, argv);
 
     if (vm.count("xacc-root-path")) {
@@ -45,7 +48,7 @@ void ServiceAPI_Initialize(int argc, char **argv) {
     }
 
     try {
-      serviceRegistry->initialize(rootPath);
+      serviceRegistry->initialize(rootPath, vm.count("xacc-lazy-plugins") > 0);
     } catch (std::exception &e) {
       XACCLogger::instance()->error(
           "Failure initializing XACC Plugin Registry - " +
@@ -69,6 +72,10 @@ void contributeService(const std::string name, ContributableService& service) {
 void contributeService(const std::string name, ContributableService&& service) {
     contributeService(name, service);
 }
+void deferContributedServices(const std::vector<std::string> &names,
+                              std::function<void()> contribute) {
+  serviceRegistry->deferContributedServices(names, std::move(contribute));
+}
 
 std::vector<OptionPairs> getRegisteredOptions() {
   return serviceRegistry->getRegisteredOptions();
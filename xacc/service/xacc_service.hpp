@@ -26,6 +26,9 @@ void ServiceAPI_Finalize();
 
 void contributeService(const std::string name, ContributableService& service);
 void contributeService(const std::string name, ContributableService&& service);
+// Defers the contribution of these services to their first request.
+void deferContributedServices(const std::vector<std::string> &names,
+                              std::function<void()> contribute);
 
 void addPluginSearchPath(const std::string path);
 
@@ -84,9 +87,12 @@ std::vector<std::string> getRegisteredIds() {
   return serviceRegistry->getRegisteredIds<ServiceInterface>();
 }
 
+// With in_startPlugins = false, only the services of the plugins already
+// loaded (with --xacc-lazy-plugins).
 template <typename ServiceInterface>
-std::vector<std::shared_ptr<ServiceInterface>> getServices() {
-  return serviceRegistry->getServices<ServiceInterface>();
+std::vector<std::shared_ptr<ServiceInterface>>
+getServices(bool in_startPlugins = true) {
+  return serviceRegistry->getServices<ServiceInterface>(in_startPlugins);
 }
 
 std::vector<OptionPairs> getRegisteredOptions();
@@ -14,6 +14,11 @@
 
 #include "xacc.hpp"
 #include "Algorithm.hpp"
+#include "Checkpoint.hpp"
+#include "ParameterStore.hpp"
+
+#include <cstdio>
+#include <unistd.h>
 
 using namespace xacc;
 using AlgorithmParameters = HeterogeneousMap;
@@ -70,6 +75,113 @@ TEST(AlgorithmTester, checkSimple) {
   alg.execute(buffer);
 }
 
+class TestOptimizer : public Optimizer {
+public:
+  OptResult optimize(OptFunction &function) override { return {}; }
+  const std::string name() const override { return "test"; }
+  const std::string description() const override { return ""; }
+  std::vector<double> initialParameters() const {
+    return options.get<std::vector<double>>("initial-parameters");
+  }
+};
+
+TEST(AlgorithmTester, checkParameterStore) {
+  const std::string fileName =
+      "parameter_store_" + std::to_string(getpid()) + ".json";
+  ParameterStore store(fileName);
+  std::vector<double> params;
+  EXPECT_FALSE(store.lookup("3-regular", 2, params));
+
+  EXPECT_TRUE(store.record("3-regular", {0.5, -0.2}, -3.0));
+  // Only improvements replace the entry
+  EXPECT_FALSE(store.record("3-regular", {0.1, 0.1}, -2.0));
+  EXPECT_TRUE(store.record("3-regular", {0.6, -0.3}, -3.5));
+  // Entries are per number of parameters
+  EXPECT_TRUE(store.record("3-regular", {0.1, 0.2, 0.3, 0.4}, -1.0));
+
+  // Another store on the same file (e.g. in another process)
+  ParameterStore other(fileName, ParameterStore::Update::Latest);
+  EXPECT_TRUE(other.lookup("3-regular", 2, params));
+  EXPECT_EQ(params, (std::vector<double>{0.6, -0.3}));
+  EXPECT_TRUE(other.lookup("3-regular", 4, params));
+  EXPECT_EQ(params.size(), 4);
+  EXPECT_FALSE(other.lookup("4-regular", 2, params));
+  EXPECT_TRUE(other.record("3-regular", {0.7, -0.4}, 0.0));
+
+  TestOptimizer optimizer;
+  EXPECT_TRUE(store.warmStart("3-regular", 2, optimizer));
+  EXPECT_EQ(optimizer.initialParameters(), (std::vector<double>{0.7, -0.4}));
+  EXPECT_FALSE(store.warmStart("3-regular", 3, optimizer));
+
+  // Key override
+  auto fromOptions = ParameterStore::fromParameters(
+      {{"parameter-store", fileName}, {"parameter-store-key", "custom"}},
+      ParameterStore::Update::Best);
+  EXPECT_EQ(fromOptions->fingerprint("3-regular"), "custom");
+  EXPECT_TRUE(ParameterStore::fromParameters({}, ParameterStore::Update::Best) ==
+              nullptr);
+
+  std::remove(fileName.c_str());
+  std::remove((fileName + ".lock").c_str());
+}
+
+TEST(AlgorithmTester, checkCheckpoint) {
+  const std::string fileName =
+      "checkpoint_" + std::to_string(getpid()) + ".bin";
+  int nbCalls = 0;
+  OptFunction f(
+      [&](const std::vector<double> &x, std::vector<double> &dx) {
+        ++nbCalls;
+        if (!dx.empty()) {
+          dx = {2.0 * x[0]};
+        }
+        return x[0] * x[0];
+      },
+      1);
+  {
+    auto checkpoint = std::make_shared<Checkpoint>(fileName);
+    EXPECT_FALSE(checkpoint->restore("problem"));
+    checkpoint->state().addExtraInfo("steps", std::vector<int>{1, 2});
+    CheckpointedOptFunction logged(f, checkpoint);
+    std::vector<double> dx(1);
+    EXPECT_NEAR(logged({0.1}, dx), 0.01, 1e-12);
+    EXPECT_NEAR(dx[0], 0.2, 1e-12);
+    EXPECT_NEAR(logged({0.3}, dx), 0.09, 1e-12);
+    EXPECT_EQ(nbCalls, 2);
+  }
+
+  // Restart: the same iterates are replayed, not evaluated
+  auto checkpoint = std::make_shared<Checkpoint>(fileName);
+  EXPECT_TRUE(checkpoint->restore("problem"));
+  EXPECT_EQ(checkpoint->state().getInformation("steps").as<std::vector<int>>(),
+            (std::vector<int>{1, 2}));
+  std::vector<double> replayedValues;
+  CheckpointedOptFunction logged(
+      f, checkpoint, [&](const Checkpoint::Evaluation &in_evaluation) {
+        replayedValues.emplace_back(in_evaluation.value);
+      });
+  std::vector<double> dx(1);
+  EXPECT_NEAR(logged({0.1}, dx), 0.01, 1e-12);
+  EXPECT_NEAR(dx[0], 0.2, 1e-12);
+  EXPECT_EQ(nbCalls, 2);
+  // Another iterate: the rest of the log is dropped
+  EXPECT_NEAR(logged({0.5}, dx), 0.25, 1e-12);
+  EXPECT_EQ(nbCalls, 3);
+  EXPECT_NEAR(logged({0.3}, dx), 0.09, 1e-12);
+  EXPECT_EQ(nbCalls, 4);
+  EXPECT_EQ(checkpoint->nbReplayed(), 1);
+  EXPECT_EQ(replayedValues.size(), 1);
+
+  // The checkpoint of another problem is ignored
+  Checkpoint other(fileName);
+  EXPECT_FALSE(other.restore("other problem"));
+  EXPECT_TRUE(Checkpoint::fromParameters({}) == nullptr);
+  EXPECT_EQ(Checkpoint::fromParameters({{"checkpoint", fileName}})->fileName(),
+            fileName);
+
+  std::remove(fileName.c_str());
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize();
   ::testing::InitGoogleTest(&argc, argv);
@@ -25,6 +25,14 @@ public:
   }
 };
 
+class key_visitor : public xacc::visitor_base<double, std::string> {
+public:
+  std::vector<std::string> keys;
+  template <typename T> void operator()(const std::string &s, const T &t) {
+    keys.push_back(s);
+  }
+};
+
 void test_set_ptr(xacc::HeterogeneousMap &map) {
   auto simple_kernel =
       xacc::getCompiler("xasm")
@@ -178,6 +186,31 @@ TEST(HeterogeneousMapTester, checkMerge) {
   c.visit(v);
 }
 
+TEST(HeterogeneousMapTester, checkFind) {
+  xacc::HeterogeneousMap c{{"zkey", 1}, {"akey", 2.5}};
+  c.insert("mkey", std::string("value"));
+  // Overwritten with another type
+  c.insert("zkey", 3.0);
+  EXPECT_EQ(3, c.size());
+  EXPECT_EQ(nullptr, c.find<int>("zkey"));
+  ASSERT_NE(nullptr, c.find<double>("zkey"));
+  EXPECT_EQ(3.0, *c.find<double>("zkey"));
+  EXPECT_EQ(nullptr, c.find<double>("nokey"));
+  EXPECT_FALSE(c.keyExists<int>("akey"));
+  EXPECT_EQ(7, c.get_or_default("nokey", 7));
+  EXPECT_THROW(c.get_with_throw<double>("nokey"), std::out_of_range);
+  EXPECT_THROW(c.get_with_throw<int>("akey"), std::bad_any_cast);
+
+  // Visited in key order
+  key_visitor v;
+  c.visit(v);
+  EXPECT_EQ((std::vector<std::string>{"akey", "mkey", "zkey"}), v.keys);
+
+  auto moved = std::move(c);
+  EXPECT_EQ(3, moved.size());
+  EXPECT_EQ("value", moved.getString("mkey"));
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize();
   ::testing::InitGoogleTest(&argc, argv);
@@ -57,6 +57,54 @@ TEST(InternalCompilerTester, checkMultipleBuffers) {
   }
 }
 
+TEST(InternalCompilerTester, checkPreparedKernel) {
+
+  auto previous = get_qpu();
+  qpu = xacc::getAccelerator("qpp", {std::make_pair("shots", 1024)});
+  auto q = qalloc(2);
+  q.setName("q");
+
+  auto r = qalloc(1);
+  r.setName("r");
+
+  const char *src = R"(__qpu__ void prepared_bell(qreg q, qreg r) {
+  H(q[0]);
+  CX(q[0],q[1]);
+  X(r[0]);
+  Measure(q[0]);
+  Measure(q[1]);
+  Measure(r[0]);
+})";
+  auto kernel = prepare("xasm", src);
+  // Prepared once
+  EXPECT_EQ(kernel, prepare("xasm", src));
+  auto byName = getPrepared("prepared_bell");
+  EXPECT_TRUE(byName);
+  EXPECT_EQ(byName, getPrepared("prepared_bell"));
+
+  xacc::AcceleratorBuffer *bufs[2] = {q.results(), r.results()};
+  for (int i = 0; i < 3; i++) {
+    q.reset();
+    r.reset();
+    execute(bufs, 2, *kernel);
+    int shots = 0;
+    for (const auto &kv : q.counts()) {
+      EXPECT_TRUE(kv.first == "00" || kv.first == "11");
+      shots += kv.second;
+    }
+    EXPECT_EQ(1, r.counts().size());
+    EXPECT_EQ(shots, r.counts()["1"]);
+  }
+
+  // The merged copy is re-used, the kernel keeps its own register bits
+  auto merged = kernel->mergedProgram;
+  execute(bufs, 2, *kernel);
+  EXPECT_EQ(merged, kernel->mergedProgram);
+  EXPECT_EQ(0, kernel->program->getInstruction(2)->bits()[0]);
+  EXPECT_EQ(2, merged->getInstruction(2)->bits()[0]);
+  clearPreparedKernels();
+  qpu = previous;
+}
 
 TEST(InternalCompilerTester, checkStaqAdd) {
   if (!xacc::hasCompiler("staq")) {
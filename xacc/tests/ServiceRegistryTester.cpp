@@ -0,0 +1,60 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#include <gtest/gtest.h>
+#include "xacc.hpp"
+#include "xacc_service.hpp"
+#include <algorithm>
+
+// Initialized with --xacc-lazy-plugins: the first run builds the plugin
+// index (eager start), the next ones load the plugins on demand. Both must
+// provide the same services.
+TEST(ServiceRegistryTester, checkLazyPlugins) {
+  // Core bundles
+  EXPECT_TRUE(xacc::getIRProvider("quantum") != nullptr);
+  // Plugins, by name
+  EXPECT_TRUE(xacc::hasService<xacc::Optimizer>("nlopt"));
+  auto optimizer = xacc::getOptimizer("nlopt");
+  ASSERT_TRUE(optimizer != nullptr);
+  EXPECT_EQ("nlopt", optimizer->name());
+  auto vqe = xacc::getService<xacc::Algorithm>("vqe");
+  ASSERT_TRUE(vqe != nullptr);
+  EXPECT_EQ("vqe", vqe->name());
+  EXPECT_FALSE(xacc::hasService<xacc::Algorithm>("not-an-algorithm"));
+  // By interface
+  const auto ids = xacc::getRegisteredIds<xacc::Optimizer>();
+  EXPECT_TRUE(std::find(ids.begin(), ids.end(), "nlopt") != ids.end());
+  EXPECT_FALSE(xacc::getServices<xacc::Optimizer>().empty());
+}
+
+TEST(ServiceRegistryTester, checkIndexedLookup) {
+  // Shared services are the same instance, Cloneable ones are clones.
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(xacc::getOptimizer("nlopt"), xacc::getOptimizer("nlopt"));
+    auto kak1 = xacc::getService<xacc::Instruction>("kak");
+    auto kak2 = xacc::getService<xacc::Instruction>("kak");
+    ASSERT_TRUE(kak1 && kak2);
+    EXPECT_NE(kak1, kak2);
+    EXPECT_EQ("kak", kak2->name());
+    // Not found (cached too)
+    EXPECT_TRUE(xacc::getService<xacc::Optimizer>("not-an-optimizer", false) ==
+                nullptr);
+  }
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize({"--xacc-lazy-plugins"});
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
@@ -13,6 +13,7 @@
 #include <gtest/gtest.h>
 
 #include "xacc.hpp"
+#include <thread>
 
 using namespace xacc;
 
@@ -132,6 +133,70 @@ exp_i_theta(q, s, {{"pauli", "X0 Z1 Y2 - X2 Z1 Y0"}});
 
     std::cout << function3->toString() << "\n";
 }
+TEST(XACCAPITester, checkConcurrentRuntime) {
+  auto provider = xacc::getIRProvider("quantum");
+  const int nbThreads = 8;
+  const int nbIters = 100;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < nbThreads; ++i) {
+    threads.emplace_back([&, i]() {
+      const auto prefix = "thread_" + std::to_string(i) + "_";
+      for (int j = 0; j < nbIters; ++j) {
+        const auto name = prefix + std::to_string(j);
+        auto buffer = xacc::qalloc(2);
+        xacc::storeBuffer(name, buffer);
+        EXPECT_EQ(buffer, xacc::getBuffer(name));
+
+        xacc::appendCompiled(provider->createComposite(name));
+        EXPECT_EQ(name, xacc::getCompiled(name)->name());
+
+        xacc::setOption(prefix + "option", name);
+        EXPECT_EQ(name, xacc::getOption(prefix + "option"));
+        xacc::debug("Iteration " + name);
+      }
+      xacc::unsetOption(prefix + "option");
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (int i = 0; i < nbThreads; ++i) {
+    const auto prefix = "thread_" + std::to_string(i) + "_";
+    EXPECT_FALSE(xacc::optionExists(prefix + "option"));
+    for (int j = 0; j < nbIters; ++j) {
+      EXPECT_TRUE(xacc::hasBuffer(prefix + std::to_string(j)));
+      EXPECT_TRUE(xacc::hasCompiled(prefix + std::to_string(j)));
+    }
+  }
+}
+
+TEST(XACCAPITester, checkLazyLogging) {
+  EXPECT_EQ(std::string(xacc::LogFields("iteration")
+                            .add("energy", -1.5)
+                            .add("params", std::vector<double>{0.1, 0.5})
+                            .add("name", "a b")),
+            "iteration energy=-1.5 params=[0.1,0.5] name=\"a b\"");
+
+  int nbBuilt = 0;
+  const auto message = [&]() {
+    nbBuilt++;
+    return std::string("message");
+  };
+  xacc::set_verbose(false);
+  XACC_LOG_INFO(message());
+  EXPECT_EQ(nbBuilt, 0);
+  xacc::set_verbose(true);
+  xacc::setLoggingLevel(0);
+  XACC_LOG_INFO(message());
+  EXPECT_EQ(nbBuilt, 0);
+  xacc::setLoggingLevel(1);
+  xacc::setLoggingAsync(true);
+  XACC_LOG_INFO(message());
+  EXPECT_EQ(nbBuilt, 1);
+  xacc::setLoggingAsync(false);
+  xacc::set_verbose(false);
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize();
   ::testing::InitGoogleTest(&argc, argv);
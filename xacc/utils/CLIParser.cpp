@@ -64,9 +64,19 @@ void CLIParser::parse(int argc,
       "no-color",
       "Turn off colored logger output (blue for INFO, red for ERROR, etc.).")(
       "use-cout", "Use std::cout for logs instead of SPDLOG Logger.")(
+      "threads", "Number of worker threads of the shared task scheduler "
+                 "(defaults to the hardware concurrency).",
+      value<std::string>())(
+      "no-parse-cache", "Parse the compiled source strings every time, instead "
+                        "of reusing the parse trees of the sources already "
+                        "compiled.")(
+      "no-xasm-fast-parser", "Parse the straight-line xasm sources with the "
+                             "ANTLR parser, as the other xasm sources.")(
       "queue-preamble", "Pass this option to xacc::Initialize() if you would "
                         "like all startup messages to be queued until after a "
-                        "global logger predicate has been passed.");
+                        "global logger predicate has been passed.")(
+      "logger-async", "Log from a background thread, dropping the messages "
+                      "rather than blocking when the queue is full.");
 
   // Parse the command line options
   auto clArgs = xaccOptions->parse(argc, argv);
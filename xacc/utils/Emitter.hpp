@@ -0,0 +1,175 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_UTILS_EMITTER_HPP_
+#define XACC_UTILS_EMITTER_HPP_
+
+#include "heterogeneous.hpp"
+#include <charconv>
+#include <complex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace xacc {
+
+/**
+ * Text output of the translators (Compiler::translate visitors): appends to
+ * a (pre-reserved) string, or to a std::ostream in chunks, e.g. a file or a
+ * socket stream for remote submission. Numbers are formatted with
+ * std::to_chars, with the std::ostream defaults (precision 6, general), so
+ * that it can replace a std::stringstream without changing the output.
+ */
+class Emitter {
+public:
+  // Sticky floating-point formats, as std::fixed << std::setprecision(p)
+  struct Fixed {
+    int precision;
+  };
+  struct General {
+    int precision;
+  };
+  static Fixed fixed(int precision) { return Fixed{precision}; }
+  static General general(int precision = 6) { return General{precision}; }
+
+  // To the owned buffer
+  explicit Emitter(size_t reserve = 0) { m_buffer.reserve(reserve); }
+  // Appends to io_target
+  explicit Emitter(std::string &io_target) : m_target(&io_target) {}
+  // To out, each time in_chunkSize bytes are buffered, and on flush()
+  explicit Emitter(std::ostream &out, size_t in_chunkSize = 1 << 16)
+      : m_out(&out), m_chunkSize(in_chunkSize) {
+    m_buffer.reserve(in_chunkSize);
+  }
+  // Not copyable: a copy would write the streamed text twice
+  Emitter(const Emitter &) = delete;
+  Emitter &operator=(const Emitter &) = delete;
+  Emitter(Emitter &&) = default;
+  Emitter &operator=(Emitter &&other) {
+    flush();
+    m_buffer = std::move(other.m_buffer);
+    other.m_buffer.clear();
+    m_target = other.m_target;
+    m_out = other.m_out;
+    m_chunkSize = other.m_chunkSize;
+    m_fixed = other.m_fixed;
+    m_precision = other.m_precision;
+    return *this;
+  }
+  ~Emitter() { flush(); }
+
+  void reserve(size_t in_size) { target().reserve(in_size); }
+
+  Emitter &operator<<(std::string_view in_str) {
+    target().append(in_str.data(), in_str.size());
+    return written();
+  }
+  Emitter &operator<<(const char *in_str) {
+    return *this << std::string_view(in_str);
+  }
+  Emitter &operator<<(const std::string &in_str) {
+    return *this << std::string_view(in_str);
+  }
+  Emitter &operator<<(char in_char) {
+    target().push_back(in_char);
+    return written();
+  }
+  Emitter &operator<<(bool in_bool) { return *this << (in_bool ? '1' : '0'); }
+
+  template <typename T>
+  typename std::enable_if<std::is_integral<T>::value, Emitter &>::type
+  operator<<(T in_value) {
+    char chars[24];
+    const auto result = std::to_chars(chars, chars + sizeof(chars), in_value);
+    return *this << std::string_view(chars, result.ptr - chars);
+  }
+
+  template <typename T>
+  typename std::enable_if<std::is_floating_point<T>::value, Emitter &>::type
+  operator<<(T in_value) {
+    // Enough for the fixed format of 1e308 with 16 digits
+    char chars[352];
+    const auto result = std::to_chars(
+        chars, chars + sizeof(chars), static_cast<double>(in_value),
+        m_fixed ? std::chars_format::fixed : std::chars_format::general,
+        m_precision);
+    return *this << std::string_view(chars, result.ptr - chars);
+  }
+
+  Emitter &operator<<(Fixed in_format) {
+    m_fixed = true;
+    m_precision = in_format.precision;
+    return *this;
+  }
+  Emitter &operator<<(General in_format) {
+    m_fixed = false;
+    m_precision = in_format.precision;
+    return *this;
+  }
+
+  template <typename T> Emitter &operator<<(const std::complex<T> &in_value) {
+    return *this << '(' << in_value.real() << ',' << in_value.imag() << ')';
+  }
+
+  // As the std::ostream operator of Utils.hpp: [a,b]
+  template <typename T> Emitter &operator<<(const std::vector<T> &in_values) {
+    *this << '[';
+    for (size_t i = 0; i < in_values.size(); ++i) {
+      if (i > 0) {
+        *this << ',';
+      }
+      *this << in_values[i];
+    }
+    return *this << ']';
+  }
+
+  // The value of an InstructionParameter, as its toString()
+  template <typename... Types>
+  Emitter &operator<<(const Variant<Types...> &in_value) {
+    mpark::visit([this](const auto &value) { *this << value; }, in_value);
+    return *this;
+  }
+
+  // Writes the buffered text to the stream, if any
+  void flush() {
+    if (m_out && !m_buffer.empty()) {
+      m_out->write(m_buffer.data(), m_buffer.size());
+      m_buffer.clear();
+    }
+  }
+
+  // The text, if not streamed
+  const std::string &str() const { return m_target ? *m_target : m_buffer; }
+  std::string take() { return std::move(target()); }
+  bool empty() const { return str().empty(); }
+  size_t size() const { return str().size(); }
+
+private:
+  std::string &target() { return m_target ? *m_target : m_buffer; }
+  Emitter &written() {
+    if (m_out && m_buffer.size() >= m_chunkSize) {
+      flush();
+    }
+    return *this;
+  }
+
+  std::string m_buffer;
+  std::string *m_target = nullptr;
+  std::ostream *m_out = nullptr;
+  size_t m_chunkSize = 0;
+  bool m_fixed = false;
+  int m_precision = 6;
+};
+} // namespace xacc
+#endif
@@ -15,6 +15,8 @@
 
 #include "Singleton.hpp"
 #include <map>
+#include <mutex>
+#include <string>
 
 namespace xacc {
 
@@ -23,6 +25,11 @@ namespace xacc {
  * keys to string values. It is used throughout XACC to
  * provide and share runtime options that are provided from
  * XACC users via the command line.
+ *
+ * The get, set, erase and exists methods are thread safe, so can be used
+ * concurrently by the xacc API (getOption, setOption, etc.). The std::map
+ * interface is not synchronized and is meant for the single-threaded
+ * command line parsing.
  */
 class RuntimeOptions : public Singleton<RuntimeOptions>,
                        public std::map<std::string, std::string> {
@@ -34,7 +41,45 @@ public:
    *
    * @param key The key to check exists
    */
-  bool exists(const std::string &key) { return find(key) != end(); }
+  bool exists(const std::string &key) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return find(key) != end();
+  }
+
+  /**
+   * Copy the value of the given key into value, if it exists.
+   *
+   * @param key The key to look up
+   * @param value The value of the key if found
+   * @return found True if the key exists
+   */
+  bool get(const std::string &key, std::string &value) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto iter = find(key);
+    if (iter == end()) {
+      return false;
+    }
+    value = iter->second;
+    return true;
+  }
+
+  void set(const std::string &key, const std::string &value) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    (*this)[key] = value;
+  }
+
+  void erase(const std::string &key) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::map<std::string, std::string>::erase(key);
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::map<std::string, std::string>::clear();
+  }
+
+private:
+  std::mutex m_mutex;
 };
 } // namespace xacc
 
@@ -0,0 +1,50 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Thien Nguyen - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_UTILS_STRUCTURALHASHER_HPP_
+#define XACC_UTILS_STRUCTURALHASHER_HPP_
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+namespace xacc {
+// Incremental 64-bit FNV-1a hash.
+// Unlike std::hash, the value is stable across runs and platforms (of the
+// same endianness), hence can be persisted.
+class StructuralHasher {
+public:
+  template <typename T> void add(const T &in_val) {
+    static_assert(std::is_trivially_copyable<T>::value, "POD type required");
+    const auto *bytes = reinterpret_cast<const unsigned char *>(&in_val);
+    for (size_t i = 0; i < sizeof(T); ++i) {
+      addByte(bytes[i]);
+    }
+  }
+  void add(const std::string &in_str) {
+    add<uint64_t>(in_str.size());
+    for (const auto c : in_str) {
+      addByte(c);
+    }
+  }
+  void add(const char *in_str) { add(std::string(in_str)); }
+  uint64_t value() const { return m_hash; }
+
+private:
+  void addByte(unsigned char in_byte) {
+    m_hash ^= in_byte;
+    m_hash *= 1099511628211ULL;
+  }
+  uint64_t m_hash = 14695981039346656037ULL;
+};
+} // namespace xacc
+#endif
@@ -13,8 +13,10 @@
 #include "Utils.hpp"
 #include <unistd.h>
 #include "spdlog/spdlog.h"
+#include "spdlog/sinks/stdout_sinks.h"
 #include "RuntimeOptions.hpp"
 
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include <istream>
@@ -226,6 +228,7 @@ void XACCLogger::createFileLogger() {
 }
 
 void XACCLogger::logToFile(bool enable, const std::string& fileNamePrefix) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
   // Switching the current setting
   if (enable != useFile) {
     // Always dump any enqueued messages before switching.
@@ -258,7 +261,10 @@ void XACCLogger::setLoggingLevel(int level) {
     getLogger()->set_level(spdlog::level::debug);
   }
 
+  loggingLevel = level;
+
   // Notify subscribers
+  std::lock_guard<std::recursive_mutex> lock(mutex);
   for (const auto& callback : loggingLevelSubscribers) {
     try {
       callback(level);
@@ -269,6 +275,38 @@ void XACCLogger::setLoggingLevel(int level) {
   }
 }
 
+void XACCLogger::setAsync(bool enable, std::size_t queueSize) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  if (enable == (syncStdOutLogger != nullptr)) {
+    return;
+  }
+  if (enable) {
+    const auto asyncName = stdOutLogger->name() + "-async";
+    auto asyncLogger = spdlog::get(asyncName);
+    if (!asyncLogger) {
+      asyncLogger = spdlog::create_async(
+          asyncName, spdlog::sinks::stdout_sink_mt::instance(),
+          queueSize, spdlog::async_overflow_policy::discard_log_msg, nullptr,
+          std::chrono::seconds(1));
+    }
+    asyncLogger->set_level(stdOutLogger->level());
+    syncStdOutLogger = stdOutLogger;
+    stdOutLogger = asyncLogger;
+  } else {
+    stdOutLogger->flush();
+    syncStdOutLogger->set_level(stdOutLogger->level());
+    stdOutLogger = syncStdOutLogger;
+    syncStdOutLogger.reset();
+  }
+}
+
+void XACCLogger::flush() {
+  getLogger()->flush();
+  if (useCout) {
+    std::cout.flush();
+  }
+}
+
 int XACCLogger::getLoggingLevel() {
   const auto spdLevel = getLogger()->level();
   switch (spdLevel) {
@@ -282,7 +320,7 @@ int XACCLogger::getLoggingLevel() {
 
 void XACCLogger::info(const std::string &msg, MessagePredicate predicate) {
   if (useCout) {
-    if (predicate() && globalPredicate()) {
+    if (predicate() && checkGlobalPredicate()) {
       if (useColor) {
         std::cout << "\033[1;34m[XACC Info] " + msg + "\033[0m \n";
       } else {
@@ -290,7 +328,7 @@ void XACCLogger::info(const std::string &msg, MessagePredicate predicate) {
       }
     }
   } else {
-    if (predicate() && globalPredicate()) {
+    if (predicate() && checkGlobalPredicate()) {
       if (useColor & !useFile) {
         getLogger()->info("\033[1;34m" + msg + "\033[0m");
       } else {
@@ -302,7 +340,7 @@ void XACCLogger::info(const std::string &msg, MessagePredicate predicate) {
 
 void XACCLogger::warning(const std::string &msg, MessagePredicate predicate) {
   if (useCout) {
-    if (predicate() && globalPredicate()) {
+    if (predicate() && checkGlobalPredicate()) {
       if (useColor) {
         std::cout << "\033[1;33m[XACC Warning] " + msg + "\033[0m \n";
       } else {
@@ -310,7 +348,7 @@ void XACCLogger::warning(const std::string &msg, MessagePredicate predicate) {
       }
     }
   } else {
-    if (predicate() && globalPredicate()) {
+    if (predicate() && checkGlobalPredicate()) {
       if (useColor & !useFile) {
         getLogger()->info("\033[1;33m" + msg + "\033[0m");
       } else {
@@ -322,7 +360,7 @@ void XACCLogger::warning(const std::string &msg, MessagePredicate predicate) {
 
 void XACCLogger::debug(const std::string &msg, MessagePredicate predicate) {
   if (useCout) {
-    if (predicate() && globalPredicate()) {
+    if (predicate() && checkGlobalPredicate()) {
       if (useColor) {
         std::cout << "\033[1;32m[XACC Debug] " + msg + "\033[0m \n";
       } else {
@@ -330,7 +368,7 @@ void XACCLogger::debug(const std::string &msg, MessagePredicate predicate) {
       }
     }
   } else {
-    if (predicate() && globalPredicate()) {
+    if (predicate() && checkGlobalPredicate()) {
       if (useColor & !useFile) {
         getLogger()->info("\033[1;32m" + msg + "\033[0m");
       } else {
@@ -341,10 +379,10 @@ void XACCLogger::debug(const std::string &msg, MessagePredicate predicate) {
 }
 void XACCLogger::error(const std::string &msg, MessagePredicate predicate) {
   if (useCout) {
-    if (predicate() && globalPredicate())
+    if (predicate() && checkGlobalPredicate())
       std::cerr << msg << "\n";
   } else {
-    if (predicate() && globalPredicate()) {
+    if (predicate() && checkGlobalPredicate()) {
       getLogger()->error("\033[1;31m[XACC Error] " + msg + "\033[0m");
     }
   }
@@ -360,15 +398,119 @@ ScopeTimer::ScopeTimer(const std::string& scopeName, bool shouldLog):
     }
   }
 
+ScopeTimer::ScopeTimer(const std::string& scopeName, SpanRecorder *recorder):
+  m_startTime(std::chrono::system_clock::now()),
+  m_shouldLog(false),
+  m_scopeName(scopeName),
+  m_recorder(recorder)
+  {
+    if (m_recorder) {
+      m_depth = m_recorder->begin(scopeName);
+    }
+  }
+
+void ScopeTimer::phase(const std::string& name) {
+  if (m_recorder) {
+    m_recorder->end(m_depth + 1);
+    m_recorder->begin(name);
+  }
+}
+
 double ScopeTimer::getDurationMs() const {
   return static_cast<double>(
     std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - m_startTime).count()/1000.0);
 }
 
 ScopeTimer::~ScopeTimer() {
+  if (m_recorder) {
+    m_recorder->end(m_depth);
+  }
   const double elapsedTime = getDurationMs();
   if (m_shouldLog) {
     XACCLogger::instance()->info("'" + m_scopeName + "' finished [" + std::to_string(elapsedTime) + " ms].");
   }
 }
+
+SpanRecorder::SpanRecorder() : m_origin(std::chrono::steady_clock::now()) {}
+
+std::size_t SpanRecorder::begin(const std::string& name) {
+  const double start = std::chrono::duration<double, std::micro>(
+                           std::chrono::steady_clock::now() - m_origin)
+                           .count();
+  m_spans.push_back({name, start, 0.0, m_open.empty() ? -1 : m_open.back()});
+  m_open.push_back(m_spans.size() - 1);
+  return m_open.size() - 1;
+}
+
+void SpanRecorder::end(std::size_t depth) {
+  const double now = std::chrono::duration<double, std::micro>(
+                         std::chrono::steady_clock::now() - m_origin)
+                         .count();
+  while (m_open.size() > depth) {
+    auto &span = m_spans[m_open.back()];
+    span.duration = now - span.start;
+    m_open.pop_back();
+  }
+}
+
+std::map<std::string, std::vector<double>>
+SpanRecorder::breakdown(const std::string& name) const {
+  std::map<std::string, std::vector<double>> result;
+  std::map<int, std::size_t> rows;
+  for (int i = 0; i < m_spans.size(); i++) {
+    if (m_spans[i].name == name) {
+      rows.emplace(i, rows.size());
+    }
+  }
+  if (rows.empty()) {
+    return result;
+  }
+  auto &totals = result[name];
+  totals.resize(rows.size(), 0.0);
+  for (int i = 0; i < m_spans.size(); i++) {
+    auto row = rows.find(i);
+    if (row != rows.end()) {
+      totals[row->second] = m_spans[i].duration / 1000.0;
+    }
+    row = rows.find(m_spans[i].parent);
+    if (row != rows.end()) {
+      auto &values = result[m_spans[i].name];
+      values.resize(rows.size(), 0.0);
+      values[row->second] += m_spans[i].duration / 1000.0;
+    }
+  }
+  return result;
+}
+
+void SpanRecorder::writeChromeTrace(const std::string& fileName) const {
+  std::ofstream out(fileName);
+  if (!out) {
+    XACCLogger::instance()->error("SpanRecorder: cannot write " + fileName +
+                                  ".");
+    return;
+  }
+  const auto escape = [](const std::string &str) {
+    std::string escaped;
+    for (auto c : str) {
+      if (c == '"' || c == '\\') {
+        escaped.push_back('\\');
+      }
+      escaped.push_back(c);
+    }
+    return escaped;
+  };
+  out << "{\"traceEvents\":[";
+  for (int i = 0; i < m_spans.size(); i++) {
+    out << (i ? "," : "") << "\n{\"name\":\"" << escape(m_spans[i].name)
+        << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":"
+        << m_spans[i].start << ",\"dur\":" << m_spans[i].duration << "}";
+  }
+  out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+void SpanRecorder::clear() {
+  m_spans.clear();
+  m_open.clear();
+  m_origin = std::chrono::steady_clock::now();
+}
 } // namespace xacc
@@ -15,13 +15,17 @@
 
 #include "Singleton.hpp"
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <queue>
 #include <functional>
 #include <sstream>
+#include <iomanip>
 #include <algorithm>
 #include <map>
 #include <chrono>
+#include <vector>
 
 namespace spdlog {
 class logger;
@@ -146,16 +150,22 @@ using MessagePredicate = std::function<bool(void)>;
 // match that of XACC.
 using LoggingLevelNotification = std::function<void(int)>;
 
+// The logging methods can be called concurrently: the spdlog loggers are the
+// thread-safe (_mt) ones, and the mutable state of the logger (queue,
+// predicate, subscribers, file logging switch) is guarded by a mutex.
 class XACCLogger : public Singleton<XACCLogger> {
 
 protected:
   std::shared_ptr<spdlog::logger> stdOutLogger;
   std::shared_ptr<spdlog::logger> fileLogger;
-  
+  // The synchronous stdout logger while logging asynchronously
+  std::shared_ptr<spdlog::logger> syncStdOutLogger;
+
   bool useCout = false;
   
   // Should we log to file?
-  bool useFile = false;
+  std::atomic<bool> useFile{false};
+  bool fileLoggerUsed = false;
 
   bool useColor = true;
 
@@ -168,10 +178,17 @@ protected:
   // Custom filename prefix (if logging to file)
   std::string logFileNamePrefix;
 
+  // Mirror of the logging level, read without locking by isEnabled()
+  std::atomic<int> loggingLevel{1};
+
+  // Guards the members above, except the spdlog loggers once created.
+  // Recursive since dumpQueue() logs, and subscribers may log.
+  std::recursive_mutex mutex;
+
   XACCLogger();
   
   std::shared_ptr<spdlog::logger> getLogger() { 
-    static bool fileLoggerUsed = false;
+    std::lock_guard<std::recursive_mutex> lock(mutex);
     if (!fileLoggerUsed && useFile) {
       createFileLogger();
       fileLoggerUsed = true;
@@ -187,10 +204,10 @@ protected:
 public:
   // Overriding here so we can have a custom constructor
   static XACCLogger *instance() {
-    if (!instance_) {
-      instance_ = new XACCLogger();
-    }
-    return instance_;
+    // Thread-safe initialization of the local static
+    static XACCLogger *logger =
+        instance_ ? instance_ : (instance_ = new XACCLogger());
+    return logger;
   }
 
   // If enable = true, switch to File logging (if not already logging to file).
@@ -206,20 +223,36 @@ public:
   // Note: this will only take effect when xacc::verbose is set.
   void setLoggingLevel(int level);
   int getLoggingLevel();
+
+  // Would a message of this level (0: warning, 1: info, 2: debug) be
+  // logged? Lock-free, so that hot loops can skip formatting messages.
+  bool isEnabled(int level) const { return useCout || level <= loggingLevel; }
+
+  // Log to stdout from a background thread: messages are queued to a
+  // bounded queue (queueSize a power of 2) and dropped when it is full,
+  // so logging never blocks the caller.
+  void setAsync(bool enable, std::size_t queueSize = 8192);
+  void flush();
   
   void subscribeLoggingLevel(LoggingLevelNotification onLevelChangeFn) { 
+    std::lock_guard<std::recursive_mutex> lock(mutex);
     loggingLevelSubscribers.emplace_back(onLevelChangeFn);
   }
 
-  void enqueueLog(const std::string log) { logQueue.push(log); }
+  void enqueueLog(const std::string log) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    logQueue.push(log);
+  }
 
   void dumpQueue() {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
     while (!logQueue.empty()) {
       info(logQueue.front());
       logQueue.pop();
     }
   }
   void setGlobalLoggerPredicate(MessagePredicate pred) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
     globalPredicate = pred;
   }
   void info(const std::string &msg,
@@ -238,9 +271,65 @@ public:
              MessagePredicate predicate = std::function<bool(void)>([]() {
                return true;
              }));
+
+private:
+  bool checkGlobalPredicate() {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    return globalPredicate();
+  }
 };
 
 
+// A message with structured key=value fields (logfmt), e.g.
+//   info(LogFields("VQE iteration").add("energy", e).add("params", x));
+// is "VQE iteration energy=-1.13 params=[0.1,0.5]". Values containing
+// spaces, '=' or '"' are quoted.
+class LogFields {
+public:
+  explicit LogFields(const std::string &msg) { m_ss << msg; }
+
+  template <typename T> LogFields &add(const std::string &key, const T &value) {
+    std::stringstream ss;
+    ss << std::setprecision(12);
+    write(ss, value);
+    auto str = ss.str();
+    if (str.find_first_of(" =\"") != std::string::npos) {
+      std::string quoted = "\"";
+      for (auto c : str) {
+        if (c == '"' || c == '\\') {
+          quoted += '\\';
+        }
+        quoted += c;
+      }
+      str = quoted + "\"";
+    }
+    m_ss << " " << key << "=" << str;
+    return *this;
+  }
+
+  std::string str() const { return m_ss.str(); }
+  operator std::string() const { return str(); }
+
+private:
+  template <typename T> static void write(std::ostream &os, const T &value) {
+    os << value;
+  }
+  template <typename T>
+  static void write(std::ostream &os, const std::vector<T> &values) {
+    os << "[";
+    for (std::size_t i = 0; i < values.size(); i++) {
+      os << (i ? "," : "");
+      write(os, values[i]);
+    }
+    os << "]";
+  }
+  static void write(std::ostream &os, bool value) {
+    os << (value ? "true" : "false");
+  }
+
+  std::stringstream m_ss;
+};
+
 template <typename T> std::vector<T> linspace(T a, T b, size_t N) {
   T h = (b - a) / static_cast<T>(N - 1);
   std::vector<T> xs(N);
@@ -274,15 +363,71 @@ void slowFunc {
   ... irrelevant code
 */
 // This will log the timing data of that specific code block.
+// (3) Record hierarchical spans instead of logging, see SpanRecorder:
+/*
+ SpanRecorder recorder;
+ {
+  ScopeTimer iteration("iteration", &recorder);
+  iteration.phase("bind");
+  .... code
+  iteration.phase("execute");
+  .... code
+ }
+ recorder.breakdown("iteration"); // {"bind": [ms], "execute": [ms], ...}
+*/
+class SpanRecorder;
 class ScopeTimer {
 public:
   ScopeTimer(const std::string& scopeName, bool shouldLog = true);
+  // A span of recorder (nothing is recorded if it is null), nested in the
+  // spans open in the recorder; it is closed with its phases and children.
+  ScopeTimer(const std::string& scopeName, SpanRecorder *recorder);
+  // Closes the previous phase of this scope, opens name as its child span
+  void phase(const std::string& name);
   double getDurationMs() const;
   ~ScopeTimer();
 private:
   std::chrono::time_point<std::chrono::system_clock> m_startTime;
   bool m_shouldLog;
   std::string m_scopeName;
+  SpanRecorder *m_recorder = nullptr;
+  std::size_t m_depth = 0;
+};
+
+// Named timing spans, nested in one another as they are opened (a stack),
+// e.g. the phases of the iterations of a variational algorithm.
+// Not thread-safe: a recorder is meant for one algorithm execution.
+class SpanRecorder {
+public:
+  struct Span {
+    std::string name;
+    // From the creation of the recorder (microseconds)
+    double start;
+    double duration;
+    // Index of the enclosing span, -1 for a top-level one
+    int parent;
+  };
+
+  SpanRecorder();
+  // Opens name, returns its depth (the number of spans open before)
+  std::size_t begin(const std::string& name);
+  // Closes the spans open at depth and above
+  void end(std::size_t depth);
+  // In opening order; the open spans have a zero duration
+  const std::vector<Span>& spans() const { return m_spans; }
+  // For each span named name (in order, at any depth): its duration under
+  // name and those of its children under their names (0 if it has none of
+  // that name, summed if several), in ms.
+  std::map<std::string, std::vector<double>>
+  breakdown(const std::string& name) const;
+  // Chrome trace event format (chrome://tracing, Perfetto)
+  void writeChromeTrace(const std::string& fileName) const;
+  void clear();
+
+private:
+  std::chrono::steady_clock::time_point m_origin;
+  std::vector<Span> m_spans;
+  std::vector<int> m_open;
 };
 
 // container helper
@@ -13,12 +13,24 @@
 #ifndef XACC_EXPR_PARSING_HPP_
 #define XACC_EXPR_PARSING_HPP_
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "Identifiable.hpp"
 
 namespace xacc {
+
+// A CompiledExpression is an expression that has been parsed once
+// against an ordered list of variable names, and can be re-evaluated
+// for new variable values without re-parsing the expression string.
+class CompiledExpression {
+public:
+  virtual bool evaluate(const std::vector<double> &variableValues,
+                        double &ref) = 0;
+  virtual ~CompiledExpression() {}
+};
+
 class ExpressionParsingUtil : public Identifiable {
 public:
   virtual bool validExpression(const std::string expr,
@@ -28,6 +40,14 @@ public:
                         const std::vector<std::string> variables,
                         const std::vector<double> variableValues,
                         double &ref) = 0;
+
+  // Parse the expression once for repeated evaluation. Returns
+  // nullptr if the expression is invalid or if this implementation
+  // does not support pre-compilation.
+  virtual std::shared_ptr<CompiledExpression>
+  compile(const std::string expr, const std::vector<std::string> variables) {
+    return nullptr;
+  }
 };
 } // namespace xacc
 #endif
\ No newline at end of file
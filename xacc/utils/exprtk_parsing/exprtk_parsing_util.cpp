@@ -19,6 +19,43 @@ using parser_t = exprtk::parser<double>;
 
 namespace xacc {
 
+namespace {
+// Holds the exprtk symbol table and compiled expression tree. The
+// symbol table references the values vector, so evaluating only
+// requires copying the new variable values in place.
+class ExprtkCompiledExpression : public CompiledExpression {
+private:
+  std::vector<double> values;
+  symbol_table_t symbol_table;
+  expression_t expr;
+
+public:
+  ExprtkCompiledExpression(const std::size_t nVariables)
+      : values(nVariables, 0.0) {}
+
+  bool compile(const std::string &exprStr,
+               const std::vector<std::string> &variables) {
+    symbol_table.add_constants();
+    for (int i = 0; i < variables.size(); i++) {
+      symbol_table.add_variable(variables[i], values[i]);
+    }
+    expr.register_symbol_table(symbol_table);
+    parser_t parser;
+    return parser.compile(exprStr, expr);
+  }
+
+  bool evaluate(const std::vector<double> &variableValues,
+                double &ref) override {
+    if (variableValues.size() != values.size()) {
+      return false;
+    }
+    std::copy(variableValues.begin(), variableValues.end(), values.begin());
+    ref = expr.value();
+    return true;
+  }
+};
+} // namespace
+
 bool ExprtkExpressionParsingUtil::validExpression(
     const std::string exprStr, const std::vector<std::string> variables) {
 
@@ -83,4 +120,14 @@ bool ExprtkExpressionParsingUtil::evaluate(
   return false;
 }
 
-} // namespace xacc
\ No newline at end of file
+std::shared_ptr<CompiledExpression>
+ExprtkExpressionParsingUtil::compile(const std::string expression,
+                                     const std::vector<std::string> variables) {
+  auto compiled = std::make_shared<ExprtkCompiledExpression>(variables.size());
+  if (compiled->compile(expression, variables)) {
+    return compiled;
+  }
+  return nullptr;
+}
+
+} // namespace xacc
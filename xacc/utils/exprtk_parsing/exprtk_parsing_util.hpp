@@ -25,6 +25,9 @@ public:
   bool evaluate(const std::string expr,
                 const std::vector<std::string> variables,
                 const std::vector<double> variableValues, double &ref) override;
+  std::shared_ptr<CompiledExpression>
+  compile(const std::string expr,
+          const std::vector<std::string> variables) override;
   const std::string name() const override { return "exprtk"; }
   const std::string description() const override { return ""; }
 };
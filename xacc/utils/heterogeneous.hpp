@@ -13,6 +13,7 @@
 #ifndef XACC_HETEROGENEOUS_HPP_
 #define XACC_HETEROGENEOUS_HPP_
 
+#include <algorithm>
 #include <initializer_list>
 #include <map>
 #include <stdexcept>
@@ -62,22 +63,25 @@ union Storage {
 };
 typedef void (*funcPtr)(void);
 
-template <typename T> T force_cast(std::any in_any) {
+template <typename T> const T *force_cast_ptr(const std::any &in_any) {
   static_assert(sizeof(std::any) == sizeof(funcPtr) + sizeof(Storage));
-  void *storageLoc = (void *)((std::uintptr_t)&in_any + sizeof(funcPtr));
-  Storage &storage = *reinterpret_cast<Storage *>(storageLoc);
+  const void *storageLoc =
+      (const void *)((std::uintptr_t)&in_any + sizeof(funcPtr));
+  const Storage &storage = *reinterpret_cast<const Storage *>(storageLoc);
   constexpr bool fit =
       (sizeof(T) <= sizeof(Storage)) && (alignof(T) <= alignof(Storage));
   if (fit) {
-    auto val = reinterpret_cast<T *>(&(storage._M_buffer));
-    return *val;
+    return reinterpret_cast<const T *>(&(storage._M_buffer));
   } else {
-    auto val = reinterpret_cast<T *>(storage._M_ptr);
-    return *val;
+    return reinterpret_cast<const T *>(storage._M_ptr);
   }
 }
 
-template <typename T> bool isType(std::any in_any) {
+template <typename T> T force_cast(const std::any &in_any) {
+  return *force_cast_ptr<T>(in_any);
+}
+
+template <typename T> bool isType(const std::any &in_any) {
   if ((in_any.type() == typeid(T)) ||
       (strcmp(in_any.type().name(), typeid(T).name()) == 0)) {
     return true;
@@ -106,12 +110,18 @@ public:
   HeterogeneousMap() = default;
   HeterogeneousMap(const HeterogeneousMap &_other) { *this = _other; }
   HeterogeneousMap(HeterogeneousMap &_other) { *this = _other; }
+  HeterogeneousMap(HeterogeneousMap &&_other) noexcept
+      : items(std::move(_other.items)) {}
 
   HeterogeneousMap &operator=(const HeterogeneousMap &_other) {
     clear();
     items = _other.items;
     return *this;
   }
+  HeterogeneousMap &operator=(HeterogeneousMap &&_other) noexcept {
+    items = std::move(_other.items);
+    return *this;
+  }
 
   template <typename T> void loop_pairs(T value) {
     insert(value.first, value.second);
@@ -143,38 +153,55 @@ public:
     visit(v);
   }
 
-  template <class T> void insert(const std::string key, const T &_t) {
-    if (items.count(key)) {
-      items.at(key) = _t;
+  template <class T> void insert(const std::string &key, const T &_t) {
+    auto iter = lower_bound(key);
+    if (iter != items.end() && iter->first == key) {
+      iter->second = _t;
     } else {
-      items.insert({key, _t});
+      items.emplace(iter, key, _t);
     }
   }
 
-  template <typename T> const T get(const std::string key) const {
-    try {
-      return std::any_cast<T>(items.at(key));
-    } catch (std::exception &e) {
-#ifdef APPLY_RTTI_ANY_CAST_FIX
-      if (keyExists<T>(key)) {
-        // Make sure that the assumption about std::any layout is correct
-        if (sizeof(std::any) ==
-            (sizeof(__internal::funcPtr) + sizeof(__internal::Storage))) {
-          return __internal::force_cast<T>(items.at(key));
-        }
-      }
-#endif
-      XACCLogger::instance()->error(
-          "HeterogeneousMap::get() error - Invalid type or key (" + key + ").");
+  template <typename T> const T get(const std::string &key) const {
+    if (auto value = find<T>(key)) {
+      return *value;
     }
+    XACCLogger::instance()->error(
+        "HeterogeneousMap::get() error - Invalid type or key (" + key + ").");
     return T();
   }
 
-  template <class T> const T get_with_throw(const std::string key) const {
-    return std::any_cast<T>(items.at(key));
+  template <class T> const T get_with_throw(const std::string &key) const {
+    auto iter = lower_bound(key);
+    if (iter == items.end() || iter->first != key) {
+      throw std::out_of_range("HeterogeneousMap::get_with_throw() - Invalid "
+                              "key (" + key + ").");
+    }
+    return std::any_cast<T>(iter->second);
   }
 
-  bool stringExists(const std::string key) const {
+  // The value at key if it is a T, nullptr otherwise (no copy, no throw).
+  // Invalidated by the next insertion.
+  template <typename T> const T *find(const std::string &key) const {
+    auto iter = lower_bound(key);
+    if (iter == items.end() || iter->first != key) {
+      return nullptr;
+    }
+    if (auto value = std::any_cast<T>(&iter->second)) {
+      return value;
+    }
+#ifdef APPLY_RTTI_ANY_CAST_FIX
+    // Make sure that the assumption about std::any layout is correct
+    if (__internal::isType<T>(iter->second) &&
+        sizeof(std::any) ==
+            (sizeof(__internal::funcPtr) + sizeof(__internal::Storage))) {
+      return __internal::force_cast_ptr<T>(iter->second);
+    }
+#endif
+    return nullptr;
+  }
+
+  bool stringExists(const std::string &key) const {
     if (keyExists<const char *>(key)) {
       return true;
     }
@@ -184,7 +211,7 @@ public:
     return false;
   }
 
-  const std::string getString(const std::string key) const {
+  const std::string getString(const std::string &key) const {
     if (keyExists<const char *>(key)) {
       return get<const char *>(key);
     } else if (keyExists<std::string>(key)) {
@@ -199,14 +226,13 @@ public:
 
   template <typename T>
   const T get_or_default(const std::string &key, const T _default) const {
-    if (keyExists<T>(key)) {
-      return get<T>(key);
-    } else {
-      return _default;
+    if (auto value = find<T>(key)) {
+      return *value;
     }
+    return _default;
   }
 
-  template <typename T> bool pointerLikeExists(const std::string key) const {
+  template <typename T> bool pointerLikeExists(const std::string &key) const {
     if (keyExists<T *>(key)) {
       return true;
     } else if (keyExists<std::shared_ptr<T>>(key)) {
@@ -215,11 +241,11 @@ public:
       return false;
     }
   }
-  template <typename T> T *getPointerLike(const std::string key) const {
-    if (keyExists<T *>(key)) {
-      return get<T *>(key);
-    } else if (keyExists<std::shared_ptr<T>>(key)) {
-      return get<std::shared_ptr<T>>(key).get();
+  template <typename T> T *getPointerLike(const std::string &key) const {
+    if (auto value = find<T *>(key)) {
+      return *value;
+    } else if (auto shared = find<std::shared_ptr<T>>(key)) {
+      return shared->get();
     } else {
       XACCLogger::instance()->error("No pointer-like value at provided key (" +
                                     key + ").");
@@ -235,25 +261,13 @@ public:
     return v.count;
   }
 
-  bool key_exists_any_type(const std::string key) const {
-    return items.count(key);
+  bool key_exists_any_type(const std::string &key) const {
+    auto iter = lower_bound(key);
+    return iter != items.end() && iter->first == key;
   }
 
-  template <typename T> bool keyExists(const std::string key) const {
-    if (items.count(key)) {
-      // we have the key, make sure it is the right type
-      try {
-        std::any_cast<T>(items.at(key));
-      } catch (std::exception &e) {
-#ifdef APPLY_RTTI_ANY_CAST_FIX
-        return __internal::isType<T>(items.at(key));
-#else
-        return false;
-#endif
-      }
-      return true;
-    }
-    return false;
+  template <typename T> bool keyExists(const std::string &key) const {
+    return find<T>(key) != nullptr;
   }
 
   size_t size() const { return items.size(); }
@@ -267,12 +281,26 @@ public:
   // Merge another map to this.
   void merge(const HeterogeneousMap &_other) {
     for (const auto &[key, item] : _other.items) {
-      items[key] = item;
+      insert(key, item);
     }
   }
 
 private:
-  std::map<std::string, std::any> items;
+  // Sorted by key (the std::map iteration order): these maps are small and
+  // looked up in the hot paths, a contiguous binary search beats the nodes.
+  using Item = std::pair<std::string, std::any>;
+  std::vector<Item> items;
+
+  std::vector<Item>::iterator lower_bound(const std::string &key) {
+    return std::lower_bound(
+        items.begin(), items.end(), key,
+        [](const Item &item, const std::string &k) { return item.first < k; });
+  }
+  std::vector<Item>::const_iterator lower_bound(const std::string &key) const {
+    return std::lower_bound(
+        items.begin(), items.end(), key,
+        [](const Item &item, const std::string &k) { return item.first < k; });
+  }
 
   template <typename T>
   class _internal_number_of_visitor : public visitor_base<T> {
@@ -296,18 +324,17 @@ private:
 
   template <class T, class HEAD, class... TAIL> struct try_visit {
     template <class U> static void apply(T &visitor, U &&element) {
-      try {
-        visitor(element.first, std::any_cast<HEAD>(element.second));
-      } catch (...) {
+      if (auto value = std::any_cast<HEAD>(&element.second)) {
+        visitor(element.first, *value);
+      } else {
         try_visit<T, TAIL...>::apply(visitor, element);
       }
     }
   };
   template <class T, class HEAD> struct try_visit<T, HEAD> {
     template <class U> static void apply(T &visitor, U &&element) {
-      try {
-        visitor(element.first, std::any_cast<HEAD>(element.second));
-      } catch (...) {
+      if (auto value = std::any_cast<HEAD>(&element.second)) {
+        visitor(element.first, *value);
       }
     }
   };
@@ -320,18 +347,18 @@ private:
 };
 
 // Make sure these basic types are always instantiatied for HeterogeneousMap
-template const bool HeterogeneousMap::get<bool>(const std::string key) const;
-template const int HeterogeneousMap::get<int>(const std::string key) const;
+template const bool HeterogeneousMap::get<bool>(const std::string &key) const;
+template const int HeterogeneousMap::get<int>(const std::string &key) const;
 template const double
-HeterogeneousMap::get<double>(const std::string key) const;
+HeterogeneousMap::get<double>(const std::string &key) const;
 template const std::vector<std::complex<double>>
 HeterogeneousMap::get<std::vector<std::complex<double>>>(
-    const std::string key) const;
+    const std::string &key) const;
 template const std::vector<double>
-HeterogeneousMap::get<std::vector<double>>(const std::string key) const;
+HeterogeneousMap::get<std::vector<double>>(const std::string &key) const;
 template const std::vector<double>
 HeterogeneousMap::get_with_throw<std::vector<double>>(
-    const std::string key) const;
+    const std::string &key) const;
 
 template <typename... Types> class Variant : public mpark::variant<Types...> {
 
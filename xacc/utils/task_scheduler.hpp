@@ -0,0 +1,46 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_TASK_SCHEDULER_HPP_
+#define XACC_TASK_SCHEDULER_HPP_
+
+#include <functional>
+#include <future>
+
+#include "Identifiable.hpp"
+
+namespace xacc {
+
+// The TaskScheduler is the runtime-wide pool of worker threads.
+// Simulators, decorators, observables and algorithms should submit
+// their parallel work here (see xacc::getTaskScheduler()) rather than
+// spawning their own threads, so that nested parallelism does not
+// oversubscribe the host.
+class TaskScheduler : public Identifiable {
+public:
+  virtual void setNumberOfThreads(const int nThreads) = 0;
+  virtual int getNumberOfThreads() const = 0;
+
+  // Schedule a task, the returned future rethrows any exception it throws.
+  virtual std::future<void> submit(std::function<void()> task) = 0;
+
+  // Split [begin, end) into contiguous chunks and run body(chunkBegin,
+  // chunkEnd) on each, returning once all chunks are done. The calling
+  // thread takes part in the work, so this may be called from a task.
+  virtual void
+  parallelFor(const std::size_t begin, const std::size_t end,
+              const std::function<void(std::size_t, std::size_t)> &body) = 0;
+
+  virtual ~TaskScheduler() {}
+};
+} // namespace xacc
+#endif
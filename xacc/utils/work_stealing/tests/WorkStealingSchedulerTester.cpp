@@ -0,0 +1,77 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#include <gtest/gtest.h>
+#include "xacc.hpp"
+#include "task_scheduler.hpp"
+
+#include <atomic>
+#include <numeric>
+
+using namespace xacc;
+
+TEST(WorkStealingSchedulerTester, checkThreadsOption) {
+  auto scheduler = xacc::getTaskScheduler();
+  EXPECT_EQ(3, scheduler->getNumberOfThreads());
+  EXPECT_EQ(scheduler, xacc::getTaskScheduler());
+}
+
+TEST(WorkStealingSchedulerTester, checkSubmit) {
+  auto scheduler = xacc::getTaskScheduler();
+  std::atomic<int> counter{0};
+  std::vector<std::future<void>> futures;
+  for (int i = 0; i < 100; i++) {
+    futures.emplace_back(scheduler->submit([&]() { counter++; }));
+  }
+  for (auto &f : futures) {
+    f.get();
+  }
+  EXPECT_EQ(100, counter);
+
+  auto failed =
+      scheduler->submit([]() { throw std::runtime_error("task failed"); });
+  EXPECT_THROW(failed.get(), std::runtime_error);
+}
+
+TEST(WorkStealingSchedulerTester, checkNestedParallelFor) {
+  auto scheduler = xacc::getTaskScheduler();
+  std::vector<int> values(1000, 0);
+  // Nested loops must not deadlock the pool
+  scheduler->parallelFor(0, 10, [&](std::size_t begin, std::size_t end) {
+    for (auto i = begin; i < end; i++) {
+      scheduler->parallelFor(
+          i * 100, (i + 1) * 100,
+          [&](std::size_t innerBegin, std::size_t innerEnd) {
+            for (auto j = innerBegin; j < innerEnd; j++) {
+              values[j] = j;
+            }
+          });
+    }
+  });
+  for (int i = 0; i < values.size(); i++) {
+    EXPECT_EQ(i, values[i]);
+  }
+
+  EXPECT_THROW(scheduler->parallelFor(0, 10,
+                                      [](std::size_t begin, std::size_t end) {
+                                        throw std::runtime_error("failed");
+                                      }),
+               std::runtime_error);
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize({"--threads", "3"});
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
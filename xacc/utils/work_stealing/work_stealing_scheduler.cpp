@@ -0,0 +1,185 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#include "work_stealing_scheduler.hpp"
+
+#include <exception>
+
+namespace {
+// The scheduler and queue index of the current worker thread, if any
+thread_local const xacc::WorkStealingTaskScheduler *currentScheduler =
+    nullptr;
+thread_local std::size_t currentWorker = 0;
+} // namespace
+
+namespace xacc {
+
+WorkStealingTaskScheduler::WorkStealingTaskScheduler() {
+  start(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+WorkStealingTaskScheduler::~WorkStealingTaskScheduler() { stop(); }
+
+void WorkStealingTaskScheduler::setNumberOfThreads(const int nThreads) {
+  if (nThreads == workers.size()) {
+    return;
+  }
+  // Pending tasks are drained by the old workers first
+  stop();
+  start(std::max(1, nThreads));
+}
+
+void WorkStealingTaskScheduler::start(const int nThreads) {
+  stopping = false;
+  queues.clear();
+  for (int i = 0; i < nThreads; i++) {
+    queues.emplace_back(std::make_unique<WorkQueue>());
+  }
+  for (int i = 0; i < nThreads; i++) {
+    workers.emplace_back([this, i]() { workerLoop(i); });
+  }
+}
+
+void WorkStealingTaskScheduler::stop() {
+  {
+    std::lock_guard<std::mutex> guard(sleepLock);
+    stopping = true;
+  }
+  wakeUp.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  workers.clear();
+}
+
+void WorkStealingTaskScheduler::enqueue(std::function<void()> task) {
+  const auto queueIdx = currentScheduler == this
+                            ? currentWorker
+                            : nextQueue++ % queues.size();
+  {
+    std::lock_guard<std::mutex> guard(queues[queueIdx]->lock);
+    queues[queueIdx]->tasks.emplace_back(std::move(task));
+    nQueued++;
+  }
+  // Synchronize with the predicate check in workerLoop
+  // so that the notification can't be missed.
+  { std::lock_guard<std::mutex> guard(sleepLock); }
+  wakeUp.notify_one();
+}
+
+bool WorkStealingTaskScheduler::runPendingTask(
+    const std::size_t preferredQueue) {
+  std::function<void()> task;
+  for (std::size_t i = 0; i < queues.size() && !task; i++) {
+    const auto queueIdx = (preferredQueue + i) % queues.size();
+    auto &queue = *queues[queueIdx];
+    std::lock_guard<std::mutex> guard(queue.lock);
+    if (queue.tasks.empty()) {
+      continue;
+    }
+    if (i == 0) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    } else {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+    nQueued--;
+  }
+
+  if (!task) {
+    return false;
+  }
+  task();
+  return true;
+}
+
+void WorkStealingTaskScheduler::workerLoop(const std::size_t workerIdx) {
+  currentScheduler = this;
+  currentWorker = workerIdx;
+  while (true) {
+    if (runPendingTask(workerIdx)) {
+      continue;
+    }
+    std::unique_lock<std::mutex> guard(sleepLock);
+    wakeUp.wait(guard, [this]() { return stopping || nQueued > 0; });
+    if (stopping && nQueued == 0) {
+      break;
+    }
+  }
+  currentScheduler = nullptr;
+}
+
+std::future<void>
+WorkStealingTaskScheduler::submit(std::function<void()> task) {
+  // std::function must be copyable, so share the packaged_task
+  auto packagedTask =
+      std::make_shared<std::packaged_task<void()>>(std::move(task));
+  auto future = packagedTask->get_future();
+  enqueue([packagedTask]() { (*packagedTask)(); });
+  return future;
+}
+
+void WorkStealingTaskScheduler::parallelFor(
+    const std::size_t begin, const std::size_t end,
+    const std::function<void(std::size_t, std::size_t)> &body) {
+  if (end <= begin) {
+    return;
+  }
+  const std::size_t n = end - begin;
+  const std::size_t nChunks = std::min<std::size_t>(n, workers.size());
+  if (nChunks <= 1) {
+    body(begin, end);
+    return;
+  }
+
+  const auto chunkBegin = [&](std::size_t chunk) {
+    return begin + chunk * n / nChunks;
+  };
+
+  std::atomic<std::size_t> remaining{nChunks - 1};
+  std::exception_ptr firstError;
+  std::mutex errorLock;
+  const auto runChunk = [&](std::size_t chunk) {
+    try {
+      body(chunkBegin(chunk), chunkBegin(chunk + 1));
+    } catch (...) {
+      std::lock_guard<std::mutex> guard(errorLock);
+      if (!firstError) {
+        firstError = std::current_exception();
+      }
+    }
+  };
+
+  for (std::size_t chunk = 1; chunk < nChunks; chunk++) {
+    enqueue([&, chunk]() {
+      runChunk(chunk);
+      remaining--;
+    });
+  }
+  runChunk(0);
+
+  // Help with queued work rather than block, nested
+  // parallelFor calls could otherwise deadlock the pool.
+  const auto preferredQueue =
+      currentScheduler == this ? currentWorker : std::size_t(0);
+  while (remaining > 0) {
+    if (!runPendingTask(preferredQueue)) {
+      std::this_thread::yield();
+    }
+  }
+
+  if (firstError) {
+    std::rethrow_exception(firstError);
+  }
+}
+} // namespace xacc
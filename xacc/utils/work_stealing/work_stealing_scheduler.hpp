@@ -0,0 +1,72 @@
+/*******************************************************************************
+ * Copyright (c) 2020 UT-Battelle, LLC.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompanies this
+ * distribution. The Eclipse Public License is available at
+ * http://www.eclipse.org/legal/epl-v10.html and the Eclipse Distribution
+ *License is available at https://eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *   Alexander J. McCaskey - initial API and implementation
+ *******************************************************************************/
+#ifndef XACC_WORK_STEALING_SCHEDULER_HPP_
+#define XACC_WORK_STEALING_SCHEDULER_HPP_
+
+#include "task_scheduler.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace xacc {
+// Each worker owns a task deque. Workers pop their own most recent task
+// and steal the oldest task from the others when they run out. Tasks
+// submitted from a worker go to that worker's deque, others are
+// distributed round-robin.
+class WorkStealingTaskScheduler : public TaskScheduler {
+public:
+  WorkStealingTaskScheduler();
+  ~WorkStealingTaskScheduler();
+
+  void setNumberOfThreads(const int nThreads) override;
+  int getNumberOfThreads() const override { return workers.size(); }
+
+  std::future<void> submit(std::function<void()> task) override;
+  void parallelFor(
+      const std::size_t begin, const std::size_t end,
+      const std::function<void(std::size_t, std::size_t)> &body) override;
+
+  const std::string name() const override { return "work-stealing"; }
+  const std::string description() const override {
+    return "Work-stealing pool of worker threads.";
+  }
+
+private:
+  struct WorkQueue {
+    std::mutex lock;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  std::vector<std::unique_ptr<WorkQueue>> queues;
+  std::vector<std::thread> workers;
+  std::mutex sleepLock;
+  std::condition_variable wakeUp;
+  std::atomic<std::size_t> nQueued{0};
+  std::atomic<std::size_t> nextQueue{0};
+  bool stopping = false;
+
+  void start(const int nThreads);
+  void stop();
+  void workerLoop(const std::size_t workerIdx);
+  void enqueue(std::function<void()> task);
+  // Run one queued task, preferring the given queue. Returns false if
+  // there was nothing to run.
+  bool runPendingTask(const std::size_t preferredQueue);
+};
+} // namespace xacc
+#endif
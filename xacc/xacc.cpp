@@ -15,6 +15,7 @@
 #include "IRProvider.hpp"
 #include "CLIParser.hpp"
 #include <memory>
+#include <mutex>
 #include <signal.h>
 #include <cstdlib>
 #include <fstream>
@@ -41,9 +42,15 @@ char **argv = NULL;
 std::map<std::string, std::shared_ptr<CompositeInstruction>>
     compilation_database{};
 std::map<std::string, std::shared_ptr<AcceleratorBuffer>> allocated_buffers{};
+// Not held while calling xacc::error, which finalizes the framework.
+std::mutex compilationDatabaseLock;
+std::mutex allocatedBuffersLock;
 
 std::string rootPathString = "";
 
+std::shared_ptr<TaskScheduler> taskScheduler;
+std::mutex taskSchedulerLock;
+
 void set_verbose(bool v) { verbose = v; }
 
 int getArgc() { return argc; }
@@ -100,6 +107,10 @@ void Initialize(int arc, char **arv) {
   // initialized
   xacc::xaccFrameworkInitialized = true;
 
+  if (optionExists("logger-async")) {
+    setLoggingAsync(true);
+  }
+
   if (!optionExists("queue-preamble")) {
     XACCLogger::instance()->dumpQueue();
   }
@@ -122,6 +133,17 @@ void setLoggingLevel(int level) {
 
 int getLoggingLevel() { return XACCLogger::instance()->getLoggingLevel(); }
 
+void setLoggingAsync(bool enable) { XACCLogger::instance()->setAsync(enable); }
+
+bool loggingEnabled(int level) {
+#ifndef _XACC_DEBUG
+  if (level > 1) {
+    return false;
+  }
+#endif
+  return verbose && XACCLogger::instance()->isEnabled(level);
+}
+
 void subscribeLoggingLevel(LoggingLevelNotification callback) {
   XACCLogger::instance()->subscribeLoggingLevel(callback);
 }
@@ -160,6 +182,7 @@ qbit qalloc(const int n) {
   std::stringstream ss;
   ss << "qreg_" << q;
   q->setName(ss.str());
+  std::lock_guard<std::mutex> lock(allocatedBuffersLock);
   allocated_buffers.insert({ss.str(), q});
   return q;
 }
@@ -168,54 +191,70 @@ qbit qalloc() {
   std::stringstream ss;
   ss << "qreg_" << q;
   q->setName(ss.str());
+  std::lock_guard<std::mutex> lock(allocatedBuffersLock);
   allocated_buffers.insert({ss.str(), q});
   return q;
 }
 
+qbit qalloc(std::istream &stream) {
+  qbit q;
+  q->load(stream);
+  storeBuffer(q);
+  return q;
+}
+
 void storeBuffer(std::shared_ptr<AcceleratorBuffer> buffer) {
   auto name = buffer->name();
-  if (allocated_buffers.count(name)) {
-    // error("Invalid buffer name to store: " + name);
-    allocated_buffers[name] = buffer;
-  } else {
-    allocated_buffers.insert({name, buffer});
-  }
+  std::lock_guard<std::mutex> lock(allocatedBuffersLock);
+  // error("Invalid buffer name to store: " + name);
+  allocated_buffers[name] = buffer;
 }
 
 void storeBuffer(const std::string name,
                  std::shared_ptr<AcceleratorBuffer> buffer) {
-  if (allocated_buffers.count(name)) {
-    error("Invalid buffer name to store: " + name);
-  }
-  // if this buffer is in here already before we
-  // set its new name, we should remove it from the allocation
-  if (allocated_buffers.count(buffer->name())) {
-    allocated_buffers.erase(buffer->name());
+  {
+    std::lock_guard<std::mutex> lock(allocatedBuffersLock);
+    if (!allocated_buffers.count(name)) {
+      // if this buffer is in here already before we
+      // set its new name, we should remove it from the allocation
+      allocated_buffers.erase(buffer->name());
+      buffer->setName(name);
+      allocated_buffers.insert({name, buffer});
+      return;
+    }
   }
-
-  buffer->setName(name);
-  allocated_buffers.insert({name, buffer});
+  error("Invalid buffer name to store: " + name);
 }
 
 std::shared_ptr<AcceleratorBuffer> getBuffer(const std::string &name) {
-  if (!allocated_buffers.count(name)) {
-    error("Invalid buffer name: " + name);
+  {
+    std::lock_guard<std::mutex> lock(allocatedBuffersLock);
+    auto iter = allocated_buffers.find(name);
+    if (iter != allocated_buffers.end()) {
+      return iter->second;
+    }
   }
-  return allocated_buffers[name];
+  error("Invalid buffer name: " + name);
+  return nullptr;
 }
 bool hasBuffer(const std::string &name) {
+  std::lock_guard<std::mutex> lock(allocatedBuffersLock);
   return allocated_buffers.count(name);
 }
 std::shared_ptr<AcceleratorBuffer>
 getClassicalRegHostBuffer(const std::string &cRegName) {
-  if (hasBuffer(cRegName)) {
-    return getBuffer(cRegName);
-  }
+  {
+    std::lock_guard<std::mutex> lock(allocatedBuffersLock);
+    auto iter = allocated_buffers.find(cRegName);
+    if (iter != allocated_buffers.end()) {
+      return iter->second;
+    }
 
-  for (auto &[bufferName, allocated_buffer] : allocated_buffers) {
-    if (xacc::container::contains(allocated_buffer->getClassicalRegs(),
-                                  cRegName)) {
-      return allocated_buffer;
+    for (auto &[bufferName, allocated_buffer] : allocated_buffers) {
+      if (xacc::container::contains(allocated_buffer->getClassicalRegs(),
+                                    cRegName)) {
+        return allocated_buffer;
+      }
     }
   }
 
@@ -242,24 +281,18 @@ bool optionExists(const std::string &optionKey) {
 }
 
 const std::string getOption(const std::string &optionKey) {
-  if (!optionExists(optionKey)) {
+  std::string value;
+  if (!RuntimeOptions::instance()->get(optionKey, value)) {
     error("Invalid runtime option - " + optionKey);
   }
-  return (*RuntimeOptions::instance())[optionKey];
+  return value;
 }
 
 void setOption(const std::string &optionKey, const std::string &value) {
-  if (optionExists(optionKey)) {
-    (*RuntimeOptions::instance())[optionKey] = value;
-  } else {
-    RuntimeOptions::instance()->insert(std::make_pair(optionKey, value));
-  }
+  RuntimeOptions::instance()->set(optionKey, value);
 }
 void unsetOption(const std::string &optionKey) {
-  if (optionExists(optionKey)) {
-    (*RuntimeOptions::instance()).erase(optionKey);
-  }
-  return;
+  RuntimeOptions::instance()->erase(optionKey);
 }
 
 void setCompiler(const std::string &compilerName) {
@@ -506,6 +539,23 @@ std::shared_ptr<Optimizer> getOptimizer(const std::string name,
   return getOptimizer(name, opts);
 }
 
+std::shared_ptr<TaskScheduler> getTaskScheduler() {
+  if (!xacc::xaccFrameworkInitialized) {
+    error("XACC not initialized before use. Please execute "
+          "xacc::Initialize() before using API.");
+  }
+
+  // Service lookup is a linear scan, so cache the scheduler
+  std::lock_guard<std::mutex> guard(taskSchedulerLock);
+  if (!taskScheduler) {
+    taskScheduler = xacc::getService<TaskScheduler>("work-stealing");
+    if (optionExists("threads")) {
+      taskScheduler->setNumberOfThreads(std::stoi(getOption("threads")));
+    }
+  }
+  return taskScheduler;
+}
+
 std::shared_ptr<IRProvider> getIRProvider(const std::string &name) {
   if (!xacc::xaccFrameworkInitialized) {
     error("XACC not initialized before use. Please execute "
@@ -525,14 +575,14 @@ std::shared_ptr<Compiler> getCompiler() {
     error("XACC not initialized before use. Please execute "
           "xacc::Initialize() before using API.");
   }
-  auto options = RuntimeOptions::instance();
   if (!optionExists("compiler")) {
     error("Invalid use of XACC API. getCompiler() with no string argument "
           "requires that you set --compiler at the command line.");
   }
-  auto compiler = xacc::getService<Compiler>(getOption("compiler"));
+  const auto compilerName = getOption("compiler");
+  auto compiler = xacc::getService<Compiler>(compilerName);
   if (!compiler) {
-    error("Invalid Compiler. Could not find " + (*options)["compiler"] +
+    error("Invalid Compiler. Could not find " + compilerName +
           " in Compiler Registry.");
   }
   return compiler;
@@ -574,6 +624,12 @@ const std::string translate(std::shared_ptr<CompositeInstruction> ci,
   return toLanguageCompiler->translate(ci);
 }
 
+void translate(std::shared_ptr<CompositeInstruction> ci,
+               const std::string toLanguage, std::ostream &out) {
+  auto toLanguageCompiler = getCompiler(toLanguage);
+  toLanguageCompiler->translateStream(ci, out);
+}
+
 void clearOptions() { RuntimeOptions::instance()->clear(); }
 
 bool hasCache(const std::string fileName, const std::string subdirectory) {
@@ -653,27 +709,34 @@ const std::string getRootDirectory() { return xacc::getRootPathString(); }
 
 void appendCompiled(std::shared_ptr<CompositeInstruction> composite,
                     bool _override) {
-  if (!_override) {
-    if (compilation_database.count(composite->name())) {
-      xacc::error("Invalid CompositeInstruction name, already in compilation "
-                  "database: " +
-                  composite->name() + ".");
+  {
+    std::lock_guard<std::mutex> lock(compilationDatabaseLock);
+    if (_override || !compilation_database.count(composite->name())) {
+      compilation_database[composite->name()] = composite;
+      return;
     }
   }
-
-  compilation_database[composite->name()] = composite;
+  xacc::error("Invalid CompositeInstruction name, already in compilation "
+              "database: " +
+              composite->name() + ".");
 }
 bool hasCompiled(const std::string name) {
+  std::lock_guard<std::mutex> lock(compilationDatabaseLock);
   return compilation_database.count(name);
 }
 
 std::shared_ptr<CompositeInstruction> getCompiled(const std::string name) {
-  if (!compilation_database.count(name)) {
-    xacc::error(
-        "Invalid CompositeInstruction requested. Not in compilation database " +
-        name);
+  {
+    std::lock_guard<std::mutex> lock(compilationDatabaseLock);
+    auto iter = compilation_database.find(name);
+    if (iter != compilation_database.end()) {
+      return iter->second;
+    }
   }
-  return compilation_database[name];
+  xacc::error(
+      "Invalid CompositeInstruction requested. Not in compilation database " +
+      name);
+  return nullptr;
 }
 
 void qasm(const std::string &qasmString) {
@@ -809,9 +872,11 @@ void unload_external_language_plugins() {
 
 void Finalize() {
   XACCLogger::instance()->dumpQueue();
+  XACCLogger::instance()->flush();
   if (xaccFrameworkInitialized) {
     // Execute tearDown() for all registered TearDown services.
-    auto tearDowns = xacc::getServices<TearDown>();
+    // The plugins that were not loaded have nothing to tear down.
+    auto tearDowns = xacc::getServices<TearDown>(false);
     debug("Tearing down " + std::to_string(tearDowns.size()) +
           " registered TearDown services..");
     std::vector<std::shared_ptr<TearDown>> frameworkTearDowns;
@@ -836,8 +901,15 @@ void Finalize() {
     }
 
     xacc::xaccFrameworkInitialized = false;
-    compilation_database.clear();
-    allocated_buffers.clear();
+    {
+      std::lock_guard<std::mutex> lock(compilationDatabaseLock);
+      compilation_database.clear();
+    }
+    {
+      std::lock_guard<std::mutex> lock(allocatedBuffersLock);
+      allocated_buffers.clear();
+    }
+    taskScheduler.reset();
     xacc::ServiceAPI_Finalize();
   }
 }
@@ -20,6 +20,7 @@
 #include "Algorithm.hpp"
 #include "Optimizer.hpp"
 #include "IRTransformation.hpp"
+#include "task_scheduler.hpp"
 
 #include "heterogeneous.hpp"
 
@@ -46,6 +47,24 @@ extern char **argv;
 
 extern std::string rootPathString;
 
+// Concurrent use of the runtime API, e.g. independent VQE workflows run on
+// several threads of a process (after xacc::Initialize, before Finalize):
+// - The buffer (qalloc, storeBuffer, getBuffer, ...), compilation database
+// (appendCompiled, getCompiled, ...), runtime option (setOption, getOption,
+// ...), service lookup and logging functions are thread safe. Access the
+// maps below through them only.
+// - getService returns a new instance of the Cloneable services with
+// shouldClone() true, e.g. Algorithms and Observables: each thread gets its
+// own. Other services are shared instances: Accelerators, Optimizers,
+// Compilers, IRTransformations, etc.
+// - Among the shared ones, the 'qpp' Accelerator and the 'nlopt' Optimizer are
+// Cloneable (shouldClone() false): clone() gives an instance a thread can
+// configure and use on its own, e.g.
+//   auto qpp = std::dynamic_pointer_cast<Cloneable<Accelerator>>(
+//                  xacc::getAccelerator("qpp"))->clone();
+//   qpp->initialize({{"shots", 1024}});
+// Configuring a shared instance (getAccelerator with parameters,
+// Optimizer::setOptions) affects all of its users.
 extern std::map<std::string, std::shared_ptr<CompositeInstruction>>
     compilation_database;
 extern std::map<std::string, std::shared_ptr<AcceleratorBuffer>>
@@ -71,6 +90,9 @@ public:
 };
 qbit qalloc(const int n);
 qbit qalloc();
+// Restore a buffer from the output of AcceleratorBuffer::print
+// or AcceleratorBuffer::printBinary.
+qbit qalloc(std::istream &stream);
 
 void Initialize(int argc, char **argv);
 
@@ -99,6 +121,11 @@ void logToFile(bool enable, const std::string &fileNamePrefix = "");
 void setLoggingLevel(int level);
 int getLoggingLevel();
 void subscribeLoggingLevel(LoggingLevelNotification callback);
+// Log from a background thread (what the "logger-async" option sets),
+// with messages dropped rather than blocking when the queue is full.
+void setLoggingAsync(bool enable);
+// Would info() (level 1), warning() (0) or debug() (2) log anything?
+bool loggingEnabled(int level);
 
 void info(const std::string &msg,
           MessagePredicate predicate = std::function<bool(void)>([]() {
@@ -117,6 +144,25 @@ void error(const std::string &msg,
              return true;
            }));
 
+// Log the message only if it would be logged, so that it is not even
+// built otherwise, e.g. in hot loops:
+//   XACC_LOG_INFO("Energy = " + std::to_string(energy));
+#define XACC_LOG_INFO(...)                                                     \
+  do {                                                                         \
+    if (xacc::loggingEnabled(1))                                               \
+      xacc::info(__VA_ARGS__);                                                 \
+  } while (false)
+#define XACC_LOG_WARNING(...)                                                  \
+  do {                                                                         \
+    if (xacc::loggingEnabled(0))                                               \
+      xacc::warning(__VA_ARGS__);                                              \
+  } while (false)
+#define XACC_LOG_DEBUG(...)                                                    \
+  do {                                                                         \
+    if (xacc::loggingEnabled(2))                                               \
+      xacc::debug(__VA_ARGS__);                                                \
+  } while (false)
+
 void clearOptions();
 bool optionExists(const std::string &optionKey);
 const std::string getOption(const std::string &optionKey);
@@ -125,6 +171,10 @@ void unsetOption(const std::string &optionKey);
 
 std::shared_ptr<IRProvider> getIRProvider(const std::string &name);
 
+// Return the runtime-wide task scheduler. Its number of threads
+// is set by the 'threads' option given to xacc::Initialize.
+std::shared_ptr<TaskScheduler> getTaskScheduler();
+
 void storeBuffer(std::shared_ptr<AcceleratorBuffer> buffer);
 void storeBuffer(const std::string name,
                  std::shared_ptr<AcceleratorBuffer> buffer);
@@ -253,6 +303,9 @@ createComposite(const std::string &name, HeterogeneousMap &&options);
 const std::string
 translate(std::shared_ptr<CompositeInstruction> CompositeInstruction,
           const std::string toLanguage);
+// Write the translation to out as it is produced (Compiler::translateStream)
+void translate(std::shared_ptr<CompositeInstruction> CompositeInstruction,
+               const std::string toLanguage, std::ostream &out);
 
 void appendCompiled(std::shared_ptr<CompositeInstruction> composite,
                     bool _override = true);